@@ -24,6 +24,7 @@
 #include <limits>
 #include <algorithm>
 #include <numeric>
+#include <vector>
 
 #include <dmlc/omp.h>
 
@@ -36,9 +37,10 @@ class CpuCTC {
 public:
     // Noncopyable
     CpuCTC(int alphabet_size, int minibatch, void* workspace,
-           int blank_label) :
+           int blank_label, int num_threads = 0) :
             alphabet_size_(alphabet_size), minibatch_(minibatch),
-            workspace_(workspace), blank_label_(blank_label) {
+            workspace_(workspace), blank_label_(blank_label),
+            num_threads_(num_threads > 0 ? num_threads : omp_get_max_threads()) {
 
     };
 
@@ -84,6 +86,7 @@ private:
     int minibatch_;
     void* workspace_;
     int blank_label_;
+    int num_threads_;
 
     void log_softmax(const ProbT* const activations, ProbT* log_probs,
                      const int* const input_lengths);
@@ -172,23 +175,28 @@ template<typename ProbT>
 void
 CpuCTC<ProbT>::log_softmax(const ProbT* const activations, ProbT* log_probs,
                            const int* const input_lengths) {
-#pragma omp parallel for
-    for (int mb = 0; mb < minibatch_; ++mb) {
-        for(int c = 0; c < input_lengths[mb]; ++c) {
-            int col_offset = (mb + minibatch_ * c) * alphabet_size_;
-            ProbT max_activation = -std::numeric_limits<ProbT>::infinity();
-            for(int r = 0; r < alphabet_size_; ++r)
-                max_activation = std::max(max_activation, activations[r + col_offset]);
-
-            ProbT denom = ProbT(0.);
-            for(int r = 0; r < alphabet_size_; ++r) {
-                denom += std::exp(activations[r + col_offset] - max_activation);
-            }
+    const int maxT = *std::max_element(input_lengths, input_lengths + minibatch_);
+    // one column per (time, utterance) so that small batches still use all threads
+    const int num_cols = maxT * minibatch_;
+#pragma omp parallel for num_threads(num_threads_)
+    for (int col = 0; col < num_cols; ++col) {
+        const int c = col / minibatch_;
+        const int mb = col % minibatch_;
+        if (c >= input_lengths[mb])
+            continue;
+        int col_offset = col * alphabet_size_;
+        ProbT max_activation = -std::numeric_limits<ProbT>::infinity();
+        for(int r = 0; r < alphabet_size_; ++r)
+            max_activation = std::max(max_activation, activations[r + col_offset]);
+
+        ProbT denom = ProbT(0.);
+        for(int r = 0; r < alphabet_size_; ++r) {
+            denom += std::exp(activations[r + col_offset] - max_activation);
+        }
 
-            for(int r = 0; r < alphabet_size_; ++r) {
-                log_probs[r + col_offset] = activations[r + col_offset]
-                                            - max_activation - std::log(denom);
-            }
+        const ProbT log_denom = max_activation + std::log(denom);
+        for(int r = 0; r < alphabet_size_; ++r) {
+            log_probs[r + col_offset] = activations[r + col_offset] - log_denom;
         }
     }
 }
@@ -424,7 +432,11 @@ CpuCTC<ProbT>::cost_and_grad(const ProbT* const activations,
 
     log_softmax(activations, log_probs, input_lengths);
 
-#pragma omp parallel for
+    std::vector<int> label_offsets(minibatch_, 0);
+    std::partial_sum(label_lengths, label_lengths + minibatch_ - 1, label_offsets.begin() + 1);
+
+    // the utterances differ in length, so hand them out dynamically
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads_)
     for (int mb = 0; mb < minibatch_; ++mb) {
         const int T = input_lengths[mb]; // Length of utterance (time)
         const int L = label_lengths[mb]; // Number of labels in transcription
@@ -434,7 +446,7 @@ CpuCTC<ProbT>::cost_and_grad(const ProbT* const activations,
         std::tie(costs[mb], mb_status) =
                 cost_and_grad_kernel(grads + mb * alphabet_size_,
                                      log_probs + mb * alphabet_size_,
-                                     flat_labels + std::accumulate(label_lengths, label_lengths + mb, 0),
+                                     flat_labels + label_offsets[mb],
                                      T, L, mb,
                                      bytes_used + mb * per_minibatch_bytes);
     }
@@ -482,7 +494,10 @@ ctcStatus_t CpuCTC<ProbT>::score_forward(const ProbT* const activations,
 
     log_softmax(activations, log_probs, input_lengths);
 
-#pragma omp parallel for
+    std::vector<int> label_offsets(minibatch_, 0);
+    std::partial_sum(label_lengths, label_lengths + minibatch_ - 1, label_offsets.begin() + 1);
+
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads_)
     for (int mb = 0; mb < minibatch_; ++mb) {
         const int T = input_lengths[mb]; // Length of utterance (time)
         const int L = label_lengths[mb]; // Number of labels in transcription
@@ -490,7 +505,7 @@ ctcStatus_t CpuCTC<ProbT>::score_forward(const ProbT* const activations,
 
         CpuCTC_metadata ctcm(L, S, T, mb, alphabet_size_, workspace_,
                              bytes_used + mb * per_minibatch_bytes, blank_label_,
-                             flat_labels + std::accumulate(label_lengths, label_lengths + mb, 0));
+                             flat_labels + label_offsets[mb]);
 
 
         if (L + ctcm.repeats > T)
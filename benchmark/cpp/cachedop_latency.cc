@@ -0,0 +1,406 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cachedop_latency.cc
+ * \brief end to end inference latency of a model served by a thread safe CachedOp
+ *
+ *  The client threads share one thread safe CachedOp and send requests at the times of a
+ *  Poisson process of the target rate (open loop), so the latency of a request, measured from
+ *  its arrival to the completion of its outputs, includes the time it waited for a busy client
+ *  like it would in a server. With --qps 0 the clients send their requests back to back instead,
+ *  which measures the peak throughput.
+ */
+#include <mxnet/c_api.h>
+#include <nnvm/c_api.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::duration Seconds(double seconds) {
+  return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void Check(int ret) {
+  if (ret != 0) {
+    std::fprintf(stderr, "%s\n", MXGetLastError());
+    std::exit(1);
+  }
+}
+
+[[noreturn]] void Usage(const char* error) {
+  if (error != nullptr)
+    std::fprintf(stderr, "error: %s\n\n", error);
+  std::fprintf(
+      stderr,
+      "usage: mxnet_cachedop_latency --symbol <file> [--params <file>] --input <name>:<shape>...\n"
+      "  --symbol <file>        JSON file of the symbol\n"
+      "  --params <file>        parameters of the symbol, named like arg:<name> or <name>\n"
+      "  --input <name>:<dims>  an input of the requests, like data:1,3,224,224, repeatable\n"
+      "  --device cpu|gpu       device of the model (default: cpu)\n"
+      "  --device-id <id>       index of the device (default: 0)\n"
+      "  --threads <n>          number of client threads (default: 1)\n"
+      "  --qps <rate>           target requests per second, 0 for back to back (default: 0)\n"
+      "  --duration <seconds>   duration of the measurement (default: 10)\n"
+      "  --warmup <seconds>     duration of the run before the measurement (default: 2)\n"
+      "  --flag <key>=<value>   flag of the CachedOp, repeatable (default: static_alloc=true,\n"
+      "                         static_shape=true)\n"
+      "  --json <file>          write the results to a JSON file\n");
+  std::exit(1);
+}
+
+std::vector<int64_t> ParseShape(const std::string& dims) {
+  std::vector<int64_t> shape;
+  std::stringstream ss(dims);
+  std::string dim;
+  while (std::getline(ss, dim, ','))
+    shape.push_back(std::stoll(dim));
+  return shape;
+}
+
+struct Options {
+  std::string symbol, params, json;
+  std::vector<std::pair<std::string, std::vector<int64_t>>> inputs;
+  std::map<std::string, std::string> flags{{"static_alloc", "true"}, {"static_shape", "true"}};
+  int dev_type{1}, dev_id{0}, threads{1};
+  double qps{0}, duration{10}, warmup{2};
+};
+
+Options ParseOptions(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc)
+      Usage(("missing value of " + arg).c_str());
+    const std::string value = argv[++i];
+    if (arg == "--symbol") {
+      opts.symbol = value;
+    } else if (arg == "--params") {
+      opts.params = value;
+    } else if (arg == "--json") {
+      opts.json = value;
+    } else if (arg == "--input") {
+      const size_t sep = value.find(':');
+      if (sep == std::string::npos)
+        Usage("--input expects <name>:<shape>");
+      opts.inputs.emplace_back(value.substr(0, sep), ParseShape(value.substr(sep + 1)));
+    } else if (arg == "--flag") {
+      const size_t sep = value.find('=');
+      if (sep == std::string::npos)
+        Usage("--flag expects <key>=<value>");
+      opts.flags[value.substr(0, sep)] = value.substr(sep + 1);
+    } else if (arg == "--device") {
+      if (value != "cpu" && value != "gpu")
+        Usage("--device expects cpu or gpu");
+      opts.dev_type = value == "cpu" ? 1 : 2;
+    } else if (arg == "--device-id") {
+      opts.dev_id = std::stoi(value);
+    } else if (arg == "--threads") {
+      opts.threads = std::stoi(value);
+    } else if (arg == "--qps") {
+      opts.qps = std::stod(value);
+    } else if (arg == "--duration") {
+      opts.duration = std::stod(value);
+    } else if (arg == "--warmup") {
+      opts.warmup = std::stod(value);
+    } else {
+      Usage(("unknown option " + arg).c_str());
+    }
+  }
+  if (opts.symbol.empty() || opts.inputs.empty())
+    Usage("--symbol and --input are required");
+  if (opts.threads <= 0 || opts.qps < 0 || opts.duration <= 0 || opts.warmup < 0)
+    Usage("--threads and --duration must be positive, --qps and --warmup non-negative");
+  return opts;
+}
+
+std::string ContextString(const Options& opts) {
+  return std::string(opts.dev_type == 1 ? "cpu(" : "gpu(") + std::to_string(opts.dev_id) + ")";
+}
+
+/*! \brief copies an array to the device of the model, which the thread safe CachedOp requires */
+NDArrayHandle CopyTo(NDArrayHandle src, const Options& opts) {
+  int ndim             = 0;
+  const int64_t* shape = nullptr;
+  int dtype            = 0;
+  Check(MXNDArrayGetShape64(src, &ndim, &shape));
+  Check(MXNDArrayGetDType(src, &dtype));
+  NDArrayHandle dst = nullptr;
+  Check(MXNDArrayCreate64(shape, ndim, opts.dev_type, opts.dev_id, 0, dtype, &dst));
+  OpHandle op = nullptr;
+  Check(NNGetOpHandle("_copyto", &op));
+  int num_outputs        = 1;
+  NDArrayHandle* outputs = &dst;
+  Check(MXImperativeInvoke(op, 1, &src, &num_outputs, &outputs, 0, nullptr, nullptr, nullptr));
+  return dst;
+}
+
+NDArrayHandle Uniform(const std::vector<int64_t>& shape, const Options& opts) {
+  OpHandle op = nullptr;
+  Check(NNGetOpHandle("_random_uniform", &op));
+  std::string shape_str = "(";
+  for (size_t i = 0; i < shape.size(); ++i)
+    shape_str += (i ? "," : "") + std::to_string(shape[i]);
+  shape_str += shape.size() == 1 ? ",)" : ")";
+  const std::string ctx  = ContextString(opts);
+  const char* keys[]     = {"shape", "ctx"};
+  const char* vals[]     = {shape_str.c_str(), ctx.c_str()};
+  int num_outputs        = 0;
+  NDArrayHandle* outputs = nullptr;
+  Check(MXImperativeInvoke(op, 0, nullptr, &num_outputs, &outputs, 2, keys, vals, nullptr));
+  return outputs[0];
+}
+
+/*! \brief latencies of the requests of one client, in microseconds */
+struct ClientStats {
+  std::vector<double> latency;
+  double wait{0};
+};
+
+void RunClient(CachedOpHandle cached_op,
+               std::vector<NDArrayHandle> inputs,
+               const Options& opts,
+               int index,
+               Clock::time_point measure_begin,
+               Clock::time_point end,
+               ClientStats* stats) {
+  std::mt19937_64 rng(index);
+  std::exponential_distribution<double> interval(opts.qps > 0 ? opts.qps / opts.threads : 1);
+  Clock::time_point arrival = Clock::now();
+  while (true) {
+    if (opts.qps > 0) {
+      arrival += Seconds(interval(rng));
+      std::this_thread::sleep_until(arrival);
+    } else {
+      arrival = Clock::now();
+    }
+    if (arrival >= end)
+      break;
+    const Clock::time_point start = Clock::now();
+    int num_outputs               = 0;
+    NDArrayHandle* outputs        = nullptr;
+    Check(MXInvokeCachedOp(cached_op,
+                           static_cast<int>(inputs.size()),
+                           inputs.data(),
+                           opts.dev_type,
+                           opts.dev_id,
+                           &num_outputs,
+                           &outputs,
+                           nullptr));
+    // the output buffer of the C API is only valid until the next call of the thread
+    std::vector<NDArrayHandle> results(outputs, outputs + num_outputs);
+    for (NDArrayHandle result : results)
+      Check(MXNDArrayWaitToRead(result));
+    const Clock::time_point done = Clock::now();
+    for (NDArrayHandle result : results)
+      Check(MXNDArrayFree(result));
+    if (arrival >= measure_begin) {
+      stats->latency.push_back(std::chrono::duration<double, std::micro>(done - arrival).count());
+      stats->wait += std::chrono::duration<double, std::micro>(start - arrival).count();
+    }
+  }
+}
+
+/*! \brief the value of a metric in the OpenMetrics text, summed over its labels */
+double MetricValue(const std::string& text, const std::string& name) {
+  double total = 0;
+  std::stringstream ss(text);
+  std::string line;
+  while (std::getline(ss, line)) {
+    if (line.compare(0, name.size(), name) != 0 || line.size() == name.size())
+      continue;
+    if (line[name.size()] != ' ' && line[name.size()] != '{')
+      continue;
+    total += std::strtod(line.c_str() + line.rfind(' ') + 1, nullptr);
+  }
+  return total;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  const size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Options opts = ParseOptions(argc, argv);
+
+  SymbolHandle symbol = nullptr;
+  Check(MXSymbolCreateFromFile(opts.symbol.c_str(), &symbol));
+  std::map<std::string, NDArrayHandle> params;
+  if (!opts.params.empty()) {
+    uint32_t num_arrays = 0, num_names = 0;
+    NDArrayHandle* arrays = nullptr;
+    const char** names    = nullptr;
+    Check(MXNDArrayLoad(opts.params.c_str(), &num_arrays, &arrays, &num_names, &names));
+    for (uint32_t i = 0; i < num_names; ++i) {
+      std::string name = names[i];
+      if (name.compare(0, 4, "arg:") == 0 || name.compare(0, 4, "aux:") == 0)
+        name = name.substr(4);
+      params[name] = CopyTo(arrays[i], opts);
+    }
+  }
+
+  // the inputs of the CachedOp are the inputs of the symbol, in the order it lists them
+  uint32_t num_inputs      = 0;
+  const char** input_names = nullptr;
+  Check(NNSymbolListInputNames(symbol, 0, &num_inputs, &input_names));
+  std::vector<std::string> names(input_names, input_names + num_inputs);
+  std::vector<std::vector<NDArrayHandle>> client_inputs(opts.threads);
+  for (const std::string& name : names) {
+    auto data = std::find_if(opts.inputs.begin(), opts.inputs.end(), [&](const auto& input) {
+      return input.first == name;
+    });
+    if (data == opts.inputs.end() && params.count(name) == 0) {
+      std::fprintf(stderr, "error: %s is neither a parameter nor an --input\n", name.c_str());
+      return 1;
+    }
+    // each client sends its own data, and the clients share the parameters
+    for (auto& inputs : client_inputs)
+      inputs.push_back(data != opts.inputs.end() ? Uniform(data->second, opts) : params[name]);
+  }
+
+  std::vector<std::string> keys, vals;
+  for (const auto& flag : opts.flags) {
+    keys.push_back(flag.first);
+    vals.push_back(flag.second);
+  }
+  std::vector<const char*> key_ptrs, val_ptrs;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_ptrs.push_back(keys[i].c_str());
+    val_ptrs.push_back(vals[i].c_str());
+  }
+  CachedOpHandle cached_op = nullptr;
+  Check(MXCreateCachedOp(symbol,
+                         static_cast<int>(keys.size()),
+                         key_ptrs.data(),
+                         val_ptrs.data(),
+                         &cached_op,
+                         true));
+  Check(MXNDArrayWaitAll());
+
+  const Clock::time_point measure_begin = Clock::now() + Seconds(opts.warmup);
+  const Clock::time_point end           = measure_begin + Seconds(opts.duration);
+  std::vector<ClientStats> stats(opts.threads);
+  std::vector<std::thread> clients;
+  for (int i = 0; i < opts.threads; ++i) {
+    clients.emplace_back(
+        RunClient, cached_op, client_inputs[i], std::cref(opts), i, measure_begin, end, &stats[i]);
+  }
+  // the peaks of the engine queue and of the memory pools during the measurement
+  std::atomic<bool> running(true);
+  double max_pending = 0, max_pool_used = 0;
+  std::thread monitor([&]() {
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      if (Clock::now() < measure_begin)
+        continue;
+      const char* metrics = nullptr;
+      Check(MXGetOpenMetrics(&metrics));
+      max_pending = std::max(max_pending, MetricValue(metrics, "mxnet_engine_pending_operations"));
+      max_pool_used =
+          std::max(max_pool_used, MetricValue(metrics, "mxnet_storage_pool_used_bytes"));
+    }
+  });
+  for (auto& client : clients)
+    client.join();
+  const double elapsed = std::chrono::duration<double>(Clock::now() - measure_begin).count();
+  running              = false;
+  monitor.join();
+
+  std::vector<double> latency;
+  double wait = 0;
+  for (const ClientStats& s : stats) {
+    latency.insert(latency.end(), s.latency.begin(), s.latency.end());
+    wait += s.wait;
+  }
+  std::sort(latency.begin(), latency.end());
+  const size_t num_requests = latency.size();
+  double mean               = 0;
+  for (double l : latency)
+    mean += l / std::max<size_t>(num_requests, 1);
+  const char* pool_stats = nullptr;
+  Check(MXStorageGetPoolStats(opts.dev_type, opts.dev_id, &pool_stats));
+  const std::string pool_json = pool_stats;
+  const char* metrics         = nullptr;
+  Check(MXGetOpenMetrics(&metrics));
+  const std::string metrics_text = metrics;
+
+  std::printf("requests:          %zu\n", num_requests);
+  std::printf(
+      "throughput:        %.1f requests/s (target %.1f)\n", num_requests / elapsed, opts.qps);
+  std::printf("latency (ms):      mean %.3f  p50 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+              mean / 1e3,
+              Percentile(latency, 0.5) / 1e3,
+              Percentile(latency, 0.99) / 1e3,
+              Percentile(latency, 0.999) / 1e3,
+              latency.empty() ? 0 : latency.back() / 1e3);
+  std::printf("mean wait (ms):    %.3f\n", num_requests ? wait / num_requests / 1e3 : 0);
+  std::printf("peak pending ops:  %.0f\n", max_pending);
+  std::printf("peak pool used:    %.0f bytes\n", max_pool_used);
+  std::printf("engine and storage metrics:\n");
+  std::stringstream ss(metrics_text);
+  std::string line;
+  while (std::getline(ss, line)) {
+    if (line.compare(0, 12, "mxnet_engine") == 0 || line.compare(0, 13, "mxnet_storage") == 0)
+      std::printf("  %s\n", line.c_str());
+  }
+
+  if (!opts.json.empty()) {
+    std::ofstream os(opts.json);
+    os << "{\n"
+       << "  \"threads\": " << opts.threads << ",\n"
+       << "  \"target_qps\": " << opts.qps << ",\n"
+       << "  \"requests\": " << num_requests << ",\n"
+       << "  \"throughput_qps\": " << num_requests / elapsed << ",\n"
+       << "  \"latency_ms\": {\"mean\": " << mean / 1e3
+       << ", \"p50\": " << Percentile(latency, 0.5) / 1e3
+       << ", \"p90\": " << Percentile(latency, 0.9) / 1e3
+       << ", \"p99\": " << Percentile(latency, 0.99) / 1e3
+       << ", \"p999\": " << Percentile(latency, 0.999) / 1e3
+       << ", \"max\": " << (latency.empty() ? 0 : latency.back() / 1e3) << "},\n"
+       << "  \"mean_wait_ms\": " << (num_requests ? wait / num_requests / 1e3 : 0) << ",\n"
+       << "  \"peak_pending_operations\": " << max_pending << ",\n"
+       << "  \"peak_pool_used_bytes\": " << max_pool_used << ",\n"
+       << "  \"pool_stats\": " << pool_json << "\n"
+       << "}\n";
+  }
+
+  Check(MXFreeCachedOp(cached_op));
+  return 0;
+}
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Compares two JSON reports of mxnet_op_benchmark and flags the regressions.
+
+The reports are written with --benchmark_format=json or --benchmark_out=<file>. When they
+were run with --benchmark_repetitions, the medians of the repetitions are compared.
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+
+_NS_PER_UNIT = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load_times(path):
+    """Returns the context of a report and the real time in nanoseconds of each benchmark."""
+    with open(path) as f:
+        report = json.load(f)
+    runs = {}
+    medians = {}
+    for bench in report['benchmarks']:
+        if bench.get('error_occurred'):
+            continue
+        time = bench['real_time'] * _NS_PER_UNIT[bench.get('time_unit', 'ns')]
+        name = bench.get('run_name', bench['name'])
+        if bench.get('run_type') == 'aggregate':
+            if bench.get('aggregate_name') == 'median':
+                medians[name] = time
+        else:
+            runs.setdefault(name, []).append(time)
+    times = {name: statistics.median(values) for name, values in runs.items()}
+    times.update(medians)
+    return report.get('context', {}), times
+
+
+def compare(base, new, threshold):
+    """Returns the rows (name, base time, new time, relative change) and the regressions."""
+    rows = []
+    regressions = []
+    for name in sorted(set(base) & set(new)):
+        change = new[name] / base[name] - 1 if base[name] > 0 else 0.0
+        rows.append((name, base[name], new[name], change))
+        if change > threshold:
+            regressions.append(name)
+    return rows, regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('base', help='JSON report of the reference build')
+    parser.add_argument('new', help='JSON report of the build to check')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='relative slowdown above which a benchmark regresses')
+    parser.add_argument('--filter', default=None,
+                        help='regular expression selecting the benchmarks to compare')
+    parser.add_argument('--all', action='store_true',
+                        help='print all the benchmarks rather than only the regressions')
+    args = parser.parse_args()
+
+    base_context, base = load_times(args.base)
+    new_context, new = load_times(args.new)
+    if args.filter:
+        pattern = re.compile(args.filter)
+        base = {k: v for k, v in base.items() if pattern.search(k)}
+        new = {k: v for k, v in new.items() if pattern.search(k)}
+    for key in ('host_name', 'num_cpus', 'mxnet_features', 'MXNET_ONEDNN_ENABLED'):
+        if base_context.get(key) != new_context.get(key):
+            print('warning: the reports differ in {}: {} and {}'.format(
+                key, base_context.get(key), new_context.get(key)))
+
+    rows, regressions = compare(base, new, args.threshold)
+    width = max([len('Benchmark')] + [len(row[0]) for row in rows])
+    print('{:<{w}} {:>14} {:>14} {:>9}'.format('Benchmark', 'Base (us)', 'New (us)', 'Change',
+                                               w=width))
+    for name, base_time, new_time, change in rows:
+        if args.all or name in regressions:
+            print('{:<{w}} {:>14.2f} {:>14.2f} {:>+8.1f}%'.format(
+                name, base_time / 1e3, new_time / 1e3, 100 * change, w=width))
+    for name in sorted(set(base) - set(new)):
+        print('missing in {}: {}'.format(args.new, name))
+    for name in sorted(set(new) - set(base)):
+        print('new in {}: {}'.format(args.new, name))
+    print('{} of {} benchmarks regressed by more than {:.1f}%'.format(
+        len(regressions), len(rows), 100 * args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
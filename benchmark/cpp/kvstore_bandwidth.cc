@@ -0,0 +1,380 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file kvstore_bandwidth.cc
+ * \brief bandwidth and latency of the kvstore push-pull over a sweep of configurations
+ *
+ *  Every iteration push-pulls all the keys of a configuration from every device, like the
+ *  gradient reduction of a training step, and waits for the results. The algorithm bandwidth
+ *  is the bytes of the values of one device over the time of an iteration, and the bus
+ *  bandwidth scales it by 2(n-1)/n for the n devices of all the workers, which is the traffic
+ *  of a link in an optimal allreduce, so that it compares with the bandwidth of the links.
+ *
+ *  The dist kvstores are run through tools/launch.py: the servers and the scheduler run the
+ *  kvstore server loop, and the workers the sweep.
+ */
+#include <mxnet/c_api.h>
+#include <nnvm/c_api.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void Check(int ret) {
+  if (ret != 0) {
+    std::fprintf(stderr, "%s\n", MXGetLastError());
+    std::exit(1);
+  }
+}
+
+[[noreturn]] void Usage(const char* error) {
+  if (error != nullptr)
+    std::fprintf(stderr, "error: %s\n\n", error);
+  std::fprintf(
+      stderr,
+      "usage: mxnet_kvstore_bandwidth [options]\n"
+      "  --kvstore <types>      kvstore types among local, device, nccl, or one of dist_sync,\n"
+      "                         dist_device_sync, dist_async (default: device)\n"
+      "  --gpus <ids>           GPUs of the values, like 0,1,2,3 (default: the CPU)\n"
+      "  --sizes <bytes>        bytes of a value, with K, M or G suffixes\n"
+      "                         (default: 4K,256K,4M,64M)\n"
+      "  --num-keys <counts>    number of keys of a push-pull (default: 1,16)\n"
+      "  --dtypes <types>       data types of the values (default: float32,float16)\n"
+      "  --compression <types>  gradient compression, none or a type like 2bit (default: none)\n"
+      "  --threshold <value>    threshold of the 1bit and 2bit compressions (default: 0.5)\n"
+      "  --iters <n>            measured iterations of a configuration (default: 20)\n"
+      "  --warmup <n>           iterations before the measurement (default: 5)\n"
+      "  --json <file>          write the results to a JSON file\n");
+  std::exit(1);
+}
+
+std::vector<std::string> Split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    items.push_back(item);
+  return items;
+}
+
+size_t ParseBytes(const std::string& size) {
+  size_t unit = 1;
+  switch (size.empty() ? ' ' : size.back()) {
+    case 'K':
+      unit = size_t{1} << 10;
+      break;
+    case 'M':
+      unit = size_t{1} << 20;
+      break;
+    case 'G':
+      unit = size_t{1} << 30;
+      break;
+  }
+  return std::stoull(unit == 1 ? size : size.substr(0, size.size() - 1)) * unit;
+}
+
+struct Options {
+  std::vector<std::string> kvstores{"device"}, dtypes{"float32", "float16"}, compressions{"none"};
+  std::vector<int> gpus;
+  std::vector<size_t> sizes{4 << 10, 256 << 10, 4 << 20, 64 << 20};
+  std::vector<int> num_keys{1, 16};
+  std::string threshold{"0.5"}, json;
+  int iters{20}, warmup{5};
+};
+
+bool IsDist(const std::string& type) {
+  return type.compare(0, 4, "dist") == 0;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc)
+      Usage(("missing value of " + arg).c_str());
+    const std::string value = argv[++i];
+    if (arg == "--kvstore") {
+      opts.kvstores = Split(value);
+    } else if (arg == "--gpus") {
+      opts.gpus.clear();
+      for (const std::string& id : Split(value))
+        opts.gpus.push_back(std::stoi(id));
+    } else if (arg == "--sizes") {
+      opts.sizes.clear();
+      for (const std::string& size : Split(value))
+        opts.sizes.push_back(ParseBytes(size));
+    } else if (arg == "--num-keys") {
+      opts.num_keys.clear();
+      for (const std::string& count : Split(value))
+        opts.num_keys.push_back(std::stoi(count));
+    } else if (arg == "--dtypes") {
+      opts.dtypes = Split(value);
+    } else if (arg == "--compression") {
+      opts.compressions = Split(value);
+    } else if (arg == "--threshold") {
+      opts.threshold = value;
+    } else if (arg == "--iters") {
+      opts.iters = std::stoi(value);
+    } else if (arg == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (arg == "--json") {
+      opts.json = value;
+    } else {
+      Usage(("unknown option " + arg).c_str());
+    }
+  }
+  const bool dist = std::any_of(opts.kvstores.begin(), opts.kvstores.end(), IsDist);
+  if (dist && opts.kvstores.size() > 1)
+    Usage("a dist kvstore runs alone, since a process joins a single cluster");
+  if (dist && opts.compressions.size() > 1)
+    Usage("a dist kvstore runs a single compression, since the servers keep the first one");
+  if (opts.iters <= 0 || opts.warmup < 0)
+    Usage("--iters must be positive and --warmup non-negative");
+  return opts;
+}
+
+/*! \brief a point of the sweep */
+struct Config {
+  std::string kvstore, dtype, compression;
+  size_t bytes;
+  int num_keys;
+};
+
+/*! \brief times of the iterations of a configuration, or the error which stopped it */
+struct Result {
+  std::vector<double> times;
+  std::string error;
+};
+
+size_t ElementSize(const std::string& dtype) {
+  if (dtype == "float16" || dtype == "bfloat16")
+    return 2;
+  if (dtype == "float64" || dtype == "int64")
+    return 8;
+  return 4;
+}
+
+/*! \brief stops the configuration with the error of the last call when it failed */
+#define TRY(call)                     \
+  if ((call) != 0) {                  \
+    result->error = MXGetLastError(); \
+    return;                           \
+  }
+
+void Uniform(size_t size, const std::string& dtype, int gpu, NDArrayHandle* out, Result* result) {
+  static OpHandle op = nullptr;
+  if (op == nullptr)
+    Check(NNGetOpHandle("_random_uniform", &op));
+  const std::string shape = "(" + std::to_string(size) + ",)";
+  const std::string ctx   = gpu < 0 ? "cpu(0)" : "gpu(" + std::to_string(gpu) + ")";
+  const char* keys[]      = {"low", "high", "shape", "ctx", "dtype"};
+  const char* vals[]      = {"-1", "1", shape.c_str(), ctx.c_str(), dtype.c_str()};
+  int num_outputs         = 0;
+  NDArrayHandle* outputs  = nullptr;
+  TRY(MXImperativeInvoke(op, 0, nullptr, &num_outputs, &outputs, 5, keys, vals, nullptr));
+  *out = outputs[0];
+}
+
+void RunConfig(KVStoreHandle kv,
+               const Config& config,
+               const Options& opts,
+               int key_base,
+               Result* result) {
+  std::vector<int> devices = opts.gpus;
+  if (devices.empty())
+    devices.push_back(-1);
+  const size_t size = std::max<size_t>(config.bytes / ElementSize(config.dtype), 1);
+  std::vector<int> keys;
+  std::vector<NDArrayHandle> vals, outs;
+  for (int k = 0; k < config.num_keys; ++k) {
+    for (int device : devices) {
+      keys.push_back(key_base + k);
+      vals.emplace_back();
+      outs.emplace_back();
+      Uniform(size, config.dtype, device, &vals.back(), result);
+      Uniform(size, config.dtype, device, &outs.back(), result);
+      if (!result->error.empty())
+        return;
+    }
+  }
+  std::vector<int> init_keys;
+  std::vector<NDArrayHandle> init_vals;
+  for (int k = 0; k < config.num_keys; ++k) {
+    init_keys.push_back(key_base + k);
+    init_vals.push_back(vals[k * devices.size()]);
+  }
+  TRY(MXKVStoreInit(kv, init_keys.size(), init_keys.data(), init_vals.data()));
+  TRY(MXNDArrayWaitAll());
+  for (int i = 0; i < opts.warmup + opts.iters; ++i) {
+    const Clock::time_point start = Clock::now();
+    TRY(MXKVStorePushPull(
+        kv, keys.size(), keys.data(), keys.size(), keys.data(), vals.data(), outs.data(), 0));
+    TRY(MXNDArrayWaitAll());
+    if (i >= opts.warmup)
+      result->times.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  for (NDArrayHandle array : vals)
+    Check(MXNDArrayFree(array));
+  for (NDArrayHandle array : outs)
+    Check(MXNDArrayFree(array));
+}
+
+#undef TRY
+
+double Percentile(std::vector<double> times, double p) {
+  std::sort(times.begin(), times.end());
+  const size_t rank = static_cast<size_t>(p * (times.size() - 1) + 0.5);
+  return times[std::min(rank, times.size() - 1)];
+}
+
+void ServerController(int head, const char*, void*) {
+  // the commands of the frontends, like the optimizer of the Python servers, do not apply
+  std::fprintf(stderr, "ignoring the server command %d\n", head);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Options opts = ParseOptions(argc, argv);
+  int is_worker      = 1;
+  Check(MXKVStoreIsWorkerNode(&is_worker));
+  if (!is_worker) {
+    KVStoreHandle server = nullptr;
+    Check(MXKVStoreCreate("dist", &server));
+    Check(MXKVStoreRunServer(server, ServerController, nullptr));
+    Check(MXKVStoreFree(server));
+    return 0;
+  }
+
+  int rank = 0, num_workers = 1;
+  const int num_devices = std::max<int>(opts.gpus.size(), 1);
+  std::vector<std::pair<Config, Result>> results;
+  KVStoreHandle dist_kv = nullptr;
+  int key_base          = 0;
+  for (const std::string& kvstore : opts.kvstores) {
+    for (const std::string& compression : opts.compressions) {
+      // a kvstore per compression, which can only be set before the keys are initialized,
+      // except for the dist kvstore, since a worker joins the cluster only once
+      KVStoreHandle kv = dist_kv;
+      if (kv == nullptr) {
+        Check(MXKVStoreCreate(kvstore.c_str(), &kv));
+        Check(MXKVStoreGetRank(kv, &rank));
+        Check(MXKVStoreGetGroupSize(kv, &num_workers));
+        if (compression != "none") {
+          const char* keys[] = {"type", "threshold"};
+          const char* vals[] = {compression.c_str(), opts.threshold.c_str()};
+          Check(MXKVStoreSetGradientCompression(kv, 2, keys, vals));
+        }
+        if (IsDist(kvstore))
+          dist_kv = kv;
+      }
+      for (const std::string& dtype : opts.dtypes) {
+        for (int num_keys : opts.num_keys) {
+          for (size_t bytes : opts.sizes) {
+            results.emplace_back(Config{kvstore, dtype, compression, bytes, num_keys}, Result());
+            RunConfig(kv, results.back().first, opts, key_base, &results.back().second);
+            key_base += num_keys;
+            if (dist_kv != nullptr)
+              Check(MXKVStoreBarrier(kv));
+          }
+        }
+      }
+      if (dist_kv == nullptr)
+        Check(MXKVStoreFree(kv));
+    }
+  }
+  if (rank != 0) {
+    Check(MXKVStoreFree(dist_kv));
+    return 0;
+  }
+
+  // the devices of all the workers take part in the reduction
+  const int num_ranks   = num_devices * num_workers;
+  const double bus_rate = num_ranks > 1 ? 2.0 * (num_ranks - 1) / num_ranks : 0.0;
+  std::printf("%d worker(s), %d device(s) per worker\n", num_workers, num_devices);
+  std::printf("%-18s %-8s %-11s %5s %12s %10s %10s %10s %10s %10s\n",
+              "kvstore",
+              "dtype",
+              "compression",
+              "keys",
+              "bytes",
+              "algbw GB/s",
+              "busbw GB/s",
+              "p50 ms",
+              "p99 ms",
+              "max ms");
+  std::ofstream json;
+  if (!opts.json.empty()) {
+    json.open(opts.json);
+    json << "{\"num_workers\": " << num_workers << ", \"num_devices\": " << num_devices
+         << ", \"results\": [";
+  }
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Config& config = results[i].first;
+    const Result& result = results[i].second;
+    std::printf("%-18s %-8s %-11s %5d %12zu ",
+                config.kvstore.c_str(),
+                config.dtype.c_str(),
+                config.compression.c_str(),
+                config.num_keys,
+                config.bytes);
+    if (json.is_open()) {
+      json << (i ? ",\n  " : "\n  ") << "{\"kvstore\": \"" << config.kvstore << "\", \"dtype\": \""
+           << config.dtype << "\", \"compression\": \"" << config.compression
+           << "\", \"num_keys\": " << config.num_keys << ", \"bytes\": " << config.bytes;
+    }
+    if (!result.error.empty()) {
+      const std::string error = result.error.substr(0, result.error.find('\n'));
+      std::printf("skipped: %s\n", error.c_str());
+      if (json.is_open())
+        json << ", \"skipped\": true}";
+      continue;
+    }
+    const double p50   = Percentile(result.times, 0.5);
+    const double algbw = static_cast<double>(config.bytes) * config.num_keys / p50 / 1e9;
+    std::printf("%10.2f %10.2f %10.3f %10.3f %10.3f\n",
+                algbw,
+                algbw * bus_rate,
+                p50 * 1e3,
+                Percentile(result.times, 0.99) * 1e3,
+                Percentile(result.times, 1.0) * 1e3);
+    if (json.is_open()) {
+      json << ", \"algbw_gbps\": " << algbw << ", \"busbw_gbps\": " << algbw * bus_rate
+           << ", \"latency_ms\": {\"p50\": " << p50 * 1e3
+           << ", \"p90\": " << Percentile(result.times, 0.9) * 1e3
+           << ", \"p99\": " << Percentile(result.times, 0.99) * 1e3
+           << ", \"max\": " << Percentile(result.times, 1.0) * 1e3 << "}}";
+    }
+  }
+  if (json.is_open())
+    json << "\n]}\n";
+  if (dist_kv != nullptr)
+    Check(MXKVStoreFree(dist_kv));
+  return 0;
+}
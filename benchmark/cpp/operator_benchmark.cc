@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file operator_benchmark.cc
+ * \brief Google Benchmark suite of the most used operators on representative shapes
+ *
+ *  The operators are invoked through the C API like the frontends do, on the CPU (with oneDNN
+ *  when the library is built with it) and on the first GPU when there is one. Run it with
+ *  --benchmark_format=json and compare two reports with benchmark/cpp/compare.py.
+ */
+#include <benchmark/benchmark.h>
+#include <mxnet/c_api.h>
+#include <nnvm/c_api.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Shape  = std::vector<int64_t>;
+using Kwargs = std::vector<std::pair<std::string, std::string>>;
+
+/*! \brief an input of a benchmark, filled uniformly in [low, high) */
+struct Input {
+  Shape shape;
+  float low{0.1f};
+  float high{1.0f};
+};
+
+/*! \brief an operator invocation to benchmark */
+struct OpCase {
+  std::string name;
+  std::string op;
+  std::vector<Input> inputs;
+  Kwargs kwargs;
+};
+
+void Check(int ret) {
+  if (ret != 0) {
+    std::fprintf(stderr, "%s\n", MXGetLastError());
+    std::exit(1);
+  }
+}
+
+std::string ShapeString(const Shape& shape, const char* sep) {
+  std::string s;
+  for (size_t i = 0; i < shape.size(); ++i)
+    s += (i ? sep : "") + std::to_string(shape[i]);
+  return s;
+}
+
+AtomicSymbolCreator GetOp(const std::string& name) {
+  OpHandle op = nullptr;
+  Check(NNGetOpHandle(name.c_str(), &op));
+  if (op == nullptr) {
+    std::fprintf(stderr, "Operator %s is not registered\n", name.c_str());
+    std::exit(1);
+  }
+  return op;
+}
+
+/*!
+ * \brief invokes an operator, writing into the outputs when there are some like an out= argument
+ *  does, and allocating them otherwise
+ */
+void Invoke(AtomicSymbolCreator op,
+            std::vector<NDArrayHandle>* inputs,
+            const Kwargs& kwargs,
+            std::vector<NDArrayHandle>* outputs) {
+  std::vector<const char*> keys, vals;
+  for (const auto& kv : kwargs) {
+    keys.push_back(kv.first.c_str());
+    vals.push_back(kv.second.c_str());
+  }
+  int num_outputs          = static_cast<int>(outputs->size());
+  NDArrayHandle* out_array = outputs->empty() ? nullptr : outputs->data();
+  Check(MXImperativeInvoke(op,
+                           static_cast<int>(inputs->size()),
+                           inputs->data(),
+                           &num_outputs,
+                           &out_array,
+                           static_cast<int>(keys.size()),
+                           keys.data(),
+                           vals.data(),
+                           nullptr));
+  if (outputs->empty())
+    outputs->assign(out_array, out_array + num_outputs);
+}
+
+NDArrayHandle Uniform(const Input& input, const std::string& ctx) {
+  static AtomicSymbolCreator op = GetOp("_random_uniform");
+  std::vector<NDArrayHandle> inputs, outputs;
+  Invoke(op,
+         &inputs,
+         {{"low", std::to_string(input.low)},
+          {"high", std::to_string(input.high)},
+          {"shape", "(" + ShapeString(input.shape, ",") + (input.shape.size() == 1 ? ",)" : ")")},
+          {"ctx", ctx}},
+         &outputs);
+  return outputs[0];
+}
+
+size_t NumBytes(NDArrayHandle array) {
+  int ndim             = 0;
+  const int64_t* shape = nullptr;
+  int dtype            = 0;
+  Check(MXNDArrayGetShape64(array, &ndim, &shape));
+  Check(MXNDArrayGetDType(array, &dtype));
+  // float32, float64, float16, uint8, int32, int8, int64, bool
+  static const size_t kSizes[] = {4, 8, 2, 1, 4, 1, 8, 1};
+  size_t size = dtype >= 0 && dtype < 8 ? kSizes[dtype] : 4;
+  for (int i = 0; i < ndim; ++i)
+    size *= static_cast<size_t>(shape[i]);
+  return size;
+}
+
+/*!
+ * \brief times one invocation of the operator up to the completion of its outputs, which includes
+ *  the overhead of the imperative runtime and the engine like in the frontends
+ */
+void RunCase(benchmark::State& state, const OpCase& c, const std::string& ctx) {
+  AtomicSymbolCreator op = GetOp(c.op);
+  std::vector<NDArrayHandle> inputs, outputs;
+  for (const Input& input : c.inputs)
+    inputs.push_back(Uniform(input, ctx));
+  // the first invocation allocates the outputs and selects the algorithms of cuDNN
+  Invoke(op, &inputs, c.kwargs, &outputs);
+  Check(MXNDArrayWaitAll());
+  for (auto _ : state) {
+    Invoke(op, &inputs, c.kwargs, &outputs);
+    Check(MXNDArrayWaitAll());
+  }
+  size_t bytes = 0;
+  for (NDArrayHandle array : inputs)
+    bytes += NumBytes(array);
+  for (NDArrayHandle array : outputs)
+    bytes += NumBytes(array);
+  state.SetBytesProcessed(static_cast<int64_t>(bytes) * state.iterations());
+  for (NDArrayHandle array : inputs)
+    Check(MXNDArrayFree(array));
+  for (NDArrayHandle array : outputs)
+    Check(MXNDArrayFree(array));
+}
+
+std::vector<OpCase> Cases() {
+  std::vector<OpCase> cases;
+  const Shape matrix = {1024, 1024};
+  const Shape image  = {16, 64, 56, 56};
+  for (const char* op : {"relu",
+                         "sigmoid",
+                         "tanh",
+                         "exp",
+                         "log",
+                         "sqrt",
+                         "rsqrt",
+                         "abs",
+                         "square",
+                         "erf",
+                         "round"}) {
+    for (const Shape& shape : {matrix, image})
+      cases.push_back({op, op, {{shape}}, {}});
+  }
+  for (const char* op : {"elemwise_add", "elemwise_sub", "elemwise_mul", "elemwise_div"}) {
+    for (const Shape& shape : {matrix, image})
+      cases.push_back({op, op, {{shape}, {shape}}, {}});
+  }
+  for (const char* op : {"broadcast_add",
+                         "broadcast_sub",
+                         "broadcast_mul",
+                         "broadcast_div",
+                         "broadcast_maximum"}) {
+    cases.push_back({op, op, {{matrix}, {{1, 1024}}}, {}});
+    cases.push_back({op, op, {{image}, {{1, 64, 1, 1}}}, {}});
+  }
+  cases.push_back({"_plus_scalar", "_plus_scalar", {{matrix}}, {{"scalar", "1"}}});
+  cases.push_back({"_mul_scalar", "_mul_scalar", {{matrix}}, {{"scalar", "2"}}});
+  cases.push_back({"_power_scalar", "_power_scalar", {{matrix}}, {{"scalar", "2"}}});
+  for (const char* op :
+       {"sum", "mean", "max", "min", "prod", "norm", "argmax", "softmax", "log_softmax"}) {
+    cases.push_back({op, op, {{matrix}}, {{"axis", "-1"}}});
+  }
+  cases.push_back({"sum_axis0", "sum", {{matrix}}, {{"axis", "0"}}});
+  cases.push_back({"sum_image", "sum", {{image}}, {{"axis", "(0,2,3)"}}});
+
+  // matrix multiplications
+  cases.push_back({"dot", "dot", {{{512, 512}}, {{512, 512}}}, {}});
+  cases.push_back({"dot", "dot", {{matrix}, {matrix}}, {}});
+  cases.push_back({"dot_transpose_b", "dot", {{matrix}, {matrix}}, {{"transpose_b", "True"}}});
+  cases.push_back({"batch_dot", "batch_dot", {{{32, 128, 64}}, {{32, 64, 128}}}, {}});
+  cases.push_back({"linalg_gemm2", "_linalg_gemm2", {{{512, 512}}, {{512, 512}}}, {}});
+  for (int64_t batch : {64, 512}) {
+    cases.push_back({"FullyConnected",
+                     "FullyConnected",
+                     {{{batch, 1024}}, {{1024, 1024}}, {{1024}}},
+                     {{"num_hidden", "1024"}}});
+  }
+
+  // layers of convolutional networks
+  cases.push_back({"Convolution_3x3",
+                   "Convolution",
+                   {{{8, 64, 56, 56}}, {{64, 64, 3, 3}}, {{64}}},
+                   {{"kernel", "(3,3)"}, {"pad", "(1,1)"}, {"num_filter", "64"}}});
+  cases.push_back({"Convolution_1x1",
+                   "Convolution",
+                   {{{8, 256, 56, 56}}, {{64, 256, 1, 1}}, {{64}}},
+                   {{"kernel", "(1,1)"}, {"num_filter", "64"}}});
+  cases.push_back(
+      {"Convolution_3x3_stride2",
+       "Convolution",
+       {{{8, 128, 28, 28}}, {{256, 128, 3, 3}}, {{256}}},
+       {{"kernel", "(3,3)"}, {"stride", "(2,2)"}, {"pad", "(1,1)"}, {"num_filter", "256"}}});
+  cases.push_back(
+      {"Deconvolution_4x4_stride2",
+       "Deconvolution",
+       {{{8, 64, 28, 28}}, {{64, 32, 4, 4}}},
+       {{"kernel", "(4,4)"}, {"stride", "(2,2)"}, {"pad", "(1,1)"}, {"num_filter", "32"}}});
+  cases.push_back(
+      {"Pooling_max_3x3",
+       "Pooling",
+       {{{8, 64, 112, 112}}},
+       {{"kernel", "(3,3)"}, {"stride", "(2,2)"}, {"pad", "(1,1)"}, {"pool_type", "max"}}});
+  cases.push_back({"Pooling_avg_global",
+                   "Pooling",
+                   {{{8, 512, 7, 7}}},
+                   {{"kernel", "(7,7)"}, {"global_pool", "True"}, {"pool_type", "avg"}}});
+  cases.push_back(
+      {"BatchNorm", "BatchNorm", {{{8, 64, 56, 56}}, {{64}}, {{64}}, {{64}}, {{64}}}, {}});
+  cases.push_back({"LayerNorm", "LayerNorm", {{{32, 128, 768}}, {{768}}, {{768}}}, {}});
+  cases.push_back({"Activation_relu", "Activation", {{image}}, {{"act_type", "relu"}}});
+  cases.push_back({"Activation_softrelu", "Activation", {{image}}, {{"act_type", "softrelu"}}});
+  cases.push_back({"LeakyReLU", "LeakyReLU", {{image}}, {{"act_type", "leaky"}}});
+  cases.push_back({"LeakyReLU_gelu", "LeakyReLU", {{{32, 128, 3072}}}, {{"act_type", "gelu"}}});
+  cases.push_back({"Embedding",
+                   "Embedding",
+                   {{{64, 128}, 0, 10000}, {{10000, 512}}},
+                   {{"input_dim", "10000"}, {"output_dim", "512"}}});
+
+  // data movement and indexing
+  cases.push_back({"transpose", "transpose", {{matrix}}, {}});
+  cases.push_back({"transpose_nhwc", "transpose", {{image}}, {{"axes", "(0,2,3,1)"}}});
+  // the attention heads, and a permutation of more dimensions than oneDNN transposes
+  cases.push_back(
+      {"transpose_heads", "transpose", {{{32, 128, 12, 64}}}, {{"axes", "(0,2,1,3)"}}});
+  cases.push_back(
+      {"transpose_5d", "transpose", {{{8, 32, 16, 16, 16}}}, {{"axes", "(0,2,3,4,1)"}}});
+  cases.push_back({"Concat",
+                   "Concat",
+                   {{{1024, 512}}, {{1024, 512}}},
+                   {{"num_args", "2"}, {"dim", "1"}}});
+  cases.push_back({"stack",
+                   "stack",
+                   {{{1024, 512}}, {{1024, 512}}},
+                   {{"num_args", "2"}, {"axis", "0"}}});
+  cases.push_back({"split", "split", {{matrix}}, {{"num_outputs", "4"}, {"axis", "1"}}});
+  cases.push_back({"slice", "slice", {{matrix}}, {{"begin", "(0,0)"}, {"end", "(512,512)"}}});
+  cases.push_back({"take", "take", {{{10000, 512}}, {{4096}, 0, 10000}}, {}});
+  cases.push_back({"one_hot", "one_hot", {{{4096}, 0, 1000}}, {{"depth", "1000"}}});
+  cases.push_back({"where", "where", {{matrix, 0, 2}, {matrix}, {matrix}}, {}});
+  cases.push_back({"clip", "clip", {{matrix}}, {{"a_min", "0.2"}, {"a_max", "0.8"}}});
+  cases.push_back({"Cast_float16", "Cast", {{matrix}}, {{"dtype", "float16"}}});
+  cases.push_back({"topk", "topk", {{{64, 4096}}}, {{"k", "10"}}});
+  cases.push_back({"sort", "sort", {{{64, 4096}}}, {}});
+  cases.push_back({"tile", "tile", {{{512, 512}}}, {{"reps", "(2,2)"}}});
+  cases.push_back({"repeat", "repeat", {{{512, 512}}}, {{"repeats", "2"}, {"axis", "0"}}});
+  cases.push_back({"reverse", "reverse", {{matrix}}, {{"axis", "1"}}});
+  cases.push_back({"Pad",
+                   "Pad",
+                   {{image}},
+                   {{"mode", "constant"}, {"pad_width", "(0,0,0,0,1,1,1,1)"}}});
+
+  // optimizer updates
+  const Shape weight = {1 << 20};
+  cases.push_back({"sgd_update", "sgd_update", {{weight}, {weight}}, {{"lr", "0.01"}}});
+  cases.push_back({"sgd_mom_update",
+                   "sgd_mom_update",
+                   {{weight}, {weight}, {weight}},
+                   {{"lr", "0.01"}, {"momentum", "0.9"}}});
+  cases.push_back(
+      {"adam_update", "adam_update", {{weight}, {weight}, {weight}, {weight}}, {{"lr", "0.001"}}});
+  return cases;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  int version = 0, num_gpus = 0;
+  Check(MXGetVersion(&version));
+  Check(MXGetGPUCount(&num_gpus));
+  benchmark::AddCustomContext("mxnet_version", std::to_string(version));
+  const LibFeature* features = nullptr;
+  size_t num_features        = 0;
+  Check(MXLibInfoFeatures(&features, &num_features));
+  std::string enabled;
+  for (size_t i = 0; i < num_features; ++i) {
+    if (features[i].enabled)
+      enabled += (enabled.empty() ? "" : ",") + std::string(features[i].name);
+  }
+  benchmark::AddCustomContext("mxnet_features", enabled);
+  const char* onednn = std::getenv("MXNET_ONEDNN_ENABLED");
+  benchmark::AddCustomContext("MXNET_ONEDNN_ENABLED", onednn ? onednn : "");
+
+  std::vector<std::pair<std::string, std::string>> contexts = {{"cpu", "cpu(0)"}};
+  if (num_gpus > 0)
+    contexts.emplace_back("gpu", "gpu(0)");
+  for (const OpCase& c : Cases()) {
+    for (const auto& ctx : contexts) {
+      const std::string name = c.name + "/" + ShapeString(c.inputs[0].shape, "x") + "/" + ctx.first;
+      benchmark::RegisterBenchmark(name.c_str(), RunCase, c, ctx.second)
+          ->UseRealTime()
+          ->Unit(benchmark::kMicrosecond);
+    }
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
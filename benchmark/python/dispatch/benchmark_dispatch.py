@@ -0,0 +1,83 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the host overhead of the imperative calls of small operators: the parsing of
+their attributes and the inference of their outputs, with the caches of the imperative calls
+enabled and disabled.
+
+Each configuration runs in its own process, since the caches read their sizes once:
+
+    python benchmark_dispatch.py --repeat 20000
+"""
+import argparse
+import os
+import subprocess
+import sys
+import timeit
+
+CONFIGS = [
+    ('no caches', {'MXNET_IMPERATIVE_ATTRS_CACHE_SIZE': '0',
+                   'MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE': '0'}),
+    ('attrs cache', {'MXNET_IMPERATIVE_ATTRS_CACHE_SIZE': '1024',
+                     'MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE': '0'}),
+    ('attrs and dispatch caches', {'MXNET_IMPERATIVE_ATTRS_CACHE_SIZE': '1024',
+                                   'MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE': '1024'}),
+]
+
+
+def workloads(mx):
+    """The calls benchmarked: the legacy operators, whose attributes are strings, and the numpy
+    operators of the FFI, whose attributes are parsed in Python."""
+    x = mx.nd.ones((2, 3, 4, 5, 6))
+    y = mx.nd.ones((2, 3, 4, 5, 6))
+    a = mx.np.ones((2, 3, 4, 5, 6))
+    b = mx.np.ones((2, 3, 4, 5, 6))
+    return [
+        ('nd.broadcast_add', lambda: mx.nd.broadcast_add(x, y)),
+        ('nd.sum', lambda: mx.nd.sum(x, axis=(1, 3), keepdims=True)),
+        ('nd.transpose', lambda: mx.nd.transpose(x, axes=(4, 3, 2, 1, 0))),
+        ('nd.reshape', lambda: mx.nd.reshape(x, shape=(6, -1))),
+        ('nd.slice', lambda: mx.nd.slice(x, begin=(0, 1), end=(1, 3))),
+        ('np.add', lambda: mx.np.add(a, b)),
+        ('np.sum', lambda: mx.np.sum(a, axis=(1, 3), keepdims=True)),
+        ('np.transpose', lambda: mx.np.transpose(a, axes=(4, 3, 2, 1, 0))),
+        ('np.reshape', lambda: mx.np.reshape(a, (6, -1))),
+    ]
+
+
+def run(repeat):
+    import mxnet as mx
+    for name, call in workloads(mx):
+        call()
+        mx.nd.waitall()
+        seconds = min(timeit.repeat(call, number=repeat, repeat=3))
+        mx.nd.waitall()
+        print('{:<20}{:>10.2f} us'.format(name, seconds / repeat * 1e6))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--repeat', type=int, default=10000, help='calls per measurement')
+    parser.add_argument('--worker', action='store_true', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    if args.worker:
+        run(args.repeat)
+        sys.exit(0)
+    for config, env in CONFIGS:
+        print('# ' + config)
+        sys.stdout.flush()
+        subprocess.check_call([sys.executable, __file__, '--worker', '--repeat', str(args.repeat)],
+                              env=dict(os.environ, **env))
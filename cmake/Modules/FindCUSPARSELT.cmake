@@ -0,0 +1,34 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+include(FindPackageHandleStandardArgs)
+
+set(CUSPARSELT_ROOT "/usr/local/cuda" CACHE PATH "cuSPARSELt root folder")
+
+find_path(CUSPARSELT_INCLUDE cusparseLt.h
+        PATHS ${CUSPARSELT_ROOT} $ENV{CUSPARSELT_ROOT}
+        PATH_SUFFIXES include
+        DOC "Path to cuSPARSELt include directory." )
+
+find_library(CUSPARSELT_LIBRARY NAMES libcusparseLt.so
+        PATHS ${CUSPARSELT_ROOT} $ENV{CUSPARSELT_ROOT} ${CUSPARSELT_INCLUDE}
+        PATH_SUFFIXES lib lib64 lib/x64 cuda/lib cuda/lib64
+        DOC "Path to cuSPARSELt library.")
+
+find_package_handle_standard_args(CUSPARSELT DEFAULT_MSG CUSPARSELT_LIBRARY CUSPARSELT_INCLUDE)
+
+mark_as_advanced(CUSPARSELT_ROOT CUSPARSELT_INCLUDE CUSPARSELT_LIBRARY)
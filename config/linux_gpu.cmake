@@ -111,6 +111,10 @@ set(USE_JEMALLOC OFF CACHE BOOL "Build with Jemalloc support")
 # put in src/operators
 SET(EXTRA_OPERATORS "" CACHE PATH "EXTRA OPERATORS PATH")
 
+# file listing the only operators to build, e.g. those of the models of an inference
+# deployment, as written by tools/selective_build.py ops
+SET(MXNET_SELECTED_OPS "" CACHE FILEPATH "File listing the only operators to build")
+
 
 #----------------------------
 # other features
@@ -129,3 +133,4 @@ set(USE_NCCL "Use NVidia NCCL with CUDA" OFF)
 set(NCCL_ROOT "" CACHE BOOL "NCCL install path. Supports autodetection.")
 set(USE_NVML OFF CACHE BOOL "Build with NVML support")
 set(USE_NVTX ON CACHE BOOL "Build with NVTX support")
+set(USE_NVJPEG OFF CACHE BOOL "Build with nvJPEG support for decoding images on the GPU")
@@ -17,3 +17,4 @@
 
 # coding: utf-8
 from . import ufunc
+from . import tuned
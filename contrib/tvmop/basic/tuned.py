@@ -0,0 +1,118 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Kernels of native operators with a schedule chosen per input shape by tune.py.
+
+The native operators run these kernels for the shapes in the tuning log loaded at runtime,
+see src/operator/contrib/tvmop/tuned.cc, which passes the arguments in the same layout.
+"""
+import tvm
+from tvm import autotvm
+from .. import defop, RealTypes
+from .. import assign_by_req, reduce_axes
+
+_BINARY_OPS = {
+    "broadcast_add": lambda a, b: a + b,
+    "broadcast_sub": lambda a, b: a - b,
+    "broadcast_mul": lambda a, b: a * b,
+    "broadcast_div": lambda a, b: a / b,
+}
+
+
+def compute_broadcast(op, dtype, ndim):
+    A = tvm.te.placeholder([tvm.te.size_var() for _ in range(ndim)], name='A', dtype=dtype)
+    B = tvm.te.placeholder([tvm.te.size_var() for _ in range(ndim)], name='B', dtype=dtype)
+    C = tvm.te.compute([tvm.te.size_var() for _ in range(ndim)],
+                       lambda *index: _BINARY_OPS[op](A[index], B[index]), name='C')
+    s = tvm.te.create_schedule(C.op)
+    return s, A, B, C
+
+
+def schedule_broadcast_cpu(op, dtype, ndim, fallback):
+    cfg = autotvm.get_config()
+    cfg.define_knob("vec", [8] if fallback else [4, 8, 16, 32])
+    s, A, B, C = compute_broadcast(op, dtype, ndim)
+    fused = s[C].fuse(*C.op.axis)
+    outer, inner = s[C].split(fused, factor=cfg["vec"].val)
+    s[C].parallel(outer)
+    s[C].vectorize(inner)
+    return s, [A, B, C]
+
+
+def schedule_broadcast_gpu(op, dtype, ndim, fallback):
+    cfg = autotvm.get_config()
+    cfg.define_knob("threads", [64] if fallback else [64, 128, 256, 512])
+    s, A, B, C = compute_broadcast(op, dtype, ndim)
+    fused = s[C].fuse(*C.op.axis)
+    bx, tx = s[C].split(fused, factor=cfg["threads"].val)
+    s[C].bind(bx, tvm.te.thread_axis("blockIdx.x"))
+    s[C].bind(tx, tvm.te.thread_axis("threadIdx.x"))
+    return s, [A, B, C]
+
+
+def _defop_broadcast(op):
+    @defop(name="tuned_" + op, target="cpu", auto_broadcast=True, dtype=RealTypes[:2], ndim=[5])
+    def _cpu(dtype, ndim, fallback):
+        return schedule_broadcast_cpu(op, dtype, ndim, fallback)
+
+    @defop(name="cuda_tuned_" + op, target="cuda", auto_broadcast=True, dtype=RealTypes[:2], ndim=[5])
+    def _gpu(dtype, ndim, fallback):
+        return schedule_broadcast_gpu(op, dtype, ndim, fallback)
+
+
+for _op in _BINARY_OPS:
+    _defop_broadcast(_op)
+
+
+def compute_sum(dtype, ndim, reduce1st, req):
+    # the axes alternate between reduced and kept ones, starting with a reduced one if reduce1st,
+    # as in compute_backward_vadd
+    axes = ([reduce1st, 1 - reduce1st] * ndim)[:ndim]
+    X = tvm.te.placeholder([tvm.te.size_var() for _ in range(ndim)], name='X', dtype=dtype)
+    ret = reduce_axes(X, axes, tvm.tir.sum)
+    out_a, out = assign_by_req(ret, req)
+    s = tvm.te.create_schedule(out.op)
+    return s, X, out_a, out, ret
+
+
+@defop(name="tuned_sum", target="cpu", dtype=RealTypes[:2], ndim=[5], reduce1st=[0, 1],
+       req=["kWriteTo", "kAddTo"], attrs=["reduce1st", "req"])
+def tuned_sum(dtype, ndim, reduce1st, req, fallback):
+    cfg = autotvm.get_config()
+    cfg.define_knob("unroll", [1] if fallback else [1, 4, 8, 16])
+    s, X, out_a, out, ret = compute_sum(dtype, ndim, reduce1st, req)
+    _, ki = s[ret].split(ret.op.reduce_axis[-1], factor=cfg["unroll"].val)
+    s[ret].unroll(ki)
+    for t in [ret, out]:
+        fused = s[t].fuse(*t.op.axis)
+        s[t].parallel(fused)
+    return s, [X, out_a, out]
+
+
+@defop(name="cuda_tuned_sum", target="cuda", dtype=RealTypes[:2], ndim=[5], reduce1st=[0, 1],
+       req=["kWriteTo", "kAddTo"], attrs=["reduce1st", "req"])
+def tuned_sum_gpu(dtype, ndim, reduce1st, req, fallback):
+    cfg = autotvm.get_config()
+    cfg.define_knob("threads", [64] if fallback else [32, 64, 128, 256])
+    s, X, out_a, out, ret = compute_sum(dtype, ndim, reduce1st, req)
+    for t in [ret, out]:
+        fused = s[t].fuse(*t.op.axis)
+        bx, tx = s[t].split(fused, factor=cfg["threads"].val)
+        s[t].bind(bx, tvm.te.thread_axis("blockIdx.x"))
+        s[t].bind(tx, tvm.te.thread_axis("threadIdx.x"))
+    return s, [X, out_a, out]
@@ -0,0 +1,190 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Tunes the kernels of tvmop/basic/tuned.py for the shapes of a workload.
+
+The workload is a json list of the calls to tune, e.g.
+
+    [{"op": "broadcast_add", "dtype": "float32", "shapes": [[32, 128], [1, 128]]},
+     {"op": "sum", "dtype": "float32", "shapes": [[64, 10]], "axis": [1]}]
+
+Every schedule of the kernel of a call is timed, and the fastest one is written to the tuning log
+when it is faster than the native operator, if it is compared with --compare-native. MXNet loads
+the log of the architecture it runs on, from MXNET_TVM_OP_TUNING_LOG or the tvmop_tuning.conf
+built with libtvmop, and runs the tuned kernel for the calls with the shapes of a record.
+"""
+import argparse
+import json
+import logging
+import os
+import platform
+import sys
+import time
+
+import numpy as np
+import tvm
+from tvm import autotvm
+
+logging.basicConfig(level=logging.INFO)
+
+MAX_DIM = 5
+
+
+def kernel_args(call):
+    """The shapes of the kernel arguments of a call, as src/operator/contrib/tvmop/tuned.cc passes
+    them, the attributes of the kernel, and the shapes of its outputs."""
+    shapes = [list(s) for s in call["shapes"]]
+    if call["op"] != "sum":
+        padded = [[1] * (MAX_DIM - len(s)) + s for s in shapes]
+        out = [max(dims) for dims in zip(*padded)]
+        return padded, {}, [out]
+    # the reduced axes of the input, merged with their reduced or kept neighbours
+    big = shapes[0]
+    axis = call.get("axis", None)
+    if axis is None or len(axis) == 0:
+        reduced = [True] * len(big)
+    else:
+        axis = [a + len(big) if a < 0 else a for a in axis]
+        reduced = [(i in axis) != call.get("exclude", False) for i in range(len(big))]
+    reduced = [r and d != 1 for r, d in zip(reduced, big)]
+    dims = []
+    for i, d in enumerate(big):
+        if i == 0 or reduced[i] != reduced[i - 1]:
+            dims.append(d)
+        else:
+            dims[-1] *= d
+    if len(dims) > MAX_DIM:
+        return None, None, None
+    dims += [1] * (MAX_DIM - len(dims))
+    reduce1st = int(reduced[0])
+    kept = dims[reduce1st::2]
+    return [dims, kept], {"reduce1st": reduce1st, "req": "kWriteTo"}, [kept]
+
+
+def find_opdef(name):
+    from tvmop.opdef import __OP_DEF__
+    for opdef in __OP_DEF__:
+        if opdef.name == name:
+            return opdef
+    raise ValueError("No tuned kernel " + name)
+
+
+def build_schedules(opdef, kwargs, target):
+    """Yields the kernels of every schedule of the op definition, with the name of the schedule"""
+    config_space = autotvm.ConfigSpace()
+    with autotvm.task.ApplyConfig(config_space):
+        opdef.func(fallback=False, **kwargs)
+    for i in range(len(config_space)):
+        with autotvm.task.ApplyConfig(config_space.get(i)):
+            sch, args = opdef.func(fallback=False, **kwargs)
+        yield "index_" + str(i), tvm.build(sch, args, target=target, binds=opdef.get_binds(args))
+
+
+def time_native(call, device, number, repeat):
+    """The time of the native operator on the call, in seconds"""
+    import mxnet as mx
+    ctx = mx.gpu(0) if device == "gpu" else mx.cpu()
+    inputs = [mx.nd.random.uniform(shape=s, ctx=ctx, dtype=call["dtype"]) for s in call["shapes"]]
+    kwargs = {k: call[k] for k in ("axis", "exclude") if k in call}
+    op = getattr(mx.nd, call["op"])
+    op(*inputs, **kwargs).wait_to_read()
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.time()
+        for _ in range(number):
+            out = op(*inputs, **kwargs)
+        out.wait_to_read()
+        best = min(best, (time.time() - start) / number)
+    return best
+
+
+def tune(call, device, target, number, repeat, compare_native):
+    """The tuning record of the call, None if the native operator is faster"""
+    args, attrs, outs = kernel_args(call)
+    if args is None:
+        logging.info("%s of shapes %s has too many dimensions, skipping it", call["op"], call["shapes"])
+        return None
+    prefix = "cuda_tuned_" if device == "gpu" else "tuned_"
+    opdef = find_opdef(prefix + call["op"])
+    kwargs = dict(attrs, dtype=call["dtype"], ndim=MAX_DIM)
+    ctx = tvm.context(target, 0)
+    inputs = args[:1] if call["op"] == "sum" else args
+    arrays = [tvm.nd.array(np.random.uniform(1, 2, size=s).astype(call["dtype"]), ctx) for s in inputs]
+    out = tvm.nd.empty(outs[0], call["dtype"], ctx)
+    # the reductions also take the output they add to, which is the output itself as in tuned.cc
+    arrays += [out, out] if call["op"] == "sum" else [out]
+    best_schedule, best_time = None, float("inf")
+    for schedule, func in build_schedules(opdef, kwargs, target):
+        timer = func.time_evaluator(func.entry_name, ctx, number=number, repeat=repeat)
+        cost = min(timer(*arrays).results)
+        logging.info("%s %s of shapes %s: %s takes %.2f us", call["op"], call["dtype"], args, schedule, cost * 1e6)
+        if cost < best_time:
+            best_schedule, best_time = schedule, cost
+    record = {"op": call["op"], "dtype": call["dtype"], "args": args, "schedule": best_schedule,
+              "time_us": best_time * 1e6}
+    if compare_native:
+        native_time = time_native(call, device, number, repeat)
+        record["native_time_us"] = native_time * 1e6
+        if native_time <= best_time:
+            logging.info("native %s of shapes %s is faster, skipping it", call["op"], call["shapes"])
+            return None
+    return record
+
+
+def get_arch(device, target, arch):
+    if arch:
+        return arch
+    if device == "cpu":
+        return platform.machine()
+    major, minor = tvm.context(target, 0).compute_version.split(".")
+    return "sm_" + major + minor
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.dirname(sys.path[0]))
+    parser = argparse.ArgumentParser(description="Tune tvm operators for the shapes of a workload")
+    parser.add_argument("workload", help="json file of the calls to tune")
+    parser.add_argument("-o", action="store", required=True, dest="log_path",
+                        help="path of the tuning log to write")
+    parser.add_argument("--device", choices=["cpu", "gpu"], default="cpu")
+    parser.add_argument("--target", default=None,
+                        help="TVM target of the kernels, e.g. 'llvm -mcpu=skylake-avx512'")
+    parser.add_argument("--arch", default=None,
+                        help="architecture the log applies to, by default platform.machine() on cpu "
+                             "and the sm_ of the gpu")
+    parser.add_argument("--number", type=int, default=100, help="runs of a schedule per measurement")
+    parser.add_argument("--repeat", type=int, default=3, help="measurements of a schedule")
+    parser.add_argument("--compare-native", action="store_true", dest="compare_native",
+                        help="only record the schedules faster than the native operators of mxnet")
+    arguments = parser.parse_args()
+
+    import tvmop  # registers the kernels
+    target = arguments.target or ("cuda" if arguments.device == "gpu" else "llvm")
+    with open(arguments.workload, "r") as f:
+        calls = json.load(f)
+    records = []
+    for call in calls:
+        record = tune(call, arguments.device, target, arguments.number, arguments.repeat,
+                      arguments.compare_native)
+        if record is not None:
+            records.append(record)
+    log = {"device": arguments.device, "arch": get_arch(arguments.device, target, arguments.arch),
+           "target": target, "records": records}
+    with open(arguments.log_path, "w") as f:
+        json.dump(log, f, indent=2)
+    logging.info("%d of %d calls tuned, written to %s", len(records), len(calls), arguments.log_path)
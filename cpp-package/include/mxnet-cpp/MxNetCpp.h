@@ -38,5 +38,6 @@
 #include "mxnet-cpp/metric.h"
 #include "mxnet-cpp/initializer.h"
 #include "mxnet-cpp/contrib.h"
+#include "mxnet-cpp/inference.hpp"
 
 #endif  // MXNET_CPP_MXNETCPP_H_
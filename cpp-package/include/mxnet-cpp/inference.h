@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference.h
+ * \brief serving of the models written by HybridBlock.export_compiled
+ */
+
+#ifndef MXNET_CPP_INFERENCE_H_
+#define MXNET_CPP_INFERENCE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "mxnet-cpp/base.h"
+#include "mxnet-cpp/ndarray.h"
+#include "mxnet-cpp/symbol.h"
+
+namespace mxnet {
+namespace cpp {
+
+/*!
+* \brief A model exported by HybridBlock.export_compiled, served through thread safe cached ops.
+*
+*  The file is loaded once, the graph is created from the symbol stored with the parameters and
+*  the parameters are bound to the cached ops, so a request only pushes the forward pass of its
+*  inputs. Forward and ForwardAsync may be called from any number of threads.
+*/
+class InferenceModel {
+ public:
+  /*!
+  * \brief called with the outputs of a request, or with the error the request failed with
+  */
+  typedef std::function<void(const std::vector<NDArray> &outputs,
+                             const std::string &error)> Callback;
+  /*!
+  * \brief load a model
+  * \param fname the file written by HybridBlock.export_compiled
+  * \param context the device to serve the model on
+  * \param num_cached_ops the number of cached ops the threads calling Forward are spread over.
+  *  The forward passes of a cached op are pushed one at a time.
+  * \param flags the flags of the cached ops, which override those the model was exported with
+  */
+  InferenceModel(const std::string &fname, const Context &context, int num_cached_ops = 1,
+                 const std::map<std::string, std::string> &flags =
+                     std::map<std::string, std::string>());
+  /*!
+  * \brief wait for the requests of ForwardAsync, then free the cached ops
+  */
+  ~InferenceModel();
+  /*!
+  * \return the names of the data inputs, in the order Forward takes them
+  */
+  const std::vector<std::string> &DataNames() const { return data_names_; }
+  /*!
+  * \brief wrap memory owned by the caller as an input, without copying it. The memory must be
+  *  on the device of the model and stay valid until the outputs of the request are read.
+  * \param data the memory of the input
+  * \param shape the shape of the input
+  * \param dtype the type of the input, 0 for float32, as the dtype of NDArray
+  */
+  NDArray WrapInput(void *data, const std::vector<mx_uint> &shape, int dtype = 0) const;
+  /*!
+  * \brief run the model and wait for its outputs
+  * \param data the data inputs, in the order of DataNames
+  */
+  std::vector<NDArray> Forward(const std::vector<NDArray> &data);
+  /*!
+  * \brief run the model and return once the forward pass is pushed. The callback is called
+  *  from a thread of the model when the outputs are computed, one callback at a time.
+  * \param data the data inputs, in the order of DataNames
+  * \param callback called with the outputs of the request
+  */
+  void ForwardAsync(const std::vector<NDArray> &data, Callback callback);
+  /*!
+  * \brief batch the concurrent requests of the cached ops along the first axis of the data
+  *  inputs, before the first request
+  * \param max_batch the maximum number of rows of a batch
+  * \param timeout_us the maximum time a request waits for the other requests of its batch
+  */
+  void EnableBatching(uint32_t max_batch, uint32_t timeout_us);
+
+ private:
+  InferenceModel(const InferenceModel &);
+  InferenceModel &operator=(const InferenceModel &);
+  /*! \brief push the forward pass of a request */
+  std::vector<NDArray> Invoke(const std::vector<NDArray> &data);
+  /*! \brief wait for the outputs of the requests of ForwardAsync and call their callbacks */
+  void CompleteRequests();
+
+  Context context_;
+  std::vector<std::string> data_names_;
+  /*! \brief the position of each data input among the inputs of the cached ops */
+  std::vector<size_t> data_slots_;
+  /*! \brief the inputs of the cached ops, the data inputs of which are set by each request */
+  std::vector<NDArray> inputs_;
+  bool np_shape_;
+  std::vector<CachedOpHandle> cached_ops_;
+  std::vector<CachedOpBatcherHandle> batchers_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::pair<std::vector<NDArray>, Callback>> pending_;
+  bool stop_;
+  std::thread completion_thread_;
+};
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_H_
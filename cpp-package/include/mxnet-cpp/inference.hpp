@@ -0,0 +1,293 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference.hpp
+ * \brief implementation of the serving of the models written by HybridBlock.export_compiled
+ */
+
+#ifndef MXNET_CPP_INFERENCE_HPP_
+#define MXNET_CPP_INFERENCE_HPP_
+
+#include <dlpack/dlpack.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dmlc/json.h"
+#include "dmlc/logging.h"
+#include "mxnet-cpp/inference.h"
+#include "mxnet-cpp/ndarray.hpp"
+#include "mxnet-cpp/symbol.hpp"
+
+namespace mxnet {
+namespace cpp {
+
+namespace inference_detail {
+
+/*! \brief reads back a string stored with the parameters by gluon.utils._string_to_array */
+inline std::string ArrayToString(const NDArray &array) {
+  std::string str(array.Size(), '\0');
+  CHECK_EQ(MXNDArraySyncCopyToCPU(array.GetHandle(), &str[0], str.size()), 0)
+      << MXGetLastError();
+  return str;
+}
+
+inline DLDataType DTypeToDLPack(int dtype) {
+  switch (dtype) {
+    case 0: return DLDataType{kDLFloat, 32, 1};
+    case 1: return DLDataType{kDLFloat, 64, 1};
+    case 2: return DLDataType{kDLFloat, 16, 1};
+    case 3: return DLDataType{kDLUInt, 8, 1};
+    case 4: return DLDataType{kDLInt, 32, 1};
+    case 5: return DLDataType{kDLInt, 8, 1};
+    case 6: return DLDataType{kDLInt, 64, 1};
+    case 7: return DLDataType{kDLUInt, 1, 1};
+    default: LOG(FATAL) << "Unsupported dtype " << dtype << " of an input";
+  }
+  return DLDataType();
+}
+
+/*! \brief the flags of the thread safe cached op, the other flags of hybridize are dropped */
+inline bool IsThreadSafeCachedOpFlag(const std::string &key) {
+  return key == "static_alloc" || key == "static_shape" || key == "share_static_alloc" ||
+         key == "forward_bulk_size";
+}
+
+inline std::string IndicesToString(const std::vector<size_t> &indices) {
+  std::ostringstream os;
+  os << '[';
+  for (size_t i = 0; i < indices.size(); ++i)
+    os << (i ? "," : "") << indices[i];
+  os << ']';
+  return os.str();
+}
+
+}  // namespace inference_detail
+
+inline InferenceModel::InferenceModel(const std::string &fname, const Context &context,
+                                      int num_cached_ops,
+                                      const std::map<std::string, std::string> &flags)
+    : context_(context), np_shape_(false), stop_(false) {
+  CHECK_GT(num_cached_ops, 0) << "An InferenceModel needs at least one cached op";
+  uint32_t out_size, out_name_size;
+  NDArrayHandle *out_arr;
+  const char **out_names;
+  if (context.GetDeviceType() == DeviceType::kGPU) {
+    CHECK_EQ(MXNDArrayLoadToContext(fname.c_str(), context.GetDeviceType(),
+                                    context.GetDeviceId(), &out_size, &out_arr,
+                                    &out_name_size, &out_names), 0)
+        << MXGetLastError();
+  } else {
+    // the parameters are served from the mapped file
+    CHECK_EQ(MXNDArrayLoadMMap(fname.c_str(), &out_size, &out_arr, &out_name_size,
+                               &out_names), 0)
+        << MXGetLastError();
+  }
+  CHECK_EQ(out_name_size, out_size) << fname << " was not written by export_compiled";
+  std::map<std::string, NDArray> arrays;
+  for (uint32_t i = 0; i < out_size; ++i)
+    arrays[out_names[i]] = NDArray(out_arr[i]);
+  CHECK(arrays.count("__symbol__") && arrays.count("__cached_op__"))
+      << fname << " was not written by export_compiled";
+
+  std::map<std::string, std::string> exported_flags;
+  int np_shape = 0;
+  {
+    std::istringstream is(inference_detail::ArrayToString(arrays["__cached_op__"]));
+    dmlc::JSONReader reader(&is);
+    dmlc::JSONObjectReadHelper helper;
+    helper.DeclareField("data_names", &data_names_);
+    helper.DeclareField("np_shape", &np_shape);
+    helper.DeclareField("flags", &exported_flags);
+    helper.ReadAllFields(&reader);
+  }
+  np_shape_ = np_shape != 0;
+  Symbol symbol = Symbol::LoadJSON(inference_detail::ArrayToString(arrays["__symbol__"]));
+
+  // the inputs of the cached ops in the order of the inputs of the graph
+  std::vector<size_t> param_slots;
+  data_slots_.assign(data_names_.size(), 0);
+  const std::vector<std::string> input_names = symbol.ListInputs();
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    const std::string &name = input_names[i];
+    auto data = std::find(data_names_.begin(), data_names_.end(), name);
+    if (data != data_names_.end()) {
+      data_slots_[data - data_names_.begin()] = i;
+      inputs_.push_back(NDArray());
+      continue;
+    }
+    auto param = arrays.find("arg:" + name);
+    if (param == arrays.end())
+      param = arrays.find("aux:" + name);
+    CHECK(param != arrays.end()) << "Parameter " << name << " is missing from " << fname;
+    param_slots.push_back(i);
+    inputs_.push_back(param->second);
+  }
+  CHECK_EQ(input_names.size() - param_slots.size(), data_names_.size())
+      << "Data inputs of " << fname << " are missing from its graph";
+
+  std::map<std::string, std::string> op_flags;
+  for (const auto &kv : exported_flags) {
+    if (inference_detail::IsThreadSafeCachedOpFlag(kv.first))
+      op_flags[kv.first] = kv.second;
+  }
+  for (const auto &kv : flags)
+    op_flags[kv.first] = kv.second;
+  std::vector<size_t> data_indices(data_slots_.begin(), data_slots_.end());
+  std::sort(data_indices.begin(), data_indices.end());
+  op_flags["data_indices"]  = inference_detail::IndicesToString(data_indices);
+  op_flags["param_indices"] = inference_detail::IndicesToString(param_slots);
+  std::vector<const char *> keys, vals;
+  for (const auto &kv : op_flags) {
+    keys.push_back(kv.first.c_str());
+    vals.push_back(kv.second.c_str());
+  }
+  for (int i = 0; i < num_cached_ops; ++i) {
+    CachedOpHandle handle;
+    CHECK_EQ(MXCreateCachedOp(symbol.GetHandle(), keys.size(), keys.data(), vals.data(),
+                              &handle, true), 0)
+        << MXGetLastError();
+    cached_ops_.push_back(handle);
+  }
+  completion_thread_ = std::thread(&InferenceModel::CompleteRequests, this);
+}
+
+inline InferenceModel::~InferenceModel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  completion_thread_.join();
+  for (CachedOpBatcherHandle batcher : batchers_)
+    MXFreeCachedOpBatcher(batcher);
+  for (CachedOpHandle handle : cached_ops_)
+    MXFreeCachedOp(handle);
+}
+
+inline NDArray InferenceModel::WrapInput(void *data, const std::vector<mx_uint> &shape,
+                                         int dtype) const {
+  std::vector<int64_t> dl_shape(shape.begin(), shape.end());
+  // the array copies the tensor and its shape, and leaves the memory to the caller
+  DLManagedTensor tensor;
+  tensor.dl_tensor.data        = data;
+  tensor.dl_tensor.ctx         = DLContext{context_.GetDeviceType() == DeviceType::kGPU ?
+                                           kDLGPU : kDLCPU, context_.GetDeviceId()};
+  tensor.dl_tensor.ndim        = static_cast<int>(dl_shape.size());
+  tensor.dl_tensor.dtype       = inference_detail::DTypeToDLPack(dtype);
+  tensor.dl_tensor.shape       = dl_shape.data();
+  tensor.dl_tensor.strides     = nullptr;
+  tensor.dl_tensor.byte_offset = 0;
+  tensor.manager_ctx           = nullptr;
+  tensor.deleter               = nullptr;
+  NDArrayHandle handle;
+  CHECK_EQ(MXNDArrayFromDLPack(&tensor, true, &handle), 0) << MXGetLastError();
+  return NDArray(handle);
+}
+
+inline void InferenceModel::EnableBatching(uint32_t max_batch, uint32_t timeout_us) {
+  CHECK(batchers_.empty()) << "Batching of the InferenceModel is already enabled";
+  for (CachedOpHandle handle : cached_ops_) {
+    CachedOpBatcherHandle batcher;
+    CHECK_EQ(MXCreateCachedOpBatcher(handle, max_batch, timeout_us, &batcher), 0)
+        << MXGetLastError();
+    batchers_.push_back(batcher);
+  }
+}
+
+inline std::vector<NDArray> InferenceModel::Invoke(const std::vector<NDArray> &data) {
+  CHECK_EQ(data.size(), data_names_.size()) << "The model takes " << data_names_.size()
+                                            << " data inputs";
+  std::vector<NDArrayHandle> inputs;
+  inputs.reserve(inputs_.size());
+  for (const NDArray &input : inputs_)
+    inputs.push_back(input.GetHandle());
+  for (size_t i = 0; i < data.size(); ++i)
+    inputs[data_slots_[i]] = data[i].GetHandle();
+  // the threads calling the model are spread over the cached ops
+  const size_t op = std::hash<std::thread::id>()(std::this_thread::get_id()) % cached_ops_.size();
+  int prev_np_shape;
+  CHECK_EQ(MXSetIsNumpyShape(np_shape_ ? 1 : 0, &prev_np_shape), 0);
+  int num_outputs       = 0;
+  NDArrayHandle *outs   = nullptr;
+  const int *out_stypes = nullptr;
+  int ret;
+  if (batchers_.empty()) {
+    ret = MXInvokeCachedOp(cached_ops_[op], inputs.size(), inputs.data(),
+                           context_.GetDeviceType(), context_.GetDeviceId(), &num_outputs, &outs,
+                           &out_stypes);
+  } else {
+    ret = MXInvokeCachedOpBatcher(batchers_[op], inputs.size(), inputs.data(), &num_outputs,
+                                  &outs, &out_stypes);
+  }
+  std::string error = ret == 0 ? std::string() : MXGetLastError();
+  int np_shape;
+  MXSetIsNumpyShape(prev_np_shape, &np_shape);
+  CHECK_EQ(ret, 0) << error;
+  std::vector<NDArray> outputs;
+  for (int i = 0; i < num_outputs; ++i)
+    outputs.push_back(NDArray(outs[i]));
+  return outputs;
+}
+
+inline std::vector<NDArray> InferenceModel::Forward(const std::vector<NDArray> &data) {
+  std::vector<NDArray> outputs = Invoke(data);
+  for (const NDArray &output : outputs)
+    CHECK_EQ(MXNDArrayWaitToRead(output.GetHandle()), 0) << MXGetLastError();
+  return outputs;
+}
+
+inline void InferenceModel::ForwardAsync(const std::vector<NDArray> &data, Callback callback) {
+  std::vector<NDArray> outputs = Invoke(data);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.emplace_back(std::move(outputs), std::move(callback));
+  }
+  cond_.notify_one();
+}
+
+inline void InferenceModel::CompleteRequests() {
+  while (true) {
+    std::pair<std::vector<NDArray>, Callback> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+      if (pending_.empty())
+        return;
+      request = std::move(pending_.front());
+      pending_.pop_front();
+    }
+    std::string error;
+    for (const NDArray &output : request.first) {
+      if (MXNDArrayWaitToRead(output.GetHandle()) != 0) {
+        error = MXGetLastError();
+        break;
+      }
+    }
+    request.second(request.first, error);
+  }
+}
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_HPP_
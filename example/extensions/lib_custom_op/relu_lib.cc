@@ -74,10 +74,18 @@ MXReturnValue backwardCPU(const std::unordered_map<std::string, std::string>& at
   return MX_SUCCESS;
 }
 
+MXReturnValue inplace(const std::unordered_map<std::string, std::string>& attrs,
+                      std::vector<std::pair<int, int>>* inplace_pairs) {
+  // relu is element-wise, so the output can be computed in the memory of the input
+  inplace_pairs->push_back({0, 0});
+  return MX_SUCCESS;
+}
+
 REGISTER_OP(my_relu)
 .setParseAttrs(parseAttrs)
 .setInferType(inferType)
 .setInferShape(inferShape)
+.setInplace(inplace)
 .setForward(forwardCPU, "cpu")
 .setForward(forwardGPU, "gpu")
 .setBackward(backwardCPU, "cpu")
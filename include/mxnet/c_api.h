@@ -64,12 +64,16 @@ typedef int64_t dim_t;
 // these typedefs are mainly used for readablity reasons
 /*! \brief handle to NDArray */
 typedef void *NDArrayHandle;
+/*! \brief handle to a pending copy of a NDArray to CPU memory */
+typedef void *NDArrayCopyHandle;
 /*! \brief handle to a mxnet narray function that changes NDArray */
 typedef const void *FunctionHandle;
 /*! \brief handle to a function that takes param and creates symbol */
 typedef void *AtomicSymbolCreator;
 /*! \brief handle to cached operator */
 typedef void *CachedOpHandle;
+/*! \brief handle to the dynamic batching of the requests of a cached operator */
+typedef void *CachedOpBatcherHandle;
 /*! \brief handle to a symbol that can be bind as operator */
 typedef void *SymbolHandle;
 /*! \brief handle to a AtomicSymbol */
@@ -168,7 +172,9 @@ struct LibFeature {
 enum CustomOpCallbacks {
   kCustomOpDelete,
   kCustomOpForward,
-  kCustomOpBackward
+  kCustomOpBackward,
+  kCustomOpForwardAsync,
+  kCustomOpBackwardAsync
 };
 
 enum CustomOpPropCallbacks {
@@ -188,6 +194,14 @@ enum CustomOpPropCallbacks {
 typedef int (*CustomOpFBFunc)(int /*size*/, void** /*ptrs*/, int* /*tags*/,
                               const int* /*reqs*/, const int /*is_train*/,
                               void* /*state*/);
+/*!
+ * \brief an async forward or backward: it returns when the op has started, and the op is done
+ *  when MXCustomOpComplete is called with on_complete, from any thread. If it fails, it must
+ *  not call MXCustomOpComplete.
+ */
+typedef int (*CustomOpFBAsyncFunc)(int /*size*/, void** /*ptrs*/, int* /*tags*/,
+                                   const int* /*reqs*/, const int /*is_train*/,
+                                   void* /*on_complete*/, void* /*state*/);
 typedef int (*CustomOpDelFunc)(void* /*state*/);
 typedef int (*CustomOpListFunc)(char*** /*args*/, void* /*state*/);
 typedef int (*CustomOpInferShapeFunc)(int /*num_input*/, int* /*ndims*/,
@@ -271,6 +285,34 @@ MXNET_DLL int MXRandomSeed(int seed);
  */
 MXNET_DLL int MXRandomSeedContext(int seed, int dev_type, int dev_id);
 
+/*!
+ * \brief Create the unique id of the NCCL communicators of the operators, e.g.
+ *  the NCCL synchronized batch norm, on one of the processes, which sends it to the others.
+ * \param out the buffer of the id, of size bytes.
+ * \param size the size of out, at least NCCL_UNIQUE_ID_BYTES (128).
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXNCCLGetUniqueId(char* out, int size);
+
+/*!
+ * \brief Create the NCCL communicators of the operators on the GPUs of this process,
+ *  which are the ranks first_rank, ..., first_rank + num_devices - 1 of all the processes.
+ *  Every process calls it with the same id.
+ * \param unique_id the id of MXNCCLGetUniqueId.
+ * \param size the size of unique_id.
+ * \param num_ranks the number of the GPUs of all the processes.
+ * \param first_rank the rank of the first GPU of this process.
+ * \param num_devices the number of the GPUs of this process.
+ * \param dev_ids the GPUs of this process.
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXNCCLInitComms(const char* unique_id,
+                              int size,
+                              int num_ranks,
+                              int first_rank,
+                              int num_devices,
+                              const int* dev_ids);
+
 /*!
  * \brief Change floating-point calculations when dealing with denormalized values.
  * Currently this option is only supported in CPU backend.
@@ -490,6 +532,56 @@ MXNET_DLL int MXProfileSetMarker(ProfileHandle domain,
                                  const char *instant_marker_name,
                                  const char *scope);
 
+/*!
+ * \brief Set every how many operator executions the latency of one is sampled, independently
+ *        of the state of the profiler
+ * \param sample_rate Sample one in sample_rate operator executions, 0 to disable sampling
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXProfileSetSampleRate(int sample_rate);
+
+/*!
+ * \brief Print the rolling latency percentiles of the sampled operator executions to a string
+ * \param out_str will receive a pointer to the output string, in json format
+ * \param reset clear the sampled latencies after printing
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXProfileScrapeSampledStats(const char **out_str, int reset);
+
+/*!
+ * \brief Begin a traced request on the calling thread. The engine operators pushed until
+ *        MXRequestTraceEnd, for example by MXInvokeCachedOp, and the operators they push are
+ *        tagged with the trace, and the request is exported when it ends slower than the
+ *        threshold set by MXRequestTraceSetConfig
+ * \param traceparent W3C traceparent of the caller, or NULL to start a new trace
+ * \param out_trace_id will receive a pointer to the 32 hex digits of the trace
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceBegin(const char *traceparent, const char **out_trace_id);
+
+/*!
+ * \brief End the traced request of the calling thread. The request itself ends when its
+ *        operators complete
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceEnd();
+
+/*!
+ * \brief Set from which latency and where the traced requests are exported
+ * \param threshold_ms latency in milliseconds from which a traced request is exported
+ * \param filename file the spans are appended to, one request per line of OTLP/JSON
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceSetConfig(double threshold_ms, const char *filename);
+
+/*!
+ * \brief Print the metrics of the engine, the memory pools, the kvstore and the operators
+ *        to a string in the OpenMetrics text format, for scraping by Prometheus
+ * \param out_str will receive a pointer to the output string
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXGetOpenMetrics(const char **out_str);
+
 /*!
  * \brief Set the number of OMP threads to use
  * \param thread_num Number of OMP threads desired
@@ -504,6 +596,40 @@ MXNET_DLL int MXSetNumOMPThreads(int thread_num);
  */
 MXNET_DLL int MXEngineSetBulkSize(int bulk_size, int* prev_bulk_size);
 
+/*!
+ * \brief set the priority added to all operations pushed from the calling thread,
+ *  e.g. every operation of a CachedOp invoked from this thread.
+ *  Operations with higher priority run first when MXNET_ENGINE_PRIORITY_SCHEDULING is set.
+ * \param priority new thread priority
+ * \param prev_priority previous thread priority
+ */
+MXNET_DLL int MXEngineSetThreadPriority(int priority, int* prev_priority);
+
+/*!
+ * \brief get the counters of adaptive bulking (MXNET_ENGINE_ADAPTIVE_BULK)
+ * \param num_merged number of operations merged into adaptive bulks
+ * \param num_bulks number of adaptive bulks pushed to execution
+ * \param num_timed number of operations pushed alone and timed
+ */
+MXNET_DLL int MXEngineGetAdaptiveBulkStats(uint64_t* num_merged,
+                                           uint64_t* num_bulks,
+                                           uint64_t* num_timed);
+
+/*!
+ * \brief start or stop a round of the operator tape of the calling thread, the operations
+ *  pushed in a round reuse the engine operators of the same positions of the previous round.
+ * \param mode 1 starts a round, 0 stops it, -1 stops it and frees the recorded operators
+ * \param prev_running whether a round was running
+ */
+MXNET_DLL int MXEngineSetTape(int mode, int* prev_running);
+
+/*!
+ * \brief get the counters of the operator tapes
+ * \param num_reused number of operations which reused a recorded operator
+ * \param num_recorded number of operators recorded
+ */
+MXNET_DLL int MXEngineGetTapeStats(uint64_t* num_reused, uint64_t* num_recorded);
+
 /*!
  * \brief Get the number of GPUs.
  * \param pointer to int that will hold the number of GPUs available.
@@ -570,6 +696,16 @@ typedef struct ConfigSpaces {
 } ConfigSpaces;
 
 MXNET_DLL int MXLoadTVMConfig(ConfigSpaces config);
+
+/*!
+ * \brief Load the schedules of TVM operator kernels tuned for the shapes of the inputs of native
+ *  operators, which then run the tuned kernels for these shapes
+ * \param num the number of schedules
+ * \param keys the operator, device, dtype and kernel argument shapes of each schedule
+ * \param schedules the kernel schedule of each key
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXLoadTVMOpTuning(int num, const char** keys, const char** schedules);
 #endif  // MXNET_USE_TVM_OP
 
 
@@ -738,6 +874,26 @@ MXNET_DLL int MXNDArraySave(const char* fname,
                             uint32_t num_args,
                             NDArrayHandle* args,
                             const char** keys);
+/*!
+ * \brief Save list of narray into the file like MXNDArraySave, without blocking.
+ *
+ *  The arrays of GPUs are copied to the CPU after their pending writes, then the file is written on
+ *  a thread of its own. Until it is written, the engine holds back the writes to the saved arrays
+ *  of the CPU.
+ *
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \param out the handle of the pending save, polled with MXNDArrayCopyIsDone, waited for with
+ *  MXNDArrayCopyWait, which rethrows the errors of the save, and freed with MXNDArrayCopyFree
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveAsync(const char* fname,
+                                 uint32_t num_args,
+                                 NDArrayHandle* args,
+                                 const char** keys,
+                                 NDArrayCopyHandle *out);
 /*!
  * \brief Load list of narray from the file.
  * \param fname name of the file.
@@ -752,6 +908,66 @@ MXNET_DLL int MXNDArrayLoad(const char* fname,
                             NDArrayHandle** out_arr,
                             uint32_t *out_name_size,
                             const char*** out_names);
+/*!
+ * \brief Load list of narray from the file, like MXNDArrayLoad, but the dense arrays of npz and
+ *  npy files saved by MXNDArraySave are copy-on-write views of the file mapped in memory, which
+ *  processes loading the same file share until they write to the arrays. The other arrays and
+ *  the files of the legacy format are read.
+ * \param fname name of the file, on the local filesystem.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadMMap(const char* fname,
+                                uint32_t *out_size,
+                                NDArrayHandle** out_arr,
+                                uint32_t *out_name_size,
+                                const char*** out_names);
+/*!
+ * \brief Load list of narray from the file directly to a device. The file is mapped as by
+ *  MXNDArrayLoadMMap, and the dense arrays are copied to a GPU in chunks through pinned staging
+ *  buffers, reading the file and copying to the GPU concurrently, without reading the arrays to
+ *  host arrays first.
+ * \param fname name of the file, on the local filesystem.
+ * \param dev_type device type of the loaded arrays.
+ * \param dev_id device id of the loaded arrays.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadToContext(const char* fname,
+                                     int dev_type,
+                                     int dev_id,
+                                     uint32_t *out_size,
+                                     NDArrayHandle** out_arr,
+                                     uint32_t *out_name_size,
+                                     const char*** out_names);
+/*!
+ * \brief Load list of narray from the file to a device lazily. The file is mapped as by
+ *  MXNDArrayLoadMMap, and the memory of the dense arrays on a GPU is only allocated and copied
+ *  from the mapped file when they are first used. Until they are written, the spill manager may
+ *  free their memory under memory pressure, see MXNET_GPU_SPILL_BUDGET, and they are copied from
+ *  the file again when they are used next. The arrays loaded to the CPU are the mapped ones.
+ * \param fname name of the file, on the local filesystem.
+ * \param dev_type device type of the loaded arrays.
+ * \param dev_id device id of the loaded arrays.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadLazy(const char* fname,
+                                int dev_type,
+                                int dev_id,
+                                uint32_t *out_size,
+                                NDArrayHandle** out_arr,
+                                uint32_t *out_name_size,
+                                const char*** out_names);
 
 /*!
  * \brief Load list / dictionary of narrays from file content loaded into memory.
@@ -802,6 +1018,42 @@ MXNET_DLL int MXNDArraySyncCopyFromCPU(NDArrayHandle handle,
 MXNET_DLL int MXNDArraySyncCopyToCPU(NDArrayHandle handle,
                                      void *data,
                                      size_t size);
+/*!
+ * \brief Copy the data of a NDArray to a contiguous CPU memory region without blocking.
+ *
+ *  The copy is pushed to the engine after the pending writes to the array, and the memory region
+ *  must stay valid until it completes. The copies from a GPU overlap with the computation on the
+ *  GPU when the memory is page-locked, e.g. allocated with cudaHostAlloc.
+ *
+ * \param handle the NDArray handle
+ * \param data the memory region to copy into.
+ * \param size the memory size we want to copy into.
+ * \param out the handle of the pending copy, to free with MXNDArrayCopyFree
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayCopyToCPUAsync(NDArrayHandle handle,
+                                      void *data,
+                                      size_t size,
+                                      NDArrayCopyHandle *out);
+/*!
+ * \brief Check whether a copy of MXNDArrayCopyToCPUAsync has completed, without blocking.
+ * \param handle the handle of the copy
+ * \param out 1 when the copy has completed or failed, 0 otherwise
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayCopyIsDone(NDArrayCopyHandle handle, int *out);
+/*!
+ * \brief Block until a copy of MXNDArrayCopyToCPUAsync completes.
+ * \param handle the handle of the copy
+ * \return 0 when the copy succeeded, -1 when it or an operation it depends on failed
+ */
+MXNET_DLL int MXNDArrayCopyWait(NDArrayCopyHandle handle);
+/*!
+ * \brief Free the handle of a copy of MXNDArrayCopyToCPUAsync. A pending copy still completes.
+ * \param handle the handle of the copy
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayCopyFree(NDArrayCopyHandle handle);
 
 /*!
  * \brief Copy src.data() to dst.data() if i = -1, else dst.aux_data(i) if i >= 0
@@ -836,6 +1088,13 @@ MXNET_DLL int MXNDArrayWaitToRead(NDArrayHandle handle);
  * \return 0 when success, -1 when failure happens
  */
 MXNET_DLL int MXNDArrayWaitToWrite(NDArrayHandle handle);
+/*!
+ * \brief Allow the memory of a GPU NDArray to be spilled to the host while it is
+ *  not used, see MXNET_GPU_SPILL_BUDGET.
+ * \param handle the NDArray handle
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySetSpillable(NDArrayHandle handle);
 
 /*!
  * \brief wait until all delayed operations in
@@ -986,6 +1245,26 @@ MXNET_DLL int MXNDArrayGetData(NDArrayHandle handle,
 MXNET_DLL int MXNDArrayToDLPack(NDArrayHandle handle,
                                        DLManagedTensorHandle *out_dlpack);
 
+/*!
+* \brief Create a reference view of NDArray that represents as DLManagedTensor, which is safe to use
+*  on a CUDA stream of the consumer without waiting for the pending operations on the NDArray.
+*
+*  For an NDArray on GPU, the stream waits on the device for the pending writes, or the pending
+*  reads and writes with for_write, and the call returns without waiting. The stream follows the
+*  __dlpack__ protocol: 1 is the legacy default stream, 2 the per-thread default stream, -1 means
+*  no synchronization, and other values are a cudaStream_t. For other NDArrays, the call waits
+*  like MXNDArrayWaitToRead or MXNDArrayWaitToWrite and the stream is ignored.
+* \param handle the handle to the ndarray
+* \param stream the CUDA stream of the consumer
+* \param for_write whether the consumer writes to the tensor
+* \param out_dlpack pointer holder to get pointer of DLManagedTensor
+* \return 0 when success, -1 when failure happens
+*/
+MXNET_DLL int MXNDArrayToDLPackStream(NDArrayHandle handle,
+                                      int64_t stream,
+                                      const bool for_write,
+                                      DLManagedTensorHandle *out_dlpack);
+
 /*!
 * \brief Create a NDArray backed by a dlpack tensor.
 *
@@ -1359,7 +1638,10 @@ MXNET_DLL int MXCachedOpGetOptimizedSymbol(CachedOpHandle handle,
  * \param num_outputs number of output NDArrays
  * \param default_dev_type the default context type
  * \param default_dev_id the default context device id
- * \param outputs output NDArrays
+ * \param outputs output NDArrays. If *outputs is not NULL, the outputs are written in the
+ *  *num_outputs given arrays, e.g. external buffers wrapped by MXNDArrayFromDLPack. When the
+ *  cached op has static_alloc and static_shape, the arrays given again on the next inference
+ *  calls are bound to the memory plan and written by the bulked operations.
  * \param out_stypes output ndarrays' stypes
  * \return 0 when success, -1 when failure happens
  */
@@ -1372,6 +1654,48 @@ MXNET_DLL int MXInvokeCachedOp(CachedOpHandle handle,
                                NDArrayHandle **outputs,
                                const int** out_stypes);
 
+/*!
+ * \brief create the dynamic batching of the concurrent requests of a thread safe cached op
+ *
+ *  The data inputs of the requests are concatenated along their first axis, padded to a power
+ *  of two rows or to max_batch, and run as one forward pass when max_batch rows are queued or
+ *  timeout_us microseconds after the oldest request.
+ * \param handle the handle to the cached op, created with thread_safe
+ * \param max_batch the maximum number of rows of a batch
+ * \param timeout_us the maximum time a request waits for the other requests of its batch
+ * \param out the handle to the batcher
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                                      uint32_t max_batch,
+                                      uint32_t timeout_us,
+                                      CachedOpBatcherHandle *out);
+
+/*!
+ * \brief free the dynamic batching of a cached op, after its requests returned
+ */
+MXNET_DLL int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle);
+
+/*!
+ * \brief invoke a cached op as part of a batch of requests, from any thread
+ *
+ *  The call returns once the batch is pushed to the engine, with views of the rows of the
+ *  outputs of the batch of the request.
+ * \param handle the handle to the batcher
+ * \param num_inputs number of input NDArrays
+ * \param inputs input NDArrays, the data inputs of which have the same number of rows
+ * \param num_outputs number of output NDArrays
+ * \param outputs output NDArrays
+ * \param out_stypes output ndarrays' stypes
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXInvokeCachedOpBatcher(CachedOpBatcherHandle handle,
+                                      int num_inputs,
+                                      NDArrayHandle *inputs,
+                                      int *num_outputs,
+                                      NDArrayHandle **outputs,
+                                      const int** out_stypes);
+
 /*!
  * \brief cached op set monitor callback
  */
@@ -1557,6 +1881,14 @@ MXNET_DLL int MXSymbolCreateFromJSON(const char *json, SymbolHandle *out);
  * \return 0 when success, -1 when failure happens
  */
 MXNET_DLL int MXSymbolRemoveAmpCast(SymbolHandle sym_handle, SymbolHandle* ret_sym_handle);
+/*!
+ * \brief Remove the operators copying their input at inference: BlockGrad, _copy, and the
+ *  Dropouts whose masks are not read
+ * \param sym_handle the input symbol.
+ * \param ret_sym_handle the output symbol.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSymbolPruneForInference(SymbolHandle sym_handle, SymbolHandle* ret_sym_handle);
 /*!
  * \brief Save a symbol into a json file.
  * \param symbol the input symbol.
@@ -2016,6 +2348,36 @@ MXNET_DLL int MXQuantizeSymbol(SymbolHandle sym_handle,
                                const char *quantize_mode, const char *quantize_granularity,
                                uint32_t* out_num_calib_names, const char ***out_calib_names);
 
+/*!
+ * \brief Convert a symbol into a symbol for quantization-aware training, where the inputs that
+ *  MXQuantizeSymbol would quantize are fake quantized with learnable scales
+ * \param sym_handle symbol to be converted
+ * \param ret_sym_handle fake quantized symbol result
+ * \param dev_type device type the trained model will be quantized for
+ * \param num_excluded_sym_names number of layers excluded from being quantized in the input symbol
+ * \param excluded_sym_names node names to be excluded from being quantized
+ * \param num_excluded_op_names number of operators excluded from being quantized in the input symbol
+ * \param excluded_op_names operator names to be excluded from being quantized
+ * \param quantized_dtype the quantized destination type for input data
+ * \param quantize_mode quantize mode to be used in quantize pass
+ * \param quantize_granularity quantize granularity, tensor-wise or channel-wise
+ * \param out_num_entry_names return the number of fake quantized entries
+ * \param out_entry_names return the names of the fake quantized entries, the scale of an entry
+ *  is the variable named with its name and the suffix _fq_scale
+ */
+MXNET_DLL int MXFakeQuantizeSymbol(SymbolHandle sym_handle,
+                                   SymbolHandle *ret_sym_handle,
+                                   const int* dev_type,
+                                   const uint32_t num_excluded_sym_names,
+                                   const char **excluded_sym_names,
+                                   const uint32_t num_excluded_op_names,
+                                   const char **excluded_op_names,
+                                   const char *quantized_dtype,
+                                   const char *quantize_mode,
+                                   const char *quantize_granularity,
+                                   uint32_t* out_num_entry_names,
+                                   const char ***out_entry_names);
+
 /*!
  * \brief Convert a symbol into a mixed precision symbol with cast operators for target dtype casting
  * \param sym_handle symbol to be converted
@@ -2472,6 +2834,45 @@ MXNET_DLL int MXKVStoreInitEx(KVStoreHandle handle,
                               const char** keys,
                               NDArrayHandle* vals);
 
+/*!
+ * \brief Init a row_sparse key of shape (num_ids, dim) whose rows are stored in hash
+ *  tables, and are pushed and pulled by the 64-bit ids of the features
+ * \param handle handle to the kvstore
+ * \param key the key
+ * \param num_ids the number of ids, the first dimension of the key
+ * \param dim the size of the rows
+ * \param num_params the number of params of the hash tables
+ * \param param_keys the names of the params, of HashEmbeddingParam
+ * \param param_vals the values of the params
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXKVStoreInitHashEmbedding(KVStoreHandle handle,
+                                         int key,
+                                         int64_t num_ids,
+                                         int64_t dim,
+                                         uint32_t num_params,
+                                         const char** param_keys,
+                                         const char** param_vals);
+
+/*!
+ * \brief Init a row_sparse key stored in hash tables, where the key is a string
+ * \param handle handle to the kvstore
+ * \param key the key
+ * \param num_ids the number of ids, the first dimension of the key
+ * \param dim the size of the rows
+ * \param num_params the number of params of the hash tables
+ * \param param_keys the names of the params, of HashEmbeddingParam
+ * \param param_vals the values of the params
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXKVStoreInitHashEmbeddingEx(KVStoreHandle handle,
+                                           const char* key,
+                                           int64_t num_ids,
+                                           int64_t dim,
+                                           uint32_t num_params,
+                                           const char** param_keys,
+                                           const char** param_vals);
+
 /*!
  * \brief Push a list of (key,value) pairs to kvstore
  * \param handle handle to the kvstore
@@ -2954,6 +3355,12 @@ MXNET_DLL int MXRtcFree(RtcHandle handle);
  * \param creator
  */
 MXNET_DLL int MXCustomOpRegister(const char* op_type, CustomOpPropCreator creator);
+/*
+ * \brief complete an async forward or backward of a custom op.
+ * \param on_complete the completion given to the async forward or backward, called once.
+ * \param error the message of the error of the op, NULL if it succeeded.
+ */
+MXNET_DLL int MXCustomOpComplete(void* on_complete, const char* error);
 /*
  * \brief record custom function for backward later.
  * \param num_inputs number of input NDArrays.
@@ -3034,6 +3441,14 @@ MXNET_DLL int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid,
  */
 MXNET_DLL int MXStorageEmptyCache(int dev_type, int dev_id);
 
+/*!
+ * \brief Get the usage statistics of the devices memory pool as a JSON string
+ * \param dev_type device type, specify device we want to take
+ * \param dev_id the device id of the specific device
+ * \param out_json the statistics, valid until the next call on this thread
+ */
+MXNET_DLL int MXStorageGetPoolStats(int dev_type, int dev_id, const char** out_json);
+
 /*!
  * \brief Reconstruct NDArray from shared memory handle
  * \param shared_pid shared PID
@@ -3046,6 +3461,35 @@ MXNET_DLL int MXStorageEmptyCache(int dev_type, int dev_id);
 MXNET_DLL int MXNDArrayCreateFromSharedMem(int shared_pid, int shared_id, const int *shape,
                                            int ndim, int dtype, NDArrayHandle *out);
 
+/*!
+ * \brief Get the CUDA IPC handle of the memory of a GPU NDArray, so that other processes on the
+ *  host can read it without a copy. The exporting process must keep the NDArray alive and must
+ *  not write to it while the other processes use the memory.
+ * \param handle NDArray handle, of a dense array on a GPU.
+ * \param ipc_handle output buffer of 64 bytes for the cudaIpcMemHandle_t of the allocation
+ *  holding the array.
+ * \param offset output offset in bytes of the array in the allocation.
+ * \param dev_id output id of the GPU of the array.
+ */
+MXNET_DLL int MXNDArrayGetSharedGPUMemHandle(NDArrayHandle handle, char* ipc_handle,
+                                             uint64_t* offset, int* dev_id);
+
+/*!
+ * \brief Reconstruct an NDArray from the CUDA IPC handle of the memory of a GPU NDArray of
+ *  another process. The NDArray reads that memory, which is mapped once by process and
+ *  unmapped when the last NDArray on it is freed, and must not be written to.
+ * \param ipc_handle the 64 bytes given by MXNDArrayGetSharedGPUMemHandle
+ * \param offset offset in bytes of the array in the allocation
+ * \param dev_id id of the GPU of the array in this process
+ * \param shape pointer to NDArray dimensions
+ * \param ndim number of NDArray dimensions
+ * \param dtype data type of NDArray
+ * \param out constructed NDArray
+ */
+MXNET_DLL int MXNDArrayCreateFromSharedGPUMem(const char* ipc_handle, uint64_t offset,
+                                              int dev_id, const int* shape, int ndim, int dtype,
+                                              NDArrayHandle* out);
+
 /*!
   * \brief Push an asynchronous operation to the engine.
   * \param async_func Execution function whici takes a parameter on_complete
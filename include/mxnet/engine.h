@@ -29,6 +29,8 @@
 #include <memory>
 #include <functional>
 #endif
+#include <string>
+#include <utility>
 #include <vector>
 #include "./base.h"
 
@@ -314,6 +316,61 @@ class MXNET_API Engine {
   virtual int set_bulk_size(int) {
     return 0;
   }
+  /*! \brief query the priority added to operations pushed from the calling thread */
+  virtual int thread_priority() const {
+    return 0;
+  }
+  /*!
+   * \brief set the priority added to operations pushed from the calling thread
+   * \return the previous thread priority
+   */
+  virtual int set_thread_priority(int) {
+    return 0;
+  }
+  /*!
+   * \brief query the counters of adaptive bulking (MXNET_ENGINE_ADAPTIVE_BULK)
+   * \param num_merged number of operations appended to an adaptive bulk
+   * \param num_bulks number of adaptive bulks pushed to execution
+   * \param num_timed number of operations pushed alone and timed
+   */
+  virtual void adaptive_bulk_stats(uint64_t* num_merged,
+                                   uint64_t* num_bulks,
+                                   uint64_t* num_timed) const {
+    *num_merged = *num_bulks = *num_timed = 0;
+  }
+  /*!
+   * \brief start or stop a round of the operator tape of the calling thread.
+   *  The i-th operation pushed by PushAsync in a round reuses the operator object of the i-th
+   *  operation of the previous round when both have the same property, name and number of
+   *  variables and the previous one has completed, instead of creating and deleting one.
+   * \param mode 1 starts a round, 0 stops it, -1 stops it and frees the recorded operators.
+   *  Starting a round while one is running has no effect.
+   * \return whether a round was running
+   */
+  virtual bool set_tape(int mode) {
+    return false;
+  }
+  /*!
+   * \brief query the counters of the operator tapes
+   * \param num_reused number of operations which reused a recorded operator
+   * \param num_recorded number of operators recorded
+   */
+  virtual void tape_stats(uint64_t* num_reused, uint64_t* num_recorded) const {
+    *num_reused = *num_recorded = 0;
+  }
+  /*!
+   * \brief query the load of the engine
+   * \param num_executed number of operations executed
+   * \param num_pending number of operations pushed and not completed yet
+   * \param queue_depths number of operations ready to run in the queue of each worker pool,
+   *  by name of the pool
+   */
+  virtual void load_stats(uint64_t* num_executed,
+                          uint64_t* num_pending,
+                          std::vector<std::pair<std::string, uint64_t>>* queue_depths) {
+    *num_executed = *num_pending = 0;
+    queue_depths->clear();
+  }
 };  // class Engine
 #endif  // DMLC_USE_CXX11
 }  // namespace mxnet
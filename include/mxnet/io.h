@@ -138,6 +138,12 @@ class Dataset {
   *  \param ret the returned ndarray items
   */
   virtual bool GetItem(uint64_t idx, std::vector<NDArray>* ret) = 0;
+  /*!
+  *  \brief Hint that the items of index idx is going to be read soon, e.g. to read ahead
+  *  the file holding it
+  *  \param idx the integer index of the item
+  */
+  virtual void Prefetch(uint64_t idx) {}
   // virtual destructor
   virtual ~Dataset(void) {}
 };  // class Dataset
@@ -177,6 +183,21 @@ class BatchifyFunction {
   /*! \brief The batchify logic */
   virtual bool Batchify(const std::vector<std::vector<NDArray> >& inputs,
                         std::vector<NDArray>* outputs) = 0;
+  /*!
+   * \brief Write one sample into its slot of the outputs, for the batchify functions stacking
+   *  the samples along a new leading dimension, so that a data loader can stack the samples
+   *  as soon as they are loaded.
+   * \param sample the elements of the sample
+   * \param index the slot of the sample in the batch
+   * \param outputs the batched elements, of the shape and dtype of the elements of the sample
+   *  with the batch size as leading dimension
+   * \return false if the function does not stack the samples, the caller then uses Batchify
+   */
+  virtual bool BatchifySample(const std::vector<NDArray>& sample,
+                              size_t index,
+                              std::vector<NDArray>* outputs) {
+    return false;
+  }
 };  // class BatchifyFunction
 
 using BatchifyFunctionPtr = std::shared_ptr<BatchifyFunction>;
@@ -110,6 +110,38 @@ class KVStore {
    */
   virtual void Init(const std::vector<std::string>& str_keys,
                     const std::vector<NDArray>& values) = 0;
+  /*!
+   * \brief Initialize a row_sparse key of shape (num_ids, dim) whose rows are stored in hash
+   *  tables, so that the memory is proportional to the rows pushed rather than to num_ids.
+   *
+   * The key is pushed and pulled with \ref Push and \ref PullRowSparse, with the row ids
+   * as the 64-bit ids of the features. The rows are given to the ids when they are first
+   * pushed, and the pushes update the rows with the optimizer of the params instead of the
+   * updater. Like \ref Init, all workers must call it.
+   *
+   * \param key the key
+   * \param shape the shape (num_ids, dim) of the key
+   * \param params the optimizer, admission and eviction of the rows, parsed by
+   *  HashEmbeddingParam
+   */
+  virtual void InitHashEmbedding(const int key,
+                                 const mxnet::TShape& shape,
+                                 const std::vector<std::pair<std::string, std::string> >
+                                 & params) {
+    LOG(FATAL) << "Hash embeddings are not supported by kvstore " << type_;
+  }
+  /*!
+   * \brief Initialize a row_sparse key stored in hash tables
+   * \param key the key in string format
+   * \param shape the shape (num_ids, dim) of the key
+   * \param params the optimizer, admission and eviction of the rows
+   */
+  virtual void InitHashEmbedding(const std::string& str_key,
+                                 const mxnet::TShape& shape,
+                                 const std::vector<std::pair<std::string, std::string> >
+                                 & params) {
+    LOG(FATAL) << "Hash embeddings are not supported by kvstore " << type_;
+  }
   /*!
    * \brief push a list of key-value pairs into the store
    *
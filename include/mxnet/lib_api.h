@@ -52,7 +52,7 @@
 #endif
 
 /* Make sure to update the version number everytime you make changes */
-#define MX_LIBRARY_VERSION 11
+#define MX_LIBRARY_VERSION 12
 
 /*!
  * \brief For loading multiple custom op libraries in Linux, exporting same symbol multiple
@@ -269,6 +269,20 @@ enum MXStorageType {
   kCSRStorage = 2,
 };
 
+/*
+ * MXTensor output request type, how the operator writes an output.
+ */
+enum MXReqType {
+  // the output is not needed
+  kReqNull = 0,
+  // write the output
+  kReqWrite = 1,
+  // write the output, which shares its memory with an input
+  kReqInplace = 2,
+  // add the result to the values of the output
+  kReqAddTo = 3,
+};
+
 /*!
  * \brief Context info passing from MXNet OpContext
  * dev_type is string repr of supported context, currently only "cpu" and "gpu"
@@ -364,6 +378,9 @@ struct MXTensor {
 
   // storage type
   MXStorageType stype;
+
+  // how the operator writes the output, always kReqWrite for inputs
+  MXReqType req;
 };
 
 /*! \brief resource malloc function to allocate memory inside Forward/Backward functions */
@@ -421,10 +438,14 @@ class OpResource {
              sparse_malloc_t sparse_malloc_fp, void* sparse_alloc_fp,
              void* rng_cpu_states, void* rng_gpu_states);
 
-  /*! \brief allocate cpu memory controlled by MXNet */
+  /*!
+   * \brief allocate cpu memory controlled by MXNet, from the temporary workspace of the operator.
+   *  The memory is valid until Forward/Backward returns. Several allocations may be made in one
+   *  call, each is aligned to 256 bytes.
+   */
   void* alloc_cpu(int size) const;
 
-  /*! \brief allocate gpu memory controlled by MXNet */
+  /*! \brief allocate gpu memory controlled by MXNet, on the stream of get_cuda_stream */
   void* alloc_gpu(int size) const;
 
   /*! \brief return the cuda stream object with correct type */
@@ -737,6 +758,9 @@ typedef MXReturnValue (*inferShape_t)(const std::unordered_map<std::string,
 typedef MXReturnValue (*mutateInputs_t)(const std::unordered_map<std::string,
                                         std::string>& attributes,
                                         std::vector<int>* input_indices);
+typedef MXReturnValue (*inplace_t)(const std::unordered_map<std::string,
+                                   std::string>& attributes,
+                                   std::vector<std::pair<int, int> >* inplace_pairs);
 typedef MXReturnValue (*createOpState_t)(const std::unordered_map<std::string,
                                          std::string>& attributes,
                                          const MXContext& ctx,
@@ -765,6 +789,12 @@ class CustomOp {
 
   CustomOp& setMutateInputs(mutateInputs_t func);
 
+  /*!
+   * \brief sets the (input, output) index pairs of the forward function which may share memory,
+   *  the output is then computed in place with req kReqInplace
+   */
+  CustomOp& setInplace(inplace_t func);
+
   CustomOp& setCreateOpState(createOpState_t func, const char* ctx);
 
   CustomOp& setIsSubgraphOp();
@@ -780,6 +810,7 @@ class CustomOp {
   inferSType_t infer_storage_type;
   inferShape_t infer_shape;
   mutateInputs_t mutate_inputs;
+  inplace_t inplace;
   bool isSGop;
 
   /*! \brief vector repr of ctx map to be easily loaded from c_api */
@@ -957,7 +988,8 @@ typedef int (*opRegGet_t)(int idx, const char** name, int *isSGop,
                           const char*** create_op_ctx, mxnet::ext::createOpState_t** create_op_fp,
                           int* create_op_count, mxnet::ext::parseAttrs_t* parse,
                           mxnet::ext::inferType_t* type, mxnet::ext::inferSType_t* stype,
-                          mxnet::ext::inferShape_t* shape, mxnet::ext::mutateInputs_t* mutate);
+                          mxnet::ext::inferShape_t* shape, mxnet::ext::mutateInputs_t* mutate,
+                          mxnet::ext::inplace_t* inplace);
 
 #define MXLIB_OPCALLFREE_STR "_opCallFree"
 typedef int (*opCallFree_t)(void* ptr);
@@ -1003,13 +1035,18 @@ typedef int (*opCallFComp_t)(fcomp_t fcomp, const char* const* keys,
                              void** in_indptr, void** out_indptr,
                              int64_t* in_indices_shapes, int64_t* out_indices_shapes,
                              int64_t* in_indptr_shapes, int64_t* out_indptr_shapes,
-                             void* rng_cpu_states, void* rng_gpu_states);
+                             void* rng_cpu_states, void* rng_gpu_states, int* outreqs);
 
 #define MXLIB_OPCALLMUTATEINPUTS_STR "_opCallMutateInputs"
 typedef int (*opCallMutateInputs_t)(mutateInputs_t mutate, const char* const* keys,
                                     const char* const* vals, int num,
                                     int** mutate_indices, int* indices_size);
 
+#define MXLIB_OPCALLINPLACE_STR "_opCallInplace"
+typedef int (*opCallInplace_t)(inplace_t inplace, const char* const* keys,
+                               const char* const* vals, int num,
+                               int** inplace_pairs, int* pairs_size);
+
 #define MXLIB_OPCALLCREATEOPSTATE_STR "_opCallCreateOpState"
 typedef int (*opCallCreateOpState_t)(createOpState_t create_op, const char* const* keys,
                                      const char* const* vals, int num, const char* dev_type,
@@ -1037,7 +1074,7 @@ typedef int (*opCallFStatefulComp_t)(int is_forward, void* state_op,
                                      void** in_indptr, void** out_indptr,
                                      int64_t* in_indices_shapes, int64_t* out_indices_shapes,
                                      int64_t* in_indptr_shapes, int64_t* out_indptr_shapes,
-                                     void* rng_cpu_states, void* rng_gpu_states);
+                                     void* rng_cpu_states, void* rng_gpu_states, int* outreqs);
 
 #define MXLIB_PARTREGSIZE_STR "_partRegSize"
 typedef int (*partRegSize_t)(void);
@@ -1166,7 +1203,8 @@ extern "C" {
                         const char*** create_op_ctx, mxnet::ext::createOpState_t** create_op_fp,
                         int* create_op_count, mxnet::ext::parseAttrs_t* parse,
                         mxnet::ext::inferType_t* type, mxnet::ext::inferSType_t* stype,
-                        mxnet::ext::inferShape_t* shape, mxnet::ext::mutateInputs_t* mutate);
+                        mxnet::ext::inferShape_t* shape, mxnet::ext::mutateInputs_t* mutate,
+                        mxnet::ext::inplace_t* inplace);
 
   /*! \brief calls free from the external library for library allocated arrays */
   MX_VOID_RET _opCallFree(void* ptr);
@@ -1209,13 +1247,18 @@ extern "C" {
                              void** in_indptr, void** out_indptr,
                              int64_t* in_indices_shapes, int64_t* out_indices_shapes,
                              int64_t* in_indptr_shapes, int64_t* out_indptr_shapes,
-                             void* rng_cpu_states, void* rng_gpu_states);
+                             void* rng_cpu_states, void* rng_gpu_states, int* outreqs);
 
   /*! \brief returns status of calling mutateInputs function for operator from library */
   MX_INT_RET _opCallMutateInputs(mxnet::ext::mutateInputs_t mutate, const char* const* keys,
                                  const char* const* vals, int num,
                                  int** mutate_indices, int* indices_size);
 
+  /*! \brief returns status of calling inplace function for operator from library */
+  MX_INT_RET _opCallInplace(mxnet::ext::inplace_t inplace, const char* const* keys,
+                            const char* const* vals, int num,
+                            int** inplace_pairs, int* pairs_size);
+
   /*! \brief returns status of calling createStatefulOp function for operator from library */
   MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op, const char* const* keys,
                                   const char* const* vals, int num, const char* dev_type,
@@ -1241,7 +1284,7 @@ extern "C" {
                                      void** out_indptr, int64_t* in_indices_shapes,
                                      int64_t* out_indices_shapes, int64_t* in_indptr_shapes,
                                      int64_t* out_indptr_shapes,
-                                     void* rng_cpu_states, void* rng_gpu_states);
+                                     void* rng_cpu_states, void* rng_gpu_states, int* outreqs);
 
   /*! \brief returns number of partitioners registered in this library */
   MX_INT_RET _partRegSize();
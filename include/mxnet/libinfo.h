@@ -58,6 +58,10 @@
 #define MXNET_USE_CUTENSOR MSHADOW_USE_CUTENSOR
 #endif
 
+#ifndef MXNET_USE_CUSPARSELT
+#define MXNET_USE_CUSPARSELT 0
+#endif
+
 #ifndef MXNET_USE_NVML
 #define MXNET_USE_NVML 0
 #endif
@@ -143,6 +147,7 @@ enum : unsigned {
   NCCL,
   TENSORRT,
   CUTENSOR,
+  CUSPARSELT,
 
   // CPU Features / optimizations
   CPU_SSE,
@@ -153,6 +158,18 @@ enum : unsigned {
   CPU_SSE4A,  // AMD extensions to SSE4
   CPU_AVX,
   CPU_AVX2,
+  // Instruction sets of the running CPU, detected at runtime for the dispatched kernels
+  CPU_AVX512F,
+  CPU_AVX512_BF16,
+  CPU_AVX512_VNNI,
+  CPU_AMX_BF16,
+  CPU_AMX_INT8,
+  CPU_NEON,
+  CPU_ASIMD_DOTPROD,
+  CPU_SVE,
+  CPU_SVE2,
+  CPU_ARM_BF16,
+  CPU_ARM_I8MM,
 
 
   // Multiprocessing / CPU / System
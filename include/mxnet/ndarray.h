@@ -32,9 +32,11 @@
 #include <nnvm/node.h>
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #if MXNET_USE_ONEDNN == 1
 #include <mkldnn.hpp>
@@ -93,7 +95,7 @@ class NDArray {
           Context ctx,
           bool delay_alloc = false,
           int dtype        = mshadow::default_type_flag)
-      : ptr_(std::make_shared<Chunk>(shape, ctx, delay_alloc, dtype)),
+      : ptr_(NewChunk(shape, ctx, delay_alloc, dtype)),
         shape_(shape),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -117,7 +119,7 @@ class NDArray {
    * \param dtype data type of this ndarray
    */
   explicit NDArray(Context ctx, int dtype = mshadow::default_type_flag)
-      : ptr_(std::make_shared<Chunk>(mxnet::TShape(mshadow::Shape1(0)), ctx, true, dtype)),
+      : ptr_(NewChunk(mxnet::TShape(mshadow::Shape1(0)), ctx, true, dtype)),
         shape_(),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -130,7 +132,7 @@ class NDArray {
    * \param dev_id the device id this tensor sits at
    */
   NDArray(const TBlob& data, int dev_id)
-      : ptr_(std::make_shared<Chunk>(data, dev_id)),
+      : ptr_(NewChunk(data, dev_id)),
         shape_(data.shape_),
         dtype_(data.type_flag_),
         storage_type_(kDefaultStorage),
@@ -157,7 +159,7 @@ class NDArray {
 
   /*! \brief create ndarray from shared memory */
   NDArray(int shared_pid, int shared_id, const mxnet::TShape& shape, int dtype)
-      : ptr_(std::make_shared<Chunk>(shared_pid, shared_id, shape, dtype)),
+      : ptr_(NewChunk(shared_pid, shared_id, shape, dtype)),
         shape_(shape),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -178,7 +180,7 @@ class NDArray {
           const TBlob& data,
           const std::vector<TBlob>& aux_data,
           int dev_id)
-      : ptr_(std::make_shared<Chunk>(stype, data, aux_data, dev_id)),
+      : ptr_(NewChunk(stype, data, aux_data, dev_id)),
         shape_(shape),
         dtype_(data.type_flag_),
         storage_type_(stype),
@@ -400,6 +402,21 @@ class NDArray {
    * trigger computation.
    */
   void WaitToWrite() const;
+  /*!
+   * \brief Allow the memory of this GPU array to be spilled to the host while it is
+   *  not used, see MXNET_GPU_SPILL_BUDGET. The data pointer changes between the
+   *  operators that use the array, so it must not be captured ahead of time.
+   */
+  void SetSpillable() const;
+  /*!
+   * \brief Fill the memory of this array with loader when it is first accessed, instead of
+   *  allocating it now, e.g. to read the parameters of a model from a mapped checkpoint only
+   *  once they are used. The memory of a GPU array is then spillable, see SetSpillable, and
+   *  until the array is written, spilling it frees its memory and restoring it calls loader
+   *  again.
+   * \param loader fills the memory given its pointer and its size in bytes
+   */
+  void SetLoader(std::function<void(void*, size_t)> loader) const;
   /*! \return the associated variable of the ndarray.*/
   inline Engine::VarHandle var() const {
     return ptr_->var;
@@ -589,10 +606,13 @@ class NDArray {
     return ret;
   }
 
-  inline void InitAsArray(const NDArray& src, const mxnet::TShape& shape, int dtype) {
+  inline void InitAsArray(const NDArray& src,
+                          const mxnet::TShape& shape,
+                          int dtype,
+                          size_t byte_offset = 0) {
     CHECK_EQ(src.storage_type(), kDefaultStorage)
         << "AsArray is intended only for kDefaultStorage.";
-    CHECK_GE(src.ptr_->shandle.size, shape.Size() * mshadow::mshadow_sizeof(dtype))
+    CHECK_GE(src.ptr_->shandle.size, byte_offset + shape.Size() * mshadow::mshadow_sizeof(dtype))
         << "NDArray.AsArray: target memory size is bigger than what was allocated.";
     // We can't reuse memory in a view.
     CHECK(!src.IsView());
@@ -600,6 +620,7 @@ class NDArray {
     shape_ = shape;
     dtype_ = dtype;
     reuse_ = true;
+    byte_offset_ += byte_offset;
   }
 
   /*!
@@ -872,6 +893,10 @@ class NDArray {
     /*! \brief whether data allocation is delayed. This doesn't indicate whether aux data
                allocation is delayed. */
     bool delay_alloc;
+    /*! \brief whether the memory is registered with the spill manager */
+    bool spillable = false;
+    /*! \brief fills the memory of a delay_alloc chunk once it is allocated, see SetLoader */
+    std::function<void(void*, size_t)> loader;
     // the type of the storage. The storage_type is never kUndefinedStorage once the chunk
     // is constructed.
     NDArrayStorageType storage_type = kDefaultStorage;
@@ -1032,7 +1057,9 @@ class NDArray {
 
     /*! \brief check if delay alloc is on, do alloc if not yet done */
     inline void CheckAndAlloc(void) {
-      if (delay_alloc) {
+      if (delay_alloc && loader) {
+        Load();
+      } else if (delay_alloc) {
         Storage::Get()->Alloc(&shandle);
 #if MXNET_USE_ONEDNN == 1
         mkl_mem_ = nullptr;
@@ -1047,6 +1074,8 @@ class NDArray {
       CHECK_EQ(kDefaultStorage, storage_type)
           << "CheckAndAlloc(dbytes) is only intended for kDefaultStorage";
       dbytes = std::max(dbytes, static_cast<uint64_t>(shandle.size));
+      if (delay_alloc && loader)
+        Load();
       if (delay_alloc) {
         shandle.size = dbytes;
         Storage::Get()->Alloc(&shandle);
@@ -1055,6 +1084,7 @@ class NDArray {
 #endif
         delay_alloc = false;
       } else if (shandle.size < dbytes) {
+        CHECK(!spillable) << "The memory of a spillable array cannot grow";
         // free storage
         Storage::Get()->Free(shandle);
         // init storage
@@ -1065,6 +1095,8 @@ class NDArray {
 #endif
       }
     }
+    /*! \brief allocate the memory of a delay_alloc chunk with a loader and fill it */
+    void Load();
     /*! \brief initialize the shape and dtype, assuming it is not initialized before. */
     void Init(const mxnet::TShape& shape, int dtype) {
       auto size     = shape.Size();
@@ -1138,6 +1170,38 @@ class NDArray {
     ~Chunk();
   };  // struct Chunk
 
+  /*! \brief memory of a chunk and its reference counts, from the chunk pool for the small ones */
+  static void* AllocChunkMemory(size_t bytes);
+  /*! \brief returns memory of AllocChunkMemory */
+  static void FreeChunkMemory(void* ptr, size_t bytes);
+  /*! \brief allocator of the memory of chunks, for std::allocate_shared */
+  template <typename T>
+  struct ChunkAllocator {
+    using value_type = T;
+    ChunkAllocator() = default;
+    template <typename U>
+    ChunkAllocator(const ChunkAllocator<U>&) {}  // NOLINT(runtime/explicit)
+    T* allocate(size_t n) {
+      return static_cast<T*>(AllocChunkMemory(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+      FreeChunkMemory(ptr, n * sizeof(T));
+    }
+    template <typename U>
+    bool operator==(const ChunkAllocator<U>&) const {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(const ChunkAllocator<U>&) const {
+      return false;
+    }
+  };
+  /*! \brief a new chunk, with its reference counts, in pooled memory */
+  template <typename... Args>
+  static std::shared_ptr<Chunk> NewChunk(Args&&... args) {
+    return std::allocate_shared<Chunk>(ChunkAllocator<Chunk>(), std::forward<Args>(args)...);
+  }
+
   /*!
    * \brief initialize the NDArray
    */
@@ -1214,6 +1278,19 @@ void CopyFromTo(const NDArray& from, const NDArray* to, int priority = 0);
  */
 void CopyFromTo(const NDArray& from, const NDArray& to, int priority = 0, bool is_opr = false);
 
+/*!
+ * \brief issue the copies from[i] to to[i], the copies of default storage arrays of the same
+ *  data type from one GPU to GPUs are scheduled by the engine as one operation, in which the
+ *  small ones are done by one kernel launch. The other copies are issued by CopyFromTo.
+ *
+ * \param from the ndarrays we want to copy data from
+ * \param to the target ndarrays
+ * \param priority Priority of the action.
+ */
+void BatchCopyFromTo(const std::vector<NDArray>& from,
+                     const std::vector<NDArray*>& to,
+                     int priority = 0);
+
 /*!
  * \brief Perform elementwise sum over each data from source, store result into out.
  * \param source the ndarray we want to sum
@@ -31,6 +31,7 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <utility>
 
 #include "./base.h"
 #include "./ndarray.h"
@@ -361,6 +362,49 @@ using FNeedCalibrateInput = std::function<std::vector<int> (const NodeAttrs& att
  */
 using FNeedCalibrateOutput = std::function<std::vector<int> (const NodeAttrs& attrs)>;
 
+/*!
+ * \brief Register a function to determine if the operator can be captured
+ * into a CUDA graph by a static CachedOp (MXNET_ENABLE_CUDA_GRAPHS).
+ * Operators that synchronize with the host or whose launches depend on host
+ * side state that changes between runs must return false.
+ * \note Register under "FIsCUDAGraphsCompatible"
+ */
+using FIsCUDAGraphsCompatible = std::function<bool (const NodeAttrs& attrs, const bool is_train)>;
+
+/*!
+ * \brief Register a function to count the floating point operations of an operator,
+ * from which the profiler reports the achieved GFLOP/s and arithmetic intensity of the
+ * operator in the aggregate stats.
+ * \note Register under "FComputeCost"
+ */
+using FComputeCost = std::function<uint64_t (const NodeAttrs& attrs,
+                                             const mxnet::ShapeVector& in_shapes,
+                                             const mxnet::ShapeVector& out_shapes)>;
+
+/*!
+ * \brief Register a function returning the outputs of an operator that are contiguous
+ * ranges of the memory of its first input of shape ishape, as pairs of the index of the
+ * output and the offset in elements of its first element in the input. The memory planner
+ * of a graph may then place these outputs within the memory of the input, and the
+ * operator must not copy an output that is already there.
+ * \note Register under "FViewOutputs"
+ */
+using FViewOutputs = std::function<std::vector<std::pair<int, size_t>> (
+    const NodeAttrs& attrs,
+    const mxnet::TShape& ishape)>;
+
+/*!
+ * \brief Register a function returning the inputs of an operator that are contiguous ranges
+ * of the memory of its first output, given the shapes ishapes of the inputs, as pairs of the
+ * index of the input and the offset in elements of its first element in the output. The
+ * memory planner of a graph may then have the producers of these inputs write them within
+ * the memory of the output, and the operator must not copy an input that is already there.
+ * \note Register under "FViewInputs"
+ */
+using FViewInputs = std::function<std::vector<std::pair<int, size_t>> (
+    const NodeAttrs& attrs,
+    const mxnet::ShapeVector& ishapes)>;
+
 }  // namespace mxnet
 
 #endif  // MXNET_OP_ATTR_TYPES_H_
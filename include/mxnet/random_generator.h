@@ -24,8 +24,10 @@
 #ifndef MXNET_RANDOM_GENERATOR_H_
 #define MXNET_RANDOM_GENERATOR_H_
 
+#include <cmath>
 #include <random>
 #include <new>
+#include <type_traits>
 #include "./base.h"
 
 #if MXNET_USE_CUDA
@@ -228,6 +230,220 @@ class RandGenerator<gpu, double> {
 
 #endif  // MXNET_USE_CUDA
 
+/*!
+ * \brief Counter based random number generator (Philox4x32-10) without state, of the
+ *  kCounterRandom resource. The generator is the key of the seed and the counter of an
+ *  invocation of an op, passed to the kernels by value. The numbers of a thread are a function
+ *  of the key, the invocation, the thread and their index only, so the invocations draw
+ *  different numbers without a lock, in any order, and reproduce with the seed.
+ *  It has the interface of RandGenerator, so that the kernels of LaunchRNG take either.
+ */
+template<typename Device, typename DType MSHADOW_DEFAULT_DTYPE>
+class PhiloxGenerator {
+ public:
+  // at least how many random numbers should be generated by one thread, as RandGenerator.
+  static constexpr int kMinNumRandomPerThread = 64;
+  // at most how many threads generate the numbers of a launch, as RandGenerator.
+  static constexpr int kNumRandomStates =
+      std::is_same<Device, mshadow::cpu>::value ? 1024 : 32768;
+
+  MSHADOW_XINLINE PhiloxGenerator(uint64_t key, uint64_t invocation)
+      : key_(key), invocation_(invocation) {}
+
+  class Impl {
+   public:
+    typedef typename std::conditional<std::is_same<DType, double>::value,
+                                      double, float>::type FType;
+
+    MSHADOW_XINLINE Impl(const PhiloxGenerator<Device, DType> *gen, int thread_idx)
+        : key_{static_cast<uint32_t>(gen->key_), static_cast<uint32_t>(gen->key_ >> 32)},
+          counter_{0, static_cast<uint32_t>(thread_idx),
+                   static_cast<uint32_t>(gen->invocation_),
+                   static_cast<uint32_t>(gen->invocation_ >> 32)} {}
+
+    Impl(const Impl &) = delete;
+    Impl &operator=(const Impl &) = delete;
+
+    // non-negative, as the 31 high bits of the next number
+    MSHADOW_XINLINE int rand() { return static_cast<int>(Next() >> 1); }
+
+    MSHADOW_XINLINE int64_t rand_int64() {
+      const uint64_t hi = Next() >> 1;
+      return static_cast<int64_t>((hi << 32) | Next());
+    }
+
+    // uniform in [0, 1) like stl
+    MSHADOW_XINLINE FType uniform() {
+      if (std::is_same<FType, double>::value) {
+        const uint64_t hi = Next() >> 5;
+        const uint64_t lo = Next() >> 6;
+        return static_cast<FType>(((hi << 26) | lo) * (1.0 / 9007199254740992.0));
+      }
+      return static_cast<FType>(Next() >> 8) * static_cast<FType>(1.0f / 16777216.0f);
+    }
+
+    // UniformRandomBitGenerator of stl, e.g. of std::shuffle
+    typedef uint32_t result_type;
+    static constexpr uint32_t min() { return 0; }
+    static constexpr uint32_t max() { return 0xffffffffu; }
+    MSHADOW_XINLINE uint32_t operator()() { return Next(); }
+
+    // Box-Muller, the second number of a pair is kept for the next call
+    MSHADOW_XINLINE FType normal() {
+      if (has_normal_) {
+        has_normal_ = false;
+        return normal_;
+      }
+      const FType radius = sqrt(FType(-2) * log(FType(1) - uniform()));
+      const FType angle  = FType(6.283185307179586) * uniform();
+      normal_            = radius * sin(angle);
+      has_normal_        = true;
+      return radius * cos(angle);
+    }
+
+    // the most numbers drawn at once by the bulk versions of operator()(), uniform() and normal()
+    static constexpr int kBulk = 128;
+
+    // n <= 2 * kBulk calls of operator()() at once
+    MSHADOW_XINLINE void operator()(uint32_t *out, int n) {
+      int i = 0;
+      for (; i < n && used_ < 4; ++i) out[i] = block_[used_++];
+      const int nblocks = (n - i) / 4;
+      Blocks(out + i, nblocks);
+      for (i += 4 * nblocks; i < n; ++i) out[i] = Next();
+    }
+
+    // n <= kBulk calls of uniform() at once, the blocks computed in lockstep
+    MSHADOW_XINLINE void uniform(FType *out, int n) {
+      uint32_t words[2 * kBulk];
+      if (std::is_same<FType, double>::value) {
+        (*this)(words, 2 * n);
+        for (int i = 0; i < n; ++i) {
+          const uint64_t hi = words[2 * i] >> 5;
+          const uint64_t lo = words[2 * i + 1] >> 6;
+          out[i] = static_cast<FType>(((hi << 26) | lo) * (1.0 / 9007199254740992.0));
+        }
+      } else {
+        (*this)(words, n);
+        for (int i = 0; i < n; ++i) {
+          out[i] = static_cast<FType>(words[i] >> 8) * static_cast<FType>(1.0f / 16777216.0f);
+        }
+      }
+    }
+
+    // n <= kBulk calls of normal() at once
+    MSHADOW_XINLINE void normal(FType *out, int n) {
+      if (n > 0 && has_normal_) {
+        has_normal_ = false;
+        *out++ = normal_;
+        --n;
+      }
+      FType u[kBulk];
+      const int pairs = n / 2;
+      uniform(u, 2 * pairs);
+      for (int i = 0; i < pairs; ++i) {
+        const FType radius = sqrt(FType(-2) * log(FType(1) - u[2 * i]));
+        const FType angle  = FType(6.283185307179586) * u[2 * i + 1];
+        out[2 * i]         = radius * cos(angle);
+        out[2 * i + 1]     = radius * sin(angle);
+      }
+      if (n % 2)
+        out[n - 1] = normal();
+    }
+
+   private:
+    MSHADOW_XINLINE static uint32_t MulHiLo(uint32_t a, uint32_t b, uint32_t *hi) {
+#ifdef __CUDA_ARCH__
+      *hi = __umulhi(a, b);
+      return a * b;
+#else
+      const uint64_t product = static_cast<uint64_t>(a) * b;
+      *hi = static_cast<uint32_t>(product >> 32);
+      return static_cast<uint32_t>(product);
+#endif  // __CUDA_ARCH__
+    }
+
+    // the next 4 numbers, the block of the counter, incremented in its first word
+    MSHADOW_XINLINE void Block() {
+      uint32_t c[4] = {counter_[0], counter_[1], counter_[2], counter_[3]};
+      uint32_t k[2] = {key_[0], key_[1]};
+      for (int round = 0; round < 10; ++round) {
+        uint32_t hi0, hi1;
+        const uint32_t lo0 = MulHiLo(0xD2511F53u, c[0], &hi0);
+        const uint32_t lo1 = MulHiLo(0xCD9E8D57u, c[2], &hi1);
+        c[0] = hi1 ^ c[1] ^ k[0];
+        c[1] = lo1;
+        c[2] = hi0 ^ c[3] ^ k[1];
+        c[3] = lo0;
+        k[0] += 0x9E3779B9u;
+        k[1] += 0xBB67AE85u;
+      }
+      for (int i = 0; i < 4; ++i) block_[i] = c[i];
+      ++counter_[0];
+      used_ = 0;
+    }
+
+    MSHADOW_XINLINE uint32_t Next() {
+      if (used_ == 4) Block();
+      return block_[used_++];
+    }
+
+    template <int kLanes>
+    MSHADOW_XINLINE static void Round(uint32_t *c0, uint32_t *c1, uint32_t *c2, uint32_t *c3,
+                                      uint32_t k0, uint32_t k1) {
+      for (int l = 0; l < kLanes; ++l) {
+        const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0[l];
+        const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2[l];
+        c0[l] = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+        c1[l] = static_cast<uint32_t>(p1);
+        c2[l] = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+        c3[l] = static_cast<uint32_t>(p0);
+      }
+    }
+
+    // the blocks of the next nblocks counters, kLanes at a time in the lanes of arrays, so that
+    // the compiler vectorizes the rounds
+    MSHADOW_XINLINE void Blocks(uint32_t *out, int nblocks) {
+      constexpr int kLanes = 16;
+      for (int b = 0; b < nblocks; b += kLanes) {
+        uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+        for (int l = 0; l < kLanes; ++l) {
+          c0[l] = counter_[0] + static_cast<uint32_t>(b + l);
+          c1[l] = counter_[1];
+          c2[l] = counter_[2];
+          c3[l] = counter_[3];
+        }
+        uint32_t k0 = key_[0], k1 = key_[1];
+        for (int round = 0; round < 10; ++round) {
+          Round<kLanes>(c0, c1, c2, c3, k0, k1);
+          k0 += 0x9E3779B9u;
+          k1 += 0xBB67AE85u;
+        }
+        for (int l = 0; l < kLanes && b + l < nblocks; ++l) {
+          out[4 * (b + l)]     = c0[l];
+          out[4 * (b + l) + 1] = c1[l];
+          out[4 * (b + l) + 2] = c2[l];
+          out[4 * (b + l) + 3] = c3[l];
+        }
+      }
+      counter_[0] += static_cast<uint32_t>(nblocks);
+    }
+
+    uint32_t key_[2];
+    uint32_t counter_[4];
+    uint32_t block_[4];
+    int used_ = 4;
+    bool has_normal_ = false;
+    FType normal_;
+  };  // class PhiloxGenerator<Device, DType>::Impl
+
+ private:
+  /*! \brief the key of the seed and the device */
+  uint64_t key_;
+  /*! \brief the counter of the invocation of the op, the 64 high bits of the counters */
+  uint64_t invocation_;
+};  // class PhiloxGenerator
+
 }  // namespace random
 }  // namespace common
 }  // namespace mxnet
@@ -25,10 +25,15 @@
 #define MXNET_RESOURCE_H_
 
 #include <dmlc/logging.h>
+#include <memory>
 #include <string>
+#include <vector>
 #include "./base.h"
 #include "./engine.h"
 #include "./random_generator.h"
+#if MXNET_USE_NCCL == 1
+#include <nccl.h>
+#endif  // MXNET_USE_NCCL == 1
 
 namespace mxnet {
 
@@ -43,12 +48,26 @@ struct ResourceRequest {
     /*! \brief A dynamic temp space that can be arbitrary size */
     kTempSpace,
     /*! \brief common::RandGenerator<xpu> object, which can be used in GPU kernel functions */
-    kParallelRandom
+    kParallelRandom,
+    /*!
+     * \brief common::PhiloxGenerator<xpu> of an invocation, which has no state, so the ops
+     *  drawing from it only read the resource and run concurrently
+     */
+    kCounterRandom
 #if MXNET_USE_CUDNN == 1
     ,
     /*! \brief cudnnDropoutDescriptor_t object for GPU dropout kernel functions */
     kCuDNNDropoutDesc
 #endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+    ,
+    /*!
+     * \brief ncclComm_t of the GPU, see ResourceManager::InitNCCLComms. The ops write the
+     *  resource, so they issue their collectives in the order they are pushed, which is the
+     *  same on all the ranks
+     */
+    kNCCLComm
+#endif  // MXNET_USE_NCCL == 1
   };
   /*! \brief type of resources */
   Type type;
@@ -93,8 +112,8 @@ inline std::string __extract_fname(const std::string& path) {
 struct Resource {
   /*! \brief The original request */
   ResourceRequest req;
-  /*! \brief engine variable */
-  engine::VarHandle var;
+  /*! \brief engine variable, nullptr for a dynamic kTempSpace, which no other op shares */
+  engine::VarHandle var{nullptr};
   /*! \brief identifier of id information, used for debug purpose */
   int32_t id;
   /*!
@@ -102,6 +121,17 @@ struct Resource {
    *  access using member functions
    */
   void *ptr_;
+  /*! \brief for kCounterRandom, the number of the request, which tells its ops apart */
+  uint64_t counter_stream_{0};
+  /*! \brief for kCounterRandom, the seed of the last invocation of this copy */
+  mutable uint32_t counter_generation_{0};
+  /*! \brief for kCounterRandom, the invocations of this copy since the seed */
+  mutable uint32_t counter_invocation_{0};
+  /*!
+   * \brief for a dynamic kTempSpace (MXNET_DYNAMIC_TEMP_SPACE), the space of the request,
+   *  returned to the storage pool with the last copy of the resource
+   */
+  std::shared_ptr<void> dynamic_space_;
   /*! \brief default constructor */
   Resource() : id(0) {}
   /*!
@@ -132,6 +162,21 @@ struct Resource {
     return static_cast<common::random::RandGenerator<xpu, DType>*>(ptr_);
   }
 
+  /*!
+   * \brief Get the counter based random number generator of the next invocation of the op.
+   *  The invocations of the op, and the ops, draw different numbers, which reproduce with
+   *  the seed, in the order of the requests and invocations after it.
+   * \tparam xpu the device type of random number generator.
+   * \tparam DType the return type.
+   * \return the generator, passed by value to the kernels.
+   */
+  template<typename xpu, typename DType>
+  inline common::random::PhiloxGenerator<xpu, DType> get_counter_random() const {
+    uint64_t key;
+    const uint64_t invocation = get_counter_random_internal(&key);
+    return common::random::PhiloxGenerator<xpu, DType>(key, invocation);
+  }
+
   /*!
    * \brief Get space requested as mshadow Tensor.
    *  The caller can request arbitrary size.
@@ -205,6 +250,16 @@ struct Resource {
       const float dropout,
       const std::string &name = MXNET_RESOURCE_DEFAULT_NAME_FARG("cudnn_dropout_state")) const;
 #endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+  /*!
+   * \brief Get the NCCL communicator of the GPU.
+   * \return the communicator, whose ranks are the GPUs of all the processes.
+   */
+  inline ncclComm_t get_nccl_comm() const {
+    CHECK_EQ(req.type, ResourceRequest::kNCCLComm);
+    return static_cast<ncclComm_t>(ptr_);
+  }
+#endif  // MXNET_USE_NCCL == 1
 
   /*!
    * \brief Get CPU space as mshadow Tensor in specified type.
@@ -235,6 +290,24 @@ struct Resource {
    * \return The allocated space
    */
   void *get_host_space_internal(size_t size) const;
+  /*!
+   * \brief internal function to count an invocation of a counter random resource.
+   * \param key the key of the seed and the device.
+   * \return the counter of the invocation.
+   */
+  uint64_t get_counter_random_internal(uint64_t *key) const;
+  /*!
+   * \brief internal function to get the currently allocated space of a
+   *  temp space resource without growing it.
+   * \return the device pointer, nullptr if nothing was allocated yet.
+   */
+  void *current_space_internal() const;
+  /*!
+   * \brief return the space of a dynamic kTempSpace to the storage pool, once the kernels
+   *  using it are complete. The next get_space allocates again. Does nothing for the other
+   *  resources.
+   */
+  void release_space() const;
 };
 
 /*! \brief Global resource manager */
@@ -259,6 +332,20 @@ class ResourceManager {
    * \param seed the seed to the random number generators.
    */
   virtual void SeedRandom(Context ctx, uint32_t seed) = 0;
+#if MXNET_USE_NCCL == 1
+  /*!
+   * \brief Create the NCCL communicators of the kNCCLComm resources of the GPUs of this
+   *  process, which are the ranks first_rank, first_rank + 1, ... of all the processes.
+   * \param id the unique id of the communicators, created by one of the processes.
+   * \param num_ranks the number of the GPUs of all the processes.
+   * \param first_rank the rank of the first GPU of this process.
+   * \param dev_ids the GPUs of this process.
+   */
+  static void InitNCCLComms(const ncclUniqueId &id,
+                            int num_ranks,
+                            int first_rank,
+                            const std::vector<int> &dev_ids);
+#endif  // MXNET_USE_NCCL == 1
   /*! \brief virtual destructor */
   virtual ~ResourceManager() DMLC_THROW_EXCEPTION {}
   /*!
@@ -26,6 +26,8 @@
 
 #include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 #include "./base.h"
 
 namespace mxnet {
@@ -111,6 +113,28 @@ class Storage {
   * For non-pool memory managers this has no effect.
   */
   virtual void ReleaseAll(Context ctx) = 0;
+  /*!
+   * \brief Usage statistics of the memory pool of a device.
+   *
+   * Pooled storage managers report the free blocks, bytes, hits, misses and
+   * high-water marks of each bucket. When MXNET_STORAGE_CALLSITE_STATS is set,
+   * a histogram of the allocations by profiler scope and name is included.
+   *
+   * \param ctx Context of the device.
+   * \return a JSON object.
+   */
+  virtual std::string PoolStats(Context ctx) = 0;
+  /*!
+   * \brief Bytes held and in use by the memory pools of all devices.
+   * \return the context, held bytes and in use bytes of each allocated pool.
+   */
+  virtual std::vector<std::tuple<Context, size_t, size_t>> PoolUsage() = 0;
+  /*!
+   * \brief Notify the storage that the profiler scope or name of an allocated
+   *  handle changed.
+   * \param handle Handle struct.
+   */
+  virtual void UpdateStorageInfo(const Handle& handle) = 0;
   /*!
    * \brief Destructor.
    */
@@ -24,7 +24,7 @@ import ctypes
 
 from ..base import _LIB
 from ..base import c_handle_array
-from ..base import NDArrayHandle, CachedOpHandle, SymbolHandle
+from ..base import NDArrayHandle, CachedOpHandle, CachedOpBatcherHandle, SymbolHandle
 from ..base import check_call
 from .. import _global_var
 from ..ndarray._internal import NDArrayBase
@@ -158,3 +158,53 @@ class CachedOp(object):
             self._monitor_callback = cb_type(_monitor_callback_wrapper(callback))
         callback_ptr = ctypes.cast(self._monitor_callback, ctypes.c_void_p)
         _api_internal.register_op_hook(self.handle, callback_ptr, monitor_all)
+
+
+class CachedOpBatcher(object):
+    """Dynamic batching of the concurrent calls of a thread safe CachedOp.
+
+    The calls from several threads are coalesced into batches, of up to ``max_batch`` rows of
+    their data inputs along the first axis, which run as one forward pass when ``max_batch`` rows
+    are queued or ``timeout_us`` microseconds after the oldest call. Batches are padded to a power
+    of two rows, or to ``max_batch``, so the CachedOp runs for a few batch shapes only. Each call
+    returns the rows of the outputs of its inputs.
+
+    Parameters
+    ----------
+    cached_op : CachedOp
+        A CachedOp created with ``thread_safe=True``, whose outputs have the rows of the batch on
+        their first axis.
+    max_batch : int
+        The maximum number of rows of a batch.
+    timeout_us : int
+        The maximum time in microseconds a call waits for the other calls of its batch.
+    """
+    __slots__ = ["handle", "cached_op"]
+
+    def __init__(self, cached_op, max_batch, timeout_us=1000):
+        self.cached_op = cached_op
+        self.handle = CachedOpBatcherHandle()
+        check_call(_LIB.MXCreateCachedOpBatcher(cached_op.handle, ctypes.c_uint32(max_batch),
+                                                ctypes.c_uint32(timeout_us), ctypes.byref(self.handle)))
+
+    def __del__(self):
+        check_call(_LIB.MXFreeCachedOpBatcher(self.handle))
+
+    def __call__(self, *args):
+        num_output = ctypes.c_int(0)
+        output_vars = ctypes.POINTER(NDArrayHandle)()
+        out_stypes = ctypes.POINTER(ctypes.c_int)()
+        check_call(_LIB.MXInvokeCachedOpBatcher(
+            self.handle,
+            ctypes.c_int(len(args)),
+            c_handle_array(args),
+            ctypes.byref(num_output),
+            ctypes.byref(output_vars),
+            ctypes.byref(out_stypes)))
+        if self.cached_op.is_np_sym:
+            create_ndarray_fn = _global_var._np_ndarray_cls
+        else:
+            create_ndarray_fn = _global_var._ndarray_cls
+        outputs = [create_ndarray_fn(ctypes.cast(output_vars[i], NDArrayHandle), stype=out_stypes[i])
+                   for i in range(num_output.value)]
+        return outputs[0] if len(outputs) == 1 else outputs
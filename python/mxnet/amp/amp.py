@@ -21,7 +21,7 @@ __all__ = ['init', 'init_trainer', 'scale_loss', 'unscale', 'convert_model',
            'convert_hybrid_block', 'list_lp16_ops', 'list_fp32_ops',
            'list_lp16_fp32_ops', 'list_conditional_fp32_ops',
            'list_widest_type_cast', 'list_loss_output_functions', 'list_lp16_use_fp32_params',
-           'convert_symbol']
+           'convert_symbol', 'convert_fp8_dense']
 
 from array import array
 import ctypes
@@ -39,7 +39,7 @@ from ..symbol import contrib as symbol_contrib
 from .. import ndarray
 from ..ndarray import NDArray, _DTYPE_NP_TO_MX, _DTYPE_MX_TO_NP
 from . import lists
-from ..gluon import Block, trainer
+from ..gluon import Block, HybridBlock, trainer
 from .. import base
 from ..base import (_NP_OP_PREFIX, _NP_OP_SUBMODULE_LIST, _NP_EXT_OP_PREFIX,
                     _NP_EXT_OP_SUBMODULE_LIST, _NP_INTERNAL_OP_PREFIX,
@@ -290,6 +290,17 @@ _loss_scaler = None
 def scale_loss(loss, optimizer_or_trainer):
     assert optimizer_or_trainer._amp_loss_scaler is not None, \
         'Loss scaler is not initialized, did you forget to call amp.init_trainer()?'
+    loss_scaler = optimizer_or_trainer._amp_loss_scaler
+    if loss_scaler.on_device:
+        # the optimizer divides the gradients by the loss scale of the device
+        def scale(l):
+            loss_scale = loss_scaler.device_state(l.context)[0:1]
+            return l * (loss_scale.as_np_ndarray() if isinstance(l, numpy.ndarray) else loss_scale)
+        if isinstance(loss, (list, tuple)):
+            yield [scale(l) for l in loss]
+        else:
+            yield scale(loss)
+        return
     optimizer_or_trainer._scale = (optimizer_or_trainer._amp_original_scale /
                                    optimizer_or_trainer._amp_loss_scaler.loss_scale)
     if isinstance(loss, (list, tuple)):
@@ -371,13 +382,18 @@ def init(target_dtype='float16', target_precision_ops=None,
                                    get_fun, target_precision_ops, conditional_fp32_ops, fp32_ops)
             _wrap_loss_output_functions(module, _loss_scaler, target_dtype)
 
-def init_trainer(optimizer_or_trainer):
+def init_trainer(optimizer_or_trainer, device_loss_scale=False):
     """Initialize trainer or optimizer to work with AMP dynamic loss scaling.
 
     Parameters
     ----------
     optimizer_or_trainer : Optimizer or Trainer
         MXNet Optimizer or Gluon trainer to initialize with AMP
+    device_loss_scale : bool, default False
+        Whether to keep the loss scale on the devices. The optimizer then skips the steps with
+        gradients that are not finite and unscales the gradients in its kernels, without
+        waiting for the gradients on the host. Requires the SGD optimizer with
+        use_fused_step, dense gradients and update_on_kvstore=False.
     """
     global _amp_loss_scale_initialized
     global _amp_initialized
@@ -390,6 +406,12 @@ def init_trainer(optimizer_or_trainer):
         loss_scaler = LossScaler()
     #_wrap_output
     if isinstance(optimizer_or_trainer, trainer.Trainer):
+        if device_loss_scale:
+            optimizer = optimizer_or_trainer._optimizer
+            if not (isinstance(optimizer, opt.SGD) and optimizer.use_fused_step):
+                raise TypeError("device_loss_scale requires the SGD optimizer with use_fused_step")
+            loss_scaler.init_device_states()
+            optimizer._amp_loss_scaler = loss_scaler
         optimizer_or_trainer._amp_loss_scaler = loss_scaler
         optimizer_or_trainer._amp_original_scale = optimizer_or_trainer._scale
         trainer.Trainer.amp_loss_scale = property(lambda self: self._amp_loss_scaler.loss_scale)
@@ -760,6 +782,58 @@ def convert_hybrid_block(block, target_dtype="float16", target_dtype_ops=None,
     ret.load_dict(arg_dict, ctx=ctx)
     return ret
 
+def convert_fp8_dense(block, amax_history_len=16, margin=0):
+    """Replace the `Dense` layers of a block and of its children with `FP8Dense` layers sharing
+    their parameters, which multiply their inputs and weights rounded to FP8 with delayed per
+    tensor scales. The block is trained or run as before; the parameters `amax_history` of the
+    new layers are states, not trained.
+
+    Parameters
+    ----------
+    block : HybridBlock
+        The block whose `Dense` layers are replaced, in place.
+    amax_history_len : int, default 16
+        Number of training steps of absolute maxima the scales come from.
+    margin : int, default 0
+        The scales map the maxima to the largest FP8 value divided by `2^margin`.
+
+    Returns
+    -------
+    block : HybridBlock
+        The block.
+    """
+    from ..gluon import nn
+    for name, ref in list(block._children.items()):
+        child = ref()
+        if type(child) is not nn.Dense:  # pylint: disable=unidiomatic-typecheck
+            convert_fp8_dense(child, amax_history_len, margin)
+            continue
+        layer = nn.FP8Dense(child._units, amax_history_len=amax_history_len, margin=margin,
+                            use_bias=child.bias is not None, flatten=child._flatten,
+                            in_units=child._in_units)
+        layer.weight = child.weight
+        if child.bias is not None:
+            layer.bias = child.bias
+        if child.act is not None:
+            layer.act = child.act
+        try:
+            layer.amax_history.initialize(ctx=child.weight.list_ctx())
+        except RuntimeError:
+            # initialized with the block
+            pass
+        if getattr(block, name, None) is child:
+            setattr(block, name, layer)
+        else:
+            # the children of Sequential blocks, which keep them in _layers
+            layers = getattr(block, '_layers', [])
+            if child in layers:
+                layers[layers.index(child)] = layer
+            block.register_child(layer, name)
+    if isinstance(block, HybridBlock):
+        block._clear_cached_op()
+    return block
+
+
 def list_lp16_ops(target_dtype):
     """Get the default list of LP16 ops for AMP
     """
@@ -150,6 +150,7 @@ FP32_FUNCS = [
     '_histogram',
     '_identity_with_attr_like_rhs',
     '_image_adjust_lighting',
+    '_image_batch_preprocess',
     '_image_flip_left_right',
     '_image_flip_top_bottom',
     '_image_normalize',
@@ -270,6 +271,7 @@ FP32_FUNCS = [
     'cbrt',
     'ceil',
     'choose_element_0index',
+    'clip_global_norm',
     'cos',
     'crop',
     'degrees',
@@ -296,9 +298,16 @@ FP32_FUNCS = [
     'mish',
     'mp_sgd_mom_update',
     'mp_sgd_update',
+    'multi_adam_update',
     'multi_all_finite',
+    'multi_clip_global_norm',
+    'multi_mp_adam_update',
+    'multi_mp_nag_mom_update',
+    'multi_mp_rmsprop_update',
     'multi_mp_sgd_mom_update',
     'multi_mp_sgd_update',
+    'multi_nag_mom_update',
+    'multi_rmsprop_update',
     'multi_sgd_mom_update',
     'multi_sgd_update',
     'negative',
@@ -410,6 +419,7 @@ FP32_FUNCS = [
     'broadcast_hypot',
     '_square_sum',
     '_contrib_hawkesll',
+    '_contrib_sampled_logits',
 
     # Reductions
     'sum',
@@ -496,6 +506,7 @@ FP32_FUNCS = [
     '_contrib_CTCLoss',
     '_contrib_ctc_loss',
     'ctc_loss',
+    '_contrib_ctc_beam_search',
     '_npx_deformable_convolution',
     '_contrib_DeformablePSROIPooling',
     ]
@@ -580,6 +591,7 @@ WIDEST_TYPE_CASTS = [
     '_contrib_PSROIPooling',
     '_contrib_Proposal',
     '_contrib_ROIAlign',
+    '_contrib_box_detection',
     '_contrib_box_iou',
     '_contrib_box_nms',
     '_contrib_box_non_maximum_suppression',
@@ -129,6 +129,7 @@ FP16_FP32_FUNCS = [
     '_hypot_scalar',
     '_identity_with_attr_like_rhs',
     '_image_adjust_lighting',
+    '_image_batch_preprocess',
     '_image_flip_left_right',
     '_image_flip_top_bottom',
     '_image_normalize',
@@ -380,6 +381,7 @@ FP16_FP32_FUNCS = [
     'cbrt',
     'ceil',
     'clip',
+    'clip_global_norm',
     'col2im',
     'cos',
     'degrees',
@@ -407,10 +409,17 @@ FP16_FP32_FUNCS = [
     'mp_nag_mom_update',
     'mp_sgd_mom_update',
     'mp_sgd_update',
+    'multi_adam_update',
     'multi_all_finite',
+    'multi_clip_global_norm',
     'multi_lars',
+    'multi_mp_adam_update',
+    'multi_mp_nag_mom_update',
+    'multi_mp_rmsprop_update',
     'multi_mp_sgd_mom_update',
     'multi_mp_sgd_update',
+    'multi_nag_mom_update',
+    'multi_rmsprop_update',
     'multi_sgd_mom_update',
     'multi_sgd_update',
     'multi_sum_sq',
@@ -510,6 +519,7 @@ FP32_FUNCS = [
     '_rpower_scalar',
     '_square_sum',
     '_contrib_hawkesll',
+    '_contrib_sampled_logits',
     '_npi_power',
     '_npi_power_scalar',
     '_npi_reciprocal',
@@ -601,6 +611,7 @@ FP32_FUNCS = [
     'make_loss',
     'Custom',
     'CTCLoss',
+    '_contrib_ctc_beam_search',
     '_npx_deformable_convolution',
     '_npx_modulated_deformable_convolution',
     '_contrib_DeformablePSROIPooling',
@@ -702,6 +713,7 @@ WIDEST_TYPE_CASTS = [
     '_contrib_Proposal',
     '_contrib_ROIAlign',
     '_contrib_box_decode',
+    '_contrib_box_detection',
     '_contrib_box_encode',
     '_contrib_box_iou',
     '_contrib_box_nms',
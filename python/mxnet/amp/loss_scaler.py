@@ -37,11 +37,66 @@ class LossScaler(object):
         self._max_loss_scale = 2.**24
         self._scale_seq_len = 2000
         self._unskipped = 0
+        self._device_states = None
 
     @property
     def loss_scale(self):
+        if self._device_states:
+            # waits for the updates of the loss scale on the devices
+            return float(next(iter(self._device_states.values()))[0].asscalar())
         return self._loss_scale
 
+    @property
+    def on_device(self):
+        """Whether the loss scale is kept on the devices, see `init_device_states`."""
+        return self._device_states is not None
+
+    def init_device_states(self):
+        """Keep the loss scale on the devices of the gradients. The steps are then skipped on
+        the devices unless the gradients are finite, without waiting for them on the host."""
+        if self._device_states is None:
+            self._device_states = {}
+
+    def device_state(self, ctx):
+        """The state of the loss scaling on ctx, a float32 NDArray of the loss scale, whether the
+        gradients of the step are finite and the number of finite steps since the loss scale
+        changed."""
+        state = self._device_states.get(ctx)
+        if state is None:
+            state = ndarray.array([self._loss_scale, 1, self._unskipped], ctx=ctx, dtype='float32')
+            self._device_states[ctx] = state
+        return state
+
+    def check_overflow_on_device(self, params, compute_norms=False):
+        """Record in the device states whether the gradients of params are finite.
+
+        With compute_norms, also returns the l2 norms of the gradients of every context, a
+        float32 NDArray in the order of params, computed on the device in the same pass.
+        """
+        grads = {}
+        for p in params:
+            if p._grad is not None:
+                for g in p._grad:
+                    grads.setdefault(g.context, []).append(g.as_nd_ndarray())
+        norms = {}
+        with ag.pause():
+            for ctx, arrays in grads.items():
+                finite = self.device_state(ctx)[1:2]
+                if compute_norms:
+                    norms[ctx] = ndarray.empty((len(arrays),), ctx=ctx, dtype='float32')
+                    ndarray.multi_all_finite(*arrays, num_arrays=len(arrays), compute_norms=True,
+                                             out=[finite, norms[ctx]])
+                else:
+                    ndarray.multi_all_finite(*arrays, num_arrays=len(arrays), out=finite)
+        return norms if compute_norms else None
+
+    def update_on_device(self):
+        """Update the loss scales of the device states after the step."""
+        with ag.pause():
+            for state in self._device_states.values():
+                ndarray.amp_update_loss_scale(state, scale_window=self._scale_seq_len,
+                                              max_loss_scale=self._max_loss_scale, out=state)
+
     def has_overflow(self, params):
         """Check gradients for overflow."""
         if is_np_array():
@@ -51,14 +106,10 @@ class LossScaler(object):
             all_finite_f = ndarray.multi_all_finite
             ones_f = ndarray.ones
         with ag.pause():
-            chunk_size = 200
             valid_params = [p._grad[0] for p in params if p._grad is not None]
             gpu_output = ones_f((1,), ctx=valid_params[0].context)
-            nb_params = len(valid_params)
-            for idx in range(0, nb_params, chunk_size):
-                all_finite_f(*valid_params[idx:idx+chunk_size],
-                             num_arrays=len(valid_params[idx:idx+chunk_size]),
-                             init_output=False, out=gpu_output)
+            all_finite_f(*valid_params, num_arrays=len(valid_params), init_output=False,
+                         out=gpu_output)
         has_overflow = not bool(gpu_output.asnumpy())
         self._loss_scale = self._next_loss_scale
         if has_overflow:
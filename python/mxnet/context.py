@@ -17,6 +17,7 @@
 """Context management API of mxnet."""
 import contextvars
 import ctypes
+import json
 from .base import _LIB
 from .base import check_call
 
@@ -135,6 +136,37 @@ class Context:
         dev_id = ctypes.c_int(self.device_id)
         check_call(_LIB.MXStorageEmptyCache(dev_type, dev_id))
 
+    def memory_pool_stats(self):
+        """Returns the usage statistics of the memory pool of the context's device.
+
+        For the pooled memory managers, each bucket of rounded size reports its
+        free blocks and bytes, the blocks in use and their high-water mark, and
+        the number of allocations served from the pool (hits) or from the
+        device (misses). When the environment variable
+        `MXNET_STORAGE_CALLSITE_STATS` is set, the allocations are also counted
+        by profiler scope and name under `callsites`. When the profiler records
+        the memory, the tensors live at the peak of the memory of the device are
+        listed under `peak`.
+
+        Returns
+        -------
+        dict
+            The statistics, `pool` is empty when the device has no memory pool.
+
+        Examples
+        -------
+        >>> ctx = mx.gpu(0)
+        >>> arr = mx.nd.ones((200,200), ctx=ctx)
+        >>> stats = ctx.memory_pool_stats()
+        >>> stats['pool']['used_bytes']
+        163840
+        """
+        dev_type = ctypes.c_int(self.device_typeid)
+        dev_id = ctypes.c_int(self.device_id)
+        out = ctypes.c_char_p()
+        check_call(_LIB.MXStorageGetPoolStats(dev_type, dev_id, ctypes.byref(out)))
+        return json.loads(out.value.decode('utf-8'))
+
 
 def cpu(device_id=0):
     """Returns a CPU context.
@@ -32,3 +32,5 @@ from . import io
 from . import quantization
 from . import quantization as quant
 from . import tensorrt
+from . import sparsity
+from . import nccl
@@ -0,0 +1,83 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+"""NCCL communicators of the operators across the processes and nodes.
+
+The NCCL synchronized batch norm, ``npx.sync_batch_norm(..., nccl=True)`` and
+``gluon.nn.SyncBatchNorm(use_nccl=True)``, averages its statistics over the GPUs of all the
+processes. One process creates the unique id of the communicators, sends it to the others,
+e.g. with MPI or the launcher of the job, and every process creates the communicators of its
+GPUs before the first forward:
+
+    >>> if rank == 0:
+    ...     unique_id = mx.contrib.nccl.get_unique_id()
+    >>> unique_id = broadcast(unique_id)  # with the tools of the job
+    >>> mx.contrib.nccl.init(unique_id, num_workers * len(gpus), rank * len(gpus),
+    ...                      [mx.gpu(i) for i in gpus])
+
+The operators of a GPU issue their collectives in the order they are pushed, so all the
+processes run the same operators in the same order.
+"""
+import ctypes
+
+from ..base import _LIB, check_call, c_array
+
+__all__ = ['get_unique_id', 'init']
+
+# NCCL_UNIQUE_ID_BYTES
+_UNIQUE_ID_BYTES = 128
+
+
+def get_unique_id():
+    """Creates the unique id of the communicators, on one of the processes.
+
+    Returns
+    -------
+    bytes
+        The id, which every process passes to :py:func:`init`.
+    """
+    buf = ctypes.create_string_buffer(_UNIQUE_ID_BYTES)
+    check_call(_LIB.MXNCCLGetUniqueId(buf, ctypes.c_int(_UNIQUE_ID_BYTES)))
+    return buf.raw
+
+
+def init(unique_id, num_ranks, first_rank, contexts):
+    """Creates the NCCL communicators of the GPUs of this process.
+
+    Parameters
+    ----------
+    unique_id : bytes
+        The id of :py:func:`get_unique_id`, the same on all the processes.
+    num_ranks : int
+        The number of the GPUs of all the processes.
+    first_rank : int
+        The rank of the first GPU of this process, the others follow.
+    contexts : list of Context
+        The GPUs of this process.
+    """
+    if len(unique_id) != _UNIQUE_ID_BYTES:
+        raise ValueError('The NCCL unique id has {} bytes'.format(_UNIQUE_ID_BYTES))
+    dev_ids = [ctx.device_id for ctx in contexts]
+    if any(ctx.device_type != 'gpu' for ctx in contexts):
+        raise ValueError('The NCCL communicators are of the gpu contexts')
+    check_call(_LIB.MXNCCLInitComms(ctypes.create_string_buffer(unique_id, _UNIQUE_ID_BYTES),
+                                    ctypes.c_int(_UNIQUE_ID_BYTES),
+                                    ctypes.c_int(num_ranks),
+                                    ctypes.c_int(first_rank),
+                                    ctypes.c_int(len(dev_ids)),
+                                    c_array(ctypes.c_int, dev_ids)))
@@ -18,6 +18,7 @@
 
 import abc
 import ctypes
+import json
 import logging
 import os
 import warnings
@@ -60,9 +61,19 @@ def _quantize_params(qsym, params, min_max_dict):
         min_fn = mx.nd.min
         max_fn = mx.nd.max
         array_cls = mx.nd
+    rowwise_quantize_fn = mx.npx.rowwise_quantize if is_np_array() else mx.nd.contrib.rowwise_quantize
+    # the bits of the tables quantized row by row, by the name of their quantized table
+    rowwise_bits = {}
+    nodes = json.loads(qsym.tojson())['nodes']
+    for node in nodes:
+        if node['op'] == '_contrib_rowwise_quantized_embedding':
+            rowwise_bits[nodes[node['inputs'][1][0]]['name']] = int(node['attrs']['bits'])
 
     for name in inputs_name:
-        if name.endswith(('weight_quantize', 'bias_quantize')):
+        if name.endswith('_rowwise_quantize'):
+            param = params[name[:-len('_rowwise_quantize')]]
+            quantized_params[name] = rowwise_quantize_fn(param, bits=rowwise_bits.get(name, 8))
+        elif name.endswith(('weight_quantize', 'bias_quantize')):
             original_name = name[:-len('_quantize')]
             param = params[original_name]
             # pylint: disable=unbalanced-tuple-unpacking
@@ -162,6 +173,58 @@ def _quantize_symbol(sym, ctx, excluded_symbols=None, excluded_operators=None,
     return Symbol(out), calib_layers
 
 
+def _fake_quantize_symbol(sym, ctx, excluded_symbols=None, excluded_operators=None,
+                          quantized_dtype='int8', quantize_mode='full',
+                          quantize_granularity='tensor-wise'):
+    """Given a symbol object representing a neural network of data type FP32, insert a
+    `_contrib_fake_quantize` before each input which `_quantize_symbol` would quantize, for
+    quantization-aware training. Returns the symbol and the names of the fake quantized entries.
+    The scale of the fake quantization of an entry is the variable `<name>_fq_scale`.
+
+    Parameters
+    ----------
+    sym : Symbol
+        FP32 neural network symbol.
+    ctx : Context
+        Defines the device that the trained model will be quantized for.
+    excluded_symbols : list of strings
+        A list of strings representing the names of the symbols that users want to excluding
+        from being quantized.
+    excluded_operators : list of strings
+        A list of strings representing the names of the operators that users want to excluding
+        from being quantized.
+    quantized_dtype: str
+        The quantized destination type for input data.
+    quantize_mode: str
+        The mode that quantization pass to apply.
+    quantize_granularity: str
+        The granularity of quantization, currently supports 'tensor-wise' and 'channel-wise'
+        quantization. The default value is 'tensor-wise'.
+    """
+    if excluded_symbols is None:
+        excluded_symbols = []
+    if excluded_operators is None:
+        excluded_operators = []
+
+    out = SymbolHandle()
+    size = mx_uint()
+    entry_str = ctypes.POINTER(ctypes.c_char_p)()
+    check_call(_LIB.MXFakeQuantizeSymbol(sym.handle,
+                                         ctypes.byref(out),
+                                         ctypes.byref(ctypes.c_int(ctx.device_typeid)),
+                                         mx_uint(len(excluded_symbols)),
+                                         c_str_array(excluded_symbols),
+                                         mx_uint(len(excluded_operators)),
+                                         c_str_array(excluded_operators),
+                                         c_str(quantized_dtype),
+                                         c_str(quantize_mode),
+                                         c_str(quantize_granularity),
+                                         ctypes.byref(size),
+                                         ctypes.byref(entry_str)))
+    entries = [py_str(entry_str[i]) for i in range(size.value)]
+    return Symbol(out), entries
+
+
 class CalibrationCollector(object):
     """Base class for all other collectors used with quantization"""
     __metaclass__ = abc.ABCMeta
@@ -206,32 +269,42 @@ class _LayerHistogramCollector(CalibrationCollector):
         self.quantized_dtype = quantized_dtype
 
     def collect(self, name, op_name, arr):
-        """Callback function for collecting layer output NDArrays."""
+        """Callback function for collecting layer output NDArrays. The histograms are computed
+        on the device of arr, so that only the bins are copied to the host."""
         if name not in self.include_layers:
             return
-        arr = arr.copyto(cpu()).asnumpy()
         if self.logger:
             self.logger.debug("Collecting layer %s histogram of shape %s" % (name, arr.shape))
-        min_range = np.min(arr)
-        max_range = np.max(arr)
+        min_range = arr.min().asscalar()
+        max_range = arr.max().asscalar()
         th = max(abs(min_range), abs(max_range))
         if name in self.hist_dict:
             self.hist_dict[name] = self.combine_histogram(self.hist_dict[name], arr, min_range, max_range, th)
         else:
-            hist, hist_edges = np.histogram(arr, bins=self.num_bins, range=(-th, th))
+            hist, hist_edges = self._histogram(arr, self.num_bins, th)
             self.hist_dict[name] = (hist, hist_edges, min_range, max_range, th)
 
     def post_collect(self):
         min_max_dict = self.get_optimal_thresholds(self.hist_dict, self.quantized_dtype, logger=self.logger)
         return min_max_dict
 
+    @staticmethod
+    def _histogram(arr, num_bins, th):
+        """The histogram of the numpy array or NDArray arr in num_bins bins over [-th, th]."""
+        if isinstance(arr, np.ndarray) or th == 0:
+            # numpy widens the empty range to [-0.5, 0.5]
+            arr = arr if isinstance(arr, np.ndarray) else arr.asnumpy()
+            return np.histogram(arr, bins=num_bins, range=(-th, th))
+        hist, hist_edges = ndarray.histogram(arr, bins=num_bins, range=(-th, th))
+        return hist.asnumpy(), hist_edges.asnumpy()
+
     @staticmethod
     def combine_histogram(old_hist, arr, new_min, new_max, new_th):
         """ Collect layer histogram for arr and combine it with old histogram.
         """
         (old_hist, old_hist_edges, old_min, old_max, old_th) = old_hist
         if new_th <= old_th:
-            hist, _ = np.histogram(arr, bins=len(old_hist), range=(-old_th, old_th))
+            hist, _ = _LayerHistogramCollector._histogram(arr, len(old_hist), old_th)
             return (old_hist + hist, old_hist_edges, min(old_min, new_min), max(old_max, new_max), old_th)
         else:
             # Need to generate new histogram with new_th
@@ -240,19 +313,15 @@ class _LayerHistogramCollector(CalibrationCollector):
             half_increased_bins = int((new_th - old_th) // old_step + 1)
             new_num_bins = half_increased_bins * 2 + old_num_bins
             new_th = half_increased_bins * old_step + old_th
-            hist, hist_edges = np.histogram(arr, bins=new_num_bins, range=(-new_th, new_th))
+            hist, hist_edges = _LayerHistogramCollector._histogram(arr, new_num_bins, new_th)
             hist[half_increased_bins:new_num_bins - half_increased_bins] += old_hist
             return (hist, hist_edges, min(old_min, new_min), max(old_max, new_max), new_th)
 
     # pylint: disable=line-too-long
     @staticmethod
-    def get_optimal_threshold(hist_data, quantized_dtype, num_quantized_bins=255):
-        """Given a dataset, find the optimal threshold for quantizing it.
-        The reference distribution is `q`, and the candidate distribution is `p`.
-        `q` is a truncated version of the original distribution.
-
-        Ref: http://on-demand.gputechconf.com/gtc/2017/presentation/s7310-8-bit-inference-with-tensorrt.pdf
-        """
+    def _push_optimal_threshold(hist_data, quantized_dtype, num_quantized_bins=255):
+        """Pushes the search of the threshold of get_optimal_threshold to the engine, and returns
+        its threshold and divergence as NDArrays."""
         (hist, hist_edges, min_val, max_val, _) = hist_data
         num_bins = len(hist)
         assert (num_bins % 2 == 1)
@@ -264,9 +333,19 @@ class _LayerHistogramCollector(CalibrationCollector):
         threshold, divergence = ndarray.contrib.calibrate_entropy(hist=hist,
                                                                   hist_edges=hist_edges,
                                                                   num_quantized_bins=num_quantized_bins)
-        threshold = threshold.asnumpy()
-        divergence = divergence.asnumpy()
         return min_val, max_val, threshold, divergence
+
+    @staticmethod
+    def get_optimal_threshold(hist_data, quantized_dtype, num_quantized_bins=255):
+        """Given a dataset, find the optimal threshold for quantizing it.
+        The reference distribution is `q`, and the candidate distribution is `p`.
+        `q` is a truncated version of the original distribution.
+
+        Ref: http://on-demand.gputechconf.com/gtc/2017/presentation/s7310-8-bit-inference-with-tensorrt.pdf
+        """
+        min_val, max_val, threshold, divergence = _LayerHistogramCollector._push_optimal_threshold(
+            hist_data, quantized_dtype, num_quantized_bins)
+        return min_val, max_val, threshold.asnumpy(), divergence.asnumpy()
     # pylint: enable=line-too-long
 
     @staticmethod
@@ -279,21 +358,98 @@ class _LayerHistogramCollector(CalibrationCollector):
         th_dict = {}
         # copy hist_dict keys since the keys() only returns a view in python3
         layer_names = list(hist_dict.keys())
+        # the searches of all the layers are pushed first, so that the engine runs them concurrently
+        # with MXNET_CPU_WORKER_NTHREADS > 1
+        searches = {}
         for name in layer_names:
             assert name in hist_dict
-            min_val, max_val, th, divergence = \
-                _LayerHistogramCollector.get_optimal_threshold(hist_dict[name], quantized_dtype,
-                                                               num_quantized_bins=num_quantized_bins)
+            searches[name] = _LayerHistogramCollector._push_optimal_threshold(
+                hist_dict[name], quantized_dtype, num_quantized_bins=num_quantized_bins)
+            del hist_dict[name]  # release the memory
+        for name in layer_names:
+            min_val, max_val, th, divergence = searches.pop(name)
+            th, divergence = th.asnumpy(), divergence.asnumpy()
             if min_val >= 0 and quantized_dtype in ['auto', 'uint8']:
                 th_dict[name] = (0, th)
             else:
                 th_dict[name] = (-th, th)
-            del hist_dict[name]  # release the memory
             if logger:
                 logger.debug(f"layer={name}, min_val={min_val}, max_val={max_val}, th={th}, divergence={divergence}")
         return th_dict
 
 
+class _LayerHistogramThresholdCollector(_LayerHistogramCollector):
+    """Collects the histograms of the layers as _LayerHistogramCollector, and derives the thresholds
+    from the histograms of the absolute values of the layer outputs: the `percentile` of the
+    values with calib_mode='percentile', or the threshold minimizing the mean squared error of
+    the quantized values with calib_mode='mse'.
+    """
+    def __init__(self, quantized_dtype, calib_mode, percentile=99.99, num_bins=8001,
+                 include_layers=None, logger=None):
+        super(_LayerHistogramThresholdCollector, self).__init__(quantized_dtype, num_bins=num_bins,
+                                                                include_layers=include_layers,
+                                                                logger=logger)
+        if calib_mode not in ('percentile', 'mse'):
+            raise ValueError('unknown calibration mode %s received, expected `percentile` or `mse`'
+                             % calib_mode)
+        self.calib_mode = calib_mode
+        self.percentile = percentile
+
+    @staticmethod
+    def _abs_histogram(hist, hist_edges):
+        """The counts and the bin centers of the absolute values of a histogram symmetric in 0."""
+        hist = np.asarray(hist, dtype=np.float64)
+        hist_edges = np.asarray(hist_edges, dtype=np.float64)
+        zero_bin = len(hist) // 2
+        abs_hist = hist[zero_bin:].copy()
+        abs_hist[1:] += hist[zero_bin - 1::-1]
+        centers = (hist_edges[zero_bin + 1:] + hist_edges[zero_bin:-1]) / 2
+        centers[0] = 0
+        return abs_hist, centers, hist_edges[zero_bin + 1:]
+
+    @staticmethod
+    def get_percentile_threshold(hist_data, percentile):
+        """The smallest bin edge below which `percentile` percents of the absolute values are."""
+        (hist, hist_edges, _, _, _) = hist_data
+        abs_hist, _, edges = _LayerHistogramThresholdCollector._abs_histogram(hist, hist_edges)
+        cumsum = np.cumsum(abs_hist)
+        if cumsum[-1] == 0:
+            return edges[-1]
+        idx = np.searchsorted(cumsum, cumsum[-1] * percentile / 100.0)
+        return edges[min(idx, len(edges) - 1)]
+
+    @staticmethod
+    def get_mse_threshold(hist_data, quantized_dtype, num_candidates=256):
+        """The bin edge minimizing the mean squared error of quantizing the absolute values into
+        the levels of the quantized type with it, among num_candidates evenly spaced edges."""
+        (hist, hist_edges, min_val, _, _) = hist_data
+        abs_hist, centers, edges = _LayerHistogramThresholdCollector._abs_histogram(hist, hist_edges)
+        levels = 255 if min_val >= 0 and quantized_dtype in ['auto', 'uint8'] else 127
+        stride = max(len(edges) // num_candidates, 1)
+        candidates = edges[stride - 1::stride]
+        steps = candidates[:, None] / levels
+        quantized = np.minimum(np.round(centers[None, :] / steps), levels) * steps
+        errors = ((centers[None, :] - quantized) ** 2 * abs_hist[None, :]).sum(axis=1)
+        return candidates[np.argmin(errors)]
+
+    def post_collect(self):
+        th_dict = {}
+        for name, hist_data in self.hist_dict.items():
+            if self.calib_mode == 'percentile':
+                th = self.get_percentile_threshold(hist_data, self.percentile)
+            else:
+                th = self.get_mse_threshold(hist_data, self.quantized_dtype)
+            min_val = hist_data[2]
+            if min_val >= 0 and self.quantized_dtype in ['auto', 'uint8']:
+                th_dict[name] = (0, th)
+            else:
+                th_dict[name] = (-th, th)
+            if self.logger:
+                self.logger.debug(f"layer={name}, min_val={min_val}, max_val={hist_data[3]}, th={th}")
+        self.hist_dict = {}
+        return th_dict
+
+
 class _LayerOutputMinMaxCollector(CalibrationCollector):
     """Saves layer output min and max values in a dict with layer names as keys.
     The collected min and max values will be directly used as thresholds for quantization.
@@ -323,6 +479,35 @@ class _LayerOutputMinMaxCollector(CalibrationCollector):
                               % (name, min_range, max_range))
 
 
+class _LayerOutputEMACollector(CalibrationCollector):
+    """Saves the exponential moving averages of the min and max values of the layer outputs over
+    the batches, the observers giving the initial scales of quantization-aware training.
+    """
+    def __init__(self, momentum=0.9, include_layers=None, logger=None):
+        super(_LayerOutputEMACollector, self).__init__()
+        self.min_max_dict = {}
+        self.momentum = momentum
+        self.include_layers = include_layers
+        self.logger = logger
+
+    def collect(self, name, op_name, arr):
+        """Callback function for updating the moving averages of min and max with an NDArray."""
+        if name not in self.include_layers:
+            return
+        min_range = float(arr.min().asnumpy())
+        max_range = float(arr.max().asnumpy())
+        if name in self.min_max_dict:
+            cur_min_max = self.min_max_dict[name]
+            m = self.momentum
+            self.min_max_dict[name] = (m * cur_min_max[0] + (1 - m) * min_range,
+                                       m * cur_min_max[1] + (1 - m) * max_range)
+        else:
+            self.min_max_dict[name] = (min_range, max_range)
+        if self.logger:
+            self.logger.debug("Collecting layer %s min_range=%f, max_range=%f"
+                              % (name, min_range, max_range))
+
+
 def _calibrate_quantized_sym(qsym, min_max_dict):
     """Given a dictionary containing the thresholds for quantizing the layers,
     set the thresholds into the quantized symbol as the params of requantize operators.
@@ -427,6 +612,10 @@ def quantize_model(sym, arg_params, aux_params, data_names=('data',),
         If calib_mode='entropy' (default mode), the thresholds for quantization will be
         derived such that the KL divergence between the distributions of FP32 layer outputs and
         quantized layer outputs is minimized based upon the calibration dataset.
+        If calib_mode='percentile', the thresholds for quantization will be the 99.99th
+        percentiles of the absolute values of the layer outputs.
+        If calib_mode='mse', the thresholds for quantization will be derived such that the mean
+        squared error of the quantized layer outputs is minimized.
     calib_data : DataLoader
         A DataLoader initialized by the calibration dataset.
     num_calib_batches : int or None
@@ -505,10 +694,14 @@ def quantize_model(sym, arg_params, aux_params, data_names=('data',),
             collector = _LayerOutputMinMaxCollector(quantized_dtype=quantized_dtype,
                                                     include_layers=calib_layers,
                                                     logger=logger)
-
+        elif calib_mode in ('percentile', 'mse'):
+            collector = _LayerHistogramThresholdCollector(quantized_dtype=quantized_dtype,
+                                                          calib_mode=calib_mode,
+                                                          include_layers=calib_layers,
+                                                          logger=logger)
         else:
             raise ValueError('unknown calibration mode %s received,'
-                             ' expected `none`, `naive`, or `entropy`' % calib_mode)
+                             ' expected `none`, `naive`, `entropy`, `percentile` or `mse`' % calib_mode)
 
         num_batches = _collect_layer_statistics(sym_block, calib_data, collector,
                                                 len(inputs), num_calib_batches, logger)
@@ -607,6 +800,10 @@ def quantize_graph(sym, arg_params, aux_params, ctx=cpu(),
         If calib_mode='entropy' (default mode), the thresholds for quantization will be
         derived such that the KL divergence between the distributions of FP32 layer outputs and
         quantized layer outputs is minimized based upon the calibration dataset.
+        If calib_mode='percentile', the thresholds for quantization will be the 99.99th
+        percentiles of the absolute values of the layer outputs.
+        If calib_mode='mse', the thresholds for quantization will be derived such that the mean
+        squared error of the quantized layer outputs is minimized.
     quantized_dtype : str
         The quantized destination type for input data. Currently support 'int8'
         , 'uint8' and 'auto'. 'auto' means automatically select output type according to calibration result.
@@ -666,6 +863,12 @@ def quantize_graph(sym, arg_params, aux_params, ctx=cpu(),
             if logger:
                 logger.info(
                     'Create a layer output minmax collector for naive calibration')
+        elif calib_mode in ('percentile', 'mse'):
+            collector = _LayerHistogramThresholdCollector(quantized_dtype=quantized_dtype,
+                                                          calib_mode=calib_mode,
+                                                          include_layers=calib_layers, logger=logger)
+            if logger:
+                logger.info('Create a layer output collector for %s calibration' % calib_mode)
         elif calib_mode == 'custom' and LayerOutputCollector is not None:
             if not isinstance(LayerOutputCollector, CalibrationCollector):
                 raise ValueError('LayerOutputCollecotr must be a subclass of a CalibrationCollector class,'
@@ -683,8 +886,8 @@ def quantize_graph(sym, arg_params, aux_params, ctx=cpu(),
                 logger.info(
                     'Create a custom layer output minmax collector for calibration')
         else:
-            raise ValueError('unknown calibration mode %s received,'
-                             ' expected `none`, `naive`, `entropy` or `custom`' % calib_mode)
+            raise ValueError('unknown calibration mode %s received, expected `none`, `naive`,'
+                             ' `entropy`, `percentile`, `mse` or `custom`' % calib_mode)
         if logger:
             logger.info('Collector created, please use set_monitor_callback'
                         ' to collect calibration information.')
@@ -723,6 +926,10 @@ def calib_graph(qsym, arg_params, aux_params, collector,
         If calib_mode='entropy' (default mode), the thresholds for quantization will be
         derived such that the KL divergence between the distributions of FP32 layer outputs and
         quantized layer outputs is minimized based upon the calibration dataset.
+        If calib_mode='percentile', the thresholds for quantization will be the 99.99th
+        percentiles of the absolute values of the layer outputs.
+        If calib_mode='mse', the thresholds for quantization will be derived such that the mean
+        squared error of the quantized layer outputs is minimized.
     quantized_dtype : str
         The quantized destination type for input data. Currently support 'int8'
         , 'uint8' and 'auto'. 'auto' means automatically select output type according to calibration result.
@@ -736,12 +943,13 @@ def calib_graph(qsym, arg_params, aux_params, collector,
     """
     min_max_dict = {}
     if calib_mode is not None and calib_mode != 'none':
-        if calib_mode in ('entropy', 'naive', 'custom'):
+        if calib_mode in ('entropy', 'naive', 'percentile', 'mse', 'custom'):
             min_max_dict = collector.post_collect()
 
         else:
             raise ValueError('unknown calibration mode %s received,'
-                             ' expected `none`, `naive`, `entropy` or `custom`' % calib_mode)
+                             ' expected `none`, `naive`, `entropy`, `percentile`, `mse` or `custom`'
+                             % calib_mode)
         qsym = _calibrate_quantized_sym(qsym, min_max_dict)
     else:
         raise ValueError('Please set calibration mode to naive, entropy or custom (with custom CalibrationCollector)')
@@ -800,6 +1008,10 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         If calib_mode='entropy' (default mode), the thresholds for quantization will be
         derived such that the KL divergence between the distributions of FP32 layer outputs and
         quantized layer outputs is minimized based upon the calibration dataset.
+        If calib_mode='percentile', the thresholds for quantization will be the 99.99th
+        percentiles of the absolute values of the layer outputs.
+        If calib_mode='mse', the thresholds for quantization will be derived such that the mean
+        squared error of the quantized layer outputs is minimized.
         If calib_mode='custom', the provided LayerOutputCollector will be used to determine
         the thresholds for quantization. For more information refer to CalibrationCollector
         documentation.
@@ -913,7 +1125,7 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         if calib_data is None:
             raise ValueError(
                 'calib_data must be provided when calib_mode=%s' % calib_mode)
-        if calib_mode in ['naive', 'entropy', 'custom']:
+        if calib_mode in ['naive', 'entropy', 'percentile', 'mse', 'custom']:
             inputs = [mx.sym.var(desc.name) for desc in data_descs]
             calib_net = SymbolBlock(symnet, inputs)
             calib_net.load_dict(params, cast_dtype=True, dtype_source='saved')
@@ -929,7 +1141,7 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
                 qsym=qsym, arg_params=args, aux_params=auxs, collector=collector,
                 calib_mode=calib_mode, logger=logger)
         else:
-            raise ValueError('calib_mode has to be one of: naive, entropy, custom')
+            raise ValueError('calib_mode has to be one of: naive, entropy, percentile, mse, custom')
     elif calib_mode is not None and calib_mode == 'none':
         inputs = [mx.sym.var(desc.name) for desc in data_descs]
 
@@ -939,3 +1151,124 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
     net.load_dict(all_params, cast_dtype=True, dtype_source='saved')
     net.optimize_for(data_nd, backend=backend, skip_infer=True)
     return net
+
+
+def fake_quantize_net(network, calib_data, quantized_dtype='int8', quantize_mode='full',
+                      quantize_granularity='tensor-wise', exclude_layers=None, exclude_operators=None,
+                      num_calib_batches=None, momentum=0.9, ctx=cpu(), logger=None):
+    """User-level API for Gluon users to generate a SymbolBlock for quantization-aware training from
+    a FP32 HybridBlock. The inputs that `quantize_net` would quantize are fake quantized, i.e.
+    quantized and dequantized back with a learnable scale, and the gradients pass straight through
+    the rounding, so that the network learns weights which are accurate once quantized.
+
+    The initial scales of the weights are their absolute max values, per output channel with
+    channel-wise granularity, and the ones of the activations are the exponential moving averages
+    of their min and max values over the batches of calib_data, both divided by the max quantized
+    value. After training, the fake quantized inputs are quantized with the learned ranges by
+    `quantize_net` with `calib_mode='custom'`, given the scales times the max quantized value.
+
+    Parameters
+    ----------
+    network : Gluon HybridBlock
+        Defines the structure of a neural network for FP32 data types.
+    calib_data : gluon.DataLoader
+        A iterable data loading object, the batches of which initialize the scales of the
+        activations.
+    quantized_dtype : str
+        The quantized destination type for input data. Currently support 'int8' and 'uint8'.
+    quantize_mode : str
+        The mode that quantization pass to apply. Support 'full' and 'smart'.
+    quantize_granularity: str
+        The granularity of quantization, currently supports 'tensor-wise' and 'channel-wise'
+        quantization. The default value is 'tensor-wise'.
+    exclude_layers : list of strings
+        A list of strings representing the names of the symbols that users want to excluding
+        from being quantized.
+    exclude_operators : list of strings
+        A list of strings representing the names of the operators that users want to excluding
+        from being quantized.
+    num_calib_batches : int or None
+        The maximum number of batches of calib_data to initialize the scales with. If not
+        provided, the whole dataset will be used.
+    momentum : float
+        The momentum of the moving averages of the min and max values of the activations.
+    ctx : Context
+        Defines the device that the trained model will be quantized for, and the one the
+        returned network runs on.
+    logger : Object
+        A logging object for printing information during the process of quantization.
+
+    Returns
+    -------
+    network : Gluon SymbolBlock
+        Defines the structure of the fake quantized neural network. Its `<name>_fq_scale`
+        parameters are the scales of the fake quantized entries.
+    """
+    from ..gluon import SymbolBlock
+
+    if not isinstance(calib_data, mx.gluon.data.DataLoader):
+        raise ValueError('calib_data expects mx.gluon.data.DataLoader, while received type %s'
+                         % str(type(calib_data)))
+    if quantized_dtype not in ('int8', 'uint8'):
+        raise ValueError('unknown quantized_dtype %s received,'
+                         ' expected `int8` or `uint8`' % quantized_dtype)
+    network.hybridize(static_alloc=False, static_shape=False)
+    batch = next(iter(calib_data))
+    batch = batch if isinstance(batch, list) else [batch]
+    network(*[b.as_in_context(ctx) for b in batch])
+    symnet, params = network.export(None)
+    if is_np_array():
+        symnet = symnet.as_np_ndarray()
+    params = {k[4:]: v for k, v in params.items()}
+    data_names = [name for name in symnet.list_inputs() if name not in params]
+
+    fsym, entries = _fake_quantize_symbol(symnet, ctx, excluded_symbols=exclude_layers,
+                                          excluded_operators=exclude_operators,
+                                          quantized_dtype=quantized_dtype,
+                                          quantize_mode=quantize_mode,
+                                          quantize_granularity=quantize_granularity)
+    qmax = 255. if quantized_dtype == 'uint8' else 127.
+    attrs = fsym.attr_dict()
+
+    collector = _LayerOutputEMACollector(momentum=momentum, include_layers=set(entries), logger=logger)
+    inputs = [mx.sym.var(name) for name in data_names]
+    calib_net = SymbolBlock(symnet, inputs)
+    calib_net.load_dict(params, ctx=ctx, cast_dtype=True, dtype_source='saved')
+    calib_net.hybridize(static_alloc=False, static_shape=False)
+    calib_net.register_op_hook(collector.collect, monitor_all=True)
+    num_batches = 0
+    for batch in calib_data:
+        batch = batch if isinstance(batch, list) else [batch]
+        batch = [b.as_in_context(ctx) for b in batch[:len(data_names)]]
+        for name, b in zip(data_names, batch):
+            collector.collect(name, None, b)
+        calib_net(*batch)
+        num_batches += 1
+        if num_calib_batches is not None and num_batches >= num_calib_batches:
+            break
+    if logger:
+        logger.info('Collected the ranges of %d fake quantized entries from %d batches'
+                    % (len(entries), num_batches))
+
+    all_params = dict(params)
+    for name in entries:
+        if name in params:
+            weight = np.abs(params[name].asnumpy())
+            if 'axis' in attrs.get(name + '_fake_quantize', {}):
+                th = weight.reshape(weight.shape[0], -1).max(axis=1)
+            else:
+                th = weight.max().reshape(1)
+        elif name in collector.min_max_dict:
+            min_range, max_range = collector.min_max_dict[name]
+            th = max(max_range, 0.) if quantized_dtype == 'uint8' else max(abs(min_range), abs(max_range))
+            th = np.array([th])
+        else:
+            if logger:
+                logger.warning('No range of %s was collected, its scale is 1' % name)
+            th = np.array([qmax])
+        scale = np.maximum(th, 1e-8) / qmax
+        all_params[name + '_fq_scale'] = scale.astype(np.float32)
+
+    net = SymbolBlock(fsym, inputs)
+    net.load_dict(all_params, ctx=ctx, cast_dtype=True, dtype_source='saved')
+    return net
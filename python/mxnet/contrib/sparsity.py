@@ -0,0 +1,102 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""2:4 structured sparsity of the weights of FullyConnected and Convolution layers.
+
+The weights pruned by :py:func:`prune_2_4` keep at most 2 nonzeros in each 4 consecutive elements
+of their rows, the first axis being the output units or filters. The ``CUSPARSELT`` backend of
+``optimize_for`` runs the layers with such weights on the sparse GEMMs of cuSPARSELt on Ampere or
+later GPUs, FullyConnected and the 1x1 Convolution with unit strides and no padding.
+
+    >>> net.initialize()
+    >>> ... # train the dense network, prune, and fine-tune with the pruning mask
+    >>> mx.contrib.sparsity.prune_block_2_4(net)
+    >>> net.optimize_for(x, backend='CUSPARSELT')
+"""
+from ..ndarray import NDArray
+from .. import ndarray as nd
+
+__all__ = ['prune_2_4', 'is_2_4_sparse', 'prune_block_2_4']
+
+
+def _groups(weight):
+    """The groups of 4 consecutive elements of the rows of the weight, as a (-1, 4) NDArray"""
+    if not isinstance(weight, NDArray):
+        weight = weight.as_nd_ndarray()
+    if len(weight.shape) < 2 or (weight.size // weight.shape[0]) % 4 != 0:
+        raise ValueError('The rows of a 2:4 sparse weight have a multiple of 4 elements, '
+                         'got a weight of shape {}'.format(weight.shape))
+    return weight.reshape((-1, 4))
+
+
+def prune_2_4(weight):
+    """Returns the weight with the 2 elements of the least magnitude of each 4 consecutive elements
+    of its rows set to zero.
+
+    Parameters
+    ----------
+    weight : NDArray or mxnet.numpy.ndarray
+        The weight of a FullyConnected or a Convolution, whose rows have a multiple of 4 elements.
+
+    Returns
+    -------
+    NDArray or mxnet.numpy.ndarray
+        The pruned weight, of the type of the weight.
+    """
+    groups = _groups(weight)
+    mask = nd.topk(nd.abs(groups), axis=1, k=2, ret_typ='mask')
+    pruned = (groups * mask).reshape(weight.shape)
+    return pruned if isinstance(weight, NDArray) else pruned.as_np_ndarray()
+
+
+def is_2_4_sparse(weight):
+    """Whether each 4 consecutive elements of the rows of the weight have at most 2 nonzeros."""
+    try:
+        groups = _groups(weight)
+    except ValueError:
+        return False
+    return int((groups != 0).sum(axis=1).max().asscalar()) <= 2
+
+
+def prune_block_2_4(block, allow_missing=True):
+    """Prunes the weights of the FullyConnected and Convolution layers of a Gluon block to 2:4.
+
+    Parameters
+    ----------
+    block : mxnet.gluon.Block
+        The initialized block, e.g. with ``nn.Dense`` and ``nn.Conv2D`` layers.
+    allow_missing : bool
+        Whether to skip the weights whose rows do not have a multiple of 4 elements, instead of
+        raising a ValueError.
+
+    Returns
+    -------
+    list of str
+        The names of the pruned parameters.
+    """
+    pruned = []
+    for name, param in block.collect_params().items():
+        if not name.endswith('weight') or len(param.shape) < 2:
+            continue
+        if (param.data().size // param.shape[0]) % 4 != 0:
+            if allow_missing:
+                continue
+            raise ValueError('Cannot prune {} of shape {} to 2:4'.format(name, param.shape))
+        param.set_data(prune_2_4(param.data()))
+        pruned.append(name)
+    return pruned
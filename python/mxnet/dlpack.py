@@ -95,6 +95,9 @@ def ndarray_from_dlpack(array_cls):
     """
     def from_dlpack(dlpack):
         handle = NDArrayHandle()
+        if hasattr(dlpack, '__dlpack__'):
+            # the legacy default stream of the producer orders it with the streams of mxnet
+            dlpack = dlpack.__dlpack__()
         dlpack = ctypes.py_object(dlpack)
         assert ctypes.pythonapi.PyCapsule_IsValid(dlpack, _c_str_dltensor), ValueError(
             'Invalid DLPack Tensor. DLTensor capsules can be consumed only once.')
@@ -137,6 +140,26 @@ def ndarray_to_dlpack_for_write():
         return ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor, _c_dlpack_deleter)
     return to_dlpack_for_write
 
+def ndarray_to_dlpack_for_stream():
+    """Returns a function that returns dlpack for use on a stream of the consumer from mxnet array,
+    following the ``__dlpack__`` protocol.
+
+    Returns
+    -------
+    fn : tensor, stream -> dlpack
+    """
+    def to_dlpack_for_stream(data, stream=None, for_write=False):
+        dlpack = DLPackHandle()
+        # None is the legacy default stream of CUDA, and is ignored for the other devices
+        stream = 1 if stream is None else stream
+        check_call(_LIB.MXNDArrayToDLPackStream(data.handle, ctypes.c_int64(stream),
+                                                ctypes.c_bool(for_write), ctypes.byref(dlpack)))
+        return ctypes.pythonapi.PyCapsule_New(dlpack, _c_str_dltensor, _c_dlpack_deleter)
+    return to_dlpack_for_stream
+
+# DLDeviceType of the device types of Context
+DLPACK_DEVICE_TYPE = {'cpu': 1, 'gpu': 2, 'cpu_pinned': 3, 'cpu_shared': 1}
+
 def ndarray_from_numpy(array_cls, array_create_fn):
     """Returns a function that creates array_cls from numpy array.
 
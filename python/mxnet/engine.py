@@ -45,6 +45,28 @@ def set_bulk_size(size):
     return prev.value
 
 
+def adaptive_bulk_stats():
+    """Get the counters of adaptive bulking.
+
+    Adaptive bulking is enabled with the environment variable
+    `MXNET_ENGINE_ADAPTIVE_BULK`. Operators whose measured execution time is
+    below the dispatch overhead threshold are merged into bulks automatically.
+
+    Returns
+    -------
+    dict
+        `merged`: number of operators merged into adaptive bulks,
+        `bulks`: number of adaptive bulks pushed to execution,
+        `timed`: number of operators pushed alone and timed.
+    """
+    merged = ctypes.c_uint64()
+    bulks = ctypes.c_uint64()
+    timed = ctypes.c_uint64()
+    check_call(_LIB.MXEngineGetAdaptiveBulkStats(
+        ctypes.byref(merged), ctypes.byref(bulks), ctypes.byref(timed)))
+    return {'merged': merged.value, 'bulks': bulks.value, 'timed': timed.value}
+
+
 class _BulkScope(object):
     """Scope object for bulk execution."""
     def __init__(self, size):
@@ -59,6 +81,108 @@ class _BulkScope(object):
         set_bulk_size(self._old_size)
 
 
+def set_priority(priority):
+    """Set the priority added to the operators pushed from the current thread.
+
+    When the environment variable `MXNET_ENGINE_PRIORITY_SCHEDULING` is set,
+    ready operators with higher priority run before ready operators with
+    lower priority. This lets latency critical requests overtake batch
+    traffic sharing the same process.
+
+    Parameters
+    ----------
+    priority : int
+        Priority of the operators pushed from now on.
+
+    Returns
+    -------
+    int
+        Previous priority.
+    """
+    prev = ctypes.c_int()
+    check_call(_LIB.MXEngineSetThreadPriority(
+        ctypes.c_int(priority), ctypes.byref(prev)))
+    return prev.value
+
+
+class _PriorityScope(object):
+    """Scope object for operator priority."""
+    def __init__(self, priority):
+        self._priority = priority
+        self._old_priority = None
+
+    def __enter__(self):
+        self._old_priority = set_priority(self._priority)
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        set_priority(self._old_priority)
+
+
+def priority(priority):
+    """Returns a scope in which all operators, including those of hybridized
+    blocks, are pushed with the given priority::
+
+        with mx.engine.priority(10):
+            out = net(x)
+    """
+    return _PriorityScope(priority)
+
+
+def tape_stats():
+    """Get the counters of the operator tapes.
+
+    Returns
+    -------
+    dict
+        `reused`: number of operators pushed reusing a recorded engine operator,
+        `recorded`: number of engine operators recorded.
+    """
+    reused = ctypes.c_uint64()
+    recorded = ctypes.c_uint64()
+    check_call(_LIB.MXEngineGetTapeStats(ctypes.byref(reused), ctypes.byref(recorded)))
+    return {'reused': reused.value, 'recorded': recorded.value}
+
+
+class _TapeScope(object):
+    """Scope object for a round of the operator tape."""
+    def __enter__(self):
+        prev = ctypes.c_int()
+        check_call(_LIB.MXEngineSetTape(ctypes.c_int(1), ctypes.byref(prev)))
+        if prev.value:
+            raise RuntimeError("The operator tape of this thread is already running")
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        prev = ctypes.c_int()
+        check_call(_LIB.MXEngineSetTape(ctypes.c_int(0), ctypes.byref(prev)))
+
+
+def tape():
+    """Returns a scope in which the operators pushed from the current thread reuse the
+    engine operators of the previous scope, which saves their creation and deletion when a
+    non-hybridized training loop pushes the same sequence of operators every step::
+
+        for data, label in train_data:
+            with mx.engine.tape():
+                with autograd.record():
+                    loss = loss_fn(net(data), label)
+                loss.backward()
+                trainer.step(batch_size)
+
+    The i-th operator of a scope reuses the i-th of the previous scope if they match and that
+    one has completed, the others are recorded for the next scope. The tape is kept between
+    the scopes, see :py:func:`clear_tape`.
+    """
+    return _TapeScope()
+
+
+def clear_tape():
+    """Frees the engine operators recorded by the tape of the current thread."""
+    prev = ctypes.c_int()
+    check_call(_LIB.MXEngineSetTape(ctypes.c_int(-1), ctypes.byref(prev)))
+
+
 def bulk(size):
     """Bulk execution bundles many operators to run together.
     This can improve performance when running a lot of small
@@ -21,6 +21,7 @@
 __all__ = ['Block', 'HybridBlock', 'SymbolBlock']
 
 import copy
+import os
 import warnings
 import weakref
 from collections import OrderedDict, defaultdict
@@ -31,18 +32,19 @@ import re
 import json
 import numpy as np
 
-from ..base import mx_real_t, MXNetError, NDArrayHandle, SymbolHandle, py_str, check_call, _LIB
+from ..base import __version__, mx_real_t, MXNetError, NDArrayHandle, SymbolHandle, py_str, check_call, _LIB
 from .. import symbol, ndarray, initializer, autograd, _deferred_compute as dc, name as _name, \
-    profiler as _profiler, context as _context
+    profiler as _profiler, context as _context, runtime as _runtime
 from ..symbol.numpy import _symbol as np_symbol
 from ..symbol import Symbol, fromjson
 from ..ndarray import NDArray
 from .parameter import Parameter, DeferredInitializationError
 from .utils import _indent, _brief_print_list, HookHandle, shape_is_known
+from .utils import _string_to_array, _array_to_string, _load_parameter_file
 from .utils import _check_same_symbol_type, _check_all_np_ndarrays, _check_block_input_np_ndarrays
 from .. import numpy_extension as _mx_npx
 from .. import numpy as _mx_np, ndarray as nd
-from .. util import is_np_array, np_shape, np_array
+from .. util import is_np_array, is_np_shape, np_array
 
 
 _naming_counter = contextvars.ContextVar('namecounter')
@@ -199,6 +201,53 @@ def _regroup(args, fmt):
     return _merger(args, fmt)[0]
 
 
+# version of the layout of the files written by HybridBlock.export_compiled
+_COMPILED_FORMAT = 1
+
+
+def _enabled_features():
+    """Names of the features the library is built with, which the compiled graphs depend on."""
+    return sorted(name for name, feature in _runtime.Features().items() if feature.enabled)
+
+
+def _convert_for_param_dtype(sym, data_names, info):
+    """Converts the graph of a block the way `HybridBlock.export` with `param_dtype` did to
+    convert its parameters, described by info: with the quantization pass for int8, with the
+    AMP pass otherwise."""
+    if info['dtype'] == 'int8':
+        from ..contrib.quantization import _quantize_symbol
+        sym, _ = _quantize_symbol(sym, _context.Context(info['device_type']),
+                                  offline_params=info['offline_params'],
+                                  quantized_dtype='int8', quantize_mode='full')
+    else:
+        from .. import amp
+        sym = amp.convert_symbol(sym, info['dtype'], data_names=data_names,
+                                 cast_optional_params=True)
+    return sym.as_np_ndarray() if is_np_array() else sym
+
+
+def _prune_for_inference(sym, outputs):
+    """The graph of sym computing only the outputs of indices `outputs`, all of them when None,
+    without the operators copying their input at inference, such as the Dropouts."""
+    import ctypes
+    if outputs is not None:
+        num_outputs = ctypes.c_uint()
+        check_call(_LIB.MXSymbolGetNumOutputs(sym.handle, ctypes.byref(num_outputs)))
+        selected = []
+        for i in ([outputs] if isinstance(outputs, int) else outputs):
+            if not -num_outputs.value <= i < num_outputs.value:
+                raise IndexError("output %d out of range of the %d outputs of the block"
+                                 % (i, num_outputs.value))
+            handle = SymbolHandle()
+            check_call(_LIB.MXSymbolGetOutput(sym.handle, ctypes.c_uint(i % num_outputs.value),
+                                              ctypes.byref(handle)))
+            selected.append(type(sym)(handle))
+        sym = symbol.Group(selected, type(sym))
+    handle = SymbolHandle()
+    check_call(_LIB.MXSymbolPruneForInference(sym.handle, ctypes.byref(handle)))
+    return type(sym)(handle)
+
+
 class Block:
     """Base class for all neural network layers and models. Your models should
     subclass this class.
@@ -337,7 +386,7 @@ class Block:
             ret.update(child()._collect_params_with_prefix(prefix + name, select))
         return ret
 
-    def save_parameters(self, filename, deduplicate=False):
+    def save_parameters(self, filename, deduplicate=False, base=None):
         """Save parameters to file.
 
         Saved parameters can only be loaded with `load_parameters`. Note that this
@@ -352,6 +401,14 @@ class Block:
             If True, save shared parameters only once. Otherwise, if a Block
             contains multiple sub-blocks that share parameters, each of the
             shared parameters will be separately saved for every sub-block.
+        base : str, optional
+            Path to the checkpoint this one is a delta of, written by the last
+            `save_parameters` or read by the last `load_parameters` of this Block.
+            The Parameters with row_sparse gradients, e.g. of `Embedding` with
+            `sparse_grad=True`, only save the rows that `Trainer` updated since then,
+            provided the optimizer updates the rows of the gradients only, e.g. with
+            `lazy_update`. The other Parameters are saved in full. `load_parameters`
+            applies the delta to its base, see also `gluon.utils.compact_parameters`.
 
         References
         ----------
@@ -369,11 +426,20 @@ class Block:
             reverse_params = {v: k for k, v in params.items()}
             params = {v: k for k, v in reverse_params.items()}
 
-        arg_dict = {key: val._reduce() for key, val in params.items()}
+        arg_dict = {}
+        for key, val in params.items():
+            rows = val._dirty_row_ids() if base is not None else None
+            arg_dict[key] = val._reduce() if rows is None else val._reduce_rows(rows)
+        if base is not None:
+            # relative to the delta, so that a chain of checkpoints can be moved together
+            arg_dict['__base__'] = _string_to_array(
+                os.path.relpath(base, os.path.dirname(os.path.abspath(filename))))
         if is_np_array():
             _mx_npx.savez(filename, **arg_dict)
         else:
             ndarray.save(filename, arg_dict)
+        for val in params.values():
+            val._track_rows()
 
     def load_parameters(self, filename, ctx=None, allow_missing=False,
                         ignore_extra=False, cast_dtype=False, dtype_source='current'):
@@ -382,7 +448,7 @@ class Block:
         Parameters
         ----------
         filename : str
-            Path to parameter file.
+            Path to parameter file, or to a delta checkpoint, which is applied to its base.
         ctx : Context or list of Context, default cpu()
             Context(s) to initialize loaded parameters on.
         allow_missing : bool, default False
@@ -402,33 +468,13 @@ class Block:
         `Saving and Loading Gluon Models \
         <https://mxnet.apache.org/api/python/docs/tutorials/packages/gluon/blocks/save_load_params.html>`_
         """
-        if is_np_array():
-            # failure may happen when loading parameters saved as NDArrays within
-            # NumPy semantics. Check the failure type and recover from it if it happens.
-            try:
-                loaded = _mx_npx.load(filename)
-            except MXNetError as e:
-                err_msg = str(e)
-                if 'is_np_shape' in err_msg:
-                    # Loading failure due to parameters saved without numpy semantics.
-                    # Temporarily disable numpy semantics and load parameters. After it's
-                    # done, resume the numpy semantics. This is fine because the cases
-                    # numpy ndarray covers is a superset of the legacy ndarray's.
-                    with np_array(False):
-                        with np_shape(False):
-                            loaded_nds = ndarray.load(filename)
-                    assert isinstance(loaded_nds, dict),\
-                        'expecting a dict type, got {}'.format(str(type(loaded_nds)))
-                    loaded = {k: loaded_nds[k].as_np_ndarray() for k in loaded_nds}
-                else:
-                    raise ValueError(err_msg)
-        else:
-            loaded = ndarray.load(filename)
-
+        loaded = _load_parameter_file(filename)
         if not loaded:
             return
         full_dict = {'params': loaded, 'filename': filename}
         self.load_dict(full_dict, ctx, allow_missing, ignore_extra, cast_dtype, dtype_source)
+        for param in self.collect_params().values():
+            param._track_rows()
 
     def load_dict(self, param_dict, ctx=None, allow_missing=False,
                   ignore_extra=False, cast_dtype=False, dtype_source="current"):
@@ -1054,6 +1100,10 @@ class HybridBlock(Block):
         self._backend_opts = {}
         self._partition_if_dynamic = True
         self._first_forward = True
+        self._pad_to_bucket = None
+        self._bucket_axis = 1
+        self._source_graph = None
+        self._partition = None
 
     def __setattr__(self, name, value):
         """Registers parameters."""
@@ -1157,6 +1207,11 @@ class HybridBlock(Block):
                 elif name in params:
                     aux_dict[name] = params[name].data()
 
+            if update_graph:
+                # kept for export_compiled, to partition again where the partitioned graph does not fit
+                self._source_graph = out
+                self._partition = (self._backend, dict(self._backend_opts))
+
             # Partition the graph
             out = out.optimize_for(self._backend, arg_dict, aux_dict, ctx, input_shapes, **self._backend_opts)
 
@@ -1262,6 +1317,8 @@ class HybridBlock(Block):
                                  .format(fmt, self._in_format))
 
         args_without_none = [ele for ele in args if ele is not None]
+        if self._pad_to_bucket is not None:
+            args_without_none = [self._pad_arg_to_bucket(ele) for ele in args_without_none]
         cargs = [args_without_none[i] if is_arg else i.data()
                  for is_arg, name, i in self._cached_op_args]
         out = self._cached_op(*cargs)
@@ -1269,6 +1326,26 @@ class HybridBlock(Block):
             out = [out]
         return _regroup(out, self._out_format)
 
+    def _pad_arg_to_bucket(self, x):
+        """Pads x with zeros along the bucket axis up to the length of its bucket."""
+        axis = self._bucket_axis
+        if not isinstance(x, NDArray) or x.ndim <= axis:
+            return x
+        length = x.shape[axis]
+        if self._pad_to_bucket == 'pow2':
+            target = 1 << max(length - 1, 0).bit_length()
+        else:
+            target = next((b for b in sorted(self._pad_to_bucket) if b >= length), length)
+        if target == length:
+            return x
+        pad_shape = list(x.shape)
+        pad_shape[axis] = target - length
+        if isinstance(x, _mx_np.ndarray):
+            pad = _mx_np.zeros(pad_shape, dtype=x.dtype, ctx=x.ctx)
+            return _mx_np.concatenate([x, pad], axis=axis)
+        pad = nd.zeros(pad_shape, dtype=x.dtype, ctx=x.ctx)
+        return nd.concat(x, pad, dim=axis)
+
     def optimize_for(self, x, *args, backend=None, clear=False,
                      partition_if_dynamic=True,
                      static_alloc=False,
@@ -1302,8 +1379,9 @@ class HybridBlock(Block):
             first input to model
         *args : NDArray
             other inputs to model
-        backend : str
-            The name of backend, as registered in `SubgraphBackendRegistry`, default None
+        backend : str or list of str
+            The name of backend, as registered in `SubgraphBackendRegistry`, default None.
+            Several backends partition the graph by estimated cost, see `Symbol.optimize_for`
         backend_opts : dict of user-specified options to pass to the backend for partitioning, optional
             Passed on to `PrePartition` and `PostPartition` functions of `SubgraphProperty`
         clear : bool, default False
@@ -1357,10 +1435,133 @@ class HybridBlock(Block):
         self._backend = None
         self._backend_opts = {}
 
+    def prepack(self, x, *args):
+        """Runs the hybridized block once for inference and waits for it, so that the
+        weights are prepared for inference before the first request is served.
+
+        For inference the oneDNN convolutions and fully connected layers compute with their
+        weights in blocked layouts, which depend on the CPU. Their first forward pass reorders
+        the weight parameters in place into these layouts, and fuses the batch norms into and
+        quantizes the weights that need it, so that only the packed form of each weight is
+        kept. The parameters are still saved in the default layout, and the weights are
+        reordered back when training resumes.
+
+        Examples
+        --------
+        # partition, then reorder the weights ahead of serving
+        block.optimize_for(x, backend='MKLDNN')
+        block.prepack(x)
+
+        Parameters
+        ----------
+        x : NDArray
+            first input to model
+        *args : NDArray
+            other inputs to model
+
+        Returns
+        -------
+        The outputs of the block for the inputs.
+        """
+        if not self._active:
+            raise RuntimeError('prepack requires a hybridized block, please call hybridize or '
+                               'optimize_for first.')
+        with autograd.predict_mode():
+            out = self(x, *args)
+        ndarray.waitall()
+        return out
+
+    def export_compiled(self, fname, x, *args, remove_amp_cast=True):
+        """Exports the optimized HybridBlock to a single file, from which
+        `gluon.SymbolBlock.imports_compiled` starts serving without partitioning it again.
+
+        The file is an uncompressed ``.npz`` archive holding the partitioned graph, the
+        parameters it runs with, the hybridize flags, the shapes and types of the inputs and the
+        version and features of the library. When the block was partitioned by `optimize_for`,
+        the graph before partitioning and its parameters are kept as well, to partition the
+        graph again where the partitioned one does not fit. C++ programs serve the file with
+        `mxnet::cpp::InferenceModel` of the cpp-package.
+
+        Examples
+        --------
+        # partition, then export the partitioned graph
+        block.optimize_for(x, backend='MKLDNN', static_alloc=True)
+        block.export_compiled('model.npz', x)
+        # in the serving process
+        net = gluon.SymbolBlock.imports_compiled('model.npz')
+
+        Parameters
+        ----------
+        fname : str
+            Path of the file to write.
+        x : NDArray
+            first input to model, whose shape and type the imported block is warmed up with
+        *args : NDArray
+            other inputs to model
+        remove_amp_cast : bool, optional
+            Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+
+        Returns
+        -------
+        str
+            `fname`
+        """
+        sym, arg_dict = self.export(None, remove_amp_cast=remove_amp_cast)
+        inputs, _ = _flatten([x] + list(args), "input")
+        inputs = [i for i in inputs if i is not None]
+        input_names = ['data'] if len(inputs) == 1 else \
+            ['data{}'.format(i) for i in range(len(inputs))]
+        _, _, ctx_set, _ = _gather_type_ctx_info(inputs)
+        ctx = ctx_set.pop() if ctx_set else _context.current_context()
+        backend, backend_opts = self._partition if self._partition else (None, {})
+        manifest = {
+            'format': _COMPILED_FORMAT,
+            'version': __version__,
+            'features': _enabled_features(),
+            'device_type': ctx.device_type,
+            'backend': backend,
+            'backend_opts': backend_opts,
+            'partition_if_dynamic': self._partition_if_dynamic,
+            'flags': {k: v for k, v in self._flags if k not in ('data_indices', 'param_indices')},
+            'inputs': [{'name': name, 'shape': list(i.shape), 'dtype': np.dtype(i.dtype).name}
+                       for name, i in zip(input_names, inputs)]}
+        arg_dict['__manifest__'] = _string_to_array(json.dumps(manifest, default=str))
+        arg_dict['__symbol__'] = _string_to_array(sym.tojson(remove_amp_cast=False))
+        # what mxnet::cpp::InferenceModel needs to create the cached op, as strings
+        arg_dict['__cached_op__'] = _string_to_array(json.dumps({
+            'data_names': input_names,
+            'np_shape': int(is_np_shape()),
+            'flags': {k: str(v) for k, v in manifest['flags'].items()}}))
+
+        if self._source_graph is not None:
+            # the parameters of the graph before partitioning, under the names export gives them
+            source = copy.copy(self._source_graph)
+            params = {v: k for k, v in {v: k for k, v in self.collect_params().items()}.items()}
+            rename_map = {param.var().name: name for name, param in params.items()}
+            for var in source.get_inputs():
+                if var.name in rename_map:
+                    var._set_attr(name=rename_map[var.name])
+            aux_names = set(source.list_auxiliary_states())
+            for name in source.list_inputs():
+                if name in params and 'arg:' + name not in arg_dict and \
+                        'aux:' + name not in arg_dict:
+                    prefix = 'aux:' if name in aux_names else 'arg:'
+                    arg_dict[prefix + name] = params[name]._reduce()
+            arg_dict['__source_symbol__'] = _string_to_array(
+                source.tojson(remove_amp_cast=remove_amp_cast))
+
+        if is_np_array():
+            _mx_npx.savez(fname, **arg_dict)
+        else:
+            ndarray.save(fname, arg_dict)
+        return fname
+
     def _clear_cached_op(self):
         self._cached_graph = ()
         self._cached_op = None
         self._first_forward = True
+        self._source_graph = None
+        self._partition = None
 
     def register_child(self, block, name=None):
         if not isinstance(block, HybridBlock):
@@ -1382,7 +1583,15 @@ class HybridBlock(Block):
                   static_shape=False,
                   inline_limit=2,
                   forward_bulk_size=None,
-                  backward_bulk_size=None):
+                  backward_bulk_size=None,
+                  shape_cache_size=None,
+                  pad_to_bucket=None,
+                  bucket_axis=1,
+                  recompute=None,
+                  recompute_budget_mb=None,
+                  fold_constants=False,
+                  prune_for_inference=False,
+                  share_static_alloc=False):
         """Activates or deactivates :py:class:`HybridBlock` s recursively. Has no effect on
         non-hybrid children.
 
@@ -1404,9 +1613,52 @@ class HybridBlock(Block):
             Segment size of bulk execution during forward pass.
         backward_bulk_size : optional int, default None
             Segment size of bulk execution during backward pass.
+        shape_cache_size : optional int, default None
+            Number of input shape signatures whose inferred graph, memory plan
+            and, with static_alloc, memory are kept per context. Inputs of a
+            cached shape skip shape inference and memory planning. Each cached
+            shape keeps its own static memory. Defaults to 1.
+        pad_to_bucket : optional str or list of int, default None
+            Pad the inputs with zeros along `bucket_axis` so that variable
+            lengths map to a few cached shapes. 'pow2' pads to the next power
+            of two, a list of lengths pads to the smallest one that fits.
+            Longer inputs are not padded. The outputs keep the padded length,
+            so the model must mask the padding.
+        bucket_axis : int, default 1
+            The axis padded by `pad_to_bucket`. Inputs with fewer axes are
+            not padded.
+        recompute : optional str, default None
+            Recompute activations during backward instead of keeping them from
+            forward, trading compute for memory. 'sqrt' keeps the outputs of
+            every sqrt(N)-th of the N operators, 'budget' keeps the outputs of
+            compute heavy operators such as convolutions and one output per
+            `recompute_budget_mb` of activations. Random, stateful and input
+            mutating operators are never recomputed.
+        recompute_budget_mb : optional float, default None
+            Megabytes of activations recomputed between two kept outputs when
+            `recompute` is 'budget'. Defaults to 64.
+        fold_constants : bool, default False
+            Evaluate the operators that only depend on parameters and constants,
+            e.g. transposes of weights, once for inference instead of on every
+            call. They are evaluated again after a parameter is updated.
+        prune_for_inference : bool, default False
+            Run the forward calls that are neither recorded nor in train mode on a
+            copy of the graph without the operators that only copy their input at
+            inference: the Dropouts whose masks are not used, BlockGrad and copies.
+            Their consumers read the input directly, saving the copies and the
+            masks.
+        share_static_alloc : bool, default False
+            Share the static memory of the intermediate arrays of inference with
+            the other blocks hybridized with `share_static_alloc` on the same
+            context, e.g. many models served on one GPU. The forward calls borrow
+            the memory while they are pushed and are ordered by the engine, so
+            the models do not each keep their activations. Must also set
+            static_alloc to True.
         """
 
         self._active = active
+        self._pad_to_bucket = pad_to_bucket
+        self._bucket_axis = bucket_axis
         self._partition_if_dynamic = partition_if_dynamic
         self._flags = [("static_alloc", static_alloc), ("static_shape", static_shape),
                        ("inline_limit", inline_limit)]
@@ -1414,6 +1666,18 @@ class HybridBlock(Block):
             self._flags.append(("forward_bulk_size", forward_bulk_size))
         if backward_bulk_size is not None:
             self._flags.append(("backward_bulk_size", backward_bulk_size))
+        if shape_cache_size is not None:
+            self._flags.append(("shape_cache_size", shape_cache_size))
+        if recompute is not None:
+            self._flags.append(("recompute", recompute))
+        if recompute_budget_mb is not None:
+            self._flags.append(("recompute_budget_mb", recompute_budget_mb))
+        if fold_constants:
+            self._flags.append(("fold_constants", fold_constants))
+        if prune_for_inference:
+            self._flags.append(("prune_for_inference", prune_for_inference))
+        if share_static_alloc:
+            self._flags.append(("share_static_alloc", share_static_alloc))
         self._clear_cached_op()
         if active and self._forward_hooks or self._forward_pre_hooks:
             warnings.warn('"{block}" is being hybridized while still having forward hook/pre-hook. '
@@ -1424,7 +1688,15 @@ class HybridBlock(Block):
                                            static_shape=static_shape,
                                            inline_limit=inline_limit,
                                            forward_bulk_size=forward_bulk_size,
-                                           backward_bulk_size=backward_bulk_size)
+                                           backward_bulk_size=backward_bulk_size,
+                                           shape_cache_size=shape_cache_size,
+                                           pad_to_bucket=pad_to_bucket,
+                                           bucket_axis=bucket_axis,
+                                           recompute=recompute,
+                                           recompute_budget_mb=recompute_budget_mb,
+                                           fold_constants=fold_constants,
+                                           prune_for_inference=prune_for_inference,
+                                           share_static_alloc=share_static_alloc)
 
     def cast(self, dtype):
         if self._active:
@@ -1468,13 +1740,27 @@ class HybridBlock(Block):
         """Infers data type of Parameters from inputs."""
         self._infer_attrs('infer_type', 'dtype', *args)
 
-    def export(self, path, epoch=0, remove_amp_cast=True):
+    def export(self, path, epoch=0, remove_amp_cast=True, param_dtype=None,
+               prune_for_inference=False, outputs=None):
         """Export HybridBlock to json format that can be loaded by
         `gluon.SymbolBlock.imports` or the C++ interface.
 
         .. note:: When there are only one input, it will have name `data`. When there
                   Are more than one inputs, they will be named as `data0`, `data1`, etc.
 
+        With `param_dtype`, the parameters are saved in the type the block is served in, so
+        that serving reads and holds them in that type instead of in float32: as the AMP pass
+        casts them for 'float16' and 'bfloat16', or as the quantization pass quantizes the
+        weights offline, with their ranges, for 'int8'. The graph is saved as is, and
+        `gluon.SymbolBlock.imports` converts it with the same pass when loading such
+        parameters. The int8 graph quantizes its inputs at runtime, without calibration, for
+        the device of the parameters.
+
+        With `prune_for_inference`, the graph is exported for serving only: without the
+        outputs not in `outputs`, nor the operators and parameters only they use, and without
+        the operators that copy their input at inference, such as the Dropouts, which can no
+        longer be trained.
+
         Parameters
         ----------
         path : str or None
@@ -1486,6 +1772,14 @@ class HybridBlock(Block):
             Epoch number of saved model.
         remove_amp_cast : bool, optional
             Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+        param_dtype : str, optional
+            'float16', 'bfloat16' or 'int8', the type to save the parameters in, by default
+            the type of the parameters.
+        prune_for_inference : bool, optional
+            Whether to export the graph for inference only.
+        outputs : int or list of int, optional
+            The indices of the outputs of the block kept with `prune_for_inference`, by default
+            all of them.
 
         Returns
         -------
@@ -1498,6 +1792,11 @@ class HybridBlock(Block):
             raise RuntimeError(
                 "Please first call block.hybridize() and then run forward with "
                 "this block at least once before calling export.")
+        if param_dtype not in (None, 'float16', 'bfloat16', 'int8'):
+            raise ValueError("param_dtype must be 'float16', 'bfloat16' or 'int8', "
+                             "while received %s" % str(param_dtype))
+        if outputs is not None and not prune_for_inference:
+            raise ValueError("outputs are selected with prune_for_inference")
         sym = copy.copy(self._cached_graph[1])
 
         # Deduplicate params (shared parameters use the same input symbol)
@@ -1511,6 +1810,8 @@ class HybridBlock(Block):
         for var in sym.get_inputs():
             if var.name in rename_map:
                 var._set_attr(name=rename_map[var.name])
+        if prune_for_inference:
+            sym = _prune_for_inference(sym, outputs)
 
         sym_filename = '%s-symbol.json' % (path if path is not None else "")
         if path is not None:
@@ -1525,10 +1826,14 @@ class HybridBlock(Block):
                     arg_dict['arg:{}'.format(name)] = param._reduce()
                 else:
                     if name not in aux_names:
+                        if outputs is not None:
+                            continue
                         warnings.warn('Parameter "{name}" is not found in the graph. '
                                       .format(name=name), stacklevel=3)
                     else:
                         arg_dict['aux:%s'%name] = param._reduce()
+        if param_dtype is not None:
+            arg_dict = self._typed_params(sym, arg_dict, param_dtype)
         params_filename = '%s-%04d.params'%((path if path is not None else ""), epoch)
 
         if path is not None:
@@ -1545,6 +1850,33 @@ class HybridBlock(Block):
             sym = type(sym)(handle)
         return sym, arg_dict
 
+    def _typed_params(self, sym, arg_dict, param_dtype):
+        """The parameters of export converted to param_dtype, in the form the pass converting the
+        graph for param_dtype takes them, with the description of the conversion."""
+        data_names = [i.name for i in self._cached_graph[0]]
+        device = next(iter(arg_dict.values())).context if arg_dict else \
+            _context.current_context()
+        info = {'dtype': param_dtype, 'device_type': device.device_type}
+        if param_dtype == 'int8':
+            from ..contrib.quantization import _quantize_params
+            args = {k[4:]: v for k, v in arg_dict.items() if k.startswith('arg:')}
+            info['offline_params'] = sorted(args)
+            qsym = _convert_for_param_dtype(sym, data_names, info)
+            typed = {'arg:' + k: v for k, v in _quantize_params(qsym, args, {}).items()}
+            typed.update({k: v for k, v in arg_dict.items() if k.startswith('aux:')})
+        else:
+            attrs = _convert_for_param_dtype(sym, data_names, info).attr_dict()
+            amp_cast = ndarray.numpy._internal.amp_cast if is_np_array() else ndarray.amp_cast
+            typed = {}
+            for key, value in arg_dict.items():
+                # -1 is an unknown type, 0 float32
+                if attrs.get(key[4:], {}).get('__dtype__', '-1') in ('-1', '0'):
+                    typed[key] = value
+                else:
+                    typed[key] = amp_cast(value, dtype=param_dtype)
+        typed['__param_dtype__'] = _string_to_array(json.dumps(info))
+        return typed
+
     def register_op_hook(self, callback, monitor_all=False):
         """Install op hook for block recursively.
 
@@ -1717,9 +2049,116 @@ class SymbolBlock(HybridBlock):
         else:
             # Do not specify type, rely on saved params type instead
             inputs = [symbol.var(i).as_np_ndarray() if is_np_array() else symbol.var(i) for i in input_names]
+            loaded = _load_parameter_file(param_file)
+            if loaded and '__param_dtype__' in loaded:
+                # parameters saved by export with param_dtype, for the converted graph
+                info = json.loads(_array_to_string(loaded.pop('__param_dtype__')))
+                sym = _convert_for_param_dtype(sym, input_names, info)
+        ret = SymbolBlock(sym, inputs)
+        if param_file is not None and loaded:
+            ret.load_dict({'params': loaded, 'filename': param_file}, ctx, allow_missing,
+                          ignore_extra, True, 'saved')
+            for param in ret.collect_params().values():
+                param._track_rows()
+        return ret
+
+    @staticmethod
+    def imports_compiled(fname, ctx=None, warmup=True):
+        """Import a model previously saved by `gluon.HybridBlock.export_compiled`
+        as a hybridized `gluon.SymbolBlock`.
+
+        The parameters are mapped from the file, see `mmap` of `mx.nd.load`, and the saved
+        partitioned graph is used as it is with the saved hybridize flags. When the library
+        differs from the one that exported the model in version or features, when the model was
+        exported for another device type or when the partitioned graph fails to load, a warning
+        is issued and the graph before partitioning is partitioned again with the saved backend,
+        if the library has it.
+
+        Parameters
+        ----------
+        fname : str
+            Path of the file written by `export_compiled`.
+        ctx : Context or list of Context, default None
+            The context to load the parameters to, by default the current context.
+        warmup : bool, default True
+            Whether to run the block once on zeros of the saved input shapes, see `prepack`, so
+            that the memory planning, the weight reordering and the algorithm selection of the
+            operators happen before the first request.
+
+        Returns
+        -------
+        gluon.SymbolBlock
+            The hybridized `gluon.SymbolBlock`.
+
+        Examples
+        --------
+        >>> net1.optimize_for(x, backend='MKLDNN', static_alloc=True)
+        >>> net1.export_compiled('net1.npz', x)
+        >>>
+        >>> net2 = gluon.SymbolBlock.imports_compiled('net1.npz')
+        >>> out2 = net2(x)
+        """
+        if ctx is None:
+            ctx = _context.current_context()
+        device = ctx[0] if isinstance(ctx, (list, tuple)) else ctx
+        load = _mx_npx.load if is_np_array() else ndarray.load
+        if isinstance(ctx, _context.Context) and ctx.device_type != 'cpu':
+            arrays = load(fname, ctx=ctx)
+        else:
+            arrays = load(fname, mmap=True)
+        if not isinstance(arrays, dict) or '__manifest__' not in arrays:
+            raise ValueError('{} was not written by HybridBlock.export_compiled'.format(fname))
+        manifest = json.loads(_array_to_string(arrays.pop('__manifest__')))
+        if manifest['format'] > _COMPILED_FORMAT:
+            raise ValueError('{} has format {} while this version reads format {} and older'
+                             .format(fname, manifest['format'], _COMPILED_FORMAT))
+        compiled = _array_to_string(arrays.pop('__symbol__'))
+        source = arrays.pop('__source_symbol__', None)
+        arrays.pop('__cached_op__', None)
+        source = compiled if source is None else _array_to_string(source)
+        load_json = np_symbol.load_json if is_np_array() else fromjson
+
+        mismatch = []
+        if manifest['version'] != __version__:
+            mismatch.append('it was exported by version {}'.format(manifest['version']))
+        if manifest['features'] != _enabled_features():
+            mismatch.append('it was exported by a library with other features')
+        if manifest['device_type'] != device.device_type:
+            mismatch.append('it was exported for {}'.format(manifest['device_type']))
+        sym = None
+        if not mismatch:
+            try:
+                sym = load_json(compiled)
+            except MXNetError as e:
+                mismatch.append('its graph fails to load: {}'.format(e))
+        if mismatch:
+            warnings.warn('{} is built again from the graph before partitioning, since {}'
+                          .format(fname, ', '.join(mismatch)), stacklevel=2)
+            sym = load_json(source)
+
+        input_names = [i['name'] for i in manifest['inputs']]
+        inputs = [symbol.var(i).as_np_ndarray() if is_np_array() else symbol.var(i)
+                  for i in input_names]
         ret = SymbolBlock(sym, inputs)
-        if param_file is not None:
-            ret.load_parameters(param_file, ctx, allow_missing, ignore_extra, True, 'saved')
+        # the parameters of the graph before partitioning are those that the compiled one lacks
+        ret.load_dict(arrays, ctx, ignore_extra=True, cast_dtype=True, dtype_source='saved')
+        ret.hybridize(True, partition_if_dynamic=manifest['partition_if_dynamic'],
+                      **manifest['flags'])
+
+        zeros = _mx_np.zeros if is_np_array() else nd.zeros
+        data = [zeros(tuple(i['shape']), dtype=i['dtype'], ctx=device)
+                for i in manifest['inputs']]
+        if mismatch and manifest['backend'] is not None:
+            try:
+                ret.optimize_for(*data, backend=manifest['backend'],
+                                 **manifest['backend_opts'])
+            except MXNetError as e:
+                warnings.warn('{} runs without partitioning, since {}'.format(fname, e),
+                              stacklevel=2)
+                ret.hybridize(True, partition_if_dynamic=manifest['partition_if_dynamic'],
+                              **manifest['flags'])
+        if warmup:
+            ret.prepack(*data)
         return ret
 
     def __repr__(self):
@@ -21,3 +21,7 @@
 from . import data
 
 from . import estimator
+
+from . import pipeline
+
+from . import monitor
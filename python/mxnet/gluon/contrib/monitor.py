@@ -0,0 +1,145 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Statistics of the intermediate tensors of hybridized blocks, computed on their devices."""
+
+__all__ = ['TensorStatsMonitor']
+
+import re
+
+from ... import autograd
+from ... import ndarray
+
+
+class TensorStatsMonitor(object):
+    """Collects the minimum, maximum, mean, number of NaNs and optionally a histogram of the
+    intermediate tensors of hybridized blocks.
+
+    The statistics are computed by operators pushed to the engine after the operators producing
+    the tensors and accumulated in small arrays on the devices of the tensors, so that the hooks
+    neither wait for the tensors nor copy them to the host. They are copied to the host every
+    ``interval`` steps only, by :py:meth:`step`.
+
+    Parameters
+    ----------
+    interval : int, default 1
+        Number of steps between the reads of the statistics.
+    pattern : str, default '.*'
+        Regular expression the names of the monitored tensors match.
+    monitor_all : bool, default False
+        If True, monitor the inputs of the operators as well as their outputs.
+    bins : int, default 0
+        Number of bins of the histograms, 0 for no histogram.
+    hist_range : (float, float), default (-1.0, 1.0)
+        Range of the bins of the histograms, the values outside it are not counted.
+
+    Examples
+    --------
+    >>> monitor = TensorStatsMonitor(interval=100, pattern='.*output')
+    >>> monitor.install(net)
+    >>> for data, label in loader:
+    ...     with autograd.record():
+    ...         loss = loss_fn(net(data), label)
+    ...     loss.backward()
+    ...     trainer.step(data.shape[0])
+    ...     stats = monitor.step()
+    ...     if stats is not None:
+    ...         print({k: v['nan_count'] for k, v in stats.items()})
+    """
+    def __init__(self, interval=1, pattern='.*', monitor_all=False, bins=0, hist_range=(-1.0, 1.0)):
+        assert interval >= 1, "interval must be positive, got %d" % interval
+        assert bins >= 0, "bins must be non-negative, got %d" % bins
+        self.interval = interval
+        self.monitor_all = monitor_all
+        self._pattern = re.compile(pattern)
+        self._bins = bins
+        self._hist_range = tuple(hist_range)
+        self._step = 0
+        self._acc = {}
+
+    def install(self, block):
+        """Installs the hook collecting the statistics on block and its children."""
+        block.register_op_hook(self._hook, self.monitor_all)
+
+    def _hook(self, name, op_name, array):
+        """Accumulates the statistics of array, without waiting for it."""
+        # pylint: disable=unused-argument
+        if array.size == 0 or not self._pattern.match(name):
+            return
+        with autograd.pause():
+            data = array.astype('float32', copy=False)
+            stats = [ndarray.min(data), ndarray.max(data), ndarray.sum(data),
+                     ndarray.sum(data != data)]
+            if self._bins:
+                stats.append(ndarray.histogram(data, bins=self._bins, range=self._hist_range)[0])
+            acc = self._acc.get(name)
+            if acc is None:
+                self._acc[name] = [stats, array.size]
+                return
+            acc_stats = acc[0]
+            acc_stats[0] = ndarray.minimum(acc_stats[0], stats[0])
+            acc_stats[1] = ndarray.maximum(acc_stats[1], stats[1])
+            for i in range(2, len(stats)):
+                acc_stats[i] = acc_stats[i] + stats[i]
+            acc[1] += array.size
+
+    def step(self):
+        """Ends a step. Every ``interval`` steps, returns the statistics accumulated since the
+        last read, otherwise None.
+
+        Returns
+        -------
+        dict of str to dict, or None
+            The statistics of the tensors by name, see :py:meth:`stats`.
+        """
+        self._step += 1
+        if self._step % self.interval != 0:
+            return None
+        return self.stats(reset=True)
+
+    def stats(self, reset=False):
+        """Copies the accumulated statistics to the host, waiting for them.
+
+        Parameters
+        ----------
+        reset : bool, default False
+            Whether to clear the statistics after reading them.
+
+        Returns
+        -------
+        dict of str to dict
+            The statistics of the tensors by name: their 'min', 'max', 'mean', 'nan_count', the
+            number 'count' of their values seen and, if the monitor has bins, their 'histogram'
+            as a numpy array. As with numpy, the minimum, maximum and mean are NaN when the
+            tensors have NaNs, which the histograms do not count.
+        """
+        ret = {}
+        for name, (stats, count) in self._acc.items():
+            nan_count = int(stats[3].asscalar())
+            # the minimum and maximum of the accumulators drop the NaNs of the earlier tensors
+            nan = float('nan')
+            ret[name] = {'min': stats[0].asscalar() if nan_count == 0 else nan,
+                         'max': stats[1].asscalar() if nan_count == 0 else nan,
+                         'mean': stats[2].asscalar() / count,
+                         'nan_count': nan_count,
+                         'count': count}
+            if self._bins:
+                ret[name]['histogram'] = stats[4].asnumpy()
+        if reset:
+            self._acc = {}
+        return ret
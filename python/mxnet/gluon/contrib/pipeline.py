@@ -0,0 +1,209 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Pipeline parallel execution of a model partitioned into stages on several devices."""
+
+__all__ = ['PipelineParallel', 'pipeline_schedule']
+
+from ..block import Block
+from ..utils import split_data
+from ... import autograd
+from ...util import is_np_array
+from ... import numpy as _mx_np
+from ... import ndarray
+
+
+def pipeline_schedule(num_stages, num_micro_batches):
+    """Returns the order in which the 1F1B schedule issues the forward and backward passes
+    of the micro-batches through the stages.
+
+    Each stage runs the forward passes of ``num_stages - stage - 1`` micro-batches ahead of
+    the backward passes, then alternates one forward and one backward pass and finally drains
+    the backward passes. The passes of a stage keep this order, the passes of different stages
+    are interleaved in the order they can run.
+
+    Parameters
+    ----------
+    num_stages : int
+        Number of stages.
+    num_micro_batches : int
+        Number of micro-batches per batch.
+
+    Returns
+    -------
+    list of tuple
+        ``(stage, is_forward, micro_batch)`` for every pass, in issue order.
+    """
+    per_stage = []
+    for stage in range(num_stages):
+        warmup = min(num_stages - stage - 1, num_micro_batches)
+        ops = [(True, m) for m in range(warmup)]
+        for m in range(num_micro_batches - warmup):
+            ops += [(True, warmup + m), (False, m)]
+        ops += [(False, m) for m in range(num_micro_batches - warmup, num_micro_batches)]
+        per_stage.append(ops)
+
+    issued = set()
+    def ready(stage, is_forward, m):
+        if is_forward:
+            return stage == 0 or (stage - 1, True, m) in issued
+        if stage == num_stages - 1:
+            return (stage, True, m) in issued
+        return (stage + 1, False, m) in issued
+
+    order = []
+    pos = [0] * num_stages
+    while len(order) < 2 * num_stages * num_micro_batches:
+        progress = False
+        # one pass per stage and clock tick
+        for stage in range(num_stages):
+            if pos[stage] == len(per_stage[stage]):
+                continue
+            is_forward, m = per_stage[stage][pos[stage]]
+            if ready(stage, is_forward, m):
+                order.append((stage, is_forward, m))
+                pos[stage] += 1
+                progress = True
+        for op in order[len(issued):]:
+            issued.add(op)
+        assert progress, "the pipeline schedule is stuck"
+    return order
+
+
+class PipelineParallel(Block):
+    """Runs the stages of a model partitioned over several devices as a pipeline.
+
+    A batch is split into micro-batches, which flow through the stages in the 1F1B order of
+    :py:func:`pipeline_schedule`. The passes are pushed without waiting to the asynchronous
+    engine, so the stages on different devices work on different micro-batches at the same
+    time, and the activations and gradients between the stages are copied on the copy
+    streams of the devices. Hybridize the stages to run each of them as one CachedOp.
+
+    Each stage takes and returns one array. The gradients of the parameters are accumulated
+    over the micro-batches, use ``trainer.step(batch_size)`` with the size of the whole batch.
+    The parameters of the stages live on different contexts, so each stage has its own
+    :py:class:`Trainer`.
+
+    Parameters
+    ----------
+    stages : list of Block
+        The consecutive parts of the model.
+    contexts : list of Context
+        The device of each stage.
+    num_micro_batches : int
+        Number of micro-batches per batch.
+    batch_axis : int, default 0
+        The axis along which the batch is split.
+
+    Example::
+
+        pipe = PipelineParallel([stage0, stage1], [mx.gpu(0), mx.gpu(1)], num_micro_batches=4)
+        pipe.initialize()
+        trainers = [gluon.Trainer(s.collect_params(), 'sgd') for s in [stage0, stage1]]
+        losses = pipe.train_step(data, label, gluon.loss.SoftmaxCrossEntropyLoss())
+        for trainer in trainers:
+            trainer.step(data.shape[0])
+    """
+    def __init__(self, stages, contexts, num_micro_batches, batch_axis=0):
+        super(PipelineParallel, self).__init__()
+        if len(stages) != len(contexts):
+            raise ValueError("%d stages are given %d contexts" % (len(stages), len(contexts)))
+        if num_micro_batches < 1:
+            raise ValueError("num_micro_batches must be positive, got %d" % num_micro_batches)
+        self._stages = list(stages)
+        self._contexts = list(contexts)
+        self._num_micro_batches = num_micro_batches
+        self._batch_axis = batch_axis
+        for i, stage in enumerate(self._stages):
+            self.register_child(stage, 'stage%d' % i)
+
+    def initialize(self, init=None, ctx=None, verbose=False, force_reinit=False):
+        """Initializes the parameters of each stage on its context, ``ctx`` is ignored."""
+        for stage, context in zip(self._stages, self._contexts):
+            stage.initialize(init=init, ctx=context, verbose=verbose, force_reinit=force_reinit)
+
+    def _split(self, x):
+        return split_data(x, self._num_micro_batches, self._batch_axis, even_split=False)
+
+    def _concat(self, xs):
+        if is_np_array():
+            return _mx_np.concatenate(xs, axis=self._batch_axis)
+        return ndarray.concat(*xs, dim=self._batch_axis)
+
+    def forward(self, x):
+        """Runs the forward passes of all micro-batches, the output is on the last context."""
+        outs = []
+        for micro_batch in self._split(x):
+            for stage, context in zip(self._stages, self._contexts):
+                micro_batch = stage(micro_batch.as_in_context(context))
+            outs.append(micro_batch)
+        return self._concat(outs)
+
+    def train_step(self, data, label, loss_fn):
+        """Runs the forward and backward passes of a batch and accumulates the gradients.
+
+        Parameters
+        ----------
+        data : NDArray or ndarray
+            The input of the first stage.
+        label : NDArray or ndarray
+            The label, which is passed with the output of the last stage to ``loss_fn``.
+        loss_fn : Block or callable
+            The loss, which runs on the last context.
+
+        Returns
+        -------
+        list of NDArray or ndarray
+            The losses of the micro-batches, on the last context.
+        """
+        num_stages = len(self._stages)
+        for param in self.collect_params().values():
+            if param.grad_req != 'null':
+                param.grad_req = 'add'
+        self.zero_grad()
+        datas = self._split(data)
+        labels = self._split(label)
+        if len(datas) != self._num_micro_batches:
+            raise ValueError("a batch of %d cannot be split into %d micro-batches"
+                             % (data.shape[self._batch_axis], self._num_micro_batches))
+        # the inputs and outputs of the stages for the micro-batches in flight
+        inputs = {}
+        outputs = {}
+        losses = [None] * self._num_micro_batches
+        for stage, is_forward, m in pipeline_schedule(num_stages, self._num_micro_batches):
+            context = self._contexts[stage]
+            if is_forward:
+                if stage == 0:
+                    x = datas[m].as_in_context(context)
+                else:
+                    x = outputs[stage - 1, m].copyto(context)
+                    x.attach_grad()
+                    inputs[stage, m] = x
+                with autograd.record():
+                    y = self._stages[stage](x)
+                    if stage == num_stages - 1:
+                        y = loss_fn(y, labels[m].as_in_context(context))
+                        losses[m] = y
+                outputs[stage, m] = y
+            else:
+                y = outputs.pop((stage, m))
+                if stage == num_stages - 1:
+                    y.backward()
+                else:
+                    y.backward(inputs.pop((stage + 1, m)).grad.copyto(context))
+        return losses
@@ -586,12 +586,20 @@ class DataLoader(object):
         compilation feature or leave it to `None` to allow MXNet to determine it automatically.
         If you request `try_nopython` to `True` and the compilation fails, it will raise a
         RuntimeError with the failure reason.
+    num_inflight : int, default 0
+        Only used by the c++ dataloader of `try_nopython`. If positive, its workers load the
+        samples of up to `num_inflight` batches concurrently, so that they do not wait for
+        the slowest sample of a batch before starting on the next batch.
+    out_of_order : bool, default False
+        Only used by the c++ dataloader of `try_nopython` with a positive `num_inflight`.
+        If ``True``, the batches are returned as soon as they are loaded, in any order.
 
     """
     def __init__(self, dataset, batch_size=None, shuffle=False, sampler=None,
                  last_batch=None, batch_sampler=None, batchify_fn=None,
                  num_workers=0, pin_memory=False, pin_device_id=0,
-                 prefetch=None, thread_pool=False, timeout=120, try_nopython=None):
+                 prefetch=None, thread_pool=False, timeout=120, try_nopython=None,
+                 num_inflight=0, out_of_order=False):
         self._dataset = dataset
         self._pin_memory = pin_memory
         self._pin_device_id = pin_device_id
@@ -648,7 +656,8 @@ class DataLoader(object):
                 num_workers=self._num_workers,
                 pin_memory=self._pin_memory,
                 pin_device_id=self._pin_device_id,
-                prefetch=self._prefetch, **mx_iter_args)
+                prefetch=self._prefetch, num_inflight=num_inflight,
+                out_of_order=out_of_order, **mx_iter_args)
         else:
             nd.waitall()
             import gc
@@ -777,10 +786,15 @@ class _MXThreadedDataLoader(object):
         but will consume more shared_memory. Using smaller number may forfeit the purpose of using
         multiple worker processes, try reduce `num_workers` in this case.
         By default it defaults to `num_workers * 2`, maximum prefetch size is `16`.
+    num_inflight : int, default 0
+        If positive, the workers load the samples of up to `num_inflight` batches
+        concurrently instead of one batch at a time.
+    out_of_order : bool, default False
+        Whether the batches are returned as soon as they are loaded, in any order.
     """
     def __init__(self, dataset, batch_sampler, batchify_fn,
                  num_workers=0, pin_memory=False, pin_device_id=0,
-                 prefetch=4):
+                 prefetch=4, num_inflight=0, out_of_order=False):
         from ._internal import MXDataset, MXSampler, MXBatchifyFunction
         from ...io.io import ThreadedDataLoader
         assert isinstance(dataset, MXDataset)
@@ -798,7 +812,9 @@ class _MXThreadedDataLoader(object):
         self._iter = ThreadedDataLoader(num_workers=num_workers, dataset=dataset,
                                         sampler=batch_sampler, batchify_fn=batchify_fn,
                                         prefetch_buffer=prefetch, ctx=ctx,
-                                        device_id=pin_device_id)
+                                        device_id=pin_device_id,
+                                        num_inflight=num_inflight,
+                                        out_of_order=out_of_order)
 
     def __iter__(self):
         while self._iter.iter_next():
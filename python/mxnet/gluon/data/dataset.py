@@ -188,6 +188,27 @@ class Dataset(object):
         """
         return self.transform(_TransformFirstClosure(fn), lazy)
 
+    def cache(self, cache_size=1024):
+        """Returns a new dataset caching the samples of this dataset in shared memory.
+
+        The samples are cached on their first access, and read from the cache on the
+        next epochs. The cache is shared with the worker processes of a DataLoader, which
+        are forked after its creation. When the cache is full, the samples cached first
+        are evicted. Only the datasets implemented in c++, e.g. transformed by a hybridized
+        transform, can be cached.
+
+        Parameters
+        ----------
+        cache_size : int, default 1024
+            Size of the cache in MB.
+
+        Returns
+        -------
+        Dataset
+            The cached dataset.
+        """
+        return _CachedDataset(self, cache_size)
+
 
 class SimpleDataset(Dataset):
     """Simple Dataset wrapper for lists and arrays.
@@ -311,6 +332,29 @@ class _FilteredDataset(Dataset):
         return self.handle
 
 
+class _CachedDataset(Dataset):
+    """Dataset caching the samples of another dataset in shared memory"""
+    def __init__(self, dataset, cache_size):
+        from ._internal import MXDataset, CachedDataset
+        if hasattr(dataset, '__mx_handle__'):
+            base = dataset.__mx_handle__()
+        elif isinstance(dataset, MXDataset):
+            base = dataset
+        else:
+            raise NotImplementedError('{} not supported.'.format(dataset))
+        # the cache is created now, for the worker processes to inherit it
+        self.handle = CachedDataset(base=base, cache_size=cache_size)
+
+    def __len__(self):
+        return len(self.handle)
+
+    def __getitem__(self, idx):
+        return self.handle[idx]
+
+    def __mx_handle__(self):
+        return self.handle
+
+
 class _SampledDataset(Dataset):
     """Dataset with elements chosen by a sampler"""
     def __init__(self, dataset, sampler):
@@ -396,10 +440,14 @@ class RecordFileDataset(Dataset):
     ----------
     filename : str
         Path to rec file.
+    use_mmap : bool, default False
+        Whether the c++ dataset of `__mx_handle__` maps the local rec file in memory and
+        returns the records as views of the mapping, instead of reading them with a stream.
     """
-    def __init__(self, filename):
+    def __init__(self, filename, use_mmap=False):
         self.idx_file = os.path.splitext(filename)[0] + '.idx'
         self.filename = filename
+        self._use_mmap = use_mmap
         self._record = recordio.MXIndexedRecordIO(self.idx_file, self.filename, 'r')
 
     def __getitem__(self, idx):
@@ -410,7 +458,8 @@ class RecordFileDataset(Dataset):
 
     def __mx_handle__(self):
         from ._internal import RecordFileDataset as _RecordFileDataset
-        return _RecordFileDataset(rec_file=self.filename, idx_file=self.idx_file)
+        return _RecordFileDataset(rec_file=self.filename, idx_file=self.idx_file,
+                                  use_mmap=self._use_mmap)
 
 
 class _DownloadedDataset(Dataset):
@@ -253,9 +253,12 @@ class ImageRecordDataset(dataset.RecordFileDataset):
 
             transform=lambda data, label: (data.astype(np.float32)/255, label)
 
+    use_mmap : bool, default False
+        Whether the c++ dataset of `__mx_handle__` maps the local rec file in memory instead
+        of reading it with a stream.
     """
-    def __init__(self, filename, flag=1, transform=None):
-        super(ImageRecordDataset, self).__init__(filename)
+    def __init__(self, filename, flag=1, transform=None, use_mmap=False):
+        super(ImageRecordDataset, self).__init__(filename, use_mmap)
         if transform is not None:
             raise DeprecationWarning(
                 'Directly apply transform to dataset is deprecated. '
@@ -273,7 +276,7 @@ class ImageRecordDataset(dataset.RecordFileDataset):
     def __mx_handle__(self):
         from .._internal import ImageRecordFileDataset as _ImageRecordFileDataset
         return _ImageRecordFileDataset(rec_file=self.filename, idx_file=self.idx_file,
-                                       flag=self._flag)
+                                       flag=self._flag, use_mmap=self._use_mmap)
 
 
 class ImageFolderDataset(dataset.Dataset):
@@ -18,9 +18,10 @@
 # coding: utf-8
 # pylint: disable= arguments-differ
 """Basic neural network layers."""
-__all__ = ['Sequential', 'HybridSequential', 'Dense', 'Dropout', 'Embedding',
+__all__ = ['Sequential', 'HybridSequential', 'Dense', 'FP8Dense', 'Dropout', 'Embedding',
            'BatchNorm', 'SyncBatchNorm', 'BatchNormReLU', 'InstanceNorm', 'LayerNorm', 'GroupNorm',
-           'Flatten', 'Lambda', 'HybridLambda', 'Concatenate', 'HybridConcatenate', 'Identity']
+           'Flatten', 'Lambda', 'HybridLambda', 'Concatenate', 'HybridConcatenate', 'Identity',
+           'AdaptiveSoftmax']
 import warnings
 import uuid
 import numpy as _np
@@ -249,6 +250,58 @@ class Dense(HybridBlock):
                         layout='{0} -> {1}'.format(shape[1] if shape[1] else None, shape[0]))
 
 
+@use_np
+class FP8Dense(Dense):
+    r"""A `Dense` layer multiplying its input and its weight rounded to FP8.
+
+    The input and the weight are scaled and rounded to E4M3, and the gradient of the output to
+    E5M2, as FP8 tensor cores compute. The scales of the input and the weight map the largest
+    absolute values of the last `amax_history_len` steps of training to the largest E4M3 value.
+    See `npx.fp8_fully_connected`.
+
+    Parameters
+    ----------
+    units : int
+        Dimensionality of the output space.
+    amax_history_len : int, default 16
+        Number of training steps of absolute maxima the scales come from.
+    margin : int, default 0
+        The scales map the maxima to the largest FP8 value divided by `2^margin`.
+    **kwargs
+        The other arguments of `Dense`.
+
+
+    Inputs:
+        - **data**: as for `Dense`.
+
+    Outputs:
+        - **out**: as for `Dense`.
+    """
+    def __init__(self, units, amax_history_len=16, margin=0, **kwargs):
+        super(FP8Dense, self).__init__(units, **kwargs)
+        self._margin = margin
+        self.amax_history = Parameter('amax_history', grad_req='null',
+                                      shape=(2, amax_history_len), init='zeros',
+                                      dtype='float32', differentiable=False)
+
+    def cast(self, dtype):
+        super(FP8Dense, self).cast(dtype)
+        self.amax_history.cast('float32')
+
+    def forward(self, x):
+        ctx = x.ctx
+        act = npx.fp8_fully_connected(x, self.weight.data(ctx),
+                                      bias=self.bias.data(ctx) if self.bias is not None else None,
+                                      amax_history=self.amax_history.data(ctx),
+                                      no_bias=self.bias is None, num_hidden=self._units,
+                                      flatten=self._flatten,
+                                      amax_history_len=self.amax_history.shape[1],
+                                      margin=self._margin, name='fwd')
+        if self.act is not None:
+            act = self.act(act)
+        return act
+
+
 @use_np
 class Dropout(HybridBlock):
     """Applies Dropout to the input.
@@ -262,6 +315,9 @@ class Dropout(HybridBlock):
         Fraction of the input units to drop. Must be a number between 0 and 1.
     axes : tuple of int, default ()
         The axes on which dropout mask is shared. If empty, regular dropout is applied.
+    packed_mask : bool, default False
+        Whether to keep the mask for the backward as bits instead of an array of the data
+        type of the input, which saves the memory of the activations. Ignored with axes.
 
 
     Inputs:
@@ -275,14 +331,16 @@ class Dropout(HybridBlock):
         `Dropout: A Simple Way to Prevent Neural Networks from Overfitting
         <http://www.cs.toronto.edu/~rsalakhu/papers/srivastava14a.pdf>`_
     """
-    def __init__(self, rate, axes=(), **kwargs):
+    def __init__(self, rate, axes=(), packed_mask=False, **kwargs):
         super(Dropout, self).__init__(**kwargs)
         self._rate = rate
         self._axes = axes
+        self._packed_mask = packed_mask
 
     def forward(self, x):
         if self._rate > 0:
-            return npx.dropout(x, p=self._rate, axes=self._axes, name='fwd', cudnn_off=False)
+            return npx.dropout(x, p=self._rate, axes=self._axes, name='fwd', cudnn_off=False,
+                               packed_mask=self._packed_mask)
         else:
             return np.copy(x)
 
@@ -1125,6 +1183,10 @@ class SyncBatchNorm(BatchNorm):
         Initializer for the running mean.
     running_variance_initializer: str or `Initializer`, default 'ones'
         Initializer for the running variance.
+    use_nccl: bool, default False
+        If True, average the statistics over the GPUs of all the processes and nodes with the
+        NCCL communicators of :py:func:`mxnet.contrib.nccl.init`, on the GPUs, instead of over
+        the `num_devices` GPUs of this process.
 
 
     Inputs:
@@ -1141,7 +1203,7 @@ class SyncBatchNorm(BatchNorm):
     def __init__(self, in_channels=0, num_devices=None, momentum=0.9, epsilon=1e-5,
                  center=True, scale=True, use_global_stats=False, beta_initializer='zeros',
                  gamma_initializer='ones', running_mean_initializer='zeros',
-                 running_variance_initializer='ones', **kwargs):
+                 running_variance_initializer='ones', use_nccl=False, **kwargs):
         super(SyncBatchNorm, self).__init__(
             axis=1, momentum=momentum, epsilon=epsilon,
             center=center, scale=scale,
@@ -1151,10 +1213,13 @@ class SyncBatchNorm(BatchNorm):
             running_mean_initializer=running_mean_initializer,
             running_variance_initializer=running_variance_initializer,
             in_channels=in_channels, **kwargs)
-        num_devices = self._get_num_devices() if num_devices is None else num_devices
+        if use_nccl:
+            num_devices = 1
+        elif num_devices is None:
+            num_devices = self._get_num_devices()
         self._kwargs = {'eps': epsilon, 'momentum': momentum,
                         'fix_gamma': not scale, 'use_global_stats': use_global_stats,
-                        'ndev': num_devices, 'key': uuid.uuid4()}
+                        'ndev': num_devices, 'key': uuid.uuid4(), 'nccl': use_nccl}
 
     def _get_num_devices(self):
         warnings.warn("Caution using SyncBatchNorm: "
@@ -1169,3 +1234,143 @@ class SyncBatchNorm(BatchNorm):
         return npx.sync_batch_norm(x, self.gamma.data(ctx), self.beta.data(ctx),
                                    self.running_mean.data(ctx), self.running_var.data(ctx),
                                    name='fwd', **self._kwargs)
+
+
+@use_np
+class AdaptiveSoftmax(Block):
+    r"""Adaptive softmax output layer, for the output layers of many classes, as described in
+    `Efficient softmax approximation for GPUs <https://arxiv.org/abs/1609.04309>`_.
+
+    The classes are split by `cutoffs` into a shortlist of the most frequent classes and clusters
+    of less and less frequent classes. The head layer computes the logits of the shortlist and of
+    the clusters, and the tail layer of each cluster, of `in_units / div_value ** (i + 1)` hidden
+    units, the logits of its classes. The log probability of a class of a cluster is the one of
+    the cluster plus the one of the class in the cluster, so that the loss only computes the
+    cluster of the label of each row.
+
+    The block runs imperatively, since the rows in each cluster depend on the data.
+
+    Parameters
+    ----------
+    in_units : int
+        Size of the input data.
+    num_classes : int
+        Number of classes.
+    cutoffs : list of int
+        The increasing first classes of the clusters, above 0 and below `num_classes`. The classes
+        are sorted by decreasing frequency.
+    div_value : float, default 4.0
+        Divisor of the hidden units of the tail layer of each cluster.
+    head_bias : bool, default False
+        Whether the head layer uses a bias vector.
+    dtype : str or np.dtype, default 'float32'
+        Data type of the parameters.
+    weight_initializer : str or `Initializer`
+        Initializer for the weight matrices.
+
+
+    Inputs:
+        - **data**: input tensor with shape `(batch_size, in_units)`.
+        - **label**: the classes of the rows, with shape `(batch_size,)`.
+
+    Outputs:
+        - **loss**: the negative log probability of the label of each row, with shape
+          `(batch_size,)`.
+    """
+    def __init__(self, in_units, num_classes, cutoffs, div_value=4.0, head_bias=False,
+                 dtype='float32', weight_initializer=None):
+        super(AdaptiveSoftmax, self).__init__()
+        cutoffs = list(cutoffs)
+        if not cutoffs or cutoffs != sorted(set(cutoffs)) or cutoffs[0] <= 0 or \
+                cutoffs[-1] >= num_classes:
+            raise ValueError("cutoffs must be increasing integers above 0 and below num_classes, "
+                             "but got {}".format(cutoffs))
+        self._num_classes = num_classes
+        self._cutoffs = cutoffs + [num_classes]
+        self._shortlist = cutoffs[0]
+        self._num_clusters = len(cutoffs)
+        self.head = Dense(self._shortlist + self._num_clusters, use_bias=head_bias, flatten=False,
+                          dtype=dtype, weight_initializer=weight_initializer, in_units=in_units)
+        self.tail = Sequential()
+        for i in range(self._num_clusters):
+            hidden = max(1, int(in_units // (div_value ** (i + 1))))
+            cluster = HybridSequential()
+            cluster.add(Dense(hidden, use_bias=False, flatten=False, dtype=dtype,
+                              weight_initializer=weight_initializer, in_units=in_units),
+                        Dense(self._cutoffs[i + 1] - self._cutoffs[i], use_bias=False,
+                              flatten=False, dtype=dtype, weight_initializer=weight_initializer,
+                              in_units=hidden))
+            self.tail.add(cluster)
+
+    def _cluster_log_prob(self, i, x, cluster_log_prob):
+        """Log probabilities of the classes of cluster i for the rows x, of the cluster log
+        probabilities cluster_log_prob."""
+        return npx.log_softmax(self.tail[i](x), axis=-1) + cluster_log_prob.reshape(-1, 1)
+
+    def forward(self, x, label):
+        label = label.astype('int64')
+        head_log_prob = npx.log_softmax(self.head(x), axis=-1)
+        cluster = np.zeros(label.shape, dtype='int64')
+        for first in self._cutoffs[:-1]:
+            cluster = cluster + (label >= first).astype('int64')
+        head_label = np.where(cluster == 0, label, cluster + (self._shortlist - 1))
+        log_prob = npx.pick(head_log_prob, head_label, axis=-1)
+        for i in range(self._num_clusters):
+            rows = np.nonzero(cluster == i + 1)[0]
+            if rows.size == 0:
+                continue
+            tail_log_prob = npx.log_softmax(self.tail[i](np.take(x, rows, axis=0, mode='clip')),
+                                            axis=-1)
+            tail_label = np.take(label, rows, mode='clip') - self._cutoffs[i]
+            log_prob = npx.index_add(log_prob, rows.reshape(1, -1),
+                                     npx.pick(tail_log_prob, tail_label, axis=-1))
+        return -log_prob
+
+    def log_prob(self, x):
+        """Returns the log probabilities of all the classes, with shape
+        `(batch_size, num_classes)`."""
+        head_log_prob = npx.log_softmax(self.head(x), axis=-1)
+        parts = [head_log_prob[:, :self._shortlist]]
+        for i in range(self._num_clusters):
+            parts.append(self._cluster_log_prob(i, x, head_log_prob[:, self._shortlist + i]))
+        return np.concatenate(parts, axis=-1)
+
+    def topk(self, x, k=1):
+        """Returns the log probabilities and the classes of the `k` most likely classes of each
+        row, by decreasing probability, with shapes `(batch_size, k)`.
+
+        The classes of a cluster are less likely than the cluster, so that the tail layer and the
+        normalization of a cluster are only computed for the rows where the cluster is more
+        likely than the `k` classes found so far, most often for none.
+        """
+        if not 0 < k <= self._shortlist:
+            raise ValueError("k must be between 1 and the size of the shortlist {}, but got {}"
+                             .format(self._shortlist, k))
+        head_log_prob = npx.log_softmax(self.head(x), axis=-1)
+        values, classes = npx.topk(head_log_prob[:, :self._shortlist], k=k, ret_typ='both',
+                                   dtype='int64')
+        for i in range(self._num_clusters):
+            cluster_log_prob = head_log_prob[:, self._shortlist + i]
+            rows = np.nonzero(cluster_log_prob > values[:, -1])[0]
+            if rows.size == 0:
+                continue
+            tail_log_prob = self._cluster_log_prob(i, np.take(x, rows, axis=0, mode='clip'),
+                                                   np.take(cluster_log_prob, rows, mode='clip'))
+            tail_k = min(k, self._cutoffs[i + 1] - self._cutoffs[i])
+            tail_values, tail_classes = npx.topk(tail_log_prob, k=tail_k, ret_typ='both',
+                                                 dtype='int64')
+            cand_values = np.concatenate([np.take(values, rows, axis=0, mode='clip'), tail_values],
+                                         axis=-1)
+            cand_classes = np.concatenate([np.take(classes, rows, axis=0, mode='clip'),
+                                           tail_classes + self._cutoffs[i]], axis=-1)
+            best_values, best = npx.topk(cand_values, k=k, ret_typ='both', dtype='int64')
+            width = cand_classes.shape[1]
+            best = best + np.arange(rows.size, dtype='int64').reshape(-1, 1) * width
+            values[rows] = best_values
+            classes[rows] = np.take(cand_classes.reshape(-1), best, mode='clip')
+        return values, classes
+
+    def __repr__(self):
+        s = '{name}({in_units} -> {num_classes}, cutoffs={cutoffs})'
+        return s.format(name=self.__class__.__name__, in_units=self.head.weight.shape[1],
+                        num_classes=self._num_classes, cutoffs=self._cutoffs[:-1])
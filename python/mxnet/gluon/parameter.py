@@ -115,6 +115,8 @@ class Parameter(object):
         self._ctx_map = None
         self._trainer = None
         self._deferred_init = ()
+        # rows updated since the last save or load, set by Trainer, for delta checkpoints
+        self._dirty_rows = None
         self._differentiable = differentiable
         self._allow_deferred_init = allow_deferred_init
         self._grad_req = None
@@ -283,6 +285,7 @@ class Parameter(object):
         """
         if cast_dtype:
             assert dtype_source in ['current', 'saved']
+        self._dirty_rows = None
         if self.shape:
             unknown_dim_size = -1 if is_np_shape() else 0
             for self_dim, data_dim in zip(self.shape, data.shape):
@@ -363,8 +366,8 @@ class Parameter(object):
 
             self._init_impl(data, ctx)
 
-    def _init_impl(self, data, ctx_list):
-        """Sets data and grad."""
+    def _init_impl(self, data, ctx_list, copy=True):
+        """Sets data and grad. Without copy, data is the data of its only context."""
         self._ctx_list = list(ctx_list)
         self._ctx_map = [[], []]
         for i, ctx in enumerate(self._ctx_list):
@@ -373,9 +376,24 @@ class Parameter(object):
                 dev_list.append(None)
             dev_list[ctx.device_id] = i
 
-        self._data = [data.copyto(ctx) for ctx in self._ctx_list]
+        if copy:
+            self._data = [data.copyto(ctx) for ctx in self._ctx_list]
+        else:
+            assert self._ctx_list == [data.context]
+            self._data = [data]
         self._init_grad()
 
+    def _init_shared(self, data):
+        """(Re)initializes with data, the read-only memory of another process, without copying it."""
+        if self.grad_req != 'null':
+            raise ValueError("Parameter '%s' reads the memory of another process and cannot have "
+                             "gradients. Set its grad_req to 'null'."%self.name)
+        self.shape = data.shape
+        self._dtype = data.dtype
+        self._dirty_rows = None
+        self._deferred_init = ()
+        self._init_impl(data, [data.context], copy=False)
+
     def _init_grad(self):
         """Initialize grad buffers."""
         if self.grad_req == 'null':
@@ -508,9 +526,53 @@ class Parameter(object):
             raise ValueError("Cannot reset context for Parameter '%s' because it "
                              "has not been initialized."%self.name)
 
+    def _track_rows(self):
+        """Starts recording the rows updated through row_sparse gradients, once the data is
+        saved or loaded, so that a delta checkpoint only saves these rows."""
+        self._dirty_rows = None
+        if self._grad_stype == 'row_sparse' and self._data is not None:
+            self._dirty_rows = ndarray.zeros((self.shape[0],), ctx=self.list_ctx()[0],
+                                             dtype='uint8')
+
+    def _mark_rows(self, grads):
+        """Records the rows of the row_sparse gradients grads as updated."""
+        if self._dirty_rows is None:
+            return
+        for grad in grads:
+            indices = grad.indices
+            if indices.size:
+                self._dirty_rows[indices.as_in_context(self._dirty_rows.ctx)] = 1
+
+    def _dirty_row_ids(self):
+        """The ids of the rows updated since the last save or load, or None when they are not
+        recorded, e.g. since the parameter is updated densely."""
+        if self._dirty_rows is None:
+            return None
+        rows = np.flatnonzero(self._dirty_rows.asnumpy())
+        return ndarray.array(rows, ctx=context.cpu(), dtype='int64')
+
+    def _reduce_rows(self, row_ids):
+        """Reduce the rows row_ids of the data from multiple context to a row_sparse array
+        on cpu."""
+        ctx = context.cpu()
+        if self._stype == 'default':
+            block = [w.as_nd_ndarray() if is_np_array() else w for w in self.list_data()]
+            rows = [ndarray.take(w, row_ids.as_in_context(w.ctx)).copyto(ctx) for w in block]
+            values = rows[0] if len(rows) == 1 else ndarray.add_n(*rows) / len(rows)
+            return ndarray.sparse.row_sparse_array((values, row_ids), shape=self.shape,
+                                                   ctx=ctx)
+        data = ndarray.zeros(self.shape, stype='row_sparse', ctx=ctx)
+        trainer = self._trainer() if self._trainer else None
+        if not trainer:
+            raise RuntimeError("Cannot reduce row_sparse data for Parameter '%s' when no " \
+                               "Trainer is created with it."%self.name)
+        trainer._row_sparse_pull(self, data, row_ids)
+        return data
+
     def set_data(self, data):
         """Sets this parameter's value on all contexts."""
         self.shape = data.shape
+        self._dirty_rows = None
 
         if self._data is None:
             assert self._deferred_init, \
@@ -38,7 +38,7 @@ class _RNNLayer(HybridBlock):
                  i2h_bias_initializer, h2h_bias_initializer,
                  mode, projection_size, h2r_weight_initializer,
                  lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan,
-                 dtype, use_sequence_length=False, **kwargs):
+                 dtype, use_sequence_length=False, use_persistent=False, **kwargs):
         super(_RNNLayer, self).__init__(**kwargs)
         assert layout in ('TNC', 'NTC'), \
             "Invalid layout %s; must be one of ['TNC' or 'NTC']"%layout
@@ -60,6 +60,7 @@ class _RNNLayer(HybridBlock):
         self._lstm_state_clip_nan = lstm_state_clip_nan
         self._dtype = dtype
         self._use_sequence_length = use_sequence_length
+        self._use_persistent = use_persistent
         self.skip_states = None
 
         self._gates = {'rnn_relu': 1, 'rnn_tanh': 1, 'lstm': 4, 'gru': 3}[mode]
@@ -244,7 +245,8 @@ class _RNNLayer(HybridBlock):
                       p=self._dropout, state_outputs=True, mode=self._mode,
                       lstm_state_clip_min=self._lstm_state_clip_min,
                       lstm_state_clip_max=self._lstm_state_clip_max,
-                      lstm_state_clip_nan=self._lstm_state_clip_nan)
+                      lstm_state_clip_nan=self._lstm_state_clip_nan,
+                      use_persistent=self._use_persistent)
 
         if self._mode == 'lstm':
             outputs, states = rnn[0], [rnn[1], rnn[2]]
@@ -20,6 +20,7 @@
 """Parameter optimizer."""
 __all__ = ['Trainer']
 
+import pickle
 from collections import OrderedDict
 
 from .. import optimizer as opt
@@ -68,6 +69,14 @@ class Trainer(object):
         If None and optimizer.aggregate_num > 1, `update_on_kvstore` is set to False.
         If the `update_on_kvstore` argument is provided,
         environment variable `MXNET_UPDATE_ON_KVSTORE` will be ignored.
+    shard_optimizer_states : bool, default False
+        Whether each Parameter is updated on one of the contexts only, so that the optimizer
+        states (e.g. the mean and variance of Adam) are kept once instead of on every context.
+        The Parameters are assigned to the contexts balancing their sizes. The gradients are
+        reduced to the owning context only and the updated weights are copied from it to the
+        other contexts. Requires dense Parameters and `update_on_kvstore=False`; after
+        `allreduce_grads()` only the gradient on the owning context is reduced. With a dist
+        kvstore the states are sharded between the contexts of each worker.
 
     Properties
     ----------
@@ -76,7 +85,7 @@ class Trainer(object):
         optimizer, its learning rate can be accessed as optimizer.learning_rate.
     """
     def __init__(self, params, optimizer, optimizer_params=None, kvstore='device',
-                 compression_params=None, update_on_kvstore=None):
+                 compression_params=None, update_on_kvstore=None, shard_optimizer_states=False):
         param_list = []
         if isinstance(params, (dict, OrderedDict)):
             for key in sorted(list(params.keys())):
@@ -108,6 +117,16 @@ class Trainer(object):
                 self._contains_sparse_grad = True
         self._compression_params = compression_params
         self._contexts = self._check_contexts()
+        self._shard_optimizer_states = shard_optimizer_states
+        if shard_optimizer_states:
+            if self._contains_sparse_weight or self._contains_sparse_grad:
+                raise ValueError("Cannot shard the optimizer states of sparse Parameters.")
+            if update_on_kvstore:
+                raise ValueError("Cannot set update_on_kvstore=True "
+                                 "when the optimizer states are sharded.")
+            update_on_kvstore = False
+        # the index of the context updating each Parameter when the states are sharded
+        self._owners = {}
         optimizer_params = optimizer_params if optimizer_params else {}
         self._init_optimizer(optimizer, optimizer_params)
         self._scale = self._optimizer.rescale_grad
@@ -249,6 +268,9 @@ class Trainer(object):
             if self._distributed and 'async' in kvstore.type:
                 update_on_kvstore = True
                 # raise err if user provides unsupported configs
+                if self._shard_optimizer_states:
+                    raise ValueError("Cannot shard the optimizer states "
+                                     "when training in async mode.")
                 if config['update_on_kvstore'] is False:
                     raise ValueError("Please set update_on_kvstore=True "
                                      "when training in async mode.")
@@ -274,8 +296,24 @@ class Trainer(object):
             self._kvstore = None
             self._update_on_kvstore = None
 
+        if self._shard_optimizer_states:
+            self._init_owners()
         self._kv_initialized = True
 
+    def _init_owners(self):
+        """Assigns each Parameter to the context with the fewest elements so far,
+        largest Parameters first."""
+        if not self._kvstore and len(self._contexts) > 1:
+            raise ValueError("Cannot shard the optimizer states between %d contexts "
+                             "without a kvstore." % len(self._contexts))
+        loads = [0] * len(self._contexts)
+        sizes = [(param.data(self._contexts[0]).size, i) for i, param in enumerate(self._params)]
+        self._owners = {}
+        for size, i in sorted(sizes, key=lambda s: (-s[0], s[1])):
+            owner = loads.index(min(loads))
+            self._owners[i] = owner
+            loads[owner] += size
+
     @property
     def learning_rate(self):
         if not isinstance(self._optimizer, opt.Optimizer):
@@ -386,6 +424,8 @@ class Trainer(object):
         # nothing to reduce
         if not self._kvstore:
             return
+        # the dense gradients are reduced by one call, so that the kvstore can fuse them
+        fused_keys, fused_grads, fused_priority = [], [], 0
         for i, param in enumerate(self._params):
             if param.grad_req != 'null':
                 idx = self._param2idx[param._uuid]
@@ -405,8 +445,19 @@ class Trainer(object):
                     # otherwise push dense gradients, pull dense weights
                     if self._update_on_kvstore:
                         self._kvstore.pushpull(idx, grad_list, out=param.list_data(), priority=-i)
+                    elif self._shard_optimizer_states:
+                        # only the owner updates the weight, reduce to it
+                        self._kvstore.pushpull(idx, grad_list, out=grad_list[self._owners[i]],
+                                               priority=-i)
+                    elif isinstance(self._kvstore, KVStore):
+                        if not fused_keys:
+                            fused_priority = -i
+                        fused_keys.append(idx)
+                        fused_grads.append(grad_list)
                     else:
                         self._kvstore.pushpull(idx, grad_list, priority=-i)
+        if fused_keys:
+            self._kvstore.pushpull(fused_keys, fused_grads, priority=fused_priority)
 
     def update(self, batch_size, ignore_stale_grad=False):
         """Makes one step of parameter update.
@@ -444,10 +495,16 @@ class Trainer(object):
     def _update(self, ignore_stale_grad=False):
         loss_scaler = getattr(self, '_amp_loss_scaler', None)
         if loss_scaler is not None:
-            if loss_scaler.has_overflow(self._params):
+            if loss_scaler.on_device:
+                assert not (self._kvstore and self._update_on_kvstore), \
+                    'AMP with device_loss_scale requires update_on_kvstore=False'
+                # the optimizer skips the step on the devices
+                loss_scaler.check_overflow_on_device(self._params)
+            elif loss_scaler.has_overflow(self._params):
                 return  # skip on overflow
 
         updates = [[] for _ in self._updaters]
+        shard_updated = []
 
         for i, param in enumerate(self._params):
             if param.grad_req == 'null':
@@ -465,9 +522,26 @@ class Trainer(object):
                             "warning and skip updating of Parameters with stale gradient" \
                             %(param.name, str(data.context)))
 
+            if param._dirty_rows is not None:
+                if self._updates_rows_only():
+                    param._mark_rows(param.list_grad())
+                else:
+                    # every row changes, the next delta checkpoint saves the whole parameter
+                    param._dirty_rows = None
+
             if self._kvstore and self._update_on_kvstore:
                 continue
 
+            if self._shard_optimizer_states:
+                owner = self._owners[i]
+                arr = param.list_data()[owner]
+                if not ignore_stale_grad or arr._fresh_grad:
+                    updates[owner].append((i, param.list_grad()[owner], arr))
+                    shard_updated.append(i)
+                for data in param.list_data():
+                    data._fresh_grad = False
+                continue
+
             for upd, arr, grad in zip(updates, param.list_data(), param.list_grad()):
                 if not ignore_stale_grad or arr._fresh_grad:
                     upd.append((i, grad, arr))
@@ -478,6 +552,22 @@ class Trainer(object):
                 if upd:
                     i, g, w = zip(*upd)
                     updater(i, g, w)
+            # copy the updated weights from their owners to the other contexts
+            for i in shard_updated:
+                data_list = self._params[i].list_data()
+                owner = self._owners[i]
+                for j, data in enumerate(data_list):
+                    if j != owner:
+                        data_list[owner].copyto(data)
+
+        if loss_scaler is not None and loss_scaler.on_device:
+            loss_scaler.update_on_device()
+
+    def _updates_rows_only(self):
+        """Whether the optimizer only changes the rows of the row_sparse gradients."""
+        if isinstance(self._optimizer, opt.AdaGrad):
+            return self._optimizer.use_fused_step
+        return getattr(self._optimizer, 'lazy_update', False)
 
     def save_states(self, fname):
         """Saves trainer states (e.g. optimizer, momentum) to a file.
@@ -504,6 +594,12 @@ class Trainer(object):
             assert not self._params_to_init, "Cannot save trainer states when some " \
                                              "parameters are not yet initialized in kvstore."
             self._kvstore.save_optimizer_states(fname, dump_optimizer=True)
+        elif self._shard_optimizer_states:
+            states = {}
+            for updater in self._updaters:
+                states.update(updater.states)
+            with open(fname, 'wb') as fout:
+                fout.write(pickle.dumps((states, self._updaters[0].optimizer)))
         else:
             with open(fname, 'wb') as fout:
                 fout.write(self._updaters[0].get_states(dump_optimizer=True))
@@ -533,9 +629,14 @@ class Trainer(object):
         else:
             with open(fname, 'rb') as f:
                 states = f.read()
-            for updater in self._updaters:
+            for j, updater in enumerate(self._updaters):
                 updater.set_states(states)
                 updater.optimizer = self._updaters[0].optimizer
+                if self._shard_optimizer_states:
+                    # keep the states of the Parameters this context updates
+                    updater.states = {k: v for k, v in updater.states.items()
+                                      if self._owners.get(k) == j}
+                    updater.states_synced = dict.fromkeys(updater.states.keys(), False)
             self._optimizer = self._updaters[0].optimizer
         param_dict = {i: param for i, param in enumerate(self._params)}
         self._optimizer.param_dict = param_dict
@@ -20,7 +20,8 @@
 """Parallelization utility optimizer."""
 
 __all__ = ['split_data', 'split_and_load', 'clip_global_norm',
-           'check_sha1', 'download', 'replace_file']
+           'check_sha1', 'download', 'replace_file', 'compact_parameters',
+           'export_shared_gpu_parameters', 'load_shared_gpu_parameters']
 
 import os
 import sys
@@ -34,8 +35,10 @@ import requests
 import numpy as np
 
 from .. import ndarray
-from ..util import is_np_shape, is_np_array
+from ..base import MXNetError
+from ..util import is_np_shape, is_np_array, np_array, np_shape
 from .. import numpy as _mx_np  # pylint: disable=reimported
+from .. import numpy_extension as _mx_npx
 
 
 def split_data(data, num_slice, batch_axis=0, even_split=True):
@@ -145,6 +148,17 @@ def clip_global_norm(arrays, max_norm, check_isfinite=True):
             sum += _mx_np.square(arg).sum().item()
         return sum
     arrays_groups = group_by_ctx(arrays)
+    if len(arrays_groups) == 1 and all(arr.dtype == arrays[0].dtype for arr in arrays):
+        # the norm and the scale are computed on the device, and all the arrays are scaled in
+        # a few kernels without a synchronization
+        total_norm = _mx_npx.multi_clip_global_norm(*arrays, num_arrays=len(arrays), max_norm=max_norm)
+        if check_isfinite:
+            total_norm = total_norm.item()
+            if not np.isfinite(total_norm):
+                warnings.warn(
+                    UserWarning('nan or inf is detected. '
+                                'Clipping results will be undefined.'), stacklevel=2)
+        return total_norm
     all_ctx_sum = _mx_np.array([0])
     ctx = arrays[0].ctx
     for group in arrays_groups:
@@ -504,3 +518,132 @@ def _check_block_input_np_ndarrays(inputs):
         for i in inputs:
             _check_block_input_np_ndarrays(i)
     # pylint: enable=no-else-raise
+
+
+def _string_to_array(string):
+    """Stores a string as an array of bytes, to save it along with the parameters."""
+    data = np.frombuffer(string.encode('utf-8'), dtype=np.uint8)
+    if is_np_array():
+        return _mx_np.array(data, dtype=np.uint8)
+    return ndarray.array(data, dtype=np.uint8)
+
+
+def _array_to_string(array):
+    """Reads back a string stored by _string_to_array."""
+    return array.asnumpy().tobytes().decode('utf-8')
+
+
+def _load_parameter_file(filename):
+    """Loads the arrays of a file written by `Block.save_parameters`. The arrays of a delta
+    checkpoint are applied to those of its base checkpoint, loaded in turn."""
+    if is_np_array():
+        # failure may happen when loading parameters saved as NDArrays within
+        # NumPy semantics. Check the failure type and recover from it if it happens.
+        try:
+            loaded = _mx_npx.load(filename)
+        except MXNetError as e:
+            err_msg = str(e)
+            if 'is_np_shape' in err_msg:
+                # Loading failure due to parameters saved without numpy semantics.
+                # Temporarily disable numpy semantics and load parameters. After it's
+                # done, resume the numpy semantics. This is fine because the cases
+                # numpy ndarray covers is a superset of the legacy ndarray's.
+                with np_array(False):
+                    with np_shape(False):
+                        loaded_nds = ndarray.load(filename)
+                assert isinstance(loaded_nds, dict),\
+                    'expecting a dict type, got {}'.format(str(type(loaded_nds)))
+                loaded = {k: loaded_nds[k].as_np_ndarray() for k in loaded_nds}
+            else:
+                raise ValueError(err_msg)
+    else:
+        loaded = ndarray.load(filename)
+    if not isinstance(loaded, dict) or '__base__' not in loaded:
+        return loaded
+    if is_np_array():
+        # npx.load reads the rows of a delta as dense arrays, ndarray.load as row_sparse ones
+        loaded = {k: v.as_np_ndarray() if v.stype == 'default' else v
+                  for k, v in ndarray.load(filename).items()}
+
+    base = _array_to_string(loaded.pop('__base__'))
+    full = _load_parameter_file(os.path.join(os.path.dirname(os.path.abspath(filename)), base))
+    for name, delta in loaded.items():
+        if getattr(delta, 'stype', 'default') != 'row_sparse' or name not in full:
+            full[name] = delta
+            continue
+        data = full[name]
+        stype = getattr(data, 'stype', 'default')
+        if stype != 'default':
+            data = data.tostype('default')
+        if delta.indices.size:
+            if is_np_array():
+                data[delta.indices.as_np_ndarray()] = delta.data.as_np_ndarray()
+            else:
+                data[delta.indices] = delta.data
+        full[name] = data if stype == 'default' else data.tostype(stype)
+    return full
+
+
+def compact_parameters(filename, out):
+    """Writes the parameters of a delta checkpoint, saved by `Block.save_parameters` with
+    `base`, to a full checkpoint, so that it no longer refers to its chain of base checkpoints.
+
+    Parameters
+    ----------
+    filename : str
+        Path to the checkpoint, full or delta.
+    out : str
+        Path to the full checkpoint to write, which may be `filename`.
+    """
+    arg_dict = _load_parameter_file(filename)
+    if is_np_array():
+        _mx_npx.savez(out, **arg_dict)
+    else:
+        ndarray.save(out, arg_dict)
+
+
+def export_shared_gpu_parameters(params):
+    """Returns the CUDA IPC handles of the GPU memory of parameters, with which the other
+    processes on the host read them by `load_shared_gpu_parameters` without copies, so that
+    the processes serving a model hold a single copy of its parameters on each GPU.
+
+    This process must keep the parameters alive and must not update them while the other
+    processes use them.
+
+    Parameters
+    ----------
+    params : dict of str to Parameter
+        The parameters, as given by `Block.collect_params`, initialized on a GPU. Only the
+        data on their first context is shared.
+
+    Returns
+    -------
+    dict of str to tuple
+        The handles by parameter name, which pickle and can be sent to the other processes.
+    """
+    return {name: p.data(p.list_ctx()[0])._to_shared_gpu_mem() for name, p in params.items()}
+
+
+def load_shared_gpu_parameters(params, handles, device_id=None):
+    """Initializes parameters with the GPU memory of the parameters of another process,
+    exported by `export_shared_gpu_parameters`, without copying it. The parameters must not
+    be updated and must have a `grad_req` of 'null'. The memory is unmapped when the last
+    parameter reading it is freed.
+
+    Parameters
+    ----------
+    params : dict of str to Parameter
+        The parameters, as given by `Block.collect_params`.
+    handles : dict of str to tuple
+        The handles by parameter name, as given by `export_shared_gpu_parameters`.
+    device_id : int, optional
+        The id of the GPU holding the memory in this process, by default the one it has in
+        the exporting process, which differs when the processes see different devices.
+    """
+    array_cls = _mx_np.ndarray if is_np_array() else ndarray.NDArray
+    for name, param in params.items():
+        ipc_handle, offset, dev_id, shape, dtype = handles[name]
+        if device_id is not None:
+            dev_id = device_id
+        hdl = ndarray.ndarray._new_from_shared_gpu_mem(ipc_handle, offset, dev_id, shape, dtype)
+        param._init_shared(array_cls(hdl, writable=False))
@@ -424,6 +424,10 @@ def create(name='local'):
     ``dist_device_sync``: Identical to ``dist_sync`` with the difference similar
     to ``device`` vs ``local``.
 
+    ``dist_nccl_hier``: Identical to ``dist_device_sync``, but ``pushpull`` reduce-scatters
+    the gradients of the GPUs of a machine with NCCL, exchanges every shard with the
+    servers, and all-gathers the results with NCCL.
+
     ``dist_async``: Performs asynchronous updates.
     The weights are updated whenever gradients are received from any machine.
     No two updates happen on the same weight at the same time. However, the order is not
@@ -435,7 +439,7 @@ def create(name='local'):
 
     Parameters
     ----------
-    name : {'local', 'device', 'nccl', 'dist_sync', 'dist_device_sync', 'dist_async', 'horovod', 'byteps'}
+    name : {'local', 'device', 'nccl', 'dist_sync', 'dist_device_sync', 'dist_nccl_hier', 'dist_async', 'horovod', 'byteps'}
         The type of KVStore.
 
     Returns
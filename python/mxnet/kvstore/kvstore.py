@@ -46,7 +46,10 @@ def _get_kvstore_server_command_type(command):
                      'kStopServer': 2,
                      'kSyncMode': 3,
                      'kSetGradientCompression': 4,
-                     'kSetProfilerParams': 5}
+                     'kSetProfilerParams': 5,
+                     'kSnapshot': 6,
+                     'kSetNumWorkers': 7,
+                     'kInitHashEmbedding': 8}
     assert (command in command_types), "Unknown command type to send to server"
     return command_types[command]
 
@@ -181,6 +184,64 @@ class KVStore(KVStoreBase):
         else:
             check_call(_LIB.MXKVStoreInit(self.handle, mx_uint(len(ckeys)), ckeys, cvals))
 
+    def init_hash_embedding(self, key, shape, **kwargs):
+        """ Initializes a row_sparse key of shape ``(num_ids, dim)`` whose rows are stored in
+        hash tables, e.g. the embedding of hashed feature ids in a 2**40 id space.
+
+        The memory is proportional to the number of ids pushed rather than to ``num_ids``. The
+        key is pushed with row_sparse gradients and pulled with `row_sparse_pull`, the row ids
+        being the int64 ids of the features. The pushes update the rows with the optimizer of
+        the kwargs on the store, instead of the optimizer set with `set_optimizer`, and are
+        applied as they are received, also by ``dist_sync`` servers. With a ``dist`` kvstore,
+        the ids are sharded across the hash tables of the servers, which are not saved by the
+        server snapshots.
+
+        Parameters
+        ----------
+        key : str or int
+            The key.
+        shape : tuple of int
+            The shape ``(num_ids, dim)`` of the key. The rows are float32.
+        optimizer : {'sgd', 'adagrad'}, default 'sgd'
+            Update of the pushed rows.
+        learning_rate : float, default 0.01
+            Learning rate of the updates.
+        wd : float, default 0
+            Weight decay of the updated rows.
+        init_scale : float, default 0.01
+            The rows are initialized uniformly in ``[-init_scale, init_scale]``.
+        admit_count : int, default 1
+            Number of pushes of an id before it is given a row. The pulls of the ids without
+            a row return zeros, and their gradients are dropped.
+        max_idle_updates : int, default 0
+            The rows not pushed during this many pushes of the key are evicted. 0 never
+            evicts.
+        capacity : int, default 0
+            Maximum number of rows of a hash table, the new ids are not admitted when it is
+            full. 0 is unbounded.
+
+        Examples
+        --------
+        >>> kv = mx.kv.create('local')
+        >>> kv.init_hash_embedding('emb', (2**40, 8), admit_count=2, max_idle_updates=1000)
+        >>> ids = mx.nd.array([3, 2**39], dtype='int64')
+        >>> grad = mx.nd.sparse.row_sparse_array((mx.nd.ones((2, 8)), ids), shape=(2**40, 8))
+        >>> kv.push('emb', grad)
+        >>> rows = mx.nd.sparse.zeros('row_sparse', (2**40, 8))
+        >>> kv.row_sparse_pull('emb', out=rows, row_ids=ids)
+        >>> out = mx.nd.sparse.Embedding(ids, rows, input_dim=2**40, output_dim=8)
+        """
+        assert len(shape) == 2, "the shape of a hash embedding is (num_ids, dim)"
+        param_keys, param_vals = _ctype_dict(kwargs)
+        if isinstance(key, str):
+            check_call(_LIB.MXKVStoreInitHashEmbeddingEx(
+                self.handle, c_str(key), ctypes.c_int64(shape[0]), ctypes.c_int64(shape[1]),
+                mx_uint(len(kwargs)), param_keys, param_vals))
+        else:
+            check_call(_LIB.MXKVStoreInitHashEmbedding(
+                self.handle, ctypes.c_int(key), ctypes.c_int64(shape[0]), ctypes.c_int64(shape[1]),
+                mx_uint(len(kwargs)), param_keys, param_vals))
+
     def push(self, key, value, priority=0):
         """ Pushes a single or a sequence of key-value pairs into the store.
 
@@ -516,6 +577,13 @@ class KVStore(KVStoreBase):
         original values is stored at the sender's end as residual and added to the
         gradient in the next iteration.
 
+        The fp16 and bf16 compressions cast every value of the gradient to a half precision
+        float, two of which are packed in one float. The int8 compression clips the gradient
+        to [-threshold, threshold] and quantizes it linearly to 8bit integers, packing four
+        values in one float. The topk compression takes a `block_size` and sends only the
+        value of the largest magnitude of every block of `block_size` values, with its
+        offset in the block. All of them keep the residual like the 2bit compression.
+
         When kvstore is 'local', gradient compression is used to reduce communication
         between multiple devices (gpus). Gradient is quantized on each GPU which
         computed the gradients, then sent to the GPU which merges the gradients. This
@@ -544,7 +612,7 @@ class KVStore(KVStoreBase):
             A dictionary specifying the type and parameters for gradient compression.
             The key `type` in this dictionary is a
             required string argument and specifies the type of gradient compression.
-            Currently `type` can be only `1bit` and `2bit`
+            Currently `type` can be `1bit`, `2bit`, `fp16`, `bf16`, `int8` and `topk`
             Other keys in this dictionary are optional and specific to the type
             of gradient compression.
         """
@@ -660,6 +728,51 @@ class KVStore(KVStoreBase):
         with open(fname, 'wb') as fout:
             fout.write(self._updater.get_states(dump_optimizer))
 
+    def save_server_snapshot(self, prefix, incremental=False):
+        """Lets every server save its own keys and optimizer states, without pulling them
+        to the worker. This is often used to checkpoint large models trained with a
+        distributed kvstore.
+
+        Server `i` writes the values of its keys to ``<prefix>-server<i>.params``, and the
+        optimizer states to ``<prefix>-server<i>.states``. The prefix can be any path
+        supported by ``dmlc::Stream``, e.g. a local path or an S3 or HDFS URI for the
+        values. The values are copied when the servers receive the command, and written
+        in the background while the training goes on. Only the worker of rank 0 sends
+        the command.
+
+        Parameters
+        ----------
+        prefix : str
+            Path prefix of the snapshot files.
+        incremental : bool, default False
+            Whether to only save the rows of the row_sparse keys pushed since the previous
+            snapshot. The dense keys are always saved in full.
+        """
+        assert 'dist' in self.type # pylint: disable=unsupported-membership-test
+        if self.rank == 0:
+            cmd = _get_kvstore_server_command_type('kSnapshot')
+            self._send_command_to_servers(cmd, '%s,%d' % (prefix, int(incremental)))
+
+    def set_num_active_workers(self, num_workers):
+        """Sets the number of workers whose pushes a ``dist_sync`` server merges in each
+        round, e.g. after some of the workers left the training. The pushes received from
+        more workers are merged in the next round. Only the worker of rank 0 sends the
+        command.
+
+        The stragglers can also be skipped with ``MXNET_KVSTORE_SYNC_TIMEOUT``, after which
+        a server applies a round with the pushes received so far.
+
+        Parameters
+        ----------
+        num_workers : int
+            Number of workers pushing every key in each round.
+        """
+        assert 'dist' in self.type # pylint: disable=unsupported-membership-test
+        assert num_workers > 0, "the number of workers must be positive"
+        if self.rank == 0:
+            cmd = _get_kvstore_server_command_type('kSetNumWorkers')
+            self._send_command_to_servers(cmd, str(num_workers))
+
     def load_optimizer_states(self, fname):
         """Loads the optimizer (updater) state from the file.
 
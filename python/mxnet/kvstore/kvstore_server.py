@@ -21,7 +21,7 @@ import ctypes
 import sys
 import pickle
 import logging
-from ..base import _LIB, check_call
+from ..base import _LIB, check_call, py_str
 from .base import create
 
 __all__ = ['KVStoreServer']
@@ -57,6 +57,10 @@ class KVStoreServer(object):
                 except:
                     raise
                 self.kvstore.set_optimizer(optimizer)
+            elif cmd_id == 6:
+                # kSnapshot, the body is the file of the optimizer states
+                if self.kvstore._updater is not None: # pylint: disable=protected-access
+                    self.kvstore.save_optimizer_states(py_str(cmd_body))
             else:
                 print("server %d, unknown command (%d, %s)" % (
                     self.kvstore.rank, cmd_id, cmd_body))
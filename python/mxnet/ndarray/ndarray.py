@@ -38,6 +38,7 @@ from ..base import c_array, c_array_buf, c_handle_array, mx_real_t
 from ..base import mx_uint, NDArrayHandle, check_call, mx_int, mx_int64
 from ..base import ctypes2buffer
 from ..dlpack import ndarray_to_dlpack_for_read, ndarray_to_dlpack_for_write
+from ..dlpack import ndarray_to_dlpack_for_stream, DLPACK_DEVICE_TYPE
 from ..dlpack import ndarray_from_dlpack, ndarray_from_numpy
 from ..runtime import Features
 from ..context import Context, current_context
@@ -228,6 +229,19 @@ def _new_from_shared_mem(shared_pid, shared_id, shape, dtype):
     return hdl
 
 
+def _new_from_shared_gpu_mem(ipc_handle, offset, dev_id, shape, dtype):
+    hdl = NDArrayHandle()
+    check_call(_LIB.MXNDArrayCreateFromSharedGPUMem(
+        ctypes.c_char_p(ipc_handle),
+        ctypes.c_uint64(offset),
+        ctypes.c_int(dev_id),
+        c_array(mx_int, shape),
+        mx_int(len(shape)),
+        ctypes.c_int(int(_DTYPE_NP_TO_MX[np.dtype(dtype).type])),
+        ctypes.byref(hdl)))
+    return hdl
+
+
 def waitall():
     """Wait for all async operations to finish in MXNet.
 
@@ -246,6 +260,39 @@ def _storage_type(handle):
     return storage_type.value
 
 
+class CopyFuture(object):
+    """A pending copy of an array to a ``numpy.ndarray``, returned by ``NDArray.asnumpy_async``,
+    or a pending save of ``npx.savez_async``, whose result is None.
+
+    The future can be polled with ``done``, waited for with ``result``, or awaited in a coroutine.
+    """
+    def __init__(self, handle, out):
+        self.handle = handle
+        self._out = out
+
+    def __del__(self):
+        check_call(_LIB.MXNDArrayCopyFree(self.handle))
+
+    def done(self):
+        """Returns whether the copy has completed, without blocking."""
+        done = ctypes.c_int(0)
+        check_call(_LIB.MXNDArrayCopyIsDone(self.handle, ctypes.byref(done)))
+        return done.value == 1
+
+    def result(self):
+        """Blocks until the copy completes, and returns the ``numpy.ndarray`` it wrote to.
+
+        Raises the error of the copy, or of the operations computing the array, if any.
+        """
+        check_call(_LIB.MXNDArrayCopyWait(self.handle))
+        return self._out
+
+    def __await__(self):
+        import asyncio
+        # the wait releases the GIL, so the event loop keeps running in the meantime
+        return asyncio.get_event_loop().run_in_executor(None, self.result).__await__()
+
+
 class NDArray(NDArrayBase):
     """An array object representing a multidimensional, homogeneous array of
 fixed-size items.
@@ -300,6 +347,14 @@ fixed-size items.
             self.handle, ctypes.byref(shared_pid), ctypes.byref(shared_id)))
         return shared_pid.value, shared_id.value, self.shape, self.dtype
 
+    def _to_shared_gpu_mem(self):
+        ipc_handle = ctypes.create_string_buffer(64)
+        offset = ctypes.c_uint64()
+        dev_id = ctypes.c_int()
+        check_call(_LIB.MXNDArrayGetSharedGPUMemHandle(
+            self.handle, ipc_handle, ctypes.byref(offset), ctypes.byref(dev_id)))
+        return ipc_handle.raw, offset.value, dev_id.value, self.shape, self.dtype
+
     def __abs__(self):
         """x.__abs__() <=> abs(x) <=> x.abs() <=> mx.nd.abs(x, y)"""
         return self.abs()
@@ -2426,6 +2481,23 @@ fixed-size items.
         """
         check_call(_LIB.MXNDArrayWaitToRead(self.handle))
 
+    def set_spillable(self):
+        """Allows the memory of this GPU array to be moved to the host while it is not used.
+
+        When the spillable arrays of a GPU hold more than `MXNET_GPU_SPILL_BUDGET` bytes,
+        the least recently used ones are copied to pinned host memory, or to a file in
+        `MXNET_GPU_SPILL_DIR`, and copied back before the next operator that uses them.
+        This suits large arrays that are used rarely, such as optimizer states. The
+        array must not be a parameter of a hybridized block with `static_alloc=True`
+        and cannot grow afterwards.
+
+        Examples
+        --------
+        >>> state = mx.nd.zeros((1024, 1024), ctx=mx.gpu(0))
+        >>> state.set_spillable()
+        """
+        check_call(_LIB.MXNDArraySetSpillable(self.handle))
+
     @property
     def ndim(self):
         """Returns the number of dimensions of this array
@@ -2626,6 +2698,47 @@ fixed-size items.
             ctypes.c_size_t(data.size)))
         return data
 
+    def asnumpy_async(self, out=None):
+        """Copies this array to a ``numpy.ndarray`` without blocking.
+
+        The copy runs after the pending operations writing this array, and the returned future
+        completes once the data is in `out`. Unlike ``asnumpy``, the calling thread can meanwhile
+        push more work, e.g. the next request of a server, and the copies from a GPU overlap with
+        its computation when `out` is page-locked memory.
+
+        Parameters
+        ----------
+        out : numpy.ndarray, optional
+            The C-contiguous writable array to copy into, with the shape and the dtype of this
+            array. It must not be used until the copy completes. By default a new array.
+
+        Returns
+        -------
+        CopyFuture
+            The pending copy, the ``result`` of which is `out`.
+
+        Examples
+        --------
+        >>> x = mx.nd.ones((2,3), ctx=mx.gpu(0))
+        >>> future = x.asnumpy_async()
+        >>> future.result()
+        array([[ 1.,  1.,  1.],
+               [ 1.,  1.,  1.]], dtype=float32)
+        """
+        if out is None:
+            out = np.empty(self.shape, dtype=self.dtype)
+        elif out.shape != self.shape or out.dtype != np.dtype(self.dtype) or \
+                not out.flags['C_CONTIGUOUS'] or not out.flags['WRITEABLE']:
+            raise ValueError('out must be a C-contiguous writable array of shape {} and dtype {}'
+                             .format(self.shape, np.dtype(self.dtype)))
+        handle = ctypes.c_void_p()
+        check_call(_LIB.MXNDArrayCopyToCPUAsync(
+            self.handle,
+            out.ctypes.data_as(ctypes.c_void_p),
+            ctypes.c_size_t(out.size),
+            ctypes.byref(handle)))
+        return CopyFuture(handle, out)
+
     def asscalar(self):
         """Returns a scalar whose value is copied from this array.
 
@@ -3002,6 +3115,31 @@ fixed-size items.
         """
         return to_dlpack_for_write(self)
 
+    def __dlpack__(self, stream=None):
+        """Returns a reference view of NDArray that represents as DLManagedTensor, following the
+        DLPack protocol of the Python array API.
+
+        For an array on GPU, the call returns without waiting for the previous write operations on
+        the array: the stream of the consumer waits for them on the device instead.
+
+        Parameters
+        ----------
+        stream : int, optional
+            The CUDA stream the consumer uses the tensor on: None or 1 for the legacy default
+            stream, 2 for the per-thread default stream, -1 for no synchronization, or the
+            cudaStream_t otherwise. It is ignored for arrays on CPU.
+
+        Returns
+        -------
+        PyCapsule (the pointer of DLManagedTensor)
+            a reference view of NDArray that represents as DLManagedTensor.
+        """
+        return _to_dlpack_for_stream(self, stream)
+
+    def __dlpack_device__(self):
+        """Returns the DLDeviceType and the device id of the array, for the DLPack protocol."""
+        return (DLPACK_DEVICE_TYPE[self.ctx.device_type], self.ctx.device_id)
+
     def _full(self, value):
         """
         This is added as an NDArray class method in order to support polymorphism in NDArray and numpy.ndarray indexing
@@ -4980,7 +5118,7 @@ from_dlpack_doc = """Returns a NDArray backed by a dlpack tensor.
 
     Parameters
     ----------
-    dlpack: PyCapsule (the pointer of DLManagedTensor)
+    dlpack: PyCapsule (the pointer of DLManagedTensor), or an object with ``__dlpack__``
         input data
 
     Returns
@@ -5038,6 +5176,8 @@ from_numpy_doc = """Returns an MXNet's NDArray backed by numpy's ndarray.
 from_numpy.__doc__ = from_numpy_doc
 
 
+_to_dlpack_for_stream = ndarray_to_dlpack_for_stream()
+
 to_dlpack_for_read = ndarray_to_dlpack_for_read()
 to_dlpack_for_read_doc = """Returns a reference view of NDArray that represents as DLManagedTensor until
 all previous write operations on the current array are finished.
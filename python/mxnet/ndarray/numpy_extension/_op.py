@@ -795,7 +795,7 @@ def pooling(data=None, kernel=None, stride=None, pad=None, pool_type="max",
 
 # pylint: disable=too-many-arguments, unused-argument
 @set_module('mxnet.ndarray.numpy_extension')
-def dropout(data, p=0.5, mode="training", axes=None, cudnn_off=False, **kwargs):
+def dropout(data, p=0.5, mode="training", axes=None, cudnn_off=False, packed_mask=False, **kwargs):
     r"""Applies dropout operation to input array.
 
     - During training, each element of the input is set to zero with probability p.
@@ -817,13 +817,16 @@ def dropout(data, p=0.5, mode="training", axes=None, cudnn_off=False, **kwargs):
         Axes for variational dropout kernel.
     cudnn_off : boolean or None, optional, default=0
         Whether to turn off cudnn in dropout operator. This option is ignored if axes is specified.
+    packed_mask : boolean, optional, default=False
+        Whether to keep the mask as uint8 bits, 8 elements per byte, instead of an array of the data type.
+        cuDNN and MKL are then not used. This option is ignored if axes is specified.
 
     Returns
     -------
     out : NDArray or list of NDArrays
         The output of this function.
     """
-    return _api_internal.dropout(data, p, mode, axes, cudnn_off)
+    return _api_internal.dropout(data, p, mode, axes, cudnn_off, packed_mask)
 
 
 # pylint: disable=too-many-arguments
@@ -892,7 +895,8 @@ def one_hot(data, depth=None, on_value=1.0, off_value=0.0, dtype="float32"):
 def rnn(data=None, parameters=None, state=None, state_cell=None, sequence_length=None,
         mode=None, state_size=None, num_layers=None, bidirectional=False,
         state_outputs=False, p=0.0, use_sequence_length=False, projection_size=None,
-        lstm_state_clip_min=None, lstm_state_clip_max=None, lstm_state_clip_nan=None):
+        lstm_state_clip_min=None, lstm_state_clip_max=None, lstm_state_clip_nan=None,
+        use_persistent=False):
     r"""Applies recurrent layers to input data. Currently, vanilla RNN, LSTM and GRU are
     implemented, with both multi-layer and bidirectional support.
 
@@ -1001,6 +1005,10 @@ def rnn(data=None, parameters=None, state=None, state_cell=None, sequence_length
     use_sequence_length : boolean, optional, default=0
         If set to true, this layer takes in an extra input parameter `sequence_length`
         to specify variable length sequence
+    use_persistent : boolean, optional, default=0
+        Whether to use the persistent cuDNN kernels on GPU, which keep the recurrent weights
+        on chip across the time steps and reduce the latency of small batches. The standard
+        kernels are used when the configuration is not supported.
 
     Returns
     -------
@@ -1021,12 +1029,14 @@ def rnn(data=None, parameters=None, state=None, state_cell=None, sequence_length
             return _api_internal.rnn(data, parameters, state, state_cell, sequence_length,
                                      state_size, num_layers, bidirectional, state_outputs,
                                      mode, p, use_sequence_length, projection_size,
-                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan)
+                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan,
+                                     use_persistent)
         else:
             return _api_internal.rnn(data, parameters, state, sequence_length,
                                      state_size, num_layers, bidirectional, state_outputs,
                                      mode, p, use_sequence_length, projection_size,
-                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan)
+                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan,
+                                     use_persistent)
     else:
         if mode == "lstm":
             assert state_cell is not None, \
@@ -1034,12 +1044,14 @@ def rnn(data=None, parameters=None, state=None, state_cell=None, sequence_length
             return _api_internal.rnn(data, parameters, state, state_cell,
                                      state_size, num_layers, bidirectional, state_outputs,
                                      mode, p, use_sequence_length, projection_size,
-                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan)
+                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan,
+                                     use_persistent)
         else:
             return _api_internal.rnn(data, parameters, state,
                                      state_size, num_layers, bidirectional, state_outputs,
                                      mode, p, use_sequence_length, projection_size,
-                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan)
+                                     lstm_state_clip_min, lstm_state_clip_max, lstm_state_clip_nan,
+                                     use_persistent)
 
 
 # pylint: disable=too-many-arguments, unused-argument
@@ -21,6 +21,7 @@ import ctypes
 
 from ..base import _LIB, check_call, py_str, c_str, string_types, mx_uint, NDArrayHandle
 from ..base import c_array, c_handle_array, c_str_array
+from ..context import current_context
 from .ndarray import NDArray
 from .ndarray import array as _array
 from .ndarray import empty as _empty_ndarray
@@ -146,7 +147,7 @@ def array(source_array, ctx=None, dtype=None):
         return _array(source_array, ctx=ctx, dtype=dtype)
 
 
-def load(fname):
+def load(fname, mmap=False, ctx=None, lazy=False):
     """Loads an array from file.
 
     See more details in ``save``.
@@ -155,6 +156,23 @@ def load(fname):
     ----------
     fname : str
         The filename.
+    mmap : bool, default False
+        Whether to map the file in memory instead of reading it. The dense arrays saved by
+        ``save`` are then copy-on-write views of the file, whose memory the processes loading it
+        share until they write to the arrays. Sparse arrays and files of the legacy format are
+        read.
+    ctx : Context, optional
+        The device to load the arrays to, by default the CPU. The file is then mapped, and the
+        dense arrays are copied to a GPU in chunks through pinned staging buffers, overlapping the
+        reads of the file with the copies to the GPU. See ``MXNET_LOAD_STAGING_BYTES`` and
+        ``MXNET_LOAD_STAGING_BUFFERS``.
+    lazy : bool, default False
+        Whether to defer loading the dense arrays to a GPU `ctx` until they are first used. The file
+        is then mapped, and the GPU memory of an array is only allocated and copied from the file
+        when an operator uses it. Until they are written, the arrays are spilled under memory
+        pressure by freeing their memory, see ``MXNET_GPU_SPILL_BUDGET``, and copied from the file
+        again when they are used next, e.g. for the experts of a sparsely gated model. The arrays
+        loaded lazily to the CPU are those of ``mmap=True``.
 
     Returns
     -------
@@ -168,11 +186,30 @@ def load(fname):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(fname),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    if lazy:
+        ctx = current_context() if ctx is None else ctx
+        check_call(_LIB.MXNDArrayLoadLazy(c_str(fname),
+                                          ctypes.c_int(ctx.device_typeid),
+                                          ctypes.c_int(ctx.device_id),
+                                          ctypes.byref(out_size),
+                                          ctypes.byref(handles),
+                                          ctypes.byref(out_name_size),
+                                          ctypes.byref(names)))
+    elif ctx is not None:
+        check_call(_LIB.MXNDArrayLoadToContext(c_str(fname),
+                                               ctypes.c_int(ctx.device_typeid),
+                                               ctypes.c_int(ctx.device_id),
+                                               ctypes.byref(out_size),
+                                               ctypes.byref(handles),
+                                               ctypes.byref(out_name_size),
+                                               ctypes.byref(names)))
+    else:
+        load_fn = _LIB.MXNDArrayLoadMMap if mmap else _LIB.MXNDArrayLoad
+        check_call(load_fn(c_str(fname),
+                           ctypes.byref(out_size),
+                           ctypes.byref(handles),
+                           ctypes.byref(out_name_size),
+                           ctypes.byref(names)))
     if out_name_size.value == 0:
         return [_ndarray_cls(NDArrayHandle(handles[i])) for i in range(out_size.value)]
     else:
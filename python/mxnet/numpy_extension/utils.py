@@ -21,14 +21,16 @@
 
 import ctypes
 from ..util import is_np_array, is_np_shape
+from ..context import current_context
 from ..base import _LIB, check_call, string_types, c_str_array
 from ..base import c_handle_array, c_str, mx_uint, NDArrayHandle, py_str
 from ..dlpack import ndarray_to_dlpack_for_read, ndarray_to_dlpack_for_write
 from ..dlpack import ndarray_from_dlpack, ndarray_from_numpy
 from ..numpy import ndarray, array
 from ..ndarray import NDArray
+from ..ndarray.ndarray import CopyFuture
 
-__all__ = ['save', 'savez', 'load', 'to_dlpack_for_read', 'to_dlpack_for_write',
+__all__ = ['save', 'savez', 'savez_async', 'load', 'to_dlpack_for_read', 'to_dlpack_for_write',
            'from_dlpack', 'from_numpy']
 
 def save(file, arr):
@@ -121,7 +123,50 @@ def savez(file, *args, **kwds):
     check_call(_LIB.MXNDArraySave(c_str(file), mx_uint(len(handles)), handles, keys))
 
 
-def load(file):
+def savez_async(file, *args, **kwds):
+    """Save several arrays into a single file in uncompressed ``.npz`` format, like ``savez``,
+    without blocking.
+
+    The arrays on GPUs are copied to the CPU after their pending writes, then the file is
+    written on a thread of its own, so that training continues in the meantime. Until the file
+    is written, the writes to the saved arrays on the CPU wait.
+
+    Parameters
+    ----------
+    file : str
+        The filename.
+    args : Arguments, optional
+        Arrays to save to the file, named "arr_0", "arr_1", and so on.
+    kwds : Keyword arguments, optional
+        Arrays to save to the file, named after the keywords.
+
+    Returns
+    -------
+    future : object
+        The pending save, whose ``done`` tells whether the file is written without blocking and
+        whose ``result`` blocks until it is written, raising the error of the save if any.
+    """
+    if len(args):
+        for i, arg in enumerate(args):
+            name = 'arr_{}'.format(str(i))
+            assert name not in kwds, 'Naming conflict between arg {} and kwargs.'.format(str(i))
+            kwds[name] = arg
+
+    str_keys = kwds.keys()
+    nd_vals = kwds.values()
+    if any(not isinstance(k, string_types) for k in str_keys) or \
+            any(not isinstance(v, NDArray) for v in nd_vals):
+        raise TypeError('Only accepts dict str->ndarray or list of ndarrays')
+
+    keys = c_str_array(str_keys)
+    handles = c_handle_array(nd_vals)
+    handle = ctypes.c_void_p()
+    check_call(_LIB.MXNDArraySaveAsync(c_str(file), mx_uint(len(handles)), handles, keys,
+                                       ctypes.byref(handle)))
+    return CopyFuture(handle, None)
+
+
+def load(file, mmap=False, ctx=None, lazy=False):
     """Load arrays from ``.npy``, ``.npz`` or legacy MXNet file format.
 
     See more details in ``save``.
@@ -130,6 +175,23 @@ def load(file):
     ----------
     file : str
         The filename.
+    mmap : bool, default False
+        Whether to map the file in memory instead of reading it. The dense arrays saved by
+        ``save`` are then copy-on-write views of the file, whose memory the processes loading it
+        share until they write to the arrays. Sparse arrays and files of the legacy format are
+        read.
+    ctx : Context, optional
+        The device to load the arrays to, by default the CPU. The file is then mapped, and the
+        dense arrays are copied to a GPU in chunks through pinned staging buffers, overlapping the
+        reads of the file with the copies to the GPU. See ``MXNET_LOAD_STAGING_BYTES`` and
+        ``MXNET_LOAD_STAGING_BUFFERS``.
+    lazy : bool, default False
+        Whether to defer loading the dense arrays to a GPU `ctx` until they are first used. The file
+        is then mapped, and the GPU memory of an array is only allocated and copied from the file
+        when an operator uses it. Until they are written, the arrays are spilled under memory
+        pressure by freeing their memory, see ``MXNET_GPU_SPILL_BUDGET``, and copied from the file
+        again when they are used next, e.g. for the experts of a sparsely gated model. The arrays
+        loaded lazily to the CPU are those of ``mmap=True``.
 
     Returns
     -------
@@ -151,11 +213,30 @@ def load(file):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(file),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    if lazy:
+        ctx = current_context() if ctx is None else ctx
+        check_call(_LIB.MXNDArrayLoadLazy(c_str(file),
+                                          ctypes.c_int(ctx.device_typeid),
+                                          ctypes.c_int(ctx.device_id),
+                                          ctypes.byref(out_size),
+                                          ctypes.byref(handles),
+                                          ctypes.byref(out_name_size),
+                                          ctypes.byref(names)))
+    elif ctx is not None:
+        check_call(_LIB.MXNDArrayLoadToContext(c_str(file),
+                                               ctypes.c_int(ctx.device_typeid),
+                                               ctypes.c_int(ctx.device_id),
+                                               ctypes.byref(out_size),
+                                               ctypes.byref(handles),
+                                               ctypes.byref(out_name_size),
+                                               ctypes.byref(names)))
+    else:
+        load_fn = _LIB.MXNDArrayLoadMMap if mmap else _LIB.MXNDArrayLoad
+        check_call(load_fn(c_str(file),
+                           ctypes.byref(out_size),
+                           ctypes.byref(handles),
+                           ctypes.byref(out_name_size),
+                           ctypes.byref(names)))
     if out_name_size.value == 0:
         if out_size.value != 1:
             return [ndarray(NDArrayHandle(handles[i])) for i in range(out_size.value)]
@@ -171,7 +252,7 @@ from_dlpack_doc = """Returns a np.ndarray backed by a dlpack tensor.
 
     Parameters
     ----------
-    dlpack: PyCapsule (the pointer of DLManagedTensor)
+    dlpack: PyCapsule (the pointer of DLManagedTensor), or an object with ``__dlpack__``
         input data
 
     Returns
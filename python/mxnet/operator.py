@@ -468,6 +468,30 @@ class CustomOp(object):
         # pylint: disable=W0613
         pass
 
+    def forward_async(self, is_train, req, in_data, out_data, aux, on_complete):
+        """Asynchronous forward interface. Can override instead of forward to start the
+        operator and return before it is done, so that the operator does not tie up a thread
+        while it waits, e.g. for another thread or a library releasing the GIL.
+
+        Parameters
+        ----------
+        is_train, req, in_data, out_data, aux
+            see forward
+        on_complete : function
+            to call once, from any thread, when out_data and aux are written: on_complete()
+            if the operator succeeded, on_complete(message) with the message of its error
+            otherwise
+        """
+        self.forward(is_train, req, in_data, out_data, aux)
+        on_complete()
+
+    def backward_async(self, req, out_grad, in_data, out_data, in_grad, aux, on_complete):
+        """Asynchronous backward interface. Can override instead of backward, see
+        forward_async.
+        """
+        self.backward(req, out_grad, in_data, out_data, in_grad, aux)
+        on_complete()
+
     def assign(self, dst, req, src):
         """Helper function for assigning into dst depending on requirements."""
         if req == 'null':
@@ -484,6 +508,26 @@ class CustomOp(object):
                 dst[:] += src
 
 
+class _AsyncCompletion(object):
+    """The completion of an async forward or backward of a CustomOp, called at most once."""
+    def __init__(self, handle):
+        self._handle = handle
+        self._lock = Lock()
+        self._done = False
+
+    def _claim(self):
+        """Returns whether the completion was not claimed before, and claims it."""
+        with self._lock:
+            done, self._done = self._done, True
+        return not done
+
+    def __call__(self, error=None):
+        if not self._claim():
+            raise RuntimeError('A CustomOp can only complete once')
+        check_call(_LIB.MXCustomOpComplete(c_void_p(self._handle),
+                                           c_str(error) if error is not None else None))
+
+
 class CustomOpProp(object):
     """Base class for operator property class implemented in python.
 
@@ -713,6 +757,8 @@ def register(reg_name):
         """Register a subclass of CustomOpProp to the registry."""
         fb_functype = CFUNCTYPE(c_int, c_int, POINTER(c_void_p), POINTER(c_int),
                                 POINTER(c_int), c_int, c_void_p)
+        fb_async_functype = CFUNCTYPE(c_int, c_int, POINTER(c_void_p), POINTER(c_int),
+                                      POINTER(c_int), c_int, c_void_p, c_void_p)
         del_functype = CFUNCTYPE(c_int, c_void_p)
 
         infershape_functype = CFUNCTYPE(c_int, c_int, POINTER(c_int),
@@ -991,24 +1037,57 @@ def register(reg_name):
                     dtypes = [dtypes[i] for i in range(num_inputs)]
                     op = op_prop.create_operator(ctx, shapes, dtypes)
 
+                    def forward_tensors(num_ndarray, ndarraies, tags, reqs):
+                        """The in_data, out_data, aux and req of CustomOp::Forward"""
+                        tensors = [[] for i in range(5)]
+                        for i in range(num_ndarray):
+                            if tags[i] == 1 or tags[i] == 4:
+                                tensors[tags[i]].append(
+                                    create_ndarray_fn(cast(ndarraies[i], NDArrayHandle), writable=True)
+                                )
+                            else:
+                                tensors[tags[i]].append(
+                                    create_ndarray_fn(cast(ndarraies[i], NDArrayHandle), writable=False)
+                                )
+                        reqs = [req_enum[reqs[i]] for i in range(len(tensors[1]))]
+                        return dict(req=reqs, in_data=tensors[0], out_data=tensors[1], aux=tensors[4])
+
+                    def backward_tensors(num_ndarray, ndarraies, tags, reqs):
+                        """The req, in_data, out_data, in_grad, out_grad and aux of CustomOp::Backward"""
+                        tensors = [[] for i in range(5)]
+                        num_outputs = len(op_prop.list_outputs())
+                        num_args = len(op_prop.list_arguments())
+                        for i in range(num_ndarray):
+                            if i in _registry.result_deps or i >= (num_outputs * 2 + num_args):
+                                # If it is a backward dependency or output or aux:
+                                # Set stype as undefined so that it returns
+                                # ndarray based on existing stype
+                                stype = _STORAGE_TYPE_UNDEFINED
+                            else:
+                                # If it is some input, output or out grad ndarray not part of
+                                # backward dependency it is empty and thus the ndarray should
+                                # be set to default
+                                stype = _STORAGE_TYPE_DEFAULT
+                            if tags[i] == 2 or tags[i] == 4:
+                                tensors[tags[i]].append(
+                                    create_ndarray_fn(cast(ndarraies[i], NDArrayHandle),
+                                                      writable=True, stype=stype)
+                                )
+                            else:
+                                tensors[tags[i]].append(
+                                    create_ndarray_fn(cast(ndarraies[i], NDArrayHandle),
+                                                      writable=False, stype=stype)
+                                )
+                        reqs = [req_enum[reqs[i]] for i in range(len(tensors[2]))]
+                        return dict(req=reqs, in_data=tensors[0], out_data=tensors[1],
+                                    in_grad=tensors[2], out_grad=tensors[3], aux=tensors[4])
+
                     def forward_entry(num_ndarray, ndarraies, tags, reqs, is_train, _):
                         """C Callback for CustomOp::Forward"""
                         try:
-                            tensors = [[] for i in range(5)]
-                            for i in range(num_ndarray):
-                                if tags[i] == 1 or tags[i] == 4:
-                                    tensors[tags[i]].append(
-                                        create_ndarray_fn(cast(ndarraies[i], NDArrayHandle), writable=True)
-                                    )
-                                else:
-                                    tensors[tags[i]].append(
-                                        create_ndarray_fn(cast(ndarraies[i], NDArrayHandle), writable=False)
-                                    )
-                            reqs = [req_enum[reqs[i]] for i in range(len(tensors[1]))]
+                            tensors = forward_tensors(num_ndarray, ndarraies, tags, reqs)
                             with ctx:
-                                op.forward(is_train=is_train, req=reqs,
-                                           in_data=tensors[0], out_data=tensors[1],
-                                           aux=tensors[4])
+                                op.forward(is_train=is_train, **tensors)
                         except Exception:
                             print('Error in CustomOp.forward: %s' % traceback.format_exc())
                             return False
@@ -1018,41 +1097,40 @@ def register(reg_name):
                         """C Callback for CustomOp::Backward"""
                         # pylint: disable=W0613
                         try:
-                            tensors = [[] for i in range(5)]
-                            num_outputs = len(op_prop.list_outputs())
-                            num_args = len(op_prop.list_arguments())
-                            for i in range(num_ndarray):
-                                if i in _registry.result_deps or i >= (num_outputs * 2 + num_args):
-                                    # If it is a backward dependency or output or aux:
-                                    # Set stype as undefined so that it returns
-                                    # ndarray based on existing stype
-                                    stype = _STORAGE_TYPE_UNDEFINED
-                                else:
-                                    # If it is some input, output or out grad ndarray not part of
-                                    # backward dependency it is empty and thus the ndarray should
-                                    # be set to default
-                                    stype = _STORAGE_TYPE_DEFAULT
-                                if tags[i] == 2 or tags[i] == 4:
-                                    tensors[tags[i]].append(
-                                        create_ndarray_fn(cast(ndarraies[i], NDArrayHandle),
-                                                          writable=True, stype=stype)
-                                    )
-                                else:
-                                    tensors[tags[i]].append(
-                                        create_ndarray_fn(cast(ndarraies[i], NDArrayHandle),
-                                                          writable=False, stype=stype)
-                                    )
-                            reqs = [req_enum[reqs[i]] for i in range(len(tensors[2]))]
+                            tensors = backward_tensors(num_ndarray, ndarraies, tags, reqs)
                             with ctx:
-                                op.backward(req=reqs,
-                                            in_data=tensors[0], out_data=tensors[1],
-                                            in_grad=tensors[2], out_grad=tensors[3],
-                                            aux=tensors[4])
+                                op.backward(**tensors)
                         except Exception:
                             print('Error in CustomOp.backward: %s' % traceback.format_exc())
                             return False
                         return True
 
+                    def forward_async_entry(num_ndarray, ndarraies, tags, reqs, is_train, on_complete, _):
+                        """C Callback for the async CustomOp::Forward"""
+                        completion = _AsyncCompletion(on_complete)
+                        try:
+                            tensors = forward_tensors(num_ndarray, ndarraies, tags, reqs)
+                            with ctx:
+                                op.forward_async(is_train=is_train, on_complete=completion, **tensors)
+                        except Exception:
+                            print('Error in CustomOp.forward_async: %s' % traceback.format_exc())
+                            # the failure of an op that has not completed is returned
+                            return not completion._claim()
+                        return True
+
+                    def backward_async_entry(num_ndarray, ndarraies, tags, reqs, is_train, on_complete, _):
+                        """C Callback for the async CustomOp::Backward"""
+                        # pylint: disable=W0613
+                        completion = _AsyncCompletion(on_complete)
+                        try:
+                            tensors = backward_tensors(num_ndarray, ndarraies, tags, reqs)
+                            with ctx:
+                                op.backward_async(on_complete=completion, **tensors)
+                        except Exception:
+                            print('Error in CustomOp.backward_async: %s' % traceback.format_exc())
+                            return not completion._claim()
+                        return True
+
                     cur = _registry.inc()
 
                     def delete_entry(_):
@@ -1067,8 +1145,14 @@ def register(reg_name):
                     callbacks = [del_functype(delete_entry),
                                  fb_functype(forward_entry),
                                  fb_functype(backward_entry)]
+                    # the ops overriding forward_async or backward_async run them instead
+                    async_forward = type(op).forward_async is not CustomOp.forward_async
+                    async_backward = type(op).backward_async is not CustomOp.backward_async
+                    if async_forward or async_backward:
+                        callbacks += [fb_async_functype(forward_async_entry if async_forward else 0),
+                                      fb_async_functype(backward_async_entry if async_backward else 0)]
                     callbacks = [cast(i, CFUNCTYPE(c_int)) for i in callbacks]
-                    contexts = [None, None, None]
+                    contexts = [None] * len(callbacks)
                     ret[0] = MXCallbackList(c_int(len(callbacks)),
                                             cast(c_array(CFUNCTYPE(c_int), callbacks),
                                                  POINTER(CFUNCTYPE(c_int))),
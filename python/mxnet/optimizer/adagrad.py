@@ -20,6 +20,7 @@ from __future__ import absolute_import
 from ..ndarray import (zeros, clip, sqrt, square)
 from ..ndarray import sparse
 from .optimizer import Optimizer, register
+from .utils import _flatten_list
 
 __all__ = ['AdaGrad']
 
@@ -58,6 +59,8 @@ class AdaGrad(Optimizer):
         Whether or not to use fused kernels for optimizer.
         When use_fused_step=False or grad is not sparse, step is called,
         otherwise, fused_step is called.
+        With ``aggregate_num`` > 1, the weights with row_sparse gradients, e.g. all the
+        embedding tables of a model, are updated in a single kernel.
 
     """
     def __init__(self, learning_rate=0.01, epsilon=1e-6, use_fused_step=True, **kwargs):
@@ -124,6 +127,17 @@ class AdaGrad(Optimizer):
         states : List of any obj
             List of state returned by `create_state()`.
         """
+        if len(indices) > 1 and all(g.stype == 'row_sparse' for g in grads):
+            # the updates of the row_sparse gradients are aggregated in a single kernel
+            self._update_count(indices)
+            kwargs = {'epsilon': self.epsilon, 'rescale_grad': self.rescale_grad}
+            if self.clip_gradient:
+                kwargs['clip_gradient'] = self.clip_gradient
+            sparse.multi_adagrad_update(*_flatten_list(zip(weights, grads, states)), out=weights,
+                                        num_weights=len(weights), lrs=self._get_lrs(indices),
+                                        wds=self._get_wds(indices), **kwargs)
+            return
+
         for index, weight, grad, state in zip(indices, weights, grads, states):
             is_sparse = grad.stype == 'row_sparse'
 
@@ -19,8 +19,9 @@
 from __future__ import absolute_import
 import math
 from ..ndarray import (zeros, clip, sqrt, square)
-from ..ndarray import adam_update
+from ..ndarray import adam_update, multi_adam_update, multi_lazy_adam_update
 from .optimizer import Optimizer, register
+from .utils import _flatten_list, _can_aggregate
 
 __all__ = ['Adam']
 
@@ -81,6 +82,8 @@ class Adam(Optimizer):
         Whether or not to use fused kernels for optimizer.
         When use_fused_step=False, step is called,
         otherwise, fused_step is called.
+        With ``lazy_update`` and ``aggregate_num`` > 1, the weights with row_sparse
+        gradients, e.g. all the embedding tables of a model, are updated in a single kernel.
     """
     def __init__(self, learning_rate=0.001, beta1=0.9, beta2=0.999, epsilon=1e-8,
                  lazy_update=False, use_fused_step=True, **kwargs):
@@ -163,6 +166,26 @@ class Adam(Optimizer):
         states : List of any obj
             List of state returned by `create_state()`.
         """
+        kwargs = {'beta1': self.beta1, 'beta2': self.beta2, 'epsilon': self.epsilon,
+                  'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        # the dense updates, and the lazy updates of the row_sparse gradients, of several weights
+        # are aggregated in a few kernels
+        lazy = self.lazy_update and len(indices) > 1 and all(g.stype == 'row_sparse' for g in grads)
+        if lazy or _can_aggregate(weights, grads):
+            self._update_count(indices)
+            lrs = []
+            for index, lr in zip(indices, self._get_lrs(indices)):
+                t = self._index_update_count[index]
+                lrs.append(lr * math.sqrt(1. - self.beta2**t) / (1. - self.beta1**t))
+            multi_update = multi_lazy_adam_update if lazy else multi_adam_update
+            multi_update(*_flatten_list((w, g, m, v) for w, g, (m, v) in zip(weights, grads, states)),
+                         out=weights, num_weights=len(weights), lrs=lrs,
+                         wds=self._get_wds(indices), **kwargs)
+            return
+
         for index, weight, grad, state in zip(indices, weights, grads, states):
             self._update_count(index)
             lr = self._get_lr(index)
@@ -174,11 +197,6 @@ class Adam(Optimizer):
 
             lr *= math.sqrt(coef2)/coef1
 
-            kwargs = {'beta1': self.beta1, 'beta2': self.beta2, 'epsilon': self.epsilon,
-                      'rescale_grad': self.rescale_grad}
-            if self.clip_gradient:
-                kwargs['clip_gradient'] = self.clip_gradient
-
             mean, var = state
 
             # update weight with fused kernel
@@ -20,7 +20,10 @@ from __future__ import absolute_import
 import numpy
 from ..ndarray import (zeros, clip)
 from ..ndarray import (sgd_update, mp_sgd_update, nag_mom_update, mp_nag_mom_update)
+from ..ndarray import (multi_sgd_update, multi_mp_sgd_update, multi_nag_mom_update,
+                       multi_mp_nag_mom_update)
 from .optimizer import Optimizer, register
+from .utils import _flatten_list, _can_aggregate
 
 __all__ = ['NAG']
 
@@ -125,17 +128,35 @@ class NAG(Optimizer):
         states : List of any obj
             List of state returned by `create_state()`.
         """
+        kwargs = {'rescale_grad': self.rescale_grad}
+        if self.momentum > 0:
+            kwargs['momentum'] = self.momentum
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        # the updates of several weights are aggregated in a few kernels
+        if _can_aggregate(weights, grads):
+            self._update_count(indices)
+            kwargs.update(num_weights=len(weights), lrs=self._get_lrs(indices), wds=self._get_wds(indices))
+            if not (self.multi_precision and weights[0].dtype == numpy.float16):
+                if self.momentum > 0:
+                    multi_nag_mom_update(*_flatten_list(zip(weights, grads, states)), out=weights, **kwargs)
+                else:
+                    multi_sgd_update(*_flatten_list(zip(weights, grads)), out=weights, **kwargs)
+            else:
+                weights32, moms = zip(*states)
+                if self.momentum > 0:
+                    multi_mp_nag_mom_update(*_flatten_list(zip(weights, grads, moms, weights32)),
+                                            out=weights, **kwargs)
+                else:
+                    multi_mp_sgd_update(*_flatten_list(zip(weights, grads, weights32)), out=weights, **kwargs)
+            return
+
         for index, weight, grad, state in zip(indices, weights, grads, states):
             self._update_count(index)
             lr = self._get_lr(index)
             wd = self._get_wd(index)
 
-            kwargs = {'rescale_grad': self.rescale_grad}
-            if self.momentum > 0:
-                kwargs['momentum'] = self.momentum
-            if self.clip_gradient:
-                kwargs['clip_gradient'] = self.clip_gradient
-
             multi_precision = self.multi_precision and weight.dtype == numpy.float16
 
             if not multi_precision:
@@ -17,8 +17,9 @@
 """RMSProp optimizer."""
 from __future__ import absolute_import
 from ..ndarray import (zeros, clip, sqrt, square)
-from ..ndarray import (rmsprop_update, rmspropalex_update)
+from ..ndarray import (rmsprop_update, rmspropalex_update, multi_rmsprop_update)
 from .optimizer import Optimizer, register
+from .utils import _flatten_list, _can_aggregate
 
 __all__ = ['RMSProp']
 
@@ -163,20 +164,28 @@ class RMSProp(Optimizer):
         states : List of any obj
             List of state returned by `create_state()`.
         """
+        kwargs = {'rho': self.rho, 'epsilon': self.epsilon,
+                  'rescale_grad': self.rescale_grad}
+        if self.centered:
+            kwargs['momentum'] = self.momentum
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+        if self.clip_weights:
+            kwargs['clip_weights'] = self.clip_weights
+
+        # the updates of several weights are aggregated in a few kernels
+        if not self.centered and _can_aggregate(weights, grads):
+            self._update_count(indices)
+            multi_rmsprop_update(*_flatten_list(zip(weights, grads, states)), out=weights,
+                                 num_weights=len(weights), lrs=self._get_lrs(indices),
+                                 wds=self._get_wds(indices), **kwargs)
+            return
+
         for index, weight, grad, state in zip(indices, weights, grads, states):
             self._update_count(index)
             lr = self._get_lr(index)
             wd = self._get_wd(index)
 
-            kwargs = {'rho': self.rho, 'epsilon': self.epsilon,
-                      'rescale_grad': self.rescale_grad}
-            if self.centered:
-                kwargs['momentum'] = self.momentum
-            if self.clip_gradient:
-                kwargs['clip_gradient'] = self.clip_gradient
-            if self.clip_weights:
-                kwargs['clip_weights'] = self.clip_weights
-
             # update weight with fused kernel
             if not self.centered:
                 var = state
@@ -18,11 +18,13 @@
 """SGD optimizer"""
 from __future__ import absolute_import
 import numpy
-from ..ndarray import (zeros, clip)
+from ..ndarray import (zeros, clip, array)
 from ..ndarray import (sgd_update, sgd_mom_update,
                        mp_sgd_update, mp_sgd_mom_update,
                        multi_sgd_update, multi_sgd_mom_update,
-                       multi_mp_sgd_update, multi_mp_sgd_mom_update)
+                       multi_mp_sgd_update, multi_mp_sgd_mom_update,
+                       preloaded_multi_sgd_update, preloaded_multi_sgd_mom_update,
+                       preloaded_multi_mp_sgd_update, preloaded_multi_mp_sgd_mom_update)
 from .optimizer import Optimizer, register
 from .utils import _flatten_list
 
@@ -186,7 +188,11 @@ class SGD(Optimizer):
         if self.clip_gradient:
             kwargs['clip_gradient'] = self.clip_gradient
 
-        if aggregate:
+        loss_scaler = getattr(self, '_amp_loss_scaler', None)
+        if loss_scaler is not None and loss_scaler.on_device:
+            self._amp_fused_step(weights, grads, states, lrs, wds,
+                                 loss_scaler.device_state(weights[0].context), kwargs)
+        elif aggregate:
             # update `aggregate_num` number of weights in a single kernel.
             # this does not support sparse weight or gradient.
             multi_precision = self.multi_precision and weights[0].dtype == numpy.float16
@@ -233,6 +239,39 @@ class SGD(Optimizer):
                         mp_sgd_update(weight, grad, weight32, out=weight,
                                       lr=lr, wd=wd, **kwargs)
 
+    def _amp_fused_step(self, weights, grads, states, lrs, wds, amp_state, kwargs):
+        """Update the weights with the kernels reading the AMP state of the device: they skip
+        the step unless its gradients are finite, and divide the gradients by its loss scale."""
+        for weight, grad in zip(weights, grads):
+            assert weight.stype == 'default' and grad.stype == 'default', \
+                'AMP with device_loss_scale does not support sparse weights or gradients'
+        ctx = weights[0].context
+        multi_precision = self.multi_precision and weights[0].dtype == numpy.float16
+        # at most 60 weights per kernel
+        for begin in range(0, len(weights), 60):
+            end = begin + 60
+            chunk = list(zip(weights[begin:end], grads[begin:end]))
+            out = list(weights[begin:end])
+            preloaded = [array(lrs[begin:end], ctx=ctx, dtype='float32'),
+                         array(wds[begin:end], ctx=ctx, dtype='float32'), amp_state]
+            kw = dict(kwargs, num_weights=len(out), with_amp_state=True, out=out)
+            if multi_precision:
+                weights32, moms = zip(*states[begin:end])
+                if self.momentum > 0:
+                    preloaded_multi_mp_sgd_mom_update(
+                        *_flatten_list((w, g, m, w32) for (w, g), m, w32 in zip(chunk, moms, weights32)),
+                        *preloaded, **kw)
+                else:
+                    preloaded_multi_mp_sgd_update(
+                        *_flatten_list((w, g, w32) for (w, g), w32 in zip(chunk, weights32)),
+                        *preloaded, **kw)
+            elif self.momentum > 0:
+                preloaded_multi_sgd_mom_update(
+                    *_flatten_list((w, g, m) for (w, g), m in zip(chunk, states[begin:end])),
+                    *preloaded, **kw)
+            else:
+                preloaded_multi_sgd_update(*_flatten_list(chunk), *preloaded, **kw)
+
     def update_multi_precision(self, indices, weights, grads, states):
         """Override update_multi_precision.
         """
@@ -23,6 +23,13 @@ def _flatten_list(nested_list):
     return [item for sublist in nested_list for item in sublist]
 
 
+def _can_aggregate(weights, grads):
+    """Whether the multi tensor kernels update the weights together, i.e. there are several weights
+    and they are all dense, with dense gradients, of the dtype of the first weight."""
+    return len(weights) > 1 and all(w.stype == 'default' and g.stype == 'default' and
+                                    w.dtype == weights[0].dtype for w, g in zip(weights, grads))
+
+
 def _as_classic(a, allow_np):
     # TODO(junwu): This is a temp solution for allowing converting
     # np.ndarray to mx.nd.NDArray to be fed into the optimizer since
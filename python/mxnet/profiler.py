@@ -22,6 +22,8 @@
 import ctypes
 import contextlib
 import contextvars
+import json
+import threading
 import warnings
 from .base import _LIB, check_call, c_str, ProfileHandle, c_str_array, py_str, KVStoreHandle
 
@@ -193,6 +195,146 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
     return py_str(debug_str.value)
 
 
+def set_sample_rate(sample_rate):
+    """Sample the latency of one in `sample_rate` operator executions, whether the profiler
+    is running or not. The overhead is low enough to leave the sampling on in production.
+
+    Parameters
+    ----------
+    sample_rate : int
+        every how many operator executions one is sampled, 0 to disable the sampling.
+        The default is the value of MXNET_PROFILER_SAMPLE_RATE, 0 if it is not set.
+    """
+    check_call(_LIB.MXProfileSetSampleRate(int(sample_rate)))
+
+
+def scrape_sampled(reset=False):
+    """Return the rolling latency percentiles of the sampled operator executions.
+
+    The percentiles are computed over the last 1024 sampled executions of each operator. The
+    sampled executions are also added to the aggregate stats, under `operator (sampled)`.
+
+    Parameters
+    ----------
+    reset : boolean
+        whether to clear the sampled latencies after scraping them
+
+    Returns
+    -------
+    dict
+        the `Count`, `P50`, `P90`, `P99` and `Max` latencies in microseconds, by operator
+        under `Operators`, and the number of samples `Dropped` because they were not scraped
+        often enough.
+    """
+    out_str = ctypes.c_char_p()
+    check_call(_LIB.MXProfileScrapeSampledStats(ctypes.byref(out_str), int(reset)))
+    return json.loads(py_str(out_str.value))
+
+
+def set_request_trace_config(threshold_ms=100, filename='mxnet_traces.json'):
+    """Set from which latency and where the requests traced with `trace_request` are exported.
+
+    Parameters
+    ----------
+    threshold_ms : float
+        latency in milliseconds from which a traced request is exported, 0 to export them all.
+        The default is the value of MXNET_REQUEST_TRACE_THRESHOLD_MS, 100 if it is not set.
+    filename : str
+        file the spans are appended to, one request per line of OTLP/JSON. The default is the
+        value of MXNET_REQUEST_TRACE_FILE, `mxnet_traces.json` if it is not set.
+    """
+    check_call(_LIB.MXRequestTraceSetConfig(ctypes.c_double(threshold_ms), c_str(filename)))
+
+
+@contextlib.contextmanager
+def trace_request(traceparent=None):
+    """Trace a request, such as the calls of a hybridized block, whether the profiler is running
+    or not.
+
+    The engine operators pushed by the thread in the scope, and the operators they push, are
+    tagged with the trace. When the scope has ended and the operators have completed, a request
+    slower than the threshold of `set_request_trace_config` is appended to its file as
+    OpenTelemetry spans: a `request` span, a span by operator with its `mxnet.wait_us` on its
+    dependencies, `mxnet.queue_us` in the queue of a worker and `mxnet.run_us`, and their
+    `queue` and `run` children. This tells whether the tail latency comes from the queues of
+    the engine or from the operators themselves.
+
+    Parameters
+    ----------
+    traceparent : str, optional
+        the W3C traceparent of the caller, whose trace the spans join, otherwise a new trace
+
+    Yields
+    ------
+    str
+        the 32 hex digits of the trace id
+    """
+    trace_id = ctypes.c_char_p()
+    check_call(_LIB.MXRequestTraceBegin(c_str(traceparent) if traceparent else None,
+                                        ctypes.byref(trace_id)))
+    try:
+        yield py_str(trace_id.value)
+    finally:
+        check_call(_LIB.MXRequestTraceEnd())
+
+
+def metrics():
+    """Return the metrics of the engine, the memory pools, the kvstore and the operators in
+    the OpenMetrics text format, which is scraped by Prometheus.
+
+    The operator metrics are only recorded while the profiler runs with `aggregate_stats`
+    set. The kvstore latency is the time to issue the calls, which are asynchronous.
+
+    Returns
+    -------
+    str
+        the metric families, terminated by `# EOF`.
+    """
+    out_str = ctypes.c_char_p()
+    check_call(_LIB.MXGetOpenMetrics(ctypes.byref(out_str)))
+    return py_str(out_str.value)
+
+
+def start_metrics_server(port, addr=''):
+    """Serve the `metrics` at `http://addr:port/metrics` from a daemon thread.
+
+    Parameters
+    ----------
+    port : int
+        the port to listen on, 0 to pick a free port
+    addr : str
+        the address to listen on, all the interfaces by default
+
+    Returns
+    -------
+    http.server.HTTPServer
+        the server, whose `server_address` holds the port and which is stopped by `shutdown`.
+    """
+    from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+    class _MetricsHandler(BaseHTTPRequestHandler):
+        def do_GET(self):  # pylint: disable=invalid-name
+            if self.path.split('?')[0] != '/metrics':
+                self.send_error(404)
+                return
+            body = metrics().encode('utf-8')
+            self.send_response(200)
+            self.send_header('Content-Type',
+                             'application/openmetrics-text; version=1.0.0; charset=utf-8')
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):  # pylint: disable=redefined-builtin
+            pass
+
+    server = ThreadingHTTPServer((addr, port), _MetricsHandler)
+    server.daemon_threads = True
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    return server
+
+
 def pause(profile_process='worker'):
     """Pause profiling.
 
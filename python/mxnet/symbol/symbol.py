@@ -1486,8 +1486,11 @@ class Symbol(SymbolBase):
 
         Parameters
         ----------
-        backend : str
-            The name of backend, as registered in ``SubgraphBackendRegistry``
+        backend : str or list of str
+            The name of backend, as registered in ``SubgraphBackendRegistry``. Given several
+            backends, as a list or separated by commas, each operator goes to the backend whose
+            subgraph saves the most estimated latency, see the ``cost_speedup_<backend>`` and
+            ``cost_transfer`` options in ``kwargs``.
         args : dict of str to NDArray, optional
             Input arguments to the symbol, required to infer shapes/types before partitioning
             If type is a dict of str to NDArray, then it maps the names of arguments
@@ -1511,7 +1514,11 @@ class Symbol(SymbolBase):
         skip_infer : bool, optional
             If True, the optimization skips the shape, type and storage type inference pass.
         kwargs : optional arguments
-            Passed on to ``PrePartition`` and ``PostPartition`` functions of ``SubgraphProperty``
+            Passed on to ``PrePartition`` and ``PostPartition`` functions of ``SubgraphProperty``.
+            With several backends, ``cost_speedup_<backend>`` overrides the estimated speedup of a
+            backend over the default operators, 2 unless the backend sets a ``cost_speedup``, and
+            ``cost_transfer`` the cost of a byte copied to or from a backend of another device, in
+            multiply-accumulates, 100 by default. These are not passed on.
 
         Returns
         -------
@@ -1519,6 +1526,8 @@ class Symbol(SymbolBase):
             A symbol with the partitioned graph for target backend.
         """
         out = SymbolHandle()
+        if isinstance(backend, (list, tuple)):
+            backend = ','.join(backend)
         assert isinstance(backend, str)
         assert isinstance(args, dict) or args is None
         assert isinstance(aux, dict) or aux is None
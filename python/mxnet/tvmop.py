@@ -41,3 +41,42 @@ if Features().is_enabled("TVM_OP"):
         with open(_CONF_TVM_OP[0], "r") as f:
             ret = ConfigSpaces.from_json_dict(json.load(f))
         _set_tvm_op_config(ret)
+
+    def _tuning_log_applies(log):
+        """Whether the tuning log was tuned on the architecture of the devices of this machine"""
+        import platform
+        if log["device"] == "cpu":
+            return log["arch"] == platform.machine()
+        from .context import num_gpus, gpu
+        from .util import get_cuda_compute_capability
+        return num_gpus() > 0 and log["arch"] == "sm_%d" % get_cuda_compute_capability(gpu(0))
+
+    def _load_tvm_op_tuning():
+        """Loads the schedules tuned by contrib/tvmop/tune.py, from the logs in
+        MXNET_TVM_OP_TUNING_LOG or the one shipped with the TVM operator library."""
+        import os
+        import numpy as np
+        from .base import c_str_array
+        from .ndarray.ndarray import _DTYPE_NP_TO_MX
+        paths = os.environ.get("MXNET_TVM_OP_TUNING_LOG")
+        paths = paths.split(os.pathsep) if paths else \
+            [os.path.join(os.path.dirname(_LIB_TVM_OP[0]), "tvmop_tuning.conf")]
+        keys, schedules = [], []
+        for path in paths:
+            if not os.path.isfile(path):
+                continue
+            with open(path, "r") as f:
+                log = json.load(f)
+            if not _tuning_log_applies(log):
+                logging.info("TVM op tuning log %s is for %s %s, skipping it", path, log["device"], log["arch"])
+                continue
+            for record in log["records"]:
+                args = ";".join(",".join(str(d) for d in shape) for shape in record["args"])
+                dtype = _DTYPE_NP_TO_MX[np.dtype(record["dtype"]).type]
+                keys.append("%s:%s:%d:%s" % (record["op"], log["device"], dtype, args))
+                schedules.append(record["schedule"])
+        if keys:
+            check_call(_LIB.MXLoadTVMOpTuning(len(keys), c_str_array(keys), c_str_array(schedules)))
+            logging.info("%d tuned TVM op schedules have been loaded", len(keys))
+
+    _load_tvm_op_tuning()
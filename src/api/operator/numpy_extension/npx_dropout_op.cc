@@ -68,6 +68,8 @@ MXNET_REGISTER_API("_npx.dropout")
       } else {
         param.cudnn_off = args[4].operator bool();
       }
+      // packed_mask
+      param.packed_mask = args[5].type_code() != kNull && args[5].operator bool();
       attrs.parsed = param;
       attrs.op     = op;
       SetAttrDict<op::DropoutParam>(&attrs);
@@ -54,13 +54,13 @@ MXNET_REGISTER_API("_npx.rnn").set_body([](runtime::MXNetArgs args, runtime::MXN
   int num_inputs = 0;
 
   // mode
-  param.mode = String2ComputeMode(args[args_size - 7].operator std::string());
+  param.mode = String2ComputeMode(args[args_size - 8].operator std::string());
   num_inputs = (param.mode == op::rnn_enum::kLstm) ? 4 : 3;
   // use_sequence_length
-  if (args[args_size - 5].type_code() == kNull) {
+  if (args[args_size - 6].type_code() == kNull) {
     param.use_sequence_length = false;
   } else {
-    param.use_sequence_length = args[args_size - 5].operator bool();
+    param.use_sequence_length = args[args_size - 6].operator bool();
   }
   if (param.use_sequence_length)
     num_inputs += 1;
@@ -71,50 +71,56 @@ MXNET_REGISTER_API("_npx.rnn").set_body([](runtime::MXNetArgs args, runtime::MXN
     inputs.push_back(args[i].operator mxnet::NDArray*());
   }
   // state_size
-  param.state_size = (uint32_t)(args[args_size - 11].operator int());
+  param.state_size = (uint32_t)(args[args_size - 12].operator int());
   // num_layers
-  param.num_layers = (uint32_t)(args[args_size - 10].operator int());
+  param.num_layers = (uint32_t)(args[args_size - 11].operator int());
   // bidirectional
-  if (args[args_size - 9].type_code() == kNull) {
+  if (args[args_size - 10].type_code() == kNull) {
     param.bidirectional = false;
   } else {
-    param.bidirectional = args[args_size - 9].operator bool();
+    param.bidirectional = args[args_size - 10].operator bool();
   }
   // state_outputs
-  if (args[args_size - 8].type_code() == kNull) {
+  if (args[args_size - 9].type_code() == kNull) {
     param.state_outputs = false;
   } else {
-    param.state_outputs = args[args_size - 8].operator bool();
+    param.state_outputs = args[args_size - 9].operator bool();
   }
   // p
-  if (args[args_size - 6].type_code() == kNull) {
+  if (args[args_size - 7].type_code() == kNull) {
     param.p = 0.0;
   } else {
-    param.p = args[args_size - 6].operator double();
+    param.p = args[args_size - 7].operator double();
   }
   // projection_size
-  if (args[args_size - 4].type_code() == kNull) {
+  if (args[args_size - 5].type_code() == kNull) {
     param.projection_size = dmlc::nullopt;
   } else {
-    param.projection_size = args[args_size - 4].operator int();
+    param.projection_size = args[args_size - 5].operator int();
   }
   // lstm_state_clip_min
-  if (args[args_size - 3].type_code() == kNull) {
+  if (args[args_size - 4].type_code() == kNull) {
     param.lstm_state_clip_min = dmlc::nullopt;
   } else {
-    param.lstm_state_clip_min = args[args_size - 3].operator double();
+    param.lstm_state_clip_min = args[args_size - 4].operator double();
   }
   // lstm_state_clip_max
-  if (args[args_size - 2].type_code() == kNull) {
+  if (args[args_size - 3].type_code() == kNull) {
     param.lstm_state_clip_max = dmlc::nullopt;
   } else {
-    param.lstm_state_clip_max = args[args_size - 2].operator double();
+    param.lstm_state_clip_max = args[args_size - 3].operator double();
   }
   // lstm_state_clip_nan
-  if (args[args_size - 1].type_code() == kNull) {
+  if (args[args_size - 2].type_code() == kNull) {
     param.lstm_state_clip_nan = false;
   } else {
-    param.lstm_state_clip_nan = args[args_size - 1].operator bool();
+    param.lstm_state_clip_nan = args[args_size - 2].operator bool();
+  }
+  // use_persistent
+  if (args[args_size - 1].type_code() == kNull) {
+    param.use_persistent = false;
+  } else {
+    param.use_persistent = args[args_size - 1].operator bool();
   }
   // initialize
   param.seq_length_ = 0;
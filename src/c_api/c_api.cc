@@ -21,12 +21,18 @@
  * \file c_api.cc
  * \brief C API of mxnet
  */
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include <string>
 #include <mutex>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <functional>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include "dmlc/base.h"
@@ -53,11 +59,15 @@
 #include "../operator/subgraph/common.h"
 #include "../operator/tensor/matrix_op-inl.h"
 #include "../operator/tvmop/op_module.h"
+#include "../operator/contrib/tvmop/tuned.h"
 #include "../operator/subgraph/partitioner/custom_subgraph_property.h"
 #include "../operator/subgraph/subgraph_property.h"
 #include "../common/utils.h"
 #include "../profiler/profiler.h"
+#include "../profiler/io_profiler.h"
+#include "../profiler/openmetrics.h"
 #include "../serialization/cnpy.h"
+#include "../serialization/pipelined_stream.h"
 #include "miniz.h"
 #include "nnvm/pass_functions.h"
 
@@ -78,7 +88,9 @@
 #endif
 
 #if MXNET_USE_CUDA
+#include <cuda.h>
 #include <cuda_profiler_api.h>
+#include "../common/cuda/utils.h"
 #endif
 #include "../common/cuda/nvtx.h"
 
@@ -234,20 +246,73 @@ void CustomFComputeDispatcher(const std::string op_name,
   CHECK(ctx.requested.size() >= 2)
       << "Custom operator should register at least memory resource and parallel random resource";
   const Resource& resource                = ctx.requested.at(0);
+  const Context& op_ctx                   = ctx.run_ctx.ctx;
   mshadow::Stream<mxnet::cpu>* cpu_stream = ctx.get_stream<mxnet::cpu>();
   mshadow::Stream<mxnet::gpu>* gpu_stream = ctx.get_stream<mxnet::gpu>();
 
-  // create lambda that captures stream & resource objects
-  // this temp workspace holds memory allocated by custom library via OpResource
-  auto cpu_alloc = [&](int size) {
-    mshadow::Tensor<mxnet::cpu, 1, char> workspace =
-        resource.get_space_typed<mxnet::cpu, 1, char>(mshadow::Shape1(size), cpu_stream);
-    return workspace.dptr_;
+  // The memory allocated by the custom library via OpResource is packed into the temp workspace
+  // of the op, sized to the most the op allocated on its device in one call so far. The
+  // allocations which do not fit, or are on the host for a gpu op, get their own memory, which
+  // is freed when the call returns.
+  static std::mutex workspace_mutex;
+  static std::unordered_map<std::string, size_t> workspace_sizes;
+  const std::string workspace_key =
+      op_name + (op_ctx.dev_mask() == Context::kCPU ? "@cpu" : "@gpu");
+  size_t workspace_size;
+  {
+    std::lock_guard<std::mutex> lock(workspace_mutex);
+    workspace_size = workspace_sizes[workspace_key];
+  }
+  char* workspace       = nullptr;
+  size_t workspace_used = 0, workspace_requested = 0;
+  std::vector<Storage::Handle> extra_space;
+  auto alloc = [&](int size, int dev_mask) {
+    CHECK(dev_mask == Context::kCPU || op_ctx.dev_mask() == Context::kGPU)
+        << "Custom operator '" << op_name << "' running on cpu cannot allocate gpu memory";
+    const size_t bytes = (static_cast<size_t>(size) + 255) / 256 * 256;
+    if (dev_mask == op_ctx.dev_mask()) {
+      workspace_requested += bytes;
+      if (workspace == nullptr && workspace_size > 0 && dev_mask == Context::kCPU) {
+        workspace = resource
+                        .get_space_typed<mxnet::cpu, 1, char>(mshadow::Shape1(workspace_size),
+                                                              cpu_stream)
+                        .dptr_;
+      } else if (workspace == nullptr && workspace_size > 0) {
+        workspace = resource
+                        .get_space_typed<mxnet::gpu, 1, char>(mshadow::Shape1(workspace_size),
+                                                              gpu_stream)
+                        .dptr_;
+      }
+      if (workspace_used + bytes <= workspace_size) {
+        void* ptr = workspace + workspace_used;
+        workspace_used += bytes;
+        return ptr;
+      }
+      extra_space.push_back(Storage::Get()->Alloc(bytes, op_ctx));
+    } else {
+      // host memory of a gpu op is pinned, to be copied asynchronously on its stream
+      extra_space.push_back(Storage::Get()->Alloc(bytes, Context::CPUPinned(op_ctx.dev_id)));
+    }
+    return extra_space.back().dptr;
   };
-  auto gpu_alloc = [&](int size) {
-    mshadow::Tensor<mxnet::gpu, 1, char> workspace =
-        resource.get_space_typed<mxnet::gpu, 1, char>(mshadow::Shape1(size), gpu_stream);
-    return workspace.dptr_;
+  auto cpu_alloc = [&](int size) { return alloc(size, Context::kCPU); };
+  auto gpu_alloc = [&](int size) { return alloc(size, Context::kGPU); };
+  // grows the workspace for the next calls and frees the memory which did not fit in it
+  auto release_space = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(workspace_mutex);
+      size_t& size = workspace_sizes[workspace_key];
+      size         = std::max(size, workspace_requested);
+    }
+    if (extra_space.empty())
+      return;
+#if MXNET_USE_CUDA
+    // the kernels of the library may still use the memory
+    if (op_ctx.dev_mask() == Context::kGPU)
+      gpu_stream->Wait();
+#endif
+    for (const Storage::Handle& handle : extra_space)
+      Storage::Get()->Free(handle);
   };
 
   // create lambda that allocates memory for sparse and
@@ -304,12 +369,14 @@ void CustomFComputeDispatcher(const std::string op_name,
   // get actual cudaStream_t out of mxnet gpu stream and pass to lib_api.h
   void* cuda_stream = nullptr;
 #if MXNET_USE_CUDA
-  if ((inputs.size() > 0 && inputs[0].ctx().dev_mask() == Context::kGPU) ||
-      (outputs.size() > 0 && outputs[0].ctx().dev_mask() == Context::kGPU)) {
+  if (op_ctx.dev_mask() == Context::kGPU) {
     cuda_stream = static_cast<void*>(gpu_stream->stream_);
   }
 #endif
 
+  // how the op writes each output, as the memory planner decided
+  std::vector<int> out_reqs(req.begin(), req.end());
+
   // get mxnet initialized and seeded RNG states and pass to lib_api.h
   void *rng_cpu_states = nullptr, *rng_gpu_states = nullptr;
   using mxnet::common::random::RandGenerator;
@@ -371,7 +438,9 @@ void CustomFComputeDispatcher(const std::string op_name,
                            in_indptr_shapes.data(),
                            out_indptr_shapes.data(),
                            rng_cpu_states,
-                           rng_gpu_states);
+                           rng_gpu_states,
+                           out_reqs.data());
+    release_space();
     std::string msgs = getExtensionMsgs(msgSize, msgGet);
     CHECK(retval) << "Error calling FCompute for custom operator '" << op_name << "'" << msgs;
   }
@@ -421,8 +490,10 @@ void CustomFComputeDispatcher(const std::string op_name,
                                    in_indptr_shapes.data(),
                                    out_indptr_shapes.data(),
                                    rng_cpu_states,
-                                   rng_gpu_states);
-    msgs       = getExtensionMsgs(msgSize, msgGet);
+                                   rng_gpu_states,
+                                   out_reqs.data());
+    release_space();
+    msgs = getExtensionMsgs(msgSize, msgGet);
     CHECK(retval) << "Error calling FStatefulCompute for custom operator '" << op_name << "'"
                   << msgs;
   }
@@ -437,6 +508,7 @@ template <typename RescReq,
           typename InferShape,
           typename InferSType,
           typename MutateInputs,
+          typename InplaceOption,
           typename SubgraphNumInputs,
           typename SubgraphInferType,
           typename SubgraphInferShape,
@@ -455,6 +527,7 @@ void registerOp(const char* name,
                 InferShape infer_shape,
                 InferSType infer_storage_type,
                 MutateInputs mutate_inputs,
+                InplaceOption inplace_option,
                 SubgraphNumInputs num_subgraph_inputs,
                 SubgraphInferType infer_subgraph_type,
                 SubgraphInferShape infer_subgraph_shape,
@@ -462,6 +535,7 @@ void registerOp(const char* name,
                 CreateOpState create_opstate,
                 GradReg grad_reg,
                 mxnet::ext::mutateInputs_t mutate_fp,
+                mxnet::ext::inplace_t inplace_fp,
                 const std::unordered_map<std::string, mxnet::ext::createOpState_t>& createop_map,
                 const std::unordered_map<std::string, mxnet::ext::fcomp_t>& forward_ctx_map,
                 const std::unordered_map<std::string, mxnet::ext::fcomp_t>& backward_ctx_map,
@@ -494,6 +568,9 @@ void registerOp(const char* name,
     // optionally add fmutate inputs if user specified a function
     if (mutate_fp != nullptr)
       regOp.set_attr<nnvm::FMutateInputs>("FMutateInputs", mutate_inputs, plevel);
+    // optionally let the memory planner share inputs with outputs
+    if (inplace_fp != nullptr)
+      regOp.set_attr<nnvm::FInplaceOption>("FInplaceOption", inplace_option, plevel);
   } else {
     using namespace mxnet::op;
     regOp.set_num_inputs(num_subgraph_inputs);
@@ -704,6 +781,9 @@ void registerOperators(void* lib,
   opCallMutateInputs_t callMutateInputs =
       get_func<opCallMutateInputs_t>(lib, const_cast<char*>(MXLIB_OPCALLMUTATEINPUTS_STR));
 
+  opCallInplace_t callInplace =
+      get_func<opCallInplace_t>(lib, const_cast<char*>(MXLIB_OPCALLINPLACE_STR));
+
   opCallCreateOpState_t callCreateOpState =
       get_func<opCallCreateOpState_t>(lib, const_cast<char*>(MXLIB_OPCALLCREATEOPSTATE_STR));
 
@@ -733,6 +813,7 @@ void registerOperators(void* lib,
     inferShape_t shape_fp = nullptr;
     // optional attributes
     mutateInputs_t mutate_fp = nullptr;
+    inplace_t inplace_fp     = nullptr;
     bool isSubgraphOp        = false;
     int _isSubgraphOp        = 0;
     // lists of forward and backward function associated with each context
@@ -758,7 +839,8 @@ void registerOperators(void* lib,
              &type_fp,
              &stype_fp,
              &shape_fp,
-             &mutate_fp);
+             &mutate_fp,
+             &inplace_fp);
 
     // construct maps of context to forward/backward custom library function
     std::unordered_map<std::string, fcomp_t> forward_ctx_map;
@@ -1171,6 +1253,37 @@ void registerOperators(void* lib,
       return mutate_indices_list;
     };
 
+    // lambda function to convert from external inplace to internal MXNet types
+    auto inplace_option = [=](const nnvm::NodeAttrs& attrs) {
+      // convert attributes to vector of char*
+      std::vector<const char*> attr_keys, attr_vals;
+      for (auto& kv : attrs.dict) {
+        attr_keys.push_back(kv.first.c_str());
+        attr_vals.push_back(kv.second.c_str());
+      }
+
+      // C type placeholder for the flattened (input, output) index pairs
+      int* inplace_pairs = nullptr;
+      int pairs_size     = 0;
+
+      // call inplace function
+      int retval       = callInplace(inplace_fp,
+                               attr_keys.data(),
+                               attr_vals.data(),
+                               attr_keys.size(),
+                               &inplace_pairs,
+                               &pairs_size);
+      std::string msgs = getExtensionMsgs(msgSize, msgGet);
+      CHECK(retval) << "Error calling Inplace for custom operator '" << name_str << "'" << msgs;
+
+      std::vector<std::pair<int, int>> inplace_list(pairs_size);
+      for (int i = 0; i < pairs_size; i++)
+        inplace_list[i] = {inplace_pairs[2 * i], inplace_pairs[2 * i + 1]};
+      callFree(inplace_pairs);
+
+      return inplace_list;
+    };
+
     // lambda function to set storage types
     auto infer_storage_type = [=](const nnvm::NodeAttrs& attrs,
                                   const int dev_mask,
@@ -1409,6 +1522,7 @@ void registerOperators(void* lib,
                infer_shape,
                infer_storage_type,
                mutate_inputs,
+               inplace_option,
                num_subgraph_inputs,
                infer_subgraph_type,
                infer_subgraph_shape,
@@ -1416,6 +1530,7 @@ void registerOperators(void* lib,
                create_opstate,
                grad_reg,
                mutate_fp,
+               inplace_fp,
                createop_map,
                forward_ctx_map,
                backward_ctx_map,
@@ -1858,6 +1973,41 @@ int MXRandomSeedContext(int seed, int dev_type, int dev_id) {
   API_END();
 }
 
+int MXNCCLGetUniqueId(char* out, int size) {
+  API_BEGIN();
+#if MXNET_USE_NCCL == 1
+  CHECK_GE(size, NCCL_UNIQUE_ID_BYTES) << "The NCCL unique id has " << NCCL_UNIQUE_ID_BYTES
+                                       << " bytes";
+  ncclUniqueId id;
+  const ncclResult_t ret = ncclGetUniqueId(&id);
+  CHECK_EQ(ret, ncclSuccess) << "Failed to create the NCCL unique id: " << ncclGetErrorString(ret);
+  std::memcpy(out, id.internal, NCCL_UNIQUE_ID_BYTES);
+#else
+  LOG(FATAL) << "compile with USE_NCCL=1 to use the NCCL communicators";
+#endif  // MXNET_USE_NCCL == 1
+  API_END();
+}
+
+int MXNCCLInitComms(const char* unique_id,
+                    int size,
+                    int num_ranks,
+                    int first_rank,
+                    int num_devices,
+                    const int* dev_ids) {
+  API_BEGIN();
+#if MXNET_USE_NCCL == 1
+  CHECK_EQ(size, NCCL_UNIQUE_ID_BYTES) << "The NCCL unique id has " << NCCL_UNIQUE_ID_BYTES
+                                       << " bytes";
+  ncclUniqueId id;
+  std::memcpy(id.internal, unique_id, NCCL_UNIQUE_ID_BYTES);
+  ResourceManager::InitNCCLComms(
+      id, num_ranks, first_rank, std::vector<int>(dev_ids, dev_ids + num_devices));
+#else
+  LOG(FATAL) << "compile with USE_NCCL=1 to use the NCCL communicators";
+#endif  // MXNET_USE_NCCL == 1
+  API_END();
+}
+
 int MXSetFlushDenorms(bool value, bool* prev_state) {
   API_BEGIN();
   *prev_state = false;
@@ -1929,6 +2079,30 @@ int MXEngineSetBulkSize(int bulk_size, int* prev_bulk_size) {
   API_END();
 }
 
+int MXEngineSetThreadPriority(int priority, int* prev_priority) {
+  API_BEGIN();
+  *prev_priority = Engine::Get()->set_thread_priority(priority);
+  API_END();
+}
+
+int MXEngineGetAdaptiveBulkStats(uint64_t* num_merged, uint64_t* num_bulks, uint64_t* num_timed) {
+  API_BEGIN();
+  Engine::Get()->adaptive_bulk_stats(num_merged, num_bulks, num_timed);
+  API_END();
+}
+
+int MXEngineSetTape(int mode, int* prev_running) {
+  API_BEGIN();
+  *prev_running = Engine::Get()->set_tape(mode);
+  API_END();
+}
+
+int MXEngineGetTapeStats(uint64_t* num_reused, uint64_t* num_recorded) {
+  API_BEGIN();
+  Engine::Get()->tape_stats(num_reused, num_recorded);
+  API_END();
+}
+
 int MXGetGPUCount(int* out) {
   API_BEGIN();
   *out = Context::GetGPUCount();
@@ -1997,6 +2171,13 @@ int MXLoadTVMConfig(ConfigSpaces config) {
   API_END();
 }
 
+int MXLoadTVMOpTuning(int num, const char** keys, const char** schedules) {
+  API_BEGIN();
+  mxnet::op::LoadTVMOpTuning(std::vector<std::string>(keys, keys + num),
+                             std::vector<std::string>(schedules, schedules + num));
+  API_END();
+}
+
 #endif  // MXNET_USE_TVM_OP
 
 int MXNDArrayCreateNone(NDArrayHandle* out) {
@@ -2178,6 +2359,68 @@ int MXNDArraySyncCopyToCPU(NDArrayHandle handle, void* data, size_t size) {
   API_END();
 }
 
+namespace {
+
+/*! \brief a copy of MXNDArrayCopyToCPUAsync, into the static array dst */
+struct NDArrayCopyEvent {
+  NDArray dst;
+  std::atomic<bool> done{false};
+};
+
+}  // namespace
+
+int MXNDArrayCopyToCPUAsync(NDArrayHandle handle,
+                            void* data,
+                            size_t size,
+                            NDArrayCopyHandle* out) {
+  API_BEGIN();
+  const NDArray* src = static_cast<NDArray*>(handle);
+  CHECK(!src->is_none()) << "NDArray is not initialized";
+  CHECK_EQ(src->storage_type(), kDefaultStorage) << "Only dense arrays can be copied to CPU memory";
+  CHECK_EQ(src->shape().Size(), size) << "Memory size do not match";
+  auto event = std::make_shared<NDArrayCopyEvent>();
+  if (size == 0U) {
+    event->done = true;
+  } else {
+    Imperative::DCInfo::Compute(*src);
+    event->dst = NDArray(TBlob(data, src->shape(), cpu::kDevMask, src->dtype(), 0), 0);
+    CopyFromTo(*src, event->dst);
+    // runs after the copy even when it fails, MXNDArrayCopyWait then rethrows the error
+    Engine::Get()->PushAsync(
+        [event](RunContext, Engine::CallbackOnComplete on_complete) {
+          event->done = true;
+          on_complete();
+        },
+        Context::CPU(),
+        {event->dst.var()},
+        {},
+        FnProperty::kNoSkip,
+        0,
+        "CopyToCPUAsyncDone");
+  }
+  *out = new std::shared_ptr<NDArrayCopyEvent>(event);
+  API_END();
+}
+
+int MXNDArrayCopyIsDone(NDArrayCopyHandle handle, int* out) {
+  API_BEGIN();
+  *out = (*static_cast<std::shared_ptr<NDArrayCopyEvent>*>(handle))->done ? 1 : 0;
+  API_END();
+}
+
+int MXNDArrayCopyWait(NDArrayCopyHandle handle) {
+  API_BEGIN();
+  const NDArray& dst = (*static_cast<std::shared_ptr<NDArrayCopyEvent>*>(handle))->dst;
+  dst.WaitToRead();
+  API_END();
+}
+
+int MXNDArrayCopyFree(NDArrayCopyHandle handle) {
+  API_BEGIN();
+  delete static_cast<std::shared_ptr<NDArrayCopyEvent>*>(handle);
+  API_END();
+}
+
 /*!
  * \brief Copy src.data() to dst.data() if i = -1, else dst.aux_data(i) if i >= 0
  * This function blocks. Do not use it in performance critical code.
@@ -2214,6 +2457,12 @@ int MXNDArrayWaitToWrite(NDArrayHandle handle) {
   API_END();
 }
 
+int MXNDArraySetSpillable(NDArrayHandle handle) {
+  API_BEGIN();
+  static_cast<NDArray*>(handle)->SetSpillable();
+  API_END();
+}
+
 int MXNDArrayWaitAll() {
   API_BEGIN();
   Engine::Get()->WaitForAll();
@@ -2236,62 +2485,125 @@ int MXNDArrayLegacySave(const char* fname,
       names[i] = keys[i];
     }
   }
-  {
-    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname, "w"));
-    mxnet::NDArray::Save(fo.get(), data, names);
-  }
+  std::unique_ptr<PipelinedWriteStream> fo = PipelinedWriteStream::Create(fname);
+  mxnet::NDArray::Save(fo.get(), data, names);
+  fo->Close();
   API_END();
 }
 
+/*!
+ * \brief saves arrays as MXNDArraySave, where no names are empty names
+ * \param cpu_arrays whether the arrays are on the CPU in the default layout, and their pending
+ *  writes have completed, so that they are saved without waiting for the engine
+ */
+static void NDArraysSave(const std::string& fname,
+                         const std::vector<NDArray>& arrays,
+                         const std::vector<std::string>& names,
+                         bool cpu_arrays) {
+  if (arrays.size() == 1 && names.empty() && arrays[0].storage_type() == kDefaultStorage) {
+    if (cpu_arrays) {
+      npy::save_cpu_array(fname, arrays[0]);
+    } else {
+      npy::save_array(fname, arrays[0]);
+    }
+  } else if (arrays.size() == 1 && names.empty()) {
+    npz::save_arrays(fname, arrays, {""}, cpu_arrays);
+  } else {
+    npz::save_arrays(fname, arrays, names, cpu_arrays);
+  }
+}
+
 int MXNDArraySave(const char* fname, uint32_t num_args, NDArrayHandle* args, const char** keys) {
   API_BEGIN();
-
   CHECK_NOTNULL(fname);
+  std::vector<NDArray> arrays(num_args);
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < num_args; ++i)
+    arrays[i] = *static_cast<NDArray*>(args[i]);
+  if (keys != nullptr)
+    names.assign(keys, keys + num_args);
+  NDArraysSave(fname, arrays, names, false);
+  API_END();
+}
 
-  // We may use mz_zip_writer_init_v2 later instead of mz_zip_writer_init_file
-  // and write an adapter for DMLC stream based on pZip->m_pWrite (and
-  // pZip->m_pIO_opaque)
-  if (num_args == 1 && keys == nullptr) {
-    NDArray* array = static_cast<NDArray*>(args[0]);
-    if (array->storage_type() == kDefaultStorage) {
-      npy::save_array(fname, *array);
+int MXNDArraySaveAsync(const char* fname,
+                       uint32_t num_args,
+                       NDArrayHandle* args,
+                       const char** keys,
+                       NDArrayCopyHandle* out) {
+  API_BEGIN();
+  CHECK_NOTNULL(fname);
+  // the arrays to save are copies of the arrays of GPUs, pushed to the engine after the pending
+  // writes, and the CPU arrays themselves, which the engine keeps from being written until saved
+  std::vector<NDArray> arrays(num_args);
+  std::vector<Engine::VarHandle> const_vars;
+  for (uint32_t i = 0; i < num_args; ++i) {
+    const NDArray& array = *static_cast<NDArray*>(args[i]);
+    if (array.ctx().dev_mask() != cpu::kDevMask) {
+      arrays[i] = array.Copy(Context::CPU());
     } else {
-      mz_zip_archive archive{};
-      CHECK(mz_zip_writer_init_file(&archive, fname, 0))
-          << "Failed to open archive " << fname << ": "
-          << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-      npz::save_array(&archive, "", *array);
-      CHECK(mz_zip_writer_finalize_archive(&archive))
-          << "Failed to finalize archive " << fname
-          << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-      CHECK(mz_zip_writer_end(&archive))
-          << "Failed to end archive " << fname
-          << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-    }
-  } else {
-    mz_zip_archive archive{};
-    CHECK(mz_zip_writer_init_file(&archive, fname, 0))
-        << "Failed to open archive " << fname << ": "
-        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-    for (uint32_t i = 0; i < num_args; ++i) {
-      NDArray* array              = static_cast<NDArray*>(args[i]);
-      const std::string array_key = keys == nullptr ? "arr_" + std::to_string(i) : keys[i];
-      npz::save_array(&archive, array_key, *array);
+      arrays[i] = array;
+#if MXNET_USE_ONEDNN == 1
+      if (array.IsMKLDNNData()) {
+        array.WaitToRead();
+        arrays[i] = array.Reorder2Default();
+      }
+#endif
     }
-    CHECK(mz_zip_writer_finalize_archive(&archive))
-        << "Failed to finalize archive " << fname
-        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-    CHECK(mz_zip_writer_end(&archive)) << "Failed to end archive " << fname
-                                       << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+    const_vars.push_back(arrays[i].var());
   }
+  std::sort(const_vars.begin(), const_vars.end());
+  const_vars.erase(std::unique(const_vars.begin(), const_vars.end()), const_vars.end());
+  std::vector<std::string> names;
+  if (keys != nullptr)
+    names.assign(keys, keys + num_args);
+
+  auto event = std::make_shared<NDArrayCopyEvent>();
+  event->dst = NDArray(mxnet::TShape(1, 1), Context::CPU(), true, mshadow::kUint8);
+  const std::string file(fname);
+  Engine::Get()->PushAsync(
+      [file, arrays, names](RunContext, Engine::CallbackOnComplete on_complete) {
+        // writing the file takes long, so it runs on its own thread instead of a CPU worker
+        std::thread([file, arrays, names, on_complete]() {
+          try {
+            NDArraysSave(file, arrays, names, true);
+          } catch (const std::exception& e) {
+            const dmlc::Error error(e.what());
+            on_complete(&error);
+            return;
+          }
+          on_complete();
+        }).detach();
+      },
+      Context::CPU(),
+      const_vars,
+      {event->dst.var()},
+      FnProperty::kNormal,
+      0,
+      "SaveAsync");
+  // runs after the save even when it fails, MXNDArrayCopyWait then rethrows the error
+  Engine::Get()->PushAsync(
+      [event](RunContext, Engine::CallbackOnComplete on_complete) {
+        event->done = true;
+        on_complete();
+      },
+      Context::CPU(),
+      {event->dst.var()},
+      {},
+      FnProperty::kNoSkip,
+      0,
+      "SaveAsyncDone");
+  *out = new std::shared_ptr<NDArrayCopyEvent>(event);
   API_END();
 }
 
-int MXNDArrayLoad(const char* fname,
-                  uint32_t* out_size,
-                  NDArrayHandle** out_arr,
-                  uint32_t* out_name_size,
-                  const char*** out_names) {
+/*! \brief loads the arrays of fname, viewing those of mapped npz or npy files with use_mmap */
+static int NDArrayLoad(const char* fname,
+                       bool use_mmap,
+                       uint32_t* out_size,
+                       NDArrayHandle** out_arr,
+                       uint32_t* out_name_size,
+                       const char*** out_names) {
   MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
   ret->ret_vec_str.clear();
   API_BEGIN();
@@ -2305,7 +2617,7 @@ int MXNDArrayLoad(const char* fname,
 
   if (magic == 0x04034b50 || magic == 0x504b0304 || magic == 0x06054b50 ||
       magic == 0x504b0506) {                       // zip file format; assumed to be npz
-    auto [data, names] = npz::load_arrays(fname);  // NOLINT
+    auto [data, names] = npz::load_arrays(fname, use_mmap);  // NOLINT
     ret->ret_handles.resize(data.size());
     for (size_t i = 0; i < data.size(); ++i) {
       NDArray* ptr        = new NDArray();
@@ -2328,7 +2640,8 @@ int MXNDArrayLoad(const char* fname,
     *out_size = 1;
     ret->ret_handles.resize(1);
     NDArray* ptr = new NDArray();
-    *ptr         = npy::load_array(fname);  // Only supports local filesystem at this point in time
+    // Only supports local filesystem at this point in time
+    *ptr                = npy::load_array(fname, use_mmap);
     ret->ret_handles[0] = ptr;
     *out_arr            = dmlc::BeginPtr(ret->ret_handles);
   } else {
@@ -2356,6 +2669,119 @@ int MXNDArrayLoad(const char* fname,
   API_END();
 }
 
+/*!
+ * \brief copies the loaded arrays to ctx. The dense arrays go to a GPU in chunks through a ring of
+ *  pinned staging buffers, so that the engine overlaps the copies of the mapped file into the
+ *  buffers on the CPU workers with the copies of the buffers to the GPU on its copy threads.
+ */
+static void NDArraysToContext(const std::vector<NDArrayHandle>& handles, const Context& ctx) {
+  const size_t staging_bytes =
+      std::max(dmlc::GetEnv("MXNET_LOAD_STAGING_BYTES", size_t(16) << 20), sizeof(double));
+  const size_t num_staging = std::max(dmlc::GetEnv("MXNET_LOAD_STAGING_BUFFERS", 4), 1);
+  std::vector<NDArray> staging;
+  size_t next = 0;
+  for (NDArrayHandle handle : handles) {
+    NDArray* array = static_cast<NDArray*>(handle);
+    const index_t size = array->shape().Size();
+    if (ctx.dev_mask() != gpu::kDevMask || array->storage_type() != kDefaultStorage ||
+        size == 0) {
+      *array = array->Copy(ctx);
+      continue;
+    }
+    const index_t chunk = staging_bytes / mshadow::mshadow_sizeof(array->dtype());
+    const NDArray target(array->shape(), ctx, false, array->dtype());
+    const NDArray src = array->Reshape(mxnet::TShape(1, size));
+    const NDArray dst = target.Reshape(mxnet::TShape(1, size));
+    for (index_t begin = 0; begin < size; begin += chunk) {
+      const index_t end = std::min(begin + chunk, size);
+      if (staging.size() < num_staging) {
+        staging.emplace_back(mxnet::TShape(1, staging_bytes),
+                             Context::CPUPinned(ctx.dev_id),
+                             false,
+                             mshadow::kUint8);
+      }
+      const NDArray buffer =
+          staging[next++ % num_staging].AsArray(mxnet::TShape(1, end - begin), array->dtype());
+      CopyFromTo(src.Slice(begin, end), buffer);
+      CopyFromTo(buffer, dst.Slice(begin, end));
+    }
+    *array = target;
+  }
+}
+
+/*!
+ * \brief replaces the dense arrays loaded to the CPU by arrays of a GPU ctx that copy them when
+ *  they are first accessed, see NDArray::SetLoader
+ */
+static void NDArraysToLazy(const std::vector<NDArrayHandle>& handles, const Context& ctx) {
+  // the mapped arrays are already read when they are accessed
+  if (ctx.dev_mask() == cpu::kDevMask)
+    return;
+  for (NDArrayHandle handle : handles) {
+    NDArray* array = static_cast<NDArray*>(handle);
+    if (array->storage_type() != kDefaultStorage || array->ctx().dev_mask() != cpu::kDevMask ||
+        array->shape().Size() == 0) {
+      *array = array->Copy(ctx);
+      continue;
+    }
+    const NDArray src = *array;
+    const NDArray target(array->shape(), ctx, true, array->dtype());
+    target.SetLoader([src, ctx](void* dptr, size_t size) {
+#if MXNET_USE_CUDA
+      mxnet::common::cuda::DeviceStore device_store(ctx.real_dev_id(), true);
+      CUDA_CALL(cudaMemcpy(dptr, src.data().dptr_, size, cudaMemcpyHostToDevice));
+#endif  // MXNET_USE_CUDA
+    });
+    *array = target;
+  }
+}
+
+int MXNDArrayLoad(const char* fname,
+                  uint32_t* out_size,
+                  NDArrayHandle** out_arr,
+                  uint32_t* out_name_size,
+                  const char*** out_names) {
+  return NDArrayLoad(fname, false, out_size, out_arr, out_name_size, out_names);
+}
+
+int MXNDArrayLoadMMap(const char* fname,
+                      uint32_t* out_size,
+                      NDArrayHandle** out_arr,
+                      uint32_t* out_name_size,
+                      const char*** out_names) {
+  return NDArrayLoad(fname, true, out_size, out_arr, out_name_size, out_names);
+}
+
+int MXNDArrayLoadToContext(const char* fname,
+                           int dev_type,
+                           int dev_id,
+                           uint32_t* out_size,
+                           NDArrayHandle** out_arr,
+                           uint32_t* out_name_size,
+                           const char*** out_names) {
+  if (NDArrayLoad(fname, true, out_size, out_arr, out_name_size, out_names) != 0)
+    return -1;
+  API_BEGIN();
+  const Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  NDArraysToContext(MXAPIThreadLocalStore<>::Get()->ret_handles, ctx);
+  API_END();
+}
+
+int MXNDArrayLoadLazy(const char* fname,
+                      int dev_type,
+                      int dev_id,
+                      uint32_t* out_size,
+                      NDArrayHandle** out_arr,
+                      uint32_t* out_name_size,
+                      const char*** out_names) {
+  if (NDArrayLoad(fname, true, out_size, out_arr, out_name_size, out_names) != 0)
+    return -1;
+  API_BEGIN();
+  const Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  NDArraysToLazy(MXAPIThreadLocalStore<>::Get()->ret_handles, ctx);
+  API_END();
+}
+
 int MXNDArrayLoadFromBuffer(const void* ndarray_buffer,
                             size_t size,
                             uint32_t* out_size,
@@ -2577,6 +3003,85 @@ int MXNDArrayToDLPack(NDArrayHandle handle, DLManagedTensorHandle* out_dlpack) {
   API_END();
 }
 
+#if MXNET_USE_CUDA
+namespace {
+
+/*!
+ * \brief holds a CUDA stream of a DLPack consumer, on its host function, until the engine releases
+ *  it after the pending operations on the array handed to the consumer
+ */
+struct DLPackStreamGate {
+  std::mutex m;
+  std::condition_variable cv;
+  bool released = false;
+
+  void Release() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      released = true;
+    }
+    cv.notify_all();
+  }
+
+  static void CUDART_CB Wait(void* data) {
+    auto* gate = static_cast<std::shared_ptr<DLPackStreamGate>*>(data);
+    {
+      std::unique_lock<std::mutex> lock((*gate)->m);
+      (*gate)->cv.wait(lock, [gate]() { return (*gate)->released; });
+    }
+    delete gate;
+  }
+};
+
+}  // namespace
+#endif
+
+int MXNDArrayToDLPackStream(NDArrayHandle handle,
+                            int64_t stream,
+                            const bool for_write,
+                            DLManagedTensorHandle* out_dlpack) {
+  API_BEGIN();
+  NDArray* arr = static_cast<NDArray*>(handle);
+  CHECK(!arr->is_none()) << "NDArray is not initialized";
+  if (arr->ctx().dev_mask() != Context::kGPU) {
+    if (for_write) {
+      arr->WaitToWrite();
+    } else {
+      arr->WaitToRead();
+    }
+  } else if (stream != -1) {
+#if MXNET_USE_CUDA
+    CHECK_NE(stream, 0) << "Stream 0 is ambiguous for CUDA, "
+                        << "use 1 for the legacy default stream or 2 for the per-thread one";
+    cudaStream_t consumer = reinterpret_cast<cudaStream_t>(stream);
+    if (stream == 1) {
+      consumer = cudaStreamLegacy;
+    } else if (stream == 2) {
+      consumer = cudaStreamPerThread;
+    }
+    // the operations on GPU complete after their stream, so the consumer stream only waits for
+    // the engine to release it, and the host does not wait at all
+    auto gate = std::make_shared<DLPackStreamGate>();
+    mshadow::SetDevice<gpu>(arr->ctx().dev_id);
+    CUDA_CALL(cudaLaunchHostFunc(
+        consumer, DLPackStreamGate::Wait, new std::shared_ptr<DLPackStreamGate>(gate)));
+    std::vector<engine::VarHandle> const_vars, mutable_vars;
+    (for_write ? mutable_vars : const_vars).push_back(arr->var());
+    Engine::Get()->PushSync([gate](RunContext) { gate->Release(); },
+                            Context::CPU(),
+                            const_vars,
+                            mutable_vars,
+                            FnProperty::kCPUPrioritized,
+                            0,
+                            "DLPackStreamHandoff");
+#else
+    LOG(FATAL) << "GPU is not enabled";
+#endif
+  }
+  *out_dlpack = arr->ToDLPack();
+  API_END();
+}
+
 int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
                         const bool transient_handle,
                         NDArrayHandle* out_handle) {
@@ -3039,8 +3544,11 @@ int MXBatchifyFunctionInvoke(BatchifyFunctionHandle handle,
     ndinputs.emplace_back(tmp);
   }
   std::vector<NDArray> res;
-  CHECK((*static_cast<BatchifyFunctionPtr*>(handle))->Batchify(ndinputs, &res))
-      << "Error call batchify with " << ndinputs.size() << " inputs";
+  {
+    profiler::IOStageTimer timer(profiler::IOProfiler::kBatchify);
+    CHECK((*static_cast<BatchifyFunctionPtr*>(handle))->Batchify(ndinputs, &res))
+        << "Error call batchify with " << ndinputs.size() << " inputs";
+  }
   std::vector<NDArray*> ndoutputs;
   ndoutputs.reserve(res.size());
   if (*outputs == nullptr) {
@@ -3106,6 +3614,17 @@ int MXKVStoreFree(KVStoreHandle handle) {
   API_END();
 }
 
+// bytes of the dense arrays of a kvstore call, the shapes of sparse outputs are not known yet
+inline uint64_t KVStoreBytes(const NDArrayHandle* arrs, uint32_t num) {
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < num; ++i) {
+    const NDArray* arr = static_cast<const NDArray*>(arrs[i]);
+    if (arr->storage_type() == kDefaultStorage)
+      bytes += arr->shape().Size() * mshadow::mshadow_sizeof(arr->dtype());
+  }
+  return bytes;
+}
+
 int MXKVStoreInit(KVStoreHandle handle, uint32_t num, const int* keys, NDArrayHandle* vals) {
   API_BEGIN();
   std::vector<int> v_keys(num);
@@ -3130,12 +3649,46 @@ int MXKVStoreInitEx(KVStoreHandle handle, uint32_t num, const char** keys, NDArr
   API_END();
 }
 
+int MXKVStoreInitHashEmbedding(KVStoreHandle handle,
+                               int key,
+                               int64_t num_ids,
+                               int64_t dim,
+                               uint32_t num_params,
+                               const char** param_keys,
+                               const char** param_vals) {
+  API_BEGIN();
+  std::vector<std::pair<std::string, std::string>> params;
+  for (uint32_t i = 0; i < num_params; ++i) {
+    params.emplace_back(param_keys[i], param_vals[i]);
+  }
+  static_cast<KVStore*>(handle)->InitHashEmbedding(key, mxnet::TShape({num_ids, dim}), params);
+  API_END();
+}
+
+int MXKVStoreInitHashEmbeddingEx(KVStoreHandle handle,
+                                 const char* key,
+                                 int64_t num_ids,
+                                 int64_t dim,
+                                 uint32_t num_params,
+                                 const char** param_keys,
+                                 const char** param_vals) {
+  API_BEGIN();
+  std::vector<std::pair<std::string, std::string>> params;
+  for (uint32_t i = 0; i < num_params; ++i) {
+    params.emplace_back(param_keys[i], param_vals[i]);
+  }
+  static_cast<KVStore*>(handle)->InitHashEmbedding(
+      std::string(key), mxnet::TShape({num_ids, dim}), params);
+  API_END();
+}
+
 int MXKVStorePush(KVStoreHandle handle,
                   uint32_t num,
                   const int* keys,
                   NDArrayHandle* vals,
                   int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPush, KVStoreBytes(vals, num));
   std::vector<int> v_keys(num);
   std::vector<NDArray> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3152,6 +3705,7 @@ int MXKVStorePushEx(KVStoreHandle handle,
                     NDArrayHandle* vals,
                     int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPush, KVStoreBytes(vals, num));
   std::vector<std::string> v_keys(num);
   std::vector<NDArray> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3168,6 +3722,7 @@ int MXKVStorePull(KVStoreHandle handle,
                   NDArrayHandle* vals,
                   int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<int> v_keys(num);
   std::vector<NDArray*> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3184,6 +3739,7 @@ int MXKVStorePullEx(KVStoreHandle handle,
                     NDArrayHandle* vals,
                     int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<std::string> v_keys(num);
   std::vector<NDArray*> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3253,6 +3809,8 @@ int MXKVStorePushPull(KVStoreHandle handle,
                       NDArrayHandle* outs,
                       int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPushPull,
+                                     KVStoreBytes(vals, vnum) + KVStoreBytes(outs, onum));
   std::vector<int> v_vkeys(vnum);
   std::vector<int> v_okeys(onum);
   std::vector<NDArray> v_vals(vnum);
@@ -3278,6 +3836,8 @@ int MXKVStorePushPullEx(KVStoreHandle handle,
                         NDArrayHandle* outs,
                         int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPushPull,
+                                     KVStoreBytes(vals, vnum) + KVStoreBytes(outs, onum));
   std::vector<std::string> v_vkeys(vnum);
   std::vector<std::string> v_okeys(onum);
   std::vector<NDArray> v_vals(vnum);
@@ -3301,6 +3861,7 @@ int MXKVStorePullWithSparse(KVStoreHandle handle,
                             int priority,
                             bool ignore_sparse) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<int> v_keys(num);
   std::vector<NDArray*> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3318,6 +3879,7 @@ int MXKVStorePullWithSparseEx(KVStoreHandle handle,
                               int priority,
                               bool ignore_sparse) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<std::string> v_keys(num);
   std::vector<NDArray*> v_vals(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3335,6 +3897,7 @@ int MXKVStorePullRowSparse(KVStoreHandle handle,
                            const NDArrayHandle* row_ids,
                            int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<int> v_keys(num);
   std::vector<std::pair<NDArray*, NDArray>> v_val_rowids(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3353,6 +3916,7 @@ int MXKVStorePullRowSparseEx(KVStoreHandle handle,
                              const NDArrayHandle* row_ids,
                              int priority) {
   API_BEGIN();
+  profiler::KVStoreCallTimer timer(profiler::KVStoreMetrics::kPull, KVStoreBytes(vals, num));
   std::vector<std::string> v_keys(num);
   std::vector<std::pair<NDArray*, NDArray>> v_val_rowids(num);
   for (uint32_t i = 0; i < num; ++i) {
@@ -3626,6 +4190,15 @@ int MXCustomOpRegister(const char* op_type, CustomOpPropCreator creator) {
   API_END();
 }
 
+int MXCustomOpComplete(void* on_complete, const char* error) {
+  API_BEGIN();
+  CHECK(on_complete != nullptr) << "The completion of an async custom op must not be NULL";
+  std::unique_ptr<mxnet::op::custom::CustomOpCompletion> completion(
+      static_cast<mxnet::op::custom::CustomOpCompletion*>(on_complete));
+  completion->fn(error);
+  API_END();
+}
+
 int MXRtcCudaModuleCreate(const char* source,
                           int num_options,
                           const char** options,
@@ -3763,6 +4336,119 @@ int MXNDArrayCreateFromSharedMem(int shared_pid,
   API_END();
 }
 
+#if MXNET_USE_CUDA
+namespace {
+
+/*!
+ * \brief the GPU memory of the other processes mapped by MXNDArrayCreateFromSharedGPUMem. CUDA
+ *  maps an IPC handle once by process, so the arrays of the same allocation share its mapping,
+ *  which is unmapped with the last of them.
+ */
+class SharedGPUMemMappings {
+ public:
+  static SharedGPUMemMappings* Get() {
+    static SharedGPUMemMappings inst;
+    return &inst;
+  }
+
+  /*! \brief maps the allocation of handle on the GPU dev_id and returns its address */
+  void* Open(const std::string& handle, int dev_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Mapping& mapping = mappings_[{handle, dev_id}];
+    if (mapping.refs == 0) {
+      cudaIpcMemHandle_t mem_handle;
+      std::memcpy(&mem_handle, handle.data(), sizeof(mem_handle));
+      common::cuda::DeviceStore device_store(dev_id);
+      CUDA_CALL(
+          cudaIpcOpenMemHandle(&mapping.base, mem_handle, cudaIpcMemLazyEnablePeerAccess));
+    }
+    ++mapping.refs;
+    return mapping.base;
+  }
+
+  /*! \brief unmaps the allocation of handle on dev_id when no array reads it anymore */
+  void Close(const std::string& handle, int dev_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = mappings_.find({handle, dev_id});
+    CHECK(it != mappings_.end());
+    if (--it->second.refs == 0) {
+      common::cuda::DeviceStore device_store(dev_id);
+      cudaError_t e = cudaIpcCloseMemHandle(it->second.base);
+      // the arrays freed at exit may outlive the CUDA runtime
+      CHECK(e == cudaSuccess || e == cudaErrorCudartUnloading)
+          << "CUDA: " << cudaGetErrorString(e);
+      mappings_.erase(it);
+    }
+  }
+
+ private:
+  struct Mapping {
+    void* base = nullptr;
+    int refs   = 0;
+  };
+  std::mutex mutex_;
+  std::map<std::pair<std::string, int>, Mapping> mappings_;
+};
+
+}  // namespace
+#endif  // MXNET_USE_CUDA
+
+int MXNDArrayGetSharedGPUMemHandle(NDArrayHandle handle,
+                                   char* ipc_handle,
+                                   uint64_t* offset,
+                                   int* dev_id) {
+  API_BEGIN();
+#if MXNET_USE_CUDA
+  NDArray* arr = reinterpret_cast<NDArray*>(handle);
+  CHECK_EQ(arr->ctx().dev_mask(), gpu::kDevMask) << "Only the GPU arrays have CUDA IPC handles";
+  CHECK_EQ(arr->storage_type(), kDefaultStorage)
+      << "Only the dense arrays have CUDA IPC handles";
+  arr->WaitToRead();
+  const TBlob& data = arr->data();
+  CHECK(data.dptr_ != nullptr) << "The array to share has no memory";
+  common::cuda::DeviceStore device_store(arr->ctx().real_dev_id());
+  // the handle is the one of the whole allocation, which may hold other arrays of the pool
+  CUdeviceptr base;
+  size_t size;
+  CUdeviceptr dptr = reinterpret_cast<CUdeviceptr>(data.dptr_);
+  CUDA_DRIVER_CALL(cuMemGetAddressRange(&base, &size, dptr));
+  cudaIpcMemHandle_t mem_handle;
+  CUDA_CALL(cudaIpcGetMemHandle(&mem_handle, reinterpret_cast<void*>(base)));
+  static_assert(sizeof(mem_handle) == 64, "CUDA IPC handles are of 64 bytes");
+  std::memcpy(ipc_handle, &mem_handle, sizeof(mem_handle));
+  *offset = dptr - base;
+  *dev_id = arr->ctx().real_dev_id();
+#else
+  LOG(FATAL) << "Compile with USE_CUDA=1 to share GPU memory between processes.";
+#endif
+  API_END();
+}
+
+int MXNDArrayCreateFromSharedGPUMem(const char* ipc_handle,
+                                    uint64_t offset,
+                                    int dev_id,
+                                    const int* shape,
+                                    int ndim,
+                                    int dtype,
+                                    NDArrayHandle* out) {
+  API_BEGIN();
+#if MXNET_USE_CUDA
+  const std::string key(ipc_handle, sizeof(cudaIpcMemHandle_t));
+  char* base = static_cast<char*>(SharedGPUMemMappings::Get()->Open(key, dev_id));
+  TBlob data(static_cast<void*>(base + offset),
+             mxnet::TShape(shape, shape + ndim),
+             gpu::kDevMask,
+             dtype,
+             dev_id);
+  *out = new NDArray(data, dev_id, [key, dev_id]() {
+    SharedGPUMemMappings::Get()->Close(key, dev_id);
+  });
+#else
+  LOG(FATAL) << "Compile with USE_CUDA=1 to share GPU memory between processes.";
+#endif
+  API_END();
+}
+
 using VarHandle          = Engine::VarHandle;
 using CallbackOnComplete = Engine::CallbackOnComplete;
 
@@ -3935,6 +4621,15 @@ int MXStorageEmptyCache(int dev_type, int dev_id) {
   API_END();
 }
 
+int MXStorageGetPoolStats(int dev_type, int dev_id, const char** out_json) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  Context ctx  = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  ret->ret_str = Storage::Get()->PoolStats(ctx);
+  *out_json    = ret->ret_str.c_str();
+  API_END();
+}
+
 int MXShallowCopyNDArray(NDArrayHandle src_handle, NDArrayHandle* out) {
   NDArray* ret = nullptr;
   API_BEGIN();
@@ -37,6 +37,7 @@
 #include "../imperative/imperative_utils.h"
 #include "../imperative/cached_op.h"
 #include "../imperative/cached_op_threadsafe.h"
+#include "../imperative/cached_op_batcher.h"
 #include "../profiler/profiler.h"
 
 using namespace mxnet;
@@ -267,6 +268,55 @@ int MXInvokeCachedOp(CachedOpHandle handle,
   API_END();
 }
 
+int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                            uint32_t max_batch,
+                            uint32_t timeout_us,
+                            CachedOpBatcherHandle* out) {
+  API_BEGIN();
+  CachedOpThreadSafePtr op =
+      std::dynamic_pointer_cast<CachedOpThreadSafe>(*static_cast<CachedOpPtr*>(handle));
+  CHECK(op != nullptr) << "Only thread safe CachedOps can batch requests";
+  *out = new CachedOpBatcher(op, max_batch, timeout_us);
+  API_END();
+}
+
+int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle) {
+  API_BEGIN();
+  delete static_cast<CachedOpBatcher*>(handle);
+  API_END();
+}
+
+int MXInvokeCachedOpBatcher(CachedOpBatcherHandle handle,
+                            int num_inputs,
+                            NDArrayHandle* inputs,
+                            int* num_outputs,
+                            NDArrayHandle** outputs,
+                            const int** out_stypes) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+
+  API_BEGIN();
+  CachedOpBatcher* batcher = static_cast<CachedOpBatcher*>(handle);
+  std::vector<NDArray> ndinputs;
+  ndinputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    ndinputs.push_back(*reinterpret_cast<NDArray*>(inputs[i]));
+  }
+  std::vector<NDArray> ndoutputs = batcher->Invoke(ndinputs);
+
+  *num_outputs = static_cast<int>(ndoutputs.size());
+  ret->ret_handles.clear();
+  ret->ret_handles.reserve(*num_outputs);
+  ret->out_types.clear();
+  ret->out_types.reserve(*num_outputs);
+  for (const NDArray& output : ndoutputs) {
+    ret->ret_handles.push_back(new NDArray(output));
+    ret->out_types.emplace_back(output.storage_type());
+  }
+  *outputs    = dmlc::BeginPtr(ret->ret_handles);
+  *out_stypes = dmlc::BeginPtr(ret->out_types);
+  API_END();
+}
+
 int MXAutogradIsTraining(bool* curr) {
   API_BEGIN();
   *curr = Imperative::Get()->is_training();
@@ -32,6 +32,11 @@
 #include <stack>
 #include "./c_api_common.h"
 #include "../profiler/storage_profiler.h"
+#include "../profiler/io_profiler.h"
+#include "../profiler/storage_fallback_profiler.h"
+#include "../profiler/openmetrics.h"
+#include "../profiler/sampling_profiler.h"
+#include "../profiler/request_tracer.h"
 #include "../profiler/profiler.h"
 
 namespace mxnet {
@@ -308,15 +313,22 @@ int MXAggregateProfileStatsPrint(const char** out_str,
     // Register stats up until now
     profiler->DumpProfile(false);
   }
+  // the sampled operator executions are recorded into the aggregate stats when drained
+  profiler::SamplingProfiler::Get()->Drain();
   std::shared_ptr<profiler::AggregateStats> stats = profiler->GetAggregateStats();
   std::ostringstream os;
+  const std::string io_summary = profiler::IOProfiler::Get()->Summary(reset != 0);
+  const std::string fallback_summary =
+      profiler::StorageFallbackProfiler::Get()->Summary(reset != 0);
   if (stats) {
-    if (static_cast<PrintFormat>(format) == PrintFormat::table)
+    if (static_cast<PrintFormat>(format) == PrintFormat::table) {
       stats->DumpTable(os, sort_by, ascending);
-    else if (static_cast<PrintFormat>(format) == PrintFormat::json)
+      os << io_summary << fallback_summary;
+    } else if (static_cast<PrintFormat>(format) == PrintFormat::json) {
       stats->DumpJson(os, sort_by, ascending);
-    else
+    } else {
       LOG(FATAL) << "Invalid value for parameter format";
+    }
   }
   if (reset != 0)
     stats->clear();
@@ -569,3 +581,58 @@ int MXProfileSetMarker(ProfileHandle domain, const char* instant_marker_name, co
   marker.mark();
   API_END();
 }
+
+int MXProfileSetSampleRate(int sample_rate) {
+  mxnet::IgnoreProfileCallScope ignore;
+  API_BEGIN();
+  profiler::SamplingProfiler::Get()->set_sample_rate(sample_rate);
+  API_END();
+}
+
+int MXProfileScrapeSampledStats(const char** out_str, int reset) {
+  mxnet::IgnoreProfileCallScope ignore;
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  ret->ret_str = profiler::SamplingProfiler::Get()->Scrape(reset != 0);
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
+int MXRequestTraceBegin(const char* traceparent, const char** out_trace_id) {
+  mxnet::IgnoreProfileCallScope ignore;
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  ret->ret_str = profiler::RequestTracer::Get()
+                     ->Begin(traceparent != nullptr ? traceparent : "")
+                     ->trace_id();
+  if (out_trace_id != nullptr)
+    *out_trace_id = (ret->ret_str).c_str();
+  API_END();
+}
+
+int MXRequestTraceEnd() {
+  mxnet::IgnoreProfileCallScope ignore;
+  API_BEGIN();
+  profiler::RequestTracer::Get()->End();
+  API_END();
+}
+
+int MXRequestTraceSetConfig(double threshold_ms, const char* filename) {
+  mxnet::IgnoreProfileCallScope ignore;
+  API_BEGIN();
+  CHECK_GE(threshold_ms, 0) << "The latency threshold of the request traces should be non-negative";
+  CHECK_NOTNULL(filename);
+  profiler::RequestTracer::Get()->SetConfig(static_cast<uint64_t>(threshold_ms * 1000), filename);
+  API_END();
+}
+
+int MXGetOpenMetrics(const char** out_str) {
+  mxnet::IgnoreProfileCallScope ignore;
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  ret->ret_str = profiler::OpenMetricsText();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
@@ -21,6 +21,7 @@
  * \file c_api_symbolic.cc
  * \brief C API of mxnet
  */
+#include "dmlc/common.h"
 #include "mxnet/base.h"
 #include "mxnet/c_api.h"
 #include "mxnet/imperative.h"
@@ -33,6 +34,7 @@
 #include "../operator/operator_common.h"
 #include "../imperative/exec_pass.h"
 #include "../operator/subgraph/subgraph_property.h"
+#include "../operator/subgraph/partition_cost.h"
 
 namespace mxnet {
 namespace op {
@@ -477,6 +479,16 @@ int MXSymbolRemoveAmpCast(SymbolHandle sym_handle, SymbolHandle* ret_sym_handle)
   API_END_HANDLE_ERROR(delete s);
 }
 
+int MXSymbolPruneForInference(SymbolHandle sym_handle, SymbolHandle* ret_sym_handle) {
+  nnvm::Symbol* s = new nnvm::Symbol();
+  API_BEGIN();
+  nnvm::Symbol* source = static_cast<nnvm::Symbol*>(sym_handle);
+  *s                   = source->Copy();
+  s->outputs           = nnvm::ApplyPass(Symbol2Graph(*s), "PruneForInference").outputs;
+  *ret_sym_handle      = s;
+  API_END_HANDLE_ERROR(delete s);
+}
+
 int MXSymbolSaveToFile(SymbolHandle symbol, const char* fname) {
   nnvm::Symbol* s = static_cast<nnvm::Symbol*>(symbol);
   API_BEGIN();
@@ -971,6 +983,47 @@ int MXQuantizeSymbol(SymbolHandle sym_handle,
   API_END_HANDLE_ERROR(delete s);
 }
 
+int MXFakeQuantizeSymbol(SymbolHandle sym_handle,
+                         SymbolHandle* ret_sym_handle,
+                         const int* dev_type,
+                         const uint32_t num_excluded_sym_names,
+                         const char** excluded_sym_names,
+                         const uint32_t num_excluded_op_names,
+                         const char** excluded_op_names,
+                         const char* quantized_dtype,
+                         const char* quantize_mode,
+                         const char* quantize_granularity,
+                         mx_uint* out_num_entry_names,
+                         const char*** out_entry_names) {
+  nnvm::Symbol* s = new nnvm::Symbol();
+  API_BEGIN();
+  nnvm::Symbol* sym = static_cast<nnvm::Symbol*>(sym_handle);
+  nnvm::Graph g     = Symbol2Graph(*sym);
+  std::unordered_set<std::string> excluded_node_names(excluded_sym_names,
+                                                      excluded_sym_names + num_excluded_sym_names);
+  std::unordered_set<std::string> excluded_op(excluded_op_names,
+                                              excluded_op_names + num_excluded_op_names);
+  g.attrs["excluded_nodes"]       = std::make_shared<nnvm::any>(std::move(excluded_node_names));
+  g.attrs["excluded_ops"]         = std::make_shared<nnvm::any>(std::move(excluded_op));
+  g.attrs["quantized_dtype"]      = std::make_shared<nnvm::any>(std::string(quantized_dtype));
+  g.attrs["target_ctx"]           = std::make_shared<nnvm::any>(*dev_type);
+  g.attrs["quantize_mode"]        = std::make_shared<nnvm::any>(std::string(quantize_mode));
+  g.attrs["quantize_granularity"] = std::make_shared<nnvm::any>(std::string(quantize_granularity));
+  g                               = ApplyPass(std::move(g), "FakeQuantizeGraph");
+  const auto& entry_names         = g.GetAttr<std::vector<std::string>>("fake_quantize_entries");
+  MXAPIThreadLocalEntry<>* ret    = MXAPIThreadLocalStore<>::Get();
+  ret->ret_vec_str                = entry_names;
+  *out_num_entry_names            = ret->ret_vec_str.size();
+  ret->ret_vec_charp.clear();
+  for (const auto& str : ret->ret_vec_str) {
+    ret->ret_vec_charp.push_back(str.c_str());
+  }
+  *out_entry_names = dmlc::BeginPtr(ret->ret_vec_charp);
+  s->outputs       = g.outputs;
+  *ret_sym_handle  = s;
+  API_END_HANDLE_ERROR(delete s);
+}
+
 // helper function to add mapping of node_name -> dtype map
 // for the given indexed graph and inferred_dtypes
 static void _SetInputDTypes(const nnvm::IndexedGraph& idx,
@@ -1396,7 +1449,99 @@ int MXOptimizeForBackend(SymbolHandle sym_handle,
     return g;
   };
 
-  if (mxnet::op::SubgraphBackendRegistry::Get()->backend_map_.count(backend_name) > 0) {
+  const std::vector<std::string> backend_names = dmlc::Split(backend_name, ',');
+  if (backend_names.size() > 1) {
+    // partition across the subgraph backends by the estimated latency of their subgraphs
+    auto* registry       = mxnet::op::SubgraphBackendRegistry::Get();
+    double transfer_cost = 100;
+    std::unordered_map<std::string, double> speedups;
+    std::unordered_map<std::string, std::string> backend_options;
+    for (const auto& kv : options_map) {
+      if (kv.first == "cost_transfer") {
+        transfer_cost = std::stod(kv.second);
+      } else if (kv.first.rfind("cost_speedup_", 0) == 0) {
+        speedups[kv.first.substr(std::string("cost_speedup_").size())] = std::stod(kv.second);
+      } else {
+        backend_options.insert(kv);
+      }
+    }
+    const int dev_mask = Context::Create(static_cast<Context::DeviceType>(dev_type), 0).dev_mask();
+    std::vector<mxnet::op::PartitionBackendCost> costs;
+    std::vector<std::vector<std::vector<std::string>>> candidates(backend_names.size());
+    for (size_t b = 0; b < backend_names.size(); ++b) {
+      CHECK(registry->backend_map_.count(backend_names[b]))
+          << "Error optimizing for backend '" << backend_names[b] << "' cannot be found";
+      const auto& backend = registry->GetSubgraphBackend(backend_names[b]);
+      mxnet::op::PartitionBackendCost cost;
+      cost.speedup = 2.0;
+      if (speedups.count(backend_names[b])) {
+        cost.speedup = speedups.at(backend_names[b]);
+      } else if (backend->HasAttr("cost_speedup")) {
+        cost.speedup = backend->GetAttr<double>("cost_speedup");
+      }
+      cost.transfer = backend->HasAttr("context") &&
+                      backend->GetAttr<Context>("context").dev_mask() != dev_mask;
+      CHECK_GT(cost.speedup, 0) << "The speedup of backend " << backend_names[b]
+                                << " must be positive";
+      costs.push_back(cost);
+      for (auto property : backend->GetSubgraphProperties()) {
+        nnvm::Graph g = init_graph(s);
+        property->PrePartition(g, backend_options);
+        g.attrs["subgraph_property"] = std::make_shared<nnvm::any>(property);
+        g                            = ApplyPass(std::move(g), "FindSubgraphCandidates");
+        const auto& found = g.GetAttr<std::vector<std::vector<std::string>>>("subgraph_candidates");
+        candidates[b].insert(candidates[b].end(), found.begin(), found.end());
+      }
+    }
+    const nnvm::Graph orig_graph = init_graph(s);
+    const auto assignment =
+        mxnet::op::AssignPartitionByCost(orig_graph, candidates, costs, transfer_cost);
+    // the backend of every operator node, -1 for the default operators, and of the nodes
+    // created by a backend, the subgraph nodes, that backend. The map holds the nodes, so that
+    // the address of a node replaced by a subgraph is not reused.
+    std::unordered_map<nnvm::ObjectPtr, int> owners;
+    DFSVisit(orig_graph.outputs, [&](const nnvm::ObjectPtr& n) {
+      if (!n->is_variable()) {
+        auto it   = assignment.find(n->attrs.name);
+        owners[n] = it == assignment.end() ? -1 : static_cast<int>(it->second);
+      }
+    });
+    static int verbose = dmlc::GetEnv("MXNET_SUBGRAPH_VERBOSE", 1);
+    for (size_t b = 0; b < backend_names.size(); ++b) {
+      const int owner  = static_cast<int>(b);
+      size_t num_nodes = 0;
+      for (const auto& kv : owners)
+        num_nodes += kv.second == owner;
+      if (verbose > 1) {
+        LOG(INFO) << "Assigned " << num_nodes << " nodes to backend " << backend_names[b]
+                  << " by estimated cost";
+      }
+      if (num_nodes == 0)
+        continue;
+      const auto& backend = registry->GetSubgraphBackend(backend_names[b]);
+      for (auto property : backend->GetSubgraphProperties()) {
+        nnvm::Graph g = init_graph(s);
+        std::unordered_set<std::string> locked_nodes;
+        DFSVisit(g.outputs, [&](const nnvm::ObjectPtr& n) {
+          auto it = owners.find(n);
+          if (it != owners.end() && it->second != owner)
+            locked_nodes.insert(n->attrs.name);
+        });
+        property->PrePartition(g, backend_options);
+        g.attrs["subgraph_property"]     = std::make_shared<nnvm::any>(property);
+        g.attrs["subgraph_locked_nodes"] = std::make_shared<nnvm::any>(std::move(locked_nodes));
+        g                                = ApplyPass(std::move(g), "BuildSubgraph");
+        g.attrs.erase("subgraph_property");
+        g.attrs.erase("subgraph_locked_nodes");
+        property->PostPartition(g);
+        s->outputs = g.outputs;
+        DFSVisit(g.outputs, [&](const nnvm::ObjectPtr& n) {
+          if (!n->is_variable())
+            owners.emplace(n, owner);
+        });
+      }
+    }
+  } else if (mxnet::op::SubgraphBackendRegistry::Get()->backend_map_.count(backend_name) > 0) {
     // use subgraph backend
     const auto backend =
         mxnet::op::SubgraphBackendRegistry ::Get()->GetSubgraphBackend(backend_name);
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cpu_isa.cc
+ * \brief Runtime detection of the instruction sets of the CPU.
+ */
+#include "./cpu_isa.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#if MXNET_CPU_ISA_DISPATCH
+#include <cpuid.h>
+#endif
+#if MXNET_CPU_ISA_NEON && defined(__linux__)
+#include <sys/auxv.h>
+// the bits of AT_HWCAP and AT_HWCAP2, for the C libraries that predate them
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+#ifndef HWCAP2_SVE2
+#define HWCAP2_SVE2 (1 << 1)
+#endif
+#ifndef HWCAP2_I8MM
+#define HWCAP2_I8MM (1 << 13)
+#endif
+#ifndef HWCAP2_BF16
+#define HWCAP2_BF16 (1 << 14)
+#endif
+#endif
+
+namespace mxnet {
+namespace common {
+
+namespace {
+
+#if MXNET_CPU_ISA_DISPATCH
+/*! \brief the state components the operating system saves on context switches */
+uint64_t GetXCR0() {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+#endif
+
+CPUFeatures DetectCPUFeatures() {
+  CPUFeatures f;
+#if MXNET_CPU_ISA_DISPATCH
+  uint32_t eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return f;
+  const bool osxsave = ecx & bit_OSXSAVE;
+  const bool fma     = ecx & bit_FMA;
+  if (!osxsave || __get_cpuid_max(0, nullptr) < 7)
+    return f;
+  const uint64_t xcr0 = GetXCR0();
+  // the ymm registers, then the opmasks and the zmm registers, then the tiles
+  const bool ymm  = (xcr0 & 0x6) == 0x6;
+  const bool zmm  = ymm && (xcr0 & 0xe0) == 0xe0;
+  const bool tile = (xcr0 & 0x60000) == 0x60000;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  f.avx2        = ymm && (ebx & bit_AVX2);
+  f.fma         = ymm && fma;
+  f.avx512f     = zmm && (ebx & bit_AVX512F);
+  f.avx512bw    = zmm && (ebx & bit_AVX512BW);
+  f.avx512vl    = zmm && (ebx & bit_AVX512VL);
+  f.avx512_vnni = zmm && (ecx & (1u << 11));
+  f.amx_bf16    = tile && (edx & (1u << 22));
+  f.amx_tile    = tile && (edx & (1u << 24));
+  f.amx_int8    = tile && (edx & (1u << 25));
+  __cpuid_count(7, 1, eax, ebx, ecx, edx);
+  f.avx512_bf16 = zmm && (eax & (1u << 5));
+#elif MXNET_CPU_ISA_NEON
+  f.neon = true;
+#if defined(__linux__)
+  const uint64_t hwcap  = getauxval(AT_HWCAP);
+  const uint64_t hwcap2 = getauxval(AT_HWCAP2);
+  f.asimd_dotprod       = hwcap & HWCAP_ASIMDDP;
+  f.sve                 = hwcap & HWCAP_SVE;
+  f.sve2                = hwcap2 & HWCAP2_SVE2;
+  f.i8mm                = hwcap2 & HWCAP2_I8MM;
+  f.arm_bf16            = hwcap2 & HWCAP2_BF16;
+#elif defined(__APPLE__)
+  // every Apple silicon CPU has the dot products, none has SVE
+  f.asimd_dotprod = true;
+#endif
+#endif
+  return f;
+}
+
+CPUISA ParseISA(const std::string& name) {
+  std::string lower(name);
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  if (lower == "baseline" || lower == "none")
+    return CPUISA::kBaseline;
+  if (lower == "avx2")
+    return CPUISA::kAVX2;
+  if (lower == "avx512")
+    return CPUISA::kAVX512;
+  if (lower == "avx512_bf16")
+    return CPUISA::kAVX512BF16;
+  if (lower == "amx")
+    return CPUISA::kAMX;
+  if (lower == "neon")
+    return CPUISA::kNEON;
+  if (lower == "sve")
+    return CPUISA::kSVE;
+  LOG(FATAL) << "Unknown MXNET_CPU_MAX_ISA " << name
+             << ", expected one of baseline, avx2, avx512, avx512_bf16, amx, neon and sve";
+  return CPUISA::kBaseline;
+}
+
+CPUISA DetectCPUISA() {
+  const CPUFeatures& f = GetCPUFeatures();
+  CPUISA isa           = CPUISA::kBaseline;
+  if (f.avx2 && f.fma) {
+    isa = CPUISA::kAVX2;
+    if (f.avx512f && f.avx512bw && f.avx512vl) {
+      isa = CPUISA::kAVX512;
+      if (f.avx512_bf16) {
+        isa = CPUISA::kAVX512BF16;
+        if (f.amx_tile && f.amx_bf16 && f.amx_int8)
+          isa = CPUISA::kAMX;
+      }
+    }
+  }
+  if (f.neon)
+    isa = f.sve ? CPUISA::kSVE : CPUISA::kNEON;
+  const std::string max_isa = dmlc::GetEnv("MXNET_CPU_MAX_ISA", std::string());
+  return max_isa.empty() ? isa : std::min(isa, ParseISA(max_isa));
+}
+
+}  // namespace
+
+const CPUFeatures& GetCPUFeatures() {
+  static const CPUFeatures features = DetectCPUFeatures();
+  return features;
+}
+
+CPUISA GetCPUISA() {
+  static const CPUISA isa = DetectCPUISA();
+  return isa;
+}
+
+}  // namespace common
+}  // namespace mxnet
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cpu_isa.h
+ * \brief Runtime detection of the instruction sets of the CPU, which selects the
+ *  specialized kernels of the operators oneDNN does not cover.
+ */
+#ifndef MXNET_COMMON_CPU_ISA_H_
+#define MXNET_COMMON_CPU_ISA_H_
+
+// the kernels are compiled with function target attributes, next to the baseline code
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define MXNET_CPU_ISA_DISPATCH 1
+#define MXNET_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define MXNET_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx2,fma")))
+#else
+#define MXNET_CPU_ISA_DISPATCH 0
+#endif
+
+// every aarch64 CPU has NEON, so its kernels need no target attributes
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define MXNET_CPU_ISA_NEON 1
+#else
+#define MXNET_CPU_ISA_NEON 0
+#endif
+
+namespace mxnet {
+namespace common {
+
+/*! \brief instruction sets the CPU and the operating system support */
+struct CPUFeatures {
+  bool avx2        = false;
+  bool fma         = false;
+  bool avx512f     = false;
+  bool avx512bw    = false;
+  bool avx512vl    = false;
+  bool avx512_vnni = false;
+  bool avx512_bf16 = false;
+  bool amx_tile    = false;
+  bool amx_bf16    = false;
+  bool amx_int8    = false;
+  // aarch64
+  bool neon          = false;
+  bool asimd_dotprod = false;
+  bool sve           = false;
+  bool sve2          = false;
+  bool arm_bf16      = false;
+  bool i8mm          = false;
+};
+
+/*! \return the instruction sets of the CPU, detected once */
+const CPUFeatures& GetCPUFeatures();
+
+/*!
+ * \brief instruction sets of the dispatched kernels, each extending the previous ones of
+ *  its architecture: the x86 ones up to kAMX, then the aarch64 ones
+ */
+enum class CPUISA : int { kBaseline = 0, kAVX2, kAVX512, kAVX512BF16, kAMX, kNEON, kSVE };
+
+/*!
+ * \return the most capable instruction set the kernels may use: the one of the CPU,
+ *  capped by MXNET_CPU_MAX_ISA
+ */
+CPUISA GetCPUISA();
+
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_CPU_ISA_H_
@@ -23,7 +23,12 @@
 
 #include <nvrtc.h>
 
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <iomanip>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <fstream>
 #include <unordered_map>
@@ -161,6 +166,101 @@ std::tuple<bool, std::string> GetArchString(const int sm_arch) {
   }
 }
 
+// FNV-1a, stable across builds and platforms unlike std::hash
+uint64_t HashString(const std::string& s) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Directory of the on-disk kernel cache, empty if the cache is disabled.
+const std::string& KernelCacheDir() {
+  static const std::string dir = dmlc::GetEnv("MXNET_RTC_CACHE_DIR", std::string());
+  return dir;
+}
+
+// Everything the compiled image depends on besides the common header, which is hashed.
+std::string KernelCacheKey(const std::string& common_header,
+                           const std::string& source,
+                           const std::string& gpu_arch) {
+  static const std::string prefix = [&]() {
+    int major = 0, minor = 0;
+    NVRTC_CALL(nvrtcVersion(&major, &minor));
+    std::ostringstream os;
+    os << "nvrtc=" << major << "." << minor << " header=" << std::hex << HashString(common_header);
+    return os.str();
+  }();
+  std::ostringstream os;
+  os << prefix << " arch=" << gpu_arch
+#if NDEBUG == 0
+     << " debug"
+#endif
+     << "\n"
+     << source;
+  return os.str();
+}
+
+std::string KernelCachePath(const std::string& key) {
+  std::ostringstream os;
+  os << KernelCacheDir() << "/" << std::hex << std::setw(16) << std::setfill('0')
+     << HashString(key) << ".rtc";
+  return os.str();
+}
+
+bool ReadCacheString(std::istream* is, std::string* s) {
+  uint64_t size = 0;
+  // a corrupted entry must not trigger a huge allocation
+  if (!is->read(reinterpret_cast<char*>(&size), sizeof(size)) || size > (1ULL << 32))
+    return false;
+  s->resize(size);
+  return static_cast<bool>(is->read(&(*s)[0], size));
+}
+
+void WriteCacheString(std::ostream* os, const std::string& s) {
+  const uint64_t size = s.size();
+  os->write(reinterpret_cast<const char*>(&size), sizeof(size));
+  os->write(s.data(), size);
+}
+
+// Load a cached image, the stored key guards against hash collisions.
+bool LoadCachedKernel(const std::string& key, std::string* image, std::string* mangled_name) {
+  std::ifstream f(KernelCachePath(key), std::ios::binary);
+  std::string stored_key;
+  if (!f || !ReadCacheString(&f, &stored_key) || stored_key != key)
+    return false;
+  return ReadCacheString(&f, mangled_name) && ReadCacheString(&f, image);
+}
+
+void StoreCachedKernel(const std::string& key,
+                       const std::string& image,
+                       const std::string& mangled_name) {
+  const std::string path = KernelCachePath(key);
+  // Write to a temporary file and rename it, so that concurrent processes never
+  // read a partially written entry.
+  const std::string tmp_path =
+      path + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream f(tmp_path, std::ios::binary);
+    WriteCacheString(&f, key);
+    WriteCacheString(&f, mangled_name);
+    WriteCacheString(&f, image);
+    if (!f) {
+      static bool warned = false;
+      LOG_IF(WARNING, !warned) << "Could not write the compiled kernel to " << tmp_path
+                               << ", make sure that MXNET_RTC_CACHE_DIR exists and is writable";
+      warned = true;
+      f.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    std::remove(tmp_path.c_str());
+}
+
 }  // namespace
 
 CUfunction get_function(const std::string& parameters,
@@ -199,51 +299,58 @@ CUfunction get_function(const std::string& parameters,
     if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
       LOG(INFO) << "\n" << std::string(80, '-') << "\n" << (parameters + code);
     }
+    const auto [use_cubin, gpu_arch] = GetArchString(sm_arch);  // NOLINT(*)
     if (compiled_kernels_this_arch.size() == CACHESIZE_WARN_THRESHOLD + 1 &&
         dmlc::GetEnv("MXNET_RTC_SIZE_WARNING", true)) {
       LOG(WARNING) << "The number of different compiled kernels exceeds "
                    << CACHESIZE_WARN_THRESHOLD
                    << ".  Set MXNET_RTC_SIZE_WARNING=0 to quiet this warning.";
     }
-    nvrtcProgram program;
-    NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
-                                  &code_with_header[0],                  // buffer
-                                  (kernel_name + "_kernel.cu").c_str(),  // name
-                                  0,                                     // num headers
-                                  nullptr,                               // headers
-                                  nullptr));                             // include names
-    const auto [use_cubin, gpu_arch] = GetArchString(sm_arch);           // NOLINT(*)
-    std::string gpu_arch_arg         = "--gpu-architecture=" + gpu_arch;
-    const char* opts[]               = {
-      gpu_arch_arg.c_str(),
+    // A kernel compiled by an earlier process is read from the on-disk cache.
+    std::string cache_key;
+    if (!KernelCacheDir().empty())
+      cache_key = KernelCacheKey(common_header, kernel_name + "\n" + parameters + code, gpu_arch);
+    if (cache_key.empty() || !LoadCachedKernel(cache_key, &kinfo.ptx, &kinfo.mangled_name)) {
+      nvrtcProgram program;
+      NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
+                                    &code_with_header[0],                  // buffer
+                                    (kernel_name + "_kernel.cu").c_str(),  // name
+                                    0,                                     // num headers
+                                    nullptr,                               // headers
+                                    nullptr));                             // include names
+      std::string gpu_arch_arg = "--gpu-architecture=" + gpu_arch;
+      const char* opts[]       = {
+        gpu_arch_arg.c_str(),
 #if NDEBUG == 0
-      "-G",
+        "-G",
 #endif
-      "--std=c++14"
-    };
-    const std::string& kernel_name_demangled = kernel_name;
-    NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
-
-    nvrtcResult compileResult          = nvrtcCompileProgram(program,  // prog
-                                                    sizeof(opts) / sizeof(opts[0]),  // num options
-                                                    opts);  // options
-    static const std::string dump_file = "mxnet_rtc_debug_code.log";
-    if (compileResult != NVRTC_SUCCESS) {
-      std::ofstream f(dump_file);
-      f << code_with_header;
-      f.close();
+        "--std=c++14"
+      };
+      const std::string& kernel_name_demangled = kernel_name;
+      NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
+
+      nvrtcResult compileResult =
+          nvrtcCompileProgram(program, sizeof(opts) / sizeof(opts[0]), opts);
+      static const std::string dump_file = "mxnet_rtc_debug_code.log";
+      if (compileResult != NVRTC_SUCCESS) {
+        std::ofstream f(dump_file);
+        f << code_with_header;
+        f.close();
+      }
+      CHECK_EQ(compileResult, NVRTC_SUCCESS)
+          << "NVRTC Compilation failed.\n"
+          << "The generated code was stored in " << dump_file << "\n"
+          << GetCompileLog(program);
+
+      kinfo.ptx = GetCompiledCode(program, use_cubin);
+      const char* mangled_name;
+      NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
+      kinfo.mangled_name = mangled_name;
+      // Destroy the program.
+      NVRTC_CALL(nvrtcDestroyProgram(&program));
+      if (!cache_key.empty())
+        StoreCachedKernel(cache_key, kinfo.ptx, kinfo.mangled_name);
     }
-    CHECK_EQ(compileResult, NVRTC_SUCCESS)
-        << "NVRTC Compilation failed.\n"
-        << "The generated code was stored in " << dump_file << "\n"
-        << GetCompileLog(program);
-
-    kinfo.ptx = GetCompiledCode(program, use_cubin);
-    const char* mangled_name;
-    NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
-    kinfo.mangled_name = mangled_name;
-    // Destroy the program.
-    NVRTC_CALL(nvrtcDestroyProgram(&program));
   }
   // Ensure function array is deep enough to index by dev_id
   while (kinfo.functions.size() <= static_cast<size_t>(dev_id))
@@ -311,6 +311,39 @@ __device__ inline index_t unravel_dot(const index_t idx, const index_t (&shape)[
   return ret;
 }
 
+// unravel_dot computed in IType, for the kernels whose sizes fit it
+template <typename IType, int ndim>
+__device__ inline void unravel_dot(const IType idx, const index_t (&shape)[MAX_DIM],
+  const index_t (&stridej)[MAX_DIM], const index_t (&stridek)[MAX_DIM], IType* j, IType* k) {
+  *j = 0;
+  *k = 0;
+  IType idx_t = idx;
+  #pragma unroll
+  for (int i = ndim-1; i >=0; --i) {
+    const IType dim = static_cast<IType>(shape[i]);
+    const IType tmp = idx_t / dim;
+    const IType coord = idx_t - tmp*dim;
+    *j += coord*static_cast<IType>(stridej[i]);
+    *k += coord*static_cast<IType>(stridek[i]);
+    idx_t = tmp;
+  }
+}
+
+template <typename IType, int ndim>
+__device__ inline IType unravel_dot(const IType idx, const index_t (&shape)[MAX_DIM],
+  const index_t (&stride)[MAX_DIM]) {
+  IType ret = 0;
+  IType j = idx;
+  #pragma unroll
+  for (int i = ndim-1; i >=0; --i) {
+    const IType dim = static_cast<IType>(shape[i]);
+    const IType tmp = j / dim;
+    ret += (j - tmp*dim)*static_cast<IType>(stride[i]);
+    j = tmp;
+  }
+  return ret;
+}
+
 template<int ndim>
 __device__ inline index_t unravel_ravel(const index_t idx, const index_t (&shape1)[MAX_DIM],
                                         const index_t (&shape2)[MAX_DIM]) {
@@ -64,6 +64,23 @@ int get_rows_per_block(size_t row_size, int num_threads_per_block) {
   return num_threads_per_block / (warp_size * actual_num_warps_per_row);
 }
 
+namespace {
+struct ThreadStream {
+  int dev_id          = -1;
+  cudaStream_t stream = nullptr;
+};
+thread_local ThreadStream thread_stream;
+}  // namespace
+
+void SetThreadStream(int dev_id, cudaStream_t stream) {
+  thread_stream.dev_id = dev_id;
+  thread_stream.stream = stream;
+}
+
+cudaStream_t GetThreadStream(int dev_id) {
+  return thread_stream.dev_id == dev_id ? thread_stream.stream : nullptr;
+}
+
 }  // namespace cuda
 }  // namespace common
 }  // namespace mxnet
@@ -440,6 +440,18 @@ int get_load_type(size_t N);
  */
 int get_rows_per_block(size_t row_size, int num_threads_per_block);
 
+/*!
+ * \brief Register the stream on which the calling thread executes operators for
+ *  GPU dev_id. Set by the engine workers, used for stream ordered allocations.
+ */
+void SetThreadStream(int dev_id, cudaStream_t stream);
+
+/*!
+ * \brief Get the stream registered by SetThreadStream for GPU dev_id.
+ * \return the stream, nullptr if the calling thread did not register one for dev_id.
+ */
+cudaStream_t GetThreadStream(int dev_id);
+
 }  // namespace cuda
 }  // namespace common
 }  // namespace mxnet
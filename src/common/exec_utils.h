@@ -32,6 +32,7 @@
 #include <utility>
 #include "../common/utils.h"
 #include "../imperative/exec_pass.h"
+#include "../profiler/storage_fallback_profiler.h"
 
 namespace mxnet {
 namespace common {
@@ -168,12 +169,17 @@ inline void SetupDefaultBlobsInOut(const std::vector<NDArray>& ndinputs,
  * \param src list of source NDArray to cast
  * \param dst list of destionation NDArray which hold the result of cast_storage operation
  * \param ctx operator context for cast_storage operation
+ * \param op the operator the arrays are cast for, whose fallbacks the profiler records
  */
 inline void CastNonDefaultStorage(const std::vector<NDArray>& src,
                                   const std::vector<NDArray>& dst,
                                   const OpContext& ctx,
-                                  const bool is_gpu) {
+                                  const bool is_gpu,
+                                  const nnvm::Op* op = nullptr) {
   CHECK_EQ(dst.size(), src.size());
+  const bool profiling =
+      op != nullptr && !src.empty() && profiler::StorageFallbackProfiler::IsProfiling();
+  const uint64_t start = profiling ? profiler::ProfileStat::NowInMicrosec() : 0;
   for (size_t i = 0; i < src.size(); i++) {
     if (is_gpu) {
 #if MXNET_USE_CUDA
@@ -185,6 +191,18 @@ inline void CastNonDefaultStorage(const std::vector<NDArray>& src,
       CastStorageDispatch<cpu>(ctx, src[i], dst[i]);
     }
   }
+  if (profiling) {
+#if MXNET_USE_CUDA
+    // the casts are timed to their completion
+    if (is_gpu)
+      ctx.get_stream<gpu>()->Wait();
+#endif
+    uint64_t bytes = 0;
+    for (const auto& nd : src)
+      bytes += nd.shape().Size() * mshadow::mshadow_sizeof(nd.dtype());
+    profiler::StorageFallbackProfiler::Get()->AddFallback(
+        op->name, bytes, profiler::ProfileStat::NowInMicrosec() - start);
+  }
 }
 
 /*! \brief The default type inference function, which assigns all undefined
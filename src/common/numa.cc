@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.cc
+ * \brief NUMA topology discovery, thread pinning and memory binding.
+ */
+#include "./numa.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "./utils.h"
+
+namespace mxnet {
+namespace common {
+namespace numa {
+
+namespace {
+
+/*! \brief parse a kernel cpulist, e.g. "0-3,8-11" */
+std::vector<int> ParseCPUList(const std::string& list) {
+  std::vector<int> ret;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty())
+      continue;
+    const size_t dash = range.find('-');
+    const int begin   = std::stoi(range.substr(0, dash));
+    const int end     = dash == std::string::npos ? begin : std::stoi(range.substr(dash + 1));
+    for (int i = begin; i <= end; ++i) {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+/*! \brief NUMA topology of the host, discovered once */
+struct Topology {
+  std::vector<std::vector<int>> node_cpus;
+  bool enabled{false};
+
+  Topology() {
+#if defined(__linux__)
+    for (int node = 0;; ++node) {
+      std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      if (!f.is_open())
+        break;
+      std::string list;
+      std::getline(f, list);
+      node_cpus.push_back(ParseCPUList(list));
+    }
+#endif
+    if (node_cpus.empty()) {
+      node_cpus.emplace_back();
+    }
+    enabled = dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false) && node_cpus.size() > 1;
+    if (dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false) && !enabled) {
+      LOG(INFO) << "MXNET_CPU_NUMA_AWARE is set but only one NUMA node is found, ignored.";
+    }
+  }
+
+  static const Topology& Get() {
+    static Topology inst;
+    return inst;
+  }
+};
+
+}  // namespace
+
+bool Enabled() {
+  return Topology::Get().enabled;
+}
+
+int NumNodes() {
+  return static_cast<int>(Topology::Get().node_cpus.size());
+}
+
+int NodeOfDevice(int dev_id) {
+  return dev_id < 0 ? 0 : dev_id % NumNodes();
+}
+
+const std::vector<int>& NodeCPUs(int node) {
+  return Topology::Get().node_cpus.at(node);
+}
+
+bool BindCurrentThreadToNode(int node) {
+#if defined(__linux__)
+  const std::vector<int>& cpus = NodeCPUs(node);
+  if (cpus.empty())
+    return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    LOG(WARNING) << "Failed to bind thread to NUMA node " << node;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool BindMemoryToNode(void* ptr, size_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // MPOL_PREFERRED from <numaif.h>, falls back to other nodes instead of failing
+  constexpr int kMPolPreferred = 1;
+  const size_t page            = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+  const uintptr_t end   = (reinterpret_cast<uintptr_t>(ptr) + size) / page * page;
+  if (end <= begin || node >= 64)
+    return false;
+  const unsigned long nodemask = 1UL << node;  // NOLINT(runtime/int)
+  return syscall(SYS_mbind,
+                 reinterpret_cast<void*>(begin),
+                 end - begin,
+                 kMPolPreferred,
+                 &nodemask,
+                 sizeof(nodemask) * 8,
+                 0) == 0;
+#else
+  return false;
+#endif
+}
+
+bool AlignedMemAllocForDevice(void** ptr, size_t size, size_t alignment, int dev_id) {
+#if defined(__linux__)
+  if (Enabled()) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (size >= page) {
+      if (!AlignedMemAlloc(ptr, size, std::max(alignment, page)))
+        return false;
+      BindMemoryToNode(*ptr, size, NodeOfDevice(dev_id));
+      return true;
+    }
+  }
+#endif
+  return AlignedMemAlloc(ptr, size, alignment);
+}
+
+}  // namespace numa
+}  // namespace common
+}  // namespace mxnet
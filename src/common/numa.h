@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.h
+ * \brief NUMA topology discovery, thread pinning and memory binding.
+ *  CPU context dev_id is mapped to NUMA node (dev_id % NumNodes()).
+ */
+#ifndef MXNET_COMMON_NUMA_H_
+#define MXNET_COMMON_NUMA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace mxnet {
+namespace common {
+namespace numa {
+
+/*!
+ * \brief Whether NUMA aware placement is enabled (MXNET_CPU_NUMA_AWARE).
+ *  Always false when the host has a single node or on non Linux platforms.
+ */
+bool Enabled();
+/*! \return number of NUMA nodes on the host, 1 if unknown */
+int NumNodes();
+/*! \return the NUMA node serving CPU context dev_id */
+int NodeOfDevice(int dev_id);
+/*! \return the logical CPUs belonging to a node */
+const std::vector<int>& NodeCPUs(int node);
+/*!
+ * \brief Pin the calling thread to the CPUs of a node.
+ *  Threads created afterwards by this thread, e.g. its OpenMP team, inherit the affinity.
+ * \return whether the affinity was set
+ */
+bool BindCurrentThreadToNode(int node);
+/*!
+ * \brief Ask the kernel to place the pages of [ptr, ptr + size) on a node.
+ *  Partial pages at both ends are left to the default first touch policy.
+ * \return whether the policy was set
+ */
+bool BindMemoryToNode(void* ptr, size_t size, int node);
+/*!
+ * \brief Aligned allocation of memory for CPU context dev_id.
+ *  When NUMA aware placement is enabled, allocations of at least one page are
+ *  page aligned and bound to the node of the device.
+ * \return whether the allocation succeeded
+ */
+bool AlignedMemAllocForDevice(void** ptr, size_t size, size_t alignment, int dev_id);
+
+}  // namespace numa
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_NUMA_H_
@@ -20,7 +20,9 @@
 #ifndef MXNET_COMMON_OBJECT_POOL_H_
 #define MXNET_COMMON_OBJECT_POOL_H_
 #include <dmlc/logging.h>
+#include <algorithm>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -29,6 +31,9 @@ namespace mxnet {
 namespace common {
 /*!
  * \brief Object pool for fast allocation and deallocation.
+ *
+ * Each thread keeps a cache of free objects, which it takes from and returns to the shared free
+ * list in batches, so that most allocations and deallocations do not take the lock.
  */
 template <typename T>
 class ObjectPool {
@@ -84,6 +89,31 @@ class ObjectPool {
    * Currently defined to be 4KB.
    */
   constexpr static std::size_t kPageSize = 1 << 12;
+  /*!
+   * \brief Number of objects a thread cache takes from or returns to the free list at once.
+   */
+  constexpr static std::size_t kCacheBatch =
+      std::max<std::size_t>(std::min<std::size_t>(kPageSize / sizeof(LinkedList), 32), 1);
+  /*!
+   * \brief Free objects of a thread, returned to the free list when the thread exits.
+   */
+  struct ThreadCache {
+    LinkedList* head{nullptr};
+    std::size_t size{0};
+    std::shared_ptr<ObjectPool> pool;
+    ~ThreadCache();
+  };
+  /*!
+   * \brief Cache of the calling thread, null once it is destroyed at the exit of the thread.
+   */
+  static ThreadCache* LocalCache();
+  /*!
+   * \brief Whether the cache of the calling thread is destroyed.
+   */
+  static bool& CacheDestroyed() {
+    static thread_local bool destroyed = false;
+    return destroyed;
+  }
   /*! \brief internal mutex */
   std::mutex m_;
   /*!
@@ -104,6 +134,14 @@ class ObjectPool {
    * This function is not protected and must be called with caution.
    */
   void AllocateChunk();
+  /*!
+   * \brief Move up to count objects from the free list to the front of *head.
+   */
+  void TakeBatch(LinkedList** head, std::size_t count);
+  /*!
+   * \brief Move count objects from the front of *head to the free list.
+   */
+  void ReturnBatch(LinkedList** head, std::size_t count);
   DISALLOW_COPY_AND_ASSIGN(ObjectPool);
 };  // class ObjectPool
 
@@ -142,7 +180,16 @@ template <typename T>
 template <typename... Args>
 T* ObjectPool<T>::New(Args&&... args) {
   LinkedList* ret;
-  {
+  ThreadCache* cache = LocalCache();
+  if (cache != nullptr) {
+    if (cache->head == nullptr) {
+      TakeBatch(&cache->head, kCacheBatch);
+      cache->size = kCacheBatch;
+    }
+    ret         = cache->head;
+    cache->head = cache->head->next;
+    --cache->size;
+  } else {
     std::lock_guard<std::mutex> lock{m_};
     if (head_->next == nullptr) {
       AllocateChunk();
@@ -157,13 +204,63 @@ template <typename T>
 void ObjectPool<T>::Delete(T* ptr) {
   ptr->~T();
   auto linked_list_ptr = reinterpret_cast<LinkedList*>(ptr);
-  {
+  ThreadCache* cache   = LocalCache();
+  if (cache != nullptr) {
+    linked_list_ptr->next = cache->head;
+    cache->head           = linked_list_ptr;
+    if (++cache->size >= 2 * kCacheBatch) {
+      ReturnBatch(&cache->head, kCacheBatch);
+      cache->size -= kCacheBatch;
+    }
+  } else {
     std::lock_guard<std::mutex> lock{m_};
     linked_list_ptr->next = head_;
     head_                 = linked_list_ptr;
   }
 }
 
+template <typename T>
+void ObjectPool<T>::TakeBatch(LinkedList** head, std::size_t count) {
+  std::lock_guard<std::mutex> lock{m_};
+  for (std::size_t i = 0; i < count; ++i) {
+    if (head_->next == nullptr) {
+      AllocateChunk();
+    }
+    LinkedList* obj = head_;
+    head_           = head_->next;
+    obj->next       = *head;
+    *head           = obj;
+  }
+}
+
+template <typename T>
+void ObjectPool<T>::ReturnBatch(LinkedList** head, std::size_t count) {
+  std::lock_guard<std::mutex> lock{m_};
+  for (std::size_t i = 0; i < count && *head != nullptr; ++i) {
+    LinkedList* obj = *head;
+    *head           = obj->next;
+    obj->next       = head_;
+    head_           = obj;
+  }
+}
+
+template <typename T>
+ObjectPool<T>::ThreadCache::~ThreadCache() {
+  CacheDestroyed() = true;
+  pool->ReturnBatch(&head, size);
+}
+
+template <typename T>
+typename ObjectPool<T>::ThreadCache* ObjectPool<T>::LocalCache() {
+  if (CacheDestroyed())
+    return nullptr;
+  static thread_local ThreadCache cache;
+  if (!cache.pool) {
+    cache.pool = _GetSharedRef();
+  }
+  return &cache;
+}
+
 template <typename T>
 ObjectPool<T>* ObjectPool<T>::Get() {
   return _GetSharedRef().get();
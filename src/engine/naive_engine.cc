@@ -31,6 +31,7 @@
 #include "./openmp.h"
 #include "../common/object_pool.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../storage/spill_manager.h"
 
 namespace mxnet {
 namespace engine {
@@ -154,6 +155,8 @@ class NaiveEngine final : public Engine {
                  int priority         = 0,
                  const char* opr_name = nullptr,
                  bool wait            = false) override {
+    if (storage::SpillManager::Active())
+      storage::SpillManager::Get()->OnPush(const_vars, mutable_vars);
     std::promise<void> promise;
     std::future<void> future     = promise.get_future();
     CallbackOnComplete callback  = CreateCallback(NaiveEngine::OnComplete, &promise);
@@ -161,6 +164,7 @@ class NaiveEngine final : public Engine {
     auto opr_deleter             = [this](NaiveOpr* p) { this->DeleteOperator(p); };
     std::unique_ptr<NaiveOpr, decltype(opr_deleter)> opr(nullptr, opr_deleter);
     const bool profiling = opr_name && profiler->IsProfiling(profiler::Profiler::kImperative);
+    const profiler::OperatorCost cost = profiler::OperatorCost::ThreadNext()->Take();
     // GenerateDisplayName() will return a pointer to the correct name of the operator
     const char* display_name =
         profiling ? profiler::CustomOpProfiler::Get()->GenerateDisplayName(opr_name) : opr_name;
@@ -174,8 +178,10 @@ class NaiveEngine final : public Engine {
       }
       opr->opr_profile =
           std::make_unique<profiler::ProfileOperator>(opr->opr_name.c_str(), attrs.release());
+      opr->opr_profile->SetCost(cost);
       opr->opr_profile->startForDevice(exec_ctx.dev_type, exec_ctx.dev_id);
     }
+    profiler::RunningOperatorScope running_opr(opr_name);
     if (exec_ctx.dev_mask() == gpu::kDevMask) {
 #if MXNET_USE_CUDA
       size_t dev_id = static_cast<size_t>(exec_ctx.dev_id);
@@ -19,8 +19,10 @@
 #include <dmlc/omp.h>
 #include <dmlc/base.h>
 #include <dmlc/parameter.h>
+#include <algorithm>
 #include <climits>
 #include "./openmp.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace engine {
@@ -33,12 +35,22 @@ static inline bool is_env_set(const char* var) {
   return dmlc::GetEnv(var, INT_MIN) != INT_MIN;
 }
 
+/*! \brief the NUMA node the thread is pinned to, -1 if it is not pinned */
+static thread_local int numa_node_of_thread = -1;
+/*! \brief whether the thread holds a share of the remaining cores */
+static thread_local bool thread_in_share = false;
+
 OpenMP* OpenMP::Get() {
   static OpenMP openMP;
   return &openMP;
 }
 
-OpenMP::OpenMP() : omp_num_threads_set_in_environment_(is_env_set("OMP_NUM_THREADS")) {
+OpenMP::OpenMP()
+    : omp_num_threads_set_in_environment_(is_env_set("OMP_NUM_THREADS")),
+      share_cores_(dmlc::GetEnv("MXNET_OMP_SHARE_CORES", true)) {
+  for (std::atomic<int>& shares : shares_) {
+    shares.store(0);
+  }
 #ifdef _OPENMP
   initialize_process();
   const int max = dmlc::GetEnv("MXNET_OMP_MAX_THREADS", INT_MIN);
@@ -75,6 +87,23 @@ void OpenMP::on_start_worker_thread(bool use_omp) {
 #endif
 }
 
+void OpenMP::on_start_worker_thread(bool use_omp, int numa_node) {
+  numa_node_of_thread = numa_node;
+  if (!use_omp || numa_node < 0) {
+    on_start_worker_thread(use_omp);
+    return;
+  }
+#ifdef _OPENMP
+  if (!omp_num_threads_set_in_environment_) {
+    int node_threads = static_cast<int>(common::numa::NodeCPUs(numa_node).size());
+#ifdef ARCH_IS_INTEL_X86
+    node_threads >>= 1;
+#endif
+    omp_set_num_threads(std::max(1, std::min(GetRecommendedOMPThreadCount(true), node_threads)));
+  }
+#endif
+}
+
 void OpenMP::set_reserve_cores(int cores) {
   CHECK_GE(cores, 0);
   reserve_cores_ = cores;
@@ -103,10 +132,17 @@ int OpenMP::GetRecommendedOMPThreadCount(bool exclude_reserved) const {
       }
     }
     // Check that OMP doesn't suggest more than our 'omp_thread_max_' value
-    if (!omp_thread_max_ || thread_count < omp_thread_max_) {
-      return thread_count;
+    if (omp_thread_max_ && thread_count > omp_thread_max_) {
+      thread_count = omp_thread_max_;
     }
-    return omp_thread_max_;
+    if (thread_in_share) {
+      // the cores left by the fixed shares, split between the threads running ops
+      const int node   = std::min(numa_node_of_thread + 1, kShareNodes);
+      const int shares = std::max(shares_[node].load(std::memory_order_relaxed), 1);
+      const int left   = thread_count - fixed_share_threads_.load(std::memory_order_relaxed);
+      thread_count     = std::max((left + shares / 2) / shares, 1);
+    }
+    return thread_count;
   } else {
     return 1;
   }
@@ -115,6 +151,35 @@ int OpenMP::GetRecommendedOMPThreadCount(bool exclude_reserved) const {
 #endif
 }
 
+OpenMP::CoreShare::CoreShare(const int threads) : threads_(threads) {
+  OpenMP* omp = OpenMP::Get();
+  if (!omp->share_cores_ || omp->omp_num_threads_set_in_environment_ || thread_in_share) {
+    return;
+  }
+  counted_ = true;
+  if (threads_ > 0) {
+    omp->fixed_share_threads_.fetch_add(threads_, std::memory_order_relaxed);
+  } else {
+    thread_in_share = true;
+    omp->shares_[std::min(numa_node_of_thread + 1, kShareNodes)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+}
+
+OpenMP::CoreShare::~CoreShare() {
+  if (!counted_) {
+    return;
+  }
+  OpenMP* omp = OpenMP::Get();
+  if (threads_ > 0) {
+    omp->fixed_share_threads_.fetch_sub(threads_, std::memory_order_relaxed);
+  } else {
+    thread_in_share = false;
+    omp->shares_[std::min(numa_node_of_thread + 1, kShareNodes)].fetch_sub(
+        1, std::memory_order_relaxed);
+  }
+}
+
 OpenMP* __init_omp__ = OpenMP::Get();
 
 }  // namespace engine
@@ -19,6 +19,8 @@
 #ifndef MXNET_ENGINE_OPENMP_H_
 #define MXNET_ENGINE_OPENMP_H_
 
+#include <atomic>
+
 namespace mxnet {
 namespace engine {
 
@@ -84,6 +86,36 @@ class OpenMP {
    */
   void on_start_worker_thread(bool use_omp);
 
+  /*!
+   * \brief Call at the beginning of a worker thread's life which is pinned to a NUMA node.
+   *        The omp team of this thread is limited to the cores of that node
+   * \param use_omp true if this thread plans to utilize parallel omp regions
+   * \param numa_node the node the thread is pinned to, -1 if it is not pinned
+   */
+  void on_start_worker_thread(bool use_omp, int numa_node);
+
+  /*!
+   * \brief Claims a share of the cores while in scope, so that the threads running OMP regions
+   *        concurrently split the cores instead of each starting a full team.
+   *        With a thread count, the share is fixed, e.g. the decoding threads of the data
+   *        iterators. Without, the team of GetRecommendedOMPThreadCount() in this thread is the
+   *        cores left by the fixed shares, divided by the shares of the other threads of the
+   *        same NUMA node running ops, e.g. the CPU engine workers.
+   */
+  class CoreShare {
+   public:
+    explicit CoreShare(int threads = 0);
+    ~CoreShare();
+    CoreShare(const CoreShare&) = delete;
+    CoreShare& operator=(const CoreShare&) = delete;
+
+   private:
+    /*! \brief the fixed thread count, 0 for a share of the remaining cores */
+    const int threads_;
+    /*! \brief whether the share is counted, not nested in another share of the thread */
+    bool counted_ = false;
+  };
+
   /*!
    * \brief Initialize a new process to use omp (after a fork,
    *        in case you're starting threads in the atfork() that may interfere
@@ -116,6 +148,14 @@ class OpenMP {
    *        the OMP's implementation's handling of that environment variable
    */
   const bool omp_num_threads_set_in_environment_;
+  /*! \brief Whether the threads running OMP regions split the cores, MXNET_OMP_SHARE_CORES */
+  const bool share_cores_;
+  /*! \brief Number of NUMA nodes whose shares are counted apart, the others share the last */
+  static constexpr int kShareNodes = 8;
+  /*! \brief Number of shares of the remaining cores, by NUMA node + 1 (0 if not pinned) */
+  std::atomic<int> shares_[kShareNodes + 1];
+  /*! \brief Number of threads of the fixed shares */
+  std::atomic<int> fixed_share_threads_{0};
 };
 
 }  // namespace engine
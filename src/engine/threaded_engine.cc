@@ -30,6 +30,7 @@
 #include <utility>
 #include "./threaded_engine.h"
 #include "../common/cuda/utils.h"
+#include "../storage/spill_manager.h"
 
 namespace mxnet {
 namespace engine {
@@ -41,20 +42,23 @@ std::atomic<std::size_t> ThreadedVar::counter{0};
 std::atomic<std::size_t> ThreadedOpr::counter{0};
 #endif  // ENGINE_DEBUG
 
-ThreadedVar::ThreadedVar(VersionedVarBlock* head) : head_{head} {
+ThreadedVar::ThreadedVar(VersionedVarBlock* head, bool lock_free)
+    : head_{head}, lock_free_{lock_free} {
 #if ENGINE_DEBUG
   LOG(INFO) << __func__ << " " << ++counter;
 #endif  // ENGINE_DEBUG
 }
 
 inline void ThreadedVar::AppendReadDependency(OprBlock* opr_block) {
+  // fast path: no write is queued, only bump the pending read count
+  if (lock_free_ && TryAppendRead()) {
+    opr_block->decr_wait();
+    return;
+  }
   std::lock_guard<std::mutex> lock{mutex_};
-  if (pending_write_ == nullptr) {
+  // kWriteQueued cannot change while holding the lock
+  if (TryAppendRead()) {
     // invariant: is_ready_to_read()
-    CHECK_GE(num_pending_reads_, 0);
-    // STATE CHANGE
-    ++num_pending_reads_;
-    // decrease wait counter
     opr_block->decr_wait();
   } else {
     auto&& new_var_block = VersionedVarBlock::New();
@@ -83,34 +87,51 @@ inline void ThreadedVar::AppendWriteDependency(OprBlock* opr_block) {
   // check if it is ready to write
   if (pending_write_ == nullptr) {
     // invariant: is_ready_to_read()
-    pending_write_ = head_;
-    CHECK_GE(num_pending_reads_, 0);
-    if (num_pending_reads_ == 0) {
+    // pending_write_ must be visible before readers can observe kWriteQueued
+    pending_write_     = head_;
+    const int64_t prev = state_.fetch_or(kWriteQueued, std::memory_order_acq_rel);
+    CHECK_GE(prev, 0);
+    if ((prev & kReadMask) == 0) {
       // STATE CHANGE
       opr_block->decr_wait();
-      num_pending_reads_ = kWriteTriggered;
     }
-  } else {
-    CHECK_NE(num_pending_reads_, 0);
   }
   head_ = new_var_block;
 }
 
+inline void ThreadedVar::AppendProfileDependency(OprBlock* opr_block, bool write) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::vector<uint64_t>* deps = &opr_block->profile_deps;
+  if (!write) {
+    if (profile_writer_ != 0)
+      deps->push_back(profile_writer_);
+    if (profile_readers_.size() == kMaxProfileReaders)
+      profile_readers_.erase(profile_readers_.begin());
+    profile_readers_.push_back(opr_block->profile_id);
+    return;
+  }
+  if (profile_readers_.empty() && profile_writer_ != 0)
+    deps->push_back(profile_writer_);
+  deps->insert(deps->end(), profile_readers_.begin(), profile_readers_.end());
+  profile_readers_.clear();
+  profile_writer_ = opr_block->profile_id;
+}
+
 template <typename Dispatcher>
 inline void ThreadedVar::CompleteReadDependency(Dispatcher dispatcher) {
   OprBlock* trigger = nullptr;
-  {
-    // this is lock scope
+  int64_t prev;
+  if (lock_free_) {
+    prev = state_.fetch_sub(1, std::memory_order_acq_rel);
+  } else {
     std::lock_guard<std::mutex> lock{mutex_};
-    CHECK_GT(num_pending_reads_, 0);
-
-    if (--num_pending_reads_ == 0) {
-      if (pending_write_ != nullptr) {
-        // STATE CHANGE
-        trigger            = pending_write_->trigger;
-        num_pending_reads_ = kWriteTriggered;
-      }
-    }
+    prev = state_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+  CHECK_GT(prev & kReadMask, 0);
+  if (prev == (kWriteQueued | 1)) {
+    // STATE CHANGE: last pending read, the queued write is now triggered.
+    // pending_write_ is stable until that write completes.
+    trigger = pending_write_->trigger;
   }
   if (trigger != nullptr && trigger->decr_wait() == 0) {
     dispatcher(trigger);
@@ -127,7 +148,7 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
     // invariants
     assert(head_->next == nullptr);
     assert(pending_write_ != nullptr);
-    CHECK_EQ(num_pending_reads_, kWriteTriggered);
+    CHECK_EQ(state_.load(std::memory_order_relaxed), kWriteQueued);
 
     // increment version number
     ++version_;
@@ -144,27 +165,28 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
     old_pending_write = pending_write_;
     // search for chains to trigger
     end_of_read_chain = old_pending_write->next;
-    // reset to 0 pending reads
-    num_pending_reads_ = 0;
+    // count the reads to trigger
+    int64_t num_pending_reads = 0;
     while (end_of_read_chain != head_ && end_of_read_chain->write == false) {
-      ++num_pending_reads_;
+      ++num_pending_reads;
       end_of_read_chain = end_of_read_chain->next;
     }
     if (end_of_read_chain == head_) {
       pending_write_ = nullptr;
+      state_.store(num_pending_reads, std::memory_order_release);
     } else {
       // check if there is pending reads, if not trigger write
       assert(end_of_read_chain->write == true);
       pending_write_ = end_of_read_chain;
-      if (num_pending_reads_ == 0) {
-        // mark write as already activated in this var
-        num_pending_reads_ = kWriteTriggered;
-        trigger_write      = end_of_read_chain->trigger;
+      state_.store(kWriteQueued | num_pending_reads, std::memory_order_release);
+      if (num_pending_reads == 0) {
+        // write is already activated in this var
+        trigger_write = end_of_read_chain->trigger;
       }
     }
   }
   // This is outside of lock scope
-  // Be very carful, pending_write_ and num_pending_reads_
+  // Be very carful, pending_write_ and state_
   // can change now, do not rely on these two variables.
   // The linked list \in [old_pending_write, end_of_read_chain)
   // is already detached from this Var.
@@ -193,8 +215,7 @@ inline void ThreadedVar::SetToDelete() {
 }
 
 inline bool ThreadedVar::ready_to_read() {
-  std::lock_guard<std::mutex> lock{mutex_};
-  return this->is_ready_to_read();
+  return !(state_.load(std::memory_order_acquire) & kWriteQueued);
 }
 
 inline size_t ThreadedVar::version() {
@@ -203,8 +224,11 @@ inline size_t ThreadedVar::version() {
 }
 
 // implementation of threaded engine
+MX_THREAD_LOCAL int ThreadedEngine::thread_priority_ = 0;
+MX_THREAD_LOCAL ThreadedEngine::OprTape* ThreadedEngine::tape_ = nullptr;
+
 ThreadedVar* ThreadedEngine::NewVariable() {
-  return ThreadedVar::New(VersionedVarBlock::New());
+  return ThreadedVar::New(VersionedVarBlock::New(), lock_free_vars_);
 }
 
 ThreadedOpr* ThreadedEngine::NewOperator(ThreadedEngine::AsyncFn fn,
@@ -287,6 +311,14 @@ void ThreadedEngine::DeleteOperator(OprHandle op) {
 void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool profiling) {
   BulkFlush();
   ThreadedOpr* threaded_opr = ThreadedOpr::CastFromBase(op);
+  if (storage::SpillManager::Active()) {
+    // restores of spilled arrays are pushed before the operator that reads them
+    std::vector<VarHandle> const_vars(threaded_opr->const_vars.begin(),
+                                      threaded_opr->const_vars.end());
+    std::vector<VarHandle> mutable_vars(threaded_opr->mutable_vars.begin(),
+                                        threaded_opr->mutable_vars.end());
+    storage::SpillManager::Get()->OnPush(const_vars, mutable_vars);
+  }
   if (profiling) {
     threaded_opr->opr_name =
         profiler::CustomOpProfiler::Get()->GenerateDisplayName(threaded_opr->opr_name.c_str());
@@ -297,9 +329,23 @@ void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool pro
   opr_block->wait.store(
       static_cast<int>(threaded_opr->const_vars.size() + threaded_opr->mutable_vars.size() + 1));
   opr_block->ctx       = exec_ctx;
-  opr_block->priority  = priority;
+  opr_block->priority  = priority + thread_priority_;
   opr_block->profiling = profiling;
+  opr_block->trace     = profiler::RequestTracer::Current();
+  if (opr_block->trace)
+    opr_block->trace_push = profiler::ProfileStat::NowInMicrosec();
   ++pending_;
+  num_pushed_.fetch_add(1, std::memory_order_relaxed);
+  if (profiling && threaded_opr->opr_name.size()) {
+    // record the edges of the dependency graph emitted in the traces
+    opr_block->profile_id = profile_opr_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+    for (auto&& i : threaded_opr->const_vars) {
+      i->AppendProfileDependency(opr_block, false);
+    }
+    for (auto&& i : threaded_opr->mutable_vars) {
+      i->AppendProfileDependency(opr_block, true);
+    }
+  }
   // Add read dependencies.
   for (auto&& i : threaded_opr->const_vars) {
     i->AppendReadDependency(opr_block);
@@ -335,11 +381,94 @@ void ThreadedEngine::PushAsync(AsyncFn fn,
   }
 #endif
   const bool profiling = profiler_->IsProfiling(profiler::Profiler::kImperative);
-  ThreadedOpr* opr     = NewOperator(std::move(fn), const_vars, mutable_vars, prop, opr_name, wait);
-  opr->temporary       = true;
+  ThreadedOpr* opr     = nullptr;
+  // the profiler renames the operators, they are not taped
+  if (tape_ != nullptr && tape_->running && !profiling)
+    opr = TapeOperator(&fn, const_vars, mutable_vars, prop, opr_name, wait);
+  if (opr == nullptr) {
+    opr            = NewOperator(std::move(fn), const_vars, mutable_vars, prop, opr_name, wait);
+    opr->temporary = true;
+  }
+  opr->cost = profiler::OperatorCost::ThreadNext()->Take();
   Push(opr, exec_ctx, priority, profiling);
 }
 
+ThreadedOpr* ThreadedEngine::TapeOperator(AsyncFn* fn,
+                                          std::vector<VarHandle> const& const_vars,
+                                          std::vector<VarHandle> const& mutable_vars,
+                                          FnProperty prop,
+                                          const char* opr_name,
+                                          bool wait) {
+  const size_t pos = tape_->pos++;
+  if (pos < tape_->oprs.size()) {
+    ThreadedOpr* opr = tape_->oprs[pos];
+    if (opr->prop == prop && opr->wait == wait && opr->const_vars.size() == const_vars.size() &&
+        opr->mutable_vars.size() == mutable_vars.size() &&
+        opr->opr_name == (opr_name ? opr_name : "")) {
+      int idle = 0;
+      // the operator of the previous round is still running, push a temporary one
+      if (!opr->tape_state.compare_exchange_strong(idle, 1, std::memory_order_acquire))
+        return nullptr;
+      opr->fn = std::move(*fn);
+      std::transform(
+          const_vars.begin(), const_vars.end(), opr->const_vars.begin(), ThreadedVar::CastFromBase);
+      std::transform(mutable_vars.begin(),
+                     mutable_vars.end(),
+                     opr->mutable_vars.begin(),
+                     ThreadedVar::CastFromBase);
+      if (ENGINE_DEBUG != 0) {
+        CheckDuplicate(const_vars, mutable_vars);
+      }
+      tape_reused_.fetch_add(1, std::memory_order_relaxed);
+      return opr;
+    }
+    // the sequence of operations changed, record this one instead
+    ReleaseTapeOperator(opr);
+  }
+  ThreadedOpr* opr = NewOperator(std::move(*fn), const_vars, mutable_vars, prop, opr_name, wait);
+  opr->taped       = true;
+  opr->tape_state.store(1, std::memory_order_relaxed);
+  if (pos < tape_->oprs.size()) {
+    tape_->oprs[pos] = opr;
+  } else {
+    tape_->oprs.push_back(opr);
+  }
+  tape_recorded_.fetch_add(1, std::memory_order_relaxed);
+  return opr;
+}
+
+void ThreadedEngine::ReleaseTapeOperator(ThreadedOpr* opr) {
+  int state = opr->tape_state.load(std::memory_order_acquire);
+  while (true) {
+    if (state == 0) {
+      if (opr->tape_state.compare_exchange_weak(state, 2, std::memory_order_acquire)) {
+        ThreadedOpr::Delete(opr);
+        return;
+      }
+    } else if (opr->tape_state.compare_exchange_weak(state, 2, std::memory_order_acq_rel)) {
+      // deleted by OnComplete
+      return;
+    }
+  }
+}
+
+bool ThreadedEngine::set_tape(int mode) {
+  if (tape_ == nullptr)
+    tape_ = new OprTape();
+  const bool running = tape_->running;
+  // a running round keeps its position
+  if (running && mode > 0)
+    return running;
+  tape_->running = mode > 0;
+  tape_->pos     = 0;
+  if (mode < 0) {
+    for (ThreadedOpr* opr : tape_->oprs)
+      ReleaseTapeOperator(opr);
+    tape_->oprs.clear();
+  }
+  return running;
+}
+
 void ThreadedEngine::PushSync(SyncFn exec_fn,
                               Context exec_ctx,
                               std::vector<VarHandle> const& const_vars,
@@ -347,7 +476,19 @@ void ThreadedEngine::PushSync(SyncFn exec_fn,
                               FnProperty prop,
                               int priority,
                               const char* opr_name) {
-  if (!bulk_size() || prop != FnProperty::kNormal || priority) {
+  // bulked operators reach Push only when the bulk is flushed
+  if (storage::SpillManager::Active())
+    storage::SpillManager::Get()->OnPush(const_vars, mutable_vars);
+  const int user_bulk_size = bulk_size();
+  if (!user_bulk_size && adaptive_bulk_ && prop == FnProperty::kNormal && !priority &&
+      opr_name != nullptr) {
+    const profiler::Profiler* prof = profiler::Profiler::Get();
+    if (!(prof && prof->AggregateRunning())) {
+      PushSyncAdaptive(exec_fn, exec_ctx, const_vars, mutable_vars, opr_name);
+      return;
+    }
+  }
+  if (!user_bulk_size || prop != FnProperty::kNormal || priority) {
     this->PushAsync(
         [exec_fn](RunContext ctx, CallbackOnComplete on_complete) {
           exec_fn(ctx);
@@ -365,10 +506,83 @@ void ThreadedEngine::PushSync(SyncFn exec_fn,
   const BulkStatus& bulk_status = *BulkStatusStore::Get();
   if (bulk_status.count && exec_ctx != bulk_status.ctx)
     BulkFlush();
-  BulkAppend(exec_fn, exec_ctx, const_vars, mutable_vars);
+  BulkAppend(exec_fn, exec_ctx, const_vars, mutable_vars, bulk_status.bulk_size);
+}
+
+void ThreadedEngine::PushSyncAdaptive(SyncFn exec_fn,
+                                      Context exec_ctx,
+                                      std::vector<VarHandle> const& const_vars,
+                                      std::vector<VarHandle> const& mutable_vars,
+                                      const char* opr_name) {
+  AdaptiveBulkStat* stat = GetAdaptiveBulkStat(opr_name);
+  // keep timing bulked operators as well, so that their cost estimate stays fresh
+  SyncFn timed_fn = TimedSyncFn(std::move(exec_fn), stat);
+  if (!IsCheapOperator(stat)) {
+    adaptive_bulk_timed_.fetch_add(1, std::memory_order_relaxed);
+    // Push flushes the pending bulk first, so the order of operators is kept
+    this->PushAsync(
+        [timed_fn](RunContext ctx, CallbackOnComplete on_complete) {
+          timed_fn(ctx);
+          on_complete();
+        },
+        exec_ctx,
+        const_vars,
+        mutable_vars,
+        FnProperty::kNormal,
+        0,
+        opr_name);
+    return;
+  }
+  BulkStatus& bulk_status = *BulkStatusStore::Get();
+  if (bulk_status.count && exec_ctx != bulk_status.ctx)
+    BulkFlush();
+  bulk_status.adaptive = true;
+  BulkAppend(timed_fn, exec_ctx, const_vars, mutable_vars, adaptive_bulk_size_);
+}
+
+ThreadedEngine::AdaptiveBulkStat* ThreadedEngine::GetAdaptiveBulkStat(const char* opr_name) {
+  // operator names usually point to the name of a registered nnvm::Op,
+  // so a per thread cache by pointer avoids taking the lock on every push.
+  static MX_THREAD_LOCAL std::unordered_map<const char*, AdaptiveBulkStat*>* cache = nullptr;
+  if (cache == nullptr) {
+    cache = new std::unordered_map<const char*, AdaptiveBulkStat*>();
+  }
+  auto it = cache->find(opr_name);
+  if (it != cache->end() && it->second->name == opr_name) {
+    return it->second;
+  }
+  static std::mutex mutex;
+  static auto* stats = new std::unordered_map<std::string, std::unique_ptr<AdaptiveBulkStat>>();
+  AdaptiveBulkStat* stat;
+  {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& entry = (*stats)[opr_name];
+    if (!entry) {
+      entry.reset(new AdaptiveBulkStat(opr_name));
+    }
+    stat = entry.get();
+  }
+  (*cache)[opr_name] = stat;
+  return stat;
 }
 
 void ThreadedEngine::DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandle var) {
+  if (delete_batch_size_ > 1) {
+    // deletions are batched, the pending ones are pushed before any wait
+    DeleteBatch full;
+    {
+      std::lock_guard<std::mutex> lock{delete_batch_m_};
+      if (!delete_batch_.vars.empty() && delete_batch_.ctx != exec_ctx)
+        std::swap(full, delete_batch_);
+      delete_batch_.ctx = exec_ctx;
+      delete_batch_.delete_fns.push_back(std::move(delete_fn));
+      delete_batch_.vars.push_back(var);
+      if (full.vars.empty() && delete_batch_.vars.size() >= delete_batch_size_)
+        std::swap(full, delete_batch_);
+    }
+    PushDeleteBatch(&full);
+    return;
+  }
   ThreadedVar* threaded_var = ThreadedVar::CastFromBase(var);
   this->PushAsync(
       [delete_fn, threaded_var](RunContext ctx, CallbackOnComplete on_complete) {
@@ -386,8 +600,46 @@ void ThreadedEngine::DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandl
       "DeleteVariable");
 }
 
+void ThreadedEngine::DeleteFlush() {
+  if (delete_batch_size_ <= 1)
+    return;
+  DeleteBatch batch;
+  {
+    std::lock_guard<std::mutex> lock{delete_batch_m_};
+    std::swap(batch, delete_batch_);
+  }
+  PushDeleteBatch(&batch);
+}
+
+void ThreadedEngine::PushDeleteBatch(DeleteBatch* batch) {
+  if (batch->vars.empty())
+    return;
+  std::vector<ThreadedVar*> threaded_vars;
+  threaded_vars.reserve(batch->vars.size());
+  for (VarHandle var : batch->vars)
+    threaded_vars.push_back(ThreadedVar::CastFromBase(var));
+  auto delete_fns = std::make_shared<std::vector<SyncFn>>(std::move(batch->delete_fns));
+  this->PushAsync(
+      [delete_fns, threaded_vars](RunContext ctx, CallbackOnComplete on_complete) {
+        // Mark the variables as orphans,
+        // so during `ThreadedEngine::OnComplete` they could be recycled.
+        for (ThreadedVar* var : threaded_vars)
+          var->SetToDelete();
+        for (const SyncFn& delete_fn : *delete_fns)
+          delete_fn(ctx);
+        on_complete();
+      },
+      batch->ctx,
+      {},
+      batch->vars,
+      FnProperty::kDeleteVar,
+      0,
+      "DeleteVariables");
+}
+
 void ThreadedEngine::WaitForVar(VarHandle var) {
   BulkFlush();
+  DeleteFlush();
   ThreadedVar* threaded_var = ThreadedVar::CastFromBase(var);
   if (threaded_var->ready_to_read()) {
     ThrowException(threaded_var);
@@ -430,6 +682,7 @@ void ThreadedEngine::WaitForVar(VarHandle var) {
 
 void ThreadedEngine::WaitForAll() {
   BulkFlush();
+  DeleteFlush();
   std::unique_lock<std::mutex> lock{finished_m_};
   finished_cv_.wait(lock, [this]() { return pending_.load() == 0 || kill_.load(); });
   std::exception_ptr exception_to_rethrow = nullptr;
@@ -453,6 +706,7 @@ void ThreadedEngine::WaitForAll() {
 
 inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
   bool is_temporary_opr = threaded_opr->temporary;
+  bool is_taped_opr     = threaded_opr->taped;
   // Mark complete for read variables
   for (auto&& i : threaded_opr->const_vars) {
     i->CompleteReadDependency([this](OprBlock* opr) { this->PushToExecute(opr, false); });
@@ -501,6 +755,16 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
   // delete operator if it is temperory
   if (is_temporary_opr) {
     ThreadedOpr::Delete(threaded_opr);
+  } else if (is_taped_opr) {
+    // release what the function holds before the tape can reuse the operator
+    threaded_opr->fn = nullptr;
+    threaded_opr->opr_exception.reset();
+    int pushed = 1;
+    if (!threaded_opr->tape_state.compare_exchange_strong(
+            pushed, 0, std::memory_order_acq_rel)) {
+      // dropped by the tape while running
+      ThreadedOpr::Delete(threaded_opr);
+    }
   }
 }
 
@@ -528,6 +792,18 @@ void ThreadedEngine::OnCompleteStatic(Engine* engine, void* opr_block_, const dm
   if (opr_block->profiling && threaded_opr->opr_name.size()) {
     // record operator end timestamp
     opr_block->opr_profile->stop();
+  } else if (opr_block->sample_start != 0) {
+    profiler::SamplingProfiler::Get()->Record(
+        threaded_opr->opr_name, profiler::ProfileStat::NowInMicrosec() - opr_block->sample_start);
+    opr_block->sample_start = 0;
+  }
+  if (opr_block->trace && threaded_opr->opr_name.size()) {
+    opr_block->trace->AddOperator(threaded_opr->opr_name,
+                                  opr_block->ctx,
+                                  opr_block->trace_push,
+                                  opr_block->trace_ready,
+                                  opr_block->trace_start,
+                                  profiler::ProfileStat::NowInMicrosec());
   }
   static_cast<ThreadedEngine*>(engine)->OnComplete(threaded_opr);
   OprBlock::Delete(opr_block);
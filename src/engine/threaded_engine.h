@@ -30,19 +30,24 @@
 #include <dmlc/logging.h>
 #include <dmlc/omp.h>
 #include <mxnet/storage.h>
+#include <algorithm>
 #include <vector>
 #include <functional>
 #include <condition_variable>
 #include <atomic>
 #include <utility>
+#include <chrono>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include "./engine_impl.h"
 #include "../profiler/profiler.h"
 #include "./openmp.h"
 #include "../common/object_pool.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../profiler/sampling_profiler.h"
+#include "../profiler/request_tracer.h"
 
 namespace mxnet {
 namespace engine {
@@ -86,6 +91,16 @@ struct OprBlock : public common::ObjectPoolAllocatable<OprBlock> {
   bool profiling{false};
   /*! \brief operator execution statistics */
   std::unique_ptr<profiler::ProfileOperator> opr_profile;
+  /*! \brief start time in microseconds when the execution is sampled, otherwise 0 */
+  uint64_t sample_start{0};
+  /*! \brief id of the operator in the profiler traces, 0 when not profiled */
+  uint64_t profile_id{0};
+  /*! \brief ids of the profiled operators that this operator waits for */
+  std::vector<uint64_t> profile_deps;
+  /*! \brief trace of the request this operator was pushed for, or null */
+  std::shared_ptr<profiler::RequestTrace> trace;
+  /*! \brief times in microseconds it was pushed, ready to run and started, when traced */
+  uint64_t trace_push{0}, trace_ready{0}, trace_start{0};
   // define possible debug information
   DEFINE_ENGINE_DEBUG_INFO(OprBlock);
   /*!
@@ -96,6 +111,8 @@ struct OprBlock : public common::ObjectPoolAllocatable<OprBlock> {
     // check invariant, avoid over trigger
     const int ret = --wait;
     CHECK_GE(ret, 0);
+    if (ret == 0 && trace)
+      trace_ready = profiler::ProfileStat::NowInMicrosec();
     return ret;
   }
 };  // struct OprBlock
@@ -118,6 +135,11 @@ struct VersionedVarBlock : public common::ObjectPoolAllocatable<VersionedVarBloc
 /*!
  * \brief Variable implementation.
  *  Each ThreadedVar is a linked list(queue) of operations to be performed.
+ *
+ *  The number of pending reads and whether a write is queued are packed
+ *  into one atomic state word. In lock free mode, appending a read while no
+ *  write is queued and completing a read are a single CAS/fetch_sub, the mutex
+ *  is only taken when the linked list has to be modified.
  */
 class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<ThreadedVar> {
  public:
@@ -125,8 +147,9 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * \brief constructor
    * \param head head block of the LinkedList,
    *             need to be initialized with next==nullptr and trigger=nullptr.
+   * \param lock_free whether reads can skip the mutex.
    */
-  explicit ThreadedVar(VersionedVarBlock* head);
+  explicit ThreadedVar(VersionedVarBlock* head, bool lock_free = true);
   /*!
    * \brief Schedule a read operation on this variable.
    *  If the opr_block can be runed right away,
@@ -143,6 +166,14 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * \param opr_block The operation to be scheduled.
    */
   inline void AppendWriteDependency(OprBlock* opr_block);
+  /*!
+   * \brief Record the profiled operators that a profiled operation waits for on this
+   *  variable, the last write for a read, and the reads since the last write (or the last
+   *  write if there was none) for a write.
+   * \param opr_block The operation to be scheduled, with its profile_id set.
+   * \param write Whether the operation writes this variable.
+   */
+  inline void AppendProfileDependency(OprBlock* opr_block, bool write);
   /*!
    * \brief A read operation is completed on this variable.
    *  This function may trigger subsequent waiting operations on this variable.
@@ -190,17 +221,24 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * exception_ptr is undefined behavior. Using shared_ptr to hold
    * exception_ptr and overcome this limitation */
   ExceptionRef var_exception;
+  /*!
+   * \brief id of the CPU worker that last started a write on this variable,
+   *  -1 if unknown. Only used as a scheduling hint, so relaxed ordering is enough.
+   */
+  std::atomic<int> worker_hint{-1};
 
  private:
-  // TODO(hotpxl) change this to spinlock for faster runtime
   // TODO(hotpxl) consider rename head
-  /*! \brief internal mutex of the ThreadedVar */
+  /*! \brief internal mutex of the ThreadedVar, protects the linked list */
   std::mutex mutex_;
   /*!
-   * \brief number of pending reads operation in the variable.
-   *  will be marked as -1 when there is a already triggered pending write.
+   * \brief state of the variable.
+   *  The lower bits hold the number of pending reads,
+   *  kWriteQueued is set iff pending_write_ != nullptr.
+   *  The value kWriteQueued alone means the pending write is triggered.
+   *  kWriteQueued is only modified while holding mutex_.
    */
-  int num_pending_reads_{0};
+  std::atomic<int64_t> state_{0};
   /*!
    * \brief Points to the last VersionedVarBlock in the queue.
    *  head_ always points to a empty VersionedVarBlock.
@@ -220,14 +258,31 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * \brief If true, delete after operation completes.
    */
   bool to_delete_{false};
-  /*! \brief special const on num_pending_reads_ to mark write being triggered */
-  static constexpr int kWriteTriggered = -1;
+  /*! \brief whether reads are scheduled without taking mutex_ */
+  bool lock_free_{true};
+  /*! \brief profile id of the last profiled write, protected by mutex_ */
+  uint64_t profile_writer_{0};
+  /*! \brief profile ids of the profiled reads since the last write, protected by mutex_ */
+  std::vector<uint64_t> profile_readers_;
+  /*! \brief maximum number of reads kept in profile_readers_ */
+  static constexpr size_t kMaxProfileReaders = 64;
+  /*! \brief flag in state_ to mark a queued write */
+  static constexpr int64_t kWriteQueued = int64_t{1} << 62;
+  /*! \brief mask of the pending read count in state_ */
+  static constexpr int64_t kReadMask = kWriteQueued - 1;
   /*!
-   * \brief derived invariant of ready to ready, without lock.
-   * \return whether the current variable is ready to read.
+   * \brief increase the pending read count if no write is queued.
+   * \return whether the read can run right away.
    */
-  inline bool is_ready_to_read() const {
-    return pending_write_ == nullptr;
+  inline bool TryAppendRead() {
+    int64_t state = state_.load(std::memory_order_acquire);
+    while (!(state & kWriteQueued)) {
+      if (state_.compare_exchange_weak(
+              state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
   }
 };  // struct ThreadedVar
 
@@ -254,6 +309,15 @@ struct ThreadedOpr final : public Opr, public common::ObjectPoolAllocatable<Thre
    * \brief Whether this is a WaitForVar operation
    */
   bool wait{false};
+  /*! \brief cost of the operator recorded by the profiler, zero if unknown */
+  profiler::OperatorCost cost;
+  /*! \brief whether the operator is owned by the tape of a thread and reused between rounds */
+  bool taped{false};
+  /*!
+   * \brief state of a taped operator: 0 when idle, 1 when pushed, 2 when pushed and dropped
+   *  by its tape, then it is deleted on completion
+   */
+  std::atomic<int> tape_state{0};
   /*!
    * \brief Cast a Opr pointer to ThreadedOpr pointer
    * \param ptr pointer from base.
@@ -317,7 +381,13 @@ class ThreadedEngine : public Engine {
   }
 
   ThreadedEngine() {
-    engine_info_ = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    engine_info_    = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    lock_free_vars_ = dmlc::GetEnv("MXNET_ENGINE_LOCK_FREE_VAR", true);
+    adaptive_bulk_  = dmlc::GetEnv("MXNET_ENGINE_ADAPTIVE_BULK", false);
+    adaptive_bulk_size_ = dmlc::GetEnv("MXNET_ENGINE_ADAPTIVE_BULK_SIZE", 15);
+    adaptive_bulk_threshold_ns_ =
+        static_cast<int64_t>(dmlc::GetEnv("MXNET_ENGINE_ADAPTIVE_BULK_THRESHOLD", 20)) * 1000;
+    delete_batch_size_ = dmlc::GetEnv("MXNET_ENGINE_DELETE_BATCH_SIZE", 16);
 
     objpool_opr_ref_    = common::ObjectPool<ThreadedOpr>::_GetSharedRef();
     objpool_blk_ref_    = common::ObjectPool<OprBlock>::_GetSharedRef();
@@ -347,6 +417,13 @@ class ThreadedEngine : public Engine {
    * \param pusher_thread whether the caller is the thread that calls push
    */
   virtual void PushToExecute(OprBlock* opr_block, bool pusher_thread) = 0;
+  /*!
+   * \brief Append the number of operations queued in each worker pool.
+   *  This function is implemented by the subclasses owning the queues.
+   *
+   * \param queue_depths the name and queue depth of each pool
+   */
+  virtual void QueueDepths(std::vector<std::pair<std::string, uint64_t>>* queue_depths) {}
   /*!
    * \brief Call this function to actually execute an opr_block
    *  This function also deletes the opr_block after execution.
@@ -363,8 +440,15 @@ class ThreadedEngine : public Engine {
       const Context& ctx = opr_block->ctx;
       opr_block->opr_profile.reset(
           new profiler::ProfileOperator(threaded_opr->opr_name.c_str(), attrs.release()));
+      opr_block->opr_profile->SetDependencies(opr_block->profile_id,
+                                              std::move(opr_block->profile_deps));
+      opr_block->opr_profile->SetCost(threaded_opr->cost);
       opr_block->opr_profile->startForDevice(ctx.dev_type, ctx.dev_id);
+    } else if (threaded_opr->opr_name.size() && profiler::SamplingProfiler::Get()->Sample()) {
+      opr_block->sample_start = profiler::ProfileStat::NowInMicrosec();
     }
+    if (opr_block->trace)
+      opr_block->trace_start = profiler::ProfileStat::NowInMicrosec();
     CallbackOnComplete callback = this->CreateCallback(ThreadedEngine::OnCompleteStatic, opr_block);
     const bool debug_info       = (engine_info_ && debug_push_opr_ == opr_block);
     if (debug_info) {
@@ -381,6 +465,9 @@ class ThreadedEngine : public Engine {
           if ((!(threaded_opr->opr_exception && *threaded_opr->opr_exception) ||
                threaded_opr->prop == FnProperty::kNoSkip) ||
               threaded_opr->wait) {
+            profiler::RunningOperatorScope running_opr(threaded_opr->opr_name.c_str());
+            // the operators it pushes belong to its request
+            profiler::RequestTraceScope trace_scope(opr_block->trace);
             threaded_opr->fn(run_ctx, callback);
           } else {
             callback();
@@ -390,6 +477,10 @@ class ThreadedEngine : public Engine {
               std::make_shared<std::exception_ptr>(std::current_exception());
           callback();
         }
+        // operations pushed by this operation must not wait in the bulk of a worker thread
+        if (adaptive_bulk_) {
+          BulkFlush();
+        }
         if (debug_info) {
           LOG(INFO) << "Fin ExecuteOprFn ";
         }
@@ -412,11 +503,45 @@ class ThreadedEngine : public Engine {
     }
   }
 
+  void adaptive_bulk_stats(uint64_t* num_merged,
+                           uint64_t* num_bulks,
+                           uint64_t* num_timed) const override {
+    *num_merged = adaptive_bulk_merged_.load(std::memory_order_relaxed);
+    *num_bulks  = adaptive_bulk_flushed_.load(std::memory_order_relaxed);
+    *num_timed  = adaptive_bulk_timed_.load(std::memory_order_relaxed);
+  }
+
+  bool set_tape(int mode) override;
+
+  void tape_stats(uint64_t* num_reused, uint64_t* num_recorded) const override {
+    *num_reused   = tape_reused_.load(std::memory_order_relaxed);
+    *num_recorded = tape_recorded_.load(std::memory_order_relaxed);
+  }
+
+  void load_stats(uint64_t* num_executed,
+                  uint64_t* num_pending,
+                  std::vector<std::pair<std::string, uint64_t>>* queue_depths) override {
+    const uint64_t pushed = num_pushed_.load(std::memory_order_relaxed);
+    *num_pending          = std::min<uint64_t>(pending_.load(std::memory_order_relaxed), pushed);
+    *num_executed         = pushed - *num_pending;
+    queue_depths->clear();
+    QueueDepths(queue_depths);
+  }
+
   int bulk_size() const override {
     const profiler::Profiler* prof = profiler::Profiler::Get();
     return (prof && prof->AggregateRunning()) ? 0 : BulkStatusStore::Get()->bulk_size;
   }
 
+  int thread_priority() const override {
+    return thread_priority_;
+  }
+
+  int set_thread_priority(int priority) override {
+    std::swap(thread_priority_, priority);
+    return priority;
+  }
+
   int set_bulk_size(int bulk_size) override {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     std::swap(bulk_status.bulk_size, bulk_size);
@@ -444,9 +569,52 @@ class ThreadedEngine : public Engine {
     std::vector<VarHandle> const_vars;
     /*! \brief mutable variables */
     std::vector<VarHandle> mutable_vars;
+    /*! \brief whether the current ops were bulked by the adaptive mode */
+    bool adaptive = false;
+  };
+  /*! \brief variables of DeleteVariable whose deletions are pushed as one operation */
+  struct DeleteBatch {
+    /*! \brief context of the deletions */
+    Context ctx;
+    /*! \brief functions freeing the data of the variables */
+    std::vector<SyncFn> delete_fns;
+    /*! \brief variables to delete */
+    std::vector<VarHandle> vars;
+  };
+  /*! \brief measured execution time of an operator, used by adaptive bulking */
+  struct AdaptiveBulkStat {
+    explicit AdaptiveBulkStat(const std::string& name) : name(name) {}
+    /*! \brief name of the operator */
+    const std::string name;
+    /*! \brief number of timed executions */
+    std::atomic<int64_t> count{0};
+    /*! \brief exponential moving average of the execution time in nanoseconds */
+    std::atomic<int64_t> avg_ns{0};
+    /*! \brief record one execution time */
+    inline void Record(int64_t ns) {
+      // concurrent updates may lose a sample, which is fine for a moving average
+      const int64_t n = count.fetch_add(1, std::memory_order_relaxed);
+      const int64_t avg = avg_ns.load(std::memory_order_relaxed);
+      avg_ns.store(n == 0 ? ns : avg + (ns - avg) / 8, std::memory_order_relaxed);
+    }
   };
+  /*! \brief number of timed executions before an operator can be bulked */
+  static constexpr int64_t kAdaptiveBulkWarmup = 4;
+  /*! \brief the operators pushed by a thread in a round, reused by its next rounds */
+  struct OprTape {
+    /*! \brief the operator of each position of the round */
+    std::vector<ThreadedOpr*> oprs;
+    /*! \brief position of the next operation pushed */
+    size_t pos = 0;
+    /*! \brief whether a round is running */
+    bool running = false;
+  };
+  /*! \brief tape of the operations pushed from this thread, allocated on first use */
+  static MX_THREAD_LOCAL OprTape* tape_;
   /*! thread local store for bulk */
   typedef dmlc::ThreadLocalStore<BulkStatus> BulkStatusStore;
+  /*! \brief priority added to the operations pushed from this thread */
+  static MX_THREAD_LOCAL int thread_priority_;
 
   /*!
    * \brief check if thee is duplication in const_vars and mutable_vars.
@@ -455,6 +623,29 @@ class ThreadedEngine : public Engine {
    */
   void CheckDuplicate(std::vector<VarHandle> const& const_vars,
                       std::vector<VarHandle> const& mutable_vars);
+  /*!
+   * \brief get the operator of the next position of the running tape of this thread,
+   *  reusing the recorded one if it matches, otherwise recording a new one.
+   * \return the operator, nullptr if the recorded one has not completed yet
+   */
+  ThreadedOpr* TapeOperator(AsyncFn* fn,
+                            std::vector<VarHandle> const& const_vars,
+                            std::vector<VarHandle> const& mutable_vars,
+                            FnProperty prop,
+                            const char* opr_name,
+                            bool wait);
+  /*! \brief drop a taped operator, it is deleted now or on completion if it is pushed */
+  static void ReleaseTapeOperator(ThreadedOpr* opr);
+  /*!
+   * \brief push a sync function in adaptive bulking mode.
+   *  Cheap operators are merged into the bulk of the calling thread,
+   *  the others are pushed alone and timed.
+   */
+  void PushSyncAdaptive(SyncFn exec_fn,
+                        Context exec_ctx,
+                        std::vector<VarHandle> const& const_vars,
+                        std::vector<VarHandle> const& mutable_vars,
+                        const char* opr_name);
   /*!
    * \brief Callback on operation completion.
    *
@@ -504,11 +695,39 @@ class ThreadedEngine : public Engine {
     }
     return;
   }
-  /*! \brief append an operator to bulk */
+  /*!
+   * \brief get the execution time statistics of an operator, shared by all engines
+   * \param opr_name name of the operator
+   * \return the statistics, never released
+   */
+  static AdaptiveBulkStat* GetAdaptiveBulkStat(const char* opr_name);
+  /*!
+   * \brief whether an operator is cheap enough compared to the dispatch overhead
+   *  to be merged into an adaptive bulk
+   */
+  inline bool IsCheapOperator(const AdaptiveBulkStat* stat) const {
+    return stat->count.load(std::memory_order_relaxed) >= kAdaptiveBulkWarmup &&
+           stat->avg_ns.load(std::memory_order_relaxed) < adaptive_bulk_threshold_ns_;
+  }
+  /*! \brief wrap a sync function to record its execution time */
+  static inline SyncFn TimedSyncFn(SyncFn exec_fn, AdaptiveBulkStat* stat) {
+    return [exec_fn, stat](RunContext ctx) {
+      const auto start = std::chrono::steady_clock::now();
+      exec_fn(ctx);
+      stat->Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count());
+    };
+  }
+  /*!
+   * \brief append an operator to bulk
+   * \param limit flush the bulk when it holds this many operators
+   */
   inline void BulkAppend(SyncFn exec_fn,
                          Context exec_ctx,
                          std::vector<VarHandle> const& const_vars,
-                         std::vector<VarHandle> const& mutable_vars) {
+                         std::vector<VarHandle> const& mutable_vars,
+                         int limit) {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     if (!bulk_status.functions) {
       bulk_status.functions.reset(new std::vector<SyncFn>());
@@ -524,26 +743,37 @@ class ThreadedEngine : public Engine {
     bulk_status.mutable_vars.insert(
         bulk_status.mutable_vars.end(), mutable_vars.begin(), mutable_vars.end());
 
-    if (bulk_status.count >= bulk_status.bulk_size)
+    if (bulk_status.count >= limit)
       BulkFlush();
   }
+  /*! \brief pushes the pending deletions of variables */
+  void DeleteFlush();
+  /*! \brief pushes the deletions of batch as one operation */
+  void PushDeleteBatch(DeleteBatch* batch);
   /*! \brief flush current bulk to execution */
   inline void BulkFlush() {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
     if (!bulk_status.count)
       return;
+    if (bulk_status.adaptive) {
+      adaptive_bulk_merged_.fetch_add(bulk_status.count, std::memory_order_relaxed);
+      adaptive_bulk_flushed_.fetch_add(1, std::memory_order_relaxed);
+      bulk_status.adaptive = false;
+    }
     bulk_status.count = 0;
     DeduplicateVarHandle(&bulk_status.const_vars, &bulk_status.mutable_vars);
     auto functions = bulk_status.functions;
     this->PushAsync(
         [functions](RunContext ctx, CallbackOnComplete on_complete) {
-          ctx.is_bulk = true;
+          // the inline GPU operations of the engine are already run in bulk mode
+          const bool stream_ordered = ctx.is_bulk;
+          ctx.is_bulk               = true;
           for (auto& fn : *functions) {
             fn(ctx);
           }
           ctx.is_bulk = false;
           bool is_gpu = ctx.ctx.dev_mask() == gpu::kDevMask;
-          if (is_gpu) {
+          if (is_gpu && !stream_ordered) {
             ctx.get_stream<gpu>()->Wait();
           }
           on_complete();
@@ -564,12 +794,36 @@ class ThreadedEngine : public Engine {
    * \brief Number of pending operations.
    */
   std::atomic<int> pending_{0};
+  /*! \brief Number of pushed operations */
+  std::atomic<uint64_t> num_pushed_{0};
+  /*! \brief Last profile id given to a profiled operation */
+  std::atomic<uint64_t> profile_opr_id_{0};
   /*! \brief whether we want to kill the waiters */
   std::atomic<bool> kill_{false};
   /*! \brief whether it is during shutdown phase*/
   std::atomic<bool> shutdown_phase_{false};
   /*!\brief show more information from engine actions */
   bool engine_info_{false};
+  /*! \brief whether new variables schedule reads without taking their mutex */
+  bool lock_free_vars_{true};
+  /*! \brief whether cheap operators are bulked automatically */
+  bool adaptive_bulk_{false};
+  /*! \brief maximum number of operators in an adaptive bulk */
+  int adaptive_bulk_size_{15};
+  /*! \brief operators faster than this are considered cheap */
+  int64_t adaptive_bulk_threshold_ns_{20000};
+  /*! \brief maximum number of variable deletions pushed as one operation */
+  size_t delete_batch_size_{16};
+  /*! \brief the deletions not pushed yet, from all threads */
+  DeleteBatch delete_batch_;
+  std::mutex delete_batch_m_;
+  /*! \brief adaptive bulking counters */
+  std::atomic<uint64_t> adaptive_bulk_merged_{0};
+  std::atomic<uint64_t> adaptive_bulk_flushed_{0};
+  std::atomic<uint64_t> adaptive_bulk_timed_{0};
+  /*! \brief operator tape counters */
+  std::atomic<uint64_t> tape_reused_{0};
+  std::atomic<uint64_t> tape_recorded_{0};
   /*! \brief debug information about wait for var. */
   std::atomic<ThreadedVar*> debug_wait_var_{nullptr};
   /*! \brief debug information about wait for var. */
@@ -32,9 +32,12 @@
 #include "../initialize.h"
 #include "./threaded_engine.h"
 #include "./thread_pool.h"
+#include "./work_stealing_queue.h"
 #include "../common/lazy_alloc_array.h"
 #include "../common/utils.h"
+#include "../common/numa.h"
 #include "../common/cuda/nvtx.h"
+#include "../common/cuda/utils.h"
 
 namespace mxnet {
 namespace engine {
@@ -45,6 +48,15 @@ namespace engine {
  *  - Use fixed amount of threads for each device.
  *  - Use special threads for copy operations.
  *  - Each stream is allocated and bound to each of the thread.
+ *  - Optionally (MXNET_CPU_WORK_STEALING=1), CPU workers of a device use
+ *    per-worker lock-free deques with work stealing instead of one shared queue.
+ *  - Optionally (MXNET_ENGINE_PRIORITY_SCHEDULING=1), normal CPU and GPU workers
+ *    pick the ready operation with the highest priority instead of the oldest one.
+ *  - Optionally (MXNET_ENGINE_INLINE_GPU=1), normal GPU operations which are ready when
+ *    they are pushed are launched by the pushing thread on one stream, without waiting
+ *    for them, see InlineGPUStream.
+ *  - Optionally (MXNET_CPU_NUMA_AWARE=1), CPU workers of cpu(i) and their omp teams
+ *    are pinned to NUMA node i % num_nodes, where the memory of cpu(i) is allocated.
  */
 class ThreadedEnginePerDevice : public ThreadedEngine {
  public:
@@ -66,8 +78,19 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     gpu_normal_workers_.Clear();
     gpu_priority_workers_.Clear();
     gpu_copy_workers_.Clear();
+    gpu_normal_priority_workers_.Clear();
     cpu_normal_workers_.Clear();
+    cpu_normal_priority_workers_.Clear();
+    cpu_stealing_workers_.Clear();
     cpu_priority_worker_.reset(nullptr);
+#if MXNET_USE_CUDA
+    // like the streams of the GPU workers, the inline stream is not destroyed
+    InlineGPUStream* inline_stream = inline_stream_.exchange(nullptr);
+    if (inline_stream != nullptr) {
+      MSHADOW_CATCH_ERROR(inline_stream->stream->Wait());
+      delete inline_stream;
+    }
+#endif
   }
 
   void Stop() override {
@@ -80,10 +103,19 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   void Start() override {
     if (is_worker_)
       return;
+    // The data loading workers forked by the frontend run small CPU operators, they skip
+    // the start of the worker pools and run the operators inline, like the NaiveEngine.
+    const LibraryInitializer* initializer = LibraryInitializer::Get();
+    inline_worker_ = initializer->was_forked() && initializer->mp_worker_inline_engine_;
+    if (inline_worker_)
+      return;
     gpu_worker_nthreads_ = common::GetNumThreadsPerGPU();
     // MXNET_CPU_WORKER_NTHREADS
     cpu_worker_nthreads_ = LibraryInitializer::Get()->cpu_worker_nthreads_;
     gpu_copy_nthreads_   = dmlc::GetEnv("MXNET_GPU_COPY_NTHREADS", 2);
+    cpu_work_stealing_   = dmlc::GetEnv("MXNET_CPU_WORK_STEALING", false);
+    priority_scheduling_ = dmlc::GetEnv("MXNET_ENGINE_PRIORITY_SCHEDULING", false);
+    inline_gpu_          = dmlc::GetEnv("MXNET_ENGINE_INLINE_GPU", false);
     // create CPU task
     int cpu_priority_nthreads  = dmlc::GetEnv("MXNET_CPU_PRIORITY_NTHREADS", 4);
     cpu_priority_worker_       = std::make_unique<ThreadWorkerBlock<kPriorityQueue>>();
@@ -96,9 +128,26 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     // GPU tasks will be created lazily
   }
 
+  void WaitForVar(VarHandle var) override {
+    ThreadedEngine::WaitForVar(var);
+    SyncInlineGPUStream();
+  }
+
+  void WaitForAll() override {
+    ThreadedEngine::WaitForAll();
+    SyncInlineGPUStream();
+  }
+
  protected:
   void PushToExecute(OprBlock* opr_block, bool pusher_thread) override {
     const Context& ctx = opr_block->ctx;
+    if (inline_worker_) {
+      CHECK_EQ(ctx.dev_mask(), Context::kCPU)
+          << "A forked process can only run CPU operators, "
+             "set MXNET_MP_WORKER_INLINE_ENGINE=0 to run " << ctx << " operators in it";
+      this->ExecuteOprBlock(RunContext{ctx, nullptr, nullptr, false}, opr_block);
+      return;
+    }
     if ((opr_block->opr->prop == FnProperty::kAsync ||
          opr_block->opr->prop == FnProperty::kDeleteVar) &&
         pusher_thread) {
@@ -107,37 +156,56 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
         MSHADOW_CATCH_ERROR(mshadow::SetDevice<gpu>(ctx.dev_id));
 #endif
       }
+      SyncInlineGPUStream();
       this->ExecuteOprBlock(RunContext{ctx, nullptr, nullptr, false}, opr_block);
     } else {
       if (ctx.dev_mask() == Context::kCPU) {
         // CPU execution.
         if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
           cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
-        } else {
+        } else if (cpu_work_stealing_) {
           int dev_id  = ctx.dev_id;
           int nthread = cpu_worker_nthreads_;
-          auto ptr    = cpu_normal_workers_.Get(dev_id, [this, ctx, nthread]() {
-            auto blk  = new ThreadWorkerBlock<kWorkerQueue>();
+          auto ptr    = cpu_stealing_workers_.Get(dev_id, [this, ctx, nthread]() {
+            auto blk  = new StealingWorkerBlock(nthread);
             blk->pool = std::make_unique<ThreadPool>(
                 nthread,
                 [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
-                  this->CPUWorker(ctx, blk, ready_event);
+                  this->CPUStealingWorker(ctx, blk, ready_event);
                 },
                 true);
             return blk;
           });
           if (ptr) {
-            if (opr_block->opr->prop == FnProperty::kDeleteVar) {
-              ptr->task_queue.PushFront(opr_block, opr_block->priority);
-            } else {
-              ptr->task_queue.Push(opr_block, opr_block->priority);
-            }
+            // dependents dispatched by a worker stay on that worker,
+            // otherwise prefer the worker that last wrote one of the inputs.
+            const int self = (stealing_block_ == ptr.get()) ? stealing_worker_id_ : -1;
+            ptr->task_queue.Push(opr_block,
+                                 self,
+                                 self >= 0 ? self : AffinityHint(opr_block),
+                                 opr_block->opr->prop == FnProperty::kDeleteVar);
           }
+        } else if (priority_scheduling_) {
+          PushToCPUWorkers(&cpu_normal_priority_workers_, opr_block);
+        } else {
+          PushToCPUWorkers(&cpu_normal_workers_, opr_block);
         }
       } else {
         CHECK_EQ(ctx.dev_mask(), Context::kGPU);
         // GPU execution.
         const FnProperty prop = opr_block->opr->prop;
+#if MXNET_USE_CUDA
+        if (inline_gpu_ && pusher_thread && prop == FnProperty::kNormal) {
+          InlineGPUStream* inline_stream = GetInlineGPUStream(ctx);
+          if (inline_stream != nullptr) {
+            // is_bulk: the operation does not wait for its stream
+            this->ExecuteOprBlock(
+                RunContext{ctx, inline_stream->stream, inline_stream->aux_stream, true},
+                opr_block);
+            return;
+          }
+        }
+#endif
         const bool is_copy = (prop == FnProperty::kCopyFromGPU || prop == FnProperty::kCopyToGPU);
         if (is_copy) {
           const size_t nthread = gpu_copy_nthreads_;
@@ -179,27 +247,12 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
             if (ptr) {
               ptr->task_queue.Push(opr_block, opr_block->priority);
             }
+          } else if (priority_scheduling_) {
+            // GPU normal task, highest priority first
+            PushToGPUWorkers(&gpu_normal_priority_workers_, opr_block, nthread);
           } else {
             // GPU normal task
-            auto ptr = gpu_normal_workers_.Get(ctx.dev_id, [this, ctx, is_copy, nthread]() {
-              // Signify to kernel that GPU is being used, so reserve cores as necessary
-              OpenMP::Get()->set_reserve_cores(GetReserveCoreCount(true));
-              auto blk  = new ThreadWorkerBlock<kWorkerQueue>();
-              blk->pool = std::make_unique<ThreadPool>(
-                  nthread,
-                  [this, ctx, is_copy, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
-                    this->GPUWorker(ctx, is_copy, blk, ready_event);
-                  },
-                  true);
-              return blk;
-            });
-            if (ptr) {
-              if (opr_block->opr->prop == FnProperty::kDeleteVar) {
-                ptr->task_queue.PushFront(opr_block, opr_block->priority);
-              } else {
-                ptr->task_queue.Push(opr_block, opr_block->priority);
-              }
-            }
+            PushToGPUWorkers(&gpu_normal_workers_, opr_block, nthread);
           }
         }
       }
@@ -220,8 +273,82 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ~ThreadWorkerBlock() = default;
   };
 
+  // working unit for CPU workers sharing a work stealing queue.
+  struct StealingWorkerBlock {
+    // task queue shared by the workers
+    WorkStealingTaskQueue<OprBlock*> task_queue;
+    // thread pool that works on this task
+    std::unique_ptr<ThreadPool> pool;
+    // counter used to assign worker ids
+    std::atomic<int> next_worker_id{0};
+    // constructor
+    explicit StealingWorkerBlock(size_t nthreads) : task_queue(nthreads) {}
+  };
+
   /*! \brief whether this is a worker thread. */
   static MX_THREAD_LOCAL bool is_worker_;
+  /*! \brief work stealing block the current thread works for, if any. */
+  static MX_THREAD_LOCAL StealingWorkerBlock* stealing_block_;
+  /*! \brief id of the current thread inside stealing_block_. */
+  static MX_THREAD_LOCAL int stealing_worker_id_;
+  /*! \brief whether CPU workers use work stealing queues */
+  bool cpu_work_stealing_{false};
+  /*! \brief whether normal workers use priority queues */
+  bool priority_scheduling_{false};
+  /*! \brief whether operators run on the pushing thread, in a forked data loading worker */
+  bool inline_worker_{false};
+  /*! \brief whether ready GPU operations are launched by the pushing thread */
+  bool inline_gpu_{false};
+#if MXNET_USE_CUDA
+  /*!
+   * \brief The stream on which the pushing thread launches the GPU operations of one device.
+   *  Operations on the stream complete for the engine as soon as they are launched, the
+   *  stream orders them. Every other execution, on a worker or by WaitForVar and WaitForAll,
+   *  first synchronizes the stream, so it sees their results.
+   */
+  struct InlineGPUStream {
+    /*! \brief the device of the stream */
+    int dev_id;
+    /*! \brief the only thread launching operations on the stream */
+    std::thread::id owner;
+    mshadow::Stream<gpu>* stream;
+    GPUAuxStream* aux_stream;
+  };
+  /*! \brief the inline stream, created by the first thread pushing a GPU operation */
+  std::atomic<InlineGPUStream*> inline_stream_{nullptr};
+  std::mutex inline_stream_m_;
+  /*! \brief the inline stream if the calling thread launches the operations of ctx on it */
+  InlineGPUStream* GetInlineGPUStream(const Context& ctx) {
+    InlineGPUStream* inline_stream = inline_stream_.load(std::memory_order_acquire);
+    if (inline_stream == nullptr) {
+      std::lock_guard<std::mutex> lock(inline_stream_m_);
+      inline_stream = inline_stream_.load(std::memory_order_acquire);
+      if (inline_stream == nullptr) {
+        inline_stream         = new InlineGPUStream();
+        inline_stream->dev_id = ctx.dev_id;
+        inline_stream->owner  = std::this_thread::get_id();
+        mshadow::SetDevice<gpu>(ctx.dev_id);
+        inline_stream->stream     = mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, ctx.dev_id);
+        inline_stream->aux_stream = new GPUAuxStream(inline_stream->stream);
+        common::cuda::SetThreadStream(ctx.dev_id,
+                                      mshadow::Stream<gpu>::GetStream(inline_stream->stream));
+        inline_stream_.store(inline_stream, std::memory_order_release);
+      }
+    }
+    if (inline_stream->dev_id != ctx.dev_id || inline_stream->owner != std::this_thread::get_id())
+      return nullptr;
+    mshadow::SetDevice<gpu>(ctx.dev_id);
+    return inline_stream;
+  }
+#endif
+  /*! \brief wait for the operations launched on the inline stream, if any */
+  void SyncInlineGPUStream() {
+#if MXNET_USE_CUDA
+    InlineGPUStream* inline_stream = inline_stream_.load(std::memory_order_acquire);
+    if (inline_stream != nullptr)
+      CUDA_CALL(cudaStreamSynchronize(mshadow::Stream<gpu>::GetStream(inline_stream->stream)));
+#endif
+  }
   /*! \brief number of concurrent thread cpu worker uses */
   size_t cpu_worker_nthreads_;
   /*! \brief number of concurrent thread each gpu worker uses */
@@ -230,14 +357,80 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   size_t gpu_copy_nthreads_;
   // cpu worker
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue>> cpu_normal_workers_;
+  // cpu worker popping the highest priority first
+  common::LazyAllocArray<ThreadWorkerBlock<kPriorityQueue>> cpu_normal_priority_workers_;
+  // cpu worker with work stealing
+  common::LazyAllocArray<StealingWorkerBlock> cpu_stealing_workers_;
   // cpu priority worker
   std::unique_ptr<ThreadWorkerBlock<kPriorityQueue>> cpu_priority_worker_;
   // workers doing normal works on GPU
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue>> gpu_normal_workers_;
+  // workers doing normal works on GPU, highest priority first
+  common::LazyAllocArray<ThreadWorkerBlock<kPriorityQueue>> gpu_normal_priority_workers_;
   // workers doing copy works from/to GPU
   common::LazyAllocArray<ThreadWorkerBlock<kCopyQueue>> gpu_copy_workers_;
   // gpu priority workers
   common::LazyAllocArray<ThreadWorkerBlock<kPriorityQueue>> gpu_priority_workers_;
+  /*!
+   * \brief Push an operation to the normal CPU workers of its device.
+   * \param workers The worker blocks, created lazily per device.
+   * \param opr_block The operator block.
+   */
+  template <dmlc::ConcurrentQueueType type>
+  inline void PushToCPUWorkers(common::LazyAllocArray<ThreadWorkerBlock<type>>* workers,
+                               OprBlock* opr_block) {
+    const Context& ctx = opr_block->ctx;
+    int nthread        = cpu_worker_nthreads_;
+    auto ptr           = workers->Get(ctx.dev_id, [this, ctx, nthread]() {
+      auto blk  = new ThreadWorkerBlock<type>();
+      blk->pool = std::make_unique<ThreadPool>(
+          nthread,
+          [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+            this->CPUWorker(ctx, blk, ready_event, true);
+          },
+          true);
+      return blk;
+    });
+    if (ptr) {
+      if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+        ptr->task_queue.PushFront(opr_block, opr_block->priority);
+      } else {
+        ptr->task_queue.Push(opr_block, opr_block->priority);
+      }
+    }
+  }
+  /*!
+   * \brief Push an operation to the normal GPU workers of its device.
+   * \param workers The worker blocks, created lazily per device.
+   * \param opr_block The operator block.
+   * \param nthread Number of workers per device.
+   */
+  template <dmlc::ConcurrentQueueType type>
+  inline void PushToGPUWorkers(common::LazyAllocArray<ThreadWorkerBlock<type>>* workers,
+                               OprBlock* opr_block,
+                               size_t nthread) {
+    const Context& ctx = opr_block->ctx;
+    const bool is_copy = false;
+    auto ptr           = workers->Get(ctx.dev_id, [this, ctx, is_copy, nthread]() {
+      // Signify to kernel that GPU is being used, so reserve cores as necessary
+      OpenMP::Get()->set_reserve_cores(GetReserveCoreCount(true));
+      auto blk  = new ThreadWorkerBlock<type>();
+      blk->pool = std::make_unique<ThreadPool>(
+          nthread,
+          [this, ctx, is_copy, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+            this->GPUWorker(ctx, is_copy, blk, ready_event);
+          },
+          true);
+      return blk;
+    });
+    if (ptr) {
+      if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+        ptr->task_queue.PushFront(opr_block, opr_block->priority);
+      } else {
+        ptr->task_queue.Push(opr_block, opr_block->priority);
+      }
+    }
+  }
   /*!
    * \brief GPU worker that performs operations on a certain device.
    * \param dev_id The device id of the worker.
@@ -264,6 +457,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
         stream     = mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, ctx.dev_id);
         aux_stream = new GPUAuxStream(stream);
       }
+      common::cuda::SetThreadStream(ctx.dev_id, mshadow::Stream<gpu>::GetStream(stream));
     } while (false);
     // execute task
     OprBlock* opr_block;
@@ -275,6 +469,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     OpenMP::Get()->on_start_worker_thread(false);
 
     while (task_queue->Pop(&opr_block)) {
+      SyncInlineGPUStream();
 #if MXNET_USE_NVTX
       auto nvtx_name = opr_block->opr->opr_name != "" ? opr_block->opr->opr_name : "Op";
       auto end_pos = nvtx_name.find('{');
@@ -296,11 +491,13 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   /*!
    * \brief CPU worker that performs operations on CPU.
    * \param block The task block of the worker.
+   * \param numa_bind Whether to pin the worker to the NUMA node of ctx in NUMA aware mode.
    */
   template <dmlc::ConcurrentQueueType type>
   inline void CPUWorker(Context ctx,
                         ThreadWorkerBlock<type>* block,
-                        const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+                        const std::shared_ptr<dmlc::ManualEvent>& ready_event,
+                        bool numa_bind = false) {
     this->is_worker_ = true;
     auto* task_queue = &(block->task_queue);
     RunContext run_ctx{ctx, nullptr, nullptr, false};
@@ -310,11 +507,75 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ready_event->signal();
 
     // Set default number of threads for OMP parallel regions initiated by this thread
-    OpenMP::Get()->on_start_worker_thread(true);
+    OpenMP::Get()->on_start_worker_thread(true, numa_bind ? BindToNUMANode(ctx) : -1);
 
     while (task_queue->Pop(&opr_block)) {
+      // the OMP teams of the workers running ops at the same time split the cores
+      OpenMP::CoreShare share;
+      SyncInlineGPUStream();
+      this->ExecuteOprBlock(run_ctx, opr_block);
+    }
+  }
+  /*!
+   * \brief CPU worker that performs operations on CPU with work stealing.
+   * \param block The task block of the worker.
+   */
+  inline void CPUStealingWorker(Context ctx,
+                                StealingWorkerBlock* block,
+                                const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+    this->is_worker_    = true;
+    stealing_block_     = block;
+    stealing_worker_id_ = block->next_worker_id++;
+    auto* task_queue    = &(block->task_queue);
+    RunContext run_ctx{ctx, nullptr, nullptr, false};
+
+    // execute task
+    OprBlock* opr_block;
+    ready_event->signal();
+
+    // Set default number of threads for OMP parallel regions initiated by this thread
+    OpenMP::Get()->on_start_worker_thread(true, BindToNUMANode(ctx));
+
+    while (task_queue->Pop(stealing_worker_id_, &opr_block)) {
+      for (ThreadedVar* var : opr_block->opr->mutable_vars) {
+        var->worker_hint.store(stealing_worker_id_, std::memory_order_relaxed);
+      }
+      OpenMP::CoreShare share;
+      SyncInlineGPUStream();
       this->ExecuteOprBlock(run_ctx, opr_block);
     }
+    stealing_block_ = nullptr;
+  }
+  /*!
+   * \brief Pin the calling CPU worker to the NUMA node serving ctx.
+   * \return the node, -1 if NUMA aware mode is disabled or pinning failed.
+   */
+  static inline int BindToNUMANode(const Context& ctx) {
+    if (!common::numa::Enabled()) {
+      return -1;
+    }
+    const int node = common::numa::NodeOfDevice(ctx.dev_id);
+    return common::numa::BindCurrentThreadToNode(node) ? node : -1;
+  }
+  /*!
+   * \brief Get the worker that last wrote one of the variables used by an operator.
+   * \param opr_block The operator block.
+   * \return the worker id, -1 if no variable carries a hint.
+   */
+  static inline int AffinityHint(const OprBlock* opr_block) {
+    for (const ThreadedVar* var : opr_block->opr->mutable_vars) {
+      const int hint = var->worker_hint.load(std::memory_order_relaxed);
+      if (hint >= 0) {
+        return hint;
+      }
+    }
+    for (const ThreadedVar* var : opr_block->opr->const_vars) {
+      const int hint = var->worker_hint.load(std::memory_order_relaxed);
+      if (hint >= 0) {
+        return hint;
+      }
+    }
+    return -1;
   }
 
   /*!
@@ -338,6 +599,32 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     return reserve;
   }
 
+  /*! \brief Append the queue depths of the worker blocks of the devices of a pool */
+  template <typename Object>
+  static inline void AppendQueueDepths(
+      const char* pool,
+      common::LazyAllocArray<Object>* array,
+      std::vector<std::pair<std::string, uint64_t>>* queue_depths) {
+    array->ForEach([pool, queue_depths](size_t i, Object* block) {
+      queue_depths->emplace_back(std::string(pool) + "/" + std::to_string(i),
+                                 static_cast<uint64_t>(block->task_queue.Size()));
+    });
+  }
+
+  void QueueDepths(std::vector<std::pair<std::string, uint64_t>>* queue_depths) override {
+    AppendQueueDepths("gpu_priority", &gpu_priority_workers_, queue_depths);
+    AppendQueueDepths("gpu_normal", &gpu_normal_workers_, queue_depths);
+    AppendQueueDepths("gpu_normal_priority", &gpu_normal_priority_workers_, queue_depths);
+    AppendQueueDepths("gpu_copy", &gpu_copy_workers_, queue_depths);
+    AppendQueueDepths("cpu_normal", &cpu_normal_workers_, queue_depths);
+    AppendQueueDepths("cpu_normal_priority", &cpu_normal_priority_workers_, queue_depths);
+    AppendQueueDepths("cpu_stealing", &cpu_stealing_workers_, queue_depths);
+    if (cpu_priority_worker_) {
+      queue_depths->emplace_back("cpu_priority",
+                                 static_cast<uint64_t>(cpu_priority_worker_->task_queue.Size()));
+    }
+  }
+
   /*! \brief Signal a single queue for shutdown */
   template <typename Object>
   static inline void SignalQueueForKill(common::LazyAllocArray<Object>* array) {
@@ -348,8 +635,11 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   void SignalQueuesForKill() {
     SignalQueueForKill(&gpu_priority_workers_);
     SignalQueueForKill(&gpu_normal_workers_);
+    SignalQueueForKill(&gpu_normal_priority_workers_);
     SignalQueueForKill(&gpu_copy_workers_);
     SignalQueueForKill(&cpu_normal_workers_);
+    SignalQueueForKill(&cpu_normal_priority_workers_);
+    SignalQueueForKill(&cpu_stealing_workers_);
     if (cpu_priority_worker_) {
       cpu_priority_worker_->task_queue.SignalForKill();
     }
@@ -361,6 +651,9 @@ Engine* CreateThreadedEnginePerDevice() {
 }
 
 MX_THREAD_LOCAL bool ThreadedEnginePerDevice::is_worker_ = false;
+MX_THREAD_LOCAL ThreadedEnginePerDevice::StealingWorkerBlock*
+    ThreadedEnginePerDevice::stealing_block_ = nullptr;
+MX_THREAD_LOCAL int ThreadedEnginePerDevice::stealing_worker_id_ = -1;
 
 }  // namespace engine
 }  // namespace mxnet
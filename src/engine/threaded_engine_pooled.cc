@@ -97,6 +97,15 @@ class ThreadedEnginePooled : public ThreadedEngine {
     }
   }
 
+  void QueueDepths(std::vector<std::pair<std::string, uint64_t>>* queue_depths) override {
+    if (task_queue_) {
+      queue_depths->emplace_back("cpu", static_cast<uint64_t>(task_queue_->Size()));
+    }
+    if (io_task_queue_) {
+      queue_depths->emplace_back("io", static_cast<uint64_t>(io_task_queue_->Size()));
+    }
+  }
+
  private:
   /*! \brief Concurrency for thread pool */
   static constexpr std::size_t kNumWorkingThreads = 16;
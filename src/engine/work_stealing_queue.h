@@ -0,0 +1,349 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_queue.h
+ * \brief Lock-free per-worker deques and a work stealing task queue
+ *  used by the CPU workers of ThreadedEnginePerDevice.
+ */
+#ifndef MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+#define MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Chase-Lev work stealing deque.
+ *  The owner thread pushes and pops at the bottom (LIFO),
+ *  any other thread may steal from the top (FIFO).
+ *  The memory ordering follows Le et al., "Correct and Efficient
+ *  Work-Stealing for Weak Memory Models", PPoPP 2013.
+ * \tparam T element type, must be trivially copyable (usually a pointer).
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "WorkStealingDeque only supports trivially copyable types");
+  /*!
+   * \brief constructor
+   * \param log_capacity log2 of the initial capacity, the deque grows on demand.
+   */
+  explicit WorkStealingDeque(int log_capacity = 8)
+      : top_(0), bottom_(0), buffer_(new Buffer(int64_t{1} << log_capacity)) {
+    retired_.emplace_back(buffer_.load(std::memory_order_relaxed));
+  }
+  /*!
+   * \brief Push an item to the bottom, only called by the owner thread.
+   * \param item the item to be pushed.
+   */
+  inline void Push(T item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* buf     = buffer_.load(std::memory_order_relaxed);
+    if (b - t > buf->capacity - 1) {
+      buf = buf->Grow(b, t);
+      // old buffers may still be read by thieves, keep them alive until destruction
+      retired_.emplace_back(buf);
+      buffer_.store(buf, std::memory_order_release);
+    }
+    buf->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  /*!
+   * \brief Pop the most recently pushed item, only called by the owner thread.
+   * \param out the popped item.
+   * \return whether an item was popped.
+   */
+  inline bool Pop(T* out) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buf     = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t    = top_.load(std::memory_order_relaxed);
+    bool success = false;
+    if (t <= b) {
+      *out    = buf->Get(b);
+      success = true;
+      if (t == b) {
+        // last element, race against thieves
+        if (!top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+          success = false;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return success;
+  }
+  /*!
+   * \brief Steal the oldest item, can be called by any thread.
+   * \param out the stolen item.
+   * \return whether an item was stolen, may fail spuriously on contention.
+   */
+  inline bool Steal(T* out) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t < b) {
+      Buffer* buf = buffer_.load(std::memory_order_acquire);
+      T item      = buf->Get(t);
+      if (!top_.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return false;
+      }
+      *out = item;
+      return true;
+    }
+    return false;
+  }
+  /*! \return approximate number of items in the deque. */
+  inline int64_t Size() const {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+ private:
+  /*! \brief circular buffer backing the deque */
+  struct Buffer {
+    explicit Buffer(int64_t cap) : capacity(cap), mask(cap - 1), data(new std::atomic<T>[cap]) {}
+    inline T Get(int64_t i) const {
+      return data[i & mask].load(std::memory_order_relaxed);
+    }
+    inline void Put(int64_t i, T item) {
+      data[i & mask].store(item, std::memory_order_relaxed);
+    }
+    inline Buffer* Grow(int64_t bottom, int64_t top) const {
+      Buffer* ret = new Buffer(capacity << 1);
+      for (int64_t i = top; i != bottom; ++i) {
+        ret->Put(i, Get(i));
+      }
+      return ret;
+    }
+    int64_t capacity;
+    int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> data;
+  };
+  /*! \brief index of the oldest item, modified by thieves */
+  alignas(64) std::atomic<int64_t> top_;
+  /*! \brief index after the newest item, modified by the owner */
+  alignas(64) std::atomic<int64_t> bottom_;
+  /*! \brief current buffer */
+  std::atomic<Buffer*> buffer_;
+  /*! \brief all buffers ever allocated, released on destruction */
+  std::vector<std::unique_ptr<Buffer>> retired_;
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+/*!
+ * \brief Blocking task queue shared by a group of workers.
+ *  Each worker owns a lock-free deque for tasks it dispatches itself,
+ *  and an inbox for tasks pushed from other threads.
+ *  Idle workers steal from the deques and inboxes of other workers
+ *  before going to sleep.
+ *
+ *  Pop has the same shutdown semantic as dmlc::ConcurrentBlockingQueue:
+ *  once SignalForKill is called, it returns false and pending tasks are dropped.
+ * \tparam T element type, must be trivially copyable (usually a pointer).
+ */
+template <typename T>
+class WorkStealingTaskQueue {
+ public:
+  /*!
+   * \brief constructor
+   * \param num_workers number of workers sharing this queue.
+   */
+  explicit WorkStealingTaskQueue(size_t num_workers) : workers_(num_workers) {
+    CHECK_GT(num_workers, 0);
+    for (auto& w : workers_) {
+      w.reset(new Worker());
+    }
+  }
+  /*! \return number of workers sharing this queue */
+  inline size_t num_workers() const {
+    return workers_.size();
+  }
+  /*!
+   * \brief Push a task.
+   * \param item the task.
+   * \param self id of the calling worker, or -1 if called from a non-worker thread.
+   * \param target id of the preferred worker, or -1 if there is no preference.
+   * \param front whether the task should be executed before other queued tasks.
+   */
+  inline void Push(T item, int self, int target = -1, bool front = false) {
+    if (target < 0 || target >= static_cast<int>(workers_.size())) {
+      target = self;
+    }
+    if (target >= 0 && target == self) {
+      // owner push, newest tasks are popped first
+      workers_[self]->deque.Push(item);
+    } else {
+      if (target < 0) {
+        target = static_cast<int>(next_inbox_.fetch_add(1, std::memory_order_relaxed) %
+                                  workers_.size());
+      }
+      Worker* w = workers_[target].get();
+      {
+        std::lock_guard<std::mutex> lock{w->mutex};
+        if (front) {
+          w->inbox.push_front(item);
+        } else {
+          w->inbox.push_back(item);
+        }
+        w->inbox_size.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    pending_.fetch_add(1, std::memory_order_seq_cst);
+    if (num_sleeping_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock{sleep_mutex_};
+      sleep_cv_.notify_one();
+    }
+  }
+  /*!
+   * \brief Pop a task for a worker, blocks until a task is available.
+   * \param self id of the calling worker.
+   * \param out the task.
+   * \return false if the queue was signaled for kill.
+   */
+  inline bool Pop(int self, T* out) {
+    CHECK_GE(self, 0);
+    CHECK_LT(self, static_cast<int>(workers_.size()));
+    while (true) {
+      for (int spin = 0; spin < kSpinCount; ++spin) {
+        if (kill_.load(std::memory_order_acquire)) {
+          return false;
+        }
+        if (TryPop(self, out)) {
+          pending_.fetch_sub(1, std::memory_order_relaxed);
+          return true;
+        }
+        if (pending_.load(std::memory_order_relaxed) == 0) {
+          break;
+        }
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock{sleep_mutex_};
+      num_sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      sleep_cv_.wait(lock, [this]() {
+        return kill_.load(std::memory_order_acquire) ||
+               pending_.load(std::memory_order_seq_cst) > 0;
+      });
+      num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  /*! \brief wake up all the workers and make Pop return false */
+  inline void SignalForKill() {
+    {
+      std::lock_guard<std::mutex> lock{sleep_mutex_};
+      kill_.store(true, std::memory_order_release);
+    }
+    sleep_cv_.notify_all();
+  }
+  /*! \return approximate number of queued tasks */
+  inline int64_t Size() const {
+    return pending_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief per worker state */
+  struct Worker {
+    /*! \brief tasks dispatched by the worker itself */
+    WorkStealingDeque<T> deque;
+    /*! \brief tasks pushed by other threads */
+    std::deque<T> inbox;
+    /*! \brief approximate size of the inbox, read without lock */
+    std::atomic<int64_t> inbox_size{0};
+    /*! \brief protects inbox */
+    std::mutex mutex;
+  };
+  /*! \brief number of polls before an idle worker goes to sleep */
+  static constexpr int kSpinCount = 64;
+  /*!
+   * \brief take a task from an inbox
+   * \param w the worker owning the inbox
+   * \param blocking whether to wait for the inbox lock
+   */
+  static inline bool TakeInbox(Worker* w, bool blocking, T* out) {
+    if (w->inbox_size.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock{w->mutex, std::defer_lock};
+    if (blocking) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      return false;
+    }
+    if (w->inbox.empty()) {
+      return false;
+    }
+    *out = w->inbox.front();
+    w->inbox.pop_front();
+    w->inbox_size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  /*! \brief non-blocking attempt to get a task: own deque, own inbox, then steal */
+  inline bool TryPop(int self, T* out) {
+    Worker* me = workers_[self].get();
+    if (me->deque.Pop(out) || TakeInbox(me, true, out)) {
+      return true;
+    }
+    const size_t n = workers_.size();
+    for (size_t i = 1; i < n; ++i) {
+      Worker* victim = workers_[(self + i) % n].get();
+      if (victim->deque.Steal(out) || TakeInbox(victim, false, out)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  /*! \brief per worker states */
+  std::vector<std::unique_ptr<Worker>> workers_;
+  /*! \brief round robin counter for pushes without affinity */
+  std::atomic<size_t> next_inbox_{0};
+  /*! \brief number of tasks pushed but not yet popped */
+  std::atomic<int64_t> pending_{0};
+  /*! \brief number of workers waiting on sleep_cv_ */
+  std::atomic<int> num_sleeping_{0};
+  /*! \brief whether the queue is signaled for kill */
+  std::atomic<bool> kill_{false};
+  /*! \brief mutex and condition variable for idle workers */
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingTaskQueue);
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_WORK_STEALING_QUEUE_H_
@@ -47,8 +47,8 @@ namespace exec {
 // FComputeExecutor and FStatefulComputeExecutor inherit from this class
 class StorageFallbackOpExecutor : public OpExecutor {
  public:
-  explicit StorageFallbackOpExecutor(std::vector<uint32_t> mutate_idx)
-      : mutate_idx_(std::move(mutate_idx)) {}
+  StorageFallbackOpExecutor(const nnvm::Op* op, std::vector<uint32_t> mutate_idx)
+      : op_(op), mutate_idx_(std::move(mutate_idx)) {}
 
   void Setup() override {
     init_ = false;
@@ -95,12 +95,12 @@ class StorageFallbackOpExecutor : public OpExecutor {
                            &post_temp_dst_,
                            &in_temp_idx_map_,
                            mutate_idx_);
-    common::CastNonDefaultStorage(pre_temp_src_, pre_temp_dst_, op_ctx, is_gpu);
+    common::CastNonDefaultStorage(pre_temp_src_, pre_temp_dst_, op_ctx, is_gpu, op_);
   }
 
   // storage fallback after fcompute is completed
   void PostFCompute(bool is_gpu) {
-    common::CastNonDefaultStorage(post_temp_src_, post_temp_dst_, op_ctx, is_gpu);
+    common::CastNonDefaultStorage(post_temp_src_, post_temp_dst_, op_ctx, is_gpu, op_);
     req = tmp_req;
   }
 
@@ -117,6 +117,8 @@ class StorageFallbackOpExecutor : public OpExecutor {
   std::vector<NDArray> pre_temp_dst_, post_temp_dst_;
   // mapping from index in input_blobs to index in pre_temp_dst
   std::unordered_map<uint32_t, uint32_t> in_temp_idx_map_;
+  // the operator, for the profiler
+  const nnvm::Op* op_;
   // indices of mutatable inputs
   std::vector<uint32_t> mutate_idx_;
   // whether blobs are initialized
@@ -146,11 +148,12 @@ class StatefulComputeExecutor : public StorageFallbackOpExecutor {
     return state_;
   }
 
-  explicit StatefulComputeExecutor(OpStatePtr state,
+  explicit StatefulComputeExecutor(const nnvm::Op* op,
+                                   OpStatePtr state,
                                    FStatefulCompute fcompute,
                                    ExecType exec_type,
                                    const std::vector<uint32_t>& mutate_idx)
-      : StorageFallbackOpExecutor(mutate_idx),
+      : StorageFallbackOpExecutor(op, mutate_idx),
         state_(std::move(state)),
         fcompute_(std::move(fcompute)),
         exec_type_(exec_type) {}
@@ -222,7 +225,7 @@ class FComputeExecutor : public StorageFallbackOpExecutor {
                             FCompute fcompute,
                             ExecType exec_type,
                             const std::vector<uint32_t>& mutate_idx)
-      : StorageFallbackOpExecutor(mutate_idx),
+      : StorageFallbackOpExecutor(attrs.op, mutate_idx),
         attrs_(std::move(attrs)),
         fcompute_(std::move(fcompute)),
         exec_type_(exec_type) {}
@@ -316,7 +319,8 @@ void CreateOpExecs(const Graph& g, OpExecVector* p_ret, OpStateVector* p_state,
       CHECK(fcompute != nullptr)
           << "One of FStatefulCompute and FStatefulComputeEx must be registered "
           << "for stateful operator " << op->name;
-      ret[i] = std::make_shared<StatefulComputeExecutor>(state, fcompute, exec_type, mutate_index);
+      ret[i] = std::make_shared<StatefulComputeExecutor>(
+          op, state, fcompute, exec_type, mutate_index);
     }
   } else if (is_layer_backward.get(op, false)) {
     CHECK_GE(inode.control_deps.size(), 1);
@@ -336,7 +340,7 @@ void CreateOpExecs(const Graph& g, OpExecVector* p_ret, OpStateVector* p_state,
           << "One of FStatefulCompute and FStatefulComputeEx must be registered "
           << "for stateful operator " << op->name;
       ret[i] = std::make_shared<StatefulComputeExecutor>(
-          ret[fwd_id].get()->state(), fcompute, exec_type, mutate_index);
+          op, ret[fwd_id].get()->state(), fcompute, exec_type, mutate_index);
     }
   } else {
     FCompute fcompute   = common::GetFCompute<FCompute>(op, "FCompute", vctx[i]);
@@ -72,7 +72,8 @@ void AttachOpResources(const Graph& g,
             requested.push_back(ResourceManager::Get()->Request(ctx, req));
             break;
           }
-          case ResourceRequest::kParallelRandom: {
+          case ResourceRequest::kParallelRandom:
+          case ResourceRequest::kCounterRandom: {
             requested.push_back(ResourceManager::Get()->Request(ctx, req));
             break;
           }
@@ -82,6 +83,12 @@ void AttachOpResources(const Graph& g,
             break;
           }
 #endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+          case ResourceRequest::kNCCLComm: {
+            requested.push_back(ResourceManager::Get()->Request(ctx, req));
+            break;
+          }
+#endif  // MXNET_USE_NCCL == 1
           default:
             LOG(FATAL) << "resource type " << req.type << " is not yet supported";
         }
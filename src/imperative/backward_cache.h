@@ -0,0 +1,222 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file backward_cache.h
+ * \brief Memoization of the gradient graphs of Imperative::Backward and of their inferred
+ *  attributes, for the tapes with the same structure and arrays as an earlier one.
+ */
+#ifndef MXNET_IMPERATIVE_BACKWARD_CACHE_H_
+#define MXNET_IMPERATIVE_BACKWARD_CACHE_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/imperative.h>
+#include <mxnet/ndarray.h>
+#include <nnvm/graph.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./cached_op.h"
+
+namespace mxnet {
+namespace imperative {
+
+/*!
+ * \brief the signature of the tape of a call of Imperative::Backward: the operators, attributes
+ *  and contexts of its nodes in DFS order, their inputs, the shapes, types and storage types of
+ *  their outputs and gradients, the entries differentiated and the head gradients
+ */
+class TapeSig {
+ public:
+  void Add(int64_t value) {
+    ints_.push_back(value);
+  }
+  void Add(const std::string& value) {
+    strs_.push_back(value);
+  }
+  void Add(const Context& ctx) {
+    Add(ctx.dev_type);
+    Add(ctx.dev_id);
+  }
+  void Add(const NDArray& array) {
+    Add(array.is_none());
+    if (array.is_none())
+      return;
+    Add(array.dtype());
+    Add(array.storage_type());
+    Add(array.shape().ndim());
+    for (int i = 0; i < array.shape().ndim(); ++i)
+      Add(array.shape()[i]);
+  }
+
+  size_t Hash() const {
+    size_t ret = ints_.size();
+    for (const int64_t i : ints_)
+      ret = dmlc::HashCombine(ret, i);
+    for (const auto& s : strs_)
+      ret = dmlc::HashCombine(ret, s);
+    return ret;
+  }
+
+  bool operator==(const TapeSig& other) const {
+    return ints_ == other.ints_ && strs_ == other.strs_;
+  }
+
+ private:
+  std::vector<int64_t> ints_;
+  std::vector<std::string> strs_;
+};
+
+/*!
+ * \brief the gradient graph of the tapes of a signature, copied off the tape, with its inferred
+ *  attributes as the graph attributes "shape", "dtype", "storage_type" and "dispatch_mode"
+ */
+struct BackwardPlan {
+  TapeSig sig;
+  nnvm::Graph graph;
+  size_t num_forward_nodes;
+  size_t num_forward_entries;
+  /*! \brief the entries of the head gradients, -1 for those the graph does not read */
+  std::vector<int64_t> ograd_eids;
+  /*! \brief the entries of the gradients of the marked non-leaf arrays */
+  std::vector<uint32_t> nleaf_grad_eids;
+  std::vector<Context> vctx;
+};
+
+/*!
+ * \brief the backward plans of the tapes of a thread, by the hash of their signature. The cache is
+ *  cleared when it holds MXNET_BACKWARD_CACHE_SIZE plans.
+ */
+class BackwardCache {
+ public:
+  static BackwardCache* Get() {
+    static thread_local BackwardCache inst;
+    return &inst;
+  }
+
+  /*!
+   * \brief the signature of the tape of sym, differentiated for xs from the head gradients of
+   *  ograd_entries, and its nodes in DFS order. Returns false when the gradient graphs of the
+   *  tape cannot be memoized: the cache is disabled, or the attributes of an operator are not
+   *  all in its dict.
+   */
+  bool Signature(const nnvm::Symbol& sym,
+                 const std::vector<nnvm::NodeEntry>& xs,
+                 const std::vector<nnvm::NodeEntry>& ograd_entries,
+                 TapeSig* sig,
+                 std::vector<const nnvm::Node*>* nodes) const {
+    static const nnvm::Op* cached_op     = nnvm::Op::Get("_CachedOp");
+    static const nnvm::Op* bwd_cached_op = nnvm::Op::Get("_backward_CachedOp");
+    if (capacity_ == 0)
+      return false;
+    sig->Add(Imperative::Get()->is_np_shape());
+    std::unordered_map<const nnvm::Node*, int64_t> node_ids;
+    bool cacheable = true;
+    nnvm::DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& n) {
+      if (!cacheable)
+        return;
+      node_ids.emplace(n.get(), nodes->size());
+      nodes->push_back(n.get());
+      const auto& info = Imperative::AGInfo::Get(n);
+      sig->Add(reinterpret_cast<int64_t>(n->op()));
+      sig->Add(info.ctx);
+      sig->Add(info.grad_req);
+      sig->Add(info.outputs.size());
+      for (const auto& output : info.outputs)
+        sig->Add(output);
+      sig->Add(info.out_grads.size());
+      for (const auto& grad : info.out_grads)
+        sig->Add(grad);
+      sig->Add(n->inputs.size());
+      for (const auto& e : n->inputs) {
+        sig->Add(node_ids.at(e.node.get()));
+        sig->Add(e.index);
+      }
+      sig->Add(n->control_deps.size());
+      for (const auto& dep : n->control_deps)
+        sig->Add(node_ids.at(dep.get()));
+      if (n->is_variable())
+        return;
+      if (n->op() == cached_op || n->op() == bwd_cached_op) {
+        sig->Add(reinterpret_cast<int64_t>(dmlc::get<CachedOpPtr>(n->attrs.parsed).get()));
+      } else if (n->attrs.dict.empty() && !n->attrs.parsed.empty()) {
+        cacheable = false;
+        return;
+      }
+      for (const auto& subgraph : n->attrs.subgraphs)
+        sig->Add(reinterpret_cast<int64_t>(subgraph.get()));
+      // the order of the entries of the dict is not defined
+      std::vector<std::pair<std::string, std::string>> dict(n->attrs.dict.begin(),
+                                                            n->attrs.dict.end());
+      std::sort(dict.begin(), dict.end());
+      sig->Add(dict.size());
+      for (const auto& kv : dict) {
+        sig->Add(kv.first);
+        sig->Add(kv.second);
+      }
+    });
+    if (!cacheable)
+      return false;
+    for (const auto& e : sym.outputs) {
+      sig->Add(node_ids.at(e.node.get()));
+      sig->Add(e.index);
+    }
+    sig->Add(xs.size());
+    for (const auto& e : xs) {
+      sig->Add(node_ids.at(e.node.get()));
+      sig->Add(e.index);
+    }
+    for (const auto& e : ograd_entries) {
+      const auto& info = Imperative::AGInfo::Get(e.node);
+      sig->Add(info.ctx);
+      sig->Add(info.outputs[0]);
+    }
+    return true;
+  }
+
+  const BackwardPlan* Find(const TapeSig& sig) const {
+    auto range = plans_.equal_range(sig.Hash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.sig == sig)
+        return &it->second;
+    }
+    return nullptr;
+  }
+
+  const BackwardPlan* Insert(BackwardPlan&& plan) {
+    if (plans_.size() >= capacity_)
+      plans_.clear();
+    const size_t hash = plan.sig.Hash();
+    return &plans_.emplace(hash, std::move(plan))->second;
+  }
+
+ private:
+  BackwardCache() : capacity_(std::max(dmlc::GetEnv("MXNET_BACKWARD_CACHE_SIZE", 16), 0)) {}
+
+  size_t capacity_;
+  std::unordered_multimap<size_t, BackwardPlan> plans_;
+};
+
+}  // namespace imperative
+}  // namespace mxnet
+
+#endif  // MXNET_IMPERATIVE_BACKWARD_CACHE_H_
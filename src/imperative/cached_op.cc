@@ -18,6 +18,7 @@
  */
 #include <memory>
 #include <unordered_set>
+#include <sstream>
 #include <iostream>
 #include "./imperative_utils.h"
 #include "./cached_op.h"
@@ -32,6 +33,43 @@ DMLC_REGISTER_PARAMETER(CachedOpConfig);
 
 constexpr uint32_t kEidNotExist = std::numeric_limits<uint32_t>::max();
 
+StaticMemoryArena* StaticMemoryArena::Get(const Context& ctx) {
+  static std::mutex mutex;
+  // leaked, the buffers must not be freed after the storage at exit
+  static auto* arenas = new std::unordered_map<Context, std::unique_ptr<StaticMemoryArena>>();
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& arena = (*arenas)[ctx];
+  if (!arena)
+    arena.reset(new StaticMemoryArena(ctx));
+  return arena.get();
+}
+
+std::multimap<size_t, NDArray> StaticMemoryArena::Borrow(std::vector<size_t> sizes) {
+  // the k-th largest buffer fits the k-th largest storage, so that AllocateMemory, which takes
+  // the smallest buffer fitting each storage, finds a buffer for all of them
+  std::sort(sizes.begin(), sizes.end(), std::greater<size_t>());
+  for (size_t k = 0; k < sizes.size(); ++k) {
+    if (k < buffers_.size() && buffers_[k].shape().Size() >= sizes[k])
+      continue;
+    NDArray buffer(
+        mxnet::TShape({static_cast<nnvm::dim_t>(sizes[k])}), ctx_, true, mshadow::kUint8);
+    buffer.AssignStorageInfo("<arena>:", "cached_op_static_memory");
+    if (k < buffers_.size()) {
+      buffers_[k] = buffer;
+    } else {
+      buffers_.push_back(buffer);
+    }
+    ++version_;
+  }
+  std::sort(buffers_.begin(), buffers_.end(), [](const NDArray& a, const NDArray& b) {
+    return a.shape().Size() > b.shape().Size();
+  });
+  std::multimap<size_t, NDArray> pool;
+  for (const NDArray& buffer : buffers_)
+    pool.emplace(buffer.shape().Size(), buffer);
+  return pool;
+}
+
 nnvm::Symbol CachedOp::GetOptimizedSymbol() const {
   nnvm::Symbol ret;
   ret.outputs = std::vector<nnvm::NodeEntry>(full_graph_.outputs.begin(),
@@ -48,6 +86,9 @@ CachedOp::CachedOp(const nnvm::Symbol& sym,
   if (config_.static_shape) {
     CHECK(config_.static_alloc) << "static_alloc must be True when static_shape is True";
   }
+  if (config_.share_static_alloc) {
+    CHECK(config_.static_alloc) << "static_alloc must be True when share_static_alloc is True";
+  }
 
   auto grad_graph = nnvm::Graph();
   std::unordered_map<uint32_t, uint32_t> fwd_input_to_grad_output;
@@ -222,10 +263,19 @@ bool CachedOp::SetForwardGraph(const Context& default_ctx,
     storage[idx.entry_id(idx.outputs()[i])] = exec::kExternalStorageID;
   }
 
+  bool view_outputs = dmlc::GetEnv("MXNET_EXEC_SLICE_VIEWS", true);
+#if MXNET_USE_ONEDNN == 1
+  // the oneDNN operators may keep their inputs in layouts a contiguous slice is not a view of
+  view_outputs = view_outputs && default_ctx.dev_mask() == Context::kGPU;
+#endif
   auto mem_plan                        = MXPlanMemory(&g,
                                std::move(storage),
                                g.GetAttr<std::vector<uint32_t> >(AddPrefix(prefix, REF_COUNT)),
-                               AddPrefix(prefix, STORAGE_PLAN));
+                               AddPrefix(prefix, STORAGE_PLAN),
+                               {0, 0},
+                               {0, 0},
+                               false,
+                               view_outputs);
   g.attrs[AddPrefix(prefix, MEM_PLAN)] = std::make_shared<dmlc::any>(std::move(mem_plan));
 
   return false;
@@ -367,17 +417,76 @@ bool CachedOp::SetBackwardGraph(GraphInfo* info,
   return false;
 }
 
-OpStatePtr CachedOp::GetCachedOpState(const Context& ctx) {
+OpStatePtr CachedOp::GetCachedOpState(const Context& ctx, const std::vector<NDArray*>* inputs) {
   std::lock_guard<std::mutex> lock(mutex_);
-  for (const auto& i : cached_op_states_[ctx]) {
-    // only create one state per device when not using static memory
-    if (!config_.static_alloc || i.unique()) {
-      return i;
+  auto& states = cached_op_states_[ctx];
+  if (inputs == nullptr) {
+    for (const auto& i : states) {
+      // only create one state per device when not using static memory
+      if (!config_.static_alloc || i.unique()) {
+        return i;
+      }
+    }
+  } else {
+    mxnet::ShapeVector shapes;
+    std::vector<int> dtypes;
+    shapes.reserve(inputs->size());
+    dtypes.reserve(inputs->size());
+    for (const NDArray* input : *inputs) {
+      shapes.push_back(input->shape());
+      dtypes.push_back(input->dtype());
+    }
+    // The graph of a state is rebuilt with recomputation once its input shapes are
+    // known, which only happens before it first runs. The recomputation is valid for
+    // any shapes, they only guide the choice of the kept activations.
+    auto plan_recompute = [&](CachedOpState* state, const OpStatePtr& state_ptr) {
+      if (config_.recompute == recompute::kNone || state->recompute_planned)
+        return;
+      if (!state_ptr.unique() || state->fwd_alloc || state->fwd_exec_init)
+        return;
+      RecomputeConfig recompute_config;
+      recompute_config.mode          = config_.recompute;
+      recompute_config.budget        = static_cast<size_t>(config_.recompute_budget_mb * (1 << 20));
+      recompute_config.in_arg_shapes = state->input_shapes;
+      recompute_config.in_arg_dtypes = state->input_dtypes;
+      state->InitGraph(fwd_graph_, inlining_, &recompute_config);
+    };
+    CachedOpState* lru        = nullptr;
+    const OpStatePtr* lru_ptr = nullptr;
+    for (const auto& i : states) {
+      // a state with static memory is busy while a forward or backward holds it
+      if (config_.static_alloc && !i.unique())
+        continue;
+      auto& state = i.get_state<CachedOpState>();
+      if (state.input_shapes == shapes && state.input_dtypes == dtypes) {
+        state.last_use = ++state_clock_;
+        plan_recompute(&state, i);
+        return i;
+      }
+      if (lru == nullptr || state.last_use < lru->last_use) {
+        lru     = &state;
+        lru_ptr = &i;
+      }
     }
+    if (lru != nullptr && states.size() >= config_.shape_cache_size) {
+      lru->input_shapes = std::move(shapes);
+      lru->input_dtypes = std::move(dtypes);
+      lru->last_use     = ++state_clock_;
+      plan_recompute(lru, *lru_ptr);
+      return *lru_ptr;
+    }
+    auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph_, inlining_);
+    auto& state        = state_ptr.get_state<CachedOpState>();
+    state.input_shapes = std::move(shapes);
+    state.input_dtypes = std::move(dtypes);
+    state.last_use     = ++state_clock_;
+    plan_recompute(&state, state_ptr);
+    states.push_back(state_ptr);
+    return state_ptr;
   }
   auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph_, inlining_);
 
-  cached_op_states_[ctx].push_back(state_ptr);
+  states.push_back(state_ptr);
   return state_ptr;
 }
 
@@ -435,7 +544,24 @@ void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bo
   }
 
   auto& reuse_pool = keep_fwd ? state.bwd_reuse_pool : state.fwd_reuse_pool;
-  reuse_pool       = imperative::AllocateMemory(g,
+  if (!keep_fwd) {
+    // the memory of the arena must not be kept by the forward pass of a backward pass
+    const bool arena = config_.share_static_alloc && !recording;
+    if (arena) {
+      std::vector<size_t> sizes;
+      for (size_t i = start_eid; i < end_eid; ++i) {
+        if (mem_plan[i].storage_id >= 0 && mem_plan[i].root == i)
+          sizes.push_back(mem_plan[i].size);
+      }
+      StaticMemoryArena* memory = StaticMemoryArena::Get(default_ctx);
+      reuse_pool                = memory->Borrow(std::move(sizes));
+      state.fwd_arena_version   = memory->version();
+    } else if (state.fwd_arena) {
+      reuse_pool.clear();
+    }
+    state.fwd_arena = arena;
+  }
+  reuse_pool = imperative::AllocateMemory(g,
                                           idx,
                                           default_ctx,
                                           start_eid,
@@ -515,6 +641,14 @@ void CachedOp::StaticInitExec(const OpStatePtr& state_ptr, bool recording, bool
         bulk_size = 0;
     }
 
+    // The independent branches go to separate segments, which the GPU workers of the engine
+    // run concurrently on their own streams.
+    std::vector<int> stream_group;
+    if (default_ctx.dev_mask() == Context::kGPU && dmlc::GetEnv("MXNET_EXEC_MULTI_STREAM", false))
+      stream_group = exec::AssignStreamGroups(idx, start_nid, end_nid);
+    const bool use_cuda_graphs =
+        cuda_graphs::CudaGraphsEnabled() || (MXNET_CUDA_GRAPHS_AVAILABLE && config_.cuda_graphs);
+
     CreateEngineOpSeg(idx,
                       default_ctx,
                       start_nid,
@@ -522,7 +656,9 @@ void CachedOp::StaticInitExec(const OpStatePtr& state_ptr, bool recording, bool
                       bulk_size,
                       state.execs,
                       skip_plus_node,
-                      &state.opr_segs);
+                      &state.opr_segs,
+                      use_cuda_graphs,
+                      stream_group);
   }
 
   if (keep_fwd) {
@@ -654,14 +790,57 @@ static void PrepareOutputs(const nnvm::Graph& g,
       INIT_DETACHED(outputs[i], arrays[eid]);
 
     arrays[eid] = outputs[i];
-    if (arrays[eid]->is_none())
+    if (arrays[eid]->is_none()) {
       arrays[eid]->ReInit(
           static_cast<NDArrayStorageType>(stypes[eid]), shapes[eid], default_ctx, dtypes[eid]);
+    } else if (shape_is_known(shapes[eid])) {
+      CHECK_EQ(outputs[i]->shape(), shapes[eid])
+          << "The array given for the output " << i << " of the CachedOp has the wrong shape";
+      CHECK_EQ(outputs[i]->dtype(), dtypes[eid])
+          << "The array given for the output " << i << " of the CachedOp has the wrong type";
+    }
     const nnvm::NodeAttrs& attrs = idx[idx.outputs()[i].node_id].source->attrs;
     outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
   }
 }
 
+bool CachedOp::SetStaticOutputs(const nnvm::Graph& g,
+                                const Context& default_ctx,
+                                const std::vector<NDArray*>& inputs,
+                                const std::vector<NDArray*>& outputs,
+                                CachedOpState* state) {
+  const auto& idx    = g.indexed_graph();
+  const auto& shapes = g.GetAttr<mxnet::ShapeVector>("shape");
+  const auto& dtypes = g.GetAttr<nnvm::DTypeVector>("dtype");
+  std::vector<int> uses(idx.num_node_entries(), 0);
+  for (const auto& e : idx.outputs())
+    ++uses[idx.entry_id(e)];
+  bool match = true;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const auto& e  = idx.outputs()[i];
+    const auto eid = idx.entry_id(e);
+    // The outputs which are inputs of the graph or are given twice, and the arrays not
+    // matching their outputs or given as inputs, are bound on every call by PrepareOutputs.
+    const NDArray& out = *outputs[i];
+    bool bound = !out.is_none() && !idx[e.node_id].source->is_variable() && uses[eid] == 1 &&
+                 out.storage_type() == kDefaultStorage && out.ctx() == default_ctx &&
+                 out.shape() == shapes[eid] && out.dtype() == dtypes[eid];
+    for (size_t j = 0; bound && j < inputs.size(); ++j)
+      bound = !inputs[j]->IsSame(out);
+    if (bound) {
+      if (state->dynamic_entries[eid] || !state->buff[eid].IsSame(out)) {
+        match            = false;
+        state->buff[eid] = out;
+      }
+    } else if (!state->dynamic_entries[eid]) {
+      match            = false;
+      state->buff[eid] = NDArray();
+    }
+    state->dynamic_entries[eid] = !bound;
+  }
+  return match;
+}
+
 OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
                                    const std::vector<NDArray*>& inputs,
                                    const std::vector<NDArray*>& outputs) {
@@ -669,7 +848,7 @@ OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
   using namespace imperative;
 
   bool recording = Imperative::Get()->is_recording();
-  auto state_ptr = GetCachedOpState(default_ctx);
+  auto state_ptr = GetCachedOpState(default_ctx, &inputs);
   auto& state    = state_ptr.get_state<CachedOpState>();
 
   // Need to lock the mutex on the state, this allows
@@ -678,9 +857,18 @@ OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
   // alloc allocates memory, and executors once and reuses the alloced memory
   // and executors for multiple forward invokes of the same op.
   std::lock_guard<std::mutex> lock(state.mutex);
+  // the forward passes borrowing the memory of the arena are pushed one at a time
+  StaticMemoryArena* arena = nullptr;
+  std::unique_lock<std::mutex> arena_lock;
+  if (config_.share_static_alloc && !recording) {
+    arena      = StaticMemoryArena::Get(default_ctx);
+    arena_lock = std::unique_lock<std::mutex>(arena->mutex);
+  }
 
   bool match = SetForwardGraph(default_ctx, &state.info, recording, inputs);
   match      = match && state.recording == recording;
+  if (arena != nullptr)
+    match = match && state.fwd_arena && state.fwd_arena_version == arena->version();
 
   nnvm::Graph& g  = state.info.fwd_graph;
   const auto& idx = g.indexed_graph();
@@ -714,6 +902,8 @@ OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
       arrays[idx.entry_id(nid, 0)] = inputs[state.info.input_map[i]];
     }
   }
+  if (config_.static_shape && !recording)
+    match = SetStaticOutputs(g, default_ctx, inputs, outputs, &state) && match;
 
   if (!state.fwd_exec_init || !match) {
     StaticInitExec(state_ptr, recording, false);
@@ -721,6 +911,10 @@ OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
 
   PrepareOutputs(g, default_ctx, outputs, &arrays, true);
   StaticRunOps(default_ctx, g, state_ptr, arrays, 0, idx.num_nodes());
+  if (arena != nullptr) {
+    // the operations of this pass in the bulk of the thread are pushed before the next pass
+    Engine::Get()->set_bulk_size(Engine::Get()->set_bulk_size(0));
+  }
 
   return recording ? state_ptr : OpStatePtr();
 }
@@ -737,12 +931,13 @@ OpStatePtr CachedOp::DynamicForward(const Context& default_ctx,
   auto op_state  = OpStatePtr::Create<DynamicRuntime>();
   auto& runtime  = op_state.get_state<DynamicRuntime>();
   {
-    auto state_ptr = GetCachedOpState(default_ctx);
+    auto state_ptr = GetCachedOpState(default_ctx, &inputs);
     auto& state    = state_ptr.get_state<CachedOpState>();
     std::lock_guard<std::mutex> lock(state.mutex);
     SetForwardGraph(default_ctx, &state.info, recording, inputs);
     runtime.info.fwd_graph = state.info.fwd_graph;
     runtime.info.input_map = state.info.input_map;
+    runtime.cached_state   = state_ptr;
   }
   nnvm::Graph& g  = runtime.info.fwd_graph;
   const auto& idx = g.indexed_graph();
@@ -804,8 +999,7 @@ OpStatePtr CachedOp::DynamicForward(const Context& default_ctx,
                   monitor_callback_,
                   monitor_all_);
     {
-      auto state_ptr    = GetCachedOpState(default_ctx);
-      auto& state       = state_ptr.get_state<CachedOpState>();
+      auto& state       = runtime.cached_state.get_state<CachedOpState>();
       auto copied_shape = shapes;
       std::lock_guard<std::mutex> lock(state.mutex);
       state.info.fwd_graph.attrs["shape"] = std::make_shared<dmlc::any>(std::move(copied_shape));
@@ -815,6 +1009,137 @@ OpStatePtr CachedOp::DynamicForward(const Context& default_ctx,
   return op_state;
 }
 
+void CachedOp::InitConstantFolding() {
+  const auto& idx = fwd_graph_.indexed_graph();
+  if (!common::CheckForInputNameDuplicates(idx)) {
+    LOG(WARNING) << "Graph contains duplicate names for some of its inputs - "
+                 << "constants are NOT folded!";
+    return;
+  }
+  std::unordered_set<std::string> params;
+  for (auto i : config_.param_indices)
+    params.insert(idx[idx.input_nodes()[i]].source->attrs.name);
+  std::vector<nnvm::NodeEntry> constants;
+  std::vector<std::string> constant_names;
+  nnvm::Graph folded = exec::FoldConstants(fwd_graph_, params, &constants, &constant_names);
+  if (constants.empty())
+    return;
+
+  std::unordered_map<std::string, size_t> input_pos;
+  for (size_t i = 0; i < idx.input_nodes().size(); ++i)
+    input_pos[idx[idx.input_nodes()[i]].source->attrs.name] = i;
+  for (size_t k = 0; k < constant_names.size(); ++k)
+    input_pos[constant_names[k]] = num_inputs() + k;
+
+  nnvm::Symbol constant_sym;
+  constant_sym.outputs = constants;
+  constant_op_ =
+      std::make_shared<CachedOp>(constant_sym, std::vector<std::pair<std::string, std::string>>());
+  for (const auto& name : constant_op_->ListForwardInputNames())
+    constant_op_inputs_.push_back(input_pos.at(name));
+
+  // the folded constants are parameters of the rest of the graph
+  nnvm::Symbol folded_sym;
+  folded_sym.outputs = folded.outputs;
+  std::vector<uint32_t> data_indices, param_indices;
+  const auto& folded_names = folded_sym.ListInputNames(nnvm::Symbol::kAll);
+  for (size_t i = 0; i < folded_names.size(); ++i) {
+    const size_t pos = input_pos.at(folded_names[i]);
+    if (pos >= num_inputs() || params.count(folded_names[i])) {
+      param_indices.push_back(i);
+    } else {
+      data_indices.push_back(i);
+    }
+    folded_op_inputs_.push_back(pos);
+  }
+  std::vector<std::pair<std::string, std::string>> flags;
+  for (const auto& flag : flags_) {
+    if (flag.first != "data_indices" && flag.first != "param_indices" &&
+        flag.first != "fold_constants")
+      flags.push_back(flag);
+  }
+  std::ostringstream os;
+  os << mxnet::Tuple<uint32_t>(data_indices.begin(), data_indices.end());
+  flags.emplace_back("data_indices", os.str());
+  os.str("");
+  os << mxnet::Tuple<uint32_t>(param_indices.begin(), param_indices.end());
+  flags.emplace_back("param_indices", os.str());
+  folded_op_ = std::make_shared<CachedOp>(folded_sym, flags);
+  if (monitor_callback_)
+    folded_op_->RegisterOpHook(monitor_callback_, monitor_all_);
+}
+
+bool CachedOp::GetFoldedInputs(const Context& default_ctx,
+                               const std::vector<NDArray*>& inputs,
+                               std::vector<NDArray*>* folded_inputs) {
+  std::lock_guard<std::mutex> lock(fold_mutex_);
+  if (!fold_init_) {
+    fold_init_ = true;
+    InitConstantFolding();
+  }
+  if (folded_op_ == nullptr)
+    return false;
+
+  bool stale = constants_.empty();
+  for (size_t k = 0; !stale && k < constant_op_inputs_.size(); ++k) {
+    const NDArray& src = *inputs[constant_op_inputs_[k]];
+    stale = !src.IsSame(constant_sources_[k]) || src.version() != constant_versions_[k];
+  }
+  if (stale) {
+    std::vector<NDArray*> constant_inputs;
+    constant_sources_.clear();
+    constant_versions_.clear();
+    for (const size_t i : constant_op_inputs_) {
+      constant_inputs.push_back(inputs[i]);
+      constant_sources_.push_back(*inputs[i]);
+      constant_versions_.push_back(inputs[i]->version());
+    }
+    constants_.assign(constant_op_->num_outputs(), NDArray());
+    std::vector<NDArray*> constant_outputs;
+    for (auto& constant : constants_)
+      constant_outputs.push_back(&constant);
+    constant_op_->Forward(constant_op_, constant_inputs, constant_outputs, default_ctx);
+  }
+
+  folded_inputs->clear();
+  for (const size_t i : folded_op_inputs_)
+    folded_inputs->push_back(i < inputs.size() ? inputs[i] : &constants_[i - inputs.size()]);
+  return true;
+}
+
+std::shared_ptr<CachedOp> CachedOp::GetPrunedOp() {
+  std::lock_guard<std::mutex> lock(prune_mutex_);
+  if (prune_init_)
+    return pruned_op_;
+  prune_init_ = true;
+
+  nnvm::Symbol sym;
+  sym.outputs = fwd_graph_.outputs;
+  sym         = sym.Copy();
+  nnvm::Graph g;
+  g.outputs = sym.outputs;
+  {
+    exec::PassTimer timer("PruneForInference");
+    sym.outputs = exec::PruneForInference(std::move(g)).outputs;
+  }
+  // the pruned graph reads the same inputs, in the same order
+  nnvm::Graph pruned;
+  pruned.outputs = sym.outputs;
+  if (pruned.indexed_graph().num_nodes() == fwd_graph_.indexed_graph().num_nodes() ||
+      sym.ListInputNames(nnvm::Symbol::kAll) != ListForwardInputNames())
+    return nullptr;
+
+  std::vector<std::pair<std::string, std::string>> flags;
+  for (const auto& flag : flags_) {
+    if (flag.first != "prune_for_inference")
+      flags.push_back(flag);
+  }
+  pruned_op_ = std::make_shared<CachedOp>(sym, flags);
+  if (monitor_callback_)
+    pruned_op_->RegisterOpHook(monitor_callback_, monitor_all_);
+  return pruned_op_;
+}
+
 OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
                              const std::vector<NDArray*>& inputs,
                              const std::vector<NDArray*>& outputs,
@@ -852,6 +1177,21 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
     }
   }
 
+  // inference runs the graph without the copies, see CachedOpConfig::prune_for_inference
+  if (config_.prune_for_inference && !Imperative::Get()->is_recording() &&
+      !Imperative::Get()->is_training()) {
+    const auto pruned_op = GetPrunedOp();
+    if (pruned_op != nullptr)
+      return pruned_op->Forward(pruned_op, inputs, outputs, default_ctx);
+  }
+
+  // inference reads the folded constants, training runs the whole graph
+  if (config_.fold_constants && !Imperative::Get()->is_recording()) {
+    std::vector<NDArray*> folded_inputs;
+    if (GetFoldedInputs(default_ctx, inputs, &folded_inputs))
+      return folded_op_->Forward(folded_op_, folded_inputs, outputs, default_ctx);
+  }
+
   int prev_bulk_size = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
 
   OpStatePtr op_state;
@@ -895,8 +1235,9 @@ void CachedOp::DynamicBackward(const bool retain_graph,
   Context default_ctx = outputs[0]->ctx();
   auto& runtime       = op_state.get_state<DynamicRuntime>();
   {
-    auto state_ptr = GetCachedOpState(default_ctx);
-    auto& state    = state_ptr.get_state<CachedOpState>();
+    auto state_ptr =
+        runtime.cached_state ? runtime.cached_state : GetCachedOpState(default_ctx);
+    auto& state = state_ptr.get_state<CachedOpState>();
     std::lock_guard<std::mutex> lock(state.mutex);
     state.info.fwd_graph = runtime.info.fwd_graph;
     state.info.input_map = runtime.info.input_map;
@@ -1271,6 +1612,14 @@ void CachedOp::RegisterOpHook(const CachedOp::CachedOpMonCallback& callback, boo
   CHECK(callback) << "invalid callback";
   monitor_callback_ = callback;
   monitor_all_      = monitor_all;
+  {
+    std::lock_guard<std::mutex> lock(fold_mutex_);
+    if (folded_op_ != nullptr)
+      folded_op_->RegisterOpHook(callback, monitor_all);
+  }
+  std::lock_guard<std::mutex> lock(prune_mutex_);
+  if (pruned_op_ != nullptr)
+    pruned_op_->RegisterOpHook(callback, monitor_all);
 }
 
 OpStatePtr CreateCachedOpState(const NodeAttrs& attrs,
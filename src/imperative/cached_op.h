@@ -27,7 +27,13 @@
 #include <utility>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
 #include "./imperative_utils.h"
@@ -210,11 +216,125 @@ void CreateForwardGraph(const nnvm::Symbol& sym, nnvm::Graph* fwd_graph) {
   }
 }
 
+namespace recompute {
+enum RecomputeMode { kNone, kSqrt, kBudget };
+}  // namespace recompute
+
+/*! \brief activation recomputation settings of a backward graph */
+struct RecomputeConfig {
+  int mode = recompute::kNone;
+  /*! \brief activation bytes between two checkpoints in budget mode */
+  size_t budget = 0;
+  mxnet::ShapeVector in_arg_shapes;
+  DTypeVector in_arg_dtypes;
+};
+
+/* \brief whether the backward graph may run a copy of node instead of keeping its outputs */
+bool CanRecompute(const nnvm::Node& node) {
+  static const auto& fstateful    = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static const auto& fmutate      = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+  static const auto& fresource    = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static const auto& fresource_ex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  if (node.is_variable())
+    return false;
+  // a second run must give the same outputs and leave the inputs alone
+  const nnvm::Op* op = node.op();
+  if (fstateful.count(op) || fmutate.count(op))
+    return false;
+  std::vector<ResourceRequest> reqs;
+  if (fresource_ex.count(op)) {
+    reqs = fresource_ex[op](node.attrs, cpu::kDevMask, DispatchMode::kFCompute);
+  } else if (fresource.count(op)) {
+    reqs = fresource[op](node.attrs);
+  }
+  for (const auto& req : reqs) {
+    if (req.type == ResourceRequest::kRandom || req.type == ResourceRequest::kParallelRandom ||
+        req.type == ResourceRequest::kCounterRandom)
+      return false;
+  }
+  return true;
+}
+
+/* \brief whether recomputing node costs more than keeping its outputs */
+bool IsComputeHeavy(const nnvm::Node& node) {
+  static const std::unordered_set<std::string> heavy_ops = {"Convolution",
+                                                            "Deconvolution",
+                                                            "FullyConnected",
+                                                            "RNN",
+                                                            "dot",
+                                                            "batch_dot",
+                                                            "_npi_matmul",
+                                                            "_npi_dot",
+                                                            "_npi_tensordot",
+                                                            "_npi_einsum"};
+  return heavy_ops.count(node.op()->name) != 0;
+}
+
+/*!
+ * \brief create the mirror function of the gradient pass that selects the forward
+ *  nodes whose outputs the backward graph recomputes instead of keeping.
+ *
+ *  The sqrt mode keeps every sqrt(N)-th of the N forward operators as a checkpoint.
+ *  The budget mode keeps the compute heavy operators and, in between, an operator
+ *  whenever the outputs since the last checkpoint exceed the budget. Operators that
+ *  cannot run twice are always kept. Returns nullptr if the shapes cannot be inferred.
+ */
+std::function<int(const nnvm::Node&)> CreateRecomputeFun(const nnvm::Graph& fwd_graph,
+                                                         const RecomputeConfig& config) {
+  nnvm::Graph g;
+  g.outputs = fwd_graph.outputs;
+  g         = exec::InferShape(std::move(g), mxnet::ShapeVector(config.in_arg_shapes));
+  g         = exec::InferType(std::move(g), DTypeVector(config.in_arg_dtypes));
+  if (g.GetAttr<size_t>("shape_num_unknown_nodes") != 0U ||
+      g.GetAttr<size_t>("dtype_num_unknown_nodes") != 0U) {
+    LOG(WARNING) << "Shapes of the graph are unknown, activations are not recomputed.";
+    return nullptr;
+  }
+  const auto& idx    = g.indexed_graph();
+  const auto& shapes = g.GetAttr<mxnet::ShapeVector>("shape");
+  const auto& dtypes = g.GetAttr<DTypeVector>("dtype");
+
+  size_t num_ops = 0;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (!idx[nid].source->is_variable())
+      ++num_ops;
+  }
+  const size_t segment = std::max<size_t>(1, std::lround(std::sqrt(num_ops)));
+
+  auto keep    = std::make_shared<std::unordered_set<const nnvm::Node*>>();
+  size_t since = 0;
+  size_t bytes = 0;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const nnvm::Node* node = idx[nid].source;
+    if (node->is_variable())
+      continue;
+    bool checkpoint = !CanRecompute(*node);
+    if (config.mode == recompute::kSqrt) {
+      checkpoint = checkpoint || ++since >= segment;
+    } else {
+      for (uint32_t i = 0; i < node->num_outputs(); ++i) {
+        const uint32_t eid = idx.entry_id(nid, i);
+        bytes += shapes[eid].Size() * mshadow::mshadow_sizeof(dtypes[eid]);
+      }
+      checkpoint = checkpoint || IsComputeHeavy(*node) || bytes > config.budget;
+    }
+    if (checkpoint) {
+      keep->insert(node);
+      since = 0;
+      bytes = 0;
+    }
+  }
+  return [keep](const nnvm::Node& node) {
+    return !node.is_variable() && keep->count(&node) == 0;
+  };
+}
+
 /* \brief construct grad_graph from fwd_graph and ograd_entries*/
 void CreateBackwardGraph(nnvm::Graph* fwd_graph,
                          nnvm::Graph* grad_graph,
                          std::vector<nnvm::NodeEntry>* ograd_entries,
-                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                         const RecomputeConfig* recompute_config = nullptr) {
   using namespace nnvm;
   static const std::vector<const Op*> zero_ops{Op::Get("zeros_like"), Op::Get("_zeros")};
   ograd_entries->reserve(fwd_graph->outputs.size());
@@ -244,15 +364,32 @@ void CreateBackwardGraph(nnvm::Graph* fwd_graph,
 
   // There are inputs in computation graph that require gradients
   if (!xs.empty()) {
+    std::function<int(const Node&)> mirror_fun = nullptr;
+    if (recompute_config != nullptr && recompute_config->mode != recompute::kNone)
+      mirror_fun = CreateRecomputeFun(*fwd_graph, *recompute_config);
+    exec::PassTimer timer("MXGradient");
     try {
-      *grad_graph = pass::MXGradient(*fwd_graph,
-                                     fwd_graph->outputs,
-                                     xs,
-                                     *ograd_entries,
-                                     mxnet::AggregateGradient,
-                                     nullptr,
-                                     zero_ops,
-                                     "_copy");
+      if (mirror_fun != nullptr) {
+        *grad_graph = pass::MXGradient(*fwd_graph,
+                                       fwd_graph->outputs,
+                                       xs,
+                                       *ograd_entries,
+                                       mxnet::AggregateGradient,
+                                       mirror_fun,
+                                       zero_ops,
+                                       "_copy",
+                                       recompute_config->in_arg_shapes,
+                                       recompute_config->in_arg_dtypes);
+      } else {
+        *grad_graph = pass::MXGradient(*fwd_graph,
+                                       fwd_graph->outputs,
+                                       xs,
+                                       *ograd_entries,
+                                       mxnet::AggregateGradient,
+                                       nullptr,
+                                       zero_ops,
+                                       "_copy");
+      }
     } catch (const nnvm::pass::InvalidGraphError& e) {
       *grad_graph = nnvm::Graph();
     }
@@ -267,16 +404,20 @@ void CreateFullGraph(const nnvm::Symbol& sym,
                      nnvm::Graph* grad_graph,
                      nnvm::Graph* full_graph,
                      std::vector<nnvm::NodeEntry>* ograd_entries,
-                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                     const RecomputeConfig* recompute_config = nullptr) {
   using namespace nnvm;
   CreateForwardGraph(sym, fwd_graph);
 
   bool do_elim_common_expr = dmlc::GetEnv("MXNET_ELIMINATE_COMMON_EXPR", true);
-  if (do_elim_common_expr)
+  if (do_elim_common_expr) {
+    exec::PassTimer timer("EliminateCommonExpr");
     *fwd_graph = exec::EliminateCommonExpr(std::move(*fwd_graph));
+  }
 
   // construct backward graph
-  CreateBackwardGraph(fwd_graph, grad_graph, ograd_entries, fwd_input_to_grad_output);
+  CreateBackwardGraph(
+      fwd_graph, grad_graph, ograd_entries, fwd_input_to_grad_output, recompute_config);
 
   full_graph->outputs = fwd_graph->outputs;
   // add backward graph outputs to full graph
@@ -337,12 +478,25 @@ void OptimizeGraph(nnvm::Graph* full_graph,
   input_map->resize(full_graph->indexed_graph().input_nodes().size());
   std::iota(input_map->begin(), input_map->end(), 0);
 #if MXNET_USE_CUDA && !defined(_WIN32)
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", true)) {
+  const bool gpu_fusion =
+      context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", true);
+#else
+  const bool gpu_fusion = false;
+  // Only warn user if MXNET_USE_FUSION env var is explicitly set
+  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
+    exec::WarnFusionNotSupported();
+  }
+#endif  // MXNET_USE_CUDA && !defined(_WIN32)
+  const bool cpu_fusion =
+      context.dev_mask() == kCPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION_CPU", false);
+  if (gpu_fusion || cpu_fusion) {
     nnvm::Graph unoptimized_graph;
     common::CopyGraph(&unoptimized_graph, *full_graph, false);
 
     if (common::CheckForInputNameDuplicates(unoptimized_graph.indexed_graph())) {
-      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs);
+      exec::PassTimer timer("FusePointwise");
+      *full_graph = gpu_fusion ? exec::FusePointwise(*full_graph, num_forward_outputs)
+                               : exec::FusePointwiseCPU(*full_graph, num_forward_outputs);
       // Fill in input_map - mapping from the new to the original input indices.
       const auto& original_inputs = unoptimized_graph.indexed_graph().input_nodes();
       const auto& new_inputs      = full_graph->indexed_graph().input_nodes();
@@ -369,12 +523,6 @@ void OptimizeGraph(nnvm::Graph* full_graph,
           << "Graph contains duplicate names for some of its inputs - fusion is NOT enabled!";
     }
   }
-#else
-  // Only warn user if MXNET_USE_FUSION env var is explicitly set
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
-    exec::WarnFusionNotSupported();
-  }
-#endif  // MXNET_USE_CUDA && !defined(_WIN32)
 
   *fwd_graph         = nnvm::Graph();
   fwd_graph->outputs = std::vector<nnvm::NodeEntry>(
@@ -415,7 +563,14 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   uint32_t backward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  bool share_static_alloc;
+  uint32_t shape_cache_size;
+  int recompute;
+  float recompute_budget_mb;
   bool is_dynamic;
+  bool fold_constants;
+  bool prune_for_inference;
+  bool cuda_graphs;
   mxnet::Tuple<uint32_t> data_indices;
   mxnet::Tuple<uint32_t> param_indices;
   std::string subgraph;
@@ -431,6 +586,33 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
             "Optimize for invariant input shapes between iterations. "
             "Must also set static_alloc to True. "
             "Change of input shapes is still allowed but slower.");
+    DMLC_DECLARE_FIELD(share_static_alloc)
+        .set_default(false)
+        .describe(
+            "Borrow the static memory of the intermediate arrays of the forward pass "
+            "from an arena shared by the CachedOps with share_static_alloc on the same "
+            "context, when not recording. Must also set static_alloc to True.");
+    DMLC_DECLARE_FIELD(shape_cache_size)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe(
+            "Maximum number of input shape signatures per context whose inferred "
+            "graph, memory plan and static memory are kept for reuse.");
+    DMLC_DECLARE_FIELD(recompute)
+        .set_default(recompute::kNone)
+        .add_enum("none", recompute::kNone)
+        .add_enum("sqrt", recompute::kSqrt)
+        .add_enum("budget", recompute::kBudget)
+        .describe(
+            "Recompute activations in the backward pass instead of keeping them. "
+            "'sqrt' keeps every sqrt(N)-th of the N forward operators, 'budget' keeps "
+            "the compute heavy operators and one operator per recompute_budget_mb of "
+            "activations.");
+    DMLC_DECLARE_FIELD(recompute_budget_mb)
+        .set_default(64.0f)
+        .set_lower_bound(0.0f)
+        .describe("Megabytes of activations recomputed between two kept operators "
+                  "when recompute is 'budget'.");
     DMLC_DECLARE_FIELD(inline_limit)
         .set_default(2)
         .describe("Maximum number of operators that can be inlined.");
@@ -452,9 +634,58 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
     DMLC_DECLARE_FIELD(is_dynamic)
         .set_default(false)
         .describe("Whether the graph contains dynamic shape operators.");
+    DMLC_DECLARE_FIELD(fold_constants)
+        .set_default(false)
+        .describe(
+            "Evaluate the operators computing only from parameters and constants once "
+            "for inference, recomputing them when a parameter is written.");
+    DMLC_DECLARE_FIELD(prune_for_inference)
+        .set_default(false)
+        .describe(
+            "Run the forward passes neither recorded nor training on a copy of the graph "
+            "without the operators copying their input at inference: BlockGrad, _copy and "
+            "the Dropouts whose masks are not read.");
+    DMLC_DECLARE_FIELD(cuda_graphs)
+        .set_default(false)
+        .describe(
+            "Capture the bulked GPU segments into CUDA graphs when static_alloc and "
+            "static_shape are True, as MXNET_ENABLE_CUDA_GRAPHS does for all the CachedOps.");
   }
 };
 
+/*!
+ * \brief Static memory shared by the forward passes of the CachedOps on a context.
+ *
+ *  The intermediate arrays of the CachedOps are views of the same buffers, so the memory is not
+ *  multiplied by the number of models. A forward pass borrows the buffers while it is pushed to
+ *  the engine, under the mutex, and the engine orders the accesses of the forward passes of the
+ *  models to the buffers as they were pushed.
+ */
+class StaticMemoryArena {
+ public:
+  static StaticMemoryArena* Get(const Context& ctx);
+  /*!
+   * \brief the buffers of the arena, grown for the given sizes of storage if needed, by size
+   *  for imperative::AllocateMemory
+   */
+  std::multimap<size_t, NDArray> Borrow(std::vector<size_t> sizes);
+  /*! \brief changes when buffers grow, after which the views of the old buffers are re-created */
+  uint64_t version() const {
+    return version_;
+  }
+
+  /*! \brief held while a forward pass borrowing the buffers is pushed */
+  std::mutex mutex;
+
+ private:
+  explicit StaticMemoryArena(const Context& ctx) : ctx_(ctx) {}
+
+  Context ctx_;
+  /*! \brief by decreasing size */
+  std::vector<NDArray> buffers_;
+  uint64_t version_ = 0;
+};
+
 namespace io {
 class LazyTransformDataset;
 }
@@ -538,20 +769,68 @@ class CachedOp {
                   const nnvm::Graph& full_graph_,
                   const bool inlining_) {
       context = context_;
+      InitGraph(fwd_graph_, inlining_);
+    }
+
+    /*!
+     * \brief (re)build the graphs of the state from the forward graph of the CachedOp.
+     *  Must only be called before the state runs.
+     */
+    void InitGraph(const nnvm::Graph& fwd_graph_,
+                   const bool inlining_,
+                   const RecomputeConfig* recompute_config = nullptr) {
+      info = GraphInfo();
       nnvm::Symbol sym;
       sym.outputs = fwd_graph_.outputs;
-      CreateFullGraph(sym.Copy(),
+      sym         = sym.Copy();
+      // cuDNN runs the convolutions of NHWC data on the tensor cores
+      if (context.dev_mask() == kGPU && dmlc::GetEnv("MXNET_USE_NHWC_LAYOUT", false)) {
+        exec::PassTimer timer("ConvertLayout");
+        nnvm::Graph g;
+        g.outputs   = sym.outputs;
+        sym.outputs = exec::ConvertLayout(std::move(g)).outputs;
+      }
+      // cuDNN adds the residual and applies the ReLU in its batch normalization kernels
+      if (context.dev_mask() == kGPU && dmlc::GetEnv("MXNET_USE_FUSED_BN_ADD_RELU", false)) {
+        exec::PassTimer timer("FuseBatchNormAddReLU");
+        nnvm::Graph g;
+        g.outputs   = sym.outputs;
+        sym.outputs = exec::FuseBatchNormAddReLU(std::move(g)).outputs;
+      }
+      // the self attentions run in one kernel, without materializing the attention maps
+      if (context.dev_mask() == kGPU && dmlc::GetEnv("MXNET_USE_FUSED_ATTENTION", false)) {
+        exec::PassTimer timer("FuseAttention");
+        nnvm::Graph g;
+        g.outputs   = sym.outputs;
+        sym.outputs = exec::FuseAttention(std::move(g)).outputs;
+      }
+      // the residual addition and dropout are computed in the pass of the layer normalization
+      if (dmlc::GetEnv("MXNET_USE_FUSED_LAYER_NORM", false)) {
+        exec::PassTimer timer("FuseAddDropoutLayerNorm");
+        nnvm::Graph g;
+        g.outputs   = sym.outputs;
+        sym.outputs = exec::FuseAddDropoutLayerNorm(std::move(g)).outputs;
+      }
+      // many small fully connected layers in parallel branches run as a few grouped GEMMs
+      if (dmlc::GetEnv("MXNET_USE_GROUPED_FC", false)) {
+        exec::PassTimer timer("GroupFullyConnected");
+        nnvm::Graph g;
+        g.outputs   = sym.outputs;
+        sym.outputs = exec::GroupFullyConnected(std::move(g)).outputs;
+      }
+      CreateFullGraph(sym,
                       &info.fwd_graph,
                       &info.grad_graph,
                       &info.full_graph,
                       &info.ograd_entries,
-                      &info.fwd_input_to_grad_output);
+                      &info.fwd_input_to_grad_output,
+                      recompute_config);
 
       OptimizeGraph(&info.full_graph,
                     &info.fwd_graph,
                     &info.grad_graph,
                     &info.input_map,
-                    context_,
+                    context,
                     fwd_graph_.outputs.size(),
                     inlining_);
 
@@ -562,6 +841,13 @@ class CachedOp {
       info.full_graph.attrs["context"] =
           std::make_shared<dmlc::any>(std::vector<Context>(max_nodes, context));
 
+      buff.clear();
+      arrays.clear();
+      array_reqs.clear();
+      dynamic_entries.clear();
+      op_states.clear();
+      execs.clear();
+      opr_segs.clear();
       buff.resize(max_entries);
       arrays.resize(max_entries);
       array_reqs.resize(max_entries);
@@ -569,6 +855,7 @@ class CachedOp {
       op_states.resize(max_nodes);
       execs.resize(max_nodes);
       opr_segs.resize(max_nodes);
+      recompute_planned = recompute_config != nullptr;
     }
 
     std::mutex mutex;
@@ -593,9 +880,27 @@ class CachedOp {
     std::vector<bool> dynamic_entries;
     std::multimap<size_t, NDArray> fwd_reuse_pool;
     std::multimap<size_t, NDArray> bwd_reuse_pool;
+    /*! \brief whether fwd_reuse_pool is borrowed from the StaticMemoryArena, at which version */
+    bool fwd_arena             = false;
+    uint64_t fwd_arena_version = 0;
+
+    /*! \brief shapes and types of the inputs the graph was last set up for */
+    mxnet::ShapeVector input_shapes;
+    std::vector<int> input_dtypes;
+    /*! \brief forward call count at the last use, for the LRU replacement */
+    uint64_t last_use = 0;
+    /*! \brief whether the backward graph was built with activation recomputation */
+    bool recompute_planned = false;
   };
 
-  OpStatePtr GetCachedOpState(const Context& ctx);
+  /*!
+   * \brief get a state for ctx. When the inputs are given, an idle state that was
+   *  last set up for the same input shapes and types is preferred, so that shape
+   *  and type inference, memory planning and static allocation are skipped.
+   *  Up to shape_cache_size states are kept per context, the least recently used
+   *  idle state is reused beyond that.
+   */
+  OpStatePtr GetCachedOpState(const Context& ctx, const std::vector<NDArray*>* inputs = nullptr);
   bool SetForwardGraph(const Context& default_ctx,
                        GraphInfo* info,
                        const bool recording,
@@ -615,6 +920,17 @@ class CachedOp {
                     const std::vector<NDArray*>& state_arrays,
                     size_t start_nid,
                     size_t end_nid);
+  /*!
+   * \brief binds the arrays given for the outputs of an inference pass with static shapes to
+   *  their entries, as the parameters, so that the operators writing them stay in the bulked
+   *  engine operations while the same arrays are given. Returns false when the bound arrays
+   *  change.
+   */
+  bool SetStaticOutputs(const nnvm::Graph& g,
+                        const Context& default_ctx,
+                        const std::vector<NDArray*>& inputs,
+                        const std::vector<NDArray*>& outputs,
+                        CachedOpState* state);
   OpStatePtr StaticForward(const Context& default_ctx,
                            const std::vector<NDArray*>& inputs,
                            const std::vector<NDArray*>& outputs);
@@ -636,6 +952,17 @@ class CachedOp {
                       const std::vector<OpReqType>& reqs,
                       const std::vector<NDArray*>& outputs);
   size_t BwdOriginalInput(const std::vector<size_t>& input_map, size_t new_i);
+  /*!
+   * \brief build the CachedOps of the constant folding on the first call. Returns false
+   *  when nothing is folded, otherwise sets the inputs of folded_op_, computing the
+   *  constants again if one of the parameters they are computed from changed.
+   */
+  bool GetFoldedInputs(const Context& default_ctx,
+                       const std::vector<NDArray*>& inputs,
+                       std::vector<NDArray*>* folded_inputs);
+  void InitConstantFolding();
+  /*! \brief the CachedOp of the graph pruned for inference, built on the first call, or null */
+  std::shared_ptr<CachedOp> GetPrunedOp();
 
   CachedOpConfig config_;
   nnvm::Graph fwd_graph_;
@@ -652,6 +979,27 @@ class CachedOp {
 
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr>> cached_op_states_;
+  uint64_t state_clock_ = 0;
+
+  /*! \brief constant folding, see CachedOpConfig::fold_constants */
+  std::mutex fold_mutex_;
+  bool fold_init_ = false;
+  /*! \brief computes the folded constants, and the rest of the graph from them */
+  std::shared_ptr<CachedOp> constant_op_, folded_op_;
+  /*!
+   * \brief inputs of constant_op_ and folded_op_: an input of this op, or the folded
+   *  constant num_inputs() places before
+   */
+  std::vector<size_t> constant_op_inputs_, folded_op_inputs_;
+  std::vector<NDArray> constants_;
+  /*! \brief inputs of constant_op_ and their versions when the constants were computed */
+  std::vector<NDArray> constant_sources_;
+  std::vector<size_t> constant_versions_;
+
+  /*! \brief pruning for inference, see CachedOpConfig::prune_for_inference */
+  std::mutex prune_mutex_;
+  bool prune_init_ = false;
+  std::shared_ptr<CachedOp> pruned_op_;
 
   friend class ::mxnet::io::LazyTransformDataset;
   nnvm::Symbol sym_;
@@ -662,6 +1010,8 @@ struct CachedOp::DynamicRuntime {
   GraphInfo info;
   std::vector<NDArray> buff;
   std::vector<OpStatePtr> op_states;
+  /*! \brief the cached state the forward graph was taken from */
+  OpStatePtr cached_state;
 };
 
 using CachedOpPtr = std::shared_ptr<CachedOp>;
@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cached_op_batcher.cc
+ * \brief Dynamic batching of the concurrent inference requests of a thread-safe cached op
+ */
+#include "./cached_op_batcher.h"
+
+#include <mxnet/imperative.h>
+#include <algorithm>
+#include <utility>
+
+namespace mxnet {
+
+CachedOpBatcher::CachedOpBatcher(const CachedOpThreadSafePtr& op,
+                                 uint32_t max_batch,
+                                 uint32_t timeout_us)
+    : op_(op), max_batch_(max_batch), timeout_(timeout_us) {
+  CHECK_GE(max_batch, 1U) << "max_batch must be positive";
+  is_data_.resize(op_->num_inputs(), false);
+  for (const uint32_t i : op_->data_indices())
+    is_data_[i] = true;
+  thread_ = std::thread([this]() { Run(); });
+}
+
+CachedOpBatcher::~CachedOpBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+std::vector<NDArray> CachedOpBatcher::Invoke(const std::vector<NDArray>& inputs) {
+  CHECK_EQ(inputs.size(), is_data_.size())
+      << "CachedOp expects " << is_data_.size() << " inputs, but " << inputs.size() << " given";
+  std::unique_ptr<Request> request(new Request());
+  request->inputs   = inputs;
+  request->np_shape = Imperative::Get()->is_np_shape();
+  request->rows     = 0;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!is_data_[i])
+      continue;
+    const NDArray& input = inputs[i];
+    CHECK_EQ(input.storage_type(), kDefaultStorage) << "Only dense data inputs can be batched";
+    CHECK_GE(input.shape().ndim(), 1) << "Data inputs are batched along their first axis";
+    CHECK(request->rows == 0 || request->rows == static_cast<size_t>(input.shape()[0]))
+        << "The data inputs of a request must have the same number of rows";
+    request->rows = input.shape()[0];
+  }
+  CHECK_GT(request->rows, 0U) << "A request must have a non-empty data input";
+  request->arrival = std::chrono::steady_clock::now();
+  std::future<std::vector<NDArray>> outputs = request->outputs.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_rows_ += request->rows;
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_all();
+  return outputs.get();
+}
+
+bool CachedOpBatcher::Compatible(const Request& head, const Request& request) const {
+  if (request.np_shape != head.np_shape)
+    return false;
+  for (size_t i = 0; i < head.inputs.size(); ++i) {
+    const NDArray& a = head.inputs[i];
+    const NDArray& b = request.inputs[i];
+    if (!is_data_[i]) {
+      if (!a.IsSame(b))
+        return false;
+      continue;
+    }
+    if (a.ctx() != b.ctx() || a.dtype() != b.dtype() || a.shape().ndim() != b.shape().ndim() ||
+        !std::equal(a.shape().begin() + 1, a.shape().end(), b.shape().begin() + 1))
+      return false;
+  }
+  return true;
+}
+
+size_t CachedOpBatcher::BatchRows(size_t rows) const {
+  if (rows >= max_batch_)
+    return rows;
+  size_t batch_rows = 1;
+  while (batch_rows < rows)
+    batch_rows <<= 1;
+  return std::min(batch_rows, max_batch_);
+}
+
+void CachedOpBatcher::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    // wait for a full batch, up to the timeout of the oldest request
+    cv_.wait_until(lock, queue_.front()->arrival + timeout_, [this]() {
+      return stop_ || queued_rows_ >= max_batch_;
+    });
+    std::vector<std::unique_ptr<Request>> batch;
+    batch.push_back(std::move(queue_.front()));
+    queue_.pop_front();
+    size_t rows = batch[0]->rows;
+    for (auto it = queue_.begin(); it != queue_.end() && rows < max_batch_;) {
+      if ((*it)->rows + rows <= max_batch_ && Compatible(*batch[0], **it)) {
+        rows += (*it)->rows;
+        batch.push_back(std::move(*it));
+        it = queue_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    queued_rows_ -= rows;
+    lock.unlock();
+    RunBatch(batch);
+    lock.lock();
+  }
+}
+
+void CachedOpBatcher::RunBatch(const std::vector<std::unique_ptr<Request>>& batch) {
+  const Request& head = *batch[0];
+  std::vector<std::vector<NDArray>> results(batch.size());
+  try {
+    // the requests may come from threads with their numpy shape semantics on
+    const int np_shape = Imperative::Get()->is_np_shape();
+    if (head.np_shape == NumpyShape::ThreadLocalOn ||
+        (head.np_shape == NumpyShape::Off && np_shape == NumpyShape::ThreadLocalOn))
+      Imperative::Get()->set_is_np_shape(head.np_shape);
+    size_t rows = 0;
+    for (const auto& request : batch)
+      rows += request->rows;
+    const size_t batch_rows = BatchRows(rows);
+    std::vector<NDArray> inputs(head.inputs);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (!is_data_[i] || (batch.size() == 1 && batch_rows == rows))
+        continue;
+      mxnet::TShape shape = head.inputs[i].shape();
+      shape[0]            = batch_rows;
+      inputs[i]           = NDArray(shape, head.inputs[i].ctx(), false, head.inputs[i].dtype());
+      size_t begin        = 0;
+      for (const auto& request : batch) {
+        NDArray rows_of_request = inputs[i].Slice(begin, begin + request->rows);
+        CopyFromTo(request->inputs[i], &rows_of_request);
+        begin += request->rows;
+      }
+      if (begin < batch_rows) {
+        NDArray padding = inputs[i].Slice(begin, batch_rows);
+        padding         = 0;
+      }
+    }
+    std::vector<NDArray> outputs(op_->num_outputs());
+    std::vector<NDArray*> input_ptrs, output_ptrs;
+    for (NDArray& input : inputs)
+      input_ptrs.push_back(&input);
+    for (NDArray& output : outputs)
+      output_ptrs.push_back(&output);
+    op_->Forward(op_, input_ptrs, output_ptrs, head.inputs[0].ctx());
+
+    for (const NDArray& output : outputs) {
+      CHECK(output.storage_type() == kDefaultStorage && output.shape().ndim() >= 1 &&
+            static_cast<size_t>(output.shape()[0]) == batch_rows)
+          << "The outputs of a batched CachedOp must have the rows of the batch on their first "
+          << "axis, but an output has shape " << output.shape();
+      size_t begin = 0;
+      for (size_t j = 0; j < batch.size(); ++j) {
+        results[j].push_back(output.Slice(begin, begin + batch[j]->rows));
+        begin += batch[j]->rows;
+      }
+    }
+  } catch (...) {
+    for (const auto& request : batch)
+      request->outputs.set_exception(std::current_exception());
+    return;
+  }
+  for (size_t j = 0; j < batch.size(); ++j)
+    batch[j]->outputs.set_value(std::move(results[j]));
+}
+
+}  // namespace mxnet
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cached_op_batcher.h
+ * \brief Dynamic batching of the concurrent inference requests of a thread-safe cached op
+ */
+#ifndef MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+#define MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+
+#include <mxnet/ndarray.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./cached_op_threadsafe.h"
+
+namespace mxnet {
+
+/*!
+ * \brief Coalesces the concurrent calls of a thread-safe cached op into batches.
+ *
+ *  The data inputs of the requests are concatenated along their first axis into a batch of up to
+ *  max_batch rows, padded to the next power of two, or to max_batch, so that the cached op sees a
+ *  few batch shapes only. The batch runs as one forward pass, which starts when max_batch rows are
+ *  queued or timeout_us after the oldest request, and each request gets the rows of the outputs
+ *  of its inputs. A request with more than max_batch rows runs alone.
+ */
+class CachedOpBatcher {
+ public:
+  CachedOpBatcher(const CachedOpThreadSafePtr& op, uint32_t max_batch, uint32_t timeout_us);
+  ~CachedOpBatcher();
+  /*!
+   * \brief queues a request and waits for its batch to be pushed to the engine
+   * \param inputs the inputs of the cached op, the data inputs of which have their rows of the
+   *  batch along their first axis, and the parameters of which are the same arrays as the ones
+   *  of the requests batched together
+   * \return the outputs of the request, views of the rows of the outputs of the batch
+   */
+  std::vector<NDArray> Invoke(const std::vector<NDArray>& inputs);
+
+ private:
+  struct Request {
+    std::vector<NDArray> inputs;
+    int np_shape;
+    size_t rows;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<std::vector<NDArray>> outputs;
+  };
+
+  /*! \brief whether the request can be in the batch of head */
+  bool Compatible(const Request& head, const Request& request) const;
+  /*! \brief the rows of the batch of rows rows of requests */
+  size_t BatchRows(size_t rows) const;
+  /*! \brief forms the batches of the queued requests and runs them */
+  void Run();
+  void RunBatch(const std::vector<std::unique_ptr<Request>>& batch);
+
+  CachedOpThreadSafePtr op_;
+  std::vector<bool> is_data_;
+  size_t max_batch_;
+  std::chrono::microseconds timeout_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<Request>> queue_;
+  size_t queued_rows_ = 0;
+  bool stop_          = false;
+  std::thread thread_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
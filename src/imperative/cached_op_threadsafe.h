@@ -44,6 +44,7 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
   uint32_t forward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  bool share_static_alloc;
   DMLC_DECLARE_PARAMETER(CachedOpThreadSafeConfig) {
     DMLC_DECLARE_FIELD(static_alloc)
         .set_default(false)
@@ -56,6 +57,11 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
             "Optimize for invariant input shapes between iterations. "
             "Must also set static_alloc to True. "
             "Change of input shapes is still allowed but slower.");
+    DMLC_DECLARE_FIELD(share_static_alloc)
+        .set_default(false)
+        .describe(
+            "Borrow the static memory of the intermediate arrays from an arena shared by "
+            "the CachedOps with share_static_alloc on the same context.");
     DMLC_DECLARE_FIELD(forward_bulk_size)
         .set_default(Imperative::BulkExecMaxNodeTrainFwd())
         .describe("Segment size of bulk execution during dynamic forward");
@@ -90,6 +96,10 @@ class CachedOpThreadSafe : public CachedOp {
   const std::unordered_set<uint32_t>& mutable_input_nodes() const {
     return fwd_graph_.indexed_graph().mutable_input_nodes();
   }
+  /*! \brief the positions of the inputs which are data, not parameters */
+  const mxnet::Tuple<uint32_t>& data_indices() const {
+    return config_.data_indices;
+  }
   OpStatePtr Forward(const std::shared_ptr<CachedOp>& op_ptr,
                      const std::vector<NDArray*>& inputs,
                      const std::vector<NDArray*>& outputs,
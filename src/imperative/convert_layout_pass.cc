@@ -0,0 +1,255 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file convert_layout_pass.cc
+ * \brief Run the regions of 2D convolutions of a graph in the NHWC layout
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+#include <mxnet/tuple.h>
+
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+/*! \brief how a node depends on the layout of its data */
+enum LayoutClass {
+  /*! \brief needs its data in NCHW, or a variable */
+  kFixed,
+  /*! \brief 2D operator with a layout attribute */
+  kSpatial,
+  /*! \brief elementwise operator, computes the same in any layout */
+  kAgnostic,
+};
+
+/*! \brief elementwise operators whose inputs and outputs have the same shape */
+const std::unordered_set<std::string> kElementwiseOps = {
+    "Activation",    "LeakyReLU",     "Dropout",          "relu",           "sigmoid",
+    "tanh",          "_npx_relu",     "_npx_sigmoid",     "elemwise_add",   "elemwise_sub",
+    "elemwise_mul",  "add_n",         "_copy",            "clip",           "Cast",
+    "amp_cast",      "_plus_scalar",  "_minus_scalar",    "_mul_scalar",    "_div_scalar",
+    "_npi_add_scalar", "_npi_multiply_scalar"};
+
+/*! \brief broadcasting operators, agnostic when all their inputs are in the same layout */
+const std::unordered_set<std::string> kBroadcastOps = {
+    "_npi_add", "_npi_subtract", "_npi_multiply", "broadcast_add", "broadcast_mul"};
+
+std::string GetAttr(const Node* n, const std::string& key) {
+  const auto it = n->attrs.dict.find(key);
+  return it == n->attrs.dict.end() ? std::string() : it->second;
+}
+
+/*! \brief whether a Convolution or Pooling computes a 2D operation in NCHW on cuDNN */
+bool Is2DNCHW(const Node* n) {
+  const std::string layout = GetAttr(n, "layout");
+  if (!layout.empty() && layout != "NCHW" && layout != "None")
+    return false;
+  const std::string cudnn_off = GetAttr(n, "cudnn_off");
+  if (cudnn_off == "True" || cudnn_off == "true" || cudnn_off == "1")
+    return false;
+  mxnet::TShape kernel;
+  std::istringstream is(GetAttr(n, "kernel"));
+  // a global pooling without kernel or layout does not tell its dimension
+  return (is >> kernel) && kernel.ndim() == 2;
+}
+
+bool IsLayoutInput(LayoutClass c, uint32_t i) {
+  return c == kAgnostic || (c == kSpatial && i == 0);
+}
+
+bool IsLayoutOutput(LayoutClass c, uint32_t i) {
+  return c == kAgnostic || (c == kSpatial && i == 0);
+}
+
+uint32_t FindRoot(std::vector<uint32_t>* parent, uint32_t i) {
+  while ((*parent)[i] != i) {
+    (*parent)[i] = (*parent)[(*parent)[i]];
+    i            = (*parent)[i];
+  }
+  return i;
+}
+
+/*! \brief entry e transposed by axes, shared by all the consumers of e */
+NodeEntry Transposed(const NodeEntry& e,
+                     const std::string& axes,
+                     const std::string& suffix,
+                     nnvm::NodeEntryMap<NodeEntry>* cache) {
+  auto it = cache->find(e);
+  if (it != cache->end())
+    return it->second;
+  static const Op* transpose_op = Op::Get("transpose");
+  ObjectPtr node                = Node::Create();
+  node->attrs.op                = transpose_op;
+  node->attrs.name              = e.node->attrs.name + "_" + std::to_string(e.index) + suffix;
+  node->attrs.dict["axes"]      = axes;
+  transpose_op->attr_parser(&node->attrs);
+  node->inputs.push_back(e);
+  NodeEntry ret{node, 0, 0};
+  cache->emplace(e, ret);
+  return ret;
+}
+
+}  // namespace
+
+Graph ConvertLayout(Graph&& g) {
+  const IndexedGraph& idx  = g.indexed_graph();
+  const uint32_t num_nodes = idx.num_nodes();
+  static const Op* conv_op = Op::Get("Convolution");
+  static const Op* pool_op = Op::Get("Pooling");
+  static const Op* bn_op   = Op::Get("BatchNorm");
+
+  // classify the nodes, in topological order
+  std::vector<LayoutClass> node_class(num_nodes, kFixed);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    const Node* n = idx[nid].source;
+    if (n->is_variable())
+      continue;
+    if (n->op() == conv_op || n->op() == pool_op) {
+      node_class[nid] = Is2DNCHW(n) ? kSpatial : kFixed;
+    } else if (n->op() == bn_op) {
+      const std::string axis = GetAttr(n, "axis");
+      node_class[nid]        = axis.empty() || axis == "1" ? kSpatial : kFixed;
+    } else if (kElementwiseOps.count(n->op()->name)) {
+      const bool per_channel = GetAttr(n, "act_type") == "prelu" ||
+                               (!GetAttr(n, "axes").empty() && GetAttr(n, "axes") != "()");
+      node_class[nid] = per_channel ? kFixed : kAgnostic;
+    } else if (kBroadcastOps.count(n->op()->name)) {
+      // the inputs of other shapes, e.g. a bias, are laid out for NCHW
+      bool same_layout = true;
+      for (const auto& e : idx[nid].inputs)
+        same_layout = same_layout && IsLayoutOutput(node_class[e.node_id], e.index);
+      node_class[nid] = same_layout ? kAgnostic : kFixed;
+    }
+  }
+
+  // regions of nodes exchanging data in the same layout
+  std::vector<uint32_t> parent(num_nodes);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid)
+    parent[nid] = nid;
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (node_class[nid] == kFixed)
+      continue;
+    const auto& inputs = idx[nid].inputs;
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+      const auto& e = inputs[i];
+      if (IsLayoutInput(node_class[nid], i) && IsLayoutOutput(node_class[e.node_id], e.index))
+        parent[FindRoot(&parent, nid)] = FindRoot(&parent, e.node_id);
+    }
+  }
+
+  // A region is converted when its convolutions are at least as many as the transposes
+  // of the data entering or leaving it.
+  std::vector<uint32_t> num_convs(num_nodes, 0);
+  std::vector<std::unordered_set<uint32_t>> boundary(num_nodes);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    const bool in_region = node_class[nid] != kFixed;
+    const uint32_t root  = in_region ? FindRoot(&parent, nid) : nid;
+    if (in_region && idx[nid].source->op() == conv_op)
+      ++num_convs[root];
+    const auto& inputs = idx[nid].inputs;
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+      const auto& e        = inputs[i];
+      const uint32_t eid   = idx.entry_id(e);
+      const bool src       = IsLayoutOutput(node_class[e.node_id], e.index);
+      const bool dst       = in_region && IsLayoutInput(node_class[nid], i);
+      const bool same_root = src && dst && FindRoot(&parent, e.node_id) == root;
+      if (dst && !same_root)
+        boundary[root].insert(eid);
+      if (src && !same_root)
+        boundary[FindRoot(&parent, e.node_id)].insert(eid);
+    }
+  }
+  for (const auto& e : idx.outputs()) {
+    if (IsLayoutOutput(node_class[e.node_id], e.index))
+      boundary[FindRoot(&parent, e.node_id)].insert(idx.entry_id(e));
+  }
+  std::vector<bool> converted(num_nodes, false);
+  bool any_converted = false;
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (node_class[nid] == kFixed)
+      continue;
+    const uint32_t root = FindRoot(&parent, nid);
+    converted[nid]      = num_convs[root] > 0 && num_convs[root] >= boundary[root].size();
+    any_converted       = any_converted || converted[nid];
+  }
+  if (!any_converted)
+    return std::move(g);
+
+  // insert the transposes and switch the converted operators to NHWC
+  auto is_nhwc = [&](const IndexedGraph::NodeEntry& e) {
+    return converted[e.node_id] && IsLayoutOutput(node_class[e.node_id], e.index);
+  };
+  nnvm::NodeEntryMap<NodeEntry> to_nhwc, to_nchw, weights;
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    if (n->is_variable())
+      continue;
+    const auto& inputs = idx[nid].inputs;
+    for (uint32_t i = 0; i < inputs.size(); ++i) {
+      const bool src_nhwc = is_nhwc(inputs[i]);
+      NodeEntry& e        = n->inputs[i];
+      if (converted[nid] && IsLayoutInput(node_class[nid], i)) {
+        if (!src_nhwc)
+          e = Transposed(e, "(0, 2, 3, 1)", "_nhwc", &to_nhwc);
+        continue;
+      }
+      if (src_nhwc)
+        e = Transposed(e, "(0, 3, 1, 2)", "_nchw", &to_nchw);
+      // the weights of a NHWC convolution are OHWI
+      if (converted[nid] && n->op() == conv_op && i == 1)
+        e = Transposed(e, "(0, 2, 3, 1)", "_ohwi", &weights);
+    }
+    if (converted[nid] && node_class[nid] == kSpatial) {
+      if (n->op() == bn_op) {
+        n->attrs.dict["axis"] = "3";
+      } else {
+        n->attrs.dict["layout"] = "NHWC";
+      }
+      n->op()->attr_parser(&n->attrs);
+    }
+  }
+  for (uint32_t i = 0; i < g.outputs.size(); ++i) {
+    if (is_nhwc(idx.outputs()[i]))
+      g.outputs[i] = Transposed(g.outputs[i], "(0, 3, 1, 2)", "_nchw", &to_nchw);
+  }
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+}  // namespace exec
+}  // namespace mxnet
@@ -0,0 +1,290 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cuda_graphs.h
+ * \brief Capture and replay of the bulked segments of a static CachedOp with CUDA graphs.
+ */
+#ifndef MXNET_IMPERATIVE_CUDA_GRAPHS_H_
+#define MXNET_IMPERATIVE_CUDA_GRAPHS_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+#include <mxnet/resource.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./exec_pass.h"
+
+#if MXNET_USE_CUDA
+#include <cuda_runtime.h>
+#include "../common/cuda/utils.h"
+#endif
+
+#if MXNET_USE_CUDA && CUDART_VERSION >= 10000
+#define MXNET_CUDA_GRAPHS_AVAILABLE 1
+#else
+#define MXNET_CUDA_GRAPHS_AVAILABLE 0
+#endif
+
+namespace mxnet {
+namespace cuda_graphs {
+
+/*!
+ * \brief whether static CachedOps capture their GPU segments into CUDA graphs.
+ *  Checked whenever the executors of a CachedOp are (re)initialized.
+ */
+inline bool CudaGraphsEnabled() {
+  return MXNET_CUDA_GRAPHS_AVAILABLE && dmlc::GetEnv("MXNET_ENABLE_CUDA_GRAPHS", false);
+}
+
+/*! \brief whether to log the capture decisions */
+inline bool CudaGraphsVerbose() {
+  static const bool verbose = dmlc::GetEnv("MXNET_CUDA_GRAPHS_VERBOSE", false);
+  return verbose;
+}
+
+#if MXNET_CUDA_GRAPHS_AVAILABLE
+
+/*!
+ * \brief Executes the operators of one bulked engine segment, replaying them from
+ *  CUDA graphs where possible.
+ *
+ *  The segment is split into runs of consecutive capturable operators. The first run
+ *  of a segment is eager, so that one-off host work such as cuDNN autotuning and lazy
+ *  temp space allocation happens outside of the capture. The second run captures each
+ *  capturable run into a graph and later runs replay it. A run whose capture fails,
+ *  e.g. because an operator synchronizes with the host, falls back to eager execution
+ *  for the lifetime of the segment.
+ *
+ *  The arrays of a static CachedOp segment keep their memory between calls and the
+ *  segment is rebuilt whenever shapes or parameters change, so no graph update is
+ *  needed. Temp space is validated before each replay since it is shared between
+ *  operators and can be reallocated by a larger request.
+ */
+class CudaGraphsExec {
+ public:
+  CudaGraphsExec(const std::vector<std::shared_ptr<exec::OpExecutor> >& execs,
+                 std::vector<nnvm::NodeAttrs> attrs,
+                 std::string opr_names)
+      : execs_(execs), attrs_(std::move(attrs)), opr_names_(std::move(opr_names)) {
+    CHECK_EQ(execs_.size(), attrs_.size());
+  }
+
+  /*!
+   * \brief run all operators of the segment on the stream of rctx.
+   *  The caller synchronizes the stream afterwards.
+   */
+  void RunAll(const RunContext& rctx) {
+    // The graphs differ between training and inference, e.g. for BatchNorm.
+    const bool is_train = execs_.size() && execs_[0]->op_ctx.is_train;
+    auto& cache         = cache_[is_train];
+    if (!cache.initialized) {
+      InitSubSegs(is_train, &cache);
+      for (const auto& exec : execs_)
+        exec->Run(rctx, true);
+      return;
+    }
+    cudaStream_t stream = mshadow::Stream<gpu>::GetStream(rctx.get_stream<gpu>());
+    for (auto& subseg : cache.subsegs) {
+      if (!subseg.capturable) {
+        RunEager(subseg, rctx);
+        continue;
+      }
+      if (subseg.graph_exec != nullptr && TempSpaceChanged(subseg))
+        subseg.Reset();
+      if (subseg.graph_exec == nullptr && !Capture(&subseg, rctx, stream)) {
+        RunEager(subseg, rctx);
+        continue;
+      }
+      CUDA_CALL(cudaGraphLaunch(subseg.graph_exec, stream));
+    }
+  }
+
+ private:
+  /*! \brief a run of consecutive operators that are either all captured or all eager */
+  struct SubSeg {
+    size_t begin;
+    size_t end;
+    bool capturable;
+    cudaGraphExec_t graph_exec = nullptr;
+    /*! \brief temp space pointers baked into the graph */
+    std::vector<void*> temp_space;
+
+    SubSeg(size_t begin, size_t end, bool capturable)
+        : begin(begin), end(end), capturable(capturable) {}
+    SubSeg(const SubSeg&) = delete;
+    SubSeg(SubSeg&& other) noexcept
+        : begin(other.begin),
+          end(other.end),
+          capturable(other.capturable),
+          graph_exec(other.graph_exec),
+          temp_space(std::move(other.temp_space)) {
+      other.graph_exec = nullptr;
+    }
+    ~SubSeg() {
+      Reset();
+    }
+    void Reset() {
+      if (graph_exec != nullptr)
+        cudaGraphExecDestroy(graph_exec);
+      graph_exec = nullptr;
+      temp_space.clear();
+    }
+  };
+
+  struct Cache {
+    bool initialized = false;
+    std::vector<SubSeg> subsegs;
+  };
+
+  bool OpOK(size_t i, bool is_train) const {
+    static auto& fstateful   = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+    static auto& fcompatible = nnvm::Op::GetAttr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible");
+    static auto& fcompute_ex = nnvm::Op::GetAttr<FComputeEx>("FComputeEx<gpu>");
+    const auto& attrs        = attrs_[i];
+    if (attrs.op == nullptr)
+      return false;
+    const auto& f = fcompatible.get(attrs.op, nullptr);
+    if (f != nullptr)
+      return f(attrs, is_train);
+    // Stateful operators may keep host side state that changes between calls.
+    if (fstateful.get(attrs.op, nullptr) != nullptr)
+      return false;
+    // Sparse operators size their outputs on the host.
+    if (fcompute_ex.get(attrs.op, nullptr) != nullptr)
+      return false;
+    for (const auto& r : execs_[i]->op_ctx.requested) {
+      // Host API random generators advance their state on the host, so a replay
+      // would repeat the same numbers.
+      if (r.req.type == ResourceRequest::kRandom)
+        return false;
+      // The counter of the invocation is an argument of the kernels.
+      if (r.req.type == ResourceRequest::kCounterRandom)
+        return false;
+#if MXNET_USE_CUDNN == 1
+      if (r.req.type == ResourceRequest::kCuDNNDropoutDesc)
+        return false;
+#endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+      // The collectives wait for the other ranks.
+      if (r.req.type == ResourceRequest::kNCCLComm)
+        return false;
+#endif  // MXNET_USE_NCCL == 1
+    }
+    return true;
+  }
+
+  void InitSubSegs(bool is_train, Cache* cache) {
+    cache->subsegs.clear();
+    for (size_t i = 0; i < execs_.size(); ++i) {
+      const bool ok = OpOK(i, is_train);
+      if (cache->subsegs.empty() || cache->subsegs.back().capturable != ok) {
+        cache->subsegs.emplace_back(i, i + 1, ok);
+      } else {
+        cache->subsegs.back().end = i + 1;
+      }
+      if (!ok && CudaGraphsVerbose()) {
+        LOG(INFO) << "CUDA graphs: operator " << attrs_[i].op->name << " (" << attrs_[i].name
+                  << ") is not capturable, it runs eagerly";
+      }
+    }
+    cache->initialized = true;
+  }
+
+  void RunEager(const SubSeg& subseg, const RunContext& rctx) {
+    for (size_t i = subseg.begin; i < subseg.end; ++i)
+      execs_[i]->Run(rctx, true);
+  }
+
+  std::vector<void*> TempSpace(const SubSeg& subseg) const {
+    std::vector<void*> ret;
+    for (size_t i = subseg.begin; i < subseg.end; ++i) {
+      for (const auto& r : execs_[i]->op_ctx.requested) {
+        if (r.req.type == ResourceRequest::kTempSpace)
+          ret.push_back(r.current_space_internal());
+      }
+    }
+    return ret;
+  }
+
+  bool TempSpaceChanged(const SubSeg& subseg) const {
+    return TempSpace(subseg) != subseg.temp_space;
+  }
+
+  /*! \brief capture the operators of subseg, returns false if they cannot be captured */
+  bool Capture(SubSeg* subseg, const RunContext& rctx, cudaStream_t stream) {
+    // The graph bakes in the temp space pointers, they must not move during the capture.
+    std::vector<void*> temp_space = TempSpace(*subseg);
+    CUDA_CALL(cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+    bool ok = true;
+    std::string reason;
+    try {
+      for (size_t i = subseg->begin; i < subseg->end; ++i)
+        execs_[i]->Run(rctx, true);
+    } catch (const dmlc::Error& e) {
+      ok     = false;
+      reason = e.what();
+    }
+    cudaGraph_t graph = nullptr;
+    cudaError_t err   = cudaStreamEndCapture(stream, &graph);
+    ok                = ok && err == cudaSuccess && graph != nullptr;
+    if (ok) {
+#if CUDART_VERSION >= 11040
+      err = cudaGraphInstantiateWithFlags(&subseg->graph_exec, graph, 0);
+#else
+      err = cudaGraphInstantiate(&subseg->graph_exec, graph, nullptr, nullptr, 0);
+#endif
+      ok  = err == cudaSuccess;
+    }
+    if (graph != nullptr)
+      cudaGraphDestroy(graph);
+    ok = ok && TempSpace(*subseg) == temp_space;
+    if (!ok) {
+      if (reason.empty() && err != cudaSuccess)
+        reason = cudaGetErrorString(err);
+      // Clear the sticky error of the failed capture.
+      cudaGetLastError();
+      subseg->Reset();
+      subseg->capturable = false;
+      LOG_IF(INFO, CudaGraphsVerbose())
+          << "CUDA graphs: capture of " << opr_names_ << " operators [" << subseg->begin << ", "
+          << subseg->end << ") failed, falling back to eager execution. " << reason;
+      return false;
+    }
+    subseg->temp_space = std::move(temp_space);
+    return true;
+  }
+
+  std::vector<std::shared_ptr<exec::OpExecutor> > execs_;
+  std::vector<nnvm::NodeAttrs> attrs_;
+  std::string opr_names_;
+  /*! \brief graphs for inference (0) and training (1) */
+  Cache cache_[2];
+};
+
+#endif  // MXNET_CUDA_GRAPHS_AVAILABLE
+
+}  // namespace cuda_graphs
+}  // namespace mxnet
+
+#endif  // MXNET_IMPERATIVE_CUDA_GRAPHS_H_
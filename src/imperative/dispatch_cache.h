@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dispatch_cache.h
+ * \brief Memoization of the inference and the lookups of Imperative::Invoke for the calls of an
+ *  operator with the same attributes, context and input and output signatures, and of the
+ *  attributes parsed for the calls with the same parameters.
+ */
+#ifndef MXNET_IMPERATIVE_DISPATCH_CACHE_H_
+#define MXNET_IMPERATIVE_DISPATCH_CACHE_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/imperative.h>
+#include <mxnet/ndarray.h>
+#include <mxnet/op_attr_types.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace imperative {
+
+/*! \brief the shape, type and storage type of an input or an output, or that it is none */
+struct DispatchArraySig {
+  bool none;
+  mxnet::TShape shape;
+  int dtype;
+  int stype;
+
+  explicit DispatchArraySig(const NDArray& array)
+      : none(array.is_none()),
+        shape(none ? mxnet::TShape() : array.shape()),
+        dtype(none ? -1 : array.dtype()),
+        stype(none ? -1 : array.storage_type()) {}
+
+  bool Matches(const NDArray& array) const {
+    if (array.is_none())
+      return none;
+    return !none && array.dtype() == dtype && array.storage_type() == stype &&
+           array.shape() == shape;
+  }
+};
+
+/*!
+ * \brief the inferred attributes of the outputs, the dispatch mode, the compute functions and the
+ *  resource requests of a call of Imperative::Invoke, with the signature of the call
+ */
+struct DispatchPlan {
+  // signature
+  const nnvm::Op* op;
+  std::unordered_map<std::string, std::string> dict;
+  Context ctx;
+  int np_shape;
+  std::vector<DispatchArraySig> inputs;
+  std::vector<DispatchArraySig> outputs;
+  // memoized
+  DispatchMode dispatch_mode;
+  mxnet::ShapeVector out_shapes;
+  std::vector<int> out_types;
+  std::vector<int> out_storage_types;
+  FCompute fn;
+  FComputeEx fn_ex;
+  std::vector<ResourceRequest> resource_reqs;
+  std::vector<uint32_t> mutate_idx;
+
+  bool Matches(const Context& call_ctx,
+               const nnvm::NodeAttrs& attrs,
+               const std::vector<NDArray*>& call_inputs,
+               const std::vector<NDArray*>& call_outputs) const {
+    if (attrs.op != op || call_ctx != ctx || Imperative::Get()->is_np_shape() != np_shape ||
+        call_inputs.size() != inputs.size() || call_outputs.size() != outputs.size())
+      return false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (!inputs[i].Matches(*call_inputs[i]))
+        return false;
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (!outputs[i].Matches(*call_outputs[i]))
+        return false;
+    }
+    return attrs.dict == dict;
+  }
+};
+
+/*!
+ * \brief the dispatch plans of the calls of Imperative::Invoke of a thread, by the hash of their
+ *  signature. The cache is cleared when it holds MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE plans.
+ */
+class DispatchCache {
+ public:
+  static DispatchCache* Get() {
+    static thread_local DispatchCache inst;
+    return &inst;
+  }
+
+  /*!
+   * \brief whether the calls with the signature of this one can be memoized: the shapes of the
+   *  inputs are known, the outputs are none or known, the operator infers its shapes, has no state
+   *  and its attributes are those of attrs.dict
+   */
+  bool Cacheable(const nnvm::NodeAttrs& attrs,
+                 const std::vector<NDArray*>& inputs,
+                 const std::vector<NDArray*>& outputs) const {
+    static auto& infershape        = nnvm::Op::GetAttr<mxnet::FInferShape>("FInferShape");
+    static auto& createop          = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+    static auto& is_layer_backward = nnvm::Op::GetAttr<bool>("TIsLayerOpBackward");
+    // the FFI passes the parsed parameters without their dict when not recording
+    if (capacity_ == 0 || (attrs.dict.empty() && !attrs.parsed.empty()) ||
+        !infershape.count(attrs.op) || createop.count(attrs.op) ||
+        is_layer_backward.get(attrs.op, false))
+      return false;
+    for (const NDArray* i : inputs) {
+      if (i->is_none() || !shape_is_known(i->shape()))
+        return false;
+    }
+    for (const NDArray* i : outputs) {
+      if (!i->is_none() && !shape_is_known(i->shape()))
+        return false;
+    }
+    return true;
+  }
+
+  static size_t Hash(const Context& ctx,
+                     const nnvm::NodeAttrs& attrs,
+                     const std::vector<NDArray*>& inputs,
+                     const std::vector<NDArray*>& outputs) {
+    size_t ret = std::hash<const nnvm::Op*>()(attrs.op);
+    ret        = dmlc::HashCombine(ret, ctx);
+    ret        = dmlc::HashCombine(ret, Imperative::Get()->is_np_shape());
+    // the order of the entries of the dict is not defined
+    size_t dict_hash = 0;
+    for (const auto& kv : attrs.dict)
+      dict_hash += dmlc::HashCombine(std::hash<std::string>()(kv.first), kv.second);
+    ret = dmlc::HashCombine(ret, dict_hash);
+    for (const NDArray* i : inputs) {
+      ret = dmlc::HashCombine(ret, i->dtype());
+      ret = dmlc::HashCombine(ret, static_cast<int>(i->storage_type()));
+      ret = dmlc::HashCombine(ret, i->shape());
+    }
+    for (const NDArray* i : outputs) {
+      ret = dmlc::HashCombine(ret, i->is_none());
+      if (!i->is_none()) {
+        ret = dmlc::HashCombine(ret, i->dtype());
+        ret = dmlc::HashCombine(ret, static_cast<int>(i->storage_type()));
+        ret = dmlc::HashCombine(ret, i->shape());
+      }
+    }
+    return ret;
+  }
+
+  const DispatchPlan* Find(size_t hash,
+                           const Context& ctx,
+                           const nnvm::NodeAttrs& attrs,
+                           const std::vector<NDArray*>& inputs,
+                           const std::vector<NDArray*>& outputs) const {
+    auto range = plans_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.Matches(ctx, attrs, inputs, outputs))
+        return &it->second;
+    }
+    return nullptr;
+  }
+
+  void Insert(size_t hash, DispatchPlan&& plan) {
+    if (plans_.size() >= capacity_)
+      plans_.clear();
+    plans_.emplace(hash, std::move(plan));
+  }
+
+ private:
+  DispatchCache()
+      : capacity_(std::max(dmlc::GetEnv("MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE", 1024), 0)) {}
+
+  size_t capacity_;
+  std::unordered_multimap<size_t, DispatchPlan> plans_;
+};
+
+/*!
+ * \brief the attributes parsed for the imperative calls of a thread by their operator, number of
+ *  inputs and parameters, so that the calls with the parameters of an earlier one copy its parsed
+ *  attributes instead of parsing their strings. The cache is cleared when it holds
+ *  MXNET_IMPERATIVE_ATTRS_CACHE_SIZE attributes.
+ */
+class ParsedAttrsCache {
+ public:
+  static ParsedAttrsCache* Get() {
+    static thread_local ParsedAttrsCache inst;
+    return &inst;
+  }
+
+  /*!
+   * \brief the key of the parameters of a call, empty when its attributes are not memoized: the
+   *  cache is disabled or the operator has a state, which its parser may set up
+   */
+  std::string Key(const nnvm::Op* op,
+                  const int num_inputs,
+                  const int num_params,
+                  const char** param_keys,
+                  const char** param_vals) const {
+    static auto& createop = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+    std::string key;
+    if (capacity_ == 0 || createop.count(op))
+      return key;
+    key.append(reinterpret_cast<const char*>(&op), sizeof(op));
+    key.append(reinterpret_cast<const char*>(&num_inputs), sizeof(num_inputs));
+    // the parsers may read the numpy semantics
+    key.push_back(static_cast<char>(Imperative::Get()->is_np_shape()));
+    key.push_back(static_cast<char>(Imperative::Get()->is_np_default_dtype()));
+    for (int i = 0; i < num_params; ++i) {
+      key.append(param_keys[i]).push_back('\0');
+      key.append(param_vals[i]).push_back('\0');
+    }
+    return key;
+  }
+
+  const nnvm::NodeAttrs* Find(const std::string& key) const {
+    auto it = attrs_.find(key);
+    return it == attrs_.end() ? nullptr : &it->second;
+  }
+
+  void Insert(std::string&& key, const nnvm::NodeAttrs& attrs) {
+    if (attrs_.size() >= capacity_)
+      attrs_.clear();
+    attrs_.emplace(std::move(key), attrs);
+  }
+
+ private:
+  ParsedAttrsCache()
+      : capacity_(std::max(dmlc::GetEnv("MXNET_IMPERATIVE_ATTRS_CACHE_SIZE", 1024), 0)) {}
+
+  size_t capacity_;
+  std::unordered_map<std::string, nnvm::NodeAttrs> attrs_;
+};
+
+}  // namespace imperative
+}  // namespace mxnet
+
+#endif  // MXNET_IMPERATIVE_DISPATCH_CACHE_H_
@@ -30,9 +30,13 @@
 #include <mxnet/graph_attr_types.h>
 #include <nnvm/graph.h>
 #include <nnvm/graph_attr_types.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <tuple>
 
@@ -63,6 +67,31 @@ using TIsFusionHelper = bool;
 /*! \brief reuse graph definition */
 using nnvm::Graph;
 
+/*!
+ * \brief Logs the wall time of a graph pass when MXNET_GRAPH_PASS_TIMING is set.
+ *  Declare it at the beginning of the scope running the pass.
+ */
+class PassTimer {
+ public:
+  explicit PassTimer(const char* name) : name_(name) {
+    static const bool enabled = dmlc::GetEnv("MXNET_GRAPH_PASS_TIMING", false);
+    enabled_                  = enabled;
+    if (enabled_)
+      start_ = std::chrono::steady_clock::now();
+  }
+  ~PassTimer() {
+    if (!enabled_)
+      return;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+    LOG(INFO) << "Graph pass " << name_ << " took " << elapsed.count() << " ms";
+  }
+
+ private:
+  const char* name_;
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+};
+
 const int kBadStorageID      = -1;
 const int kExternalStorageID = -2;
 const int kDynamicStorageID  = -3;
@@ -201,6 +230,103 @@ Graph DetectInplaceAddTo(Graph g);
  */
 Graph EliminateCommonExpr(Graph&& g);
 
+/*!
+ * \brief Switch the 2D convolutions, poolings and batch normalizations of a forward graph
+ *  to NHWC, with the elementwise operators between them, in the regions where that takes
+ *  no more transposes of the data than there are convolutions. The weights of the converted
+ *  convolutions are transposed to OHWI, the inputs and outputs of the graph stay NCHW.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the layouts converted
+ */
+Graph ConvertLayout(Graph&& g);
+
+/*!
+ * \brief Replace the self attentions of a forward graph, interleaved_matmul_selfatt_qk then
+ *  softmax or masked_softmax over the keys then interleaved_matmul_selfatt_valatt, with
+ *  _contrib_interleaved_selfatt, when the scores and the attention maps are used nowhere else.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the self attentions fused
+ */
+Graph FuseAttention(Graph&& g);
+
+/*!
+ * \brief Replace the LayerNorms over the last axis of a forward graph normalizing an
+ *  elemwise_add or _npi_add of a residual and, optionally, an elementwise Dropout, with
+ *  _contrib_add_dropout_layer_norm. The addends must have the same shape.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the layer normalizations fused
+ */
+Graph FuseAddDropoutLayerNorm(Graph&& g);
+
+/*!
+ * \brief Replace the BatchNorms of a forward graph followed by an elemwise_add or _npi_add of a
+ *  residual and a ReLU, Activation with act_type relu, relu or _npx_relu, with
+ *  _contrib_BatchNormAddReLU, when the normalized data and the sum are used nowhere else. The
+ *  addends must have the same shape.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the batch normalizations fused
+ */
+Graph FuseBatchNormAddReLU(Graph&& g);
+
+/*!
+ * \brief Replace the independent FullyConnected operators of a forward graph, those of the
+ *  same depth in the graph with the same no_bias and flatten, with
+ *  _contrib_grouped_fully_connected computing them with grouped GEMMs.
+ *
+ * \param g input forward graph
+ *
+ * \return graph with the fully connected layers grouped
+ */
+Graph GroupFullyConnected(Graph&& g);
+
+/*!
+ * \brief Remove the operators of a forward graph copying their input at inference: BlockGrad,
+ *  _copy, and the Dropouts of mode training whose masks are not read. Their readers read their
+ *  input instead. The nodes of g are rewired in place.
+ *
+ * \param g input forward graph
+ *
+ * \return graph without the copies
+ */
+Graph PruneForInference(Graph&& g);
+
+/*!
+ * \brief Group the operators of nodes [start_nid, end_nid) of a graph by the branch they belong
+ *  to: the operators of a chain share a group, and each branch leaving a fork starts a new one.
+ *
+ * \param idx indexed graph
+ * \param start_nid first node grouped, the operators before it are inputs
+ * \param end_nid end of the nodes grouped
+ *
+ * \return the group of each node of idx, -1 for the variables and the nodes out of the range
+ */
+std::vector<int> AssignStreamGroups(const nnvm::IndexedGraph& idx,
+                                    const size_t start_nid,
+                                    const size_t end_nid);
+
+/*!
+ * \brief Fold the operators computing only from immutable inputs and constants.
+ *
+ * \param g input forward graph, left unchanged
+ * \param immutable_inputs names of the inputs of g whose values never change
+ * \param constants set to the entries computing the folded values
+ * \param constant_names set to the names of the variables reading constants[i]
+ *
+ * \return copy of g reading the folded values from new input variables
+ */
+Graph FoldConstants(const Graph& g,
+                    const std::unordered_set<std::string>& immutable_inputs,
+                    std::vector<nnvm::NodeEntry>* constants,
+                    std::vector<std::string>* constant_names);
+
 /*!
  * \brief Fuse pointwise operations in the graph.
  *
@@ -211,6 +337,16 @@ Graph EliminateCommonExpr(Graph&& g);
  */
 Graph FusePointwise(const Graph& g, const size_t num_forward_outputs);
 
+/*!
+ * \brief Fuse pointwise operations in the graph into FusedOps run by the CPU interpreter.
+ *
+ * \param g input graph (needs to be entire graph, not just forward part)
+ * \param num_forward_outputs number of outputs in the graph produced by the forward pass
+ *
+ * \return copy of the graph with fused pointwise operations
+ */
+Graph FusePointwiseCPU(const Graph& g, const size_t num_forward_outputs);
+
 /*!
  * \brief Issue a one-time warning that fusion is not possible for this platform or build.
  */
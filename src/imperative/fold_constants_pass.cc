@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fold_constants_pass.cc
+ * \brief Fold the operators of a graph which only depend on immutable inputs
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "./exec_pass.h"
+#include "../common/exec_utils.h"
+
+namespace nnvm {
+ObjectPtr CreateVariableNode(const std::string& name);
+}
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::ObjectPtr;
+
+/*!
+ * \brief Whether the outputs of a Node only depend on its inputs, so that it can be
+ *  evaluated once when all its inputs are constant.
+ */
+bool IsFoldable(const Node* n) {
+  if (n->is_variable() || !n->attrs.subgraphs.empty())
+    return false;
+
+  // Ops that mutate inputs cannot be evaluated ahead of time
+  static auto& fmutate_inputs = Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+  if (fmutate_inputs.get(n->op(), nullptr) != nullptr)
+    return false;
+
+  // Stateful ops may keep internal state between calls
+  static auto& fstateful = Op::GetAttr<FCreateOpState>("FCreateOpState");
+  if (fstateful.get(n->op(), nullptr) != nullptr)
+    return false;
+
+  static auto& deterministic_output =
+      Op::GetAttr<THasDeterministicOutput>("THasDeterministicOutput");
+  if (deterministic_output.contains(n->op()))
+    return deterministic_output[n->op()];
+
+  // Ops requesting other resources than temporary space may be random
+  static auto& resource_request    = Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static auto& resource_request_ex = Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  const auto fresource_request     = resource_request.get(n->op(), nullptr);
+  if (fresource_request != nullptr) {
+    for (const auto& req : fresource_request(n->attrs)) {
+      if (req.type != ResourceRequest::kTempSpace)
+        return false;
+    }
+  }
+  return resource_request_ex.get(n->op(), nullptr) == nullptr;
+}
+
+}  // namespace
+
+Graph FoldConstants(const Graph& g,
+                    const std::unordered_set<std::string>& immutable_inputs,
+                    std::vector<nnvm::NodeEntry>* constants,
+                    std::vector<std::string>* constant_names) {
+  Graph ret;
+  common::CopyGraph(&ret, g, false);
+  const IndexedGraph& idx = ret.indexed_graph();
+
+  std::unordered_set<uint32_t> output_nodes;
+  for (const auto& e : idx.outputs())
+    output_nodes.insert(e.node_id);
+  std::unordered_set<std::string> names;
+  for (const uint32_t nid : idx.input_nodes())
+    names.insert(idx[nid].source->attrs.name);
+
+  // The outputs of the graph are computed on every call, so that they stay distinct arrays.
+  std::vector<bool> is_constant(idx.num_nodes(), false);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto& inode = idx[nid];
+    if (inode.source->is_variable()) {
+      is_constant[nid] = immutable_inputs.count(inode.source->attrs.name) &&
+                         !idx.mutable_input_nodes().count(nid);
+      continue;
+    }
+    bool constant = !output_nodes.count(nid) && inode.control_deps.empty() &&
+                    IsFoldable(inode.source);
+    for (const auto& e : inode.inputs)
+      constant = constant && is_constant[e.node_id];
+    is_constant[nid] = constant;
+  }
+
+  // Read the constants used by the other operators from new variables.
+  nnvm::NodeEntryMap<ObjectPtr> variables;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (is_constant[nid] || idx[nid].source->is_variable())
+      continue;
+    Node* node = const_cast<Node*>(idx[nid].source);
+    for (auto& e : node->inputs) {
+      if (e.node->is_variable() || !is_constant[idx.node_id(e.node.get())])
+        continue;
+      auto it = variables.find(e);
+      if (it == variables.end()) {
+        std::string name = e.node->attrs.name + "_folded";
+        if (e.node->num_outputs() > 1)
+          name += std::to_string(e.index);
+        while (names.count(name))
+          name += "_";
+        names.insert(name);
+        constants->push_back(e);
+        constant_names->push_back(name);
+        it = variables.emplace(e, nnvm::CreateVariableNode(name)).first;
+      }
+      e = nnvm::NodeEntry{it->second, 0, 0};
+    }
+  }
+
+  // The indexed graph of ret no longer matches its nodes.
+  Graph folded;
+  folded.outputs = ret.outputs;
+  return folded;
+}
+
+}  // namespace exec
+}  // namespace mxnet
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fuse_attention_pass.cc
+ * \brief Compute the self attentions of a graph with _contrib_interleaved_selfatt
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+std::string GetAttr(const Node* n, const std::string& key) {
+  const auto it = n->attrs.dict.find(key);
+  return it == n->attrs.dict.end() ? std::string() : it->second;
+}
+
+bool IsUnset(const std::string& value) {
+  return value.empty() || value == "None";
+}
+
+bool IsFalse(const std::string& value) {
+  return IsUnset(value) || value == "False" || value == "false" || value == "0";
+}
+
+/*! \brief whether n is a softmax over the keys, which the fused attention computes */
+bool IsKeySoftmax(const Node* n) {
+  static const Op* softmax_op        = Op::Get("softmax");
+  static const Op* masked_softmax_op = Op::Get("masked_softmax");
+  const std::string axis             = GetAttr(n, "axis");
+  if (!axis.empty() && axis != "-1")
+    return false;
+  if (n->op() == softmax_op)
+    return IsUnset(GetAttr(n, "dtype")) && IsFalse(GetAttr(n, "use_length"));
+  // the fused attention always normalizes, which only changes the overflows
+  return n->op() == masked_softmax_op;
+}
+
+}  // namespace
+
+Graph FuseAttention(Graph&& g) {
+  const IndexedGraph& idx     = g.indexed_graph();
+  static const Op* qk_op      = Op::Get("_contrib_interleaved_matmul_selfatt_qk");
+  static const Op* valatt_op  = Op::Get("_contrib_interleaved_matmul_selfatt_valatt");
+  static const Op* masked_op  = Op::Get("masked_softmax");
+  static const Op* selfatt_op = Op::Get("_contrib_interleaved_selfatt");
+
+  // the scores and the attention maps must not be used elsewhere
+  std::vector<uint32_t> uses(idx.num_node_entries(), 0);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    for (const auto& e : idx[nid].inputs)
+      ++uses[idx.entry_id(e)];
+  }
+  for (const auto& e : idx.outputs())
+    ++uses[idx.entry_id(e)];
+
+  // qk -> softmax -> valatt, with valatt reading the queries, keys and values of qk
+  std::unordered_map<const Node*, ObjectPtr> fused;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const Node* valatt = idx[nid].source;
+    if (valatt->op() != valatt_op)
+      continue;
+    const auto& attention = idx[nid].inputs[1];
+    const Node* softmax   = idx[attention.node_id].source;
+    if (softmax->is_variable() || !IsKeySoftmax(softmax) || uses[idx.entry_id(attention)] != 1)
+      continue;
+    const auto& scores = idx[attention.node_id].inputs[0];
+    const Node* qk     = idx[scores.node_id].source;
+    if (qk->op() != qk_op || uses[idx.entry_id(scores)] != 1 ||
+        idx.entry_id(idx[scores.node_id].inputs[0]) != idx.entry_id(idx[nid].inputs[0]) ||
+        GetAttr(qk, "heads") != GetAttr(valatt, "heads"))
+      continue;
+
+    const std::string temperature = GetAttr(softmax, "temperature");
+    ObjectPtr n                   = Node::Create();
+    n->attrs.op                   = selfatt_op;
+    n->attrs.name                 = valatt->attrs.name + "_fused";
+    n->attrs.dict["heads"]        = GetAttr(valatt, "heads");
+    if (!IsUnset(temperature))
+      n->attrs.dict["temperature"] = temperature;
+    n->inputs.push_back(valatt->inputs[0]);
+    if (softmax->op() == masked_op) {
+      n->attrs.dict["masked"] = "True";
+      n->inputs.push_back(softmax->inputs[1]);
+    }
+    selfatt_op->attr_parser(&n->attrs);
+    fused.emplace(valatt, n);
+  }
+  if (fused.empty())
+    return std::move(g);
+
+  auto replace = [&](NodeEntry* e) {
+    const auto it = fused.find(e->node.get());
+    if (it != fused.end())
+      *e = NodeEntry{it->second, 0, 0};
+  };
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    for (auto& e : n->inputs)
+      replace(&e);
+  }
+  for (auto& e : g.outputs)
+    replace(&e);
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+}  // namespace exec
+}  // namespace mxnet
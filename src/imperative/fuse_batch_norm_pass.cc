@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fuse_batch_norm_pass.cc
+ * \brief Compute the batch normalizations of a graph followed by a residual addition and a ReLU
+ *  with _contrib_BatchNormAddReLU
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+std::string GetAttr(const Node* n, const std::string& key) {
+  const auto it = n->attrs.dict.find(key);
+  return it == n->attrs.dict.end() ? std::string() : it->second;
+}
+
+bool IsFalse(const std::string& value) {
+  return value.empty() || value == "False" || value == "false" || value == "0";
+}
+
+bool IsReLU(const Node* n) {
+  static const Op* activation_op = Op::Get("Activation");
+  static const Op* relu_op       = Op::Get("relu");
+  static const Op* npx_relu_op   = Op::Get("_npx_relu");
+  return n->op() == relu_op || n->op() == npx_relu_op ||
+         (n->op() == activation_op && GetAttr(n, "act_type") == "relu");
+}
+
+/*! \brief whether n is a BatchNorm returning only the normalized data */
+bool IsBatchNorm(const Node* n) {
+  static const Op* batch_norm_op = Op::Get("BatchNorm");
+  return n->op() == batch_norm_op && IsFalse(GetAttr(n, "output_mean_var"));
+}
+
+}  // namespace
+
+Graph FuseBatchNormAddReLU(Graph&& g) {
+  const IndexedGraph& idx   = g.indexed_graph();
+  static const Op* add_op   = Op::Get("elemwise_add");
+  static const Op* npi_add  = Op::Get("_npi_add");
+  static const Op* fused_op = Op::Get("_contrib_BatchNormAddReLU");
+
+  std::vector<uint32_t> uses(idx.num_node_entries(), 0);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    for (const auto& e : idx[nid].inputs)
+      ++uses[idx.entry_id(e)];
+  }
+  for (const auto& e : idx.outputs())
+    ++uses[idx.entry_id(e)];
+
+  // relu(add(BatchNorm(data), addend)), where the normalized data and the sum are used nowhere
+  // else. The fused node replaces the output of the ReLU.
+  std::unordered_map<const Node*, ObjectPtr> fused_relus;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const Node* relu = idx[nid].source;
+    if (relu->is_variable() || !IsReLU(relu))
+      continue;
+    const auto& sum_entry = idx[nid].inputs[0];
+    const Node* add       = idx[sum_entry.node_id].source;
+    if ((add->op() != add_op && add->op() != npi_add) || uses[idx.entry_id(sum_entry)] != 1)
+      continue;
+    int norm_input = -1;
+    for (int i = 0; i < 2; ++i) {
+      const auto& e = idx[sum_entry.node_id].inputs[i];
+      if (IsBatchNorm(idx[e.node_id].source) && e.index == 0 && uses[idx.entry_id(e)] == 1) {
+        norm_input = i;
+        break;
+      }
+    }
+    if (norm_input < 0)
+      continue;
+    const Node* norm = add->inputs[norm_input].node.get();
+
+    ObjectPtr n     = Node::Create();
+    n->attrs.op     = fused_op;
+    n->attrs.name   = norm->attrs.name + "_add_relu";
+    n->attrs.dict   = norm->attrs.dict;
+    n->inputs       = norm->inputs;
+    n->control_deps = norm->control_deps;
+    n->inputs.push_back(add->inputs[1 - norm_input]);
+    fused_op->attr_parser(&n->attrs);
+    fused_relus.emplace(relu, n);
+  }
+  if (fused_relus.empty())
+    return std::move(g);
+
+  auto replace = [&](NodeEntry* e) {
+    auto it = fused_relus.find(e->node.get());
+    if (it != fused_relus.end())
+      *e = NodeEntry{it->second, 0, 0};
+  };
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    for (auto& e : n->inputs)
+      replace(&e);
+  }
+  // the data or the addend of a fused node may be the output of another one
+  for (auto& kv : fused_relus) {
+    for (auto& e : kv.second->inputs)
+      replace(&e);
+  }
+  for (auto& e : g.outputs)
+    replace(&e);
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+}  // namespace exec
+}  // namespace mxnet
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fuse_layer_norm_pass.cc
+ * \brief Compute the residual additions, dropouts and layer normalizations of a graph with
+ *  _contrib_add_dropout_layer_norm
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+std::string GetAttr(const Node* n, const std::string& key) {
+  const auto it = n->attrs.dict.find(key);
+  return it == n->attrs.dict.end() ? std::string() : it->second;
+}
+
+bool IsFalse(const std::string& value) {
+  return value.empty() || value == "False" || value == "false" || value == "0";
+}
+
+/*! \brief whether n is a LayerNorm over the last axis returning only the normalized data */
+bool IsLastAxisLayerNorm(const Node* n) {
+  static const Op* layer_norm_op = Op::Get("LayerNorm");
+  const std::string axis         = GetAttr(n, "axis");
+  return n->op() == layer_norm_op && (axis.empty() || axis == "-1") &&
+         IsFalse(GetAttr(n, "output_mean_var"));
+}
+
+/*! \brief whether n is a Dropout of independent elements */
+bool IsElementDropout(const Node* n) {
+  static const Op* dropout_op = Op::Get("Dropout");
+  const std::string axes      = GetAttr(n, "axes");
+  return n->op() == dropout_op && (axes.empty() || axes == "()" || axes == "[]");
+}
+
+}  // namespace
+
+Graph FuseAddDropoutLayerNorm(Graph&& g) {
+  const IndexedGraph& idx   = g.indexed_graph();
+  static const Op* add_op   = Op::Get("elemwise_add");
+  static const Op* npi_add  = Op::Get("_npi_add");
+  static const Op* fused_op = Op::Get("_contrib_add_dropout_layer_norm");
+
+  std::vector<uint32_t> uses(idx.num_node_entries(), 0);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    for (const auto& e : idx[nid].inputs)
+      ++uses[idx.entry_id(e)];
+  }
+  for (const auto& e : idx.outputs())
+    ++uses[idx.entry_id(e)];
+
+  // LayerNorm(add(Dropout(data), residual)), or LayerNorm(add(data, residual)) without a
+  // dropout. The fused node replaces the output of the LayerNorm and, when it is used
+  // elsewhere, the sum.
+  std::unordered_map<const Node*, ObjectPtr> fused_norms, fused_sums;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const Node* norm = idx[nid].source;
+    if (norm->is_variable() || !IsLastAxisLayerNorm(norm))
+      continue;
+    const auto& sum_entry = idx[nid].inputs[0];
+    const Node* add       = idx[sum_entry.node_id].source;
+    if ((add->op() != add_op && add->op() != npi_add) || fused_sums.count(add))
+      continue;
+    int data_input = -1;
+    for (int i = 0; i < 2; ++i) {
+      const auto& e = idx[sum_entry.node_id].inputs[i];
+      if (IsElementDropout(idx[e.node_id].source) && e.index == 0 &&
+          uses[idx.entry_id(e)] == 1) {
+        data_input = i;
+        break;
+      }
+    }
+    const Node* dropout = data_input >= 0 ? add->inputs[data_input].node.get() : nullptr;
+
+    ObjectPtr n                 = Node::Create();
+    n->attrs.op                 = fused_op;
+    n->attrs.name               = norm->attrs.name + "_fused";
+    n->attrs.dict["eps"]        = GetAttr(norm, "eps");
+    n->attrs.dict["p"]          = dropout != nullptr ? GetAttr(dropout, "p") : "0";
+    n->attrs.dict["mode"]       = dropout != nullptr ? GetAttr(dropout, "mode") : "";
+    n->attrs.dict["output_sum"] = uses[idx.entry_id(sum_entry)] > 1 ? "True" : "False";
+    for (const char* key : {"eps", "p", "mode"}) {
+      if (n->attrs.dict[key].empty())
+        n->attrs.dict.erase(key);
+    }
+    n->inputs.push_back(dropout != nullptr ? dropout->inputs[0] : add->inputs[0]);
+    n->inputs.push_back(add->inputs[dropout != nullptr ? 1 - data_input : 1]);
+    n->inputs.push_back(norm->inputs[1]);
+    n->inputs.push_back(norm->inputs[2]);
+    fused_op->attr_parser(&n->attrs);
+    fused_norms.emplace(norm, n);
+    fused_sums.emplace(add, n);
+  }
+  if (fused_norms.empty())
+    return std::move(g);
+
+  auto replace = [&](NodeEntry* e) {
+    auto it = fused_norms.find(e->node.get());
+    if (it != fused_norms.end()) {
+      *e = NodeEntry{it->second, 0, 0};
+      return;
+    }
+    it = fused_sums.find(e->node.get());
+    if (it != fused_sums.end())
+      *e = NodeEntry{it->second, 1, 0};
+  };
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    for (auto& e : n->inputs)
+      replace(&e);
+  }
+  // the residual of a fused node may be the output of another one
+  for (auto& kv : fused_norms) {
+    for (auto& e : kv.second->inputs)
+      replace(&e);
+  }
+  for (auto& e : g.outputs)
+    replace(&e);
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+}  // namespace exec
+}  // namespace mxnet
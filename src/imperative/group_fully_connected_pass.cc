@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file group_fully_connected_pass.cc
+ * \brief Compute the independent fully connected layers of a graph with grouped GEMMs
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "./exec_pass.h"
+#include "../operator/nn/fully_connected-inl.h"
+
+namespace mxnet {
+namespace exec {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+Graph GroupFullyConnected(Graph&& g) {
+  const IndexedGraph& idx     = g.indexed_graph();
+  static const Op* fc_op      = Op::Get("FullyConnected");
+  static const Op* grouped_op = Op::Get("_contrib_grouped_fully_connected");
+
+  // A node only depends on nodes of smaller depths, so the layers of the same depth are
+  // independent. They are grouped by depth and the parameters shared by a grouped layer.
+  std::vector<uint32_t> depth(idx.num_nodes(), 0);
+  std::map<std::tuple<uint32_t, bool, bool>, std::vector<uint32_t>> layers;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto& node = idx[nid];
+    for (const auto& e : node.inputs)
+      depth[nid] = std::max(depth[nid], depth[e.node_id] + 1);
+    for (const uint32_t dep : node.control_deps)
+      depth[nid] = std::max(depth[nid], depth[dep] + 1);
+    if (node.source->op() != fc_op || !node.source->control_deps.empty())
+      continue;
+    const auto& param = nnvm::get<op::FullyConnectedParam>(node.source->attrs.parsed);
+    layers[std::make_tuple(depth[nid], param.no_bias, param.flatten)].push_back(nid);
+  }
+
+  // the output of the grouped layer of each layer
+  std::unordered_map<const Node*, NodeEntry> grouped;
+  std::vector<ObjectPtr> grouped_nodes;
+  for (const auto& group : layers) {
+    const std::vector<uint32_t>& nids = group.second;
+    if (nids.size() < 2)
+      continue;
+    ObjectPtr n = Node::Create();
+    std::ostringstream num_hidden;
+    num_hidden << "(";
+    for (size_t i = 0; i < nids.size(); ++i) {
+      const Node* layer = idx[nids[i]].source;
+      num_hidden << nnvm::get<op::FullyConnectedParam>(layer->attrs.parsed).num_hidden << ",";
+      n->inputs.insert(n->inputs.end(), layer->inputs.begin(), layer->inputs.end());
+      grouped.emplace(layer, NodeEntry{n, static_cast<uint32_t>(i), 0});
+    }
+    num_hidden << ")";
+    n->attrs.op                 = grouped_op;
+    n->attrs.name               = idx[nids[0]].source->attrs.name + "_grouped";
+    n->attrs.dict["num_groups"] = std::to_string(nids.size());
+    n->attrs.dict["num_hidden"] = num_hidden.str();
+    n->attrs.dict["no_bias"]    = std::get<1>(group.first) ? "True" : "False";
+    n->attrs.dict["flatten"]    = std::get<2>(group.first) ? "True" : "False";
+    grouped_op->attr_parser(&n->attrs);
+    grouped_nodes.push_back(n);
+  }
+  if (grouped.empty())
+    return std::move(g);
+
+  auto replace = [&](NodeEntry* e) {
+    const auto it = grouped.find(e->node.get());
+    if (it != grouped.end())
+      *e = it->second;
+  };
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    for (auto& e : n->inputs)
+      replace(&e);
+  }
+  for (const auto& n : grouped_nodes) {
+    for (auto& e : n->inputs)
+      replace(&e);
+  }
+  for (auto& e : g.outputs)
+    replace(&e);
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+}  // namespace exec
+}  // namespace mxnet
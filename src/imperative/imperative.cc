@@ -23,6 +23,8 @@
 
 #include "./imperative_utils.h"
 #include "./cached_op.h"
+#include "./dispatch_cache.h"
+#include "./backward_cache.h"
 
 namespace nnvm {
 ObjectPtr CreateVariableNode(const std::string& name);
@@ -102,6 +104,55 @@ OpStatePtr Imperative::InvokeOp(const Context& ctx,
   return state;
 }
 
+namespace {
+
+/*! \brief Imperative::Invoke of a stateless operator with the plan of the signature of the call */
+void InvokePlan(const imperative::DispatchPlan& plan,
+                const Context& ctx,
+                const nnvm::NodeAttrs& attrs,
+                const std::vector<NDArray*>& inputs,
+                const std::vector<NDArray*>& outputs) {
+  using namespace imperative;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (outputs[i]->is_none()) {
+      const auto storage_type = static_cast<NDArrayStorageType>(plan.out_storage_types[i]);
+      outputs[i]->ReInit(storage_type, plan.out_shapes[i], ctx, plan.out_types[i]);
+      outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
+    }
+  }
+  std::vector<OpReqType> req;
+  SetWriteInplaceReq(inputs, outputs, &req);
+
+  std::vector<engine::VarHandle> read_vars, write_vars;
+  std::vector<Resource> requested;
+  SetDependency(ctx,
+                inputs,
+                outputs,
+                plan.resource_reqs,
+                plan.mutate_idx,
+                &read_vars,
+                &write_vars,
+                &requested);
+  if (plan.fn_ex && plan.dispatch_mode == DispatchMode::kFComputeEx) {
+    PushFComputeEx(
+        plan.fn_ex, attrs.op, attrs, ctx, read_vars, write_vars, requested, inputs, outputs, req);
+  } else {
+    PushFCompute(plan.fn,
+                 attrs.op,
+                 attrs,
+                 ctx,
+                 read_vars,
+                 write_vars,
+                 requested,
+                 inputs,
+                 outputs,
+                 plan.mutate_idx,
+                 req);
+  }
+}
+
+}  // namespace
+
 OpStatePtr Imperative::Invoke(const Context& default_ctx,
                               const nnvm::NodeAttrs& attrs,
                               const std::vector<NDArray*>& inputs,
@@ -121,10 +172,50 @@ OpStatePtr Imperative::Invoke(const Context& default_ctx,
   // TODO(piiswrong): infer ctx
   DispatchMode dispatch_mode = DispatchMode::kUndefined;
   Context ctx                = GetContext(attrs, inputs, outputs, default_ctx);
+
+  // the calls with the signature of an earlier one skip the inference and the lookups
+  DispatchCache* cache = DispatchCache::Get();
+  const bool cacheable = cache->Cacheable(attrs, inputs, outputs);
+  const size_t hash    = cacheable ? DispatchCache::Hash(ctx, attrs, inputs, outputs) : 0;
+  DispatchPlan plan;
+  if (cacheable) {
+    if (const DispatchPlan* cached = cache->Find(hash, ctx, attrs, inputs, outputs)) {
+      InvokePlan(*cached, ctx, attrs, inputs, outputs);
+      return OpStatePtr();
+    }
+    plan.op       = attrs.op;
+    plan.dict     = attrs.dict;
+    plan.ctx      = ctx;
+    plan.np_shape = is_np_shape();
+    for (const NDArray* i : inputs)
+      plan.inputs.emplace_back(*i);
+    for (const NDArray* i : outputs)
+      plan.outputs.emplace_back(*i);
+  }
+
   SetShapeType(ctx, attrs, inputs, outputs, &dispatch_mode);
+  bool memoize = cacheable;
+  if (cacheable) {
+    static auto& fmutate              = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+    const MXAPIThreadLocalEntry<>* tl = MXAPIThreadLocalStore<>::Get();
+
+    plan.dispatch_mode     = dispatch_mode;
+    plan.out_shapes        = tl->out_shapes;
+    plan.out_types         = tl->out_types;
+    plan.out_storage_types = tl->out_storage_types;
+    plan.fn                = common::GetFCompute<FCompute>(attrs.op, "FCompute", ctx);
+    plan.fn_ex             = common::GetFCompute<FComputeEx>(attrs.op, "FComputeEx", ctx);
+    plan.resource_reqs     = GetResourceRequests(attrs, ctx, dispatch_mode);
+    if (fmutate.count(attrs.op))
+      plan.mutate_idx = fmutate[attrs.op](attrs);
+    for (const auto& shape : plan.out_shapes)
+      memoize = memoize && shape_is_known(shape);
+  }
   std::vector<OpReqType> req;
   SetWriteInplaceReq(inputs, outputs, &req);
   OpStatePtr ret = InvokeOp(ctx, attrs, inputs, outputs, req, dispatch_mode);
+  if (memoize)
+    cache->Insert(hash, std::move(plan));
   // the followinng loop is used for finding out the correct shape when some shapes are dynamic
   for (auto output : outputs) {
     if (!shape_is_known(output->shape())) {
@@ -520,38 +611,62 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
     us.emplace_back(NodeEntry{i, 0, 0});
   }
 
-  Graph g_graph = pass::MXGradient(graph,
-                                   graph.outputs,
-                                   xs,
-                                   ograd_entries,
-                                   mxnet::AggregateGradient,
-                                   nullptr,
-                                   zero_ops,
-                                   "_copy",
-                                   ShapeVector(),
-                                   DTypeVector(),
-                                   us);
-  CHECK_EQ(g_graph.outputs.size(), xs.size());
-  for (const auto& e : g_graph.outputs) {
-    if (e.node->op() == nullptr) {
-      auto node      = Node::Create();
-      node->attrs.op = copy_op;
-      node->inputs.push_back(e);
-      graph.outputs.emplace_back(std::move(node));
-    } else {
-      graph.outputs.push_back(e);
-    }
-  }
-  const auto& idx = graph.indexed_graph();
-  // get number of nodes used in forward pass
+  // The tapes with the structure and the arrays of an earlier one reuse its gradient graph and
+  // its inferred attributes.
+  BackwardCache* cache = BackwardCache::Get();
+  TapeSig sig;
+  std::vector<const Node*> fwd_nodes;
+  const bool cacheable =
+      !create_graph && cache->Signature(sym, xs, ograd_entries, &sig, &fwd_nodes);
+  const BackwardPlan* plan = cacheable ? cache->Find(sig) : nullptr;
+
   size_t num_forward_nodes   = 0;
   size_t num_forward_entries = 0;
-  for (size_t i = 0; i < num_forward_outputs; ++i) {
-    num_forward_nodes =
-        std::max(num_forward_nodes, static_cast<size_t>(idx.outputs()[i].node_id + 1));
-    num_forward_entries =
-        std::max(num_forward_entries, static_cast<size_t>(idx.entry_id(idx.outputs()[i])) + 1);
+  std::vector<uint32_t> nleaf_grad_eids;
+  if (plan != nullptr) {
+    graph               = plan->graph;
+    num_forward_nodes   = plan->num_forward_nodes;
+    num_forward_entries = plan->num_forward_entries;
+    nleaf_grad_eids     = plan->nleaf_grad_eids;
+  } else {
+    Graph g_graph = pass::MXGradient(graph,
+                                     graph.outputs,
+                                     xs,
+                                     ograd_entries,
+                                     mxnet::AggregateGradient,
+                                     nullptr,
+                                     zero_ops,
+                                     "_copy",
+                                     ShapeVector(),
+                                     DTypeVector(),
+                                     us);
+    CHECK_EQ(g_graph.outputs.size(), xs.size());
+    for (const auto& e : g_graph.outputs) {
+      if (e.node->op() == nullptr) {
+        auto node      = Node::Create();
+        node->attrs.op = copy_op;
+        node->inputs.push_back(e);
+        graph.outputs.emplace_back(std::move(node));
+      } else {
+        graph.outputs.push_back(e);
+      }
+    }
+    const auto& idx = graph.indexed_graph();
+    // get number of nodes used in forward pass
+    for (size_t i = 0; i < num_forward_outputs; ++i) {
+      num_forward_nodes =
+          std::max(num_forward_nodes, static_cast<size_t>(idx.outputs()[i].node_id + 1));
+      num_forward_entries =
+          std::max(num_forward_entries, static_cast<size_t>(idx.entry_id(idx.outputs()[i])) + 1);
+    }
+    const std::vector<NodeEntry>& us_grads =
+        g_graph.GetAttr<std::vector<NodeEntry>>("nleaf_grads");
+    CHECK_EQ(us_grads.size(), us.size())
+        << "Size of queried nleaf_vars and size of their gradients don't match.";
+    for (const auto& e : us_grads)
+      nleaf_grad_eids.push_back(idx.entry_id(e));
   }
+  const auto& idx = graph.indexed_graph();
 
   // Allocate buffer
   std::vector<NDArray> buff(idx.num_node_entries());
@@ -585,9 +700,11 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
       buff[eid].autograd_entry_ = ograd_entry;
     }
   } else {
+    // the nodes of the graph of a plan are copies of those of the tape, in the same order
     states.reserve(num_forward_nodes);
     for (size_t i = 0; i < num_forward_nodes; ++i) {
-      const AGInfo& info = dmlc::get<AGInfo>(idx[i].source->info);
+      const Node* n      = plan != nullptr ? fwd_nodes[i] : idx[i].source;
+      const AGInfo& info = dmlc::get<AGInfo>(n->info);
       states.emplace_back(info.state);
       for (size_t j = 0; j < info.outputs.size(); ++j) {
         size_t eid  = idx.entry_id(i, j);
@@ -597,11 +714,15 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
           ref_count[eid] = 1;
       }
     }
-    for (auto& ograd_entry : ograd_entries) {
-      if (!idx.exist(ograd_entry.node.get()))
-        continue;
-      AGInfo& info                      = AGInfo::Get(ograd_entry.node);
-      arrays[idx.entry_id(ograd_entry)] = &info.outputs[0];
+    for (size_t i = 0; i < ograd_entries.size(); ++i) {
+      int64_t eid = -1;
+      if (plan != nullptr) {
+        eid = plan->ograd_eids[i];
+      } else if (idx.exist(ograd_entries[i].node.get())) {
+        eid = idx.entry_id(ograd_entries[i]);
+      }
+      if (eid >= 0)
+        arrays[eid] = &AGInfo::Get(ograd_entries[i].node).outputs[0];
     }
   }
   for (size_t i = num_forward_outputs; i < graph.outputs.size(); ++i) {
@@ -609,12 +730,8 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
     arrays[eid]    = x_grads[i - num_forward_outputs];
     ref_count[eid] = 1;
   }
-  const std::vector<NodeEntry>& us_grads =
-    g_graph.GetAttr<std::vector<NodeEntry>>("nleaf_grads");
-  CHECK_EQ(us_grads.size(), us.size())
-    << "Size of queried nleaf_vars and size of their gradients don't match.";
-  for (size_t i = 0; i < us_grads.size(); i++) {
-    size_t eid = idx.entry_id(us_grads[i]);
+  for (size_t i = 0; i < nleaf_grad_eids.size(); i++) {
+    size_t eid   = nleaf_grad_eids[i];
     AGInfo& info = AGInfo::Get(us[i].node);
     if (arrays[eid]->dtype_ == -1) {
       arrays[eid] = &info.out_grads[0];
@@ -625,10 +742,13 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
   }
 
   // Assign context
-  auto vctx = PlaceDevice(idx);
+  std::vector<Context> vctx;
+  if (plan != nullptr) {
+    vctx = plan->vctx;
+  } else {
+    vctx = PlaceDevice(idx);
 
-  // Infer shape type
-  {
+    // Infer shape type
     std::pair<uint32_t, uint32_t> node_range, entry_range;
     node_range  = {num_forward_nodes, idx.num_nodes()};
     entry_range = {num_forward_entries, idx.num_node_entries()};
@@ -656,6 +776,25 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
       dev_mask.emplace_back(i.dev_mask());
     CheckAndInferStorageType(
         &graph, std::move(dev_mask), std::move(stypes), false, node_range, entry_range);
+
+    // the plan reads the arrays of the next tapes from the nodes of its copy of the graph
+    if (cacheable && !contain_unknown) {
+      BackwardPlan new_plan;
+      new_plan.sig = std::move(sig);
+      Symbol copy;
+      copy.outputs                 = graph.outputs;
+      new_plan.graph.outputs       = copy.Copy().outputs;
+      new_plan.graph.attrs         = graph.attrs;
+      new_plan.num_forward_nodes   = num_forward_nodes;
+      new_plan.num_forward_entries = num_forward_entries;
+      for (const auto& ograd_entry : ograd_entries) {
+        new_plan.ograd_eids.push_back(
+            idx.exist(ograd_entry.node.get()) ? idx.entry_id(ograd_entry) : -1);
+      }
+      new_plan.nleaf_grad_eids = nleaf_grad_eids;
+      new_plan.vctx            = vctx;
+      cache->Insert(std::move(new_plan));
+    }
   }
 
   // Calculate ref count
@@ -675,10 +814,9 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
     size_t eid      = idx.entry_id(idx.outputs()[i]);
     array_reqs[eid] = x_reqs[i - num_forward_outputs];
   }
-  for (size_t i = 0; i < us_grads.size(); i++) {
-    size_t eid = idx.entry_id(us_grads[i]);
-    AGInfo& info = AGInfo::Get(us[i].node);
-    array_reqs[eid] = info.grad_req;
+  for (size_t i = 0; i < nleaf_grad_eids.size(); i++) {
+    AGInfo& info                   = AGInfo::Get(us[i].node);
+    array_reqs[nleaf_grad_eids[i]] = info.grad_req;
   }
 
   const auto& shapes         = graph.GetAttr<mxnet::ShapeVector>("shape");
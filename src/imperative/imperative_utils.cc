@@ -184,11 +184,33 @@ void NaiveRunGraph(const bool retain_graph,
                    const imperative::CachedOpMonCallback& callback,
                    const bool monitor_all,
                    const bool skip_engine) {
+  // The shape of the outputs of a dynamic shape operator is only known once it has run.
+  // In the pipelined mode the host waits for it when an operator reading the output is
+  // dispatched, not right after the operator, so the following independent operators are
+  // dispatched while the dynamic one runs. The pending outputs hold copies of the arrays
+  // which keep their chunks alive after their last use.
+  const bool pipelined = !callback && !recording && !skip_engine &&
+                         dmlc::GetEnv("MXNET_DYNAMIC_SHAPE_PIPELINE", false);
+  std::unordered_map<size_t, NDArray> pending;
+  auto sync_shape = [&](size_t eid) {
+    auto it = pending.find(eid);
+    if (it == pending.end())
+      return;
+    it->second.WaitToRead();
+    it->second.SetShapeFromChunk();
+    (*shapes)[eid] = it->second.shape();
+    if (arrays[eid]->var() == it->second.var())
+      arrays[eid]->SetShapeFromChunk();
+    pending.erase(it);
+  };
   for (size_t i = node_start; i < node_end; ++i) {
     const nnvm::IndexedGraph::Node& node = idx[i];
     if (node.source->op() == nullptr) {
       continue;
     }
+    for (const auto& j : node.inputs) {
+      sync_shape(idx.entry_id(j));
+    }
     std::vector<NDArray*> ndinputs  = NodeInputs(idx, i, arrays);
     std::vector<NDArray*> ndoutputs = NodeOutputs(idx, i, arrays);
     std::vector<OpReqType> req;
@@ -211,11 +233,15 @@ void NaiveRunGraph(const bool retain_graph,
             ctx, node.source->attrs, ndinputs, ndoutputs, req, dispatch_mode, state);
       }
       for (size_t j = 0; j < ndoutputs.size(); ++j) {
+        size_t eid = idx.entry_id(i, j);
         if (mxnet::op::shape_is_none(ndoutputs[j]->shape())) {
+          if (pipelined) {
+            pending.emplace(eid, *ndoutputs[j]);
+            continue;
+          }
           ndoutputs[j]->WaitToRead();
           ndoutputs[j]->SetShapeFromChunk();
         }
-        size_t eid     = idx.entry_id(i, j);
         auto shape     = ndoutputs[j]->shape();
         (*shapes)[eid] = shape;
       }
@@ -229,6 +255,9 @@ void NaiveRunGraph(const bool retain_graph,
       mxnet::common::ExecuteMonOutputCallback(idx, arrays, i, callback);
     }
   }
+  while (!pending.empty()) {
+    sync_shape(pending.begin()->first);
+  }
 }
 
 }  // namespace imperative
@@ -24,12 +24,15 @@
 #include <vector>
 #include <map>
 #include <string>
+#include "./cuda_graphs.h"
+#include "./dispatch_cache.h"
 #include "./exec_pass.h"
 #include "../c_api/c_api_common.h"
 #include "../common/utils.h"
 #include "../common/exec_utils.h"
 #include "../operator/nn/mkldnn/mkldnn_base-inl.h"
 #include "../operator/operator_common.h"
+#include "../profiler/profiler.h"
 
 #ifndef MXNET_IMPERATIVE_IMPERATIVE_UTILS_H_
 #define MXNET_IMPERATIVE_IMPERATIVE_UTILS_H_
@@ -118,6 +121,8 @@ struct MemoryPlanInfo {
   uint32_t root;
   size_t size;
   bool inplace;
+  /*! \brief offset in bytes of the entry in the memory of its root, see FViewOutputs */
+  size_t offset;
 };
 
 struct EngineOprDeleter {
@@ -184,17 +189,16 @@ inline void SetShapeType(const Context& ctx,
   static auto& inferstorage    = nnvm::Op::GetAttr<FInferStorageType>("FInferStorageType");
   MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
   // infer shape
+  // the shapes are assigned to those of the last call, which reuse their buffers
   mxnet::ShapeVector& in_shapes = ret->arg_shapes;
-  in_shapes.clear();
-  in_shapes.reserve(inputs.size());
-  for (auto& i : inputs) {
-    in_shapes.push_back(i->shape());
+  in_shapes.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    in_shapes[i] = inputs[i]->shape();
   }
   mxnet::ShapeVector& out_shapes = ret->out_shapes;
-  out_shapes.clear();
-  out_shapes.reserve(outputs.size());
-  for (auto& i : outputs) {
-    out_shapes.push_back(i->shape());
+  out_shapes.resize(outputs.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    out_shapes[i] = outputs[i]->shape();
   }
   bool is_dynamic_shape_existing = !infershape.count(attrs.op);
   if (!is_dynamic_shape_existing) {
@@ -320,67 +324,86 @@ inline void SetShapeType(const Context& ctx,
   }
 }
 
-/*! \brief Set read and write vars, resource requests and mutate_idx
+/*! \brief the resource requests of the operator, with the temporary space of storage fallback */
+inline std::vector<ResourceRequest> GetResourceRequests(const nnvm::NodeAttrs& attrs,
+                                                        const Context& ctx,
+                                                        const DispatchMode dispatch_mode) {
+  static auto& ftmp_resource    = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static auto& ftmp_resource_ex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+
+  std::vector<ResourceRequest> resource_reqs;
+  const bool rsc_req    = (ftmp_resource.count(attrs.op) != 0);
+  const bool rsc_ex_req = (ftmp_resource_ex.count(attrs.op) != 0);
+  if (rsc_req || rsc_ex_req) {
+    resource_reqs = rsc_ex_req ? ftmp_resource_ex[attrs.op](
+                                     attrs, static_cast<int>(ctx.dev_mask()), dispatch_mode)
+                               : ftmp_resource[attrs.op](attrs);
+    const int ntmp = std::count_if(
+        resource_reqs.begin(), resource_reqs.end(), [](const ResourceRequest& req) {
+          return req.type == ResourceRequest::kTempSpace;
+        });
+    CHECK_LE(ntmp, 1) << "Only support 1 temp space request";
+  }
+
+  // append extra resource requests for storage fallback
+  if (dispatch_mode == DispatchMode::kFComputeFallback) {
+    resource_reqs.emplace_back(ResourceRequest::kTempSpace);
+  }
+  return resource_reqs;
+}
+
+/*! \brief Set read and write vars and the resources of resource_reqs
  *
  * For inputs and outputs arguments only NDArray::var() is accessed.
  */
-inline void SetDependency(const nnvm::NodeAttrs& attrs,
-                          const Context& ctx,
+inline void SetDependency(const Context& ctx,
                           const std::vector<NDArray*>& inputs,
                           const std::vector<NDArray*>& outputs,
+                          const std::vector<ResourceRequest>& resource_reqs,
+                          const std::vector<uint32_t>& mutate_idx,
                           std::vector<engine::VarHandle>* p_read_vars,
                           std::vector<engine::VarHandle>* p_write_vars,
-                          std::vector<Resource>* p_requested,
-                          std::vector<uint32_t>* p_mutate_idx,
-                          const DispatchMode dispatch_mode) {
-  static auto& fmutate          = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
-  static auto& ftmp_resource    = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
-  static auto& ftmp_resource_ex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
-
+                          std::vector<Resource>* p_requested) {
   std::vector<engine::VarHandle>& read_vars  = *p_read_vars;
   std::vector<engine::VarHandle>& write_vars = *p_write_vars;
   std::vector<Resource>& requested           = *p_requested;
-  std::vector<uint32_t>& mutate_idx          = *p_mutate_idx;
 
-  if (fmutate.count(attrs.op)) {
-    mutate_idx = fmutate[attrs.op](attrs);
-  }
-  const bool rsc_req    = (ftmp_resource.count(attrs.op) != 0);
-  const bool rsc_ex_req = (ftmp_resource_ex.count(attrs.op) != 0);
-  if (rsc_req || rsc_ex_req) {
-    int ntmp           = 0;
-    auto resource_reqs = rsc_ex_req ? ftmp_resource_ex[attrs.op](
-                                          attrs, static_cast<int>(ctx.dev_mask()), dispatch_mode)
-                                    : ftmp_resource[attrs.op](attrs);
-    for (const auto& req : resource_reqs) {
-      switch (req.type) {
-        case ResourceRequest::kTempSpace:
-          ++ntmp;
-        case ResourceRequest::kRandom:
-          requested.push_back(ResourceManager::Get()->Request(ctx, req));
-          write_vars.push_back(requested.back().var);
-          break;
-        case ResourceRequest::kParallelRandom:
-          requested.push_back(ResourceManager::Get()->Request(ctx, req));
+  for (const auto& req : resource_reqs) {
+    switch (req.type) {
+      case ResourceRequest::kTempSpace:
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        // a dynamic temp space is of this op only
+        if (requested.back().var != nullptr)
           write_vars.push_back(requested.back().var);
-          break;
+        break;
+      case ResourceRequest::kRandom:
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        write_vars.push_back(requested.back().var);
+        break;
+      case ResourceRequest::kParallelRandom:
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        write_vars.push_back(requested.back().var);
+        break;
+      case ResourceRequest::kCounterRandom:
+        // only read, the ops drawing from it run concurrently
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        read_vars.push_back(requested.back().var);
+        break;
 #if MXNET_USE_CUDNN == 1
-        case ResourceRequest::kCuDNNDropoutDesc:
-          requested.push_back(ResourceManager::Get()->Request(ctx, req));
-          write_vars.push_back(requested.back().var);
-          break;
+      case ResourceRequest::kCuDNNDropoutDesc:
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        write_vars.push_back(requested.back().var);
+        break;
 #endif  // MXNET_USE_CUDNN == 1
-        default:
-          LOG(FATAL) << "resource type not yet supported";
-      }
+#if MXNET_USE_NCCL == 1
+      case ResourceRequest::kNCCLComm:
+        requested.push_back(ResourceManager::Get()->Request(ctx, req));
+        write_vars.push_back(requested.back().var);
+        break;
+#endif  // MXNET_USE_NCCL == 1
+      default:
+        LOG(FATAL) << "resource type not yet supported";
     }
-    CHECK_LE(ntmp, 1) << "Only support 1 temp space request";
-  }
-
-  // append extra resource requests for storage fallback
-  if (dispatch_mode == DispatchMode::kFComputeFallback) {
-    requested.push_back(ResourceManager::Get()->Request(ctx, ResourceRequest::kTempSpace));
-    write_vars.push_back(requested.back().var);
   }
 
   read_vars.reserve(inputs.size());
@@ -397,6 +420,34 @@ inline void SetDependency(const nnvm::NodeAttrs& attrs,
   Engine::Get()->DeduplicateVarHandle(&read_vars, &write_vars);
 }
 
+/*! \brief Set read and write vars, resource requests and mutate_idx
+ *
+ * For inputs and outputs arguments only NDArray::var() is accessed.
+ */
+inline void SetDependency(const nnvm::NodeAttrs& attrs,
+                          const Context& ctx,
+                          const std::vector<NDArray*>& inputs,
+                          const std::vector<NDArray*>& outputs,
+                          std::vector<engine::VarHandle>* p_read_vars,
+                          std::vector<engine::VarHandle>* p_write_vars,
+                          std::vector<Resource>* p_requested,
+                          std::vector<uint32_t>* p_mutate_idx,
+                          const DispatchMode dispatch_mode) {
+  static auto& fmutate = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+
+  if (fmutate.count(attrs.op)) {
+    *p_mutate_idx = fmutate[attrs.op](attrs);
+  }
+  SetDependency(ctx,
+                inputs,
+                outputs,
+                GetResourceRequests(attrs, ctx, dispatch_mode),
+                *p_mutate_idx,
+                p_read_vars,
+                p_write_vars,
+                p_requested);
+}
+
 /*! \brief Reset vector of OpReqType *req based on input and output NDArrays.
  *
  * Set to kWriteInplace if corresponding output shares variable with any input
@@ -436,6 +487,13 @@ inline nnvm::NodeAttrs ParseAttrs(const nnvm::Op* op,
                                   const char** param_vals) {
   static auto& num_args = nnvm::Op::GetAttr<std::string>("key_var_num_args");
 
+  ParsedAttrsCache* cache = ParsedAttrsCache::Get();
+  std::string key         = cache->Key(op, num_inputs, num_params, param_keys, param_vals);
+  if (!key.empty()) {
+    if (const nnvm::NodeAttrs* cached = cache->Find(key))
+      return *cached;
+  }
+
   nnvm::NodeAttrs attrs;
   attrs.op = op;
   attrs.dict.reserve(num_params + 1);
@@ -449,6 +507,8 @@ inline nnvm::NodeAttrs ParseAttrs(const nnvm::Op* op,
     op->attr_parser(&attrs);
   }
 
+  if (!key.empty())
+    cache->Insert(std::move(key), attrs);
   return attrs;
 }
 
@@ -645,6 +705,37 @@ inline void SetupDefaultBlobsInOut(const std::vector<NDArray*>& ndinputs,
   DerefInputOutput(in, out, &newIn, &newOut);           \
   DerefInputOutputRelease(in, out)
 
+/*!
+ * \brief Set the cost of the operator pushed next to the engine by this thread, when the
+ *  profiler aggregates the stats and the operator registers a FComputeCost. The bytes are
+ *  those of the dense inputs and outputs, read or written once.
+ */
+inline void SetOperatorCost(const nnvm::Op* op,
+                            const nnvm::NodeAttrs& attrs,
+                            const std::vector<NDArray*>& inputs,
+                            const std::vector<NDArray*>& outputs) {
+  static auto& fcompute_cost = nnvm::Op::GetAttr<FComputeCost>("FComputeCost");
+  if (!fcompute_cost.count(op) || !profiler::Profiler::Get()->AggregateRunning())
+    return;
+  mxnet::ShapeVector in_shapes, out_shapes;
+  for (const NDArray* arr : inputs)
+    in_shapes.push_back(arr->shape());
+  for (const NDArray* arr : outputs)
+    out_shapes.push_back(arr->shape());
+  if (!shape_is_known(in_shapes) || !shape_is_known(out_shapes))
+    return;
+  uint64_t bytes = 0;
+  for (const std::vector<NDArray*>* arrays : {&inputs, &outputs}) {
+    for (const NDArray* arr : *arrays) {
+      if (arr->storage_type() == kDefaultStorage)
+        bytes += arr->shape().Size() * mshadow::mshadow_sizeof(arr->dtype());
+    }
+  }
+  profiler::OperatorCost* cost = profiler::OperatorCost::ThreadNext();
+  cost->flops                  = fcompute_cost[op](attrs, in_shapes, out_shapes);
+  cost->bytes                  = bytes;
+}
+
 inline void PushFCompute(const FCompute& fn,
                          const nnvm::Op* op,
                          const nnvm::NodeAttrs& attrs,
@@ -691,10 +782,10 @@ inline void PushFCompute(const FCompute& fn,
     OpContext opctx{need_grad, is_train, rctx, engine::CallbackOnComplete(), requested};
     bool is_gpu = ctx.dev_mask() == gpu::kDevMask;
     // pre-fcompute fallback, cast to default storage type
-    CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu);
+    CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu, op);
     fn(attrs, opctx, input_blobs, tmp_req, output_blobs);
     // post-fcompute fallback, cast to original storage type
-    CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu);
+    CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu, op);
     if (is_gpu && !rctx.is_bulk) {
       rctx.get_stream<gpu>()->Wait();
     }
@@ -704,6 +795,7 @@ inline void PushFCompute(const FCompute& fn,
     // execute without engine
     run(RunContext{ctx, nullptr, nullptr, false});
   } else {
+    SetOperatorCost(op, attrs, inputs, outputs);
     Engine::Get()->PushSync(
         run, ctx, read_vars, write_vars, FnProperty::kNormal, 0, op->name.c_str());
   }
@@ -741,6 +833,7 @@ inline void PushFComputeEx(const FComputeEx& fn,
     run(RunContext{ctx, nullptr, nullptr, false});
   } else {
     CHECK(exec_type == ExecType::kSync);
+    SetOperatorCost(op, attrs, inputs, outputs);
     Engine::Get()->PushSync(
         run, ctx, read_vars, write_vars, FnProperty::kNormal, 0, op->name.c_str());
   }
@@ -790,6 +883,7 @@ inline void PushOperator(const OpStatePtr& state,
       RunContext rctx{ctx, nullptr, nullptr, false};
       run(rctx, engine::CallbackOnComplete());
     } else if (exec_type == ExecType::kSync) {
+      SetOperatorCost(op, attrs, inputs, outputs);
       Engine::Get()->PushSync([=](RunContext rctx) { run(rctx, engine::CallbackOnComplete()); },
                               ctx,
                               read_vars,
@@ -799,6 +893,7 @@ inline void PushOperator(const OpStatePtr& state,
                               op->name.c_str());
     } else {
       CHECK(exec_type == ExecType::kAsync);
+      SetOperatorCost(op, attrs, inputs, outputs);
       Engine::Get()->PushAsync(
           run, ctx, read_vars, write_vars, FnProperty::kAsync, 0, op->name.c_str());
     }
@@ -836,10 +931,10 @@ inline void PushOperator(const OpStatePtr& state,
       // setup contexts
       const bool is_gpu = rctx.get_ctx().dev_mask() == gpu::kDevMask;
       // pre-fcompute fallback
-      CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu);
+      CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu, op);
       fcompute(state, opctx, input_blobs, tmp_req, output_blobs);
       // post-fcompute fallback, cast to original storage type, if necessary
-      CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu);
+      CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu, op);
       if (is_gpu && exec_type == ExecType::kSync && rctx.get_stream<gpu>() && !rctx.is_bulk) {
         rctx.get_stream<gpu>()->Wait();
       }
@@ -850,6 +945,7 @@ inline void PushOperator(const OpStatePtr& state,
       RunContext rctx{ctx, nullptr, nullptr, false};
       run(rctx, engine::CallbackOnComplete());
     } else if (exec_type == ExecType::kSync) {
+      SetOperatorCost(op, attrs, inputs, outputs);
       Engine::Get()->PushSync([=](RunContext rctx) { run(rctx, engine::CallbackOnComplete()); },
                               ctx,
                               read_vars,
@@ -859,6 +955,7 @@ inline void PushOperator(const OpStatePtr& state,
                               op->name.c_str());
     } else {
       CHECK(exec_type == ExecType::kAsync);
+      SetOperatorCost(op, attrs, inputs, outputs);
       Engine::Get()->PushAsync(
           run, ctx, read_vars, write_vars, FnProperty::kAsync, 0, op->name.c_str());
     }
@@ -1079,16 +1176,19 @@ inline MemoryPlanVector MXPlanMemory(nnvm::Graph* p_g,
                                      const std::string& storage_plan,
                                      const std::pair<uint32_t, uint32_t>& node_range  = {0, 0},
                                      const std::pair<uint32_t, uint32_t>& entry_range = {0, 0},
-                                     bool detect_inplace_addto                        = false) {
+                                     bool detect_inplace_addto                        = false,
+                                     bool view_outputs                                = false) {
   using namespace nnvm;
+  exec::PassTimer timer("MXPlanMemory");
   nnvm::Graph& g  = *p_g;
   const auto& idx = g.indexed_graph();
   if (node_range.second > node_range.first) {
     g.attrs["node_range"] = std::make_shared<dmlc::any>(node_range);
   }
-  g.attrs["ref_count"] = std::make_shared<dmlc::any>(ref_count);
-  g.attrs["storage"]   = std::make_shared<dmlc::any>(std::move(storage));
-  g                    = nnvm::ApplyPass(g, "MXPlanMemory");
+  g.attrs["ref_count"]    = std::make_shared<dmlc::any>(ref_count);
+  g.attrs["storage"]      = std::make_shared<dmlc::any>(std::move(storage));
+  g.attrs["view_outputs"] = std::make_shared<dmlc::any>(view_outputs);
+  g                       = nnvm::ApplyPass(g, "MXPlanMemory");
   if (detect_inplace_addto)
     g = exec::DetectInplaceAddTo(g);
 
@@ -1097,25 +1197,39 @@ inline MemoryPlanVector MXPlanMemory(nnvm::Graph* p_g,
   const auto& storage_inplace = g.GetAttr<std::vector<int> >("storage_inplace_index");
   g.attrs[storage_plan]       = std::make_shared<any>(storage_inplace);
   const auto& storage_ids     = g.GetAttr<StorageVector>("storage_id");
+  const auto& offsets         = g.GetAttr<std::vector<size_t> >("storage_offset");
   uint32_t entry_start        = entry_range.first;
   uint32_t entry_end =
       entry_range.second > entry_start ? entry_range.second : idx.num_node_entries();
   MemoryPlanVector mem_plan(idx.num_node_entries());
+  // the root of a storage is its first entry of the lowest offset, as the entries written in
+  // place in the output of a later node, see FViewInputs, may come before that output
   std::unordered_map<int, uint32_t> sid_to_root;
+  for (uint32_t i = entry_start; i < entry_end; ++i) {
+    if (storage_ids[i] < 0)
+      continue;
+    auto it = sid_to_root.find(storage_ids[i]);
+    if (it == sid_to_root.end())
+      sid_to_root[storage_ids[i]] = i;
+    else if (offsets[i] < offsets[it->second])
+      it->second = i;
+  }
 
   for (uint32_t i = entry_start; i < entry_end; ++i) {
     if (storage_ids[i] < 0) {
-      mem_plan[i] = {storage_ids[i], i, 0, false};
-    } else if (!sid_to_root.count(storage_ids[i])) {
+      mem_plan[i] = {storage_ids[i], i, 0, false, 0};
+      continue;
+    }
+    const uint32_t root = sid_to_root.at(storage_ids[i]);
+    // the offset is relative to the root
+    const size_t offset = offsets[i] - offsets[root];
+    const size_t bytes  = mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size();
+    if (root == i) {
       CHECK_LT(storage_inplace[i], 0);
-      sid_to_root[storage_ids[i]] = i;
-      mem_plan[i]                 = {
-          storage_ids[i], i, mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size(), false};
+      mem_plan[i] = {storage_ids[i], i, std::max(mem_plan[i].size, bytes), false, 0};
     } else {
-      uint32_t root = sid_to_root[storage_ids[i]];
-      mem_plan[i]   = {storage_ids[i], root, 0, storage_inplace[i] >= 0};
-      mem_plan[root].size =
-          std::max(mem_plan[root].size, mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size());
+      mem_plan[i]         = {storage_ids[i], root, 0, storage_inplace[i] >= 0, offset};
+      mem_plan[root].size = std::max(mem_plan[root].size, offset + bytes);
     }
   }
 
@@ -1153,8 +1267,19 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
     }
   }
 
-  const NDArray* pntr;
+  // the roots first, as the other entries of their storage are placed in their memory
+  std::vector<uint32_t> order;
   for (uint32_t i = entry_start; i < entry_end; ++i) {
+    if (mem_plan[i].root == i)
+      order.push_back(i);
+  }
+  for (uint32_t i = entry_start; i < entry_end; ++i) {
+    if (mem_plan[i].root != i)
+      order.push_back(i);
+  }
+
+  const NDArray* pntr;
+  for (const uint32_t i : order) {
     const auto& plan = mem_plan[i];
     if (plan.storage_id == exec::kExternalStorageID)
       continue;
@@ -1187,7 +1312,7 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
       if (plan.inplace && array_reqs->at(i) == kWriteTo)
         array_reqs->at(i) = kWriteInplace;
     }
-    arrays[i]->InitAsArray(*pntr, shapes[i], dtypes[i]);
+    arrays[i]->InitAsArray(*pntr, shapes[i], dtypes[i], plan.offset);
   }
 
   return new_pool;
@@ -1216,10 +1341,17 @@ inline void SetupOpExec(const nnvm::Graph& g,
   exec->Setup();
 }
 
+/*!
+ * \brief create an engine operator running execs in order.
+ * \param attrs if not null, the node attributes of execs. Synchronous GPU
+ *  segments then replay their operators from CUDA graphs when
+ *  MXNET_ENABLE_CUDA_GRAPHS is set.
+ */
 inline Engine::OprHandle CreateEngineOp(
     const Context& default_ctx,
     const std::vector<std::shared_ptr<exec::OpExecutor> >& execs,
-    const char* opr_names) {
+    const char* opr_names,
+    const std::vector<nnvm::NodeAttrs>* attrs = nullptr) {
   CHECK_GT(execs.size(), 0);
   std::vector<Engine::VarHandle> use_vars, mutate_vars;
 
@@ -1232,7 +1364,11 @@ inline Engine::OprHandle CreateEngineOp(
       use_vars.push_back(nd.var());
     }
     for (auto& r : exec->op_ctx.requested) {
-      mutate_vars.push_back(r.var);
+      if (r.req.type == ResourceRequest::kCounterRandom) {
+        use_vars.push_back(r.var);
+      } else if (r.var != nullptr) {
+        mutate_vars.push_back(r.var);
+      }
     }
     for (auto& nd : exec->out_array) {
       mutate_vars.push_back(nd.var());
@@ -1247,13 +1383,31 @@ inline Engine::OprHandle CreateEngineOp(
   bool is_gpu   = default_ctx.dev_mask() == gpu::kDevMask;
   bool is_async = execs.size() > 1 ? false : execs[0]->exec_type() == ExecType::kAsync;
 
+#if MXNET_CUDA_GRAPHS_AVAILABLE
+  std::shared_ptr<cuda_graphs::CudaGraphsExec> graphs;
+  if (attrs != nullptr && is_gpu && !is_async) {
+    graphs = std::make_shared<cuda_graphs::CudaGraphsExec>(execs, *attrs, opr_names);
+  }
+  auto exec_fun = [execs, is_async, is_gpu, graphs](RunContext ctx,
+                                                    Engine::CallbackOnComplete on_complete) {
+#else
   auto exec_fun = [execs, is_async, is_gpu](RunContext ctx,
                                             Engine::CallbackOnComplete on_complete) {
+#endif  // MXNET_CUDA_GRAPHS_AVAILABLE
     if (is_async) {
       execs[0]->op_ctx.async_on_complete = on_complete;
     }
+#if MXNET_CUDA_GRAPHS_AVAILABLE
+    if (graphs != nullptr) {
+      graphs->RunAll(ctx);
+    } else {
+      for (const auto& exec : execs)
+        exec->Run(ctx, is_gpu);
+    }
+#else
     for (const auto& exec : execs)
       exec->Run(ctx, is_gpu);
+#endif  // MXNET_CUDA_GRAPHS_AVAILABLE
     // call on complete only if it is async op
     if (!is_async) {
       if (is_gpu) {
@@ -1264,6 +1418,17 @@ inline Engine::OprHandle CreateEngineOp(
         LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
 #endif
       }
+      bool keep_space = false;
+#if MXNET_CUDA_GRAPHS_AVAILABLE
+      // the cuda graphs replay the kernels with the captured temp space
+      keep_space = graphs != nullptr;
+#endif  // MXNET_CUDA_GRAPHS_AVAILABLE
+      if (!keep_space) {
+        for (const auto& exec : execs) {
+          for (const auto& r : exec->op_ctx.requested)
+            r.release_space();
+        }
+      }
       on_complete();
     }
   };
@@ -1279,9 +1444,14 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
                               const size_t bulk_size,
                               const std::vector<std::shared_ptr<exec::OpExecutor> >& execs,
                               const std::vector<int> skip_plus_node,
-                              std::vector<EngineOprSeg>* opr_segs) {
+                              std::vector<EngineOprSeg>* opr_segs,
+                              const bool use_cuda_graphs           = false,
+                              const std::vector<int>& stream_group = std::vector<int>()) {
   size_t seg_start = start_nid;
+  int seg_group    = -1;
   std::vector<std::shared_ptr<exec::OpExecutor> > seg_execs;
+  std::vector<nnvm::NodeAttrs> seg_attrs;
+  const std::vector<nnvm::NodeAttrs>* p_seg_attrs = use_cuda_graphs ? &seg_attrs : nullptr;
   std::string opr_names = "[";
   for (size_t nid = start_nid; nid < end_nid; ++nid) {
     const auto& node = idx[nid];
@@ -1294,8 +1464,10 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
     bool is_async       = exec->exec_type() != ExecType::kSync;
     bool valid          = exec->out_array.size() > 0;
 
-    // Stop at async nodes and invalid node (due to input/output is not allocated)
-    bool stop = is_async || !valid || seg_execs.size() >= bulk_size;
+    // Stop at async nodes and invalid node (due to input/output is not allocated), and at the
+    // start of another branch when the branches are grouped
+    bool new_group = stream_group.size() && seg_execs.size() && stream_group[nid] != seg_group;
+    bool stop      = is_async || !valid || seg_execs.size() >= bulk_size || new_group;
 
     // Create opr segment for previous nodes.
     if (stop && nid > seg_start) {
@@ -1304,16 +1476,21 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
         seg = EngineOprSeg{false, nid};
         opr_names.pop_back();
         opr_names += "]";
-        seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+        seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str(), p_seg_attrs));
       } else {
         seg = EngineOprSeg{true, nid, nullptr};
       }
       seg_start = nid;
       seg_execs.clear();
+      seg_attrs.clear();
       opr_names.clear();
     }
 
     seg_execs.push_back(exec);
+    if (stream_group.size())
+      seg_group = stream_group[nid];
+    if (use_cuda_graphs)
+      seg_attrs.push_back(node.source->attrs);
 
     const auto& inode = idx[nid];
     opr_names += op_name;
@@ -1331,14 +1508,16 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
     if (!valid) {
       seg = EngineOprSeg{false, nid + 1, nullptr};
       seg_execs.clear();
+      seg_attrs.clear();
       opr_names.clear();
       seg_start = nid + 1;
     } else if (is_async) {
       seg = EngineOprSeg{false, nid + 1};
       opr_names.pop_back();
       opr_names += "]";
-      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str(), p_seg_attrs));
       seg_execs.clear();
+      seg_attrs.clear();
       opr_names.clear();
       seg_start = nid + 1;
     }
@@ -1350,7 +1529,7 @@ inline void CreateEngineOpSeg(const nnvm::IndexedGraph& idx,
       seg = EngineOprSeg{false, end_nid};
       opr_names.pop_back();
       opr_names += "]";
-      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str()));
+      seg.opr.reset(CreateEngineOp(default_ctx, seg_execs, opr_names.c_str(), p_seg_attrs));
     } else {
       seg = EngineOprSeg{true, end_nid, nullptr};
     }
@@ -25,7 +25,10 @@
 #include <mxnet/op_attr_types.h>
 #include <mxnet/graph_attr_types.h>
 #include <mxnet/imperative.h>
+#include <algorithm>
+#include <exception>
 #include "./exec_pass.h"
+#include "../engine/openmp.h"
 #include "../operator/operator_common.h"
 #include "../common/exec_utils.h"
 
@@ -232,6 +235,145 @@ void ProvideAttrToFusion(const uint32_t nid,
   provide(inode.source->attrs, inode.source->control_deps, in_attrs, out_attrs);
 }
 
+/*!
+ * \brief Whether the forward sweeps of the attribute inference may infer the operators
+ *  of a topological level in parallel, set by MXNET_INFER_GRAPH_ATTR_PARALLEL.
+ */
+inline bool ParallelInferenceEnabled(uint32_t num_nodes) {
+  // smaller graphs are not worth the threads
+  return num_nodes >= 256 && dmlc::GetEnv("MXNET_INFER_GRAPH_ATTR_PARALLEL", false) &&
+         engine::OpenMP::Get()->GetRecommendedOMPThreadCount() > 1;
+}
+
+/*!
+ * \brief Group the nodes in [node_start, node_end) by topological level: the nodes of a
+ *  level only depend, through their inputs and control dependencies, on the nodes of the
+ *  previous levels. The nodes of every level are in increasing order.
+ */
+inline std::vector<std::vector<uint32_t>> TopologicalLevels(const nnvm::IndexedGraph& idx,
+                                                            uint32_t node_start,
+                                                            uint32_t node_end) {
+  std::vector<uint32_t> node_level(node_end - node_start, 0);
+  std::vector<std::vector<uint32_t>> levels;
+  for (uint32_t nid = node_start; nid < node_end; ++nid) {
+    const auto& inode = idx[nid];
+    uint32_t level    = 0;
+    for (const auto& e : inode.inputs) {
+      if (e.node_id >= node_start)
+        level = std::max(level, node_level[e.node_id - node_start] + 1);
+    }
+    for (const uint32_t dep : inode.control_deps) {
+      if (dep >= node_start)
+        level = std::max(level, node_level[dep - node_start] + 1);
+    }
+    node_level[nid - node_start] = level;
+    if (levels.size() <= level)
+      levels.resize(level + 1);
+    levels[level].push_back(nid);
+  }
+  return levels;
+}
+
+/*!
+ * \brief Forward sweep of the attribute inference which infers the operators of every
+ *  topological level in parallel.
+ *
+ *  The operators for which fparallel(nid) holds are inferred concurrently by
+ *  fapply(nid, &in_attrs, &out_attrs), which must only read rshape, and their results are
+ *  then written back in node order. An operator reading an input attribute that an earlier
+ *  operator of the level updated is inferred again by fstep(nid), the serial step, like
+ *  the other nodes of the level.
+ *
+ * \param idx indexed graph
+ * \param levels nodes grouped by TopologicalLevels
+ * \param rshape attributes of the node entries
+ * \param inference_finished nodes whose attributes are all inferred
+ * \param fparallel whether the attributes of a node can be inferred concurrently
+ * \param fapply inference of a node from the given attributes, returns whether they are all
+ *               known after the inference
+ * \param fstep serial inference step of a node
+ */
+template <typename AttrType, typename FParallel, typename FApply, typename FStep>
+void ParallelForwardSweep(const nnvm::IndexedGraph& idx,
+                          const std::vector<std::vector<uint32_t>>& levels,
+                          std::vector<AttrType>* rshape,
+                          std::vector<bool>* inference_finished,
+                          FParallel fparallel,
+                          FApply fapply,
+                          FStep fstep) {
+  // levels with fewer operators are inferred serially
+  const size_t kMinParallelNodes = 32;
+  const int nthreads             = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const int np_shape             = Imperative::Get()->is_np_shape();
+  std::vector<AttrType>& attrs   = *rshape;
+  // level in which an entry was last updated during the write back, plus one
+  std::vector<uint32_t> updated(attrs.size(), 0);
+  std::vector<uint32_t> batch, serial;
+  for (size_t level = 0; level < levels.size(); ++level) {
+    batch.clear();
+    serial.clear();
+    for (const uint32_t nid : levels[level]) {
+      if ((*inference_finished)[nid])
+        continue;
+      if (fparallel(nid)) {
+        batch.push_back(nid);
+      } else {
+        serial.push_back(nid);
+      }
+    }
+    if (batch.size() < kMinParallelNodes) {
+      for (const uint32_t nid : levels[level])
+        fstep(nid);
+      continue;
+    }
+    const int num_batch = static_cast<int>(batch.size());
+    std::vector<std::vector<AttrType>> in_attrs(num_batch), out_attrs(num_batch);
+    std::vector<char> finished(num_batch, 0);
+    std::vector<std::exception_ptr> errors(num_batch);
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic, 4)
+    for (int k = 0; k < num_batch; ++k) {
+      // the numpy shape semantics of the caller is thread local
+      if (np_shape != NumpyShape::GlobalOn && Imperative::Get()->is_np_shape() != np_shape)
+        Imperative::Get()->set_is_np_shape(np_shape);
+      try {
+        finished[k] = fapply(batch[k], &in_attrs[k], &out_attrs[k]);
+      } catch (...) {
+        errors[k] = std::current_exception();
+      }
+    }
+    const uint32_t stamp = static_cast<uint32_t>(level) + 1;
+    for (int k = 0; k < num_batch; ++k) {
+      const uint32_t nid = batch[k];
+      const auto& inode  = idx[nid];
+      bool stale         = false;
+      for (const auto& e : inode.inputs) {
+        stale = stale || updated[idx.entry_id(e)] == stamp;
+      }
+      if (stale) {
+        fstep(nid);
+        for (const auto& e : inode.inputs)
+          updated[idx.entry_id(e)] = stamp;
+        continue;
+      }
+      if (errors[k])
+        std::rethrow_exception(errors[k]);
+      for (size_t i = 0; i < inode.inputs.size(); ++i) {
+        const uint32_t eid = idx.entry_id(inode.inputs[i]);
+        if (!(attrs[eid] == in_attrs[k][i])) {
+          attrs[eid]   = in_attrs[k][i];
+          updated[eid] = stamp;
+        }
+      }
+      for (size_t i = 0; i < out_attrs[k].size(); ++i) {
+        attrs[idx.entry_id(nid, i)] = out_attrs[k][i];
+      }
+      (*inference_finished)[nid] = finished[k];
+    }
+    for (const uint32_t nid : serial)
+      fstep(nid);
+  }
+}
+
 /*!\brief
  * This is a duplicate of the InferAttr function in nnvm with minor modification
  * to support inferring storage type whose function signature is different from
@@ -362,6 +504,31 @@ nnvm::Graph InferAttr(nnvm::Graph&& ret,
   // Temp space for shape inference.
   std::vector<AttrType> ishape, oshape;
 
+  // calls the inference function of operator nid, returns whether all its attributes are known
+  auto apply_infer = [&](uint32_t nid, AttrVector* ishape, AttrVector* oshape) {
+    const auto& inode           = idx[nid];
+    DispatchMode* dispatch_mode = nullptr;
+    if (dispatch_mode_name != nullptr) {
+      dispatch_mode = &dispatch_modes[nid];
+    }
+    auto finfer = finfer_shape.get(inode.source->op(), fdefault);
+    try {
+      ApplyOpInferAttr(ret, finfer, inode.source->attrs, nid, ishape, oshape, dispatch_mode);
+    } catch (const std::exception& e) {
+      throw dmlc::Error("Error in operator " + inode.source->attrs.name + ": " + e.what());
+    }
+    bool finished = true;
+    for (const auto& attr : *ishape) {
+      if (fis_none(attr))
+        finished = false;
+    }
+    for (const auto& attr : *oshape) {
+      if (fis_none(attr))
+        finished = false;
+    }
+    return finished;
+  };
+
   // inference step function for nid
   auto infer_step = [&](uint32_t nid, bool last_iter) {
     if (inference_finished[nid])
@@ -405,7 +572,6 @@ nnvm::Graph InferAttr(nnvm::Graph&& ret,
             nid, idx, &rshape, &inference_finished, fis_none, infer_fusion_name);
       }
     } else {
-      DispatchMode* dispatch_mode = nullptr;
       // Forward operator inference.
       ishape.resize(num_inputs, empty_val);
       for (uint32_t i = 0; i < ishape.size(); ++i) {
@@ -415,31 +581,13 @@ nnvm::Graph InferAttr(nnvm::Graph&& ret,
       for (uint32_t i = 0; i < oshape.size(); ++i) {
         oshape[i] = rshape[idx.entry_id(nid, i)];
       }
-      if (dispatch_mode_name != nullptr) {
-        dispatch_mode = &dispatch_modes[nid];
-      }
-      auto finfer = finfer_shape.get(inode.source->op(), fdefault);
-      if (finfer != nullptr) {
+      if (finfer_shape.get(inode.source->op(), fdefault) != nullptr) {
         // Call inference function of the operator.
-        try {
-          static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
-          if (is_fusion.get(inode.source->op(), false)) {
-            ProvideAttrToFusion<FProvideSubgraphType>(nid, idx, rshape, provide_fusion_name);
-          }
-          ApplyOpInferAttr(ret, finfer, inode.source->attrs, nid, &ishape, &oshape, dispatch_mode);
-          bool finished = true;
-          for (const auto& attr : ishape) {
-            if (fis_none(attr))
-              finished = false;
-          }
-          for (const auto& attr : oshape) {
-            if (fis_none(attr))
-              finished = false;
-          }
-          inference_finished[nid] = finished;
-        } catch (const std::exception& e) {
-          throw dmlc::Error("Error in operator " + inode.source->attrs.name + ": " + e.what());
+        static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
+        if (is_fusion.get(inode.source->op(), false)) {
+          ProvideAttrToFusion<FProvideSubgraphType>(nid, idx, rshape, provide_fusion_name);
         }
+        inference_finished[nid] = apply_infer(nid, &ishape, &oshape);
       } else {
         // Operator does not provide sttribute inference function,
         // so we need to test if everything was inferred by other operators
@@ -471,6 +619,36 @@ nnvm::Graph InferAttr(nnvm::Graph&& ret,
     }
   };
 
+  // storage type inference stays serial, it logs the storage fallbacks
+  const bool parallel =
+      dispatch_mode_name == nullptr && ParallelInferenceEnabled(node_end - node_start);
+  std::vector<std::vector<uint32_t>> levels;
+  if (parallel)
+    levels = TopologicalLevels(idx, node_start, node_end);
+  // whether operator nid can be inferred concurrently with the others of its level
+  auto is_plain = [&](uint32_t nid) {
+    static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
+    const nnvm::Node* node = idx[nid].source;
+    return !node->is_variable() &&
+           !(is_backward.get(node->op(), false) && node->control_deps.size() &&
+             bwd_identity_assign) &&
+           !is_fusion.get(node->op(), false) && node->attrs.subgraphs.empty() &&
+           finfer_shape.get(node->op(), fdefault) != nullptr;
+  };
+  // reads the attributes of operator nid and infers them
+  auto read_and_apply = [&](uint32_t nid, AttrVector* ishape, AttrVector* oshape) {
+    const auto& inode = idx[nid];
+    ishape->resize(inode.inputs.size(), empty_val);
+    for (uint32_t i = 0; i < ishape->size(); ++i) {
+      (*ishape)[i] = rshape[idx.entry_id(inode.inputs[i])];
+    }
+    oshape->resize(inode.source->num_outputs(), empty_val);
+    for (uint32_t i = 0; i < oshape->size(); ++i) {
+      (*oshape)[i] = rshape[idx.entry_id(nid, i)];
+    }
+    return apply_infer(nid, ishape, oshape);
+  };
+
   size_t last_num_unknown;
   size_t num_unknown_dispatch_mode = dispatch_mode_name ? node_end - node_start : 0;
   size_t num_unknown_entry_attr    = entry_end - entry_start;
@@ -479,7 +657,10 @@ nnvm::Graph InferAttr(nnvm::Graph&& ret,
   bool do_next_iteration           = true;
   int i                            = 0;
   do {
-    if (i % 2 == 0) {
+    if (i % 2 == 0 && parallel) {
+      ParallelForwardSweep(idx, levels, &rshape, &inference_finished, is_plain, read_and_apply,
+                           [&](uint32_t nid) { infer_step(nid, last_iter); });
+    } else if (i % 2 == 0) {
       for (uint32_t nid = node_start; nid < node_end; ++nid) {
         infer_step(nid, last_iter);
       }
@@ -654,6 +835,31 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
     common::ConvertToNumpyShape(&rshape);
   }
 
+  // calls the inference function of operator nid, returns whether all its shapes are known
+  auto apply_infer = [&](uint32_t nid, AttrVector* ishape, AttrVector* oshape) {
+    const auto& inode           = idx[nid];
+    DispatchMode* dispatch_mode = nullptr;
+    if (dispatch_mode_name != nullptr) {
+      dispatch_mode = &dispatch_modes[nid];
+    }
+    auto finfer = finfer_shape.get(inode.source->op(), fdefault);
+    try {
+      ApplyOpInferAttr(ret, finfer, inode.source->attrs, nid, ishape, oshape, dispatch_mode);
+    } catch (const std::exception& e) {
+      throw dmlc::Error("Error in operator " + inode.source->attrs.name + ": " + e.what());
+    }
+    bool finished = true;
+    for (const auto& attr : *ishape) {
+      if (fis_none(attr))
+        finished = false;
+    }
+    for (const auto& attr : *oshape) {
+      if (fis_none(attr))
+        finished = false;
+    }
+    return finished;
+  };
+
   // inference step function for nid
   auto infer_step = [&](uint32_t nid, bool last_iter) {
     if (inference_finished[nid])
@@ -702,7 +908,6 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
             nid, idx, &rshape, &inference_finished, fis_none, "FAccessSubgraphShape");
       }
     } else {
-      DispatchMode* dispatch_mode = nullptr;
       // Forward operator inference.
       ishape.resize(num_inputs, empty_val);
       bool is_input_dynamic_shape = false;
@@ -716,11 +921,7 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
       for (uint32_t i = 0; i < oshape.size(); ++i) {
         oshape[i] = rshape[idx.entry_id(nid, i)];
       }
-      if (dispatch_mode_name != nullptr) {
-        dispatch_mode = &dispatch_modes[nid];
-      }
-      auto finfer = finfer_shape.get(inode.source->op(), fdefault);
-      if (finfer == nullptr || is_input_dynamic_shape) {
+      if (finfer_shape.get(inode.source->op(), fdefault) == nullptr || is_input_dynamic_shape) {
         for (uint32_t i = 0; i < oshape.size(); ++i) {
           if (!mxnet::ndim_is_known(oshape[i].ndim())) {
             is_dynamic[idx.entry_id(nid, i)] = 1;
@@ -729,26 +930,12 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
         inference_finished[nid] = true;
       } else {
         // Call inference function of the operator.
-        try {
-          static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
-          if (is_fusion.get(inode.source->op(), false)) {
-            ProvideAttrToFusion<exec::FProvideSubgraphShape>(
-                nid, idx, rshape, "FProvideSubgraphShape");
-          }
-          ApplyOpInferAttr(ret, finfer, inode.source->attrs, nid, &ishape, &oshape, dispatch_mode);
-          bool finished = true;
-          for (const auto& attr : ishape) {
-            if (fis_none(attr))
-              finished = false;
-          }
-          for (const auto& attr : oshape) {
-            if (fis_none(attr))
-              finished = false;
-          }
-          inference_finished[nid] = finished;
-        } catch (const std::exception& e) {
-          throw dmlc::Error("Error in operator " + inode.source->attrs.name + ": " + e.what());
+        static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
+        if (is_fusion.get(inode.source->op(), false)) {
+          ProvideAttrToFusion<exec::FProvideSubgraphShape>(
+              nid, idx, rshape, "FProvideSubgraphShape");
         }
+        inference_finished[nid] = apply_infer(nid, &ishape, &oshape);
       }
       // Save to the result map.
       for (uint32_t i = 0; i < num_inputs; ++i) {
@@ -760,6 +947,43 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
     }
   };
 
+  const bool parallel =
+      dispatch_mode_name == nullptr && ParallelInferenceEnabled(node_end - node_start);
+  std::vector<std::vector<uint32_t>> levels;
+  if (parallel)
+    levels = TopologicalLevels(idx, node_start, node_end);
+  // whether operator nid can be inferred concurrently with the others of its level
+  auto is_plain = [&](uint32_t nid) {
+    static auto& is_fusion = Op::GetAttr<exec::TIsFusion>("TIsFusion");
+    const auto& inode      = idx[nid];
+    const nnvm::Node* node = inode.source;
+    if (node->is_variable() ||
+        (is_backward.get(node->op(), false) && node->control_deps.size() && bwd_identity_assign) ||
+        is_fusion.get(node->op(), false) || !node->attrs.subgraphs.empty() ||
+        finfer_shape.get(node->op(), fdefault) == nullptr) {
+      return false;
+    }
+    for (const auto& e : inode.inputs) {
+      const uint32_t eid = idx.entry_id(e);
+      if (!mxnet::ndim_is_known(rshape[eid]) && is_dynamic[eid])
+        return false;
+    }
+    return true;
+  };
+  // reads the shapes of operator nid and infers them
+  auto read_and_apply = [&](uint32_t nid, AttrVector* ishape, AttrVector* oshape) {
+    const auto& inode = idx[nid];
+    ishape->resize(inode.inputs.size(), empty_val);
+    for (uint32_t i = 0; i < ishape->size(); ++i) {
+      (*ishape)[i] = rshape[idx.entry_id(inode.inputs[i])];
+    }
+    oshape->resize(inode.source->num_outputs(), empty_val);
+    for (uint32_t i = 0; i < oshape->size(); ++i) {
+      (*oshape)[i] = rshape[idx.entry_id(nid, i)];
+    }
+    return apply_infer(nid, ishape, oshape);
+  };
+
   size_t last_num_unknown;
   size_t num_unknown     = static_cast<size_t>(-1);  // Infinity
   bool last_iter         = false;
@@ -767,7 +991,10 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
 
   int i = 0;
   do {
-    if (i % 2 == 0) {
+    if (i % 2 == 0 && parallel) {
+      ParallelForwardSweep(idx, levels, &rshape, &inference_finished, is_plain, read_and_apply,
+                           [&](uint32_t nid) { infer_step(nid, last_iter); });
+    } else if (i % 2 == 0) {
       // forward inference
       for (uint32_t nid = node_start; nid < node_end; ++nid) {
         infer_step(nid, last_iter);
@@ -819,6 +1046,7 @@ nnvm::Graph InferShape(nnvm::Graph&& graph,
                        mxnet::ShapeVector&& shape_inputs,
                        const std::string& shape_attr_key) {
   using dmlc::any;
+  PassTimer timer("InferShape");
   if (shape_inputs.size() != 0) {
     graph.attrs["shape_inputs"] = std::make_shared<any>(std::move(shape_inputs));
   }
@@ -855,6 +1083,7 @@ nnvm::Graph InferType(nnvm::Graph&& graph,
                       nnvm::DTypeVector&& dtype_inputs,
                       const std::string& dtype_attr_key) {
   using dmlc::any;
+  PassTimer timer("InferType");
   if (dtype_inputs.size() != 0) {
     graph.attrs["dtype_inputs"] = std::make_shared<any>(std::move(dtype_inputs));
   }
@@ -881,6 +1110,7 @@ nnvm::Graph InferStorageType(nnvm::Graph&& graph,
                              StorageTypeVector&& storage_type_inputs,
                              const std::string& storage_type_attr_key) {
   using dmlc::any;
+  PassTimer timer("InferStorageType");
   if (storage_type_inputs.size() != 0) {
     graph.attrs["storage_type_inputs"] = std::make_shared<any>(std::move(storage_type_inputs));
   }
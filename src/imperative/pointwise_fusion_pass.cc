@@ -31,6 +31,9 @@
 #include <algorithm>
 #include <queue>
 #include <chrono>
+#include <set>
+#include <tuple>
+#include <utility>
 #include "./simple_partition_pass.h"
 #include "../operator/fusion/fused_op-inl.h"
 #include "../operator/fusion/fused_op.h"
@@ -54,10 +57,10 @@ void WarnFusionNotSupported() {
   }
 }
 
-#if MXNET_USE_CUDA
-
 namespace {
 
+#if MXNET_USE_CUDA
+
 bool IsFusionCompatible(const nnvm::Node* n) {
   using namespace mxnet::fusion;
   if (n->op() == nullptr)
@@ -105,6 +108,121 @@ bool IsInputsOnlyCompatible(const nnvm::Node* n) {
   return false;
 }
 
+bool IsReductionCompatible(const nnvm::Node* n) {
+  using namespace mxnet::fusion;
+  if (n->op() == nullptr || !reduce_ops.count(n->op()->name))
+    return false;
+  // the initial value of the numpy reductions is not supported
+  const auto it = n->attrs.dict.find("initial");
+  return it == n->attrs.dict.end() || it->second == "None";
+}
+
+bool IsReductionInputCompatible(const nnvm::Node* n) {
+  using namespace mxnet::fusion;
+  if (n->op() == nullptr)
+    return false;
+  const std::string& op_name = n->op()->name;
+  if (reshape_ops.count(op_name))
+    return false;
+  if (broadcast_ops.count(op_name))
+    return true;
+  return ops_desc.count(op_name) && ops_desc.at(op_name).size() == 1;
+}
+
+/* \brief Find the reductions that can be fused with the pointwise ops computing
+ *        their input. A producer joins the subset of a reduction if all of its
+ *        outputs are only read inside of the subset and the subset keeps at most
+ *        kMaxReduceInputs inputs.
+ * \return tuple (subset assignment, number of found subsets)
+ */
+std::tuple<std::vector<int>, int> GetReductionSubsets(const Graph& g,
+                                                      const size_t num_forward_outputs) {
+  using NodeEntry        = std::pair<uint32_t, uint32_t>;
+  const auto& idx        = g.indexed_graph();
+  const size_t num_nodes = idx.num_nodes();
+
+  std::vector<std::vector<uint32_t>> consumers(num_nodes);
+  std::vector<bool> is_output(num_nodes, false);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    for (const auto& e : idx[nid].inputs) {
+      consumers[e.node_id].push_back(nid);
+    }
+  }
+  for (const auto& e : idx.outputs()) {
+    is_output[e.node_id] = true;
+  }
+  int last_forward_node = -1;
+  for (size_t i = 0; i < num_forward_outputs; ++i) {
+    last_forward_node = std::max(last_forward_node, static_cast<int>(idx.outputs()[i].node_id));
+  }
+
+  std::vector<int> assignment(num_nodes, -1);
+  int num_subsets = 0;
+  // Producers have smaller ids than their consumers, so visiting the nodes in
+  // reverse order decides about all the consumers of a node before the node itself.
+  for (int rid = static_cast<int>(num_nodes) - 1; rid >= 0; --rid) {
+    const nnvm::Node* reduce_node = idx[rid].source;
+    if (assignment[rid] != -1 || !IsReductionCompatible(reduce_node))
+      continue;
+    const int subset = num_subsets;
+    std::vector<uint32_t> members = {static_cast<uint32_t>(rid)};
+    assignment[rid]               = subset;
+    std::set<NodeEntry> inputs;
+    std::priority_queue<uint32_t> candidates;
+    std::set<uint32_t> visited;
+    for (const auto& e : idx[rid].inputs) {
+      inputs.insert({e.node_id, e.index});
+      candidates.push(e.node_id);
+    }
+    while (!candidates.empty()) {
+      const uint32_t nid = candidates.top();
+      candidates.pop();
+      if (!visited.insert(nid).second)
+        continue;
+      const nnvm::Node* node = idx[nid].source;
+      if (assignment[nid] != -1 || is_output[nid] || !IsReductionInputCompatible(node) ||
+          !detail::IsSamePass(nid, rid, last_forward_node))
+        continue;
+      bool all_consumers_inside = true;
+      for (const uint32_t c : consumers[nid]) {
+        all_consumers_inside = all_consumers_inside && assignment[c] == subset;
+      }
+      if (!all_consumers_inside)
+        continue;
+      std::set<NodeEntry> new_inputs;
+      for (const auto& e : inputs) {
+        if (e.first != nid)
+          new_inputs.insert(e);
+      }
+      for (const auto& e : idx[nid].inputs) {
+        new_inputs.insert({e.node_id, e.index});
+      }
+      if (new_inputs.empty() || new_inputs.size() > fusion::kMaxReduceInputs)
+        continue;
+      inputs.swap(new_inputs);
+      assignment[nid] = subset;
+      members.push_back(nid);
+      for (const auto& e : idx[nid].inputs) {
+        candidates.push(e.node_id);
+      }
+    }
+    // a reduction alone does not need the fused kernel
+    if (members.size() == 1) {
+      assignment[rid] = -1;
+    } else {
+      ++num_subsets;
+    }
+  }
+  return {assignment, num_subsets};
+}
+
+#endif  // MXNET_USE_CUDA
+
+// The CPU FusedOp does not load slices of its inputs
+bool IsInputsOnlyCompatibleCPU(const nnvm::Node* n) {
+  return false;
+}
+
 void CreateSubgraphNode(const nnvm::Graph& subgraph,
                         size_t inputs_size,
                         nnvm::Node* subgraph_node) {
@@ -331,13 +449,23 @@ Graph CopyAndReplaceSubgraphs(const Graph& g,
   return ret;
 }
 
+#if MXNET_USE_CUDA
 Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
-  auto start                            = std::chrono::steady_clock::now();
-  auto [subset_assignment, num_subsets] = GetCompatibleSubsets(g,                    // NOLINT(*)
+  auto start = std::chrono::steady_clock::now();
+  Graph reduced;
+  if (dmlc::GetEnv("MXNET_USE_FUSION_REDUCE", true)) {
+    // Reductions are fused first, the pointwise ops they do not absorb are fused after
+    auto [reduce_assignment, num_reduce_subsets] =  // NOLINT(*)
+        GetReductionSubsets(g, num_forward_outputs);
+    reduced = CopyAndReplaceSubgraphs(g, reduce_assignment, num_reduce_subsets, CreateSubgraphNode);
+  } else {
+    reduced = g;
+  }
+  auto [subset_assignment, num_subsets] = GetCompatibleSubsets(reduced,              // NOLINT(*)
                                                                num_forward_outputs,  // NOLINT(*)
                                                                IsFusionCompatible,
                                                                IsInputsOnlyCompatible);
-  Graph ret = CopyAndReplaceSubgraphs(g, subset_assignment, num_subsets, CreateSubgraphNode);
+  Graph ret = CopyAndReplaceSubgraphs(reduced, subset_assignment, num_subsets, CreateSubgraphNode);
   auto end  = std::chrono::steady_clock::now();
   if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
     auto diff = end - start;
@@ -348,5 +476,21 @@ Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
 }
 #endif  // MXNET_USE_CUDA
 
+Graph FusePointwiseCPU(const Graph& g, const size_t num_forward_outputs) {
+  auto start = std::chrono::steady_clock::now();
+  auto [subset_assignment, num_subsets] = GetCompatibleSubsets(g,                    // NOLINT(*)
+                                                               num_forward_outputs,  // NOLINT(*)
+                                                               IsCPUFusionCompatible,
+                                                               IsInputsOnlyCompatibleCPU);
+  Graph ret = CopyAndReplaceSubgraphs(g, subset_assignment, num_subsets, CreateSubgraphNode);
+  auto end  = std::chrono::steady_clock::now();
+  if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
+    auto diff = end - start;
+    LOG(INFO) << "CPU pointwise fusion graph pass took: "
+              << std::chrono::duration<double, std::milli>(diff).count() << "ms.";
+  }
+  return ret;
+}
+
 }  // namespace exec
 }  // namespace mxnet
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file prune_for_inference_pass.cc
+ * \brief Remove the operators of a graph computing nothing at inference
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "./exec_pass.h"
+#include "../operator/nn/dropout-inl.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+
+/*! \brief whether node nid copies its input at inference, as nothing reads a dropout mask */
+bool IsInferenceIdentity(const IndexedGraph& idx, uint32_t nid, const std::vector<bool>& read) {
+  static const Op* dropout_op    = Op::Get("Dropout");
+  static const Op* block_grad_op = Op::Get("BlockGrad");
+  static const Op* copy_op       = Op::Get("_copy");
+  const Node* n                  = idx[nid].source;
+  if (n->is_variable() || !n->control_deps.empty() || n->inputs.size() != 1)
+    return false;
+  if (n->op() == block_grad_op || n->op() == copy_op)
+    return true;
+  return n->op() == dropout_op &&
+         nnvm::get<op::DropoutParam>(n->attrs.parsed).mode == op::dropout::kTraining &&
+         !read[idx.entry_id(nid, 1)];
+}
+
+}  // namespace
+
+Graph PruneForInference(Graph&& g) {
+  const IndexedGraph& idx = g.indexed_graph();
+
+  // whether the outputs of the nodes are read, or a control dependency
+  std::vector<bool> read(idx.num_node_entries(), false);
+  std::vector<bool> depended(idx.num_nodes(), false);
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    for (const auto& e : idx[nid].inputs)
+      read[idx.entry_id(e)] = true;
+    for (const uint32_t dep : idx[nid].control_deps)
+      depended[dep] = true;
+  }
+  for (const auto& e : idx.outputs())
+    read[idx.entry_id(e)] = true;
+
+  // the entry each removed node reads, through the chains of removed nodes
+  std::vector<bool> removed(idx.num_nodes(), false);
+  std::vector<NodeEntry> source(idx.num_nodes());
+  bool pruned = false;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (depended[nid] || !IsInferenceIdentity(idx, nid, read))
+      continue;
+    const uint32_t src = idx[nid].inputs[0].node_id;
+    removed[nid]       = true;
+    source[nid]        = removed[src] ? source[src] : idx[nid].source->inputs[0];
+    pruned             = true;
+  }
+  if (!pruned)
+    return std::move(g);
+
+  auto resolve = [&](const NodeEntry& e) {
+    const uint32_t nid = idx.node_id(e.node.get());
+    return removed[nid] ? source[nid] : e;
+  };
+  // the removed nodes kept as outputs read the entries their removed inputs read
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    Node* n = const_cast<Node*>(idx[nid].source);
+    for (auto& e : n->inputs)
+      e = resolve(e);
+  }
+  // An output of the graph stays a copy when it would read a variable or another output, the
+  // outputs of a graph being distinct operator outputs.
+  std::set<std::pair<const Node*, uint32_t>> outputs;
+  for (const auto& e : g.outputs)
+    outputs.emplace(e.node.get(), e.index);
+  for (auto& e : g.outputs) {
+    const NodeEntry src = resolve(e);
+    if (src.node == e.node || src.node->is_variable() ||
+        !outputs.emplace(src.node.get(), src.index).second)
+      continue;
+    e = src;
+  }
+
+  // The indexed graph of g no longer matches its nodes.
+  Graph ret;
+  ret.outputs = g.outputs;
+  return ret;
+}
+
+NNVM_REGISTER_PASS(PruneForInference)
+    .describe("Remove the operators of a graph computing nothing at inference.")
+    .set_body(PruneForInference)
+    .set_change_graph(true);
+
+}  // namespace exec
+}  // namespace mxnet
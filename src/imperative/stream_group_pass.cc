@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file stream_group_pass.cc
+ * \brief Split the operators of a graph into the chains of its independent branches, whose
+ *  bulked segments the GPU workers of the engine then run concurrently on their streams
+ */
+
+#include <mxnet/base.h>
+
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+std::vector<int> AssignStreamGroups(const nnvm::IndexedGraph& idx,
+                                    const size_t start_nid,
+                                    const size_t end_nid) {
+  // the operators computed before start_nid are inputs, as the variables are
+  auto is_op = [&](uint32_t nid) {
+    return nid >= start_nid && nid < end_nid && !idx[nid].source->is_variable();
+  };
+  std::vector<uint32_t> consumers(idx.num_nodes(), 0);
+  for (size_t nid = start_nid; nid < end_nid; ++nid) {
+    if (!is_op(nid))
+      continue;
+    for (const auto& e : idx[nid].inputs) {
+      if (is_op(e.node_id))
+        ++consumers[e.node_id];
+    }
+  }
+
+  // An operator continues the group of its last computed input when it is the only consumer
+  // of that input, so a chain stays in one group and, in the depth first order of the indexed
+  // graph, in one segment. The branches leaving a fork each start a group, and a join continues
+  // the group of the branch computed just before it.
+  std::vector<int> group(idx.num_nodes(), -1);
+  int num_groups = 0;
+  for (size_t nid = start_nid; nid < end_nid; ++nid) {
+    if (!is_op(nid))
+      continue;
+    int producer = -1;
+    for (const auto& e : idx[nid].inputs) {
+      if (is_op(e.node_id) && static_cast<int>(e.node_id) > producer)
+        producer = e.node_id;
+    }
+    group[nid] = producer >= 0 && consumers[producer] == 1 ? group[producer] : num_groups++;
+  }
+  return group;
+}
+
+}  // namespace exec
+}  // namespace mxnet
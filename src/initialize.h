@@ -74,6 +74,11 @@ class LibraryInitializer {
   size_t cpu_worker_nthreads_;
   size_t omp_num_threads_;
   size_t mp_cv_num_threads_;
+  /**
+   * Whether the engine of a forked process runs its CPU operators on the pushing thread,
+   * without starting worker threads, MXNET_MP_WORKER_INLINE_ENGINE
+   */
+  bool mp_worker_inline_engine_;
 
   // Actual code for the atfork handlers as member functions.
   void atfork_prepare();
@@ -94,6 +94,20 @@ class GroupBatchify : public BatchifyFunction {
     return true;
   }
 
+  bool BatchifySample(const std::vector<NDArray>& sample,
+                      size_t index,
+                      std::vector<NDArray>* outputs) override {
+    CHECK_EQ(sample.size(), fs_.size()) << "In GroupBatchifyFunction, Elem size " << sample.size()
+                                        << " and batchify function size " << fs_.size()
+                                        << " must match";
+    for (size_t i = 0; i < sample.size(); ++i) {
+      std::vector<NDArray> out({(*outputs)[i]});
+      if (!fs_[i]->BatchifySample({sample[i]}, index, &out))
+        return false;
+    }
+    return true;
+  }
+
  private:
   /*! \brief params */
   GroupBatchifyParam param_;
@@ -178,6 +192,29 @@ class StackBatchify : public BatchifyFunction {
     return true;
   }
 
+  bool BatchifySample(const std::vector<NDArray>& sample,
+                      size_t index,
+                      std::vector<NDArray>* outputs) override {
+    CHECK_EQ(sample.size(), outputs->size());
+    for (size_t i = 0; i < sample.size(); ++i) {
+      const NDArray& out = (*outputs)[i];
+      mxnet::TShape ashape(out.shape().begin() + 1, out.shape().end());
+      CHECK_EQ(ashape, sample[i].shape())
+          << "StackBatchify requires all data along batch dim to be the same, "
+          << "mismatch " << ashape << " vs. " << sample[i].shape();
+      CHECK_EQ(out.dtype(), sample[i].dtype());
+      CHECK_LT(index, out.shape()[0]);
+      MSHADOW_TYPE_SWITCH_WITH_BOOL(out.dtype(), DType, {
+        DType* ptr = out.data().dptr<DType>() + ashape.Size() * index;
+        RunContext rctx{out.ctx(), nullptr, nullptr, false};
+        auto dst = TBlob(ptr, sample[i].data().shape_, cpu::kDevMask, out.dtype(), 0);
+        mxnet::ndarray::Copy<cpu, cpu>(
+            sample[i].data(), &dst, Context::CPU(), Context::CPU(), rctx);
+      })
+    }
+    return true;
+  }
+
  private:
   /*! \brief parameters */
   StackBatchifyParam param_;
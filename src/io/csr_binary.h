@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file csr_binary.h
+ * \brief binary format of sparse training data, read by CSRBinIter without parsing
+ *
+ *  File Format: file header, then blocks of rows starting at multiples of 64 bytes
+ *  Block Format: block header, then the columns of its rows, each at a multiple of 8 bytes:
+ *    label[num_rows] float32, indptr[num_rows + 1] int64 starting at 0,
+ *    indices[nnz] int64, values[nnz] float32
+ * \sa tools/libsvm2bin.cc
+ */
+#ifndef MXNET_IO_CSR_BINARY_H_
+#define MXNET_IO_CSR_BINARY_H_
+
+#include <cstdint>
+
+namespace mxnet {
+namespace io {
+
+/*! \brief header at the beginning of the file */
+struct CSRBinFileHeader {
+  static constexpr uint64_t kMagic   = 0x314e494252534358ULL;  // "XCSRBIN1"
+  static constexpr uint64_t kVersion = 1;
+  uint64_t magic{kMagic};
+  uint64_t version{kVersion};
+};
+
+/*! \brief header of a block of rows */
+struct CSRBinBlockHeader {
+  uint64_t num_rows;
+  uint64_t nnz;
+};
+
+/*! \brief offsets of the columns of a block from the beginning of the block */
+struct CSRBinBlockLayout {
+  static constexpr uint64_t kBlockAlign = 64;
+  uint64_t label, indptr, indices, values, size;
+
+  explicit CSRBinBlockLayout(const CSRBinBlockHeader& header) {
+    label   = Align(sizeof(CSRBinBlockHeader), 8);
+    indptr  = Align(label + header.num_rows * sizeof(float), 8);
+    indices = Align(indptr + (header.num_rows + 1) * sizeof(int64_t), 8);
+    values  = Align(indices + header.nnz * sizeof(int64_t), 8);
+    size    = Align(values + header.nnz * sizeof(float), kBlockAlign);
+  }
+
+  static uint64_t Align(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+};
+
+/*! \brief offset of the first block */
+constexpr uint64_t kCSRBinFirstBlock = 64;
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_CSR_BINARY_H_
@@ -25,9 +25,19 @@
 #include <dmlc/omp.h>
 #include <mxnet/io.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "./inst_vector.h"
 #include "./iter_prefetcher.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../profiler/io_profiler.h"
 
 namespace mxnet {
 namespace io {
@@ -42,6 +52,10 @@ struct ThreadedDataLoaderParam : public dmlc::Parameter<ThreadedDataLoaderParam>
   std::intptr_t batchify_fn;
   /*! \brief pin memory to device id.*/
   int pin_device_id;
+  /*! \brief number of batches loaded concurrently.*/
+  int num_inflight;
+  /*! \brief whether batches can be returned out of order.*/
+  bool out_of_order;
   // declare parameters
   DMLC_DECLARE_PARAMETER(ThreadedDataLoaderParam) {
     DMLC_DECLARE_FIELD(num_workers).set_default(0).describe("Number of thread workers.");
@@ -51,6 +65,15 @@ struct ThreadedDataLoaderParam : public dmlc::Parameter<ThreadedDataLoaderParam>
     DMLC_DECLARE_FIELD(pin_device_id)
         .set_default(-1)
         .describe("If not negative, will move data to pinned memory.");
+    DMLC_DECLARE_FIELD(num_inflight)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("If positive, the workers persist and load the samples of up to "
+                  "num_inflight batches concurrently, instead of one batch at a time.");
+    DMLC_DECLARE_FIELD(out_of_order)
+        .set_default(false)
+        .describe("Whether batches are returned as soon as they are loaded, in any order. "
+                  "Only used when num_inflight is positive.");
   }
 };  // struct ThreadedDataLoaderParam
 
@@ -61,7 +84,16 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
  public:
   ThreadedDataLoader() = default;
   // destructor
-  ~ThreadedDataLoader() override = default;
+  ~ThreadedDataLoader() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    task_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
   // constructor
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
@@ -79,10 +111,22 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     dataset_len_ = dataset_->GetLen();
     sampler_     = static_cast<IIterator<DataBatch>*>(reinterpret_cast<void*>(param_.sampler));
     batchify_fn_ = *static_cast<BatchifyFunctionPtr*>(reinterpret_cast<void*>(param_.batchify_fn));
+    if (param_.num_inflight > 0) {
+      for (int i = 0; i < param_.num_workers; ++i) {
+        workers_.emplace_back([this]() { this->WorkerLoop(); });
+      }
+    }
     this->BeforeFirst();
   }
   // before first
   void BeforeFirst() override {
+    if (param_.num_inflight > 0) {
+      // drop the batches in flight, once the samples being loaded are done
+      std::unique_lock<std::mutex> lock(mutex_);
+      tasks_.clear();
+      done_cv_.wait(lock, [this]() { return running_ == 0; });
+      inflight_.clear();
+    }
     sampler_->BeforeFirst();
   }
 
@@ -91,6 +135,9 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   }
 
   bool Next() override {
+    if (param_.num_inflight > 0) {
+      return NextPipelined();
+    }
     bool has_next = sampler_->Next();
     if (!has_next)
       return false;
@@ -120,34 +167,238 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     }
     omp_exc_.Rethrow();
 
+    Batchify(&inputs, real_batch_size, samples.num_batch_padd, profiling);
+    return true;
+  }
+
+  const TBlobBatch& Value() const override {
+    return out_;
+  }
+
+ private:
+  /*! \brief a batch whose samples are loaded by the workers */
+  struct PendingBatch {
+    std::vector<int64_t> indices;
+    std::vector<std::vector<NDArray> > inputs;
+    int num_batch_padd;
+    /*! \brief the samples stacked by the workers, when the batchify function stacks them */
+    std::vector<NDArray> outputs;
+    /*! \brief number of samples left to load, guarded by mutex_ */
+    size_t remaining;
+    /*! \brief number of samples written into outputs, guarded by mutex_ */
+    size_t num_stacked{0};
+    /*! \brief the first error raised loading a sample */
+    std::exception_ptr error;
+  };
+
+  /*! \brief pad the inputs to the batch size and batchify them into out_ */
+  void Batchify(std::vector<std::vector<NDArray> >* inputs,
+                size_t real_batch_size,
+                int num_batch_padd,
+                bool profiling) {
     // pad to normal batch size
-    for (size_t i = real_batch_size; i < batch_size; ++i) {
-      inputs[i] = inputs[0];
+    for (size_t i = real_batch_size; i < inputs->size(); ++i) {
+      (*inputs)[i] = (*inputs)[0];
     }
 
     // batchify
     if (profiling) {
       profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderBatchify");
     }
-    CHECK(batchify_fn_->Batchify(inputs, &batched_buffer_))
-        << "Error call batchify inside dataloader";
+    {
+      profiler::IOStageTimer timer(profiler::IOProfiler::kBatchify);
+      CHECK(batchify_fn_->Batchify(*inputs, &batched_buffer_))
+          << "Error call batchify inside dataloader";
+    }
     if (profiling) {
       profiler::CustomOpProfiler::Get()->OnCustomEnd();
     }
-    out_.batch_size = batched_buffer_.size();
-    out_.data.resize(batched_buffer_.size());
-    for (size_t i = 0; i < batched_buffer_.size(); ++i) {
-      out_.data[i] = batched_buffer_[i].data();
+    SetOutput(batched_buffer_, num_batch_padd);
+  }
+
+  void SetOutput(const std::vector<NDArray>& batched, int num_batch_padd) {
+    out_.batch_size = batched.size();
+    out_.data.resize(batched.size());
+    for (size_t i = 0; i < batched.size(); ++i) {
+      out_.data[i] = batched[i].data();
+    }
+    out_.num_batch_padd = num_batch_padd;
+  }
+
+  /*!
+   * \brief the outputs of a batch stacking the elements of sample, recycled from the outputs
+   *  of the previous batches when their shapes match, called with mutex_ held
+   */
+  std::vector<NDArray> AllocOutputs(const std::vector<NDArray>& sample, size_t batch_size) {
+    std::vector<mxnet::TShape> shapes;
+    for (const auto& elem : sample) {
+      TShape sshape(elem.shape().ndim() + 1, 0);
+      sshape[0] = batch_size;
+      for (int k = 0; k < elem.shape().ndim(); ++k) {
+        sshape[k + 1] = elem.shape()[k];
+      }
+      shapes.push_back(sshape);
+    }
+    while (!free_outputs_.empty()) {
+      std::vector<NDArray> outputs = std::move(free_outputs_.front());
+      free_outputs_.pop_front();
+      bool match = outputs.size() == sample.size();
+      for (size_t i = 0; match && i < sample.size(); ++i) {
+        match = outputs[i].shape() == shapes[i] && outputs[i].dtype() == sample[i].dtype();
+      }
+      if (match)
+        return outputs;
+    }
+    std::vector<NDArray> outputs;
+    for (size_t i = 0; i < sample.size(); ++i) {
+      outputs.emplace_back(shapes[i], Context::CPU(), false, sample[i].dtype());
+    }
+    return outputs;
+  }
+
+  /*!
+   * \brief write a loaded sample into its slot of the outputs of its batch, and into the
+   *  padded slots for the first sample
+   * \return false if the batchify function does not stack the samples
+   */
+  bool StackSample(PendingBatch* batch, size_t slot) {
+    const auto& sample = batch->inputs[slot];
+    for (const auto& elem : sample) {
+      if (elem.storage_type() != kDefaultStorage || elem.ctx().dev_mask() != cpu::kDevMask)
+        return false;
+    }
+    std::vector<NDArray> outputs;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (batch->outputs.empty()) {
+        batch->outputs = AllocOutputs(sample, batch->inputs.size());
+      }
+      outputs = batch->outputs;
+    }
+    profiler::IOStageTimer timer(profiler::IOProfiler::kBatchify);
+    if (!batchify_fn_->BatchifySample(sample, slot, &outputs))
+      return false;
+    if (slot == 0) {
+      for (size_t i = batch->indices.size(); i < batch->inputs.size(); ++i) {
+        batchify_fn_->BatchifySample(sample, i, &outputs);
+      }
     }
-    out_.num_batch_padd = samples.num_batch_padd;
     return true;
   }
 
-  const TBlobBatch& Value() const override {
-    return out_;
+  /*!
+   * \brief queue the samples of the next batches of the sampler, up to num_inflight batches,
+   *  the idle workers load the samples of the next batches while a slow sample finishes
+   */
+  void FillPipeline() {
+    while (static_cast<int>(inflight_.size()) < param_.num_inflight && sampler_->Next()) {
+      auto samples           = sampler_->Value();
+      auto batch_size        = samples.data[0].shape().Size();
+      int real_batch_size    = batch_size - samples.num_batch_padd;
+      const int64_t* idx_ptr = static_cast<int64_t*>(samples.data[0].data().dptr_);
+      auto batch             = std::make_shared<PendingBatch>();
+      batch->indices.assign(idx_ptr, idx_ptr + real_batch_size);
+      batch->inputs.resize(batch_size);
+      batch->num_batch_padd = samples.num_batch_padd;
+      batch->remaining      = real_batch_size;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflight_.push_back(batch);
+        for (int i = 0; i < real_batch_size; ++i) {
+          tasks_.emplace_back(batch, i);
+        }
+      }
+      task_cv_.notify_all();
+      for (const auto idx : batch->indices) {
+        dataset_->Prefetch(idx);
+      }
+    }
+  }
+
+  bool NextPipelined() {
+    if (!stacked_outputs_.empty()) {
+      // the previous batch has been copied out of its outputs
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_outputs_.push_back(std::move(stacked_outputs_));
+      stacked_outputs_.clear();
+    }
+    FillPipeline();
+    std::shared_ptr<PendingBatch> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (inflight_.empty())
+        return false;
+      auto done = inflight_.end();
+      done_cv_.wait(lock, [this, &done]() {
+        done = param_.out_of_order
+                   ? std::find_if(inflight_.begin(),
+                                  inflight_.end(),
+                                  [](const std::shared_ptr<PendingBatch>& b) {
+                                    return b->remaining == 0;
+                                  })
+                   : (inflight_.front()->remaining == 0 ? inflight_.begin() : inflight_.end());
+        return done != inflight_.end();
+      });
+      batch = *done;
+      inflight_.erase(done);
+      profiler::IOProfiler::Get()->SetQueueDepth(profiler::IOProfiler::kLoaderQueue,
+                                                 inflight_.size());
+    }
+    if (batch->error) {
+      std::rethrow_exception(batch->error);
+    }
+    // keep the workers busy while batchifying
+    FillPipeline();
+    if (batch->num_stacked == batch->indices.size()) {
+      stacked_outputs_ = std::move(batch->outputs);
+      SetOutput(stacked_outputs_, batch->num_batch_padd);
+      return true;
+    }
+    CHECK_EQ(batch->num_stacked, 0) << "Only part of the samples of the batch could be stacked";
+    bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
+    Batchify(&batch->inputs, batch->indices.size(), batch->num_batch_padd, profiling);
+    return true;
+  }
+
+  void WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      task_cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      if (stop_)
+        return;
+      auto task = tasks_.front();
+      tasks_.pop_front();
+      ++running_;
+      lock.unlock();
+      PendingBatch* batch = task.first.get();
+      const auto idx      = batch->indices[task.second];
+      std::exception_ptr error;
+      bool stacked = false;
+      try {
+        CHECK(dataset_->GetItem(idx, &batch->inputs[task.second]))
+            << "Error getting data # " << idx;
+        if (stack_samples_) {
+          stacked        = StackSample(batch, task.second);
+          stack_samples_ = stacked;
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+      if (stacked && task.second != 0) {
+        // the first sample is kept for the padded slots
+        batch->inputs[task.second].clear();
+      }
+      lock.lock();
+      if (error && !batch->error) {
+        batch->error = error;
+      }
+      batch->num_stacked += stacked;
+      --batch->remaining;
+      --running_;
+      done_cv_.notify_all();
+    }
   }
 
- private:
   /*! \brief Params */
   ThreadedDataLoaderParam param_;
   /*! \brief output */
@@ -164,6 +415,24 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   BatchifyFunctionPtr batchify_fn_;
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
+  /*! \brief persistent workers, when num_inflight is positive */
+  std::vector<std::thread> workers_;
+  /*! \brief batches in flight, in the order of the sampler */
+  std::deque<std::shared_ptr<PendingBatch> > inflight_;
+  /*! \brief samples to load, as their batch and position in the batch */
+  std::deque<std::pair<std::shared_ptr<PendingBatch>, size_t> > tasks_;
+  /*! \brief whether the batchify function stacks the samples in the workers */
+  std::atomic<bool> stack_samples_{true};
+  /*! \brief outputs of the last batch stacked by the workers */
+  std::vector<NDArray> stacked_outputs_;
+  /*! \brief outputs of the previous batches, recycled for the next batches */
+  std::deque<std::vector<NDArray> > free_outputs_;
+  /*! \brief number of samples being loaded */
+  size_t running_{0};
+  bool stop_{false};
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
 };  // class ThreadedDataLoader
 
 MXNET_REGISTER_IO_ITER(ThreadedDataLoader)
@@ -32,11 +32,22 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <thread>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 #include "../imperative/cached_op.h"
 #include "../imperative/naive_cached_op.h"
 #include "../ndarray/ndarray_function.h"
+#include "../profiler/io_profiler.h"
 
 #if MXNET_USE_OPENCV
 #include <opencv2/opencv.hpp>
@@ -49,10 +60,14 @@ namespace io {
 struct RecordFileDatasetParam : public dmlc::Parameter<RecordFileDatasetParam> {
   std::string rec_file;
   std::string idx_file;
+  bool use_mmap;
   // declare parameters
   DMLC_DECLARE_PARAMETER(RecordFileDatasetParam) {
     DMLC_DECLARE_FIELD(rec_file).describe("The absolute path of record file.");
     DMLC_DECLARE_FIELD(idx_file).describe("The path of the idx file.");
+    DMLC_DECLARE_FIELD(use_mmap).set_default(false).describe(
+        "Whether to map the local record file in memory and return the records as views of "
+        "the mapping instead of reading them with a stream.");
   }
 };  // struct RecordFileDatasetParam
 
@@ -71,15 +86,42 @@ class RecordFileDataset final : public Dataset {
       idx_[key] = idx;
     }
     delete idx_stream;
+    if (param_.use_mmap) {
+      MapFile();
+    }
   }
 
   uint64_t GetLen() const override {
     return idx_.size();
   }
 
+  void Prefetch(uint64_t idx) override {
+#ifndef _WIN32
+    if (!file_)
+      return;
+    auto it = idx_.find(static_cast<size_t>(idx));
+    if (it == idx_.end())
+      return;
+    // the record ends where the next one in the file starts
+    const size_t begin = it->second;
+    auto next          = std::upper_bound(offsets_.begin(), offsets_.end(), begin);
+    const size_t end   = next == offsets_.end() ? file_->size : *next;
+    const size_t page  = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = begin / page * page;
+    madvise(file_->data + start, end - start, MADV_WILLNEED);
+#endif  // _WIN32
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
+    profiler::IOStageTimer timer(profiler::IOProfiler::kRead);
     ret->resize(1);
     auto& out = (*ret)[0];
+    if (file_) {
+      if (!GetMappedItem(idx_[static_cast<size_t>(idx)], &out))
+        return false;
+      profiler::IOProfiler::Get()->AddBytesRead(out.shape().Size());
+      return true;
+    }
     static thread_local std::unique_ptr<dmlc::Stream> stream;
     static thread_local std::unique_ptr<dmlc::RecordIOReader> reader;
     if (!reader) {
@@ -93,6 +135,7 @@ class RecordFileDataset final : public Dataset {
     if (reader->NextRecord(&read_buff)) {
       const char* buf   = read_buff.c_str();
       const size_t size = read_buff.size();
+      profiler::IOProfiler::Get()->AddBytesRead(size);
       out = NDArray(TShape({static_cast<dim_t>(size)}), Context::CPU(), false, mshadow::kInt8);
       TBlob dst = out.data();
       RunContext rctx{Context::CPU(), nullptr, nullptr, false};
@@ -110,10 +153,93 @@ class RecordFileDataset final : public Dataset {
   }
 
  private:
+  /*! \brief the record file mapped in memory, unmapped when its last view is released */
+  struct MappedFile {
+    char* data{nullptr};
+    size_t size{0};
+    ~MappedFile() {
+#ifndef _WIN32
+      if (data != nullptr)
+        munmap(data, size);
+#endif  // _WIN32
+    }
+  };
+
+  void MapFile() {
+#ifndef _WIN32
+    const int fd = open(param_.rec_file.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Failed to open " << param_.rec_file << " for mapping: " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << param_.rec_file;
+    auto file  = std::make_shared<MappedFile>();
+    file->size = st.st_size;
+    if (file->size > 0) {
+      // private mapping, the views are writable without modifying the file
+      void* ptr = mmap(nullptr, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << param_.rec_file << ": " << strerror(errno);
+      file->data = static_cast<char*>(ptr);
+      // the kernel reads ahead sequentially by default, Prefetch reads ahead the sampled records
+      madvise(file->data, file->size, MADV_RANDOM);
+    }
+    close(fd);
+    file_ = file;
+    offsets_.reserve(idx_.size());
+    for (const auto& kv : idx_) {
+      offsets_.push_back(kv.second);
+    }
+    std::sort(offsets_.begin(), offsets_.end());
+#else
+    LOG(FATAL) << "RecordFileDataset does not support use_mmap on Windows";
+#endif  // _WIN32
+  }
+
+  /*!
+   * \brief read the record at pos of the mapped file, as a view of the mapping unless the record
+   *  is split in several parts by the writer
+   */
+  bool GetMappedItem(size_t pos, NDArray* out) {
+    const size_t header_size = 2 * sizeof(uint32_t);
+    std::string parts;
+    while (true) {
+      CHECK_LE(pos + header_size, file_->size) << "Invalid record offset " << pos;
+      uint32_t header[2];
+      std::memcpy(header, file_->data + pos, header_size);
+      CHECK_EQ(header[0], dmlc::RecordIOWriter::kMagic) << "Invalid RecordIO file";
+      const uint32_t cflag = dmlc::RecordIOWriter::DecodeFlag(header[1]);
+      const uint32_t len   = dmlc::RecordIOWriter::DecodeLength(header[1]);
+      char* data           = file_->data + pos + header_size;
+      CHECK_LE(pos + header_size + len, file_->size) << "Invalid record length " << len;
+      if (cflag == 0) {
+        // the view keeps the mapping alive
+        auto file = file_;
+        TBlob view(data, TShape({static_cast<dim_t>(len)}), cpu::kDevMask, mshadow::kInt8);
+        *out = NDArray(view, 0, [file]() {});
+        return true;
+      }
+      // the writer splits the records containing the magic number at the magic number
+      if (cflag != 1) {
+        const uint32_t magic = dmlc::RecordIOWriter::kMagic;
+        parts.append(reinterpret_cast<const char*>(&magic), sizeof(magic));
+      }
+      parts.append(data, len);
+      if (cflag == 3)
+        break;
+      pos += header_size + ((len + 3U) & ~3U);
+    }
+    *out = NDArray(
+        TShape({static_cast<dim_t>(parts.size())}), Context::CPU(), false, mshadow::kInt8);
+    std::memcpy(out->data().dptr_, parts.data(), parts.size());
+    return true;
+  }
+
   /*! \brief parameters */
   RecordFileDatasetParam param_;
   /*! \brief indices */
   std::unordered_map<size_t, size_t> idx_;
+  /*! \brief the mapped record file, when use_mmap is set */
+  std::shared_ptr<MappedFile> file_;
+  /*! \brief sorted offsets of the records in the file */
+  std::vector<size_t> offsets_;
 };
 
 MXNET_REGISTER_IO_DATASET(RecordFileDataset)
@@ -127,12 +253,15 @@ struct ImageRecordFileDatasetParam : public dmlc::Parameter<ImageRecordFileDatas
   std::string rec_file;
   std::string idx_file;
   int flag;
+  bool use_mmap;
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecordFileDatasetParam) {
     DMLC_DECLARE_FIELD(rec_file).describe("The absolute path of record file.");
     DMLC_DECLARE_FIELD(idx_file).describe("The path of the idx file.");
     DMLC_DECLARE_FIELD(flag).set_default(1).describe(
         "If 1, always convert to colored, if 0 always convert to grayscale.");
+    DMLC_DECLARE_FIELD(use_mmap).set_default(false).describe(
+        "Whether to map the local record file in memory instead of reading it with a stream.");
   }
 };  // struct ImageRecordFileDatasetParam
 
@@ -198,6 +327,10 @@ class ImageRecordFileDataset : public Dataset {
     return base_->GetLen();
   }
 
+  void Prefetch(uint64_t idx) override {
+    base_->Prefetch(idx);
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     CHECK_LT(idx, GetLen());
     std::vector<NDArray> raw;
@@ -234,6 +367,7 @@ class ImageRecordFileDataset : public Dataset {
     ret->resize(2);
     (*ret)[1] = label;
 #if MXNET_USE_OPENCV
+    profiler::IOStageTimer timer(profiler::IOProfiler::kDecode);
     cv::Mat buf(1, size, CV_8U, s);
     cv::Mat res = cv::imdecode(buf, param_.flag);
     CHECK(!res.empty()) << "Decoding failed. Invalid image file.";
@@ -304,6 +438,7 @@ class ImageSequenceDataset final : public Dataset {
 #if MXNET_USE_OPENCV
     CHECK_LT(idx, img_list_.size())
         << "GetItem index: " << idx << " out of bound: " << img_list_.size();
+    profiler::IOStageTimer timer(profiler::IOProfiler::kDecode);
     cv::Mat res = cv::imread(img_list_[idx], param_.flag);
     CHECK(!res.empty()) << "Decoding failed. Invalid image file.";
     const int n_channels = res.channels();
@@ -362,6 +497,12 @@ class NDArrayDataset final : public Dataset {
     return size_;
   }
 
+  void Prefetch(uint64_t idx) override {
+    for (const auto& child : childs_) {
+      child->Prefetch(idx);
+    }
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* rets) override {
     CHECK_LT(idx, size_) << "GetItem index: " << idx << " out of bound: " << size_;
     rets->resize(1);
@@ -489,6 +630,11 @@ class IndexedDataset final : public Dataset {
     return param_.indices.ndim();
   }
 
+  void Prefetch(uint64_t idx) override {
+    if (idx < static_cast<uint64_t>(param_.indices.ndim()))
+      base_data_->Prefetch(param_.indices[idx]);
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     CHECK_GT(param_.indices.ndim(), idx)
         << "IndexError: " << idx << " from total: " << param_.indices.ndim();
@@ -513,6 +659,243 @@ MXNET_REGISTER_IO_DATASET(IndexedDataset)
       return new IndexedDataset(kwargs);
     });
 
+struct CachedDatasetParam : public dmlc::Parameter<CachedDatasetParam> {
+  /*! \brief the base dataset */
+  std::intptr_t base;
+  /*! \brief size of the cache in MB */
+  size_t cache_size;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(CachedDatasetParam) {
+    DMLC_DECLARE_FIELD(base).describe(
+        "Pointer to the internal c++ dataset whose items are cached.");
+    DMLC_DECLARE_FIELD(cache_size)
+        .set_default(1024)
+        .describe("Size of the cache in MB. The oldest items are evicted when it is full.");
+  }
+};  // struct CachedDatasetParam
+
+DMLC_REGISTER_PARAMETER(CachedDatasetParam);
+
+/*!
+ * \brief Dataset caching the items of another dataset in shared memory, e.g. the decoded
+ *  images of an ImageRecordFileDataset.
+ *
+ * The cache is an anonymous shared mapping, so that the processes forked after its creation,
+ * e.g. the workers of a DataLoader, read and fill the same cache. The items are copied into a
+ * ring buffer, evicting the items cached first when it is full, and guarded by a process
+ * shared read-write lock: the hits only take the lock shared.
+ */
+class CachedDataset final : public Dataset {
+ public:
+  explicit CachedDataset(const std::vector<std::pair<std::string, std::string>>& kwargs) {
+#ifndef _WIN32
+    param_.InitAllowUnknown(kwargs);
+    base_data_ = *static_cast<std::shared_ptr<Dataset>*>(reinterpret_cast<void*>(param_.base));
+    const size_t table_size = Align(sizeof(CacheHeader) + GetLen() * sizeof(int64_t));
+    const size_t capacity   = param_.cache_size << 20;
+    map_size_               = table_size + capacity;
+    void* ptr = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map the shared memory of the dataset cache: "
+                              << strerror(errno);
+    header_ = new (ptr) CacheHeader();
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    CHECK_EQ(pthread_rwlockattr_setpshared(&attr, PTHREAD_PROCESS_SHARED), 0)
+        << "Process shared locks are not supported";
+    CHECK_EQ(pthread_rwlock_init(&header_->lock, &attr), 0);
+    pthread_rwlockattr_destroy(&attr);
+    header_->capacity = capacity;
+    offsets_          = reinterpret_cast<int64_t*>(header_ + 1);
+    std::fill(offsets_, offsets_ + GetLen(), -1);
+    data_ = static_cast<char*>(ptr) + table_size;
+#else
+    LOG(FATAL) << "CachedDataset is not supported on Windows";
+#endif  // _WIN32
+  }
+
+  ~CachedDataset() override {
+#ifndef _WIN32
+    if (header_ != nullptr)
+      munmap(header_, map_size_);
+#endif  // _WIN32
+  }
+
+  uint64_t GetLen() const override {
+    return base_data_->GetLen();
+  }
+
+  void Prefetch(uint64_t idx) override {
+    base_data_->Prefetch(idx);
+  }
+
+  bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
+    CHECK_LT(idx, GetLen()) << "GetItem index: " << idx << " out of bound: " << GetLen();
+#ifndef _WIN32
+    if (Read(idx, ret))
+      return true;
+    if (!base_data_->GetItem(idx, ret))
+      return false;
+    Write(idx, *ret);
+    return true;
+#else
+    return base_data_->GetItem(idx, ret);
+#endif  // _WIN32
+  }
+
+ private:
+#ifndef _WIN32
+  /*! \brief state of the cache, at the beginning of the shared memory */
+  struct CacheHeader {
+    pthread_rwlock_t lock;
+    /*! \brief size of the ring buffer */
+    uint64_t capacity;
+    /*! \brief the cached items are in [tail, head), or in [tail, end) and [0, head) if wrapped */
+    uint64_t head, tail, end;
+    uint64_t wrapped;
+    uint64_t count;
+  };
+  /*! \brief an item in the ring buffer, followed by its arrays */
+  struct EntryHeader {
+    uint64_t index;
+    uint64_t size;
+    uint64_t num_arrays;
+  };
+  /*! \brief an array of an item, followed by its shape and, aligned, its data */
+  struct ArrayHeader {
+    int32_t dtype;
+    int32_t ndim;
+    uint64_t nbytes;
+  };
+
+  class LockGuard {
+   public:
+    LockGuard(pthread_rwlock_t* lock, bool exclusive) : lock_(lock) {
+      CHECK_EQ(exclusive ? pthread_rwlock_wrlock(lock_) : pthread_rwlock_rdlock(lock_), 0);
+    }
+    ~LockGuard() {
+      pthread_rwlock_unlock(lock_);
+    }
+
+   private:
+    pthread_rwlock_t* lock_;
+  };
+
+  static size_t Align(size_t size) {
+    return (size + 15) / 16 * 16;
+  }
+
+  static size_t ArraySize(const NDArray& arr) {
+    return Align(sizeof(ArrayHeader) + arr.shape().ndim() * sizeof(int64_t)) +
+           Align(arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype()));
+  }
+
+  bool Read(uint64_t idx, std::vector<NDArray>* ret) {
+    LockGuard lock(&header_->lock, false);
+    if (offsets_[idx] < 0)
+      return false;
+    const char* ptr           = data_ + offsets_[idx];
+    const EntryHeader* header = reinterpret_cast<const EntryHeader*>(ptr);
+    ptr += Align(sizeof(EntryHeader));
+    ret->resize(header->num_arrays);
+    for (auto& arr : *ret) {
+      const ArrayHeader* array = reinterpret_cast<const ArrayHeader*>(ptr);
+      const int64_t* dims      = reinterpret_cast<const int64_t*>(array + 1);
+      TShape shape(array->ndim, 1);
+      for (int i = 0; i < array->ndim; ++i)
+        shape[i] = dims[i];
+      ptr += Align(sizeof(ArrayHeader) + array->ndim * sizeof(int64_t));
+      arr = NDArray(shape, Context::CPU(), false, array->dtype);
+      std::memcpy(arr.data().dptr_, ptr, array->nbytes);
+      ptr += Align(array->nbytes);
+    }
+    return true;
+  }
+
+  void Write(uint64_t idx, const std::vector<NDArray>& arrays) {
+    size_t size = Align(sizeof(EntryHeader));
+    for (const auto& arr : arrays) {
+      if (arr.storage_type() != kDefaultStorage || arr.ctx().dev_mask() != cpu::kDevMask)
+        return;
+      arr.WaitToRead();
+      size += ArraySize(arr);
+    }
+    LockGuard lock(&header_->lock, true);
+    if (offsets_[idx] >= 0 || size > header_->capacity)
+      return;
+    const uint64_t offset = Allocate(size);
+    char* ptr             = data_ + offset;
+    EntryHeader* header   = reinterpret_cast<EntryHeader*>(ptr);
+    header->index         = idx;
+    header->size          = size;
+    header->num_arrays    = arrays.size();
+    ptr += Align(sizeof(EntryHeader));
+    for (const auto& arr : arrays) {
+      ArrayHeader* array = reinterpret_cast<ArrayHeader*>(ptr);
+      array->dtype       = arr.dtype();
+      array->ndim        = arr.shape().ndim();
+      array->nbytes      = arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype());
+      int64_t* dims      = reinterpret_cast<int64_t*>(array + 1);
+      for (int i = 0; i < array->ndim; ++i)
+        dims[i] = arr.shape()[i];
+      ptr += Align(sizeof(ArrayHeader) + array->ndim * sizeof(int64_t));
+      std::memcpy(ptr, arr.data().dptr_, array->nbytes);
+      ptr += Align(array->nbytes);
+    }
+    offsets_[idx] = offset;
+  }
+
+  /*! \brief allocate size bytes at the head of the ring buffer, evicting the oldest items */
+  uint64_t Allocate(size_t size) {
+    CacheHeader* h = header_;
+    while (true) {
+      if (h->count == 0) {
+        h->head = h->tail = h->wrapped = 0;
+      }
+      if (!h->wrapped && h->capacity - h->head >= size) {
+        break;
+      } else if (!h->wrapped && h->tail >= size) {
+        h->end     = h->head;
+        h->head    = 0;
+        h->wrapped = 1;
+        break;
+      } else if (h->wrapped && h->tail - h->head >= size) {
+        break;
+      }
+      // evict the oldest item
+      const EntryHeader* oldest = reinterpret_cast<const EntryHeader*>(data_ + h->tail);
+      offsets_[oldest->index]   = -1;
+      h->tail += oldest->size;
+      --h->count;
+      if (h->wrapped && h->tail == h->end) {
+        h->tail    = 0;
+        h->wrapped = 0;
+      }
+    }
+    const uint64_t offset = h->head;
+    h->head += size;
+    ++h->count;
+    return offset;
+  }
+
+  /*! \brief the shared memory, holding the header, the offsets of the items and the data */
+  CacheHeader* header_{nullptr};
+  int64_t* offsets_{nullptr};
+  char* data_{nullptr};
+  size_t map_size_{0};
+#endif  // _WIN32
+  /*! \brief parameters */
+  CachedDatasetParam param_;
+  /*! \brief stored child dataset */
+  std::shared_ptr<Dataset> base_data_;
+};  // class CachedDataset
+
+MXNET_REGISTER_IO_DATASET(CachedDataset)
+    .describe("Dataset caching the items of another dataset in shared memory")
+    .add_arguments(CachedDatasetParam::__FIELDS__())
+    .set_body([](const std::vector<std::pair<std::string, std::string>>& kwargs) {
+      return new CachedDataset(kwargs);
+    });
+
 struct LazyTransformDatasetParam : public dmlc::Parameter<LazyTransformDatasetParam> {
   /*! \brief the source ndarray */
   std::intptr_t cached_op;
@@ -600,6 +983,10 @@ class LazyTransformDataset final : public Dataset {
     return base_data_->GetLen();
   }
 
+  void Prefetch(uint64_t idx) override {
+    base_data_->Prefetch(idx);
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* outputs) override {
     std::vector<NDArray> inputs;
     if (!base_data_->GetItem(idx, &inputs))
@@ -628,6 +1015,7 @@ class LazyTransformDataset final : public Dataset {
     }
     CHECK(inputs.size() > 0) << "dataset getitem requires at least one input";
     Context default_ctx = inputs[0].ctx();
+    profiler::IOStageTimer timer(profiler::IOProfiler::kAugment);
     cached_op_->Forward(cached_op_, ndinputs, ndoutputs, default_ctx);
     return true;
   }
@@ -614,6 +614,143 @@ class DefaultImageAugmenter : public ImageAugmenter {
   std::vector<int> rotate_list_;
 };
 
+/*!
+ * \brief sampler of the augmentations of DefaultImageAugmenter applied on the GPU, every crop
+ *  and resize becomes a single window of the decoded image resized to data_shape
+ */
+class DefaultGPUAugmentSampler : public GPUAugmentSampler {
+ public:
+  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
+    for (auto& kwarg : param_.InitAllowUnknown(kwargs)) {
+      CHECK_NE(kwarg.first, "rotate_list") << "rotate_list is not supported with gpu_decode";
+    }
+    CHECK(param_.max_rotate_angle == 0 && param_.rotate <= 0 && param_.max_shear_ratio == 0.0f)
+        << "rotations and shears are not supported with gpu_decode";
+    CHECK(param_.max_random_scale == 1.0f && param_.min_random_scale == 1.0f &&
+          param_.max_img_size == 1e10f && param_.min_img_size == 0.0f)
+        << "random scales and image size limits are not supported with gpu_decode";
+    CHECK(param_.random_resized_crop ||
+          (param_.max_aspect_ratio == 0.0f && !param_.min_aspect_ratio.has_value()))
+        << "aspect ratios are only supported with random_resized_crop and gpu_decode";
+    CHECK(param_.max_crop_size == -1 && param_.min_crop_size == -1 && param_.pad == 0)
+        << "crop sizes and padding are not supported with gpu_decode";
+    CHECK(param_.random_h == 0 && param_.random_s == 0 && param_.random_l == 0 &&
+          param_.pca_noise == 0.0f)
+        << "HSL and PCA noise are not supported with gpu_decode";
+    CHECK(!param_.random_resized_crop || !param_.rand_crop)
+        << "\nSetting random_resized_crop to true conflicts with rand_crop.";
+  }
+
+  void Sample(int rows, int cols, GPUImageAugment* aug, common::RANDOM_ENGINE* prnd) override {
+    using mshadow::index_t;
+    const float out_rows = param_.data_shape[1];
+    const float out_cols = param_.data_shape[2];
+    // size of the image after the resize of the shorter edge
+    float res_rows = rows;
+    float res_cols = cols;
+    if (param_.resize != -1) {
+      if (rows > cols) {
+        res_rows = param_.resize * rows / cols;
+        res_cols = param_.resize;
+      } else {
+        res_rows = param_.resize;
+        res_cols = param_.resize * cols / rows;
+      }
+    }
+    // crop window in the resized image
+    bool is_cropped = false;
+    float x = 0, y = 0, width = res_cols, height = res_rows;
+    float max_aspect_ratio = 1 + param_.max_aspect_ratio;
+    float min_aspect_ratio = 1 - param_.max_aspect_ratio;
+    if (param_.min_aspect_ratio.has_value()) {
+      max_aspect_ratio = param_.max_aspect_ratio;
+      min_aspect_ratio = param_.min_aspect_ratio.value();
+    }
+    if (param_.random_resized_crop &&
+        (param_.max_random_area != 1.0f || param_.min_random_area != 1.0f ||
+         max_aspect_ratio != 1.0f || min_aspect_ratio != 1.0f)) {
+      CHECK(min_aspect_ratio > 0.0f);
+      CHECK(param_.min_random_area <= param_.max_random_area);
+      CHECK(min_aspect_ratio <= max_aspect_ratio);
+      std::uniform_real_distribution<float> rand_uniform_area(param_.min_random_area,
+                                                              param_.max_random_area);
+      std::uniform_real_distribution<float> rand_uniform_ratio(min_aspect_ratio,
+                                                               max_aspect_ratio);
+      std::uniform_real_distribution<float> rand_uniform(0, 1);
+      const float area = res_rows * res_cols;
+      for (int i = 0; i < 10; ++i) {
+        float target_area = area * rand_uniform_area(*prnd);
+        float ratio       = rand_uniform_ratio(*prnd);
+        int y_area        = std::round(std::sqrt(target_area / ratio));
+        int x_area        = std::round(std::sqrt(target_area * ratio));
+        if (rand_uniform(*prnd) > 0.5) {
+          std::swap(x_area, y_area);
+        }
+        if (y_area <= res_rows && x_area <= res_cols) {
+          y      = std::uniform_int_distribution<index_t>(0, res_rows - y_area)(*prnd);
+          x      = std::uniform_int_distribution<index_t>(0, res_cols - x_area)(*prnd);
+          width  = x_area;
+          height = y_area;
+          is_cropped = true;
+          break;
+        }
+      }
+    }
+    if (!is_cropped) {
+      // center crop, after enlarging the images smaller than data_shape
+      float crop_rows = res_rows;
+      float crop_cols = res_cols;
+      if (crop_rows < out_rows) {
+        crop_cols = static_cast<index_t>(out_rows / crop_rows * crop_cols);
+        crop_rows = out_rows;
+      }
+      if (crop_cols < out_cols) {
+        crop_rows = static_cast<index_t>(out_cols / crop_cols * crop_rows);
+        crop_cols = out_cols;
+      }
+      index_t crop_y = crop_rows - out_rows;
+      index_t crop_x = crop_cols - out_cols;
+      if (param_.rand_crop != 0) {
+        crop_y = std::uniform_int_distribution<index_t>(0, crop_y)(*prnd);
+        crop_x = std::uniform_int_distribution<index_t>(0, crop_x)(*prnd);
+      } else {
+        crop_y /= 2;
+        crop_x /= 2;
+      }
+      x      = crop_x * res_cols / crop_cols;
+      y      = crop_y * res_rows / crop_rows;
+      width  = out_cols * res_cols / crop_cols;
+      height = out_rows * res_rows / crop_rows;
+    }
+    aug->x      = x * cols / res_cols;
+    aug->y      = y * rows / res_rows;
+    aug->width  = width * cols / res_cols;
+    aug->height = height * rows / res_rows;
+
+    // color jitter
+    aug->alpha_b = aug->alpha_c = aug->alpha_s = 1.0f;
+    int rand_order[3] = {0, 1, 2};
+    if (param_.brightness > 0.0f || param_.contrast > 0.0f || param_.saturation > 0.0f) {
+      aug->alpha_b +=
+          std::uniform_real_distribution<float>(-param_.brightness, param_.brightness)(*prnd);
+      aug->alpha_c +=
+          std::uniform_real_distribution<float>(-param_.contrast, param_.contrast)(*prnd);
+      aug->alpha_s +=
+          std::uniform_real_distribution<float>(-param_.saturation, param_.saturation)(*prnd);
+      std::shuffle(std::begin(rand_order), std::end(rand_order), *prnd);
+    }
+    std::copy(std::begin(rand_order), std::end(rand_order), aug->order);
+  }
+
+ private:
+  // parameters
+  DefaultImageAugmentParam param_;
+};
+
+GPUAugmentSampler* GPUAugmentSampler::Create() {
+  return new DefaultGPUAugmentSampler();
+}
+
 ImageAugmenter* ImageAugmenter::Create(const std::string& name) {
   return dmlc::Registry<ImageAugmenterReg>::Find(name)->body();
 }
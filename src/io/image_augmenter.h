@@ -69,6 +69,41 @@ class ImageAugmenter {
   static ImageAugmenter* Create(const std::string& name);
 };
 
+/*! \brief augmentation of an image decoded on the GPU */
+struct GPUImageAugment {
+  /*! \brief crop window, in pixels of the decoded image */
+  float x, y, width, height;
+  /*! \brief whether to flip the crop horizontally */
+  int mirror;
+  /*! \brief factors of the brightness, contrast and saturation jitter */
+  float alpha_b, alpha_c, alpha_s;
+  /*! \brief order of the jitters, 0 for brightness, 1 for contrast and 2 for saturation */
+  int order[3];
+  /*! \brief random contrast and illumination of the normalization, multiplied by its scale */
+  float contrast, illumination;
+};
+
+/*!
+ * \brief Samples the crop window and the color jitter of aug_default for an image which is
+ *  decoded and augmented on the GPU. The other augmentations of aug_default are rejected.
+ */
+class GPUAugmentSampler {
+ public:
+  virtual void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) = 0;
+  /*!
+   * \brief sample the augmentation of an image
+   * \param rows height of the decoded image
+   * \param cols width of the decoded image
+   * \param aug the crop and the jitter, the mirror and normalization are left unchanged
+   * \param prnd pointer to random number generator.
+   */
+  virtual void Sample(int rows, int cols, GPUImageAugment* aug, common::RANDOM_ENGINE* prnd) = 0;
+  // virtual destructor
+  virtual ~GPUAugmentSampler() {}
+  /*! \brief create the sampler of aug_default */
+  static GPUAugmentSampler* Create();
+};
+
 /*! \brief typedef the factory function of data iterator */
 typedef std::function<ImageAugmenter*()> ImageAugmenterFactory;
 /*!
@@ -0,0 +1,311 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file image_gpu_decoder.cu
+ * \brief batched decoding of JPEG images with nvJPEG and augmentation on the GPU
+ */
+#include "./image_gpu_decoder.h"
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+
+#include <algorithm>
+#include "../common/cuda/utils.h"
+
+/*!
+ * \brief Protected nvJPEG call.
+ * \param func Expression to call.
+ */
+#define NVJPEG_CALL(func)                                                             \
+  {                                                                                   \
+    nvjpegStatus_t e = (func);                                                        \
+    CHECK_EQ(e, NVJPEG_STATUS_SUCCESS) << "nvJPEG: " #func " failed with status " << e; \
+  }
+
+namespace mxnet {
+namespace io {
+
+namespace {
+
+const int kThreads = 256;
+
+/*! \brief a decoded image and its augmentation */
+struct DecodedImage {
+  size_t offset;
+  int width, height;
+  GPUImageAugment aug;
+  /*! \brief mean of the gray levels of the crop, before the jitter */
+  float gray_mean;
+};
+
+__device__ inline float Clamp(float v) {
+  return fminf(fmaxf(v, 0.0f), 255.0f);
+}
+
+__device__ inline float Gray(const float* rgb) {
+  return 0.299f * rgb[0] + 0.587f * rgb[1] + 0.114f * rgb[2];
+}
+
+/*! \brief bilinear sample of the crop of an image at the output pixel (x, y) */
+__device__ inline void SampleCrop(const uint8_t* decoded,
+                                  const DecodedImage& img,
+                                  int x,
+                                  int y,
+                                  int out_width,
+                                  int out_height,
+                                  float* rgb) {
+  const GPUImageAugment& aug = img.aug;
+  const int src_x            = aug.mirror ? out_width - 1 - x : x;
+  float sx = fminf(fmaxf(aug.x + (src_x + 0.5f) * aug.width / out_width - 0.5f, 0.0f),
+                   img.width - 1.0f);
+  float sy = fminf(fmaxf(aug.y + (y + 0.5f) * aug.height / out_height - 0.5f, 0.0f),
+                   img.height - 1.0f);
+  const int x0       = static_cast<int>(sx);
+  const int y0       = static_cast<int>(sy);
+  const int x1       = min(x0 + 1, img.width - 1);
+  const int y1       = min(y0 + 1, img.height - 1);
+  const float fx     = sx - x0;
+  const float fy     = sy - y0;
+  const uint8_t* src = decoded + img.offset;
+  const size_t pitch = static_cast<size_t>(img.width) * 3;
+  const uint8_t* top    = src + y0 * pitch;
+  const uint8_t* bottom = src + y1 * pitch;
+  for (int c = 0; c < 3; ++c) {
+    const float t = top[x0 * 3 + c] * (1 - fx) + top[x1 * 3 + c] * fx;
+    const float b = bottom[x0 * 3 + c] * (1 - fx) + bottom[x1 * 3 + c] * fx;
+    rgb[c]        = t * (1 - fy) + b * fy;
+  }
+}
+
+/*! \brief mean gray level of the crop of every image, one block per image */
+__global__ void GrayMeanKernel(const uint8_t* decoded,
+                               DecodedImage* images,
+                               int out_width,
+                               int out_height) {
+  __shared__ float partial[kThreads];
+  DecodedImage& img = images[blockIdx.x];
+  float sum         = 0;
+  if (img.aug.alpha_c != 1.0f) {
+    for (int i = threadIdx.x; i < out_width * out_height; i += blockDim.x) {
+      float rgb[3];
+      SampleCrop(decoded, img, i % out_width, i / out_width, out_width, out_height, rgb);
+      sum += Gray(rgb);
+    }
+  }
+  partial[threadIdx.x] = sum;
+  __syncthreads();
+  for (int s = blockDim.x / 2; s > 0; s /= 2) {
+    if (threadIdx.x < s)
+      partial[threadIdx.x] += partial[threadIdx.x + s];
+    __syncthreads();
+  }
+  if (threadIdx.x == 0)
+    img.gray_mean = partial[0] / (out_width * out_height);
+}
+
+template <typename DType>
+struct Normalized {
+  __device__ static DType Get(float v, int c, const GPUNormalize& n, const GPUImageAugment& a) {
+    return DType((v - n.mean[c]) * a.contrast / n.std[c] + a.illumination / n.std[c]);
+  }
+};
+
+template <>
+struct Normalized<uint8_t> {
+  __device__ static uint8_t Get(float v, int c, const GPUNormalize& n, const GPUImageAugment& a) {
+    return static_cast<uint8_t>(__float2int_rn(v));
+  }
+};
+
+template <>
+struct Normalized<int8_t> {
+  __device__ static int8_t Get(float v, int c, const GPUNormalize& n, const GPUImageAugment& a) {
+    return static_cast<int8_t>(max(-128, min(127, __float2int_rn(v) - __float2int_rn(n.mean[c]))));
+  }
+};
+
+/*! \brief crop, resize, flip, jitter and normalize the images, one thread per output pixel */
+template <typename DType>
+__global__ void AugmentKernel(const uint8_t* decoded,
+                              const DecodedImage* images,
+                              GPUNormalize normalize,
+                              int out_width,
+                              int out_height,
+                              DType* out) {
+  const int i = blockIdx.x * blockDim.x + threadIdx.x;
+  if (i >= out_width * out_height)
+    return;
+  const DecodedImage& img    = images[blockIdx.y];
+  const GPUImageAugment& aug = img.aug;
+  float rgb[3];
+  SampleCrop(decoded, img, i % out_width, i / out_width, out_width, out_height, rgb);
+  // the jitters of aug_default, saturation keeps the gray levels
+  float gray_mean = img.gray_mean;
+  for (int j = 0; j < 3; ++j) {
+    if (aug.order[j] == 0 && aug.alpha_b != 1.0f) {
+      for (int c = 0; c < 3; ++c)
+        rgb[c] = Clamp(rgb[c] * aug.alpha_b);
+      gray_mean *= aug.alpha_b;
+    } else if (aug.order[j] == 1 && aug.alpha_c != 1.0f) {
+      for (int c = 0; c < 3; ++c)
+        rgb[c] = Clamp(rgb[c] * aug.alpha_c + (1 - aug.alpha_c) * gray_mean);
+    } else if (aug.order[j] == 2 && aug.alpha_s != 1.0f) {
+      const float gray = Gray(rgb);
+      for (int c = 0; c < 3; ++c)
+        rgb[c] = Clamp(rgb[c] * aug.alpha_s + (1 - aug.alpha_s) * gray);
+    }
+  }
+  const size_t plane = static_cast<size_t>(out_width) * out_height;
+  DType* dst         = out + blockIdx.y * 3 * plane + i;
+  for (int c = 0; c < 3; ++c)
+    dst[c * plane] = Normalized<DType>::Get(rgb[c], c, normalize, aug);
+}
+
+}  // namespace
+
+ImageGPUDecoder::ImageGPUDecoder(int dev_id) : dev_id_(dev_id) {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+  NVJPEG_CALL(nvjpegCreateSimple(&handle_));
+  NVJPEG_CALL(nvjpegJpegStateCreate(handle_, &state_));
+}
+
+ImageGPUDecoder::~ImageGPUDecoder() {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  if (decoded_.dptr != nullptr)
+    Storage::Get()->Free(decoded_);
+  if (images_.dptr != nullptr)
+    Storage::Get()->Free(images_);
+  nvjpegJpegStateDestroy(state_);
+  nvjpegDestroy(handle_);
+  cudaStreamDestroy(stream_);
+}
+
+bool ImageGPUDecoder::GetImageInfo(const uint8_t* data, size_t size, int* width, int* height) {
+  int num_components;
+  nvjpegChromaSubsampling_t subsampling;
+  int widths[NVJPEG_MAX_COMPONENT];
+  int heights[NVJPEG_MAX_COMPONENT];
+  if (nvjpegGetImageInfo(
+          handle_, data, size, &num_components, &subsampling, widths, heights) !=
+          NVJPEG_STATUS_SUCCESS ||
+      (num_components != 1 && num_components != 3) || subsampling == NVJPEG_CSS_UNKNOWN) {
+    return false;
+  }
+  *width  = widths[0];
+  *height = heights[0];
+  return true;
+}
+
+void ImageGPUDecoder::Reserve(Storage::Handle* buf, size_t size) {
+  if (buf->dptr != nullptr && buf->size >= size)
+    return;
+  if (buf->dptr != nullptr)
+    Storage::Get()->Free(*buf);
+  *buf = Storage::Get()->Alloc(size, Context::GPU(dev_id_));
+}
+
+void ImageGPUDecoder::Process(const std::vector<GPUDecodeInput>& inputs,
+                              const std::vector<GPUImageAugment>& augs,
+                              const GPUNormalize& normalize,
+                              const std::vector<real_t>& labels,
+                              const TBlob& data,
+                              const TBlob& label) {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  const int num_images = inputs.size();
+  CHECK_EQ(augs.size(), inputs.size());
+  CHECK_LE(num_images, data.shape_[0]);
+  std::vector<DecodedImage> images(num_images);
+  size_t decoded_size = 0;
+  for (int i = 0; i < num_images; ++i) {
+    images[i].offset = decoded_size;
+    images[i].width  = inputs[i].width;
+    images[i].height = inputs[i].height;
+    images[i].aug    = augs[i];
+    decoded_size += static_cast<size_t>(inputs[i].width) * inputs[i].height * 3;
+  }
+  // the previous batch is complete, so that the buffers can be replaced
+  Reserve(&decoded_, decoded_size);
+  Reserve(&images_, num_images * sizeof(DecodedImage));
+  uint8_t* decoded = static_cast<uint8_t*>(decoded_.dptr);
+
+  std::vector<const unsigned char*> jpegs;
+  std::vector<size_t> lengths;
+  std::vector<nvjpegImage_t> outputs;
+  for (int i = 0; i < num_images; ++i) {
+    uint8_t* dst = decoded + images[i].offset;
+    if (inputs[i].rgb != nullptr) {
+      CUDA_CALL(cudaMemcpyAsync(dst,
+                                inputs[i].rgb,
+                                static_cast<size_t>(inputs[i].width) * inputs[i].height * 3,
+                                cudaMemcpyHostToDevice,
+                                stream_));
+      continue;
+    }
+    nvjpegImage_t out = {};
+    out.channel[0]    = dst;
+    out.pitch[0]      = static_cast<size_t>(inputs[i].width) * 3;
+    jpegs.push_back(inputs[i].data);
+    lengths.push_back(inputs[i].size);
+    outputs.push_back(out);
+  }
+  if (!jpegs.empty()) {
+    const int num_jpegs = jpegs.size();
+    if (num_jpegs != batch_size_) {
+      NVJPEG_CALL(nvjpegDecodeBatchedInitialize(handle_, state_, num_jpegs, 1, NVJPEG_OUTPUT_RGBI));
+      batch_size_ = num_jpegs;
+    }
+    NVJPEG_CALL(nvjpegDecodeBatched(
+        handle_, state_, jpegs.data(), lengths.data(), outputs.data(), stream_));
+  }
+
+  if (num_images > 0) {
+    DecodedImage* dev_images = static_cast<DecodedImage*>(images_.dptr);
+    CUDA_CALL(cudaMemcpyAsync(dev_images,
+                              images.data(),
+                              num_images * sizeof(DecodedImage),
+                              cudaMemcpyHostToDevice,
+                              stream_));
+    const int out_height = data.shape_[2];
+    const int out_width  = data.shape_[3];
+    if (std::any_of(augs.begin(), augs.end(), [](const GPUImageAugment& a) {
+          return a.alpha_c != 1.0f;
+        })) {
+      GrayMeanKernel<<<num_images, kThreads, 0, stream_>>>(
+          decoded, dev_images, out_width, out_height);
+    }
+    const dim3 blocks((out_width * out_height + kThreads - 1) / kThreads, num_images);
+    MSHADOW_TYPE_SWITCH(data.type_flag_, DType, {
+      AugmentKernel<<<blocks, kThreads, 0, stream_>>>(
+          decoded, dev_images, normalize, out_width, out_height, data.dptr<DType>());
+    });
+    CUDA_CALL(cudaGetLastError());
+  }
+  CUDA_CALL(cudaMemcpyAsync(label.dptr_,
+                            labels.data(),
+                            labels.size() * sizeof(real_t),
+                            cudaMemcpyHostToDevice,
+                            stream_));
+  CUDA_CALL(cudaStreamSynchronize(stream_));
+}
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file image_gpu_decoder.h
+ * \brief batched decoding of JPEG images with nvJPEG and augmentation on the GPU
+ */
+#ifndef MXNET_IO_IMAGE_GPU_DECODER_H_
+#define MXNET_IO_IMAGE_GPU_DECODER_H_
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+
+#include <cuda_runtime.h>
+#include <mxnet/storage.h>
+#include <mxnet/tensor_blob.h>
+#include <nvjpeg.h>
+#include <vector>
+#include "./image_augmenter.h"
+
+namespace mxnet {
+namespace io {
+
+/*! \brief an encoded image of a batch */
+struct GPUDecodeInput {
+  /*! \brief the encoded image */
+  const uint8_t* data;
+  size_t size;
+  /*! \brief the image decoded on the CPU in interleaved RGB, when nvJPEG cannot decode it */
+  const uint8_t* rgb;
+  /*! \brief size of the decoded image */
+  int width, height;
+};
+
+/*! \brief mean and standard deviation of the RGB channels, see ImageNormalizeParam */
+struct GPUNormalize {
+  float mean[3];
+  float std[3];
+};
+
+/*!
+ * \brief Decodes the JPEG images of a batch with the batched decoder of nvJPEG, then crops,
+ *  resizes, flips and jitters them, and writes them normalized into a NCHW tensor, in one
+ *  pass over the decoded images.
+ */
+class ImageGPUDecoder {
+ public:
+  explicit ImageGPUDecoder(int dev_id);
+  ~ImageGPUDecoder();
+  /*!
+   * \brief read the size of an encoded image
+   * \return whether nvJPEG decodes the image
+   */
+  bool GetImageInfo(const uint8_t* data, size_t size, int* width, int* height);
+  /*!
+   * \brief decode and augment the images of a batch, and copy their labels, and wait for
+   *  data and label to be written
+   * \param inputs the encoded images
+   * \param augs the augmentation of each image
+   * \param normalize the normalization of the images
+   * \param labels the labels of the images, on the CPU
+   * \param data the batch of images on the GPU, of shape (batch_size, 3, height, width)
+   * \param label the batch of labels on the GPU
+   */
+  void Process(const std::vector<GPUDecodeInput>& inputs,
+               const std::vector<GPUImageAugment>& augs,
+               const GPUNormalize& normalize,
+               const std::vector<real_t>& labels,
+               const TBlob& data,
+               const TBlob& label);
+
+ private:
+  /*! \brief grow a buffer on the GPU to size bytes */
+  void Reserve(Storage::Handle* buf, size_t size);
+
+  int dev_id_;
+  cudaStream_t stream_;
+  nvjpegHandle_t handle_;
+  nvjpegJpegState_t state_;
+  /*! \brief number of images the batched decoder is initialized for */
+  int batch_size_{0};
+  /*! \brief decoded images, in interleaved RGB */
+  Storage::Handle decoded_;
+  /*! \brief descriptions of the decoded images */
+  Storage::Handle images_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+#endif  // MXNET_IO_IMAGE_GPU_DECODER_H_
@@ -132,6 +132,8 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
   int shuffle_chunk_seed;
   /*! \brief random seed for augmentations */
   dmlc::optional<int> seed_aug;
+  /*! \brief minimal shorter edge of the JPEG images decoded at a reduced scale */
+  int jpeg_scale_min_size;
 
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecParserParam) {
@@ -187,6 +189,30 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
     DMLC_DECLARE_FIELD(seed_aug)
         .set_default(dmlc::optional<int>())
         .describe("Random seed for augmentations.");
+    DMLC_DECLARE_FIELD(jpeg_scale_min_size)
+        .set_default(0)
+        .set_lower_bound(-1)
+        .describe(
+            "Decode the JPEG images with libjpeg-turbo at the smallest scale of 1/2, 1/4 or 1/8 "
+            "whose shorter edge is at least this size, e.g. the ``resize`` of the images. -1 uses "
+            "the larger edge of ``data_shape``, for scale invariant augmentations such as a "
+            "``random_resized_crop``. 0 decodes the images at full resolution.");
+  }
+};
+
+// GPU decoding parameters of the image record parser
+struct ImageRecGPUParam : public dmlc::Parameter<ImageRecGPUParam> {
+  /*! \brief whether to decode and augment the images on the GPU */
+  bool gpu_decode;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ImageRecGPUParam) {
+    DMLC_DECLARE_FIELD(gpu_decode)
+        .set_default(false)
+        .describe(
+            "Whether to decode the JPEG images with nvJPEG and apply the crops, flips, color "
+            "jitter and normalization on the GPU ``device_id``, which then holds the batches. "
+            "Only the reading of the records runs on the CPU. Requires MXNet built with "
+            "USE_NVJPEG.");
   }
 };
 
@@ -400,6 +426,8 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
   /*! \brief Context data loader optimized for */
   int ctx;
   int device_id;
+  /*! \brief GPU the batches are copied to ahead of time, -1 to return host batches */
+  int prefetch_device_id;
   /*! \brief data type */
   dmlc::optional<int> dtype;
 
@@ -421,6 +449,13 @@ struct PrefetcherParam : public dmlc::Parameter<PrefetcherParam> {
             "it will use cpu_pinned(device_id) as ctx");
     DMLC_DECLARE_FIELD(device_id).set_default(-1).describe(
         "The default device id for context. -1 indicate it's on default device");
+    DMLC_DECLARE_FIELD(prefetch_device_id)
+        .set_default(-1)
+        .set_lower_bound(-1)
+        .describe(
+            "If not -1, the batches are returned on gpu(prefetch_device_id), the next batch "
+            "being copied to the GPU by the copy workers of the engine while the current "
+            "one is used.");
     DMLC_DECLARE_FIELD(dtype)
         .add_enum("float32", mshadow::kFloat32)
         .add_enum("float64", mshadow::kFloat64)
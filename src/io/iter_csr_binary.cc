@@ -0,0 +1,218 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_csr_binary.cc
+ * \brief define an iterator over the binary CSR files converted by libsvm2bin
+ */
+#include <mxnet/io.h>
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "./csr_binary.h"
+#include "./iter_sparse_prefetcher.h"
+#include "./iter_sparse_batchloader.h"
+
+namespace mxnet {
+namespace io {
+// CSRBin parameters
+struct CSRBinIterParam : public dmlc::Parameter<CSRBinIterParam> {
+  /*! \brief path to data file */
+  std::string data_csrbin;
+  /*! \brief data shape */
+  mxnet::TShape data_shape;
+  /*! \brief partition the data into multiple parts */
+  int num_parts;
+  /*! \brief the index of the part will read*/
+  int part_index;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(CSRBinIterParam) {
+    DMLC_DECLARE_FIELD(data_csrbin)
+        .describe("The input binary CSR file converted from LibSVM by libsvm2bin.");
+    DMLC_DECLARE_FIELD(data_shape).describe("The shape of one example.");
+    DMLC_DECLARE_FIELD(num_parts).set_default(1).describe("partition the data into multiple parts");
+    DMLC_DECLARE_FIELD(part_index).set_default(0).describe("the index of the part will read");
+  }
+};
+
+class CSRBinIter : public SparseIIterator<DataInst> {
+ public:
+  CSRBinIter() = default;
+  ~CSRBinIter() override {
+#ifndef _WIN32
+    if (data_ != nullptr)
+      munmap(data_, size_);
+#endif  // _WIN32
+  }
+
+  // intialize iterator loads data in
+  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
+    CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
+    CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
+    CHECK_LT(param_.part_index, param_.num_parts) << "part index should be less than num_parts";
+#ifndef _WIN32
+    const int fd = open(param_.data_csrbin.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Failed to open " << param_.data_csrbin << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << param_.data_csrbin;
+    size_ = st.st_size;
+    CHECK_GE(size_, kCSRBinFirstBlock) << param_.data_csrbin << " is not a binary CSR file";
+    void* ptr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << param_.data_csrbin << ": " << strerror(errno);
+    data_ = static_cast<char*>(ptr);
+    madvise(data_, size_, MADV_SEQUENTIAL);
+#else
+    LOG(FATAL) << "CSRBinIter is not supported on Windows";
+#endif  // _WIN32
+    CSRBinFileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    CHECK_EQ(header.magic, CSRBinFileHeader::kMagic)
+        << param_.data_csrbin << " is not a binary CSR file";
+    CHECK_EQ(header.version, CSRBinFileHeader::kVersion)
+        << "Unsupported version of binary CSR file " << header.version;
+    // the blocks of the part, split by position like the parts of the LibSVMIter
+    std::vector<uint64_t> offsets;
+    for (uint64_t pos = kCSRBinFirstBlock; pos < size_;) {
+      CHECK_LE(pos + sizeof(CSRBinBlockHeader), size_) << "Truncated binary CSR file";
+      CSRBinBlockHeader block;
+      std::memcpy(&block, data_ + pos, sizeof(block));
+      const CSRBinBlockLayout layout(block);
+      CHECK_LE(pos + layout.size, size_) << "Truncated binary CSR file";
+      offsets.push_back(pos);
+      pos += layout.size;
+    }
+    const size_t begin = offsets.size() * param_.part_index / param_.num_parts;
+    const size_t end   = offsets.size() * (param_.part_index + 1) / param_.num_parts;
+    blocks_.assign(offsets.begin() + begin, offsets.begin() + end);
+    out_.data.resize(4);
+  }
+
+  void BeforeFirst() override {
+    block_idx_    = 0;
+    row_          = 0;
+    num_rows_     = 0;
+    inst_counter_ = 0;
+  }
+
+  bool Next() override {
+    while (row_ >= num_rows_) {
+      if (block_idx_ >= blocks_.size())
+        return false;
+      const char* block = data_ + blocks_[block_idx_++];
+      CSRBinBlockHeader header;
+      std::memcpy(&header, block, sizeof(header));
+      const CSRBinBlockLayout layout(header);
+      label_    = reinterpret_cast<const real_t*>(block + layout.label);
+      indptr_   = reinterpret_cast<const int64_t*>(block + layout.indptr);
+      indices_  = reinterpret_cast<const int64_t*>(block + layout.indices);
+      values_   = reinterpret_cast<const real_t*>(block + layout.values);
+      num_rows_ = header.num_rows;
+      row_      = 0;
+    }
+    out_.index = inst_counter_++;
+    // views of the mapped row, data, indices and indptr
+    const int64_t begin = indptr_[row_];
+    const mxnet::TShape shape(mshadow::Shape1(indptr_[row_ + 1] - begin));
+    out_.data[0] = TBlob(const_cast<real_t*>(values_ + begin), shape, cpu::kDevMask);
+    out_.data[1] = TBlob(const_cast<int64_t*>(indices_ + begin), shape, cpu::kDevMask);
+    out_.data[2] = TBlob(nullptr, mshadow::Shape1(0), cpu::kDevMask, mshadow::kInt64);
+    out_.data[3] = TBlob(const_cast<real_t*>(label_ + row_), mshadow::Shape1(1), cpu::kDevMask);
+    ++row_;
+    return true;
+  }
+
+  const DataInst& Value() const override {
+    return out_;
+  }
+
+  const NDArrayStorageType GetStorageType(bool is_data) const override {
+    return is_data ? kCSRStorage : kDefaultStorage;
+  }
+
+  const mxnet::TShape GetShape(bool is_data) const override {
+    if (is_data)
+      return param_.data_shape;
+    return mxnet::TShape(1, 1);
+  }
+
+ private:
+  CSRBinIterParam param_;
+  // output instance
+  DataInst out_;
+  // the mapped file
+  char* data_{nullptr};
+  size_t size_{0};
+  // offsets of the blocks of the part
+  std::vector<uint64_t> blocks_;
+  size_t block_idx_{0};
+  // columns of the current block
+  const real_t* label_{nullptr};
+  const int64_t* indptr_{nullptr};
+  const int64_t* indices_{nullptr};
+  const real_t* values_{nullptr};
+  uint64_t row_{0}, num_rows_{0};
+  // internal instance counter
+  unsigned inst_counter_{0};
+};
+
+DMLC_REGISTER_PARAMETER(CSRBinIterParam);
+
+MXNET_REGISTER_IO_ITER(CSRBinIter)
+    .describe(R"code(Returns the iterator over a binary CSR file, which returns data with `csr`
+storage type and a 1D dense label, like the `LibSVMIter` with `label_libsvm` set to ``NULL``.
+
+The binary CSR file is converted from a zero-based LibSVM file by the `libsvm2bin` tool. It
+stores blocks of rows in the layout of the batches, which are mapped in memory and copied into
+the batches without parsing.
+
+When `num_parts` and `part_index` are provided, the blocks of the file are split into
+`num_parts` partitions, and the iterator only reads the `part_index`-th partition.
+
+Example::
+
+  $ libsvm2bin data.t data.bin
+
+  >>> data_iter = mx.io.CSRBinIter(data_csrbin='data.bin', data_shape=(3,), batch_size=3)
+  >>> batch = data_iter.next()
+  >>> batch.data[0]
+  <CSRNDArray 3x3 @cpu(0)>
+
+)code" ADD_FILELINE)
+    .add_arguments(CSRBinIterParam::__FIELDS__())
+    .add_arguments(BatchParam::__FIELDS__())
+    .add_arguments(PrefetcherParam::__FIELDS__())
+    .set_body([]() { return new SparsePrefetcherIter(new SparseBatchLoader(new CSRBinIter())); });
+
+}  // namespace io
+}  // namespace mxnet
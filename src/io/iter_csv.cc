@@ -28,6 +28,7 @@
 #include <dmlc/data.h>
 #include "./iter_prefetcher.h"
 #include "./iter_batchloader.h"
+#include "./text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -41,6 +42,10 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   std::string label_csv;
   /*! \brief label shape */
   mxnet::TShape label_shape;
+  /*! \brief number of threads parsing a chunk */
+  int num_parse_threads;
+  /*! \brief number of parsed chunks queued ahead */
+  int parse_prefetch;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CSVIterParam) {
     DMLC_DECLARE_FIELD(data_csv).describe("The input CSV file or a directory path.");
@@ -52,6 +57,18 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
     DMLC_DECLARE_FIELD(label_shape)
         .set_default(mxnet::TShape(shape1, shape1 + 1))
         .describe("The shape of one label.");
+    DMLC_DECLARE_FIELD(num_parse_threads)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "If positive, the chunks of the files are parsed by num_parse_threads threads "
+            "each instead of the two threads of the dmlc parser.");
+    DMLC_DECLARE_FIELD(parse_prefetch)
+        .set_default(2)
+        .set_lower_bound(1)
+        .describe(
+            "Number of parsed chunks queued ahead of the batch loader. "
+            "Only used when num_parse_threads is positive.");
   }
 };
 
@@ -95,10 +112,9 @@ class CSVIterTyped : public CSVIterBase {
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t, DType>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
+    data_parser_.reset(CreateParser(param_.data_csv));
     if (param_.label_csv != "NULL") {
-      label_parser_.reset(
-          dmlc::Parser<uint32_t, DType>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
+      label_parser_.reset(CreateParser(param_.label_csv));
     } else {
       dummy_label.set_pad(false);
       dummy_label.Resize(mshadow::Shape1(1));
@@ -148,6 +164,14 @@ class CSVIterTyped : public CSVIterBase {
   }
 
  private:
+  dmlc::Parser<uint32_t, DType>* CreateParser(const std::string& uri) {
+    if (param_.num_parse_threads > 0) {
+      return new CSVChunkParser<uint32_t, DType>(
+          uri, 0, 1, param_.num_parse_threads, param_.parse_prefetch);
+    }
+    return dmlc::Parser<uint32_t, DType>::Create(uri.c_str(), 0, 1, "csv");
+  }
+
   inline TBlob AsTBlob(const dmlc::Row<uint32_t, DType>& row, const mxnet::TShape& shape) {
     CHECK_EQ(row.length, shape.Size())
         << "The data size in CSV do not match size of shape: "
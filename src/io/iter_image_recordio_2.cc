@@ -32,6 +32,7 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <dmlc/timer.h>
+#include <deque>
 #include <memory>
 #include <type_traits>
 #if MXNET_USE_LIBJPEG_TURBO
@@ -39,9 +40,11 @@
 #endif
 #include "./image_recordio.h"
 #include "./image_augmenter.h"
+#include "./image_gpu_decoder.h"
 #include "./image_iter_common.h"
 #include "./inst_vector.h"
 #include "../common/utils.h"
+#include "../profiler/io_profiler.h"
 #include "../profiler/profiler.h"
 
 namespace mxnet {
@@ -58,6 +61,8 @@ class ImageRecordIOParser2 {
   inline void BeforeFirst() {
     if (batch_param_.round_batch == 0 || !overflow) {
       n_parsed_ = 0;
+      chunk_records_.clear();
+      chunk_index_ = 0;
       return source_->BeforeFirst();
     } else {
       overflow = false;
@@ -84,6 +89,13 @@ class ImageRecordIOParser2 {
                            const size_t current_size,
                            dmlc::InputSplit::Blob* chunk);
   inline void CreateMeanImg();
+  inline void LoadLabel(const ImageRecordIO& rec, std::vector<float>* label_buf);
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+  // decode and augment the next batch on the GPU
+  inline bool ParseNextGPU(DataBatch* out);
+  // read the next record for the GPU decoder
+  inline bool NextGPURecord(dmlc::InputSplit::Blob* blob);
+#endif
 
   // magic number to seed prng
   static const int kRandMagic          = 111;
@@ -93,6 +105,7 @@ class ImageRecordIOParser2 {
   ImageRecordParam record_param_;
   BatchParam batch_param_;
   ImageNormalizeParam normalize_param_;
+  ImageRecGPUParam gpu_param_;
 
 #if MXNET_USE_OPENCV
   /*! \brief augmenters */
@@ -125,8 +138,23 @@ class ImageRecordIOParser2 {
   bool legacy_shuffle_;
   // whether mean image is ready.
   bool meanfile_ready_;
+  // minimal shorter edge of the JPEG images decoded at a reduced scale, 0 for full scale
+  int jpeg_min_size_{0};
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
+  /*! \brief records of the last chunk read for the GPU decoder */
+  std::vector<dmlc::InputSplit::Blob> chunk_records_;
+  size_t chunk_index_{0};
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+  /*! \brief decoder and augmenter of the batches on the GPU, if gpu_decode */
+  std::unique_ptr<ImageGPUDecoder> gpu_decoder_;
+  std::unique_ptr<GPUAugmentSampler> gpu_sampler_;
+  /*! \brief records split across the chunk, images decoded on the CPU and labels of a batch */
+  std::deque<std::string> split_records_;
+  std::vector<std::string> encoded_;
+  std::vector<cv::Mat> cpu_decoded_;
+  std::vector<real_t> gpu_labels_;
+#endif
 };
 
 template <typename DType>
@@ -139,6 +167,7 @@ inline void ImageRecordIOParser2<DType>::Init(
   record_param_.InitAllowUnknown(kwargs);
   batch_param_.InitAllowUnknown(kwargs);
   normalize_param_.InitAllowUnknown(kwargs);
+  gpu_param_.InitAllowUnknown(kwargs);
   PrefetcherParam prefetch_param;
   prefetch_param.InitAllowUnknown(kwargs);
   n_parsed_ = 0;
@@ -158,6 +187,15 @@ inline void ImageRecordIOParser2<DType>::Init(
     { threadget = omp_get_num_threads(); }
   }
   param_.preprocess_threads = threadget;
+  jpeg_min_size_            = param_.jpeg_scale_min_size;
+  if (jpeg_min_size_ == -1) {
+    jpeg_min_size_ = std::max(param_.data_shape[1], param_.data_shape[2]);
+  }
+#if !MXNET_USE_LIBJPEG_TURBO
+  if (jpeg_min_size_ != 0) {
+    LOG(WARNING) << "jpeg_scale_min_size is ignored without libjpeg-turbo";
+  }
+#endif
 
   std::vector<std::string> aug_names = dmlc::Split(param_.aug_seq, ',');
   augmenters_.clear();
@@ -224,6 +262,27 @@ inline void ImageRecordIOParser2<DType>::Init(
       source_->HintChunkSize(64 << 20UL);
     }
   }
+  if (gpu_param_.gpu_decode) {
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+    CHECK_NE(prefetch_param.ctx, PrefetcherParam::CtxType::kCPU)
+        << "ImageRecordIter2: gpu_decode cannot be used with ctx='cpu'";
+    CHECK_EQ(param_.data_shape[0], 3) << "ImageRecordIter2: gpu_decode only supports RGB images";
+    CHECK_EQ(param_.aug_seq, "aug_default") << "ImageRecordIter2: gpu_decode only supports "
+                                            << "aug_default";
+    CHECK_EQ(normalize_param_.mean_img.length(), 0)
+        << "ImageRecordIter2: mean_img is not supported with gpu_decode";
+    gpu_sampler_.reset(GPUAugmentSampler::Create());
+    gpu_sampler_->Init(kwargs);
+    gpu_decoder_ = std::make_unique<ImageGPUDecoder>(std::max(param_.device_id, 0));
+    if (param_.verbose) {
+      LOG(INFO) << "ImageRecordIOParser2: decode the images on gpu("
+                << std::max(param_.device_id, 0) << ")";
+    }
+    return;
+#else
+    LOG(FATAL) << "ImageRecordIter2: gpu_decode requires MXNet built with USE_NVJPEG";
+#endif
+  }
   // Normalize init
   if (!std::is_same<DType, uint8_t>::value) {
     meanimg_.set_pad(false);
@@ -265,6 +324,11 @@ inline void ImageRecordIOParser2<DType>::Init(
 
 template <typename DType>
 inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+  if (gpu_decoder_ != nullptr) {
+    return ParseNextGPU(out);
+  }
+#endif
   if (overflow) {
     return false;
   }
@@ -314,7 +378,13 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
     // int n_to_copy;
     size_t n_to_out = 0;
     if (n_parsed_ == 0) {
-      if (source_->NextBatch(&chunk, batch_param_.batch_size)) {
+      bool has_chunk;
+      {
+        profiler::IOStageTimer timer(profiler::IOProfiler::kRead);
+        has_chunk = source_->NextBatch(&chunk, batch_param_.batch_size);
+      }
+      if (has_chunk) {
+        profiler::IOProfiler::Get()->AddBytesRead(chunk.size);
         inst_order_.clear();
         inst_index_        = 0;
         DType* data_dptr   = static_cast<DType*>(out->data[0].data().dptr_);
@@ -493,15 +563,33 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
   int err = tjDecompressHeader2(handle, jpeg, jpeg_size, &w, &h, &subsamp);
   if (err != 0) {
     // If it is a malformed JPEG then fall back to OpenCV
+    tjDestroy(handle);
     return cv::imdecode(image, color);
   }
+  // decode at the smallest scale of the DCT which keeps the shorter edge large enough
+  if (jpeg_min_size_ > 0) {
+    int num_factors;
+    const tjscalingfactor* factors = tjGetScalingFactors(&num_factors);
+    int scaled_w = w, scaled_h = h;
+    for (int i = 0; i < num_factors; ++i) {
+      const int factor_w = TJSCALED(w, factors[i]);
+      const int factor_h = TJSCALED(h, factors[i]);
+      if (factors[i].num == 1 && factors[i].denom <= 8 &&
+          std::min(factor_w, factor_h) >= jpeg_min_size_ && factor_w < scaled_w) {
+        scaled_w = factor_w;
+        scaled_h = factor_h;
+      }
+    }
+    w = scaled_w;
+    h = scaled_h;
+  }
   cv::Mat ret = cv::Mat(h, w, color ? CV_8UC3 : CV_8UC1);
   err = tjDecompress2(handle, jpeg, jpeg_size, ret.ptr(), w, 0, h, color ? TJPF_BGR : TJPF_GRAY, 0);
+  tjDestroy(handle);
   if (err != 0) {
     // If it is a malformed JPEG then fall back to OpenCV
     return cv::imdecode(image, color);
   }
-  tjDestroy(handle);
   return ret;
 }
 #endif
@@ -518,6 +606,8 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
   // save opencv out
   dmlc::RecordIOChunkReader reader(*chunk, 0, 1);
   size_t gl_idx = current_size;
+  // the decoding threads are taken from the cores of the OMP teams of the engine workers
+  engine::OpenMP::CoreShare share(param_.preprocess_threads);
 #pragma omp parallel num_threads(param_.preprocess_threads)
   {
     omp_exc_.Run([&] {
@@ -555,6 +645,8 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
           prnds_[tid]->seed(idx + param_.seed_aug.value() + kRandMagic);
         }
 
+        std::unique_ptr<profiler::IOStageTimer> timer(
+            new profiler::IOStageTimer(profiler::IOProfiler::kDecode));
         switch (param_.data_shape[0]) {
           case 1:
 #if MXNET_USE_LIBJPEG_TURBO
@@ -580,22 +672,10 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
             LOG(FATAL) << "Invalid output shape " << param_.data_shape;
         }
         const int n_channels = res.channels();
+        timer.reset(new profiler::IOStageTimer(profiler::IOProfiler::kAugment));
         // load label before augmentations
         std::vector<float> label_buf;
-        if (label_map_ != nullptr) {
-          label_buf = label_map_->FindCopy(rec.image_index());
-        } else if (rec.label != nullptr) {
-          CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
-                                                      << "-dimensional label "
-                                                         "but label_width is set to "
-                                                      << param_.label_width;
-          label_buf.assign(rec.label, rec.label + rec.num_label);
-        } else {
-          CHECK_EQ(param_.label_width, 1)
-              << "label_width must be 1 unless an imglist is provided "
-                 "or the rec file is packed with multi dimensional label";
-          label_buf.assign(&rec.header.label, &rec.header.label + 1);
-        }
+        LoadLabel(rec, &label_buf);
         for (auto& aug : augmenters_[tid]) {
           res = aug->Process(res, &label_buf, prnds_[tid].get());
         }
@@ -648,6 +728,7 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
             label,
             mshadow::Tensor<cpu, 1>(dmlc::BeginPtr(label_buf), mshadow::Shape1(label_buf.size())));
         res.release();
+        timer.reset();
       }
     });
   }
@@ -659,6 +740,163 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
 #endif
 }
 
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::LoadLabel(const ImageRecordIO& rec,
+                                                   std::vector<float>* label_buf) {
+  if (label_map_ != nullptr) {
+    *label_buf = label_map_->FindCopy(rec.image_index());
+  } else if (rec.label != nullptr) {
+    CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
+                                                << "-dimensional label "
+                                                   "but label_width is set to "
+                                                << param_.label_width;
+    label_buf->assign(rec.label, rec.label + rec.num_label);
+  } else {
+    CHECK_EQ(param_.label_width, 1) << "label_width must be 1 unless an imglist is provided "
+                                       "or the rec file is packed with multi dimensional label";
+    label_buf->assign(&rec.header.label, &rec.header.label + 1);
+  }
+}
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG && MXNET_USE_OPENCV
+template <typename DType>
+inline bool ImageRecordIOParser2<DType>::NextGPURecord(dmlc::InputSplit::Blob* blob) {
+  while (chunk_index_ == chunk_records_.size()) {
+    dmlc::InputSplit::Blob chunk;
+    {
+      profiler::IOStageTimer timer(profiler::IOProfiler::kRead);
+      if (!source_->NextBatch(&chunk, batch_param_.batch_size)) {
+        return false;
+      }
+    }
+    profiler::IOProfiler::Get()->AddBytesRead(chunk.size);
+    chunk_records_.clear();
+    split_records_.clear();
+    chunk_index_        = 0;
+    const char* begin   = static_cast<const char*>(chunk.dptr);
+    const char* end     = begin + chunk.size;
+    dmlc::RecordIOChunkReader reader(chunk, 0, 1);
+    dmlc::InputSplit::Blob rec;
+    while (reader.NextRecord(&rec)) {
+      // the records split in several parts are joined in a buffer of the reader
+      if (static_cast<const char*>(rec.dptr) < begin || static_cast<const char*>(rec.dptr) >= end) {
+        split_records_.emplace_back(static_cast<const char*>(rec.dptr), rec.size);
+        rec.dptr = &split_records_.back()[0];
+      }
+      chunk_records_.push_back(rec);
+    }
+    if (legacy_shuffle_) {
+      std::shuffle(chunk_records_.begin(), chunk_records_.end(), rnd_);
+    }
+  }
+  *blob = chunk_records_[chunk_index_++];
+  return true;
+}
+
+template <typename DType>
+inline bool ImageRecordIOParser2<DType>::ParseNextGPU(DataBatch* out) {
+  if (overflow) {
+    return false;
+  }
+  CHECK(source_ != nullptr);
+  const size_t batch_size = batch_param_.batch_size;
+  out->index.resize(batch_size);
+  if (out->data.size() == 0) {
+    out->data.resize(2);
+    unit_size_.resize(2);
+    std::vector<index_t> shape_vec = {static_cast<index_t>(batch_size)};
+    for (index_t dim = 0; dim < param_.data_shape.ndim(); ++dim) {
+      shape_vec.push_back(param_.data_shape[dim]);
+    }
+    mxnet::TShape data_shape(shape_vec.begin(), shape_vec.end());
+    mxnet::TShape label_shape(mshadow::Shape2(batch_size, param_.label_width));
+    const auto ctx = Context::GPU(std::max(param_.device_id, 0));
+    const std::string profiler_scope =
+        profiler::ProfilerScope::Get()->GetCurrentProfilerScope() + "image_io:";
+    out->data.at(0) = NDArray(data_shape, ctx, false, mshadow::DataType<DType>::kFlag);
+    out->data.at(0).AssignStorageInfo(profiler_scope, "data");
+    out->data.at(1) = NDArray(label_shape, ctx, false, mshadow::DataType<real_t>::kFlag);
+    out->data.at(1).AssignStorageInfo(profiler_scope, "label");
+    unit_size_[0] = param_.data_shape.Size();
+    unit_size_[1] = param_.label_width;
+    encoded_.resize(batch_size);
+    cpu_decoded_.resize(batch_size);
+    gpu_labels_.resize(batch_size * param_.label_width);
+  }
+
+  std::vector<GPUDecodeInput> inputs;
+  std::vector<GPUImageAugment> augs;
+  std::vector<float> label_buf;
+  std::uniform_real_distribution<float> rand_uniform(0, 1);
+  std::bernoulli_distribution coin_flip(0.5);
+  common::RANDOM_ENGINE* prnd = prnds_[0].get();
+  out->num_batch_padd         = 0;
+  while (inputs.size() < batch_size) {
+    dmlc::InputSplit::Blob blob;
+    if (!NextGPURecord(&blob)) {
+      if (inputs.empty()) {
+        return false;
+      }
+      CHECK(!overflow) << "number of input images must be bigger than the batch size";
+      out->num_batch_padd = batch_size - inputs.size();
+      if (batch_param_.round_batch != 0) {
+        overflow = true;
+        source_->BeforeFirst();
+        continue;
+      }
+      break;
+    }
+    const size_t i = inputs.size();
+    ImageRecordIO rec;
+    rec.Load(blob.dptr, blob.size);
+    out->index[i] = rec.image_index();
+    encoded_[i].assign(reinterpret_cast<const char*>(rec.content), rec.content_size);
+    LoadLabel(rec, &label_buf);
+    std::copy(label_buf.begin(), label_buf.end(), &gpu_labels_[i * param_.label_width]);
+
+    GPUDecodeInput input;
+    input.data = reinterpret_cast<const uint8_t*>(encoded_[i].data());
+    input.size = encoded_[i].size();
+    input.rgb  = nullptr;
+    if (!gpu_decoder_->GetImageInfo(input.data, input.size, &input.width, &input.height)) {
+      // the images that are not JPEG are decoded with OpenCV
+      cv::Mat buf(1, input.size, CV_8U, const_cast<uint8_t*>(input.data));
+      cv::Mat res = cv::imdecode(buf, 1);
+      CHECK(!res.empty()) << "Invalid image with index " << rec.image_index();
+      cv::cvtColor(res, cpu_decoded_[i], cv::COLOR_BGR2RGB);
+      input.rgb    = cpu_decoded_[i].ptr();
+      input.width  = cpu_decoded_[i].cols;
+      input.height = cpu_decoded_[i].rows;
+    }
+    inputs.push_back(input);
+
+    if (param_.seed_aug.has_value()) {
+      prnd->seed(i + param_.seed_aug.value() + kRandMagic);
+    }
+    GPUImageAugment aug;
+    gpu_sampler_->Sample(input.height, input.width, &aug, prnd);
+    aug.mirror = (normalize_param_.rand_mirror && coin_flip(*prnd)) || normalize_param_.mirror;
+    aug.contrast     = 1;
+    aug.illumination = 0;
+    if (!std::is_same<DType, uint8_t>::value) {
+      aug.contrast = (rand_uniform(*prnd) * normalize_param_.max_random_contrast * 2 -
+                      normalize_param_.max_random_contrast + 1) *
+                     normalize_param_.scale;
+      aug.illumination = (rand_uniform(*prnd) * normalize_param_.max_random_illumination * 2 -
+                          normalize_param_.max_random_illumination) *
+                         normalize_param_.scale;
+    }
+    augs.push_back(aug);
+  }
+
+  const ImageNormalizeParam& p = normalize_param_;
+  GPUNormalize normalize       = {{p.mean_r, p.mean_g, p.mean_b}, {p.std_r, p.std_g, p.std_b}};
+  gpu_decoder_->Process(
+      inputs, augs, normalize, gpu_labels_, out->data[0].data(), out->data[1].data());
+  return true;
+}
+#endif
+
 // create mean image.
 template <typename DType>
 inline void ImageRecordIOParser2<DType>::CreateMeanImg() {
@@ -831,6 +1069,8 @@ class ImageRecordIter2Wrapper : public IIterator<DataBatch> {
   void Init(const std::vector<std::pair<std::string, std::string>>& kwargs) override {
     PrefetcherParam prefetch_param;
     prefetch_param.InitAllowUnknown(kwargs);
+    CHECK_EQ(prefetch_param.prefetch_device_id, -1)
+        << "ImageRecordIter does not support prefetch_device_id, set gpu_decode instead";
     int dtype = mshadow::kFloat32;
     if (prefetch_param.dtype.has_value()) {
       dtype = prefetch_param.dtype.value();
@@ -918,6 +1158,7 @@ Example::
     .add_arguments(PrefetcherParam::__FIELDS__())
     .add_arguments(ListDefaultAugParams())
     .add_arguments(ImageNormalizeParam::__FIELDS__())
+    .add_arguments(ImageRecGPUParam::__FIELDS__())
     .set_body([]() { return new ImageRecordIter2Wrapper(); });
 
 MXNET_REGISTER_IO_ITER(ImageRecordUInt8Iter)
@@ -28,6 +28,7 @@
 #include <dmlc/data.h>
 #include "./iter_sparse_prefetcher.h"
 #include "./iter_sparse_batchloader.h"
+#include "./text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -45,6 +46,10 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   int num_parts;
   /*! \brief the index of the part will read*/
   int part_index;
+  /*! \brief number of threads parsing a chunk */
+  int num_parse_threads;
+  /*! \brief number of parsed chunks queued ahead */
+  int parse_prefetch;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LibSVMIterParam) {
     DMLC_DECLARE_FIELD(data_libsvm)
@@ -61,6 +66,18 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
         .describe("The shape of one label.");
     DMLC_DECLARE_FIELD(num_parts).set_default(1).describe("partition the data into multiple parts");
     DMLC_DECLARE_FIELD(part_index).set_default(0).describe("the index of the part will read");
+    DMLC_DECLARE_FIELD(num_parse_threads)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "If positive, the chunks of the files are parsed by num_parse_threads threads "
+            "each instead of the two threads of the dmlc parser.");
+    DMLC_DECLARE_FIELD(parse_prefetch)
+        .set_default(2)
+        .set_lower_bound(1)
+        .describe(
+            "Number of parsed chunks queued ahead of the batch loader. "
+            "Only used when num_parse_threads is positive.");
   }
 };
 
@@ -75,11 +92,9 @@ class LibSVMIter : public SparseIIterator<DataInst> {
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(
-        param_.data_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+    data_parser_.reset(CreateParser(param_.data_libsvm));
     if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(
-          param_.label_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+      label_parser_.reset(CreateParser(param_.label_libsvm));
       CHECK_GT(param_.label_shape.Size(), 1)
           << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
@@ -161,6 +176,18 @@ class LibSVMIter : public SparseIIterator<DataInst> {
   }
 
  private:
+  dmlc::Parser<uint64_t>* CreateParser(const std::string& uri) {
+    if (param_.num_parse_threads > 0) {
+      return new LibSVMChunkParser<uint64_t>(uri,
+                                             param_.part_index,
+                                             param_.num_parts,
+                                             param_.num_parse_threads,
+                                             param_.parse_prefetch);
+    }
+    return dmlc::Parser<uint64_t>::Create(
+        uri.c_str(), param_.part_index, param_.num_parts, "libsvm");
+  }
+
   inline TBlob AsDataBlob(const dmlc::Row<uint64_t>& row) {
     const real_t* ptr = row.value;
     mxnet::TShape shape(mshadow::Shape1(row.length));
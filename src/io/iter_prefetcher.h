@@ -37,8 +37,10 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include "./inst_vector.h"
 #include "./image_iter_common.h"
+#include "../profiler/io_profiler.h"
 
 namespace mxnet {
 namespace io {
@@ -63,6 +65,9 @@ class PrefetcherIter : public IIterator<DataBatch> {
     // init image rec param
     kwargs_left = param_.InitAllowUnknown(kwargs);
     CHECK_GT(param_.prefetch_buffer, 0) << "Prefetch_buffer must be positive number";
+#if !MXNET_USE_CUDA
+    CHECK_EQ(param_.prefetch_device_id, -1) << "prefetch_device_id requires MXNet built with CUDA";
+#endif  // MXNET_USE_CUDA
     // maximum prefetch threaded iter internal size
     const int kMaxPrefetchBuffer = 16;
     // init thread iter
@@ -111,6 +116,8 @@ class PrefetcherIter : public IIterator<DataBatch> {
             std::copy(
                 batch.inst_index, batch.inst_index + batch.batch_size, (*dptr)->index.begin());
           }
+          profiler::IOProfiler::Get()->SetQueueDepth(profiler::IOProfiler::kPrefetchQueue,
+                                                     ++queue_depth_);
           return true;
         },
         [this]() {
@@ -121,6 +128,8 @@ class PrefetcherIter : public IIterator<DataBatch> {
 
   virtual void BeforeFirst(void) {
     iter.BeforeFirst();
+    queue_depth_    = 0;
+    device_started_ = false;
   }
 
   virtual int64_t GetLenHint(void) const {
@@ -128,6 +137,30 @@ class PrefetcherIter : public IIterator<DataBatch> {
   }
 
   virtual bool Next(void) {
+    if (param_.prefetch_device_id < 0) {
+      return NextHost();
+    }
+    // the batch copied ahead becomes the current batch, and the copy of the next one starts
+    if (!device_started_) {
+      device_started_ = true;
+      device_valid_   = CopyToDevice(&device_batches_[1 - device_cur_]);
+    }
+    if (!device_valid_)
+      return false;
+    device_cur_   = 1 - device_cur_;
+    device_valid_ = CopyToDevice(&device_batches_[1 - device_cur_]);
+    return true;
+  }
+  virtual const DataBatch& Value(void) const {
+    if (param_.prefetch_device_id >= 0) {
+      return device_batches_[device_cur_];
+    }
+    return *out_;
+  }
+
+ protected:
+  /*! \brief move to the next host batch */
+  bool NextHost() {
     if (out_ != nullptr) {
       recycle_queue_.push(out_);
       out_ = nullptr;
@@ -142,13 +175,40 @@ class PrefetcherIter : public IIterator<DataBatch> {
       recycle_queue_.pop();
       iter.Recycle(&old_batch);
     }
-    return iter.Next(&out_);
+    profiler::IOStageTimer timer(profiler::IOProfiler::kConsumerWait);
+    if (!iter.Next(&out_))
+      return false;
+    profiler::IOProfiler::Get()->SetQueueDepth(profiler::IOProfiler::kPrefetchQueue,
+                                               --queue_depth_);
+    return true;
   }
-  virtual const DataBatch& Value(void) const {
-    return *out_;
+
+  /*!
+   * \brief copy the next host batch into the double buffered batch on the GPU, asynchronously
+   *  on the copy workers of the engine, the host batch is only recycled once copied
+   * \return false if there is no next batch
+   */
+  bool CopyToDevice(DataBatch* dev) {
+    if (!NextHost())
+      return false;
+    const Context ctx = Context::GPU(param_.prefetch_device_id);
+    dev->data.resize(out_->data.size());
+    for (size_t i = 0; i < out_->data.size(); ++i) {
+      const NDArray& src = out_->data[i];
+      NDArray& dst       = dev->data[i];
+      if (dst.is_none() || dst.storage_type() != src.storage_type() ||
+          dst.dtype() != src.dtype() || dst.shape() != src.shape()) {
+        dst = src.storage_type() == kDefaultStorage
+                  ? NDArray(src.shape(), ctx, true, src.dtype())
+                  : NDArray(src.storage_type(), src.shape(), ctx, true, src.dtype());
+      }
+      CopyFromTo(src, &dst, 0);
+    }
+    dev->index          = out_->index;
+    dev->num_batch_padd = out_->num_batch_padd;
+    return true;
   }
 
- protected:
   /*! \brief prefetcher parameters */
   PrefetcherParam param_;
   /*! \brief backend thread */
@@ -163,6 +223,14 @@ class PrefetcherIter : public IIterator<DataBatch> {
   std::queue<DataBatch*> recycle_queue_;
   /*! \brief size hint cache */
   int64_t length_hint_;
+  /*! \brief number of batches prefetched and not returned yet */
+  std::atomic<uint64_t> queue_depth_{0};
+  /*! \brief batches on the GPU, the current one and the one copied ahead */
+  DataBatch device_batches_[2];
+  int device_cur_{0};
+  /*! \brief whether the first batch has been copied, and whether the next one exists */
+  bool device_started_{false};
+  bool device_valid_{false};
 };
 }  // namespace io
 }  // namespace mxnet
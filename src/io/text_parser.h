@@ -0,0 +1,368 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file text_parser.h
+ * \brief parsers of the chunks of the CSV and LibSVM files over a configurable number of
+ *  threads, with a prefetch queue of parsed chunks
+ */
+#ifndef MXNET_IO_TEXT_PARSER_H_
+#define MXNET_IO_TEXT_PARSER_H_
+
+#include <dmlc/data.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <dmlc/threadediter.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief parse a number at p, without the validation and locale handling of strtod for the
+ *  common decimal notations
+ * \return the end of the number, p if there is none
+ */
+template <typename DType>
+inline const char* ParseNumber(const char* p, const char* end, DType* out) {
+  const char* begin = p;
+  bool negative     = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (std::is_integral<DType>::value) {
+    if (digits == 0 || (negative && std::is_unsigned<DType>::value))
+      return begin;
+    const int64_t value = static_cast<int64_t>(mantissa);
+    *out                = static_cast<DType>(negative ? -value : value);
+    return p;
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p, ++digits, --exponent) {
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+  if (p != end && (*p == 'e' || *p == 'E') && digits > 0) {
+    int exp_value = 0;
+    const char* q = ParseNumber(p + 1, end, &exp_value);
+    if (q != p + 1) {
+      exponent += exp_value;
+      p = q;
+    }
+  }
+  // the mantissa and the power of ten are exact in double
+  static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if (digits > 0 && digits <= 15 && exponent >= -22 && exponent <= 22) {
+    double value = static_cast<double>(mantissa);
+    value        = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+    *out         = static_cast<DType>(negative ? -value : value);
+    return p;
+  }
+  // long mantissas, large exponents, inf and nan
+  char buf[64];
+  size_t len = 0;
+  while (begin + len != end && len + 1 < sizeof(buf) && begin[len] != ' ' && begin[len] != '\t' &&
+         begin[len] != ',' && begin[len] != ':' && begin[len] != '\n' && begin[len] != '\r') {
+    buf[len] = begin[len];
+    ++len;
+  }
+  buf[len] = '\0';
+  char* stop;
+  const double value = std::strtod(buf, &stop);
+  if (stop == buf)
+    return begin;
+  *out = static_cast<DType>(value);
+  return begin + (stop - buf);
+}
+
+/*! \brief rows parsed from a part of a chunk */
+template <typename IndexType, typename DType>
+struct ParsedRows {
+  std::vector<size_t> offset{0};
+  std::vector<DType> label;
+  std::vector<IndexType> index;
+  std::vector<DType> value;
+
+  void Clear() {
+    offset.resize(1);
+    label.clear();
+    index.clear();
+    value.clear();
+  }
+  size_t Size() const {
+    return label.size();
+  }
+  dmlc::RowBlock<IndexType, DType> GetBlock() const {
+    dmlc::RowBlock<IndexType, DType> block;
+    block.size   = Size();
+    block.offset = offset.data();
+    block.label  = label.data();
+    block.weight = nullptr;
+    block.qid    = nullptr;
+    block.field  = nullptr;
+    block.index  = index.data();
+    block.value  = value.data();
+    return block;
+  }
+};
+
+/*!
+ * \brief Parser of a text file of one row per line. The chunks of the file are read and
+ *  parsed by a producer thread, splitting every chunk at line boundaries over num_threads
+ *  OMP threads, and up to prefetch parsed chunks are queued ahead of the consumer.
+ * \tparam LineParser parses the lines of a range of the chunk with its static Parse
+ */
+template <typename IndexType, typename DType, typename LineParser>
+class TextChunkParser : public dmlc::Parser<IndexType, DType> {
+ public:
+  TextChunkParser(const std::string& uri,
+                  unsigned part_index,
+                  unsigned num_parts,
+                  int num_threads,
+                  int prefetch)
+      : source_(dmlc::InputSplit::Create(uri.c_str(), part_index, num_parts, "text")),
+        num_threads_(std::max(num_threads, 1)),
+        parts_(num_threads_) {
+    iter_.set_max_capacity(std::max(prefetch, 1));
+    iter_.Init(
+        [this](ParsedRows<IndexType, DType>** dptr) {
+          dmlc::InputSplit::Blob chunk;
+          if (!source_->NextChunk(&chunk))
+            return false;
+          if (*dptr == nullptr)
+            *dptr = new ParsedRows<IndexType, DType>();
+          bytes_read_ += chunk.size;
+          ParseChunk(static_cast<const char*>(chunk.dptr), chunk.size, *dptr);
+          return true;
+        },
+        [this]() { source_->BeforeFirst(); });
+  }
+
+  ~TextChunkParser() override {
+    iter_.Destroy();
+  }
+
+  void BeforeFirst() override {
+    if (out_ != nullptr) {
+      iter_.Recycle(&out_);
+    }
+    iter_.BeforeFirst();
+    bytes_read_ = 0;
+  }
+
+  bool Next() override {
+    while (true) {
+      if (out_ != nullptr) {
+        iter_.Recycle(&out_);
+      }
+      if (!iter_.Next(&out_))
+        return false;
+      if (out_->Size() != 0) {
+        block_ = out_->GetBlock();
+        return true;
+      }
+    }
+  }
+
+  const dmlc::RowBlock<IndexType, DType>& Value() const override {
+    return block_;
+  }
+
+  size_t BytesRead() const override {
+    return bytes_read_;
+  }
+
+ private:
+  void ParseChunk(const char* data, size_t size, ParsedRows<IndexType, DType>* out) {
+    const char* end = data + size;
+    // split the chunk into equal parts, moved to the start of the next line
+    std::vector<const char*> bounds(num_threads_ + 1, end);
+    bounds[0] = data;
+    for (int i = 1; i < num_threads_; ++i) {
+      const char* p = std::max(bounds[i - 1], data + size * i / num_threads_);
+      if (p != data && p != end) {
+        const void* eol = std::memchr(p - 1, '\n', end - p + 1);
+        p               = eol == nullptr ? end : static_cast<const char*>(eol) + 1;
+      }
+      bounds[i] = p;
+    }
+    dmlc::OMPException omp_exc;
+#pragma omp parallel for num_threads(num_threads_)
+    for (int i = 0; i < num_threads_; ++i) {
+      omp_exc.Run([&] {
+        parts_[i].Clear();
+        LineParser::Parse(bounds[i], bounds[i + 1], &parts_[i]);
+      });
+    }
+    omp_exc.Rethrow();
+    // concatenate the parts
+    size_t num_rows = 0, num_values = 0;
+    std::vector<size_t> row_start(num_threads_), value_start(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+      row_start[i]   = num_rows;
+      value_start[i] = num_values;
+      num_rows += parts_[i].Size();
+      num_values += parts_[i].value.size();
+    }
+    out->offset.resize(num_rows + 1);
+    out->label.resize(num_rows);
+    out->index.resize(num_values);
+    out->value.resize(num_values);
+    out->offset[num_rows] = num_values;
+#pragma omp parallel for num_threads(num_threads_)
+    for (int i = 0; i < num_threads_; ++i) {
+      const auto& part = parts_[i];
+      for (size_t r = 0; r < part.Size(); ++r) {
+        out->offset[row_start[i] + r] = value_start[i] + part.offset[r];
+      }
+      std::copy(part.label.begin(), part.label.end(), out->label.begin() + row_start[i]);
+      std::copy(part.index.begin(), part.index.end(), out->index.begin() + value_start[i]);
+      std::copy(part.value.begin(), part.value.end(), out->value.begin() + value_start[i]);
+    }
+  }
+
+  std::unique_ptr<dmlc::InputSplit> source_;
+  int num_threads_;
+  /*! \brief rows parsed by every thread */
+  std::vector<ParsedRows<IndexType, DType> > parts_;
+  dmlc::ThreadedIter<ParsedRows<IndexType, DType> > iter_;
+  ParsedRows<IndexType, DType>* out_{nullptr};
+  dmlc::RowBlock<IndexType, DType> block_;
+  size_t bytes_read_{0};
+};
+
+inline bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*!
+ * \brief parser of the zero-based LibSVM format, label[:weight] [qid:id] index:value ...,
+ *  the weights and query ids are skipped
+ */
+struct LibSVMLineParser {
+  template <typename IndexType, typename DType>
+  static void Parse(const char* begin, const char* end, ParsedRows<IndexType, DType>* out) {
+    const char* p = begin;
+    while (p != end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      eol             = eol == nullptr ? end : eol;
+      while (p != eol && IsBlank(*p))
+        ++p;
+      if (p == eol || *p == '#') {
+        p = eol == end ? end : eol + 1;
+        continue;
+      }
+      DType label;
+      const char* q = ParseNumber(p, eol, &label);
+      CHECK(q != p) << "Invalid LibSVM label: " << std::string(p, eol);
+      p = q;
+      if (p != eol && *p == ':') {
+        real_t weight;
+        p = ParseNumber(p + 1, eol, &weight);
+      }
+      out->label.push_back(label);
+      while (true) {
+        while (p != eol && IsBlank(*p))
+          ++p;
+        if (p == eol || *p == '#')
+          break;
+        if (eol - p > 4 && std::strncmp(p, "qid:", 4) == 0) {
+          uint64_t qid;
+          p = ParseNumber(p + 4, eol, &qid);
+          continue;
+        }
+        uint64_t index;
+        DType value;
+        q = ParseNumber(p, eol, &index);
+        CHECK(q != p && q != eol && *q == ':') << "Invalid LibSVM feature: " << std::string(p, eol);
+        p = ParseNumber(q + 1, eol, &value);
+        CHECK(p != q + 1) << "Invalid LibSVM value: " << std::string(q, eol);
+        out->index.push_back(static_cast<IndexType>(index));
+        out->value.push_back(value);
+      }
+      out->offset.push_back(out->index.size());
+      p = eol == end ? end : eol + 1;
+    }
+  }
+};
+
+/*! \brief parser of the CSV format without label column, the labels are 0 */
+struct CSVLineParser {
+  template <typename IndexType, typename DType>
+  static void Parse(const char* begin, const char* end, ParsedRows<IndexType, DType>* out) {
+    const char* p = begin;
+    while (p != end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      eol             = eol == nullptr ? end : eol;
+      const char* q   = p;
+      while (q != eol && IsBlank(*q))
+        ++q;
+      if (q == eol) {
+        p = eol == end ? end : eol + 1;
+        continue;
+      }
+      IndexType column = 0;
+      while (p != eol) {
+        while (p != eol && IsBlank(*p))
+          ++p;
+        DType value = 0;
+        q           = ParseNumber(p, eol, &value);
+        p           = q;
+        while (p != eol && IsBlank(*p))
+          ++p;
+        CHECK(p == eol || *p == ',') << "Invalid CSV value: " << std::string(q, eol);
+        out->index.push_back(column++);
+        out->value.push_back(value);
+        if (p != eol)
+          ++p;
+      }
+      out->label.push_back(0);
+      out->offset.push_back(out->index.size());
+      p = eol == end ? end : eol + 1;
+    }
+  }
+};
+
+template <typename IndexType, typename DType = real_t>
+using LibSVMChunkParser = TextChunkParser<IndexType, DType, LibSVMLineParser>;
+
+template <typename IndexType, typename DType = real_t>
+using CSVChunkParser = TextChunkParser<IndexType, DType, CSVLineParser>;
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_TEXT_PARSER_H_
@@ -32,7 +32,10 @@
 #include "../ndarray/ndarray_function.h"
 #include "../operator/tensor/sparse_retain-inl.h"
 #include "../profiler/profiler.h"
+#include "../common/numa.h"
+#include "../engine/openmp.h"
 #include "./kvstore_utils.h"
+#include "./reduce_sum_cpu.h"
 namespace mxnet {
 namespace kvstore {
 /**
@@ -104,7 +107,8 @@ class Comm {
 class CommCPU : public Comm {
  public:
   CommCPU() {
-    nthread_reduction_ = dmlc::GetEnv("MXNET_KVSTORE_REDUCTION_NTHREADS", 4);
+    // 0 sizes the threads of each reduction to its bytes, up to the recommended OMP threads
+    nthread_reduction_ = dmlc::GetEnv("MXNET_KVSTORE_REDUCTION_NTHREADS", 0);
     bigarray_bound_    = dmlc::GetEnv("MXNET_KVSTORE_BIGARRAY_BOUND", 1000 * 1000);
     // TODO(junwu) delete the following data member, now for benchmark only
     is_serial_push_ = dmlc::GetEnv("MXNET_KVSTORE_SERIAL_PUSH", 0);
@@ -143,35 +147,61 @@ class CommCPU : public Comm {
     NDArray& buf_merged = buf.merged_buf(stype);
     // normal dense reduce
     if (stype == kDefaultStorage) {
-      std::vector<Engine::VarHandle> const_vars(src.size() - 1);
+      // the CPU arrays are summed where they are, the others are copied to pinned buffers,
+      // the first one to the merged buffer
+      std::vector<Engine::VarHandle> const_vars;
       std::vector<NDArray> reduce(src.size());
-      CopyFromTo(src[0], &buf_merged, priority);
-      reduce[0] = buf_merged;
-
-      if (buf.copy_buf.empty()) {
+      std::vector<int> in_nodes(src.size(), -1);
+      if (buf.copy_buf.empty())
         buf.copy_buf.resize(src.size() - 1);
-        for (size_t j = 0; j < src.size() - 1; ++j) {
-          // allocate copy buffer
-          buf.copy_buf[j] = NDArray(src[0].shape(), pinned_ctx_, false, src[0].dtype());
+      for (size_t i = 0; i < src.size(); ++i) {
+        if (src[i].ctx().dev_mask() == cpu::kDevMask) {
+          reduce[i] = src[i];
+          if (common::numa::Enabled() && src[i].ctx().dev_type == Context::kCPU)
+            in_nodes[i] = common::numa::NodeOfDevice(src[i].ctx().dev_id);
+        } else if (i == 0) {
+          CopyFromTo(src[0], &buf_merged, priority);
+          reduce[0] = buf_merged;
+          continue;
+        } else {
+          NDArray& copy = buf.copy_buf[i - 1];
+          if (copy.is_none())
+            copy = NDArray(src[0].shape(), pinned_ctx_, false, src[0].dtype());
+          CHECK(stype == copy.storage_type())
+              << "Storage type mismatch detected. " << stype << "(src) vs. "
+              << copy.storage_type() << "(buf.copy_buf)";
+          CopyFromTo(src[i], &copy, priority);
+          reduce[i] = copy;
         }
+        const_vars.push_back(reduce[i].var());
       }
-      CHECK(stype == buf.copy_buf[0].storage_type())
-          << "Storage type mismatch detected. " << stype << "(src) vs. "
-          << buf.copy_buf[0].storage_type() << "(buf.copy_buf)";
-      for (size_t i = 1; i < src.size(); ++i) {
-        CopyFromTo(src[i], &(buf.copy_buf[i - 1]), priority);
-        reduce[i]         = buf.copy_buf[i - 1];
-        const_vars[i - 1] = reduce[i].var();
+      std::sort(const_vars.begin(), const_vars.end());
+      const_vars.erase(std::unique(const_vars.begin(), const_vars.end()), const_vars.end());
+      // the partial sums of the nodes with two inputs or more
+      std::vector<NDArray> partials;
+      std::vector<Engine::VarHandle> mutate_vars = {buf_merged.var()};
+      for (int node = 0; common::numa::Enabled() && node < common::numa::NumNodes(); ++node) {
+        if (std::count(in_nodes.begin(), in_nodes.end(), node) < 2)
+          continue;
+        if (buf.numa_partials.size() <= static_cast<size_t>(node))
+          buf.numa_partials.resize(node + 1);
+        NDArray& partial = buf.numa_partials[node];
+        if (partial.is_none())
+          partial = NDArray(src[0].shape(), Context::CPU(node), false, src[0].dtype());
+        partials.resize(node + 1);
+        partials[node] = partial;
+        mutate_vars.push_back(partial.var());
       }
 
       Engine::Get()->PushAsync(
-          [reduce, this](RunContext rctx, Engine::CallbackOnComplete on_complete) {
-            ReduceSumCPU(reduce);
+          [reduce, in_nodes, buf_merged, partials, this](RunContext rctx,
+                                                         Engine::CallbackOnComplete on_complete) {
+            ReduceSumCPU(reduce, in_nodes, buf_merged, partials);
             on_complete();
           },
           Context::CPU(),
           const_vars,
-          {reduce[0].var()},
+          mutate_vars,
           FnProperty::kCPUPrioritized,
           priority,
           "KVStoreReduce");
@@ -198,6 +228,9 @@ class CommCPU : public Comm {
       }
       Resource rsc = ResourceManager::Get()->Request(buf_merged.ctx(),
                                                      ResourceRequest(ResourceRequest::kTempSpace));
+      std::vector<Engine::VarHandle> mutate_vars = {buf_merged.var()};
+      if (rsc.var != nullptr)
+        mutate_vars.push_back(rsc.var);
       Engine::Get()->PushAsync(
           [reduce, buf_merged, rsc, this](RunContext rctx, Engine::CallbackOnComplete on_complete) {
             NDArray out = buf_merged;
@@ -208,7 +241,7 @@ class CommCPU : public Comm {
           },
           Context::CPU(),
           const_vars,
-          {buf_merged.var(), rsc.var},
+          mutate_vars,
           FnProperty::kCPUPrioritized,
           priority,
           "KVStoreReduce");
@@ -290,18 +323,34 @@ class CommCPU : public Comm {
   }
 
  private:
-  // reduce sum into val[0]
-  inline void ReduceSumCPU(const std::vector<NDArray>& in_data) {
-    MSHADOW_TYPE_SWITCH(in_data[0].dtype(), DType, {
-      std::vector<DType*> dptr(in_data.size());
-      for (size_t i = 0; i < in_data.size(); ++i) {
-        TBlob data = in_data[i].data();
-        CHECK(data.CheckContiguous());
-        dptr[i] = data.FlatTo2D<cpu, DType>().dptr_;
-      }
-      size_t total = in_data[0].shape().Size();
-      ReduceSumCPUImpl(dptr, total);
-    });
+  // reduce sum of in_data, on the NUMA nodes in_nodes, into out, which may be in_data[0]
+  inline void ReduceSumCPU(const std::vector<NDArray>& in_data,
+                           const std::vector<int>& in_nodes,
+                           const NDArray& out,
+                           const std::vector<NDArray>& partials) {
+    std::vector<NDArray> arrays(in_data);
+    ReduceSumArgs args;
+    for (NDArray& arr : arrays) {
+#if MXNET_USE_ONEDNN == 1
+      if (arr.IsMKLDNNData())
+        arr = arr.Reorder2Default();
+#endif
+      TBlob data = arr.data();
+      CHECK(data.CheckContiguous());
+      args.in.push_back(data.dptr_);
+    }
+    args.in_nodes = in_nodes;
+    for (const NDArray& partial : partials)
+      args.partials.push_back(partial.is_none() ? nullptr : partial.data().dptr_);
+    args.out               = out.data().dptr_;
+    args.out_node          = -1;
+    args.size              = out.shape().Size();
+    args.dtype             = out.dtype();
+    args.min_parallel_size = bigarray_bound_;
+    args.max_threads       = nthread_reduction_ > 0
+                                 ? nthread_reduction_
+                                 : engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    kvstore::ReduceSumCPU(args);
   }
 
   // serial implementation of reduce sum for row sparse NDArray.
@@ -377,67 +426,14 @@ class CommCPU : public Comm {
     });
   }
 
-  template <typename DType>
-  inline static void ReduceSumCPU(const std::vector<DType*>& dptr, size_t offset, index_t size) {
-    using namespace mshadow;  // NOLINT(*)
-    Tensor<cpu, 1, DType> in_0(dptr[0] + offset, Shape1(size));
-    for (size_t i = 1; i < dptr.size(); i += 4) {
-      switch (dptr.size() - i) {
-        case 1: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          in_0 += in_1;
-          break;
-        }
-        case 2: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          in_0 += in_1 + in_2;
-          break;
-        }
-        case 3: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3;
-          break;
-        }
-        default: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_4(dptr[i + 3] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3 + in_4;
-          break;
-        }
-      }
-    }
-  }
-
-  template <typename DType>
-  inline void ReduceSumCPUImpl(std::vector<DType*> dptr, size_t total) {
-    const size_t step = std::min(bigarray_bound_, static_cast<size_t>(4 << 10));
-    long ntask        = (total + step - 1) / step;  // NOLINT(*)
-    if (total < bigarray_bound_ || nthread_reduction_ <= 1) {
-      ReduceSumCPU(dptr, 0, total);
-    } else {
-#pragma omp parallel for schedule(static) num_threads(nthread_reduction_)
-      for (long j = 0; j < ntask; ++j) {  // NOLINT(*)
-        size_t k     = static_cast<size_t>(j);
-        size_t begin = std::min(k * step, total);
-        size_t end   = std::min((k + 1) * step, total);
-        if (j == ntask - 1)
-          CHECK_EQ(end, total);
-        ReduceSumCPU(dptr, begin, static_cast<index_t>(end - begin));
-      }
-    }
-  }
-
   /// \brief temporal space for pushing and pulling
   struct BufferEntry {
     /// \brief the merged value
     NDArray merged;
     /// \brief the cpu buffer for gpu data
     std::vector<NDArray> copy_buf;
+    /// \brief the partial sums of the inputs by NUMA node
+    std::vector<NDArray> numa_partials;
     /// \brief the merged buffer for the given storage type
     inline NDArray& merged_buf(NDArrayStorageType stype) {
       if (stype == kDefaultStorage) {
@@ -631,17 +627,18 @@ class CommDevice : public Comm {
       // copy to a random device first
       int dev_id = key % dst.size();
       CopyFromTo(src, dst[dev_id], priority);
+      std::vector<NDArray*> others;
       for (size_t i = 0; i < dst.size(); ++i) {
         if (i != static_cast<size_t>(dev_id)) {
-          CopyFromTo(*dst[dev_id], dst[i], priority);
+          others.push_back(dst[i]);
         }
       }
+      BatchCopyFromTo(std::vector<NDArray>(others.size(), *dst[dev_id]), others, priority);
     } else {
       auto& buf_merged = merge_buf_[key].merged_buf(src.storage_type());
       CopyFromTo(src, &buf_merged, priority);
-      for (auto d : dst) {
-        CopyFromTo(buf_merged, d, priority);
-      }
+      // the copies to the GPUs are one operation of the engine
+      BatchCopyFromTo(std::vector<NDArray>(dst.size(), buf_merged), dst, priority);
     }
   }
 
@@ -22,6 +22,10 @@
 #include <dmlc/omp.h>
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
 #include <utility>
 #include <limits>
 #include <vector>
@@ -51,6 +55,8 @@ class CommDeviceTree : public CommDevice {
     gpuarray_bound_     = dmlc::GetEnv("MXNET_KVSTORE_TREE_ARRAY_BOUND", 10000000);
     backtrack_          = dmlc::GetEnv("MXNET_KVSTORE_TREE_BACKTRACK", 0);
     link_usage_penalty_ = dmlc::GetEnv("MXNET_KVSTORE_TREE_LINK_USAGE_PENALTY", 0.7);
+    autotune_           = dmlc::GetEnv("MXNET_KVSTORE_TREE_AUTOTUNE", false);
+    autotune_cache_     = dmlc::GetEnv("MXNET_KVSTORE_TREE_AUTOTUNE_CACHE", std::string());
   }
 
   virtual ~CommDeviceTree() {}
@@ -232,7 +238,7 @@ class CommDeviceTree : public CommDevice {
         }
       } else {
         int root = 0;
-        ReduceInner(key, src, root, 0, priority);
+        ReduceInner(key, src, small_tree_, 0, priority);
 
         TreeBufferEntry& buf = tree_merge_buf_[root][key];
         return buf.merged[0];
@@ -319,8 +325,7 @@ class CommDeviceTree : public CommDevice {
             }
           }
         } else {
-          int root = 0;
-          BroadcastInner(key, src, dst, root, -1, priority);
+          BroadcastInner(key, src, dst, small_tree_, -1, priority);
         }
       } else {
         LOG(FATAL) << "Only dense input supported for now";
@@ -378,16 +383,196 @@ class CommDeviceTree : public CommDevice {
     std::vector<int> p2p_matrix(devs_.size() * devs_.size());
     EnableP2P(&p2p_matrix);
     GetP2PWeight(devs_, p2p_matrix, &link_matrix);
+    depth_ = ComputeDepth(devs_.size());
+    if (autotune_) {
+      AutotuneTrees(link_matrix);
+      return;
+    }
     if (backtrack_)
       LOG(INFO) << "Using Backtracking to generate trees";
     else
       LOG(INFO) << "Using Kernighan-Lin to generate trees";
     ComputeTrees(link_matrix, devs_.size(), link_usage_penalty_, backtrack_, &topology_, &scan_);
-
-    depth_ = ComputeDepth(devs_.size());
 #endif
   }
 
+#if MXNET_USE_CUDA
+  /*! \brief parameters of the generation of the trees */
+  struct TreeParams {
+    bool backtrack;
+    float link_usage_penalty;
+  };
+
+  /**
+   * \brief Chooses the parameters of the trees of the big arrays, reduced over the trees of
+   *  every root, and of the tree of the small arrays, reduced over one tree, by timing
+   *  every candidate. The choice is cached by the fingerprint of the topology of the host.
+   */
+  void AutotuneTrees(const std::vector<float>& link_matrix) {
+    const std::string fingerprint = TopologyFingerprint(link_matrix);
+    TreeParams big, small;
+    if (!ReadAutotuneCache(fingerprint, &big, &small)) {
+      std::vector<TreeParams> candidates;
+      for (const bool backtrack : {false, true}) {
+        for (const float penalty : {0.1f, 0.4f, 0.7f, 1.0f}) {
+          candidates.push_back({backtrack, penalty});
+        }
+      }
+      std::vector<std::vector<size_t>> topo, scan;
+      std::vector<std::vector<std::vector<size_t>>> tried;
+      std::vector<int> all_roots(devs_.size());
+      for (size_t i = 0; i < devs_.size(); ++i) {
+        all_roots[i] = i;
+      }
+      // representative sizes of the arrays of each class, in floats
+      const size_t big_size   = 2 * static_cast<size_t>(gpuarray_bound_);
+      const size_t small_size = std::min<size_t>(1 << 16, gpuarray_bound_);
+      double best_big         = std::numeric_limits<double>::max();
+      double best_small       = std::numeric_limits<double>::max();
+      for (const auto& c : candidates) {
+        ComputeTrees(link_matrix, devs_.size(), c.link_usage_penalty, c.backtrack, &topo, &scan);
+        // different parameters often lead to the same trees
+        if (std::find(tried.begin(), tried.end(), topo) != tried.end())
+          continue;
+        tried.push_back(topo);
+        const double t_big   = BenchmarkTrees(topo, scan, all_roots, big_size);
+        const double t_small = BenchmarkTrees(topo, scan, {0}, small_size);
+        LOG(INFO) << "Trees with backtrack=" << c.backtrack
+                  << " link_usage_penalty=" << c.link_usage_penalty << ": " << t_big
+                  << " ms for big arrays, " << t_small << " ms for small arrays";
+        if (t_big < best_big) {
+          best_big = t_big;
+          big      = c;
+        }
+        if (t_small < best_small) {
+          best_small = t_small;
+          small      = c;
+        }
+      }
+      WriteAutotuneCache(fingerprint, big, small);
+    }
+    LOG(INFO) << "Using trees with backtrack=" << big.backtrack
+              << " link_usage_penalty=" << big.link_usage_penalty << " for big arrays and "
+              << "backtrack=" << small.backtrack
+              << " link_usage_penalty=" << small.link_usage_penalty << " for small arrays";
+    std::vector<std::vector<size_t>> small_topo, small_scan;
+    ComputeTrees(link_matrix,
+                 devs_.size(),
+                 small.link_usage_penalty,
+                 small.backtrack,
+                 &small_topo,
+                 &small_scan);
+    ComputeTrees(
+        link_matrix, devs_.size(), big.link_usage_penalty, big.backtrack, &topology_, &scan_);
+    // the tree of root 0 of the small arrays follows the trees of every root
+    small_tree_ = topology_.size();
+    topology_.push_back(small_topo[0]);
+    scan_.push_back(small_scan[0]);
+  }
+
+  /**
+   * \brief milliseconds of a reduce followed by a broadcast of size floats split over the
+   *  trees of roots, emulated by sums and copies of buffers along the edges of the trees
+   */
+  double BenchmarkTrees(const std::vector<std::vector<size_t>>& topo,
+                        const std::vector<std::vector<size_t>>& scan,
+                        const std::vector<int>& roots,
+                        size_t size) {
+    const mxnet::TShape shape(1, static_cast<dim_t>(std::max<size_t>(size / roots.size(), 1)));
+    std::vector<std::vector<NDArray>> bufs(roots.size()), recv(roots.size());
+    for (size_t r = 0; r < roots.size(); ++r) {
+      for (const auto& ctx : devs_) {
+        bufs[r].emplace_back(shape, ctx, false, mshadow::kFloat32);
+        recv[r].emplace_back(shape, ctx, false, mshadow::kFloat32);
+      }
+    }
+    auto run = [&]() {
+      for (size_t r = 0; r < roots.size(); ++r) {
+        const auto& tree = topo[roots[r]];
+        const auto& lvl  = scan[roots[r]];
+        // the second node of every pair of a level sends to the first, its parent
+        for (int level = depth_; level > 0; --level) {
+          for (size_t j = lvl[level]; j + 1 < lvl[level + 1]; j += kBranch) {
+            if (tree[j] != tree[j + 1]) {
+              CopyFromTo(bufs[r][tree[j + 1]], &recv[r][tree[j]]);
+              bufs[r][tree[j]] += recv[r][tree[j]];
+            }
+          }
+        }
+        for (int level = 1; level <= depth_; ++level) {
+          for (size_t j = lvl[level]; j + 1 < lvl[level + 1]; j += kBranch) {
+            if (tree[j] != tree[j + 1])
+              CopyFromTo(bufs[r][tree[j]], &bufs[r][tree[j + 1]]);
+          }
+        }
+      }
+      for (const auto& b : bufs) {
+        for (const auto& a : b)
+          a.WaitToRead();
+      }
+    };
+    const int kWarmup = 2, kRepeat = 10;
+    for (int i = 0; i < kWarmup; ++i)
+      run();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeat; ++i)
+      run();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kRepeat;
+  }
+
+  /*! \brief identifies the GPUs of the host and the links between them */
+  std::string TopologyFingerprint(const std::vector<float>& link_matrix) {
+    std::ostringstream os;
+    for (const auto& ctx : devs_) {
+      cudaDeviceProp prop;
+      CUDA_CALL(cudaGetDeviceProperties(&prop, ctx.dev_id));
+      os << prop.name << ";";
+    }
+    for (const float w : link_matrix)
+      os << w << ",";
+    os << gpuarray_bound_;
+    std::ostringstream hash;
+    hash << std::hex << std::hash<std::string>()(os.str());
+    return hash.str();
+  }
+
+  bool ReadAutotuneCache(const std::string& fingerprint, TreeParams* big, TreeParams* small) {
+    if (autotune_cache_.empty())
+      return false;
+    std::ifstream is(autotune_cache_);
+    std::string line;
+    while (std::getline(is, line)) {
+      std::istringstream ls(line);
+      std::string key;
+      TreeParams b, s;
+      if ((ls >> key >> b.backtrack >> b.link_usage_penalty >> s.backtrack >>
+           s.link_usage_penalty) &&
+          key == fingerprint) {
+        *big   = b;
+        *small = s;
+        LOG(INFO) << "Read the tree parameters of topology " << fingerprint << " from "
+                  << autotune_cache_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void WriteAutotuneCache(const std::string& fingerprint,
+                          const TreeParams& big,
+                          const TreeParams& small) {
+    if (autotune_cache_.empty())
+      return;
+    std::ofstream os(autotune_cache_, std::ios::app);
+    os << fingerprint << " " << big.backtrack << " " << big.link_usage_penalty << " "
+       << small.backtrack << " " << small.link_usage_penalty << "\n";
+    if (!os)
+      LOG(WARNING) << "Could not write the tree parameters to " << autotune_cache_;
+  }
+#endif
+
   using KeyAttrs = std::tuple<int, mxnet::TShape, int>;
   // try to allocate buff on device evenly
   void InitMergeBufferTree() {
@@ -530,6 +715,12 @@ class CommDeviceTree : public CommDevice {
   int gpuarray_bound_;
   bool backtrack_;
   float link_usage_penalty_;
+  /// \brief whether to choose the trees by timing them, instead of from the parameters above
+  bool autotune_;
+  /// \brief file caching the tree parameters chosen for each topology, if not empty
+  std::string autotune_cache_;
+  /// \brief index in topology_ of the tree reducing the arrays smaller than gpuarray_bound_
+  int small_tree_ = 0;
 
   /// \brief constant for maximum size of recv buffer per GPU
   ///        2: only receive from 1 other GPU
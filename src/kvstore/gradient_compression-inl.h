@@ -26,6 +26,7 @@
 #define MXNET_KVSTORE_GRADIENT_COMPRESSION_INL_H_
 
 #include <vector>
+#include "./gradient_compression.h"
 #include "../operator/mxnet_op.h"
 
 namespace mxnet {
@@ -44,6 +45,30 @@ void Quantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
 void Dequantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
                         const std::vector<mxnet::TBlob>& inputs,
                         const float threshold);
+void QuantizeFP16Impl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const float threshold);
+void DequantizeFP16Impl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const float threshold);
+void QuantizeBF16Impl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const float threshold);
+void DequantizeBF16Impl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const float threshold);
+void QuantizeInt8Impl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const float threshold);
+void DequantizeInt8Impl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const float threshold);
+void QuantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const int block_size);
+void DequantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const int block_size);
 
 struct quantize_1bit {
   MSHADOW_XINLINE static void Map(int out_byte_id,
@@ -232,6 +257,202 @@ void Dequantize2BitKernelLaunch(mshadow::Stream<xpu>* s,
       threshold);               // positive threshold
 }
 
+struct quantize_fp16 {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* grad, float* residual) {
+    using mshadow::half::half_t;
+    const float value                 = residual[i] + grad[i];
+    const half_t quantized            = half_t(value);
+    reinterpret_cast<half_t*>(out)[i] = quantized;
+    // keep the rounding error for the next iteration
+    residual[i] = value - static_cast<float>(quantized);
+  }
+};
+
+struct dequantize_fp16 {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* in) {
+    out[i] = static_cast<float>(reinterpret_cast<mshadow::half::half_t*>(in)[i]);
+  }
+};
+
+template <typename xpu>
+void QuantizeFP16KernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const float threshold) {
+  mxnet::op::mxnet_op::Kernel<quantize_fp16, xpu>::Launch(s,
+                                                          inputs[0].Size(),  // original size
+                                                          inputs[2].dptr<float>(),
+                                                          inputs[0].dptr<float>(),
+                                                          inputs[1].dptr<float>());
+}
+
+template <typename xpu>
+void DequantizeFP16KernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const float threshold) {
+  mxnet::op::mxnet_op::Kernel<dequantize_fp16, xpu>::Launch(
+      s, inputs[1].Size(), inputs[1].dptr<float>(), inputs[0].dptr<float>());
+}
+
+struct quantize_bf16 {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* grad, float* residual) {
+    const float value = residual[i] + grad[i];
+    // round the upper 16 bits of the float to nearest even
+    uint32_t bits                       = *reinterpret_cast<const uint32_t*>(&value);
+    bits                                = (bits + 0x7fff + ((bits >> 16) & 1)) & 0xffff0000;
+    const float quantized               = *reinterpret_cast<const float*>(&bits);
+    reinterpret_cast<uint16_t*>(out)[i] = static_cast<uint16_t>(bits >> 16);
+    residual[i]                         = value - quantized;
+  }
+};
+
+struct dequantize_bf16 {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* in) {
+    const uint32_t bits = static_cast<uint32_t>(reinterpret_cast<uint16_t*>(in)[i]) << 16;
+    out[i]              = *reinterpret_cast<const float*>(&bits);
+  }
+};
+
+template <typename xpu>
+void QuantizeBF16KernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const float threshold) {
+  mxnet::op::mxnet_op::Kernel<quantize_bf16, xpu>::Launch(s,
+                                                          inputs[0].Size(),  // original size
+                                                          inputs[2].dptr<float>(),
+                                                          inputs[0].dptr<float>(),
+                                                          inputs[1].dptr<float>());
+}
+
+template <typename xpu>
+void DequantizeBF16KernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const float threshold) {
+  mxnet::op::mxnet_op::Kernel<dequantize_bf16, xpu>::Launch(
+      s, inputs[1].Size(), inputs[1].dptr<float>(), inputs[0].dptr<float>());
+}
+
+struct quantize_int8 {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* out,
+                                  float* grad,
+                                  float* residual,
+                                  const float threshold) {
+    // values in [-threshold, threshold] are mapped linearly to [-127, 127]
+    const float value      = residual[i] + grad[i];
+    float level            = value / threshold * 127.f;
+    level                  = level > 127.f ? 127.f : (level < -127.f ? -127.f : level);
+    const int8_t quantized = static_cast<int8_t>(level >= 0 ? level + 0.5f : level - 0.5f);
+
+    reinterpret_cast<int8_t*>(out)[i] = quantized;
+    // the clipped part of the value is sent in the next iterations
+    residual[i] = value - quantized * threshold / 127.f;
+  }
+};
+
+struct dequantize_int8 {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* in, const float threshold) {
+    out[i] = reinterpret_cast<int8_t*>(in)[i] * threshold / 127.f;
+  }
+};
+
+template <typename xpu>
+void QuantizeInt8KernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const float threshold) {
+  mxnet::op::mxnet_op::Kernel<quantize_int8, xpu>::Launch(s,
+                                                          inputs[0].Size(),  // original size
+                                                          inputs[2].dptr<float>(),
+                                                          inputs[0].dptr<float>(),
+                                                          inputs[1].dptr<float>(),
+                                                          threshold);
+}
+
+template <typename xpu>
+void DequantizeInt8KernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const float threshold) {
+  mxnet::op::mxnet_op::Kernel<dequantize_int8, xpu>::Launch(
+      s, inputs[1].Size(), inputs[1].dptr<float>(), inputs[0].dptr<float>(), threshold);
+}
+
+/*!
+ * \brief an element kept by the top-k sparsification, its offset in its block and its
+ *  value fit in the 4 bytes of one compressed float
+ */
+struct TopKEntry {
+  uint16_t offset;
+  mshadow::half::half_t value;
+};
+
+struct quantize_topk {
+  MSHADOW_XINLINE static void Map(int block,
+                                  int original_size,
+                                  float* out,
+                                  float* grad,
+                                  float* residual,
+                                  const int block_size) {
+    using mshadow::half::half_t;
+    // each block of block_size values sends its largest accumulated value
+    const int start = block * block_size;
+    const int end   = (start + block_size <= original_size) ? start + block_size : original_size;
+    int best        = start;
+    for (int i = start; i < end; ++i) {
+      residual[i] += grad[i];
+      const float mag      = residual[i] < 0 ? -residual[i] : residual[i];
+      const float best_mag = residual[best] < 0 ? -residual[best] : residual[best];
+      if (mag > best_mag)
+        best = i;
+    }
+    TopKEntry entry;
+    entry.offset = static_cast<uint16_t>(best - start);
+    entry.value  = half_t(residual[best]);
+    residual[best] -= static_cast<float>(entry.value);
+    reinterpret_cast<TopKEntry*>(out)[block] = entry;
+  }
+};
+
+struct dequantize_topk {
+  MSHADOW_XINLINE static void Map(int block,
+                                  int original_size,
+                                  float* out,
+                                  float* in,
+                                  const int block_size) {
+    const int start = block * block_size;
+    const int end   = (start + block_size <= original_size) ? start + block_size : original_size;
+    for (int i = start; i < end; ++i)
+      out[i] = 0;
+    const TopKEntry entry     = reinterpret_cast<TopKEntry*>(in)[block];
+    out[start + entry.offset] = static_cast<float>(entry.value);
+  }
+};
+
+template <typename xpu>
+void QuantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const int block_size) {
+  mxnet::op::mxnet_op::Kernel<quantize_topk, xpu>::Launch(
+      s,
+      (inputs[0].Size() + block_size - 1) / block_size,  // number of blocks
+      inputs[0].Size(),                                  // original size
+      inputs[2].dptr<float>(),                           // compressed array
+      inputs[0].dptr<float>(),                           // original array
+      inputs[1].dptr<float>(),                           // residual array
+      block_size);
+}
+
+template <typename xpu>
+void DequantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const int block_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_topk, xpu>::Launch(
+      s,
+      (inputs[1].Size() + block_size - 1) / block_size,  // number of blocks
+      inputs[1].Size(),                                  // original size
+      inputs[1].dptr<float>(),                           // out array
+      inputs[0].dptr<float>(),                           // compressed array
+      block_size);
+}
+
 inline void Quantize1BitImpl(mshadow::Stream<mshadow::cpu>* s,
                              const std::vector<mxnet::TBlob>& inputs,
                              const float threshold) {
@@ -255,6 +476,122 @@ inline void Dequantize2BitImpl(mshadow::Stream<mshadow::cpu>* s,
                                const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+inline void QuantizeFP16Impl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const float threshold) {
+  QuantizeFP16KernelLaunch(s, inputs, threshold);
+}
+
+inline void DequantizeFP16Impl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const float threshold) {
+  DequantizeFP16KernelLaunch(s, inputs, threshold);
+}
+
+inline void QuantizeBF16Impl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const float threshold) {
+  QuantizeBF16KernelLaunch(s, inputs, threshold);
+}
+
+inline void DequantizeBF16Impl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const float threshold) {
+  DequantizeBF16KernelLaunch(s, inputs, threshold);
+}
+
+inline void QuantizeInt8Impl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const float threshold) {
+  QuantizeInt8KernelLaunch(s, inputs, threshold);
+}
+
+inline void DequantizeInt8Impl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const float threshold) {
+  DequantizeInt8KernelLaunch(s, inputs, threshold);
+}
+
+inline void QuantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+inline void DequantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+/*!
+ * \brief quantizes inputs[0] plus the residual inputs[1] into inputs[2] with type
+ * \param factor compression factor, the block size of the top-k sparsification
+ */
+template <typename xpu>
+void QuantizeImpl(mshadow::Stream<xpu>* s,
+                  const CompressionType type,
+                  const std::vector<mxnet::TBlob>& inputs,
+                  const float threshold,
+                  const int factor) {
+  switch (type) {
+    case CompressionType::kOneBit:
+      Quantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTwoBit:
+      Quantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kFP16:
+      QuantizeFP16Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kBF16:
+      QuantizeBF16Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kInt8:
+      QuantizeInt8Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kTopK:
+      QuantizeTopKImpl(s, inputs, factor);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported quantization of type " << static_cast<int>(type);
+  }
+}
+
+/*!
+ * \brief dequantizes inputs[0] into inputs[1] with type
+ * \param factor compression factor, the block size of the top-k sparsification
+ */
+template <typename xpu>
+void DequantizeImpl(mshadow::Stream<xpu>* s,
+                    const CompressionType type,
+                    const std::vector<mxnet::TBlob>& inputs,
+                    const float threshold,
+                    const int factor) {
+  switch (type) {
+    case CompressionType::kOneBit:
+      Dequantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTwoBit:
+      Dequantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kFP16:
+      DequantizeFP16Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kBF16:
+      DequantizeBF16Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kInt8:
+      DequantizeInt8Impl(s, inputs, threshold);
+      break;
+    case CompressionType::kTopK:
+      DequantizeTopKImpl(s, inputs, factor);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported dequantization of type " << static_cast<int>(type);
+  }
+}
 }  // namespace kvstore
 }  // namespace mxnet
 
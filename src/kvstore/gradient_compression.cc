@@ -46,6 +46,15 @@ void GradientCompression::SetParams(
   } else if (params.type == "2bit") {
     CHECK_GT(params.threshold, 0) << "threshold must be greater than 0 for two bit compression";
     SetTwoBitCompression(params.threshold);
+  } else if (params.type == "fp16") {
+    SetLinearCompression(CompressionType::kFP16, params.threshold);
+  } else if (params.type == "bf16") {
+    SetLinearCompression(CompressionType::kBF16, params.threshold);
+  } else if (params.type == "int8") {
+    CHECK_GT(params.threshold, 0) << "threshold must be greater than 0 for int8 compression";
+    SetLinearCompression(CompressionType::kInt8, params.threshold);
+  } else if (params.type == "topk") {
+    SetTopKCompression(params.block_size);
   } else {
     LOG(FATAL) << "Unknown type for gradient compression " << params.type;
   }
@@ -69,11 +78,22 @@ void GradientCompression::SetTwoBitCompression(const float threshold) {
   threshold_ = threshold;
 }
 
+void GradientCompression::SetLinearCompression(const CompressionType type,
+                                               const float threshold) {
+  type_      = type;
+  threshold_ = threshold;
+}
+
+void GradientCompression::SetTopKCompression(const int block_size) {
+  type_       = CompressionType::kTopK;
+  block_size_ = block_size;
+}
+
 std::string GradientCompression::EncodeParams() {
   using namespace std;  // to reduce length of next line
   string rval = get_type_str();
   if (type_ != CompressionType::kNone) {
-    rval += "," + to_string(threshold_);
+    rval += "," + to_string(threshold_) + "," + to_string(block_size_);
   }
   return rval;
 }
@@ -87,6 +107,9 @@ void GradientCompression::DecodeParams(const std::string& s) {
       threshold_ = stof(elems[1]);
     }
   }
+  if (elems.size() > 2) {
+    block_size_ = stoi(elems[2]);
+  }
 }
 
 int GradientCompression::GetCompressionFactor() {
@@ -94,6 +117,13 @@ int GradientCompression::GetCompressionFactor() {
     return 32;
   } else if (type_ == CompressionType::kTwoBit) {
     return 16;
+  } else if (type_ == CompressionType::kFP16 || type_ == CompressionType::kBF16) {
+    return 2;
+  } else if (type_ == CompressionType::kInt8) {
+    return 4;
+  } else if (type_ == CompressionType::kTopK) {
+    // an offset and a half precision value per block
+    return block_size_;
   } else {
     LOG(FATAL) << "Unsupported compression type: " << get_type_str();
     return 0;
@@ -112,71 +142,40 @@ void GradientCompression::Quantize(const mxnet::NDArray& from,
   CHECK(shape_is_known(from.shape())) << "source operand has undefined shape";
   CHECK(shape_is_known(to->shape())) << "destination operand has undefined shape";
   CHECK(shape_is_known(residual->shape())) << "residual operand has undefined shape";
-  const int a           = from.ctx().dev_mask();
-  const int b           = to->ctx().dev_mask();
-  const float threshold = threshold_;
+  CHECK(type_ != CompressionType::kNone) << "Unsupported quantization of type " << get_type_str();
+  const int a                = from.ctx().dev_mask();
+  const int b                = to->ctx().dev_mask();
+  const CompressionType type = type_;
+  const float threshold      = threshold_;
+  const int factor           = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
-    if (type_ == CompressionType::kOneBit) {
-      mxnet::Engine::Get()->PushSync(
-          [from, to, residual, threshold](mxnet::RunContext ctx) {
-            std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-            Quantize1BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
-          },
-          from.ctx(),
-          {from.var()},
-          {to->var(), residual->var()},
-          mxnet::FnProperty::kNormal,
-          priority,
-          "QuantizeCPU");
-    } else if (type_ == CompressionType::kTwoBit) {
+    mxnet::Engine::Get()->PushSync(
+        [from, to, residual, type, threshold, factor](mxnet::RunContext ctx) {
+          std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+          QuantizeImpl(ctx.get_stream<mshadow::cpu>(), type, inputs, threshold, factor);
+        },
+        from.ctx(),
+        {from.var()},
+        {to->var(), residual->var()},
+        mxnet::FnProperty::kNormal,
+        priority,
+        "QuantizeCPU");
+  } else {
+    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
+#if MXNET_USE_CUDA
       mxnet::Engine::Get()->PushSync(
-          [from, to, residual, threshold](mxnet::RunContext ctx) {
+          [from, to, residual, type, threshold, factor](mxnet::RunContext ctx) {
             std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-            Quantize2BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
+            QuantizeImpl(ctx.get_stream<mshadow::gpu>(), type, inputs, threshold, factor);
+            // Wait GPU kernel to complete
+            ctx.get_stream<mshadow::gpu>()->Wait();
           },
           from.ctx(),
           {from.var()},
           {to->var(), residual->var()},
           mxnet::FnProperty::kNormal,
           priority,
-          "QuantizeCPU");
-    } else {
-      LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
-    }
-  } else {
-    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
-#if MXNET_USE_CUDA
-      if (type_ == CompressionType::kOneBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, residual, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-              Quantize1BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to complete
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var(), residual->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "QuantizeGPU");
-      } else if (type_ == CompressionType::kTwoBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, residual, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
-              Quantize2BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to complete
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var(), residual->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "QuantizeGPU");
-      } else {
-        LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
-      }
+          "QuantizeGPU");
 #else
       LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
 #endif
@@ -191,71 +190,41 @@ void GradientCompression::Dequantize(const mxnet::NDArray& from,
                                      const int priority) {
   CHECK(shape_is_known(from.shape())) << "source operand has undefined shape";
   CHECK(shape_is_known(to->shape())) << "destination operand has undefined shape";
-  const int a           = from.ctx().dev_mask();
-  const int b           = to->ctx().dev_mask();
-  const float threshold = threshold_;
+  CHECK(type_ != CompressionType::kNone)
+      << "Unsupported dequantization of type " << get_type_str();
+  const int a                = from.ctx().dev_mask();
+  const int b                = to->ctx().dev_mask();
+  const CompressionType type = type_;
+  const float threshold      = threshold_;
+  const int factor           = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
-    if (type_ == CompressionType::kOneBit) {
-      mxnet::Engine::Get()->PushSync(
-          [from, to, threshold](mxnet::RunContext ctx) {
-            std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-            Dequantize1BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
-          },
-          from.ctx(),
-          {from.var()},
-          {to->var()},
-          mxnet::FnProperty::kNormal,
-          priority,
-          "DequantizeCPU");
-    } else if (type_ == CompressionType::kTwoBit) {
+    mxnet::Engine::Get()->PushSync(
+        [from, to, type, threshold, factor](mxnet::RunContext ctx) {
+          std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+          DequantizeImpl(ctx.get_stream<mshadow::cpu>(), type, inputs, threshold, factor);
+        },
+        from.ctx(),
+        {from.var()},
+        {to->var()},
+        mxnet::FnProperty::kNormal,
+        priority,
+        "DequantizeCPU");
+  } else {
+    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
+#if MXNET_USE_CUDA
       mxnet::Engine::Get()->PushSync(
-          [from, to, threshold](mxnet::RunContext ctx) {
+          [from, to, type, threshold, factor](mxnet::RunContext ctx) {
             std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-            Dequantize2BitImpl(ctx.get_stream<mshadow::cpu>(), inputs, threshold);
+            DequantizeImpl(ctx.get_stream<mshadow::gpu>(), type, inputs, threshold, factor);
+            // Wait GPU kernel to complete
+            ctx.get_stream<mshadow::gpu>()->Wait();
           },
           from.ctx(),
           {from.var()},
           {to->var()},
           mxnet::FnProperty::kNormal,
           priority,
-          "DequantizeCPU");
-    } else {
-      LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
-    }
-  } else {
-    if (a == mshadow::gpu::kDevMask && b == mshadow::gpu::kDevMask) {
-#if MXNET_USE_CUDA
-      if (type_ == CompressionType::kOneBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-              Dequantize1BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to complete
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "DequantizeGPU");
-      } else if (type_ == CompressionType::kTwoBit) {
-        mxnet::Engine::Get()->PushSync(
-            [from, to, threshold](mxnet::RunContext ctx) {
-              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
-              Dequantize2BitImpl(ctx.get_stream<mshadow::gpu>(), inputs, threshold);
-              // Wait GPU kernel to completes
-              ctx.get_stream<mshadow::gpu>()->Wait();
-            },
-            from.ctx(),
-            {from.var()},
-            {to->var()},
-            mxnet::FnProperty::kNormal,
-            priority,
-            "DequantizeGPU");
-      } else {
-        LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
-      }
+          "DequantizeGPU");
 #else
       LOG(FATAL) << MXNET_GPU_NOT_ENABLED_ERROR;
 #endif
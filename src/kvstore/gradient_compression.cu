@@ -50,5 +50,53 @@ void Dequantize2BitImpl(mshadow::Stream<gpu>* s,
                         const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+void QuantizeFP16Impl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const float threshold) {
+  QuantizeFP16KernelLaunch(s, inputs, threshold);
+}
+
+void DequantizeFP16Impl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const float threshold) {
+  DequantizeFP16KernelLaunch(s, inputs, threshold);
+}
+
+void QuantizeBF16Impl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const float threshold) {
+  QuantizeBF16KernelLaunch(s, inputs, threshold);
+}
+
+void DequantizeBF16Impl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const float threshold) {
+  DequantizeBF16KernelLaunch(s, inputs, threshold);
+}
+
+void QuantizeInt8Impl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const float threshold) {
+  QuantizeInt8KernelLaunch(s, inputs, threshold);
+}
+
+void DequantizeInt8Impl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const float threshold) {
+  DequantizeInt8KernelLaunch(s, inputs, threshold);
+}
+
+void QuantizeTopKImpl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+void DequantizeTopKImpl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
@@ -34,16 +34,23 @@
 namespace mxnet {
 namespace kvstore {
 
-enum class CompressionType { kNone, kOneBit, kTwoBit };
+enum class CompressionType { kNone, kOneBit, kTwoBit, kFP16, kBF16, kInt8, kTopK };
 
 struct GradientCompressionParam : public dmlc::Parameter<GradientCompressionParam> {
   std::string type;
   float threshold;
+  int block_size;
   DMLC_DECLARE_PARAMETER(GradientCompressionParam) {
     DMLC_DECLARE_FIELD(type).describe(
-        "Type of gradient compression to use, like `2bit` for example");
+        "Type of gradient compression to use: `1bit`, `2bit`, `fp16`, `bf16`, `int8` or `topk`");
     DMLC_DECLARE_FIELD(threshold).set_default(0.5).describe(
-        "Threshold to use for 2bit gradient compression");
+        "Threshold to use for 2bit gradient compression, and the largest magnitude sent by "
+        "int8 gradient compression");
+    DMLC_DECLARE_FIELD(block_size)
+        .set_default(32)
+        .set_range(2, 65536)
+        .describe("Number of values of the blocks of topk gradient compression, which sends "
+                  "the largest value of every block");
   }
 };
 
@@ -82,6 +89,19 @@ class GradientCompression {
    */
   void SetTwoBitCompression(const float threshold);
 
+  /*!
+   * \brief sets linear quantization of the gradients to 16 or 8 bits
+   * \param type kFP16, kBF16 or kInt8
+   * \param threshold largest magnitude of the gradients quantized to int8
+   */
+  void SetLinearCompression(const CompressionType type, const float threshold);
+
+  /*!
+   * \brief sets top-k sparsification, sending the largest value of every block
+   * \param block_size number of values of a block
+   */
+  void SetTopKCompression(const int block_size);
+
   /*!
    * \brief encodes parameters of gc into a string
    */
@@ -138,6 +158,11 @@ class GradientCompression {
    * all negative gradients will be thresholded to -1*`threshold_`
    */
   float threshold_ = 0;
+
+  /*!
+   * \brief number of values of a block of the top-k sparsification
+   */
+  int block_size_ = 0;
 };
 }  // namespace kvstore
 }  // namespace mxnet
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hash_embedding.cc
+ * \brief Hash table storage of the rows of the row_sparse keys with a large id space
+ */
+#include "./hash_embedding.h"
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mxnet {
+namespace kvstore {
+
+DMLC_REGISTER_PARAMETER(HashEmbeddingParam);
+
+HashEmbeddingTable::HashEmbeddingTable(int64_t dim, const HashEmbeddingParam& param)
+    : dim_(dim),
+      param_(param),
+      adagrad_(param.optimizer == "adagrad"),
+      slot_ids_(64, kEmpty),
+      slot_rows_(64, kEmpty),
+      rng_(param.seed) {
+  CHECK_GT(dim, 0) << "the rows of a hash embedding must not be empty";
+  CHECK(param.optimizer == "sgd" || param.optimizer == "adagrad")
+      << "Unsupported optimizer " << param.optimizer << " of a hash embedding, "
+      << "expected sgd or adagrad";
+}
+
+size_t HashEmbeddingTable::Find(int64_t id) const {
+  const size_t mask = slot_ids_.size() - 1;
+  size_t slot       = Hash(id) & mask;
+  while (slot_ids_[slot] != kEmpty && slot_ids_[slot] != id) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void HashEmbeddingTable::Grow() {
+  std::vector<int64_t> ids(slot_ids_.size() * 2, kEmpty);
+  std::vector<int64_t> rows(slot_rows_.size() * 2, kEmpty);
+  slot_ids_.swap(ids);
+  slot_rows_.swap(rows);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] != kEmpty) {
+      const size_t slot = Find(ids[i]);
+      slot_ids_[slot]   = ids[i];
+      slot_rows_[slot]  = rows[i];
+    }
+  }
+}
+
+int64_t HashEmbeddingTable::Insert(int64_t id) {
+  if (param_.capacity > 0 && num_rows_ >= static_cast<size_t>(param_.capacity)) {
+    return -1;
+  }
+  // at most 3/4 of the slots are used, the probes stay short
+  if ((num_rows_ + 1) * 4 > slot_ids_.size() * 3) {
+    Grow();
+  }
+  int64_t row;
+  if (!free_rows_.empty()) {
+    row = free_rows_.back();
+    free_rows_.pop_back();
+  } else {
+    row = static_cast<int64_t>(row_ids_.size());
+    row_ids_.push_back(kEmpty);
+    last_update_.push_back(0);
+    values_.resize(values_.size() + dim_);
+    if (adagrad_) {
+      history_.resize(history_.size() + dim_);
+    }
+  }
+  std::uniform_real_distribution<float> init(-param_.init_scale, param_.init_scale);
+  float* value = values_.data() + row * dim_;
+  for (int64_t j = 0; j < dim_; ++j) {
+    value[j] = param_.init_scale > 0 ? init(rng_) : 0.0f;
+  }
+  if (adagrad_) {
+    std::fill_n(history_.data() + row * dim_, dim_, 0.0f);
+  }
+  const size_t slot = Find(id);
+  slot_ids_[slot]   = id;
+  slot_rows_[slot]  = row;
+  row_ids_[row]     = id;
+  ++num_rows_;
+  return row;
+}
+
+void HashEmbeddingTable::Erase(size_t slot) {
+  const size_t mask = slot_ids_.size() - 1;
+  free_rows_.push_back(slot_rows_[slot]);
+  row_ids_[slot_rows_[slot]] = kEmpty;
+  --num_rows_;
+  // backward shift deletion, the ids after the slot move back unless their home slot is
+  // cyclically in (slot, next]
+  size_t next = slot;
+  while (true) {
+    next = (next + 1) & mask;
+    if (slot_ids_[next] == kEmpty) {
+      break;
+    }
+    const size_t home = Hash(slot_ids_[next]) & mask;
+    const bool stays =
+        slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+    if (!stays) {
+      slot_ids_[slot]  = slot_ids_[next];
+      slot_rows_[slot] = slot_rows_[next];
+      slot             = next;
+    }
+  }
+  slot_ids_[slot]  = kEmpty;
+  slot_rows_[slot] = kEmpty;
+}
+
+void HashEmbeddingTable::EvictIdle() {
+  for (size_t row = 0; row < row_ids_.size(); ++row) {
+    if (row_ids_[row] != kEmpty && num_updates_ - last_update_[row] >= param_.max_idle_updates) {
+      Erase(Find(row_ids_[row]));
+    }
+  }
+  pending_.clear();
+}
+
+void HashEmbeddingTable::Pull(const int64_t* ids, size_t n, float* out) const {
+  for (size_t i = 0; i < n; ++i) {
+    const size_t slot = Find(ids[i]);
+    if (slot_ids_[slot] == kEmpty) {
+      std::fill_n(out + i * dim_, dim_, 0.0f);
+    } else {
+      std::memcpy(out + i * dim_, values_.data() + slot_rows_[slot] * dim_, dim_ * sizeof(float));
+    }
+  }
+}
+
+void HashEmbeddingTable::Push(const int64_t* ids, size_t n, const float* grads) {
+  ++num_updates_;
+  const float lr = param_.learning_rate;
+  const float wd = param_.wd;
+  for (size_t i = 0; i < n; ++i) {
+    const size_t slot = Find(ids[i]);
+    int64_t row       = slot_rows_[slot];
+    if (slot_ids_[slot] == kEmpty) {
+      auto it = pending_.find(ids[i]);
+      const int count = it == pending_.end() ? 1 : it->second + 1;
+      if (count < param_.admit_count || (row = Insert(ids[i])) < 0) {
+        pending_[ids[i]] = std::min(count, param_.admit_count);
+        continue;
+      }
+      if (it != pending_.end()) {
+        pending_.erase(it);
+      }
+    }
+    last_update_[row] = num_updates_;
+    float* w          = values_.data() + row * dim_;
+    const float* g    = grads + i * dim_;
+    if (adagrad_) {
+      float* h = history_.data() + row * dim_;
+      for (int64_t j = 0; j < dim_; ++j) {
+        const float grad = g[j] + wd * w[j];
+        h[j] += grad * grad;
+        w[j] -= lr * grad / (std::sqrt(h[j]) + param_.epsilon);
+      }
+    } else {
+      for (int64_t j = 0; j < dim_; ++j) {
+        w[j] -= lr * (g[j] + wd * w[j]);
+      }
+    }
+  }
+  if (param_.max_idle_updates > 0 && num_updates_ % param_.max_idle_updates == 0) {
+    EvictIdle();
+  }
+}
+
+}  // namespace kvstore
+}  // namespace mxnet
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hash_embedding.h
+ * \brief Hash table storage of the rows of the row_sparse keys with a large id space
+ */
+#ifndef MXNET_KVSTORE_HASH_EMBEDDING_H_
+#define MXNET_KVSTORE_HASH_EMBEDDING_H_
+#include <dmlc/parameter.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+struct HashEmbeddingParam : public dmlc::Parameter<HashEmbeddingParam> {
+  std::string optimizer;
+  float learning_rate;
+  float wd;
+  float epsilon;
+  float init_scale;
+  int admit_count;
+  int64_t max_idle_updates;
+  int64_t capacity;
+  int seed;
+  DMLC_DECLARE_PARAMETER(HashEmbeddingParam) {
+    DMLC_DECLARE_FIELD(optimizer)
+        .set_default("sgd")
+        .describe("Update of the pushed rows, `sgd` or `adagrad`");
+    DMLC_DECLARE_FIELD(learning_rate).set_default(0.01f).describe("Learning rate of the updates");
+    DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe("Weight decay of the updated rows");
+    DMLC_DECLARE_FIELD(epsilon)
+        .set_default(1e-7f)
+        .describe("Added to the denominator of the adagrad updates");
+    DMLC_DECLARE_FIELD(init_scale)
+        .set_default(0.01f)
+        .describe("Rows are initialized uniformly in [-init_scale, init_scale] when admitted");
+    DMLC_DECLARE_FIELD(admit_count)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe("Number of pushes of an id before it is given a row. The pulls of the ids "
+                  "without a row return zeros, and their gradients are dropped");
+    DMLC_DECLARE_FIELD(max_idle_updates)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("The rows not pushed in this many pushes of the key are evicted, and the "
+                  "counts of the ids pending admission are reset. 0 never evicts");
+    DMLC_DECLARE_FIELD(capacity)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("Maximum number of rows of a table, the new ids are not admitted when it "
+                  "is full. 0 is unbounded");
+    DMLC_DECLARE_FIELD(seed).set_default(0).describe("Seed of the initialization of the rows");
+  }
+};
+
+/*!
+ * \brief rows of a float32 embedding keyed by 64-bit ids, in an open addressing table with
+ *  linear probing. The memory is proportional to the number of rows admitted, not to the
+ *  id space. Not thread safe, the kvstores access a table from one thread at a time.
+ */
+class HashEmbeddingTable {
+ public:
+  HashEmbeddingTable(int64_t dim, const HashEmbeddingParam& param);
+
+  int64_t dim() const {
+    return dim_;
+  }
+
+  /*! \brief number of rows admitted */
+  size_t size() const {
+    return num_rows_;
+  }
+
+  /*! \brief writes the n x dim rows of ids to out, zeros for the ids without a row */
+  void Pull(const int64_t* ids, size_t n, float* out) const;
+
+  /*!
+   * \brief updates the rows of ids with the n x dim gradients, after admitting the ids
+   *  pushed admit_count times. Then evicts the idle rows every max_idle_updates pushes.
+   */
+  void Push(const int64_t* ids, size_t n, const float* grads);
+
+ private:
+  static constexpr int64_t kEmpty = -1;
+
+  static uint64_t Hash(int64_t id) {
+    // finalizer of splitmix64, the hashed ids of the features are often not uniform
+    uint64_t x = static_cast<uint64_t>(id);
+    x          = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x          = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  /*! \brief the slot holding id, or the empty slot where it is inserted */
+  size_t Find(int64_t id) const;
+  /*! \brief the row of a new id, -1 if the table is full */
+  int64_t Insert(int64_t id);
+  /*! \brief removes the id of a slot, shifting back the ids probed after it */
+  void Erase(size_t slot);
+  void Grow();
+  void EvictIdle();
+
+  const int64_t dim_;
+  const HashEmbeddingParam param_;
+  const bool adagrad_;
+  /*! \brief id and row of every slot, the number of slots is a power of 2 */
+  std::vector<int64_t> slot_ids_;
+  std::vector<int64_t> slot_rows_;
+  size_t num_rows_ = 0;
+  /*! \brief values and adagrad histories of the rows, with the rows freed by the evictions */
+  std::vector<float> values_;
+  std::vector<float> history_;
+  std::vector<int64_t> row_ids_;
+  std::vector<int64_t> last_update_;
+  std::vector<int64_t> free_rows_;
+  /*! \brief number of pushes of the ids pending admission */
+  std::unordered_map<int64_t, int> pending_;
+  int64_t num_updates_ = 0;
+  std::mt19937 rng_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_HASH_EMBEDDING_H_
@@ -33,6 +33,9 @@ std::atomic<int> mxnet::kvstore::KVStoreDist::customer_id_{0};
 #if MXNET_USE_NCCL
 #include "./kvstore_nccl.h"
 #endif  // MXNET_USE_NCCL
+#if MXNET_USE_NCCL && MXNET_USE_DIST_KVSTORE
+#include "./kvstore_dist_nccl_hier.h"
+#endif  // MXNET_USE_NCCL && MXNET_USE_DIST_KVSTORE
 
 #include <cstdlib>
 
@@ -56,6 +59,14 @@ KVStore* KVStore::Create(const char* type_name) {
     if (ps_type == "p3") {
       CHECK(!has("async")) << "Asynchronous update is not supported in P3StoreDist";
       kv = new kvstore::P3StoreDist(use_device_comm);
+    } else if (has("nccl_hier")) {
+#if MXNET_USE_NCCL
+      CHECK(!has("async")) << "Asynchronous update is not supported in " << tname;
+      kv = new kvstore::KVStoreDistNCCLHier();
+#else
+      LOG(FATAL) << "compile with USE_NCCL=1 to use " << tname;
+      return nullptr;
+#endif  // MXNET_USE_NCCL
     } else {
       kv = new kvstore::KVStoreDist(use_device_comm);
     }
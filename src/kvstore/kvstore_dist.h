@@ -184,6 +184,78 @@ class KVStoreDist : public KVStoreLocal {
   std::unordered_map<int, PSKV> ps_kv_;
   std::unordered_map<int, ComprPSKV> compr_ps_kv_;
 
+  /**
+   * \brief reduce the values of key on the local devices, push the result to the servers
+   *  and pull the aggregated value into outs
+   */
+  virtual void PushPullKey(int key,
+                           const std::vector<NDArray>& vals,
+                           const std::vector<NDArray*>& outs,
+                           int priority) {
+    NDArray merged = comm_->Reduce(key, vals, priority);
+
+    const auto push_stype = merged.storage_type();
+    const auto pull_stype = outs[0]->storage_type();
+    CHECK_EQ(push_stype, kDefaultStorage) << "Expected push_stype of value to be kDefaultStorage";
+    CHECK_EQ(pull_stype, kDefaultStorage) << "Expected pull_stype of value to be kDefaultStorage";
+
+    const int push_dtype = merged.dtype();
+    const int pull_dtype = outs[0]->dtype();
+    CHECK_EQ(push_dtype, pull_dtype) << "Output buffer dtype is different";
+
+    auto& comm_buf = comm_buf_[key];
+    if (merged.ctx().dev_mask() == cpu::kDevMask) {
+      comm_buf = merged;  // avoid memory copy
+    } else {
+      if (comm_buf.is_none()) {
+        comm_buf = NDArray(outs[0]->shape(), pinned_ctx_, true, pull_dtype);
+      }
+      CopyFromTo(merged, &comm_buf);
+    }
+
+    CHECK(gradient_compression_->get_type() == CompressionType::kNone)
+        << "Compression not supported with PushPull";
+    PushPullDefault(key, comm_buf, priority);
+    comm_->Broadcast(key, comm_buf, outs, priority);
+  }
+
+  /**
+   * \brief push comm_buf to the servers and pull the aggregated value back into it
+   */
+  virtual void PushPullDefault(int key, const NDArray& comm_buf, int priority) {
+    auto pushpull = [this, key, comm_buf](RunContext rctx, Engine::CallbackOnComplete cb) {
+      size_t size         = comm_buf.shape().Size();
+      const int dtype     = comm_buf.dtype();
+      const int num_bytes = mshadow::mshadow_sizeof(dtype);
+      const int cmd       = GetCommandType(RequestType::kDefaultPushPull, dtype);
+
+      PSKV& pskv = EncodeDefaultKey(key, size, num_bytes);
+      char* data = static_cast<char*>(comm_buf.data().dptr_);
+      auto vals  = new ps::SArray<char>(data, size * num_bytes, false);
+
+      CHECK_NOTNULL(ps_worker_)->ZPushPull(pskv.keys, *vals, vals, &pskv.lens, cmd, [vals, cb]() {
+        delete vals;
+        cb();
+      });
+    };
+
+    CHECK_NOTNULL(Engine::Get())
+        ->PushAsync(pushpull,
+                    pinned_ctx_,
+                    {},
+                    {comm_buf.var()},
+                    FnProperty::kNormal,
+                    priority,
+                    "KVStoreDistDefaultStoragePushPull");
+  }
+
+  /**
+   * \brief buffer for non-compressed data.
+   * When gradient compression is active, this is used
+   * for the data in pull and for original data in push
+   */
+  std::unordered_map<int, NDArray> comm_buf_;
+
  private:
   static std::atomic<int> customer_id_;
 
@@ -215,6 +287,28 @@ class KVStoreDist : public KVStoreLocal {
     comm_->Init(key, value.storage_type(), value.shape(), value.dtype());
   }
 
+  void InitHashEmbeddingImpl(
+      const int key,
+      const mxnet::TShape& shape,
+      const std::vector<std::pair<std::string, std::string>>& params) override {
+    CHECK_EQ(shape.ndim(), 2) << "the shape of a hash embedding is (num_ids, dim)";
+    CHECK(hashed_keys_.insert(key).second) << "duplicate init of key " << key;
+    // check the params before sending them to the servers
+    HashEmbeddingParam param;
+    param.Init(params);
+    comm_->Init(key, kRowSparseStorage, shape, mshadow::kFloat32);
+    if (get_rank() == 0 && this->ps_worker_->get_customer()->customer_id() == 0) {
+      std::string body = std::to_string(key) + "," + std::to_string(shape[1]);
+      for (const auto& p : params) {
+        body += "," + p.first + "=" + p.second;
+      }
+      SendCommandToServers(static_cast<int>(CommandType::kInitHashEmbedding), body);
+    }
+    if (!ps::Postoffice::Get()->is_recovery()) {
+      Barrier();
+    }
+  }
+
   void PushPullImpl(const std::vector<int>& vkeys,
                     const std::vector<int>& okeys,
                     const std::vector<NDArray>& values,
@@ -231,35 +325,7 @@ class KVStoreDist : public KVStoreLocal {
 
     for (size_t i = 0; i < uniq_vkeys.size(); ++i) {
       CHECK_EQ(uniq_vkeys[i], uniq_okeys[i]) << "Mismatch in push and pull key";
-      int key          = uniq_vkeys[i];
-      const auto& vals = grouped_vals[i];
-      const auto& outs = grouped_outs[i];
-
-      NDArray merged = comm_->Reduce(key, vals, priority);
-
-      const auto push_stype = merged.storage_type();
-      const auto pull_stype = outs[0]->storage_type();
-      CHECK_EQ(push_stype, kDefaultStorage) << "Expected push_stype of value to be kDefaultStorage";
-      CHECK_EQ(pull_stype, kDefaultStorage) << "Expected pull_stype of value to be kDefaultStorage";
-
-      const int push_dtype = merged.dtype();
-      const int pull_dtype = outs[0]->dtype();
-      CHECK_EQ(push_dtype, pull_dtype) << "Output buffer dtype is different";
-
-      auto& comm_buf = comm_buf_[key];
-      if (merged.ctx().dev_mask() == cpu::kDevMask) {
-        comm_buf = merged;  // avoid memory copy
-      } else {
-        if (comm_buf.is_none()) {
-          comm_buf = NDArray(outs[0]->shape(), pinned_ctx_, true, pull_dtype);
-        }
-        CopyFromTo(merged, &comm_buf);
-      }
-
-      CHECK(gradient_compression_->get_type() == CompressionType::kNone)
-          << "Compression not supported with PushPull";
-      PushPullDefault(key, comm_buf, priority);
-      comm_->Broadcast(key, comm_buf, outs, priority);
+      PushPullKey(uniq_vkeys[i], grouped_vals[i], grouped_outs[i], priority);
     }
   }
 
@@ -282,6 +348,8 @@ class KVStoreDist : public KVStoreLocal {
       int key = uniq_keys[i];
       // use the same array for merging to guarantee that pull always happens
       // after the previous push on this key
+      CHECK(!hashed_keys_.count(key))
+          << "the hash embedding of key " << key << " can only be pulled with row_sparse_pull";
       auto& recv_buf          = comm_buf_[key];
       const auto storage_type = grouped_vals[i][0]->storage_type();
       CHECK_EQ(storage_type, kDefaultStorage) << "Expected stype of value to be kDefaultStorage";
@@ -464,7 +532,9 @@ class KVStoreDist : public KVStoreLocal {
   // push row sparse gradient
   virtual void PushRowSparse(int key, const NDArray& send_buf, int priority) {
     using namespace rowsparse;
-    auto push_to_servers = [this, key, send_buf](RunContext rctx, Engine::CallbackOnComplete cb) {
+    const RequestType mode = HashedRequestType(key, send_buf.dtype());
+    auto push_to_servers   = [this, key, send_buf, mode](RunContext rctx,
+                                                         Engine::CallbackOnComplete cb) {
       char* data             = static_cast<char*>(send_buf.data().dptr_);
       const int64_t num_rows = send_buf.aux_shape(kIdx)[0];
       const auto offsets     = send_buf.aux_data(kIdx).dptr<int64_t>();
@@ -479,7 +549,7 @@ class KVStoreDist : public KVStoreLocal {
                   << " keys: " << pskv.keys << " size: " << size;
       }
       ps::SArray<char> vals(data, size * num_bytes, false);
-      const int cmd = GetCommandType(RequestType::kRowSparsePushPull, send_buf.dtype());
+      const int cmd = GetCommandType(mode, send_buf.dtype());
       CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb]() { cb(); });
     };
     Engine::Get()->PushAsync(push_to_servers,
@@ -530,8 +600,9 @@ class KVStoreDist : public KVStoreLocal {
                               const NDArray& indices,
                               int priority) {
     using namespace rowsparse;
-    auto pull_from_servers = [this, key, recv_buf, indices](RunContext rctx,
-                                                            Engine::CallbackOnComplete cb) {
+    const RequestType mode = HashedRequestType(key, recv_buf.dtype());
+    auto pull_from_servers = [this, key, recv_buf, indices, mode](RunContext rctx,
+                                                                  Engine::CallbackOnComplete cb) {
       // allocate memory for the buffer
       CHECK_EQ(indices.dtype(), mshadow::kInt64);
       const TBlob idx_data  = indices.data();
@@ -551,7 +622,7 @@ class KVStoreDist : public KVStoreLocal {
                   << " keys: " << pskv.keys << " size: " << size;
       }
       auto vals     = new ps::SArray<char>(data, size * num_bytes, false);
-      const int cmd = GetCommandType(RequestType::kRowSparsePushPull, recv_buf.dtype());
+      const int cmd = GetCommandType(mode, recv_buf.dtype());
       // copy indices to recv_buf. this needs to be done before ZPull
       // because after pull is done, the callback function returns and locks are released.
       // at this point, later functions may access the indices variable while copy happens
@@ -572,31 +643,16 @@ class KVStoreDist : public KVStoreLocal {
                     "KVStoreDistRowSparsePull");
   }
 
-  virtual void PushPullDefault(int key, const NDArray& comm_buf, int priority) {
-    auto pushpull = [this, key, comm_buf](RunContext rctx, Engine::CallbackOnComplete cb) {
-      size_t size         = comm_buf.shape().Size();
-      const int dtype     = comm_buf.dtype();
-      const int num_bytes = mshadow::mshadow_sizeof(dtype);
-      const int cmd       = GetCommandType(RequestType::kDefaultPushPull, dtype);
-
-      PSKV& pskv = EncodeDefaultKey(key, size, num_bytes);
-      char* data = static_cast<char*>(comm_buf.data().dptr_);
-      auto vals  = new ps::SArray<char>(data, size * num_bytes, false);
-
-      CHECK_NOTNULL(ps_worker_)->ZPushPull(pskv.keys, *vals, vals, &pskv.lens, cmd, [vals, cb]() {
-        delete vals;
-        cb();
-      });
-    };
-
-    CHECK_NOTNULL(Engine::Get())
-        ->PushAsync(pushpull,
-                    pinned_ctx_,
-                    {},
-                    {comm_buf.var()},
-                    FnProperty::kNormal,
-                    priority,
-                    "KVStoreDistDefaultStoragePushPull");
+  /**
+   * \brief the request type of the row_sparse pushes and pulls of a key, the rows of the hash
+   *  embeddings are stored in the hash tables of the servers
+   */
+  RequestType HashedRequestType(const int key, const int dtype) {
+    if (!hashed_keys_.count(key)) {
+      return RequestType::kRowSparsePushPull;
+    }
+    CHECK_EQ(dtype, mshadow::kFloat32) << "hash embeddings are float32";
+    return RequestType::kHashedRowSparsePushPull;
   }
 
   /**
@@ -836,12 +892,6 @@ class KVStoreDist : public KVStoreLocal {
    * \brief threshold for partition
    */
   size_t bigarray_bound_;
-  /**
-   * \brief buffer for non-compressed data.
-   * When gradient compression is active, this is used
-   * for the data in pull and for original data in push
-   */
-  std::unordered_map<int, NDArray> comm_buf_;
   /**
    * \brief buffer for compressed data
    * Used when gradient compression is active and action
@@ -853,6 +903,10 @@ class KVStoreDist : public KVStoreLocal {
    * during gradient compression
    */
   std::unordered_map<int, NDArray> residual_;
+  /**
+   * \brief keys of the hash embeddings, whose rows are keyed by the ids of the features
+   */
+  std::unordered_set<int> hashed_keys_;
   bool log_verbose_;
 };
 
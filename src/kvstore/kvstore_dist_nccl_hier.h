@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_nccl_hier.h
+ * @brief  distributed kvstore reducing within the node with NCCL
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_NCCL_HIER_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_NCCL_HIER_H_
+
+#if MXNET_USE_NCCL && MXNET_USE_DIST_KVSTORE
+
+#include <nccl.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "./kvstore_dist.h"
+#include "./kvstore_nccl.h"
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief distributed kvstore with a hierarchical allreduce for pushpull
+ *
+ * The gradients of the GPUs of a worker are reduce-scattered with NCCL, so that every GPU
+ * holds the sum of one shard. Every shard is copied to the host buffer of the key from its
+ * own GPU, the buffer is allreduced across the workers by the servers, and the shards are
+ * copied back and all-gathered with NCCL. The reduction and the broadcast within the node
+ * run over NVLink on all the GPUs, instead of through the root GPU of the device Comm.
+ *
+ * Keys whose size is not a multiple of the number of GPUs, and push and pull, use the
+ * device Comm of KVStoreDist.
+ */
+class KVStoreDistNCCLHier : public KVStoreDist {
+ public:
+  KVStoreDistNCCLHier() : KVStoreDist(true) {}
+
+  virtual ~KVStoreDistNCCLHier() {
+    Engine::Get()->WaitForAll();
+    mxnet::common::cuda::DeviceStore device_store;
+    for (auto& e : nccl_data_) {
+      device_store.SetDevice(e.second.dev_id);
+      cudaStreamDestroy(e.second.stream);
+      ncclCommDestroy(e.second.comm);
+    }
+  }
+
+  void SetGradientCompression(
+      const std::vector<std::pair<std::string, std::string>>& kwargs) override {
+    LOG(FATAL) << "dist_nccl_hier kvstore does not support gradient compression";
+  }
+
+ protected:
+  void PushPullKey(int key,
+                   const std::vector<NDArray>& vals,
+                   const std::vector<NDArray*>& outs,
+                   int priority) override {
+    const size_t num_devs = vals.size();
+    const size_t size     = vals[0].shape().Size();
+    if (!UseHierarchical(vals, outs)) {
+      KVStoreDist::PushPullKey(key, vals, outs, priority);
+      return;
+    }
+    if (nccl_data_.empty()) {
+      InitNCCL(vals);
+    }
+
+    // order the arrays by NCCL rank
+    std::vector<NDArray> srcs(num_devs), dsts(num_devs);
+    for (size_t i = 0; i < num_devs; ++i) {
+      srcs[nccl_data_.at(vals[i].ctx().dev_id).rank] = vals[i];
+      dsts[nccl_data_.at(outs[i]->ctx().dev_id).rank] = *outs[i];
+    }
+    const size_t shard = size / num_devs;
+    auto& comm_buf     = comm_buf_[key];
+    if (comm_buf.is_none()) {
+      comm_buf = NDArray(outs[0]->shape(), pinned_ctx_, true, outs[0]->dtype());
+    }
+
+    // every GPU reduces its shard into its output
+    RunNCCL(srcs, dsts, priority, "KVStoreReduceScatter", [shard](const NDArray& src,
+                                                                const NDArray& dst,
+                                                                const NCCLEntry& e) {
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        ncclReduceScatter(src.data().dptr<DType>(),
+                          dst.data().dptr<DType>() + e.rank * shard,
+                          shard,
+                          GetNCCLType(dst.dtype()),
+                          ncclSum,
+                          e.comm,
+                          e.stream);
+      });
+    });
+    const mxnet::TShape flat(1, static_cast<dim_t>(size));
+    NDArray flat_buf = comm_buf.Reshape(flat);
+    for (size_t r = 0; r < num_devs; ++r) {
+      NDArray host_shard = flat_buf.Slice(r * shard, (r + 1) * shard);
+      CopyFromTo(dsts[r].Reshape(flat).Slice(r * shard, (r + 1) * shard), &host_shard, priority);
+    }
+
+    PushPullDefault(key, comm_buf, priority);
+
+    for (size_t r = 0; r < num_devs; ++r) {
+      NDArray dev_shard = dsts[r].Reshape(flat).Slice(r * shard, (r + 1) * shard);
+      CopyFromTo(flat_buf.Slice(r * shard, (r + 1) * shard), &dev_shard, priority);
+    }
+    // every GPU gathers the shards of the others
+    RunNCCL(dsts, dsts, priority, "KVStoreAllGather", [shard](const NDArray& src,
+                                                              const NDArray& dst,
+                                                              const NCCLEntry& e) {
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        ncclAllGather(dst.data().dptr<DType>() + e.rank * shard,
+                      dst.data().dptr<DType>(),
+                      shard,
+                      GetNCCLType(dst.dtype()),
+                      e.comm,
+                      e.stream);
+      });
+    });
+  }
+
+ private:
+  struct NCCLEntry {
+    /// \brief device ID
+    int dev_id;
+    /// \brief NCCL commmunicator
+    ncclComm_t comm;
+    /// \brief NCCL rank
+    size_t rank;
+    /// \brief GPU stream to use with NCCL
+    cudaStream_t stream;
+  };
+
+  /**
+   * \brief whether the values of a key can be reduce-scattered, they need to be dense arrays
+   *  of the same shape on the GPUs of the communicator with one output on each of them
+   */
+  bool UseHierarchical(const std::vector<NDArray>& vals, const std::vector<NDArray*>& outs) {
+    if (vals.size() < 2 || vals.size() != outs.size() ||
+        vals[0].shape().Size() % vals.size() != 0 ||
+        gradient_compression_->get_type() != CompressionType::kNone) {
+      return false;
+    }
+    std::vector<int> val_devs, out_devs;
+    for (size_t i = 0; i < vals.size(); ++i) {
+      if (vals[i].ctx().dev_mask() != gpu::kDevMask ||
+          vals[i].storage_type() != kDefaultStorage ||
+          outs[i]->storage_type() != kDefaultStorage || vals[i].shape() != vals[0].shape() ||
+          outs[i]->shape() != vals[0].shape() || vals[i].dtype() != vals[0].dtype() ||
+          outs[i]->dtype() != vals[0].dtype()) {
+        return false;
+      }
+      val_devs.push_back(vals[i].ctx().dev_id);
+      out_devs.push_back(outs[i]->ctx().dev_id);
+    }
+    std::sort(val_devs.begin(), val_devs.end());
+    std::sort(out_devs.begin(), out_devs.end());
+    if (val_devs != out_devs || std::adjacent_find(val_devs.begin(), val_devs.end()) !=
+                                    val_devs.end()) {
+      return false;
+    }
+    if (nccl_data_.empty()) {
+      return true;
+    }
+    CHECK(val_devs == device_ids_) << "dist_nccl_hier kvstore supports only single set "
+                                   << "of devices";
+    return true;
+  }
+
+  void InitNCCL(const std::vector<NDArray>& vals) {
+    for (const auto& v : vals) {
+      device_ids_.push_back(v.ctx().dev_id);
+    }
+    std::sort(device_ids_.begin(), device_ids_.end());
+    std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+    std::vector<ncclComm_t> comms(device_ids_.size());
+    ncclCommInitAll(&(comms[0]), device_ids_.size(), &(device_ids_[0]));
+    mxnet::common::cuda::DeviceStore device_store;
+    for (size_t i = 0; i < device_ids_.size(); ++i) {
+      NCCLEntry e;
+      e.dev_id = device_ids_[i];
+      e.comm   = comms[i];
+      e.rank   = i;
+      device_store.SetDevice(e.dev_id);
+      cudaStreamCreate(&(e.stream));
+      nccl_data_[device_ids_[i]] = e;
+    }
+  }
+
+  /**
+   * \brief push a collective reading srcs and writing dsts, both ordered by NCCL rank,
+   *  and wait for it to complete
+   */
+  template <typename F>
+  void RunNCCL(const std::vector<NDArray>& srcs,
+               const std::vector<NDArray>& dsts,
+               int priority,
+               const char* opr_name,
+               F collective) {
+    std::vector<Engine::VarHandle> const_vars;
+    std::vector<Engine::VarHandle> mutable_vars;
+    std::unordered_set<Engine::VarHandle> written;
+    for (const auto& d : dsts) {
+      mutable_vars.push_back(d.var());
+      written.insert(d.var());
+    }
+    for (const auto& s : srcs) {
+      if (!written.count(s.var()))
+        const_vars.push_back(s.var());
+    }
+    Engine::Get()->PushSync(
+        [this, srcs, dsts, collective](RunContext rctx) {
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          ncclGroupStart();
+          for (size_t r = 0; r < dsts.size(); ++r) {
+            collective(srcs[r], dsts[r], nccl_data_.at(device_ids_[r]));
+          }
+          ncclGroupEnd();
+          mxnet::common::cuda::DeviceStore device_store;
+          for (int dev_id : device_ids_) {
+            device_store.SetDevice(dev_id);
+            CUDA_CALL(cudaStreamSynchronize(nccl_data_.at(dev_id).stream));
+          }
+        },
+        Context::CPU(),
+        const_vars,
+        mutable_vars,
+        FnProperty::kCPUPrioritized,
+        priority,
+        opr_name);
+  }
+
+  std::unordered_map<int, NCCLEntry> nccl_data_;
+  /// \brief devices of the communicator, in the order of their rank
+  std::vector<int> device_ids_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+
+#endif  // MXNET_USE_NCCL && MXNET_USE_DIST_KVSTORE
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_NCCL_HIER_H_
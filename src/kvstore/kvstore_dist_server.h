@@ -26,14 +26,21 @@
 #include <mxnet/c_api.h>
 #include <mxnet/kvstore.h>
 #include <ps/ps.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <queue>
 #include <string>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
+#include <cstring>
 #include <functional>
 #include <future>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#include "./hash_embedding.h"
 #include "../profiler/profiler.h"
 #include "../operator/tensor/elemwise_binary_op-inl.h"
 #include "../operator/tensor/init_op.h"
@@ -48,10 +55,18 @@ enum class CommandType {
   kStopServer,
   kSyncMode,
   kSetGradientCompression,
-  kSetProfilerParams
+  kSetProfilerParams,
+  kSnapshot,
+  kSetNumWorkers,
+  kInitHashEmbedding
 };
 
-enum class RequestType { kDefaultPushPull, kRowSparsePushPull, kCompressedPushPull };
+enum class RequestType {
+  kDefaultPushPull,
+  kRowSparsePushPull,
+  kCompressedPushPull,
+  kHashedRowSparsePushPull
+};
 
 struct DataHandleType {
   RequestType requestType;
@@ -154,6 +169,85 @@ class Executor {
   std::condition_variable cond_;
 };
 
+/**
+ * \brief pool of threads, each executing the functions pushed to its shard in order
+ */
+class ShardedExecutor {
+ public:
+  typedef std::function<void()> Func;
+
+  explicit ShardedExecutor(size_t num_shards) {
+    for (size_t i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(new Shard());
+      Shard* shard  = shards_.back().get();
+      shard->thread = std::thread([shard]() { shard->Run(); });
+    }
+  }
+
+  ~ShardedExecutor() {
+    for (auto& shard : shards_) {
+      shard->Push(Func());
+      shard->thread.join();
+    }
+  }
+
+  size_t num_shards() const {
+    return shards_.size();
+  }
+
+  /**
+   * \brief let the thread of a shard execute a function without waiting for it. threadsafe
+   */
+  void Push(size_t shard, Func func) {
+    shards_[shard % shards_.size()]->Push(std::move(func));
+  }
+
+  /**
+   * \brief wait for all the functions pushed so far to complete
+   */
+  void WaitAll() {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::mutex> lk(shard->mu);
+      shard->cond.wait(lk, [&shard] { return shard->pending == 0; });
+    }
+  }
+
+ private:
+  struct Shard {
+    void Push(Func func) {
+      std::lock_guard<std::mutex> lk(mu);
+      queue.push(std::move(func));
+      ++pending;
+      cond.notify_all();
+    }
+
+    void Run() {
+      std::unique_lock<std::mutex> lk(mu);
+      while (true) {
+        cond.wait(lk, [this] { return !queue.empty(); });
+        Func f = std::move(queue.front());
+        queue.pop();
+        if (!f) {
+          break;
+        }
+        lk.unlock();
+        f();
+        lk.lock();
+        --pending;
+        cond.notify_all();
+      }
+    }
+
+    std::queue<Func> queue;
+    /*! \brief number of the functions pushed and not completed */
+    size_t pending = 0;
+    std::mutex mu;
+    std::condition_variable cond;
+    std::thread thread;
+  };
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
 class KVStoreDistServer {
  public:
   KVStoreDistServer() {
@@ -165,10 +259,26 @@ class KVStoreDistServer {
     sync_mode_            = false;
     gradient_compression_ = std::make_shared<GradientCompression>();
     log_verbose_          = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    num_workers_          = ps::NumWorkers();
+    sync_timeout_         = dmlc::GetEnv("MXNET_KVSTORE_SYNC_TIMEOUT", 0);
+    const int num_threads = dmlc::GetEnv("MXNET_KVSTORE_SERVER_THREADS", 1);
+    // the rounds timed out are applied by the thread handling their key
+    if (num_threads > 1 || sync_timeout_ > 0) {
+      aggregation_pool_.reset(new ShardedExecutor(std::max(num_threads, 1)));
+      shard_update_ = dmlc::GetEnv("MXNET_KVSTORE_SERVER_SHARD_UPDATE", false);
+    }
+    if (sync_timeout_ > 0) {
+      straggler_monitor_ = std::thread([this]() { MonitorStragglers(); });
+    }
   }
 
   ~KVStoreDistServer() {
     profiler::Profiler::Get()->SetState(profiler::Profiler::ProfilerState(0));
+    StopStragglerMonitor();
+    aggregation_pool_.reset();
+    if (snapshot_thread_.joinable()) {
+      snapshot_thread_.join();
+    }
     delete ps_server_;
   }
 
@@ -192,17 +302,34 @@ class KVStoreDistServer {
  private:
   struct UpdateBuf {
     std::vector<ps::KVMeta> request;
+    // type, keys and arrival of the first push of the round, to apply it on a timeout
+    DataHandleType type;
+    ps::KVPairs<char> round_req;
+    std::chrono::steady_clock::time_point round_start;
     NDArray merged;
     // temp_array is used to cast received values as float32 for computation if required
     NDArray temp_array;
+    // first dense push of a round, read in place from the buffer of ps-lite held by
+    // pending_vals until it is summed with the next push or applied
+    NDArray pending;
+    ps::SArray<char> pending_vals;
   };
 
   void CommandHandle(const ps::SimpleData& recved, ps::SimpleApp* app) {
     CommandType recved_type = static_cast<CommandType>(recved.head);
+    if (aggregation_pool_ && recved_type != CommandType::kController) {
+      // the commands change the state read by the requests of every key
+      aggregation_pool_->WaitAll();
+    }
     switch (recved_type) {
       case CommandType::kStopServer:
+        StopStragglerMonitor();
         exec_.Stop();
         break;
+      case CommandType::kSetNumWorkers:
+        num_workers_ = std::stoi(recved.body);
+        CHECK_GT(num_workers_, 0) << "the number of workers must be positive";
+        break;
       case CommandType::kSyncMode:
         sync_mode_ = true;
         break;
@@ -214,6 +341,12 @@ class KVStoreDistServer {
         ProcessServerProfilerCommands(
             static_cast<KVStoreServerProfilerCommand>(recved.body.back() - '0'), recved.body);
         break;
+      case CommandType::kSnapshot:
+        Snapshot(recved.head, recved.body);
+        break;
+      case CommandType::kInitHashEmbedding:
+        InitHashEmbedding(recved.body);
+        break;
       case CommandType::kSetMultiPrecision:
         // uses value 1 for message id from frontend
         if (!multi_precision_) {
@@ -276,6 +409,109 @@ class KVStoreDistServer {
     }
   }
 
+  /**
+   * \brief Saves the values of the keys of this server to "<prefix>-server<rank>.params",
+   *  and lets the controller save the states of the optimizer to
+   *  "<prefix>-server<rank>.states". The body of the command is "<prefix>,<incremental>".
+   *
+   * The values are copied when the command is received, and written by a background thread
+   * while the training goes on. In incremental mode, only the rows of the row_sparse keys
+   * pushed since the previous snapshot are saved.
+   */
+  void Snapshot(const int head, const std::string& body) {
+    const size_t sep = body.rfind(',');
+    CHECK_NE(sep, std::string::npos) << "Improper snapshot command passed from worker";
+    const std::string prefix = body.substr(0, sep) + "-server" + std::to_string(ps::MyRank());
+    const bool incremental   = body.substr(sep + 1) == "1";
+    if (snapshot_thread_.joinable()) {
+      snapshot_thread_.join();
+    }
+    std::vector<NDArray> data;
+    std::vector<std::string> names;
+    for (const auto& stored_entry : store_) {
+      const int key         = stored_entry.first;
+      const auto realt      = store_realt_.find(key);
+      const NDArray& stored = realt != store_realt_.end() ? realt->second : stored_entry.second;
+      if (stored.is_none()) {
+        continue;
+      }
+      auto& touched = touched_rows_[key];
+      if (stored.storage_type() == kRowSparseStorage && incremental) {
+        data.push_back(TouchedRows(stored, touched));
+      } else {
+        NDArray copy = stored.storage_type() == kRowSparseStorage ?
+                           NDArray(kRowSparseStorage, stored.shape(), Context(), true,
+                                   stored.dtype()) :
+                           NDArray(stored.shape(), Context(), false, stored.dtype());
+        CopyFromTo(stored, &copy);
+        data.push_back(copy);
+      }
+      names.push_back(std::to_string(key));
+      touched.assign(touched.size(), false);
+    }
+    snapshot_thread_ = std::thread([prefix, data, names]() {
+      std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create((prefix + ".params").c_str(), "w"));
+      NDArray::Save(fo.get(), data, names);
+      LOG(INFO) << "Saved " << data.size() << " keys to " << prefix << ".params";
+    });
+    if (controller_) {
+      exec_.Exec([this, head, prefix]() { controller_(head, prefix + ".states"); });
+    }
+  }
+
+  /**
+   * \brief copies the rows of stored marked in touched, stored holds all its rows as the
+   *  row_sparse values of the server do
+   */
+  NDArray TouchedRows(const NDArray& stored, const std::vector<bool>& touched) {
+    stored.WaitToRead();
+    CHECK_EQ(stored.storage_shape()[0], stored.shape()[0]);
+    std::vector<int64_t> rows;
+    for (size_t i = 0; i < touched.size(); ++i) {
+      if (touched[i]) {
+        rows.push_back(i);
+      }
+    }
+    const auto& shape   = stored.shape();
+    const auto unit_len = shape.ProdShape(1, shape.ndim());
+    NDArray ret(kRowSparseStorage, shape, Context(), true, stored.dtype());
+    ret.CheckAndAlloc({mshadow::Shape1(rows.size())});
+    MSHADOW_TYPE_SWITCH(stored.dtype(), DType, {
+      MSHADOW_IDX_TYPE_SWITCH(ret.aux_type(rowsparse::kIdx), IType, {
+        const DType* src = stored.data().dptr<DType>();
+        DType* dst       = ret.data().dptr<DType>();
+        IType* idx       = ret.aux_data(rowsparse::kIdx).dptr<IType>();
+        for (size_t i = 0; i < rows.size(); ++i) {
+          idx[i] = static_cast<IType>(rows[i]);
+          std::memcpy(dst + i * unit_len, src + rows[i] * unit_len, unit_len * sizeof(DType));
+        }
+      });
+    });
+    return ret;
+  }
+
+  /**
+   * \brief creates the hash table of a hash embedding key of this server, the body of the
+   *  command is "<key>,<dim>[,<param>=<value>...]" with the params of HashEmbeddingParam
+   */
+  void InitHashEmbedding(const std::string& body) {
+    std::vector<std::string> elems;
+    mxnet::kvstore::split(body, ',', std::back_inserter(elems));
+    CHECK_GE(elems.size(), 2) << "Improper hash embedding command passed from worker";
+    std::vector<std::pair<std::string, std::string>> params;
+    for (size_t i = 2; i < elems.size(); ++i) {
+      const size_t sep = elems[i].find('=');
+      CHECK_NE(sep, std::string::npos) << "Improper hash embedding param " << elems[i];
+      params.emplace_back(elems[i].substr(0, sep), elems[i].substr(sep + 1));
+    }
+    HashEmbeddingParam param;
+    param.Init(params);
+    // the servers initialize their rows differently
+    param.seed += ps::MyRank();
+    GetEntry(&hashed_, std::stoi(elems[0]))
+        .reset(new HashEmbeddingTable(std::stoll(elems[1]), param));
+  }
+
   void ProcessServerProfilerCommands(KVStoreServerProfilerCommand type, const std::string& body) {
     switch (type) {
       case KVStoreServerProfilerCommand::kSetConfig:
@@ -329,6 +565,24 @@ class KVStoreDistServer {
                     const ps::KVPairs<char>& req_data,
                     ps::KVServer<char>* server) {
     DataHandleType type = DepairDataHandleType(req_meta.cmd);
+    if (aggregation_pool_) {
+      // The requests of a key are handled in order by the thread of its shard. The data
+      // received is held by the copy of req_data.
+      const bool compressed_push =
+          type.requestType == RequestType::kCompressedPushPull && req_meta.push;
+      const int key = DecodeKey(req_data.keys[compressed_push ? 1 : 0]);
+      aggregation_pool_->Push(key, [this, type, req_meta, req_data, server]() {
+        DataHandle(type, req_meta, req_data, server);
+      });
+    } else {
+      DataHandle(type, req_meta, req_data, server);
+    }
+  }
+
+  void DataHandle(const DataHandleType type,
+                  const ps::KVMeta& req_meta,
+                  const ps::KVPairs<char>& req_data,
+                  ps::KVServer<char>* server) {
     switch (type.requestType) {
       case RequestType::kRowSparsePushPull:
         DataHandleRowSparse(type, req_meta, req_data, server);
@@ -339,6 +593,9 @@ class KVStoreDistServer {
       case RequestType::kDefaultPushPull:
         DataHandleDefault(type, req_meta, req_data, server);
         break;
+      case RequestType::kHashedRowSparsePushPull:
+        DataHandleHashed(type, req_meta, req_data, server);
+        break;
     }
   }
 
@@ -346,16 +603,70 @@ class KVStoreDistServer {
     return multi_precision_ && type.dtype != mshadow::kFloat32;
   }
 
+  /**
+   * \brief entry of a key in one of the maps of the server, which are shared by the
+   *  aggregation threads. The references to the entries stay valid when a map grows.
+   */
+  template <typename T>
+  T& GetEntry(std::unordered_map<int, T>* map, const int key) {
+    std::lock_guard<std::mutex> lk(map_mu_);
+    return (*map)[key];
+  }
+
+  /**
+   * \brief writes the sum of the dense arrays lhs and rhs to dst with a vectorized loop on
+   *  the calling thread, instead of an engine operator followed by a wait
+   */
+  void SumDense(const NDArray& lhs, const NDArray& rhs, NDArray* dst) {
+    CHECK_EQ(lhs.dtype(), dst->dtype());
+    CHECK_EQ(rhs.dtype(), dst->dtype());
+    CHECK_EQ(lhs.shape().Size(), dst->shape().Size());
+    CHECK_EQ(rhs.shape().Size(), dst->shape().Size());
+    lhs.WaitToRead();
+    rhs.WaitToRead();
+    dst->WaitToWrite();
+    const size_t size = dst->shape().Size();
+    MSHADOW_REAL_TYPE_SWITCH(dst->dtype(), DType, {
+      const DType* l = lhs.data().dptr<DType>();
+      const DType* r = rhs.data().dptr<DType>();
+      DType* to      = dst->data().dptr<DType>();
+#pragma omp simd
+      for (size_t i = 0; i < size; ++i) {
+        to[i] = l[i] + r[i];
+      }
+    });
+  }
+
+  void AccumulateDense(const NDArray& src, NDArray* dst) {
+    SumDense(*dst, src, dst);
+  }
+
+  /**
+   * \brief applies the round of pushes of a key when all the workers pushed, or when the
+   *  round is forced because it timed out
+   */
   inline void ApplyUpdates(const DataHandleType type,
                            const int key,
                            const ps::KVPairs<char>& req_data,
                            UpdateBuf* update_buf,
-                           ps::KVServer<char>* server) {
-    if (!sync_mode_ || update_buf->request.size() == (size_t)ps::NumWorkers()) {
+                           ps::KVServer<char>* server,
+                           bool force = false) {
+    if (sync_mode_ && update_buf->request.size() == 1 && !force) {
+      update_buf->type           = type;
+      update_buf->round_req.keys = req_data.keys;
+      update_buf->round_start    = std::chrono::steady_clock::now();
+    }
+    if (!sync_mode_ || force || update_buf->request.size() >= static_cast<size_t>(num_workers_)) {
       // let the main thread to execute updater_, which is necessary for python
-      auto& stored = has_multi_precision_copy(type) ? store_realt_[key] : store_[key];
-      auto& update = sync_mode_ ? update_buf->merged : update_buf->temp_array;
-      if (updater_) {
+      auto& stored =
+          has_multi_precision_copy(type) ? GetEntry(&store_realt_, key) : GetEntry(&store_, key);
+      // a single push of the round is applied from the received buffer
+      const bool in_place = sync_mode_ && !update_buf->pending.is_none();
+      auto& update        = in_place ? update_buf->pending
+                                     : (sync_mode_ ? update_buf->merged : update_buf->temp_array);
+      if (updater_ && shard_update_) {
+        updater_(key, update, &stored);
+      } else if (updater_) {
         exec_.Exec([this, key, &update, &stored]() {
           CHECK(updater_);
           updater_(key, update, &stored);
@@ -363,7 +674,7 @@ class KVStoreDistServer {
       } else {
         CHECK(sync_mode_) << "Updater needs to be set for async mode";
         // if no updater, just copy
-        CopyFromTo(update_buf->merged, &stored);
+        CopyFromTo(update, &stored);
       }
 
       if (log_verbose_) {
@@ -381,7 +692,7 @@ class KVStoreDistServer {
       if (has_pull) {
         // if there is a pull request, perform WaitToRead() once before DefaultStorageResponse
         if (has_multi_precision_copy(type))
-          CopyFromTo(stored, store_[key]);
+          CopyFromTo(stored, GetEntry(&store_, key));
         stored.WaitToRead();
         for (const auto& req : update_buf->request) {
           if (req.pull) {
@@ -396,14 +707,66 @@ class KVStoreDistServer {
         }
         update_buf->request.clear();
         if (has_multi_precision_copy(type))
-          CopyFromTo(stored, store_[key]);
+          CopyFromTo(stored, GetEntry(&store_, key));
         stored.WaitToRead();
       }
+      if (in_place) {
+        update_buf->pending      = NDArray();
+        update_buf->pending_vals = ps::SArray<char>();
+      }
     } else {
       update_buf->merged.WaitToRead();
     }
   }
 
+  /**
+   * \brief Checks every sync_timeout_ / 4 milliseconds for the rounds waiting longer than
+   *  sync_timeout_, on the thread of each shard. The pushes of the stragglers are then merged
+   *  in the next round, at most one round late.
+   */
+  void MonitorStragglers() {
+    const auto period = std::chrono::milliseconds(std::max(sync_timeout_ / 4, 1));
+    while (!stop_monitor_) {
+      std::this_thread::sleep_for(period);
+      for (size_t shard = 0; shard < aggregation_pool_->num_shards() && !stop_monitor_; ++shard) {
+        aggregation_pool_->Push(shard, [this, shard]() { ApplyTimedOutRounds(shard); });
+      }
+    }
+  }
+
+  void StopStragglerMonitor() {
+    stop_monitor_ = true;
+    if (straggler_monitor_.joinable()) {
+      straggler_monitor_.join();
+    }
+  }
+
+  void ApplyTimedOutRounds(const size_t shard) {
+    if (!sync_mode_) {
+      return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    // the entries of the keys of this shard are only modified by this thread
+    std::vector<std::pair<int, UpdateBuf*>> timed_out;
+    {
+      std::lock_guard<std::mutex> lk(map_mu_);
+      for (auto& entry : update_buf_) {
+        const UpdateBuf& buf = entry.second;
+        if (static_cast<size_t>(entry.first) % aggregation_pool_->num_shards() == shard &&
+            !buf.request.empty() &&
+            now - buf.round_start > std::chrono::milliseconds(sync_timeout_)) {
+          timed_out.emplace_back(entry.first, &entry.second);
+        }
+      }
+    }
+    for (const auto& t : timed_out) {
+      UpdateBuf* buf = t.second;
+      LOG(WARNING) << "Applying the round of key " << t.first << " with " << buf->request.size()
+                   << " of " << num_workers_ << " workers after " << sync_timeout_ << " ms";
+      ApplyUpdates(buf->type, t.first, buf->round_req, buf, ps_server_, true);
+    }
+  }
+
   void DecodeRowIds(const ps::SArray<ps::Key>& keys,
                     int64_t* indices,
                     const int64_t master_key,
@@ -461,7 +824,7 @@ class KVStoreDistServer {
       server->Response(req_meta, response);
       return;
     }
-    const NDArray& stored = store_[master_key];
+    const NDArray& stored = GetEntry(&store_, master_key);
     if (has_multi_precision_copy(type))
       stored.WaitToRead();
     CHECK(!stored.is_none()) << "init " << master_key << " first";
@@ -496,7 +859,8 @@ class KVStoreDistServer {
                            const ps::KVMeta& req_meta,
                            const ps::KVPairs<char>& req_data,
                            ps::KVServer<char>* server) {
-    auto& stored  = has_multi_precision_copy(type) ? store_realt_[master_key] : store_[master_key];
+    auto& stored  = has_multi_precision_copy(type) ? GetEntry(&store_realt_, master_key)
+                                                   : GetEntry(&store_, master_key);
     int dtype     = type.dtype;
     int num_bytes = mshadow::mshadow_sizeof(dtype);
     auto unit_len = req_data.lens[1] / num_bytes;
@@ -515,7 +879,8 @@ class KVStoreDistServer {
                      true,
                      has_multi_precision_copy(type) ? mshadow::kFloat32 : type.dtype);
     if (has_multi_precision_copy(type)) {
-      store_[master_key] = NDArray(kRowSparseStorage, dshape, Context(), true, type.dtype);
+      GetEntry(&store_, master_key) =
+          NDArray(kRowSparseStorage, dshape, Context(), true, type.dtype);
     }
     Engine::Get()->PushAsync(
         [this, recved, stored, type](RunContext ctx, Engine::CallbackOnComplete on_complete) {
@@ -540,8 +905,8 @@ class KVStoreDistServer {
         0,
         PROFILER_MESSAGE_FUNCNAME);
     if (has_multi_precision_copy(type)) {
-      CopyFromTo(stored, store_[master_key]);
-      store_[master_key].WaitToRead();
+      CopyFromTo(stored, GetEntry(&store_, master_key));
+      GetEntry(&store_, master_key).WaitToRead();
     }
     stored.WaitToRead();
     server->Response(req_meta);
@@ -553,7 +918,7 @@ class KVStoreDistServer {
                            ps::KVServer<char>* server) {
     int master_key = DecodeKey(req_data.keys[0]);
     auto num_rows  = req_data.keys.size() - 1;
-    auto& stored   = store_[master_key];
+    auto& stored   = GetEntry(&store_, master_key);
     if (req_meta.push) {
       CHECK_GT(req_data.lens.size(), 0) << "req_data.lens cannot be empty";
       CHECK_EQ(req_data.lens[0], 0);
@@ -567,7 +932,7 @@ class KVStoreDistServer {
       } else {
         if (log_verbose_)
           LOG(INFO) << "push: " << master_key << " " << req_data.keys;
-        auto& updates = update_buf_[master_key];
+        auto& updates = GetEntry(&update_buf_, master_key);
         if (sync_mode_ && updates.merged.is_none()) {
           updates.merged = NDArray(kRowSparseStorage,
                                    stored.shape(),
@@ -599,6 +964,11 @@ class KVStoreDistServer {
           // indices
           std::vector<int64_t> indices(num_rows);
           DecodeRowIds(req_data.keys, indices.data(), master_key, num_rows);
+          auto& touched = GetEntry(&touched_rows_, master_key);
+          touched.resize(stored.shape()[0], false);
+          for (const int64_t row : indices) {
+            touched[row] = true;
+          }
 
           // data
           TBlob idx_blob(indices.data(), mshadow::Shape1(num_rows), cpu::kDevMask);
@@ -636,13 +1006,58 @@ class KVStoreDistServer {
     }
   }
 
+  /**
+   * \brief ids of the rows of a request of a hash embedding, relative to the first row of
+   *  the partition of this server. They span 64 bits as the ps keys do.
+   */
+  void DecodeHashedIds(const ps::SArray<ps::Key>& keys, const int master_key, int64_t* ids) {
+    const ps::Key begin =
+        ps::Postoffice::Get()->GetServerKeyRanges()[ps::MyRank()].begin() + master_key;
+    for (size_t i = 1; i < keys.size(); ++i) {
+      ids[i - 1] = static_cast<int64_t>(keys[i] - begin);
+    }
+  }
+
+  /**
+   * \brief the pushes of a hash embedding update its rows when they are received, in the
+   *  sync mode too, as the rows pushed by the workers differ. The pulls return the rows of the
+   *  ids, zeros for the ids without a row.
+   */
+  void DataHandleHashed(const DataHandleType type,
+                        const ps::KVMeta& req_meta,
+                        const ps::KVPairs<char>& req_data,
+                        ps::KVServer<char>* server) {
+    const int master_key      = DecodeKey(req_data.keys[0]);
+    HashEmbeddingTable* table = GetEntry(&hashed_, master_key).get();
+    CHECK(table != nullptr) << "init the hash embedding of key " << master_key << " first";
+    CHECK_EQ(type.dtype, mshadow::kFloat32) << "hash embeddings are float32";
+    const size_t num_rows  = req_data.keys.size() - 1;
+    const size_t unit_size = table->dim() * sizeof(float);
+    std::vector<int64_t> ids(num_rows);
+    DecodeHashedIds(req_data.keys, master_key, ids.data());
+    if (req_meta.push) {
+      CHECK_EQ(req_data.vals.size(), num_rows * unit_size);
+      table->Push(ids.data(), num_rows, reinterpret_cast<const float*>(req_data.vals.data()));
+      server->Response(req_meta);
+      return;
+    }
+    ps::KVPairs<char> response;
+    response.keys = req_data.keys;
+    response.vals.resize(num_rows * unit_size);
+    table->Pull(ids.data(), num_rows, reinterpret_cast<float*>(response.vals.data()));
+    std::vector<int> lens(req_data.keys.size(), table->dim());
+    lens[0] = 0;
+    response.lens.CopyFrom(lens.begin(), lens.end());
+    server->Response(req_meta, response);
+  }
+
   void DefaultStorageResponse(const DataHandleType type,
                               const int key,
                               const ps::KVMeta& req_meta,
                               const ps::KVPairs<char>& req_data,
                               ps::KVServer<char>* server) {
     ps::KVPairs<char> response;
-    const NDArray& stored = store_[key];
+    const NDArray& stored = GetEntry(&store_, key);
     CHECK(!stored.is_none()) << "init " << key << " first";
 
     // as server returns when store_realt is ready in this case
@@ -675,14 +1090,14 @@ class KVStoreDistServer {
 
       int original_size = DecodeKey(req_data.keys[0]);
       int key           = DecodeKey(req_data.keys[1]);
-      auto& stored      = store_[key];
+      auto& stored      = GetEntry(&store_, key);
 
       size_t ds[] = {(size_t)req_data.lens[1] / mshadow::mshadow_sizeof(type.dtype)};
       mxnet::TShape dshape(ds, ds + 1);
       TBlob recv_blob(reinterpret_cast<real_t*>(req_data.vals.data()), dshape, cpu::kDevMask);
       NDArray recved = NDArray(recv_blob, 0);
 
-      NDArray decomp_buf = decomp_buf_[key];
+      NDArray decomp_buf = GetEntry(&decomp_buf_, key);
       dshape             = mxnet::TShape{(int64_t)original_size};
 
       if (decomp_buf.is_none()) {
@@ -696,7 +1111,7 @@ class KVStoreDistServer {
         stored.WaitToRead();
       } else if (sync_mode_) {
         // synced push
-        auto& merged = update_buf_[key];
+        auto& merged = GetEntry(&update_buf_, key);
         if (merged.merged.is_none()) {
           merged.merged = NDArray(dshape, Context());
         }
@@ -704,7 +1119,7 @@ class KVStoreDistServer {
           gradient_compression_->Dequantize(recved, &merged.merged, 0);
         } else {
           gradient_compression_->Dequantize(recved, &decomp_buf, 0);
-          merged.merged += decomp_buf;
+          AccumulateDense(decomp_buf, &merged.merged);
         }
         merged.request.push_back(req_meta);
         ApplyUpdates(type, key, req_data, &merged, server);
@@ -737,7 +1152,8 @@ class KVStoreDistServer {
       CHECK_EQ(req_data.vals.size(), (size_t)req_data.lens[0]);
     }
     int key      = DecodeKey(req_data.keys[0]);
-    auto& stored = has_multi_precision_copy(type) ? store_realt_[key] : store_[key];
+    auto& stored =
+        has_multi_precision_copy(type) ? GetEntry(&store_realt_, key) : GetEntry(&store_, key);
     // there used several WaitToRead, this is because \a recved's memory
     // could be deallocated when this function returns. so we need to make sure
     // the operators with \a NDArray are actually finished
@@ -758,14 +1174,14 @@ class KVStoreDistServer {
         CopyFromTo(recved, &stored, 0);
         server->Response(req_meta);
         if (has_multi_precision_copy(type)) {
-          auto& stored_dtype = store_[key];
+          auto& stored_dtype = GetEntry(&store_, key);
           stored_dtype       = NDArray(dshape, Context(), false, type.dtype);
           CopyFromTo(stored, stored_dtype);
           stored_dtype.WaitToRead();
         }
         stored.WaitToRead();
       } else {
-        auto& updates = update_buf_[key];
+        auto& updates = GetEntry(&update_buf_, key);
         if (sync_mode_ && updates.merged.is_none()) {
           updates.merged = NDArray(dshape,
                                    Context(),
@@ -777,7 +1193,13 @@ class KVStoreDistServer {
         }
         if (updates.request.empty()) {
           if (sync_mode_) {
-            CopyFromTo(recved, updates.merged);
+            if (has_multi_precision_copy(type)) {
+              CopyFromTo(recved, updates.merged);
+            } else {
+              // keep the push in the receive buffer instead of copying it to merged
+              updates.pending      = recved;
+              updates.pending_vals = req_data.vals;
+            }
           } else {
             if (has_multi_precision_copy(type)) {
               CopyFromTo(recved, updates.temp_array);
@@ -789,9 +1211,13 @@ class KVStoreDistServer {
           CHECK(sync_mode_);
           if (has_multi_precision_copy(type)) {
             CopyFromTo(recved, updates.temp_array);
-            updates.merged += updates.temp_array;
+            AccumulateDense(updates.temp_array, &updates.merged);
+          } else if (!updates.pending.is_none()) {
+            SumDense(updates.pending, recved, &updates.merged);
+            updates.pending      = NDArray();
+            updates.pending_vals = ps::SArray<char>();
           } else {
-            updates.merged += recved;
+            AccumulateDense(recved, &updates.merged);
           }
         }
         updates.request.push_back(req_meta);
@@ -836,6 +1262,32 @@ class KVStoreDistServer {
   Executor exec_;
   ps::KVServer<char>* ps_server_;
 
+  /**
+   * \brief threads aggregating the requests of the keys of their shard, if
+   *  MXNET_KVSTORE_SERVER_THREADS is larger than 1. Otherwise the requests are handled on
+   *  the thread of ps-lite.
+   */
+  std::unique_ptr<ShardedExecutor> aggregation_pool_;
+  /*! \brief whether the updater runs on the aggregation threads instead of exec_ */
+  bool shard_update_ = false;
+  /*! \brief guards the insertion of the entries of the maps of the server */
+  std::mutex map_mu_;
+
+  /*! \brief hash tables of the hash embedding keys, which are not saved by the snapshots */
+  std::unordered_map<int, std::unique_ptr<HashEmbeddingTable>> hashed_;
+
+  /*! \brief rows of the row_sparse keys pushed since the last snapshot */
+  std::unordered_map<int, std::vector<bool>> touched_rows_;
+  /*! \brief thread writing the last snapshot */
+  std::thread snapshot_thread_;
+
+  /*! \brief number of workers whose pushes are merged in each sync round */
+  int num_workers_;
+  /*! \brief milliseconds after which a sync round is applied without the stragglers, 0 waits */
+  int sync_timeout_;
+  std::thread straggler_monitor_;
+  std::atomic<bool> stop_monitor_{false};
+
   // whether to LOG verbose information
   bool log_verbose_;
 
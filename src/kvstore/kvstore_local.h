@@ -25,6 +25,8 @@
 #define MXNET_KVSTORE_KVSTORE_LOCAL_H_
 
 #include <mxnet/kvstore.h>
+#include <map>
+#include <memory>
 #include <unordered_map>
 #include <bitset>
 #include <vector>
@@ -34,6 +36,7 @@
 #include <algorithm>
 #include "./comm.h"
 #include "./comm_tree.h"
+#include "./hash_embedding.h"
 #include "./kvstore_utils.h"
 #include "../ndarray/ndarray_function.h"
 #include "../profiler/profiler.h"
@@ -108,6 +111,25 @@ class KVStoreLocal : public KVStore {
     InitImpl(keys, values);
   }
 
+  void InitHashEmbedding(const int key,
+                         const mxnet::TShape& shape,
+                         const std::vector<std::pair<std::string, std::string>>& params) override {
+    SetKeyType(kIntKey);
+    InitHashEmbeddingImpl(key, shape, params);
+  }
+
+  void InitHashEmbedding(const std::string& str_key,
+                         const mxnet::TShape& shape,
+                         const std::vector<std::pair<std::string, std::string>>& params) override {
+    SetKeyType(kStringKey);
+    CHECK(str_key_dict_.find(str_key) == str_key_dict_.end())
+        << "duplicate init of key " << str_key;
+    const int key              = next_str_key_++;
+    str_key_dict_[str_key]     = key;
+    reverse_str_key_dict_[key] = str_key;
+    InitHashEmbeddingImpl(key, shape, params);
+  }
+
   void Push(const std::vector<int>& keys,
             const std::vector<NDArray>& values,
             int priority) override {
@@ -138,7 +160,7 @@ class KVStoreLocal : public KVStore {
                 const std::vector<NDArray*>& outs,
                 int priority) override {
     SetKeyType(kIntKey);
-    PushPullImpl(vkeys, okeys, values, outs, priority);
+    FusedPushPull(vkeys, okeys, values, outs, priority);
   }
 
   void PullRowSparse(const std::vector<int>& keys,
@@ -199,7 +221,7 @@ class KVStoreLocal : public KVStore {
     std::vector<int> okeys(str_okeys.size());
     LookupKeys(str_vkeys, &vkeys);
     LookupKeys(str_okeys, &okeys);
-    PushPullImpl(vkeys, okeys, values, outs, priority);
+    FusedPushPull(vkeys, okeys, values, outs, priority);
   }
 
   void PullRowSparse(const std::vector<std::string>& str_keys,
@@ -229,6 +251,21 @@ class KVStoreLocal : public KVStore {
     comm_->SetGradientCompression(gradient_compression_);
   }
 
+  virtual void InitHashEmbeddingImpl(
+      const int key,
+      const mxnet::TShape& shape,
+      const std::vector<std::pair<std::string, std::string>>& params) {
+    CHECK(local_.find(key) == local_.end() && hashed_.find(key) == hashed_.end())
+        << "duplicate init of key " << key;
+    CHECK_EQ(shape.ndim(), 2) << "the shape of a hash embedding is (num_ids, dim)";
+    HashEmbeddingParam param;
+    param.Init(params);
+    hashed_[key].table = std::make_shared<HashEmbeddingTable>(shape[1], param);
+    hashed_[key].var   = Engine::Get()->NewVariable();
+    hashed_[key].shape = shape;
+    comm_->Init(key, kRowSparseStorage, shape, mshadow::kFloat32);
+  }
+
   virtual void PushImpl(const std::vector<int>& keys,
                         const std::vector<NDArray>& values,
                         int priority) {
@@ -238,7 +275,11 @@ class KVStoreLocal : public KVStore {
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
       int key               = uniq_keys[i];
       const NDArray& merged = comm_->Reduce(key, grouped_vals[i], priority);
-      NDArray& local        = local_[key];
+      if (hashed_.count(key)) {
+        PushHashed(hashed_.at(key), merged, priority);
+        continue;
+      }
+      NDArray& local = local_[key];
       if (key_type_ == kStringKey) {
         local.AssignStorageInfo(
             profiler::ProfilerScope::Get()->GetCurrentProfilerScope() + "kvstore:push:",
@@ -285,7 +326,9 @@ class KVStoreLocal : public KVStore {
     GroupKVPairsPull(keys, values, &uniq_keys, &grouped_vals, ignore_sparse);
 
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
-      int key              = uniq_keys[i];
+      int key = uniq_keys[i];
+      CHECK(!hashed_.count(key)) << "the hash embedding of key " << key
+                                 << " can only be pulled with row_sparse_pull";
       const NDArray& local = local_[key];
       CHECK(!local.is_none()) << "key " << key << " has not been inited";
       comm_->Broadcast(key, local, grouped_vals[i], priority);
@@ -312,7 +355,14 @@ class KVStoreLocal : public KVStore {
     std::vector<std::vector<std::pair<NDArray*, NDArray>>> grouped_val_rowids;
     GroupKVPairsPullRsp(keys, val_rowids, &uniq_keys, &grouped_val_rowids, false);
     for (size_t i = 0; i < uniq_keys.size(); ++i) {
-      int key              = uniq_keys[i];
+      int key = uniq_keys[i];
+      if (hashed_.count(key)) {
+        for (auto& val_rowid : grouped_val_rowids[i]) {
+          PullHashed(hashed_.at(key), Unique(val_rowid.second, pinned_ctx_, priority),
+                     val_rowid.first, priority);
+        }
+        continue;
+      }
       const NDArray& local = local_[key];
       CHECK(!local.is_none()) << "key " << key << " has not been inited";
       CHECK_EQ(local.storage_type(), kRowSparseStorage)
@@ -357,6 +407,122 @@ class KVStoreLocal : public KVStore {
     PullImpl(okeys, outs, priority, true);
   }
 
+  /**
+   * \brief pushpull the small dense arrays reduced in place through fusion buffers of at
+   *  most MXNET_KVSTORE_FUSION_BYTES bytes, so that every buffer is reduced by a single
+   *  collective or server request instead of one per key.
+   *
+   * The keys of a buffer are consecutive keys of the call with the same data type and
+   * devices. The values are copied into the buffer by engine operators, so a buffer is
+   * reduced as soon as the values of its keys are computed, and copied back after.
+   * Keys with an updater are not fused, as the updater works on the original keys.
+   */
+  void FusedPushPull(const std::vector<int>& vkeys,
+                     const std::vector<int>& okeys,
+                     const std::vector<NDArray>& values,
+                     const std::vector<NDArray*>& outs,
+                     int priority) {
+    if (fusion_bytes_ == 0 || updater_ != nullptr || str_updater_ != nullptr ||
+        vkeys != okeys || values.size() != outs.size()) {
+      PushPullImpl(vkeys, okeys, values, outs, priority);
+      return;
+    }
+    // the values of every key, in the order of their first appearance
+    std::vector<int> keys;
+    std::unordered_map<int, std::vector<size_t>> positions;
+    for (size_t i = 0; i < vkeys.size(); ++i) {
+      if (!positions.count(vkeys[i]))
+        keys.push_back(vkeys[i]);
+      positions[vkeys[i]].push_back(i);
+    }
+    std::vector<int> rest_keys;
+    std::vector<NDArray> rest_values;
+    std::vector<NDArray*> rest_outs;
+    auto add_rest = [&](int key) {
+      for (size_t i : positions[key]) {
+        rest_keys.push_back(key);
+        rest_values.push_back(values[i]);
+        rest_outs.push_back(outs[i]);
+      }
+    };
+    // the devices of the values of key, empty if they cannot be fused
+    auto fusable_ctxs = [&](int key) {
+      std::vector<Context> ctxs;
+      for (size_t i : positions[key]) {
+        const NDArray& v = values[i];
+        if (v.storage_type() != kDefaultStorage || outs[i]->var() != v.var() ||
+            v.shape() != values[positions[key][0]].shape() ||
+            v.dtype() != values[positions[key][0]].dtype() ||
+            v.shape().Size() * mshadow::mshadow_sizeof(v.dtype()) * 2 > fusion_bytes_) {
+          return std::vector<Context>();
+        }
+        ctxs.push_back(v.ctx());
+      }
+      return ctxs;
+    };
+
+    std::vector<std::vector<int>> buckets;
+    std::vector<Context> bucket_ctxs;
+    int bucket_dtype    = -1;
+    size_t bucket_bytes = 0;
+    for (int key : keys) {
+      const std::vector<Context> ctxs = fusable_ctxs(key);
+      if (ctxs.empty()) {
+        add_rest(key);
+        continue;
+      }
+      const NDArray& v   = values[positions[key][0]];
+      const size_t bytes = v.shape().Size() * mshadow::mshadow_sizeof(v.dtype());
+      if (buckets.empty() || ctxs != bucket_ctxs || v.dtype() != bucket_dtype ||
+          bucket_bytes + bytes > fusion_bytes_) {
+        buckets.emplace_back();
+        bucket_ctxs  = ctxs;
+        bucket_dtype = v.dtype();
+        bucket_bytes = 0;
+      }
+      buckets.back().push_back(key);
+      bucket_bytes += bytes;
+    }
+
+    std::vector<std::vector<int>> fused;
+    for (const auto& bucket : buckets) {
+      if (bucket.size() == 1) {
+        add_rest(bucket[0]);
+      } else {
+        fused.push_back(bucket);
+      }
+    }
+    // pack the values into their buffers
+    for (const auto& bucket : fused) {
+      FusionBuffer& buf = GetFusionBuffer(bucket, values, positions);
+      for (size_t d = 0; d < buf.buffers.size(); ++d) {
+        size_t offset = 0;
+        for (int key : bucket) {
+          const NDArray& v = values[positions[key][d]];
+          NDArray part     = FusionPart(buf.buffers[d], offset, v.shape());
+          CopyFromTo(v, &part, priority);
+          offset += v.shape().Size();
+        }
+        rest_keys.push_back(buf.key);
+        rest_values.push_back(buf.buffers[d]);
+        rest_outs.push_back(&buf.buffers[d]);
+      }
+    }
+    PushPullImpl(rest_keys, rest_keys, rest_values, rest_outs, priority);
+    // unpack the reduced values
+    for (const auto& bucket : fused) {
+      FusionBuffer& buf = fusion_buffers_.at(bucket);
+      for (size_t d = 0; d < buf.buffers.size(); ++d) {
+        size_t offset = 0;
+        for (int key : bucket) {
+          NDArray* out = outs[positions[key][d]];
+          CopyFromTo(FusionPart(buf.buffers[d], offset, out->shape()), out, priority);
+          offset += out->shape().Size();
+        }
+      }
+    }
+  }
+
   /**
    * \brief group values on keys for push
    */
@@ -464,6 +630,38 @@ class KVStoreLocal : public KVStore {
     }
   }
 
+  /*! \brief fusion buffers of a list of keys, one per device */
+  struct FusionBuffer {
+    int key;
+    std::vector<NDArray> buffers;
+  };
+
+  FusionBuffer& GetFusionBuffer(const std::vector<int>& bucket,
+                                const std::vector<NDArray>& values,
+                                const std::unordered_map<int, std::vector<size_t>>& positions) {
+    auto it = fusion_buffers_.find(bucket);
+    if (it != fusion_buffers_.end())
+      return it->second;
+    size_t size = 0;
+    for (int key : bucket)
+      size += values[positions.at(key)[0]].shape().Size();
+    FusionBuffer buf;
+    buf.key = kFusionKeyBase + static_cast<int>(fusion_buffers_.size());
+    for (size_t i : positions.at(bucket[0])) {
+      NDArray buffer(mxnet::TShape(1, static_cast<dim_t>(size)), values[i].ctx(), false,
+                     values[i].dtype());
+      buffer = 0;
+      buf.buffers.push_back(buffer);
+    }
+    InitImpl({buf.key}, {buf.buffers[0]});
+    return fusion_buffers_.emplace(bucket, std::move(buf)).first->second;
+  }
+
+  /*! \brief view of the elements of buffer starting at offset, with shape */
+  static NDArray FusionPart(const NDArray& buffer, size_t offset, const mxnet::TShape& shape) {
+    return buffer.Slice(offset, offset + shape.Size()).Reshape(shape);
+  }
+
   void LookupKeys(const std::vector<std::string>& str_keys, std::vector<int>* keys) {
     for (size_t i = 0; i < str_keys.size(); ++i) {
       auto& str_key = str_keys[i];
@@ -529,6 +727,55 @@ class KVStoreLocal : public KVStore {
     return out;
   }
 
+  /*! \brief the hash table of a hash embedding key, accessed by the engine through var */
+  struct HashedKey {
+    std::shared_ptr<HashEmbeddingTable> table;
+    Engine::VarHandle var;
+    mxnet::TShape shape;
+  };
+
+  /*! \brief updates the rows of the table with the row_sparse gradient merged */
+  void PushHashed(const HashedKey& hashed, const NDArray& merged, int priority) {
+    CHECK_EQ(merged.storage_type(), kRowSparseStorage)
+        << "the gradients of a hash embedding are row_sparse";
+    CHECK_EQ(merged.dtype(), mshadow::kFloat32) << "hash embeddings are float32";
+    CHECK_EQ(merged.aux_type(rowsparse::kIdx), mshadow::kInt64)
+        << "the row ids of the gradients of a hash embedding are int64";
+    const NDArray grad = merged.ctx().dev_mask() == cpu::kDevMask ? merged
+                                                                  : merged.Copy(pinned_ctx_);
+    auto table = hashed.table;
+    Engine::Get()->PushSync(
+        [table, grad](RunContext rctx) {
+          if (!grad.storage_initialized())
+            return;
+          table->Push(grad.aux_data(rowsparse::kIdx).dptr<int64_t>(),
+                      grad.aux_shape(rowsparse::kIdx)[0],
+                      grad.data().dptr<float>());
+        },
+        pinned_ctx_, {grad.var()}, {hashed.var}, FnProperty::kCPUPrioritized, priority,
+        "KVStoreHashEmbeddingPush");
+  }
+
+  /*! \brief pulls the rows of the unique row ids from the table into out */
+  void PullHashed(const HashedKey& hashed, const NDArray& row_ids, NDArray* out, int priority) {
+    CHECK_EQ(out->dtype(), mshadow::kFloat32) << "hash embeddings are float32";
+    NDArray rows(kRowSparseStorage, hashed.shape, pinned_ctx_, true, mshadow::kFloat32);
+    auto table = hashed.table;
+    Engine::Get()->PushSync(
+        [table, row_ids, rows](RunContext rctx) {
+          NDArray ret = rows;
+          // the ids are the data of row_ids, as returned by Unique
+          const size_t num_rows = row_ids.aux_shape(rowsparse::kIdx)[0];
+          ret.CheckAndAlloc({mshadow::Shape1(num_rows)});
+          const int64_t* ids = row_ids.data().dptr<int64_t>();
+          std::copy(ids, ids + num_rows, ret.aux_data(rowsparse::kIdx).dptr<int64_t>());
+          table->Pull(ids, num_rows, ret.data().dptr<float>());
+        },
+        pinned_ctx_, {row_ids.var(), hashed.var}, {rows.var()}, FnProperty::kCPUPrioritized,
+        priority, "KVStoreHashEmbeddingPull");
+    CopyFromTo(rows, out, priority);
+  }
+
   /// reducer and broadcaster
   Comm* comm_;
   /// pinned context
@@ -541,10 +788,18 @@ class KVStoreLocal : public KVStore {
   std::unordered_map<int, std::string> reverse_str_key_dict_;
   /// the next available integer for string->int key mapping
   int next_str_key_ = 0;
+  /// hash tables of the hash embedding keys
+  std::unordered_map<int, HashedKey> hashed_;
   /// whether printed warning due to mismatch stype in each key
   std::unordered_set<int> warnings_printed_;
   /// whether int or string is used for keys
   KeyType key_type_ = kUndefinedKey;
+  /// first key of the fusion buffers, above the keys of the users
+  static constexpr int kFusionKeyBase = 1 << 30;
+  /// maximum size of a fusion buffer in bytes, 0 disables the fusion
+  size_t fusion_bytes_ = dmlc::GetEnv("MXNET_KVSTORE_FUSION_BYTES", static_cast<size_t>(0));
+  /// fusion buffers by list of fused keys
+  std::map<std::vector<int>, FusionBuffer> fusion_buffers_;
 };
 }  // namespace kvstore
 }  // namespace mxnet
@@ -38,7 +38,9 @@
 #include <tuple>
 #include "./comm.h"
 #include "./kvstore_local.h"
+#include "./kvstore_utils.h"
 #include "../common/cuda/utils.h"
+#include "../common/utils.h"
 
 // NCCL v2 introduces NCCL_MAJOR macro for versioning,
 // so if there is no such macro defined in nccl.h
@@ -56,14 +58,38 @@
 namespace mxnet {
 namespace kvstore {
 
+/**
+ * \brief NCCL data type of a mshadow type flag
+ */
+inline ncclDataType_t GetNCCLType(int dtype) {
+  switch (dtype) {
+    case mshadow::kFloat32:
+      return ncclFloat;
+    case mshadow::kFloat16:
+      return ncclHalf;
+    case mshadow::kFloat64:
+      return ncclDouble;
+    case mshadow::kUint8:
+      return ncclChar;
+    case mshadow::kInt32:
+      return ncclInt;
+    case mshadow::kInt64:
+      return ncclInt64;
+    default:
+      LOG(FATAL) << "Unknown type passed to NCCL KVStore";
+  }
+  return ncclNumTypes;
+}
+
 /**
  * \brief store data in local machine using NCCL
  */
 class KVStoreNCCL : public KVStoreLocal {
  public:
   KVStoreNCCL() : KVStoreLocal() {
-    // Due to aggregation, we do not use the Comm interface
-    comm_       = nullptr;
+    // Due to aggregation, the reductions and broadcasts do not use the Comm interface,
+    // it only retains the rows of row_sparse pulls
+    comm_       = new CommDevice();
     pinned_ctx_ = Context::CPUPinned(0);
     inited_     = false;
   }
@@ -84,13 +110,19 @@ class KVStoreNCCL : public KVStoreLocal {
     }
   }
 
+  void InitHashEmbeddingImpl(
+      const int key,
+      const mxnet::TShape& shape,
+      const std::vector<std::pair<std::string, std::string>>& params) override {
+    LOG(FATAL) << "NCCL kvstore does not support hash embeddings";
+  }
+
   void PushImpl(const std::vector<int>& keys,
                 const std::vector<NDArray>& values,
                 int priority) override {
     std::vector<int> uniq_keys;
     std::vector<std::vector<NDArray>> grouped_vals;
-    // nccl kvstore doesn't support sparse ndarray
-    GroupKVPairsHelper(keys, values, &uniq_keys, &grouped_vals, true);
+    GroupKVPairsHelper(keys, values, &uniq_keys, &grouped_vals, true, true);
 
     std::vector<const NDArray*> merged_ptrs;
     std::vector<NDArray*> local_ptrs;
@@ -149,7 +181,7 @@ class KVStoreNCCL : public KVStoreLocal {
     CHECK(ignore_sparse) << "nccl kvstore pull doesn't support ignore_sparse=False";
     std::vector<int> uniq_keys;
     std::vector<std::vector<NDArray*>> grouped_vals;
-    GroupKVPairsHelper(keys, values, &uniq_keys, &grouped_vals, true);
+    GroupKVPairsHelper(keys, values, &uniq_keys, &grouped_vals, true, false);
     std::vector<NDArray> locals;
     bool nccl_called = false;
 
@@ -172,12 +204,6 @@ class KVStoreNCCL : public KVStoreLocal {
     }
   }
 
-  void PullRowSparseImpl(const std::vector<int>& keys,
-                         const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
-                         int priority = 0) override {
-    LOG(FATAL) << "NCCL kvstore does not support sparse storage type";
-  }
-
   void SetGradientCompression(
       const std::vector<std::pair<std::string, std::string>>& kwargs) override {
     LOG(FATAL) << "NCCL kvstore does not support gradient compression";
@@ -185,23 +211,27 @@ class KVStoreNCCL : public KVStoreLocal {
 
  protected:
   /**
-   * \brief group values on keys
+   * \brief group values on keys, the row_sparse values are valid for pushes and ignored by
+   *  pulls, which use row_sparse_pull
    */
   template <typename T>
   void GroupKVPairsHelper(const std::vector<int>& keys,
                           const std::vector<T>& values,
                           std::vector<int>* uniq_keys,
                           std::vector<std::vector<T>>* grouped_vals,
-                          bool ignore_sparse) {
+                          bool ignore_sparse,
+                          bool is_push) {
     // check if the storage type of a value is valid
-    auto validator = [this](const int key, const T nd, bool ignore_sparse) -> bool {
+    auto validator = [this, is_push](const int key, const T nd, bool ignore_sparse) -> bool {
       CHECK(ignore_sparse) << "nccl kvstore pull doesn't support ignore_sparse=False";
       auto stype = ptr(nd)->storage_type();
       // valid NDArray
       if (stype == kDefaultStorage)
         return true;
+      if (stype == kRowSparseStorage)
+        return is_push;
       // invalid NDArray, abort
-      LOG(FATAL) << "NCCL kvstore does not support sparse storage type";
+      LOG(FATAL) << "NCCL kvstore does not support storage type " << stype;
       return false;
     };
     GroupKVPairs(keys, values, uniq_keys, grouped_vals, validator, ignore_sparse);
@@ -248,6 +278,11 @@ class KVStoreNCCL : public KVStoreLocal {
       std::sort(dev_ids.begin(), dev_ids.end());
       CHECK(device_ids_ == dev_ids) << "NCCL KVStore supports only single set of devices";
 
+      if (src[0].storage_type() == kRowSparseStorage) {
+        (*merged_ptrs)[k] = &ReduceRowSparse(key, src, priority);
+        continue;
+      }
+
       auto& buf = merge_buf_[key];
       int root  = buf.merged.ctx().dev_id;
       root_id   = FindRootId(src, root);
@@ -273,7 +308,7 @@ class KVStoreNCCL : public KVStoreLocal {
             auto& src     = srcs[k];
             auto& root_id = root_ids[k];
             auto& reduce  = reduces[k];
-            if (src.size() <= 1) {
+            if (src.size() <= 1 || src[0].storage_type() != kDefaultStorage) {
               continue;
             }
             int root = nccl_data_[src[root_id].ctx().dev_id].rank;
@@ -318,6 +353,170 @@ class KVStoreNCCL : public KVStoreLocal {
         "KVStoreReduce");
   }
 
+  /**
+   * \brief Reduces the row_sparse values of a key on the GPUs into the GPU of rank 0. The
+   *  row indices of every GPU are broadcast to the others, and every GPU computes their
+   *  union with UniqueImpl and retains its values on it, so that the values of all the GPUs
+   *  have the same rows and are summed in place by ncclReduce. Unlike the reduction of
+   *  CommDevice, every GPU sends only its share of the rows.
+   */
+  const NDArray& ReduceRowSparse(int key, const std::vector<NDArray>& src, int priority) {
+    const size_t num_devs = src.size();
+    // values ordered by NCCL rank
+    std::vector<NDArray> vals(num_devs), gathered(num_devs), retained(num_devs);
+    for (const auto& v : src) {
+      CHECK_EQ(v.aux_type(rowsparse::kIdx), mshadow::kInt64)
+          << "NCCL kvstore expects int64 row indices";
+      vals[nccl_data_[v.ctx().dev_id].rank] = v;
+    }
+    auto& merged = merge_buf_[key].merged;
+    if (merged.is_none()) {
+      merged = NDArray(kRowSparseStorage, vals[0].shape(), vals[0].ctx(), true, vals[0].dtype());
+    }
+    std::vector<Engine::VarHandle> val_vars, gathered_vars, retained_vars;
+    for (size_t r = 0; r < num_devs; ++r) {
+      // the row indices of all the GPUs, held by the values of a row_sparse array as in Unique
+      gathered[r] = NDArray(kRowSparseStorage,
+                            mshadow::Shape2(num_devs * vals[r].shape()[0], 1),
+                            vals[r].ctx(),
+                            true,
+                            mshadow::kInt64);
+      retained[r] = r == 0 ? merged
+                           : NDArray(kRowSparseStorage,
+                                     vals[r].shape(),
+                                     vals[r].ctx(),
+                                     true,
+                                     vals[r].dtype());
+      val_vars.push_back(vals[r].var());
+      gathered_vars.push_back(gathered[r].var());
+      if (r > 0)
+        retained_vars.push_back(retained[r].var());
+    }
+
+    Engine::Get()->PushSync(
+        [vals, gathered, this](RunContext rctx) {
+          std::vector<size_t> counts(vals.size()), offsets(vals.size() + 1, 0);
+          for (size_t r = 0; r < vals.size(); ++r) {
+            counts[r]      = vals[r].storage_initialized() ? vals[r].storage_shape()[0] : 0;
+            offsets[r + 1] = offsets[r] + counts[r];
+          }
+          mxnet::common::cuda::DeviceStore device_store;
+          for (size_t r = 0; r < vals.size(); ++r) {
+            gathered[r].CheckAndAlloc({mshadow::Shape1(offsets.back())});
+            const NCCLEntry& e = nccl_data_[vals[r].ctx().dev_id];
+            device_store.SetDevice(e.dev_id);
+            if (counts[r] > 0) {
+              CUDA_CALL(cudaMemcpyAsync(gathered[r].data().dptr<int64_t>() + offsets[r],
+                                        vals[r].aux_data(rowsparse::kIdx).dptr<int64_t>(),
+                                        counts[r] * sizeof(int64_t),
+                                        cudaMemcpyDeviceToDevice,
+                                        e.stream));
+            }
+          }
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          ncclGroupStart();
+          for (size_t root = 0; root < vals.size(); ++root) {
+            if (counts[root] == 0)
+              continue;
+            for (size_t r = 0; r < vals.size(); ++r) {
+              const NCCLEntry& e = nccl_data_[vals[r].ctx().dev_id];
+              ncclBcast(gathered[r].data().dptr<int64_t>() + offsets[root],
+                        counts[root],
+                        ncclInt64,
+                        root,
+                        e.comm,
+                        e.stream);
+            }
+          }
+          ncclGroupEnd();
+          for (size_t r = 0; r < vals.size(); ++r) {
+            device_store.SetDevice(vals[r].ctx().dev_id);
+            CUDA_CALL(cudaStreamSynchronize(nccl_data_[vals[r].ctx().dev_id].stream));
+          }
+        },
+        Context::CPU(),
+        val_vars,
+        gathered_vars,
+        FnProperty::kCPUPrioritized,
+        priority,
+        "KVStoreGatherRowIds");
+
+    for (size_t r = 0; r < num_devs; ++r) {
+      const NDArray val = vals[r], ids = gathered[r], out = retained[r];
+      Engine::Get()->PushAsync(
+          [val, ids, out](RunContext rctx, Engine::CallbackOnComplete on_complete) {
+            mshadow::Stream<gpu>* s = rctx.get_stream<gpu>();
+            const size_t num_ids    = ids.storage_shape()[0];
+            // sort the row indices and remove the duplicates
+            NDArray workspace;
+            NDArray uniq(kRowSparseStorage,
+                         mshadow::Shape2(num_ids, 1),
+                         ids.data(),
+                         {ids.aux_data(rowsparse::kIdx)},
+                         ids.ctx().dev_id);
+            if (num_ids > 0)
+              UniqueImpl(&workspace, s, uniq);
+            const TBlob rows = uniq.data();
+            NDArray retained = out;
+            if (val.storage_initialized() && rows.Size() > 0) {
+              common::SparseRetainOpForwardRspWrapper<gpu>(s, val, rows, kWriteTo, &retained);
+            } else {
+              // no rows on this GPU, it sends zeros for all the rows of the union
+              retained.CheckAndAlloc({mshadow::Shape1(rows.Size())});
+              cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+              const TBlob data    = retained.data();
+              const TBlob idx     = retained.aux_data(rowsparse::kIdx);
+              CUDA_CALL(cudaMemsetAsync(
+                  data.dptr_, 0, data.Size() * mshadow::mshadow_sizeof(data.type_flag_), stream));
+              CUDA_CALL(cudaMemcpyAsync(idx.dptr_,
+                                        rows.dptr_,
+                                        rows.Size() * sizeof(int64_t),
+                                        cudaMemcpyDeviceToDevice,
+                                        stream));
+            }
+            // wait for GPU operations to complete
+            s->Wait();
+            on_complete();
+          },
+          val.ctx(),
+          {val.var()},
+          {ids.var(), out.var()},
+          FnProperty::kGPUPrioritized,
+          priority,
+          "KVStoreRetainRowUnion");
+    }
+
+    Engine::Get()->PushSync(
+        [retained, this](RunContext rctx) {
+          const size_t size = retained[0].storage_initialized() ? retained[0].data().Size() : 0;
+          if (size == 0)
+            return;
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          ncclGroupStart();
+          for (size_t r = 0; r < retained.size(); ++r) {
+            const NCCLEntry& e = nccl_data_[retained[r].ctx().dev_id];
+            MSHADOW_TYPE_SWITCH(retained[r].dtype(), DType, {
+              ncclReduce(retained[r].data().dptr<DType>(),
+                         r == 0 ? retained[r].data().dptr<DType>() : nullptr,
+                         size,
+                         GetNCCLType(retained[r].dtype()),
+                         ncclSum,
+                         0,
+                         e.comm,
+                         e.stream);
+            });
+          }
+          ncclGroupEnd();
+        },
+        Context::CPU(),
+        retained_vars,
+        {merged.var()},
+        FnProperty::kCPUPrioritized,
+        priority,
+        "KVStoreReduceRowSparse");
+    return merged;
+  }
+
   virtual void Broadcast(const std::vector<int> keys,
                          const std::vector<NDArray>& srcs,
                          const std::vector<std::vector<NDArray*>>& dsts,
@@ -454,29 +653,15 @@ class KVStoreNCCL : public KVStoreLocal {
                int dtype = mshadow::kFloat32) {
     if (stype == kDefaultStorage) {
       key_attrs_.push_back(std::make_tuple(key, shape, dtype));
-    } else {
-      LOG(FATAL) << "NCCL KVStore does not support sparse storage type";
-    }
-  }
-
-  ncclDataType_t GetNCCLType(int dtype) {
-    switch (dtype) {
-      case mshadow::kFloat32:
-        return ncclFloat;
-      case mshadow::kFloat16:
-        return ncclHalf;
-      case mshadow::kFloat64:
-        return ncclDouble;
-      case mshadow::kUint8:
-        return ncclChar;
-      case mshadow::kInt32:
-        return ncclInt;
-      case mshadow::kInt64:
-        return ncclInt64;
-      default:
-        LOG(FATAL) << "Unknown type passed to NCCL KVStore";
+      // keys inited after the first reduction, e.g. kvstore fusion buffers
+      if (inited_ && !merge_buf_.empty()) {
+        const Context root = merge_buf_.begin()->second.merged.ctx();
+        merge_buf_[key].merged = NDArray(shape, root, false, dtype);
+      }
+    } else if (stype != kRowSparseStorage) {
+      // the buffers of the row_sparse keys are allocated by ReduceRowSparse
+      LOG(FATAL) << "NCCL KVStore does not support storage type " << stype;
     }
-    return ncclNumTypes;
   }
 
   void InitNCCL(const std::vector<Context>& devs) {
@@ -26,6 +26,9 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <utility>
 #include "./kvstore_dist.h"
 #include "mxnet/engine.h"
@@ -33,12 +36,82 @@
 namespace mxnet {
 namespace kvstore {
 
+/**
+ * \brief issues the requests of the parameter slices by priority, with at most credit bytes
+ *  in flight, so that the slices of the layers needed first by the next forward pass
+ *  overtake the large gradients already queued. A credit of 0 issues every request at once.
+ */
+class CreditScheduler {
+ public:
+  /*! \brief sends a request, and calls its argument once the request completes */
+  using Request = std::function<void(std::function<void()>)>;
+
+  explicit CreditScheduler(size_t credit) : credit_(credit) {}
+
+  void Schedule(int priority, size_t bytes, Request request) {
+    if (credit_ == 0) {
+      request([]() {});
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push(Task{priority, next_seq_++, bytes, std::move(request)});
+    }
+    Dispatch();
+  }
+
+ private:
+  struct Task {
+    int priority;
+    uint64_t seq;
+    size_t bytes;
+    Request request;
+  };
+  /*! \brief the higher priority first, then the first scheduled */
+  struct Later {
+    bool operator()(const Task& a, const Task& b) const {
+      return a.priority < b.priority || (a.priority == b.priority && a.seq > b.seq);
+    }
+  };
+
+  void Dispatch() {
+    std::vector<Task> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // a slice larger than the credit is sent alone
+      while (!queue_.empty() && (in_flight_ == 0 || in_flight_ + queue_.top().bytes <= credit_)) {
+        in_flight_ += queue_.top().bytes;
+        ready.push_back(queue_.top());
+        queue_.pop();
+      }
+    }
+    for (auto& task : ready) {
+      const size_t bytes = task.bytes;
+      task.request([this, bytes]() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          in_flight_ -= bytes;
+        }
+        Dispatch();
+      });
+    }
+  }
+
+  const size_t credit_;
+  std::mutex mutex_;
+  std::priority_queue<Task, std::vector<Task>, Later> queue_;
+  size_t in_flight_  = 0;
+  uint64_t next_seq_ = 0;
+};
+
 /**
  * \brief distributed p3store
  */
 class P3StoreDist : public KVStoreDist {
  public:
-  explicit P3StoreDist(bool use_device_comm) : KVStoreDist(use_device_comm) {
+  explicit P3StoreDist(bool use_device_comm)
+      : KVStoreDist(use_device_comm),
+        scheduler_(dmlc::GetEnv("MXNET_KVSTORE_P3_CREDIT", static_cast<size_t>(0))) {
     slice_threshold_ = dmlc::GetEnv("MXNET_KVSTORE_SLICE_THRESHOLD", 40 * 1000);
   }
 
@@ -94,19 +167,22 @@ class P3StoreDist : public KVStoreDist {
         auto ks = pskv.keys.segment(idx, idx + 1);
         auto ls = pskv.lens.segment(idx, idx + 1);
         auto vs = vals.segment(off, off + pskv.lens[idx]);
-        CHECK_NOTNULL(ps_worker_)
-            ->ZPush(
-                ks,
-                vs,
-                ls,
-                cmd,
-                [counter, cb]() {
-                  if (--(*counter) == 0) {
-                    delete counter;
-                    cb();
-                  }
-                },
-                priority);
+        scheduler_.Schedule(priority, pskv.lens[idx], [=](std::function<void()> done) {
+          CHECK_NOTNULL(ps_worker_)
+              ->ZPush(
+                  ks,
+                  vs,
+                  ls,
+                  cmd,
+                  [counter, cb, done]() {
+                    done();
+                    if (--(*counter) == 0) {
+                      delete counter;
+                      cb();
+                    }
+                  },
+                  priority);
+        });
         off += pskv.lens[idx];
       }
     };
@@ -142,21 +218,24 @@ class P3StoreDist : public KVStoreDist {
         auto ks = pskv.keys.segment(idx, idx + 1);
         auto ls = new ps::SArray<int>(1, pskv.lens[idx]);
         auto vs = new ps::SArray<char>(data + off, pskv.lens[idx], false);
-        CHECK_NOTNULL(ps_worker_)
-            ->ZPull(
-                ks,
-                vs,
-                ls,
-                cmd,
-                [vs, ls, counter, cb]() {
-                  delete vs;
-                  delete ls;
-                  if (--(*counter) == 0) {
-                    delete counter;
-                    cb();
-                  }
-                },
-                priority);
+        scheduler_.Schedule(priority, pskv.lens[idx], [=](std::function<void()> done) {
+          CHECK_NOTNULL(ps_worker_)
+              ->ZPull(
+                  ks,
+                  vs,
+                  ls,
+                  cmd,
+                  [vs, ls, counter, cb, done]() {
+                    delete vs;
+                    delete ls;
+                    done();
+                    if (--(*counter) == 0) {
+                      delete counter;
+                      cb();
+                    }
+                  },
+                  priority);
+        });
         off += pskv.lens[idx];
       }
     };
@@ -196,22 +275,25 @@ class P3StoreDist : public KVStoreDist {
         auto ks = pskv.keys.segment(idx, idx + 1);
         auto ls = new ps::SArray<int>(1, pskv.lens[idx]);
         auto vs = new ps::SArray<char>(data + off, pskv.lens[idx], false);
-        CHECK_NOTNULL(ps_worker_)
-            ->ZPushPull(
-                ks,
-                *vs,
-                vs,
-                ls,
-                cmd,
-                [vs, ls, counter, cb]() {
-                  delete vs;
-                  delete ls;
-                  if (--(*counter) == 0) {
-                    delete counter;
-                    cb();
-                  }
-                },
-                priority);
+        scheduler_.Schedule(priority, pskv.lens[idx], [=](std::function<void()> done) {
+          CHECK_NOTNULL(ps_worker_)
+              ->ZPushPull(
+                  ks,
+                  *vs,
+                  vs,
+                  ls,
+                  cmd,
+                  [vs, ls, counter, cb, done]() {
+                    delete vs;
+                    delete ls;
+                    done();
+                    if (--(*counter) == 0) {
+                      delete counter;
+                      cb();
+                    }
+                  },
+                  priority);
+        });
         off += pskv.lens[idx];
       }
     };
@@ -263,6 +345,10 @@ class P3StoreDist : public KVStoreDist {
    * \brief threshold for the parameter slice size
    */
   size_t slice_threshold_;
+  /**
+   * \brief flow control of the slice requests
+   */
+  CreditScheduler scheduler_;
 };
 
 }  // namespace kvstore
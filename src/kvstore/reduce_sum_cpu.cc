@@ -0,0 +1,394 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file reduce_sum_cpu.cc
+ * \brief sum of the dense CPU arrays reduced by CommCPU, vectorized for the CPU instruction sets
+ *  and split over the NUMA nodes the arrays are on
+ */
+#include "./reduce_sum_cpu.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "../common/cpu_isa.h"
+#include "../common/numa.h"
+
+#if MXNET_CPU_ISA_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace mxnet {
+namespace kvstore {
+
+namespace {
+
+/*! \brief the least memory a thread reads and writes, below which more threads do not pay */
+constexpr size_t kMinBytesPerThread = 1 << 20;
+
+/*! \brief elements of the blocks the inputs are added to while they stay in L1 */
+constexpr size_t kBlock = 4096;
+
+/*! \brief inputs added to a block in one pass, which the prefetchers follow */
+constexpr size_t kGroup = 8;
+
+/*!
+ * \brief adds the n inputs to out in [begin, end), or writes their sum when first, in which case
+ *  out may be in[0]
+ */
+template <typename DType>
+void SumBlock(const DType* const* in,
+              size_t n,
+              bool first,
+              DType* out,
+              size_t begin,
+              size_t end,
+              bool stream) {
+  size_t i = 0;
+  // the first pass reads in[0] in place of out
+  const DType* base = first ? in[i++] : out;
+  // the passes add up to three inputs, in loops the compiler vectorizes
+  while (i < n || base != out) {
+    const size_t m = std::min<size_t>(n - i, 3);
+    const DType* a = m > 0 ? in[i] : nullptr;
+    const DType* b = m > 1 ? in[i + 1] : nullptr;
+    const DType* c = m > 2 ? in[i + 2] : nullptr;
+    switch (m) {
+      case 0:
+        std::copy(base + begin, base + end, out + begin);
+        break;
+      case 1:
+        for (size_t j = begin; j < end; ++j)
+          out[j] = base[j] + a[j];
+        break;
+      case 2:
+        for (size_t j = begin; j < end; ++j)
+          out[j] = base[j] + a[j] + b[j];
+        break;
+      default:
+        for (size_t j = begin; j < end; ++j)
+          out[j] = base[j] + a[j] + b[j] + c[j];
+        break;
+    }
+    i += m;
+    base = out;
+  }
+}
+
+#if MXNET_CPU_ISA_DISPATCH
+/*! \brief base[j] plus the first M of a[j], b[j] and c[j] */
+template <int M>
+inline float SumAt(const float* base, const float* a, const float* b, const float* c, size_t j) {
+  float sum = base[j];
+  if (M > 0)
+    sum += a[j];
+  if (M > 1)
+    sum += b[j];
+  if (M > 2)
+    sum += c[j];
+  return sum;
+}
+
+namespace avx2 {
+
+/*! \brief writes to out base plus the first M of a, b and c in [begin, end) */
+template <int M>
+MXNET_TARGET_AVX2 void SumPass(const float* base,
+                               const float* a,
+                               const float* b,
+                               const float* c,
+                               float* out,
+                               size_t begin,
+                               size_t end,
+                               bool stream) {
+  size_t j = begin;
+  // the non-temporal stores are aligned
+  for (; stream && j < end && reinterpret_cast<uintptr_t>(out + j) % 32 != 0; ++j)
+    out[j] = SumAt<M>(base, a, b, c, j);
+  for (; j + 8 <= end; j += 8) {
+    __m256 acc = _mm256_loadu_ps(base + j);
+    if (M > 0)
+      acc = _mm256_add_ps(acc, _mm256_loadu_ps(a + j));
+    if (M > 1)
+      acc = _mm256_add_ps(acc, _mm256_loadu_ps(b + j));
+    if (M > 2)
+      acc = _mm256_add_ps(acc, _mm256_loadu_ps(c + j));
+    if (stream)
+      _mm256_stream_ps(out + j, acc);
+    else
+      _mm256_storeu_ps(out + j, acc);
+  }
+  for (; j < end; ++j)
+    out[j] = SumAt<M>(base, a, b, c, j);
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+template <int M>
+MXNET_TARGET_AVX512 void SumPass(const float* base,
+                                 const float* a,
+                                 const float* b,
+                                 const float* c,
+                                 float* out,
+                                 size_t begin,
+                                 size_t end,
+                                 bool stream) {
+  size_t j = begin;
+  for (; stream && j < end && reinterpret_cast<uintptr_t>(out + j) % 64 != 0; ++j)
+    out[j] = SumAt<M>(base, a, b, c, j);
+  for (; j + 16 <= end; j += 16) {
+    __m512 acc = _mm512_loadu_ps(base + j);
+    if (M > 0)
+      acc = _mm512_add_ps(acc, _mm512_loadu_ps(a + j));
+    if (M > 1)
+      acc = _mm512_add_ps(acc, _mm512_loadu_ps(b + j));
+    if (M > 2)
+      acc = _mm512_add_ps(acc, _mm512_loadu_ps(c + j));
+    if (stream)
+      _mm512_stream_ps(out + j, acc);
+    else
+      _mm512_storeu_ps(out + j, acc);
+  }
+  if (j < end) {
+    const __mmask16 mask = (1u << (end - j)) - 1;
+    __m512 acc           = _mm512_maskz_loadu_ps(mask, base + j);
+    if (M > 0)
+      acc = _mm512_add_ps(acc, _mm512_maskz_loadu_ps(mask, a + j));
+    if (M > 1)
+      acc = _mm512_add_ps(acc, _mm512_maskz_loadu_ps(mask, b + j));
+    if (M > 2)
+      acc = _mm512_add_ps(acc, _mm512_maskz_loadu_ps(mask, c + j));
+    _mm512_mask_storeu_ps(out + j, mask, acc);
+  }
+}
+
+}  // namespace avx512
+
+/*! \brief SumBlock of the float32 blocks by the SumPass of an instruction set */
+template <template <int> class Pass>
+void SumBlockByPasses(const float* const* in,
+                      size_t n,
+                      bool first,
+                      float* out,
+                      size_t begin,
+                      size_t end,
+                      bool stream) {
+  size_t i          = 0;
+  const float* base = first ? in[i++] : out;
+  while (i < n || base != out) {
+    const size_t m         = std::min<size_t>(n - i, 3);
+    const float* a         = m > 0 ? in[i] : nullptr;
+    const float* b         = m > 1 ? in[i + 1] : nullptr;
+    const float* c         = m > 2 ? in[i + 2] : nullptr;
+    const bool stream_pass = stream && i + m == n;
+    switch (m) {
+      case 0:
+        Pass<0>::Run(base, a, b, c, out, begin, end, stream_pass);
+        break;
+      case 1:
+        Pass<1>::Run(base, a, b, c, out, begin, end, stream_pass);
+        break;
+      case 2:
+        Pass<2>::Run(base, a, b, c, out, begin, end, stream_pass);
+        break;
+      default:
+        Pass<3>::Run(base, a, b, c, out, begin, end, stream_pass);
+        break;
+    }
+    i += m;
+    base = out;
+  }
+}
+
+template <int M>
+struct AVX2Pass {
+  static void Run(const float* base,
+                  const float* a,
+                  const float* b,
+                  const float* c,
+                  float* out,
+                  size_t begin,
+                  size_t end,
+                  bool stream) {
+    avx2::SumPass<M>(base, a, b, c, out, begin, end, stream);
+  }
+};
+
+template <int M>
+struct AVX512Pass {
+  static void Run(const float* base,
+                  const float* a,
+                  const float* b,
+                  const float* c,
+                  float* out,
+                  size_t begin,
+                  size_t end,
+                  bool stream) {
+    avx512::SumPass<M>(base, a, b, c, out, begin, end, stream);
+  }
+};
+#endif  // MXNET_CPU_ISA_DISPATCH
+
+/*! \brief the float32 blocks are summed with the widest vectors of the CPU */
+void SumBlock(const float* const* in,
+              size_t n,
+              bool first,
+              float* out,
+              size_t begin,
+              size_t end,
+              bool stream) {
+#if MXNET_CPU_ISA_DISPATCH
+  static const common::CPUISA isa = common::GetCPUISA();
+  if (isa >= common::CPUISA::kAVX512 && isa <= common::CPUISA::kAMX)
+    return SumBlockByPasses<AVX512Pass>(in, n, first, out, begin, end, stream);
+  if (isa >= common::CPUISA::kAVX2 && isa <= common::CPUISA::kAMX)
+    return SumBlockByPasses<AVX2Pass>(in, n, first, out, begin, end, stream);
+#endif
+  SumBlock<float>(in, n, first, out, begin, end, stream);
+}
+
+/*!
+ * \brief the sum of the inputs in [begin, end) of out, by blocks, with non-temporal stores when
+ *  stream. With first, out is written and may be in[0], otherwise the inputs are added to it.
+ */
+template <typename DType>
+void SumRange(const std::vector<const DType*>& in,
+              bool first,
+              DType* out,
+              size_t begin,
+              size_t end,
+              bool stream) {
+  for (size_t b = begin; b < end; b += kBlock) {
+    const size_t e = std::min(b + kBlock, end);
+    for (size_t g = 0; g < in.size(); g += kGroup) {
+      const size_t n  = std::min(kGroup, in.size() - g);
+      const bool last = g + n == in.size();
+      SumBlock(in.data() + g, n, first && g == 0, out, b, e, stream && last);
+    }
+  }
+#if MXNET_CPU_ISA_DISPATCH
+  // the non-temporal stores are visible to the other threads once the reduction returns
+  if (stream)
+    _mm_sfence();
+#endif
+}
+
+/*! \brief the threads of a sum reading num_arrays arrays and writing one */
+int NumThreads(const ReduceSumArgs& args, size_t num_arrays, int max_threads) {
+  if (args.size < args.min_parallel_size || max_threads <= 1)
+    return 1;
+  const size_t bytes = (num_arrays + 1) * args.size * mshadow::mshadow_sizeof(args.dtype);
+  return static_cast<int>(std::max<size_t>(
+      1, std::min<size_t>(bytes / kMinBytesPerThread, static_cast<size_t>(max_threads))));
+}
+
+/*! \brief the sum over nthreads threads, each on a contiguous range of whole cache lines */
+template <typename DType>
+void SumParallel(const std::vector<const DType*>& in,
+                 bool first,
+                 DType* out,
+                 size_t size,
+                 bool stream,
+                 int nthreads) {
+  if (nthreads <= 1) {
+    SumRange(in, first, out, 0, size, stream);
+    return;
+  }
+  const size_t line  = std::max<size_t>(64 / sizeof(DType), 1);
+  const size_t chunk = ((size + nthreads - 1) / nthreads + line - 1) / line * line;
+#pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+  for (int t = 0; t < nthreads; ++t) {
+    const size_t begin = std::min(t * chunk, size);
+    const size_t end   = std::min(begin + chunk, size);
+    if (begin < end)
+      SumRange(in, first, out, begin, end, stream);
+  }
+}
+
+template <typename DType>
+void ReduceSum(const ReduceSumArgs& args) {
+  DType* out = static_cast<DType*>(args.out);
+  // the inputs of the node of out, or of no known node, and those of the other nodes. An input
+  // out overwrites is summed first of all, by the threads of out.
+  std::vector<const DType*> home;
+  std::map<int, std::vector<const DType*>> remote;
+  for (size_t i = 0; i < args.in.size(); ++i) {
+    const int node  = args.in_nodes.empty() ? -1 : args.in_nodes[i];
+    const DType* in = static_cast<const DType*>(args.in[i]);
+    if (in == out || node < 0 || node == args.out_node || node >= common::numa::NumNodes() ||
+        static_cast<size_t>(node) >= args.partials.size() || args.partials[node] == nullptr)
+      home.push_back(in);
+    else
+      remote[node].push_back(in);
+  }
+  // a node with a single input has nothing to sum before sending it
+  for (auto it = remote.begin(); it != remote.end();) {
+    if (it->second.size() == 1) {
+      home.push_back(it->second[0]);
+      it = remote.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  const int home_threads = NumThreads(args, home.size(), args.max_threads);
+  const bool home_stream = remote.empty() && std::find(home.begin(), home.end(), out) == home.end();
+  if (remote.empty()) {
+    SumParallel(home, true, out, args.size, home_stream, home_threads);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  std::vector<const DType*> partials;
+  for (const auto& kv : remote) {
+    const int node = kv.first;
+    DType* partial = static_cast<DType*>(args.partials[node]);
+    partials.push_back(partial);
+    const int node_threads = static_cast<int>(common::numa::NodeCPUs(node).size());
+    const int nthreads =
+        NumThreads(args, kv.second.size(), std::min(args.max_threads, node_threads));
+    workers.emplace_back([&args, &kv, node, partial, nthreads]() {
+      common::numa::BindCurrentThreadToNode(node);
+      SumParallel(kv.second, true, partial, args.size, true, nthreads);
+    });
+  }
+  if (!home.empty())
+    SumParallel(home, true, out, args.size, false, home_threads);
+  for (auto& worker : workers)
+    worker.join();
+  SumParallel(partials, home.empty(), out, args.size, false, home_threads);
+}
+
+}  // namespace
+
+void ReduceSumCPU(const ReduceSumArgs& args) {
+  CHECK(!args.in.empty());
+  CHECK(args.in_nodes.empty() || args.in_nodes.size() == args.in.size());
+  MSHADOW_TYPE_SWITCH(args.dtype, DType, { ReduceSum<DType>(args); });
+}
+
+}  // namespace kvstore
+}  // namespace mxnet
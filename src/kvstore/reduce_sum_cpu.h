@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file reduce_sum_cpu.h
+ * \brief sum of the dense CPU arrays reduced by CommCPU, vectorized for the CPU instruction sets
+ *  and split over the NUMA nodes the arrays are on
+ */
+#ifndef MXNET_KVSTORE_REDUCE_SUM_CPU_H_
+#define MXNET_KVSTORE_REDUCE_SUM_CPU_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/*! \brief the arrays summed into out by ReduceSumCPU, of size elements of type dtype */
+struct ReduceSumArgs {
+  std::vector<const void*> in;
+  /*! \brief the NUMA nodes of the inputs, -1 for unknown, or empty when none is known */
+  std::vector<int> in_nodes;
+  /*!
+   * \brief buffers of size elements by NUMA node, for the partial sums of the inputs on the
+   *  nodes other than the one of out, or empty
+   */
+  std::vector<void*> partials;
+  /*! \brief the output, which may be in[0] */
+  void* out;
+  /*! \brief the NUMA node of out, -1 for unknown */
+  int out_node;
+  size_t size;
+  int dtype;
+  /*! \brief the arrays of fewer elements are summed by the calling thread */
+  size_t min_parallel_size;
+  /*! \brief the most threads summing on each NUMA node */
+  int max_threads;
+};
+
+/*!
+ * \brief writes to out the sum of the inputs. The threads get contiguous ranges of at least
+ *  1 MB of the memory the sum reads and writes, up to max_threads, since a few threads
+ *  saturate the memory bandwidth. The float32 sums use AVX2 or AVX-512 and, when out is not
+ *  an input, non-temporal stores. When two inputs or more are on a NUMA node other than the
+ *  one of out, threads pinned to that node sum them into its partial sum first, while the
+ *  others sum the inputs of the node of out, so that each node sends its sum only over the
+ *  interconnect.
+ */
+void ReduceSumCPU(const ReduceSumArgs& args);
+
+}  // namespace kvstore
+}  // namespace mxnet
+#endif  // MXNET_KVSTORE_REDUCE_SUM_CPU_H_
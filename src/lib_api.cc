@@ -99,14 +99,15 @@ void mxnet::ext::MXSparse::set(void* data_ptr,
 }
 
 mxnet::ext::MXTensor::MXTensor()
-    : data_ptr(nullptr), dtype(kUNSET), verID(0), stype(kDefaultStorage) {}
+    : data_ptr(nullptr), dtype(kUNSET), verID(0), stype(kDefaultStorage), req(kReqWrite) {}
 mxnet::ext::MXTensor::MXTensor(const MXTensor& oth)
     : data_ptr(oth.data_ptr),
       shape(oth.shape),
       dtype(oth.dtype),
       verID(oth.verID),
       ctx(oth.ctx),
-      stype(oth.stype) {
+      stype(oth.stype),
+      req(oth.req) {
   setDLTensor();
 }
 
@@ -121,7 +122,8 @@ mxnet::ext::MXTensor::MXTensor(void* data_ptr,
       dtype(dtype),
       verID(vID),
       ctx(std::move(mx_ctx)),
-      stype(stype) {
+      stype(stype),
+      req(kReqWrite) {
   setDLTensor();
 }
 
@@ -856,6 +858,7 @@ mxnet::ext::CustomOp::CustomOp(const char* op_name)
       infer_storage_type(nullptr),
       infer_shape(nullptr),
       mutate_inputs(nullptr),
+      inplace(nullptr),
       isSGop(false) {}
 
 mxnet::ext::CustomOp& mxnet::ext::CustomOp::setForward(mxnet::ext::fcomp_t fcomp, const char* ctx) {
@@ -898,6 +901,11 @@ mxnet::ext::CustomOp& mxnet::ext::CustomOp::setMutateInputs(mxnet::ext::mutateIn
   return *this;
 }
 
+mxnet::ext::CustomOp& mxnet::ext::CustomOp::setInplace(mxnet::ext::inplace_t func) {
+  inplace = func;
+  return *this;
+}
+
 mxnet::ext::CustomOp& mxnet::ext::CustomOp::setCreateOpState(mxnet::ext::createOpState_t func,
                                                              const char* ctx) {
   if (create_op_ctx_map.count(ctx) > 0)
@@ -1029,7 +1037,8 @@ MX_VOID_RET _opRegGet(int idx,
                       mxnet::ext::inferType_t* type,
                       mxnet::ext::inferSType_t* stype,
                       mxnet::ext::inferShape_t* shape,
-                      mxnet::ext::mutateInputs_t* mutate) {
+                      mxnet::ext::mutateInputs_t* mutate,
+                      mxnet::ext::inplace_t* inplace) {
   mxnet::ext::CustomOp& op = mxnet::ext::Registry<mxnet::ext::CustomOp>::get()->get(idx);
   *name                    = op.name;
   *parse                   = op.parse_attrs;
@@ -1037,6 +1046,7 @@ MX_VOID_RET _opRegGet(int idx,
   *stype                   = op.infer_storage_type;
   *shape                   = op.infer_shape;
   *mutate                  = op.mutate_inputs;
+  *inplace                 = op.inplace;
   *isSGop                  = op.isSGop;
   op.mapToVector();
   *forward_ctx     = op.forward_ctx_cstr.data();
@@ -1252,7 +1262,8 @@ MX_INT_RET _opCallFCompute(mxnet::ext::fcomp_t fcomp,
                            int64_t* in_indptr_shapes,
                            int64_t* out_indptr_shapes,
                            void* rng_cpu_states,
-                           void* rng_gpu_states) {
+                           void* rng_gpu_states,
+                           int* outreqs) {
   // create map of attributes from list
   std::unordered_map<std::string, std::string> attrs;
   for (int i = 0; i < num; i++) {
@@ -1339,6 +1350,7 @@ MX_INT_RET _opCallFCompute(mxnet::ext::fcomp_t fcomp,
                            mxnet::ext::MXContext(outdev_type[i], outdev_id[i]),
                            type);
     }
+    outputs[i].req = static_cast<mxnet::ext::MXReqType>(outreqs[i]);
   }
 
   mxnet::ext::OpResource res(cpu_malloc,
@@ -1383,6 +1395,37 @@ MX_INT_RET _opCallMutateInputs(mxnet::ext::mutateInputs_t mutate,
   return retval;
 }
 
+/*! \brief returns status of calling inplace function for operator from library */
+MX_INT_RET _opCallInplace(mxnet::ext::inplace_t inplace,
+                          const char* const* keys,
+                          const char* const* vals,
+                          int num,
+                          int** inplace_pairs,
+                          int* pairs_size) {
+  // create map of attributes from list
+  std::unordered_map<std::string, std::string> attrs;
+  for (int i = 0; i < num; i++) {
+    attrs[std::string(keys[i])] = std::string(vals[i]);
+  }
+
+  // create a vector of (input, output) index pairs
+  std::vector<std::pair<int, int> > pairs;
+
+  int retval = inplace(attrs, &pairs);
+  if (!retval)
+    return retval;
+
+  // output the pairs flattened, input index first
+  *pairs_size    = pairs.size();
+  *inplace_pairs = static_cast<int*>(malloc(*pairs_size * 2 * sizeof(int)));
+  for (int i = 0; i < *pairs_size; i++) {
+    (*inplace_pairs)[2 * i]     = pairs[i].first;
+    (*inplace_pairs)[2 * i + 1] = pairs[i].second;
+  }
+
+  return retval;
+}
+
 /*! \brief returns status of calling createStatefulOp function for operator from library */
 MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
                                 const char* const* keys,
@@ -1467,7 +1510,8 @@ MX_INT_RET _opCallFStatefulCompute(int is_forward,
                                    int64_t* in_indptr_shapes,
                                    int64_t* out_indptr_shapes,
                                    void* rng_cpu_states,
-                                   void* rng_gpu_states) {
+                                   void* rng_gpu_states,
+                                   int* outreqs) {
   // create a vector of tensors for inputs
   std::vector<mxnet::ext::MXTensor> inputs(num_in);
   // create a vector for sparse inputs
@@ -1549,6 +1593,7 @@ MX_INT_RET _opCallFStatefulCompute(int is_forward,
                            mxnet::ext::MXContext(outdev_type[i], outdev_id[i]),
                            type);
     }
+    outputs[i].req = static_cast<mxnet::ext::MXReqType>(outreqs[i]);
   }
 
   mxnet::ext::OpResource res(cpu_malloc,
@@ -26,6 +26,7 @@
 #include "mxnet/libinfo.h"
 #include <bitset>
 #include "mxnet/base.h"
+#include "./common/cpu_isa.h"
 
 namespace mxnet {
 namespace features {
@@ -39,6 +40,7 @@ class FeatureSet {
     feature_bits.set(NCCL, MXNET_USE_NCCL);
     feature_bits.set(TENSORRT, MXNET_USE_TENSORRT);
     feature_bits.set(CUTENSOR, MXNET_USE_CUTENSOR);
+    feature_bits.set(CUSPARSELT, MXNET_USE_CUSPARSELT);
 
     // Check flags for example with gcc -msse3 -mavx2 -dM -E - < /dev/null | egrep "SSE|AVX"
 #if __SSE__
@@ -65,6 +67,18 @@ class FeatureSet {
 #if __AVX2__
     feature_bits.set(CPU_AVX2);
 #endif
+    const common::CPUFeatures& cpu = common::GetCPUFeatures();
+    feature_bits.set(CPU_AVX512F, cpu.avx512f);
+    feature_bits.set(CPU_AVX512_BF16, cpu.avx512_bf16);
+    feature_bits.set(CPU_AVX512_VNNI, cpu.avx512_vnni);
+    feature_bits.set(CPU_AMX_BF16, cpu.amx_tile && cpu.amx_bf16);
+    feature_bits.set(CPU_AMX_INT8, cpu.amx_tile && cpu.amx_int8);
+    feature_bits.set(CPU_NEON, cpu.neon);
+    feature_bits.set(CPU_ASIMD_DOTPROD, cpu.asimd_dotprod);
+    feature_bits.set(CPU_SVE, cpu.sve);
+    feature_bits.set(CPU_SVE2, cpu.sve2);
+    feature_bits.set(CPU_ARM_BF16, cpu.arm_bf16);
+    feature_bits.set(CPU_ARM_I8MM, cpu.i8mm);
 
     // CPU
     feature_bits.set(OPENMP, MXNET_USE_OPENMP);
@@ -133,6 +147,7 @@ const std::vector<std::string> EnumNames::names = {
     "NCCL",
     "TENSORRT",
     "CUTENSOR",
+    "CUSPARSELT",
     "CPU_SSE",
     "CPU_SSE2",
     "CPU_SSE3",
@@ -141,6 +156,17 @@ const std::vector<std::string> EnumNames::names = {
     "CPU_SSE4A",
     "CPU_AVX",
     "CPU_AVX2",
+    "CPU_AVX512F",
+    "CPU_AVX512_BF16",
+    "CPU_AVX512_VNNI",
+    "CPU_AMX_BF16",
+    "CPU_AMX_INT8",
+    "CPU_NEON",
+    "CPU_ASIMD_DOTPROD",
+    "CPU_SVE",
+    "CPU_SVE2",
+    "CPU_ARM_BF16",
+    "CPU_ARM_I8MM",
     "OPENMP",
     "SSE",
     "F16C",
@@ -30,15 +30,26 @@
 #include <mxnet/ndarray.h>
 #include <mxnet/resource.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
 #include <mshadow/tensor.h>
 
 #include "./ndarray_function.h"
+#include "./p2p_copy.h"
 
+#include "../common/object_pool.h"
 #include "../common/utils.h"
 #include "../operator/nn/mkldnn/mkldnn_base-inl.h"
 #include "../operator/tensor/init_op.h"
 #include "../operator/tensor/matrix_op-inl.h"
 #include "../profiler/storage_profiler.h"
+#include "../serialization/device_staging.h"
+#include "../storage/spill_manager.h"
 
 #if MXNET_USE_OPENCV
 #include <opencv2/opencv.hpp>
@@ -83,10 +94,9 @@ void NDArray::ReInit(const NDArrayStorageType stype,
     } else {
       storage_shape = *pStorage_shapes;
     }
-    ptr_ = std::make_shared<Chunk>(
-        stype, storage_shape, ctx, delay_alloc, dtype, aux_types, aux_shapes);
+    ptr_ = NewChunk(stype, storage_shape, ctx, delay_alloc, dtype, aux_types, aux_shapes);
   } else {
-    ptr_ = std::make_shared<Chunk>(shape, ctx, delay_alloc, dtype);
+    ptr_ = NewChunk(shape, ctx, delay_alloc, dtype);
   }
 }
 
@@ -96,12 +106,14 @@ void NDArray::AssignStorageInfo(const std::string& profiler_scope, const std::st
   }
   ptr_->shandle.profiler_scope = profiler_scope;
   ptr_->shandle.name           = name;
+  Storage::Get()->UpdateStorageInfo(ptr_->shandle);
 #if MXNET_USE_CUDA
   profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(ptr_->shandle);
 #endif  // MXNET_USE_CUDA
   for (Storage::Handle& aux_handle : ptr_->aux_handles) {
     aux_handle.profiler_scope = profiler_scope;
     aux_handle.name           = name + "_aux_data";
+    Storage::Get()->UpdateStorageInfo(aux_handle);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(aux_handle);
 #endif  // MXNET_USE_CUDA
@@ -115,6 +127,40 @@ void NDArray::SetShapeFromChunk() const {
   }
 }
 
+namespace {
+
+/*! \brief pool of blocks of kBytes, for the chunks with their reference counts */
+template <size_t kBytes>
+struct ChunkPool {
+  using Block = typename std::aligned_storage<kBytes, alignof(std::max_align_t)>::type;
+
+  static common::ObjectPool<Block>* Get() {
+    // never released, as the arrays of static objects may be released after the pool would be
+    static auto* pool =
+        new std::shared_ptr<common::ObjectPool<Block>>(common::ObjectPool<Block>::_GetSharedRef());
+    return pool->get();
+  }
+};
+
+}  // namespace
+
+// std::allocate_shared places the chunk after its reference counts and a few pointers
+void* NDArray::AllocChunkMemory(size_t bytes) {
+  using Pool = ChunkPool<sizeof(Chunk) + 64>;
+  if (bytes > sizeof(Pool::Block))
+    return ::operator new(bytes);
+  return Pool::Get()->New();
+}
+
+void NDArray::FreeChunkMemory(void* ptr, size_t bytes) {
+  using Pool = ChunkPool<sizeof(Chunk) + 64>;
+  if (bytes > sizeof(Pool::Block)) {
+    ::operator delete(ptr);
+  } else {
+    Pool::Get()->Delete(static_cast<Pool::Block*>(ptr));
+  }
+}
+
 struct ChunkMem {
   Storage::Handle h;
   std::vector<Storage::Handle> aux_h;
@@ -124,7 +170,10 @@ struct ChunkMem {
 };
 
 NDArray::Chunk::~Chunk() {
-  bool skip_free = static_data || delay_alloc;
+  if (spillable)
+    storage::SpillManager::Get()->Unregister(var);
+  // no copy of a spillable chunk is pending, a spilled chunk has no device memory left
+  bool skip_free = static_data || delay_alloc || (spillable && shandle.dptr == nullptr);
   ChunkMem mem;
   mem.h     = this->shandle;
   mem.aux_h = this->aux_handles;
@@ -153,6 +202,22 @@ NDArray::Chunk::~Chunk() {
   }
 }
 
+void NDArray::Chunk::Load() {
+  // the operators reading the array may run concurrently, and the loads are rare
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!delay_alloc)
+    return;
+  Storage::Get()->Alloc(&shandle);
+#if MXNET_USE_ONEDNN == 1
+  mkl_mem_ = nullptr;
+#endif
+  loader(shandle.dptr, shandle.size);
+  delay_alloc = false;
+  if (spillable)
+    storage::SpillManager::Get()->OnLoad(var);
+}
+
 void NDArray::Chunk::CheckAndAllocData(const mxnet::TShape& shape, int dtype) {
   CHECK_NE(aux_shapes.size(), 0) << "data is expected to be allocated after aux_data";
   auto dbytes = shape.Size() * mshadow::mshadow_sizeof(dtype);
@@ -202,7 +267,7 @@ NDArray::NDArray(const mkldnn::memory::desc& md)
     : storage_type_(kDefaultStorage), autograd_entry_(nullptr) {
   shape_ = mxnet::TShape(md.data.dims, md.data.dims + md.data.ndims);
   dtype_ = get_mxnet_type(md.data.data_type);
-  ptr_   = std::make_shared<Chunk>(shape_, Context::CPU(), true, dtype_);
+  ptr_   = NewChunk(shape_, Context::CPU(), true, dtype_);
   ptr_->CheckAndAlloc(md.get_size());
   ptr_->mkl_mem_ = std::make_shared<MKLDNNMemory>(md, ptr_->shandle.dptr);
 }
@@ -212,7 +277,7 @@ NDArray::NDArray(const std::shared_ptr<mkldnn::memory>& mkldnn_mem)
   auto mem_desc      = mkldnn_mem->get_desc();
   shape_             = mxnet::TShape(mem_desc.data.dims, mem_desc.data.dims + mem_desc.data.ndims);
   dtype_             = get_mxnet_type(mem_desc.data.data_type);
-  ptr_               = std::make_shared<Chunk>(shape_, Context::CPU(), true, dtype_);
+  ptr_               = NewChunk(shape_, Context::CPU(), true, dtype_);
   ptr_->shandle.dptr = mkldnn_mem->get_data_handle();
   ptr_->shandle.size = mem_desc.get_size();
   ptr_->delay_alloc  = false;
@@ -1455,7 +1520,8 @@ void CopyFromTo(const NDArray& from, const NDArray& to, int priority, bool is_op
       Resource rsc =
           ResourceManager::Get()->Request(from_ctx, ResourceRequest(ResourceRequest::kTempSpace));
       requested.push_back(rsc);
-      mutable_vars.push_back(rsc.var);
+      if (rsc.var != nullptr)
+        mutable_vars.push_back(rsc.var);
     }
   }
 
@@ -1525,6 +1591,86 @@ void CopyFromTo(const NDArray& from, const NDArray* to, int priority) {
   CopyFromTo(from, *to, priority);
 }
 
+void BatchCopyFromTo(const std::vector<NDArray>& from,
+                     const std::vector<NDArray*>& to,
+                     int priority) {
+  CHECK_EQ(from.size(), to.size()) << "operands size mismatch";
+#if MXNET_USE_CUDA
+  // the copies batched from each GPU, by its id
+  std::map<int, std::vector<size_t>> batches;
+  for (size_t i = 0; i < from.size(); ++i) {
+    const NDArray& src = from[i];
+    const NDArray& dst = *to[i];
+    const bool batched = src.ctx().dev_mask() == gpu::kDevMask &&
+                         dst.ctx().dev_mask() == gpu::kDevMask && src.var() != dst.var() &&
+                         src.storage_type() == kDefaultStorage &&
+                         dst.storage_type() == kDefaultStorage && src.dtype() == dst.dtype();
+    if (!batched) {
+      CopyFromTo(src, dst, priority);
+      continue;
+    }
+    CHECK(src.shape() == dst.shape())
+        << "operands shape mismatch "
+        << "from.shape = " << src.shape() << " to.shape=" << dst.shape();
+    CHECK(!mxnet::op::shape_is_none(src.shape())) << "source operands have undefined shape";
+    if (src.shape().Size() != 0U)
+      batches[src.ctx().dev_id].push_back(i);
+  }
+  for (const auto& batch : batches) {
+    std::vector<NDArray> srcs, dsts;
+    std::vector<Engine::VarHandle> const_vars, mutable_vars;
+    for (const size_t i : batch.second) {
+      srcs.push_back(from[i]);
+      dsts.push_back(*to[i]);
+      const_vars.push_back(from[i].var());
+      mutable_vars.push_back(to[i]->var());
+    }
+    std::sort(const_vars.begin(), const_vars.end());
+    const_vars.erase(std::unique(const_vars.begin(), const_vars.end()), const_vars.end());
+    std::sort(mutable_vars.begin(), mutable_vars.end());
+    mutable_vars.erase(std::unique(mutable_vars.begin(), mutable_vars.end()), mutable_vars.end());
+    const bool chained =
+        std::any_of(mutable_vars.begin(), mutable_vars.end(), [&](Engine::VarHandle var) {
+          return std::binary_search(const_vars.begin(), const_vars.end(), var);
+        });
+    if (srcs.size() == 1 || chained) {
+      // the copies to arrays copied from are ordered by the engine
+      for (size_t k = 0; k < srcs.size(); ++k)
+        CopyFromTo(srcs[k], dsts[k], priority);
+      continue;
+    }
+    Engine::Get()->PushAsync(
+        [srcs, dsts](RunContext ctx, Engine::CallbackOnComplete on_complete) {
+          std::vector<ndarray::PeerCopy> copies;
+          copies.reserve(srcs.size());
+          for (size_t k = 0; k < srcs.size(); ++k) {
+            const TBlob& src = srcs[k].data();
+            const TBlob& dst = dsts[k].data();
+            CHECK(src.CheckContiguous() && dst.CheckContiguous())
+                << "copy across only support contiguous memory";
+            copies.push_back({dst.dptr_,
+                              dsts[k].ctx().dev_id,
+                              src.dptr_,
+                              srcs[k].ctx().dev_id,
+                              src.shape_.Size() * mshadow::mshadow_sizeof(src.type_flag_)});
+          }
+          ndarray::PeerCopyScheduler::Get()->CopyBatch(copies, ctx.get_stream<gpu>()->stream_);
+          ctx.get_stream<gpu>()->Wait();
+          on_complete();
+        },
+        srcs[0].ctx(),
+        const_vars,
+        mutable_vars,
+        FnProperty::kCopyFromGPU,
+        priority,
+        "CopyGPU2GPUBatch");
+  }
+#else
+  for (size_t i = 0; i < from.size(); ++i)
+    CopyFromTo(from[i], *to[i], priority);
+#endif
+}
+
 void ElementwiseSum(const std::vector<NDArray>& source, NDArray* out, int priority) {
   std::vector<Engine::VarHandle> const_vars;
   const_vars.reserve(source.size());
@@ -1592,6 +1738,9 @@ void ElementwiseSum(const std::vector<NDArray>& source, NDArray* out, int priori
   } else if (stype == kRowSparseStorage) {
     Resource rsc =
         ResourceManager::Get()->Request(ret.ctx(), ResourceRequest(ResourceRequest::kTempSpace));
+    std::vector<Engine::VarHandle> mutable_vars = {ret.var()};
+    if (rsc.var != nullptr)
+      mutable_vars.push_back(rsc.var);
 
     Engine::Get()->PushSync(
         [source, ret, rsc](RunContext rctx) {
@@ -1615,7 +1764,7 @@ void ElementwiseSum(const std::vector<NDArray>& source, NDArray* out, int priori
         },
         ret.ctx(),
         const_vars,
-        {ret.var(), rsc.var},
+        mutable_vars,
         FnProperty::kNormal,
         priority,
         "RowSparseElementwiseSum");
@@ -1886,6 +2035,15 @@ void NDArray::Save(dmlc::Stream* strm) const {
   // save context
   Context ctx = this->ctx();
   ctx.Save(strm);
+  if (ctx.dev_mask() != cpu::kDevMask && nad == 0) {
+    // the data goes to strm in chunks through pinned buffers, without a copy of it on the host
+    int32_t type_flag = dtype();
+    strm->Write(&type_flag, sizeof(type_flag));
+    DeviceStaging staging;
+    staging.Start(*this);
+    staging.Write(strm);
+    return;
+  }
   TBlob save_data;
   NDArray nd_cpu;  // a copy of *this on cpu
   if (ctx.dev_mask() != cpu::kDevMask) {
@@ -2435,6 +2593,33 @@ void NDArray::WaitToWrite() const {
   Engine::Get()->WaitForVar(ptr_->var);
 }
 
+void NDArray::SetSpillable() const {
+  CHECK(!is_none()) << "Cannot spill an empty array";
+  CHECK_EQ(storage_type(), kDefaultStorage) << "Only dense arrays can be spilled";
+  CHECK_EQ(ctx().dev_mask(), gpu::kDevMask) << "Only GPU arrays can be spilled";
+  CHECK(!ptr_->static_data) << "Arrays of external memory cannot be spilled";
+  if (ptr_->spillable)
+    return;
+  ptr_->CheckAndAlloc();
+  ptr_->spillable = true;
+  storage::SpillManager::Get()->Register(ptr_->var, &ptr_->shandle, ptr_);
+}
+
+void NDArray::SetLoader(std::function<void(void*, size_t)> loader) const {
+  CHECK(!is_none()) << "Cannot load an empty array";
+  CHECK_EQ(storage_type(), kDefaultStorage) << "Only dense arrays can be loaded lazily";
+  CHECK(!ptr_->static_data) << "Arrays of external memory cannot be loaded lazily";
+  CHECK(ptr_->delay_alloc) << "The memory of a lazily loaded array must not be allocated yet";
+  CHECK(shape_is_known(ptr_->storage_shape) && ptr_->shandle.size > 0)
+      << "A lazily loaded array must have a known non-empty shape";
+  CHECK(!ptr_->loader) << "The array already has a loader";
+  ptr_->loader = std::move(loader);
+  if (ctx().dev_mask() == gpu::kDevMask) {
+    ptr_->spillable = true;
+    storage::SpillManager::Get()->RegisterLazy(ptr_->var, &ptr_->shandle, ptr_, ptr_->loader);
+  }
+}
+
 #if MXNET_PREDICT_ONLY == 0
 // register API function
 // those with underscore will be registered at NDArray
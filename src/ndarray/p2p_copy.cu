@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file p2p_copy.cu
+ * \brief scheduler of the copies between GPUs
+ */
+#include "./p2p_copy.h"
+
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <memory>
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace ndarray {
+
+namespace {
+
+/*! \brief maximal number of copies done by one launch, they are passed as kernel parameters */
+constexpr int kMaxBatchCopies = 64;
+constexpr int kBatchCopyThreads = 256;
+
+struct PeerCopyBatch {
+  int num;
+  const void* src[kMaxBatchCopies];
+  void* dst[kMaxBatchCopies];
+  size_t bytes[kMaxBatchCopies];
+};
+
+template <typename T>
+__device__ void CopyWords(T* dst, const T* src, size_t n) {
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n; i += gridDim.x * blockDim.x)
+    dst[i] = src[i];
+}
+
+/*! \brief copy k of the batch by the blocks of row k of the grid, with the widest aligned words */
+__global__ void BatchCopyKernel(PeerCopyBatch batch) {
+  const int k        = blockIdx.y;
+  const char* src    = static_cast<const char*>(batch.src[k]);
+  char* dst          = static_cast<char*>(batch.dst[k]);
+  const size_t bytes = batch.bytes[k];
+  const uintptr_t align =
+      reinterpret_cast<uintptr_t>(src) | reinterpret_cast<uintptr_t>(dst) | bytes;
+  if (align % sizeof(uint4) == 0) {
+    CopyWords(reinterpret_cast<uint4*>(dst),
+              reinterpret_cast<const uint4*>(src),
+              bytes / sizeof(uint4));
+  } else if (align % sizeof(uint32_t) == 0) {
+    CopyWords(reinterpret_cast<uint32_t*>(dst),
+              reinterpret_cast<const uint32_t*>(src),
+              bytes / sizeof(uint32_t));
+  } else {
+    CopyWords(dst, src, bytes);
+  }
+}
+
+/*! \brief the copy streams of a GPU for the calling thread, which wait on its stream */
+struct CopyStreams {
+  std::vector<cudaStream_t> streams;
+  std::vector<cudaEvent_t> done;
+  cudaEvent_t ready;
+
+  CopyStreams(int dev, int num) : streams(num), done(num) {
+    mxnet::common::cuda::DeviceStore device_store(dev);
+    for (int i = 0; i < num; ++i) {
+      CUDA_CALL(cudaStreamCreateWithFlags(&streams[i], cudaStreamNonBlocking));
+      CUDA_CALL(cudaEventCreateWithFlags(&done[i], cudaEventDisableTiming));
+    }
+    CUDA_CALL(cudaEventCreateWithFlags(&ready, cudaEventDisableTiming));
+  }
+
+  ~CopyStreams() {
+    // the runtime may already be unloaded at the exit of the thread, the errors are ignored
+    for (size_t i = 0; i < streams.size(); ++i) {
+      cudaStreamDestroy(streams[i]);
+      cudaEventDestroy(done[i]);
+    }
+    cudaEventDestroy(ready);
+  }
+};
+
+CopyStreams* GetCopyStreams(int dev, int num) {
+  // the copy workers of the engine copy concurrently, each has its own streams and events
+  static thread_local std::vector<std::unique_ptr<CopyStreams>> copy_streams;
+  if (copy_streams.size() <= static_cast<size_t>(dev))
+    copy_streams.resize(dev + 1);
+  if (!copy_streams[dev])
+    copy_streams[dev].reset(new CopyStreams(dev, num));
+  return copy_streams[dev].get();
+}
+
+}  // namespace
+
+PeerCopyScheduler* PeerCopyScheduler::Get() {
+  static PeerCopyScheduler inst;
+  return &inst;
+}
+
+PeerCopyScheduler::PeerCopyScheduler()
+    : enable_p2p_(dmlc::GetEnv("MXNET_ENABLE_GPU_P2P", true)),
+      chunk_size_(std::max<size_t>(dmlc::GetEnv("MXNET_GPU_P2P_CHUNK_SIZE", 8 << 20), 1)),
+      max_streams_(std::max(dmlc::GetEnv("MXNET_GPU_P2P_COPY_STREAMS", 4), 1)),
+      batch_copy_size_(dmlc::GetEnv("MXNET_GPU_P2P_BATCH_COPY_SIZE", 64 << 10)) {
+  CUDA_CALL(cudaGetDeviceCount(&num_devices_));
+  links_.resize(num_devices_ * num_devices_);
+}
+
+PeerCopyScheduler::Link PeerCopyScheduler::GetLink(int dev, int peer) {
+  CHECK(dev >= 0 && dev < num_devices_ && peer >= 0 && peer < num_devices_)
+      << "Invalid pair of GPUs " << dev << ", " << peer;
+  std::lock_guard<std::mutex> lock(mutex_);
+  Link& link = links_[dev * num_devices_ + peer];
+  if (link.access != -1)
+    return link;
+  link.access = 0;
+  if (dev == peer) {
+    link.access = 1;
+    return link;
+  }
+  int can_access = 0;
+  CUDA_CALL(cudaDeviceCanAccessPeer(&can_access, dev, peer));
+  if (enable_p2p_ && can_access) {
+    mxnet::common::cuda::DeviceStore device_store(dev);
+    cudaError_t e = cudaDeviceEnablePeerAccess(peer, 0);
+    if (e == cudaErrorPeerAccessAlreadyEnabled) {
+      // enabled by CommDevice, clear the error
+      cudaGetLastError();
+    }
+    link.access = e == cudaSuccess || e == cudaErrorPeerAccessAlreadyEnabled;
+  }
+  if (link.access) {
+    // ranked as by GetP2PWeight of gpu_topology.h: 0 for PCIe, else the number of NVLinks
+    int rank = 0;
+    CUDA_CALL(cudaDeviceGetP2PAttribute(&rank, cudaDevP2PAttrPerformanceRank, dev, peer));
+    link.streams = std::min(std::max(rank, 1), max_streams_);
+  }
+  return link;
+}
+
+bool PeerCopyScheduler::PeerAccess(int dev, int peer) {
+  return GetLink(dev, peer).access == 1;
+}
+
+void PeerCopyScheduler::Copy(const PeerCopy& copy, cudaStream_t stream) {
+  const Link link = GetLink(copy.src_dev, copy.dst_dev);
+  if (link.streams < 2 || copy.bytes < 2 * chunk_size_) {
+    CUDA_CALL(cudaMemcpyPeerAsync(
+        copy.dst, copy.dst_dev, copy.src, copy.src_dev, copy.bytes, stream));
+    return;
+  }
+  // each link is driven by a copy engine of the GPU, a copy on one stream uses a single link
+  CopyStreams* aux        = GetCopyStreams(copy.src_dev, max_streams_);
+  const size_t num_chunks = (copy.bytes + chunk_size_ - 1) / chunk_size_;
+  const int num_streams   = static_cast<int>(std::min<size_t>(link.streams, num_chunks));
+  CUDA_CALL(cudaEventRecord(aux->ready, stream));
+  for (int i = 0; i < num_streams; ++i)
+    CUDA_CALL(cudaStreamWaitEvent(aux->streams[i], aux->ready, 0));
+  for (size_t c = 0; c < num_chunks; ++c) {
+    const size_t offset = c * chunk_size_;
+    CUDA_CALL(cudaMemcpyPeerAsync(static_cast<char*>(copy.dst) + offset,
+                                  copy.dst_dev,
+                                  static_cast<const char*>(copy.src) + offset,
+                                  copy.src_dev,
+                                  std::min(chunk_size_, copy.bytes - offset),
+                                  aux->streams[c % num_streams]));
+  }
+  for (int i = 0; i < num_streams; ++i) {
+    CUDA_CALL(cudaEventRecord(aux->done[i], aux->streams[i]));
+    CUDA_CALL(cudaStreamWaitEvent(stream, aux->done[i], 0));
+  }
+}
+
+void PeerCopyScheduler::CopyBatch(const std::vector<PeerCopy>& copies, cudaStream_t stream) {
+  int dev = -1;
+  CUDA_CALL(cudaGetDevice(&dev));
+  PeerCopyBatch batch;
+  batch.num        = 0;
+  size_t max_bytes = 0;
+  auto launch      = [&]() {
+    if (batch.num == 0)
+      return;
+    // enough blocks for the largest copy in 32 bit words
+    const size_t words = (max_bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    const dim3 grid(static_cast<unsigned>(std::min<size_t>(
+                        (words + kBatchCopyThreads - 1) / kBatchCopyThreads, 64)),
+                    batch.num);
+    BatchCopyKernel<<<grid, kBatchCopyThreads, 0, stream>>>(batch);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(BatchCopyKernel);
+    batch.num = 0;
+    max_bytes = 0;
+  };
+  for (const PeerCopy& copy : copies) {
+    if (copy.bytes == 0)
+      continue;
+    CHECK_EQ(copy.src_dev, dev) << "The copies of a batch are from the GPU of its stream";
+    if (copy.bytes <= batch_copy_size_ && PeerAccess(copy.src_dev, copy.dst_dev)) {
+      batch.src[batch.num]   = copy.src;
+      batch.dst[batch.num]   = copy.dst;
+      batch.bytes[batch.num] = copy.bytes;
+      max_bytes              = std::max(max_bytes, copy.bytes);
+      if (++batch.num == kMaxBatchCopies)
+        launch();
+    } else if (copy.src_dev == copy.dst_dev) {
+      CUDA_CALL(
+          cudaMemcpyAsync(copy.dst, copy.src, copy.bytes, cudaMemcpyDeviceToDevice, stream));
+    } else {
+      Copy(copy, stream);
+    }
+  }
+  launch();
+}
+
+}  // namespace ndarray
+}  // namespace mxnet
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file p2p_copy.h
+ * \brief scheduler of the copies between GPUs
+ */
+#ifndef MXNET_NDARRAY_P2P_COPY_H_
+#define MXNET_NDARRAY_P2P_COPY_H_
+
+#include <mxnet/base.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#if MXNET_USE_CUDA
+
+namespace mxnet {
+namespace ndarray {
+
+/*! \brief a contiguous copy of bytes from the memory of one GPU to another */
+struct PeerCopy {
+  void* dst;
+  int dst_dev;
+  const void* src;
+  int src_dev;
+  size_t bytes;
+};
+
+/*!
+ * \brief Schedules the copies between GPUs on the stream of the source GPU. The direct access
+ *  to a peer is enabled the first time a pair of GPUs copies, when their link supports it and
+ *  MXNET_ENABLE_GPU_P2P is set. The large copies over a link of several NVLinks are split into
+ *  chunks on as many copy streams, and the small copies are done by one kernel launch.
+ */
+class PeerCopyScheduler {
+ public:
+  /*! \brief get the global instance */
+  static PeerCopyScheduler* Get();
+
+  /*!
+   * \brief whether a GPU accesses the memory of a peer directly, enabled on first use
+   * \param dev the GPU accessing the memory
+   * \param peer the GPU the memory is on
+   */
+  bool PeerAccess(int dev, int peer);
+
+  /*!
+   * \brief copy on the stream of the source GPU, in chunks on the copy streams when it is large
+   *  and the link between the GPUs has several NVLinks
+   */
+  void Copy(const PeerCopy& copy, cudaStream_t stream);
+
+  /*!
+   * \brief copy from the source GPU of the stream, the small copies to the peers it accesses
+   *  directly in one launch and the others one by one
+   */
+  void CopyBatch(const std::vector<PeerCopy>& copies, cudaStream_t stream);
+
+  /*! \return size in bytes up to which a copy is done in a batch */
+  size_t batch_copy_size() const {
+    return batch_copy_size_;
+  }
+
+ private:
+  PeerCopyScheduler();
+
+  /*! \brief the state of a pair of GPUs */
+  struct Link {
+    /*! \brief -1 for not queried yet, 0 for staged through the host, 1 for direct access */
+    int access{-1};
+    /*! \brief number of copy streams a large copy is split on */
+    int streams{1};
+  };
+
+  /*! \return the state of the pair of GPUs, queried and enabled on first use */
+  Link GetLink(int dev, int peer);
+
+  int num_devices_{0};
+  bool enable_p2p_;
+  size_t chunk_size_;
+  int max_streams_;
+  size_t batch_copy_size_;
+  /*! \brief guards links_ */
+  std::mutex mutex_;
+  /*! \brief the state of the pair dev, peer at dev * num_devices_ + peer */
+  std::vector<Link> links_;
+};
+
+}  // namespace ndarray
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
+#endif  // MXNET_NDARRAY_P2P_COPY_H_
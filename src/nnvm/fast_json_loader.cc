@@ -0,0 +1,500 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fast_json_loader.cc
+ * \brief single pass loader of the graphs saved by nnvm SaveJSON
+ *
+ *  The JSON is parsed in place, in one pass, into the nodes of the graph: the nodes are
+ *  allocated from an arena, the operators are looked up once per name and the nodes with the
+ *  same attributes, as written in the JSON, share the dictionary parsed the first time.
+ */
+#include <dmlc/registry.h>
+#include <nnvm/graph.h>
+#include <nnvm/node.h>
+#include <nnvm/op.h>
+#include <nnvm/symbolic.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./fast_json_loader.h"
+
+namespace mxnet {
+namespace {
+
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+using nnvm::Op;
+using nnvm::Symbol;
+
+/*! \brief memory of the nodes of a graph, freed with the last of the nodes */
+class NodeArena {
+ public:
+  void* Allocate(size_t size, size_t align) {
+    size_t offset = (used_ + align - 1) / align * align;
+    if (blocks_.empty() || offset + size > kBlockSize) {
+      blocks_.emplace_back(new char[std::max(size, kBlockSize)]);
+      offset = 0;
+    }
+    used_ = offset + size;
+    return blocks_.back().get() + offset;
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 64 << 10;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  size_t used_ = 0;
+};
+
+/*! \brief allocator of the nodes, which keeps the arena alive in their control blocks */
+template <typename T>
+struct NodeAllocator {
+  typedef T value_type;
+
+  explicit NodeAllocator(std::shared_ptr<NodeArena> arena) : arena(std::move(arena)) {}
+  template <typename U>
+  NodeAllocator(const NodeAllocator<U>& other) : arena(other.arena) {}  // NOLINT(*)
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, size_t) {}
+
+  std::shared_ptr<NodeArena> arena;
+};
+
+template <typename T, typename U>
+bool operator==(const NodeAllocator<T>& a, const NodeAllocator<U>& b) {
+  return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const NodeAllocator<T>& a, const NodeAllocator<U>& b) {
+  return a.arena != b.arena;
+}
+
+struct JSONEntry {
+  uint32_t node_id;
+  uint32_t index;
+  uint32_t version;
+};
+
+struct JSONGraph;
+
+struct JSONNode {
+  ObjectPtr node;
+  std::vector<JSONEntry> inputs;
+  std::vector<uint32_t> control_deps;
+  std::vector<JSONGraph> subgraphs;
+};
+
+struct JSONGraph {
+  std::vector<JSONNode> nodes;
+  std::vector<uint32_t> arg_nodes;
+  std::vector<JSONEntry> heads;
+  std::unordered_map<std::string, std::shared_ptr<nnvm::any>> attrs;
+};
+
+class JSONGraphParser {
+ public:
+  explicit JSONGraphParser(const std::string& json)
+      : cur_(json.data()), end_(json.data() + json.size()), arena_(new NodeArena()) {}
+
+  bool Parse(nnvm::Graph* out) {
+    JSONGraph graph;
+    if (!ParseGraph(&graph))
+      return false;
+    SkipSpace();
+    std::shared_ptr<Symbol> symbol;
+    if (cur_ != end_ || !(symbol = Link(&graph, false)))
+      return false;
+    out->outputs = std::move(symbol->outputs);
+    out->attrs   = std::move(graph.attrs);
+    return true;
+  }
+
+ private:
+  void SkipSpace() {
+    while (cur_ != end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\t' || *cur_ == '\r'))
+      ++cur_;
+  }
+
+  bool Accept(char c) {
+    SkipSpace();
+    if (cur_ == end_ || *cur_ != c)
+      return false;
+    ++cur_;
+    return true;
+  }
+
+  /*! \brief parse the members of an object, calling member with the key of each */
+  template <typename FMember>
+  bool ParseObject(FMember member) {
+    if (!Accept('{'))
+      return false;
+    if (Accept('}'))
+      return true;
+    std::string key;
+    do {
+      if (!ParseString(&key) || !Accept(':') || !member(key))
+        return false;
+    } while (Accept(','));
+    return Accept('}');
+  }
+
+  /*! \brief parse the elements of an array, calling element for each */
+  template <typename FElement>
+  bool ParseArray(FElement element) {
+    if (!Accept('['))
+      return false;
+    if (Accept(']'))
+      return true;
+    do {
+      if (!element())
+        return false;
+    } while (Accept(','));
+    return Accept(']');
+  }
+
+  bool ParseHex(uint32_t* code) {
+    if (end_ - cur_ < 4)
+      return false;
+    *code = 0;
+    for (int i = 0; i < 4; ++i, ++cur_) {
+      char c = *cur_;
+      int digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        return false;
+      }
+      *code = *code * 16 + digit;
+    }
+    return true;
+  }
+
+  static void AppendUTF8(uint32_t code, std::string* out) {
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+
+  bool ParseString(std::string* out) {
+    if (!Accept('"'))
+      return false;
+    out->clear();
+    while (true) {
+      const char* start = cur_;
+      while (cur_ != end_ && *cur_ != '"' && *cur_ != '\\')
+        ++cur_;
+      out->append(start, cur_);
+      if (cur_ == end_)
+        return false;
+      if (*cur_++ == '"')
+        return true;
+      if (cur_ == end_)
+        return false;
+      switch (*cur_++) {
+        case '"':
+          out->push_back('"');
+          break;
+        case '\\':
+          out->push_back('\\');
+          break;
+        case '/':
+          out->push_back('/');
+          break;
+        case 'b':
+          out->push_back('\b');
+          break;
+        case 'f':
+          out->push_back('\f');
+          break;
+        case 'n':
+          out->push_back('\n');
+          break;
+        case 'r':
+          out->push_back('\r');
+          break;
+        case 't':
+          out->push_back('\t');
+          break;
+        case 'u': {
+          uint32_t code;
+          if (!ParseHex(&code))
+            return false;
+          if (code >= 0xD800 && code < 0xDC00) {
+            // the high surrogate of a pair
+            uint32_t low;
+            if (end_ - cur_ < 2 || cur_[0] != '\\' || cur_[1] != 'u')
+              return false;
+            cur_ += 2;
+            if (!ParseHex(&low) || low < 0xDC00 || low >= 0xE000)
+              return false;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+          AppendUTF8(code, out);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+  }
+
+  bool ParseInt(int64_t* out) {
+    SkipSpace();
+    bool negative = cur_ != end_ && *cur_ == '-';
+    if (negative)
+      ++cur_;
+    if (cur_ == end_ || *cur_ < '0' || *cur_ > '9')
+      return false;
+    int64_t value = 0;
+    for (; cur_ != end_ && *cur_ >= '0' && *cur_ <= '9'; ++cur_) {
+      value = value * 10 + (*cur_ - '0');
+      if (value > (int64_t{1} << 40))
+        return false;
+    }
+    *out = negative ? -value : value;
+    return true;
+  }
+
+  bool ParseIndex(uint32_t* out) {
+    int64_t value;
+    if (!ParseInt(&value) || value < 0 || value > UINT32_MAX)
+      return false;
+    *out = static_cast<uint32_t>(value);
+    return true;
+  }
+
+  bool ParseIndices(std::vector<uint32_t>* out) {
+    return ParseArray([&]() {
+      uint32_t index;
+      if (!ParseIndex(&index))
+        return false;
+      out->push_back(index);
+      return true;
+    });
+  }
+
+  /*! \brief parse [node_id, index] or [node_id, index, version] */
+  bool ParseEntries(std::vector<JSONEntry>* out) {
+    return ParseArray([&]() {
+      std::vector<uint32_t> fields;
+      if (!ParseIndices(&fields) || fields.size() < 2 || fields.size() > 3)
+        return false;
+      out->push_back(JSONEntry{fields[0], fields[1], fields.size() == 3 ? fields[2] : 0});
+      return true;
+    });
+  }
+
+  /*! \brief parse a dictionary of strings, once for all the dictionaries written the same */
+  bool ParseDict(std::unordered_map<std::string, std::string>* out) {
+    SkipSpace();
+    const char* start = cur_;
+    std::unordered_map<std::string, std::string> dict;
+    std::string value;
+    bool ok = ParseObject([&](const std::string& key) {
+      if (!ParseString(&value))
+        return false;
+      dict[key] = value;
+      return true;
+    });
+    if (!ok)
+      return false;
+    auto it = dicts_.find(std::string_view(start, cur_ - start));
+    if (it == dicts_.end())
+      it = dicts_.emplace(std::string_view(start, cur_ - start), std::move(dict)).first;
+    *out = it->second;
+    return true;
+  }
+
+  bool ParseOp(const Op** op) {
+    std::string name;
+    if (!ParseString(&name))
+      return false;
+    if (name == "null") {
+      *op = nullptr;
+      return true;
+    }
+    auto it = ops_.find(name);
+    if (it == ops_.end())
+      it = ops_.emplace(name, dmlc::Registry<Op>::Find(name)).first;
+    *op = it->second;
+    return *op != nullptr;
+  }
+
+  bool ParseNode(JSONNode* out) {
+    out->node = std::allocate_shared<Node>(NodeAllocator<Node>(arena_));
+    nnvm::NodeAttrs* attrs = &out->node->attrs;
+    return ParseObject([&](const std::string& key) {
+      if (key == "op")
+        return ParseOp(&attrs->op);
+      if (key == "name")
+        return ParseString(&attrs->name);
+      if (key == "inputs")
+        return ParseEntries(&out->inputs);
+      if (key == "attrs" || key == "attr" || key == "param")
+        return ParseDict(&attrs->dict);
+      if (key == "control_deps")
+        return ParseIndices(&out->control_deps);
+      if (key == "subgraphs") {
+        return ParseArray([&]() {
+          out->subgraphs.emplace_back();
+          return ParseGraph(&out->subgraphs.back());
+        });
+      }
+      if (key == "backward_source_id") {
+        int64_t id;
+        return ParseInt(&id);
+      }
+      return false;
+    });
+  }
+
+  /*! \brief parse the attributes of a graph, only those of type int */
+  bool ParseGraphAttrs(JSONGraph* out) {
+    return ParseObject([&](const std::string& key) {
+      std::string type;
+      int64_t value;
+      if (!Accept('[') || !ParseString(&type) || type != "int" || !Accept(',') ||
+          !ParseInt(&value) || !Accept(']'))
+        return false;
+      out->attrs[key] = std::make_shared<nnvm::any>(static_cast<int>(value));
+      return true;
+    });
+  }
+
+  bool ParseGraph(JSONGraph* out) {
+    return ParseObject([&](const std::string& key) {
+      if (key == "nodes") {
+        return ParseArray([&]() {
+          out->nodes.emplace_back();
+          return ParseNode(&out->nodes.back());
+        });
+      }
+      if (key == "arg_nodes")
+        return ParseIndices(&out->arg_nodes);
+      if (key == "node_row_ptr") {
+        std::vector<uint32_t> node_row_ptr;
+        return ParseIndices(&node_row_ptr);
+      }
+      if (key == "heads")
+        return ParseEntries(&out->heads);
+      if (key == "attrs")
+        return ParseGraphAttrs(out);
+      return false;
+    });
+  }
+
+  /*!
+   * \brief connect the nodes of a graph, as JSONGraph2Symbol of nnvm
+   * \param parse whether to parse the attributes of the nodes
+   * \return the outputs of the graph, or nullptr if an index is out of bounds
+   */
+  std::shared_ptr<Symbol> Link(JSONGraph* graph, bool parse) {
+    const size_t num_nodes = graph->nodes.size();
+    for (JSONNode& n : graph->nodes) {
+      n.node->inputs.reserve(n.inputs.size());
+      for (const JSONEntry& e : n.inputs) {
+        if (e.node_id >= num_nodes)
+          return nullptr;
+        n.node->inputs.emplace_back(graph->nodes[e.node_id].node, e.index, e.version);
+      }
+      n.node->control_deps.reserve(n.control_deps.size());
+      for (uint32_t nid : n.control_deps) {
+        if (nid >= num_nodes)
+          return nullptr;
+        n.node->control_deps.push_back(graph->nodes[nid].node);
+      }
+      for (JSONGraph& subgraph : n.subgraphs) {
+        std::shared_ptr<Symbol> symbol = Link(&subgraph, true);
+        if (!symbol)
+          return nullptr;
+        n.node->attrs.subgraphs.push_back(std::move(symbol));
+      }
+      if (!parse)
+        continue;
+      if (n.node->op() != nullptr) {
+        if (n.node->op()->attr_parser != nullptr)
+          n.node->op()->attr_parser(&(n.node->attrs));
+      } else {
+        n.node->attrs.parsed = VariableParsed();
+      }
+    }
+    for (uint32_t nid : graph->arg_nodes) {
+      if (nid >= num_nodes || !graph->nodes[nid].node->is_variable())
+        return nullptr;
+    }
+    auto symbol = std::make_shared<Symbol>();
+    symbol->outputs.reserve(graph->heads.size());
+    for (const JSONEntry& e : graph->heads) {
+      if (e.node_id >= num_nodes)
+        return nullptr;
+      symbol->outputs.emplace_back(graph->nodes[e.node_id].node, e.index, e.version);
+    }
+    return symbol;
+  }
+
+  /*! \brief the parsed attributes of the variables, as Symbol::CreateVariable sets them */
+  const nnvm::any& VariableParsed() {
+    if (variable_parsed_.empty())
+      variable_parsed_ = Symbol::CreateVariable("var").outputs[0].node->attrs.parsed;
+    return variable_parsed_;
+  }
+
+  const char* cur_;
+  const char* end_;
+  std::shared_ptr<NodeArena> arena_;
+  /*! \brief the operators, by name */
+  std::unordered_map<std::string, const Op*> ops_;
+  /*! \brief the dictionaries of attributes, by their text in the JSON */
+  std::unordered_map<std::string_view, std::unordered_map<std::string, std::string>> dicts_;
+  nnvm::any variable_parsed_;
+};
+
+}  // namespace
+
+bool FastLoadJSON(const std::string& json, nnvm::Graph* out) {
+  return JSONGraphParser(json).Parse(out);
+}
+
+}  // namespace mxnet
@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fast_json_loader.h
+ * \brief single pass loader of the graphs saved by nnvm SaveJSON
+ */
+#ifndef MXNET_NNVM_FAST_JSON_LOADER_H_
+#define MXNET_NNVM_FAST_JSON_LOADER_H_
+
+#include <nnvm/graph.h>
+#include <string>
+
+namespace mxnet {
+
+/*!
+ * \brief Load a graph from its JSON as the LoadJSON pass of nnvm with load_json_no_parse does,
+ *  without parsing the attributes of the nodes of the graph. The nodes of subgraphs are parsed.
+ * \param json the JSON of the graph
+ * \param out the graph loaded
+ * \return false when the JSON uses a feature the loader does not handle, or is not valid, in
+ *  which case it is to be loaded by the LoadJSON pass, which reports the errors
+ */
+bool FastLoadJSON(const std::string& json, nnvm::Graph* out);
+
+}  // namespace mxnet
+
+#endif  // MXNET_NNVM_FAST_JSON_LOADER_H_
@@ -32,7 +32,12 @@
 #include <nnvm/op_attr_types.h>
 #include <memory>
 #include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include "../c_api/c_api_common.h"
+#include "./fast_json_loader.h"
 
 namespace mxnet {
 using nnvm::FListInputNames;
@@ -111,13 +116,35 @@ Graph UpgradeJSON_FixParsing(Graph g) {
 }
 
 Graph UpgradeJSON_Parse(Graph g) {
-  nnvm::DFSVisit(g.outputs, [](const std::shared_ptr<Node>& n) {
-    if (n->op() != nullptr) {
-      if (n->op()->attr_parser != nullptr)
-        n->op()->attr_parser(&(n->attrs));
+  // ugly workaround due to VariableParam is not exposed.
+  const nnvm::any variable_parsed =
+      nnvm::Symbol::CreateVariable("var").outputs[0].node->attrs.parsed;
+  // the nodes of an operator with the same attributes are parsed once, but for those whose
+  // parsed attributes hold the state of the node
+  std::unordered_map<std::string, NodeAttrs> parsed;
+  nnvm::DFSVisit(g.outputs, [&](const std::shared_ptr<Node>& n) {
+    if (n->op() == nullptr) {
+      n->attrs.parsed = variable_parsed;
+      return;
+    }
+    if (n->op()->attr_parser == nullptr)
+      return;
+    if (!n->attrs.subgraphs.empty() || n->op()->name == "Custom") {
+      n->op()->attr_parser(&(n->attrs));
+      return;
+    }
+    std::string key = n->op()->name;
+    for (const auto& kv : std::map<std::string, std::string>(n->attrs.dict.begin(),
+                                                             n->attrs.dict.end())) {
+      key.append(1, '\0').append(kv.first).append(1, '\0').append(kv.second);
+    }
+    auto it = parsed.find(key);
+    if (it == parsed.end()) {
+      n->op()->attr_parser(&(n->attrs));
+      parsed.emplace(std::move(key), n->attrs);
     } else {
-      // ugly workaround due to VariableParam is not exposed.
-      n->attrs.parsed = nnvm::Symbol::CreateVariable(n->attrs.name).outputs[0].node->attrs.parsed;
+      n->attrs.dict   = it->second.dict;
+      n->attrs.parsed = it->second.parsed;
     }
   });
   return g;
@@ -195,9 +222,13 @@ static std::vector<std::pair<int, std::function<Graph(Graph)> > > upgrader_list
 };
 
 Graph LoadLegacyJSONPass(Graph g) {
-  g.attrs["load_json_no_parse"] = std::make_shared<nnvm::any>(true);
-  Graph load                    = nnvm::ApplyPass(g, "LoadJSON");
-  int version                   = MXNET_MAKE_VERSION(0, 8, 0);
+  Graph load;
+  if (!dmlc::GetEnv("MXNET_FAST_JSON_LOADER", true) ||
+      !FastLoadJSON(g.GetAttr<std::string>("json"), &load)) {
+    g.attrs["load_json_no_parse"] = std::make_shared<nnvm::any>(true);
+    load                          = nnvm::ApplyPass(g, "LoadJSON");
+  }
+  int version = MXNET_MAKE_VERSION(0, 8, 0);
   if (load.attrs.find("mxnet_version") != load.attrs.end()) {
     version = nnvm::get<int>(*load.attrs["mxnet_version"]);
   }
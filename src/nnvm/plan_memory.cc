@@ -26,7 +26,15 @@
 #include <nnvm/graph_attr_types.h>
 #include <nnvm/op_attr_types.h>
 #include <mxnet/base.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "graph_algorithm.h"
 #include "../operator/operator_common.h"
 
@@ -193,23 +201,149 @@ class MXGraphAllocator {
   const IndexedGraph* idx_;
 };
 
+/*!
+ * \brief allocator that assigns storage from the live ranges of the whole graph.
+ *
+ * Every request first gets its own storage id, and the node that requests it and
+ * the node that releases it are recorded. Solve() then packs the requests into
+ * shared storage: from the largest to the smallest, each request goes to the
+ * smallest storage of its device whose requests do not overlap with its range.
+ * Unlike the greedy allocator, which can only reuse what is free at the time of a
+ * request, this sees the lifetime of every entry up front.
+ */
+class MXLiveRangeAllocator {
+ public:
+  using StorageID = MXGraphAllocator::StorageID;
+
+  StorageID Request(int dev_id, int dtype, mxnet::TShape shape, uint32_t node_id) {
+    if (!mxnet::shape_is_known(shape))
+      return MXGraphAllocator::kBadStorageID;
+    Block block;
+    block.dev_id = dev_id;
+    block.size   = shape.Size() * MXGetDTypeSize(dtype);
+    block.begin  = node_id;
+    blocks_.push_back(block);
+    return static_cast<StorageID>(blocks_.size() - 1);
+  }
+
+  void Release(StorageID id, uint32_t node_id) {
+    CHECK_NE(id, MXGraphAllocator::kBadStorageID);
+    if (id == MXGraphAllocator::kExternalStorageID || id == MXGraphAllocator::kDynamicStorageID)
+      return;
+    blocks_[id].end = node_id;
+  }
+
+  /*! \brief assign the requests to storage, returns the storage of each request */
+  std::vector<StorageID> Solve() {
+    std::vector<size_t> order(blocks_.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return blocks_[a].size > blocks_[b].size;
+    });
+    std::vector<StorageID> assignment(blocks_.size());
+    slots_.clear();
+    for (size_t i : order) {
+      const Block& block = blocks_[i];
+      int best           = -1;
+      // storage is created by the largest request it holds, so every one fits
+      for (size_t s = 0; s < slots_.size(); ++s) {
+        const Slot& slot = slots_[s];
+        if (slot.dev_id != block.dev_id || Overlaps(slot, block))
+          continue;
+        if (best < 0 || slot.size < slots_[best].size)
+          best = static_cast<int>(s);
+      }
+      if (best < 0) {
+        best = static_cast<int>(slots_.size());
+        slots_.emplace_back();
+        slots_.back().dev_id = block.dev_id;
+        slots_.back().size   = block.size;
+      }
+      slots_[best].ranges[block.begin] = block.end;
+      assignment[i]                    = best;
+    }
+    return assignment;
+  }
+
+  // totoal number of bytes allocated
+  size_t TotalAllocBytes() const {
+    size_t total = 0;
+    for (const auto& slot : slots_)
+      total += slot.size;
+    return total;
+  }
+
+  /*! \brief the largest number of bytes live at the same time, a bound for any plan */
+  size_t PeakLiveBytes() const {
+    std::map<uint32_t, int64_t> delta;
+    for (const auto& block : blocks_) {
+      delta[block.begin] += block.size;
+      if (block.end != kNeverReleased)
+        delta[block.end + 1] -= block.size;
+    }
+    int64_t live = 0, peak = 0;
+    for (const auto& kv : delta) {
+      live += kv.second;
+      peak = std::max(peak, live);
+    }
+    return static_cast<size_t>(peak);
+  }
+
+ private:
+  static constexpr uint32_t kNeverReleased = std::numeric_limits<uint32_t>::max();
+
+  struct Block {
+    int dev_id;
+    size_t size;
+    // nodes that request and release the storage
+    uint32_t begin;
+    uint32_t end{kNeverReleased};
+  };
+  struct Slot {
+    int dev_id;
+    size_t size;
+    // disjoint ranges of the requests sharing the storage, begin to end
+    std::map<uint32_t, uint32_t> ranges;
+  };
+
+  static bool Overlaps(const Slot& slot, const Block& block) {
+    // the range starting last before the end of block is the only candidate
+    auto it = slot.ranges.upper_bound(block.end);
+    if (it == slot.ranges.begin())
+      return false;
+    --it;
+    return it->second >= block.begin;
+  }
+
+  std::vector<Block> blocks_;
+  std::vector<Slot> slots_;
+};
+
 /*
  * Internal method to perform the memory allocation for a graph
  * */
+template <typename Allocator>
 size_t MXAllocMemory(const Graph& ret,
                      const IndexedGraph& idx,
                      const std::pair<uint32_t, uint32_t>& node_range,
                      StorageVector* storage_ptr,
                      std::vector<int>* storage_inplace_index_ptr,
+                     std::vector<size_t>* storage_offset_ptr,
                      const std::vector<uint32_t>& entry_ref_count,
-                     MXGraphAllocator* allocator) {
+                     Allocator* allocator) {
   static auto& finplace_option   = Op::GetAttr<FInplaceOption>("FInplaceOption");
   static auto& finplace_identity = Op::GetAttr<FInplaceIdentity>("FInplaceIdentity");
   static auto& fignore_inputs    = Op::GetAttr<FIgnoreInputs>("FIgnoreInputs");
+  static auto& fview_outputs     = Op::GetAttr<mxnet::FViewOutputs>("FViewOutputs");
+  static auto& fview_inputs      = Op::GetAttr<mxnet::FViewInputs>("FViewInputs");
 
   // Get reference
   auto& storage               = *storage_ptr;
   auto& storage_inplace_index = *storage_inplace_index_ptr;
+  auto& storage_offset        = *storage_offset_ptr;
+  const bool view_outputs =
+      ret.attrs.count("view_outputs") != 0 && ret.GetAttr<bool>("view_outputs");
 
   // Get attributes from the graph
   const mxnet::ShapeVector& shape_vec = ret.GetAttr<mxnet::ShapeVector>("shape");
@@ -222,10 +356,70 @@ size_t MXAllocMemory(const Graph& ret,
   size_t num_not_allocated = 0;
   std::vector<MXGraphAllocator::StorageID> storage_ref_count(idx.num_node_entries(), 0);
 
+  // the entries read only by a node as contiguous ranges of its first output, with the entry of
+  // that output and their offset in bytes in it, which their producers write in place
+  std::unordered_map<uint32_t, std::pair<uint32_t, size_t>> view_inputs;
+  for (uint32_t nid = node_range.first; view_outputs && nid < node_range.second; ++nid) {
+    const auto& inode = idx[nid];
+    if (inode.source->is_variable() || fview_inputs.count(inode.source->op()) == 0)
+      continue;
+    const uint32_t eid_out = idx.entry_id(nid, 0);
+    mxnet::ShapeVector ishapes;
+    for (const auto& e : inode.inputs)
+      ishapes.push_back(shape_vec[idx.entry_id(e)]);
+    if (storage[eid_out] != MXGraphAllocator::kBadStorageID || entry_ref_count[eid_out] == 0 ||
+        !shape_is_known(shape_vec[eid_out]) ||
+        !std::all_of(ishapes.begin(), ishapes.end(), [](const mxnet::TShape& s) {
+          return shape_is_known(s);
+        }))
+      continue;
+    const auto views = fview_inputs[inode.source->op()](inode.source->attrs, ishapes);
+    for (const auto& kv : views) {
+      const auto& e         = inode.inputs[kv.first];
+      const uint32_t eid_in = idx.entry_id(e);
+      const uint32_t nid_in = idx.node_id(e.node.get());
+      if (e.node->is_variable() || nid_in < node_range.first ||
+          storage[eid_in] != MXGraphAllocator::kBadStorageID || entry_ref_count[eid_in] != 1 ||
+          dtype_vec[eid_in] != dtype_vec[eid_out] ||
+          (device_vec != nullptr && device_vec->at(nid_in) != device_vec->at(nid)))
+        continue;
+      view_inputs[eid_in] = {eid_out, kv.second * MXGetDTypeSize(dtype_vec[eid_out])};
+    }
+  }
+  // places the entry in the memory of the output reading it, allocated first when needed
+  std::function<void(uint32_t, int, uint32_t)> place_view_input = [&](uint32_t eid,
+                                                                      int dev_id,
+                                                                      uint32_t nid) {
+    const auto& view       = view_inputs.at(eid);
+    const uint32_t eid_out = view.first;
+    if (storage[eid_out] == MXGraphAllocator::kBadStorageID) {
+      if (view_inputs.count(eid_out) != 0) {
+        place_view_input(eid_out, dev_id, nid);
+      } else {
+        auto sid = allocator->Request(dev_id, dtype_vec[eid_out], shape_vec[eid_out], nid);
+        if (sid >= 0)
+          storage_ref_count[sid] = entry_ref_count[eid_out];
+        storage[eid_out] = sid;
+      }
+    }
+    auto sid = storage[eid_out];
+    if (sid < 0)
+      return;
+    storage[eid] = sid;
+    storage_ref_count[sid] += entry_ref_count[eid];
+    storage_offset[eid] = storage_offset[eid_out] + view.second;
+  };
+
   for (uint32_t nid = node_range.first; nid < node_range.second; ++nid) {
     const auto& inode = idx[nid];
     if (inode.source->is_variable())
       continue;
+    // write the outputs read as ranges of the output of a later node in its memory
+    for (uint32_t index = 0; !view_inputs.empty() && index < inode.source->num_outputs(); ++index) {
+      const uint32_t eid = idx.entry_id(nid, index);
+      if (view_inputs.count(eid) != 0 && storage[eid] == MXGraphAllocator::kBadStorageID)
+        place_view_input(eid, (device_vec != nullptr) ? device_vec->at(nid) : 0, nid);
+    }
     // check inplace option
     if (finplace_option.count(inode.source->op()) != 0) {
       auto inplace_pairs = finplace_option[inode.source->op()](inode.source->attrs);
@@ -266,9 +460,28 @@ size_t MXAllocMemory(const Graph& ret,
           // input section.
           storage_ref_count[sid_in] += entry_ref_count[eid_out];
           storage_inplace_index[eid_out] = kv.first;
+          storage_offset[eid_out]        = storage_offset[eid_in];
         }
       }
     }
+    // place the outputs that are contiguous ranges of the first input in its memory
+    if (view_outputs && fview_outputs.count(inode.source->op()) != 0 && !inode.inputs.empty() &&
+        shape_is_known(shape_vec[idx.entry_id(inode.inputs[0])])) {
+      uint32_t eid_in = idx.entry_id(inode.inputs[0]);
+      auto sid_in     = storage[eid_in];
+      auto views      = fview_outputs[inode.source->op()](inode.source->attrs, shape_vec[eid_in]);
+      for (const auto& kv : views) {
+        uint32_t eid_out = idx.entry_id(nid, kv.first);
+        if (sid_in < 0 || storage[eid_out] != MXGraphAllocator::kBadStorageID ||
+            entry_ref_count[eid_out] == 0 || dtype_vec[eid_out] != dtype_vec[eid_in])
+          continue;
+        storage[eid_out] = sid_in;
+        storage_ref_count[sid_in] += entry_ref_count[eid_out];
+        storage_inplace_index[eid_out] = 0;
+        storage_offset[eid_out] =
+            storage_offset[eid_in] + kv.second * MXGetDTypeSize(dtype_vec[eid_in]);
+      }
+    }
     // normal allocation
     const int dev_id = (device_vec != nullptr) ? device_vec->at(nid) : 0;
     // sort output nodes based on size before allocating output
@@ -375,6 +588,44 @@ Graph MXPlanMemory(Graph ret) {
     storage.resize(idx.num_node_entries(), -1);
   }
 
+  std::string planner = dmlc::GetEnv("MXNET_MEMORY_PLANNER", std::string("greedy"));
+  if (ret.attrs.count("memory_planner") != 0) {
+    planner = ret.GetAttr<std::string>("memory_planner");
+  }
+  const bool verbose = dmlc::GetEnv("MXNET_MEMORY_PLAN_VERBOSE", false);
+  CHECK(planner == "greedy" || planner == "liverange")
+      << "Unknown memory planner " << planner << ", expected greedy or liverange";
+
+  if (planner == "liverange") {
+    StorageVector storage_vec(storage);
+    std::vector<int> storage_inplace_index(idx.num_node_entries(), -1);
+    std::vector<size_t> storage_offset(idx.num_node_entries(), 0);
+    MXLiveRangeAllocator allocator;
+    size_t storage_num_not_allocated = MXAllocMemory(ret,
+                                                     idx,
+                                                     node_range,
+                                                     &storage_vec,
+                                                     &storage_inplace_index,
+                                                     &storage_offset,
+                                                     ref_count,
+                                                     &allocator);
+    const auto assignment = allocator.Solve();
+    for (auto& sid : storage_vec) {
+      if (sid >= 0)
+        sid = assignment[sid];
+    }
+    size_t storage_allocated_bytes = allocator.TotalAllocBytes();
+    LOG_IF(INFO, verbose) << "Memory plan (liverange): " << storage_allocated_bytes
+                          << " bytes allocated, live entries peak at "
+                          << allocator.PeakLiveBytes() << " bytes";
+    ret.attrs["storage_id"]                = std::make_shared<any>(std::move(storage_vec));
+    ret.attrs["storage_inplace_index"]     = std::make_shared<any>(std::move(storage_inplace_index));
+    ret.attrs["storage_offset"]            = std::make_shared<any>(std::move(storage_offset));
+    ret.attrs["storage_allocated_bytes"]   = std::make_shared<any>(storage_allocated_bytes);
+    ret.attrs["storage_num_not_allocated"] = std::make_shared<any>(storage_num_not_allocated);
+    return ret;
+  }
+
   // Search the best NNVM_EXEC_MATCH_RANGE parameter. This is turned off by default
   size_t min_allocated_bytes = -1;
   size_t max_match_range     = dmlc::GetEnv("NNVM_EXEC_MATCH_RANGE", 16);
@@ -386,19 +637,27 @@ Graph MXPlanMemory(Graph ret) {
     // Make a copy of related fields
     StorageVector storage_vec(storage);
     std::vector<int> storage_inplace_index(idx.num_node_entries(), -1);
+    std::vector<size_t> storage_offset(idx.num_node_entries(), 0);
 
     // the allocator
     MXGraphAllocator allocator(&idx, match_range);
 
     // number of entries that are not statically allocated.
-    size_t storage_num_not_allocated = MXAllocMemory(
-        ret, idx, node_range, &storage_vec, &storage_inplace_index, ref_count, &allocator);
+    size_t storage_num_not_allocated = MXAllocMemory(ret,
+                                                     idx,
+                                                     node_range,
+                                                     &storage_vec,
+                                                     &storage_inplace_index,
+                                                     &storage_offset,
+                                                     ref_count,
+                                                     &allocator);
     size_t storage_allocated_bytes = allocator.TotalAllocBytes();
 
     // Choose the plan which leads to minimal memory usage
     if (min_allocated_bytes > storage_allocated_bytes) {
       ret.attrs["storage_id"]            = std::make_shared<any>(std::move(storage_vec));
       ret.attrs["storage_inplace_index"] = std::make_shared<any>(std::move(storage_inplace_index));
+      ret.attrs["storage_offset"]        = std::make_shared<any>(std::move(storage_offset));
       ret.attrs["storage_allocated_bytes"]   = std::make_shared<any>(storage_allocated_bytes);
       ret.attrs["storage_num_not_allocated"] = std::make_shared<any>(storage_num_not_allocated);
       min_allocated_bytes                    = storage_allocated_bytes;
@@ -408,6 +667,7 @@ Graph MXPlanMemory(Graph ret) {
       break;
     }
   }
+  LOG_IF(INFO, verbose) << "Memory plan (greedy): " << min_allocated_bytes << " bytes allocated";
   return ret;
 }
 
@@ -418,7 +678,8 @@ NNVM_REGISTER_PASS(MXPlanMemory)
     .depend_graph_attr("dtype")
     .depend_graph_attr("shape")
     .provide_graph_attr("storage_id")
-    .provide_graph_attr("storage_inplace_index");
+    .provide_graph_attr("storage_inplace_index")
+    .provide_graph_attr("storage_offset");
 
 }  // namespace
 }  // namespace pass
@@ -53,38 +53,95 @@ struct AllFiniteParam : public dmlc::Parameter<AllFiniteParam> {
 struct MultiAllFiniteParam : public dmlc::Parameter<MultiAllFiniteParam> {
   int num_arrays;
   bool init_output;
+  bool compute_norms;
   DMLC_DECLARE_PARAMETER(MultiAllFiniteParam) {
     DMLC_DECLARE_FIELD(num_arrays).set_default(1).describe("Number of arrays.");
     DMLC_DECLARE_FIELD(init_output).set_default(true).describe("Initialize output to 1.");
+    DMLC_DECLARE_FIELD(compute_norms)
+        .set_default(false)
+        .describe("Also output the l2 norms of the arrays, computed in the same pass.");
   }
 };
 
-template <typename DType>
-struct MultiAllFiniteKernelParam {
-  static const int N = 200;
-  int count;
-  size_t max_size;
-  size_t sizes[N];
-  DType* arrays[N];
+inline bool MultiAllFiniteShape(const nnvm::NodeAttrs& attrs,
+                                mxnet::ShapeVector* in_attrs,
+                                mxnet::ShapeVector* out_attrs) {
+  const MultiAllFiniteParam& param = nnvm::get<MultiAllFiniteParam>(attrs.parsed);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, 1));
+  if (param.compute_norms)
+    SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape(1, param.num_arrays));
+  return true;
+}
+
+inline bool MultiAllFiniteType(const nnvm::NodeAttrs& attrs,
+                               std::vector<int>* in_attrs,
+                               std::vector<int>* out_attrs) {
+  for (size_t i = 0; i < out_attrs->size(); ++i)
+    TYPE_ASSIGN_CHECK(*out_attrs, i, mshadow::kFloat32);
+  return true;
+}
+
+/*!
+ * \brief the entries of the state of the dynamic loss scaling of AMP on the device, a float32
+ *  array: the loss scale, whether the gradients of the step are finite (set by multi_all_finite)
+ *  and the number of finite steps since the loss scale changed
+ */
+enum AMPStateEntry { kAMPLossScale, kAMPFinite, kAMPFiniteSteps, kAMPStateSize };
+
+struct AMPUpdateLossScaleParam : public dmlc::Parameter<AMPUpdateLossScaleParam> {
+  float scale_factor;
+  int scale_window;
+  float max_loss_scale;
+  DMLC_DECLARE_PARAMETER(AMPUpdateLossScaleParam) {
+    DMLC_DECLARE_FIELD(scale_factor)
+        .set_default(2.0f)
+        .describe("Factor of the loss scale when it is increased or decreased.");
+    DMLC_DECLARE_FIELD(scale_window)
+        .set_default(2000)
+        .describe("Number of finite steps after which the loss scale is increased.");
+    DMLC_DECLARE_FIELD(max_loss_scale)
+        .set_default(16777216.0f)
+        .describe("Maximum loss scale.");
+  }
 };
 
-template <typename xpu, typename DType>
-MultiAllFiniteKernelParam<DType> FillMultiAllFiniteParam(const MultiAllFiniteParam& op_param,
-                                                         const OpContext& ctx,
-                                                         const std::vector<TBlob>& inputs) {
-  MultiAllFiniteKernelParam<DType> param;
-  using namespace mxnet_op;
-  Stream<xpu>* s = ctx.get_stream<xpu>();
-  param.count    = op_param.num_arrays;
-  param.max_size = 0;
-  for (int i = 0; i < param.count; ++i) {
-    param.sizes[i] = inputs[i].shape_.Size();
-    if (param.max_size < param.sizes[i]) {
-      param.max_size = param.sizes[i];
+struct AMPUpdateLossScaleKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  const float* state,
+                                  float* out,
+                                  const float scale_factor,
+                                  const int scale_window,
+                                  const float max_loss_scale) {
+    float scale = state[kAMPLossScale];
+    float steps = state[kAMPFiniteSteps] + 1;
+    if (state[kAMPFinite] == 0) {
+      scale /= scale_factor;
+      steps = 0;
+    } else if (steps >= scale_window) {
+      scale = scale * scale_factor < max_loss_scale ? scale * scale_factor : max_loss_scale;
+      steps = 0;
     }
-    param.arrays[i] = inputs[i].FlatTo2D<xpu, DType>(s).dptr_;
+    out[kAMPLossScale]   = scale;
+    out[kAMPFinite]      = state[kAMPFinite];
+    out[kAMPFiniteSteps] = steps;
   }
-  return param;
+};
+
+template <typename xpu>
+inline void AMPUpdateLossScale(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const AMPUpdateLossScaleParam& param = nnvm::get<AMPUpdateLossScaleParam>(attrs.parsed);
+  Kernel<AMPUpdateLossScaleKernel, xpu>::Launch(ctx.get_stream<xpu>(),
+                                                1,
+                                                inputs[0].dptr<float>(),
+                                                outputs[0].dptr<float>(),
+                                                param.scale_factor,
+                                                param.scale_window,
+                                                param.max_loss_scale);
 }
 
 }  // namespace op
@@ -23,7 +23,9 @@
  * \author Clement Fuji Tsang
  */
 #include "./all_finite-inl.h"
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace mxnet {
 namespace op {
@@ -58,37 +60,65 @@ inline void AllFiniteCPU(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*!
+ * \brief whether the elements [begin, end) of array are finite, and the sum of their squares
+ */
 template <typename DType>
-struct MultiAllFiniteCPUKernel {
-  MSHADOW_XINLINE static void Map(int i, const MultiAllFiniteKernelParam<DType> param, float* out) {
-    bool is_finite = true;
-    for (int index = 0; index < param.count; ++index) {
-      if ((size_t)i < param.sizes[index]) {
-        is_finite = std::isfinite(static_cast<float>(param.arrays[index][i])) ? is_finite : false;
-      }
-    }
-    if (!is_finite) {
-      out[0] = 0.;
-    }
+inline bool AllFiniteSumSq(const DType* array,
+                           const index_t begin,
+                           const index_t end,
+                           float* sum_sq) {
+  bool is_finite = true;
+  float sum      = 0;
+  for (index_t i = begin; i < end; ++i) {
+    const float val = static_cast<float>(array[i]);
+    is_finite       = std::isfinite(val) ? is_finite : false;
+    sum += val * val;
   }
-};
+  *sum_sq = sum;
+  return is_finite;
+}
 
 inline void MultiAllFiniteCPU(const nnvm::NodeAttrs& attrs,
                               const OpContext& ctx,
                               const std::vector<TBlob>& inputs,
                               const std::vector<OpReqType>& req,
                               const std::vector<TBlob>& outputs) {
-  using namespace mxnet_op;
-  Stream<cpu>* s                      = ctx.get_stream<cpu>();
   const MultiAllFiniteParam& op_param = nnvm::get<MultiAllFiniteParam>(attrs.parsed);
-  Tensor<cpu, 2, float> out           = outputs[0].FlatTo2D<cpu, float>(s);
+  float* out                          = outputs[0].dptr<float>();
   if (op_param.init_output)
-    out = 1.;
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
-    MultiAllFiniteKernelParam<DType> param =
-        FillMultiAllFiniteParam<cpu, DType>(op_param, ctx, inputs);
-    Kernel<MultiAllFiniteCPUKernel<DType>, cpu>::Launch(s, param.max_size, param, out.dptr_);
-  });
+    out[0] = 1.;
+  // the chunks of all the arrays, of any type, processed by the threads
+  constexpr index_t chunk_size = 1 << 14;
+  std::vector<std::pair<int, index_t>> chunks;
+  for (int index = 0; index < op_param.num_arrays; ++index) {
+    const index_t size = inputs[index].Size();
+    for (index_t begin = 0; begin < size; begin += chunk_size)
+      chunks.emplace_back(index, begin);
+  }
+  std::vector<float> sum_sq(chunks.size());
+  int is_finite         = 1;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) schedule(dynamic) \
+    reduction(&& : is_finite) if (chunks.size() > 1)
+  for (index_t c = 0; c < static_cast<index_t>(chunks.size()); ++c) {
+    const TBlob& array  = inputs[chunks[c].first];
+    const index_t begin = chunks[c].second;
+    const index_t end   = std::min(begin + chunk_size, static_cast<index_t>(array.Size()));
+    MSHADOW_REAL_TYPE_SWITCH(array.type_flag_, DType, {
+      is_finite = AllFiniteSumSq(array.dptr<DType>(), begin, end, &sum_sq[c]) && is_finite;
+    });
+  }
+  if (!is_finite)
+    out[0] = 0.;
+  if (op_param.compute_norms) {
+    float* norms = outputs[1].dptr<float>();
+    std::fill(norms, norms + op_param.num_arrays, 0.0f);
+    for (size_t c = 0; c < chunks.size(); ++c)
+      norms[chunks[c].first] += sum_sq[c];
+    for (int index = 0; index < op_param.num_arrays; ++index)
+      norms[index] = std::sqrt(norms[index]);
+  }
 }
 
 DMLC_REGISTER_PARAMETER(AllFiniteParam);
@@ -129,40 +159,79 @@ DMLC_REGISTER_PARAMETER(MultiAllFiniteParam);
 NNVM_REGISTER_OP(multi_all_finite)
     .add_alias("_npi_multi_all_finite")
     .describe(R"code(Check if all the float numbers in all the arrays are finite (used for AMP)
+
+The arrays may have different types and any number of them is checked in a few launches. With
+``compute_norms``, the l2 norms of the arrays, e.g. of the gradients for logging, are computed
+in the same pass and output as a second float32 array of shape ``(num_arrays,)``.
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const MultiAllFiniteParam& param = dmlc::get<MultiAllFiniteParam>(attrs.parsed);
       return static_cast<uint32_t>(param.num_arrays);
     })
-    .set_num_outputs(1)
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAllFiniteParam& param = dmlc::get<MultiAllFiniteParam>(attrs.parsed);
+      return static_cast<uint32_t>(1 + param.compute_norms);
+    })
     .set_attr_parser(ParamParser<MultiAllFiniteParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiAllFiniteShape)
+    .set_attr<nnvm::FInferType>("FInferType", MultiAllFiniteType)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiAllFiniteParam>(attrs.parsed).num_arrays;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("array_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
+    .add_arguments(MultiAllFiniteParam::__FIELDS__())
+    .set_attr<FCompute>("FCompute<cpu>", MultiAllFiniteCPU);
+
+DMLC_REGISTER_PARAMETER(AMPUpdateLossScaleParam);
+
+NNVM_REGISTER_OP(amp_update_loss_scale)
+    .add_alias("_npi_amp_update_loss_scale")
+    .describe(R"code(Update the state of the dynamic loss scaling on the device (used for AMP)
+
+The state is a float32 array of the loss scale, whether the gradients of the step are
+finite, as written by ``multi_all_finite``, and the number of finite steps since the
+loss scale changed. The loss scale is divided by ``scale_factor`` after a step with
+gradients that are not finite, and multiplied by it, up to ``max_loss_scale``, after
+``scale_window`` finite steps. The loss scale is read by the optimizers updating with
+``with_amp_state``, so that the steps do not wait for the state on the host.
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<AMPUpdateLossScaleParam>)
     .set_attr<mxnet::FInferShape>("FInferShape",
                                   [](const nnvm::NodeAttrs& attrs,
                                      std::vector<TShape>* in_attrs,
                                      std::vector<TShape>* out_attrs) {
-                                    (*out_attrs)[0] = TShape({1});
+                                    SHAPE_ASSIGN_CHECK(*in_attrs, 0, TShape(1, kAMPStateSize));
+                                    SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, kAMPStateSize));
                                     return true;
                                   })
     .set_attr<nnvm::FInferType>("FInferType",
                                 [](const nnvm::NodeAttrs& attrs,
                                    std::vector<int>* in_attrs,
                                    std::vector<int>* out_attrs) {
-                                  (*out_attrs)[0] = mshadow::kFloat32;
+                                  TYPE_ASSIGN_CHECK(*in_attrs, 0, mshadow::kFloat32);
+                                  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
                                   return true;
                                 })
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int>>{{0, 0}};
+                                    })
     .set_attr<nnvm::FListInputNames>("FListInputNames",
                                      [](const NodeAttrs& attrs) {
-                                       uint32_t num_args =
-                                           dmlc::get<MultiAllFiniteParam>(attrs.parsed).num_arrays;
-                                       std::vector<std::string> ret;
-                                       for (uint32_t i = 0; i < num_args; ++i) {
-                                         ret.push_back(std::string("array_") + std::to_string(i));
-                                       }
-                                       return ret;
+                                       return std::vector<std::string>{"amp_state"};
                                      })
-    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
-    .add_arguments(MultiAllFiniteParam::__FIELDS__())
-    .set_attr<FCompute>("FCompute<cpu>", MultiAllFiniteCPU);
+    .add_argument("amp_state", "NDArray-or-Symbol", "State of the dynamic loss scaling")
+    .add_arguments(AMPUpdateLossScaleParam::__FIELDS__())
+    .set_attr<FCompute>("FCompute<cpu>", AMPUpdateLossScale<cpu>);
 
 }  // namespace op
 }  // namespace mxnet
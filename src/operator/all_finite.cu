@@ -24,6 +24,9 @@
  */
 
 #include "./all_finite-inl.h"
+#include <cub/cub.cuh>
+#include <map>
+#include <vector>
 
 namespace mxnet {
 namespace op {
@@ -62,18 +65,109 @@ inline void AllFiniteGPU(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*! \brief the number of elements of the arrays processed by a block of multi_all_finite */
+constexpr index_t kMultiAllFiniteChunk = 1 << 16;
+
+/*!
+ * \brief arguments of a launch of multi_all_finite over up to N arrays of the same type, split
+ *  in up to kMaxChunks chunks of kMultiAllFiniteChunk elements, one per block. The struct stays
+ *  within the 4KB of the arguments of a cuda kernel.
+ */
 template <typename DType>
-__global__ void MultiAllFiniteGPUKernel(const MultiAllFiniteKernelParam<DType> param, float* out) {
-  bool is_finite = true;
-  for (int index = 0; index < param.count; ++index) {
-    CUDA_KERNEL_LOOP(i, param.sizes[index]) {
-      is_finite = isfinite(static_cast<float>(param.arrays[index][i])) ? is_finite : false;
-    }
+struct MultiAllFiniteKernelParam {
+  static const int N          = 96;
+  static const int kMaxChunks = 320;
+  int count;
+  int num_chunks;
+  const DType* arrays[N];
+  index_t sizes[N];
+  /*! \brief the positions of the arrays in the inputs, of their norms in the output */
+  int indices[N];
+  uint8_t chunk_arrays[kMaxChunks];
+  int chunks[kMaxChunks];
+};
+
+template <typename DType, bool compute_norms>
+__global__ void MultiAllFiniteGPUKernel(const MultiAllFiniteKernelParam<DType> param,
+                                        float* out,
+                                        float* sum_sq) {
+  const int index     = param.chunk_arrays[blockIdx.x];
+  const index_t begin = static_cast<index_t>(param.chunks[blockIdx.x]) * kMultiAllFiniteChunk;
+  const index_t end   = min(begin + kMultiAllFiniteChunk, param.sizes[index]);
+  const DType* array  = param.arrays[index];
+  bool is_finite      = true;
+  float sum           = 0;
+  for (index_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    const float val = static_cast<float>(array[i]);
+    is_finite       = isfinite(val) ? is_finite : false;
+    if (compute_norms)
+      sum += val * val;
   }
-  __syncthreads();
   if (!is_finite) {
     out[0] = 0.;
   }
+  if (compute_norms) {
+    typedef cub::BlockReduce<float, mshadow::cuda::kBaseThreadNum> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+    sum = BlockReduce(temp_storage).Sum(sum);
+    if (threadIdx.x == 0)
+      atomicAdd(&sum_sq[param.indices[index]], sum);
+  }
+}
+
+struct MultiAllFiniteNormKernel {
+  MSHADOW_XINLINE static void Map(int i, float* norms) {
+    norms[i] = sqrtf(norms[i]);
+  }
+};
+
+/*! \brief checks the inputs of the given indices, all of type DType */
+template <typename DType, bool compute_norms>
+void MultiAllFiniteGPULaunch(mshadow::Stream<gpu>* s,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<int>& indices,
+                             float* out,
+                             float* sum_sq) {
+  using Param = MultiAllFiniteKernelParam<DType>;
+  static_assert(sizeof(Param) <= 4096, "the arguments of a cuda kernel are limited to 4KB");
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  Param param;
+  param.count      = 0;
+  param.num_chunks = 0;
+  auto launch      = [&]() {
+    MultiAllFiniteGPUKernel<DType, compute_norms>
+        <<<param.num_chunks, mshadow::cuda::kBaseThreadNum, 0, stream>>>(param, out, sum_sq);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(MultiAllFiniteGPUKernel);
+    param.count      = 0;
+    param.num_chunks = 0;
+  };
+  for (const int index : indices) {
+    const index_t size = inputs[index].Size();
+    if (size == 0)
+      continue;
+    if (param.count == Param::N)
+      launch();
+    int k            = param.count++;
+    param.arrays[k]  = inputs[index].dptr<DType>();
+    param.sizes[k]   = size;
+    param.indices[k] = index;
+    const int chunks = (size + kMultiAllFiniteChunk - 1) / kMultiAllFiniteChunk;
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+      if (param.num_chunks == Param::kMaxChunks) {
+        // the next launch starts with the rest of the current array
+        launch();
+        param.arrays[0]  = param.arrays[k];
+        param.sizes[0]   = param.sizes[k];
+        param.indices[0] = param.indices[k];
+        param.count      = 1;
+        k                = 0;
+      }
+      param.chunk_arrays[param.num_chunks] = k;
+      param.chunks[param.num_chunks++]     = chunk;
+    }
+  }
+  if (param.num_chunks > 0)
+    launch();
 }
 
 inline void MultiAllFiniteGPU(const nnvm::NodeAttrs& attrs,
@@ -87,20 +181,36 @@ inline void MultiAllFiniteGPU(const nnvm::NodeAttrs& attrs,
   Tensor<gpu, 2, float> out           = outputs[0].FlatTo2D<gpu, float>(s);
   if (op_param.init_output)
     out = 1.;
-  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
-    MultiAllFiniteKernelParam<DType> param =
-        FillMultiAllFiniteParam<gpu, DType>(op_param, ctx, inputs);
-    MultiAllFiniteGPUKernel<DType><<<cuda_get_num_blocks(param.max_size),
-                                     mshadow::cuda::kBaseThreadNum,
-                                     1,
-                                     mshadow::Stream<gpu>::GetStream(s)>>>(param, out.dptr_);
-    MSHADOW_CUDA_POST_KERNEL_CHECK(MultiAllFiniteGPUKernel<DType>);
-  });
+  float* sum_sq = nullptr;
+  if (op_param.compute_norms) {
+    // the blocks add the sums of squares of their chunks to the norms
+    sum_sq = outputs[1].dptr<float>();
+    CUDA_CALL(cudaMemsetAsync(
+        sum_sq, 0, op_param.num_arrays * sizeof(float), mshadow::Stream<gpu>::GetStream(s)));
+  }
+  // the arrays by type, one kernel reading the arrays of a type
+  std::map<int, std::vector<int>> indices;
+  for (int index = 0; index < op_param.num_arrays; ++index)
+    indices[inputs[index].type_flag_].push_back(index);
+  for (const auto& type_indices : indices) {
+    MSHADOW_REAL_TYPE_SWITCH(type_indices.first, DType, {
+      if (op_param.compute_norms) {
+        MultiAllFiniteGPULaunch<DType, true>(s, inputs, type_indices.second, out.dptr_, sum_sq);
+      } else {
+        MultiAllFiniteGPULaunch<DType, false>(s, inputs, type_indices.second, out.dptr_, sum_sq);
+      }
+    });
+  }
+  if (op_param.compute_norms)
+    Kernel<MultiAllFiniteNormKernel, gpu>::Launch(s, op_param.num_arrays, sum_sq);
 }
 
 NNVM_REGISTER_OP(all_finite).set_attr<FCompute>("FCompute<gpu>", AllFiniteGPU);
 
 NNVM_REGISTER_OP(multi_all_finite).set_attr<FCompute>("FCompute<gpu>", MultiAllFiniteGPU);
 
+NNVM_REGISTER_OP(amp_update_loss_scale)
+    .set_attr<FCompute>("FCompute<gpu>", AMPUpdateLossScale<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
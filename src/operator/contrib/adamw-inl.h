@@ -28,6 +28,7 @@
 #include <vector>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#include "../multi_tensor_apply-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -334,122 +335,62 @@ class Adam_single_precision {
   using type = float;
 };
 
-template <typename DType, typename MPDType>
-struct MultiAdamKernelParam {
-  static const int N = 50;
-  int count;
-  size_t max_size;
-  size_t sizes[N];
-  DType* weights[N];
-  DType* grad_data[N];
-  MPDType* mean_data[N];
-  MPDType* var_data[N];
-  MPDType* weights32[N];
-  DType* out_data[N];
-  MPDType clip_gradient;
-  MPDType beta1;
-  MPDType beta2;
-  MPDType etas[N];
-  MPDType lrs[N];
-  MPDType wds[N];
-  MPDType epsilon;
-};
-
-template <typename MPDType, bool has_mixed_precision>
-struct MultiMPAdamWKernel {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiAdamKernelParam<DType, MPDType>& param,
-                                  const OpReqType req,
-                                  const float rescale_grad) {
-    for (int index = 0; index < param.count; ++index) {
-      if ((size_t)i < param.sizes[index]) {
-        MPDType w =
-            has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
-        MPDType scaled_grad =
-            static_cast<MPDType>(rescale_grad) * static_cast<MPDType>(param.grad_data[index][i]);
-
-        if (param.clip_gradient >= 0.0f)
-          scaled_grad = mshadow_op::clip::Map(scaled_grad, param.clip_gradient);
-
-        const auto mean = param.beta1 * (param.mean_data[index][i] - scaled_grad) + scaled_grad;
-        const auto adj  = mshadow_op::square::Map(scaled_grad);
-        const auto var  = param.beta2 * (param.var_data[index][i] - adj) + adj;
-
-        param.mean_data[index][i] = mean;
-        param.var_data[index][i]  = var;
-        w                         = w - param.etas[index] *
-                    (param.lrs[index] * mean / (mshadow_op::square_root::Map(var) + param.epsilon) +
-                     param.wds[index] * w);
-        if (has_mixed_precision)
-          param.weights32[index][i] = w;
-
-        KERNEL_ASSIGN(param.out_data[index][i], req, w);
-      }
-    }
+struct MultiAdamWOp {
+  static constexpr bool kHasGrad  = true;
+  static constexpr int kNumStates = 2;
+  template <typename MPDType>
+  struct Hyper {
+    MPDType beta1;
+    MPDType beta2;
+    MPDType epsilon;
+  };
+
+  template <typename MPDType, typename Param>
+  MSHADOW_XINLINE static MPDType Map(const int index,
+                                     const index_t i,
+                                     const MPDType w,
+                                     const Param& param) {
+    const MPDType scaled_grad = MultiTensorGrad(param, index, i);
+    MPDType* mean_data        = param.states[0][index];
+    MPDType* var_data         = param.states[1][index];
+
+    const auto mean = param.hyper.beta1 * (mean_data[i] - scaled_grad) + scaled_grad;
+    const auto adj  = mshadow_op::square::Map(scaled_grad);
+    const auto var  = param.hyper.beta2 * (var_data[i] - adj) + adj;
+
+    mean_data[i] = mean;
+    var_data[i]  = var;
+    return w - param.etas[index] *
+                   (param.lrs[index] * mean /
+                        (mshadow_op::square_root::Map(var) + param.hyper.epsilon) +
+                    param.wds[index] * w);
   }
 };
 
-template <typename xpu,
-          typename DType,
-          typename MPDType,
-          typename ParamType = MultiAdamWParam,
-          int input_stride   = 4>
-void FillMultiAdamKernelParam(const nnvm::NodeAttrs& attrs,
-                              const OpContext& ctx,
-                              const std::vector<TBlob>& inputs,
-                              const std::vector<TBlob>& outputs,
-                              MultiAdamKernelParam<DType, MPDType>* pParam) {
-  const ParamType& p       = nnvm::get<ParamType>(attrs.parsed);
-  mxnet_op::Stream<xpu>* s = ctx.get_stream<xpu>();
-  pParam->clip_gradient    = p.clip_gradient;
-  pParam->beta1            = p.beta1;
-  pParam->beta2            = p.beta2;
-
-  pParam->epsilon = p.epsilon;
-
-  pParam->count         = p.num_weights;
-  pParam->max_size      = 0;
-  constexpr bool isSame = std::is_same<DType, MPDType>::value;
-  for (int i = 0; i < pParam->count; ++i) {
-    const auto idx   = i * input_stride;
-    pParam->sizes[i] = inputs[idx].shape_.Size();
-    if (pParam->max_size < pParam->sizes[i])
-      pParam->max_size = pParam->sizes[i];
-
-    pParam->weights[i]   = inputs[idx].FlatTo2D<xpu, DType>(s).dptr_;
-    pParam->grad_data[i] = inputs[idx + 1].FlatTo2D<xpu, DType>(s).dptr_;
-    pParam->mean_data[i] = inputs[idx + 2].FlatTo2D<xpu, MPDType>(s).dptr_;
-    pParam->var_data[i]  = inputs[idx + 3].FlatTo2D<xpu, MPDType>(s).dptr_;
-    // if mixed precision, then the last input in a set
-    // is 32-bit master copy of the weights
-    if (!isSame)
-      pParam->weights32[i] = inputs[idx + input_stride - 1].FlatTo2D<xpu, MPDType>(s).dptr_;
-
-    pParam->out_data[i] = outputs[i].FlatTo2D<xpu, DType>(s).dptr_;
-  }
-  memcpy(pParam->etas, p.etas.begin(), pParam->count * sizeof(p.etas[0]));
-  memcpy(pParam->lrs, p.lrs.begin(), pParam->count * sizeof(p.lrs[0]));
-  memcpy(pParam->wds, p.wds.begin(), pParam->count * sizeof(p.wds[0]));
-}
-
-template <typename xpu, template <typename> class MPTypeChooser, int input_stride>
+template <typename xpu, template <typename> class MPTypeChooser>
 static inline void MultiAdamWUpdate(const nnvm::NodeAttrs& attrs,
                                     const OpContext& ctx,
                                     const std::vector<TBlob>& inputs,
                                     const std::vector<OpReqType>& req,
                                     const std::vector<TBlob>& outputs,
-                                    const float rescale_grad) {
-  using namespace mxnet_op;
-  Stream<xpu>* s = ctx.get_stream<xpu>();
+                                    const float rescale_grad,
+                                    const float* grad_scale) {
+  const MultiAdamWParam& p = nnvm::get<MultiAdamWParam>(attrs.parsed);
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
     using MPDType = typename MPTypeChooser<DType>::type;
-    MultiAdamKernelParam<DType, MPDType> param;
-    FillMultiAdamKernelParam<xpu, DType, MPDType, MultiAdamWParam, input_stride>(
-        attrs, ctx, inputs, outputs, &param);
-
-    Kernel<MultiMPAdamWKernel<MPDType, !std::is_same<DType, MPDType>::value>, xpu>::Launch(
-        s, param.max_size, param, req[0], rescale_grad);
+    const MultiAdamWOp::Hyper<MPDType> hyper{p.beta1, p.beta2, p.epsilon};
+    MultiTensorApply<xpu, MultiAdamWOp, DType, MPDType, !std::is_same<DType, MPDType>::value>(
+        ctx,
+        inputs,
+        req[0],
+        outputs,
+        p.lrs,
+        p.wds,
+        p.etas,
+        rescale_grad,
+        p.clip_gradient,
+        hyper,
+        grad_scale);
   });
 }
 
@@ -494,15 +435,23 @@ inline void multiMPUpdate(const nnvm::NodeAttrs& attrs,
                           const std::vector<OpReqType>& req,
                           const std::vector<TBlob>& outputs) {
   std::vector<TBlob> inputs_wo_scale;
-  float scalef;
-  if (!PrepareInputBlobs<xpu>(ctx, inputs, &inputs_wo_scale, &scalef))
+  float scalef            = 1.0f;
+  const float* grad_scale = nullptr;
+  if (std::is_same<xpu, gpu>::value && inputs.back().type_flag_ == mshadow::kFloat32) {
+    // the kernels read the scale on the device, e.g. the output of clip_global_norm, instead
+    // of waiting for its copy to the host
+    inputs_wo_scale.assign(inputs.begin(), inputs.end() - 1);
+    grad_scale = inputs.back().dptr<float>();
+  } else if (!PrepareInputBlobs<xpu>(ctx, inputs, &inputs_wo_scale, &scalef)) {
     return;
+  }
 
   if (!MP)
-    MultiAdamWUpdate<xpu, Adam_type_identity, 4>(attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+    MultiAdamWUpdate<xpu, Adam_type_identity>(
+        attrs, ctx, inputs_wo_scale, req, outputs, scalef, grad_scale);
   else
-    MultiAdamWUpdate<xpu, Adam_single_precision, 5>(
-        attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+    MultiAdamWUpdate<xpu, Adam_single_precision>(
+        attrs, ctx, inputs_wo_scale, req, outputs, scalef, grad_scale);
 }
 
 }  // namespace adamw
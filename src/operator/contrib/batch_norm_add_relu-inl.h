@@ -0,0 +1,223 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu-inl.h
+ * \brief Batch normalization followed by a residual addition and a ReLU, keeping 1 bit per
+ *  element of the ReLU for the backward pass
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
+#define MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
+
+#include <mxnet/operator.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../nn/batch_norm-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * out = relu(BatchNorm(data) + addend). The reserve output holds the ReLU bitmask, bit i % 32
+ * of word i / 32 for element i, or the reserve space of cuDNN when cuDNN computes the whole
+ * operator.
+ */
+namespace batchnormaddrelu {
+enum BatchNormAddReLUOpInputs { kData, kGamma, kBeta, kInMovingMean, kInMovingVar, kAddend };
+enum BatchNormAddReLUOpOutputs { kOut, kMean, kVar, kReserve };
+enum BatchNormAddReLUOpInputsBwd {
+  kBwdOutGrad,
+  kBwdMean,
+  kBwdVar,
+  kBwdData,
+  kBwdGamma,
+  kBwdBeta,
+  kBwdMovingMean,
+  kBwdMovingVar,
+  kBwdOut,
+  kBwdReserve
+};
+enum BatchNormAddReLUOpOutputsBwd { kBwdDataGrad, kBwdGammaGrad, kBwdBetaGrad, kBwdAddendGrad };
+}  // namespace batchnormaddrelu
+
+/*!
+ * \brief the int32 words of the reserve output. Beyond the bit per element, cuDNN pads its
+ *  bitmask to tiles of rows and channels, so the rows and the channels are rounded up to 64
+ *  with some words to spare. The size cuDNN asks for is checked when it runs.
+ */
+inline index_t BatchNormAddReLUReserveWords(const mxnet::TShape& dshape, int channel_axis) {
+  const index_t channels = dshape[channel_axis];
+  const index_t rows     = channels == 0 ? 0 : dshape.Size() / channels;
+  const index_t bits     = ((rows + 63) / 64 * 64) * ((channels + 63) / 64 * 64);
+  return bits / 32 + 1024;
+}
+
+/*! \brief out = relu(out + addend), with the ReLU bitmask of 32 elements per thread */
+struct BatchNormAddReLUMaskKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t w,
+                                  DType* out,
+                                  const DType* addend,
+                                  uint32_t* mask,
+                                  const index_t size) {
+    const index_t begin = w * 32;
+    const index_t end   = begin + 32 < size ? begin + 32 : size;
+    uint32_t bits       = 0;
+    for (index_t i = begin; i < end; ++i) {
+      const DType v = out[i] + addend[i];
+      if (v > DType(0)) {
+        out[i] = v;
+        bits |= 1U << (i - begin);
+      } else {
+        out[i] = DType(0);
+      }
+    }
+    mask[w] = bits;
+  }
+};
+
+/*! \brief the gradient of the sum, the output gradient where the ReLU bitmask is set */
+struct BatchNormAddReLUGradKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* sum_grad,
+                                  const DType* out_grad,
+                                  const uint32_t* mask) {
+    sum_grad[i] = (mask[i >> 5] >> (i & 31)) & 1U ? out_grad[i] : DType(0);
+  }
+};
+
+/*! \brief out = relu(out + addend), writing the ReLU bitmask to reserve */
+template <typename xpu>
+void BatchNormAddReLUMask(mshadow::Stream<xpu>* s,
+                          const TBlob& out,
+                          const TBlob& addend,
+                          const TBlob& reserve) {
+  const index_t size = out.Size();
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    mxnet_op::Kernel<BatchNormAddReLUMaskKernel, xpu>::Launch(
+        s,
+        (size + 31) / 32,
+        out.dptr<DType>(),
+        addend.dptr<DType>(),
+        reinterpret_cast<uint32_t*>(reserve.dptr<int32_t>()),
+        size);
+  });
+}
+
+/*! \brief the gradient of the sum, to sum_grad of the shape and type of out_grad */
+template <typename xpu>
+void BatchNormAddReLUSumGrad(mshadow::Stream<xpu>* s,
+                             const TBlob& out_grad,
+                             const TBlob& reserve,
+                             const TBlob& sum_grad) {
+  MSHADOW_REAL_TYPE_SWITCH(out_grad.type_flag_, DType, {
+    mxnet_op::Kernel<BatchNormAddReLUGradKernel, xpu>::Launch(
+        s,
+        out_grad.Size(),
+        sum_grad.dptr<DType>(),
+        out_grad.dptr<DType>(),
+        reinterpret_cast<const uint32_t*>(reserve.dptr<int32_t>()));
+  });
+}
+
+/*! \brief the gradient of the addend for req, from the gradient of the sum when it is not there */
+template <typename xpu>
+void BatchNormAddReLUAddendGrad(mshadow::Stream<xpu>* s,
+                                const TBlob& sum_grad,
+                                const OpReqType req,
+                                const TBlob& addend_grad) {
+  using namespace mxnet_op;
+  if (req != kAddTo)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH(addend_grad.type_flag_, DType, {
+    Kernel<op_with_req<mshadow_op::identity, kAddTo>, xpu>::Launch(
+        s, addend_grad.Size(), addend_grad.dptr<DType>(), sum_grad.dptr<DType>());
+  });
+}
+
+/*! \brief BatchNorm, then the addition and the ReLU in a second pass over the output */
+template <typename xpu>
+void BatchNormAddReLUForwardFallback(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(req[kOut], kWriteTo);
+  std::vector<TBlob> bn_inputs(inputs.begin(), inputs.begin() + kAddend);
+  std::vector<TBlob> bn_outputs(outputs.begin(), outputs.begin() + kReserve);
+  std::vector<OpReqType> bn_req(req.begin(), req.begin() + kReserve);
+  BatchNormCompute<xpu>(attrs, ctx, bn_inputs, bn_req, bn_outputs);
+  BatchNormAddReLUMask(ctx.get_stream<xpu>(), outputs[kOut], inputs[kAddend], outputs[kReserve]);
+}
+
+/*!
+ * \brief the gradient of the sum from the ReLU bitmask, then the BatchNorm backward of it. The
+ *  gradient of the sum is the gradient of the addend, and goes to the temp space when the
+ *  gradient of the addend is not written, so the BatchNorm backward of xpu must not use it.
+ */
+template <typename xpu>
+void BatchNormAddReLUBackwardFallback(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& out_grad   = inputs[kBwdOutGrad];
+  TBlob sum_grad          = outputs[kBwdAddendGrad];
+  if (!IsBNWriting(req[kBwdAddendGrad])) {
+    const size_t bytes = out_grad.Size() * mshadow::mshadow_sizeof(out_grad.type_flag_);
+    void* space        = ctx.requested[0].get_space_internal(bytes, "BatchNormAddReLU");
+    sum_grad           = TBlob(space, out_grad.shape_, xpu::kDevMask, out_grad.type_flag_);
+  }
+  BatchNormAddReLUSumGrad(s, out_grad, inputs[kBwdReserve], sum_grad);
+
+  std::vector<TBlob> bn_inputs(inputs.begin(), inputs.begin() + kBwdOut);
+  bn_inputs[kBwdOutGrad] = sum_grad;
+  std::vector<TBlob> bn_outputs(outputs.begin(), outputs.begin() + kBwdAddendGrad);
+  std::vector<OpReqType> bn_req(req.begin(), req.begin() + kBwdAddendGrad);
+  BatchNormGradCompute<xpu>(attrs, ctx, bn_inputs, bn_req, bn_outputs);
+  BatchNormAddReLUAddendGrad(s, sum_grad, req[kBwdAddendGrad], outputs[kBwdAddendGrad]);
+}
+
+template <typename xpu>
+void BatchNormAddReLUCompute(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs);
+
+/*!
+ * The inputs are the output gradient, mean, var, data, gamma, beta, moving_mean, moving_var,
+ * output and reserve. The outputs are the gradients of data, gamma, beta and addend.
+ */
+template <typename xpu>
+void BatchNormAddReLUGradCompute(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
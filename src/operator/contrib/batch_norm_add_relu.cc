@@ -0,0 +1,227 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu.cc
+ * \brief Batch normalization followed by a residual addition and a ReLU
+ */
+
+#include "./batch_norm_add_relu-inl.h"
+
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+static bool BatchNormAddReLUShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_shape,
+                                  mxnet::ShapeVector* out_shape) {
+  using namespace batchnormaddrelu;
+  const BatchNormParam& param = nnvm::get<BatchNormParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 6U)
+      << "Input:[data, gamma, beta, moving_mean, moving_var, addend]";
+  CHECK_EQ(out_shape->size(), 4U);
+  SHAPE_ASSIGN_CHECK(*in_shape, kAddend, in_shape->at(kData));
+  SHAPE_ASSIGN_CHECK(*in_shape, kData, in_shape->at(kAddend));
+  SHAPE_ASSIGN_CHECK(*out_shape, kOut, in_shape->at(kData));
+  const mxnet::TShape& dshape = in_shape->at(kData);
+  if (!mxnet::shape_is_known(dshape)) {
+    return false;
+  }
+
+  const int channel_axis = batchnorm::GetRealAxis(dshape, param.axis);
+  CHECK(channel_axis >= 0 && channel_axis < dshape.ndim())
+      << "Channel axis out of range: " << param.axis;
+  const mxnet::TShape channels(mshadow::Shape1(dshape[channel_axis]));
+  for (int i : {kGamma, kBeta, kInMovingMean, kInMovingVar})
+    SHAPE_ASSIGN_CHECK(*in_shape, i, channels);
+  SHAPE_ASSIGN_CHECK(*out_shape, kMean, channels);
+  SHAPE_ASSIGN_CHECK(*out_shape, kVar, channels);
+  SHAPE_ASSIGN_CHECK(*out_shape,
+                     kReserve,
+                     mxnet::TShape(mshadow::Shape1(
+                         BatchNormAddReLUReserveWords(dshape, channel_axis))));
+  return true;
+}
+
+static bool BatchNormAddReLUType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_type,
+                                 std::vector<int>* out_type) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(in_type->size(), 6U);
+  CHECK_EQ(out_type->size(), 4U);
+  TYPE_ASSIGN_CHECK(*in_type, kAddend, (*in_type)[kData]);
+  TYPE_ASSIGN_CHECK(*in_type, kData, (*in_type)[kAddend]);
+  TYPE_ASSIGN_CHECK(*in_type, kData, (*out_type)[kOut]);
+  TYPE_ASSIGN_CHECK(*out_type, kReserve, mshadow::kInt32);
+  const int dtype = (*in_type)[kData];
+  if (type_is_none(dtype)) {
+    return false;
+  }
+  TYPE_ASSIGN_CHECK(*out_type, kOut, dtype);
+  // For float16 data gamma, beta and the statistics are float32, as in BatchNorm
+  int dtype_param = -1;
+  MSHADOW_REAL_TYPE_SWITCH_EX(
+      dtype, DTypeX, AccRealX, { dtype_param = mshadow::DataType<AccRealX>::kFlag; });
+  for (int i : {kGamma, kBeta, kInMovingMean, kInMovingVar})
+    TYPE_ASSIGN_CHECK(*in_type, i, dtype_param);
+  TYPE_ASSIGN_CHECK(*out_type, kMean, dtype_param);
+  TYPE_ASSIGN_CHECK(*out_type, kVar, dtype_param);
+  return true;
+}
+
+std::vector<nnvm::NodeEntry> BatchNormAddReLUGrad(const nnvm::ObjectPtr& n,
+                                                  const std::vector<nnvm::NodeEntry>& ograds) {
+  using namespace batchnormaddrelu;
+  std::vector<nnvm::NodeEntry> heads;
+  heads.reserve(10);
+  heads.emplace_back(ograds.at(kOut));
+  heads.emplace_back(n, kMean, 0);
+  heads.emplace_back(n, kVar, 0);
+  heads.emplace_back(n->inputs.at(kData));
+  heads.emplace_back(n->inputs.at(kGamma));
+  heads.emplace_back(n->inputs.at(kBeta));
+  heads.emplace_back(n->inputs.at(kInMovingMean));
+  heads.emplace_back(n->inputs.at(kInMovingVar));
+  heads.emplace_back(n, kOut, 0);
+  heads.emplace_back(n, kReserve, 0);
+
+  nnvm::ObjectPtr gnode = nnvm::Node::Create();
+  gnode->inputs         = std::move(heads);
+  gnode->control_deps.emplace_back(n);
+  gnode->attrs      = n->attrs;
+  gnode->attrs.op   = nnvm::Op::Get("_backward_contrib_BatchNormAddReLU");
+  gnode->attrs.name = n->attrs.name + "_backward";
+  std::vector<nnvm::NodeEntry> in_grad;
+  in_grad.reserve(6);
+  for (uint32_t i = 0; i < 3; ++i)
+    in_grad.emplace_back(gnode, i, 0);
+  // attach no gradient node to forbid gradient on aux_state
+  nnvm::ObjectPtr ng = nnvm::Node::Create();
+  ng->attrs.op       = Op::Get("_NoGradient");
+  ng->attrs.name     = "NoGradient";
+  for (size_t i = 3; i < 5; ++i)
+    in_grad.emplace_back(ng);
+  in_grad.emplace_back(gnode, kBwdAddendGrad, 0);
+  return in_grad;
+}
+
+template <>
+void BatchNormAddReLUCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 4U);
+  BatchNormAddReLUForwardFallback<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
+template <>
+void BatchNormAddReLUGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 10U);
+  CHECK_EQ(outputs.size(), 4U);
+  // the BatchNorm backward on CPU does not use the temp space
+  BatchNormAddReLUBackwardFallback<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
+NNVM_REGISTER_OP(_contrib_BatchNormAddReLU)
+    .add_alias("_npx_batch_norm_add_relu")
+    .describe(R"code(Batch normalization, then the addition of a residual and a ReLU.
+
+Computes ``relu(BatchNorm(data) + addend)``, as at the end of the residual blocks of ResNet,
+with the parameters of ``BatchNorm``. The backward pass needs only 1 bit per element of the ReLU,
+kept in the ``reserve`` output, instead of the sum. On GPU, cuDNN computes it with one pass
+over the data in each direction when the channels are the last axis, the data is float16, and
+the statistics of the batch are used in training; otherwise the addition and the ReLU take a
+second pass after the batch normalization.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(4)
+    .set_attr_parser(ParamParser<BatchNormParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data",
+                                                                       "gamma",
+                                                                       "beta",
+                                                                       "moving_mean",
+                                                                       "moving_var",
+                                                                       "addend"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"output", "mean", "var", "reserve"};
+        })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) {
+                                          const BatchNormParam& param =
+                                              nnvm::get<BatchNormParam>(attrs.parsed);
+                                          return param.output_mean_var ? 3 : 1;
+                                        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{3, 4};
+                                   })
+    .set_attr<mxnet::FInferShape>("FInferShape", BatchNormAddReLUShape)
+    .set_attr<nnvm::FInferType>("FInferType", BatchNormAddReLUType)
+    .set_attr<FCompute>("FCompute<cpu>", BatchNormAddReLUCompute<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", BatchNormAddReLUGrad)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol", "Input data to batch normalization")
+    .add_argument("gamma", "NDArray-or-Symbol", "gamma array")
+    .add_argument("beta", "NDArray-or-Symbol", "beta array")
+    .add_argument("moving_mean", "NDArray-or-Symbol", "running mean of input")
+    .add_argument("moving_var", "NDArray-or-Symbol", "running variance of input")
+    .add_argument("addend", "NDArray-or-Symbol", "residual added to the normalized data")
+    .add_arguments(BatchNormParam::__FIELDS__())
+    .set_attr<nnvm::FSetInputVarAttrOnCompose>(
+        "FSetInputVarAttrOnCompose",
+        [](const nnvm::NodeAttrs& attrs, nnvm::ObjectPtr var, const int index) {
+          if (var->attrs.dict.find("__init__") != var->attrs.dict.end())
+            return;
+          if (index == 3) {
+            var->attrs.dict["__init__"] = "[\"zero\", {}]";
+          } else if (index == 4) {
+            var->attrs.dict["__init__"] = "[\"one\", {}]";
+          }
+        });
+
+NNVM_REGISTER_OP(_backward_contrib_BatchNormAddReLU)
+    .set_num_inputs(10)
+    .set_num_outputs(4)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", BatchNormAddReLUGradCompute<cpu>)
+    .set_attr_parser(ParamParser<BatchNormParam>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu.cu
+ * \brief Batch normalization followed by a residual addition and a ReLU, on GPU
+ */
+
+#include "./batch_norm_add_relu-inl.h"
+#if MXNET_USE_CUDNN == 1
+#include "../nn/cudnn/cudnn_batch_norm.h"
+#endif
+
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+// defined in batch_norm.cu
+template <>
+void BatchNormCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs);
+
+template <>
+void BatchNormGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs);
+
+template <>
+void BatchNormAddReLUCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 4U);
+#if MXNET_USE_CUDNN == 1
+  BatchNormParam param = nnvm::get<BatchNormParam>(attrs.parsed);
+  param.axis           = batchnorm::GetRealAxis(inputs[kData].shape_, param.axis);
+  if (!param.use_global_stats && !param.cudnn_off &&
+      CudnnBatchNormSupports(param, inputs[kData])) {
+    CudnnBatchNormAddReLUForward(param, ctx, inputs, req, outputs);
+    return;
+  }
+#endif
+  BatchNormAddReLUForwardFallback<gpu>(attrs, ctx, inputs, req, outputs);
+}
+
+template <>
+void BatchNormAddReLUGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(inputs.size(), 10U);
+  CHECK_EQ(outputs.size(), 4U);
+#if MXNET_USE_CUDNN == 1
+  BatchNormParam param = nnvm::get<BatchNormParam>(attrs.parsed);
+  param.axis           = batchnorm::GetRealAxis(inputs[kBwdData].shape_, param.axis);
+  if (!param.use_global_stats && !param.cudnn_off &&
+      CudnnBatchNormSupports(param, inputs[kBwdData])) {
+    CudnnBatchNormAddReLUBackward(param, ctx, inputs, req, outputs);
+    return;
+  }
+#endif
+  // the BatchNorm backward on GPU uses the temp space, which then cannot hold the gradient of
+  // the sum
+  CHECK(IsBNWriting(req[kBwdAddendGrad]))
+      << "BatchNormAddReLU without cuDNN needs to write the gradient of the addend";
+  BatchNormAddReLUBackwardFallback<gpu>(attrs, ctx, inputs, req, outputs);
+}
+
+NNVM_REGISTER_OP(_contrib_BatchNormAddReLU)
+    .set_attr<FCompute>("FCompute<gpu>", BatchNormAddReLUCompute<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_BatchNormAddReLU)
+    .set_attr<FCompute>("FCompute<gpu>", BatchNormAddReLUGradCompute<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
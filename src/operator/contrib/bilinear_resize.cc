@@ -22,6 +22,7 @@
  * \author Hang Zhang
  */
 #include "bilinear_resize-inl.h"
+#include <algorithm>
 #include "../elemwise_op_common.h"
 
 namespace mxnet {
@@ -29,6 +30,46 @@ namespace op {
 
 using namespace mshadow;
 
+/*! \brief source elements and weights of one output row or column of the resize */
+template <typename AccReal>
+struct BilinearTap {
+  int index;  // first source element
+  int step;   // offset of the second one, 0 at the last element
+  AccReal lambda0;
+  AccReal lambda1;
+};
+
+template <typename AccReal>
+static std::vector<BilinearTap<AccReal>> BilinearTaps(int input_size,
+                                                      int output_size,
+                                                      bool align_corners) {
+  const float scale = area_pixel_compute_scale<float>(input_size, output_size, align_corners);
+  std::vector<BilinearTap<AccReal>> taps(output_size);
+  for (int o = 0; o < output_size; ++o) {
+    const float r     = area_pixel_compute_source_index<float>(scale, o, align_corners, false);
+    const int i     = r;
+    taps[o].index   = i;
+    taps[o].step    = (i < input_size - 1) ? 1 : 0;
+    taps[o].lambda1 = r - i;
+    taps[o].lambda0 = AccReal(1) - taps[o].lambda1;
+  }
+  return taps;
+}
+
+/*!
+ * \brief rows of each plane per work item, so that the work items of few large planes still
+ *  occupy every thread
+ */
+static int BilinearRowBlock(int planes, int rows, int nthreads) {
+  const int blocks = std::min(rows, std::max(1, (nthreads + planes - 1) / planes));
+  return (rows + blocks - 1) / blocks;
+}
+
+/*!
+ * \brief The resize is separable: every output row blends two source rows interpolated along
+ *  the width. Consecutive output rows mostly share their source rows, so the interpolated rows
+ *  are kept in two buffers and each is computed once when upsampling.
+ */
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            const std::vector<TBlob>& input,
@@ -36,71 +77,75 @@ void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            bool align_corners) {
   Tensor<xpu, 4, DType> itensor = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> otensor = output[0].get<xpu, 4, DType>(s);
-  int nbatch                    = otensor.size(0);
-  int channels                  = otensor.size(1);
-  int outputHeight              = otensor.size(2);
-  int outputWidth               = otensor.size(3);
-  int inputHeight               = itensor.size(2);
-  int inputWidth                = itensor.size(3);
+  const int planes              = otensor.size(0) * otensor.size(1);
+  const int outputHeight        = otensor.size(2);
+  const int outputWidth         = otensor.size(3);
+  const int inputHeight         = itensor.size(2);
+  const int inputWidth          = itensor.size(3);
+  const DType* idata            = itensor.dptr_;
+  DType* odata                  = otensor.dptr_;
 
   const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-  DType* idata                       = itensor.dptr_;
-  DType* odata                       = otensor.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
-
   // special case: just copy
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    const index_t size = otensor.shape_.Size();
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      const DType* pos1 = &idata[h1 * inputWidth + w1];
-      DType* pos2       = &odata[index];
-      for (int c = 0; c < channels; ++c) {
-        *pos2 = *pos1;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
-      }
-    }
+    for (index_t i = 0; i < size; ++i)
+      odata[i] = idata[i];
     return;
   }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
+  const auto htaps    = BilinearTaps<AccReal>(inputHeight, outputHeight, align_corners);
+  const auto wtaps    = BilinearTaps<AccReal>(inputWidth, outputWidth, align_corners);
+  const int row_block = BilinearRowBlock(planes, outputHeight, nthreads);
+  const int blocks    = (outputHeight + row_block - 1) / row_block;
 
-#pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-    const DType* pos1    = &idata[h1 * inputWidth + w1];
-    DType* pos2          = &odata[index];
-
-    for (int c = 0; c < channels; ++c) {
-      *pos2 = h0lambda * (w0lambda * (*pos1) + w1lambda * *(pos1 + w1p)) +
-              h1lambda * (w0lambda * *(pos1 + h1p * inputWidth) +
-                          w1lambda * *(pos1 + h1p * inputWidth + w1p));
-      pos1 += input_elems_per_channel;
-      pos2 += output_elems_per_channel;
+#pragma omp parallel num_threads(nthreads)
+  {
+    std::vector<AccReal> rows(2 * outputWidth);
+#pragma omp for
+    for (int item = 0; item < planes * blocks; ++item) {
+      const int plane   = item / blocks;
+      const int h_begin = (item % blocks) * row_block;
+      const int h_end   = std::min(outputHeight, h_begin + row_block);
+      const DType* in   = idata + static_cast<index_t>(plane) * inputHeight * inputWidth;
+      DType* out        = odata + static_cast<index_t>(plane) * outputHeight * outputWidth;
+      int cached[2]     = {-1, -1};
+      // the buffer holding source row h interpolated along the width, not evicting row keep
+      auto row = [&](int h, int keep) {
+        for (int b = 0; b < 2; ++b) {
+          if (cached[b] == h)
+            return rows.data() + b * outputWidth;
+        }
+        const int b      = cached[0] == keep ? 1 : 0;
+        AccReal* buf     = rows.data() + b * outputWidth;
+        const DType* src = in + h * inputWidth;
+        for (int w2 = 0; w2 < outputWidth; ++w2) {
+          const BilinearTap<AccReal>& t = wtaps[w2];
+          const AccReal left            = static_cast<AccReal>(src[t.index]);
+          const AccReal right           = static_cast<AccReal>(src[t.index + t.step]);
+          buf[w2]                       = t.lambda0 * left + t.lambda1 * right;
+        }
+        cached[b] = h;
+        return buf;
+      };
+      for (int h2 = h_begin; h2 < h_end; ++h2) {
+        const BilinearTap<AccReal>& t = htaps[h2];
+        const AccReal* top            = row(t.index, t.index + t.step);
+        const AccReal* bottom         = row(t.index + t.step, t.index);
+        DType* dst                    = out + h2 * outputWidth;
+        for (int w2 = 0; w2 < outputWidth; ++w2)
+          dst[w2] = static_cast<DType>(t.lambda0 * top[w2] + t.lambda1 * bottom[w2]);
+      }
     }
   }
 }
 
+/*!
+ * \brief The adjoint of the separable forward pass: each output gradient row is interpolated
+ *  back along the width once, then added to its two source rows. The work items own disjoint
+ *  blocks of source rows, so no update needs to be atomic.
+ */
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
                                               const std::vector<TBlob>& input,
@@ -110,70 +155,65 @@ void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
   Tensor<xpu, 4, DType> gradOutput = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> gradInput  = output[0].get<xpu, 4, DType>(s);
 
-  int nbatch       = gradInput.size(0);
-  int channels     = gradInput.size(1);
-  int outputHeight = gradOutput.size(2);
-  int outputWidth  = gradOutput.size(3);
-  int inputHeight  = gradInput.size(2);
-  int inputWidth   = gradInput.size(3);
+  const int nbatch        = gradInput.size(0);
+  const int planes        = nbatch * gradInput.size(1);
+  const int outputHeight  = gradOutput.size(2);
+  const int outputWidth   = gradOutput.size(3);
+  const int inputHeight   = gradInput.size(2);
+  const int inputWidth    = gradInput.size(3);
+  DType* dataInput        = gradInput.dptr_;
+  const DType* dataOutput = gradOutput.dptr_;
 
   const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-  DType* dataInput                   = gradInput.dptr_;
-  DType* dataOutput                  = gradOutput.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
-
   // special case: same-size matching grids
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    const index_t size = gradInput.shape_.Size();
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      DType* pos1       = &dataInput[h1 * inputWidth + w1];
-      const DType* pos2 = &dataOutput[index];
-      for (int c = 0; c < channels; ++c) {
-        *pos1 += *pos2;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
-      }
-    }
-    return;
-  }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
-#pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-
-    DType* posInput        = &dataInput[h1 * inputWidth + w1];
-    const DType* posOutput = &dataOutput[index];
-    for (int c = 0; c < channels; ++c) {
-#pragma omp critical
-      {
-        *posInput += h0lambda * w0lambda * (*posOutput);
-        *(posInput + w1p) += h0lambda * w1lambda * (*posOutput);
-        *(posInput + h1p * inputWidth) += h1lambda * w0lambda * (*posOutput);
-        *(posInput + h1p * inputWidth + w1p) += h1lambda * w1lambda * (*posOutput);
+    for (index_t i = 0; i < size; ++i)
+      dataInput[i] += dataOutput[i];
+  } else {
+    const auto htaps    = BilinearTaps<AccReal>(inputHeight, outputHeight, align_corners);
+    const auto wtaps    = BilinearTaps<AccReal>(inputWidth, outputWidth, align_corners);
+    const int row_block = BilinearRowBlock(planes, inputHeight, nthreads);
+    const int blocks    = (inputHeight + row_block - 1) / row_block;
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<AccReal> row(inputWidth);
+#pragma omp for
+      for (int item = 0; item < planes * blocks; ++item) {
+        const int plane   = item / blocks;
+        const int h_begin = (item % blocks) * row_block;
+        const int h_end   = std::min(inputHeight, h_begin + row_block);
+        DType* in         = dataInput + static_cast<index_t>(plane) * inputHeight * inputWidth;
+        const DType* out =
+            dataOutput + static_cast<index_t>(plane) * outputHeight * outputWidth;
+        for (int h2 = 0; h2 < outputHeight; ++h2) {
+          const BilinearTap<AccReal>& t = htaps[h2];
+          const bool top                = t.index >= h_begin && t.index < h_end;
+          const bool bottom = t.index + t.step >= h_begin && t.index + t.step < h_end;
+          if (!top && !bottom)
+            continue;
+          std::fill(row.begin(), row.end(), AccReal(0));
+          const DType* src = out + h2 * outputWidth;
+          for (int w2 = 0; w2 < outputWidth; ++w2) {
+            const BilinearTap<AccReal>& tw = wtaps[w2];
+            const AccReal g                = static_cast<AccReal>(src[w2]);
+            row[tw.index] += tw.lambda0 * g;
+            row[tw.index + tw.step] += tw.lambda1 * g;
+          }
+          if (top) {
+            DType* dst = in + t.index * inputWidth;
+            for (int w1 = 0; w1 < inputWidth; ++w1)
+              dst[w1] += static_cast<DType>(t.lambda0 * row[w1]);
+          }
+          if (bottom) {
+            DType* dst = in + (t.index + t.step) * inputWidth;
+            for (int w1 = 0; w1 < inputWidth; ++w1)
+              dst[w1] += static_cast<DType>(t.lambda1 * row[w1]);
+          }
+        }
       }
-      posInput += input_elems_per_channel;
-      posOutput += output_elems_per_channel;
     }
   }
 
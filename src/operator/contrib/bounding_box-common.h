@@ -60,72 +60,6 @@ MSHADOW_XINLINE DType Intersect(const DType* a, const DType* b, int encode) {
   return w > 0 ? w : DType(0);
 }
 
-/*!
- * \brief Implementation of the non-maximum suppression operation
- *
- * \param i the launched thread index
- * \param index sorted index in descending order
- * \param batch_start map (b, k) to compact index by indices[batch_start[b] + k]
- * \param input the input of nms op
- * \param areas pre-computed box areas
- * \param k nms topk number
- * \param ref compare reference position
- * \param num number of input boxes in each batch
- * \param stride input stride, usually 6 (id-score-x1-y1-x2-y2)
- * \param offset_box box offset, usually 2
- * \param thresh nms threshold
- * \param force force suppress regardless of class id
- * \param offset_id class id offset, used when force == false, usually 0
- * \param encode box encoding type, corner(0) or center(1)
- * \param DType the data type
- */
-struct nms_impl {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  int32_t* index,
-                                  const int32_t* batch_start,
-                                  const DType* input,
-                                  const DType* areas,
-                                  int k,
-                                  int ref,
-                                  int num,
-                                  int stride,
-                                  int offset_box,
-                                  int offset_id,
-                                  float thresh,
-                                  bool force,
-                                  int encode) {
-    int b   = i / k;            // batch
-    int pos = i % k + ref + 1;  // position
-    ref     = static_cast<int>(batch_start[b]) + ref;
-    pos     = static_cast<int>(batch_start[b]) + pos;
-    if (ref >= static_cast<int>(batch_start[b + 1]))
-      return;
-    if (pos >= static_cast<int>(batch_start[b + 1]))
-      return;
-    if (index[ref] < 0)
-      return;  // reference has been suppressed
-    if (index[pos] < 0)
-      return;  // self been suppressed
-    int ref_offset = static_cast<int>(index[ref]) * stride + offset_box;
-    int pos_offset = static_cast<int>(index[pos]) * stride + offset_box;
-    if (!force && offset_id >= 0) {
-      int ref_id = static_cast<int>(input[ref_offset - offset_box + offset_id]);
-      int pos_id = static_cast<int>(input[pos_offset - offset_box + offset_id]);
-      if (ref_id != pos_id)
-        return;  // different class
-    }
-    DType intersect = Intersect(input + ref_offset, input + pos_offset, encode);
-    intersect *= Intersect(input + ref_offset + 1, input + pos_offset + 1, encode);
-    int ref_area_offset = static_cast<int>(index[ref]);
-    int pos_area_offset = static_cast<int>(index[pos]);
-    DType iou           = intersect / (areas[ref_area_offset] + areas[pos_area_offset] - intersect);
-    if (iou > thresh) {
-      index[pos] = -1;
-    }
-  }
-};
-
 namespace mshadow_op {
 struct less_than : public mxnet_op::tunable {
   template <typename DType>
@@ -24,6 +24,7 @@
 */
 #ifndef MXNET_OPERATOR_CONTRIB_BOUNDING_BOX_INL_CUH_
 #define MXNET_OPERATOR_CONTRIB_BOUNDING_BOX_INL_CUH_
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <mxnet/operator_util.h>
@@ -77,114 +78,143 @@ MSHADOW_XINLINE DType Intersect2(const DType *a, const DType b1, const DType b2,
   return w > 0 ? w : DType(0);
 }
 
-template<typename DType, int N, bool check_class>
-__launch_bounds__(512)
-__global__ void nms_apply_kernel(const int topk, int32_t *index,
-                                 const int32_t *batch_start,
-                                 const DType *input,
-                                 const DType *areas,
-                                 const int num, const int stride,
-                                 const int offset_box, const int offset_id,
-                                 const float thresh, const bool force,
-                                 const int encode, const int start_offset) {
-  constexpr int block_size = 512;
-  const int start = static_cast<int>(batch_start[blockIdx.x]) + start_offset;
-  const int size_of_batch = static_cast<int>(batch_start[blockIdx.x + 1]) - start;
-  const int end = min(min(size_of_batch, topk - start_offset), N * block_size);
-  __shared__ int s_index[N * block_size];
+/*! \brief number of boxes per tile of the suppression mask, one bit of a mask word each */
+constexpr int kNMSTileSize = 64;
+/*! \brief threads of the kernel reducing the suppression mask of a batch */
+constexpr int kNMSReduceThreads = 128;
+/*! \brief upper bound of the suppression mask, larger batches are processed in chunks */
+constexpr size_t kNMSMaxMaskBytes = 64 << 20;
 
-  for (int i = threadIdx.x; i < end; i += block_size) {
-    s_index[i] = static_cast<int>(index[start + i]);
-  }
+inline int NMSMaskBlocks(int topk) {
+  return (topk + kNMSTileSize - 1) / kNMSTileSize;
+}
 
-  __syncthreads();
-  for (int ref = 0; ref < end; ++ref) {
-    const int ref_area_offset = static_cast<int>(s_index[ref]);
-    if (ref_area_offset >= 0) {
-      const int ref_offset = ref_area_offset * stride + offset_box;
-      int ref_id = 0;
-      if (check_class) {
-        ref_id = static_cast<int>(input[ref_offset - offset_box + offset_id]);
-      }
-      for (int i = 0; i < N; ++i) {
-        const int my_pos = threadIdx.x + i * block_size;
-        if (my_pos > ref && my_pos < end && s_index[my_pos] >= 0) {
-          const int pos_area_offset = static_cast<int>(s_index[my_pos]);
-          const int pos_offset = pos_area_offset * stride + offset_box;
-          if (check_class) {
-            const int pos_id = static_cast<int>(input[pos_offset - offset_box + offset_id]);
-            if (ref_id != pos_id) continue;  // different class
-          }
-          DType intersect = Intersect(input + ref_offset, input + pos_offset, encode);
-          intersect *= Intersect(input + ref_offset + 1, input + pos_offset + 1, encode);
-          const DType iou = intersect /
-                            (areas[ref_area_offset] + areas[pos_area_offset] - intersect);
-          if (iou > thresh) {
-            s_index[my_pos] = -1;
-          }
-        }
-      }
-      __syncthreads();
-    }
-  }
+/*! \brief number of batches whose suppression masks are computed at once */
+inline int NMSMaskBatches(int num_batch, int topk) {
+  const size_t batch_bytes = static_cast<size_t>(topk) * NMSMaskBlocks(topk) * sizeof(uint64_t);
+  const size_t batches     = std::max<size_t>(1, kNMSMaxMaskBytes / batch_bytes);
+  return static_cast<int>(std::min<size_t>(std::min<size_t>(num_batch, batches), 65535));
+}
 
-  for (int i = threadIdx.x; i < end; i += block_size) {
-    index[start + i] = s_index[i];
-  }
+/*! \brief number of 64-bit words of the workspace of NMSApply */
+inline index_t NMSMaskSize(mshadow::Stream<gpu> *s, int num_batch, int topk) {
+  return static_cast<index_t>(NMSMaskBatches(num_batch, topk)) * topk * NMSMaskBlocks(topk);
 }
 
-template<typename DType, int N, bool check_class>
-__launch_bounds__(512)
-__global__ void nms_apply_kernel_rest(const int topk, int32_t *index,
-                                 const int32_t *batch_start,
-                                 const DType *input,
-                                 const DType *areas,
-                                 const int num, const int stride,
-                                 const int offset_box, const int offset_id,
-                                 const float thresh, const bool force,
-                                 const int encode, const int start_offset,
-                                 const int blocks_per_batch) {
-  constexpr int block_size = 512;
-  const int batch = blockIdx.x / blocks_per_batch;
-  const int start_ref = static_cast<int>(batch_start[batch]) + start_offset;
-  const int block_offset = (N + blockIdx.x % blocks_per_batch) * block_size;
-  const int start = start_ref + block_offset;
+/*!
+ * \brief Computes one tile of the suppression mask of a batch.
+ *  Bit j of word (i, blockIdx.x) is set if the box at sorted position i overlaps the box at
+ *  position blockIdx.x * 64 + j by more than thresh, with both boxes of the same class
+ *  when check_class. Only the tiles on and right of the diagonal are computed.
+ */
+template<typename DType, bool check_class>
+__launch_bounds__(kNMSTileSize)
+__global__ void nms_mask_kernel(const int topk, const int col_blocks, const int batch_offset,
+                                const int32_t *index, const int32_t *batch_start,
+                                const DType *input, const DType *areas,
+                                const int stride, const int offset_box, const int offset_id,
+                                const float thresh, const int encode, uint64_t *mask) {
+  const int batch     = batch_offset + blockIdx.z;
+  const int start     = static_cast<int>(batch_start[batch]);
+  const int size      = min(static_cast<int>(batch_start[batch + 1]) - start, topk);
+  const int row_start = blockIdx.y * kNMSTileSize;
+  const int col_start = blockIdx.x * kNMSTileSize;
+  if (blockIdx.x < blockIdx.y || row_start >= size || col_start >= size) return;
+  const int row_size = min(size - row_start, kNMSTileSize);
+  const int col_size = min(size - col_start, kNMSTileSize);
+  __shared__ DType s_box[kNMSTileSize * 4];
+  __shared__ DType s_area[kNMSTileSize];
+  __shared__ int s_id[kNMSTileSize];
 
-  const int size_of_batch = static_cast<int>(batch_start[batch + 1]) - start;
-  const int end = min(size_of_batch, topk - start_offset - block_offset);
-  const int my_pos = start + threadIdx.x;
-  if (threadIdx.x < end && index[my_pos] >= 0) {
-    const int pos_area_offset = static_cast<int>(index[my_pos]);
-    const int pos_offset = pos_area_offset * stride + offset_box;
-    DType my_box[4];
+  if (threadIdx.x < col_size) {
+    const int pos        = static_cast<int>(index[start + col_start + threadIdx.x]);
+    const int pos_offset = pos * stride + offset_box;
 #pragma unroll
     for (int i = 0; i < 4; ++i) {
-      my_box[i] = input[pos_offset + i];
+      s_box[threadIdx.x * 4 + i] = input[pos_offset + i];
     }
-    const DType my_area = areas[pos_area_offset];
-    int pos_id = 0;
+    s_area[threadIdx.x] = areas[pos];
     if (check_class) {
-      pos_id = static_cast<int>(input[pos_offset - offset_box + offset_id]);
+      s_id[threadIdx.x] = static_cast<int>(input[pos * stride + offset_id]);
+    }
+  }
+  __syncthreads();
+
+  if (threadIdx.x < row_size) {
+    const int ref        = static_cast<int>(index[start + row_start + threadIdx.x]);
+    const int ref_offset = ref * stride + offset_box;
+    DType my_box[4];
+#pragma unroll
+    for (int i = 0; i < 4; ++i) {
+      my_box[i] = input[ref_offset + i];
     }
+    const DType my_area = areas[ref];
+    const int my_id     = check_class ? static_cast<int>(input[ref * stride + offset_id]) : 0;
+    uint64_t bits       = 0;
+    const int first     = blockIdx.x == blockIdx.y ? threadIdx.x + 1 : 0;
+    for (int j = first; j < col_size; ++j) {
+      if (check_class && s_id[j] != my_id) continue;  // different class
+      DType intersect = Intersect2(s_box + j * 4, my_box[0], my_box[2], encode);
+      intersect *= Intersect2(s_box + j * 4 + 1, my_box[1], my_box[3], encode);
+      const DType iou = intersect / (s_area[j] + my_area - intersect);
+      if (iou > thresh) {
+        bits |= 1ULL << j;
+      }
+    }
+    const size_t row = static_cast<size_t>(blockIdx.z) * topk + row_start + threadIdx.x;
+    mask[row * col_blocks + blockIdx.x] = bits;
+  }
+}
 
-    for (int ref = start_ref; ref < start_ref + N * block_size; ++ref) {
-      const int ref_area_offset = static_cast<int>(index[ref]);
-      if (ref_area_offset >= 0) {
-        const int ref_offset = ref_area_offset * stride + offset_box;
-        int ref_id = 0;
-        if (check_class) {
-          ref_id = static_cast<int>(input[ref_offset - offset_box + offset_id]);
-          if (ref_id != pos_id) continue;  // different class
+/*!
+ * \brief Greedily walks the sorted boxes of a batch and marks the suppressed ones with -1.
+ *  The boxes of a tile are resolved against each other by one thread, then the kept boxes
+ *  of the tile suppress the following tiles, one mask word per thread.
+ */
+__launch_bounds__(kNMSReduceThreads)
+__global__ void nms_reduce_mask_kernel(const int topk, const int col_blocks,
+                                       const int batch_offset, int32_t *index,
+                                       const int32_t *batch_start, const uint64_t *mask) {
+  extern __shared__ uint64_t s_removed[];
+  const int batch      = batch_offset + blockIdx.x;
+  const int start      = static_cast<int>(batch_start[batch]);
+  const int size       = min(static_cast<int>(batch_start[batch + 1]) - start, topk);
+  const int num_blocks = (size + kNMSTileSize - 1) / kNMSTileSize;
+  const uint64_t *batch_mask = mask + static_cast<size_t>(blockIdx.x) * topk * col_blocks;
+  for (int i = threadIdx.x; i < num_blocks; i += blockDim.x) {
+    s_removed[i] = 0;
+  }
+  __syncthreads();
+
+  for (int block = 0; block < num_blocks; ++block) {
+    const int n          = min(size - block * kNMSTileSize, kNMSTileSize);
+    const uint64_t *rows = batch_mask + static_cast<size_t>(block) * kNMSTileSize * col_blocks;
+    if (threadIdx.x == 0) {
+      uint64_t removed = s_removed[block];
+      for (int k = 0; k < n; ++k) {
+        if (!((removed >> k) & 1ULL)) {
+          removed |= rows[k * col_blocks + block];
         }
-        DType intersect = Intersect2(input + ref_offset, my_box[0], my_box[2], encode);
-        intersect *= Intersect2(input + ref_offset + 1, my_box[1], my_box[3], encode);
-        const DType iou = intersect /
-          (areas[ref_area_offset] + my_area - intersect);
-        if (iou > thresh) {
-          index[my_pos] = -1;
-          break;
+      }
+      s_removed[block] = removed;
+    }
+    __syncthreads();
+    const uint64_t removed = s_removed[block];
+    for (int j = block + 1 + threadIdx.x; j < num_blocks; j += blockDim.x) {
+      uint64_t word = s_removed[j];
+      for (int k = 0; k < n; ++k) {
+        if (!((removed >> k) & 1ULL)) {
+          word |= rows[k * col_blocks + j];
         }
       }
+      s_removed[j] = word;
+    }
+    __syncthreads();
+  }
+
+  for (int i = threadIdx.x; i < size; i += blockDim.x) {
+    if ((s_removed[i / kNMSTileSize] >> (i % kNMSTileSize)) & 1ULL) {
+      index[start + i] = -1;
     }
   }
 }
@@ -196,82 +226,33 @@ void NMSApply(mshadow::Stream<gpu> *s,
               mshadow::Tensor<gpu, 1, int32_t>* batch_start,
               mshadow::Tensor<gpu, 3, DType>* buffer,
               mshadow::Tensor<gpu, 1, DType>* areas,
+              mshadow::Tensor<gpu, 1, uint64_t>* mask,
               int num_elem, int width_elem,
               int coord_start, int id_index,
               float threshold, bool force_suppress,
               int in_format) {
-  using namespace mxnet_op;
-  constexpr int THRESHOLD = 1024;
-  for (int ref = 0; ref < topk; ref += THRESHOLD) {
-    constexpr int block_size = 512;
-    constexpr int N = THRESHOLD / block_size;
-    auto stream = mshadow::Stream<gpu>::GetStream(s);
+  const int col_blocks   = NMSMaskBlocks(topk);
+  const int mask_batches = NMSMaskBatches(num_batch, topk);
+  const size_t shared    = col_blocks * sizeof(uint64_t);
+  CHECK_LE(shared, 48 * 1024) << "topk of box_nms is too large: " << topk;
+  CHECK_GE(mask->MSize(), NMSMaskSize(s, num_batch, topk));
+  auto stream = mshadow::Stream<gpu>::GetStream(s);
+  for (int b = 0; b < num_batch; b += mask_batches) {
+    const int batches = std::min(mask_batches, num_batch - b);
+    const dim3 grid(col_blocks, col_blocks, batches);
     if (!force_suppress && id_index >= 0) {
-      nms_apply_kernel<DType, N, true><<<num_batch, block_size, 0, stream>>>(topk,
-                                                                      sorted_index->dptr_,
-                                                                      batch_start->dptr_,
-                                                                      buffer->dptr_,
-                                                                      areas->dptr_,
-                                                                      num_elem,
-                                                                      width_elem,
-                                                                      coord_start,
-                                                                      id_index,
-                                                                      threshold,
-                                                                      force_suppress,
-                                                                      in_format,
-                                                                      ref);
-      int blocks_per_batch = (topk - ref - THRESHOLD + block_size - 1)/block_size;
-      int blocks = blocks_per_batch  * num_batch;
-      if (blocks > 0) {
-        nms_apply_kernel_rest<DType, N, true><<<blocks, block_size, 0, stream>>>(topk,
-                                                                        sorted_index->dptr_,
-                                                                        batch_start->dptr_,
-                                                                        buffer->dptr_,
-                                                                        areas->dptr_,
-                                                                        num_elem,
-                                                                        width_elem,
-                                                                        coord_start,
-                                                                        id_index,
-                                                                        threshold,
-                                                                        force_suppress,
-                                                                        in_format,
-                                                                        ref,
-                                                                        blocks_per_batch);
-      }
+      nms_mask_kernel<DType, true><<<grid, kNMSTileSize, 0, stream>>>(
+          topk, col_blocks, b, sorted_index->dptr_, batch_start->dptr_, buffer->dptr_,
+          areas->dptr_, width_elem, coord_start, id_index, threshold, in_format, mask->dptr_);
     } else {
-      nms_apply_kernel<DType, N, false><<<num_batch, block_size, 0, stream>>>(topk,
-                                                                       sorted_index->dptr_,
-                                                                       batch_start->dptr_,
-                                                                       buffer->dptr_,
-                                                                       areas->dptr_,
-                                                                       num_elem,
-                                                                       width_elem,
-                                                                       coord_start,
-                                                                       id_index,
-                                                                       threshold,
-                                                                       force_suppress,
-                                                                       in_format,
-                                                                       ref);
-      int blocks_per_batch = (topk - ref - THRESHOLD + block_size - 1)/block_size;
-      int blocks = blocks_per_batch  * num_batch;
-      if (blocks > 0) {
-        nms_apply_kernel_rest<DType, N, false><<<blocks, block_size, 0, stream>>>(topk,
-                                                                        sorted_index->dptr_,
-                                                                        batch_start->dptr_,
-                                                                        buffer->dptr_,
-                                                                        areas->dptr_,
-                                                                        num_elem,
-                                                                        width_elem,
-                                                                        coord_start,
-                                                                        id_index,
-                                                                        threshold,
-                                                                        force_suppress,
-                                                                        in_format,
-                                                                        ref,
-                                                                        blocks_per_batch);
-      }
+      nms_mask_kernel<DType, false><<<grid, kNMSTileSize, 0, stream>>>(
+          topk, col_blocks, b, sorted_index->dptr_, batch_start->dptr_, buffer->dptr_,
+          areas->dptr_, width_elem, coord_start, id_index, threshold, in_format, mask->dptr_);
     }
+    nms_reduce_mask_kernel<<<batches, kNMSReduceThreads, shared, stream>>>(
+        topk, col_blocks, b, sorted_index->dptr_, batch_start->dptr_, mask->dptr_);
   }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(nms_reduce_mask_kernel);
 }
 
 __launch_bounds__(512)
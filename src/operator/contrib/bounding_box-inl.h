@@ -258,6 +258,48 @@ struct compute_area {
   }
 };
 
+/*!
+ * \brief Greedy NMS of boxes sorted by descending score, in corner coordinates.
+ *  The overlaps of a kept box with all later boxes are one branch free loop.
+ * \param id class ids, boxes of different classes do not suppress each other
+ * \param removed set to 1 for the suppressed boxes, has to be zero initialized
+ */
+template <typename DType>
+inline void GreedyNMS(int size,
+                      const DType* x1,
+                      const DType* y1,
+                      const DType* x2,
+                      const DType* y2,
+                      const DType* area,
+                      const int* id,
+                      float threshold,
+                      uint8_t* removed) {
+  for (int ref = 0; ref < size - 1; ++ref) {
+    if (removed[ref])
+      continue;
+    const DType rx1 = x1[ref], ry1 = y1[ref], rx2 = x2[ref], ry2 = y2[ref];
+    const DType rarea = area[ref];
+    const int rid     = id[ref];
+#pragma omp simd
+    for (int i = ref + 1; i < size; ++i) {
+      const DType left      = rx1 > x1[i] ? rx1 : x1[i];
+      const DType right     = rx2 < x2[i] ? rx2 : x2[i];
+      const DType top       = ry1 > y1[i] ? ry1 : y1[i];
+      const DType bottom    = ry2 < y2[i] ? ry2 : y2[i];
+      const DType w         = right - left;
+      const DType h         = bottom - top;
+      const DType intersect = (w > DType(0) ? w : DType(0)) * (h > DType(0) ? h : DType(0));
+      const DType iou       = intersect / (rarea + area[i] - intersect);
+      removed[i] |= static_cast<uint8_t>(iou > threshold && id[i] == rid);
+    }
+  }
+}
+
+/*! \brief the CPU NMSApply needs no workspace */
+inline index_t NMSMaskSize(mshadow::Stream<cpu>* s, int num_batch, int topk) {
+  return 0;
+}
+
 template <typename DType>
 void NMSApply(mshadow::Stream<cpu>* s,
               int num_batch,
@@ -266,6 +308,7 @@ void NMSApply(mshadow::Stream<cpu>* s,
               mshadow::Tensor<cpu, 1, int32_t>* batch_start,
               mshadow::Tensor<cpu, 3, DType>* buffer,
               mshadow::Tensor<cpu, 1, DType>* areas,
+              mshadow::Tensor<cpu, 1, uint64_t>* mask,
               int num_elem,
               int width_elem,
               int coord_start,
@@ -273,28 +316,57 @@ void NMSApply(mshadow::Stream<cpu>* s,
               float threshold,
               bool force_suppress,
               int in_format) {
-  using namespace mxnet_op;
   // go through each box as reference, suppress if overlap > threshold
   // sorted_index with -1 is marked as suppressed
-  for (int ref = 0; ref < topk; ++ref) {
-    int num_worker = topk - ref - 1;
-    if (num_worker < 1)
+  // The batches are independent, their boxes are gathered into corner coordinates.
+  const bool check_class = !force_suppress && id_index >= 0;
+  const int32_t* starts  = batch_start->dptr_;
+  const DType* input     = buffer->dptr_;
+  const DType* area      = areas->dptr_;
+  int32_t* index         = sorted_index->dptr_;
+  const int num_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (int b = 0; b < num_batch; ++b) {
+    const int start = static_cast<int>(starts[b]);
+    const int size  = std::min(static_cast<int>(starts[b + 1]) - start, topk);
+    if (size < 2)
       continue;
-    Kernel<nms_impl, cpu>::Launch(s,
-                                  num_batch * num_worker,
-                                  sorted_index->dptr_,
-                                  batch_start->dptr_,
-                                  buffer->dptr_,
-                                  areas->dptr_,
-                                  num_worker,
-                                  ref,
-                                  num_elem,
-                                  width_elem,
-                                  coord_start,
-                                  id_index,
-                                  threshold,
-                                  force_suppress,
-                                  in_format);
+    std::vector<DType> x1(size), y1(size), x2(size), y2(size), box_area(size);
+    std::vector<int> id(size, 0);
+    std::vector<uint8_t> removed(size, 0);
+    for (int i = 0; i < size; ++i) {
+      const int pos    = static_cast<int>(index[start + i]);
+      const DType* box = input + pos * width_elem + coord_start;
+      if (box_common_enum::kCorner == in_format) {
+        x1[i] = box[0];
+        y1[i] = box[1];
+        x2[i] = box[2];
+        y2[i] = box[3];
+      } else {
+        const DType w = box[2] / 2;
+        const DType h = box[3] / 2;
+        x1[i]         = box[0] - w;
+        y1[i]         = box[1] - h;
+        x2[i]         = box[0] + w;
+        y2[i]         = box[1] + h;
+      }
+      box_area[i] = area[pos];
+      if (check_class)
+        id[i] = static_cast<int>(input[pos * width_elem + id_index]);
+    }
+    GreedyNMS(size,
+              x1.data(),
+              y1.data(),
+              x2.data(),
+              y2.data(),
+              box_area.data(),
+              id.data(),
+              threshold,
+              removed.data());
+    for (int i = 1; i < size; ++i) {
+      if (removed[i])
+        index[start + i] = -1;
+    }
   }
 }
 
@@ -406,7 +478,11 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
     Shape<3> buffer_shape      = Shape3(num_batch, num_elem, width_elem);
     Shape<1> batch_start_shape = Shape1(num_batch + 1);
 
-    // index
+    // sort topk
+    int topk = param.topk < 0 ? num_elem : std::min(num_elem, param.topk);
+
+    // the suppression mask leads the workspace, which keeps it 8-byte aligned
+    index_t mask_size  = topk < 1 ? 0 : mxnet::op::NMSMaskSize(s, num_batch, topk);
     index_t int32_size = sort_index_shape.Size() * 3 + batch_start_shape.Size();
     index_t dtype_size = sort_index_shape.Size() * 3;
     if (req[0] == kWriteInplace) {
@@ -414,18 +490,22 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
     }
     // ceil up when sizeof(DType) is larger than sizeof(DType)
     index_t int32_offset   = (int32_size * sizeof(int32_t) - 1) / sizeof(DType) + 1;
-    index_t workspace_size = int32_offset + dtype_size;
+    index_t mask_offset    = mask_size * sizeof(uint64_t) / sizeof(DType);
+    index_t workspace_size = mask_offset + int32_offset + dtype_size;
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[box_nms_enum::kTempSpace].get_space_typed<xpu, 1, DType>(
             Shape1(workspace_size), s);
+    Tensor<xpu, 1, uint64_t> mask(
+        reinterpret_cast<uint64_t*>(workspace.dptr_), Shape1(mask_size), s);
     Tensor<xpu, 1, int32_t> sorted_index(
-        reinterpret_cast<int32_t*>(workspace.dptr_), sort_index_shape, s);
+        reinterpret_cast<int32_t*>(workspace.dptr_ + mask_offset), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> all_sorted_index(
         sorted_index.dptr_ + sorted_index.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> batch_id(
         all_sorted_index.dptr_ + all_sorted_index.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, int32_t> batch_start(batch_id.dptr_ + batch_id.MSize(), batch_start_shape, s);
-    Tensor<xpu, 1, DType> scores(workspace.dptr_ + int32_offset, sort_index_shape, s);
+    Tensor<xpu, 1, DType> scores(
+        workspace.dptr_ + mask_offset + int32_offset, sort_index_shape, s);
     Tensor<xpu, 1, DType> areas(scores.dptr_ + scores.MSize(), sort_index_shape, s);
     Tensor<xpu, 1, DType> classes(areas.dptr_ + areas.MSize(), sort_index_shape, s);
     Tensor<xpu, 3, DType> buffer = data;
@@ -440,8 +520,6 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
     int coord_start = param.coord_start;
     int id_index    = param.id_index;
 
-    // sort topk
-    int topk = param.topk < 0 ? num_elem : std::min(num_elem, param.topk);
     if (topk < 1) {
       out    = F<mshadow_op::identity>(buffer);
       record = reshape(range<DType>(0, num_batch * num_elem), record.shape_);
@@ -519,6 +597,7 @@ void BoxNMSForward(const nnvm::NodeAttrs& attrs,
                         &batch_start,
                         &buffer,
                         &areas,
+                        &mask,
                         num_elem,
                         width_elem,
                         coord_start,
@@ -1179,6 +1258,249 @@ void BoxDecodeForward(const nnvm::NodeAttrs& attrs,
   });
 }
 
+namespace box_detection_enum {
+enum BoxDetectionOpInputs { kClsProb, kLocPred, kAnchor };
+enum BoxDetectionOpOutputs { kOut };
+}  // namespace box_detection_enum
+
+struct BoxDetectionParam : public dmlc::Parameter<BoxDetectionParam> {
+  float threshold;
+  int background_id;
+  float nms_threshold;
+  bool force_suppress;
+  int nms_topk;
+  int keep_topk;
+  bool clip;
+  mxnet::Tuple<float> variances;
+  DMLC_DECLARE_PARAMETER(BoxDetectionParam) {
+    DMLC_DECLARE_FIELD(threshold).set_default(0.01f).describe(
+        "Only the scores larger than threshold are candidate detections.");
+    DMLC_DECLARE_FIELD(background_id)
+        .set_default(0)
+        .describe("Class of the background, which is ignored, -1 for none.");
+    DMLC_DECLARE_FIELD(nms_threshold)
+        .set_default(0.5f)
+        .describe("Overlapping(IoU) threshold to suppress a detection with a smaller score.");
+    DMLC_DECLARE_FIELD(force_suppress)
+        .set_default(false)
+        .describe("Suppress the detections regardless of their class.");
+    DMLC_DECLARE_FIELD(nms_topk).set_default(400).describe(
+        "Number of candidates with the largest scores kept per class before nms, "
+        "-1 for no limit.");
+    DMLC_DECLARE_FIELD(keep_topk)
+        .set_default(100)
+        .describe("Number of detections with the largest scores kept per batch after nms.");
+    DMLC_DECLARE_FIELD(clip).set_default(true).describe("Clip the boxes to [0, 1].");
+    DMLC_DECLARE_FIELD(variances)
+        .set_default({0.1f, 0.1f, 0.2f, 0.2f})
+        .describe("Variances to be decoded from box regression output.");
+  }
+};  // BoxDetectionParam
+
+inline bool BoxDetectionShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  const BoxDetectionParam& param = nnvm::get<BoxDetectionParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 3U) << "Inputs: [cls_prob, loc_pred, anchor]";
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& cshape = in_attrs->at(box_detection_enum::kClsProb);
+  const mxnet::TShape& lshape = in_attrs->at(box_detection_enum::kLocPred);
+  const mxnet::TShape& ashape = in_attrs->at(box_detection_enum::kAnchor);
+  if (!shape_is_known(cshape) || !shape_is_known(lshape) || !shape_is_known(ashape))
+    return false;
+  CHECK_EQ(cshape.ndim(), 3U) << "cls_prob must be (B, C, N), provided: " << cshape;
+  CHECK_EQ(lshape.ndim(), 2U) << "loc_pred must be (B, N * 4), provided: " << lshape;
+  CHECK_EQ(ashape.ndim(), 3U) << "anchor must be (1, N, 4), provided: " << ashape;
+  CHECK_EQ(cshape[2], ashape[1]) << "Number of anchors mismatch";
+  CHECK_EQ(cshape[2] * 4, lshape[1]) << "# anchors mismatch with # loc";
+  CHECK_EQ(cshape[0], lshape[0]) << "Batch size mismatch";
+  CHECK_EQ(ashape[2], 4U);
+  CHECK_GT(param.keep_topk, 0) << "keep_topk must be positive";
+  CHECK_EQ(param.variances.ndim(), 4) << "Variance size must be 4";
+  // [id, score, xmin, ymin, xmax, ymax]
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, mxnet::TShape({cshape[0], param.keep_topk, 6}));
+  return true;
+}
+
+/*! \brief index of the class of foreground class c */
+MSHADOW_XINLINE int DetectionClass(int c, int background_id) {
+  return background_id >= 0 && c >= background_id ? c + 1 : c;
+}
+
+/*! \brief decode the regression of an anchor into a box, both in corner format */
+template <typename DType>
+MSHADOW_XINLINE void DetectionDecode(DType* out,
+                                     const DType* anchor,
+                                     const DType* loc_pred,
+                                     const bool clip,
+                                     const float vx,
+                                     const float vy,
+                                     const float vw,
+                                     const float vh) {
+  const DType aw = anchor[2] - anchor[0];
+  const DType ah = anchor[3] - anchor[1];
+  const DType ax = (anchor[0] + anchor[2]) / 2;
+  const DType ay = (anchor[1] + anchor[3]) / 2;
+  const DType ox = loc_pred[0] * vx * aw + ax;
+  const DType oy = loc_pred[1] * vy * ah + ay;
+  const DType ow = exp(loc_pred[2] * vw) * aw / 2;
+  const DType oh = exp(loc_pred[3] * vh) * ah / 2;
+  out[0]         = ox - ow;
+  out[1]         = oy - oh;
+  out[2]         = ox + ow;
+  out[3]         = oy + oh;
+  if (clip) {
+    for (int i = 0; i < 4; ++i) {
+      out[i] = out[i] < DType(0) ? DType(0) : (out[i] > DType(1) ? DType(1) : out[i]);
+    }
+  }
+}
+
+/*!
+ * \brief Fused detection output of multibox predictions.
+ *  Only the nms_topk anchors with the largest scores above threshold are decoded per class.
+ *  NMS runs per class, or over all classes with force_suppress, and the keep_topk
+ *  detections with the largest scores are written per batch, padded with -1.
+ *  The batches run in parallel with GreedyNMS.
+ */
+inline void BoxDetectionForward(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_NE(req[box_detection_enum::kOut], kAddTo) << "BoxDetection does not support kAddTo";
+  if (req[box_detection_enum::kOut] == kNullOp)
+    return;
+  const BoxDetectionParam& param = nnvm::get<BoxDetectionParam>(attrs.parsed);
+  const mxnet::TShape& cshape    = inputs[box_detection_enum::kClsProb].shape_;
+  const int num_batch            = cshape[0];
+  const int num_classes          = cshape[1];
+  const int num_anchors          = cshape[2];
+  const int background_id        = param.background_id < num_classes ? param.background_id : -1;
+  const int num_fg               = background_id >= 0 ? num_classes - 1 : num_classes;
+  const int nms_topk  = param.nms_topk < 0 ? num_anchors : std::min(param.nms_topk, num_anchors);
+  const int keep_topk = param.keep_topk;
+  const mxnet::Tuple<float>& v = param.variances;
+  const int num_threads        = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_REAL_TYPE_SWITCH(outputs[box_detection_enum::kOut].type_flag_, DType, {
+    const DType* cls_prob = inputs[box_detection_enum::kClsProb].dptr<DType>();
+    const DType* loc_pred = inputs[box_detection_enum::kLocPred].dptr<DType>();
+    const DType* anchors  = inputs[box_detection_enum::kAnchor].dptr<DType>();
+    DType* out            = outputs[box_detection_enum::kOut].dptr<DType>();
+    const DType threshold = static_cast<DType>(param.threshold);
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (int b = 0; b < num_batch; ++b) {
+      // by descending score, then ascending anchor or candidate
+      auto descend = [](const std::pair<DType, int>& l, const std::pair<DType, int>& r) {
+        return l.first > r.first || (l.first == r.first && l.second < r.second);
+      };
+      // the candidates of all classes in corner coordinates, sorted by score per class
+      std::vector<std::pair<DType, int>> scored;
+      std::vector<DType> x1, y1, x2, y2, area, score;
+      std::vector<int> id, class_start(1, 0);
+      for (int c = 0; c < num_fg; ++c) {
+        const DType* prob = cls_prob + (b * num_classes + DetectionClass(c, background_id)) *
+                                           num_anchors;
+        scored.clear();
+        for (int n = 0; n < num_anchors; ++n) {
+          if (prob[n] > threshold)
+            scored.emplace_back(prob[n], n);
+        }
+        const int k = std::min(nms_topk, static_cast<int>(scored.size()));
+        std::partial_sort(scored.begin(), scored.begin() + k, scored.end(), descend);
+        for (int i = 0; i < k; ++i) {
+          const int n = scored[i].second;
+          DType box[4];
+          DetectionDecode(box,
+                          anchors + n * 4,
+                          loc_pred + (b * num_anchors + n) * 4,
+                          param.clip,
+                          v[0],
+                          v[1],
+                          v[2],
+                          v[3]);
+          x1.push_back(box[0]);
+          y1.push_back(box[1]);
+          x2.push_back(box[2]);
+          y2.push_back(box[3]);
+          area.push_back(BoxArea(box, box_common_enum::kCorner));
+          score.push_back(scored[i].first);
+          id.push_back(c);
+        }
+        class_start.push_back(static_cast<int>(score.size()));
+      }
+      const int num_cand = static_cast<int>(score.size());
+      std::vector<uint8_t> removed(num_cand, 0);
+      if (param.force_suppress) {
+        // one nms over the candidates of all classes, by descending score
+        std::vector<std::pair<DType, int>> order(num_cand);
+        for (int i = 0; i < num_cand; ++i)
+          order[i] = std::make_pair(score[i], i);
+        std::sort(order.begin(), order.end(), descend);
+        std::vector<DType> sx1(num_cand), sy1(num_cand), sx2(num_cand), sy2(num_cand);
+        std::vector<DType> sarea(num_cand);
+        std::vector<int> sid(num_cand, 0);
+        std::vector<uint8_t> sremoved(num_cand, 0);
+        for (int i = 0; i < num_cand; ++i) {
+          const int j = order[i].second;
+          sx1[i]      = x1[j];
+          sy1[i]      = y1[j];
+          sx2[i]      = x2[j];
+          sy2[i]      = y2[j];
+          sarea[i]    = area[j];
+        }
+        GreedyNMS(num_cand,
+                  sx1.data(),
+                  sy1.data(),
+                  sx2.data(),
+                  sy2.data(),
+                  sarea.data(),
+                  sid.data(),
+                  param.nms_threshold,
+                  sremoved.data());
+        for (int i = 0; i < num_cand; ++i)
+          removed[order[i].second] = sremoved[i];
+      } else {
+        for (int c = 0; c < num_fg; ++c) {
+          const int start = class_start[c];
+          GreedyNMS(class_start[c + 1] - start,
+                    x1.data() + start,
+                    y1.data() + start,
+                    x2.data() + start,
+                    y2.data() + start,
+                    area.data() + start,
+                    id.data() + start,
+                    param.nms_threshold,
+                    removed.data() + start);
+        }
+      }
+      std::vector<std::pair<DType, int>> kept;
+      for (int i = 0; i < num_cand; ++i) {
+        if (!removed[i])
+          kept.emplace_back(score[i], i);
+      }
+      const int num_out = std::min(keep_topk, static_cast<int>(kept.size()));
+      std::partial_sort(kept.begin(), kept.begin() + num_out, kept.end(), descend);
+      DType* batch_out = out + b * keep_topk * 6;
+      for (int i = 0; i < keep_topk * 6; ++i)
+        batch_out[i] = DType(-1);
+      for (int i = 0; i < num_out; ++i) {
+        const int j = kept[i].second;
+        DType* row  = batch_out + i * 6;
+        row[0]      = static_cast<DType>(id[j]);
+        row[1]      = score[j];
+        row[2]      = x1[j];
+        row[3]      = y1[j];
+        row[4]      = x2[j];
+        row[5]      = y2[j];
+      }
+    }
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -31,6 +31,7 @@ DMLC_REGISTER_PARAMETER(BoxNMSParam);
 DMLC_REGISTER_PARAMETER(BoxOverlapParam);
 DMLC_REGISTER_PARAMETER(BipartiteMatchingParam);
 DMLC_REGISTER_PARAMETER(BoxDecodeParam);
+DMLC_REGISTER_PARAMETER(BoxDetectionParam);
 
 NNVM_REGISTER_OP(_contrib_box_nms)
     .add_alias("_contrib_box_non_maximum_suppression")
@@ -254,5 +255,49 @@ NNVM_REGISTER_OP(_contrib_box_decode)
     .add_argument("anchors", "NDArray-or-Symbol", "(1, N, 4) encoded in corner or center")
     .add_arguments(BoxDecodeParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_box_detection)
+    .add_alias("_npx_box_detection")
+    .describe(R"doc(Fused detection output of multibox predictions.
+
+Replaces ``MultiBoxDetection`` or ``box_decode`` followed by ``box_nms`` with one operator
+that keeps the per-class candidates:
+
+- the ``nms_topk`` anchors with the largest scores above ``threshold`` are selected for each
+  class except ``background_id``, and only these are decoded,
+- non-maximum suppression runs per class, or over all classes with ``force_suppress``,
+- the ``keep_topk`` detections with the largest scores are returned for each batch.
+
+The output has shape (B, keep_topk, 6). Each detection is
+``[class_id, score, xmin, ymin, xmax, ymax]``, with the class ids counted without the
+background, sorted by descending score and padded with -1.
+
+Example::
+
+  cls_prob: (B, num_classes, N), loc_pred: (B, N * 4), anchor: (1, N, 4)
+  dets = box_detection(cls_prob, loc_pred, anchor, threshold=0.01, nms_threshold=0.45,
+                       nms_topk=400, keep_topk=200)
+
+)doc" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<BoxDetectionParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "cls_prob", "loc_pred", "anchor"};
+                                     })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<mxnet::FInferShape>("FInferShape", BoxDetectionShape)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<3, 1>)
+    .set_attr<FCompute>("FCompute<cpu>", BoxDetectionForward)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("cls_prob", "NDArray-or-Symbol", "(B, C, N) class probabilities")
+    .add_argument("loc_pred", "NDArray-or-Symbol", "(B, N * 4) location regression predictions")
+    .add_argument("anchor", "NDArray-or-Symbol", "(1, N, 4) anchors encoded in corner")
+    .add_arguments(BoxDetectionParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
@@ -23,6 +23,9 @@
  * \author Joshua Zhang
  */
 #include <cub/cub.cuh>
+#include <thrust/count.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <limits>
 
 #include "./bounding_box-inl.cuh"
 #include "./bounding_box-inl.h"
@@ -45,7 +48,7 @@ struct TempWorkspace {
   size_t buffer_space;
   DType* buffer;
   size_t nms_scratch_space;
-  uint32_t* nms_scratch;
+  uint64_t* nms_scratch;
   size_t indices_temp_spaces;
   index_t* indices;
 };
@@ -195,369 +198,77 @@ void WorkspaceForSort(const index_t num_elem,
       align(std::max(sort_scores_temp_space, sort_topk_scores_temp_space), alignment);
 }
 
-template <int encode, typename DType>
-__global__ void CalculateGreedyNMSResultsKernel(const DType* data,
-                                                uint32_t* result,
-                                                const index_t current_start,
-                                                const index_t num_elems,
-                                                const index_t num_batches,
-                                                const index_t num_blocks_per_row_batch,
-                                                const index_t num_blocks_per_row,
-                                                const index_t topk,
-                                                const index_t element_width,
-                                                const index_t num_elements_per_batch,
-                                                const int coord_index,
-                                                const int class_index,
-                                                const int score_index,
-                                                const float threshold);
-
-template <typename DType>
-__global__ void ReduceNMSResultTriangleKernel(uint32_t* nms_results,
-                                              DType* data,
-                                              const index_t score_index,
-                                              const index_t element_width,
-                                              const index_t num_batches,
-                                              const index_t num_elems,
-                                              const index_t start_index,
-                                              const index_t topk);
-
 template <typename DType>
-__global__ void ReduceNMSResultRestKernel(DType* data,
-                                          const uint32_t* nms_results,
-                                          const index_t score_index,
-                                          const index_t element_width,
-                                          const index_t num_batches,
-                                          const index_t num_elements_per_batch,
-                                          const index_t start_index,
-                                          const index_t topk,
-                                          const index_t num_blocks_per_batch);
-
-template <typename DType>
-struct NMS {
-  static constexpr int THRESHOLD = 512;
-
-  void operator()(Tensor<gpu, 3, DType>* data,
-                  Tensor<gpu, 2, uint32_t>* scratch,
-                  const index_t topk,
-                  const BoxNMSParam& param,
-                  Stream<gpu>* s) {
-    const int n_threads                  = 512;
-    const index_t num_batches            = data->shape_[0];
-    const index_t num_elements_per_batch = data->shape_[1];
-    const index_t element_width          = data->shape_[2];
-    for (index_t current_start = 0; current_start < topk; current_start += THRESHOLD) {
-      const index_t n_elems                  = topk - current_start;
-      const index_t num_blocks_per_row_batch = ceil_div(n_elems, n_threads);
-      const index_t num_blocks_per_row       = num_blocks_per_row_batch * num_batches;
-      const index_t n_blocks = THRESHOLD / (sizeof(uint32_t) * 8) * num_blocks_per_row;
-      if (param.in_format == box_common_enum::kCorner) {
-        CalculateGreedyNMSResultsKernel<box_common_enum::kCorner>
-            <<<n_blocks, n_threads, 0, Stream<gpu>::GetStream(s)>>>(
-                data->dptr_,
-                scratch->dptr_,
-                current_start,
-                n_elems,
-                num_batches,
-                num_blocks_per_row_batch,
-                num_blocks_per_row,
-                topk,
-                element_width,
-                num_elements_per_batch,
-                param.coord_start,
-                param.force_suppress ? -1 : param.id_index,
-                param.score_index,
-                param.overlap_thresh);
-      } else {
-        CalculateGreedyNMSResultsKernel<box_common_enum::kCenter>
-            <<<n_blocks, n_threads, 0, Stream<gpu>::GetStream(s)>>>(
-                data->dptr_,
-                scratch->dptr_,
-                current_start,
-                n_elems,
-                num_batches,
-                num_blocks_per_row_batch,
-                num_blocks_per_row,
-                topk,
-                element_width,
-                num_elements_per_batch,
-                param.coord_start,
-                param.force_suppress ? -1 : param.id_index,
-                param.score_index,
-                param.overlap_thresh);
-      }
-      ReduceNMSResultTriangleKernel<<<num_batches, THRESHOLD, 0, Stream<gpu>::GetStream(s)>>>(
-          scratch->dptr_,
-          data->dptr_,
-          param.score_index,
-          element_width,
-          num_batches,
-          num_elements_per_batch,
-          current_start,
-          topk);
-      const index_t n_rest_elems              = n_elems - THRESHOLD;
-      const index_t num_rest_blocks_per_batch = ceil_div(n_rest_elems, n_threads);
-      const index_t num_rest_blocks           = num_rest_blocks_per_batch * num_batches;
-      if (n_rest_elems > 0) {
-        ReduceNMSResultRestKernel<<<num_rest_blocks, n_threads, 0, Stream<gpu>::GetStream(s)>>>(
-            data->dptr_,
-            scratch->dptr_,
-            param.score_index,
-            element_width,
-            num_batches,
-            num_elements_per_batch,
-            current_start,
-            topk,
-            num_rest_blocks_per_batch);
-      }
-    }
-  }
-};
-
-template <int encode, typename DType>
-__device__ __forceinline__ DType
-calculate_area(const DType b0, const DType b1, const DType b2, const DType b3) {
-  DType width  = b2;
-  DType height = b3;
-  if (encode == box_common_enum::kCorner) {
-    width -= b0;
-    height -= b1;
-  }
-  if (width < 0 || height < 0)
-    return 0;
-  return width * height;
-}
-
-template <int encode, typename DType>
-__device__ __forceinline__ DType calculate_intersection(const DType a0,
-                                                        const DType a1,
-                                                        const DType a2,
-                                                        const DType a3,
-                                                        const DType b0,
-                                                        const DType b1,
-                                                        const DType b2,
-                                                        const DType b3) {
-  DType wx, wy;
-  if (encode == box_common_enum::kCorner) {
-    const DType left   = a0 > b0 ? a0 : b0;
-    const DType bottom = a1 > b1 ? a1 : b1;
-    const DType right  = a2 < b2 ? a2 : b2;
-    const DType top    = a3 < b3 ? a3 : b3;
-    wx                 = right - left;
-    wy                 = top - bottom;
-  } else {
-    const DType al     = 2 * a0 - a2;
-    const DType ar     = 2 * a0 + a2;
-    const DType bl     = 2 * b0 - b2;
-    const DType br     = 2 * b0 + b2;
-    const DType left   = bl > al ? bl : al;
-    const DType right  = br < ar ? br : ar;
-    wx                 = right - left;
-    const DType ab     = 2 * a1 - a3;
-    const DType at     = 2 * a1 + a3;
-    const DType bb     = 2 * b1 - b3;
-    const DType bt     = 2 * b1 + b3;
-    const DType bottom = bb > ab ? bb : ab;
-    const DType top    = bt < at ? bt : at;
-    wy                 = top - bottom;
-    wy                 = wy / 4;  // To compensate for both wx and wy being 2x too large
-  }
-  if (wx <= 0 || wy <= 0) {
-    return 0;
-  } else {
-    return (wx * wy);
-  }
-}
-
-template <int encode, typename DType>
-__launch_bounds__(512) __global__
-    void CalculateGreedyNMSResultsKernel(const DType* data,
-                                         uint32_t* result,
-                                         const index_t current_start,
-                                         const index_t num_elems,
-                                         const index_t num_batches,
-                                         const index_t num_blocks_per_row_batch,
-                                         const index_t num_blocks_per_row,
-                                         const index_t topk,
-                                         const index_t element_width,
-                                         const index_t num_elements_per_batch,
-                                         const int coord_index,
-                                         const int class_index,
-                                         const int score_index,
-                                         const float threshold) {
-  constexpr int max_elem_width  = 20;
-  constexpr int num_other_boxes = sizeof(uint32_t) * 8;
-  __shared__ DType other_boxes[max_elem_width * num_other_boxes];
-  __shared__ DType other_boxes_areas[num_other_boxes];
-  const index_t my_row                   = blockIdx.x / num_blocks_per_row;
-  const index_t my_block_offset_in_row   = blockIdx.x % num_blocks_per_row;
-  const index_t my_block_offset_in_batch = my_block_offset_in_row % num_blocks_per_row_batch;
-  const index_t my_batch                 = (my_block_offset_in_row) / num_blocks_per_row_batch;
-  const index_t my_element_in_batch =
-      my_block_offset_in_batch * blockDim.x + current_start + threadIdx.x;
-
-  // Load other boxes
-  const index_t offset =
-      (my_batch * num_elements_per_batch + current_start + my_row * num_other_boxes) *
-      element_width;
-  for (int i = threadIdx.x; i < element_width * num_other_boxes; i += blockDim.x) {
-    other_boxes[i] = data[offset + i];
-  }
-  __syncthreads();
-
-  if (threadIdx.x < num_other_boxes) {
-    const int other_boxes_offset = element_width * threadIdx.x;
-    const DType their_area =
-        calculate_area<encode>(other_boxes[other_boxes_offset + coord_index + 0],
-                               other_boxes[other_boxes_offset + coord_index + 1],
-                               other_boxes[other_boxes_offset + coord_index + 2],
-                               other_boxes[other_boxes_offset + coord_index + 3]);
-    other_boxes_areas[threadIdx.x] = their_area;
-  }
-  __syncthreads();
-
-  if (my_element_in_batch >= topk)
-    return;
-
-  DType my_box[4];
-  DType my_class = -1;
-  DType my_score = -1;
-  const index_t my_offset =
-      (my_batch * num_elements_per_batch + my_element_in_batch) * element_width;
-  my_score = data[my_offset + score_index];
-#pragma unroll
-  for (int i = 0; i < 4; ++i) {
-    my_box[i] = data[my_offset + coord_index + i];
-  }
-  if (class_index != -1) {
-    my_class = data[my_offset + class_index];
-  }
-  DType my_area = calculate_area<encode>(my_box[0], my_box[1], my_box[2], my_box[3]);
-
-  uint32_t ret = 0;
-  if (my_score != -1) {
-#pragma unroll
-    for (int i = 0; i < num_other_boxes; ++i) {
-      const int other_boxes_offset = element_width * i;
-      if ((class_index == -1 || my_class == other_boxes[other_boxes_offset + class_index]) &&
-          other_boxes[other_boxes_offset + score_index] != -1) {
-        const DType their_area = other_boxes_areas[i];
-
-        const DType intersect =
-            calculate_intersection<encode>(my_box[0],
-                                           my_box[1],
-                                           my_box[2],
-                                           my_box[3],
-                                           other_boxes[other_boxes_offset + coord_index + 0],
-                                           other_boxes[other_boxes_offset + coord_index + 1],
-                                           other_boxes[other_boxes_offset + coord_index + 2],
-                                           other_boxes[other_boxes_offset + coord_index + 3]);
-        if (intersect > threshold * (my_area + their_area - intersect)) {
-          ret = ret | (1u << i);
-        }
-      }
-    }
-  }
-  result[(my_row * num_batches + my_batch) * topk + my_element_in_batch] = ~ret;
-}
-
-template <typename DType>
-__launch_bounds__(NMS<DType>::THRESHOLD) __global__
-    void ReduceNMSResultTriangleKernel(uint32_t* nms_results,
-                                       DType* data,
-                                       const index_t score_index,
-                                       const index_t element_width,
-                                       const index_t num_batches,
-                                       const index_t num_elements_per_batch,
-                                       const index_t start_index,
-                                       const index_t topk) {
-  constexpr int n_threads           = NMS<DType>::THRESHOLD;
-  constexpr int warp_size           = 32;
-  const index_t my_batch            = blockIdx.x;
-  const index_t my_element_in_batch = threadIdx.x + start_index;
-  const index_t my_element          = my_batch * topk + my_element_in_batch;
-  const int my_warp                 = threadIdx.x / warp_size;
-  const int my_lane                 = threadIdx.x % warp_size;
-
-  __shared__ uint32_t current_valid_boxes[n_threads / warp_size];
-  const uint32_t full_mask            = 0xFFFFFFFF;
-  const uint32_t my_lane_mask         = 1 << my_lane;
-  const uint32_t earlier_threads_mask = (1 << (my_lane + 1)) - 1;
-  uint32_t valid                      = my_lane_mask;
-  uint32_t valid_boxes                = full_mask;
-
-  uint32_t my_next_mask = my_element_in_batch < topk ? nms_results[my_element] : full_mask;
-#pragma unroll
-  for (int i = 0; i < n_threads / warp_size; ++i) {
-    uint32_t my_mask = my_next_mask;
-    my_next_mask     = (((i + 1) < n_threads / warp_size) && (my_element_in_batch < topk))
-                           ? nms_results[(i + 1) * topk * num_batches + my_element]
-                           : full_mask;
-    if (my_warp == i && !__all_sync(full_mask, my_mask == full_mask)) {
-      my_mask = my_mask | earlier_threads_mask;
-      // Loop over warp_size - 1 because the last
-      // thread does not contribute to the mask anyway
-#pragma unroll
-      for (int j = 0; j < warp_size - 1; ++j) {
-        const uint32_t mask = __shfl_sync(full_mask, valid ? my_mask : full_mask, j);
-        valid               = valid & mask;
-      }
-      valid_boxes = __ballot_sync(full_mask, valid);
-    }
-    if (my_lane == 0 && my_warp == i) {
-      current_valid_boxes[i] = valid_boxes;
-    }
-    __syncthreads();
-    if ((my_warp > i) && (((~my_mask) & current_valid_boxes[i]) != 0)) {
-      valid = 0;
+__global__ void SuppressScoresKernel(DType* data,
+                                     const int32_t* index,
+                                     const index_t topk,
+                                     const index_t num_elements_per_batch,
+                                     const int element_width,
+                                     const int score_index,
+                                     const index_t N) {
+  const index_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid < N) {
+    const index_t pos = (tid / topk) * num_elements_per_batch + tid % topk;
+    if (index[pos] < 0) {
+      data[pos * element_width + score_index] = -1;
     }
   }
-  if (my_lane == 0) {
-    nms_results[my_element] = valid_boxes;
-  }
-  if (valid == 0) {
-    data[(my_batch * num_elements_per_batch + my_element_in_batch) * element_width + score_index] =
-        -1;
-  }
 }
 
+/*!
+ * \brief Suppresses boxes among the first topk rows of each batch of the sorted data, by
+ *  setting their score to -1, with the bitmask NMSApply of bounding_box-inl.cuh.
+ *  The rows filtered out before are all -1, so they have no area and suppress nothing.
+ */
 template <typename DType>
-__launch_bounds__(512) __global__
-    void ReduceNMSResultRestKernel(DType* data,
-                                   const uint32_t* nms_results,
-                                   const index_t score_index,
-                                   const index_t element_width,
-                                   const index_t num_batches,
-                                   const index_t num_elements_per_batch,
-                                   const index_t start_index,
-                                   const index_t topk,
-                                   const index_t num_blocks_per_batch) {
-  constexpr int num_other_boxes          = sizeof(uint32_t) * 8;
-  constexpr int num_iterations           = NMS<DType>::THRESHOLD / num_other_boxes;
-  constexpr int warp_size                = 32;
-  const index_t my_block_offset_in_batch = blockIdx.x % num_blocks_per_batch;
-  const index_t my_batch                 = blockIdx.x / num_blocks_per_batch;
-  const index_t my_element_in_batch =
-      my_block_offset_in_batch * blockDim.x + start_index + NMS<DType>::THRESHOLD + threadIdx.x;
-  const index_t my_element = my_batch * topk + my_element_in_batch;
-
-  if (my_element_in_batch >= topk)
-    return;
-
-  bool valid = true;
-
-#pragma unroll
-  for (int i = 0; i < num_iterations; ++i) {
-    const uint32_t my_mask     = nms_results[i * topk * num_batches + my_element];
-    const uint32_t valid_boxes = nms_results[my_batch * topk + i * warp_size + start_index];
-
-    const bool no_hit = (valid_boxes & (~my_mask)) == 0;
-    valid             = valid && no_hit;
-  }
-
-  if (!valid) {
-    data[(my_batch * num_elements_per_batch + my_element_in_batch) * element_width + score_index] =
-        -1;
-  }
+void NMS(Tensor<gpu, 3, DType>* data,
+         const TempWorkspace<DType>& workspace,
+         const index_t topk,
+         const BoxNMSParam& param,
+         Stream<gpu>* s) {
+  using mshadow::Shape1;
+  using mshadow::expr::range;
+  using mshadow::expr::ScalarExp;
+  const int n_threads     = 512;
+  const index_t num_batch = data->shape_[0];
+  const index_t num_elem  = data->shape_[1];
+  const int width_elem    = data->shape_[2];
+  Tensor<gpu, 1, uint64_t> mask(workspace.nms_scratch, Shape1(NMSMaskSize(s, num_batch, topk)), s);
+  Tensor<gpu, 1, int32_t> index(
+      reinterpret_cast<int32_t*>(mask.dptr_ + mask.MSize()), Shape1(num_batch * num_elem), s);
+  Tensor<gpu, 1, int32_t> batch_start(index.dptr_ + index.MSize(), Shape1(num_batch + 1), s);
+  // the scores are only needed again to compact the results
+  Tensor<gpu, 1, DType> areas(workspace.scores, Shape1(num_batch * num_elem), s);
+  index       = range<int32_t>(0, num_batch * num_elem);
+  batch_start = range<int32_t>(0, num_batch + 1) * ScalarExp<int32_t>(num_elem);
+  mxnet_op::Kernel<compute_area, gpu>::Launch(s,
+                                              num_batch * topk,
+                                              areas.dptr_,
+                                              data->dptr_ + param.coord_start,
+                                              index.dptr_,
+                                              batch_start.dptr_,
+                                              topk,
+                                              num_elem,
+                                              width_elem,
+                                              param.in_format);
+  NMSApply(s,
+           num_batch,
+           topk,
+           &index,
+           &batch_start,
+           data,
+           &areas,
+           &mask,
+           num_elem,
+           width_elem,
+           param.coord_start,
+           param.id_index,
+           param.overlap_thresh,
+           param.force_suppress,
+           param.in_format);
+  const index_t N = num_batch * topk;
+  SuppressScoresKernel<<<ceil_div(N, n_threads), n_threads, 0, Stream<gpu>::GetStream(s)>>>(
+      data->dptr_, index.dptr_, topk, num_elem, width_elem, param.score_index, N);
 }
 
 template <typename DType>
@@ -576,8 +287,10 @@ TempWorkspace<DType> GetWorkspace(const index_t num_batch,
   WorkspaceForSort(num_elem, topk, alignment, &workspace);
   // Place for a buffer
   workspace.buffer_space = align(num_batch * num_elem * width_elem * sizeof(DType), alignment);
+  // the suppression mask, followed by the int32 sorted positions and batch starts of NMSApply
   workspace.nms_scratch_space =
-      align(NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8) * num_batch * topk * sizeof(uint32_t),
+      align(NMSMaskSize(s, num_batch, topk) * sizeof(uint64_t) +
+                (num_batch * num_elem + num_batch + 1) * sizeof(int32_t),
             alignment);
 
   const size_t workspace_size = workspace.scores_temp_space + workspace.scratch_space +
@@ -593,7 +306,7 @@ TempWorkspace<DType> GetWorkspace(const index_t num_batch,
   workspace.scores  = reinterpret_cast<DType*>(scratch_memory.dptr_);
   workspace.scratch = reinterpret_cast<uint8_t*>(workspace.scores) + workspace.scores_temp_space;
   workspace.buffer  = reinterpret_cast<DType*>(workspace.scratch + workspace.scratch_space);
-  workspace.nms_scratch = reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(workspace.buffer) +
+  workspace.nms_scratch = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(workspace.buffer) +
                                                       workspace.buffer_space);
   workspace.indices = reinterpret_cast<index_t*>(reinterpret_cast<uint8_t*>(workspace.nms_scratch) +
                                                  workspace.nms_scratch_space);
@@ -654,6 +367,137 @@ void CompactNMSResults(const Tensor<gpu, 3, DType>& data,
   CompactData<true>(*sorted_indices, data, out, topk, score_index, s);
 }
 
+/*! \brief offset in cls_prob of the flat (batch, foreground class, anchor) index i */
+__device__ __forceinline__ index_t DetectionScoreOffset(const index_t i,
+                                                        const int num_classes,
+                                                        const int num_fg,
+                                                        const int num_anchors,
+                                                        const int background_id) {
+  const index_t n = i % num_anchors;
+  const index_t c = (i / num_anchors) % num_fg;
+  const index_t b = i / (static_cast<index_t>(num_fg) * num_anchors);
+  return (b * num_classes + DetectionClass(c, background_id)) * num_anchors + n;
+}
+
+template <typename DType>
+struct DetectionAboveThreshold {
+  const DType* cls_prob;
+  float threshold;
+  int num_classes;
+  int num_fg;
+  int num_anchors;
+  int background_id;
+
+  __device__ bool operator()(const int32_t i) const {
+    const index_t offset =
+        DetectionScoreOffset(i, num_classes, num_fg, num_anchors, background_id);
+    return static_cast<float>(cls_prob[offset]) > threshold;
+  }
+};
+
+/*! \brief whether a position of the nms output is a kept candidate */
+template <typename DType>
+struct DetectionKept {
+  const DType* candidates;
+
+  __device__ bool operator()(const int32_t index) const {
+    return index >= 0 && static_cast<float>(candidates[index * 6]) >= 0;
+  }
+};
+
+template <typename DType>
+__global__ void DetectionScoresKernel(DType* scores,
+                                      const int32_t* index,
+                                      const DType* cls_prob,
+                                      const int num_classes,
+                                      const int num_fg,
+                                      const int num_anchors,
+                                      const int background_id,
+                                      const index_t N) {
+  const index_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid < N) {
+    scores[tid] = cls_prob[DetectionScoreOffset(
+        index[tid], num_classes, num_fg, num_anchors, background_id)];
+  }
+}
+
+/*!
+ * \brief Writes the nms_topk candidates of each (batch, class) segment, as
+ *  [class, score, xmin, ymin, xmax, ymax], and their areas. The missing candidates of a
+ *  segment are all -1, they have no area and suppress nothing.
+ */
+template <typename DType>
+__global__ void DetectionCandidatesKernel(DType* candidates,
+                                          DType* areas,
+                                          const int32_t* index,
+                                          const int32_t* segment_start,
+                                          const DType* cls_prob,
+                                          const DType* loc_pred,
+                                          const DType* anchors,
+                                          const int nms_topk,
+                                          const int num_classes,
+                                          const int num_fg,
+                                          const int num_anchors,
+                                          const int background_id,
+                                          const bool clip,
+                                          const float vx,
+                                          const float vy,
+                                          const float vw,
+                                          const float vh,
+                                          const index_t N) {
+  const index_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid >= N)
+    return;
+  const index_t segment = tid / nms_topk;
+  const index_t pos     = segment_start[segment] + tid % nms_topk;
+  DType* row            = candidates + tid * 6;
+  if (pos >= segment_start[segment + 1]) {
+    for (int i = 0; i < 6; ++i) {
+      row[i] = -1;
+    }
+    areas[tid] = 0;
+    return;
+  }
+  const index_t i = index[pos];
+  const index_t n = i % num_anchors;
+  const index_t b = i / (static_cast<index_t>(num_fg) * num_anchors);
+  row[0]          = static_cast<DType>((i / num_anchors) % num_fg);
+  row[1] = cls_prob[DetectionScoreOffset(i, num_classes, num_fg, num_anchors, background_id)];
+  DetectionDecode(
+      row + 2, anchors + n * 4, loc_pred + (b * num_anchors + n) * 4, clip, vx, vy, vw, vh);
+  areas[tid] = BoxArea(row + 2, box_common_enum::kCorner);
+}
+
+template <typename DType>
+__global__ void DetectionKeptScoresKernel(DType* scores,
+                                          const int32_t* index,
+                                          const DType* candidates,
+                                          const index_t N) {
+  const index_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid < N) {
+    scores[tid] = candidates[index[tid] * 6 + 1];
+  }
+}
+
+template <typename DType>
+__global__ void DetectionAssignKernel(DType* out,
+                                      const DType* candidates,
+                                      const int32_t* index,
+                                      const int32_t* batch_start,
+                                      const int keep_topk,
+                                      const index_t N) {
+  const index_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid >= N)
+    return;
+  const index_t b   = tid / keep_topk;
+  const index_t pos = batch_start[b] + tid % keep_topk;
+  if (pos < batch_start[b + 1]) {
+    for (int i = 0; i < 6; ++i) {
+      out[tid * 6 + i] = candidates[index[pos] * 6 + i];
+    }
+  }
+}
+
 }  // namespace
 
 void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
@@ -662,7 +506,6 @@ void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
                              const std::vector<OpReqType>& req,
                              const std::vector<TBlob>& outputs) {
   using mshadow::Shape1;
-  using mshadow::Shape2;
   using mshadow::Shape3;
   CHECK_NE(req[0], kAddTo) << "BoxNMS does not support kAddTo";
   CHECK_NE(req[0], kWriteInplace) << "BoxNMS does not support in place computation";
@@ -703,10 +546,6 @@ void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
     Tensor<gpu, 1, char> scratch(
         reinterpret_cast<char*>(workspace.scratch), Shape1(workspace.scratch_space), s);
     Tensor<gpu, 3, DType> buffer(workspace.buffer, Shape3(num_batch, num_elem, width_elem), s);
-    Tensor<gpu, 2, uint32_t> nms_scratch(
-        workspace.nms_scratch,
-        Shape2(NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8), topk * num_batch),
-        s);
     indices = mshadow::expr::range<index_t>(0, num_batch * num_elem);
     for (index_t i = 0; i < num_batch; ++i) {
       // Sort each batch separately
@@ -726,8 +565,7 @@ void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
                            &sorted_indices_batch);
     }
     CompactData<false>(sorted_indices, out, &buffer, topk, -1, s);
-    NMS<DType> nms;
-    nms(&buffer, &nms_scratch, topk, param, s);
+    NMS(&buffer, workspace, topk, param, s);
     CompactNMSResults(buffer,
                       &out,
                       &indices,
@@ -769,6 +607,169 @@ void BoxNMSForwardGPU(const nnvm::NodeAttrs& attrs,
   BoxNMSForward<gpu>(attrs, ctx, inputs, req, outputs);
 }
 
+/*!
+ * \brief GPU version of BoxDetectionForward. The candidates above the threshold are
+ *  compacted first and the workspace is sized by their count, so that neither the decoded
+ *  boxes nor the sort buffers span all anchors of all classes.
+ */
+void BoxDetectionForwardGPU(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using mshadow::Shape1;
+  using mshadow::Shape3;
+  using mshadow::expr::range;
+  using mshadow::expr::reshape;
+  using mshadow::expr::ScalarExp;
+  using mshadow::expr::slice;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_NE(req[box_detection_enum::kOut], kAddTo) << "BoxDetection does not support kAddTo";
+  if (req[box_detection_enum::kOut] == kNullOp)
+    return;
+  const BoxDetectionParam& param = nnvm::get<BoxDetectionParam>(attrs.parsed);
+  Stream<gpu>* s                 = ctx.get_stream<gpu>();
+  cudaStream_t stream            = Stream<gpu>::GetStream(s);
+  const mxnet::TShape& cshape    = inputs[box_detection_enum::kClsProb].shape_;
+  const int num_batch            = cshape[0];
+  const int num_classes          = cshape[1];
+  const int num_anchors          = cshape[2];
+  const int background_id        = param.background_id < num_classes ? param.background_id : -1;
+  const int num_fg               = background_id >= 0 ? num_classes - 1 : num_classes;
+  const int nms_topk  = param.nms_topk < 0 ? num_anchors : std::min(param.nms_topk, num_anchors);
+  const int keep_topk = param.keep_topk;
+  // the candidates of each batch and class are a segment
+  const int num_segments       = num_batch * num_fg;
+  const index_t num_scores     = static_cast<index_t>(num_segments) * num_anchors;
+  const index_t num_cand       = static_cast<index_t>(num_segments) * nms_topk;
+  const index_t batch_cand     = static_cast<index_t>(num_fg) * nms_topk;
+  const mxnet::Tuple<float>& v = param.variances;
+  const int n_threads          = 512;
+  CHECK_LE(num_scores, std::numeric_limits<int32_t>::max())
+      << "Too many scores for BoxDetection: " << num_scores;
+  auto policy = thrust::cuda::par.on(stream);
+
+  MSHADOW_REAL_TYPE_SWITCH(outputs[box_detection_enum::kOut].type_flag_, DType, {
+    const DType* cls_prob     = inputs[box_detection_enum::kClsProb].dptr<DType>();
+    Tensor<gpu, 3, DType> out = outputs[box_detection_enum::kOut].get<gpu, 3, DType>(s);
+    out                       = -1;
+    if (num_fg < 1 || nms_topk < 1)
+      return;
+
+    // select the candidates above the threshold
+    DetectionAboveThreshold<DType> above{
+        cls_prob, param.threshold, num_classes, num_fg, num_anchors, background_id};
+    thrust::counting_iterator<int32_t> first(0);
+    const index_t num_valid = thrust::count_if(policy, first, first + num_scores, above);
+    if (num_valid == 0)
+      return;
+
+    // workspace
+    const int alignment     = 128;
+    const index_t sort_size = std::max(num_valid, num_cand);
+    const index_t mask_size = param.force_suppress ? NMSMaskSize(s, num_batch, batch_cand) :
+                                                     NMSMaskSize(s, num_segments, nms_topk);
+    const size_t sort_space = std::max(
+        mxnet::op::SortByKeyWorkspaceSize<DType, int32_t, gpu>(sort_size),
+        mxnet::op::SortByKeyWorkspaceSize<int32_t, int32_t, gpu>(sort_size));
+    const size_t sizes[] = {
+        align(mask_size * sizeof(uint64_t), alignment),
+        align(num_valid * sizeof(int32_t), alignment),
+        align(sort_size * sizeof(int32_t), alignment),
+        align((num_segments + 1) * sizeof(int32_t), alignment),
+        align((num_segments + 1) * sizeof(int32_t), alignment),
+        align(num_cand * sizeof(int32_t), alignment),
+        align(num_cand * sizeof(int32_t), alignment),
+        align(sort_size * sizeof(DType), alignment),
+        align(num_cand * 6 * sizeof(DType), alignment),
+        align(num_cand * sizeof(DType), alignment),
+        align(sort_space, alignment)};
+    size_t workspace_size = 0;
+    for (size_t size : sizes)
+      workspace_size += size;
+    Tensor<gpu, 1, double> workspace = ctx.requested[0].get_space_typed<gpu, 1, double>(
+        Shape1(ceil_div(workspace_size, sizeof(double))), s);
+    char* ptrs[sizeof(sizes) / sizeof(sizes[0])];
+    ptrs[0] = reinterpret_cast<char*>(workspace.dptr_);
+    for (size_t i = 1; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+      ptrs[i] = ptrs[i - 1] + sizes[i - 1];
+    Tensor<gpu, 1, uint64_t> mask(reinterpret_cast<uint64_t*>(ptrs[0]), Shape1(mask_size), s);
+    Tensor<gpu, 1, int32_t> valid_index(
+        reinterpret_cast<int32_t*>(ptrs[1]), Shape1(num_valid), s);
+    Tensor<gpu, 1, int32_t> segment_id(reinterpret_cast<int32_t*>(ptrs[2]), Shape1(num_valid), s);
+    Tensor<gpu, 1, int32_t> segment_start(
+        reinterpret_cast<int32_t*>(ptrs[3]), Shape1(num_segments + 1), s);
+    Tensor<gpu, 1, int32_t> nms_start(
+        reinterpret_cast<int32_t*>(ptrs[4]), Shape1(num_segments + 1), s);
+    Tensor<gpu, 1, int32_t> nms_index(reinterpret_cast<int32_t*>(ptrs[5]), Shape1(num_cand), s);
+    Tensor<gpu, 1, int32_t> kept_index(reinterpret_cast<int32_t*>(ptrs[6]), Shape1(num_cand), s);
+    Tensor<gpu, 1, DType> scores(reinterpret_cast<DType*>(ptrs[7]), Shape1(num_valid), s);
+    Tensor<gpu, 3, DType> candidates(
+        reinterpret_cast<DType*>(ptrs[8]), Shape3(1, num_cand, 6), s);
+    Tensor<gpu, 1, DType> areas(reinterpret_cast<DType*>(ptrs[9]), Shape1(num_cand), s);
+    Tensor<gpu, 1, char> scratch(ptrs[10], Shape1(sizes[10]), s);
+
+    // sort the candidates by segment, then descending score
+    thrust::copy_if(policy, first, first + num_scores, valid_index.dptr_, above);
+    DetectionScoresKernel<<<ceil_div(num_valid, n_threads), n_threads, 0, stream>>>(
+        scores.dptr_, valid_index.dptr_, cls_prob, num_classes, num_fg, num_anchors,
+        background_id, num_valid);
+    mxnet::op::SortByKey(scores, valid_index, false, &scratch);
+    segment_id = valid_index / ScalarExp<int32_t>(num_anchors);
+    mxnet::op::SortByKey(segment_id, valid_index, true, &scratch);
+    NMSCalculateBatchStart(s, &segment_start, &segment_id, num_segments);
+
+    // decode the nms_topk candidates of each segment
+    DetectionCandidatesKernel<<<ceil_div(num_cand, n_threads), n_threads, 0, stream>>>(
+        candidates.dptr_, areas.dptr_, valid_index.dptr_, segment_start.dptr_, cls_prob,
+        inputs[box_detection_enum::kLocPred].dptr<DType>(),
+        inputs[box_detection_enum::kAnchor].dptr<DType>(), nms_topk, num_classes, num_fg,
+        num_anchors, background_id, param.clip, v[0], v[1], v[2], v[3], num_cand);
+
+    // nms per segment, or per batch over the candidates sorted by score
+    nms_index = range<int32_t>(0, num_cand);
+    if (param.force_suppress) {
+      Tensor<gpu, 1, DType> cand_scores(scores.dptr_, Shape1(num_cand), s);
+      Tensor<gpu, 1, int32_t> batch_id(segment_id.dptr_, Shape1(num_cand), s);
+      Tensor<gpu, 1, int32_t> batch_start(nms_start.dptr_, Shape1(num_batch + 1), s);
+      cand_scores = reshape(slice<2>(candidates, 1, 2), cand_scores.shape_);
+      mxnet::op::SortByKey(cand_scores, nms_index, false, &scratch);
+      batch_id = nms_index / ScalarExp<int32_t>(batch_cand);
+      mxnet::op::SortByKey(batch_id, nms_index, true, &scratch);
+      batch_start = range<int32_t>(0, num_batch + 1) * ScalarExp<int32_t>(batch_cand);
+      NMSApply(s, num_batch, batch_cand, &nms_index, &batch_start, &candidates, &areas, &mask,
+               num_cand, 6, 2, -1, param.nms_threshold, true, box_common_enum::kCorner);
+    } else {
+      nms_start = range<int32_t>(0, num_segments + 1) * ScalarExp<int32_t>(nms_topk);
+      NMSApply(s, num_segments, nms_topk, &nms_index, &nms_start, &candidates, &areas, &mask,
+               num_cand, 6, 2, -1, param.nms_threshold, true, box_common_enum::kCorner);
+    }
+
+    // sort the kept candidates by batch, then descending score, and keep the top ones
+    DetectionKept<DType> kept{candidates.dptr_};
+    const index_t num_kept =
+        thrust::copy_if(policy, nms_index.dptr_, nms_index.dptr_ + num_cand,
+                        kept_index.dptr_, kept) - kept_index.dptr_;
+    if (num_kept == 0)
+      return;
+    Tensor<gpu, 1, int32_t> kept_sorted(kept_index.dptr_, Shape1(num_kept), s);
+    Tensor<gpu, 1, DType> kept_scores(scores.dptr_, Shape1(num_kept), s);
+    Tensor<gpu, 1, int32_t> kept_batch(segment_id.dptr_, Shape1(num_kept), s);
+    Tensor<gpu, 1, int32_t> batch_start(segment_start.dptr_, Shape1(num_batch + 1), s);
+    DetectionKeptScoresKernel<<<ceil_div(num_kept, n_threads), n_threads, 0, stream>>>(
+        kept_scores.dptr_, kept_sorted.dptr_, candidates.dptr_, num_kept);
+    mxnet::op::SortByKey(kept_scores, kept_sorted, false, &scratch);
+    kept_batch = kept_sorted / ScalarExp<int32_t>(batch_cand);
+    mxnet::op::SortByKey(kept_batch, kept_sorted, true, &scratch);
+    NMSCalculateBatchStart(s, &batch_start, &kept_batch, num_batch);
+    const index_t num_out = static_cast<index_t>(num_batch) * keep_topk;
+    DetectionAssignKernel<<<ceil_div(num_out, n_threads), n_threads, 0, stream>>>(
+        out.dptr_, candidates.dptr_, kept_sorted.dptr_, batch_start.dptr_, keep_topk, num_out);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(DetectionAssignKernel);
+  });
+}
+
 NNVM_REGISTER_OP(_contrib_box_nms).set_attr<FCompute>("FCompute<gpu>", BoxNMSForwardGPU);
 
 NNVM_REGISTER_OP(_backward_contrib_box_nms)
@@ -789,5 +790,8 @@ NNVM_REGISTER_OP(_contrib_box_encode).set_attr<FCompute>("FCompute<gpu>", BoxEnc
 
 NNVM_REGISTER_OP(_contrib_box_decode).set_attr<FCompute>("FCompute<gpu>", BoxDecodeForward<gpu>);
 
+NNVM_REGISTER_OP(_contrib_box_detection)
+    .set_attr<FCompute>("FCompute<gpu>", BoxDetectionForwardGPU);
+
 }  // namespace op
 }  // namespace mxnet
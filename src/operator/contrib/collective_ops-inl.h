@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file collective_ops-inl.h
+ * \brief Collectives over the GPUs of all the processes in the graph, with the NCCL
+ *  communicators of mx.contrib.nccl
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_COLLECTIVE_OPS_INL_H_
+#define MXNET_OPERATOR_CONTRIB_COLLECTIVE_OPS_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../operator_common.h"
+#include "../tensor/elemwise_unary_op.h"
+
+namespace mxnet {
+namespace op {
+
+struct CollectiveParam : public dmlc::Parameter<CollectiveParam> {
+  int num_ranks;
+  DMLC_DECLARE_PARAMETER(CollectiveParam) {
+    DMLC_DECLARE_FIELD(num_ranks)
+        .set_lower_bound(1)
+        .describe(
+            "The number of the ranks of the NCCL communicators of mx.contrib.nccl.init, "
+            "i.e. the GPUs of all the processes.");
+  }
+};
+
+enum class CollectiveType { kAllReduce, kAllGather, kReduceScatter };
+
+/*!
+ * \brief the output of all reduce has the shape of the input, the output of all gather
+ *  concatenates the inputs of the ranks on the first axis, and the output of reduce scatter
+ *  is the part of the rank of the first axis.
+ */
+template <CollectiveType type>
+inline bool CollectiveShape(const nnvm::NodeAttrs& attrs,
+                            mxnet::ShapeVector* in_attrs,
+                            mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  if (type == CollectiveType::kAllReduce)
+    return ElemwiseShape<1, 1>(attrs, in_attrs, out_attrs);
+  const int num_ranks = nnvm::get<CollectiveParam>(attrs.parsed).num_ranks;
+  // the first axis of the larger shape, all gather's output or reduce scatter's input
+  const bool gather = type == CollectiveType::kAllGather;
+  mxnet::TShape& small = gather ? in_attrs->at(0) : out_attrs->at(0);
+  mxnet::TShape& large = gather ? out_attrs->at(0) : in_attrs->at(0);
+  if (ndim_is_known(small)) {
+    CHECK_GE(small.ndim(), 1) << "The collectives split the first axis";
+    mxnet::TShape shape = small;
+    if (dim_size_is_known(small, 0))
+      shape[0] = small[0] * num_ranks;
+    SHAPE_ASSIGN_CHECK(gather ? *out_attrs : *in_attrs, 0, shape);
+  }
+  if (ndim_is_known(large)) {
+    CHECK_GE(large.ndim(), 1) << "The collectives split the first axis";
+    mxnet::TShape shape = large;
+    if (dim_size_is_known(large, 0)) {
+      CHECK_EQ(large[0] % num_ranks, 0)
+          << "The first axis of " << large << " is not a multiple of num_ranks " << num_ranks;
+      shape[0] = large[0] / num_ranks;
+    }
+    SHAPE_ASSIGN_CHECK(gather ? *in_attrs : *out_attrs, 0, shape);
+  }
+  return shape_is_known(in_attrs->at(0)) && shape_is_known(out_attrs->at(0));
+}
+
+/*! \brief a single rank is the identity, the collectives of more run on gpu */
+template <CollectiveType type>
+void CollectiveComputeCPU(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  CHECK_EQ(nnvm::get<CollectiveParam>(attrs.parsed).num_ranks, 1)
+      << "The collectives of several ranks run on gpu, with the NCCL communicators";
+  UnaryOp::IdentityCompute<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
+#ifdef __CUDACC__
+template <CollectiveType type>
+void CollectiveComputeGPU(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+#if MXNET_USE_NCCL == 1
+  // every rank runs the collective, the ranks agree on the requests of a graph
+  if (req[0] == kNullOp)
+    return;
+  CHECK_NE(req[0], kAddTo) << "The collectives do not add to their output";
+  const int num_ranks  = nnvm::get<CollectiveParam>(attrs.parsed).num_ranks;
+  ncclComm_t nccl_comm = ctx.requested[0].get_nccl_comm();
+  int comm_ranks       = 0;
+  ncclCommCount(nccl_comm, &comm_ranks);
+  CHECK_EQ(comm_ranks, num_ranks) << "The NCCL communicators have " << comm_ranks << " ranks";
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(ctx.get_stream<gpu>());
+  ncclDataType_t nccl_type;
+  switch (inputs[0].type_flag_) {
+    case mshadow::kFloat32:
+      nccl_type = ncclFloat32;
+      break;
+    case mshadow::kFloat64:
+      nccl_type = ncclFloat64;
+      break;
+    case mshadow::kFloat16:
+      nccl_type = ncclFloat16;
+      break;
+    case mshadow::kUint8:
+      nccl_type = ncclUint8;
+      break;
+    case mshadow::kInt8:
+      nccl_type = ncclInt8;
+      break;
+    case mshadow::kInt32:
+      nccl_type = ncclInt32;
+      break;
+    case mshadow::kInt64:
+      nccl_type = ncclInt64;
+      break;
+    default:
+      LOG(FATAL) << "Unsupported type " << inputs[0].type_flag_ << " of the collectives";
+  }
+  const void* in = inputs[0].dptr_;
+  void* out      = outputs[0].dptr_;
+  ncclResult_t ret;
+  if (type == CollectiveType::kAllReduce) {
+    ret = ncclAllReduce(in, out, inputs[0].Size(), nccl_type, ncclSum, nccl_comm, stream);
+  } else if (type == CollectiveType::kAllGather) {
+    ret = ncclAllGather(in, out, inputs[0].Size(), nccl_type, nccl_comm, stream);
+  } else {
+    ret = ncclReduceScatter(in, out, outputs[0].Size(), nccl_type, ncclSum, nccl_comm, stream);
+  }
+  CHECK_EQ(ret, ncclSuccess) << "NCCL collective failed: " << ncclGetErrorString(ret);
+#else
+  LOG(FATAL) << "compile with USE_NCCL=1 to use the collectives";
+#endif  // MXNET_USE_NCCL == 1
+}
+#endif  // __CUDACC__
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_COLLECTIVE_OPS_INL_H_
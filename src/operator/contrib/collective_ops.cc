@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file collective_ops.cc
+ * \brief Collectives over the GPUs of all the processes in the graph
+ */
+#include "./collective_ops-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(CollectiveParam);
+
+#if MXNET_USE_NCCL == 1
+// the communicator of the GPU, its variable orders the collectives of all the ops
+#define MXNET_COLLECTIVE_RESOURCE ResourceRequest::kNCCLComm
+#else
+#define MXNET_COLLECTIVE_RESOURCE
+#endif  // MXNET_USE_NCCL == 1
+
+#define MXNET_OPERATOR_REGISTER_COLLECTIVE(name, type)                                    \
+  NNVM_REGISTER_OP(name)                                                                  \
+      .set_num_inputs(1)                                                                  \
+      .set_num_outputs(1)                                                                 \
+      .set_attr_parser(ParamParser<CollectiveParam>)                                      \
+      .set_attr<nnvm::FListInputNames>(                                                   \
+          "FListInputNames",                                                              \
+          [](const NodeAttrs& attrs) { return std::vector<std::string>{"data"}; })        \
+      .set_attr<mxnet::FInferShape>("FInferShape", CollectiveShape<type>)                 \
+      .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)                       \
+      .set_attr<FResourceRequest>(                                                        \
+          "FResourceRequest",                                                             \
+          [](const NodeAttrs& attrs) {                                                    \
+            return std::vector<ResourceRequest>{MXNET_COLLECTIVE_RESOURCE};               \
+          })                                                                              \
+      .set_attr<FCompute>("FCompute<cpu>", CollectiveComputeCPU<type>)                    \
+      .add_argument("data", "NDArray-or-Symbol", "The part of the rank")                  \
+      .add_arguments(CollectiveParam::__FIELDS__())
+
+MXNET_OPERATOR_REGISTER_COLLECTIVE(_contrib_allreduce, CollectiveType::kAllReduce)
+    .describe(R"code(Sums the inputs of all the ranks, the GPUs of all the processes of the
+NCCL communicators of ``mx.contrib.nccl.init``, into the output of every rank.
+
+The collectives are in the graph, so a hybridized block overlaps them with the compute, e.g.
+the tensor parallel layers of a transformer::
+
+  y = _contrib_allreduce(dot(x, w_rank), num_ranks=4)
+
+All the ranks run the same collectives in the same order, the ops of a GPU issue them in the
+order they are pushed. A single rank on cpu is the identity.
+)code" ADD_FILELINE)
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int>>{{0, 0}};
+                                    })
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_contrib_allreduce"});
+
+MXNET_OPERATOR_REGISTER_COLLECTIVE(_contrib_allgather, CollectiveType::kAllGather)
+    .describe(R"code(Concatenates the inputs of all the ranks on the first axis, in the order of
+the ranks, into the output of every rank. The first axis of the output is ``num_ranks``
+times the first axis of the input.
+
+See ``_contrib_allreduce`` for the ranks and the order of the collectives.
+)code" ADD_FILELINE)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_contrib_reduce_scatter"});
+
+MXNET_OPERATOR_REGISTER_COLLECTIVE(_contrib_reduce_scatter, CollectiveType::kReduceScatter)
+    .describe(R"code(Sums the inputs of all the ranks, and scatters the sum on the first axis:
+the output of the rank r is the r-th of the ``num_ranks`` parts of the first axis.
+
+See ``_contrib_allreduce`` for the ranks and the order of the collectives.
+)code" ADD_FILELINE)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_contrib_allgather"});
+
+}  // namespace op
+}  // namespace mxnet
@@ -37,6 +37,8 @@
 namespace mxnet {
 namespace op {
 
+typedef int64_t dgl_id_t;
+
 template <typename xpu>
 void DGLAdjacencyForwardEx(const nnvm::NodeAttrs& attrs,
                            const OpContext& ctx,
@@ -62,6 +64,112 @@ void DGLAdjacencyForwardEx(const nnvm::NodeAttrs& attrs,
   mxnet_op::copy(s, outputs[0].aux_data(csr::kIndPtr), in_indptr);
 }
 
+struct edge_id_csr_forward {
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  DType* out_data,
+                                  const DType* in_data,
+                                  const IType* in_indices,
+                                  const IType* in_indptr,
+                                  const CType* u,
+                                  const CType* v) {
+    const int64_t target_row_id = static_cast<int64_t>(u[i]);
+    const IType target_col_id   = static_cast<IType>(v[i]);
+    const IType* end            = in_indices + in_indptr[target_row_id + 1];
+    // the columns of a row are not sorted
+    const IType* ptr = in_indices + in_indptr[target_row_id];
+    while (ptr != end && *ptr != target_col_id)
+      ++ptr;
+    if (ptr == end) {
+      // does not exist in the range
+      out_data[i] = DType(-1);
+    } else {
+      out_data[i] = *(in_data + (ptr - in_indices));
+    }
+  }
+};
+
+template <typename xpu>
+void EdgeIDForwardCsrImpl(const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const OpReqType req,
+                          const NDArray& output) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace csr;
+  if (req == kNullOp)
+    return;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(req, kWriteTo) << "EdgeID with CSR only supports kWriteTo";
+  Stream<xpu>* s        = ctx.get_stream<xpu>();
+  const NDArray& u      = inputs[1];
+  const dim_t out_elems = u.shape().Size();
+  if (!inputs[0].storage_initialized()) {
+    MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
+      Kernel<mxnet_op::op_with_req<mshadow_op::identity, kWriteTo>, xpu>::Launch(
+          s, out_elems, output.data().dptr<DType>(), DType(-1));
+    });
+    return;
+  }
+  const NDArray& data     = inputs[0];
+  const TBlob& in_data    = data.data();
+  const TBlob& in_indices = data.aux_data(kIdx);
+  const TBlob& in_indptr  = data.aux_data(kIndPtr);
+  const NDArray& v        = inputs[2];
+
+  CHECK_EQ(data.aux_type(kIdx), data.aux_type(kIndPtr))
+      << "The dtypes of indices and indptr don't match";
+  MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
+    MSHADOW_IDX_TYPE_SWITCH(data.aux_type(kIdx), IType, {
+      MSHADOW_TYPE_SWITCH(u.dtype(), CType, {
+        Kernel<edge_id_csr_forward, xpu>::Launch(s,
+                                                 out_elems,
+                                                 output.data().dptr<DType>(),
+                                                 in_data.dptr<DType>(),
+                                                 in_indices.dptr<IType>(),
+                                                 in_indptr.dptr<IType>(),
+                                                 u.data().dptr<CType>(),
+                                                 v.data().dptr<CType>());
+      });
+    });
+  });
+}
+
+template <typename xpu>
+void EdgeIDForwardEx(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<NDArray>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<NDArray>& outputs) {
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req.size(), 1U);
+  const auto in_stype  = inputs[0].storage_type();
+  const auto out_stype = outputs[0].storage_type();
+  if (in_stype == kCSRStorage && out_stype == kDefaultStorage) {
+    EdgeIDForwardCsrImpl<xpu>(ctx, inputs, req[0], outputs[0]);
+  } else {
+    LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
+  }
+}
+
+struct SubgraphCompactParam : public dmlc::Parameter<SubgraphCompactParam> {
+  int num_args;
+  bool return_mapping;
+  mxnet::Tuple<dim_t> graph_sizes;
+  DMLC_DECLARE_PARAMETER(SubgraphCompactParam) {
+    DMLC_DECLARE_FIELD(num_args).set_lower_bound(2).describe("Number of input arguments.");
+    DMLC_DECLARE_FIELD(return_mapping)
+        .describe("Return mapping of vid and eid between the subgraph and the parent graph.");
+    DMLC_DECLARE_FIELD(graph_sizes).describe("the number of vertices in each graph.");
+  }
+};  // struct SubgraphCompactParam
+
+inline size_t get_num_graphs(const SubgraphCompactParam& params) {
+  // Each CSR needs a 1D array to store the original vertex Id for each row.
+  return params.num_args / 2;
+}
+
 }  // namespace op
 }  // namespace mxnet
 
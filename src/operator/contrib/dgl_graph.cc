@@ -25,10 +25,12 @@
 #include <dmlc/logging.h>
 #include <dmlc/optional.h>
 #include <algorithm>
+#include <cstdint>
 #include <random>
 #include <utility>
 
 #include "../elemwise_op_common.h"
+#include "../../engine/openmp.h"
 #include "../../imperative/imperative_utils.h"
 #include "../subgraph_op_common.h"
 #include "./dgl_graph-inl.h"
@@ -36,17 +38,45 @@
 namespace mxnet {
 namespace op {
 
-typedef int64_t dgl_id_t;
-
 ////////////////////////////// Graph Sampling ///////////////////////////////
 
+/*
+ * Random stream of the neighbors of a vertex in a sample, seeded by the seed of the sample and
+ * the vertex. The vertices of a hop are sampled in parallel, and a sample does not depend on
+ * the number of threads. A splitmix64 generator, seeding it is cheap unlike std::mt19937.
+ */
+class VertexRandom {
+ public:
+  typedef uint64_t result_type;
+
+  VertexRandom(unsigned int seed, dgl_id_t vertex)
+      : state_((static_cast<uint64_t>(seed) << 32) ^ static_cast<uint64_t>(vertex)) {}
+
+  static constexpr result_type min() {
+    return 0;
+  }
+  static constexpr result_type max() {
+    return UINT64_MAX;
+  }
+
+  result_type operator()() {
+    uint64_t x = (state_ += 0x9e3779b97f4a7c15ULL);
+    x          = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x          = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+ private:
+  uint64_t state_;
+};
+
 /*
  * ArrayHeap is used to sample elements from vector
  */
 class ArrayHeap {
  public:
-  explicit ArrayHeap(const std::vector<float>& prob, unsigned int seed) {
-    generator_    = std::mt19937(seed);
+  ArrayHeap(const std::vector<float>& prob, VertexRandom* generator) {
+    generator_    = generator;
     distribution_ = std::uniform_real_distribution<float>(0.0, 1.0);
     vec_size_     = prob.size();
     bit_len_      = ceil(log2(vec_size_));
@@ -93,7 +123,7 @@ class ArrayHeap {
    * Sample from arrayHeap
    */
   size_t Sample() {
-    float xi = heap_[1] * distribution_(generator_);
+    float xi = heap_[1] * distribution_(*generator_);
     int i    = 1;
     while (i < limit_) {
       i = i << 1;
@@ -121,7 +151,7 @@ class ArrayHeap {
   int bit_len_;   // bit size
   int limit_;
   std::vector<float> heap_;
-  std::mt19937 generator_;
+  VertexRandom* generator_;
   std::uniform_real_distribution<float> distribution_;
 };
 
@@ -391,12 +421,14 @@ static bool CSRNeighborNonUniformSampleType(const nnvm::NodeAttrs& attrs,
   return success;
 }
 
-static void RandomSample(size_t set_size, size_t num, std::vector<size_t>* out, unsigned int seed) {
-  std::mt19937 generator(seed);
+static void RandomSample(size_t set_size,
+                         size_t num,
+                         std::vector<size_t>* out,
+                         VertexRandom* generator) {
   std::unordered_set<size_t> sampled_idxs;
   std::uniform_int_distribution<size_t> distribution(0, set_size - 1);
   while (sampled_idxs.size() < num) {
-    sampled_idxs.insert(distribution(generator));
+    sampled_idxs.insert(distribution(*generator));
   }
   out->clear();
   for (size_t sampled_idx : sampled_idxs) {
@@ -430,7 +462,7 @@ static void GetUniformSample(const dgl_id_t* val_list,
                              const size_t max_num_neighbor,
                              std::vector<dgl_id_t>* out_ver,
                              std::vector<dgl_id_t>* out_edge,
-                             unsigned int seed) {
+                             VertexRandom* generator) {
   // Copy ver_list to output
   if (ver_len <= max_num_neighbor) {
     for (size_t i = 0; i < ver_len; ++i) {
@@ -443,12 +475,12 @@ static void GetUniformSample(const dgl_id_t* val_list,
   std::vector<size_t> sorted_idxs;
   if (ver_len > max_num_neighbor * 2) {
     sorted_idxs.reserve(max_num_neighbor);
-    RandomSample(ver_len, max_num_neighbor, &sorted_idxs, seed);
+    RandomSample(ver_len, max_num_neighbor, &sorted_idxs, generator);
     std::sort(sorted_idxs.begin(), sorted_idxs.end());
   } else {
     std::vector<size_t> negate;
     negate.reserve(ver_len - max_num_neighbor);
-    RandomSample(ver_len, ver_len - max_num_neighbor, &negate, seed);
+    RandomSample(ver_len, ver_len - max_num_neighbor, &negate, generator);
     std::sort(negate.begin(), negate.end());
     NegateSet(negate, ver_len, &sorted_idxs);
   }
@@ -473,7 +505,7 @@ static void GetNonUniformSample(const float* probability,
                                 const size_t max_num_neighbor,
                                 std::vector<dgl_id_t>* out_ver,
                                 std::vector<dgl_id_t>* out_edge,
-                                unsigned int seed) {
+                                VertexRandom* generator) {
   // Copy ver_list to output
   if (ver_len <= max_num_neighbor) {
     for (size_t i = 0; i < ver_len; ++i) {
@@ -488,7 +520,7 @@ static void GetNonUniformSample(const float* probability,
   for (size_t i = 0; i < ver_len; ++i) {
     sp_prob[i] = probability[col_list[i]];
   }
-  ArrayHeap arrayHeap(sp_prob, seed);
+  ArrayHeap arrayHeap(sp_prob, generator);
   arrayHeap.SampleWithoutReplacement(max_num_neighbor, &sp_index);
   out_ver->resize(max_num_neighbor);
   out_edge->resize(max_num_neighbor);
@@ -524,7 +556,8 @@ static void SampleSubgraph(const NDArray& csr,
                            int num_hops,
                            size_t num_neighbor,
                            size_t max_num_vertices,
-                           unsigned int random_seed) {
+                           unsigned int random_seed,
+                           int num_threads) {
   size_t num_seeds = seed_arr.shape().Size();
   CHECK_GE(max_num_vertices, num_seeds);
 
@@ -548,8 +581,8 @@ static void SampleSubgraph(const NDArray& csr,
       sub_vers.emplace_back(seed[i], 0);
     }
   }
-  std::vector<dgl_id_t> tmp_sampled_src_list;
-  std::vector<dgl_id_t> tmp_sampled_edge_list;
+  std::vector<std::vector<dgl_id_t> > sampled_src_lists;
+  std::vector<std::vector<dgl_id_t> > sampled_edge_lists;
   // ver_id, position
   std::vector<std::pair<dgl_id_t, size_t> > neigh_pos;
   neigh_pos.reserve(num_seeds);
@@ -562,60 +595,76 @@ static void SampleSubgraph(const NDArray& csr,
   // isn't in the last level, we will sample its neighbors. If not, the while loop terminates.
   size_t idx = 0;
   while (idx < sub_vers.size() && sub_ver_mp.size() < max_num_vertices) {
-    dgl_id_t dst_id    = sub_vers[idx].first;
-    int cur_node_level = sub_vers[idx].second;
-    idx++;
-    // If the node is in the last level, we don't need to sample neighbors
-    // from this node.
-    if (cur_node_level >= num_hops)
-      continue;
-
-    tmp_sampled_src_list.clear();
-    tmp_sampled_edge_list.clear();
-    dgl_id_t ver_len = *(indptr + dst_id + 1) - *(indptr + dst_id);
-    if (probability == nullptr) {  // uniform-sample
-      GetUniformSample(val_list + *(indptr + dst_id),
-                       col_list + *(indptr + dst_id),
-                       ver_len,
-                       num_neighbor,
-                       &tmp_sampled_src_list,
-                       &tmp_sampled_edge_list,
-                       random_seed);
-    } else {  // non-uniform-sample
-      GetNonUniformSample(probability,
-                          val_list + *(indptr + dst_id),
-                          col_list + *(indptr + dst_id),
-                          ver_len,
-                          num_neighbor,
-                          &tmp_sampled_src_list,
-                          &tmp_sampled_edge_list,
-                          random_seed);
-    }
-    CHECK_EQ(tmp_sampled_src_list.size(), tmp_sampled_edge_list.size());
-    size_t pos = neighbor_list.size();
-    neigh_pos.emplace_back(dst_id, pos);
-    // First we push the size of neighbor vector
-    neighbor_list.push_back(tmp_sampled_edge_list.size());
-    // Then push the vertices
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      neighbor_list.push_back(i);
-    }
-    // Finally we push the edge list
-    for (dgl_id_t& i : tmp_sampled_edge_list) {
-      neighbor_list.push_back(i);
+    // The neighbors of the vertices in the queue are sampled in parallel, each vertex with its
+    // own random stream. They are added in the order of the queue, as if the vertices were
+    // sampled one by one.
+    const size_t num_queued = sub_vers.size() - idx;
+    sampled_src_lists.resize(num_queued);
+    sampled_edge_lists.resize(num_queued);
+#pragma omp parallel for num_threads(num_threads) if (num_queued > 1)
+    for (int64_t j = 0; j < static_cast<int64_t>(num_queued); ++j) {
+      dgl_id_t dst_id = sub_vers[idx + j].first;
+      sampled_src_lists[j].clear();
+      sampled_edge_lists[j].clear();
+      // If the node is in the last level, we don't need to sample neighbors
+      // from this node.
+      if (sub_vers[idx + j].second >= num_hops)
+        continue;
+      VertexRandom generator(random_seed, dst_id);
+      dgl_id_t ver_len = *(indptr + dst_id + 1) - *(indptr + dst_id);
+      if (probability == nullptr) {  // uniform-sample
+        GetUniformSample(val_list + *(indptr + dst_id),
+                         col_list + *(indptr + dst_id),
+                         ver_len,
+                         num_neighbor,
+                         &sampled_src_lists[j],
+                         &sampled_edge_lists[j],
+                         &generator);
+      } else {  // non-uniform-sample
+        GetNonUniformSample(probability,
+                            val_list + *(indptr + dst_id),
+                            col_list + *(indptr + dst_id),
+                            ver_len,
+                            num_neighbor,
+                            &sampled_src_lists[j],
+                            &sampled_edge_lists[j],
+                            &generator);
+      }
     }
-    num_edges += tmp_sampled_src_list.size();
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      // If we have sampled the max number of vertices, we have to stop.
-      if (sub_ver_mp.size() >= max_num_vertices)
-        break;
-      // We need to add the neighbor in the hashtable here. This ensures that
-      // the vertex in the queue is unique. If we see a vertex before, we don't
-      // need to add it to the queue again.
-      auto ret = sub_ver_mp.insert(i);
-      // If the sampled neighbor is inserted to the map successfully.
-      if (ret.second)
-        sub_vers.emplace_back(i, cur_node_level + 1);
+    for (size_t j = 0; j < num_queued && sub_ver_mp.size() < max_num_vertices; ++j, ++idx) {
+      dgl_id_t dst_id    = sub_vers[idx].first;
+      int cur_node_level = sub_vers[idx].second;
+      if (cur_node_level >= num_hops)
+        continue;
+
+      const std::vector<dgl_id_t>& tmp_sampled_src_list  = sampled_src_lists[j];
+      const std::vector<dgl_id_t>& tmp_sampled_edge_list = sampled_edge_lists[j];
+      CHECK_EQ(tmp_sampled_src_list.size(), tmp_sampled_edge_list.size());
+      size_t pos = neighbor_list.size();
+      neigh_pos.emplace_back(dst_id, pos);
+      // First we push the size of neighbor vector
+      neighbor_list.push_back(tmp_sampled_edge_list.size());
+      // Then push the vertices
+      for (const dgl_id_t& i : tmp_sampled_src_list) {
+        neighbor_list.push_back(i);
+      }
+      // Finally we push the edge list
+      for (const dgl_id_t& i : tmp_sampled_edge_list) {
+        neighbor_list.push_back(i);
+      }
+      num_edges += tmp_sampled_src_list.size();
+      for (const dgl_id_t& i : tmp_sampled_src_list) {
+        // If we have sampled the max number of vertices, we have to stop.
+        if (sub_ver_mp.size() >= max_num_vertices)
+          break;
+        // We need to add the neighbor in the hashtable here. This ensures that
+        // the vertex in the queue is unique. If we see a vertex before, we don't
+        // need to add it to the queue again.
+        auto ret = sub_ver_mp.insert(i);
+        // If the sampled neighbor is inserted to the map successfully.
+        if (ret.second)
+          sub_vers.emplace_back(i, cur_node_level + 1);
+      }
     }
   }
   // Let's check if there is a vertex that we haven't sampled its neighbors.
@@ -713,8 +762,12 @@ static void CSRNeighborUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs,
   mshadow::Stream<cpu>* s                  = ctx.get_stream<cpu>();
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
+  // The subgraphs are sampled in parallel when there are enough of them, and the vertices of a
+  // subgraph otherwise. Each subgraph has its own seed, a sample does not depend on the threads.
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const bool by_subgraph = num_subgraphs >= omp_threads;
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(omp_threads) if (by_subgraph)
   for (int i = 0; i < num_subgraphs; i++) {
     SampleSubgraph(inputs[0],                       // graph_csr
                    inputs[i + 1],                   // seed vector
@@ -726,11 +779,8 @@ static void CSRNeighborUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs,
                    params.num_hops,
                    params.num_neighbor,
                    params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+                   seed + i,
+                   by_subgraph ? 1 : omp_threads);
   }
 }
 
@@ -816,8 +866,12 @@ static void CSRNeighborNonUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs
   mshadow::Stream<cpu>* s                  = ctx.get_stream<cpu>();
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
+  // The subgraphs are sampled in parallel when there are enough of them, and the vertices of a
+  // subgraph otherwise. Each subgraph has its own seed, a sample does not depend on the threads.
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const bool by_subgraph = num_subgraphs >= omp_threads;
 
-#pragma omp parallel for
+#pragma omp parallel for num_threads(omp_threads) if (by_subgraph)
   for (int i = 0; i < num_subgraphs; i++) {
     float* sub_prob = outputs[i + 2 * num_subgraphs].data().dptr<float>();
     SampleSubgraph(inputs[0],                       // graph_csr
@@ -830,11 +884,8 @@ static void CSRNeighborNonUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs
                    params.num_hops,
                    params.num_neighbor,
                    params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+                   seed + i,
+                   by_subgraph ? 1 : omp_threads);
   }
 }
 
@@ -1236,93 +1287,6 @@ inline bool EdgeIDStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
-struct edge_id_csr_forward {
-  template <typename DType, typename IType, typename CType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  DType* out_data,
-                                  const DType* in_data,
-                                  const IType* in_indices,
-                                  const IType* in_indptr,
-                                  const CType* u,
-                                  const CType* v) {
-    const int64_t target_row_id = static_cast<int64_t>(u[i]);
-    const IType target_col_id   = static_cast<IType>(v[i]);
-    auto ptr                    = std::find(in_indices + in_indptr[target_row_id],
-                         in_indices + in_indptr[target_row_id + 1],
-                         target_col_id);
-    if (ptr == in_indices + in_indptr[target_row_id + 1]) {
-      // does not exist in the range
-      out_data[i] = DType(-1);
-    } else {
-      out_data[i] = *(in_data + (ptr - in_indices));
-    }
-  }
-};
-
-template <typename xpu>
-void EdgeIDForwardCsrImpl(const OpContext& ctx,
-                          const std::vector<NDArray>& inputs,
-                          const OpReqType req,
-                          const NDArray& output) {
-  using namespace mshadow;
-  using namespace mxnet_op;
-  using namespace csr;
-  if (req == kNullOp)
-    return;
-  CHECK_EQ(inputs.size(), 3U);
-  CHECK_EQ(req, kWriteTo) << "EdgeID with CSR only supports kWriteTo";
-  Stream<xpu>* s        = ctx.get_stream<xpu>();
-  const NDArray& u      = inputs[1];
-  const dim_t out_elems = u.shape().Size();
-  if (!inputs[0].storage_initialized()) {
-    MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
-      Kernel<mxnet_op::op_with_req<mshadow_op::identity, kWriteTo>, xpu>::Launch(
-          s, out_elems, output.data().dptr<DType>(), DType(-1));
-    });
-    return;
-  }
-  const NDArray& data     = inputs[0];
-  const TBlob& in_data    = data.data();
-  const TBlob& in_indices = data.aux_data(kIdx);
-  const TBlob& in_indptr  = data.aux_data(kIndPtr);
-  const NDArray& v        = inputs[2];
-
-  CHECK_EQ(data.aux_type(kIdx), data.aux_type(kIndPtr))
-      << "The dtypes of indices and indptr don't match";
-  MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
-    MSHADOW_IDX_TYPE_SWITCH(data.aux_type(kIdx), IType, {
-      MSHADOW_TYPE_SWITCH(u.dtype(), CType, {
-        Kernel<edge_id_csr_forward, xpu>::Launch(s,
-                                                 out_elems,
-                                                 output.data().dptr<DType>(),
-                                                 in_data.dptr<DType>(),
-                                                 in_indices.dptr<IType>(),
-                                                 in_indptr.dptr<IType>(),
-                                                 u.data().dptr<CType>(),
-                                                 v.data().dptr<CType>());
-      });
-    });
-  });
-}
-
-template <typename xpu>
-void EdgeIDForwardEx(const nnvm::NodeAttrs& attrs,
-                     const OpContext& ctx,
-                     const std::vector<NDArray>& inputs,
-                     const std::vector<OpReqType>& req,
-                     const std::vector<NDArray>& outputs) {
-  CHECK_EQ(inputs.size(), 3U);
-  CHECK_EQ(outputs.size(), 1U);
-  CHECK_EQ(req.size(), 1U);
-  const auto in_stype  = inputs[0].storage_type();
-  const auto out_stype = outputs[0].storage_type();
-  if (in_stype == kCSRStorage && out_stype == kDefaultStorage) {
-    EdgeIDForwardCsrImpl<xpu>(ctx, inputs, req[0], outputs[0]);
-  } else {
-    LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
-  }
-}
-
 NNVM_REGISTER_OP(_contrib_edge_id)
     .describe(R"code(This operator implements the edge_id function for a graph
 stored in a CSR matrix (the value of the CSR stores the edge Id of the graph).
@@ -1431,25 +1395,8 @@ Example:
 
 ///////////////////////// Compact subgraphs ///////////////////////////
 
-struct SubgraphCompactParam : public dmlc::Parameter<SubgraphCompactParam> {
-  int num_args;
-  bool return_mapping;
-  mxnet::Tuple<dim_t> graph_sizes;
-  DMLC_DECLARE_PARAMETER(SubgraphCompactParam) {
-    DMLC_DECLARE_FIELD(num_args).set_lower_bound(2).describe("Number of input arguments.");
-    DMLC_DECLARE_FIELD(return_mapping)
-        .describe("Return mapping of vid and eid between the subgraph and the parent graph.");
-    DMLC_DECLARE_FIELD(graph_sizes).describe("the number of vertices in each graph.");
-  }
-};  // struct SubgraphCompactParam
-
 DMLC_REGISTER_PARAMETER(SubgraphCompactParam);
 
-static inline size_t get_num_graphs(const SubgraphCompactParam& params) {
-  // Each CSR needs a 1D array to store the original vertex Id for each row.
-  return params.num_args / 2;
-}
-
 static void CompactSubgraph(const NDArray& csr,
                             const NDArray& vids,
                             const NDArray& out_csr,
@@ -25,5 +25,79 @@ namespace op {
 NNVM_REGISTER_OP(_contrib_dgl_adjacency)
     .set_attr<FComputeEx>("FComputeEx<gpu>", DGLAdjacencyForwardEx<gpu>);
 
+NNVM_REGISTER_OP(_contrib_edge_id).set_attr<FComputeEx>("FComputeEx<gpu>", EdgeIDForwardEx<gpu>);
+
+/*
+ * The new column ids of a compacted subgraph are the positions of the old ones in the vertex
+ * ids of the rows, which the samplers write sorted.
+ */
+struct dgl_graph_compact_csr {
+  MSHADOW_XINLINE static void Map(int i,
+                                  dgl_id_t* indices_out,
+                                  dgl_id_t* eids_out,
+                                  const dgl_id_t* indices_in,
+                                  const dgl_id_t* row_ids,
+                                  const dgl_id_t graph_size) {
+    dgl_id_t lo = 0;
+    dgl_id_t hi = graph_size;
+    while (lo < hi) {
+      const dgl_id_t mid = lo + (hi - lo) / 2;
+      if (row_ids[mid] < indices_in[i]) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    indices_out[i] = lo < graph_size && row_ids[lo] == indices_in[i] ? lo : -1;
+    eids_out[i]    = i;
+  }
+};
+
+static void SubgraphCompactComputeExGPU(const nnvm::NodeAttrs& attrs,
+                                        const OpContext& ctx,
+                                        const std::vector<NDArray>& inputs,
+                                        const std::vector<OpReqType>& req,
+                                        const std::vector<NDArray>& outputs) {
+  const SubgraphCompactParam& params = nnvm::get<SubgraphCompactParam>(attrs.parsed);
+  const int num_g                    = get_num_graphs(params);
+  mshadow::Stream<gpu>* s            = ctx.get_stream<gpu>();
+  for (int i = 0; i < num_g; i++) {
+    const NDArray& csr_arr = inputs[i];
+    const NDArray& vids    = inputs[i + num_g];
+    const NDArray& out_csr = outputs[i];
+    const dim_t graph_size = params.graph_sizes[i];
+    const TBlob in_indices = csr_arr.aux_data(csr::kIdx);
+    const TBlob in_indptr  = csr_arr.aux_data(csr::kIndPtr);
+    // the number of vertices stored after the vertex ids is on the device, it is not checked
+    CHECK_EQ(vids.shape()[0], in_indptr.shape_[0]);
+    CHECK_EQ(out_csr.shape()[0], graph_size);
+    CHECK_GE(in_indptr.shape_[0], graph_size + 1);
+
+    const mxnet::TShape nz_shape(1, in_indices.shape_.Size());
+    const mxnet::TShape indptr_shape(1, graph_size + 1);
+    out_csr.CheckAndAllocData(nz_shape);
+    out_csr.CheckAndAllocAuxData(csr::kIdx, nz_shape);
+    out_csr.CheckAndAllocAuxData(csr::kIndPtr, indptr_shape);
+    // the rows after graph_size are empty
+    const TBlob indptr_in(
+        in_indptr.dptr<dgl_id_t>(), indptr_shape, gpu::kDevMask, in_indptr.dev_id());
+    mxnet_op::copy(s, out_csr.aux_data(csr::kIndPtr), indptr_in);
+    if (nz_shape[0] == 0)
+      continue;
+    dgl_id_t* indices_out = out_csr.aux_data(csr::kIdx).dptr<dgl_id_t>();
+    dgl_id_t* sub_eids    = out_csr.data().dptr<dgl_id_t>();
+    mxnet_op::Kernel<dgl_graph_compact_csr, gpu>::Launch(s,
+                                                         nz_shape[0],
+                                                         indices_out,
+                                                         sub_eids,
+                                                         in_indices.dptr<dgl_id_t>(),
+                                                         vids.data().dptr<dgl_id_t>(),
+                                                         graph_size);
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_dgl_graph_compact)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", SubgraphCompactComputeExGPU);
+
 }  // namespace op
 }  // namespace mxnet
@@ -0,0 +1,428 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_fully_connected-inl.h
+ * \brief Fully connected layer multiplying the data and the weight rounded to FP8, with per
+ *  tensor scales from a history of their absolute maxima
+ */
+
+#ifndef MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
+#define MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
+
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <vector>
+
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../nn/fully_connected-inl.h"
+#include "../tensor/broadcast_reduce_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace fp8fc {
+enum FP8FCOutputs { kOut, kScale };
+enum FP8FCInputsBwd { kBwdOutGrad, kBwdData, kBwdWeight, kBwdScale };
+// the rows of the amax history and of the scales
+enum FP8FCTensors { kDataAmax, kWeightAmax };
+}  // namespace fp8fc
+
+struct FP8FullyConnectedParam : public dmlc::Parameter<FP8FullyConnectedParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  int amax_history_len;
+  int margin;
+
+  DMLC_DECLARE_PARAMETER(FP8FullyConnectedParam) {
+    DMLC_DECLARE_FIELD(num_hidden)
+        .set_lower_bound(1)
+        .describe("Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+    DMLC_DECLARE_FIELD(amax_history_len)
+        .set_default(16)
+        .set_lower_bound(1)
+        .describe("Number of steps of the history of the absolute maxima the scales come from.");
+    DMLC_DECLARE_FIELD(margin).set_default(0).set_lower_bound(0).describe(
+        "The scales map the maxima of the history to the largest FP8 value divided by "
+        "2^margin.");
+  }
+
+  FullyConnectedParam fc_param() const {
+    FullyConnectedParam param;
+    param.num_hidden = num_hidden;
+    param.no_bias    = no_bias;
+    param.flatten    = flatten;
+    return param;
+  }
+
+  /*! \brief index of the amax history in the inputs */
+  int amax_history_index() const {
+    return no_bias ? 2 : 3;
+  }
+};
+
+/*! \brief FP8 with 4 exponent bits and 3 mantissa bits, without infinities, for the forward pass */
+struct FP8E4M3 {
+  static constexpr int kMantissaBits = 3;
+  // exponent of the smallest normal value, 1 - bias
+  static constexpr int kMinExponent = -6;
+  MSHADOW_XINLINE static float Max() {
+    return 448.0f;
+  }
+};
+
+/*! \brief FP8 with 5 exponent bits and 2 mantissa bits, of wider range, for the gradients */
+struct FP8E5M2 {
+  static constexpr int kMantissaBits = 2;
+  static constexpr int kMinExponent  = -14;
+  MSHADOW_XINLINE static float Max() {
+    return 57344.0f;
+  }
+};
+
+/*! \brief x rounded to the nearest value of Format, ties to even, saturating at its largest */
+template <typename Format>
+MSHADOW_XINLINE float FP8Round(const float x) {
+  const float largest = Format::Max();
+  const float ax      = fabsf(x);
+  if (x != x)
+    return x;
+  if (ax >= largest)
+    return copysignf(largest, x);
+  // ax = f * 2^exponent with f in [0.5, 1), and the values of the binade of ax are 2^(exponent-1)
+  // apart by steps of 2^(exponent - 1 - kMantissaBits), those of the subnormals as the smallest
+  int exponent;
+  frexpf(ax, &exponent);
+  const int e      = exponent - 1 > Format::kMinExponent ? exponent - 1 : Format::kMinExponent;
+  const float step = ldexpf(1.0f, e - Format::kMantissaBits);
+  return copysignf(fminf(rintf(ax / step) * step, largest), x);
+}
+
+/*! \brief the FP8 bits of Format of x, rounded as FP8Round */
+template <typename Format>
+MSHADOW_XINLINE uint8_t FP8Encode(const float x) {
+  const float r        = FP8Round<Format>(x);
+  const uint8_t sign   = copysignf(1.0f, r) < 0.0f ? 0x80 : 0;
+  const float ar       = fabsf(r);
+  constexpr int kShift = Format::kMantissaBits - Format::kMinExponent;
+  if (r != r)
+    return 0x7F;
+  int exponent;
+  const float f = frexpf(ar, &exponent);
+  if (ar == 0.0f || exponent - 1 < Format::kMinExponent)
+    return sign | static_cast<uint8_t>(ldexpf(ar, kShift));
+  const int biased   = exponent - Format::kMinExponent;
+  const int mantissa = static_cast<int>(ldexpf(2.0f * f - 1.0f, Format::kMantissaBits));
+  return sign | static_cast<uint8_t>((biased << Format::kMantissaBits) | mantissa);
+}
+
+/*!
+ * \brief the scale of row i of the amax history, then the history shifted by one step with the
+ *  current maximum first when update is set. The scale maps the maximum of the history, or the
+ *  current maximum before there is a history, to the largest value of Format. inv_scale may be
+ *  null.
+ */
+template <typename Format>
+struct FP8DelayedScaleKernel {
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  float* history,
+                                  const float* amax,
+                                  float* scale,
+                                  float* inv_scale,
+                                  const index_t len,
+                                  const int margin,
+                                  const bool update) {
+    float* row = history + i * len;
+    float m    = 0.0f;
+    for (index_t j = 0; j < len; ++j)
+      m = fmaxf(m, row[j]);
+    if (!(m > 0.0f))
+      m = amax[i];
+    const float s = m > 0.0f && m < INFINITY ? ldexpf(Format::Max() / m, -margin) : 1.0f;
+    scale[i]      = s;
+    if (inv_scale != nullptr)
+      inv_scale[i] = 1.0f / s;
+    if (update) {
+      for (index_t j = len - 1; j > 0; --j)
+        row[j] = row[j - 1];
+      row[0] = amax[i];
+    }
+  }
+};
+
+/*! \brief the scale of the current maximum of a tensor, for the gradients */
+template <typename Format>
+struct FP8CurrentScaleKernel {
+  MSHADOW_XINLINE static void Map(index_t i, float* scale, const float* amax, const int margin) {
+    const float m = amax[i];
+    scale[i]      = m > 0.0f && m < INFINITY ? ldexpf(Format::Max() / m, -margin) : 1.0f;
+  }
+};
+
+/*! \brief out = in, scaled, rounded to FP8 and scaled back */
+template <typename Format>
+struct FP8QuantizeKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const DType* in, const float* scale) {
+    const float s = *scale;
+    out[i]        = DType(FP8Round<Format>(static_cast<float>(in[i]) * s) / s);
+  }
+};
+
+/*! \brief out = the FP8 bits of in, scaled */
+template <typename Format>
+struct FP8EncodeKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, uint8_t* out, const DType* in, const float* scale) {
+    out[i] = FP8Encode<Format>(static_cast<float>(in[i]) * *scale);
+  }
+};
+
+/*! \brief bytes of workspace of FP8AbsMax for in */
+template <typename xpu>
+size_t FP8AbsMaxWorkspaceSize(mshadow::Stream<xpu>* s, const TBlob& in) {
+  return broadcast::ReduceWorkspaceSize(
+      s, mxnet::TShape(1, 1), kWriteTo, mxnet::TShape(1, in.Size()));
+}
+
+/*! \brief *amax = max(abs(in)), in float, on the device of in */
+template <typename xpu>
+void FP8AbsMax(const OpContext& ctx,
+               const TBlob& in,
+               float* amax,
+               const mshadow::Tensor<xpu, 1, char>& workspace) {
+  const TBlob flat = in.reshape(mxnet::TShape(1, in.Size()));
+  const TBlob out(amax, mxnet::TShape(1, 1), xpu::kDevMask, mshadow::kFloat32);
+#if !defined(__CUDACC__)
+  ReduceAxesComputeImpl<xpu, mshadow::red::maximum, true, false, mshadow_op::abs>(
+      ctx, {flat}, {kWriteTo}, {out}, out.shape_, &workspace);
+#else
+  ReduceAxesRTCComputeImpl(
+      ctx, {flat}, {kWriteTo}, {out}, out.shape_, "red::maximum{}", &workspace, false, "abs");
+#endif
+}
+
+/*! \brief carves aligned buffers out of the temporary space */
+class FP8Workspace {
+ public:
+  static constexpr size_t kAlign = 256;
+
+  explicit FP8Workspace(char* base) : base_(base) {}
+
+  /*! \brief bytes taken by a buffer of bytes */
+  static size_t Size(size_t bytes) {
+    return (bytes + kAlign - 1) / kAlign * kAlign;
+  }
+
+  template <typename T>
+  T* Take(size_t count) {
+    T* ptr = reinterpret_cast<T*>(base_ + offset_);
+    offset_ += Size(count * sizeof(T));
+    return ptr;
+  }
+
+ private:
+  char* base_;
+  size_t offset_ = 0;
+};
+
+/*! \brief the data and the weight of the layer rounded to FP8, for the emulated GEMMs */
+template <typename xpu, typename DType>
+void FP8QuantizeInputs(mshadow::Stream<xpu>* s,
+                       const TBlob& data,
+                       const TBlob& weight,
+                       const float* scale,
+                       TBlob* data_q,
+                       TBlob* weight_q,
+                       FP8Workspace* space) {
+  using namespace mxnet_op;
+  *data_q   = TBlob(space->Take<DType>(data.Size()), data.shape_, xpu::kDevMask, data.type_flag_);
+  *weight_q = TBlob(
+      space->Take<DType>(weight.Size()), weight.shape_, xpu::kDevMask, weight.type_flag_);
+  Kernel<FP8QuantizeKernel<FP8E4M3>, xpu>::Launch(
+      s, data.Size(), data_q->dptr<DType>(), data.dptr<DType>(), scale + fp8fc::kDataAmax);
+  Kernel<FP8QuantizeKernel<FP8E4M3>, xpu>::Launch(
+      s, weight.Size(), weight_q->dptr<DType>(), weight.dptr<DType>(), scale + fp8fc::kWeightAmax);
+}
+
+/*!
+ * \brief the maxima of the data and the weight, their scales from the amax history, updated in
+ *  training, to outputs[kScale], and the inverses of the scales to inv_scale when it is set
+ */
+template <typename xpu>
+void FP8UpdateScales(const OpContext& ctx,
+                     const FP8FullyConnectedParam& param,
+                     const std::vector<TBlob>& inputs,
+                     const std::vector<TBlob>& outputs,
+                     float* inv_scale,
+                     FP8Workspace* space) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& data       = inputs[fullc::kData];
+  const TBlob& weight     = inputs[fullc::kWeight];
+  const TBlob& history    = inputs[param.amax_history_index()];
+  CHECK_EQ(history.type_flag_, mshadow::kFloat32) << "amax_history must be float32";
+  CHECK_EQ(outputs[fp8fc::kScale].type_flag_, mshadow::kFloat32);
+  float* amax          = space->Take<float>(2);
+  const size_t ws_size =
+      std::max(FP8AbsMaxWorkspaceSize(s, data), FP8AbsMaxWorkspaceSize(s, weight));
+  const mshadow::Tensor<xpu, 1, char> workspace(
+      space->Take<char>(ws_size), mshadow::Shape1(ws_size), s);
+  FP8AbsMax(ctx, data, amax + fp8fc::kDataAmax, workspace);
+  FP8AbsMax(ctx, weight, amax + fp8fc::kWeightAmax, workspace);
+  Kernel<FP8DelayedScaleKernel<FP8E4M3>, xpu>::Launch(s,
+                                                      2,
+                                                      history.dptr<float>(),
+                                                      amax,
+                                                      outputs[fp8fc::kScale].dptr<float>(),
+                                                      inv_scale,
+                                                      param.amax_history_len,
+                                                      param.margin,
+                                                      ctx.is_train);
+}
+
+/*!
+ * \brief bytes of temporary space of FP8UpdateScales, with the inverses of the scales, and of the
+ *  data and the weight rounded to elements of element_size bytes
+ */
+template <typename xpu>
+size_t FP8ForwardWorkspaceSize(mshadow::Stream<xpu>* s,
+                               const TBlob& data,
+                               const TBlob& weight,
+                               size_t element_size) {
+  const size_t reduce_size =
+      std::max(FP8AbsMaxWorkspaceSize(s, data), FP8AbsMaxWorkspaceSize(s, weight));
+  return 2 * FP8Workspace::Size(2 * sizeof(float)) + FP8Workspace::Size(reduce_size) +
+         FP8Workspace::Size(data.Size() * element_size) +
+         FP8Workspace::Size(weight.Size() * element_size);
+}
+
+/*! \brief the forward pass with the GEMM of DType of the data and the weight rounded to FP8 */
+template <typename xpu, typename DType>
+void FP8FullyConnectedForwardEmulated(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  const auto& param       = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (req[fp8fc::kOut] == kNullOp)
+    return;
+  const size_t bytes =
+      FP8ForwardWorkspaceSize(s, inputs[fullc::kData], inputs[fullc::kWeight], sizeof(DType));
+  FP8Workspace space(
+      ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(bytes), s).dptr_);
+  TBlob data_q, weight_q;
+  FP8UpdateScales<xpu>(ctx, param, inputs, outputs, nullptr, &space);
+  FP8QuantizeInputs<xpu, DType>(s,
+                                inputs[fullc::kData],
+                                inputs[fullc::kWeight],
+                                outputs[fp8fc::kScale].dptr<float>(),
+                                &data_q,
+                                &weight_q,
+                                &space);
+  std::vector<TBlob> fc_inputs = {data_q, weight_q};
+  if (!param.no_bias)
+    fc_inputs.push_back(inputs[fullc::kBias]);
+  FCForward<xpu, DType>(
+      ctx, param.fc_param(), fc_inputs, {req[fp8fc::kOut]}, {outputs[fp8fc::kOut]});
+}
+
+/*!
+ * \brief the backward pass, with the gradient of the output rounded to E5M2 with the scale of its
+ *  current maximum, and the data and the weight rounded to E4M3 with the scales of the forward
+ *  pass. The GEMMs compute in DType; the gradient of the bias is that of the output unrounded.
+ */
+template <typename xpu, typename DType>
+void FP8FullyConnectedBackwardEmulated(const nnvm::NodeAttrs& attrs,
+                                       const OpContext& ctx,
+                                       const std::vector<TBlob>& inputs,
+                                       const std::vector<OpReqType>& req,
+                                       const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  using namespace fp8fc;
+  const auto& param       = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& ograd      = inputs[kBwdOutGrad];
+  const size_t ws_size    = FP8AbsMaxWorkspaceSize(s, ograd);
+  size_t bytes = FP8Workspace::Size(2 * sizeof(float)) + FP8Workspace::Size(ws_size);
+  for (const TBlob& blob : {ograd, inputs[kBwdData], inputs[kBwdWeight]})
+    bytes += FP8Workspace::Size(blob.Size() * sizeof(DType));
+  FP8Workspace space(
+      ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(bytes), s).dptr_);
+
+  // the scale of the gradient of the output, then its maximum
+  float* ograd_scale = space.Take<float>(2);
+  const mshadow::Tensor<xpu, 1, char> workspace(
+      space.Take<char>(ws_size), mshadow::Shape1(ws_size), s);
+  FP8AbsMax(ctx, ograd, ograd_scale + 1, workspace);
+  Kernel<FP8CurrentScaleKernel<FP8E5M2>, xpu>::Launch(
+      s, 1, ograd_scale, ograd_scale + 1, param.margin);
+  const TBlob ograd_q(
+      space.Take<DType>(ograd.Size()), ograd.shape_, xpu::kDevMask, ograd.type_flag_);
+  Kernel<FP8QuantizeKernel<FP8E5M2>, xpu>::Launch(
+      s, ograd.Size(), ograd_q.dptr<DType>(), ograd.dptr<DType>(), ograd_scale);
+
+  TBlob data_q, weight_q;
+  FP8QuantizeInputs<xpu, DType>(s,
+                                inputs[kBwdData],
+                                inputs[kBwdWeight],
+                                inputs[kBwdScale].dptr<float>(),
+                                &data_q,
+                                &weight_q,
+                                &space);
+  std::vector<OpReqType> fc_req(req);
+  if (!param.no_bias)
+    fc_req[fullc::kBias] = kNullOp;
+  FCBackward<xpu, DType>(ctx, param.fc_param(), {ograd_q}, {data_q, weight_q}, fc_req, outputs);
+  if (!param.no_bias) {
+    const mshadow::Tensor<xpu, 2, DType> ograd_2d = param.flatten ?
+                                                        FlattenAs2DTail<xpu, DType>(ograd, ctx) :
+                                                        FlattenAs2DHead<xpu, DType>(ograd, ctx);
+    AddBiasGrad(outputs[fullc::kBias], ograd_2d, req[fullc::kBias], param.num_hidden, ctx);
+  }
+}
+
+template <typename xpu>
+void FP8FullyConnectedCompute(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs);
+
+/*!
+ * The inputs are the gradient of the output, the data, the weight and the scales of the forward
+ * pass. The outputs are the gradients of the data, the weight and the bias.
+ */
+template <typename xpu>
+void FP8FullyConnectedGradCompute(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_FP8_FULLY_CONNECTED_INL_H_
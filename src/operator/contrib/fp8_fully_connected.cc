@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_fully_connected.cc
+ * \brief Fully connected layer computing with the data and the weight rounded to FP8
+ */
+
+#include "./fp8_fully_connected-inl.h"
+
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(FP8FullyConnectedParam);
+
+static bool FP8FullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                   mxnet::ShapeVector* in_shape,
+                                   mxnet::ShapeVector* out_shape) {
+  using namespace mshadow;
+  const auto& param = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), param.amax_history_index() + 1U)
+      << (param.no_bias ? "Input:[data, weight, amax_history]" :
+                          "Input:[data, weight, bias, amax_history]");
+  CHECK_EQ(out_shape->size(), 2U);
+  SHAPE_ASSIGN_CHECK(*in_shape, param.amax_history_index(), Shape2(2, param.amax_history_len));
+  SHAPE_ASSIGN_CHECK(*out_shape, fp8fc::kScale, Shape1(2));
+  const mxnet::TShape dshape = (*in_shape)[fullc::kData];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+
+  const index_t num_input =
+      param.flatten ? dshape.ProdShape(1, dshape.ndim()) : dshape[dshape.ndim() - 1];
+  SHAPE_ASSIGN_CHECK(*in_shape, fullc::kWeight, Shape2(param.num_hidden, num_input));
+  if (!param.no_bias) {
+    if (!shape_assign(&(*in_shape)[fullc::kBias], Shape1(param.num_hidden)) &&
+        !shape_assign(&(*in_shape)[fullc::kBias], Shape2(param.num_hidden, 1))) {
+      LOG(FATAL) << "Unexpected shape for bias " << (*in_shape)[fullc::kBias];
+    }
+  }
+  if (!param.flatten) {
+    mxnet::TShape result_shape(dshape);
+    result_shape[dshape.ndim() - 1] = param.num_hidden;
+    SHAPE_ASSIGN_CHECK(*out_shape, fp8fc::kOut, result_shape);
+  } else {
+    SHAPE_ASSIGN_CHECK(*out_shape, fp8fc::kOut, Shape2(dshape[0], param.num_hidden));
+  }
+  return true;
+}
+
+static bool FP8FullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                  std::vector<int>* in_type,
+                                  std::vector<int>* out_type) {
+  const auto& param = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+  const int history = param.amax_history_index();
+  CHECK_EQ(in_type->size(), history + 1U);
+  TYPE_ASSIGN_CHECK(*in_type, history, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_type, fp8fc::kScale, mshadow::kFloat32);
+  int dtype = (*out_type)[fp8fc::kOut];
+  for (int i = 0; i < history && dtype == -1; ++i)
+    dtype = (*in_type)[i];
+  if (dtype == -1)
+    return false;
+  for (int i = 0; i < history; ++i)
+    TYPE_ASSIGN_CHECK(*in_type, i, dtype);
+  TYPE_ASSIGN_CHECK(*out_type, fp8fc::kOut, dtype);
+  return true;
+}
+
+std::vector<nnvm::NodeEntry> FP8FullyConnectedGrad(const nnvm::ObjectPtr& n,
+                                                   const std::vector<nnvm::NodeEntry>& ograds) {
+  const auto& param = nnvm::get<FP8FullyConnectedParam>(n->attrs.parsed);
+  std::vector<nnvm::NodeEntry> heads{ograds[fp8fc::kOut],
+                                     n->inputs[fullc::kData],
+                                     n->inputs[fullc::kWeight],
+                                     nnvm::NodeEntry{n, fp8fc::kScale, 0}};
+  nnvm::ObjectPtr gnode = nnvm::Node::Create();
+  gnode->inputs         = std::move(heads);
+  gnode->control_deps.emplace_back(n);
+  gnode->attrs      = n->attrs;
+  gnode->attrs.op   = nnvm::Op::Get("_backward_contrib_fp8_fully_connected");
+  gnode->attrs.name = n->attrs.name + "_backward";
+  std::vector<nnvm::NodeEntry> in_grad;
+  for (int i = 0; i < param.amax_history_index(); ++i)
+    in_grad.emplace_back(gnode, i, 0);
+  // the amax history is an auxiliary state
+  nnvm::ObjectPtr ng = nnvm::Node::Create();
+  ng->attrs.op       = Op::Get("_NoGradient");
+  ng->attrs.name     = "NoGradient";
+  in_grad.emplace_back(ng);
+  return in_grad;
+}
+
+template <>
+void FP8FullyConnectedCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  const int dtype = inputs[fullc::kData].type_flag_;
+  CHECK(dtype == mshadow::kFloat32 || dtype == mshadow::kFloat64)
+      << "fp8_fully_connected on CPU supports float32 and float64 data";
+  MSHADOW_SGL_DBL_TYPE_SWITCH(dtype, DType, {
+    FP8FullyConnectedForwardEmulated<cpu, DType>(attrs, ctx, inputs, req, outputs);
+  });
+}
+
+template <>
+void FP8FullyConnectedGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                       const OpContext& ctx,
+                                       const std::vector<TBlob>& inputs,
+                                       const std::vector<OpReqType>& req,
+                                       const std::vector<TBlob>& outputs) {
+  const int dtype = inputs[fp8fc::kBwdOutGrad].type_flag_;
+  CHECK(dtype == mshadow::kFloat32 || dtype == mshadow::kFloat64)
+      << "fp8_fully_connected on CPU supports float32 and float64 data";
+  MSHADOW_SGL_DBL_TYPE_SWITCH(dtype, DType, {
+    FP8FullyConnectedBackwardEmulated<cpu, DType>(attrs, ctx, inputs, req, outputs);
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_fp8_fully_connected)
+    .add_alias("_npx_fp8_fully_connected")
+    .describe(R"code(Apply a fully connected layer, like ``FullyConnected``, to the data and the
+weight rounded to FP8.
+
+The data and the weight are multiplied by per tensor scales and rounded to E4M3, FP8 with 4
+exponent and 3 mantissa bits, which is what FP8 tensor cores multiply. The scales are delayed:
+they map the largest absolute value of each tensor over the last ``amax_history_len`` steps to
+the largest E4M3 value, 448, divided by ``2^margin``, and values beyond it saturate. The
+auxiliary state ``amax_history`` of shape ``(2, amax_history_len)`` keeps the maxima of the data
+and of the weight, newest first. It is updated in training; it should start at zero, and the
+scales of the first step come from the current maxima.
+
+In the backward pass the gradient of the output is rounded to E5M2, with 5 exponent and 2
+mantissa bits, with the scale of its current maximum.
+
+On GPUs of compute capability 8.9 or later, when MXNet is built with cuBLASLt of CUDA 11.8 or
+later, the forward GEMM multiplies the FP8 values for float16 and float32 data whose sizes are
+multiples of 16. Everywhere else the rounded values are multiplied in the type of the data.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<FP8FullyConnectedParam>(attrs.parsed).amax_history_index() + 1;
+    })
+    .set_num_outputs(2)
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<FP8FullyConnectedParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const auto& param = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+          if (param.no_bias)
+            return std::vector<std::string>{"data", "weight", "amax_history"};
+          return std::vector<std::string>{"data", "weight", "bias", "amax_history"};
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "scale"};
+                                      })
+    .set_attr<nnvm::FMutateInputs>(
+        "FMutateInputs",
+        [](const nnvm::NodeAttrs& attrs) {
+          const auto& param = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+          return std::vector<uint32_t>{static_cast<uint32_t>(param.amax_history_index())};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", FP8FullyConnectedShape)
+    .set_attr<nnvm::FInferType>("FInferType", FP8FullyConnectedType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", FP8FullyConnectedCompute<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", FP8FullyConnectedGrad)
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+    .add_argument("amax_history",
+                  "NDArray-or-Symbol",
+                  "The absolute maxima of the data and of the weight of the last steps.")
+    .add_arguments(FP8FullyConnectedParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_fp8_fully_connected)
+    .set_num_inputs(4)
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return nnvm::get<FP8FullyConnectedParam>(attrs.parsed).amax_history_index();
+    })
+    .set_attr_parser(ParamParser<FP8FullyConnectedParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", FP8FullyConnectedGradCompute<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_fully_connected.cu
+ * \brief Fully connected layer computing with the data and the weight rounded to FP8, with the
+ *  FP8 GEMMs of cuBLASLt when the GPU has them
+ */
+
+#include "./fp8_fully_connected-inl.h"
+
+#include <type_traits>
+#include <vector>
+
+#if MXNET_USE_CUBLASLT == 1 && CUDA_VERSION >= 11080
+#include <cublasLt.h>
+#define MXNET_USE_FP8_CUBLASLT 1
+#else
+#define MXNET_USE_FP8_CUBLASLT 0
+#endif
+
+namespace mxnet {
+namespace op {
+
+#if MXNET_USE_FP8_CUBLASLT
+
+namespace {
+
+// bytes of the workspace of the cuBLASLt GEMM
+constexpr size_t kCublasLtWorkspace = 4 << 20;
+
+/*! \brief the cuBLASLt descriptors of the GEMM of a layer, released with the object */
+class FP8CublasLtGemm {
+ public:
+  /*!
+   * \brief the row major rows x hidden out = data * weight^T, thus col major hidden x rows
+   *  out = weight^T * data with cols x hidden weight and cols x rows data
+   */
+  FP8CublasLtGemm(cudaDataType_t out_type, index_t rows, index_t cols, index_t hidden) {
+    const cublasOperation_t transa = CUBLAS_OP_T;
+    const cublasOperation_t transb = CUBLAS_OP_N;
+    CUBLAS_CALL(cublasLtMatmulDescCreate(&desc_, CUBLAS_COMPUTE_32F, CUDA_R_32F));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_TRANSA, &transa, sizeof(transa)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_TRANSB, &transb, sizeof(transb)));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&a_, CUDA_R_8F_E4M3, cols, hidden, cols));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&b_, CUDA_R_8F_E4M3, cols, rows, cols));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&d_, out_type, hidden, rows, hidden));
+  }
+
+  ~FP8CublasLtGemm() {
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(d_));
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(b_));
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(a_));
+    CUBLAS_CALL(cublasLtMatmulDescDestroy(desc_));
+  }
+
+  /*! \brief chooses the algorithm, false when cuBLASLt has none */
+  bool Prepare(cublasLtHandle_t handle) {
+    cublasLtMatmulPreference_t pref;
+    const uint64_t workspace = kCublasLtWorkspace;
+    int found                = 0;
+    CUBLAS_CALL(cublasLtMatmulPreferenceCreate(&pref));
+    CUBLAS_CALL(cublasLtMatmulPreferenceSetAttribute(
+        pref, CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, &workspace, sizeof(workspace)));
+    const cublasStatus_t status =
+        cublasLtMatmulAlgoGetHeuristic(handle, desc_, a_, b_, d_, d_, pref, 1, &algo_, &found);
+    CUBLAS_CALL(cublasLtMatmulPreferenceDestroy(pref));
+    return status == CUBLAS_STATUS_SUCCESS && found > 0;
+  }
+
+  /*! \brief out = weight * data, with the inverses of the scales of the FP8 values */
+  void Run(cublasLtHandle_t handle,
+           cudaStream_t stream,
+           const uint8_t* weight,
+           const uint8_t* data,
+           const float* inv_scale,
+           void* out,
+           void* workspace) {
+    const float* a_scale = inv_scale + fp8fc::kWeightAmax;
+    const float* b_scale = inv_scale + fp8fc::kDataAmax;
+    const float alpha    = 1.0f;
+    const float beta     = 0.0f;
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_A_SCALE_POINTER, &a_scale, sizeof(a_scale)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_B_SCALE_POINTER, &b_scale, sizeof(b_scale)));
+    CUBLAS_CALL(cublasLtMatmul(handle,
+                               desc_,
+                               &alpha,
+                               weight,
+                               a_,
+                               data,
+                               b_,
+                               &beta,
+                               out,
+                               d_,
+                               out,
+                               d_,
+                               &algo_.algo,
+                               workspace,
+                               kCublasLtWorkspace,
+                               stream));
+  }
+
+ private:
+  cublasLtMatmulDesc_t desc_;
+  cublasLtMatrixLayout_t a_;
+  cublasLtMatrixLayout_t b_;
+  cublasLtMatrixLayout_t d_;
+  cublasLtMatmulHeuristicResult_t algo_;
+};
+
+/*! \brief the forward pass with the FP8 GEMM of cuBLASLt, false when it does not apply */
+template <typename DType>
+bool FP8FullyConnectedForwardCublasLt(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const auto& param       = nnvm::get<FP8FullyConnectedParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const TBlob& data       = inputs[fullc::kData];
+  const TBlob& weight     = inputs[fullc::kWeight];
+  const index_t hidden    = param.num_hidden;
+  const index_t cols      = weight.shape_[1];
+  const index_t rows      = data.Size() / cols;
+  if (!std::is_same<DType, float>::value && !std::is_same<DType, mshadow::half::half_t>::value)
+    return false;
+  if (common::cuda::SMArch(ctx.run_ctx.ctx.dev_id) < 89 || rows % 16 != 0 || cols % 16 != 0 ||
+      hidden % 16 != 0)
+    return false;
+  const cudaDataType_t out_type =
+      mshadow::DataType<DType>::kFlag == mshadow::kFloat16 ? CUDA_R_16F : CUDA_R_32F;
+  cublasLtHandle_t handle = reinterpret_cast<cublasLtHandle_t>(s->blas_handle_);
+  FP8CublasLtGemm gemm(out_type, rows, cols, hidden);
+  if (!gemm.Prepare(handle))
+    return false;
+
+  const size_t bytes = FP8ForwardWorkspaceSize(s, data, weight, sizeof(uint8_t)) +
+                       FP8Workspace::Size(kCublasLtWorkspace);
+  FP8Workspace space(
+      ctx.requested[0].get_space_typed<gpu, 1, char>(mshadow::Shape1(bytes), s).dptr_);
+  float* inv_scale = space.Take<float>(2);
+  FP8UpdateScales<gpu>(ctx, param, inputs, outputs, inv_scale, &space);
+  const float* scale = outputs[fp8fc::kScale].dptr<float>();
+  uint8_t* data_q    = space.Take<uint8_t>(data.Size());
+  uint8_t* weight_q  = space.Take<uint8_t>(weight.Size());
+  Kernel<FP8EncodeKernel<FP8E4M3>, gpu>::Launch(
+      s, data.Size(), data_q, data.dptr<DType>(), scale + fp8fc::kDataAmax);
+  Kernel<FP8EncodeKernel<FP8E4M3>, gpu>::Launch(
+      s, weight.Size(), weight_q, weight.dptr<DType>(), scale + fp8fc::kWeightAmax);
+  const TBlob& out = outputs[fp8fc::kOut];
+  gemm.Run(handle,
+           mshadow::Stream<gpu>::GetStream(s),
+           weight_q,
+           data_q,
+           inv_scale,
+           out.dptr<DType>(),
+           space.Take<char>(kCublasLtWorkspace));
+  if (!param.no_bias) {
+    AddBias(inputs[fullc::kBias].get_with_shape<gpu, 1, DType>(mshadow::Shape1(hidden), s),
+            data.get_with_shape<gpu, 2, DType>(mshadow::Shape2(rows, cols), s),
+            out.get_with_shape<gpu, 2, DType>(mshadow::Shape2(rows, hidden), s),
+            s);
+  }
+  return true;
+}
+
+}  // namespace
+
+#endif  // MXNET_USE_FP8_CUBLASLT
+
+template <>
+void FP8FullyConnectedCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  if (req[fp8fc::kOut] == kNullOp)
+    return;
+  CHECK_EQ(req[fp8fc::kOut], kWriteTo);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[fullc::kData].type_flag_, DType, {
+#if MXNET_USE_FP8_CUBLASLT
+    if (FP8FullyConnectedForwardCublasLt<DType>(attrs, ctx, inputs, req, outputs))
+      return;
+#endif
+    FP8FullyConnectedForwardEmulated<gpu, DType>(attrs, ctx, inputs, req, outputs);
+  });
+}
+
+template <>
+void FP8FullyConnectedGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                       const OpContext& ctx,
+                                       const std::vector<TBlob>& inputs,
+                                       const std::vector<OpReqType>& req,
+                                       const std::vector<TBlob>& outputs) {
+  MSHADOW_REAL_TYPE_SWITCH(inputs[fp8fc::kBwdOutGrad].type_flag_, DType, {
+    FP8FullyConnectedBackwardEmulated<gpu, DType>(attrs, ctx, inputs, req, outputs);
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_fp8_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", FP8FullyConnectedCompute<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_fp8_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", FP8FullyConnectedGradCompute<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
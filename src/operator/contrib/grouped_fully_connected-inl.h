@@ -0,0 +1,299 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file grouped_fully_connected-inl.h
+ * \brief Independent fully connected layers computed with grouped GEMMs
+ */
+
+#ifndef MXNET_OPERATOR_CONTRIB_GROUPED_FULLY_CONNECTED_INL_H_
+#define MXNET_OPERATOR_CONTRIB_GROUPED_FULLY_CONNECTED_INL_H_
+
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+struct GroupedFullyConnectedParam : public dmlc::Parameter<GroupedFullyConnectedParam> {
+  int num_groups;
+  mxnet::Tuple<int> num_hidden;
+  bool no_bias;
+  bool flatten;
+
+  DMLC_DECLARE_PARAMETER(GroupedFullyConnectedParam) {
+    DMLC_DECLARE_FIELD(num_groups).set_lower_bound(1).describe("Number of fully connected layers.");
+    DMLC_DECLARE_FIELD(num_hidden).describe("Number of hidden nodes of the output of each layer.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+  }
+
+  /*! \brief number of inputs of each layer */
+  int num_layer_inputs() const {
+    return no_bias ? 2 : 3;
+  }
+};
+
+/*!
+ * \brief C = op(A) * op(B) + beta * C, with row major m x n C, m x k op(A) and k x n op(B),
+ *  and the leading dimensions of the matrices as stored
+ */
+template <typename DType>
+struct GroupedGemmDesc {
+  const DType* a;
+  const DType* b;
+  DType* c;
+  bool ta;
+  bool tb;
+  index_t m;
+  index_t n;
+  index_t k;
+  index_t lda;
+  index_t ldb;
+  index_t ldc;
+  float beta;
+};
+
+/*!
+ * \brief run the GEMMs of gemms, the GEMMs of the same sizes together. The GEMMs must not
+ *  write the same C.
+ * \param ptrs device memory for 3 pointers per GEMM
+ */
+template <typename xpu, typename DType>
+void GroupedGemm(const OpContext& ctx,
+                 const std::vector<GroupedGemmDesc<DType>>& gemms,
+                 void** ptrs);
+
+/*! \brief data of layer i viewed as a rows x cols matrix */
+inline std::pair<index_t, index_t> GroupedFCDataMatrix(const mxnet::TShape& dshape,
+                                                       bool flatten) {
+  if (flatten)
+    return {dshape[0], dshape.ProdShape(1, dshape.ndim())};
+  return {dshape.ProdShape(0, dshape.ndim() - 1), dshape[dshape.ndim() - 1]};
+}
+
+inline bool GroupedFullyConnectedShape(const nnvm::NodeAttrs& attrs,
+                                       mxnet::ShapeVector* in_shape,
+                                       mxnet::ShapeVector* out_shape) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  const int per     = param.num_layer_inputs();
+  bool all_known    = true;
+  CHECK_EQ(param.num_hidden.ndim(), param.num_groups);
+  CHECK_EQ(in_shape->size(), param.num_groups * per);
+  CHECK_EQ(out_shape->size(), param.num_groups);
+  for (int g = 0; g < param.num_groups; ++g) {
+    const mxnet::TShape dshape = (*in_shape)[g * per];
+    const index_t num_hidden   = param.num_hidden[g];
+    if (!mxnet::ndim_is_known(dshape)) {
+      all_known = false;
+      continue;
+    }
+    const index_t num_input = GroupedFCDataMatrix(dshape, param.flatten).second;
+    SHAPE_ASSIGN_CHECK(*in_shape, g * per + 1, mshadow::Shape2(num_hidden, num_input));
+    if (!param.no_bias) {
+      if (!shape_assign(&(*in_shape)[g * per + 2], mshadow::Shape1(num_hidden)) &&
+          !shape_assign(&(*in_shape)[g * per + 2], mshadow::Shape2(num_hidden, 1))) {
+        LOG(FATAL) << "Unexpected shape for bias " << (*in_shape)[g * per + 2];
+      }
+    }
+    if (!param.flatten) {
+      mxnet::TShape result_shape(dshape);
+      result_shape[dshape.ndim() - 1] = num_hidden;
+      SHAPE_ASSIGN_CHECK(*out_shape, g, result_shape);
+    } else {
+      SHAPE_ASSIGN_CHECK(*out_shape, g, mshadow::Shape2(dshape[0], num_hidden));
+    }
+  }
+  return all_known;
+}
+
+inline bool GroupedFullyConnectedType(const nnvm::NodeAttrs& attrs,
+                                      std::vector<int>* in_type,
+                                      std::vector<int>* out_type) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  const int per     = param.num_layer_inputs();
+  CHECK_EQ(in_type->size(), param.num_groups * per);
+  CHECK_EQ(out_type->size(), param.num_groups);
+  // the layers may compute in different types
+  bool all_known = true;
+  for (int g = 0; g < param.num_groups; ++g) {
+    int dtype = (*out_type)[g];
+    for (int i = 0; i < per && dtype == -1; ++i)
+      dtype = (*in_type)[g * per + i];
+    if (dtype == -1) {
+      all_known = false;
+      continue;
+    }
+    for (int i = 0; i < per; ++i)
+      TYPE_ASSIGN_CHECK(*in_type, g * per + i, dtype);
+    TYPE_ASSIGN_CHECK(*out_type, g, dtype);
+  }
+  return all_known;
+}
+
+/*!
+ * \brief bytes of the temporary space of a grouped fully connected layer computing
+ *  num_gemms GEMMs, with max_rows data rows in a layer
+ */
+template <typename DType>
+size_t GroupedFCWorkspaceSize(index_t max_rows, size_t num_gemms) {
+  const size_t ones_slots = (max_rows * sizeof(DType) + sizeof(void*) - 1) / sizeof(void*);
+  return (ones_slots + 3 * num_gemms) * sizeof(void*);
+}
+
+/*! \brief split the temporary space into a vector of ones and the pointers of the GEMMs */
+template <typename xpu, typename DType>
+DType* GroupedFCWorkspace(const OpContext& ctx,
+                          index_t max_rows,
+                          size_t num_gemms,
+                          void*** ptrs) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const size_t slots      = GroupedFCWorkspaceSize<DType>(max_rows, num_gemms) / sizeof(void*);
+  void** space            = reinterpret_cast<void**>(
+      ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(slots * sizeof(void*)), s)
+          .dptr_);
+  DType* ones = reinterpret_cast<DType*>(space);
+  *ptrs       = space + slots - 3 * num_gemms;
+  if (max_rows > 0)
+    Kernel<set_one, xpu>::Launch(s, max_rows, ones);
+  return ones;
+}
+
+/*! \brief the types of the layers, in the order of the layers */
+inline std::vector<int> GroupedFCTypes(const std::vector<TBlob>& blobs, int num, int stride) {
+  std::vector<int> types;
+  for (int g = 0; g < num; ++g) {
+    if (std::find(types.begin(), types.end(), blobs[g * stride].type_flag_) == types.end())
+      types.push_back(blobs[g * stride].type_flag_);
+  }
+  return types;
+}
+
+/*! \brief compute the layers of type DType */
+template <typename xpu, typename DType>
+void GroupedFullyConnectedForward(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  const int per     = param.num_layer_inputs();
+  std::vector<GroupedGemmDesc<DType>> bias_gemms, gemms;
+  index_t max_rows = 0;
+  for (int g = 0; g < param.num_groups; ++g) {
+    if (req[g] == kNullOp || outputs[g].type_flag_ != mshadow::DataType<DType>::kFlag)
+      continue;
+    CHECK_EQ(req[g], kWriteTo);
+    const auto x         = GroupedFCDataMatrix(inputs[g * per].shape_, param.flatten);
+    const index_t rows   = x.first;
+    const index_t cols   = x.second;
+    const index_t hidden = param.num_hidden[g];
+    DType* out           = outputs[g].dptr<DType>();
+    const DType* data    = inputs[g * per].dptr<DType>();
+    const DType* weight  = inputs[g * per + 1].dptr<DType>();
+    // out = rows x 1 ones * 1 x hidden bias, then out += data * weight^T
+    if (!param.no_bias) {
+      const DType* bias = inputs[g * per + 2].dptr<DType>();
+      bias_gemms.push_back({nullptr, bias, out, false, false, rows, hidden, 1, 1, hidden, hidden,
+                            0.0f});
+      max_rows = std::max(max_rows, rows);
+    }
+    gemms.push_back({data, weight, out, false, true, rows, hidden, cols, cols, cols, hidden,
+                     param.no_bias ? 0.0f : 1.0f});
+  }
+  if (gemms.empty())
+    return;
+  void** ptrs = nullptr;
+  DType* ones = GroupedFCWorkspace<xpu, DType>(ctx, max_rows, gemms.size(), &ptrs);
+  if (!bias_gemms.empty()) {
+    for (auto& gemm : bias_gemms)
+      gemm.a = ones;
+    GroupedGemm<xpu, DType>(ctx, bias_gemms, ptrs);
+  }
+  GroupedGemm<xpu, DType>(ctx, gemms, ptrs);
+}
+
+/*!
+ * \brief compute the gradients of the layers of type DType. The inputs are the gradients of the
+ *  outputs followed by the data and the weights of the layers, the outputs the gradients of the
+ *  data, the weights and the biases of the layers.
+ */
+template <typename xpu, typename DType>
+void GroupedFullyConnectedBackward(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  const int per     = param.num_layer_inputs();
+  const int groups  = param.num_groups;
+  std::vector<GroupedGemmDesc<DType>> gemms;
+  index_t max_rows = 0;
+  for (int g = 0; g < groups; ++g) {
+    if (inputs[g].type_flag_ != mshadow::DataType<DType>::kFlag)
+      continue;
+    const auto x          = GroupedFCDataMatrix(inputs[groups + 2 * g].shape_, param.flatten);
+    const index_t rows    = x.first;
+    const index_t cols    = x.second;
+    const index_t hidden  = param.num_hidden[g];
+    const DType* ograd    = inputs[g].dptr<DType>();
+    const DType* data     = inputs[groups + 2 * g].dptr<DType>();
+    const DType* weight   = inputs[groups + 2 * g + 1].dptr<DType>();
+    const OpReqType* reqs = &req[g * per];
+    for (int i = 0; i < per; ++i)
+      CHECK_NE(reqs[i], kWriteInplace) << "cannot write the gradients inplace";
+    // data grad = ograd * weight
+    if (reqs[0] != kNullOp) {
+      gemms.push_back({ograd, weight, outputs[g * per].dptr<DType>(), false, false, rows, cols,
+                       hidden, hidden, cols, cols, reqs[0] == kAddTo ? 1.0f : 0.0f});
+    }
+    // weight grad = ograd^T * data
+    if (reqs[1] != kNullOp) {
+      gemms.push_back({ograd, data, outputs[g * per + 1].dptr<DType>(), true, false, hidden, cols,
+                       rows, hidden, cols, cols, reqs[1] == kAddTo ? 1.0f : 0.0f});
+    }
+    // bias grad = 1 x rows ones * ograd
+    if (!param.no_bias && reqs[2] != kNullOp) {
+      gemms.push_back({nullptr, ograd, outputs[g * per + 2].dptr<DType>(), false, false, 1,
+                       hidden, rows, rows, hidden, hidden, reqs[2] == kAddTo ? 1.0f : 0.0f});
+      max_rows = std::max(max_rows, rows);
+    }
+  }
+  if (gemms.empty())
+    return;
+  void** ptrs = nullptr;
+  DType* ones = GroupedFCWorkspace<xpu, DType>(ctx, max_rows, gemms.size(), &ptrs);
+  for (auto& gemm : gemms) {
+    if (gemm.a == nullptr)
+      gemm.a = ones;
+  }
+  GroupedGemm<xpu, DType>(ctx, gemms, ptrs);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_GROUPED_FULLY_CONNECTED_INL_H_
@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file grouped_fully_connected.cc
+ * \brief Independent fully connected layers computed with grouped GEMMs
+ */
+
+#include <string>
+
+#include "./grouped_fully_connected-inl.h"
+#include "../../engine/openmp.h"
+#include "../linalg.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(GroupedFullyConnectedParam);
+
+template <typename DType>
+void GroupedGemmCPU(const OpContext& ctx, const std::vector<GroupedGemmDesc<DType>>& gemms) {
+  using mshadow::Shape2;
+  using mshadow::Tensor;
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const int nthreads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // Small GEMMs do not keep the threads of the BLAS busy, they run one per thread instead.
+  bool small = true;
+  for (const auto& gemm : gemms)
+    small = small && gemm.m * gemm.n * gemm.k <= (1 << 18);
+  const bool per_thread =
+      gemms.size() > 1 && (small || gemms.size() >= static_cast<size_t>(nthreads));
+#pragma omp parallel for num_threads(nthreads) if (per_thread)
+  for (index_t i = 0; i < static_cast<index_t>(gemms.size()); ++i) {
+    const GroupedGemmDesc<DType>& gemm = gemms[i];
+    Tensor<cpu, 2, DType> a(const_cast<DType*>(gemm.a),
+                            gemm.ta ? Shape2(gemm.k, gemm.m) : Shape2(gemm.m, gemm.k),
+                            gemm.lda,
+                            s);
+    Tensor<cpu, 2, DType> b(const_cast<DType*>(gemm.b),
+                            gemm.tb ? Shape2(gemm.n, gemm.k) : Shape2(gemm.k, gemm.n),
+                            gemm.ldb,
+                            s);
+    Tensor<cpu, 2, DType> c(gemm.c, Shape2(gemm.m, gemm.n), gemm.ldc, s);
+    linalg_gemm(a, b, c, DType(1), DType(gemm.beta), gemm.ta, gemm.tb, s);
+  }
+}
+
+template <>
+void GroupedGemm<cpu, float>(const OpContext& ctx,
+                             const std::vector<GroupedGemmDesc<float>>& gemms,
+                             void** ptrs) {
+  GroupedGemmCPU(ctx, gemms);
+}
+
+template <>
+void GroupedGemm<cpu, double>(const OpContext& ctx,
+                              const std::vector<GroupedGemmDesc<double>>& gemms,
+                              void** ptrs) {
+  GroupedGemmCPU(ctx, gemms);
+}
+
+void GroupedFullyConnectedForwardCPU(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  for (const int type : GroupedFCTypes(outputs, param.num_groups, 1)) {
+    MSHADOW_SGL_DBL_TYPE_SWITCH(type, DType, {
+      GroupedFullyConnectedForward<cpu, DType>(attrs, ctx, inputs, req, outputs);
+    });
+  }
+}
+
+void GroupedFullyConnectedBackwardCPU(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  for (const int type : GroupedFCTypes(inputs, param.num_groups, 1)) {
+    MSHADOW_SGL_DBL_TYPE_SWITCH(type, DType, {
+      GroupedFullyConnectedBackward<cpu, DType>(attrs, ctx, inputs, req, outputs);
+    });
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_grouped_fully_connected)
+    .describe(R"code(Apply independent fully connected layers, like ``FullyConnected``, with
+grouped GEMMs.
+
+The inputs are the data, the weight and, unless ``no_bias`` is set, the bias of each layer,
+layer after layer, and the outputs the outputs of the layers. The layers may have different
+sizes and types. The GEMMs of the layers of the same sizes run together, on GPU as batched
+cuBLAS GEMMs, on CPU one per thread when they are small. The CachedOp of a Gluon model groups
+the independent ``FullyConnected`` operators of its graph into this operator when
+MXNET_USE_GROUPED_FC is set.
+
+The layers use float32, float64 or, on GPU, float16.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_groups * param.num_layer_inputs());
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return static_cast<uint32_t>(nnvm::get<GroupedFullyConnectedParam>(attrs.parsed).num_groups);
+    })
+    .set_attr_parser(ParamParser<GroupedFullyConnectedParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const auto& param =
+                                           nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+                                       std::vector<std::string> ret;
+                                       for (int g = 0; g < param.num_groups; ++g) {
+                                         ret.push_back("data" + std::to_string(g));
+                                         ret.push_back("weight" + std::to_string(g));
+                                         if (!param.no_bias)
+                                           ret.push_back("bias" + std::to_string(g));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", GroupedFullyConnectedShape)
+    .set_attr<nnvm::FInferType>("FInferType", GroupedFullyConnectedType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    // the pointers of the GEMMs are copied from the host on every call
+    .set_attr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible",
+                                       [](const NodeAttrs& attrs, const bool) { return false; })
+    .set_attr<FCompute>("FCompute<cpu>", GroupedFullyConnectedForwardCPU)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          const auto& param = nnvm::get<GroupedFullyConnectedParam>(n->attrs.parsed);
+          const int per     = param.num_layer_inputs();
+          std::vector<nnvm::NodeEntry> heads(ograds.begin(), ograds.end());
+          for (int g = 0; g < param.num_groups; ++g) {
+            heads.push_back(n->inputs[g * per]);
+            heads.push_back(n->inputs[g * per + 1]);
+          }
+          return MakeGradNode(
+              "_backward_contrib_grouped_fully_connected", n, heads, n->attrs.dict);
+        })
+    .add_argument("args", "NDArray-or-Symbol[]", "The data, weight and bias of each layer")
+    .add_arguments(GroupedFullyConnectedParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_grouped_fully_connected)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return static_cast<uint32_t>(
+          3 * nnvm::get<GroupedFullyConnectedParam>(attrs.parsed).num_groups);
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_groups * param.num_layer_inputs());
+    })
+    .set_attr_parser(ParamParser<GroupedFullyConnectedParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FIsCUDAGraphsCompatible>("FIsCUDAGraphsCompatible",
+                                       [](const NodeAttrs& attrs, const bool) { return false; })
+    .set_attr<FCompute>("FCompute<cpu>", GroupedFullyConnectedBackwardCPU);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file grouped_fully_connected.cu
+ * \brief Independent fully connected layers computed with grouped GEMMs
+ */
+
+#include <map>
+#include <tuple>
+#include <type_traits>
+
+#include "./grouped_fully_connected-inl.h"
+#include "../../common/cuda/utils.h"
+#include "../linalg.h"
+
+namespace mxnet {
+namespace op {
+
+template <typename DType>
+void GroupedGemmGPU(const OpContext& ctx,
+                    const std::vector<GroupedGemmDesc<DType>>& gemms,
+                    void** ptrs) {
+  using namespace mxnet::common::cuda;
+  using ScaleType         = typename CublasType<DType>::ScaleType;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  CHECK_EQ(s->blas_handle_ownership_, mshadow::Stream<gpu>::OwnHandle)
+      << "Must init CuBLAS handle in stream";
+
+  // the GEMMs of the same sizes run as one batched GEMM
+  using Sizes = std::tuple<bool, bool, index_t, index_t, index_t, index_t, index_t, index_t, float>;
+  std::map<Sizes, std::vector<size_t>> batches;
+  for (size_t i = 0; i < gemms.size(); ++i) {
+    const auto& g = gemms[i];
+    batches[Sizes(g.ta, g.tb, g.m, g.n, g.k, g.lda, g.ldb, g.ldc, g.beta)].push_back(i);
+  }
+  // the pointers to A, then B, then C of the GEMMs of each batch, batch after batch
+  std::vector<const void*> host_ptrs(3 * gemms.size());
+  size_t offset = 0;
+  for (const auto& batch : batches) {
+    const size_t count = batch.second.size();
+    for (size_t j = 0; j < count; ++j) {
+      const auto& gemm                  = gemms[batch.second[j]];
+      host_ptrs[offset + j]             = gemm.a;
+      host_ptrs[offset + count + j]     = gemm.b;
+      host_ptrs[offset + 2 * count + j] = gemm.c;
+    }
+    offset += 3 * count;
+  }
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  CUDA_CALL(cudaMemcpyAsync(ptrs,
+                            host_ptrs.data(),
+                            host_ptrs.size() * sizeof(void*),
+                            cudaMemcpyHostToDevice,
+                            stream));
+
+  cublasHandle_t blas_handle = mshadow::Stream<gpu>::GetBlasHandle(s);
+  auto math_mode = std::is_same<DType, mshadow::half::half_t>::value && GetEnvAllowTensorCore() ?
+                       CUBLAS_TENSOR_OP_MATH :
+                       VERSION_ADJUSTED_TF32_MATH;
+  auto previous_math_mode = SetCublasMathMode(blas_handle, math_mode);
+  const ScaleType alpha   = 1;
+  offset                  = 0;
+  for (const auto& batch : batches) {
+    // cuBLAS is column major, it computes C^T = op(B)^T * op(A)^T
+    const auto& gemm     = gemms[batch.second[0]];
+    const int count      = batch.second.size();
+    const ScaleType beta = gemm.beta;
+    void** a             = ptrs + offset;
+    CUBLAS_CALL(cublasGemmBatchedEx(blas_handle,
+                                    CublasTransposeOp(gemm.tb),
+                                    CublasTransposeOp(gemm.ta),
+                                    static_cast<int>(gemm.n),
+                                    static_cast<int>(gemm.m),
+                                    static_cast<int>(gemm.k),
+                                    &alpha,
+                                    reinterpret_cast<const void* const*>(a + count),
+                                    CublasType<DType>::kCudaFlag,
+                                    static_cast<int>(gemm.ldb),
+                                    reinterpret_cast<const void* const*>(a),
+                                    CublasType<DType>::kCudaFlag,
+                                    static_cast<int>(gemm.lda),
+                                    &beta,
+                                    a + 2 * count,
+                                    CublasType<DType>::kCudaFlag,
+                                    static_cast<int>(gemm.ldc),
+                                    count,
+                                    CublasType<ScaleType>::kCudaFlag,
+                                    CUBLAS_GEMM_DEFAULT));
+    offset += 3 * count;
+  }
+  SetCublasMathMode(blas_handle, previous_math_mode);
+}
+
+template <>
+void GroupedGemm<gpu, float>(const OpContext& ctx,
+                             const std::vector<GroupedGemmDesc<float>>& gemms,
+                             void** ptrs) {
+  GroupedGemmGPU(ctx, gemms, ptrs);
+}
+
+template <>
+void GroupedGemm<gpu, double>(const OpContext& ctx,
+                              const std::vector<GroupedGemmDesc<double>>& gemms,
+                              void** ptrs) {
+  GroupedGemmGPU(ctx, gemms, ptrs);
+}
+
+template <>
+void GroupedGemm<gpu, mshadow::half::half_t>(
+    const OpContext& ctx,
+    const std::vector<GroupedGemmDesc<mshadow::half::half_t>>& gemms,
+    void** ptrs) {
+  GroupedGemmGPU(ctx, gemms, ptrs);
+}
+
+void GroupedFullyConnectedForwardGPU(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  for (const int type : GroupedFCTypes(outputs, param.num_groups, 1)) {
+    MSHADOW_REAL_TYPE_SWITCH(type, DType, {
+      GroupedFullyConnectedForward<gpu, DType>(attrs, ctx, inputs, req, outputs);
+    });
+  }
+}
+
+void GroupedFullyConnectedBackwardGPU(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<GroupedFullyConnectedParam>(attrs.parsed);
+  for (const int type : GroupedFCTypes(inputs, param.num_groups, 1)) {
+    MSHADOW_REAL_TYPE_SWITCH(type, DType, {
+      GroupedFullyConnectedBackward<gpu, DType>(attrs, ctx, inputs, req, outputs);
+    });
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_grouped_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", GroupedFullyConnectedForwardGPU);
+
+NNVM_REGISTER_OP(_backward_contrib_grouped_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", GroupedFullyConnectedBackwardGPU);
+
+}  // namespace op
+}  // namespace mxnet
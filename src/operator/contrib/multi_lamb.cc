@@ -32,90 +32,82 @@ namespace op {
 template <typename MPDType, bool has_mixed_precision>
 struct MultiLAMBKernelStep1 {
   template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                                  const float beta1,
-                                  const float beta2,
-                                  const float epsilon,
-                                  const float clip_gradient,
-                                  const bool bias_correction,
-                                  const float rescale_grad,
-                                  float* temp_g) {
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
+                                         const float beta1,
+                                         const float beta2,
+                                         const float epsilon,
+                                         const float clip_gradient,
+                                         const bool bias_correction,
+                                         const float rescale_grad,
+                                         float* temp_g) {
     using namespace mshadow_op;
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w           = has_mixed_precision ? kernel_params.weights32[index][i]
-                                                  : MPDType(kernel_params.weights[index][i]);
-        MPDType scaled_grad = static_cast<MPDType>(kernel_params.grads[index][i]) * rescale_grad;
-        if (clip_gradient >= 0.0f)
-          scaled_grad = mshadow_op::clip::Map(scaled_grad, static_cast<MPDType>(clip_gradient));
-        MPDType mean = static_cast<MPDType>(beta1) * kernel_params.mean[index][i] +
-                       (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta1)) * scaled_grad;
-        MPDType var =
-            static_cast<MPDType>(beta2) * kernel_params.var[index][i] +
-            (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta2)) * scaled_grad * scaled_grad;
-        kernel_params.mean[index][i] = mean;
-        kernel_params.var[index][i]  = var;
-
-        MPDType g;
-        if (bias_correction) {
-          MPDType mean_hat =
-              mean / (static_cast<MPDType>(1.0f) -
-                      power::Map(static_cast<MPDType>(beta1),
-                                 static_cast<MPDType>(kernel_params.step_count[index])));
-          MPDType var_hat =
-              var / (static_cast<MPDType>(1.0f) -
-                     power::Map(static_cast<MPDType>(beta2),
-                                static_cast<MPDType>(kernel_params.step_count[index])));
-          g = mean_hat / (sqrt(var_hat) + static_cast<MPDType>(epsilon)) +
-              kernel_params.wds[index] * w;
-        } else {
-          g = mean / (sqrt(var) + static_cast<MPDType>(epsilon)) + kernel_params.wds[index] * w;
-        }
-        temp_g[kernel_params.tensor2temp_g[index] + i] = g;
-      }
+    MPDType w           = has_mixed_precision ? kernel_params.weights32[index][i]
+                                              : MPDType(kernel_params.weights[index][i]);
+    MPDType scaled_grad = static_cast<MPDType>(kernel_params.grads[index][i]) * rescale_grad;
+    if (clip_gradient >= 0.0f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, static_cast<MPDType>(clip_gradient));
+    MPDType mean = static_cast<MPDType>(beta1) * kernel_params.mean[index][i] +
+                   (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta1)) * scaled_grad;
+    MPDType var =
+        static_cast<MPDType>(beta2) * kernel_params.var[index][i] +
+        (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta2)) * scaled_grad * scaled_grad;
+    kernel_params.mean[index][i] = mean;
+    kernel_params.var[index][i]  = var;
+
+    MPDType g;
+    if (bias_correction) {
+      MPDType mean_hat = mean / (static_cast<MPDType>(1.0f) -
+                                 power::Map(static_cast<MPDType>(beta1),
+                                            static_cast<MPDType>(kernel_params.step_count[index])));
+      MPDType var_hat  = var / (static_cast<MPDType>(1.0f) -
+                               power::Map(static_cast<MPDType>(beta2),
+                                          static_cast<MPDType>(kernel_params.step_count[index])));
+      g = mean_hat / (sqrt(var_hat) + static_cast<MPDType>(epsilon)) +
+          kernel_params.wds[index] * w;
+    } else {
+      g = mean / (sqrt(var) + static_cast<MPDType>(epsilon)) + kernel_params.wds[index] * w;
     }
+    temp_g[kernel_params.tensor2temp_g[index] + i] = g;
   }
 };
 
 template <typename MPDType, bool has_mixed_precision>
 struct MultiLAMBKernelStep2 {
   template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                                  const float* sum_sq_weigths,
-                                  const float* sum_sq_temp_g,
-                                  const float* temp_g,
-                                  const float lower_bound,
-                                  const float upper_bound,
-                                  const OpReqType req) {
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w = has_mixed_precision ? kernel_params.weights32[index][i]
-                                        : MPDType(kernel_params.weights[index][i]);
-        float r1  = sqrt(sum_sq_weigths[index]);
-        float r2  = sqrt(sum_sq_temp_g[index]);
-        if (lower_bound >= 0)
-          r1 = std::max(r1, lower_bound);
-        if (upper_bound >= 0)
-          r1 = std::min(r1, upper_bound);
-
-        // calculate lamb_trust_ratio
-        MPDType r;
-        if (r1 == 0.0f || r2 == 0.0f)
-          r = 1.0f;
-        else
-          r = r1 / r2;
-
-        MPDType lr_adjusted = kernel_params.learning_rates[index] * r;
-        w -= lr_adjusted * temp_g[kernel_params.tensor2temp_g[index] + i];
-
-        // update weights
-        if (has_mixed_precision)
-          kernel_params.weights32[index][i] = w;
-        KERNEL_ASSIGN(kernel_params.out_data[index][i], req, w);
-      }
-    }
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
+                                         const float* sum_sq_weigths,
+                                         const float* sum_sq_temp_g,
+                                         const float* temp_g,
+                                         const float lower_bound,
+                                         const float upper_bound,
+                                         const OpReqType req) {
+    MPDType w = has_mixed_precision ? kernel_params.weights32[index][i]
+                                    : MPDType(kernel_params.weights[index][i]);
+    float r1  = sqrt(sum_sq_weigths[index]);
+    float r2  = sqrt(sum_sq_temp_g[index]);
+    if (lower_bound >= 0)
+      r1 = std::max(r1, lower_bound);
+    if (upper_bound >= 0)
+      r1 = std::min(r1, upper_bound);
+
+    // calculate lamb_trust_ratio
+    MPDType r;
+    if (r1 == 0.0f || r2 == 0.0f)
+      r = 1.0f;
+    else
+      r = r1 / r2;
+
+    MPDType lr_adjusted = kernel_params.learning_rates[index] * r;
+    w -= lr_adjusted * temp_g[kernel_params.tensor2temp_g[index] + i];
+
+    // update weights
+    if (has_mixed_precision)
+      kernel_params.weights32[index][i] = w;
+    KERNEL_ASSIGN(kernel_params.out_data[index][i], req, w);
   }
 };
 
@@ -126,17 +118,18 @@ void CallKernel1(Stream<cpu>* s,
                  float* temp_g,
                  int* block_to_tensor,
                  int* block_to_chunk) {
-  Kernel<MultiLAMBKernelStep1<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::Launch(
-      s,
-      kernel_params.max_size,
-      kernel_params,
-      param.beta1,
-      param.beta2,
-      param.epsilon,
-      param.clip_gradient,
-      param.bias_correction,
-      param.rescale_grad,
-      temp_g);
+  Kernel<MultiLAMBKernelStep1<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
+      LaunchMultiTensor(s,
+                        static_cast<int>(kernel_params.ntensors),
+                        kernel_params.sizes,
+                        kernel_params,
+                        param.beta1,
+                        param.beta2,
+                        param.epsilon,
+                        param.clip_gradient,
+                        param.bias_correction,
+                        param.rescale_grad,
+                        temp_g);
 }
 
 template <typename MPDType, typename DType>
@@ -149,16 +142,17 @@ void CallKernel2(Stream<cpu>* s,
                  int* block_to_tensor,
                  int* block_to_chunk,
                  const OpReqType req) {
-  Kernel<MultiLAMBKernelStep2<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::Launch(
-      s,
-      kernel_params.max_size,
-      kernel_params,
-      r1,
-      r2,
-      temp_g,
-      param.lower_bound,
-      param.upper_bound,
-      req);
+  Kernel<MultiLAMBKernelStep2<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
+      LaunchMultiTensor(s,
+                        static_cast<int>(kernel_params.ntensors),
+                        kernel_params.sizes,
+                        kernel_params,
+                        r1,
+                        r2,
+                        temp_g,
+                        param.lower_bound,
+                        param.upper_bound,
+                        req);
 }
 
 DMLC_REGISTER_PARAMETER(MultiLAMBParam);
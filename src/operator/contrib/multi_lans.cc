@@ -32,103 +32,97 @@ namespace op {
 template <typename MPDType, bool has_mixed_precision>
 struct MultiLANSKernelStep1 {
   template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLANSKernelParam<DType, MPDType>& kernel_params,
-                                  const float beta1,
-                                  const float beta2,
-                                  const float epsilon,
-                                  const float clip_gradient,
-                                  const float rescale_grad,
-                                  float* g_sq_norm,
-                                  float* temp_m,
-                                  float* temp_g) {
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiLANSKernelParam<DType, MPDType>& kernel_params,
+                                         const float beta1,
+                                         const float beta2,
+                                         const float epsilon,
+                                         const float clip_gradient,
+                                         const float rescale_grad,
+                                         float* g_sq_norm,
+                                         float* temp_m,
+                                         float* temp_g) {
     using namespace mshadow_op;
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w           = has_mixed_precision ? kernel_params.weights32[index][i]
-                                                  : MPDType(kernel_params.weights[index][i]);
-        float g_norm        = sqrt(g_sq_norm[index]);
-        MPDType scaled_grad = static_cast<MPDType>(kernel_params.grads[index][i]) * rescale_grad;
-        scaled_grad /= g_norm;
-        if (clip_gradient >= 0.0f)
-          scaled_grad = mshadow_op::clip::Map(scaled_grad, static_cast<MPDType>(clip_gradient));
-        MPDType mean = static_cast<MPDType>(beta1) * kernel_params.mean[index][i] +
-                       (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta1)) * scaled_grad;
-        MPDType var =
-            static_cast<MPDType>(beta2) * kernel_params.var[index][i] +
-            (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta2)) * scaled_grad * scaled_grad;
-        kernel_params.mean[index][i] = mean;
-        kernel_params.var[index][i]  = var;
+    MPDType w           = has_mixed_precision ? kernel_params.weights32[index][i]
+                                              : MPDType(kernel_params.weights[index][i]);
+    float g_norm        = sqrt(g_sq_norm[index]);
+    MPDType scaled_grad = static_cast<MPDType>(kernel_params.grads[index][i]) * rescale_grad;
+    scaled_grad /= g_norm;
+    if (clip_gradient >= 0.0f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, static_cast<MPDType>(clip_gradient));
+    MPDType mean = static_cast<MPDType>(beta1) * kernel_params.mean[index][i] +
+                   (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta1)) * scaled_grad;
+    MPDType var =
+        static_cast<MPDType>(beta2) * kernel_params.var[index][i] +
+        (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta2)) * scaled_grad * scaled_grad;
+    kernel_params.mean[index][i] = mean;
+    kernel_params.var[index][i]  = var;
 
-        MPDType m, g;
-        MPDType mean_hat =
-            mean / (static_cast<MPDType>(1.0f) -
-                    power::Map(static_cast<MPDType>(beta1),
-                               static_cast<MPDType>(kernel_params.step_count[index])));
-        MPDType var_hat  = var / (static_cast<MPDType>(1.0f) -
-                                 power::Map(static_cast<MPDType>(beta2),
-                                            static_cast<MPDType>(kernel_params.step_count[index])));
-        var_hat          = sqrt(var_hat) + static_cast<MPDType>(epsilon);
-        MPDType scaled_w = kernel_params.wds[index] * w;
-        m                = mean_hat / var_hat + scaled_w;
-        g                = scaled_grad / var_hat + scaled_w;
-        temp_m[kernel_params.tensor2temp_g[index] + i] = m;
-        temp_g[kernel_params.tensor2temp_g[index] + i] = g;
-      }
-    }
+    MPDType m, g;
+    MPDType mean_hat =
+        mean / (static_cast<MPDType>(1.0f) -
+                power::Map(static_cast<MPDType>(beta1),
+                           static_cast<MPDType>(kernel_params.step_count[index])));
+    MPDType var_hat  = var / (static_cast<MPDType>(1.0f) -
+                             power::Map(static_cast<MPDType>(beta2),
+                                        static_cast<MPDType>(kernel_params.step_count[index])));
+    var_hat          = sqrt(var_hat) + static_cast<MPDType>(epsilon);
+    MPDType scaled_w = kernel_params.wds[index] * w;
+    m                = mean_hat / var_hat + scaled_w;
+    g                = scaled_grad / var_hat + scaled_w;
+    temp_m[kernel_params.tensor2temp_g[index] + i] = m;
+    temp_g[kernel_params.tensor2temp_g[index] + i] = g;
   }
 };
 
 template <typename MPDType, bool has_mixed_precision>
 struct MultiLANSKernelStep2 {
   template <typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLANSKernelParam<DType, MPDType>& kernel_params,
-                                  const float beta1,
-                                  const float* sum_sq_weigths,
-                                  const float* sum_sq_temp_m,
-                                  const float* sum_sq_temp_g,
-                                  const float* temp_m,
-                                  const float* temp_g,
-                                  const float lower_bound,
-                                  const float upper_bound,
-                                  const OpReqType req) {
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w  = has_mixed_precision ? kernel_params.weights32[index][i]
-                                         : MPDType(kernel_params.weights[index][i]);
-        float r1   = sqrt(sum_sq_weigths[index]);
-        float r2_m = sqrt(sum_sq_temp_m[index]);
-        float r2_g = sqrt(sum_sq_temp_g[index]);
-        if (lower_bound >= 0)
-          r1 = std::max(r1, lower_bound);
-        if (upper_bound >= 0)
-          r1 = std::min(r1, upper_bound);
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiLANSKernelParam<DType, MPDType>& kernel_params,
+                                         const float beta1,
+                                         const float* sum_sq_weigths,
+                                         const float* sum_sq_temp_m,
+                                         const float* sum_sq_temp_g,
+                                         const float* temp_m,
+                                         const float* temp_g,
+                                         const float lower_bound,
+                                         const float upper_bound,
+                                         const OpReqType req) {
+    MPDType w  = has_mixed_precision ? kernel_params.weights32[index][i]
+                                     : MPDType(kernel_params.weights[index][i]);
+    float r1   = sqrt(sum_sq_weigths[index]);
+    float r2_m = sqrt(sum_sq_temp_m[index]);
+    float r2_g = sqrt(sum_sq_temp_g[index]);
+    if (lower_bound >= 0)
+      r1 = std::max(r1, lower_bound);
+    if (upper_bound >= 0)
+      r1 = std::min(r1, upper_bound);
 
-        // calculate nesterov lamb_trust_ratio
-        MPDType r_m, r_g;
-        if (r1 == 0.0f || r2_m == 0.0f)
-          r_m = 1.0f;
-        else
-          r_m = r1 / r2_m;
-        if (r1 == 0.0f || r2_g == 0.0f)
-          r_g = 1.0f;
-        else
-          r_g = r1 / r2_g;
-        r_m *= static_cast<MPDType>(beta1);
-        r_g *= (1. - static_cast<MPDType>(beta1));
+    // calculate nesterov lamb_trust_ratio
+    MPDType r_m, r_g;
+    if (r1 == 0.0f || r2_m == 0.0f)
+      r_m = 1.0f;
+    else
+      r_m = r1 / r2_m;
+    if (r1 == 0.0f || r2_g == 0.0f)
+      r_g = 1.0f;
+    else
+      r_g = r1 / r2_g;
+    r_m *= static_cast<MPDType>(beta1);
+    r_g *= (1. - static_cast<MPDType>(beta1));
 
-        MPDType lr_adjusted_m = kernel_params.learning_rates[index] * r_m;
-        MPDType lr_adjusted_g = kernel_params.learning_rates[index] * r_g;
-        w -= lr_adjusted_m * temp_m[kernel_params.tensor2temp_g[index] + i] +
-             lr_adjusted_g * temp_g[kernel_params.tensor2temp_g[index] + i];
+    MPDType lr_adjusted_m = kernel_params.learning_rates[index] * r_m;
+    MPDType lr_adjusted_g = kernel_params.learning_rates[index] * r_g;
+    w -= lr_adjusted_m * temp_m[kernel_params.tensor2temp_g[index] + i] +
+         lr_adjusted_g * temp_g[kernel_params.tensor2temp_g[index] + i];
 
-        // update weights
-        if (has_mixed_precision)
-          kernel_params.weights32[index][i] = w;
-        KERNEL_ASSIGN(kernel_params.out_data[index][i], req, w);
-      }
-    }
+    // update weights
+    if (has_mixed_precision)
+      kernel_params.weights32[index][i] = w;
+    KERNEL_ASSIGN(kernel_params.out_data[index][i], req, w);
   }
 };
 
@@ -141,18 +135,19 @@ void CallKernel1(Stream<cpu>* s,
                  float* temp_g,
                  int* block_to_tensor,
                  int* block_to_chunk) {
-  Kernel<MultiLANSKernelStep1<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::Launch(
-      s,
-      kernel_params.max_size,
-      kernel_params,
-      param.beta1,
-      param.beta2,
-      param.epsilon,
-      param.clip_gradient,
-      param.rescale_grad,
-      g_sq_norm,
-      temp_m,
-      temp_g);
+  Kernel<MultiLANSKernelStep1<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
+      LaunchMultiTensor(s,
+                        static_cast<int>(kernel_params.ntensors),
+                        kernel_params.sizes,
+                        kernel_params,
+                        param.beta1,
+                        param.beta2,
+                        param.epsilon,
+                        param.clip_gradient,
+                        param.rescale_grad,
+                        g_sq_norm,
+                        temp_m,
+                        temp_g);
 }
 
 template <typename MPDType, typename DType>
@@ -167,19 +162,20 @@ void CallKernel2(Stream<cpu>* s,
                  int* block_to_tensor,
                  int* block_to_chunk,
                  const OpReqType req) {
-  Kernel<MultiLANSKernelStep2<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::Launch(
-      s,
-      kernel_params.max_size,
-      kernel_params,
-      param.beta1,
-      r1,
-      r2_m,
-      r2_g,
-      temp_m,
-      temp_g,
-      param.lower_bound,
-      param.upper_bound,
-      req);
+  Kernel<MultiLANSKernelStep2<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
+      LaunchMultiTensor(s,
+                        static_cast<int>(kernel_params.ntensors),
+                        kernel_params.sizes,
+                        kernel_params,
+                        param.beta1,
+                        r1,
+                        r2_m,
+                        r2_g,
+                        temp_m,
+                        temp_g,
+                        param.lower_bound,
+                        param.upper_bound,
+                        req);
 }
 
 DMLC_REGISTER_PARAMETER(MultiLANSParam);
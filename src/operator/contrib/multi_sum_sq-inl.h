@@ -29,6 +29,7 @@
 #include <mxnet/operator.h>
 #include <vector>
 #include "../operator_common.h"
+#include "../multi_tensor_apply-inl.h"
 
 namespace multi_sum_sq {
 enum MultiSumSqUpdateResource { kTempSpace };
@@ -63,10 +64,11 @@ inline bool MultiSumSqShape(const NodeAttrs& attrs,
   return true;
 }
 
+template <typename ParamType>
 inline bool MultiSumSqType(const NodeAttrs& attrs,
                            std::vector<int>* in_type,
                            std::vector<int>* out_type) {
-  const auto& p = dmlc::get<MultiSumSqParam>(attrs.parsed);
+  const auto& p = dmlc::get<ParamType>(attrs.parsed);
   CHECK_EQ(in_type->size(), p.num_arrays);
   int dtype = (*in_type)[0];
   CHECK_NE(dtype, -1) << "First input must have specified type";
@@ -105,6 +107,155 @@ void MultiSumSq(const nnvm::NodeAttrs& attrs,
   MultiSumSqRun<xpu>(inputs, p.num_arrays, out_ptr, ctx, p.scale);
 }
 
+struct MultiClipGlobalNormParam : public dmlc::Parameter<MultiClipGlobalNormParam> {
+  int num_arrays;
+  float max_norm;
+
+  DMLC_DECLARE_PARAMETER(MultiClipGlobalNormParam) {
+    DMLC_DECLARE_FIELD(num_arrays).describe("number of input arrays.");
+    DMLC_DECLARE_FIELD(max_norm).describe("Maximum of the l2 norm of all the arrays");
+  }
+};
+
+struct ClipGlobalNormParam : public dmlc::Parameter<ClipGlobalNormParam> {
+  int num_arrays;
+  float max_norm;
+  float rescale_grad;
+
+  DMLC_DECLARE_PARAMETER(ClipGlobalNormParam) {
+    DMLC_DECLARE_FIELD(num_arrays).describe("number of input arrays.");
+    DMLC_DECLARE_FIELD(max_norm).describe("Maximum of the l2 norm of all the rescaled arrays");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale of the arrays, applied before the norm and included in the scale");
+  }
+};
+
+template <typename ParamType>
+inline bool MultiClipGlobalNormShape(const NodeAttrs& attrs,
+                                     std::vector<mxnet::TShape>* in_shape,
+                                     std::vector<mxnet::TShape>* out_shape) {
+  const auto& p = dmlc::get<ParamType>(attrs.parsed);
+  out_shape->resize(1);
+
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape(1, 1));
+
+  CHECK_EQ(in_shape->size(), p.num_arrays);
+  for (auto s : *in_shape) {
+    if (s.ndim() == 0)
+      return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief total norm of the arrays from their sums of squares, and the scale of the arrays.
+ *  With zero_nonfinite the scale is 0 when the norm is not finite, the skipped steps of the
+ *  optimizers reading it.
+ */
+struct MultiClipGlobalNormScaleKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  const float* sum_sq,
+                                  const int num_arrays,
+                                  const float max_norm,
+                                  const float rescale,
+                                  const bool zero_nonfinite,
+                                  float* scale,
+                                  float* total_norm) {
+    float sum = 0;
+    for (int j = 0; j < num_arrays; ++j)
+      sum += sum_sq[j];
+    const float norm  = mshadow_op::square_root::Map(sum);
+    const float ratio = max_norm / (norm + 1e-8f);
+    scale[0]          = rescale * (ratio < 1.0f ? ratio : 1.0f);
+    if (zero_nonfinite && !mshadow_op::isfinite::Map(norm))
+      scale[0] = 0.0f;
+    if (total_norm)
+      total_norm[0] = norm;
+  }
+};
+
+struct MultiTensorScaleOp {
+  static constexpr bool kHasGrad  = false;
+  static constexpr int kNumStates = 0;
+  template <typename MPDType>
+  struct Hyper {
+    /*! \brief computed on the device, the arrays are scaled without a synchronization */
+    const float* scale;
+  };
+
+  template <typename MPDType, typename Param>
+  MSHADOW_XINLINE static MPDType Map(const int index,
+                                     const index_t i,
+                                     const MPDType w,
+                                     const Param& param) {
+    return w * static_cast<MPDType>(*param.hyper.scale);
+  }
+};
+
+template <typename xpu>
+void MultiClipGlobalNorm(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  auto s        = ctx.get_stream<xpu>();
+  const auto& p = dmlc::get<MultiClipGlobalNormParam>(attrs.parsed);
+  // the sums of squares and the scale follow the storage used within MultiSumSqRun
+  const size_t pos_wspace = GetRequiredStorageMultiSumSq<xpu>(inputs);
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[multi_sum_sq::kTempSpace].get_space_typed<xpu, 1, char>(
+          Shape1(pos_wspace + (p.num_arrays + 1) * sizeof(float)), s);
+  float* sum_sq = reinterpret_cast<float*>(&workspace[pos_wspace]);
+  float* scale  = sum_sq + p.num_arrays;
+
+  MultiSumSqRun<xpu>(inputs, p.num_arrays, sum_sq, ctx);
+  Kernel<MultiClipGlobalNormScaleKernel, xpu>::Launch(
+      s, 1, sum_sq, p.num_arrays, p.max_norm, 1.0f, false, scale, outputs[0].dptr<float>());
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    using MPDType =
+        typename std::conditional<std::is_same<DType, double>::value, double, float>::type;
+    MultiTensorApply<xpu, MultiTensorScaleOp, DType, MPDType, false>(ctx,
+                                                                     inputs,
+                                                                     kWriteInplace,
+                                                                     inputs,
+                                                                     mxnet::Tuple<float>(),
+                                                                     mxnet::Tuple<float>(),
+                                                                     mxnet::Tuple<float>(),
+                                                                     1.0f,
+                                                                     -1.0f,
+                                                                     {scale});
+  });
+}
+
+template <typename xpu>
+void ClipGlobalNorm(const nnvm::NodeAttrs& attrs,
+                    const OpContext& ctx,
+                    const std::vector<TBlob>& inputs,
+                    const std::vector<OpReqType>& req,
+                    const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  auto s        = ctx.get_stream<xpu>();
+  const auto& p = dmlc::get<ClipGlobalNormParam>(attrs.parsed);
+  const size_t pos_wspace = GetRequiredStorageMultiSumSq<xpu>(inputs);
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[multi_sum_sq::kTempSpace].get_space_typed<xpu, 1, char>(
+          Shape1(pos_wspace + p.num_arrays * sizeof(float)), s);
+  float* sum_sq = reinterpret_cast<float*>(&workspace[pos_wspace]);
+
+  MultiSumSqRun<xpu>(inputs, p.num_arrays, sum_sq, ctx, p.rescale_grad);
+  Kernel<MultiClipGlobalNormScaleKernel, xpu>::Launch(s,
+                                                      1,
+                                                      sum_sq,
+                                                      p.num_arrays,
+                                                      p.max_norm,
+                                                      p.rescale_grad,
+                                                      true,
+                                                      outputs[0].dptr<float>(),
+                                                      static_cast<float*>(nullptr));
+}
+
 }  // namespace op
 }  // namespace mxnet
 
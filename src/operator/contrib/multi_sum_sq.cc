@@ -29,6 +29,8 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(MultiSumSqParam);
+DMLC_REGISTER_PARAMETER(MultiClipGlobalNormParam);
+DMLC_REGISTER_PARAMETER(ClipGlobalNormParam);
 
 NNVM_REGISTER_OP(multi_sum_sq)
     .describe(R"code(Compute the sums of squares of multiple arrays
@@ -39,7 +41,7 @@ NNVM_REGISTER_OP(multi_sum_sq)
     .set_num_outputs(1)
     .set_attr_parser(ParamParser<MultiSumSqParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", MultiSumSqShape)
-    .set_attr<nnvm::FInferType>("FInferType", MultiSumSqType)
+    .set_attr<nnvm::FInferType>("FInferType", MultiSumSqType<MultiSumSqParam>)
     .set_attr<nnvm::FListInputNames>("FListInputNames",
                                      [](const NodeAttrs& attrs) {
                                        const auto& param = dmlc::get<MultiSumSqParam>(attrs.parsed);
@@ -58,6 +60,98 @@ NNVM_REGISTER_OP(multi_sum_sq)
     .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
     .add_arguments(MultiSumSqParam::__FIELDS__());
 
+NNVM_REGISTER_OP(multi_clip_global_norm)
+    .add_alias("_npx_multi_clip_global_norm")
+    .describe(R"code(Rescales the arrays in place so that their global l2 norm is at most max_norm
+
+It computes::
+
+  total_norm = sqrt(sum(sum(square(array)) for array in arrays))
+  scale = min(max_norm / (total_norm + 1e-8), 1)
+  array *= scale for array in arrays
+
+and returns total_norm, of shape (1,). The scale stays on the device, the arrays are scaled
+without waiting for the norm, and a few launches scale all of them.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      return static_cast<uint32_t>(dmlc::get<MultiClipGlobalNormParam>(attrs.parsed).num_arrays);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<MultiClipGlobalNormParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiClipGlobalNormShape<MultiClipGlobalNormParam>)
+    .set_attr<nnvm::FInferType>("FInferType", MultiSumSqType<MultiClipGlobalNormParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const uint32_t num_args =
+                                           dmlc::get<MultiClipGlobalNormParam>(attrs.parsed)
+                                               .num_arrays;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("array_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     const uint32_t num_args =
+                                         dmlc::get<MultiClipGlobalNormParam>(attrs.parsed)
+                                             .num_arrays;
+                                     std::vector<uint32_t> ret(num_args);
+                                     for (uint32_t i = 0; i < num_args; ++i) {
+                                       ret[i] = i;
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", MultiClipGlobalNorm<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
+    .add_arguments(MultiClipGlobalNormParam::__FIELDS__());
+
+NNVM_REGISTER_OP(clip_global_norm)
+    .add_alias("_npx_clip_global_norm")
+    .describe(R"code(Computes the scale clipping the global l2 norm of the arrays to max_norm
+
+It computes::
+
+  total_norm = sqrt(sum(sum(square(rescale_grad * array)) for array in arrays))
+  scale = rescale_grad * min(max_norm / (total_norm + 1e-8), 1)
+
+and returns scale, of shape (1,), or 0 when total_norm is not finite. The arrays are not
+modified. The scale is meant to be passed as the rescale_grad of the multi-tensor optimizers,
+e.g. ``_multi_adamw_update``, which read it on the device, clip the gradients within the update
+and skip the update when the scale is 0, so that a step clipping the gradients or skipping an
+overflow of AMP never waits for the norm on the host.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      return static_cast<uint32_t>(dmlc::get<ClipGlobalNormParam>(attrs.parsed).num_arrays);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<ClipGlobalNormParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiClipGlobalNormShape<ClipGlobalNormParam>)
+    .set_attr<nnvm::FInferType>("FInferType", MultiSumSqType<ClipGlobalNormParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const uint32_t num_args =
+                                           dmlc::get<ClipGlobalNormParam>(attrs.parsed).num_arrays;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("array_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<FCompute>("FCompute<cpu>", ClipGlobalNorm<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
+    .add_arguments(ClipGlobalNormParam::__FIELDS__());
+
 template <>
 size_t GetRequiredStorageMultiSumSq<cpu>(const std::vector<TBlob>& inputs,
                                          int* param_max_chunks_per_tensor) {
@@ -208,5 +208,10 @@ void MultiSumSqRun<gpu>(const std::vector<TBlob>& inputs,
 
 NNVM_REGISTER_OP(multi_sum_sq).set_attr<FCompute>("FCompute<gpu>", MultiSumSq<gpu>);
 
+NNVM_REGISTER_OP(multi_clip_global_norm)
+    .set_attr<FCompute>("FCompute<gpu>", MultiClipGlobalNorm<gpu>);
+
+NNVM_REGISTER_OP(clip_global_norm).set_attr<FCompute>("FCompute<gpu>", ClipGlobalNorm<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file deformable_implicit_gemm.cuh
+ * \brief GPU implicit GEMM of the forward pass of (modulated) deformable convolution.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_CUH_
+#define MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_CUH_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include "../../mxnet_op.h"
+#include "../../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief filters and output pixels of the tile of a block, and the depth of a step */
+constexpr int kDeformTileM  = 64;
+constexpr int kDeformTileP  = 64;
+constexpr int kDeformTileK  = 16;
+constexpr int kDeformThread = 16;
+
+template <>
+inline index_t DeformConvImplicitGemmWorkspace<gpu>(const DeformConvGeometry& g) {
+  return 0;
+}
+
+/*!
+ * \brief One block computes a 64x64 tile of filters and output pixels of one image and
+ *  group. Each step stages a 16 deep slice of the weights and of the deformed columns in
+ *  shared memory, sampling the columns on the fly, then every thread accumulates a 4x4
+ *  sub-tile. The threads of a warp run along the output pixels, so the offset, mask and
+ *  output accesses coalesce.
+ */
+template <typename DType, typename AType>
+__global__ void __launch_bounds__(kDeformThread * kDeformThread)
+    DeformConvImplicitGemmKernel(const DeformConvGeometry g,
+                                 const DType* data,
+                                 const DType* offset,
+                                 const DType* mask,
+                                 const DType* weight,
+                                 const DType* bias,
+                                 DType* out) {
+  constexpr int kRows    = kDeformTileM / kDeformThread;
+  constexpr int kCols    = kDeformTileP / kDeformThread;
+  constexpr int kThreads = kDeformThread * kDeformThread;
+  __shared__ AType s_weight[kDeformTileK][kDeformTileM];
+  __shared__ AType s_col[kDeformTileK][kDeformTileP];
+  const int M           = g.M();
+  const int K           = g.K();
+  const int P           = g.P();
+  const int n           = blockIdx.z / g.group;
+  const int grp         = blockIdx.z % g.group;
+  const int m0          = blockIdx.y * kDeformTileM;
+  const int p0          = blockIdx.x * kDeformTileP;
+  const int tid         = threadIdx.x;
+  const int tx          = tid % kDeformThread;
+  const int ty          = tid / kDeformThread;
+  const int kernel_size = g.kernel_h * g.kernel_w;
+  const DType* data_n   = data + static_cast<index_t>(n) * g.channels * g.height * g.width;
+  const DType* offset_n =
+      offset + static_cast<index_t>(n) * g.deformable_group * 2 * kernel_size * P;
+  const DType* mask_n =
+      mask == nullptr ? nullptr
+                      : mask + static_cast<index_t>(n) * g.deformable_group * kernel_size * P;
+  const DType* weight_g = weight + static_cast<index_t>(grp) * M * K;
+
+  AType acc[kRows][kCols];
+#pragma unroll
+  for (int r = 0; r < kRows; ++r) {
+#pragma unroll
+    for (int c = 0; c < kCols; ++c)
+      acc[r][c] = 0;
+  }
+  for (int k0 = 0; k0 < K; k0 += kDeformTileK) {
+    for (int e = tid; e < kDeformTileK * kDeformTileM; e += kThreads) {
+      const int mm     = e / kDeformTileK;
+      const int kk     = e % kDeformTileK;
+      s_weight[kk][mm] = (m0 + mm < M && k0 + kk < K) ?
+                             static_cast<AType>(weight_g[(m0 + mm) * K + k0 + kk]) :
+                             AType(0);
+    }
+    for (int e = tid; e < kDeformTileK * kDeformTileP; e += kThreads) {
+      const int kk  = e / kDeformTileP;
+      const int pp  = e % kDeformTileP;
+      s_col[kk][pp] = (k0 + kk < K && p0 + pp < P) ?
+                          DeformConvSample<AType>(
+                              data_n, offset_n, mask_n, g, grp, k0 + kk, p0 + pp) :
+                          AType(0);
+    }
+    __syncthreads();
+#pragma unroll
+    for (int kk = 0; kk < kDeformTileK; ++kk) {
+      AType a[kRows];
+      AType b[kCols];
+#pragma unroll
+      for (int r = 0; r < kRows; ++r)
+        a[r] = s_weight[kk][ty + r * kDeformThread];
+#pragma unroll
+      for (int c = 0; c < kCols; ++c)
+        b[c] = s_col[kk][tx + c * kDeformThread];
+#pragma unroll
+      for (int r = 0; r < kRows; ++r) {
+#pragma unroll
+        for (int c = 0; c < kCols; ++c)
+          acc[r][c] += a[r] * b[c];
+      }
+    }
+    __syncthreads();
+  }
+#pragma unroll
+  for (int r = 0; r < kRows; ++r) {
+    const int m = m0 + ty + r * kDeformThread;
+    if (m >= M)
+      continue;
+    const int f    = grp * M + m;
+    const AType b  = bias == nullptr ? AType(0) : static_cast<AType>(bias[f]);
+    DType* out_row = out + (static_cast<index_t>(n) * g.num_filter + f) * P;
+#pragma unroll
+    for (int c = 0; c < kCols; ++c) {
+      const int p = p0 + tx + c * kDeformThread;
+      if (p < P)
+        out_row[p] = static_cast<DType>(acc[r][c] + b);
+    }
+  }
+}
+
+template <typename DType>
+inline void DeformConvImplicitGemmForward(mshadow::Stream<gpu>* s,
+                                          const DeformConvGeometry& g,
+                                          const DType* data,
+                                          const DType* offset,
+                                          const DType* mask,
+                                          const DType* weight,
+                                          const DType* bias,
+                                          DType* out,
+                                          DType* workspace) {
+  typedef typename mxnet_op::AccType<DType>::type AType;
+  CHECK_LT(g.channels * g.height * g.width, INT32_MAX)
+      << "The implicit GEMM of deformable convolution does not support images of 2^31 elements";
+  // the images and groups of a launch are the z dimension of the grid
+  const index_t images = std::max<index_t>(1, 65535 / g.group);
+  for (index_t n0 = 0; n0 < g.num; n0 += images) {
+    const index_t kernel_size = g.kernel_h * g.kernel_w;
+    DeformConvGeometry chunk  = g;
+    chunk.num                 = std::min(images, g.num - n0);
+    dim3 blocks((g.P() + kDeformTileP - 1) / kDeformTileP,
+                (g.M() + kDeformTileM - 1) / kDeformTileM,
+                chunk.num * g.group);
+    DeformConvImplicitGemmKernel<DType, AType>
+        <<<blocks, kDeformThread * kDeformThread, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+            chunk,
+            data + n0 * g.channels * g.height * g.width,
+            offset + n0 * g.deformable_group * 2 * kernel_size * g.P(),
+            mask == nullptr ? nullptr : mask + n0 * g.deformable_group * kernel_size * g.P(),
+            weight,
+            bias,
+            out + n0 * g.num_filter * g.P());
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(DeformConvImplicitGemmKernel);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_CUH_
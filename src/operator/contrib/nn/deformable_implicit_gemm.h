@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file deformable_implicit_gemm.h
+ * \brief Forward pass of (modulated) deformable convolution as an implicit GEMM, which
+ *  samples the deformed columns while multiplying instead of materializing them.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_H_
+#define MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <cmath>
+#include "../../mxnet_op.h"
+#include "../../linalg.h"
+#include "../../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief whether the forward pass of deformable convolution uses the implicit GEMM
+ *  instead of the deformable im2col column buffer.
+ */
+inline bool DeformableConvImplicitGemm() {
+  return dmlc::GetEnv("MXNET_DEFORMABLE_CONV_IMPLICIT_GEMM", true);
+}
+
+/*! \brief geometry of a 2-D deformable convolution in NCHW layout */
+struct DeformConvGeometry {
+  index_t num;
+  index_t channels;
+  index_t height;
+  index_t width;
+  index_t out_h;
+  index_t out_w;
+  index_t kernel_h;
+  index_t kernel_w;
+  index_t pad_h;
+  index_t pad_w;
+  index_t stride_h;
+  index_t stride_w;
+  index_t dilate_h;
+  index_t dilate_w;
+  index_t num_filter;
+  index_t group;
+  index_t deformable_group;
+
+  /*! \brief rows of the GEMM: filters per group */
+  MSHADOW_XINLINE index_t M() const {
+    return num_filter / group;
+  }
+  /*! \brief depth of the GEMM: input channels per group times kernel size */
+  MSHADOW_XINLINE index_t K() const {
+    return channels / group * kernel_h * kernel_w;
+  }
+  /*! \brief columns of the GEMM: output pixels */
+  MSHADOW_XINLINE index_t P() const {
+    return out_h * out_w;
+  }
+};
+
+template <typename Param>
+inline DeformConvGeometry GetDeformConvGeometry(const Param& param,
+                                                const mxnet::TShape& dshape,
+                                                const mxnet::TShape& oshape) {
+  DeformConvGeometry g;
+  g.num              = dshape[0];
+  g.channels         = dshape[1];
+  g.height           = dshape[2];
+  g.width            = dshape[3];
+  g.out_h            = oshape[2];
+  g.out_w            = oshape[3];
+  g.kernel_h         = param.kernel[0];
+  g.kernel_w         = param.kernel[1];
+  g.pad_h            = param.pad[0];
+  g.pad_w            = param.pad[1];
+  g.stride_h         = param.stride[0];
+  g.stride_w         = param.stride[1];
+  g.dilate_h         = param.dilate[0];
+  g.dilate_w         = param.dilate[1];
+  g.num_filter       = param.num_filter;
+  g.group            = param.num_group;
+  g.deformable_group = param.num_deformable_group;
+  return g;
+}
+
+/*!
+ * \brief Sample of the deformed column k of the GEMM of group grp at output pixel p.
+ *  With a mask the sampling follows modulated deformable convolution, which reads zeros
+ *  outside of the image, otherwise it follows deformable convolution, which clamps.
+ * \param data input image of the batch element
+ * \param offset offsets of the batch element
+ * \param mask mask of the batch element, or nullptr
+ */
+template <typename AType, typename DType>
+MSHADOW_XINLINE AType DeformConvSample(const DType* data,
+                                       const DType* offset,
+                                       const DType* mask,
+                                       const DeformConvGeometry& g,
+                                       index_t grp,
+                                       index_t k,
+                                       index_t p) {
+  const index_t kernel_size = g.kernel_h * g.kernel_w;
+  const index_t c           = grp * (g.channels / g.group) + k / kernel_size;
+  const index_t ij          = k % kernel_size;
+  const index_t dg          = c / (g.channels / g.deformable_group);
+  const index_t out_size    = g.P();
+  const index_t h_base = (p / g.out_w) * g.stride_h - g.pad_h + (ij / g.kernel_w) * g.dilate_h;
+  const index_t w_base = (p % g.out_w) * g.stride_w - g.pad_w + (ij % g.kernel_w) * g.dilate_w;
+  const DType* off     = offset + (dg * 2 * kernel_size + 2 * ij) * out_size + p;
+  const AType h        = h_base + static_cast<AType>(off[0]);
+  const AType w        = w_base + static_cast<AType>(off[out_size]);
+  const DType* im      = data + c * g.height * g.width;
+  if (mask != nullptr) {
+    if (h <= -1 || w <= -1 || h >= g.height || w >= g.width)
+      return AType(0);
+    const index_t h_low = static_cast<index_t>(floor(h));
+    const index_t w_low = static_cast<index_t>(floor(w));
+    const AType lh      = h - h_low;
+    const AType lw      = w - w_low;
+    AType val           = 0;
+    if (h_low >= 0 && w_low >= 0)
+      val += (1 - lh) * (1 - lw) * static_cast<AType>(im[h_low * g.width + w_low]);
+    if (h_low >= 0 && w_low + 1 < g.width)
+      val += (1 - lh) * lw * static_cast<AType>(im[h_low * g.width + w_low + 1]);
+    if (h_low + 1 < g.height && w_low >= 0)
+      val += lh * (1 - lw) * static_cast<AType>(im[(h_low + 1) * g.width + w_low]);
+    if (h_low + 1 < g.height && w_low + 1 < g.width)
+      val += lh * lw * static_cast<AType>(im[(h_low + 1) * g.width + w_low + 1]);
+    return val * static_cast<AType>(mask[(dg * kernel_size + ij) * out_size + p]);
+  }
+  if (h < 0 || w < 0 || h >= g.height || w >= g.width)
+    return AType(0);
+  const index_t h_low = static_cast<index_t>(floor(h));
+  const index_t w_low = static_cast<index_t>(floor(w));
+  // the last row and column are clamped to the border
+  const index_t h_high = h_low >= g.height - 1 ? h_low : h_low + 1;
+  const index_t w_high = w_low >= g.width - 1 ? w_low : w_low + 1;
+  const AType lh       = h_low >= g.height - 1 ? AType(0) : h - h_low;
+  const AType lw       = w_low >= g.width - 1 ? AType(0) : w - w_low;
+  return (1 - lh) * (1 - lw) * static_cast<AType>(im[h_low * g.width + w_low]) +
+         (1 - lh) * lw * static_cast<AType>(im[h_low * g.width + w_high]) +
+         lh * (1 - lw) * static_cast<AType>(im[h_high * g.width + w_low]) +
+         lh * lw * static_cast<AType>(im[h_high * g.width + w_high]);
+}
+
+/*! \brief number of output pixels per block of the CPU implicit GEMM */
+inline index_t DeformConvCPUBlock(const DeformConvGeometry& g) {
+  // keep the sampled block of the columns within the L2 cache
+  const index_t kBlockElems = 1 << 16;
+  const index_t block       = kBlockElems / std::max<index_t>(1, g.K());
+  return std::max<index_t>(16, std::min<index_t>(g.P(), block));
+}
+
+/*! \brief temp space in elements needed by DeformConvImplicitGemmForward */
+template <typename xpu>
+inline index_t DeformConvImplicitGemmWorkspace(const DeformConvGeometry& g);
+
+template <>
+inline index_t DeformConvImplicitGemmWorkspace<cpu>(const DeformConvGeometry& g) {
+  return g.K() * DeformConvCPUBlock(g);
+}
+
+/*!
+ * \brief out = conv(data, offset, mask, weight) + bias without a column buffer.
+ *  The CPU version samples one block of output pixels at a time into workspace,
+ *  which stays in cache, and multiplies it with BLAS.
+ * \param mask nullptr for deformable convolution
+ * \param bias nullptr without bias
+ */
+template <typename DType>
+inline void DeformConvImplicitGemmForward(mshadow::Stream<cpu>* s,
+                                          const DeformConvGeometry& g,
+                                          const DType* data,
+                                          const DType* offset,
+                                          const DType* mask,
+                                          const DType* weight,
+                                          const DType* bias,
+                                          DType* out,
+                                          DType* workspace) {
+  using namespace mshadow;
+  typedef typename mxnet_op::AccType<DType>::type AType;
+  const index_t M           = g.M();
+  const index_t K           = g.K();
+  const index_t P           = g.P();
+  const index_t block       = DeformConvCPUBlock(g);
+  const index_t kernel_size = g.kernel_h * g.kernel_w;
+  const index_t data_dim    = g.channels * g.height * g.width;
+  const index_t offset_dim  = g.deformable_group * 2 * kernel_size * P;
+  const index_t mask_dim    = g.deformable_group * kernel_size * P;
+  const int omp_threads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  for (index_t n = 0; n < g.num; ++n) {
+    const DType* data_n   = data + n * data_dim;
+    const DType* offset_n = offset + n * offset_dim;
+    const DType* mask_n   = mask == nullptr ? nullptr : mask + n * mask_dim;
+    for (index_t grp = 0; grp < g.group; ++grp) {
+      Tensor<cpu, 2, DType> weight_g(const_cast<DType*>(weight) + grp * M * K, Shape2(M, K), s);
+      DType* out_g = out + (n * g.num_filter + grp * M) * P;
+      for (index_t p0 = 0; p0 < P; p0 += block) {
+        const index_t cols = std::min(block, P - p0);
+#pragma omp parallel for num_threads(omp_threads)
+        for (index_t k = 0; k < K; ++k) {
+          for (index_t p = 0; p < cols; ++p) {
+            workspace[k * cols + p] = static_cast<DType>(
+                DeformConvSample<AType>(data_n, offset_n, mask_n, g, grp, k, p0 + p));
+          }
+        }
+        Tensor<cpu, 2, DType> col(workspace, Shape2(K, cols), s);
+        Tensor<cpu, 2, DType> out_block(out_g + p0, Shape2(M, cols), P, s);
+        linalg_gemm(weight_g, col, out_block, false, false, s, kWriteTo);
+        if (bias != nullptr) {
+          for (index_t m = 0; m < M; ++m) {
+            const DType b = bias[grp * M + m];
+            for (index_t p = 0; p < cols; ++p)
+              out_g[m * P + p0 + p] += b;
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+#ifdef __CUDACC__
+#include "./deformable_implicit_gemm.cuh"
+#endif
+#endif  // MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_IMPLICIT_GEMM_H_
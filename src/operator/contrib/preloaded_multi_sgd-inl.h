@@ -32,6 +32,7 @@
 #include <nnvm/op.h>
 #include <nnvm/op_attr_types.h>
 #include <vector>
+#include "../all_finite-inl.h"
 #include "../operator_common.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
@@ -46,6 +47,7 @@ struct PreloadedMultiSGDParam : public dmlc::Parameter<PreloadedMultiSGDParam> {
   float rescale_grad;
   float clip_gradient;
   int num_weights;
+  bool with_amp_state;
   DMLC_DECLARE_PARAMETER(PreloadedMultiSGDParam) {
     DMLC_DECLARE_FIELD(rescale_grad)
         .set_default(1.0f)
@@ -57,6 +59,12 @@ struct PreloadedMultiSGDParam : public dmlc::Parameter<PreloadedMultiSGDParam> {
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
     DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+    DMLC_DECLARE_FIELD(with_amp_state)
+        .set_default(false)
+        .describe(
+            "Whether the last input is the state of the dynamic loss scaling of AMP. The "
+            "gradients are then divided by its loss scale, and the weights are only updated "
+            "when its gradients are finite.");
   }
 };
 
@@ -65,6 +73,7 @@ struct PreloadedMultiSGDMomParam : public dmlc::Parameter<PreloadedMultiSGDMomPa
   float rescale_grad;
   float clip_gradient;
   int num_weights;
+  bool with_amp_state;
   DMLC_DECLARE_PARAMETER(PreloadedMultiSGDMomParam) {
     DMLC_DECLARE_FIELD(momentum).set_default(0.0f).describe(
         "The decay rate of momentum estimates at each epoch.");
@@ -78,6 +87,12 @@ struct PreloadedMultiSGDMomParam : public dmlc::Parameter<PreloadedMultiSGDMomPa
             "If clip_gradient <= 0, gradient clipping is turned off. "
             "grad = max(min(grad, clip_gradient), -clip_gradient).");
     DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+    DMLC_DECLARE_FIELD(with_amp_state)
+        .set_default(false)
+        .describe(
+            "Whether the last input is the state of the dynamic loss scaling of AMP. The "
+            "gradients are then divided by its loss scale, and the weights are only updated "
+            "when its gradients are finite.");
   }
 };
 
@@ -86,8 +101,10 @@ inline bool PreloadedMultiSGDShape(const nnvm::NodeAttrs& attrs,
                                    std::vector<mxnet::TShape>* in_attrs,
                                    std::vector<mxnet::TShape>* out_attrs) {
   const ParamType& param = dmlc::get<ParamType>(attrs.parsed);
-  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights + 2);
+  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights + 2 + param.with_amp_state);
   CHECK_EQ(out_attrs->size(), param.num_weights);
+  if (param.with_amp_state)
+    SHAPE_ASSIGN_CHECK(*in_attrs, in_attrs->size() - 1, mxnet::TShape(1, kAMPStateSize));
 
   bool all_inferred   = true;
   auto& input_shapes  = *in_attrs;
@@ -119,8 +136,10 @@ inline bool MP_PreloadedMultiSGD_InferType(const nnvm::NodeAttrs& attrs,
                                            std::vector<int>* in_attrs,
                                            std::vector<int>* out_attrs) {
   const ParamType& param = dmlc::get<ParamType>(attrs.parsed);
-  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights + 2);
+  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights + 2 + param.with_amp_state);
   CHECK_EQ(out_attrs->size(), param.num_weights);
+  if (param.with_amp_state)
+    TYPE_ASSIGN_CHECK(*in_attrs, in_attrs->size() - 1, mshadow::kFloat32);
 
   bool all_inferred  = true;
   auto& input_types  = *in_attrs;
@@ -159,6 +178,8 @@ struct PreloadedMultiSGDKernelParam {
   DType* out_data[N];
   float* lrs;
   float* wds;
+  /*! \brief the AMP state of the update, nullptr without dynamic loss scaling */
+  const float* amp_state;
   MPDType clip_gradient;
   MPDType rescale_grad;
   MPDType momentum;
@@ -172,29 +193,45 @@ struct PreloadedMultiSGDKernel {
                                   const OpReqType req) {
     for (int index = 0; index < param.count; ++index) {
       if ((size_t)i < param.sizes[index]) {
-        MPDType w =
-            has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
-        MPDType mom = has_momentum ? param.mom[index][i] : MPDType(0);
-        if (param.clip_gradient >= 0.0f) {
-          mom = param.momentum * mom - param.lrs[index] * param.wds[index] * w -
-                param.lrs[index] *
-                    mshadow_op::clip::Map(
-                        param.rescale_grad * static_cast<MPDType>(param.grads[index][i]),
-                        param.clip_gradient);
-        } else {
-          mom = param.momentum * mom - param.lrs[index] * param.wds[index] * w -
-                param.lrs[index] * param.rescale_grad * static_cast<MPDType>(param.grads[index][i]);
-        }
-        if (has_momentum) {
-          param.mom[index][i] = mom;
-        }
-        w = w + mom;
-        if (has_mixed_precision) {
-          param.weights32[index][i] = w;
-        }
-        KERNEL_ASSIGN(param.out_data[index][i], req, w);
+        MapElement(index, i, param, req);
+      }
+    }
+  }
+
+  template <typename DType>
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const PreloadedMultiSGDKernelParam<DType, MPDType>& param,
+                                         const OpReqType req) {
+    MPDType rescale_grad = param.rescale_grad;
+    if (param.amp_state != nullptr) {
+      // the step is skipped when a gradient overflowed
+      if (param.amp_state[kAMPFinite] == 0) {
+        KERNEL_ASSIGN(param.out_data[index][i], req, param.weights[index][i]);
+        return;
       }
+      rescale_grad /= param.amp_state[kAMPLossScale];
+    }
+    MPDType w =
+        has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
+    MPDType mom = has_momentum ? param.mom[index][i] : MPDType(0);
+    if (param.clip_gradient >= 0.0f) {
+      mom = param.momentum * mom - param.lrs[index] * param.wds[index] * w -
+            param.lrs[index] *
+                mshadow_op::clip::Map(rescale_grad * static_cast<MPDType>(param.grads[index][i]),
+                                      param.clip_gradient);
+    } else {
+      mom = param.momentum * mom - param.lrs[index] * param.wds[index] * w -
+            param.lrs[index] * rescale_grad * static_cast<MPDType>(param.grads[index][i]);
+    }
+    if (has_momentum) {
+      param.mom[index][i] = mom;
+    }
+    w = w + mom;
+    if (has_mixed_precision) {
+      param.weights32[index][i] = w;
     }
+    KERNEL_ASSIGN(param.out_data[index][i], req, w);
   }
 };
 
@@ -236,6 +273,7 @@ PreloadedMultiSGDKernelParam<DType, MPDType> FillPreloadedMultiSGDKernelParam(
   const int wds_idx = param.count * input_stride + 1;
   param.lrs         = inputs[lrs_idx].FlatTo2D<xpu, float>(s).dptr_;
   param.wds         = inputs[wds_idx].FlatTo2D<xpu, float>(s).dptr_;
+  param.amp_state   = p.with_amp_state ? inputs[wds_idx + 1].dptr<float>() : nullptr;
   return param;
 }
 
@@ -288,7 +326,7 @@ inline void PreloadedMultiSGDUpdate(const nnvm::NodeAttrs& attrs,
         FillPreloadedMultiSGDKernelParam<xpu, DType, MPDType, PreloadedMultiSGDParam, input_stride>(
             attrs, ctx, inputs, outputs);
     Kernel<PreloadedMultiSGDKernel<MPDType, false, !std::is_same<DType, MPDType>::value>,
-           xpu>::Launch(s, param.max_size, param, req[0]);
+           xpu>::LaunchMultiTensor(s, param.count, param.sizes, param, req[0]);
   });
 }
 
@@ -306,7 +344,7 @@ inline void PreloadedMultiSGDMomUpdate(const nnvm::NodeAttrs& attrs,
         FillPreloadedMultiSGDMomKernelParam<xpu, DType, MPDType, input_stride>(
             attrs, ctx, inputs, outputs);
     Kernel<PreloadedMultiSGDKernel<MPDType, true, !std::is_same<DType, MPDType>::value>,
-           xpu>::Launch(s, param.max_size, param, req[0]);
+           xpu>::LaunchMultiTensor(s, param.count, param.sizes, param, req[0]);
   });
 }
 
@@ -41,7 +41,7 @@ It updates the weights using::
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
-      return static_cast<uint32_t>(param.num_weights * 2 + 2);
+      return static_cast<uint32_t>(param.num_weights * 2 + 2 + param.with_amp_state);
     })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
@@ -54,7 +54,8 @@ It updates the weights using::
     .set_attr<nnvm::FListInputNames>(
         "FListInputNames",
         [](const NodeAttrs& attrs) {
-          uint32_t num_args = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed).num_weights;
+          const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
+          uint32_t num_args = param.num_weights;
           std::vector<std::string> ret;
           ret.reserve(num_args * 2 + 2);
           for (uint32_t i = 0; i < num_args; ++i) {
@@ -63,6 +64,8 @@ It updates the weights using::
           }
           ret.emplace_back("lrs");
           ret.emplace_back("wds");
+          if (param.with_amp_state)
+            ret.emplace_back("amp_state");
           return ret;
         })
     .set_attr<FCompute>("FCompute<cpu>", PreloadedMultiSGDUpdate<cpu, preloaded_type_identity, 2>)
@@ -93,7 +96,7 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
-      return static_cast<uint32_t>(param.num_weights * 3 + 2);
+      return static_cast<uint32_t>(param.num_weights * 3 + 2 + param.with_amp_state);
     })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
@@ -107,7 +110,9 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
     .set_attr<nnvm::FListInputNames>(
         "FListInputNames",
         [](const NodeAttrs& attrs) {
-          uint32_t num_args = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed).num_weights;
+          const PreloadedMultiSGDMomParam& param =
+              dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
+          uint32_t num_args = param.num_weights;
           std::vector<std::string> ret;
           ret.reserve(num_args * 3 + 2);
           for (uint32_t i = 0; i < num_args; ++i) {
@@ -117,6 +122,8 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
           }
           ret.emplace_back("lrs");
           ret.emplace_back("wds");
+          if (param.with_amp_state)
+            ret.emplace_back("amp_state");
           return ret;
         })
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
@@ -148,7 +155,7 @@ It updates the weights using::
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
-      return static_cast<uint32_t>(param.num_weights * 3 + 2);
+      return static_cast<uint32_t>(param.num_weights * 3 + 2 + param.with_amp_state);
     })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
@@ -161,7 +168,8 @@ It updates the weights using::
     .set_attr<nnvm::FListInputNames>(
         "FListInputNames",
         [](const NodeAttrs& attrs) {
-          uint32_t num_args = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed).num_weights;
+          const PreloadedMultiSGDParam& param = dmlc::get<PreloadedMultiSGDParam>(attrs.parsed);
+          uint32_t num_args = param.num_weights;
           std::vector<std::string> ret;
           ret.reserve(num_args * 3 + 2);
           for (uint32_t i = 0; i < num_args; ++i) {
@@ -171,6 +179,8 @@ It updates the weights using::
           }
           ret.emplace_back("lrs");
           ret.emplace_back("wds");
+          if (param.with_amp_state)
+            ret.emplace_back("amp_state");
           return ret;
         })
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
@@ -214,7 +224,7 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
 )code" ADD_FILELINE)
     .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
-      return static_cast<uint32_t>(param.num_weights * 4 + 2);
+      return static_cast<uint32_t>(param.num_weights * 4 + 2 + param.with_amp_state);
     })
     .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
       const PreloadedMultiSGDMomParam& param = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
@@ -228,7 +238,9 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
     .set_attr<nnvm::FListInputNames>(
         "FListInputNames",
         [](const NodeAttrs& attrs) {
-          uint32_t num_args = dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed).num_weights;
+          const PreloadedMultiSGDMomParam& param =
+              dmlc::get<PreloadedMultiSGDMomParam>(attrs.parsed);
+          uint32_t num_args = param.num_weights;
           std::vector<std::string> ret;
           ret.reserve(num_args * 4 + 2);
           for (uint32_t i = 0; i < num_args; ++i) {
@@ -239,6 +251,8 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
           }
           ret.emplace_back("lrs");
           ret.emplace_back("wds");
+          if (param.with_amp_state)
+            ret.emplace_back("amp_state");
           return ret;
         })
     .set_attr<nnvm::FMutateInputs>("FMutateInputs",
@@ -46,6 +46,7 @@ struct ROIAlignParam : public dmlc::Parameter<ROIAlignParam> {
   int sample_ratio;
   bool position_sensitive;
   bool aligned;
+  int layout;
   DMLC_DECLARE_PARAMETER(ROIAlignParam) {
     DMLC_DECLARE_FIELD(pooled_size)
         .set_expect_ndim(2)
@@ -68,6 +69,13 @@ struct ROIAlignParam : public dmlc::Parameter<ROIAlignParam> {
     DMLC_DECLARE_FIELD(aligned).set_default(false).describe(
         "Center-aligned ROIAlign introduced in Detectron2. "
         "To enable, set aligned to True.");
+    DMLC_DECLARE_FIELD(layout)
+        .add_enum("NCHW", mshadow::kNCHW)
+        .add_enum("NHWC", mshadow::kNHWC)
+        .set_default(mshadow::kNCHW)
+        .describe(
+            "Layout of data and output. With NHWC the bilinear weights of a sampling point "
+            "are shared by the contiguous channels.");
   }
 };
 
@@ -133,12 +133,67 @@ void pre_calc_for_bilinear_interpolate(const int height,
   }
 }
 
+/*!
+ * \brief computes the sampling grid of a roi, returns false if the roi is ignored
+ */
 template <typename T>
-void ROIAlignForward(const int nthreads,
+bool roi_align_grid(const T* roi,
+                    const int roi_cols,
+                    const T& spatial_scale,
+                    const bool continuous_coordinate,
+                    const int pooled_height,
+                    const int pooled_width,
+                    const int sampling_ratio,
+                    int* roi_batch_ind,
+                    T* roi_start_h,
+                    T* roi_start_w,
+                    T* bin_size_h,
+                    T* bin_size_w,
+                    int* roi_bin_grid_h,
+                    int* roi_bin_grid_w) {
+  // roi could have 4 or 5 columns
+  *roi_batch_ind = 0;
+  if (roi_cols == 5) {
+    *roi_batch_ind = roi[0];
+    if (*roi_batch_ind < 0)
+      return false;
+    roi++;
+  }
+
+  // Do not using rounding; this implementation detail is critical
+  T roi_offset = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
+  *roi_start_w = roi[0] * spatial_scale - roi_offset;
+  *roi_start_h = roi[1] * spatial_scale - roi_offset;
+  T roi_end_w  = roi[2] * spatial_scale - roi_offset;
+  T roi_end_h  = roi[3] * spatial_scale - roi_offset;
+
+  T roi_width  = roi_end_w - *roi_start_w;
+  T roi_height = roi_end_h - *roi_start_h;
+  if (continuous_coordinate) {
+    CHECK_GT(roi_width, 0.);
+    CHECK_GT(roi_height, 0.);
+  } else {  // backward compatiblity
+    // Force malformed ROIs to be 1x1
+    roi_width  = std::max(roi_width, (T)1.);
+    roi_height = std::max(roi_height, (T)1.);
+  }
+  *bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+  *bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+
+  // We use roi_bin_grid to sample the grid and mimic integral
+  *roi_bin_grid_h =
+      (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_height / pooled_height);  // e.g., = 2
+  *roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_width / pooled_width);
+  return true;
+}
+
+template <typename T>
+void ROIAlignForward(const int n_rois,
                      const T* bottom_data,
                      const T& spatial_scale,
                      const bool position_sensitive,
                      const bool continuous_coordinate,
+                     const bool nhwc,
                      const int channels,
                      const int height,
                      const int width,
@@ -150,58 +205,40 @@ void ROIAlignForward(const int nthreads,
                      T* top_data) {
   DCHECK(roi_cols == 4 || roi_cols == 5);
 
-  int n_rois = nthreads / channels / pooled_width / pooled_height;
+  const int roi_size          = channels * pooled_width * pooled_height;
+  const int channels_unpooled = position_sensitive ? roi_size : channels;
   // (n, c, ph, pw) is an element in the pooled output
   // can be parallelized using omp
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
   for (int n = 0; n < n_rois; n++) {
-    int index_n = n * channels * pooled_width * pooled_height;
-
-    // roi could have 4 or 5 columns
-    const T* offset_bottom_rois = bottom_rois + n * roi_cols;
-    int roi_batch_ind           = 0;
-    if (roi_cols == 5) {
-      roi_batch_ind = offset_bottom_rois[0];
-      if (roi_batch_ind < 0) {
-        top_data[n] = 0;
-        continue;
-      }
-      offset_bottom_rois++;
-    }
-
-    // Do not using rounding; this implementation detail is critical
-    T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
-    T roi_start_w = offset_bottom_rois[0] * spatial_scale - roi_offset;
-    T roi_start_h = offset_bottom_rois[1] * spatial_scale - roi_offset;
-    T roi_end_w   = offset_bottom_rois[2] * spatial_scale - roi_offset;
-    T roi_end_h   = offset_bottom_rois[3] * spatial_scale - roi_offset;
-
-    T roi_width  = roi_end_w - roi_start_w;
-    T roi_height = roi_end_h - roi_start_h;
-    if (continuous_coordinate) {
-      CHECK_GT(roi_width, 0.);
-      CHECK_GT(roi_height, 0.);
-    } else {  // backward compatiblity
-      // Force malformed ROIs to be 1x1
-      roi_width  = std::max(roi_width, (T)1.);
-      roi_height = std::max(roi_height, (T)1.);
+    T* roi_top_data = top_data + n * roi_size;
+    int roi_batch_ind, roi_bin_grid_h, roi_bin_grid_w;
+    T roi_start_h, roi_start_w, bin_size_h, bin_size_w;
+    if (!roi_align_grid(bottom_rois + n * roi_cols,
+                        roi_cols,
+                        spatial_scale,
+                        continuous_coordinate,
+                        pooled_height,
+                        pooled_width,
+                        sampling_ratio,
+                        &roi_batch_ind,
+                        &roi_start_h,
+                        &roi_start_w,
+                        &bin_size_h,
+                        &bin_size_w,
+                        &roi_bin_grid_h,
+                        &roi_bin_grid_w)) {
+      std::fill(roi_top_data, roi_top_data + roi_size, static_cast<T>(0));
+      continue;
     }
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h =
-        (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_height / pooled_height);  // e.g., = 2
-    int roi_bin_grid_w =
-        (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_width / pooled_width);
 
     // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
+    const int num_samples = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
+    const T count         = num_samples;
 
     // we want to precalculate indeces and weights shared by all chanels,
     // this is the key point of optimiation
-    std::vector<PreCalc<T>> pre_calc(roi_bin_grid_h * roi_bin_grid_w * pooled_width *
-                                     pooled_height);
+    std::vector<PreCalc<T>> pre_calc(num_samples * pooled_width * pooled_height);
     pre_calc_for_bilinear_interpolate(height,
                                       width,
                                       pooled_height,
@@ -216,20 +253,42 @@ void ROIAlignForward(const int nthreads,
                                       roi_bin_grid_w,
                                       &pre_calc);
 
+    if (nhwc) {
+      // The channels of a sampling point are contiguous, they are interpolated together.
+      const T* batch_data = bottom_data + roi_batch_ind * height * width * channels_unpooled;
+      const int c_stride  = position_sensitive ? pooled_height * pooled_width : 1;
+      for (int bin = 0; bin < pooled_height * pooled_width; bin++) {
+        T* out                      = roi_top_data + bin * channels;
+        const T* offset_bottom_data = batch_data + (position_sensitive ? bin : 0);
+        std::fill(out, out + channels, static_cast<T>(0));
+        for (int k = 0; k < num_samples; k++) {
+          const PreCalc<T>& pc = pre_calc[bin * num_samples + k];
+          const T* d1          = offset_bottom_data + pc.pos1 * channels_unpooled;
+          const T* d2          = offset_bottom_data + pc.pos2 * channels_unpooled;
+          const T* d3          = offset_bottom_data + pc.pos3 * channels_unpooled;
+          const T* d4          = offset_bottom_data + pc.pos4 * channels_unpooled;
+#pragma omp simd
+          for (int c = 0; c < channels; c++) {
+            out[c] += pc.w1 * d1[c * c_stride] + pc.w2 * d2[c * c_stride] +
+                      pc.w3 * d3[c * c_stride] + pc.w4 * d4[c * c_stride];
+          }
+        }
+        for (int c = 0; c < channels; c++)
+          out[c] /= count;
+      }
+      continue;
+    }
+
     for (int c = 0; c < channels; c++) {
-      int index_n_c      = index_n + c * pooled_width * pooled_height;
+      int index_n_c      = c * pooled_width * pooled_height;
       int pre_calc_index = 0;
 
       for (int ph = 0; ph < pooled_height; ph++) {
         for (int pw = 0; pw < pooled_width; pw++) {
           int index = index_n_c + ph * pooled_width + pw;
 
-          int c_unpooled        = c;
-          int channels_unpooled = channels;
-          if (position_sensitive) {
-            c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
-            channels_unpooled = channels * pooled_height * pooled_width;
-          }
+          const int c_unpooled =
+              position_sensitive ? c * pooled_height * pooled_width + ph * pooled_width + pw : c;
           const T* offset_bottom_data =
               bottom_data + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
           T output_val = 0.;
@@ -245,7 +304,7 @@ void ROIAlignForward(const int nthreads,
           }
           output_val /= count;
 
-          top_data[index] = output_val;
+          roi_top_data[index] = output_val;
         }  // for pw
       }    // for ph
     }      // for c
@@ -253,72 +312,12 @@ void ROIAlignForward(const int nthreads,
 }
 
 template <typename T>
-void bilinear_interpolate_gradient(const int height,
-                                   const int width,
-                                   T y,
-                                   T x,
-                                   T* w1,
-                                   T* w2,
-                                   T* w3,
-                                   T* w4,
-                                   int* x_low,
-                                   int* x_high,
-                                   int* y_low,
-                                   int* y_high,
-                                   const int /*index*/ /* index for debug only*/) {
-  // deal with cases that inverse elements are out of feature map boundary
-  if (y < -1.0 || y > height || x < -1.0 || x > width) {
-    // empty
-    *w1 = *w2 = *w3 = *w4 = 0.;
-    *x_low = *x_high = *y_low = *y_high = -1;
-    return;
-  }
-
-  if (y <= 0) {
-    y = 0;
-  }
-  if (x <= 0) {
-    x = 0;
-  }
-
-  *y_low = static_cast<int>(y);
-  *x_low = static_cast<int>(x);
-
-  if (*y_low >= height - 1) {
-    *y_high = *y_low = height - 1;
-    y                = (T)*y_low;
-  } else {
-    *y_high = *y_low + 1;
-  }
-
-  if (*x_low >= width - 1) {
-    *x_high = *x_low = width - 1;
-    x                = (T)*x_low;
-  } else {
-    *x_high = *x_low + 1;
-  }
-
-  T ly = y - *y_low;
-  T lx = x - *x_low;
-  T hy = 1. - ly, hx = 1. - lx;
-
-  *w1 = hy * hx, *w2 = hy * lx, *w3 = ly * hx, *w4 = ly * lx;
-
-  return;
-}
-
-template <class T>
-inline void add(const T& val, T* address) {
-  *address += val;
-}
-
-template <typename T>
-void ROIAlignBackward(const int nthreads,
-                      const T* top_diff,
-                      const int /*num_rois*/,
+void ROIAlignBackward(const T* top_diff,
+                      const int num_rois,
                       const T& spatial_scale,
                       const bool position_sensitive,
                       const bool continuous_coordinate,
+                      const bool nhwc,
                       const int channels,
                       const int height,
                       const int width,
@@ -330,90 +329,92 @@ void ROIAlignBackward(const int nthreads,
                       int rois_cols) {
   DCHECK(rois_cols == 4 || rois_cols == 5);
 
-  for (int index = 0; index < nthreads; index++) {
-    // (n, c, ph, pw) is an element in the pooled output
-    int pw = index % pooled_width;
-    int ph = (index / pooled_width) % pooled_height;
-    int c  = (index / pooled_width / pooled_height) % channels;
-    int n  = index / pooled_width / pooled_height / channels;
-
-    const T* offset_bottom_rois = bottom_rois + n * rois_cols;
-    int roi_batch_ind           = 0;
-    if (rois_cols == 5) {
-      roi_batch_ind = offset_bottom_rois[0];
-      if (roi_batch_ind < 0)
-        continue;
-      offset_bottom_rois++;
-    }
+  const int num_bins          = pooled_height * pooled_width;
+  const int channels_unpooled = position_sensitive ? channels * num_bins : channels;
+  // single threaded, since the rois may overlap
+  for (int n = 0; n < num_rois; n++) {
+    int roi_batch_ind, roi_bin_grid_h, roi_bin_grid_w;
+    T roi_start_h, roi_start_w, bin_size_h, bin_size_w;
+    if (!roi_align_grid(bottom_rois + n * rois_cols,
+                        rois_cols,
+                        spatial_scale,
+                        continuous_coordinate,
+                        pooled_height,
+                        pooled_width,
+                        sampling_ratio,
+                        &roi_batch_ind,
+                        &roi_start_h,
+                        &roi_start_w,
+                        &bin_size_h,
+                        &bin_size_w,
+                        &roi_bin_grid_h,
+                        &roi_bin_grid_w))
+      continue;
 
-    // Do not using rounding; this implementation detail is critical
-    T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
-    T roi_start_w = offset_bottom_rois[0] * spatial_scale - roi_offset;
-    T roi_start_h = offset_bottom_rois[1] * spatial_scale - roi_offset;
-    T roi_end_w   = offset_bottom_rois[2] * spatial_scale - roi_offset;
-    T roi_end_h   = offset_bottom_rois[3] * spatial_scale - roi_offset;
-
-    T roi_width  = roi_end_w - roi_start_w;
-    T roi_height = roi_end_h - roi_start_h;
-    if (!continuous_coordinate) {  // backward compatiblity
-      // Force malformed ROIs to be 1x1
-      roi_width  = std::max(roi_width, (T)1.);
-      roi_height = std::max(roi_height, (T)1.);
-    }
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-
-    int c_unpooled        = c;
-    int channels_unpooled = channels;
-    if (position_sensitive) {
-      c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
-      channels_unpooled = channels * pooled_height * pooled_width;
-    }
-    T* offset_bottom_diff =
-        bottom_diff + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
-
-    int top_offset            = (n * channels + c) * pooled_height * pooled_width;
-    const T* offset_top_diff  = top_diff + top_offset;
-    const T top_diff_this_bin = offset_top_diff[ph * pooled_width + pw];
+    // We do average (integral) pooling inside a bin
+    const int num_samples = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
+    const T count         = num_samples;
 
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h =
-        (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_height / pooled_height);  // e.g., = 2
-    int roi_bin_grid_w =
-        (sampling_ratio > 0) ? sampling_ratio : std::ceil(roi_width / pooled_width);
+    // the weights are shared by all channels, as in the forward pass
+    std::vector<PreCalc<T>> pre_calc(num_samples * num_bins);
+    pre_calc_for_bilinear_interpolate(height,
+                                      width,
+                                      pooled_height,
+                                      pooled_width,
+                                      roi_bin_grid_h,
+                                      roi_bin_grid_w,
+                                      roi_start_h,
+                                      roi_start_w,
+                                      bin_size_h,
+                                      bin_size_w,
+                                      roi_bin_grid_h,
+                                      roi_bin_grid_w,
+                                      &pre_calc);
 
-    // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
-
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-      const T y =
-          roi_start_h + ph * bin_size_h +
-          static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);  // e.g., 0.5, 1.5
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_start_w + pw * bin_size_w +
-                    static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
-
-        T w1, w2, w3, w4;
-        int x_low, x_high, y_low, y_high;
-
-        bilinear_interpolate_gradient(
-            height, width, y, x, &w1, &w2, &w3, &w4, &x_low, &x_high, &y_low, &y_high, index);
-
-        T g1 = top_diff_this_bin * w1 / count;
-        T g2 = top_diff_this_bin * w2 / count;
-        T g3 = top_diff_this_bin * w3 / count;
-        T g4 = top_diff_this_bin * w4 / count;
-
-        if (x_low >= 0 && x_high >= 0 && y_low >= 0 && y_high >= 0) {
-          // atomic add is not needed for now since it is single threaded
-          add(static_cast<T>(g1), offset_bottom_diff + y_low * width + x_low);
-          add(static_cast<T>(g2), offset_bottom_diff + y_low * width + x_high);
-          add(static_cast<T>(g3), offset_bottom_diff + y_high * width + x_low);
-          add(static_cast<T>(g4), offset_bottom_diff + y_high * width + x_high);
-        }  // if
-      }    // ix
-    }      // iy
-  }        // for
+    for (int bin = 0; bin < num_bins; bin++) {
+      const PreCalc<T>* bin_pre_calc = &pre_calc[bin * num_samples];
+      if (nhwc) {
+        const T* offset_top_diff = top_diff + (n * num_bins + bin) * channels;
+        T* offset_bottom_diff    = bottom_diff +
+                                roi_batch_ind * height * width * channels_unpooled +
+                                (position_sensitive ? bin : 0);
+        const int c_stride       = position_sensitive ? num_bins : 1;
+        for (int k = 0; k < num_samples; k++) {
+          const PreCalc<T>& pc = bin_pre_calc[k];
+          // out of the feature map
+          if (pc.w1 == 0 && pc.w2 == 0 && pc.w3 == 0 && pc.w4 == 0)
+            continue;
+          T* d1 = offset_bottom_diff + pc.pos1 * channels_unpooled;
+          T* d2 = offset_bottom_diff + pc.pos2 * channels_unpooled;
+          T* d3 = offset_bottom_diff + pc.pos3 * channels_unpooled;
+          T* d4 = offset_bottom_diff + pc.pos4 * channels_unpooled;
+          for (int c = 0; c < channels; c++) {
+            const T g = offset_top_diff[c] / count;
+            d1[c * c_stride] += g * pc.w1;
+            d2[c * c_stride] += g * pc.w2;
+            d3[c * c_stride] += g * pc.w3;
+            d4[c * c_stride] += g * pc.w4;
+          }
+        }
+        continue;
+      }
+      for (int c = 0; c < channels; c++) {
+        const int c_unpooled = position_sensitive ? c * num_bins + bin : c;
+        T* offset_bottom_diff =
+            bottom_diff + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
+        const T g = top_diff[(n * channels + c) * num_bins + bin] / count;
+        for (int k = 0; k < num_samples; k++) {
+          const PreCalc<T>& pc = bin_pre_calc[k];
+          if (pc.w1 == 0 && pc.w2 == 0 && pc.w3 == 0 && pc.w4 == 0)
+            continue;
+          offset_bottom_diff[pc.pos1] += g * pc.w1;
+          offset_bottom_diff[pc.pos2] += g * pc.w2;
+          offset_bottom_diff[pc.pos3] += g * pc.w3;
+          offset_bottom_diff[pc.pos4] += g * pc.w4;
+        }
+      }
+    }  // for bin
+  }    // for n
 }  // ROIAlignBackward
 
 template <typename xpu>
@@ -431,14 +432,16 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
 
   const ROIAlignParam& param = nnvm::get<ROIAlignParam>(attrs.parsed);
 
-  const int count = out_data[roialign::kOut].Size();
-  // const int num_rois = in_data[roialign::kBox].size(0);
-  const int channels      = out_data[roialign::kOut].size(1);  // channels of pooled output
-  const int height        = in_data[roialign::kData].size(2);
-  const int width         = in_data[roialign::kData].size(3);
-  const int pooled_height = out_data[roialign::kOut].size(2);
-  const int pooled_width  = out_data[roialign::kOut].size(3);
-  const int rois_cols     = in_data[roialign::kBox].size(1);
+  const bool nhwc             = param.layout == mshadow::kNHWC;
+  const mxnet::TShape& dshape = in_data[roialign::kData].shape_;
+  const mxnet::TShape& oshape = out_data[roialign::kOut].shape_;
+  const int num_rois          = in_data[roialign::kBox].size(0);
+  const int channels          = nhwc ? oshape[3] : oshape[1];  // channels of pooled output
+  const int height            = nhwc ? dshape[1] : dshape[2];
+  const int width             = nhwc ? dshape[2] : dshape[3];
+  const int pooled_height     = nhwc ? oshape[1] : oshape[2];
+  const int pooled_width      = nhwc ? oshape[2] : oshape[3];
+  const int rois_cols         = in_data[roialign::kBox].size(1);
 
   // assume all the data and gradient have the same type
   MSHADOW_REAL_TYPE_SWITCH(in_data[0].type_flag_, DType, {
@@ -446,11 +449,12 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
     const DType* bottom_rois = in_data[roialign::kBox].dptr<DType>();
     DType* top_data          = out_data[roialign::kOut].dptr<DType>();
 
-    ROIAlignForward<DType>(count,
+    ROIAlignForward<DType>(num_rois,
                            bottom_data,
                            param.spatial_scale,
                            param.position_sensitive,
                            param.aligned,
+                           nhwc,
                            channels,
                            height,
                            width,
@@ -484,14 +488,16 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
 
   const ROIAlignParam& param = nnvm::get<ROIAlignParam>(attrs.parsed);
 
-  const int count         = out_grad[0].Size();
-  const int num_rois      = in_data[0].size(0);
-  const int channels      = out_grad[0].size(1);  // channels of pooled output
-  const int height        = outputs[0].size(2);
-  const int width         = outputs[0].size(3);
-  const int pooled_height = out_grad[0].size(2);
-  const int pooled_width  = out_grad[0].size(3);
-  const int rois_cols     = in_data[0].size(1);
+  const bool nhwc             = param.layout == mshadow::kNHWC;
+  const mxnet::TShape& dshape = outputs[0].shape_;
+  const mxnet::TShape& oshape = out_grad[0].shape_;
+  const int num_rois          = in_data[0].size(0);
+  const int channels          = nhwc ? oshape[3] : oshape[1];  // channels of pooled output
+  const int height            = nhwc ? dshape[1] : dshape[2];
+  const int width             = nhwc ? dshape[2] : dshape[3];
+  const int pooled_height     = nhwc ? oshape[1] : oshape[2];
+  const int pooled_width      = nhwc ? oshape[2] : oshape[3];
+  const int rois_cols         = in_data[0].size(1);
 
   Stream<cpu>* s = ctx.get_stream<cpu>();
   // assume all the data and gradient have the same type
@@ -504,12 +510,12 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
       if (kWriteTo == req[roialign::kData]) {
         Fill<false>(s, outputs[0], kWriteTo, static_cast<DType>(0));
       }
-      ROIAlignBackward<DType>(count,
-                              top_diff,
+      ROIAlignBackward<DType>(top_diff,
                               num_rois,
                               param.spatial_scale,
                               param.position_sensitive,
                               param.aligned,
+                              nhwc,
                               channels,
                               height,
                               width,
@@ -543,6 +549,10 @@ Bilinear interpolation is used to compute the exact values of the
 input features at four regularly sampled locations in each RoI bin.
 Then the feature map can be aggregated by avgpooling.
 
+With ``layout='NHWC'`` data has shape (batch, height, width, channels) and the output has
+shape (num_rois, pooled_h, pooled_w, channels). The channels of a sampling point are then
+contiguous, so its bilinear weights are shared by all channels.
+
 
 References
 ----------
@@ -568,26 +578,30 @@ He, Kaiming, et al. "Mask R-CNN." ICCV, 2017
           using namespace mshadow;
           const ROIAlignParam& param = nnvm::get<ROIAlignParam>(attrs.parsed);
           CHECK_EQ(in_shape->size(), 2) << "Input:[data, rois]";
-          // data: [batch_size, c, h, w]
+          // data: [batch_size, c, h, w] or [batch_size, h, w, c]
           mxnet::TShape dshape = in_shape->at(roialign::kData);
           CHECK_EQ(dshape.ndim(), 4) << "data should be a 4D tensor";
           // bbox: [num_rois, 5]
           mxnet::TShape bshape = in_shape->at(roialign::kBox);
           CHECK_EQ(bshape.ndim(), 2) << "bbox should be a 2D tensor of shape [batch, 5]";
           CHECK_EQ(bshape[1], 5) << "bbox should be a 2D tensor of shape [batch, 5]";
-          // out: [num_rois, c, pooled_h, pooled_w]
-          out_shape->clear();
+          const bool nhwc       = param.layout == mshadow::kNHWC;
+          const int in_channels = nhwc ? dshape[3] : dshape[1];
+          int out_channels      = in_channels;
           if (param.position_sensitive) {
-            CHECK_EQ(dshape[1] % (param.pooled_size[0] * param.pooled_size[1]), 0)
+            CHECK_EQ(in_channels % (param.pooled_size[0] * param.pooled_size[1]), 0)
                 << "Input channels should be divided by pooled_size[0]*pooled_size[1]"
                    "when position_sensitive is true.";
-            out_shape->push_back(Shape4(bshape[0],
-                                        dshape[1] / param.pooled_size[0] / param.pooled_size[1],
-                                        param.pooled_size[0],
-                                        param.pooled_size[1]));
+            out_channels = in_channels / param.pooled_size[0] / param.pooled_size[1];
+          }
+          // out: [num_rois, c, pooled_h, pooled_w] or [num_rois, pooled_h, pooled_w, c]
+          out_shape->clear();
+          if (nhwc) {
+            out_shape->push_back(
+                Shape4(bshape[0], param.pooled_size[0], param.pooled_size[1], out_channels));
           } else {
             out_shape->push_back(
-                Shape4(bshape[0], dshape[1], param.pooled_size[0], param.pooled_size[1]));
+                Shape4(bshape[0], out_channels, param.pooled_size[0], param.pooled_size[1]));
           }
           return true;
         })
@@ -329,6 +329,276 @@ __global__ void RoIAlignBackwardKernel(const int nthreads,
   }        // CUDA_KERNEL_LOOP
 }  // RoIAlignBackward
 
+/*!
+ * \brief computes the sampling grid of a roi, returns false if the roi is ignored
+ */
+template <typename T>
+__device__ bool roi_align_grid(const T* roi,
+                               const T spatial_scale,
+                               const bool continuous_coordinate,
+                               const int pooled_height,
+                               const int pooled_width,
+                               const int sampling_ratio,
+                               int* roi_batch_ind,
+                               T* roi_start_h,
+                               T* roi_start_w,
+                               T* bin_size_h,
+                               T* bin_size_w,
+                               int* roi_bin_grid_h,
+                               int* roi_bin_grid_w) {
+  *roi_batch_ind = roi[0];
+  if (*roi_batch_ind < 0)
+    return false;
+
+  // Do not using rounding; this implementation detail is critical
+  T roi_offset = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
+  *roi_start_w = roi[1] * spatial_scale - roi_offset;
+  *roi_start_h = roi[2] * spatial_scale - roi_offset;
+  T roi_end_w  = roi[3] * spatial_scale - roi_offset;
+  T roi_end_h  = roi[4] * spatial_scale - roi_offset;
+
+  T roi_width  = roi_end_w - *roi_start_w;
+  T roi_height = roi_end_h - *roi_start_h;
+  if (!continuous_coordinate) {  // backward compatiblity
+    // Force malformed ROIs to be 1x1
+    roi_width  = max(roi_width, (T)1.);
+    roi_height = max(roi_height, (T)1.);
+  }
+  *bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+  *bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+
+  // We use roi_bin_grid to sample the grid and mimic integral
+  *roi_bin_grid_h =
+      (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);  // e.g., = 2
+  *roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+  return true;
+}
+
+// Number of sampling points whose positions and weights are staged in shared memory at once.
+constexpr int ROI_NHWC_SAMPLE_CHUNK = 64;
+
+/*!
+ * \brief computes the positions and weights of the sampling points [begin, begin + chunk)
+ *  of a bin into shared memory, they are shared by all channels. The position of a point
+ *  out of the feature map is -1.
+ */
+template <typename T>
+__device__ void roi_align_nhwc_samples(const int begin,
+                                       const int chunk,
+                                       const int height,
+                                       const int width,
+                                       const int ph,
+                                       const int pw,
+                                       const T roi_start_h,
+                                       const T roi_start_w,
+                                       const T bin_size_h,
+                                       const T bin_size_w,
+                                       const int roi_bin_grid_h,
+                                       const int roi_bin_grid_w,
+                                       int (*s_pos)[4],
+                                       T (*s_w)[4]) {
+  const T count = roi_bin_grid_h * roi_bin_grid_w;
+  for (int k = threadIdx.x; k < chunk; k += blockDim.x) {
+    const int iy = (begin + k) / roi_bin_grid_w;
+    const int ix = (begin + k) % roi_bin_grid_w;
+    const T y    = roi_start_h + ph * bin_size_h +
+                static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);
+    const T x    = roi_start_w + pw * bin_size_w +
+                static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
+    T w1, w2, w3, w4;
+    int x_low, x_high, y_low, y_high;
+    bilinear_interpolate_gradient(
+        height, width, y, x, &w1, &w2, &w3, &w4, &x_low, &x_high, &y_low, &y_high, k);
+    if (x_low < 0) {
+      s_pos[k][0] = -1;
+      continue;
+    }
+    s_pos[k][0] = y_low * width + x_low;
+    s_pos[k][1] = y_low * width + x_high;
+    s_pos[k][2] = y_high * width + x_low;
+    s_pos[k][3] = y_high * width + x_high;
+    s_w[k][0]   = w1 / count;
+    s_w[k][1]   = w2 / count;
+    s_w[k][2]   = w3 / count;
+    s_w[k][3]   = w4 / count;
+  }
+}
+
+/*!
+ * \brief NHWC forward, one block per output bin (n, ph, pw). The threads of a block compute
+ *  the sampling points of the bin once and then read the channels of each point coalesced.
+ */
+template <typename T>
+__global__ void RoIAlignForwardNHWCKernel(const int nbins,
+                                          const T* bottom_data,
+                                          const T spatial_scale,
+                                          const bool position_sensitive,
+                                          const bool continuous_coordinate,
+                                          const int channels,
+                                          const int height,
+                                          const int width,
+                                          const int pooled_height,
+                                          const int pooled_width,
+                                          const int sampling_ratio,
+                                          const T* bottom_rois,
+                                          T* top_data) {
+  __shared__ int s_pos[ROI_NHWC_SAMPLE_CHUNK][4];
+  __shared__ T s_w[ROI_NHWC_SAMPLE_CHUNK][4];
+  const int num_bins          = pooled_height * pooled_width;
+  const int channels_unpooled = position_sensitive ? channels * num_bins : channels;
+  const int c_stride          = position_sensitive ? num_bins : 1;
+  for (int index = blockIdx.x; index < nbins; index += gridDim.x) {
+    const int bin = index % num_bins;
+    const int n   = index / num_bins;
+    T* out        = top_data + index * channels;
+
+    int roi_batch_ind, roi_bin_grid_h, roi_bin_grid_w;
+    T roi_start_h, roi_start_w, bin_size_h, bin_size_w;
+    if (!roi_align_grid(bottom_rois + n * 5,
+                        spatial_scale,
+                        continuous_coordinate,
+                        pooled_height,
+                        pooled_width,
+                        sampling_ratio,
+                        &roi_batch_ind,
+                        &roi_start_h,
+                        &roi_start_w,
+                        &bin_size_h,
+                        &bin_size_w,
+                        &roi_bin_grid_h,
+                        &roi_bin_grid_w)) {
+      for (int c = threadIdx.x; c < channels; c += blockDim.x)
+        out[c] = 0.;
+      continue;
+    }
+    const T* offset_bottom_data = bottom_data +
+                                  roi_batch_ind * height * width * channels_unpooled +
+                                  (position_sensitive ? bin : 0);
+    const int num_samples = roi_bin_grid_h * roi_bin_grid_w;
+    for (int begin = 0; begin < num_samples; begin += ROI_NHWC_SAMPLE_CHUNK) {
+      const int chunk = min(ROI_NHWC_SAMPLE_CHUNK, num_samples - begin);
+      // the previous chunk is consumed
+      __syncthreads();
+      roi_align_nhwc_samples(begin,
+                             chunk,
+                             height,
+                             width,
+                             bin / pooled_width,
+                             bin % pooled_width,
+                             roi_start_h,
+                             roi_start_w,
+                             bin_size_h,
+                             bin_size_w,
+                             roi_bin_grid_h,
+                             roi_bin_grid_w,
+                             s_pos,
+                             s_w);
+      __syncthreads();
+      for (int c = threadIdx.x; c < channels; c += blockDim.x) {
+        const T* data = offset_bottom_data + c * c_stride;
+        T val         = begin == 0 ? static_cast<T>(0) : out[c];
+        for (int k = 0; k < chunk; k++) {
+          if (s_pos[k][0] < 0)
+            continue;
+          val += s_w[k][0] * data[s_pos[k][0] * channels_unpooled] +
+                 s_w[k][1] * data[s_pos[k][1] * channels_unpooled] +
+                 s_w[k][2] * data[s_pos[k][2] * channels_unpooled] +
+                 s_w[k][3] * data[s_pos[k][3] * channels_unpooled];
+        }
+        out[c] = val;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief NHWC backward, one block per output bin, the gradients of the channels of a
+ *  sampling point are added with coalesced atomics.
+ */
+template <typename T>
+__global__ void RoIAlignBackwardNHWCKernel(const int nbins,
+                                           const T* top_diff,
+                                           const T spatial_scale,
+                                           const bool position_sensitive,
+                                           const bool continuous_coordinate,
+                                           const int channels,
+                                           const int height,
+                                           const int width,
+                                           const int pooled_height,
+                                           const int pooled_width,
+                                           const int sampling_ratio,
+                                           T* bottom_diff,
+                                           const T* bottom_rois) {
+  __shared__ int s_pos[ROI_NHWC_SAMPLE_CHUNK][4];
+  __shared__ T s_w[ROI_NHWC_SAMPLE_CHUNK][4];
+  const int num_bins          = pooled_height * pooled_width;
+  const int channels_unpooled = position_sensitive ? channels * num_bins : channels;
+  const int c_stride          = position_sensitive ? num_bins : 1;
+  for (int index = blockIdx.x; index < nbins; index += gridDim.x) {
+    const int bin = index % num_bins;
+    const int n   = index / num_bins;
+
+    int roi_batch_ind, roi_bin_grid_h, roi_bin_grid_w;
+    T roi_start_h, roi_start_w, bin_size_h, bin_size_w;
+    if (!roi_align_grid(bottom_rois + n * 5,
+                        spatial_scale,
+                        continuous_coordinate,
+                        pooled_height,
+                        pooled_width,
+                        sampling_ratio,
+                        &roi_batch_ind,
+                        &roi_start_h,
+                        &roi_start_w,
+                        &bin_size_h,
+                        &bin_size_w,
+                        &roi_bin_grid_h,
+                        &roi_bin_grid_w))
+      continue;
+    T* offset_bottom_diff = bottom_diff + roi_batch_ind * height * width * channels_unpooled +
+                            (position_sensitive ? bin : 0);
+    const int num_samples = roi_bin_grid_h * roi_bin_grid_w;
+    for (int begin = 0; begin < num_samples; begin += ROI_NHWC_SAMPLE_CHUNK) {
+      const int chunk = min(ROI_NHWC_SAMPLE_CHUNK, num_samples - begin);
+      __syncthreads();
+      roi_align_nhwc_samples(begin,
+                             chunk,
+                             height,
+                             width,
+                             bin / pooled_width,
+                             bin % pooled_width,
+                             roi_start_h,
+                             roi_start_w,
+                             bin_size_h,
+                             bin_size_w,
+                             roi_bin_grid_h,
+                             roi_bin_grid_w,
+                             s_pos,
+                             s_w);
+      __syncthreads();
+      for (int c = threadIdx.x; c < channels; c += blockDim.x) {
+        T* diff   = offset_bottom_diff + c * c_stride;
+        const T g = top_diff[index * channels + c];
+        for (int k = 0; k < chunk; k++) {
+          if (s_pos[k][0] < 0)
+            continue;
+          atomicAdd(diff + s_pos[k][0] * channels_unpooled, g * s_w[k][0]);
+          atomicAdd(diff + s_pos[k][1] * channels_unpooled, g * s_w[k][1]);
+          atomicAdd(diff + s_pos[k][2] * channels_unpooled, g * s_w[k][2]);
+          atomicAdd(diff + s_pos[k][3] * channels_unpooled, g * s_w[k][3]);
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * \brief threads per block of the NHWC kernels, a multiple of the warp size covering the
+ *  channels
+ */
+inline int ROI_NHWC_THREADS(const int channels) {
+  return std::min(kBaseThreadNum, std::max(32, (channels + 31) / 32 * 32));
+}
+
 template <typename xpu>
 void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
                             const OpContext& ctx,
@@ -344,13 +614,16 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
 
   const ROIAlignParam param = nnvm::get<ROIAlignParam>(attrs.parsed);
 
-  const int count         = out_data[roialign::kOut].Size();
-  const int num_rois      = in_data[roialign::kBox].size(0);
-  const int channels      = out_data[roialign::kOut].size(1);  // channels of pooled output
-  const int height        = in_data[roialign::kData].size(2);
-  const int width         = in_data[roialign::kData].size(3);
-  const int pooled_height = out_data[roialign::kOut].size(2);
-  const int pooled_width  = out_data[roialign::kOut].size(3);
+  const bool nhwc             = param.layout == mshadow::kNHWC;
+  const mxnet::TShape& dshape = in_data[roialign::kData].shape_;
+  const mxnet::TShape& oshape = out_data[roialign::kOut].shape_;
+  const int count             = out_data[roialign::kOut].Size();
+  const int num_rois          = in_data[roialign::kBox].size(0);
+  const int channels          = nhwc ? oshape[3] : oshape[1];  // channels of pooled output
+  const int height            = nhwc ? dshape[1] : dshape[2];
+  const int width             = nhwc ? dshape[2] : dshape[3];
+  const int pooled_height     = nhwc ? oshape[1] : oshape[2];
+  const int pooled_width      = nhwc ? oshape[2] : oshape[3];
 
   Stream<gpu>* s      = ctx.get_stream<gpu>();
   cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
@@ -358,6 +631,27 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
     const DType* bottom_data = in_data[roialign::kData].dptr<DType>();
     const DType* bottom_rois = in_data[roialign::kBox].dptr<DType>();
     DType* top_data          = out_data[roialign::kOut].dptr<DType>();
+    if (nhwc) {
+      const int nbins = num_rois * pooled_height * pooled_width;
+      RoIAlignForwardNHWCKernel<DType><<<std::min(nbins, kMaxGridNum),
+                                         ROI_NHWC_THREADS(channels),
+                                         0,
+                                         stream>>>(nbins,
+                                                   bottom_data,
+                                                   param.spatial_scale,
+                                                   param.position_sensitive,
+                                                   param.aligned,
+                                                   channels,
+                                                   height,
+                                                   width,
+                                                   pooled_height,
+                                                   pooled_width,
+                                                   param.sample_ratio,
+                                                   bottom_rois,
+                                                   top_data);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(RoIAlignForwardNHWCKernel);
+      return;
+    }
     RoIAlignForwardKernel<DType>
         <<<ROI_GET_BLOCKS(count), kMaxThreadsPerBlock, 0, stream>>>(count,
                                                                     bottom_data,
@@ -396,13 +690,16 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
 
   const ROIAlignParam param = nnvm::get<ROIAlignParam>(attrs.parsed);
 
-  const int count         = out_grad[0].Size();
-  const int num_rois      = in_data[0].size(0);
-  const int channels      = out_grad[0].size(1);  // channels of pooled output
-  const int height        = outputs[0].size(2);
-  const int width         = outputs[0].size(3);
-  const int pooled_height = out_grad[0].size(2);
-  const int pooled_width  = out_grad[0].size(3);
+  const bool nhwc             = param.layout == mshadow::kNHWC;
+  const mxnet::TShape& dshape = outputs[0].shape_;
+  const mxnet::TShape& oshape = out_grad[0].shape_;
+  const int count             = out_grad[0].Size();
+  const int num_rois          = in_data[0].size(0);
+  const int channels          = nhwc ? oshape[3] : oshape[1];  // channels of pooled output
+  const int height            = nhwc ? dshape[1] : dshape[2];
+  const int width             = nhwc ? dshape[2] : dshape[3];
+  const int pooled_height     = nhwc ? oshape[1] : oshape[2];
+  const int pooled_width      = nhwc ? oshape[2] : oshape[3];
 
   Stream<gpu>* s      = ctx.get_stream<gpu>();
   cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
@@ -421,6 +718,27 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
     if (kWriteTo == req[roialign::kData]) {
       Fill<false>(s, outputs[0], kWriteTo, static_cast<DType>(0));
     }
+    if (nhwc) {
+      const int nbins = num_rois * pooled_height * pooled_width;
+      RoIAlignBackwardNHWCKernel<DType><<<std::min(nbins, kMaxGridNum),
+                                          ROI_NHWC_THREADS(channels),
+                                          0,
+                                          stream>>>(nbins,
+                                                    top_diff,
+                                                    param.spatial_scale,
+                                                    param.position_sensitive,
+                                                    param.aligned,
+                                                    channels,
+                                                    height,
+                                                    width,
+                                                    pooled_height,
+                                                    pooled_width,
+                                                    param.sample_ratio,
+                                                    grad_in,
+                                                    bottom_rois);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(RoIAlignBackwardNHWCKernel);
+      return;
+    }
     RoIAlignBackwardKernel<DType>
         <<<ROI_GET_BLOCKS(count), kMaxThreadsPerBlock, 0, stream>>>(count,
                                                                     top_diff,
@@ -0,0 +1,522 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sampled_logits-inl.h
+ * \brief logits of the label and of sampled classes of a fully connected output layer, for the
+ *  sampled softmax of the layers of many classes
+ */
+
+#ifndef MXNET_OPERATOR_CONTRIB_SAMPLED_LOGITS_INL_H_
+#define MXNET_OPERATOR_CONTRIB_SAMPLED_LOGITS_INL_H_
+
+#include <mxnet/operator.h>
+#include <vector>
+
+#include "../linalg.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace sampled_logits {
+enum SampledLogitsOpInputs { kData, kWeight, kBias, kLabel, kSampled, kNumTries };
+enum SampledLogitsBackwardInputs { kOutGrad, kBwdData, kBwdWeight, kBwdLabel, kBwdSampled };
+}  // namespace sampled_logits
+
+struct SampledLogitsParam : public dmlc::Parameter<SampledLogitsParam> {
+  bool remove_accidental_hits;
+  bool subtract_log_q;
+
+  DMLC_DECLARE_PARAMETER(SampledLogitsParam) {
+    DMLC_DECLARE_FIELD(remove_accidental_hits)
+        .set_default(true)
+        .describe("Whether to give the sampled classes that are the label of a row a logit of "
+                  "the lowest value, and no gradient, in that row.");
+    DMLC_DECLARE_FIELD(subtract_log_q)
+        .set_default(true)
+        .describe("Whether to subtract from the logits the log of the expected number of "
+                  "times ``_sample_unique_zipfian`` draws each class, so that the softmax of the "
+                  "logits estimates the one over all the classes.");
+  }
+};
+
+/*! \brief class c of num_classes, clipped to the valid classes */
+template <typename IType>
+MSHADOW_XINLINE index_t SampledLogitsClass(IType c, index_t num_classes) {
+  const index_t k = static_cast<index_t>(c);
+  return k < 0 ? 0 : (k >= num_classes ? num_classes - 1 : k);
+}
+
+/*!
+ * \brief log of the expected number of times class c of num_classes is drawn by the num_tries
+ *  draws of _sample_unique_zipfian, of probability log((c + 2) / (c + 1)) / log(num_classes + 1)
+ */
+MSHADOW_XINLINE double SampledLogitsLogQ(index_t c, index_t num_classes, double num_tries) {
+  const double p = log((c + 2.0) / (c + 1.0)) / log(num_classes + 1.0);
+  return log(-expm1(num_tries * log1p(-p)));
+}
+
+/*!
+ * \brief rows[j] = the weight row of class sampled[j] and offset[j] what its logits add to the
+ *  product of the data and the row
+ */
+struct SampledLogitsGather {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* rows,
+                                  DType* offset,
+                                  const DType* weight,
+                                  const DType* bias,
+                                  const int64_t* sampled,
+                                  const int64_t* num_tries,
+                                  index_t num_classes,
+                                  index_t dim,
+                                  bool subtract_log_q) {
+    const index_t j = i / dim;
+    const index_t c = SampledLogitsClass(sampled[j], num_classes);
+    rows[i]         = weight[c * dim + i % dim];
+    if (offset && i % dim == 0) {
+      offset[j] = bias[c];
+      if (subtract_log_q)
+        offset[j] -= static_cast<DType>(SampledLogitsLogQ(c, num_classes, num_tries[0]));
+    }
+  }
+};
+
+/*! \brief writes the logit of the label of row b to the first column of out */
+struct SampledLogitsTrue {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t b,
+                                  DType* out,
+                                  const DType* data,
+                                  const DType* weight,
+                                  const DType* bias,
+                                  const LType* label,
+                                  const int64_t* num_tries,
+                                  index_t num_classes,
+                                  index_t dim,
+                                  index_t num_sampled,
+                                  bool subtract_log_q) {
+    const index_t c = SampledLogitsClass(label[b], num_classes);
+    const DType* x  = data + b * dim;
+    const DType* w  = weight + c * dim;
+    DType sum       = bias[c];
+    for (index_t d = 0; d < dim; ++d)
+      sum += x[d] * w[d];
+    if (subtract_log_q)
+      sum -= static_cast<DType>(SampledLogitsLogQ(c, num_classes, num_tries[0]));
+    out[b * (num_sampled + 1)] = sum;
+  }
+};
+
+/*! \brief adds the offsets of the sampled classes to their logits, or masks the labels */
+struct SampledLogitsSampled {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* offset,
+                                  const LType* label,
+                                  const int64_t* sampled,
+                                  index_t num_classes,
+                                  index_t num_sampled,
+                                  bool remove_accidental_hits) {
+    const index_t b = i / num_sampled;
+    const index_t j = i % num_sampled;
+    DType& logit    = out[b * (num_sampled + 1) + 1 + j];
+    if (remove_accidental_hits && SampledLogitsClass(sampled[j], num_classes) ==
+                                      SampledLogitsClass(label[b], num_classes)) {
+      logit = -mshadow::red::limits::MaxValue<DType>();
+    } else {
+      logit += offset[j];
+    }
+  }
+};
+
+/*! \brief grad[b, j] = the gradient of the logit of sampled class j of row b, or 0 for a hit */
+struct SampledLogitsGradSampled {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* grad,
+                                  const DType* ograd,
+                                  const LType* label,
+                                  const int64_t* sampled,
+                                  index_t num_classes,
+                                  index_t num_sampled,
+                                  bool remove_accidental_hits) {
+    const index_t b = i / num_sampled;
+    const index_t j = i % num_sampled;
+    const bool hit  = remove_accidental_hits && SampledLogitsClass(sampled[j], num_classes) ==
+                                                   SampledLogitsClass(label[b], num_classes);
+    grad[i] = hit ? DType(0) : ograd[b * (num_sampled + 1) + 1 + j];
+  }
+};
+
+/*! \brief adds to the data gradient the one through the logits of the labels */
+struct SampledLogitsGradDataTrue {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* grad,
+                                  const DType* ograd,
+                                  const DType* weight,
+                                  const LType* label,
+                                  index_t num_classes,
+                                  index_t dim,
+                                  index_t num_sampled) {
+    const index_t b = i / dim;
+    const index_t c = SampledLogitsClass(label[b], num_classes);
+    grad[i] += ograd[b * (num_sampled + 1)] * weight[c * dim + i % dim];
+  }
+};
+
+/*!
+ * \brief adds the gradients of the rows of the sampled classes to the weight gradient, the
+ *  classes being unique
+ */
+struct SampledLogitsScatterSampled {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* grad,
+                                  const DType* rows_grad,
+                                  const int64_t* sampled,
+                                  index_t num_classes,
+                                  index_t dim) {
+    const index_t c = SampledLogitsClass(sampled[i / dim], num_classes);
+    grad[c * dim + i % dim] += rows_grad[i];
+  }
+};
+
+/*!
+ * \brief adds to column d of the weight gradient, or of the bias gradient for a dim of 1 and
+ *  no data, the gradients of the rows of the labels, which may repeat
+ */
+struct SampledLogitsScatterTrue {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t d,
+                                  DType* grad,
+                                  const DType* ograd,
+                                  const DType* data,
+                                  const LType* label,
+                                  index_t batch_size,
+                                  index_t num_classes,
+                                  index_t dim,
+                                  index_t num_sampled) {
+    for (index_t b = 0; b < batch_size; ++b) {
+      const index_t c = SampledLogitsClass(label[b], num_classes);
+      const DType g   = ograd[b * (num_sampled + 1)];
+      grad[c * dim + d] += data ? g * data[b * dim + d] : g;
+    }
+  }
+};
+
+/*! \brief adds the sum over the rows of the gradients of sampled class j to the bias gradient */
+struct SampledLogitsScatterBias {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t j,
+                                  DType* grad,
+                                  const DType* sampled_grad,
+                                  const int64_t* sampled,
+                                  index_t batch_size,
+                                  index_t num_classes,
+                                  index_t num_sampled) {
+    DType sum = 0;
+    for (index_t b = 0; b < batch_size; ++b)
+      sum += sampled_grad[b * num_sampled + j];
+    grad[SampledLogitsClass(sampled[j], num_classes)] += sum;
+  }
+};
+
+inline bool SampledLogitsShape(const nnvm::NodeAttrs& attrs,
+                               mxnet::ShapeVector* in_shape,
+                               mxnet::ShapeVector* out_shape) {
+  using namespace sampled_logits;
+  CHECK_EQ(in_shape->size(), 6U);
+  CHECK_EQ(out_shape->size(), 1U);
+  const mxnet::TShape& dshape = (*in_shape)[kData];
+  const mxnet::TShape& wshape = (*in_shape)[kWeight];
+  SHAPE_ASSIGN_CHECK(*in_shape, kNumTries, mshadow::Shape1(1));
+  if (mxnet::ndim_is_known(dshape)) {
+    CHECK_EQ(dshape.ndim(), 2U) << "The data of sampled_logits must be (batch_size, dim)";
+    SHAPE_ASSIGN_CHECK(*in_shape, kLabel, mshadow::Shape1(dshape[0]));
+  }
+  if (mxnet::ndim_is_known(wshape)) {
+    CHECK_EQ(wshape.ndim(), 2U) << "The weight of sampled_logits must be (num_classes, dim)";
+    SHAPE_ASSIGN_CHECK(*in_shape, kBias, mshadow::Shape1(wshape[0]));
+    if (mxnet::ndim_is_known(dshape))
+      CHECK_EQ(wshape[1], dshape[1]) << "The data and the weight must have the same dim";
+  } else if (mxnet::ndim_is_known(dshape) && mxnet::ndim_is_known((*in_shape)[kBias])) {
+    SHAPE_ASSIGN_CHECK(*in_shape, kWeight, mshadow::Shape2((*in_shape)[kBias][0], dshape[1]));
+  }
+  const mxnet::TShape& sshape = (*in_shape)[kSampled];
+  if (!mxnet::ndim_is_known(dshape) || !mxnet::shape_is_known(sshape))
+    return false;
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mshadow::Shape2(dshape[0], sshape.Size() + 1));
+  return mxnet::shape_is_known((*in_shape)[kWeight]);
+}
+
+inline bool SampledLogitsType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int>* in_type,
+                              std::vector<int>* out_type) {
+  using namespace sampled_logits;
+  CHECK_EQ(in_type->size(), 6U);
+  CHECK_EQ(out_type->size(), 1U);
+  int dtype = (*in_type)[kData];
+  if (dtype == -1)
+    dtype = (*out_type)[0];
+  if (dtype == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*in_type, kData, dtype);
+  TYPE_ASSIGN_CHECK(*in_type, kWeight, dtype);
+  TYPE_ASSIGN_CHECK(*in_type, kBias, dtype);
+  TYPE_ASSIGN_CHECK(*out_type, 0, dtype);
+  if ((*in_type)[kLabel] == -1)
+    TYPE_ASSIGN_CHECK(*in_type, kLabel, dtype);
+  // the types of the outputs of _sample_unique_zipfian
+  TYPE_ASSIGN_CHECK(*in_type, kSampled, mshadow::kInt64);
+  TYPE_ASSIGN_CHECK(*in_type, kNumTries, mshadow::kInt64);
+  return true;
+}
+
+template <typename xpu>
+void SampledLogitsForward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace sampled_logits;
+  const auto& param = nnvm::get<SampledLogitsParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK(req[0] == kWriteTo || req[0] == kWriteInplace) << "sampled_logits does not add to out";
+  Stream<xpu>* s            = ctx.get_stream<xpu>();
+  const index_t batch_size  = inputs[kData].shape_[0];
+  const index_t dim         = inputs[kData].shape_[1];
+  const index_t num_classes = inputs[kWeight].shape_[0];
+  const index_t num_sampled = inputs[kSampled].Size();
+  if (batch_size == 0)
+    return;
+  const int64_t* sampled   = inputs[kSampled].dptr<int64_t>();
+  const int64_t* num_tries = inputs[kNumTries].dptr<int64_t>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[kLabel].type_flag_, LType, {
+      DType* out          = outputs[0].dptr<DType>();
+      const DType* weight = inputs[kWeight].dptr<DType>();
+      const DType* bias   = inputs[kBias].dptr<DType>();
+      const LType* label  = inputs[kLabel].dptr<LType>();
+      Kernel<SampledLogitsTrue, xpu>::Launch(s,
+                                             batch_size,
+                                             out,
+                                             inputs[kData].dptr<DType>(),
+                                             weight,
+                                             bias,
+                                             label,
+                                             num_tries,
+                                             num_classes,
+                                             dim,
+                                             num_sampled,
+                                             param.subtract_log_q);
+      if (num_sampled > 0) {
+        // the logits of the sampled classes are the GEMM of the data and of their rows
+        Tensor<xpu, 1, DType> workspace = ctx.requested[0].get_space_typed<xpu, 1, DType>(
+            Shape1(num_sampled * dim + num_sampled), s);
+        DType* rows   = workspace.dptr_;
+        DType* offset = rows + num_sampled * dim;
+        Kernel<SampledLogitsGather, xpu>::Launch(s,
+                                                 num_sampled * dim,
+                                                 rows,
+                                                 offset,
+                                                 weight,
+                                                 bias,
+                                                 sampled,
+                                                 num_tries,
+                                                 num_classes,
+                                                 dim,
+                                                 param.subtract_log_q);
+        Tensor<xpu, 2, DType> logits(out + 1, Shape2(batch_size, num_sampled), num_sampled + 1, s);
+        linalg_gemm(inputs[kData].get<xpu, 2, DType>(s),
+                    Tensor<xpu, 2, DType>(rows, Shape2(num_sampled, dim), s),
+                    logits,
+                    DType(1),
+                    DType(0),
+                    false,
+                    true,
+                    s);
+        Kernel<SampledLogitsSampled, xpu>::Launch(s,
+                                                  batch_size * num_sampled,
+                                                  out,
+                                                  offset,
+                                                  label,
+                                                  sampled,
+                                                  num_classes,
+                                                  num_sampled,
+                                                  param.remove_accidental_hits);
+      }
+    });
+  });
+}
+
+template <typename xpu>
+void SampledLogitsBackward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace sampled_logits;
+  const auto& param = nnvm::get<SampledLogitsParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 5U);
+  CHECK_EQ(outputs.size(), 6U);
+  Stream<xpu>* s            = ctx.get_stream<xpu>();
+  const index_t batch_size  = inputs[kBwdData].shape_[0];
+  const index_t dim         = inputs[kBwdData].shape_[1];
+  const index_t num_classes = inputs[kBwdWeight].shape_[0];
+  const index_t num_sampled = inputs[kBwdSampled].Size();
+  const int64_t* sampled    = inputs[kBwdSampled].dptr<int64_t>();
+  // the labels and the sampled classes have no gradient
+  for (int i : {kLabel, kSampled, kNumTries}) {
+    if (req[i] == kWriteTo || req[i] == kWriteInplace) {
+      MSHADOW_TYPE_SWITCH(outputs[i].type_flag_, IType, {
+        Kernel<set_zero, xpu>::Launch(s, outputs[i].Size(), outputs[i].dptr<IType>());
+      });
+    }
+  }
+  MSHADOW_SGL_DBL_TYPE_SWITCH(inputs[kOutGrad].type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[kBwdLabel].type_flag_, LType, {
+      const DType* ograd  = inputs[kOutGrad].dptr<DType>();
+      const DType* data   = inputs[kBwdData].dptr<DType>();
+      const DType* weight = inputs[kBwdWeight].dptr<DType>();
+      const LType* label  = inputs[kBwdLabel].dptr<LType>();
+      for (int i : {kData, kWeight, kBias}) {
+        if (req[i] == kWriteTo || req[i] == kWriteInplace)
+          Kernel<set_zero, xpu>::Launch(s, outputs[i].Size(), outputs[i].dptr<DType>());
+      }
+      if (batch_size == 0)
+        return;
+      if (num_sampled > 0) {
+        Tensor<xpu, 1, DType> workspace = ctx.requested[0].get_space_typed<xpu, 1, DType>(
+            Shape1(2 * num_sampled * dim + batch_size * num_sampled), s);
+        DType* rows         = workspace.dptr_;
+        DType* rows_grad    = rows + num_sampled * dim;
+        DType* sampled_grad = rows_grad + num_sampled * dim;
+        Tensor<xpu, 2, DType> grad_mat(sampled_grad, Shape2(batch_size, num_sampled), s);
+        Kernel<SampledLogitsGradSampled, xpu>::Launch(s,
+                                                      batch_size * num_sampled,
+                                                      sampled_grad,
+                                                      ograd,
+                                                      label,
+                                                      sampled,
+                                                      num_classes,
+                                                      num_sampled,
+                                                      param.remove_accidental_hits);
+        if (req[kData] != kNullOp) {
+          Kernel<SampledLogitsGather, xpu>::Launch(s,
+                                                   num_sampled * dim,
+                                                   rows,
+                                                   static_cast<DType*>(nullptr),
+                                                   weight,
+                                                   static_cast<const DType*>(nullptr),
+                                                   sampled,
+                                                   static_cast<const int64_t*>(nullptr),
+                                                   num_classes,
+                                                   dim,
+                                                   false);
+          linalg_gemm(grad_mat,
+                      Tensor<xpu, 2, DType>(rows, Shape2(num_sampled, dim), s),
+                      outputs[kData].get<xpu, 2, DType>(s),
+                      DType(1),
+                      DType(1),
+                      false,
+                      false,
+                      s);
+        }
+        if (req[kWeight] != kNullOp) {
+          linalg_gemm(grad_mat,
+                      inputs[kBwdData].get<xpu, 2, DType>(s),
+                      Tensor<xpu, 2, DType>(rows_grad, Shape2(num_sampled, dim), s),
+                      DType(1),
+                      DType(0),
+                      true,
+                      false,
+                      s);
+          Kernel<SampledLogitsScatterSampled, xpu>::Launch(s,
+                                                           num_sampled * dim,
+                                                           outputs[kWeight].dptr<DType>(),
+                                                           rows_grad,
+                                                           sampled,
+                                                           num_classes,
+                                                           dim);
+        }
+        if (req[kBias] != kNullOp) {
+          Kernel<SampledLogitsScatterBias, xpu>::Launch(s,
+                                                        num_sampled,
+                                                        outputs[kBias].dptr<DType>(),
+                                                        sampled_grad,
+                                                        sampled,
+                                                        batch_size,
+                                                        num_classes,
+                                                        num_sampled);
+        }
+      }
+      // the gradients through the logits of the labels
+      if (req[kData] != kNullOp) {
+        Kernel<SampledLogitsGradDataTrue, xpu>::Launch(s,
+                                                       batch_size * dim,
+                                                       outputs[kData].dptr<DType>(),
+                                                       ograd,
+                                                       weight,
+                                                       label,
+                                                       num_classes,
+                                                       dim,
+                                                       num_sampled);
+      }
+      if (req[kWeight] != kNullOp) {
+        Kernel<SampledLogitsScatterTrue, xpu>::Launch(s,
+                                                      dim,
+                                                      outputs[kWeight].dptr<DType>(),
+                                                      ograd,
+                                                      data,
+                                                      label,
+                                                      batch_size,
+                                                      num_classes,
+                                                      dim,
+                                                      num_sampled);
+      }
+      if (req[kBias] != kNullOp) {
+        Kernel<SampledLogitsScatterTrue, xpu>::Launch(s,
+                                                      1,
+                                                      outputs[kBias].dptr<DType>(),
+                                                      ograd,
+                                                      static_cast<const DType*>(nullptr),
+                                                      label,
+                                                      batch_size,
+                                                      num_classes,
+                                                      index_t(1),
+                                                      num_sampled);
+      }
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_CONTRIB_SAMPLED_LOGITS_INL_H_
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sampled_logits.cc
+ * \brief logits of the label and of sampled classes of a fully connected output layer
+ */
+
+#include <string>
+
+#include "./sampled_logits-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(SampledLogitsParam);
+
+NNVM_REGISTER_OP(_contrib_sampled_logits)
+    .add_alias("_npx_sampled_logits")
+    .describe(R"code(Compute the logits of a fully connected output layer for the label of each
+row and for sampled classes only, for the sampled softmax of the layers of many classes.
+
+The inputs are the ``(batch_size, dim)`` data, the ``(num_classes, dim)`` weight and the
+``(num_classes,)`` bias of the layer, the ``(batch_size,)`` labels, and the unique classes
+``sampled`` and the number of draws ``num_tries`` returned by ``_sample_unique_zipfian`` for
+a batch of 1. The ``(batch_size, 1 + num_sampled)`` output holds the logit of the label of each
+row, then the logits of the sampled classes. The softmax cross entropy of the output with labels
+of 0 is the sampled softmax loss, and costs a GEMM of ``num_sampled`` instead of
+``num_classes`` columns.
+
+Unless ``subtract_log_q`` is false, the logits are corrected by the log of the expected number of
+times each class is drawn. Unless ``remove_accidental_hits`` is false, a sampled class that is
+the label of a row gets the lowest logit in that row.
+
+The gradients of the weight and the bias are dense, and only their rows of the labels and of the
+sampled classes are not zero. The data uses float32 or float64.
+
+Example::
+
+  sampled, num_tries = _sample_unique_zipfian(num_classes, shape=(1, 8192))
+  logits = sampled_logits(data, weight, bias, label, sampled.reshape(-1), num_tries)
+  loss = softmax_cross_entropy(logits, zeros(batch_size))
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<SampledLogitsParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data",
+                                                                       "weight",
+                                                                       "bias",
+                                                                       "label",
+                                                                       "sampled",
+                                                                       "num_tries"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", SampledLogitsShape)
+    .set_attr<nnvm::FInferType>("FInferType", SampledLogitsType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", SampledLogitsForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          using namespace sampled_logits;
+          std::vector<nnvm::NodeEntry> heads(ograds.begin(), ograds.end());
+          for (int i : {kData, kWeight, kLabel, kSampled})
+            heads.push_back(n->inputs[i]);
+          return MakeGradNode("_backward_contrib_sampled_logits", n, heads, n->attrs.dict);
+        })
+    .add_argument("data", "NDArray-or-Symbol", "Input data, of shape (batch_size, dim).")
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix, of shape (num_classes, dim).")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias, of shape (num_classes,).")
+    .add_argument("label", "NDArray-or-Symbol", "The class of each row, of shape (batch_size,).")
+    .add_argument("sampled", "NDArray-or-Symbol", "The unique sampled classes, of type int64.")
+    .add_argument("num_tries",
+                  "NDArray-or-Symbol",
+                  "The number of draws that sampled the classes, of shape (1,) and type int64.")
+    .add_arguments(SampledLogitsParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_sampled_logits)
+    .set_num_inputs(5)
+    .set_num_outputs(6)
+    .set_attr_parser(ParamParser<SampledLogitsParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", SampledLogitsBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
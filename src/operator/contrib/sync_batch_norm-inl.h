@@ -31,6 +31,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "../operator_common.h"
 #include "../mshadow_op.h"
@@ -42,7 +43,7 @@ namespace syncbatchnorm {
 enum BatchNormOpInputs { kData, kGamma, kBeta };
 enum BatchNormOpOutputs { kOut, kMean, kVar };
 enum BatchNormOpAuxiliary { kMovingMean, kMovingVar };
-enum BatchNormBackResource { kTempSpace };
+enum BatchNormBackResource { kTempSpace, kNCCLComm };
 }  // namespace syncbatchnorm
 
 struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
@@ -53,6 +54,7 @@ struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
   bool output_mean_var;
   int ndev;
   std::string key;
+  bool nccl;
   DMLC_DECLARE_PARAMETER(SyncBatchNormParam) {
     DMLC_DECLARE_FIELD(eps).set_default(1e-3f).describe("Epsilon to prevent div 0");
     DMLC_DECLARE_FIELD(momentum).set_default(0.9f).describe("Momentum for moving average");
@@ -69,6 +71,10 @@ struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
     DMLC_DECLARE_FIELD(key).describe(
         "Hash key for synchronization, please set the same hash key for same layer, "
         "Block.prefix is typically used as in :class:`gluon.nn.contrib.SyncBatchNorm`.");
+    DMLC_DECLARE_FIELD(nccl).set_default(false).describe(
+        "Whether to average the statistics over the GPUs of all the processes with the NCCL "
+        "communicators of mx.contrib.nccl.init, instead of over the ndev GPUs of this process. "
+        "ndev and key are then unused.");
   }
 };
 
@@ -249,6 +255,40 @@ static GlobalShared<SharedND<mshadow::Tensor<cpu, 1, real_t>>> global_shared_var
 static GlobalShared<SharedND<mshadow::Tensor<cpu, 1, real_t>>> global_shared_grad;
 static GlobalShared<SharedND<mshadow::Tensor<cpu, 1, real_t>>> global_shared_prod;
 
+/*!
+ * \brief averages the rows of stats over the ranks of the NCCL communicator, on the device
+ *  without a copy to the host
+ */
+inline void NCCLAllReduceMean(const Resource& comm,
+                              mshadow::Tensor<cpu, 2, real_t> stats,
+                              mshadow::Stream<cpu>* s) {
+  LOG(FATAL) << "The NCCL synchronized batch norm runs on gpu";
+}
+
+#ifdef __CUDACC__
+inline void NCCLAllReduceMean(const Resource& comm,
+                              mshadow::Tensor<gpu, 2, real_t> stats,
+                              mshadow::Stream<gpu>* s) {
+#if MXNET_USE_NCCL == 1
+  static_assert(std::is_same<real_t, float>::value, "the statistics are reduced as float");
+  ncclComm_t nccl_comm = comm.get_nccl_comm();
+  int num_ranks        = 1;
+  ncclCommCount(nccl_comm, &num_ranks);
+  const ncclResult_t ret = ncclAllReduce(stats.dptr_,
+                                         stats.dptr_,
+                                         stats.shape_.Size(),
+                                         ncclFloat,
+                                         ncclSum,
+                                         nccl_comm,
+                                         mshadow::Stream<gpu>::GetStream(s));
+  CHECK_EQ(ret, ncclSuccess) << "NCCL all reduce failed: " << ncclGetErrorString(ret);
+  stats /= static_cast<real_t>(num_ranks);
+#else
+  LOG(FATAL) << "compile with USE_NCCL=1 to use the NCCL synchronized batch norm";
+#endif  // MXNET_USE_NCCL == 1
+}
+#endif  // __CUDACC__
+
 template <typename xpu>
 class SyncBatchNorm : public Operator {
  public:
@@ -301,7 +341,25 @@ class SyncBatchNorm : public Operator {
       slope = 1.f;
 
     // whether use global statistics
-    if (ctx.is_train && !param_.use_global_stats) {
+    if (ctx.is_train && !param_.use_global_stats && param_.nccl) {
+      Tensor<xpu, 1> mean = out_data[syncbatchnorm::kMean].get<xpu, 1, real_t>(s);
+      Tensor<xpu, 1> var  = out_data[syncbatchnorm::kVar].get<xpu, 1, real_t>(s);
+      CHECK(req[syncbatchnorm::kMean] == kNullOp || req[syncbatchnorm::kMean] == kWriteTo);
+      CHECK(req[syncbatchnorm::kVar] == kNullOp || req[syncbatchnorm::kVar] == kWriteTo);
+      // E(x) and E(x^2) of all the ranks, reduced in a single call
+      Tensor<xpu, 2> stats = ctx.requested[syncbatchnorm::kTempSpace].get_space<xpu>(
+          mshadow::Shape2(2, mean.shape_[0]), s);
+      stats[0] = scale * sumall_except_dim<1>(data);
+      stats[1] = scale * sumall_except_dim<1>(F<mshadow_op::square>(data));
+      NCCLAllReduceMean(ctx.requested[syncbatchnorm::kNCCLComm], stats, s);
+      mshadow::Copy(mean, stats[0], s);
+      var = stats[1] - F<mshadow_op::square>(mean);
+      Assign(out,
+             req[syncbatchnorm::kOut],
+             broadcast<1>(slope, out.shape_) * (data - broadcast<1>(mean, data.shape_)) /
+                     F<mshadow_op::square_root>(broadcast<1>(var + param_.eps, data.shape_)) +
+                 broadcast<1>(bias, out.shape_));
+    } else if (ctx.is_train && !param_.use_global_stats) {
       // get my rank
       Barrier* global_barrier = global_shared_barrier_forward.Register(param_.key, param_.ndev);
       int myRank              = global_shared_rank_forward.Register(param_.key, param_.ndev);
@@ -397,9 +455,6 @@ class SyncBatchNorm : public Operator {
       slope = 1.f;
 
     if (ctx.is_train && !param_.use_global_stats) {
-      // get my rank
-      Barrier* global_barrier = global_shared_barrier_backward.Register(param_.key, param_.ndev);
-      int myRank              = global_shared_rank_backward.Register(param_.key, param_.ndev);
       // get requested temp space
       Tensor<xpu, 2> workspace = ctx.requested[syncbatchnorm::kTempSpace].get_space<xpu>(
           mshadow::Shape2(5, mean.shape_[0]), s);
@@ -413,23 +468,31 @@ class SyncBatchNorm : public Operator {
       Tensor<xpu, 1> sumProd = workspace[4];
       sumGrad                = sumall_except_dim<1>(grad);
       sumProd = sumall_except_dim<1>(grad * (data - broadcast<1>(mean, data.shape_)));
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedGrad =
-          global_shared_grad.Register(param_.key, param_.ndev);
-      SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedProd =
-          global_shared_prod.Register(param_.key, param_.ndev);
-      // copy to cpu, push and pull
-      Tensor<cpu, 1, real_t>* grad_cpu_ptr = sharedGrad->Retrieve(sumGrad.shape_, myRank);
-      Tensor<cpu, 1, real_t>* prod_cpu_ptr = sharedProd->Retrieve(sumGrad.shape_, myRank);
-      mshadow::Copy(*grad_cpu_ptr, sumGrad, s);
-      mshadow::Copy(*prod_cpu_ptr, sumProd, s);
-      sharedGrad->SetReady(myRank);
-      sharedProd->SetReady(myRank);
-      global_barrier->Wait();
-      Tensor<cpu, 1, real_t> grad_cpu = sharedGrad->Pop(myRank);
-      Tensor<cpu, 1, real_t> prod_cpu = sharedProd->Pop(myRank);
-      // copy back to gpu
-      mshadow::Copy(sumGrad, grad_cpu, s);
-      mshadow::Copy(sumProd, prod_cpu, s);
+      if (param_.nccl) {
+        // the rows of sumGrad and sumProd are reduced in a single call
+        NCCLAllReduceMean(ctx.requested[syncbatchnorm::kNCCLComm], workspace.Slice(3, 5), s);
+      } else {
+        // get my rank
+        Barrier* global_barrier = global_shared_barrier_backward.Register(param_.key, param_.ndev);
+        int myRank              = global_shared_rank_backward.Register(param_.key, param_.ndev);
+        SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedGrad =
+            global_shared_grad.Register(param_.key, param_.ndev);
+        SharedND<mshadow::Tensor<cpu, 1, real_t>>* sharedProd =
+            global_shared_prod.Register(param_.key, param_.ndev);
+        // copy to cpu, push and pull
+        Tensor<cpu, 1, real_t>* grad_cpu_ptr = sharedGrad->Retrieve(sumGrad.shape_, myRank);
+        Tensor<cpu, 1, real_t>* prod_cpu_ptr = sharedProd->Retrieve(sumGrad.shape_, myRank);
+        mshadow::Copy(*grad_cpu_ptr, sumGrad, s);
+        mshadow::Copy(*prod_cpu_ptr, sumProd, s);
+        sharedGrad->SetReady(myRank);
+        sharedProd->SetReady(myRank);
+        global_barrier->Wait();
+        Tensor<cpu, 1, real_t> grad_cpu = sharedGrad->Pop(myRank);
+        Tensor<cpu, 1, real_t> prod_cpu = sharedProd->Pop(myRank);
+        // copy back to gpu
+        mshadow::Copy(sumGrad, grad_cpu, s);
+        mshadow::Copy(sumProd, prod_cpu, s);
+      }
 
       gvar  = -1.0f * sumProd * slope * F<mshadow_op::power>(var + param_.eps, -1.5f);
       gmean = sumGrad * slope;
@@ -566,8 +629,12 @@ class SyncBatchNormProp : public OperatorProperty {
             in_data[syncbatchnorm::kGamma]};
   }
 
+  std::vector<ResourceRequest> ForwardResource(const mxnet::ShapeVector& in_shape) const override {
+    return NCCLResource();
+  }
+
   std::vector<ResourceRequest> BackwardResource(const mxnet::ShapeVector& in_shape) const override {
-    return {ResourceRequest::kTempSpace};
+    return param_.nccl ? NCCLResource() : std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
   }
 
   int NumVisibleOutputs() const override {
@@ -607,6 +674,18 @@ class SyncBatchNormProp : public OperatorProperty {
   }
 
  private:
+  // the temp space and the communicator of the NCCL statistics, none without it
+  std::vector<ResourceRequest> NCCLResource() const {
+    if (!param_.nccl)
+      return {};
+#if MXNET_USE_NCCL == 1
+    return {ResourceRequest::kTempSpace, ResourceRequest::kNCCLComm};
+#else
+    LOG(FATAL) << "compile with USE_NCCL=1 to use the NCCL synchronized batch norm";
+    return {};
+#endif  // MXNET_USE_NCCL == 1
+  }
+
   SyncBatchNormParam param_;
 };  // class SyncBatchNormProp
 
@@ -25,6 +25,7 @@
 #define MXNET_OPERATOR_CONTRIB_TRANSFORMER_INL_H_
 
 #include <mxnet/operator_util.h>
+#include <type_traits>
 #include <vector>
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
@@ -40,6 +41,20 @@ struct InterleavedMatMulParam : public dmlc::Parameter<InterleavedMatMulParam> {
   }
 };
 
+struct InterleavedSelfAttParam : public dmlc::Parameter<InterleavedSelfAttParam> {
+  int heads;
+  bool masked;
+  float temperature;
+  DMLC_DECLARE_PARAMETER(InterleavedSelfAttParam) {
+    DMLC_DECLARE_FIELD(heads).describe("Set number of heads");
+    DMLC_DECLARE_FIELD(masked).set_default(false).describe(
+        "Whether a boolean mask selects the keys each query attends to");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(1.0f)
+        .describe("Temperature of the softmax, which divides the scores");
+  }
+};
+
 template <typename xpu>
 static void DivSqrtDimForward_(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
@@ -302,6 +317,95 @@ void SldWinAttenContextBackward(const nnvm::NodeAttrs& attrs,
       ctx, outputs.at(1), inputs.at(1), inputs.at(0), inputs.at(3), true, true, param.w, w_right);
 }
 
+struct InterleavedKVCacheParam : public dmlc::Parameter<InterleavedKVCacheParam> {
+  int heads;
+  float temperature;
+  DMLC_DECLARE_PARAMETER(InterleavedKVCacheParam) {
+    DMLC_DECLARE_FIELD(heads).describe("Set number of heads");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(1.0f)
+        .describe("Temperature of the softmax, which divides the scores");
+  }
+};
+
+/*!
+ * \brief copy the keys and values of the new tokens after the tokens of the cache, and their
+ *  queries to the output. Tokens past the capacity of the cache are dropped.
+ */
+struct KVCacheAppend {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* queries,
+                                  DType* cache,
+                                  const DType* qkv,
+                                  const int32_t* length,
+                                  const index_t head_dim,
+                                  const index_t attn_batches,
+                                  const index_t capacity) {
+    const index_t dim   = i % head_dim;
+    const index_t batch = (i / head_dim) % attn_batches;
+    const index_t step  = i / (head_dim * attn_batches);
+    const DType* src    = qkv + (step * attn_batches + batch) * 3 * head_dim + dim;
+    queries[i]          = src[0];
+    const index_t pos   = length[0] + step;
+    if (pos < capacity) {
+      DType* dst    = cache + (pos * attn_batches + batch) * 2 * head_dim + dim;
+      dst[0]        = src[head_dim];
+      dst[head_dim] = src[2 * head_dim];
+    }
+  }
+};
+
+struct KVCacheGrow {
+  MSHADOW_XINLINE static void Map(int i,
+                                  int32_t* length,
+                                  const int32_t steps,
+                                  const int32_t capacity) {
+    length[0] = length[0] + steps < capacity ? length[0] + steps : capacity;
+  }
+};
+
+template <typename xpu>
+void InterleavedKVCacheAppendForward(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  // inputs: queries_keys_values, cache, length. The cache and the length are updated in place.
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req[0], kWriteTo) << "interleaved_kv_cache_append only supports kWriteTo";
+  CHECK_EQ(inputs[2].type_flag_, mshadow::kInt32);
+  const auto& params         = nnvm::get<InterleavedKVCacheParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s    = ctx.get_stream<xpu>();
+  const mxnet::TShape& qkv   = inputs[0].shape_;
+  const index_t head_dim     = qkv[2] / 3 / params.heads;
+  const index_t attn_batches = params.heads * qkv[1];
+  const index_t capacity     = inputs[1].shape_[0];
+  const int32_t* length      = inputs[2].dptr<int32_t>();
+  if (std::is_same<xpu, cpu>::value) {
+    CHECK_LE(length[0] + qkv[0], capacity)
+        << "the cache of " << capacity << " tokens cannot hold " << length[0] + qkv[0];
+  }
+  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    mxnet_op::Kernel<KVCacheAppend, xpu>::Launch(s,
+                                                 outputs[0].Size(),
+                                                 outputs[0].dptr<DType>(),
+                                                 inputs[1].dptr<DType>(),
+                                                 inputs[0].dptr<DType>(),
+                                                 length,
+                                                 head_dim,
+                                                 attn_batches,
+                                                 capacity);
+  });
+  // after all the copies have read the length
+  mxnet_op::Kernel<KVCacheGrow, xpu>::Launch(s,
+                                             1,
+                                             inputs[2].dptr<int32_t>(),
+                                             static_cast<int32_t>(qkv[0]),
+                                             static_cast<int32_t>(capacity));
+}
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_CONTRIB_TRANSFORMER_INL_H_
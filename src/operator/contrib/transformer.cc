@@ -22,6 +22,8 @@
  * \brief CPU implementation of the operators used in Transformer
  */
 #include <mxnet/base.h>
+#include <algorithm>
+#include <limits>
 #include "./transformer-inl.h"
 #include "../tensor/elemwise_unary_op.h"
 
@@ -29,6 +31,8 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(InterleavedMatMulParam);
+DMLC_REGISTER_PARAMETER(InterleavedSelfAttParam);
+DMLC_REGISTER_PARAMETER(InterleavedKVCacheParam);
 
 static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
                                             mxnet::ShapeVector* in_shape,
@@ -773,6 +777,350 @@ NNVM_REGISTER_OP(_backward_interleaved_matmul_selfatt_valatt)
     .set_attr_parser(ParamParser<InterleavedMatMulParam>)
     .set_attr<FCompute>("FCompute<cpu>", BackwardInterleavedMatMulSelfAttValAttCPU);
 
+static bool InterleavedSelfAttShape(const NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_shape,
+                                    mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), params.masked ? 2U : 1U)
+      << "Input:[queries_keys_values" << (params.masked ? ", mask" : "")
+      << "] currently have, " << in_shape->size() << " inputs";
+  auto qkv_shape = in_shape->at(0);
+  if (!mxnet::ndim_is_known(qkv_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in seq_length-batch-3*proj_dim, "
+      << "currently is: " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (3 * params.heads), 0)
+      << "queries_keys_values.shape[2] should be a multiple of 3 * heads, "
+      << "currently is " << qkv_shape[2];
+  if (params.masked && mxnet::ndim_is_known(in_shape->at(1))) {
+    const mxnet::TShape scores({params.heads * qkv_shape[1], qkv_shape[0], qkv_shape[0]});
+    const auto& mask_shape = in_shape->at(1);
+    CHECK_EQ(mask_shape.ndim(), 3U) << "Input mask should be 3D in batch-seq_length-seq_length, "
+                                    << "currently is: " << mask_shape.ndim() << "D";
+    for (int i = 0; i < 3; ++i) {
+      CHECK(mask_shape[i] == 1 || mask_shape[i] == scores[i])
+          << "mask of shape " << mask_shape << " does not broadcast to the scores " << scores;
+    }
+  }
+  out_shape->resize(2);
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / 3}));
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, mxnet::TShape({params.heads * qkv_shape[1], qkv_shape[0]}));
+  return true;
+}
+
+static bool InterleavedSelfAttType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_types,
+                                   std::vector<int>* out_types) {
+  const auto& params = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+  CHECK_EQ(in_types->size(), params.masked ? 2U : 1U);
+  out_types->resize(2);
+  TYPE_ASSIGN_CHECK(*out_types, 0, in_types->at(0));
+  TYPE_ASSIGN_CHECK(*in_types, 0, out_types->at(0));
+  if (params.masked)
+    TYPE_ASSIGN_CHECK(*in_types, 1, mshadow::kBool);
+  TYPE_ASSIGN_CHECK(*out_types, 1, mshadow::kFloat32);
+  return out_types->at(0) != -1;
+}
+
+NNVM_REGISTER_OP(_contrib_interleaved_selfatt)
+    .add_alias("_npx_interleaved_selfatt")
+    .describe(R"code(Compute the self attention of the interleaved projections of queries, keys
+and values in one pass, without materializing the attention maps.
+
+the input must be a single tensor of interleaved projections
+of queries, keys and values following the layout:
+(seq_length, batch_size, num_heads * head_dim * 3)
+
+and the optional boolean mask must broadcast to the scores:
+(batch_size * num_heads, seq_length, seq_length)
+
+the equivalent code would be::
+
+    scores = mx.nd.contrib.interleaved_matmul_selfatt_qk(queries_keys_values, heads=heads)
+    attention = mx.nd.masked_softmax(scores, mask, axis=-1, temperature=temperature)
+    output = mx.nd.contrib.interleaved_matmul_selfatt_valatt(queries_keys_values, attention,
+                                                             heads=heads)
+
+The queries which attend to no key get zeros, like with masked_softmax. Only implemented on GPU,
+where the head_dim of the heads must be at most 128. The CachedOp of a hybridized block rewrites
+the graphs above into this operator on GPU when MXNET_USE_FUSED_ATTENTION is set.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+      return params.masked ? 2 : 1;
+    })
+    .set_num_outputs(2)
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<InterleavedSelfAttParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const auto& params =
+                                           nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+                                       if (params.masked)
+                                         return std::vector<std::string>{"queries_keys_values",
+                                                                         "mask"};
+                                       return std::vector<std::string>{"queries_keys_values"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "logsumexp"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", InterleavedSelfAttShape)
+    .set_attr<nnvm::FInferType>("FInferType", InterleavedSelfAttType)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          // the backward recomputes the attention maps from the output and its logsumexp
+          std::vector<nnvm::NodeEntry> heads{ograds[0]};
+          heads.insert(heads.end(), n->inputs.begin(), n->inputs.end());
+          heads.emplace_back(n, 0, 0);
+          heads.emplace_back(n, 1, 0);
+          return MakeGradNode("_backward_interleaved_selfatt", n, heads, n->attrs.dict);
+        })
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Interleaved queries, keys and values")
+    .add_argument("mask", "NDArray-or-Symbol", "Keys each query attends to")
+    .add_arguments(InterleavedSelfAttParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_interleaved_selfatt)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+      return params.masked ? 5 : 4;
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      const auto& params = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+      return params.masked ? 2 : 1;
+    })
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr_parser(ParamParser<InterleavedSelfAttParam>);
+
+static bool InterleavedKVCacheAppendShape(const NodeAttrs& attrs,
+                                          mxnet::ShapeVector* in_shape,
+                                          mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedKVCacheParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 3U) << "Input:[queries_keys_values, cache, length] currently have, "
+                                 << in_shape->size() << " inputs";
+  SHAPE_ASSIGN_CHECK(*in_shape, 2, mxnet::TShape({1}));
+  const auto& qkv_shape = in_shape->at(0);
+  if (!mxnet::ndim_is_known(qkv_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in seq_length-batch-3*proj_dim, "
+      << "currently is: " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (3 * params.heads), 0)
+      << "queries_keys_values.shape[2] should be a multiple of 3 * heads, "
+      << "currently is " << qkv_shape[2];
+  // the capacity of the cache is only known from the cache
+  const auto& cache_shape = in_shape->at(1);
+  if (!mxnet::ndim_is_known(cache_shape))
+    return false;
+  CHECK_EQ(cache_shape.ndim(), 3U) << "Input cache should be 3D in capacity-batch-2*proj_dim, "
+                                   << "currently is: " << cache_shape.ndim() << "D";
+  CHECK_EQ(cache_shape[1], qkv_shape[1]) << "the batches of the cache and the tokens differ";
+  CHECK_EQ(cache_shape[2] * 3, qkv_shape[2] * 2)
+      << "the cache holds keys and values of " << cache_shape[2] / 2 << " dimensions, "
+      << "the tokens of " << qkv_shape[2] / 3;
+  out_shape->resize(1);
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / 3}));
+  return true;
+}
+
+static bool InterleavedKVCacheAttendShape(const NodeAttrs& attrs,
+                                          mxnet::ShapeVector* in_shape,
+                                          mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedKVCacheParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), 3U) << "Input:[queries, cache, length] currently have, "
+                                 << in_shape->size() << " inputs";
+  SHAPE_ASSIGN_CHECK(*in_shape, 2, mxnet::TShape({1}));
+  const auto& q_shape     = in_shape->at(0);
+  const auto& cache_shape = in_shape->at(1);
+  if (!mxnet::ndim_is_known(q_shape) || !mxnet::ndim_is_known(cache_shape))
+    return false;
+  CHECK_EQ(q_shape.ndim(), 3U) << "Input queries should be 3D in seq_length-batch-proj_dim, "
+                               << "currently is: " << q_shape.ndim() << "D";
+  CHECK_EQ(q_shape[2] % params.heads, 0)
+      << "queries.shape[2] should be a multiple of heads, currently is " << q_shape[2];
+  CHECK_EQ(cache_shape.ndim(), 3U) << "Input cache should be 3D in capacity-batch-2*proj_dim, "
+                                   << "currently is: " << cache_shape.ndim() << "D";
+  CHECK_EQ(cache_shape[1], q_shape[1]) << "the batches of the cache and the queries differ";
+  CHECK_EQ(cache_shape[2], q_shape[2] * 2)
+      << "the cache holds keys and values of " << cache_shape[2] / 2 << " dimensions, "
+      << "the queries of " << q_shape[2];
+  out_shape->resize(1);
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, q_shape);
+  return true;
+}
+
+static bool InterleavedKVCacheType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_attrs,
+                                   std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  out_attrs->resize(1);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, out_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, in_attrs->at(1));
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  return out_attrs->at(0) != -1;
+}
+
+void InterleavedKVCacheAttendCPU(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  CHECK_EQ(req[0], kWriteTo) << "interleaved_kv_cache_attend only supports kWriteTo";
+  CHECK_EQ(inputs[2].type_flag_, mshadow::kInt32);
+  const auto& params         = nnvm::get<InterleavedKVCacheParam>(attrs.parsed);
+  const index_t steps        = inputs[0].shape_[0];
+  const index_t attn_batches = params.heads * inputs[0].shape_[1];
+  const index_t head_dim     = inputs[0].shape_[2] / params.heads;
+  const index_t length       = inputs[2].dptr<int32_t>()[0];
+  CHECK_GE(length, steps) << "the cache of " << length << " tokens misses the queried tokens";
+  const float scale = 1.0f / (params.temperature * std::sqrt(static_cast<float>(head_dim)));
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    const DType* queries = inputs[0].dptr<DType>();
+    const DType* cache   = inputs[1].dptr<DType>();
+    DType* out           = outputs[0].dptr<DType>();
+#pragma omp parallel num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+    {
+      std::vector<float> acc(head_dim);
+#pragma omp for
+      for (index_t i = 0; i < steps * attn_batches; ++i) {
+        // the tokens of the cache up to the query, with a running softmax over them
+        const index_t keys = length - steps + i / attn_batches + 1;
+        const DType* query = queries + i * head_dim;
+        const DType* kv    = cache + (i % attn_batches) * 2 * head_dim;
+        float row_max      = -std::numeric_limits<float>::infinity();
+        float row_sum      = 0.f;
+        std::fill(acc.begin(), acc.end(), 0.f);
+        for (index_t k = 0; k < keys; ++k) {
+          const DType* key   = kv + k * attn_batches * 2 * head_dim;
+          const DType* value = key + head_dim;
+          float score        = 0.f;
+          for (index_t d = 0; d < head_dim; ++d)
+            score += static_cast<float>(query[d]) * static_cast<float>(key[d]);
+          score *= scale;
+          if (score > row_max) {
+            const float rescale = std::exp(row_max - score);
+            row_sum *= rescale;
+            for (index_t d = 0; d < head_dim; ++d)
+              acc[d] *= rescale;
+            row_max = score;
+          }
+          const float p = std::exp(score - row_max);
+          row_sum += p;
+          for (index_t d = 0; d < head_dim; ++d)
+            acc[d] += p * static_cast<float>(value[d]);
+        }
+        for (index_t d = 0; d < head_dim; ++d)
+          out[i * head_dim + d] = static_cast<DType>(acc[d] / row_sum);
+      }
+    }
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_interleaved_kv_cache_append)
+    .add_alias("_npx_interleaved_kv_cache_append")
+    .describe(R"code(Append the keys and values of new tokens to a key-value cache, for the
+incremental decoding of self attention.
+
+the inputs are the interleaved projections of the queries, keys and values of the
+new tokens, following the layout:
+(seq_length, batch_size, num_heads * head_dim * 3)
+
+the cache, which holds the interleaved keys and values of the previous tokens:
+(capacity, batch_size, num_heads * head_dim * 2)
+
+and the number of tokens in the cache, an int32 tensor of shape (1,).
+
+The keys and values are written at the end of the cache and the length is increased by
+seq_length, both in place, so neither is reallocated when decoding a token. The output is
+the queries of the new tokens, following the layout:
+(seq_length, batch_size, num_heads * head_dim)
+
+which interleaved_kv_cache_attend attends to the updated cache. In a hybridized block, the
+cache and the length are parameters with grad_req 'null', which persist across the
+invocations of the block::
+
+    queries = mx.npx.interleaved_kv_cache_append(qkv, self.cache.data(),
+                                                 self.length.data(), heads=heads)
+    out = mx.npx.interleaved_kv_cache_attend(queries, self.cache.data(),
+                                             self.length.data(), heads=heads)
+
+)code" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<InterleavedKVCacheParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"queries_keys_values", "cache", "length"};
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"queries"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", InterleavedKVCacheAppendShape)
+    .set_attr<nnvm::FInferType>("FInferType", InterleavedKVCacheType)
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{1, 2};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", InterleavedKVCacheAppendForward<cpu>)
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Interleaved queries, keys and values of the new tokens")
+    .add_argument("cache", "NDArray-or-Symbol", "Interleaved keys and values of the tokens")
+    .add_argument("length", "NDArray-or-Symbol", "Number of tokens in the cache")
+    .add_arguments(InterleavedKVCacheParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_interleaved_kv_cache_attend)
+    .add_alias("_npx_interleaved_kv_cache_attend")
+    .describe(R"code(Attend the queries of the last tokens of a key-value cache to the tokens
+of the cache up to them, a causal self attention over the cache.
+
+the inputs are the queries returned by interleaved_kv_cache_append, following the layout:
+(seq_length, batch_size, num_heads * head_dim)
+
+the cache, following the layout:
+(capacity, batch_size, num_heads * head_dim * 2)
+
+and the number of tokens in the cache, an int32 tensor of shape (1,), which includes the
+seq_length tokens of the queries.
+
+The output follows the layout of the queries. Each query costs O(length), so decoding a
+token no longer attends over the whole prefix again.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<InterleavedKVCacheParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"queries", "cache", "length"};
+        })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", InterleavedKVCacheAttendShape)
+    .set_attr<nnvm::FInferType>("FInferType", InterleavedKVCacheType)
+    .set_attr<FCompute>("FCompute<cpu>", InterleavedKVCacheAttendCPU)
+    .add_argument("queries", "NDArray-or-Symbol", "Queries of the last tokens of the cache")
+    .add_argument("cache", "NDArray-or-Symbol", "Interleaved keys and values of the tokens")
+    .add_argument("length", "NDArray-or-Symbol", "Number of tokens in the cache")
+    .add_arguments(InterleavedKVCacheParam::__FIELDS__());
+
 NNVM_REGISTER_OP(_contrib_interleaved_matmul_encdec_qk)
     .add_alias("_npx_interleaved_matmul_encdec_qk")
     .describe(R"code(Compute the matrix multiplication between the projections of
@@ -751,6 +751,521 @@ void BackwardInterleavedMatMulEncDecValAttGPU(const nnvm::NodeAttrs& attrs,
   })
 }
 
+// Tiles of the fused self attention: one query (or key) row per warp of a block, and
+// one key (or query) of a tile per lane of the warps
+constexpr int kSelfAttRows       = 8;
+constexpr int kSelfAttTile       = 32;
+constexpr int kSelfAttMaxHeadDim = 128;
+constexpr int kSelfAttStride     = kSelfAttMaxHeadDim + 1;  // no bank conflicts across lanes
+constexpr int kSelfAttPerLane    = kSelfAttMaxHeadDim / 32;
+
+/*! \brief strides of the interleaved queries, keys and values and of the mask */
+struct SelfAttGeometry {
+  index_t seq_len;
+  index_t head_dim;
+  index_t attn_batches;
+  index_t qkv_token;
+  index_t out_token;
+  index_t mask_batch;
+  index_t mask_query;
+  index_t mask_key;
+  float scale;
+};
+
+static SelfAttGeometry GetSelfAttGeometry(const InterleavedSelfAttParam& params,
+                                          const mxnet::TShape& qkv_shape,
+                                          const mxnet::TShape* mask_shape) {
+  SelfAttGeometry g;
+  g.seq_len      = qkv_shape[0];
+  g.attn_batches = params.heads * qkv_shape[1];
+  g.head_dim     = qkv_shape[2] / 3 / params.heads;
+  g.qkv_token    = qkv_shape[2] * qkv_shape[1];
+  g.out_token    = g.head_dim * g.attn_batches;
+  g.scale        = 1.0f / (params.temperature * sqrt(static_cast<float>(g.head_dim)));
+  CHECK_LE(g.head_dim, kSelfAttMaxHeadDim)
+      << "interleaved_selfatt supports heads of at most " << kSelfAttMaxHeadDim
+      << " dimensions, currently is " << g.head_dim;
+  g.mask_batch = g.mask_query = g.mask_key = 0;
+  if (mask_shape) {
+    g.mask_key   = (*mask_shape)[2] == 1 ? 0 : 1;
+    g.mask_query = (*mask_shape)[1] == 1 ? 0 : (*mask_shape)[2];
+    g.mask_batch = (*mask_shape)[0] == 1 ? 0 : (*mask_shape)[1] * (*mask_shape)[2];
+  }
+  return g;
+}
+
+__device__ inline float SelfAttWarpMax(float value) {
+#pragma unroll
+  for (int i = 16; i >= 1; i /= 2)
+    value = fmaxf(value, __shfl_xor_sync(0xffffffff, value, i));
+  return value;
+}
+
+__device__ inline float SelfAttWarpSum(float value) {
+#pragma unroll
+  for (int i = 16; i >= 1; i /= 2)
+    value += __shfl_xor_sync(0xffffffff, value, i);
+  return value;
+}
+
+/*! \brief load rows [first, first + count) of a projection to shared memory, scaled */
+template <typename DType>
+__device__ inline void SelfAttLoadRows(float* rows,
+                                       const DType* src,
+                                       const index_t first,
+                                       const int count,
+                                       const index_t stride,
+                                       const SelfAttGeometry& g,
+                                       const float scale) {
+  for (int idx = threadIdx.x; idx < count * g.head_dim; idx += blockDim.x) {
+    const int r = idx / g.head_dim;
+    const int i = idx % g.head_dim;
+    rows[r * kSelfAttStride + i] =
+        first + r < g.seq_len ? static_cast<float>(src[(first + r) * stride + i]) * scale : 0.f;
+  }
+}
+
+__device__ inline float SelfAttDot(const float* a, const float* b, const index_t head_dim) {
+  float dot = 0.f;
+  for (index_t i = 0; i < head_dim; ++i)
+    dot += a[i] * b[i];
+  return dot;
+}
+
+__device__ inline bool SelfAttAllowed(const bool* mask,
+                                      const SelfAttGeometry& g,
+                                      const index_t query,
+                                      const index_t key) {
+  return query < g.seq_len && key < g.seq_len &&
+         (mask == nullptr || mask[query * g.mask_query + key * g.mask_key]);
+}
+
+template <typename DType>
+__device__ inline void SelfAttStore(DType* dst, const float value, const bool add) {
+  *dst = add ? static_cast<DType>(static_cast<float>(*dst) + value) : static_cast<DType>(value);
+}
+
+/*!
+ * \brief attend kSelfAttRows queries of an attention batch to all the keys, with a running
+ *  softmax over the tiles of keys. Saves the logsumexp of the scores of each query.
+ */
+template <typename DType>
+__global__ void SelfAttForwardKernel(const DType* qkv,
+                                     const bool* mask,
+                                     DType* out,
+                                     float* logsumexp,
+                                     const SelfAttGeometry g) {
+  __shared__ float queries[kSelfAttRows * kSelfAttStride];
+  __shared__ float keys[kSelfAttTile * kSelfAttStride];
+  __shared__ float values[kSelfAttTile * kSelfAttStride];
+  const index_t batch = blockIdx.y;
+  const int warp      = threadIdx.x / 32;
+  const int lane      = threadIdx.x % 32;
+  const index_t first = static_cast<index_t>(blockIdx.x) * kSelfAttRows;
+  const index_t query = first + warp;
+  const DType* base   = qkv + batch * 3 * g.head_dim;
+  const bool* bmask   = mask ? mask + batch * g.mask_batch : nullptr;
+  const float* q_row  = queries + warp * kSelfAttStride;
+
+  SelfAttLoadRows(queries, base, first, kSelfAttRows, g.qkv_token, g, g.scale);
+  float row_max = -INFINITY;
+  float row_sum = 0.f;
+  float acc[kSelfAttPerLane];
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j)
+    acc[j] = 0.f;
+
+  for (index_t tile = 0; tile < g.seq_len; tile += kSelfAttTile) {
+    __syncthreads();
+    SelfAttLoadRows(keys, base + g.head_dim, tile, kSelfAttTile, g.qkv_token, g, 1.f);
+    SelfAttLoadRows(values, base + 2 * g.head_dim, tile, kSelfAttTile, g.qkv_token, g, 1.f);
+    __syncthreads();
+    if (query >= g.seq_len)
+      continue;
+    const float score = SelfAttAllowed(bmask, g, query, tile + lane) ?
+                            SelfAttDot(q_row, keys + lane * kSelfAttStride, g.head_dim) :
+                            -INFINITY;
+    const float tile_max = SelfAttWarpMax(score);
+    if (tile_max == -INFINITY)
+      continue;
+    const float new_max = fmaxf(row_max, tile_max);
+    const float rescale = __expf(row_max - new_max);
+    const float p       = score == -INFINITY ? 0.f : __expf(score - new_max);
+    row_sum             = row_sum * rescale + SelfAttWarpSum(p);
+    row_max             = new_max;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j)
+      acc[j] *= rescale;
+    for (int k = 0; k < kSelfAttTile; ++k) {
+      const float pk = __shfl_sync(0xffffffff, p, k);
+#pragma unroll
+      for (int j = 0; j < kSelfAttPerLane; ++j)
+        acc[j] += pk * values[k * kSelfAttStride + lane + 32 * j];
+    }
+  }
+
+  if (query < g.seq_len) {
+    // like masked_softmax, a query which attends to no key gets zeros
+    const float norm = row_sum > 0.f ? 1.f / row_sum : 0.f;
+    DType* out_row   = out + query * g.out_token + batch * g.head_dim;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j) {
+      if (lane + 32 * j < g.head_dim)
+        out_row[lane + 32 * j] = static_cast<DType>(acc[j] * norm);
+    }
+    if (lane == 0)
+      logsumexp[batch * g.seq_len + query] = row_sum > 0.f ? row_max + logf(row_sum) : INFINITY;
+  }
+}
+
+/*! \brief dot products of the output gradients with the outputs, one query per warp */
+template <typename DType>
+__global__ void SelfAttBackwardDotKernel(const DType* ograd,
+                                         const DType* out,
+                                         float* dots,
+                                         const SelfAttGeometry g) {
+  const index_t batch = blockIdx.y;
+  const index_t query = static_cast<index_t>(blockIdx.x) * kSelfAttRows + threadIdx.x / 32;
+  const int lane      = threadIdx.x % 32;
+  if (query >= g.seq_len)
+    return;
+  const index_t offset = query * g.out_token + batch * g.head_dim;
+  float dot            = 0.f;
+  for (index_t i = lane; i < g.head_dim; i += 32)
+    dot += static_cast<float>(ograd[offset + i]) * static_cast<float>(out[offset + i]);
+  dot = SelfAttWarpSum(dot);
+  if (lane == 0)
+    dots[batch * g.seq_len + query] = dot;
+}
+
+/*! \brief gradients of kSelfAttRows queries, over the tiles of keys */
+template <typename DType>
+__global__ void SelfAttBackwardQueryKernel(const DType* ograd,
+                                           const DType* qkv,
+                                           const bool* mask,
+                                           const float* logsumexp,
+                                           const float* dots,
+                                           DType* qkv_grad,
+                                           const bool add,
+                                           const SelfAttGeometry g) {
+  __shared__ float queries[kSelfAttRows * kSelfAttStride];
+  __shared__ float ograds[kSelfAttRows * kSelfAttStride];
+  __shared__ float keys[kSelfAttTile * kSelfAttStride];
+  __shared__ float values[kSelfAttTile * kSelfAttStride];
+  const index_t batch = blockIdx.y;
+  const int warp      = threadIdx.x / 32;
+  const int lane      = threadIdx.x % 32;
+  const index_t first = static_cast<index_t>(blockIdx.x) * kSelfAttRows;
+  const index_t query = first + warp;
+  const DType* base   = qkv + batch * 3 * g.head_dim;
+  const bool* bmask   = mask ? mask + batch * g.mask_batch : nullptr;
+  const float* q_row  = queries + warp * kSelfAttStride;
+  const float* o_row  = ograds + warp * kSelfAttStride;
+
+  SelfAttLoadRows(queries, base, first, kSelfAttRows, g.qkv_token, g, g.scale);
+  SelfAttLoadRows(
+      ograds, ograd + batch * g.head_dim, first, kSelfAttRows, g.out_token, g, 1.f);
+  const float lse = query < g.seq_len ? logsumexp[batch * g.seq_len + query] : 0.f;
+  const float dot = query < g.seq_len ? dots[batch * g.seq_len + query] : 0.f;
+  float acc[kSelfAttPerLane];
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j)
+    acc[j] = 0.f;
+
+  for (index_t tile = 0; tile < g.seq_len; tile += kSelfAttTile) {
+    __syncthreads();
+    SelfAttLoadRows(keys, base + g.head_dim, tile, kSelfAttTile, g.qkv_token, g, 1.f);
+    SelfAttLoadRows(values, base + 2 * g.head_dim, tile, kSelfAttTile, g.qkv_token, g, 1.f);
+    __syncthreads();
+    if (query >= g.seq_len)
+      continue;
+    float dscore = 0.f;
+    if (SelfAttAllowed(bmask, g, query, tile + lane)) {
+      const float p  = __expf(SelfAttDot(q_row, keys + lane * kSelfAttStride, g.head_dim) - lse);
+      const float dp = SelfAttDot(o_row, values + lane * kSelfAttStride, g.head_dim);
+      dscore         = p * (dp - dot);
+    }
+    for (int k = 0; k < kSelfAttTile; ++k) {
+      const float dk = __shfl_sync(0xffffffff, dscore, k);
+#pragma unroll
+      for (int j = 0; j < kSelfAttPerLane; ++j)
+        acc[j] += dk * keys[k * kSelfAttStride + lane + 32 * j];
+    }
+  }
+
+  if (query < g.seq_len) {
+    DType* grad_row = qkv_grad + query * g.qkv_token + batch * 3 * g.head_dim;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j) {
+      if (lane + 32 * j < g.head_dim)
+        SelfAttStore(grad_row + lane + 32 * j, acc[j] * g.scale, add);
+    }
+  }
+}
+
+/*! \brief gradients of kSelfAttRows keys and values, over the tiles of queries */
+template <typename DType>
+__global__ void SelfAttBackwardKeyKernel(const DType* ograd,
+                                         const DType* qkv,
+                                         const bool* mask,
+                                         const float* logsumexp,
+                                         const float* dots,
+                                         DType* qkv_grad,
+                                         const bool add,
+                                         const SelfAttGeometry g) {
+  __shared__ float keys[kSelfAttRows * kSelfAttStride];
+  __shared__ float values[kSelfAttRows * kSelfAttStride];
+  __shared__ float queries[kSelfAttTile * kSelfAttStride];
+  __shared__ float ograds[kSelfAttTile * kSelfAttStride];
+  const index_t batch = blockIdx.y;
+  const int warp      = threadIdx.x / 32;
+  const int lane      = threadIdx.x % 32;
+  const index_t first = static_cast<index_t>(blockIdx.x) * kSelfAttRows;
+  const index_t key   = first + warp;
+  const DType* base   = qkv + batch * 3 * g.head_dim;
+  const bool* bmask   = mask ? mask + batch * g.mask_batch : nullptr;
+  const float* k_row  = keys + warp * kSelfAttStride;
+  const float* v_row  = values + warp * kSelfAttStride;
+
+  SelfAttLoadRows(keys, base + g.head_dim, first, kSelfAttRows, g.qkv_token, g, 1.f);
+  SelfAttLoadRows(values, base + 2 * g.head_dim, first, kSelfAttRows, g.qkv_token, g, 1.f);
+  float key_acc[kSelfAttPerLane];
+  float value_acc[kSelfAttPerLane];
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j)
+    key_acc[j] = value_acc[j] = 0.f;
+
+  for (index_t tile = 0; tile < g.seq_len; tile += kSelfAttTile) {
+    __syncthreads();
+    SelfAttLoadRows(queries, base, tile, kSelfAttTile, g.qkv_token, g, g.scale);
+    SelfAttLoadRows(
+        ograds, ograd + batch * g.head_dim, tile, kSelfAttTile, g.out_token, g, 1.f);
+    __syncthreads();
+    if (key >= g.seq_len)
+      continue;
+    const index_t query = tile + lane;
+    float p             = 0.f;
+    float dscore        = 0.f;
+    if (SelfAttAllowed(bmask, g, query, key)) {
+      const float lse = logsumexp[batch * g.seq_len + query];
+      p = __expf(SelfAttDot(queries + lane * kSelfAttStride, k_row, g.head_dim) - lse);
+      const float dp = SelfAttDot(ograds + lane * kSelfAttStride, v_row, g.head_dim);
+      dscore         = p * (dp - dots[batch * g.seq_len + query]);
+    }
+    for (int q = 0; q < kSelfAttTile; ++q) {
+      const float pq = __shfl_sync(0xffffffff, p, q);
+      const float dq = __shfl_sync(0xffffffff, dscore, q);
+#pragma unroll
+      for (int j = 0; j < kSelfAttPerLane; ++j) {
+        value_acc[j] += pq * ograds[q * kSelfAttStride + lane + 32 * j];
+        key_acc[j] += dq * queries[q * kSelfAttStride + lane + 32 * j];
+      }
+    }
+  }
+
+  if (key < g.seq_len) {
+    DType* grad_row = qkv_grad + key * g.qkv_token + batch * 3 * g.head_dim;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j) {
+      if (lane + 32 * j < g.head_dim) {
+        SelfAttStore(grad_row + g.head_dim + lane + 32 * j, key_acc[j], add);
+        SelfAttStore(grad_row + 2 * g.head_dim + lane + 32 * j, value_acc[j], add);
+      }
+    }
+  }
+}
+
+void InterleavedSelfAttGPU(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  const auto& params         = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s    = ctx.get_stream<gpu>();
+  const SelfAttGeometry geom =
+      GetSelfAttGeometry(params, inputs[0].shape_, params.masked ? &inputs[1].shape_ : nullptr);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo) << "interleaved_selfatt only supports kWriteTo";
+  const dim3 blocks((geom.seq_len + kSelfAttRows - 1) / kSelfAttRows, geom.attn_batches);
+  const bool* mask = params.masked ? inputs[1].dptr<bool>() : nullptr;
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    SelfAttForwardKernel<<<blocks, kSelfAttRows * 32, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+        inputs[0].dptr<DType>(), mask, outputs[0].dptr<DType>(), outputs[1].dptr<float>(), geom);
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(SelfAttForwardKernel);
+}
+
+void BackwardInterleavedSelfAttGPU(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  // inputs: output gradient, queries_keys_values, (mask), output, logsumexp
+  const auto& params         = nnvm::get<InterleavedSelfAttParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s    = ctx.get_stream<gpu>();
+  cudaStream_t stream        = mshadow::Stream<gpu>::GetStream(s);
+  const TBlob& ograd         = inputs[0];
+  const TBlob& qkv           = inputs[1];
+  const TBlob& out           = inputs[params.masked ? 3 : 2];
+  const TBlob& logsumexp     = inputs[params.masked ? 4 : 3];
+  const SelfAttGeometry geom =
+      GetSelfAttGeometry(params, qkv.shape_, params.masked ? &inputs[2].shape_ : nullptr);
+  const bool* mask = params.masked ? inputs[2].dptr<bool>() : nullptr;
+  if (params.masked && req[1] != kNullOp && req[1] != kAddTo) {
+    CUDA_CALL(cudaMemsetAsync(outputs[1].dptr_, 0, outputs[1].Size() * sizeof(bool), stream));
+  }
+  if (req[0] == kNullOp)
+    return;
+
+  mshadow::Tensor<gpu, 1, float> dots = ctx.requested[0].get_space_typed<gpu, 1, float>(
+      mshadow::Shape1(geom.attn_batches * geom.seq_len), s);
+  const dim3 blocks((geom.seq_len + kSelfAttRows - 1) / kSelfAttRows, geom.attn_batches);
+  const bool add = req[0] == kAddTo;
+  MSHADOW_REAL_TYPE_SWITCH(qkv.type_flag_, DType, {
+    SelfAttBackwardDotKernel<<<blocks, kSelfAttRows * 32, 0, stream>>>(
+        ograd.dptr<DType>(), out.dptr<DType>(), dots.dptr_, geom);
+    SelfAttBackwardQueryKernel<<<blocks, kSelfAttRows * 32, 0, stream>>>(ograd.dptr<DType>(),
+                                                                         qkv.dptr<DType>(),
+                                                                         mask,
+                                                                         logsumexp.dptr<float>(),
+                                                                         dots.dptr_,
+                                                                         outputs[0].dptr<DType>(),
+                                                                         add,
+                                                                         geom);
+    SelfAttBackwardKeyKernel<<<blocks, kSelfAttRows * 32, 0, stream>>>(ograd.dptr<DType>(),
+                                                                       qkv.dptr<DType>(),
+                                                                       mask,
+                                                                       logsumexp.dptr<float>(),
+                                                                       dots.dptr_,
+                                                                       outputs[0].dptr<DType>(),
+                                                                       add,
+                                                                       geom);
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(SelfAttBackwardKeyKernel);
+}
+
+/*!
+ * \brief attend a query of an attention batch to the tokens of the cache up to it. The warps
+ *  of the block take every kSelfAttRows-th token with a running softmax each, and the lanes
+ *  of a warp split the dimensions of the head.
+ */
+template <typename DType>
+__global__ void KVCacheAttendKernel(const DType* queries,
+                                    const DType* cache,
+                                    const int32_t* length,
+                                    DType* out,
+                                    const index_t attn_batches,
+                                    const index_t head_dim,
+                                    const index_t capacity,
+                                    const float scale) {
+  __shared__ float warp_max[kSelfAttRows];
+  __shared__ float warp_sum[kSelfAttRows];
+  __shared__ float warp_acc[kSelfAttRows * kSelfAttStride];
+  const index_t row  = static_cast<index_t>(blockIdx.x) * attn_batches + blockIdx.y;
+  const int warp     = threadIdx.x / 32;
+  const int lane     = threadIdx.x % 32;
+  const DType* kv    = cache + blockIdx.y * 2 * head_dim;
+  const index_t keys = min(static_cast<index_t>(length[0]) - gridDim.x + blockIdx.x + 1, capacity);
+
+  float query[kSelfAttPerLane];
+  float acc[kSelfAttPerLane];
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j) {
+    const index_t dim = lane + 32 * j;
+    query[j] = dim < head_dim ? static_cast<float>(queries[row * head_dim + dim]) * scale : 0.f;
+    acc[j]   = 0.f;
+  }
+  float row_max = -INFINITY;
+  float row_sum = 0.f;
+  for (index_t k = warp; k < keys; k += kSelfAttRows) {
+    const DType* key = kv + k * attn_batches * 2 * head_dim;
+    float dot        = 0.f;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j) {
+      if (lane + 32 * j < head_dim)
+        dot += query[j] * static_cast<float>(key[lane + 32 * j]);
+    }
+    const float score   = SelfAttWarpSum(dot);
+    const float new_max = fmaxf(row_max, score);
+    const float rescale = __expf(row_max - new_max);
+    const float p       = __expf(score - new_max);
+    row_sum             = row_sum * rescale + p;
+    row_max             = new_max;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j) {
+      if (lane + 32 * j < head_dim)
+        acc[j] = acc[j] * rescale + p * static_cast<float>(key[head_dim + lane + 32 * j]);
+    }
+  }
+  if (lane == 0) {
+    warp_max[warp] = row_max;
+    warp_sum[warp] = row_sum;
+  }
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j)
+    warp_acc[warp * kSelfAttStride + lane + 32 * j] = acc[j];
+  __syncthreads();
+
+  // merge the running softmaxes of the warps
+  if (warp != 0)
+    return;
+  float block_max = -INFINITY;
+  for (int w = 0; w < kSelfAttRows; ++w)
+    block_max = fmaxf(block_max, warp_max[w]);
+  float block_sum = 0.f;
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j)
+    acc[j] = 0.f;
+  for (int w = 0; w < kSelfAttRows; ++w) {
+    if (warp_sum[w] == 0.f)
+      continue;
+    const float rescale = __expf(warp_max[w] - block_max);
+    block_sum += warp_sum[w] * rescale;
+#pragma unroll
+    for (int j = 0; j < kSelfAttPerLane; ++j)
+      acc[j] += warp_acc[w * kSelfAttStride + lane + 32 * j] * rescale;
+  }
+  const float norm = block_sum > 0.f ? 1.f / block_sum : 0.f;
+#pragma unroll
+  for (int j = 0; j < kSelfAttPerLane; ++j) {
+    if (lane + 32 * j < head_dim)
+      out[row * head_dim + lane + 32 * j] = static_cast<DType>(acc[j] * norm);
+  }
+}
+
+void InterleavedKVCacheAttendGPU(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  CHECK_EQ(req[0], kWriteTo) << "interleaved_kv_cache_attend only supports kWriteTo";
+  CHECK_EQ(inputs[2].type_flag_, mshadow::kInt32);
+  const auto& params         = nnvm::get<InterleavedKVCacheParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s    = ctx.get_stream<gpu>();
+  const index_t steps        = inputs[0].shape_[0];
+  const index_t attn_batches = params.heads * inputs[0].shape_[1];
+  const index_t head_dim     = inputs[0].shape_[2] / params.heads;
+  CHECK_LE(head_dim, kSelfAttMaxHeadDim)
+      << "interleaved_kv_cache_attend supports heads of at most " << kSelfAttMaxHeadDim
+      << " dimensions, currently is " << head_dim;
+  const float scale = 1.0f / (params.temperature * sqrt(static_cast<float>(head_dim)));
+  // the length stays on the device, the queries missing from the cache get zeros
+  const dim3 blocks(steps, attn_batches);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    KVCacheAttendKernel<<<blocks, kSelfAttRows * 32, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+        inputs[0].dptr<DType>(),
+        inputs[1].dptr<DType>(),
+        inputs[2].dptr<int32_t>(),
+        outputs[0].dptr<DType>(),
+        attn_batches,
+        head_dim,
+        inputs[1].shape_[0],
+        scale);
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(KVCacheAttendKernel);
+}
+
 NNVM_REGISTER_OP(_contrib_interleaved_matmul_selfatt_qk)
     .set_attr<FCompute>("FCompute<gpu>", InterleavedMatMulSelfAttQKGPU);
 
@@ -775,6 +1290,18 @@ NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_qk)
 NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_valatt)
     .set_attr<FCompute>("FCompute<gpu>", BackwardInterleavedMatMulEncDecValAttGPU);
 
+NNVM_REGISTER_OP(_contrib_interleaved_selfatt)
+    .set_attr<FCompute>("FCompute<gpu>", InterleavedSelfAttGPU);
+
+NNVM_REGISTER_OP(_backward_interleaved_selfatt)
+    .set_attr<FCompute>("FCompute<gpu>", BackwardInterleavedSelfAttGPU);
+
+NNVM_REGISTER_OP(_contrib_interleaved_kv_cache_append)
+    .set_attr<FCompute>("FCompute<gpu>", InterleavedKVCacheAppendForward<gpu>);
+
+NNVM_REGISTER_OP(_contrib_interleaved_kv_cache_attend)
+    .set_attr<FCompute>("FCompute<gpu>", InterleavedKVCacheAttendGPU);
+
 // relu
 NNVM_REGISTER_OP(_contrib_div_sqrt_dim)
     .set_attr<FCompute>("FCompute<gpu>", DivSqrtDimForward_<gpu>);
@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tuned.cc
+ * \brief Dispatch of native operators to the TVM kernels tuned for the shapes of their inputs
+ */
+#ifdef MXNET_USE_TVM_OP
+#include "./tuned.h"
+
+#include <tvm/runtime/packed_func.h>
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../../tensor/broadcast_reduce_op.h"
+#include "../../tvmop/op_module.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the kernel arguments of the tuned kernels have up to 5 dimensions */
+static constexpr int tuned_max_dim = 5;
+
+/*! \brief how the inputs and outputs of a native operator are passed to its tuned kernels */
+enum TunedScheme {
+  // the inputs and the output, with their leading dimensions padded with 1
+  kTunedBroadcast,
+  // the input and the output, with the consecutive reduced and kept axes merged
+  kTunedReduce
+};
+
+struct TunedOp {
+  /*! \brief the name of the tuned kernels on cpu, prefixed by cuda_ on gpu */
+  const char* kernel;
+  TunedScheme scheme;
+};
+
+/*! \brief the native operators with tuned kernels, see contrib/tvmop/basic/tuned.py */
+static const std::unordered_map<std::string, TunedOp>& TunedOps() {
+  static const std::unordered_map<std::string, TunedOp> ops = {
+      {"broadcast_add", {"tuned_broadcast_add", kTunedBroadcast}},
+      {"broadcast_sub", {"tuned_broadcast_sub", kTunedBroadcast}},
+      {"broadcast_mul", {"tuned_broadcast_mul", kTunedBroadcast}},
+      {"broadcast_div", {"tuned_broadcast_div", kTunedBroadcast}},
+      {"sum", {"tuned_sum", kTunedReduce}}};
+  return ops;
+}
+
+/*! \brief the tuned schedules by key, and the operators whose FCompute dispatch to them */
+struct TVMOpTuning {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::string> schedules;
+  std::unordered_set<std::string> patched;
+
+  static TVMOpTuning* Get() {
+    static TVMOpTuning inst;
+    return &inst;
+  }
+};
+
+static TBlob TunedPadding(const TBlob& tblob) {
+  TShape tshape(tuned_max_dim, 1);
+  const int ndim = tblob.shape_.ndim();
+  for (int i = tuned_max_dim - ndim; i < tuned_max_dim; ++i)
+    tshape[i] = tblob.size(i - tuned_max_dim + ndim);
+  return tblob.reshape(tshape);
+}
+
+/*!
+ * \brief the reshaped input and output of a reduction, in the alternating reduced and kept axes
+ *  of the kernels of contrib/tvmop/basic/tuned.py, false if it has more than tuned_max_dim
+ * \param reduce1st whether the first axis of the reshaped input is reduced
+ */
+static bool TunedReduceArgs(const nnvm::NodeAttrs& attrs,
+                            const TBlob& input,
+                            const TBlob& output,
+                            std::vector<TBlob>* args,
+                            int* reduce1st) {
+  const ReduceAxesParam& param = nnvm::get<ReduceAxesParam>(attrs.parsed);
+  const TShape& big            = input.shape_;
+  if (big.ndim() == 0)
+    return false;
+  const TShape small = ReduceAxesShapeImpl(big, param.axis, true, param.exclude);
+  std::vector<index_t> dims;
+  bool last_reduced = false;
+  for (int i = 0; i < big.ndim(); ++i) {
+    const bool reduced = big[i] != small[i];
+    if (i == 0 || reduced != last_reduced)
+      dims.push_back(big[i]);
+    else
+      dims.back() *= big[i];
+    if (i == 0)
+      *reduce1st = reduced;
+    last_reduced = reduced;
+  }
+  if (dims.size() > static_cast<size_t>(tuned_max_dim))
+    return false;
+  dims.resize(tuned_max_dim, 1);
+  std::vector<index_t> kept;
+  for (size_t i = *reduce1st; i < dims.size(); i += 2)
+    kept.push_back(dims[i]);
+  args->push_back(input.reshape(TShape(dims.begin(), dims.end())));
+  args->push_back(output.reshape(TShape(kept.begin(), kept.end())));
+  return true;
+}
+
+/*! \brief the key of the schedule tuned for the kernel arguments, see LoadTVMOpTuning */
+static std::string TunedKey(const std::string& op_name,
+                            const OpContext& ctx,
+                            int dtype,
+                            const std::vector<TBlob>& args) {
+  std::ostringstream key;
+  key << op_name << ':' << (ctx.run_ctx.ctx.dev_mask() == Context::kGPU ? "gpu" : "cpu") << ':'
+      << dtype << ':';
+  for (size_t i = 0; i < args.size(); ++i) {
+    for (int j = 0; j < args[i].shape_.ndim(); ++j)
+      key << (j == 0 ? "" : ",") << args[i].shape_[j];
+    key << (i + 1 == args.size() ? "" : ";");
+  }
+  return key.str();
+}
+
+/*! \brief runs the tuned kernel of the inputs, false if there is none to run the native one */
+static bool TunedCompute(const std::string& op_name,
+                         const TunedOp& tuned,
+                         const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  if (req[0] == kNullOp)
+    return false;
+  for (const TBlob& input : inputs) {
+    if (input.shape_.Size() == 0 || input.shape_.ndim() > tuned_max_dim)
+      return false;
+  }
+  std::vector<TBlob> args;
+  int reduce1st = 0;
+  if (tuned.scheme == kTunedBroadcast) {
+    if (req[0] == kAddTo || outputs[0].shape_.ndim() > tuned_max_dim)
+      return false;
+    for (const TBlob& input : inputs)
+      args.push_back(TunedPadding(input));
+  } else if (!TunedReduceArgs(attrs, inputs[0], outputs[0], &args, &reduce1st)) {
+    return false;
+  }
+  std::string schedule;
+  {
+    TVMOpTuning* tuning = TVMOpTuning::Get();
+    std::lock_guard<std::mutex> lock(tuning->mutex);
+    auto it = tuning->schedules.find(TunedKey(op_name, ctx, inputs[0].type_flag_, args));
+    if (it == tuning->schedules.end())
+      return false;
+    schedule = it->second;
+  }
+  std::string func = std::string(ctx.run_ctx.ctx.dev_mask() == Context::kGPU ? "cuda_" : "") +
+                     tuned.kernel;
+  if (tuned.scheme == kTunedBroadcast) {
+    args.push_back(TunedPadding(outputs[0]));
+  } else {
+    func += "reduce1st_" + std::to_string(reduce1st);
+    func += req[0] == kAddTo ? "req_kAddTo" : "req_kWriteTo";
+    args.push_back(args.back());
+  }
+  tvm::runtime::TVMOpModule::Get()->Call(func + schedule, ctx, args);
+  return true;
+}
+
+void LoadTVMOpTuning(const std::vector<std::string>& keys,
+                     const std::vector<std::string>& schedules) {
+  CHECK_EQ(keys.size(), schedules.size());
+  TVMOpTuning* tuning = TVMOpTuning::Get();
+  std::lock_guard<std::mutex> lock(tuning->mutex);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const std::string op_name = keys[i].substr(0, keys[i].find(':'));
+    const std::string dev     = keys[i].substr(op_name.size() + 1, 3);
+    auto it                   = TunedOps().find(op_name);
+    CHECK(it != TunedOps().end()) << "Operator " << op_name << " has no tuned TVM kernels";
+    CHECK(dev == "cpu" || dev == "gpu") << "Invalid TVM op tuning key " << keys[i];
+#if !MXNET_USE_CUDA
+    if (dev == "gpu")
+      continue;
+#endif
+    tuning->schedules[keys[i]] = schedules[i];
+    if (!tuning->patched.insert(op_name + ":" + dev).second)
+      continue;
+    // the FCompute of the operator runs its tuned kernels, and its native one for the inputs
+    // with no tuned schedule
+    const std::string attr = dev == "gpu" ? "FCompute<gpu>" : "FCompute<cpu>";
+    nnvm::Op& op           = dmlc::Registry<nnvm::Op>::Get()->__REGISTER_OR_GET__(op_name);
+    const FCompute native  = nnvm::Op::GetAttr<FCompute>(attr).get(&op, nullptr);
+    CHECK(native != nullptr) << "Operator " << op_name << " has no " << attr;
+    const TunedOp tuned = it->second;
+    op.set_attr<FCompute>(
+        attr,
+        [op_name, tuned, native](const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+          if (!TunedCompute(op_name, tuned, attrs, ctx, inputs, req, outputs))
+            native(attrs, ctx, inputs, req, outputs);
+        },
+        11);
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_USE_TVM_OP
@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tuned.h
+ * \brief Dispatch of native operators to the TVM kernels tuned for the shapes of their inputs
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_TVMOP_TUNED_H_
+#define MXNET_OPERATOR_CONTRIB_TVMOP_TUNED_H_
+
+#if MXNET_USE_TVM_OP
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief loads the schedules tuned offline by contrib/tvmop/tune.py. The FCompute of the native
+ *  operators of the schedules then run the tuned TVM kernel for the inputs with the shapes of a
+ *  schedule, and the native kernel for the others.
+ * \param keys the operator, device, dtype and kernel argument shapes of each schedule, as in
+ *  "broadcast_add:cpu:0:1,1,1,32,128;1,1,1,1,128"
+ * \param schedules the kernel schedule of each key, e.g. "index_3"
+ */
+void LoadTVMOpTuning(const std::vector<std::string>& keys,
+                     const std::vector<std::string>& schedules);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_TVM_OP
+#endif  // MXNET_OPERATOR_CONTRIB_TVMOP_TUNED_H_
@@ -39,6 +39,8 @@
 #include <thread>
 #include <mutex>
 #include <functional>
+#include <future>
+#include <memory>
 #include <condition_variable>
 #include <queue>
 #include "../operator_common.h"
@@ -48,6 +50,11 @@ namespace mxnet {
 namespace op {
 namespace custom {
 
+/*! \brief the completion of an async custom op, which MXCustomOpComplete calls and deletes */
+struct CustomOpCompletion {
+  std::function<void(const char*)> fn;
+};
+
 class CustomOperator {
  public:
   void Register(const std::string& op_type, CustomOpPropCreator creator) {
@@ -72,6 +79,9 @@ class CustomOperator {
   // inputs and outputs unlike the dense case. Passing vector of inputs and
   // outputs ndarrays as args and updating the inputs and outputs ndarray
   // chunk pointers to be same as the copied ndarrays.
+  // func gets a completion, which is nullptr unless async. An async func returns when the
+  // frontend has started the op, and the frontend calls MXCustomOpComplete with the completion
+  // when the op is done, so that the worker thread is free meanwhile.
   template <typename Func>
   void Push(const Func& func,
             const OpContext& ctx,
@@ -81,14 +91,28 @@ class CustomOperator {
             const std::vector<int>& tags,
             const std::unordered_set<int>& output_tags,
             const std::vector<NDArray>& outputs,
-            const std::string op_type = "") {
+            const std::string op_type = "",
+            bool async                = false) {
     if (naive_engine_) {
+      std::promise<std::string> done;
+      std::unique_ptr<CustomOpCompletion> completion;
+      if (async) {
+        completion.reset(new CustomOpCompletion());
+        completion->fn = [&done](const char* err) { done.set_value(err ? err : ""); };
+      }
       if (profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative)) {
         profiler::CustomOpProfiler::Get()->OnCustomBegin(op_type);
-        func();
+        func(completion.get());
         profiler::CustomOpProfiler::Get()->OnCustomEnd();
       } else {
-        func();
+        func(completion.get());
+      }
+      if (async) {
+        // the completion is deleted by MXCustomOpComplete
+        completion.release();
+        const std::string err = done.get_future().get();
+        if (!err.empty())
+          throw dmlc::Error(err);
       }
       for (size_t i = 0, out_idx = 0; i < arrs.size(); i++) {
         if (arrs[i].storage_type() == kDefaultStorage ||
@@ -107,63 +131,37 @@ class CustomOperator {
       bool prev_recording = Imperative::Get()->set_is_recording(recording);
       bool prev_training  = Imperative::Get()->set_is_training(training);
 
+      CustomOpCompletion* completion = nullptr;
+      if (async) {
+        completion     = new CustomOpCompletion();
+        completion->fn = [=](const char* err) {
+          if (err) {
+            exception_ =
+                std::make_shared<std::exception_ptr>(std::make_exception_ptr(dmlc::Error(err)));
+          }
+          PushWait(ctx, arrs, tags, output_tags, outputs);
+        };
+      }
       try {
         if (profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative)) {
           profiler::CustomOpProfiler::Get()->OnCustomBegin(op_type);
-          func();
+          func(completion);
           profiler::CustomOpProfiler::Get()->OnCustomEnd();
         } else {
-          func();
+          func(completion);
         }
       } catch (dmlc::Error& e) {
         exception_ = std::make_shared<std::exception_ptr>(std::current_exception());
+        // the frontend failed to start the op and will not complete it
+        delete completion;
+        async = false;
       }
 
       Imperative::Get()->set_is_training(prev_training);
       Imperative::Get()->set_is_recording(prev_recording);
 
-      std::vector<Engine::VarHandle> vars, vars2;
-      size_t idx = 0;
-      for (const auto& i : arrs) {
-        vars.push_back(i.var());
-        if (output_tags.count(tags[idx]) > 0) {
-          if (i.storage_type() == kDefaultStorage || i.storage_type() == kUndefinedStorage)
-            continue;
-          vars2.push_back(i.var());
-          idx++;
-        }
-      }
-
-      Engine::Get()->PushSync(
-          [=](RunContext rctx) {
-            try {
-              Throw();
-              for (const auto& i : arrs) {
-                Engine::Get()->Throw(i.var());
-              }
-            } catch (dmlc::Error& err) {
-              ctx.async_on_complete(&err);
-              return;
-            }
-
-            for (size_t i = 0, out_idx = 0; i < arrs.size(); i++) {
-              if (arrs[i].storage_type() == kDefaultStorage ||
-                  arrs[i].storage_type() == kUndefinedStorage)
-                continue;
-              if (output_tags.count(tags[i]) > 0) {
-                outputs[out_idx].SparseUpdateChunk(arrs[i]);
-                out_idx++;
-              }
-            }
-
-            ctx.async_on_complete();
-          },
-          ctx.run_ctx.ctx,
-          vars,
-          vars2,
-          FnProperty::kNoSkip,
-          0,
-          "CustomOperatorWait");
+      if (!async)
+        PushWait(ctx, arrs, tags, output_tags, outputs);
     });
     // increase num_threads if there is not enough threads to execute custom operator
     if (q_.size() > num_free_threads_)
@@ -211,6 +209,55 @@ class CustomOperator {
   CustomOperator() {
     this->Start();
   }
+  /*! \brief pushes the engine op completing the op once the frontend is done with its arrays */
+  void PushWait(const OpContext& ctx,
+                const std::vector<NDArray>& arrs,
+                const std::vector<int>& tags,
+                const std::unordered_set<int>& output_tags,
+                const std::vector<NDArray>& outputs) {
+    std::vector<Engine::VarHandle> vars, vars2;
+    size_t idx = 0;
+    for (const auto& i : arrs) {
+      vars.push_back(i.var());
+      if (output_tags.count(tags[idx]) > 0) {
+        if (i.storage_type() == kDefaultStorage || i.storage_type() == kUndefinedStorage)
+          continue;
+        vars2.push_back(i.var());
+        idx++;
+      }
+    }
+
+    Engine::Get()->PushSync(
+        [=](RunContext rctx) {
+          try {
+            Throw();
+            for (const auto& i : arrs) {
+              Engine::Get()->Throw(i.var());
+            }
+          } catch (dmlc::Error& err) {
+            ctx.async_on_complete(&err);
+            return;
+          }
+
+          for (size_t i = 0, out_idx = 0; i < arrs.size(); i++) {
+            if (arrs[i].storage_type() == kDefaultStorage ||
+                arrs[i].storage_type() == kUndefinedStorage)
+              continue;
+            if (output_tags.count(tags[i]) > 0) {
+              outputs[out_idx].SparseUpdateChunk(arrs[i]);
+              out_idx++;
+            }
+          }
+
+          ctx.async_on_complete();
+        },
+        ctx.run_ctx.ctx,
+        vars,
+        vars2,
+        FnProperty::kNoSkip,
+        0,
+        "CustomOperatorWait");
+  }
   void ThreadTarget() {
     std::unique_lock<std::mutex> lock(mutex_);
     while (!q_.empty() || !destructing_) {
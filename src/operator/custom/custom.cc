@@ -329,8 +329,22 @@ void ForwardEx(const OpStatePtr& state,
     tags.push_back(4);
   }
 
+  const bool async = params.info->num_callbacks > kCustomOpForwardAsync &&
+                     params.info->callbacks[kCustomOpForwardAsync] != nullptr;
   CustomOperator::Get()->Push(
-      [=]() {
+      [=](CustomOpCompletion* completion) {
+        if (async) {
+          auto fn =
+              reinterpret_cast<CustomOpFBAsyncFunc>(params.info->callbacks[kCustomOpForwardAsync]);
+          CHECK(fn(ptrs.size(),
+                   const_cast<void**>(ptrs.data()),
+                   const_cast<int*>(tags.data()),
+                   reinterpret_cast<const int*>(req.data()),
+                   static_cast<int>(ctx.is_train),
+                   completion,
+                   params.info->contexts[kCustomOpForwardAsync]));
+          return;
+        }
         CHECK(reinterpret_cast<CustomOpFBFunc>(params.info->callbacks[kCustomOpForward])(
             ptrs.size(),
             const_cast<void**>(ptrs.data()),
@@ -346,7 +360,8 @@ void ForwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      params.op_type);
+      params.op_type,
+      async);
 }
 
 void BackwardEx(const OpStatePtr& state,
@@ -410,8 +425,22 @@ void BackwardEx(const OpStatePtr& state,
     ptrs.push_back(reinterpret_cast<void*>(nd));
     tags.push_back(4);
   }
+  const bool async = params.info->num_callbacks > kCustomOpBackwardAsync &&
+                     params.info->callbacks[kCustomOpBackwardAsync] != nullptr;
   CustomOperator::Get()->Push(
-      [=]() {
+      [=](CustomOpCompletion* completion) {
+        if (async) {
+          auto fn =
+              reinterpret_cast<CustomOpFBAsyncFunc>(params.info->callbacks[kCustomOpBackwardAsync]);
+          CHECK(fn(ptrs.size(),
+                   const_cast<void**>(ptrs.data()),
+                   const_cast<int*>(tags.data()),
+                   reinterpret_cast<const int*>(req.data()),
+                   static_cast<int>(ctx.is_train),
+                   completion,
+                   params.info->contexts[kCustomOpBackwardAsync]));
+          return;
+        }
         CHECK(reinterpret_cast<CustomOpFBFunc>(params.info->callbacks[kCustomOpBackward])(
             ptrs.size(),
             const_cast<void**>(ptrs.data()),
@@ -427,7 +456,8 @@ void BackwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      "_backward_" + params.op_type);
+      "_backward_" + params.op_type,
+      async);
 }
 
 // infer storage backward function for custom op which assigns kDefaultStorage for
@@ -25,6 +25,7 @@
 #include "./operator_common.h"
 #include "./nn/im2col.h"
 #include "./contrib/nn/deformable_im2col.h"
+#include "./contrib/nn/deformable_implicit_gemm.h"
 #include "./linalg.h"
 
 namespace mxnet {
@@ -105,6 +106,28 @@ class DeformableConvolutionOp : public Operator {
     LayerSetUp(
         in_data[conv::kData].shape_, in_data[conv::kOffset].shape_, out_data[conv::kOut].shape_);
     Stream<xpu>* s = ctx.get_stream<xpu>();
+    if (DeformableConvImplicitGemm()) {
+      // sample the deformed columns inside the GEMM instead of materializing them
+      const DeformConvGeometry geom = GetDeformConvGeometry(
+          param_, in_data[conv::kData].shape_, out_data[conv::kOut].shape_);
+      const index_t workspace_size = DeformConvImplicitGemmWorkspace<xpu>(geom);
+      DType* workspace             = nullptr;
+      if (workspace_size > 0) {
+        workspace = ctx.requested[conv::kTempSpace]
+                        .get_space_typed<xpu, 1, DType>(Shape1(workspace_size), s)
+                        .dptr_;
+      }
+      DeformConvImplicitGemmForward(s,
+                                    geom,
+                                    in_data[conv::kData].dptr<DType>(),
+                                    in_data[conv::kOffset].dptr<DType>(),
+                                    nullptr,
+                                    in_data[conv::kWeight].dptr<DType>(),
+                                    bias_term_ ? in_data[conv::kBias].dptr<DType>() : nullptr,
+                                    out_data[conv::kOut].dptr<DType>(),
+                                    workspace);
+      return;
+    }
     // allocate workspace for col_buffer
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(Shape1(col_buffer_size_), s);
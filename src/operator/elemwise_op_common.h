@@ -183,6 +183,20 @@ inline bool ElemwiseShape(const nnvm::NodeAttrs& attrs,
       attrs, in_attrs, out_attrs, mxnet::TShape());
 }
 
+/*! \brief FComputeCost of the operators doing one floating point operation per output */
+inline uint64_t ElemwiseFlops(const nnvm::NodeAttrs& attrs,
+                              const mxnet::ShapeVector& in_shapes,
+                              const mxnet::ShapeVector& out_shapes) {
+  return out_shapes[0].Size();
+}
+
+/*! \brief FComputeCost of the reductions, doing one floating point operation per input */
+inline uint64_t ReduceFlops(const nnvm::NodeAttrs& attrs,
+                            const mxnet::ShapeVector& in_shapes,
+                            const mxnet::ShapeVector& out_shapes) {
+  return in_shapes[0].Size();
+}
+
 template <index_t n_in, index_t n_out>
 inline bool ElemwiseType(const nnvm::NodeAttrs& attrs,
                          std::vector<int>* in_attrs,
@@ -22,6 +22,8 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <utility>
 #include <vector>
 
 #if MXNET_USE_CUDA
@@ -215,6 +217,37 @@ const std::vector<std::string> variable_io_ops = {"add_n",
                                                   "_backward_amp_multicast",
                                                   "_backward_cast"};
 
+// Reductions that can end a fused subgraph: the reducer and whether the result is
+// divided by the number of reduced elements
+const std::map<std::string, std::pair<std::string, bool>> reduce_ops = {
+    {"sum", {"red::sum{}", false}},
+    {"mean", {"red::sum{}", true}},
+    {"_npi_sum", {"red::sum{}", false}},
+    {"_npi_mean", {"red::sum{}", true}},
+};
+
+// Broadcasting binary ops that can feed a fused reduction
+const std::map<std::string, std::vector<std::vector<std::string>>> broadcast_ops = {
+    {"broadcast_add", {{"op::add(%, %)", "_0", "_1"}}},
+    {"broadcast_plus", {{"op::add(%, %)", "_0", "_1"}}},
+    {"broadcast_sub", {{"op::sub(%, %)", "_0", "_1"}}},
+    {"broadcast_minus", {{"op::sub(%, %)", "_0", "_1"}}},
+    {"broadcast_mul", {{"op::mul(%, %)", "_0", "_1"}}},
+    {"broadcast_div", {{"op::div(%, %)", "_0", "_1"}}},
+    {"broadcast_maximum", {{"op::max(%, %)", "_0", "_1"}}},
+    {"broadcast_minimum", {{"op::min(%, %)", "_0", "_1"}}},
+    {"_npi_add", {{"op::add(%, %)", "_0", "_1"}}},
+    {"_npi_subtract", {{"op::sub(%, %)", "_0", "_1"}}},
+    {"_npi_multiply", {{"op::mul(%, %)", "_0", "_1"}}},
+};
+
+// Ops of ops_desc that change the shape, they cannot feed a fused reduction
+const std::set<std::string> reshape_ops = {
+    "squeeze", "flatten", "Reshape", "reshape", "_backward_reshape", "expand_dims"};
+
+// Maximum number of inputs of a fused reduction
+const size_t kMaxReduceInputs = 2;
+
 const char kernel_begin[] = R"code(
 const int tid = threadIdx.x + blockIdx.x * blockDim.x;
 for (int i = tid; i < N; i+= gridDim.x * blockDim.x) {
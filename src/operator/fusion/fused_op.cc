@@ -17,20 +17,48 @@
  * under the License.
  */
 
+#include <algorithm>
 #include <tuple>
 
 #include "./fused_op.h"
+#include "./fused_op-inl.h"
 #include "../operator_common.h"
 #include "../../imperative/exec_pass.h"
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 DMLC_REGISTER_PARAMETER(FusedOpConfig);
 
 std::mutex FusedOp::mutex_;
 
+namespace {
+
+inline int mshadowTypeToVectorLength(int type) {
+  switch (type) {
+    case mshadow::kFloat32:
+      return 1;
+    case mshadow::kFloat64:
+      return 1;
+    case mshadow::kFloat16:
+      return 2;
+    case mshadow::kUint8:
+      return 4;
+    case mshadow::kInt8:
+      return 4;
+    case mshadow::kInt32:
+      return 1;
+    case mshadow::kInt64:
+      return 1;
+    case mshadow::kBool:
+      return 4 / sizeof(bool);
+    default:
+      LOG(FATAL) << "Unknown type enum " << type;
+  }
+  return 0;
+}
+
+}  // namespace
+
 void FusedOpParamParser(nnvm::NodeAttrs* attrs) {
   FusedOpConfig param;
   try {
@@ -50,11 +78,18 @@ void FusedOpParamParser(nnvm::NodeAttrs* attrs) {
 }
 
 FusedOp::FusedOp(const nnvm::NodeAttrs* attrs, const FusedOpConfig& config)
-    : initialized_(false), kernel_function_dev_id_(-1) {
+    : cpu_interpreted_(false), initialized_(false), kernel_function_dev_id_(-1) {
   inputs_           = std::vector<FusedOpEntry>(config.num_inputs);
   outputs_          = std::vector<FusedOpEntry>(config.num_outputs);
   subgraph_         = nnvm::Graph();
   subgraph_.outputs = attrs->subgraphs[0]->outputs;
+
+#if MXNET_USE_CUDA
+  reduction_ = subgraph_.outputs.size() == 1 && !subgraph_.outputs[0].node->is_variable() &&
+               fusion::reduce_ops.count(subgraph_.outputs[0].node->op()->name) > 0;
+#else
+  reduction_ = false;
+#endif  // MXNET_USE_CUDA
 }
 
 bool FusedOp::InferShape(const nnvm::NodeAttrs& attrs,
@@ -139,6 +174,58 @@ bool FusedOp::InferType(const nnvm::NodeAttrs& attrs,
   return inferred;
 }
 
+void FusedOp::CheckShapesAndTypes(const std::vector<TBlob>& inputs,
+                                  const std::vector<TBlob>& outputs,
+                                  std::vector<int>* in_dtypes,
+                                  std::vector<int>* in_ndims,
+                                  std::vector<int>* out_dtypes,
+                                  std::vector<int>* out_ndims,
+                                  int* nvec) {
+  std::vector<mxnet::TShape> in_shapes;
+  std::vector<mxnet::TShape> out_shapes;
+  CHECK_EQ(inputs.size(), inputs_.size());
+  CHECK_EQ(outputs.size(), outputs_.size());
+
+  for (size_t counter = 0; counter < inputs.size(); ++counter) {
+    const auto& blob = inputs[counter];
+    in_dtypes->push_back(blob.type_flag_);
+    in_ndims->push_back(blob.ndim());
+    in_shapes.push_back(blob.shape_);
+    initialized_           = initialized_ && blob.type_flag_ == inputs_[counter].dtype;
+    initialized_           = initialized_ && blob.ndim() == inputs_[counter].ndim;
+    inputs_[counter].dtype = blob.type_flag_;
+    inputs_[counter].ndim  = blob.ndim();
+    if (nvec != nullptr)
+      *nvec = std::max(*nvec, mshadowTypeToVectorLength(blob.type_flag_));
+  }
+
+  for (size_t counter = 0; counter < outputs.size(); ++counter) {
+    const auto& blob = outputs[counter];
+    out_dtypes->push_back(blob.type_flag_);
+    out_ndims->push_back(blob.ndim());
+    out_shapes.push_back(blob.shape_);
+    initialized_            = initialized_ && blob.type_flag_ == outputs_[counter].dtype;
+    initialized_            = initialized_ && blob.ndim() == outputs_[counter].ndim;
+    outputs_[counter].dtype = blob.type_flag_;
+    outputs_[counter].ndim  = blob.ndim();
+    if (nvec != nullptr)
+      *nvec = std::max(*nvec, mshadowTypeToVectorLength(blob.type_flag_));
+  }
+
+  for (auto it = intermediate_shapes_.begin(); it != intermediate_shapes_.end(); ++it) {
+    if (it->input_attr == in_shapes && it->output_attr == out_shapes) {
+      intermediate_shapes_.erase(intermediate_shapes_.begin(), it);
+      break;
+    }
+  }
+  for (auto it = intermediate_dtypes_.begin(); it != intermediate_dtypes_.end(); ++it) {
+    if (it->input_attr == *in_dtypes && it->output_attr == *out_dtypes) {
+      intermediate_dtypes_.erase(intermediate_dtypes_.begin(), it);
+      break;
+    }
+  }
+}
+
 template <typename Attr>
 std::tuple<const nnvm::ObjectPtr, std::vector<Attr>, std::vector<Attr>> FusedOp::GetAttrs(
     const std::string& attr_name,
@@ -221,6 +308,9 @@ NNVM_REGISTER_OP(_FusedOp)
                                       const auto num_inputs  = op->num_inputs();
                                       const auto num_outputs = op->num_outputs();
                                       std::vector<std::pair<int, int>> ret;
+                                      // the reduce kernel writes its output while other blocks still read the inputs
+                                      if (op->IsReduction())
+                                        return ret;
                                       for (unsigned int i = 0; i < num_inputs; ++i) {
                                         for (unsigned int j = 0; j < num_outputs; ++j) {
                                           ret.emplace_back(i, j);
@@ -228,6 +318,15 @@ NNVM_REGISTER_OP(_FusedOp)
                                       }
                                       return ret;
                                     })
+    .set_attr<FResourceRequestEx>(
+        "FResourceRequestEx",
+        [](const NodeAttrs& attrs, const int dev_mask, const DispatchMode dispatch_mode) {
+          const FusedOpPtr& op = nnvm::get<FusedOpPtr>(attrs.parsed);
+          // the CPU fallback runs the fused operators with their own temp space requests
+          if (op->IsReduction() || dev_mask == mshadow::cpu::kDevMask)
+            return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+          return std::vector<ResourceRequest>{};
+        })
     .set_attr<exec::FProvideSubgraphShape>("FProvideSubgraphShape", FusedOpProvideShape)
     .set_attr<exec::FProvideSubgraphType>("FProvideSubgraphType", FusedOpProvideType)
     .set_attr<exec::FProvideSubgraphStorageType>("FProvideSubgraphStorageType",
@@ -286,5 +385,3 @@ NNVM_REGISTER_OP(_FusedOpOutHelper)
     .set_attr<exec::FAccessSubgraphType>("FAccessSubgraphType", FusedOpOutHelperType);
 
 }  // namespace mxnet
-
-#endif  // MXNET_USE_CUDA
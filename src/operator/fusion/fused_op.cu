@@ -25,7 +25,10 @@
 #include "./fused_op-inl.h"
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
+#include "../tensor/broadcast_reduce_op.h"
+#include "../numpy/np_broadcast_reduce_op.h"
 #include "../../imperative/exec_pass.h"
+#include "../../common/utils.h"
 #include "../../common/cuda/utils.h"
 #include "../../common/cuda/rtc.h"
 
@@ -57,30 +60,6 @@ inline std::string mshadowTypeToString(int type) {
   return "";
 }
 
-inline int mshadowTypeToVectorLength(int type) {
-  switch (type) {
-    case mshadow::kFloat32:
-      return 1;
-    case mshadow::kFloat64:
-      return 1;
-    case mshadow::kFloat16:
-      return 2;
-    case mshadow::kUint8:
-      return 4;
-    case mshadow::kInt8:
-      return 4;
-    case mshadow::kInt32:
-      return 1;
-    case mshadow::kInt64:
-      return 1;
-    case mshadow::kBool:
-      return 4 / sizeof(bool);
-    default:
-      LOG(FATAL) << "Unknown type enum " << type;
-  }
-  return 0;
-}
-
 inline void replaceString(std::string* input, const std::string old, const std::string repl) {
   size_t pos = 0;
   while ((pos = input->find(old, pos)) != std::string::npos) {
@@ -165,8 +144,82 @@ void AddPointerAndShape(const TBlob& data,
   });
 }
 
+/*!
+ * \brief Merge the adjacent axes that are reduced, and broadcast in lhs and rhs, alike
+ *  and drop the axes of size 1.
+ */
+int CompactReduceShapes(mxnet::TShape* big,
+                        mxnet::TShape* small,
+                        mxnet::TShape* lhs,
+                        mxnet::TShape* rhs) {
+  const int ndim = big->ndim();
+  mxnet::TShape new_big(ndim, 1), new_small(ndim, 1), new_lhs(ndim, 1), new_rhs(ndim, 1);
+  int new_ndim  = 0;
+  int last_kind = -1;
+  for (int i = 0; i < ndim; ++i) {
+    const index_t size = (*big)[i];
+    if (size == 1)
+      continue;
+    const int kind =
+        ((*small)[i] == 1) | (((*lhs)[i] == 1) << 1) | (((*rhs)[i] == 1) << 2);
+    if (kind != last_kind) {
+      ++new_ndim;
+      last_kind = kind;
+    }
+    const int j = new_ndim - 1;
+    new_big[j] *= size;
+    new_small[j] *= (*small)[i];
+    new_lhs[j] *= (*lhs)[i];
+    new_rhs[j] *= (*rhs)[i];
+  }
+  new_ndim = std::max(new_ndim, 1);
+  *big     = mxnet::TShape(new_big.begin(), new_big.begin() + new_ndim);
+  *small   = mxnet::TShape(new_small.begin(), new_small.begin() + new_ndim);
+  *lhs     = mxnet::TShape(new_lhs.begin(), new_lhs.begin() + new_ndim);
+  *rhs     = mxnet::TShape(new_rhs.begin(), new_rhs.begin() + new_ndim);
+  return new_ndim;
+}
+
 }  // namespace
 
+std::string FusedOp::GenerateReduceFunction(const std::vector<int>& node_dtypes) {
+  const auto& g          = subgraph_.indexed_graph();
+  const auto& input_nids = g.input_nodes();
+  const auto& out        = g.outputs()[0];
+  CHECK_LE(input_nids.size(), fusion::kMaxReduceInputs);
+  std::map<std::pair<int, int>, std::string> variables;
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    variables[{input_nids[i], 0}] = "in" + std::to_string(i);
+  }
+  std::string code      = "";
+  int temp_name_counter = 0;
+  for (size_t i = 0; i < g.num_nodes(); ++i) {
+    const auto& node = g[i];
+    if (node.source->is_variable() || i == out.node_id)
+      continue;
+    const std::string& op_name = node.source->op()->name;
+    const auto& op_descs       = fusion::ops_desc.count(op_name) ? fusion::ops_desc.at(op_name)
+                                                                 : fusion::broadcast_ops.at(op_name);
+    CHECK_EQ(op_descs.size(), 1) << "Unexpected op " << op_name << " in a fused reduction";
+    const std::string var_name = "temp" + std::to_string(temp_name_counter++);
+    code += "  const auto " + var_name + " = " +
+            ParseOpDescription(op_descs[0], variables, node) + ";\n";
+    variables[{i, 0}] = var_name;
+  }
+  const auto& reduce_input = g[out.node_id].inputs[0];
+  const int input_dtype    = node_dtypes[g.entry_id(reduce_input)];
+  return std::string("using AType = typename AccType<") +
+         common::mshadow_type_info(input_dtype).name +
+         ">::type;\n"
+         "template <typename T0, typename T1>\n"
+         "__device__ inline AType FusedReduceFunc(const T0 in0, const T1 in1) {\n" +
+         code + "  return AType(" + variables.at({reduce_input.node_id, reduce_input.index}) +
+         ");\n"
+         "}\n"
+         "#define FUNC FusedReduceFunc(IType1::from(lhs[idx_lhs[u]]), "
+         "IType2::from(rhs[idx_rhs[u]]))\n";
+}
+
 std::string FusedOp::GenerateCode(const std::vector<OpReqType>& req,
                                   const std::vector<int>& in_dtypes,
                                   const std::vector<int>& out_dtypes,
@@ -584,56 +637,6 @@ CUfunction FusedOp::CompileCode(const std::string& code,
   return common::cuda::rtc::get_function(code, "FusedKernel_" + kernel_name, "", dev_id);
 }
 
-void FusedOp::CheckShapesAndTypes(const std::vector<TBlob>& inputs,
-                                  const std::vector<TBlob>& outputs,
-                                  std::vector<int>* in_dtypes,
-                                  std::vector<int>* in_ndims,
-                                  std::vector<int>* out_dtypes,
-                                  std::vector<int>* out_ndims,
-                                  int* nvec) {
-  std::vector<mxnet::TShape> in_shapes;
-  std::vector<mxnet::TShape> out_shapes;
-  CHECK_EQ(inputs.size(), inputs_.size());
-  CHECK_EQ(outputs.size(), outputs_.size());
-
-  for (size_t counter = 0; counter < inputs.size(); ++counter) {
-    const auto& blob = inputs[counter];
-    in_dtypes->push_back(blob.type_flag_);
-    in_ndims->push_back(blob.ndim());
-    in_shapes.push_back(blob.shape_);
-    initialized_           = initialized_ && blob.type_flag_ == inputs_[counter].dtype;
-    initialized_           = initialized_ && blob.ndim() == inputs_[counter].ndim;
-    inputs_[counter].dtype = blob.type_flag_;
-    inputs_[counter].ndim  = blob.ndim();
-    *nvec                  = max(*nvec, mshadowTypeToVectorLength(blob.type_flag_));
-  }
-
-  for (size_t counter = 0; counter < outputs.size(); ++counter) {
-    const auto& blob = outputs[counter];
-    out_dtypes->push_back(blob.type_flag_);
-    out_ndims->push_back(blob.ndim());
-    out_shapes.push_back(blob.shape_);
-    initialized_            = initialized_ && blob.type_flag_ == outputs_[counter].dtype;
-    initialized_            = initialized_ && blob.ndim() == outputs_[counter].ndim;
-    outputs_[counter].dtype = blob.type_flag_;
-    outputs_[counter].ndim  = blob.ndim();
-    *nvec                   = max(*nvec, mshadowTypeToVectorLength(blob.type_flag_));
-  }
-
-  for (auto it = intermediate_shapes_.begin(); it != intermediate_shapes_.end(); ++it) {
-    if (it->input_attr == in_shapes && it->output_attr == out_shapes) {
-      intermediate_shapes_.erase(intermediate_shapes_.begin(), it);
-      break;
-    }
-  }
-  for (auto it = intermediate_dtypes_.begin(); it != intermediate_dtypes_.end(); ++it) {
-    if (it->input_attr == *in_dtypes && it->output_attr == *out_dtypes) {
-      intermediate_dtypes_.erase(intermediate_dtypes_.begin(), it);
-      break;
-    }
-  }
-}
-
 template <>
 void FusedOp::Forward<gpu>(const nnvm::NodeAttrs& attrs,
                            const OpContext& ctx,
@@ -655,6 +658,15 @@ void FusedOp::Forward<gpu>(const nnvm::NodeAttrs& attrs,
   const auto& node_shapes = intermediate_shapes_[0].internal_attr;
   const auto& node_dtypes = intermediate_dtypes_[0].internal_attr;
 
+  if (reduction_) {
+    if (!initialized_) {
+      reduce_func_code_ = GenerateReduceFunction(node_dtypes);
+      initialized_      = true;
+    }
+    ForwardReduction(ctx, inputs, req, outputs);
+    return;
+  }
+
   int dev_id = ctx.run_ctx.ctx.dev_id;
 
   // A change between training and inference modes may require different kernel functions
@@ -743,6 +755,89 @@ void FusedOp::Forward<gpu>(const nnvm::NodeAttrs& attrs,
                             &args);
 }
 
+void FusedOp::ForwardReduction(const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mshadow::expr;
+  if (req[0] == kNullOp || outputs[0].Size() == 0)
+    return;
+  const auto& g           = subgraph_.indexed_graph();
+  const auto& node_shapes = intermediate_shapes_[0].internal_attr;
+  const auto& reduce_node = g[g.outputs()[0].node_id];
+  const auto& rattrs      = reduce_node.source->attrs;
+  const auto& reduce_op   = fusion::reduce_ops.at(rattrs.op->name);
+  const bool is_mean      = reduce_op.second;
+
+  // The reduction is computed with keepdims, the output only differs by its
+  // axes of size 1
+  mxnet::TShape big_shape = node_shapes[g.entry_id(reduce_node.inputs[0])];
+  mxnet::TShape small_shape;
+  if (rattrs.op->name.compare(0, 5, "_npi_") == 0) {
+    const auto& param = nnvm::get<op::NumpyReduceAxesParam>(rattrs.parsed);
+    small_shape       = op::NumpyReduceAxesShapeImpl(big_shape, param.axis, true);
+  } else {
+    const auto& param = nnvm::get<op::ReduceAxesParam>(rattrs.parsed);
+    small_shape       = op::ReduceAxesShapeImpl(big_shape, param.axis, true, param.exclude);
+  }
+  if (big_shape.ndim() == 0) {
+    big_shape   = mxnet::TShape(1, 1);
+    small_shape = big_shape;
+  }
+  const int big_ndim = big_shape.ndim();
+  // inputs broadcast to the input of the reduction, align them to the right
+  auto align = [big_ndim](const mxnet::TShape& shape) {
+    mxnet::TShape ret(big_ndim, 1);
+    for (int i = 0; i < shape.ndim(); ++i) {
+      ret[big_ndim - shape.ndim() + i] = shape[i];
+    }
+    return ret;
+  };
+  mxnet::TShape lhs_shape = align(inputs[0].shape_);
+  mxnet::TShape rhs_shape = inputs.size() > 1 ? align(inputs[1].shape_) : lhs_shape;
+  const size_t M          = big_shape.Size() / small_shape.Size();
+  const int ndim          = CompactReduceShapes(&big_shape, &small_shape, &lhs_shape, &rhs_shape);
+  CHECK_LE(ndim, op::broadcast::MAX_DIM)
+      << "Fused reductions support inputs with up to " << op::broadcast::MAX_DIM
+      << " dimensions after merging adjacent axes, got " << ndim;
+
+  Stream<gpu>* s   = ctx.get_stream<gpu>();
+  const int dev_id = ctx.run_ctx.ctx.dev_id;
+  const TBlob lhs  = inputs[0].reshape(lhs_shape);
+  const TBlob rhs  = inputs.size() > 1 ? inputs[1].reshape(rhs_shape) : lhs;
+  // the reduce kernel only reads the inputs, big just describes the reduced shape
+  const TBlob big(lhs.dptr_, big_shape, gpu::kDevMask, lhs.type_flag_, dev_id);
+  const TBlob small = outputs[0].reshape(small_shape);
+  MSHADOW_TYPE_SWITCH(small.type_flag_, DType, {
+    Tensor<gpu, 1, DType> out = small.FlatTo1D<gpu, DType>(s);
+    if (big_shape.Size() == 0) {
+      if (req[0] != kAddTo)
+        out = scalar<DType>(0);
+      return;
+    }
+    // the mean added to the output is computed in a temporary buffer
+    const bool add_mean    = is_mean && req[0] == kAddTo;
+    const OpReqType rreq   = add_mean ? kWriteTo : req[0];
+    const size_t tmp_bytes = add_mean ? (small.Size() * sizeof(DType) + 15) / 16 * 16 : 0;
+    const size_t workspace_size =
+        op::broadcast::ReduceWorkspaceSize(s, small_shape, rreq, big_shape, lhs_shape, rhs_shape);
+    Tensor<gpu, 1, char> space =
+        ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(tmp_bytes + workspace_size), s);
+    Tensor<gpu, 1, char> workspace(space.dptr_ + tmp_bytes, Shape1(workspace_size), s);
+    const TBlob result =
+        add_mean ? TBlob(reinterpret_cast<DType*>(space.dptr_), small_shape, gpu::kDevMask, dev_id)
+                 : small;
+    op::broadcast::RTCReduceFunc(
+        ctx, result, rreq, workspace, big, lhs, rhs, reduce_op.first, ndim, reduce_func_code_);
+    if (add_mean) {
+      out += result.FlatTo1D<gpu, DType>(s) / scalar<DType>(M);
+    } else if (is_mean) {
+      out /= scalar<DType>(M);
+    }
+  });
+}
+
 void FusedOpForwardGPU(const nnvm::NodeAttrs& attrs,
                        const OpContext& ctx,
                        const std::vector<TBlob>& inputs,
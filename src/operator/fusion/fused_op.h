@@ -28,8 +28,6 @@
 #include <mutex>
 #include <tuple>
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 namespace fusion {
@@ -67,6 +65,10 @@ class FusedOp {
   uint32_t num_outputs() const {
     return outputs_.size();
   }
+  /*! \brief whether the subgraph ends with a reduction */
+  bool IsReduction() const {
+    return reduction_;
+  }
 
   template <typename xpu>
   void Forward(const nnvm::NodeAttrs& attrs,
@@ -115,6 +117,7 @@ class FusedOp {
   }
 
  private:
+#if MXNET_USE_CUDA
   std::string GenerateCode(const std::vector<OpReqType>& req,
                            const std::vector<int>& in_dtypes,
                            const std::vector<int>& out_dtypes,
@@ -126,8 +129,32 @@ class FusedOp {
                            const std::string& kernel_name,
                            std::vector<uint32_t>* check_shapes);
 
+  std::string GenerateReduceFunction(const std::vector<int>& node_dtypes);
+
   CUfunction CompileCode(const std::string& code, const std::string& kernel_name, int dev_id);
 
+  void ForwardReduction(const OpContext& ctx,
+                        const std::vector<TBlob>& inputs,
+                        const std::vector<OpReqType>& req,
+                        const std::vector<TBlob>& outputs);
+
+#endif  // MXNET_USE_CUDA
+
+  /*! \brief build the program of the CPU interpreter, false if a node is not supported */
+  bool BuildCPUProgram();
+
+  template <typename DType, typename CType>
+  void ForwardCPUTiled(const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs);
+
+  void ForwardCPUFallback(const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs);
+
+  // nvec, the vector length of the GPU kernels, is not computed when nullptr
   void CheckShapesAndTypes(const std::vector<TBlob>& inputs,
                            const std::vector<TBlob>& outputs,
                            std::vector<int>* in_dtypes,
@@ -166,7 +193,28 @@ class FusedOp {
   std::vector<uint32_t> extra_shape_args_;
   std::vector<uint32_t> check_shape_args_;
 
+#if MXNET_USE_CUDA
   CUfunction kernel_functions_[fusion::kNumKernelVariants];
+  // FUNC of the reduce kernel computing the input of the reduction
+  std::string reduce_func_code_;
+#endif  // MXNET_USE_CUDA
+  bool reduction_;
+
+  /*! \brief one node of the subgraph executed by the CPU interpreter */
+  struct CPUStep {
+    // key of the tile function, see fused_op_cpu.cc
+    std::string op;
+    // slots of the inputs, the fused op inputs come first
+    std::vector<uint32_t> inputs;
+    uint32_t output;
+    // scalar parameters of the node
+    std::vector<double> params;
+  };
+  std::vector<CPUStep> cpu_steps_;
+  // slots holding the fused op outputs
+  std::vector<uint32_t> cpu_output_slots_;
+  // whether every node of the subgraph has a tile function
+  bool cpu_interpreted_;
   bool initialized_;
   int kernel_function_dev_id_;
 
@@ -185,8 +233,9 @@ struct FusedOpHelperParam {
 
 using FusedOpHelperParamPtr = std::shared_ptr<FusedOpHelperParam>;
 
-}  // namespace mxnet
+/*! \brief whether the CPU FusedOp can execute node n */
+bool IsCPUFusionCompatible(const nnvm::Node* n);
 
-#endif  // MXNET_USE_CUDA
+}  // namespace mxnet
 
 #endif  // MXNET_OPERATOR_FUSION_FUSED_OP_H_
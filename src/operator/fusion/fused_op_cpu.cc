@@ -0,0 +1,467 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fused_op_cpu.cc
+ * \brief CPU execution of FusedOp.
+ *
+ * The subgraph is interpreted tile by tile: every node is a loop over the mshadow_op
+ * functor of its operator, so the intermediate results of a tile stay in the cache
+ * and the loops are vectorized by the compiler. Subgraphs that broadcast or mix
+ * dtypes run their nodes one by one with the FCompute<cpu> of their operators.
+ */
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "./fused_op.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+
+namespace {
+
+// number of elements of a tile, the intermediate results of a tile fit in L1
+const index_t kCPUTile = 512;
+
+template <typename CType>
+using TileFn = void (*)(const CType* const* in,
+                        size_t num_in,
+                        const double* params,
+                        CType* out,
+                        index_t n);
+
+template <typename OP, typename CType>
+void UnaryTile(const CType* const* in,
+               size_t num_in,
+               const double* params,
+               CType* out,
+               index_t n) {
+  const CType* x = in[0];
+#pragma omp simd
+  for (index_t i = 0; i < n; ++i) {
+    out[i] = OP::Map(x[i]);
+  }
+}
+
+template <typename OP, typename CType>
+void BinaryTile(const CType* const* in,
+                size_t num_in,
+                const double* params,
+                CType* out,
+                index_t n) {
+  const CType* x = in[0];
+  const CType* y = in[1];
+#pragma omp simd
+  for (index_t i = 0; i < n; ++i) {
+    out[i] = OP::Map(x[i], y[i]);
+  }
+}
+
+template <typename OP, typename CType>
+void ScalarTile(const CType* const* in,
+                size_t num_in,
+                const double* params,
+                CType* out,
+                index_t n) {
+  const CType* x     = in[0];
+  const CType scalar = static_cast<CType>(params[0]);
+#pragma omp simd
+  for (index_t i = 0; i < n; ++i) {
+    out[i] = OP::Map(x[i], scalar);
+  }
+}
+
+template <typename CType>
+void ClipTile(const CType* const* in,
+              size_t num_in,
+              const double* params,
+              CType* out,
+              index_t n) {
+  const CType* x    = in[0];
+  const CType a_min = static_cast<CType>(params[0]);
+  const CType a_max = static_cast<CType>(params[1]);
+#pragma omp simd
+  for (index_t i = 0; i < n; ++i) {
+    out[i] = mshadow_op::clip::Map(x[i], a_min, a_max);
+  }
+}
+
+template <typename CType>
+void AddNTile(const CType* const* in,
+              size_t num_in,
+              const double* params,
+              CType* out,
+              index_t n) {
+  std::copy(in[0], in[0] + n, out);
+  for (size_t k = 1; k < num_in; ++k) {
+    const CType* x = in[k];
+#pragma omp simd
+    for (index_t i = 0; i < n; ++i) {
+      out[i] += x[i];
+    }
+  }
+}
+
+/*! \brief tile functions by CPUStepKey */
+template <typename CType>
+const std::unordered_map<std::string, TileFn<CType>>& TileFunctions() {
+  static const std::unordered_map<std::string, TileFn<CType>> functions = {
+      // unary
+      {"relu", UnaryTile<mshadow_op::relu, CType>},
+      {"_npx_relu", UnaryTile<mshadow_op::relu, CType>},
+      {"Activation:relu", UnaryTile<mshadow_op::relu, CType>},
+      {"sigmoid", UnaryTile<mshadow_op::sigmoid, CType>},
+      {"_npx_sigmoid", UnaryTile<mshadow_op::sigmoid, CType>},
+      {"Activation:sigmoid", UnaryTile<mshadow_op::sigmoid, CType>},
+      {"tanh", UnaryTile<mshadow_op::tanh, CType>},
+      {"_npi_tanh", UnaryTile<mshadow_op::tanh, CType>},
+      {"Activation:tanh", UnaryTile<mshadow_op::tanh, CType>},
+      {"Activation:softrelu", UnaryTile<mshadow_op::softrelu, CType>},
+      {"softsign", UnaryTile<mshadow_op::softsign, CType>},
+      {"Activation:softsign", UnaryTile<mshadow_op::softsign, CType>},
+      {"exp", UnaryTile<mshadow_op::exp, CType>},
+      {"_npi_exp", UnaryTile<mshadow_op::exp, CType>},
+      {"expm1", UnaryTile<mshadow_op::expm1, CType>},
+      {"log", UnaryTile<mshadow_op::log, CType>},
+      {"_npi_log", UnaryTile<mshadow_op::log, CType>},
+      {"log1p", UnaryTile<mshadow_op::log1p, CType>},
+      {"sqrt", UnaryTile<mshadow_op::square_root, CType>},
+      {"_npi_sqrt", UnaryTile<mshadow_op::square_root, CType>},
+      {"rsqrt", UnaryTile<mshadow_op::reciprocal_square_root, CType>},
+      {"square", UnaryTile<mshadow_op::square, CType>},
+      {"_npi_square", UnaryTile<mshadow_op::square, CType>},
+      {"negative", UnaryTile<mshadow_op::negation, CType>},
+      {"_npi_negative", UnaryTile<mshadow_op::negation, CType>},
+      {"abs", UnaryTile<mshadow_op::abs, CType>},
+      {"_npi_absolute", UnaryTile<mshadow_op::abs, CType>},
+      {"reciprocal", UnaryTile<mshadow_op::reciprocal, CType>},
+      {"sin", UnaryTile<mshadow_op::sin, CType>},
+      {"_npi_sin", UnaryTile<mshadow_op::sin, CType>},
+      {"cos", UnaryTile<mshadow_op::cos, CType>},
+      {"_npi_cos", UnaryTile<mshadow_op::cos, CType>},
+      {"erf", UnaryTile<mshadow_op::erf, CType>},
+      {"identity", UnaryTile<mshadow_op::identity, CType>},
+      {"_copy", UnaryTile<mshadow_op::identity, CType>},
+      // binary, the numpy operators broadcast, see IsUniform
+      {"elemwise_add", BinaryTile<mshadow_op::plus, CType>},
+      {"_npi_add", BinaryTile<mshadow_op::plus, CType>},
+      {"elemwise_sub", BinaryTile<mshadow_op::minus, CType>},
+      {"_npi_subtract", BinaryTile<mshadow_op::minus, CType>},
+      {"elemwise_mul", BinaryTile<mshadow_op::mul, CType>},
+      {"_npi_multiply", BinaryTile<mshadow_op::mul, CType>},
+      {"elemwise_div", BinaryTile<mshadow_op::div, CType>},
+      {"_maximum", BinaryTile<mshadow_op::maximum, CType>},
+      {"_npi_maximum", BinaryTile<mshadow_op::maximum, CType>},
+      {"_minimum", BinaryTile<mshadow_op::minimum, CType>},
+      {"_npi_minimum", BinaryTile<mshadow_op::minimum, CType>},
+      {"_power", BinaryTile<mshadow_op::power, CType>},
+      // scalar
+      {"_plus_scalar", ScalarTile<mshadow_op::plus, CType>},
+      {"_npi_add_scalar", ScalarTile<mshadow_op::plus, CType>},
+      {"_minus_scalar", ScalarTile<mshadow_op::minus, CType>},
+      {"_npi_subtract_scalar", ScalarTile<mshadow_op::minus, CType>},
+      {"_rminus_scalar", ScalarTile<mshadow_op::rminus, CType>},
+      {"_npi_rsubtract_scalar", ScalarTile<mshadow_op::rminus, CType>},
+      {"_mul_scalar", ScalarTile<mshadow_op::mul, CType>},
+      {"_npi_multiply_scalar", ScalarTile<mshadow_op::mul, CType>},
+      {"_div_scalar", ScalarTile<mshadow_op::div, CType>},
+      {"_rdiv_scalar", ScalarTile<mshadow_op::rdiv, CType>},
+      {"_maximum_scalar", ScalarTile<mshadow_op::maximum, CType>},
+      {"_npi_maximum_scalar", ScalarTile<mshadow_op::maximum, CType>},
+      {"_minimum_scalar", ScalarTile<mshadow_op::minimum, CType>},
+      {"_npi_minimum_scalar", ScalarTile<mshadow_op::minimum, CType>},
+      {"_power_scalar", ScalarTile<mshadow_op::power, CType>},
+      {"_rpower_scalar", ScalarTile<mshadow_op::rpower, CType>},
+      // other
+      {"clip", ClipTile<CType>},
+      {"add_n", AddNTile<CType>},
+  };
+  return functions;
+}
+
+/*! \brief key of the tile function of a node */
+std::string CPUStepKey(const nnvm::NodeAttrs& attrs) {
+  if (attrs.op->name == "Activation") {
+    auto it = attrs.dict.find("act_type");
+    return it != attrs.dict.end() ? "Activation:" + it->second : attrs.op->name;
+  }
+  return attrs.op->name;
+}
+
+/*! \brief whether all entries have the same dtype and number of elements */
+bool IsUniform(const mxnet::ShapeVector& shapes, const std::vector<int>& dtypes, size_t size) {
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    if (shapes[i].Size() != size || dtypes[i] != dtypes[0])
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool IsCPUFusionCompatible(const nnvm::Node* n) {
+  using namespace mshadow;
+  static auto& fcompute     = nnvm::Op::GetAttr<FCompute>("FCompute<cpu>");
+  static auto& fresource    = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static auto& fresource_ex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  if (n->op() == nullptr || n->num_outputs() != 1)
+    return false;
+  if (TileFunctions<float>().count(CPUStepKey(n->attrs)) == 0)
+    return false;
+  // the fallback runs the node with its FCompute and the temp space of the fused op
+  if (fcompute.get(n->op(), nullptr) == nullptr)
+    return false;
+  std::vector<ResourceRequest> requests;
+  if (fresource_ex.count(n->op())) {
+    requests = fresource_ex[n->op()](n->attrs, cpu::kDevMask, DispatchMode::kFCompute);
+  } else if (fresource.count(n->op())) {
+    requests = fresource[n->op()](n->attrs);
+  }
+  for (const auto& r : requests) {
+    if (r.type != ResourceRequest::kTempSpace)
+      return false;
+  }
+  return true;
+}
+
+bool FusedOp::BuildCPUProgram() {
+  const auto& functions  = TileFunctions<float>();
+  const auto& g          = subgraph_.indexed_graph();
+  const auto& input_nids = g.input_nodes();
+  std::vector<uint32_t> entry_slots(g.num_node_entries(), 0);
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    entry_slots[g.entry_id(input_nids[i], 0)] = i;
+  }
+  uint32_t num_slots = input_nids.size();
+  cpu_steps_.clear();
+  cpu_output_slots_.clear();
+  for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const auto& node = g[nid];
+    if (node.source->is_variable())
+      continue;
+    const auto& attrs = node.source->attrs;
+    CPUStep step;
+    step.op = CPUStepKey(attrs);
+    if (functions.count(step.op) == 0 || node.source->num_outputs() != 1)
+      return false;
+    for (const auto& e : node.inputs) {
+      step.inputs.push_back(entry_slots[g.entry_id(e)]);
+    }
+    if (attrs.op->name == "clip") {
+      step.params.push_back(std::stod(attrs.dict.at("a_min")));
+      step.params.push_back(std::stod(attrs.dict.at("a_max")));
+    } else if (attrs.dict.count("scalar")) {
+      step.params.push_back(std::stod(attrs.dict.at("scalar")));
+    }
+    step.output                     = num_slots++;
+    entry_slots[g.entry_id(nid, 0)] = step.output;
+    cpu_steps_.push_back(std::move(step));
+  }
+  for (const auto& e : g.outputs()) {
+    cpu_output_slots_.push_back(entry_slots[g.entry_id(e)]);
+  }
+  return true;
+}
+
+template <typename DType, typename CType>
+void FusedOp::ForwardCPUTiled(const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  const auto& functions = TileFunctions<CType>();
+  std::vector<TileFn<CType>> steps;
+  for (const auto& step : cpu_steps_) {
+    steps.push_back(functions.at(step.op));
+  }
+  const index_t N         = outputs[0].Size();
+  const index_t num_tiles = (N + kCPUTile - 1) / kCPUTile;
+  const size_t num_slots  = inputs.size() + cpu_steps_.size();
+  const int omp_threads   = std::max<index_t>(
+      std::min<index_t>(engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), num_tiles), 1);
+#pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<CType> buffer(num_slots * kCPUTile);
+    std::vector<const CType*> slots(num_slots);
+    std::vector<const CType*> args;
+    for (size_t i = inputs.size(); i < num_slots; ++i) {
+      slots[i] = buffer.data() + i * kCPUTile;
+    }
+#pragma omp for
+    for (index_t tile = 0; tile < num_tiles; ++tile) {
+      const index_t begin = tile * kCPUTile;
+      const index_t n     = std::min(kCPUTile, N - begin);
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        const DType* in = inputs[i].dptr<DType>() + begin;
+        if (std::is_same<DType, CType>::value) {
+          slots[i] = reinterpret_cast<const CType*>(in);
+        } else {
+          CType* converted = buffer.data() + i * kCPUTile;
+          for (index_t j = 0; j < n; ++j) {
+            converted[j] = static_cast<CType>(in[j]);
+          }
+          slots[i] = converted;
+        }
+      }
+      for (size_t s = 0; s < cpu_steps_.size(); ++s) {
+        const auto& step = cpu_steps_[s];
+        args.clear();
+        for (const auto slot : step.inputs) {
+          args.push_back(slots[slot]);
+        }
+        CType* out = buffer.data() + step.output * kCPUTile;
+        steps[s](args.data(), args.size(), step.params.data(), out, n);
+      }
+      // the outputs are stored once the tile is computed, as they may share memory
+      // with the inputs
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        const CType* result = slots[cpu_output_slots_[i]];
+        DType* out          = outputs[i].dptr<DType>() + begin;
+        if (req[i] == kAddTo) {
+          for (index_t j = 0; j < n; ++j) {
+            out[j] = static_cast<DType>(static_cast<CType>(out[j]) + result[j]);
+          }
+        } else if (req[i] != kNullOp) {
+          for (index_t j = 0; j < n; ++j) {
+            out[j] = static_cast<DType>(result[j]);
+          }
+        }
+      }
+    }
+  }
+}
+
+void FusedOp::ForwardCPUFallback(const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  static auto& fcompute   = nnvm::Op::GetAttr<FCompute>("FCompute<cpu>");
+  const auto& g           = subgraph_.indexed_graph();
+  const auto& node_shapes = intermediate_shapes_[0].internal_attr;
+  const auto& node_dtypes = intermediate_dtypes_[0].internal_attr;
+  const auto& input_nids  = g.input_nodes();
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+
+  // the node outputs live in a separate buffer, the temp space is used by the nodes
+  std::vector<size_t> offsets(g.num_node_entries(), 0);
+  size_t total = 0;
+  for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+    if (g[nid].source->is_variable())
+      continue;
+    for (uint32_t i = 0; i < g[nid].source->num_outputs(); ++i) {
+      const uint32_t eid = g.entry_id(nid, i);
+      offsets[eid]       = total;
+      const size_t bytes = node_shapes[eid].Size() * mshadow::mshadow_sizeof(node_dtypes[eid]);
+      total += (bytes + 63) / 64 * 64;
+    }
+  }
+  std::vector<double> buffer(total / sizeof(double));
+  char* base = reinterpret_cast<char*>(buffer.data());
+
+  std::vector<TBlob> entries(g.num_node_entries());
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    entries[g.entry_id(input_nids[i], 0)] = inputs[i];
+  }
+  for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const auto& node = g[nid];
+    if (node.source->is_variable())
+      continue;
+    std::vector<TBlob> in_blobs, out_blobs;
+    for (const auto& e : node.inputs) {
+      in_blobs.push_back(entries[g.entry_id(e)]);
+    }
+    for (uint32_t i = 0; i < node.source->num_outputs(); ++i) {
+      const uint32_t eid = g.entry_id(nid, i);
+      entries[eid] =
+          TBlob(base + offsets[eid], node_shapes[eid], cpu::kDevMask, node_dtypes[eid]);
+      out_blobs.push_back(entries[eid]);
+    }
+    std::vector<OpReqType> reqs(out_blobs.size(), kWriteTo);
+    fcompute[node.source->op()](node.source->attrs, ctx, in_blobs, reqs, out_blobs);
+  }
+
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const TBlob& result = entries[g.entry_id(g.outputs()[i])];
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(outputs[i].type_flag_, DType, {
+      MXNET_ASSIGN_REQ_SWITCH(req[i], Req, {
+        Kernel<op_with_req<mshadow_op::identity, Req>, cpu>::Launch(
+            s, outputs[i].Size(), outputs[i].dptr<DType>(), result.dptr<DType>());
+      });
+    });
+  }
+}
+
+template <>
+void FusedOp::Forward<cpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  std::lock_guard<std::mutex> lock(my_mutex_);
+  CHECK_GE(outputs.size(), 1) << "There needs to be at least 1 output.";
+
+  std::vector<int> in_dtypes;
+  std::vector<int> in_ndims;
+  std::vector<int> out_dtypes;
+  std::vector<int> out_ndims;
+  CheckShapesAndTypes(inputs, outputs, &in_dtypes, &in_ndims, &out_dtypes, &out_ndims, nullptr);
+
+  if (!initialized_) {
+    cpu_interpreted_ = BuildCPUProgram();
+    initialized_     = true;
+  }
+
+  const auto& node_shapes = intermediate_shapes_[0].internal_attr;
+  const auto& node_dtypes = intermediate_dtypes_[0].internal_attr;
+  const int dtype         = outputs[0].type_flag_;
+  // the other dtypes are left to the fallback
+  const bool tiled = cpu_interpreted_ &&
+                     (dtype <= mshadow::kInt64 || dtype == mshadow::kBfloat16) &&
+                     IsUniform(node_shapes, node_dtypes, outputs[0].Size());
+  if (!tiled) {
+    ForwardCPUFallback(ctx, inputs, req, outputs);
+    return;
+  }
+  MSHADOW_TYPE_SWITCH(dtype, DType, {
+    // half precision is computed in float, like in the GPU kernels
+    using CType = typename std::conditional<std::is_same<DType, mshadow::half::half_t>::value ||
+                                                std::is_same<DType, mshadow::bfloat::bf16_t>::value,
+                                            float,
+                                            DType>::type;
+    ForwardCPUTiled<DType, CType>(ctx, inputs, req, outputs);
+  });
+}
+
+void FusedOpForwardCPU(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  const FusedOpPtr& op = nnvm::get<FusedOpPtr>(attrs.parsed);
+  op->Forward<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
+NNVM_REGISTER_OP(_FusedOp).set_attr<FCompute>("FCompute<cpu>", FusedOpForwardCPU);
+
+}  // namespace mxnet
@@ -0,0 +1,339 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_preprocess-inl.h
+ * \brief fused resize, crop or pad, to_tensor and normalize of a list of images
+ */
+
+#ifndef MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
+#define MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "image_utils.h"
+
+namespace mxnet {
+namespace op {
+namespace image {
+
+using namespace mshadow;
+
+enum BatchPreprocessMode { kLetterbox, kCenterCrop };
+
+struct BatchPreprocessParam : public dmlc::Parameter<BatchPreprocessParam> {
+  int num_images;
+  mxnet::Tuple<int> size;
+  int mode;
+  mxnet::Tuple<float> mean;
+  mxnet::Tuple<float> std;
+  float pad_value;
+  DMLC_DECLARE_PARAMETER(BatchPreprocessParam) {
+    DMLC_DECLARE_FIELD(num_images).set_lower_bound(1).describe("Number of input images.");
+    DMLC_DECLARE_FIELD(size).describe(
+        "Size of the output images. Could be (width, height) or (size)");
+    DMLC_DECLARE_FIELD(mode)
+        .set_default(kLetterbox)
+        .add_enum("letterbox", kLetterbox)
+        .add_enum("center_crop", kCenterCrop)
+        .describe(
+            "letterbox resizes the long edge to the output size, keeping the aspect ratio, "
+            "and pads the borders with pad_value. center_crop resizes the short edge to the "
+            "output size and crops the center.");
+    DMLC_DECLARE_FIELD(mean)
+        .set_default(mxnet::Tuple<float>{0.0f})
+        .describe("Sequence of means for each channel, applied after scaling to [0, 1].");
+    DMLC_DECLARE_FIELD(std)
+        .set_default(mxnet::Tuple<float>{1.0f})
+        .describe("Sequence of standard deviations for each channel.");
+    DMLC_DECLARE_FIELD(pad_value)
+        .set_default(0.0f)
+        .describe("Pixel value of the letterbox borders, in the range of the input images.");
+  }
+};
+
+/*! \brief where an image lands in the output, in output pixels */
+struct PreprocessGeometry {
+  int height;
+  int width;
+  /*! \brief size of the resized image, larger than the output for center_crop */
+  int resized_h;
+  int resized_w;
+  /*! \brief position of the resized image in the output, negative for center_crop */
+  int off_y;
+  int off_x;
+};
+
+inline PreprocessGeometry GetPreprocessGeometry(int height,
+                                                int width,
+                                                int out_h,
+                                                int out_w,
+                                                int mode) {
+  const float scale_h = static_cast<float>(out_h) / height;
+  const float scale_w = static_cast<float>(out_w) / width;
+  PreprocessGeometry g;
+  g.height = height;
+  g.width  = width;
+  if (mode == kLetterbox) {
+    const float scale = std::min(scale_h, scale_w);
+    g.resized_h       = std::min(out_h, std::max(1, static_cast<int>(std::round(height * scale))));
+    g.resized_w       = std::min(out_w, std::max(1, static_cast<int>(std::round(width * scale))));
+  } else {
+    const float scale = std::max(scale_h, scale_w);
+    g.resized_h       = std::max(out_h, static_cast<int>(std::round(height * scale)));
+    g.resized_w       = std::max(out_w, static_cast<int>(std::round(width * scale)));
+  }
+  g.off_y = (out_h - g.resized_h) / 2;
+  g.off_x = (out_w - g.resized_w) / 2;
+  return g;
+}
+
+/*!
+ * \brief bilinear taps along one axis for output coordinate dst in the resized image,
+ *  with the half pixel centers of cv::resize INTER_LINEAR
+ */
+MSHADOW_XINLINE void PreprocessTaps(int dst, int resized, int src, int* i0, int* i1, float* frac) {
+  float s = (dst + 0.5f) * src / resized - 0.5f;
+  s       = s > 0.f ? s : 0.f;
+  int i   = static_cast<int>(s);
+  if (i >= src - 1) {
+    *i0   = src - 1;
+    *i1   = src - 1;
+    *frac = 0.f;
+  } else {
+    *i0   = i;
+    *i1   = i + 1;
+    *frac = s - i;
+  }
+}
+
+/*! \brief the images of one launch, passed to the kernel by value */
+template <typename DType>
+struct BatchPreprocessKernelParam {
+  static const int N            = 64;
+  static const int kMaxChannels = 3;
+  int count;
+  int channels;
+  int out_h;
+  int out_w;
+  float pad_value;
+  /*! \brief out = pixel * scale + bias folds x / 255, - mean and / std */
+  float scale[kMaxChannels];
+  float bias[kMaxChannels];
+  const DType* images[N];
+  PreprocessGeometry geometry[N];
+};
+
+/*!
+ * \brief writes the (C, out_h, out_w) output pixel (y, x) of an image from its HWC input
+ */
+template <typename DType>
+MSHADOW_XINLINE void PreprocessPixel(const BatchPreprocessKernelParam<DType>& param,
+                                     const DType* image,
+                                     const PreprocessGeometry& g,
+                                     int y0, int y1, float fy,
+                                     int x0, int x1, float fx,
+                                     bool inside,
+                                     float* out,
+                                     size_t plane) {
+  const int C = param.channels;
+  for (int c = 0; c < C; ++c) {
+    float v = param.pad_value;
+    if (inside) {
+      const float top = (1.f - fx) * static_cast<float>(image[(y0 * g.width + x0) * C + c]) +
+                        fx * static_cast<float>(image[(y0 * g.width + x1) * C + c]);
+      const float bot = (1.f - fx) * static_cast<float>(image[(y1 * g.width + x0) * C + c]) +
+                        fx * static_cast<float>(image[(y1 * g.width + x1) * C + c]);
+      v = (1.f - fy) * top + fy * bot;
+    }
+    out[c * plane] = v * param.scale[c] + param.bias[c];
+  }
+}
+
+#if MXNET_USE_CUDA
+template <typename DType>
+void BatchPreprocessImplCUDA(Stream<gpu>* s,
+                             const BatchPreprocessKernelParam<DType>& param,
+                             float* out);
+#endif  // MXNET_USE_CUDA
+
+inline SizeParam BatchPreprocessSize(const BatchPreprocessParam& param) {
+  CHECK((param.size.ndim() == 1) || (param.size.ndim() == 2))
+      << "Output size dimension must be 1 or 2, but got " << param.size.ndim();
+  const int width  = param.size[0];
+  const int height = param.size.ndim() == 1 ? param.size[0] : param.size[1];
+  CHECK(width > 0 && height > 0) << "Output size should be greater than 0, but got "
+                                 << param.size;
+  return SizeParam(height, width);
+}
+
+inline bool BatchPreprocessShape(const nnvm::NodeAttrs& attrs,
+                                 mxnet::ShapeVector* in_attrs,
+                                 mxnet::ShapeVector* out_attrs) {
+  const BatchPreprocessParam& param = nnvm::get<BatchPreprocessParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), static_cast<size_t>(param.num_images));
+  int nchannels = -1;
+  for (const auto& ishape : *in_attrs) {
+    if (!mxnet::ndim_is_known(ishape))
+      return false;
+    CHECK_EQ(ishape.ndim(), 3U) << "Input images must have shape (height, width, channels), "
+                                << "but got " << ishape;
+    CHECK(ishape[C] == 3 || ishape[C] == 1)
+        << "The last dimension of input images must be the channel dimension with "
+        << "either 1 or 3 elements, but got input with shape " << ishape;
+    CHECK(ishape[H] > 0 && ishape[W] > 0) << "Input images must not be empty, got " << ishape;
+    CHECK(nchannels == -1 || nchannels == ishape[C])
+        << "All input images must have the same number of channels, got " << nchannels << " and "
+        << ishape[C];
+    nchannels = ishape[C];
+  }
+  CHECK((param.mean.ndim() == 1) || (param.mean.ndim() == nchannels))
+      << "mean must have either 1 or " << nchannels << " elements, but got " << param.mean;
+  CHECK((param.std.ndim() == 1) || (param.std.ndim() == nchannels))
+      << "std must have either 1 or " << nchannels << " elements, but got " << param.std;
+  const SizeParam size = BatchPreprocessSize(param);
+  SHAPE_ASSIGN_CHECK(
+      *out_attrs, 0, mxnet::TShape({param.num_images, nchannels, size.height, size.width}));
+  return true;
+}
+
+inline bool BatchPreprocessType(const nnvm::NodeAttrs& attrs,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  int dtype = -1;
+  for (const int t : *in_attrs) {
+    if (t == -1)
+      continue;
+    CHECK(dtype == -1 || dtype == t) << "All input images must have the same type";
+    dtype = t;
+  }
+  if (dtype == -1)
+    return false;
+  for (size_t i = 0; i < in_attrs->size(); ++i)
+    TYPE_ASSIGN_CHECK(*in_attrs, i, dtype);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  return true;
+}
+
+template <typename DType>
+inline void BatchPreprocessImpl(const BatchPreprocessKernelParam<DType>& param, float* out) {
+  const size_t plane = static_cast<size_t>(param.out_h) * param.out_w;
+  // the horizontal taps are shared by all rows of an image
+  std::vector<int> taps(param.count * param.out_w * 2);
+  std::vector<float> fracs(param.count * param.out_w);
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  for (int n = 0; n < param.count; ++n) {
+    const PreprocessGeometry& g = param.geometry[n];
+    for (int x = 0; x < param.out_w; ++x) {
+      const int k = n * param.out_w + x;
+      PreprocessTaps(x - g.off_x, g.resized_w, g.width, &taps[2 * k], &taps[2 * k + 1], &fracs[k]);
+    }
+  }
+  const int rows = param.count * param.out_h;
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  for (int r = 0; r < rows; ++r) {
+    const int n                 = r / param.out_h;
+    const int y                 = r % param.out_h;
+    const PreprocessGeometry& g = param.geometry[n];
+    const int ry                = y - g.off_y;
+    int y0, y1;
+    float fy;
+    PreprocessTaps(ry, g.resized_h, g.height, &y0, &y1, &fy);
+    const bool row_inside = ry >= 0 && ry < g.resized_h;
+    const int* xtaps      = &taps[2 * n * param.out_w];
+    const float* xfracs   = &fracs[n * param.out_w];
+    float* row            = out + n * param.channels * plane + static_cast<size_t>(y) * param.out_w;
+    for (int x = 0; x < param.out_w; ++x) {
+      const int rx = x - g.off_x;
+      PreprocessPixel(param,
+                      param.images[n],
+                      g,
+                      y0,
+                      y1,
+                      fy,
+                      xtaps[2 * x],
+                      xtaps[2 * x + 1],
+                      xfracs[x],
+                      row_inside && rx >= 0 && rx < g.resized_w,
+                      row + x,
+                      plane);
+    }
+  }
+}
+
+template <typename xpu>
+inline void BatchPreprocess(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  const BatchPreprocessParam& param = nnvm::get<BatchPreprocessParam>(attrs.parsed);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_NE(req[0], kAddTo) << "batch_preprocess does not support kAddTo";
+  if (req[0] == kNullOp)
+    return;
+  const SizeParam size = BatchPreprocessSize(param);
+  const int nchannels  = inputs[0].shape_[C];
+  float* out           = outputs[0].dptr<float>();
+  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    using KernelParam = BatchPreprocessKernelParam<DType>;
+    KernelParam kparam;
+    kparam.channels  = nchannels;
+    kparam.out_h     = size.height;
+    kparam.out_w     = size.width;
+    kparam.pad_value = param.pad_value;
+    for (int c = 0; c < nchannels; ++c) {
+      const float mean = param.mean[param.mean.ndim() == 1 ? 0 : c];
+      const float std  = param.std[param.std.ndim() == 1 ? 0 : c];
+      kparam.scale[c]  = 1.f / (255.f * std);
+      kparam.bias[c]   = -mean / std;
+    }
+    const size_t image_size = static_cast<size_t>(nchannels) * size.height * size.width;
+    // one launch per KernelParam::N images
+    for (int begin = 0; begin < param.num_images; begin += KernelParam::N) {
+      kparam.count = std::min(KernelParam::N, param.num_images - begin);
+      for (int i = 0; i < kparam.count; ++i) {
+        const TBlob& image = inputs[begin + i];
+        kparam.images[i]   = image.dptr<DType>();
+        kparam.geometry[i] = GetPreprocessGeometry(
+            image.shape_[H], image.shape_[W], size.height, size.width, param.mode);
+      }
+      if (std::is_same<xpu, gpu>::value) {
+#if MXNET_USE_CUDA
+        BatchPreprocessImplCUDA<DType>(ctx.get_stream<gpu>(), kparam, out + begin * image_size);
+#endif  // MXNET_USE_CUDA
+      } else {
+        BatchPreprocessImpl(kparam, out + begin * image_size);
+      }
+    }
+  });
+}
+
+}  // namespace image
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_IMAGE_BATCH_PREPROCESS_INL_H_
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_preprocess.cc
+ * \brief batch preprocess operator cpu
+ */
+#include <mxnet/base.h>
+#include "./batch_preprocess-inl.h"
+#include "../operator_common.h"
+#include "../elemwise_op_common.h"
+
+namespace mxnet {
+namespace op {
+namespace image {
+
+DMLC_REGISTER_PARAMETER(BatchPreprocessParam);
+
+NNVM_REGISTER_OP(_image_batch_preprocess)
+    .add_alias("_npx__image_batch_preprocess")
+    .describe(R"code(Resizes a list of images of shape (H x W x C) with different sizes and
+returns them as one normalized tensor of shape (N x C x height x width).
+
+Each image is resized with bilinear interpolation, then either padded (``letterbox``) or
+cropped (``center_crop``) to the output size, converted to the range [0, 1] like ``to_tensor``
+and normalized with ``mean`` and ``std`` like ``normalize``, in a single pass over the images.
+
+``letterbox`` keeps the whole image: it resizes the long edge to the output size, keeping the
+aspect ratio, and centers the image on borders of ``pad_value``. ``center_crop`` fills the
+output: it resizes the short edge to the output size and crops the center.
+
+Example
+-------
+>>> images = [mx.nd.random.uniform(0, 255, (480, 640, 3)).astype('uint8'),
+...           mx.nd.random.uniform(0, 255, (300, 200, 3)).astype('uint8')]
+>>> mx.nd.image.batch_preprocess(*images, num_images=2, size=(320, 320),
+...                              mean=(0.485, 0.456, 0.406), std=(0.229, 0.224, 0.225))
+<NDArray 2x3x320x320 @cpu(0)>
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const BatchPreprocessParam& param = dmlc::get<BatchPreprocessParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_images);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<BatchPreprocessParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const int num_images =
+                                           dmlc::get<BatchPreprocessParam>(attrs.parsed).num_images;
+                                       std::vector<std::string> ret;
+                                       for (int i = 0; i < num_images; ++i) {
+                                         ret.push_back(std::string("image_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", BatchPreprocessShape)
+    .set_attr<nnvm::FInferType>("FInferType", BatchPreprocessType)
+    .set_attr<FCompute>("FCompute<cpu>", BatchPreprocess<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<std::string>("key_var_num_args", "num_images")
+    .add_argument("images", "NDArray-or-Symbol[]", "The images, of shape (H x W x C).")
+    .add_arguments(BatchPreprocessParam::__FIELDS__());
+
+}  // namespace image
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_preprocess.cu
+ * \brief batch preprocess operator gpu
+ */
+#include "./batch_preprocess-inl.h"
+
+namespace mxnet {
+namespace op {
+namespace image {
+
+using namespace mshadow;
+
+// One thread per output pixel of all the images of the launch, writing all channels.
+template <typename DType>
+__global__ void BatchPreprocessKernel(const BatchPreprocessKernelParam<DType> param,
+                                      float* out) {
+  const int plane = param.out_h * param.out_w;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < param.count * plane;
+       i += blockDim.x * gridDim.x) {
+    const int n                 = i / plane;
+    const int y                 = (i % plane) / param.out_w;
+    const int x                 = i % param.out_w;
+    const PreprocessGeometry& g = param.geometry[n];
+    const int ry                = y - g.off_y;
+    const int rx                = x - g.off_x;
+    int y0, y1, x0, x1;
+    float fy, fx;
+    PreprocessTaps(ry, g.resized_h, g.height, &y0, &y1, &fy);
+    PreprocessTaps(rx, g.resized_w, g.width, &x0, &x1, &fx);
+    PreprocessPixel(param,
+                    param.images[n],
+                    g,
+                    y0,
+                    y1,
+                    fy,
+                    x0,
+                    x1,
+                    fx,
+                    ry >= 0 && ry < g.resized_h && rx >= 0 && rx < g.resized_w,
+                    out + static_cast<size_t>(n) * param.channels * plane + y * param.out_w + x,
+                    plane);
+  }
+}
+
+template <typename DType>
+void BatchPreprocessImplCUDA(Stream<gpu>* s,
+                             const BatchPreprocessKernelParam<DType>& param,
+                             float* out) {
+  const int num_pixels = param.count * param.out_h * param.out_w;
+  BatchPreprocessKernel<DType><<<mxnet_op::cuda_get_num_blocks(num_pixels),
+                                 mshadow::cuda::kBaseThreadNum,
+                                 0,
+                                 Stream<gpu>::GetStream(s)>>>(param, out);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(BatchPreprocessKernel);
+}
+
+NNVM_REGISTER_OP(_image_batch_preprocess).set_attr<FCompute>("FCompute<gpu>", BatchPreprocess<gpu>);
+
+}  // namespace image
+}  // namespace op
+}  // namespace mxnet
@@ -48,6 +48,9 @@ using namespace mshadow;
 // The batched versions all work on tensors with one more dimension as the
 // non-batched ones and the first/highest dimension iterates over the elements
 // within the batch.
+// The batched versions of potrf, potri, trsm and syevd process the batches of matrices of at most
+// MXNET_LINALG_SMALL_MATRIX_SIZE rows as a whole: in parallel over the matrices on CPU, by the
+// batched cuBLAS/cuSOLVER routines on GPU.
 
 //////////////////////////////// GEMM ////////////////////////////////////////////
 
@@ -151,6 +154,7 @@ void linalg_batch_trmm(const Tensor<xpu, 3, DType>& A,
 template <typename xpu, typename DType>
 void linalg_potrf(const Tensor<xpu, 2, DType>& A, bool lower, Stream<xpu>* s = 0);
 
+// The batched version may overwrite the other triangle of the matrices.
 template <typename xpu, typename DType>
 void linalg_batch_potrf(const Tensor<xpu, 3, DType>& A, bool lower, Stream<xpu>* s = 0);
 
@@ -235,6 +239,18 @@ IndexT linalg_syevd_workspace_query(const Tensor<xpu, 2, DType>& A,
                                     const Tensor<xpu, 1, DType>& L,
                                     Stream<xpu>* s = 0);
 
+// Batched version, with the eigenvalues of A[i] in L[i], and its workspace query.
+template <typename xpu, typename DType>
+void linalg_batch_syevd(const Tensor<xpu, 3, DType>& A,
+                        const Tensor<xpu, 2, DType>& L,
+                        const Tensor<xpu, 1, DType>& work,
+                        Stream<xpu>* s = 0);
+
+template <typename xpu, typename DType, typename IndexT = typename LapackIndex<xpu>::IndexT>
+IndexT linalg_batch_syevd_workspace_query(const Tensor<xpu, 3, DType>& A,
+                                          const Tensor<xpu, 2, DType>& L,
+                                          Stream<xpu>* s = 0);
+
 //////////////////////////////// GESVD ////////////////////////////////////////////
 
 // CPU/GPU-versions of LAPACK function "gesvd". Please refer to the
@@ -25,9 +25,12 @@
 #ifndef MXNET_OPERATOR_LINALG_IMPL_H_
 #define MXNET_OPERATOR_LINALG_IMPL_H_
 
+#include <dmlc/parameter.h>
 #include <mxnet/op_attr_types.h>
 
 #include <algorithm>
+#include <cmath>
+#include <exception>
 
 #include "../common/cuda/utils.h"
 #include "mxnet_op.h"
@@ -44,8 +47,158 @@ inline void linalg_check_batch_size(int A, int B, int C) {
   Storage::Handle var = Storage::Get()->Alloc(sizeof(dtype) * size, Context::GPU()); \
   var.profiler_scope  = "<ephemeral>:";                                              \
   var.name            = #func "_" #var;
+
+// The batched routines of cuBLAS and cuSOLVER take DType *matrices[] as input to store the
+// pointers of each batch matrix. This kernel is used to build the pointer array.
+struct set_matrix {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
+    p[i] = m + i * step;
+  }
+};
 #endif
 
+//////////////////////////////// SMALL MATRICES ////////////////////////////////////
+
+// The batches of matrices of at most MXNET_LINALG_SMALL_MATRIX_SIZE rows and columns are
+// processed as a whole: on CPU by the kernels below, or by LAPACK calls, in parallel over the
+// matrices, and on GPU by the batched routines of cuBLAS and cuSOLVER. Larger matrices are
+// processed one at a time by the (multithreaded) LAPACK, cuBLAS and cuSOLVER routines.
+inline bool linalg_is_small_matrix(index_t n) {
+  static const int max_size = dmlc::GetEnv("MXNET_LINALG_SMALL_MATRIX_SIZE", 64);
+  return n <= max_size;
+}
+
+template <typename xpu>
+inline int linalg_batch_omp_threads(index_t batch_size, index_t n) {
+  return 1;
+}
+
+template <>
+inline int linalg_batch_omp_threads<cpu>(index_t batch_size, index_t n) {
+  if (batch_size < 2 || !linalg_is_small_matrix(n))
+    return 1;
+  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  return static_cast<int>(std::max<index_t>(1, std::min<index_t>(batch_size, omp_threads)));
+}
+
+template <typename Body>
+inline void linalg_batch_for(index_t batch_size, int num_threads, const Body& body) {
+  if (num_threads < 2) {
+    for (index_t i = 0; i < batch_size; ++i) {
+      body(i, 0);
+    }
+    return;
+  }
+  // errors cannot leave a parallel region
+  std::exception_ptr error;
+#pragma omp parallel for num_threads(num_threads)
+  for (index_t i = 0; i < batch_size; ++i) {
+    try {
+      body(i, omp_get_thread_num());
+    } catch (...) {
+#pragma omp critical
+      error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+// Kernels of the CPU for the small matrices. The element (i, j) of a matrix is at
+// a[i * rs + j * cs], so that the kernels work on the lower triangle of a row-major matrix for
+// (rs, cs) = (stride, 1) and on its upper triangle, transposed, for (rs, cs) = (1, stride).
+
+// Cholesky factor L of A = L * L^T in the lower triangle, the upper one being left untouched.
+// Returns false when A is not positive definite.
+template <typename DType>
+inline bool linalg_small_potrf(DType* a, int n, int rs, int cs) {
+  for (int j = 0; j < n; ++j) {
+    DType* aj = a + j * rs;
+    DType d   = aj[j * cs];
+    for (int k = 0; k < j; ++k) {
+      d -= aj[k * cs] * aj[k * cs];
+    }
+    if (!(d > DType(0)))
+      return false;
+    d          = std::sqrt(d);
+    aj[j * cs] = d;
+    for (int i = j + 1; i < n; ++i) {
+      DType* ai = a + i * rs;
+      DType v   = ai[j * cs];
+      for (int k = 0; k < j; ++k) {
+        v -= ai[k * cs] * aj[k * cs];
+      }
+      ai[j * cs] = v / d;
+    }
+  }
+  return true;
+}
+
+// Lower triangle of A^-1 = L^-T * L^-1 from the Cholesky factor L in the lower triangle.
+// Returns false when L is singular.
+template <typename DType>
+inline bool linalg_small_potri(DType* a, int n, int rs, int cs) {
+  auto at = [=](int i, int j) -> DType& { return a[i * rs + j * cs]; };
+  // L^-1, column by column
+  for (int j = 0; j < n; ++j) {
+    if (at(j, j) == DType(0))
+      return false;
+    at(j, j) = DType(1) / at(j, j);
+    for (int i = j + 1; i < n; ++i) {
+      DType v = at(i, j) * at(j, j);
+      for (int k = j + 1; k < i; ++k) {
+        v += at(i, k) * at(k, j);
+      }
+      at(i, j) = -v / at(i, i);
+    }
+  }
+  // L^-T * L^-1, row by row, each element overwriting the last one of L^-1 it reads
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      DType v(0);
+      for (int k = i; k < n; ++k) {
+        v += at(k, i) * at(k, j);
+      }
+      at(i, j) = v;
+    }
+  }
+  return true;
+}
+
+// B = alpha * M^-1 * B for the triangular n x n matrix M at (m, mrs, mcs) and the n x k matrix
+// B at (b, brs, bcs), by substitution over the rows of B.
+template <typename DType>
+inline void linalg_small_trsm(const DType* m,
+                              int mrs,
+                              int mcs,
+                              bool lower,
+                              DType* b,
+                              int n,
+                              int k,
+                              int brs,
+                              int bcs,
+                              DType alpha) {
+  for (int t = 0; t < n; ++t) {
+    const int i = lower ? t : n - 1 - t;
+    DType* bi   = b + i * brs;
+    for (int c = 0; c < k; ++c) {
+      bi[c * bcs] *= alpha;
+    }
+    for (int j = (lower ? 0 : i + 1); j < (lower ? i : n); ++j) {
+      const DType mij = m[i * mrs + j * mcs];
+      const DType* bj = b + j * brs;
+      for (int c = 0; c < k; ++c) {
+        bi[c * bcs] -= mij * bj[c * bcs];
+      }
+    }
+    const DType d = m[i * mrs + i * mcs];
+    for (int c = 0; c < k; ++c) {
+      bi[c * bcs] /= d;
+    }
+  }
+}
+
 //////////////////////////////// GEMM ////////////////////////////////////////////
 
 // CPU/GPU-versions of BLAS3 function "gemm". Please refer to the BLAS3-documentation
@@ -776,21 +929,6 @@ inline void check_trsm(const Tensor<xpu, 2, DType>& A,
                   B.stride_);                                         \
   }
 
-#define LINALG_XPU_BATCH_TRSM(xpu, DType)                                   \
-  template <>                                                               \
-  inline void linalg_batch_trsm<xpu, DType>(const Tensor<xpu, 3, DType>& A, \
-                                            const Tensor<xpu, 3, DType>& B, \
-                                            DType alpha,                    \
-                                            bool rightside,                 \
-                                            bool lower,                     \
-                                            bool transpose,                 \
-                                            Stream<xpu>* s) {               \
-    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));               \
-    for (index_t i = 0; i < A.size(0); ++i) {                               \
-      linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);       \
-    }                                                                       \
-  }
-
 #else
 
 #define LINALG_CPU_TRSM(fname, DType)                                 \
@@ -805,25 +943,54 @@ inline void check_trsm(const Tensor<xpu, 2, DType>& A,
     LOG(FATAL) << "linalg_trsm not implemented, needs cblas!";        \
   }
 
-#define LINALG_XPU_BATCH_TRSM(xpu, DType)                                   \
+#endif  // MSHADOW_USE_CBLAS == 1 || MSHADOW_USE_MKL == 1
+
+LINALG_CPU_TRSM(strsm, float)
+LINALG_CPU_TRSM(dtrsm, double)
+
+// Small matrices are solved by linalg_small_trsm for M = op(A) on the left side, and for
+// M = op(A)^T and B^T on the right side.
+template <typename DType>
+inline void linalg_batch_trsm_small(const Tensor<cpu, 3, DType>& A,
+                                    const Tensor<cpu, 3, DType>& B,
+                                    DType alpha,
+                                    bool rightside,
+                                    bool lower,
+                                    bool transpose) {
+  const bool mtrans = rightside != transpose;
+  const int mrs     = mtrans ? 1 : A.stride_;
+  const int mcs     = mtrans ? A.stride_ : 1;
+  const int n       = rightside ? B.size(2) : B.size(1);
+  const int k       = rightside ? B.size(1) : B.size(2);
+  const int brs     = rightside ? 1 : B.stride_;
+  const int bcs     = rightside ? B.stride_ : 1;
+  linalg_batch_for(A.size(0), linalg_batch_omp_threads<cpu>(A.size(0), n), [&](index_t i, int) {
+    linalg_small_trsm(
+        A[i].dptr_, mrs, mcs, lower != mtrans, B[i].dptr_, n, k, brs, bcs, alpha);
+  });
+}
+
+#define LINALG_CPU_BATCH_TRSM(DType)                                        \
   template <>                                                               \
-  inline void linalg_batch_trsm<xpu, DType>(const Tensor<xpu, 3, DType>& A, \
-                                            const Tensor<xpu, 3, DType>& B, \
+  inline void linalg_batch_trsm<cpu, DType>(const Tensor<cpu, 3, DType>& A, \
+                                            const Tensor<cpu, 3, DType>& B, \
                                             DType alpha,                    \
                                             bool rightside,                 \
                                             bool lower,                     \
                                             bool transpose,                 \
-                                            Stream<xpu>* s) {               \
-    LOG(FATAL) << "linalg_batch_trsm not implemented, needs cblas!";        \
+                                            Stream<cpu>* s) {               \
+    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));               \
+    if (linalg_is_small_matrix(A.size(1))) {                                \
+      check_trsm(A[0], B[0], alpha, rightside, lower, transpose);           \
+      linalg_batch_trsm_small(A, B, alpha, rightside, lower, transpose);    \
+      return;                                                               \
+    }                                                                       \
+    for (index_t i = 0; i < A.size(0); ++i) {                               \
+      linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);       \
+    }                                                                       \
   }
-
-#endif  // MSHADOW_USE_CBLAS == 1 || MSHADOW_USE_MKL == 1
-
-LINALG_CPU_TRSM(strsm, float)
-LINALG_CPU_TRSM(dtrsm, double)
-
-LINALG_XPU_BATCH_TRSM(cpu, float)
-LINALG_XPU_BATCH_TRSM(cpu, double)
+LINALG_CPU_BATCH_TRSM(float)
+LINALG_CPU_BATCH_TRSM(double)
 
 #ifdef __CUDACC__
 
@@ -858,8 +1025,49 @@ LINALG_XPU_BATCH_TRSM(cpu, double)
 LINALG_GPU_TRSM(Strsm, float)
 LINALG_GPU_TRSM(Dtrsm, double)
 
-LINALG_XPU_BATCH_TRSM(gpu, float)
-LINALG_XPU_BATCH_TRSM(gpu, double)
+#define LINALG_GPU_BATCH_TRSM(fname, DType)                                                \
+  template <>                                                                              \
+  inline void linalg_batch_trsm<gpu, DType>(const Tensor<gpu, 3, DType>& A,                \
+                                            const Tensor<gpu, 3, DType>& B,                \
+                                            DType alpha,                                   \
+                                            bool rightside,                                \
+                                            bool lower,                                    \
+                                            bool transpose,                                \
+                                            Stream<gpu>* s) {                              \
+    using namespace mxnet;                                                                 \
+    using namespace mxnet::op::mxnet_op;                                                   \
+    using mshadow::gpu;                                                                    \
+    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));                              \
+    if (A.size(0) == 1 || !linalg_is_small_matrix(A.size(1))) {                            \
+      for (index_t i = 0; i < A.size(0); ++i) {                                            \
+        linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);                    \
+      }                                                                                    \
+      return;                                                                              \
+    }                                                                                      \
+    CHECK_NOTNULL(s);                                                                      \
+    check_trsm(A[0], B[0], alpha, rightside, lower, transpose);                            \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_trsm, ptr_buf, DType*, 2 * A.size(0));        \
+    DType** A_ptr = static_cast<DType**>(ptr_buf.dptr);                                    \
+    DType** B_ptr = A_ptr + A.size(0);                                                     \
+    Kernel<set_matrix, gpu>::Launch(s, A.size(0), A_ptr, A.dptr_, A.size(1) * A.stride_);  \
+    Kernel<set_matrix, gpu>::Launch(s, B.size(0), B_ptr, B.dptr_, B.size(1) * B.stride_);  \
+    CUBLAS_CALL(cublas##fname(Stream<gpu>::GetBlasHandle(s),                               \
+                              (rightside ? CUBLAS_SIDE_LEFT : CUBLAS_SIDE_RIGHT),          \
+                              (lower ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER),   \
+                              (transpose ? CUBLAS_OP_T : CUBLAS_OP_N),                     \
+                              CUBLAS_DIAG_NON_UNIT,                                        \
+                              B.size(2),                                                   \
+                              B.size(1),                                                   \
+                              &alpha,                                                      \
+                              A_ptr,                                                       \
+                              A.stride_,                                                   \
+                              B_ptr,                                                       \
+                              B.stride_,                                                   \
+                              A.size(0)));                                                 \
+    Storage::Get()->Free(ptr_buf);                                                         \
+  }
+LINALG_GPU_BATCH_TRSM(StrsmBatched, float)
+LINALG_GPU_BATCH_TRSM(DtrsmBatched, double)
 
 #endif  // __CUDACC__
 
@@ -1014,13 +1222,37 @@ inline void check_potrf(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRF(spotrf, float)
 LINALG_CPU_POTRF(dpotrf, double)
 
-#define LINALG_CPU_BATCH_POTRF(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potrf<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potrf(A[i], lower);                                    \
-    }                                                               \
+// Small matrices are factorized by the kernel linalg_small_potrf (if Op is potrf) or
+// linalg_small_potri, the upper triangle being the transposed lower one. Returns the index of the
+// first matrix failing, or the batch size.
+template <typename DType, bool (*Op)(DType*, int, int, int)>
+inline index_t linalg_batch_small_cholesky(const Tensor<cpu, 3, DType>& A, bool lower) {
+  const int rs(lower ? A.stride_ : 1), cs(lower ? 1 : A.stride_);
+  const int n(A.size(1));
+  index_t failed(A.size(0));
+  linalg_batch_for(A.size(0), linalg_batch_omp_threads<cpu>(A.size(0), n), [&](index_t i, int) {
+    if (!Op(A[i].dptr_, n, rs, cs)) {
+#pragma omp critical
+      failed = std::min(failed, i);
+    }
+  });
+  return failed;
+}
+
+#define LINALG_CPU_BATCH_POTRF(DType)                                                        \
+  template <>                                                                                \
+  inline void linalg_batch_potrf<cpu, DType>(                                                \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                          \
+    if (A.size(0) == 0 || !linalg_is_small_matrix(A.size(1))) {                              \
+      for (index_t i = 0; i < A.size(0); ++i) {                                              \
+        linalg_potrf(A[i], lower);                                                           \
+      }                                                                                      \
+      return;                                                                                \
+    }                                                                                        \
+    check_potrf(A[0], lower);                                                                \
+    index_t failed(linalg_batch_small_cholesky<DType, linalg_small_potrf<DType>>(A, lower)); \
+    CHECK_EQ(failed, A.size(0)) << "potrf failed on cpu for the matrix " << failed           \
+                                << " of the batch. " << potrf_errstr;                        \
   }
 LINALG_CPU_BATCH_POTRF(float)
 LINALG_CPU_BATCH_POTRF(double)
@@ -1069,6 +1301,47 @@ LINALG_GPU_BUFFSIZE_POTRF(DnDpotrf_bufferSize, double)
 LINALG_GPU_POTRF(DnSpotrf, float)
 LINALG_GPU_POTRF(DnDpotrf, double)
 
+// potrfBatched only available with cuda9.1 or higher. It uses the other triangle of the
+// matrices as workspace.
+#if CUDA_VERSION >= 9010
+
+#define LINALG_GPU_POTRF_BATCHED(fname, DType)                                                 \
+  inline bool linalg_potrf_batched(                                                            \
+      const Tensor<gpu, 3, DType>& A, bool lower, Stream<gpu>* s) {                            \
+    using namespace mxnet;                                                                     \
+    using namespace mxnet::op::mxnet_op;                                                       \
+    using mshadow::gpu;                                                                        \
+    if (A.size(0) == 1 || !linalg_is_small_matrix(A.size(1)))                                  \
+      return false;                                                                            \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, info, int, A.size(0));                     \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, A_ptr_buf, DType*, A.size(0));             \
+    DType** A_ptr = static_cast<DType**>(A_ptr_buf.dptr);                                      \
+    Kernel<set_matrix, gpu>::Launch(s, A.size(0), A_ptr, A.dptr_, A.size(1) * A.stride_);      \
+    CUSOLVER_CALL(cusolver##fname(Stream<gpu>::GetSolverHandle(s),                             \
+                                  (lower ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER),   \
+                                  A.size(1),                                                   \
+                                  A_ptr,                                                       \
+                                  A.stride_,                                                   \
+                                  static_cast<int*>(info.dptr),                                \
+                                  A.size(0)));                                                 \
+    Storage::Get()->Free(info);                                                                \
+    Storage::Get()->Free(A_ptr_buf);                                                           \
+    return true;                                                                               \
+  }
+
+#else
+
+#define LINALG_GPU_POTRF_BATCHED(fname, DType)                      \
+  inline bool linalg_potrf_batched(                                 \
+      const Tensor<gpu, 3, DType>& A, bool lower, Stream<gpu>* s) { \
+    return false;                                                   \
+  }
+
+#endif  // CUDA_VERSION >= 9010
+
+LINALG_GPU_POTRF_BATCHED(DnSpotrfBatched, float)
+LINALG_GPU_POTRF_BATCHED(DnDpotrfBatched, double)
+
 #define LINALG_GPU_BATCH_POTRF(fname, DType)                                                   \
   template <>                                                                                  \
   inline void linalg_batch_potrf<gpu, DType>(                                                  \
@@ -1078,6 +1351,8 @@ LINALG_GPU_POTRF(DnDpotrf, double)
     CHECK_NOTNULL(s);                                                                          \
     CHECK_GT(A.size(0), 0);                                                                    \
     check_potrf(A[0], lower);                                                                  \
+    if (linalg_potrf_batched(A, lower, s))                                                     \
+      return;                                                                                  \
     int buffsize(linalg_potrf_buffsize(A[0], lower, s));                                       \
     EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, buffer, DType, buffsize);                  \
     EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, info, int, 1);                             \
@@ -1127,13 +1402,20 @@ inline void check_potri(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRI(spotri, float)
 LINALG_CPU_POTRI(dpotri, double)
 
-#define LINALG_CPU_BATCH_POTRI(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potri<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potri(A[i], lower);                                    \
-    }                                                               \
+#define LINALG_CPU_BATCH_POTRI(DType)                                                        \
+  template <>                                                                                \
+  inline void linalg_batch_potri<cpu, DType>(                                                \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                          \
+    if (A.size(0) == 0 || !linalg_is_small_matrix(A.size(1))) {                              \
+      for (index_t i = 0; i < A.size(0); ++i) {                                              \
+        linalg_potri(A[i], lower);                                                           \
+      }                                                                                      \
+      return;                                                                                \
+    }                                                                                        \
+    check_potri(A[0], lower);                                                                \
+    index_t failed(linalg_batch_small_cholesky<DType, linalg_small_potri<DType>>(A, lower)); \
+    CHECK_EQ(failed, A.size(0)) << "potri failed on cpu for the matrix " << failed           \
+                                << " of the batch. " << potri_errstr;                        \
   }
 LINALG_CPU_BATCH_POTRI(float)
 LINALG_CPU_BATCH_POTRI(double)
@@ -1592,6 +1874,30 @@ LINALG_CPU_SYEVD(dsyevd, double)
 LINALG_CPU_SYEVD_WORKSPACE_QUERY(ssyevd, float)
 LINALG_CPU_SYEVD_WORKSPACE_QUERY(dsyevd, double)
 
+// Batches of small matrices are processed in parallel, each thread with its own workspace.
+#define LINALG_CPU_BATCH_SYEVD(DType)                                                   \
+  template <>                                                                           \
+  inline lapack_index_t linalg_batch_syevd_workspace_query<cpu, DType>(                 \
+      const Tensor<cpu, 3, DType>& A, const Tensor<cpu, 2, DType>& L, Stream<cpu>* s) { \
+    return linalg_syevd_workspace_query(A[0], L[0], s) *                                \
+           linalg_batch_omp_threads<cpu>(A.size(0), A.size(1));                         \
+  }                                                                                     \
+  template <>                                                                           \
+  inline void linalg_batch_syevd<cpu, DType>(const Tensor<cpu, 3, DType>& A,            \
+                                             const Tensor<cpu, 2, DType>& L,            \
+                                             const Tensor<cpu, 1, DType>& work,         \
+                                             Stream<cpu>* s) {                          \
+    linalg_check_batch_size(A.size(0), L.size(0), L.size(0));                           \
+    const int nthreads(linalg_batch_omp_threads<cpu>(A.size(0), A.size(1)));            \
+    const index_t lwork(work.size(0) / nthreads);                                       \
+    linalg_batch_for(A.size(0), nthreads, [&](index_t i, int thread) {                  \
+      Tensor<cpu, 1, DType> work_i(work.dptr_ + thread * lwork, Shape1(lwork), s);      \
+      linalg_syevd(A[i], L[i], work_i, s);                                              \
+    });                                                                                 \
+  }
+LINALG_CPU_BATCH_SYEVD(float)
+LINALG_CPU_BATCH_SYEVD(double)
+
 #ifdef __CUDACC__
 
 // SYEVD only available with cuda8 or higher.
@@ -1668,6 +1974,100 @@ LINALG_GPU_SYEVD(DnDsyevd, double)
 LINALG_GPU_SYEVD_WORKSPACE_QUERY(DnSsyevd, float)
 LINALG_GPU_SYEVD_WORKSPACE_QUERY(DnDsyevd, double)
 
+// syevjBatched only available with cuda9 or higher. It processes batches of matrices of at most
+// 32 rows, with Jacobi rotations, and is used for those whose eigenvalues are contiguous.
+#if CUDA_VERSION >= 9000
+
+template <typename DType>
+inline bool linalg_use_syevj_batched(const Tensor<gpu, 3, DType>& A,
+                                     const Tensor<gpu, 2, DType>& L) {
+  return A.size(0) > 1 && A.size(1) <= 32 && linalg_is_small_matrix(A.size(1)) &&
+         L.stride_ == L.size(1);
+}
+
+#define LINALG_GPU_BATCH_SYEVD(fname, DType)                                            \
+  template <>                                                                           \
+  inline int linalg_batch_syevd_workspace_query<gpu, DType>(                            \
+      const Tensor<gpu, 3, DType>& A, const Tensor<gpu, 2, DType>& L, Stream<gpu>* s) { \
+    using namespace mxnet;                                                              \
+    using mshadow::gpu;                                                                 \
+    if (!linalg_use_syevj_batched(A, L))                                                \
+      return linalg_syevd_workspace_query(A[0], L[0], s);                               \
+    int lwork(0);                                                                       \
+    syevjInfo_t params;                                                                 \
+    CUSOLVER_CALL(cusolverDnCreateSyevjInfo(&params));                                  \
+    CUSOLVER_CALL(cusolver##fname##_bufferSize(Stream<gpu>::GetSolverHandle(s),         \
+                                               CUSOLVER_EIG_MODE_VECTOR,                \
+                                               CUBLAS_FILL_MODE_UPPER,                  \
+                                               A.size(1),                               \
+                                               A.dptr_,                                 \
+                                               A.stride_,                               \
+                                               L.dptr_,                                 \
+                                               &lwork,                                  \
+                                               params,                                  \
+                                               A.size(0)));                             \
+    CUSOLVER_CALL(cusolverDnDestroySyevjInfo(params));                                  \
+    return lwork;                                                                       \
+  }                                                                                     \
+  template <>                                                                           \
+  inline void linalg_batch_syevd<gpu, DType>(const Tensor<gpu, 3, DType>& A,            \
+                                             const Tensor<gpu, 2, DType>& L,            \
+                                             const Tensor<gpu, 1, DType>& work,         \
+                                             Stream<gpu>* s) {                          \
+    using namespace mxnet;                                                              \
+    using mshadow::gpu;                                                                 \
+    CHECK_NOTNULL(s);                                                                   \
+    linalg_check_batch_size(A.size(0), L.size(0), L.size(0));                           \
+    if (!linalg_use_syevj_batched(A, L)) {                                              \
+      for (index_t i = 0; i < A.size(0); ++i) {                                         \
+        linalg_syevd(A[i], L[i], work, s);                                              \
+      }                                                                                 \
+      return;                                                                           \
+    }                                                                                   \
+    check_syevd(A[0], L[0]);                                                            \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_syevd, info, int, A.size(0));              \
+    syevjInfo_t params;                                                                 \
+    CUSOLVER_CALL(cusolverDnCreateSyevjInfo(&params));                                  \
+    CUSOLVER_CALL(cusolver##fname(Stream<gpu>::GetSolverHandle(s),                      \
+                                  CUSOLVER_EIG_MODE_VECTOR,                             \
+                                  CUBLAS_FILL_MODE_UPPER,                               \
+                                  A.size(1),                                            \
+                                  A.dptr_,                                              \
+                                  A.stride_,                                            \
+                                  L.dptr_,                                              \
+                                  work.dptr_,                                           \
+                                  work.size(0),                                         \
+                                  static_cast<int*>(info.dptr),                         \
+                                  params,                                               \
+                                  A.size(0)));                                          \
+    CUSOLVER_CALL(cusolverDnDestroySyevjInfo(params));                                  \
+    Storage::Get()->Free(info);                                                         \
+  }
+
+#else
+
+#define LINALG_GPU_BATCH_SYEVD(fname, DType)                                            \
+  template <>                                                                           \
+  inline int linalg_batch_syevd_workspace_query<gpu, DType>(                            \
+      const Tensor<gpu, 3, DType>& A, const Tensor<gpu, 2, DType>& L, Stream<gpu>* s) { \
+    return linalg_syevd_workspace_query(A[0], L[0], s);                                 \
+  }                                                                                     \
+  template <>                                                                           \
+  inline void linalg_batch_syevd<gpu, DType>(const Tensor<gpu, 3, DType>& A,            \
+                                             const Tensor<gpu, 2, DType>& L,            \
+                                             const Tensor<gpu, 1, DType>& work,         \
+                                             Stream<gpu>* s) {                          \
+    linalg_check_batch_size(A.size(0), L.size(0), L.size(0));                           \
+    for (index_t i = 0; i < A.size(0); ++i) {                                           \
+      linalg_syevd(A[i], L[i], work, s);                                                \
+    }                                                                                   \
+  }
+
+#endif  // CUDA_VERSION >= 9000
+
+LINALG_GPU_BATCH_SYEVD(DnSsyevjBatched, float)
+LINALG_GPU_BATCH_SYEVD(DnDsyevjBatched, double)
+
 #endif  // __CUDACC__
 
 //////////////////////////////// GESVD ////////////////////////////////////////////
@@ -1854,16 +2254,6 @@ LINALG_CPU_BATCH_GETRF(dgetrf, double, LapackIndex<cpu>::IndexT)
 
 #ifdef __CUDACC__
 
-// "getrfBatched" and "getriBatched" in cuBLAS must have DType *matrices[] as input
-// to store the pointers of each batch matrix. This kernel is used to build the
-// pointer array.
-struct set_matrix {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
-    p[i] = m + i * step;
-  }
-};
-
 // GETRF only available with cuda8 or higher.
 #if CUDA_VERSION >= 8000
 
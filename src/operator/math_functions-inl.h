@@ -27,6 +27,7 @@
 #define MXNET_OPERATOR_MATH_FUNCTIONS_INL_H_
 
 #include "math.h"
+#include "./vectorized_math-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -54,6 +55,28 @@ namespace math {
     return ::name(static_cast<double>(a));                                                    \
   }
 
+// The float functions of the cpu are vec::name, which the loops of the kernels vectorize
+#if MXNET_USE_VECTORIZED_MATH && !defined(__CUDA_ARCH__)
+#define MXNET_FLOAT_MATH_FUNC(name) vec::name
+#else
+#define MXNET_FLOAT_MATH_FUNC(name) ::name##f
+#endif
+
+#define MXNET_VECTORIZED_UNARY_MATH_FUNC(name)                                                \
+  MSHADOW_XINLINE                                                                             \
+  float name(float a) {                                                                       \
+    return MXNET_FLOAT_MATH_FUNC(name)(a);                                                    \
+  }                                                                                           \
+  MSHADOW_XINLINE                                                                             \
+  double name(double a) {                                                                     \
+    return ::name(a);                                                                         \
+  }                                                                                           \
+  template <typename DType>                                                                   \
+  MSHADOW_XINLINE typename std::enable_if<std::is_integral<DType>::value, double>::type name( \
+      DType a) {                                                                              \
+    return ::name(static_cast<double>(a));                                                    \
+  }
+
 #define MXNET_BINARY_MATH_FUNC(name)                                \
   template <typename DType>                                         \
   MSHADOW_XINLINE float name(DType a, DType b) {                    \
@@ -64,17 +87,17 @@ namespace math {
     return ::name(a, b);                                            \
   }
 
-MXNET_UNARY_MATH_FUNC(erf)
+MXNET_VECTORIZED_UNARY_MATH_FUNC(erf)
 
-MXNET_UNARY_MATH_FUNC(exp)
+MXNET_VECTORIZED_UNARY_MATH_FUNC(exp)
 
 MXNET_UNARY_MATH_FUNC(expm1)
 
-MXNET_UNARY_MATH_FUNC(tanh)
+MXNET_VECTORIZED_UNARY_MATH_FUNC(tanh)
 
 MXNET_UNARY_MATH_FUNC(log1p)
 
-MXNET_UNARY_MATH_FUNC(log)
+MXNET_VECTORIZED_UNARY_MATH_FUNC(log)
 
 MXNET_UNARY_MATH_FUNC(log10)
 
@@ -25,6 +25,7 @@
 #include "./operator_common.h"
 #include "./nn/im2col.h"
 #include "./contrib/nn/modulated_deformable_im2col.h"
+#include "./contrib/nn/deformable_implicit_gemm.h"
 #include "./linalg.h"
 
 namespace mxnet {
@@ -116,6 +117,28 @@ class ModulatedDeformableConvolutionOp : public Operator {
                in_data[dmconv::kMask].shape_,
                out_data[dmconv::kOut].shape_);
     Stream<xpu>* s = ctx.get_stream<xpu>();
+    if (DeformableConvImplicitGemm()) {
+      // sample the deformed columns inside the GEMM instead of materializing them
+      const DeformConvGeometry geom = GetDeformConvGeometry(
+          param_, in_data[dmconv::kData].shape_, out_data[dmconv::kOut].shape_);
+      const index_t workspace_size = DeformConvImplicitGemmWorkspace<xpu>(geom);
+      DType* workspace             = nullptr;
+      if (workspace_size > 0) {
+        workspace = ctx.requested[dmconv::kTempSpace]
+                        .get_space_typed<xpu, 1, DType>(Shape1(workspace_size), s)
+                        .dptr_;
+      }
+      DeformConvImplicitGemmForward(s,
+                                    geom,
+                                    in_data[dmconv::kData].dptr<DType>(),
+                                    in_data[dmconv::kOffset].dptr<DType>(),
+                                    in_data[dmconv::kMask].dptr<DType>(),
+                                    in_data[dmconv::kWeight].dptr<DType>(),
+                                    bias_term_ ? in_data[dmconv::kBias].dptr<DType>() : nullptr,
+                                    out_data[dmconv::kOut].dptr<DType>(),
+                                    workspace);
+      return;
+    }
     // allocate workspace for col_buffer
     Tensor<xpu, 1, DType> workspace =
         ctx.requested[dmconv::kTempSpace].get_space_typed<xpu, 1, DType>(
@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_tensor_apply-inl.h
+ * \brief Elementwise updates of lists of tensors in a few launches, shared by the multi
+ *  tensor optimizers
+ */
+#ifndef MXNET_OPERATOR_MULTI_TENSOR_APPLY_INL_H_
+#define MXNET_OPERATOR_MULTI_TENSOR_APPLY_INL_H_
+#include <mxnet/operator_util.h>
+#include <climits>
+#include <vector>
+#include "./mshadow_op.h"
+#include "./mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief arguments of a launch over up to N tensors, passed by value to the kernel. N keeps
+ *  the struct within the 4KB of the arguments of a cuda kernel.
+ *
+ * An OP updating the tensors defines
+ *  - kHasGrad, whether a gradient follows every weight in the inputs,
+ *  - kNumStates, the number of the MPDType states following the gradient,
+ *  - Hyper<MPDType>, its hyperparameters shared by all the tensors,
+ *  - MPDType Map(index, i, w, param), the new value of the i-th element w of the index-th
+ *    weight, which also updates the states.
+ */
+template <typename DType, typename MPDType, typename OP>
+struct MultiTensorParam {
+  using MPType                     = MPDType;
+  using Hyper                      = typename OP::template Hyper<MPDType>;
+  static constexpr int kNumStates  = OP::kNumStates > 0 ? OP::kNumStates : 1;
+  static constexpr int kPointers   = 4 + kNumStates;
+  static constexpr size_t kPerItem = 2 * sizeof(index_t) + kPointers * sizeof(void*) +
+                                     3 * sizeof(MPDType);
+  static constexpr int N =
+      (4096 - 2 * sizeof(MPDType) - sizeof(void*) - sizeof(Hyper) - 16) / kPerItem;
+  int count;
+  index_t sizes[N];
+  /*! \brief offsets of the tensors laid end to end, the elements of a launch on gpu */
+  index_t offsets[N];
+  DType* weights[N];
+  const DType* grads[N];
+  MPDType* states[kNumStates][N];
+  MPDType* weights32[N];
+  DType* out[N];
+  MPDType lrs[N];
+  MPDType wds[N];
+  MPDType etas[N];
+  MPDType rescale_grad;
+  MPDType clip_gradient;
+  /*!
+   * \brief scale of the gradients on the device, multiplied with rescale_grad, or nullptr.
+   *  The tensors are not updated when it is 0 or not finite.
+   */
+  const float* grad_scale;
+  Hyper hyper;
+};
+
+/*! \brief the rescaled and clipped gradient of the i-th element of the index-th weight */
+template <typename Param>
+MSHADOW_XINLINE typename Param::MPType MultiTensorGrad(const Param& param,
+                                                       const int index,
+                                                       const index_t i) {
+  using MPDType = typename Param::MPType;
+  MPDType grad  = param.rescale_grad * static_cast<MPDType>(param.grads[index][i]);
+  if (param.grad_scale)
+    grad *= static_cast<MPDType>(*param.grad_scale);
+  if (param.clip_gradient >= 0.0f)
+    grad = mshadow_op::clip::Map(grad, param.clip_gradient);
+  return grad;
+}
+
+template <typename OP, bool has_mixed_precision>
+struct MultiTensorKernel {
+  /*! \brief the i-th element of the tensors laid end to end, the launch of the gpu */
+  template <typename Param>
+  MSHADOW_XINLINE static void Map(index_t i, const Param& param, const OpReqType req) {
+    // the empty tensors are skipped, the offsets are increasing
+    int lo = 0;
+    int hi = param.count - 1;
+    while (lo < hi) {
+      const int mid = (lo + hi + 1) / 2;
+      if (param.offsets[mid] <= i) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    MapElement(lo, i - param.offsets[lo], param, req);
+  }
+
+  /*! \brief the i-th element of the index-th tensor, the chunks of the cpu */
+  template <typename Param>
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         const index_t i,
+                                         const Param& param,
+                                         const OpReqType req) {
+    using MPDType = typename Param::MPType;
+    if (param.grad_scale &&
+        (*param.grad_scale == 0.0f || !mshadow_op::isfinite::Map(*param.grad_scale))) {
+      // a skipped step, e.g. of an overflow of the gradients
+      KERNEL_ASSIGN(param.out[index][i], req, param.weights[index][i]);
+      return;
+    }
+    MPDType w     = has_mixed_precision ? param.weights32[index][i]
+                                        : static_cast<MPDType>(param.weights[index][i]);
+    w             = OP::Map(index, i, w, param);
+    if (has_mixed_precision)
+      param.weights32[index][i] = w;
+    KERNEL_ASSIGN(param.out[index][i], req, w);
+  }
+};
+
+template <typename KernelOP, typename Param>
+inline void MultiTensorLaunch(mshadow::Stream<cpu>* s,
+                              const Param& param,
+                              const index_t total,
+                              const OpReqType req) {
+  mxnet_op::Kernel<KernelOP, cpu>::LaunchMultiTensor(s, param.count, param.sizes, param, req);
+}
+
+#ifdef __CUDACC__
+template <typename KernelOP, typename Param>
+inline void MultiTensorLaunch(mshadow::Stream<gpu>* s,
+                              const Param& param,
+                              const index_t total,
+                              const OpReqType req) {
+  // one thread per element of all the tensors, instead of one per element of the largest
+  mxnet_op::Kernel<KernelOP, gpu>::Launch(s, static_cast<int>(total), param, req);
+}
+#endif  // __CUDACC__
+
+/*!
+ * \brief applies OP to the i-th outputs with the i-th weights, gradients and states of the
+ *  inputs, N tensors per launch.
+ * \param inputs weight, gradient (if OP::kHasGrad), OP::kNumStates states and the float32
+ *  master copy (if multi_precision) of every output
+ * \param lrs learning rates of the tensors, all 0 if empty
+ * \param wds weight decays of the tensors, all 0 if empty
+ * \param etas schedule multipliers of the tensors, all 1 if empty
+ * \param grad_scale float32 scale of the gradients on the device, e.g. the output of
+ *  clip_global_norm, so that it is not copied to the host. nullptr if none
+ */
+template <typename xpu, typename OP, typename DType, typename MPDType, bool multi_precision>
+void MultiTensorApply(const OpContext& ctx,
+                      const std::vector<TBlob>& inputs,
+                      const OpReqType req,
+                      const std::vector<TBlob>& outputs,
+                      const mxnet::Tuple<float>& lrs,
+                      const mxnet::Tuple<float>& wds,
+                      const mxnet::Tuple<float>& etas,
+                      const float rescale_grad,
+                      const float clip_gradient,
+                      const typename OP::template Hyper<MPDType>& hyper,
+                      const float* grad_scale = nullptr) {
+  using Param = MultiTensorParam<DType, MPDType, OP>;
+  static_assert(sizeof(Param) <= 4096, "the arguments of a cuda kernel are limited to 4KB");
+  constexpr int stride  = 1 + OP::kHasGrad + OP::kNumStates + multi_precision;
+  const int num_tensors = outputs.size();
+  CHECK_EQ(inputs.size(), static_cast<size_t>(num_tensors * stride));
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+
+  Param param;
+  param.count         = 0;
+  param.rescale_grad  = rescale_grad;
+  param.clip_gradient = clip_gradient;
+  param.grad_scale    = grad_scale;
+  param.hyper         = hyper;
+  index_t total       = 0;
+  for (int t = 0; t < num_tensors; ++t) {
+    const index_t size = outputs[t].Size();
+    if (size == 0)
+      continue;
+    if (param.count == Param::N || total + size > INT_MAX) {
+      MultiTensorLaunch<MultiTensorKernel<OP, multi_precision>>(s, param, total, req);
+      param.count = 0;
+      total       = 0;
+    }
+    const int k      = param.count++;
+    const int idx    = t * stride;
+    param.sizes[k]   = size;
+    param.offsets[k] = total;
+    param.weights[k] = inputs[idx].dptr<DType>();
+    param.grads[k]   = OP::kHasGrad ? inputs[idx + 1].dptr<DType>() : nullptr;
+    for (int j = 0; j < OP::kNumStates; ++j) {
+      const int state    = idx + 1 + OP::kHasGrad + j;
+      param.states[j][k] = inputs[state].dptr<MPDType>();
+    }
+    // the float32 master copy of the weight is the last input of the tensor
+    param.weights32[k] = multi_precision ? inputs[idx + stride - 1].dptr<MPDType>() : nullptr;
+    param.out[k]       = outputs[t].dptr<DType>();
+    param.lrs[k]       = lrs.ndim() ? lrs[t] : 0.0f;
+    param.wds[k]       = wds.ndim() ? wds[t] : 0.0f;
+    param.etas[k]      = etas.ndim() ? etas[t] : 1.0f;
+    total += size;
+  }
+  if (param.count > 0)
+    MultiTensorLaunch<MultiTensorKernel<OP, multi_precision>>(s, param, total, req);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_MULTI_TENSOR_APPLY_INL_H_
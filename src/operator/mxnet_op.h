@@ -31,6 +31,9 @@
 #include <mxnet/op_attr_types.h>
 #include <algorithm>
 #include <limits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 #include "./operator_tune.h"
 #include "../engine/openmp.h"
 
@@ -607,6 +610,31 @@ MSHADOW_XINLINE index_t unravel_dot(const index_t idx,
   return ret;
 }
 
+/*!
+ * \brief Combining unravel and the dot products with two strides, computed in IType, which holds
+ *  the size of shape
+ */
+template <int ndim, typename IType>
+MSHADOW_XINLINE void unravel_dot(const IType idx,
+                                 const Shape<ndim>& shape,
+                                 const Shape<ndim>& stride1,
+                                 const Shape<ndim>& stride2,
+                                 IType* idx1,
+                                 IType* idx2) {
+  *idx1 = 0;
+  *idx2 = 0;
+  IType j = idx;
+#pragma unroll
+  for (int i = ndim - 1; i >= 0; --i) {
+    const IType dim   = static_cast<IType>(shape[i]);
+    const IType tmp   = j / dim;
+    const IType coord = j - tmp * dim;
+    *idx1 += coord * static_cast<IType>(stride1[i]);
+    *idx2 += coord * static_cast<IType>(stride2[i]);
+    j = tmp;
+  }
+}
+
 /* Calculate stride of each dim from shape */
 template <int ndim>
 MSHADOW_XINLINE Shape<ndim> calc_stride(const Shape<ndim>& shape) {
@@ -923,6 +951,41 @@ struct Kernel<OP, cpu> {
     return true;
   }
 
+  /*!
+   * \brief Launch a CPU kernel over the elements of several tensors in one parallel region.
+   * The tensors are cut into chunks, which a dynamic schedule spreads over the threads, so that
+   * a thread streams through one tensor at a time and small tensors do not leave threads idle.
+   * \tparam Args Varargs type to eventually pass to the OP::MapElement() function
+   * \param count Number of tensors
+   * \param sizes Number of elements of each tensor
+   * \param args Varargs to eventually pass to OP::MapElement(index, i, args...), which computes
+   *        the i-th element of the index-th tensor
+   */
+  template <typename SType, typename... Args>
+  inline static bool LaunchMultiTensor(mshadow::Stream<cpu>*,
+                                       const int count,
+                                       const SType* sizes,
+                                       Args... args) {
+    constexpr index_t chunk_size = 1 << 14;
+    std::vector<std::pair<int, index_t>> chunks;
+    for (int index = 0; index < count; ++index) {
+      for (index_t begin = 0; begin < static_cast<index_t>(sizes[index]); begin += chunk_size)
+        chunks.emplace_back(index, begin);
+    }
+    const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) schedule(dynamic) if (chunks.size() > 1)
+    for (index_t c = 0; c < static_cast<index_t>(chunks.size()); ++c) {
+      const int index     = chunks[c].first;
+      const index_t begin = chunks[c].second;
+      const index_t end   = std::min(begin + chunk_size, static_cast<index_t>(sizes[index]));
+#pragma omp simd
+      for (index_t i = begin; i < end; ++i) {
+        OP::MapElement(index, i, args...);
+      }
+    }
+    return true;
+  }
+
   /*!
    * \brief Launch a generic CPU kernel with dynamic schedule. This is recommended
    * for irregular workloads such as spmv.
@@ -960,18 +1023,68 @@ struct Kernel<OP, cpu> {
    * operator_tune.cc
    * \tparam PRIMITIVE_OP The primitive operation to use for tuning
    * \tparam DType Data type
+   * \tparam elementwise Whether OP::Map(i, ...) only accesses the i-th elements, so that the
+   *         iterations are vectorized
    * \tparam Args Varargs type to eventually pass to the OP::Map() function
    * \param N Number of iterations
    * \param dest Destination pointer (used to infer DType)
    * \param args Varargs to eventually pass to the OP::Map() function
    */
-  template <typename PRIMITIVE_OP, typename DType, typename... Args>
+  template <typename PRIMITIVE_OP, typename DType, bool elementwise = false, typename... Args>
   static void LaunchTuned(mshadow::Stream<cpu>*, const size_t N, Args... args) {
 #ifdef _OPENMP
     const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-    if (omp_threads < 2 ||
-        !tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(omp_threads))) {
-      for (size_t i = 0; i < N; ++i) {
+    if (omp_threads < 2) {
+      LaunchLoop<elementwise>(1, N, args...);
+      return;
+    }
+    bool use_omp = tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(omp_threads));
+#ifdef MXNET_USE_OPERATOR_TUNING
+    if (AdaptiveOMPTuning::Enabled() && OperatorTuneByType<DType>::tuning_mode() == tune::kAuto) {
+      static AdaptiveOMPTuning::Table* table =
+          AdaptiveOMPTuning::Get(typeid(tuned_op<PRIMITIVE_OP, DType>).name());
+      const AdaptiveOMPTuning::Decision decision =
+          AdaptiveOMPTuning::Choose(table, N, omp_threads, use_omp);
+      if (decision.timed) {
+        const AdaptiveOMPTuning::Timer timer;
+        LaunchLoop<elementwise>(decision.omp ? omp_threads : 1, N, args...);
+        AdaptiveOMPTuning::Record(table, decision, N, omp_threads, timer.duration());
+        return;
+      }
+      use_omp = decision.omp;
+    }
+#endif  // MXNET_USE_OPERATOR_TUNING
+    LaunchLoop<elementwise>(use_omp ? omp_threads : 1, N, args...);
+#else
+    for (size_t i = 0; i < N; ++i) {
+      OP::Map(i, args...);
+    }
+#endif
+  }
+
+  /*!
+   * \brief The loop of LaunchTuned
+   * \tparam elementwise Whether the iterations are vectorized
+   * \param omp_threads Number of OMP threads, serial if less than 2
+   * \param N Number of iterations
+   * \param args Varargs to eventually pass to the OP::Map() function
+   */
+  template <bool elementwise, typename... Args>
+  static MSHADOW_CINLINE void LaunchLoop(const int omp_threads, const size_t N, Args... args) {
+    if (omp_threads < 2) {
+      if constexpr (elementwise) {
+#pragma omp simd
+        for (index_t i = 0; i < static_cast<index_t>(N); ++i) {
+          OP::Map(i, args...);
+        }
+      } else {
+        for (size_t i = 0; i < N; ++i) {
+          OP::Map(i, args...);
+        }
+      }
+    } else if constexpr (elementwise) {
+#pragma omp parallel for simd num_threads(omp_threads)
+      for (index_t i = 0; i < static_cast<index_t>(N); ++i) {
         OP::Map(i, args...);
       }
     } else {
@@ -980,11 +1093,6 @@ struct Kernel<OP, cpu> {
         OP::Map(i, args...);
       }
     }
-#else
-    for (size_t i = 0; i < N; ++i) {
-      OP::Map(i, args...);
-    }
-#endif
   }
 
   /*!
@@ -999,7 +1107,7 @@ struct Kernel<OP, cpu> {
 #ifdef _OPENMP
     const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
     if (omp_threads < 2) {
-      OP::Map(0, N, args...);
+      OP::Map(static_cast<index_t>(0), N, args...);
     } else {
       const auto length = (N + omp_threads - 1) / omp_threads;
 #pragma omp parallel for num_threads(omp_threads)
@@ -1008,7 +1116,7 @@ struct Kernel<OP, cpu> {
       }
     }
 #else
-    OP::Map(0, N, args...);
+    OP::Map(static_cast<index_t>(0), N, args...);
 #endif
   }
 
@@ -1030,7 +1138,8 @@ struct Kernel<OP, cpu> {
   }
 
   /*!
-   * \brief Launch a tunable OP wrapper with explicitly-supplied data type (ie op_with_req)
+   * \brief Launch a tunable OP wrapper with explicitly-supplied data type (ie op_with_req).
+   * The wrappers are elementwise, their iterations are vectorized
    * \tparam DType Data type
    * \tparam T Wrapper type
    * \tparam Args Varargs type to eventually pass to the OP::Map() function
@@ -1043,23 +1152,39 @@ struct Kernel<OP, cpu> {
   static MSHADOW_CINLINE
       typename std::enable_if<std::is_base_of<tunable, typename T::Operation>::value, bool>::type
       Launch(mshadow::Stream<cpu>* s, const size_t N, DType* dest, Args... args) {
-    LaunchTuned<typename T::Operation, DType>(s, N, dest, args...);
+    LaunchTuned<typename T::Operation, DType, true>(s, N, dest, args...);
     return true;
   }
 };
 
+/*!
+ * \brief whether the GPU kernels over N elements index them with int32_t. In the builds with
+ *  large tensor support, index_t is int64_t and is used only for the kernels over more elements.
+ *  The grid-stride loops step past N by less than 2^26 elements, 65535 blocks of at most 1024
+ *  threads, which must not overflow the index either.
+ */
+inline bool UseInt32Index(const size_t N) {
+  return N <= static_cast<size_t>(std::numeric_limits<int32_t>::max() - (1 << 26));
+}
+
 #ifdef __CUDACC__
-template <typename OP, typename... Args>
-__global__ void mxnet_generic_kernel(int N, Args... args) {
-  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
+/*!
+ * \brief The grid-stride loop of the GPU kernels, with indices of type IType. The Map functions
+ *  taking their index as a template argument compute with it.
+ */
+template <typename OP, typename IType, typename... Args>
+__global__ void mxnet_generic_kernel(IType N, Args... args) {
+  for (IType i = blockIdx.x * blockDim.x + threadIdx.x; i < N;
+       i += static_cast<IType>(blockDim.x) * gridDim.x) {
     OP::Map(i, args...);
   }
 }
 
-template <typename OP, typename... Args>
-__global__ void mxnet_generic_kernel_ex(int N, Args... args) {
-  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < N; i += blockDim.x * gridDim.x) {
-    OP::Map(i, 1, args...);
+template <typename OP, typename IType, typename... Args>
+__global__ void mxnet_generic_kernel_ex(IType N, Args... args) {
+  for (IType i = blockIdx.x * blockDim.x + threadIdx.x; i < N;
+       i += static_cast<IType>(blockDim.x) * gridDim.x) {
+    OP::Map(i, IType(1), args...);
   }
 }
 
@@ -1067,24 +1192,59 @@ template <typename OP>
 struct Kernel<OP, gpu> {
   /*! \brief Launch GPU kernel */
   template <typename... Args>
-  inline static void Launch(mshadow::Stream<gpu>* s, int N, Args... args) {
+  inline static void Launch(mshadow::Stream<gpu>* s, const size_t N, Args... args) {
     if (0 == N)
       return;
     using namespace mshadow::cuda;
-    int ngrid = std::min(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
-    mxnet_generic_kernel<OP, Args...>
-        <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
+    const int ngrid     = std::min(static_cast<size_t>(kMaxGridNum),
+                               (N + kBaseThreadNum - 1) / kBaseThreadNum);
+    cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+#if MSHADOW_INT64_TENSOR_SIZE == 1
+    if (!UseInt32Index(N)) {
+      mxnet_generic_kernel<OP, index_t, Args...>
+          <<<ngrid, kBaseThreadNum, 0, stream>>>(static_cast<index_t>(N), args...);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel);
+      return;
+    }
+#endif
+    mxnet_generic_kernel<OP, int32_t, Args...>
+        <<<ngrid, kBaseThreadNum, 0, stream>>>(static_cast<int32_t>(N), args...);
     MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel);
   }
 
+  /*!
+   * \brief Launch GPU kernel over the elements of several tensors, whose OP::Map(i, args...)
+   * computes the i-th element of all of them
+   */
+  template <typename SType, typename... Args>
+  inline static void LaunchMultiTensor(mshadow::Stream<gpu>* s,
+                                       const int count,
+                                       const SType* sizes,
+                                       Args... args) {
+    SType max_size = 0;
+    for (int index = 0; index < count; ++index)
+      max_size = std::max(max_size, sizes[index]);
+    Launch(s, static_cast<size_t>(max_size), args...);
+  }
+
   template <typename... Args>
-  inline static void LaunchEx(mshadow::Stream<gpu>* s, const int N, Args... args) {
+  inline static void LaunchEx(mshadow::Stream<gpu>* s, const size_t N, Args... args) {
     if (0 == N)
       return;
     using namespace mshadow::cuda;
-    int ngrid = std::min(kMaxGridNum, (N + kBaseThreadNum - 1) / kBaseThreadNum);
-    mxnet_generic_kernel_ex<OP, Args...>
-        <<<ngrid, kBaseThreadNum, 0, mshadow::Stream<gpu>::GetStream(s)>>>(N, args...);
+    const int ngrid     = std::min(static_cast<size_t>(kMaxGridNum),
+                               (N + kBaseThreadNum - 1) / kBaseThreadNum);
+    cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+#if MSHADOW_INT64_TENSOR_SIZE == 1
+    if (!UseInt32Index(N)) {
+      mxnet_generic_kernel_ex<OP, index_t, Args...>
+          <<<ngrid, kBaseThreadNum, 0, stream>>>(static_cast<index_t>(N), args...);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel_ex);
+      return;
+    }
+#endif
+    mxnet_generic_kernel_ex<OP, int32_t, Args...>
+        <<<ngrid, kBaseThreadNum, 0, stream>>>(static_cast<int32_t>(N), args...);
     MSHADOW_CUDA_POST_KERNEL_CHECK(mxnet_generic_kernel_ex);
   }
 };
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file add_dropout_layer_norm-inl.h
+ * \brief Layer normalization of the sum of a residual and a dropout, in one pass over the data
+ */
+#ifndef MXNET_OPERATOR_NN_ADD_DROPOUT_LAYER_NORM_INL_H_
+#define MXNET_OPERATOR_NN_ADD_DROPOUT_LAYER_NORM_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../operator_common.h"
+#include "../mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * out = LayerNorm(sum), sum = dropout(data) + residual, normalizing the last axis. The dropout
+ * mask holds 0 or 1 / (1 - p) like the mask of Dropout.
+ */
+namespace add_dropout_layernorm {
+enum AddDropoutLayerNormOpInputs { kData, kResidual, kGamma, kBeta };
+enum AddDropoutLayerNormOpOutputs { kOut, kSum, kMask, kMean, kStd };
+enum AddDropoutLayerNormOpOutputsBwd {
+  kBwdDataGrad,
+  kBwdResidualGrad,
+  kBwdGammaGrad,
+  kBwdBetaGrad
+};
+enum AddDropoutLayerNormOpMode { kTraining, kAlways };
+}  // namespace add_dropout_layernorm
+
+struct AddDropoutLayerNormParam : public dmlc::Parameter<AddDropoutLayerNormParam> {
+  float p;
+  int mode;
+  float eps;
+  bool output_sum;
+  DMLC_DECLARE_PARAMETER(AddDropoutLayerNormParam) {
+    DMLC_DECLARE_FIELD(p).set_default(0.5).set_range(0, 1).describe(
+        "Fraction of the data that gets dropped out during training time.");
+    DMLC_DECLARE_FIELD(mode)
+        .add_enum("training", add_dropout_layernorm::kTraining)
+        .add_enum("always", add_dropout_layernorm::kAlways)
+        .set_default(add_dropout_layernorm::kTraining)
+        .describe(
+            "Whether to only turn on dropout during training or to also turn on for inference.");
+    DMLC_DECLARE_FIELD(eps).set_default(1e-5f).describe(
+        "An `epsilon` parameter to prevent division by 0.");
+    DMLC_DECLARE_FIELD(output_sum)
+        .set_default(false)
+        .describe("Also output the normalized sum, dropout(data) + residual.");
+  }
+  void SetAttrDict(std::unordered_map<std::string, std::string>* dict) {
+    std::ostringstream p_s, eps_s, output_sum_s;
+    p_s << p;
+    eps_s << eps;
+    output_sum_s << output_sum;
+    (*dict)["p"]          = p_s.str();
+    (*dict)["mode"]       = mode == add_dropout_layernorm::kAlways ? "always" : "training";
+    (*dict)["eps"]        = eps_s.str();
+    (*dict)["output_sum"] = output_sum_s.str();
+  }
+};
+
+/*! \brief whether the dropout is applied, else the mask is not written and acts as ones */
+inline bool AddDropoutLayerNormIsDropping(const AddDropoutLayerNormParam& param,
+                                          const OpContext& ctx) {
+  return param.p > 0 && (ctx.is_train || param.mode == add_dropout_layernorm::kAlways);
+}
+
+/*! \brief the index of the first backward input after the output gradients */
+inline int AddDropoutLayerNormBwdSum(const AddDropoutLayerNormParam& param) {
+  return param.output_sum ? 2 : 1;
+}
+
+template <typename xpu>
+void AddDropoutLayerNormCompute(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs);
+
+/*!
+ * The inputs are the gradients of out and, with output_sum, of sum, followed by sum, mask, mean,
+ * std and gamma. The outputs are the gradients of data, residual, gamma and beta.
+ */
+template <typename xpu>
+void AddDropoutLayerNormGradCompute(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_ADD_DROPOUT_LAYER_NORM_INL_H_
@@ -0,0 +1,381 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file add_dropout_layer_norm.cc
+ * \brief Layer normalization of the sum of a residual and a dropout, in one pass over the data
+ */
+
+#include <mxnet/random_generator.h>
+#include <algorithm>
+#include <cmath>
+#include "./add_dropout_layer_norm-inl.h"
+#include "../elemwise_op_common.h"
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(AddDropoutLayerNormParam);
+
+static bool AddDropoutLayerNormShape(const nnvm::NodeAttrs& attrs,
+                                     mxnet::ShapeVector* in_shape,
+                                     mxnet::ShapeVector* out_shape) {
+  using namespace add_dropout_layernorm;
+  CHECK_EQ(in_shape->size(), 4U) << "Input:[data, residual, gamma, beta]";
+  CHECK_EQ(out_shape->size(), 5U);
+  // the addends must have the same shape, either may be given
+  if (!mxnet::ndim_is_known(in_shape->at(kData)))
+    SHAPE_ASSIGN_CHECK(*in_shape, kData, in_shape->at(kResidual));
+  SHAPE_ASSIGN_CHECK(*in_shape, kResidual, in_shape->at(kData));
+  SHAPE_ASSIGN_CHECK(*in_shape, kData, in_shape->at(kResidual));
+  const mxnet::TShape& dshape = in_shape->at(kData);
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  CHECK_GE(dshape.ndim(), 1) << "The data to normalize must have at least one axis";
+  const index_t nchannel = dshape[dshape.ndim() - 1];
+  SHAPE_ASSIGN_CHECK(*in_shape, kGamma, mxnet::TShape(mshadow::Shape1(nchannel)));
+  SHAPE_ASSIGN_CHECK(*in_shape, kBeta, mxnet::TShape(mshadow::Shape1(nchannel)));
+  mxnet::TShape moments_shape(dshape);
+  moments_shape[dshape.ndim() - 1] = 1;
+  SHAPE_ASSIGN_CHECK(*out_shape, kOut, dshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, kSum, dshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, kMask, dshape);
+  SHAPE_ASSIGN_CHECK(*out_shape, kMean, moments_shape);
+  SHAPE_ASSIGN_CHECK(*out_shape, kStd, moments_shape);
+  return shape_is_known(dshape);
+}
+
+/*! \brief merge the Welford partition (mean_b, m2_b, count_b) into (mean, m2, count) */
+template <typename AType>
+inline void WelfordMerge(const AType mean_b,
+                         const AType m2_b,
+                         const AType count_b,
+                         AType* mean,
+                         AType* m2,
+                         AType* count) {
+  if (count_b == AType(0))
+    return;
+  const AType total = *count + count_b;
+  const AType delta = mean_b - *mean;
+  *mean += delta * count_b / total;
+  *m2 += m2_b + delta * delta * *count * count_b / total;
+  *count = total;
+}
+
+/*!
+ * \brief sum = data * mask + residual and out = LayerNorm(sum) for the rows [begin, end) of
+ *  nchannel values, in one pass with the Welford algorithm. The sum is normalized as rounded to
+ *  DType, which the backward reads. Without mask the data is not dropped.
+ */
+template <typename DType, typename AType>
+void AddDropoutLayerNormRows(const index_t begin,
+                             const index_t end,
+                             const index_t nchannel,
+                             const AType eps,
+                             const DType* data,
+                             const DType* residual,
+                             const DType* mask,
+                             const DType* gamma,
+                             const DType* beta,
+                             DType* out,
+                             DType* sum,
+                             DType* mean_data,
+                             DType* std_data) {
+  // kLanes interleaved Welford accumulators of equal counts share the division of each step
+  constexpr int kLanes = 8;
+  for (index_t j = begin; j < end; ++j) {
+    const DType* x = data + j * nchannel;
+    const DType* r = residual + j * nchannel;
+    const DType* m = mask != nullptr ? mask + j * nchannel : nullptr;
+    DType* s       = sum + j * nchannel;
+    AType lane_mean[kLanes] = {0};
+    AType lane_m2[kLanes]   = {0};
+    AType lane_count        = 0;
+    index_t i               = 0;
+    for (; i + kLanes <= nchannel; i += kLanes) {
+      lane_count += 1;
+      const AType inv_count = AType(1) / lane_count;
+#pragma omp simd
+      for (int k = 0; k < kLanes; ++k) {
+        const AType v = m != nullptr ? static_cast<AType>(x[i + k]) * static_cast<AType>(m[i + k])
+                                     : static_cast<AType>(x[i + k]);
+        s[i + k]      = static_cast<DType>(v + static_cast<AType>(r[i + k]));
+        const AType a = static_cast<AType>(s[i + k]);
+        const AType d = a - lane_mean[k];
+        lane_mean[k] += d * inv_count;
+        lane_m2[k] += d * (a - lane_mean[k]);
+      }
+    }
+    AType mean = 0, m2 = 0, count = 0;
+    for (int k = 0; k < kLanes; ++k)
+      WelfordMerge(lane_mean[k], lane_m2[k], lane_count, &mean, &m2, &count);
+    for (; i < nchannel; ++i) {
+      const AType v = m != nullptr ? static_cast<AType>(x[i]) * static_cast<AType>(m[i])
+                                   : static_cast<AType>(x[i]);
+      s[i]          = static_cast<DType>(v + static_cast<AType>(r[i]));
+      const AType a = static_cast<AType>(s[i]);
+      count += 1;
+      const AType d = a - mean;
+      mean += d / count;
+      m2 += d * (a - mean);
+    }
+    const AType sigma     = std::sqrt(m2 / nchannel + eps);
+    const AType inv_sigma = AType(1) / sigma;
+    mean_data[j]          = static_cast<DType>(mean);
+    std_data[j]           = static_cast<DType>(sigma);
+    DType* o              = out + j * nchannel;
+#pragma omp simd
+    for (i = 0; i < nchannel; ++i) {
+      o[i] = static_cast<DType>((static_cast<AType>(s[i]) - mean) * inv_sigma *
+                                    static_cast<AType>(gamma[i]) +
+                                static_cast<AType>(beta[i]));
+    }
+  }
+}
+
+template <>
+void AddDropoutLayerNormCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  using namespace add_dropout_layernorm;
+  using common::random::RandGenerator;
+  const AddDropoutLayerNormParam& param = nnvm::get<AddDropoutLayerNormParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 4U);
+  CHECK_EQ(outputs.size(), 5U);
+  if (req[kOut] == kNullOp || inputs[kData].Size() == 0)
+    return;
+  CHECK_NE(req[kOut], kAddTo);
+  const TBlob& data      = inputs[kData];
+  const index_t nchannel = data.shape_[data.ndim() - 1];
+  const index_t nbatch   = data.shape_.ProdShape(0, data.ndim() - 1);
+  const bool dropping    = AddDropoutLayerNormIsDropping(param, ctx);
+  const float pkeep      = 1.0f - param.p;
+  const int nthreads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    typedef typename std::conditional<std::is_same<DType, mshadow::half::half_t>::value,
+                                      float,
+                                      DType>::type AType;
+    const DType* x        = data.dptr<DType>();
+    const DType* residual = inputs[kResidual].dptr<DType>();
+    const DType* gamma    = inputs[kGamma].dptr<DType>();
+    const DType* beta     = inputs[kBeta].dptr<DType>();
+    DType* out            = outputs[kOut].dptr<DType>();
+    DType* sum            = outputs[kSum].dptr<DType>();
+    DType* mask           = outputs[kMask].dptr<DType>();
+    DType* mean           = outputs[kMean].dptr<DType>();
+    DType* std            = outputs[kStd].dptr<DType>();
+    if (!dropping) {
+#pragma omp parallel for num_threads(nthreads)
+      for (index_t j = 0; j < nbatch; ++j) {
+        AddDropoutLayerNormRows<DType, AType>(
+            j, j + 1, nchannel, param.eps, x, residual, nullptr, gamma, beta, out, sum, mean, std);
+      }
+    } else {
+      // every chunk of rows draws its mask from its own random state, row by row, so that
+      // the mask of a row is still in the cache when the row is normalized
+      RandGenerator<cpu, float>* gen = ctx.requested[0].get_parallel_random<cpu, float>();
+      const index_t nchunk =
+          std::min(nbatch, static_cast<index_t>(RandGenerator<cpu, float>::kNumRandomStates));
+      const index_t step = (nbatch + nchunk - 1) / nchunk;
+#pragma omp parallel for num_threads(nthreads)
+      for (index_t c = 0; c < nchunk; ++c) {
+        RandGenerator<cpu, float>::Impl genImpl(gen, c);
+        for (index_t j = c * step; j < std::min(nbatch, (c + 1) * step); ++j) {
+          DType* m = mask + j * nchannel;
+          for (index_t i = 0; i < nchannel; ++i)
+            m[i] = genImpl.uniform() < pkeep ? DType(1.0f / pkeep) : DType(0);
+          AddDropoutLayerNormRows<DType, AType>(
+              j, j + 1, nchannel, param.eps, x, residual, mask, gamma, beta, out, sum, mean, std);
+        }
+      }
+    }
+  });
+}
+
+template <>
+void AddDropoutLayerNormGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                         const OpContext& ctx,
+                                         const std::vector<TBlob>& inputs,
+                                         const std::vector<OpReqType>& req,
+                                         const std::vector<TBlob>& outputs) {
+  using namespace add_dropout_layernorm;
+  using namespace mshadow;
+  const AddDropoutLayerNormParam& param = nnvm::get<AddDropoutLayerNormParam>(attrs.parsed);
+  const int in_sum = AddDropoutLayerNormBwdSum(param);
+  CHECK_EQ(inputs.size(), in_sum + 5U);
+  CHECK_EQ(outputs.size(), 4U);
+  const TBlob& sum = inputs[in_sum];
+  if (sum.Size() == 0)
+    return;
+  const index_t nchannel = sum.shape_[sum.ndim() - 1];
+  const index_t nbatch   = sum.shape_.ProdShape(0, sum.ndim() - 1);
+  const bool dropping    = AddDropoutLayerNormIsDropping(param, ctx);
+  const int nthreads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t nchunk   = std::min(nbatch, static_cast<index_t>(nthreads));
+  const index_t step     = (nbatch + nchunk - 1) / nchunk;
+  Stream<cpu>* s         = ctx.get_stream<cpu>();
+  MSHADOW_REAL_TYPE_SWITCH(sum.type_flag_, DType, {
+    typedef typename std::conditional<std::is_same<DType, mshadow::half::half_t>::value,
+                                      float,
+                                      DType>::type AType;
+    const DType* ograd     = inputs[0].dptr<DType>();
+    const DType* sum_ograd = param.output_sum ? inputs[1].dptr<DType>() : nullptr;
+    const DType* x         = sum.dptr<DType>();
+    const DType* mask      = dropping ? inputs[in_sum + 1].dptr<DType>() : nullptr;
+    const DType* mean      = inputs[in_sum + 2].dptr<DType>();
+    const DType* std       = inputs[in_sum + 3].dptr<DType>();
+    const DType* gamma     = inputs[in_sum + 4].dptr<DType>();
+    DType* data_grad       = outputs[kBwdDataGrad].dptr<DType>();
+    DType* residual_grad   = outputs[kBwdResidualGrad].dptr<DType>();
+    // the partial gradients of gamma and beta of every chunk of rows
+    Tensor<cpu, 1, AType> workspace =
+        ctx.requested[0].get_space_typed<cpu, 1, AType>(Shape1(2 * nchunk * nchannel), s);
+    std::fill(workspace.dptr_, workspace.dptr_ + workspace.size(0), AType(0));
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t c = 0; c < nchunk; ++c) {
+      AType* part_gamma = workspace.dptr_ + 2 * c * nchannel;
+      AType* part_beta  = part_gamma + nchannel;
+      for (index_t j = c * step; j < std::min(nbatch, (c + 1) * step); ++j) {
+        const index_t offset = j * nchannel;
+        const AType row_mean = static_cast<AType>(mean[j]);
+        const AType inv_std  = AType(1) / static_cast<AType>(std[j]);
+        AType sum_val0 = 0, sum_val1 = 0;
+        for (index_t i = 0; i < nchannel; ++i) {
+          const AType og   = static_cast<AType>(ograd[offset + i]);
+          const AType xhat = (static_cast<AType>(x[offset + i]) - row_mean) * inv_std;
+          const AType g    = og * static_cast<AType>(gamma[i]);
+          sum_val0 += g;
+          sum_val1 += g * xhat;
+          part_gamma[i] += og * xhat;
+          part_beta[i] += og;
+        }
+        sum_val0 /= nchannel;
+        sum_val1 /= nchannel;
+        for (index_t i = 0; i < nchannel; ++i) {
+          const AType og   = static_cast<AType>(ograd[offset + i]);
+          const AType xhat = (static_cast<AType>(x[offset + i]) - row_mean) * inv_std;
+          AType dsum = (og * static_cast<AType>(gamma[i]) - sum_val0 - xhat * sum_val1) * inv_std;
+          if (sum_ograd != nullptr)
+            dsum += static_cast<AType>(sum_ograd[offset + i]);
+          KERNEL_ASSIGN(residual_grad[offset + i], req[kBwdResidualGrad], static_cast<DType>(dsum));
+          if (mask != nullptr)
+            dsum *= static_cast<AType>(mask[offset + i]);
+          KERNEL_ASSIGN(data_grad[offset + i], req[kBwdDataGrad], static_cast<DType>(dsum));
+        }
+      }
+    }
+    DType* gamma_grad = outputs[kBwdGammaGrad].dptr<DType>();
+    DType* beta_grad  = outputs[kBwdBetaGrad].dptr<DType>();
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t i = 0; i < nchannel; ++i) {
+      AType dgamma = 0, dbeta = 0;
+      for (index_t c = 0; c < nchunk; ++c) {
+        dgamma += workspace.dptr_[2 * c * nchannel + i];
+        dbeta += workspace.dptr_[(2 * c + 1) * nchannel + i];
+      }
+      KERNEL_ASSIGN(gamma_grad[i], req[kBwdGammaGrad], static_cast<DType>(dgamma));
+      KERNEL_ASSIGN(beta_grad[i], req[kBwdBetaGrad], static_cast<DType>(dbeta));
+    }
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_add_dropout_layer_norm)
+    .add_alias("_npx_add_dropout_layer_norm")
+    .describe(R"code(Layer normalization of the sum of a residual and a dropout.
+
+Computes, in one pass over the data and normalizing the last axis,
+
+.. math::
+
+  sum = dropout(data, p) + residual
+
+  out = \frac{sum - mean(sum, -1)}{\sqrt{var(sum, -1) + \epsilon}} * gamma + beta
+
+as the residual connection, dropout and layer normalization of a transformer block would, with
+the mean and the variance computed by the Welford algorithm. The dropout is applied like
+``Dropout``, in training or always depending on ``mode``. ``data`` and ``residual`` must have the
+same shape. If ``output_sum`` is true, ``sum`` is also returned.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(5)
+    .set_attr_parser(ParamParser<AddDropoutLayerNormParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"data", "residual", "gamma", "beta"};
+        })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"output", "sum", "mask", "mean", "std"};
+        })
+    .set_attr<nnvm::FNumVisibleOutputs>(
+        "FNumVisibleOutputs",
+        [](const NodeAttrs& attrs) {
+          return nnvm::get<AddDropoutLayerNormParam>(attrs.parsed).output_sum ? 2 : 1;
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", AddDropoutLayerNormShape)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<4, 5>)
+    .set_attr<FCompute>("FCompute<cpu>", AddDropoutLayerNormCompute<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          using namespace add_dropout_layernorm;
+          const auto& param = nnvm::get<AddDropoutLayerNormParam>(n->attrs.parsed);
+          std::vector<nnvm::NodeEntry> heads;
+          heads.push_back(ograds[kOut]);
+          if (param.output_sum)
+            heads.push_back(ograds[kSum]);
+          heads.emplace_back(n, kSum, 0);
+          heads.emplace_back(n, kMask, 0);
+          heads.emplace_back(n, kMean, 0);
+          heads.emplace_back(n, kStd, 0);
+          heads.push_back(n->inputs[kGamma]);
+          return MakeGradNode("_backward_contrib_add_dropout_layer_norm", n, heads, n->attrs.dict);
+        })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{
+                                      ResourceRequest::kParallelRandom};
+                                })
+    .add_argument("data", "NDArray-or-Symbol", "Input data to the dropout")
+    .add_argument("residual", "NDArray-or-Symbol", "Residual added to the dropout of data")
+    .add_argument("gamma", "NDArray-or-Symbol", "gamma array")
+    .add_argument("beta", "NDArray-or-Symbol", "beta array")
+    .add_arguments(AddDropoutLayerNormParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_add_dropout_layer_norm)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& param = nnvm::get<AddDropoutLayerNormParam>(attrs.parsed);
+      return AddDropoutLayerNormBwdSum(param) + 5;
+    })
+    .set_num_outputs(4)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr_parser(ParamParser<AddDropoutLayerNormParam>)
+    .set_attr<FCompute>("FCompute<cpu>", AddDropoutLayerNormGradCompute<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
+      return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+    });
+
+}  // namespace op
+}  // namespace mxnet
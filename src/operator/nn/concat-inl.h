@@ -91,6 +91,26 @@ class ConcatOp {
     size_t mid      = out_data[concat_enum::kOut].shape_[axis];
     Shape<3> oshape = Shape3(leading, mid, trailing);
     out             = out_data[concat_enum::kOut].get_with_shape<xpu, 3, DType>(oshape, s);
+    if (leading == 1 &&
+        (req[concat_enum::kOut] == kWriteTo || req[concat_enum::kOut] == kWriteInplace)) {
+      // copy only the inputs the memory planner did not place in the output, see FViewInputs
+      std::vector<size_t> offsets(size_ + 1, 0);
+      bool views = false;
+      for (int i = 0; i < size_; ++i) {
+        offsets[i + 1] = offsets[i] + in_data[i].Size();
+        views = views || IsViewOutput(out_data[concat_enum::kOut], in_data[i], offsets[i]);
+      }
+      if (views) {
+        for (int i = 0; i < size_; ++i) {
+          if (in_data[i].Size() == 0 ||
+              IsViewOutput(out_data[concat_enum::kOut], in_data[i], offsets[i]))
+            continue;
+          Tensor<xpu, 1, DType> dst(out.dptr_ + offsets[i], Shape1(in_data[i].Size()), s);
+          Copy(dst, in_data[i].get_with_shape<xpu, 1, DType>(Shape1(in_data[i].Size()), s), s);
+        }
+        return;
+      }
+    }
 
     for (int i = 0; i < size_; ++i) {
       Shape<3> dshape = Shape3(leading, in_data[i].shape_[axis], trailing);
@@ -133,6 +153,31 @@ class ConcatOp {
   int dimension_;
 };  // class ConcatOp
 
+/*!
+ * \brief the offsets in the output of the inputs of a concat along axis, which are contiguous
+ *  when the axes before axis have one element, see FViewInputs
+ */
+inline std::vector<std::pair<int, size_t>> ConcatInputOffsets(const mxnet::ShapeVector& ishapes,
+                                                              int axis) {
+  if (ishapes.empty() || ishapes[0].ProdShape(0, axis) != 1)
+    return {};
+  std::vector<std::pair<int, size_t>> views;
+  size_t offset = 0;
+  for (size_t i = 0; i < ishapes.size(); ++i) {
+    views.emplace_back(i, offset);
+    offset += ishapes[i].Size();
+  }
+  return views;
+}
+
+inline std::vector<std::pair<int, size_t>> ConcatViewInputs(const nnvm::NodeAttrs& attrs,
+                                                            const mxnet::ShapeVector& ishapes) {
+  const ConcatParam& param = nnvm::get<ConcatParam>(attrs.parsed);
+  if (ishapes.empty() || ishapes[0].ndim() <= 0)
+    return {};
+  return ConcatInputOffsets(ishapes, CheckAxis(param.dim, ishapes[0].ndim()));
+}
+
 template <typename xpu>
 void ConcatCompute(const nnvm::NodeAttrs& attrs,
                    const OpContext& ctx,
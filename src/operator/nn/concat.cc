@@ -341,6 +341,7 @@ DMLC_REGISTER_PARAMETER(ConcatParam);
       .set_attr<FInferStorageType>("FInferStorageType", ConcatForwardInferStorageType)            \
       .set_attr<FCompute>("FCompute<cpu>", ConcatCompute<cpu>)                                    \
       .set_attr<FComputeEx>("FComputeEx<cpu>", ConcatComputeExCPU)                                \
+      .set_attr<FViewInputs>("FViewInputs", ConcatViewInputs)                                     \
       .set_attr<nnvm::FGradient>("FGradient", ConcatGrad{"_backward_Concat"})                     \
       .set_attr<std::string>("key_var_num_args", "num_args")
 
@@ -42,6 +42,8 @@
 #include "../operator_common.h"
 #include "../linalg.h"
 #include "./im2col.h"
+#include "./convolution_channels_last.h"
+#include "./winograd_convolution.h"
 
 namespace mxnet {
 namespace op {
@@ -106,7 +108,8 @@ struct ConvolutionParam : public dmlc::Parameter<ConvolutionParam> {
         .describe(
             "Set layout for input, output and weight. Empty for\n    "
             "default layout: NCW for 1d, NCHW for 2d and NCDHW for 3d."
-            "NHWC and NDHWC are only supported on GPU.");
+            " NHWC and NDHWC use direct channels-last kernels when oneDNN and cuDNN "
+            "do not apply.");
   }
   // Adjusts kernel size for effects of dilation in the dimension `dim`.
   index_t DilatedKernelSize(int dim) const {
@@ -229,11 +232,17 @@ class ConvolutionOp {
     param_.workspace = (param_.workspace << 20) / sizeof(DType);
     if (param_.layout.has_value()) {
       CHECK(param_.layout.value() == mshadow::kNCW || param_.layout.value() == mshadow::kNCHW ||
-            param_.layout.value() == mshadow::kNCDHW)
-          << "Only support NCW, NCHW and NCDHW layout";
+            param_.layout.value() == mshadow::kNCDHW || ChannelsLast())
+          << "Only support NCW, NCHW, NCDHW, NHWC and NDHWC layout";
     }
   }
 
+  /*! \brief whether the data is NHWC or NDHWC, which the direct channels-last kernels run */
+  bool ChannelsLast() const {
+    return param_.layout.has_value() &&
+           (param_.layout.value() == mshadow::kNHWC || param_.layout.value() == mshadow::kNDHWC);
+  }
+
   void Forward(const OpContext& ctx,
                const std::vector<TBlob>& in_data,
                const std::vector<OpReqType>& req,
@@ -244,6 +253,37 @@ class ConvolutionOp {
     CHECK_EQ(in_data.size(), expected);
     CHECK_EQ(out_data.size(), 1U);
     // CHECK_EQ(req[conv::kOut], kWriteTo);
+    if (ChannelsLast()) {
+      Stream<xpu>* s          = ctx.get_stream<xpu>();
+      const ConvNxCGeometry g = GetConvNxCGeometry(
+          param_, in_data[conv::kData].shape_, out_data[conv::kOut].shape_);
+      ConvNxCForward(s,
+                     g,
+                     in_data[conv::kData].dptr<DType>(),
+                     in_data[conv::kWeight].dptr<DType>(),
+                     param_.no_bias ? nullptr : in_data[conv::kBias].dptr<DType>(),
+                     req[conv::kOut],
+                     out_data[conv::kOut].dptr<DType>());
+      return;
+    }
+    if (WinogradConvApplies<xpu, DType>(param_)) {
+      Stream<xpu>* s               = ctx.get_stream<xpu>();
+      const WinogradConvGeometry g = GetWinogradConvGeometry(
+          param_, in_data[conv::kData].shape_, out_data[conv::kOut].shape_);
+
+      Tensor<xpu, 1, DType> workspace =
+          ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(
+              Shape1(WinogradConvWorkspace(g)), s);
+      WinogradConvForward(s,
+                          g,
+                          in_data[conv::kData].dptr<DType>(),
+                          in_data[conv::kWeight].dptr<DType>(),
+                          param_.no_bias ? nullptr : in_data[conv::kBias].dptr<DType>(),
+                          req[conv::kOut],
+                          out_data[conv::kOut].dptr<DType>(),
+                          workspace.dptr_);
+      return;
+    }
     _Forward(ctx,
              in_data[conv::kData],
              in_data[conv::kWeight],
@@ -267,6 +307,10 @@ class ConvolutionOp {
     CHECK_EQ(in_grad.size(), expected);
     CHECK_EQ(req.size(), expected);
     CHECK_EQ(in_data[conv::kWeight].CheckContiguous(), true);
+    if (ChannelsLast()) {
+      _BackwardChannelsLast(ctx, out_grad[conv::kOut], in_data, req, in_grad);
+      return;
+    }
 
     auto workspace = _BackwardData(
         ctx, out_grad[conv::kOut], in_data[conv::kWeight], req[conv::kData], in_grad[conv::kData]);
@@ -281,6 +325,38 @@ class ConvolutionOp {
   }
 
  private:
+  // Computes the gradients of a convolution in NHWC or NDHWC layout
+  void _BackwardChannelsLast(const OpContext& ctx,
+                             const TBlob& out_grad,
+                             const std::vector<TBlob>& in_data,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& in_grad) {
+    using namespace mshadow;
+    using namespace mshadow::expr;
+    Stream<xpu>* s          = ctx.get_stream<xpu>();
+    const ConvNxCGeometry g =
+        GetConvNxCGeometry(param_, in_data[conv::kData].shape_, out_grad.shape_);
+    ConvNxCBackwardData(s,
+                        g,
+                        out_grad.dptr<DType>(),
+                        in_data[conv::kWeight].dptr<DType>(),
+                        req[conv::kData],
+                        in_grad[conv::kData].dptr<DType>());
+    ConvNxCBackwardWeight(s,
+                          g,
+                          out_grad.dptr<DType>(),
+                          in_data[conv::kData].dptr<DType>(),
+                          req[conv::kWeight],
+                          in_grad[conv::kWeight].dptr<DType>());
+    if (!param_.no_bias) {
+      // the filters are the innermost axis of the gradient of the output
+      Tensor<xpu, 1, DType> dbias = in_grad[conv::kBias].get<xpu, 1, DType>(s);
+      Tensor<xpu, 2, DType> dout  = out_grad.get_with_shape<xpu, 2, DType>(
+          Shape2(out_grad.shape_.Size() / param_.num_filter, param_.num_filter), s);
+      ASSIGN_DISPATCH(dbias, req[conv::kBias], sumall_except_dim<1>(dout));
+    }
+  }
+
   Tensor<xpu, 1, DType> _Forward(const OpContext& ctx,
                                  const TBlob& in_data,
                                  const TBlob& in_weights,
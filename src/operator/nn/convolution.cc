@@ -308,6 +308,15 @@ static bool ConvolutionType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+// a multiply-add per output and element of a filter
+static uint64_t ConvolutionFlops(const nnvm::NodeAttrs& attrs,
+                                 const mxnet::ShapeVector& in_shapes,
+                                 const mxnet::ShapeVector& out_shapes) {
+  const ConvolutionParam& param_ = nnvm::get<ConvolutionParam>(attrs.parsed);
+  const uint64_t filter_size     = in_shapes[conv::kWeight].Size() / param_.num_filter;
+  return 2 * out_shapes[conv::kOut].Size() * filter_size;
+}
+
 #if MXNET_USE_ONEDNN == 1
 inline static bool ConvStorageType(const nnvm::NodeAttrs& attrs,
                                    const int dev_mask,
@@ -502,6 +511,7 @@ There are other options to tune the performance.
                                       })
     .set_attr<mxnet::FInferShape>("FInferShape", ConvolutionShape)
     .set_attr<nnvm::FInferType>("FInferType", ConvolutionType)
+    .set_attr<FComputeCost>("FComputeCost", ConvolutionFlops)
 #if MXNET_USE_ONEDNN == 1
     .set_attr<FInferStorageType>("FInferStorageType", ConvStorageType)
 #endif
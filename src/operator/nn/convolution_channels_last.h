@@ -0,0 +1,323 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file convolution_channels_last.h
+ * \brief Direct convolution of NHWC and NDHWC data, used when neither oneDNN nor cuDNN
+ *  applies. The reduction over the channels is contiguous in both the data and the
+ *  weights, so no im2col buffer and no layout transposition are needed.
+ */
+#ifndef MXNET_OPERATOR_NN_CONVOLUTION_CHANNELS_LAST_H_
+#define MXNET_OPERATOR_NN_CONVOLUTION_CHANNELS_LAST_H_
+
+#include <mxnet/base.h>
+#include <mxnet/operator.h>
+#include "../mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief output channels (or input channels in backward) accumulated in registers */
+constexpr int kConvNxCBlock = 4;
+
+/*!
+ * \brief geometry of a convolution in channels-last layout. A 2-D convolution has a depth
+ *  of 1, the weights are (num_filter, kernel_d, kernel_h, kernel_w, channels / group).
+ */
+struct ConvNxCGeometry {
+  index_t num;
+  index_t channels;
+  index_t num_filter;
+  index_t group;
+  index_t in[3];
+  index_t out[3];
+  index_t kernel[3];
+  index_t pad[3];
+  index_t stride[3];
+  index_t dilate[3];
+
+  MSHADOW_XINLINE index_t InPixels() const {
+    return in[0] * in[1] * in[2];
+  }
+  MSHADOW_XINLINE index_t OutPixels() const {
+    return out[0] * out[1] * out[2];
+  }
+  MSHADOW_XINLINE index_t Taps() const {
+    return kernel[0] * kernel[1] * kernel[2];
+  }
+  /*! \brief input channels per group */
+  MSHADOW_XINLINE index_t Cg() const {
+    return channels / group;
+  }
+  /*! \brief filters per group */
+  MSHADOW_XINLINE index_t Fg() const {
+    return num_filter / group;
+  }
+  /*! \brief input pixel read by output pixel p at kernel tap t, or -1 in the padding */
+  MSHADOW_XINLINE index_t InPixel(index_t p, index_t t) const {
+    index_t pixel = 0, rem_p = p, rem_t = t, scale = 1;
+    for (int i = 2; i >= 0; --i) {
+      const index_t x = (rem_p % out[i]) * stride[i] - pad[i] + (rem_t % kernel[i]) * dilate[i];
+      if (x < 0 || x >= in[i])
+        return -1;
+      pixel += x * scale;
+      scale *= in[i];
+      rem_p /= out[i];
+      rem_t /= kernel[i];
+    }
+    return pixel;
+  }
+  /*! \brief output pixel that reads input pixel q at kernel tap t, or -1 if there is none */
+  MSHADOW_XINLINE index_t OutPixel(index_t q, index_t t) const {
+    index_t pixel = 0, rem_q = q, rem_t = t, scale = 1;
+    for (int i = 2; i >= 0; --i) {
+      const index_t x = (rem_q % in[i]) + pad[i] - (rem_t % kernel[i]) * dilate[i];
+      if (x < 0 || x % stride[i] != 0 || x / stride[i] >= out[i])
+        return -1;
+      pixel += x / stride[i] * scale;
+      scale *= out[i];
+      rem_q /= in[i];
+      rem_t /= kernel[i];
+    }
+    return pixel;
+  }
+};
+
+template <typename Param>
+inline ConvNxCGeometry GetConvNxCGeometry(const Param& param,
+                                          const mxnet::TShape& dshape,
+                                          const mxnet::TShape& oshape) {
+  const int ndim = param.kernel.ndim();
+  CHECK(ndim == 2 || ndim == 3) << "Channels-last convolution supports 2-D and 3-D kernels";
+  ConvNxCGeometry g;
+  g.num        = dshape[0];
+  g.channels   = dshape[ndim + 1];
+  g.num_filter = param.num_filter;
+  g.group      = param.num_group;
+  for (int i = 0; i < 3; ++i) {
+    // missing leading spatial axes have extent 1
+    const int d = i - (3 - ndim);
+    g.in[i]     = d < 0 ? 1 : dshape[d + 1];
+    g.out[i]    = d < 0 ? 1 : oshape[d + 1];
+    g.kernel[i] = d < 0 ? 1 : param.kernel[d];
+    g.pad[i]    = d < 0 ? 0 : param.pad[d];
+    g.stride[i] = d < 0 ? 1 : param.stride[d];
+    g.dilate[i] = d < 0 ? 1 : param.dilate[d];
+  }
+  return g;
+}
+
+/*!
+ * \brief One work item computes kConvNxCBlock filters of a group at one output pixel, so
+ *  each input value loaded is used for kConvNxCBlock multiply-adds.
+ */
+template <int req>
+struct ConvNxCForwardKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const ConvNxCGeometry g,
+                                  const DType* data,
+                                  const DType* weight,
+                                  const DType* bias,
+                                  DType* out) {
+    typedef typename mxnet_op::AccType<DType>::type AType;
+    const index_t Cg      = g.Cg();
+    const index_t Fg      = g.Fg();
+    const index_t taps    = g.Taps();
+    const index_t fblocks = (Fg + kConvNxCBlock - 1) / kConvNxCBlock;
+    const index_t f0      = (i % fblocks) * kConvNxCBlock;
+    const index_t grp     = (i / fblocks) % g.group;
+    const index_t pixel   = i / (fblocks * g.group);
+    const index_t n       = pixel / g.OutPixels();
+    const index_t p       = pixel % g.OutPixels();
+    const int rows        = static_cast<int>(Fg - f0 < kConvNxCBlock ? Fg - f0 : kConvNxCBlock);
+    const DType* data_n   = data + n * g.InPixels() * g.channels + grp * Cg;
+    const DType* w[kConvNxCBlock];
+    AType acc[kConvNxCBlock];
+    for (int r = 0; r < kConvNxCBlock; ++r) {
+      // padded rows repeat the last filter and are not written
+      w[r]   = weight + (grp * Fg + f0 + (r < rows ? r : rows - 1)) * taps * Cg;
+      acc[r] = 0;
+    }
+    for (index_t t = 0; t < taps; ++t) {
+      const index_t q = g.InPixel(p, t);
+      if (q < 0)
+        continue;
+      const DType* x = data_n + q * g.channels;
+      for (index_t c = 0; c < Cg; ++c) {
+        const AType v = static_cast<AType>(x[c]);
+        for (int r = 0; r < kConvNxCBlock; ++r)
+          acc[r] += v * static_cast<AType>(w[r][t * Cg + c]);
+      }
+    }
+    DType* y = out + pixel * g.num_filter + grp * Fg + f0;
+    for (int r = 0; r < rows; ++r) {
+      const AType b = bias == nullptr ? AType(0) : static_cast<AType>(bias[grp * Fg + f0 + r]);
+      KERNEL_ASSIGN(y[r], req, static_cast<DType>(acc[r] + b));
+    }
+  }
+};
+
+/*!
+ * \brief One work item computes the gradient of kConvNxCBlock channels of a group at one
+ *  input pixel, gathering over the output pixels that read it, so no atomics are needed.
+ */
+template <int req>
+struct ConvNxCBackwardDataKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const ConvNxCGeometry g,
+                                  const DType* out_grad,
+                                  const DType* weight,
+                                  DType* in_grad) {
+    typedef typename mxnet_op::AccType<DType>::type AType;
+    const index_t Cg        = g.Cg();
+    const index_t Fg        = g.Fg();
+    const index_t taps      = g.Taps();
+    const index_t cblocks   = (Cg + kConvNxCBlock - 1) / kConvNxCBlock;
+    const index_t c0        = (i % cblocks) * kConvNxCBlock;
+    const index_t grp       = (i / cblocks) % g.group;
+    const index_t pixel     = i / (cblocks * g.group);
+    const index_t n         = pixel / g.InPixels();
+    const index_t q         = pixel % g.InPixels();
+    const int cols          = static_cast<int>(Cg - c0 < kConvNxCBlock ? Cg - c0 : kConvNxCBlock);
+    const DType* out_grad_n = out_grad + n * g.OutPixels() * g.num_filter + grp * Fg;
+    AType acc[kConvNxCBlock];
+    for (int c = 0; c < kConvNxCBlock; ++c)
+      acc[c] = 0;
+    for (index_t t = 0; t < taps; ++t) {
+      const index_t p = g.OutPixel(q, t);
+      if (p < 0)
+        continue;
+      const DType* dy = out_grad_n + p * g.num_filter;
+      for (index_t f = 0; f < Fg; ++f) {
+        const AType v  = static_cast<AType>(dy[f]);
+        const DType* w = weight + ((grp * Fg + f) * taps + t) * Cg + c0;
+        for (int c = 0; c < cols; ++c)
+          acc[c] += v * static_cast<AType>(w[c]);
+      }
+    }
+    DType* dx = in_grad + pixel * g.channels + grp * Cg + c0;
+    for (int c = 0; c < cols; ++c)
+      KERNEL_ASSIGN(dx[c], req, static_cast<DType>(acc[c]));
+  }
+};
+
+/*!
+ * \brief One work item computes the gradient of kConvNxCBlock channels of one filter at
+ *  one kernel tap, reducing over the batch and the output pixels.
+ */
+template <int req>
+struct ConvNxCBackwardWeightKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const ConvNxCGeometry g,
+                                  const DType* out_grad,
+                                  const DType* data,
+                                  DType* weight_grad) {
+    typedef typename mxnet_op::AccType<DType>::type AType;
+    const index_t Cg      = g.Cg();
+    const index_t taps    = g.Taps();
+    const index_t cblocks = (Cg + kConvNxCBlock - 1) / kConvNxCBlock;
+    const index_t c0      = (i % cblocks) * kConvNxCBlock;
+    const index_t t       = (i / cblocks) % taps;
+    const index_t f       = i / (cblocks * taps);
+    const index_t grp     = f / g.Fg();
+    const int cols        = static_cast<int>(Cg - c0 < kConvNxCBlock ? Cg - c0 : kConvNxCBlock);
+    const index_t P       = g.OutPixels();
+    AType acc[kConvNxCBlock];
+    for (int c = 0; c < kConvNxCBlock; ++c)
+      acc[c] = 0;
+    for (index_t n = 0; n < g.num; ++n) {
+      const DType* data_n = data + n * g.InPixels() * g.channels + grp * Cg + c0;
+      const DType* dy     = out_grad + n * P * g.num_filter + f;
+      for (index_t p = 0; p < P; ++p) {
+        const index_t q = g.InPixel(p, t);
+        if (q < 0)
+          continue;
+        const AType v  = static_cast<AType>(dy[p * g.num_filter]);
+        const DType* x = data_n + q * g.channels;
+        for (int c = 0; c < cols; ++c)
+          acc[c] += v * static_cast<AType>(x[c]);
+      }
+    }
+    DType* dw = weight_grad + (f * taps + t) * Cg + c0;
+    for (int c = 0; c < cols; ++c)
+      KERNEL_ASSIGN(dw[c], req, static_cast<DType>(acc[c]));
+  }
+};
+
+/*! \brief out = conv(data, weight) + bias in channels-last layout, bias may be nullptr */
+template <typename xpu, typename DType>
+inline void ConvNxCForward(mshadow::Stream<xpu>* s,
+                           const ConvNxCGeometry& g,
+                           const DType* data,
+                           const DType* weight,
+                           const DType* bias,
+                           OpReqType req,
+                           DType* out) {
+  using namespace mxnet_op;
+  if (req == kNullOp)
+    return;
+  const index_t fblocks = (g.Fg() + kConvNxCBlock - 1) / kConvNxCBlock;
+  MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+    Kernel<ConvNxCForwardKernel<Req>, xpu>::Launch(
+        s, g.num * g.OutPixels() * g.group * fblocks, g, data, weight, bias, out);
+  });
+}
+
+/*! \brief gradient of the data of a channels-last convolution */
+template <typename xpu, typename DType>
+inline void ConvNxCBackwardData(mshadow::Stream<xpu>* s,
+                                const ConvNxCGeometry& g,
+                                const DType* out_grad,
+                                const DType* weight,
+                                OpReqType req,
+                                DType* in_grad) {
+  using namespace mxnet_op;
+  if (req == kNullOp)
+    return;
+  const index_t cblocks = (g.Cg() + kConvNxCBlock - 1) / kConvNxCBlock;
+  MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+    Kernel<ConvNxCBackwardDataKernel<Req>, xpu>::Launch(
+        s, g.num * g.InPixels() * g.group * cblocks, g, out_grad, weight, in_grad);
+  });
+}
+
+/*! \brief gradient of the weights of a channels-last convolution */
+template <typename xpu, typename DType>
+inline void ConvNxCBackwardWeight(mshadow::Stream<xpu>* s,
+                                  const ConvNxCGeometry& g,
+                                  const DType* out_grad,
+                                  const DType* data,
+                                  OpReqType req,
+                                  DType* weight_grad) {
+  using namespace mxnet_op;
+  if (req == kNullOp)
+    return;
+  const index_t cblocks = (g.Cg() + kConvNxCBlock - 1) / kConvNxCBlock;
+  MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+    Kernel<ConvNxCBackwardWeightKernel<Req>, xpu>::Launch(
+        s, g.num_filter * g.Taps() * cblocks, g, out_grad, data, weight_grad);
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_NN_CONVOLUTION_CHANNELS_LAST_H_
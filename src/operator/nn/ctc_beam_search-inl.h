@@ -0,0 +1,421 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ctc_beam_search-inl.h
+ * \brief CTC prefix beam search decoder
+ */
+
+#ifndef MXNET_OPERATOR_NN_CTC_BEAM_SEARCH_INL_H_
+#define MXNET_OPERATOR_NN_CTC_BEAM_SEARCH_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <string>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../elemwise_op_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace ctc_beam_search {
+enum CTCBeamSearchOutputs { kTokens, kScores };
+}  // namespace ctc_beam_search
+
+struct CTCBeamSearchParam : public dmlc::Parameter<CTCBeamSearchParam> {
+  int beam_size;
+  int top_k;
+  int blank_label;
+  bool use_data_lengths;
+  bool use_lm;
+  float lm_weight;
+  float insertion_bonus;
+  DMLC_DECLARE_PARAMETER(CTCBeamSearchParam) {
+    DMLC_DECLARE_FIELD(beam_size).set_default(10).set_lower_bound(1).describe(
+        "Number of prefixes kept after every frame.");
+    DMLC_DECLARE_FIELD(top_k).set_default(0).describe(
+        "Only the top_k most likely tokens of a frame extend the prefixes. "
+        "If top_k <= 0, all tokens are tried.");
+    DMLC_DECLARE_FIELD(blank_label)
+        .add_enum("first", 0)
+        .add_enum("last", 1)
+        .set_default(0)
+        .describe(
+            "Set the label that is reserved for blank label. "
+            "If \"first\", 0-th label is reserved, "
+            "if \"last\", the last label ``alphabet_size-1`` is reserved.");
+    DMLC_DECLARE_FIELD(use_data_lengths)
+        .set_default(false)
+        .describe(
+            "Whether the data lengths are decided by `data_lengths`. "
+            "If false, the lengths are equal to the max sequence length.");
+    DMLC_DECLARE_FIELD(use_lm).set_default(false).describe(
+        "Whether the prefixes are rescored with the bigram language model `lm`.");
+    DMLC_DECLARE_FIELD(lm_weight).set_default(1.0f).describe(
+        "Weight of the language model log-probabilities. Only used when use_lm is true.");
+    DMLC_DECLARE_FIELD(insertion_bonus)
+        .set_default(0.0f)
+        .describe("Score added for every emitted token.");
+  }
+};
+
+inline uint32_t CTCBeamSearchNumInputs(const NodeAttrs& attrs) {
+  const CTCBeamSearchParam& param = nnvm::get<CTCBeamSearchParam>(attrs.parsed);
+  return 1U + param.use_data_lengths + param.use_lm;
+}
+
+inline std::vector<std::string> CTCBeamSearchListInputNames(const NodeAttrs& attrs) {
+  const CTCBeamSearchParam& param = nnvm::get<CTCBeamSearchParam>(attrs.parsed);
+  std::vector<std::string> ret{"data"};
+  if (param.use_data_lengths)
+    ret.emplace_back("data_lengths");
+  if (param.use_lm)
+    ret.emplace_back("lm");
+  return ret;
+}
+
+inline bool CTCBeamSearchShape(const nnvm::NodeAttrs& attrs,
+                               mxnet::ShapeVector* in_attrs,
+                               mxnet::ShapeVector* out_attrs) {
+  const CTCBeamSearchParam& param = nnvm::get<CTCBeamSearchParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), CTCBeamSearchNumInputs(attrs));
+  CHECK_EQ(out_attrs->size(), 2U);
+  const mxnet::TShape& dshape = (*in_attrs)[0];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  CHECK_EQ(dshape.ndim(), 3U) << "The number of dimensions of data array must be 3.";
+  CHECK_GE(dshape[2], 2) << "The alphabet must contain the blank label and one token.";
+  CHECK_LT(dshape.Size(), INT32_MAX) << "ValueError: CTC beam search does not support large"
+                                     << " tensors where total size >= 2^31.";
+  if (param.use_data_lengths) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, 1, mxnet::TShape(1, dshape[1]));
+  }
+  if (param.use_lm) {
+    mxnet::TShape lshape(2, dshape[2]);
+    SHAPE_ASSIGN_CHECK(*in_attrs, 1 + param.use_data_lengths, lshape);
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs,
+                     ctc_beam_search::kTokens,
+                     mxnet::TShape({dshape[1], param.beam_size, dshape[0]}));
+  SHAPE_ASSIGN_CHECK(
+      *out_attrs, ctc_beam_search::kScores, mxnet::TShape({dshape[1], param.beam_size}));
+  return true;
+}
+
+inline bool CTCBeamSearchType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int>* in_attrs,
+                              std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), CTCBeamSearchNumInputs(attrs));
+  CHECK_EQ(out_attrs->size(), 2U);
+  for (size_t i = 0; i < in_attrs->size(); ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, ctc_beam_search::kTokens, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, ctc_beam_search::kScores, mshadow::kFloat32);
+  return true;
+}
+
+/*! \brief sizes shared by all utterances of a batch */
+struct CTCBeamSearchDims {
+  int max_len;
+  int batch;
+  int alphabet;
+  int blank;
+  int beam;
+  /*! \brief number of tokens tried per frame */
+  int top_k;
+  /*! \brief per utterance workspace in ints and floats */
+  int int_space;
+  int float_space;
+  float lm_weight;
+  float insertion_bonus;
+  bool use_lm;
+};
+
+inline CTCBeamSearchDims GetCTCBeamSearchDims(const CTCBeamSearchParam& param,
+                                              const mxnet::TShape& dshape) {
+  CTCBeamSearchDims d;
+  d.max_len  = dshape[0];
+  d.batch    = dshape[1];
+  d.alphabet = dshape[2];
+  d.blank    = param.blank_label == 0 ? 0 : d.alphabet - 1;
+  d.beam     = param.beam_size;
+  d.top_k    = (param.top_k <= 0 || param.top_k > d.alphabet - 1) ? d.alphabet - 1 : param.top_k;
+  const int num_nodes = d.max_len * d.beam + 1;
+  const int num_cands = d.beam * (d.top_k + 1);
+  // tokens of the frame, trie nodes, current and next beams, candidates
+  d.int_space = d.top_k + 4 * num_nodes + 6 * d.beam + 2 * num_cands;
+  // p_blank, p_non_blank and lm score of the beams and the candidates, candidate score
+  d.float_space     = 6 * d.beam + 4 * num_cands;
+  d.lm_weight       = param.lm_weight;
+  d.insertion_bonus = param.insertion_bonus;
+  d.use_lm          = param.use_lm;
+  return d;
+}
+
+MSHADOW_XINLINE float CTCLogAdd(float a, float b) {
+  if (a < b) {
+    const float tmp = a;
+    a               = b;
+    b               = tmp;
+  }
+  if (b == mshadow::red::limits::NegInfValue<float>())
+    return a;
+  return a + log1pf(expf(b - a));
+}
+
+/*!
+ * \brief Prefix beam search over one utterance.
+ *
+ *  The prefixes are nodes of a trie that only grows and never holds a prefix twice, so
+ *  a beam is a node id plus the probabilities of its prefix ending in blank and in
+ *  non-blank. Every frame extends each beam by its top_k tokens; an extension that
+ *  equals another beam is merged into it instead of becoming a candidate. The
+ *  candidates are picked by repeated argmax, which keeps the beams sorted by score.
+ */
+struct CTCBeamSearchKernel {
+  MSHADOW_XINLINE static void Map(int b,
+                                  int32_t* out_tokens,
+                                  float* out_scores,
+                                  const float* data,
+                                  const float* data_lengths,
+                                  const float* lm,
+                                  int* int_work,
+                                  float* float_work,
+                                  const CTCBeamSearchDims d) {
+    const float neg_inf = mshadow::red::limits::NegInfValue<float>();
+    const int A         = d.alphabet;
+    const int num_nodes = d.max_len * d.beam + 1;
+    const int num_cands = d.beam * (d.top_k + 1);
+    int* tok            = int_work + static_cast<size_t>(b) * d.int_space;
+    int* node_parent    = tok + d.top_k;
+    int* node_token     = node_parent + num_nodes;
+    int* node_child     = node_token + num_nodes;
+    int* node_sibling   = node_child + num_nodes;
+    int* beam_node      = node_sibling + num_nodes;
+    int* beam_last      = beam_node + 2 * d.beam;
+    int* beam_len       = beam_last + 2 * d.beam;
+    int* cand_src       = beam_len + 2 * d.beam;
+    int* cand_tok       = cand_src + num_cands;
+    float* beam_pb      = float_work + static_cast<size_t>(b) * d.float_space;
+    float* beam_pnb     = beam_pb + 2 * d.beam;
+    float* beam_lm      = beam_pnb + 2 * d.beam;
+    float* cand_pb      = beam_lm + 2 * d.beam;
+    float* cand_pnb     = cand_pb + num_cands;
+    float* cand_lm      = cand_pnb + num_cands;
+    float* cand_score   = cand_lm + num_cands;
+
+    int T = d.max_len;
+    if (data_lengths != nullptr) {
+      T = static_cast<int>(data_lengths[b]);
+      T = T < 0 ? 0 : (T > d.max_len ? d.max_len : T);
+    }
+    int used_nodes  = 1;
+    node_parent[0]  = -1;
+    node_token[0]   = -1;
+    node_child[0]   = -1;
+    node_sibling[0] = -1;
+    int nb          = 1;
+    beam_node[0]    = 0;
+    beam_last[0]    = -1;
+    beam_len[0]     = 0;
+    beam_pb[0]      = 0.f;
+    beam_pnb[0]     = neg_inf;
+    beam_lm[0]      = 0.f;
+    for (int t = 0; t < T; ++t) {
+      const float* x = data + (static_cast<size_t>(t) * d.batch + b) * A;
+      // log-softmax normalizer of the frame
+      float mx = neg_inf;
+      for (int a = 0; a < A; ++a)
+        mx = x[a] > mx ? x[a] : mx;
+      float sum = 0.f;
+      for (int a = 0; a < A; ++a)
+        sum += expf(x[a] - mx);
+      const float lse      = mx + logf(sum);
+      const float lp_blank = x[d.blank] - lse;
+      // the top_k tokens of the frame, sorted by insertion
+      int nk = 0;
+      for (int a = 0; a < A; ++a) {
+        if (a == d.blank || (nk == d.top_k && x[a] <= x[tok[nk - 1]]))
+          continue;
+        int pos = nk < d.top_k ? nk++ : nk - 1;
+        for (; pos > 0 && x[tok[pos - 1]] < x[a]; --pos)
+          tok[pos] = tok[pos - 1];
+        tok[pos] = a;
+      }
+      // every beam stays, the first nb candidates belong to the beams themselves
+      int nc = 0;
+      for (int i = 0; i < nb; ++i, ++nc) {
+        cand_src[nc] = i;
+        cand_tok[nc] = -1;
+        cand_pb[nc]  = CTCLogAdd(beam_pb[i], beam_pnb[i]) + lp_blank;
+        cand_pnb[nc] = beam_last[i] >= 0 ? beam_pnb[i] + x[beam_last[i]] - lse : neg_inf;
+        cand_lm[nc]  = beam_lm[i];
+      }
+      // a beam that extends another beam by one token collects that extension
+      for (int j = 0; j < nb; ++j) {
+        if (beam_node[j] == 0)
+          continue;
+        const int parent = node_parent[beam_node[j]];
+        const int c      = node_token[beam_node[j]];
+        for (int i = 0; i < nb; ++i) {
+          if (beam_node[i] != parent)
+            continue;
+          const float prev = c == beam_last[i] ? beam_pb[i] : CTCLogAdd(beam_pb[i], beam_pnb[i]);
+          cand_pnb[j]      = CTCLogAdd(cand_pnb[j], prev + x[c] - lse);
+          break;
+        }
+      }
+      // the remaining extensions are new prefixes
+      for (int i = 0; i < nb; ++i) {
+        const float total = CTCLogAdd(beam_pb[i], beam_pnb[i]);
+        const int prev    = beam_last[i] >= 0 ? beam_last[i] : d.blank;
+        for (int q = 0; q < nk; ++q) {
+          const int c = tok[q];
+          bool merged = false;
+          for (int j = 0; j < nb && !merged; ++j) {
+            merged = beam_node[j] != 0 && node_parent[beam_node[j]] == beam_node[i] &&
+                     node_token[beam_node[j]] == c;
+          }
+          if (merged)
+            continue;
+          cand_src[nc] = i;
+          cand_tok[nc] = c;
+          cand_pb[nc]  = neg_inf;
+          cand_pnb[nc] = (c == beam_last[i] ? beam_pb[i] : total) + x[c] - lse;
+          cand_lm[nc]  = beam_lm[i] + d.insertion_bonus;
+          if (d.use_lm)
+            cand_lm[nc] += d.lm_weight * lm[prev * A + c];
+          ++nc;
+        }
+      }
+      for (int q = 0; q < nc; ++q)
+        cand_score[q] = CTCLogAdd(cand_pb[q], cand_pnb[q]) + cand_lm[q];
+      // the best candidates become the next beams, in descending order of score
+      int nn = 0;
+      for (; nn < d.beam; ++nn) {
+        int best = -1;
+        for (int q = 0; q < nc; ++q) {
+          if (cand_score[q] > neg_inf && (best < 0 || cand_score[q] > cand_score[best]))
+            best = q;
+        }
+        if (best < 0)
+          break;
+        cand_score[best] = neg_inf;
+        const int i      = cand_src[best];
+        const int next   = d.beam + nn;
+        if (cand_tok[best] < 0) {
+          beam_node[next] = beam_node[i];
+          beam_last[next] = beam_last[i];
+          beam_len[next]  = beam_len[i];
+        } else {
+          // a prefix that left the beams and comes back keeps its node
+          const int parent = beam_node[i];
+          int node         = node_child[parent];
+          while (node >= 0 && node_token[node] != cand_tok[best])
+            node = node_sibling[node];
+          if (node < 0) {
+            node               = used_nodes++;
+            node_parent[node]  = parent;
+            node_token[node]   = cand_tok[best];
+            node_child[node]   = -1;
+            node_sibling[node] = node_child[parent];
+            node_child[parent] = node;
+          }
+          beam_node[next] = node;
+          beam_last[next] = cand_tok[best];
+          beam_len[next]  = beam_len[i] + 1;
+        }
+        beam_pb[next]  = cand_pb[best];
+        beam_pnb[next] = cand_pnb[best];
+        beam_lm[next]  = cand_lm[best];
+      }
+      if (nn == 0)
+        break;
+      for (int i = 0; i < nn; ++i) {
+        beam_node[i] = beam_node[d.beam + i];
+        beam_last[i] = beam_last[d.beam + i];
+        beam_len[i]  = beam_len[d.beam + i];
+        beam_pb[i]   = beam_pb[d.beam + i];
+        beam_pnb[i]  = beam_pnb[d.beam + i];
+        beam_lm[i]   = beam_lm[d.beam + i];
+      }
+      nb = nn;
+    }
+    for (int r = 0; r < d.beam; ++r) {
+      int32_t* seq = out_tokens + (static_cast<size_t>(b) * d.beam + r) * d.max_len;
+      for (int t = 0; t < d.max_len; ++t)
+        seq[t] = -1;
+      if (r >= nb) {
+        out_scores[b * d.beam + r] = neg_inf;
+        continue;
+      }
+      int node = beam_node[r];
+      for (int l = beam_len[r] - 1; l >= 0; --l, node = node_parent[node])
+        seq[l] = node_token[node];
+      out_scores[b * d.beam + r] = CTCLogAdd(beam_pb[r], beam_pnb[r]) + beam_lm[r];
+    }
+  }
+};
+
+template <typename xpu>
+void CTCBeamSearchForward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  const CTCBeamSearchParam& param = nnvm::get<CTCBeamSearchParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), CTCBeamSearchNumInputs(attrs));
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK_EQ(req[ctc_beam_search::kTokens], kWriteTo);
+  CHECK_EQ(req[ctc_beam_search::kScores], kWriteTo);
+  Stream<xpu>* s            = ctx.get_stream<xpu>();
+  const CTCBeamSearchDims d = GetCTCBeamSearchDims(param, inputs[0].shape_);
+  if (d.batch == 0)
+    return;
+  const size_t int_bytes   = sizeof(int) * d.int_space * d.batch;
+  const size_t float_bytes = sizeof(float) * d.float_space * d.batch;
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(int_bytes + float_bytes), s);
+  int* int_work     = reinterpret_cast<int*>(workspace.dptr_);
+  float* float_work = reinterpret_cast<float*>(workspace.dptr_ + int_bytes);
+  const float* data_lengths = param.use_data_lengths ? inputs[1].dptr<float>() : nullptr;
+  const float* lm = param.use_lm ? inputs[1 + param.use_data_lengths].dptr<float>() : nullptr;
+  mxnet_op::Kernel<CTCBeamSearchKernel, xpu>::Launch(
+      s,
+      d.batch,
+      outputs[ctc_beam_search::kTokens].dptr<int32_t>(),
+      outputs[ctc_beam_search::kScores].dptr<float>(),
+      inputs[0].dptr<float>(),
+      data_lengths,
+      lm,
+      int_work,
+      float_work,
+      d);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_CTC_BEAM_SEARCH_INL_H_
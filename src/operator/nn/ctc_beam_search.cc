@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ctc_beam_search.cc
+ * \brief CPU Implementation of the CTC beam search decoder
+ */
+#include "./ctc_beam_search-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(CTCBeamSearchParam);
+
+NNVM_REGISTER_OP(_contrib_ctc_beam_search)
+    .add_alias("_npx_ctc_beam_search")
+    .describe(R"code(Decodes the activations of a CTC model with prefix beam search.
+
+The shapes of the inputs and outputs:
+
+- **data**: `(sequence_length, batch_size, alphabet_size)`
+- **data_lengths**: `(batch_size,)`, only when `use_data_lengths` is true
+- **lm**: `(alphabet_size, alphabet_size)`, only when `use_lm` is true
+- **tokens**: `(batch_size, beam_size, sequence_length)`
+- **scores**: `(batch_size, beam_size)`
+
+The `data` tensor holds the activations before softmax, with the blank label at channel
+``0`` when `blank_label` is ``"first"`` and at channel ``alphabet_size-1`` otherwise, the
+same layout as for `CTCLoss`.
+
+Every frame extends each of the `beam_size` prefixes by the `top_k` most likely tokens of
+the frame, merging the paths that collapse to the same prefix, and keeps the `beam_size`
+best prefixes. The score of a prefix is its log-probability, plus `insertion_bonus` for
+every token and, when `use_lm` is true, `lm_weight` times the log-probabilities of the
+bigram language model ``lm[prev, next]``. Row ``blank`` of `lm` scores the first token.
+
+``tokens`` holds the decoded label indices of the prefixes, best first, padded with ``-1``.
+``scores`` holds their scores, ``-inf`` for the beams that are left empty.
+
+Example::
+
+  tokens, scores = ctc_beam_search(data, beam_size=8, top_k=16)
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<CTCBeamSearchParam>)
+    .set_num_inputs(CTCBeamSearchNumInputs)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames", CTCBeamSearchListInputNames)
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"tokens", "scores"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", CTCBeamSearchShape)
+    .set_attr<nnvm::FInferType>("FInferType", CTCBeamSearchType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .set_attr<FCompute>("FCompute<cpu>", CTCBeamSearchForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("data", "NDArray-or-Symbol", "Activations of the CTC model.")
+    .add_argument("data_lengths",
+                  "NDArray-or-Symbol",
+                  "Lengths of data for each of the samples. Only required "
+                  "when use_data_lengths is true.")
+    .add_argument("lm",
+                  "NDArray-or-Symbol",
+                  "Bigram language model log-probabilities. Only required "
+                  "when use_lm is true.")
+    .add_arguments(CTCBeamSearchParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
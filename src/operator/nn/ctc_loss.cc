@@ -22,6 +22,7 @@
  * \brief CPU Implementation of CTC Loss op
  */
 #include "./ctc_loss-inl.h"
+#include "../../engine/openmp.h"
 #include "../../../3rdparty/ctc_include/detail/cpu_ctc.h"
 
 namespace mshadow {
@@ -37,7 +38,11 @@ ctcStatus_t compute_ctc_cost(const Tensor<cpu, 3, DType> activations,
                              int blank_label) {
   int minibatch     = static_cast<int>(activations.size(1));
   int alphabet_size = static_cast<int>(activations.size(2));
-  mxnet_warpctc::CpuCTC<DType> ctc(alphabet_size, minibatch, workspace, blank_label);
+  mxnet_warpctc::CpuCTC<DType> ctc(alphabet_size,
+                                   minibatch,
+                                   workspace,
+                                   blank_label,
+                                   mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
   if (isTraining) {
     return ctc.cost_and_grad(activations.dptr_, grads, costs, labels, label_lengths, data_lengths);
   } else {
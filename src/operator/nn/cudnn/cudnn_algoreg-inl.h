@@ -26,8 +26,11 @@
 #define MXNET_OPERATOR_NN_CUDNN_CUDNN_ALGOREG_INL_H_
 
 #include <algorithm>
+#include <fstream>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <utility>
@@ -66,6 +69,14 @@ class CuDNNAlgo {
   bool is_tensor_core_algo_;
 };
 
+/*!
+ * \brief The algorithms autotuned for the convolutions, or deconvolutions, of each configuration.
+ *
+ * When MXNET_CUDNN_AUTOTUNE_CACHE names a file, the registry loads the algorithms tuned by earlier
+ * processes from it on first use and appends the algorithms it tunes to it. The entries are keyed
+ * by the GPU model and the cuDNN version besides the configuration, so one file can serve
+ * different machines.
+ */
 template <typename ParamType>
 class CuDNNAlgoReg {
  public:
@@ -73,6 +84,9 @@ class CuDNNAlgoReg {
                                           CuDNNAlgo<cudnnConvolutionBwdDataAlgo_t>*,
                                           CuDNNAlgo<cudnnConvolutionBwdFilterAlgo_t>*)>;
 
+  explicit CuDNNAlgoReg(const std::string& name)
+      : name_(name), cache_file_(dmlc::GetEnv("MXNET_CUDNN_AUTOTUNE_CACHE", std::string())) {}
+
   void FindOrElseRegister(const ParamType& param,
                           const mxnet::ShapeVector& in_shape,
                           const mxnet::ShapeVector& out_shape,
@@ -96,11 +110,26 @@ class CuDNNAlgoReg {
                  sm_arch,
                  add_to_weight};
     std::lock_guard<std::mutex> guard(lock_);
+    if (!cache_file_.empty() && !cache_loaded_) {
+      Load(cache_file_);
+      cache_loaded_ = true;
+    }
     auto i = reg_.find(key);
     if (i != reg_.end()) {
       *fwd = i->second.fwd;
       *bwd = i->second.bwd;
       *flt = i->second.flt;
+      return;
+    }
+    // Only the autotuned algorithms are worth keeping across processes.
+    const bool tuned = param.cudnn_tune.value() != conv::kOff && !cache_file_.empty();
+    const std::string persistent_key = tuned ? PersistentKey(key) : std::string();
+    auto p = tuned ? persistent_.find(persistent_key) : persistent_.end();
+    if (p != persistent_.end()) {
+      *fwd = p->second.fwd;
+      *bwd = p->second.bwd;
+      *flt = p->second.flt;
+      reg_.insert(std::pair<ParamKey, CudnnAlgorithms>(key, p->second));
     } else {
       if (param.cudnn_tune.value() && reg_.size() % 50 == 0) {
         LOG(INFO) << "Running performance tests to find the best convolution "
@@ -121,6 +150,13 @@ class CuDNNAlgoReg {
       algo_setter(fwd, bwd, flt);
       // Save result so future lookups hit in this registry
       reg_.insert(std::pair<ParamKey, CudnnAlgorithms>(key, CudnnAlgorithms{*fwd, *bwd, *flt}));
+      if (tuned) {
+        persistent_[persistent_key] = CudnnAlgorithms{*fwd, *bwd, *flt};
+        std::ofstream file(cache_file_, std::ios::app);
+        file << Entry(persistent_key, persistent_[persistent_key]);
+        if (!file)
+          LOG(WARNING) << "Failed to append the tuned cuDNN algorithms to " << cache_file_;
+      }
     }
   }
 
@@ -133,6 +169,40 @@ class CuDNNAlgoReg {
     CuDNNAlgo<cudnnConvolutionBwdFilterAlgo_t> flt;
   };
 
+  // A line of a file is the key of the configuration, a tab, and the algorithms.
+  static std::string Entry(const std::string& key, const CudnnAlgorithms& algos) {
+    std::ostringstream os;
+    os << key << '\t' << static_cast<int>(algos.fwd.AlgoNumber()) << ' '
+       << algos.fwd.IsTensorCoreAlgo() << ' ' << static_cast<int>(algos.bwd.AlgoNumber()) << ' '
+       << algos.bwd.IsTensorCoreAlgo() << ' ' << static_cast<int>(algos.flt.AlgoNumber()) << ' '
+       << algos.flt.IsTensorCoreAlgo() << '\n';
+    return os.str();
+  }
+
+  // Load the algorithms tuned by other processes, they are used instead of autotuning the same
+  // configurations on the same GPU model and cuDNN version.
+  void Load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+      return;
+    std::string line;
+    while (std::getline(file, line)) {
+      const size_t tab = line.rfind('\t');
+      if (tab == std::string::npos)
+        continue;
+      std::istringstream is(line.substr(tab + 1));
+      int fwd, bwd, flt;
+      bool fwd_tc, bwd_tc, flt_tc;
+      if (!(is >> fwd >> fwd_tc >> bwd >> bwd_tc >> flt >> flt_tc))
+        continue;
+      CudnnAlgorithms algos;
+      algos.fwd.Set(static_cast<cudnnConvolutionFwdAlgo_t>(fwd), fwd_tc);
+      algos.bwd.Set(static_cast<cudnnConvolutionBwdDataAlgo_t>(bwd), bwd_tc);
+      algos.flt.Set(static_cast<cudnnConvolutionBwdFilterAlgo_t>(flt), flt_tc);
+      persistent_[line.substr(0, tab)] = algos;
+    }
+  }
+
   struct ParamKey {
     ParamType param;
     mxnet::TShape data_shape, weight_shape, out_shape;
@@ -168,8 +238,32 @@ class CuDNNAlgoReg {
     }
   };
 
+  // The key of a configuration valid in other processes, which also names the operator, the GPU
+  // model and the cuDNN version.
+  std::string PersistentKey(const ParamKey& key) const {
+    int dev_id = 0;
+    CUDA_CALL(cudaGetDevice(&dev_id));
+    cudaDeviceProp props;
+    CUDA_CALL(cudaGetDeviceProperties(&props, dev_id));
+    std::ostringstream os;
+    os << name_ << ' ' << props.name << " cudnn" << CUDNN_VERSION << " sm" << key.sm_arch;
+    for (const auto& field : key.param.__DICT__())
+      os << ' ' << field.first << '=' << field.second;
+    os << ' ' << key.data_shape << ' ' << key.weight_shape << ' ' << key.out_shape << ' '
+       << key.cudnn_data_type << ' ' << key.cudnn_forward_compute_type << ' '
+       << key.cudnn_backward_compute_type << ' ' << key.add_to_weight;
+    std::string ret = os.str();
+    std::replace(ret.begin(), ret.end(), '\t', ' ');
+    return ret;
+  }
+
   std::mutex lock_;
   std::unordered_map<ParamKey, CudnnAlgorithms, ParamHash> reg_;
+  // the algorithms autotuned by this process or loaded from the cache file by their persistent keys
+  std::unordered_map<std::string, CudnnAlgorithms> persistent_;
+  std::string name_;
+  std::string cache_file_;
+  bool cache_loaded_        = false;
   bool is_warning_autotune_ = false;
 };
 
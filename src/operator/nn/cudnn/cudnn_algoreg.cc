@@ -34,13 +34,13 @@ namespace op {
 #if MXNET_USE_CUDNN == 1
 template <>
 CuDNNAlgoReg<ConvolutionParam>* CuDNNAlgoReg<ConvolutionParam>::Get() {
-  static CuDNNAlgoReg<ConvolutionParam> inst;
+  static CuDNNAlgoReg<ConvolutionParam> inst("Convolution");
   return &inst;
 }
 
 template <>
 CuDNNAlgoReg<DeconvolutionParam>* CuDNNAlgoReg<DeconvolutionParam>::Get() {
-  static CuDNNAlgoReg<DeconvolutionParam> inst;
+  static CuDNNAlgoReg<DeconvolutionParam> inst("Deconvolution");
   return &inst;
 }
 #endif  // CUDNN
@@ -27,6 +27,7 @@
 #include "cudnn_batch_norm.h"
 
 #include "../../../common/cuda/utils.h"
+#include "../../contrib/batch_norm_add_relu-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -38,6 +39,7 @@ namespace {
 struct Globals {
   cudnnTensorDescriptor_t io_desc;
   cudnnTensorDescriptor_t mean_desc;
+  cudnnActivationDescriptor_t relu_desc;
   bool internal_aux_states_lock = false;
 
   static Globals& Get() {
@@ -48,11 +50,15 @@ struct Globals {
   Globals() {
     CUDNN_CALL(cudnnCreateTensorDescriptor(&io_desc));
     CUDNN_CALL(cudnnCreateTensorDescriptor(&mean_desc));
+    CUDNN_CALL(cudnnCreateActivationDescriptor(&relu_desc));
+    CUDNN_CALL(cudnnSetActivationDescriptor(
+        relu_desc, CUDNN_ACTIVATION_RELU, CUDNN_PROPAGATE_NAN, 0.0));
   }
 
   ~Globals() {
     CUDNN_CALL(cudnnDestroyTensorDescriptor(io_desc));
     CUDNN_CALL(cudnnDestroyTensorDescriptor(mean_desc));
+    CUDNN_CALL(cudnnDestroyActivationDescriptor(relu_desc));
   }
 };
 
@@ -80,6 +86,27 @@ mshadow::TypeFlag ParamType(int x_type) {
   return xt == mshadow::kFloat16 ? mshadow::kFloat32 : xt;
 }
 
+// If the lock on the auxiliary states is set, then this implies that
+// the preceding call is also a `Forward()` call, which further
+// indicates that we are in the backward mirroring mode, and therefore
+// update to the auxiliary states is disabled. This is done by setting
+// the `momentum` to `1` (or `factor` to `0`).
+double MovingAverageFactor(const BatchNormParam& param) {
+  return ((dmlc::GetEnv("MXNET_BACKWARD_DO_MIRROR", 0) || dmlc::GetEnv("MXNET_MEMORY_OPT", 0)) &&
+          Globals::Get().internal_aux_states_lock)
+             ? 0
+             : (1 - param.momentum);
+}
+
+// cuDNN adds the residual and applies the ReLU in its NHWC kernels for float16 only
+bool CudnnBatchNormAddReLUFuses(const BatchNormParam& param,
+                                const OpContext& ctx,
+                                const TBlob& x) {
+  const int n = x.shape_.ndim();
+  return ctx.is_train && x.type_flag_ == mshadow::kFloat16 && param.axis == n - 1 &&
+         x.shape_[n - 1] % 4 == 0;
+}
+
 }  // namespace
 
 bool CudnnBatchNormSupports(const BatchNormParam& param, const TBlob& x) {
@@ -115,17 +142,7 @@ void CudnnBatchNormForward(const BatchNormParam& param, const OpContext& ctx,
           Globals::Get().io_desc, nullptr, Globals::Get().io_desc, Globals::Get().mean_desc,
           nullptr, &workspace_size));
       auto workspace = ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormForward");
-
-      // If the lock on the auxiliary states is set, then this implies that
-      // the preceding call is also a `Forward()` call, which further
-      // indicates that we are in the backward mirroring mode, and therefore
-      // update to the auxiliary states is disabled. This is done by setting
-      // the `momentum` to `1` (or `factor` to `0`).
-      double factor =
-          ((dmlc::GetEnv("MXNET_BACKWARD_DO_MIRROR", 0) || dmlc::GetEnv("MXNET_MEMORY_OPT", 0)) &&
-           Globals::Get().internal_aux_states_lock)
-              ? 0
-              : (1 - param.momentum);
+      double factor  = MovingAverageFactor(param);
       CUDNN_CALL(cudnnBatchNormalizationForwardTrainingEx(
           s->dnn_handle_, CUDNN_BATCHNORM_SPATIAL_PERSISTENT, CUDNN_BATCHNORM_OPS_BN, &a, &b,
           Globals::Get().io_desc, inputs[batchnorm::kData].dptr_,
@@ -205,6 +222,137 @@ void CudnnBatchNormBackward(const BatchNormParam& param, const OpContext& ctx,
   Globals::Get().internal_aux_states_lock = false;
 }
 
+void CudnnBatchNormAddReLUForward(const BatchNormParam& param, const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(inputs.size(), 6);
+  CHECK_EQ(outputs.size(), 4);
+  CHECK_EQ(req[kOut], kWriteTo);
+  auto s         = ctx.get_stream<gpu>();
+  const TBlob& x = inputs[kData];
+  if (!CudnnBatchNormAddReLUFuses(param, ctx, x)) {
+    std::vector<TBlob> bn_inputs(inputs.begin(), inputs.begin() + kAddend);
+    std::vector<TBlob> bn_outputs(outputs.begin(), outputs.begin() + kReserve);
+    std::vector<OpReqType> bn_req(req.begin(), req.begin() + kReserve);
+    CudnnBatchNormForward(param, ctx, bn_inputs, bn_req, bn_outputs);
+    BatchNormAddReLUMask(s, outputs[kOut], inputs[kAddend], outputs[kReserve]);
+    return;
+  }
+
+  SetDescriptors(param, x);
+  const cudnnBatchNormMode_t mode = CUDNN_BATCHNORM_SPATIAL_PERSISTENT;
+  const cudnnBatchNormOps_t ops   = CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION;
+  const Globals& g                = Globals::Get();
+  size_t workspace_size           = 0;
+  size_t reserve_size             = 0;
+  CUDNN_CALL(cudnnGetBatchNormalizationForwardTrainingExWorkspaceSize(
+      s->dnn_handle_, mode, ops, g.io_desc, g.io_desc, g.io_desc, g.mean_desc, g.relu_desc,
+      &workspace_size));
+  CUDNN_CALL(cudnnGetBatchNormalizationTrainingExReserveSpaceSize(
+      s->dnn_handle_, mode, ops, g.relu_desc, g.io_desc, &reserve_size));
+  CHECK_LE(reserve_size, outputs[kReserve].Size() * sizeof(int32_t))
+      << "cuDNN needs a larger reserve space than BatchNormAddReLU provides";
+  auto workspace =
+      ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormAddReLUForward");
+  MSHADOW_REAL_TYPE_SWITCH(ParamType(x.type_flag_), DType, {
+    DType a = 1.0f;
+    DType b = 0.0f;
+    if (param.fix_gamma) inputs[kGamma].FlatTo1D<gpu, DType>(s) = 1.0f;
+    CUDNN_CALL(cudnnBatchNormalizationForwardTrainingEx(
+        s->dnn_handle_, mode, ops, &a, &b,
+        g.io_desc, x.dptr_,
+        g.io_desc, inputs[kAddend].dptr_,
+        g.io_desc, outputs[kOut].dptr_,
+        g.mean_desc, inputs[kGamma].dptr_, inputs[kBeta].dptr_,
+        MovingAverageFactor(param), inputs[kInMovingMean].dptr_, inputs[kInMovingVar].dptr_,
+        param.eps, outputs[kMean].dptr_, outputs[kVar].dptr_,
+        g.relu_desc,
+        workspace, workspace_size,
+        outputs[kReserve].dptr_, reserve_size));
+  })
+  Globals::Get().internal_aux_states_lock = true;
+}
+
+void CudnnBatchNormAddReLUBackward(const BatchNormParam& param, const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using namespace batchnormaddrelu;
+  CHECK_EQ(inputs.size(), 10);
+  CHECK_EQ(outputs.size(), 4);
+  CHECK_EQ(req.size(), 4);
+  auto s                          = ctx.get_stream<gpu>();
+  const TBlob& x                  = inputs[kBwdData];
+  const bool fused                = CudnnBatchNormAddReLUFuses(param, ctx, x);
+  const cudnnBatchNormMode_t mode = CUDNN_BATCHNORM_SPATIAL_PERSISTENT;
+  const cudnnBatchNormOps_t ops =
+      fused ? CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION : CUDNN_BATCHNORM_OPS_BN;
+  SetDescriptors(param, x);
+  const Globals& g = Globals::Get();
+  // the addend and the normalized data share the gradient of the sum, computed by cuDNN with
+  // the fusion and from the ReLU bitmask without
+  cudnnTensorDescriptor_t fused_desc   = fused ? g.io_desc : nullptr;
+  cudnnActivationDescriptor_t act_desc = fused ? g.relu_desc : nullptr;
+  size_t workspace_size                = 0;
+  size_t reserve_size                  = 0;
+  CUDNN_CALL(cudnnGetBatchNormalizationBackwardExWorkspaceSize(
+      s->dnn_handle_, mode, ops, g.io_desc, fused_desc, g.io_desc, fused_desc, g.io_desc,
+      g.mean_desc, act_desc, &workspace_size));
+  if (fused) {
+    CUDNN_CALL(cudnnGetBatchNormalizationTrainingExReserveSpaceSize(
+        s->dnn_handle_, mode, ops, g.relu_desc, g.io_desc, &reserve_size));
+  }
+  // the gradient of the sum goes after the workspace of cuDNN when the one of the addend is not
+  // written
+  const bool write_addend = IsBNWriting(req[kBwdAddendGrad]);
+  const size_t offset     = (workspace_size + 255) / 256 * 256;
+  const size_t bytes      = write_addend ? 0 : x.Size() * mshadow::mshadow_sizeof(x.type_flag_);
+  char* workspace         = static_cast<char*>(
+      ctx.requested[0].get_space_internal(offset + bytes, "CudnnBatchNormAddReLUBackward"));
+  const TBlob sum_grad =
+      write_addend ? outputs[kBwdAddendGrad]
+                   : TBlob(workspace + offset, x.shape_, gpu::kDevMask, x.type_flag_);
+  if (!fused)
+    BatchNormAddReLUSumGrad(s, inputs[kBwdOutGrad], inputs[kBwdReserve], sum_grad);
+
+  MSHADOW_REAL_TYPE_SWITCH(ParamType(x.type_flag_), DType, {
+    if (param.fix_gamma) inputs[kBwdGamma].FlatTo1D<gpu, DType>(s) = 1.0f;
+    bool grad_add_gamma_beta = req[kBwdGammaGrad] == kAddTo || req[kBwdBetaGrad] == kAddTo;
+    if (grad_add_gamma_beta) {
+      if (IsBNWriting(req[kBwdGammaGrad]))
+        outputs[kBwdGammaGrad].FlatTo1D<gpu, DType>(s) = 0.0f;
+      if (IsBNWriting(req[kBwdBetaGrad]))
+        outputs[kBwdBetaGrad].FlatTo1D<gpu, DType>(s) = 0.0f;
+    }
+    DType a = 1.0f;
+    DType b = 0.0f;
+    DType b_add = 1.0f;
+    const bool global_stats = !ctx.is_train;
+    CUDNN_CALL(cudnnBatchNormalizationBackwardEx(
+        s->dnn_handle_, mode, ops,
+        &a, req[kBwdDataGrad] == kAddTo ? &b_add : &b,
+        &a, grad_add_gamma_beta ? &b_add : &b,
+        g.io_desc, x.dptr_,
+        fused_desc, fused ? inputs[kBwdOut].dptr_ : nullptr,
+        g.io_desc, fused ? inputs[kBwdOutGrad].dptr_ : sum_grad.dptr_,
+        fused_desc, fused ? sum_grad.dptr_ : nullptr,
+        g.io_desc, outputs[kBwdDataGrad].dptr_,
+        g.mean_desc,
+        inputs[kBwdGamma].dptr_, inputs[kBwdBeta].dptr_,
+        outputs[kBwdGammaGrad].dptr_, outputs[kBwdBetaGrad].dptr_, param.eps,
+        global_stats ? nullptr : inputs[kBwdMean].dptr_,
+        global_stats ? nullptr : inputs[kBwdVar].dptr_,
+        act_desc,
+        workspace, workspace_size,
+        fused ? inputs[kBwdReserve].dptr_ : nullptr, reserve_size));
+    if (param.fix_gamma) outputs[kBwdGammaGrad].FlatTo1D<gpu, DType>(s) = 0.0f;
+  })
+  BatchNormAddReLUAddendGrad(s, sum_grad, req[kBwdAddendGrad], outputs[kBwdAddendGrad]);
+  Globals::Get().internal_aux_states_lock = false;
+}
+
 #endif  // MXNET_USE_CUDNN == 1
 }  // namespace op
 }  // namespace mxnet
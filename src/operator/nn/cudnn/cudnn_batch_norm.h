@@ -48,6 +48,21 @@ void CudnnBatchNormBackward(const BatchNormParam& param, const OpContext& ctx,
                             const std::vector<TBlob>& inputs, const std::vector<OpReqType>& req,
                             const std::vector<TBlob>& outputs);
 
+/*!
+ * The forward and backward passes of _contrib_BatchNormAddReLU. cuDNN computes the addition and
+ * the ReLU with the batch normalization for float16 data with the channels last in training, and
+ * the rest takes a pass of its own over the data.
+ */
+void CudnnBatchNormAddReLUForward(const BatchNormParam& param, const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs);
+
+void CudnnBatchNormAddReLUBackward(const BatchNormParam& param, const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs);
+
 #endif  // MXNET_USE_CUDNN == 1
 
 }  // namespace op
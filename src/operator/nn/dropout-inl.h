@@ -68,6 +68,7 @@ struct DropoutParam : public dmlc::Parameter<DropoutParam> {
   int mode;
   mxnet::TShape axes;
   dmlc::optional<bool> cudnn_off;
+  bool packed_mask;
   DMLC_DECLARE_PARAMETER(DropoutParam) {
     DMLC_DECLARE_FIELD(p).set_default(0.5).set_range(0, 1).describe(
         "Fraction of the input that gets dropped out during training time.");
@@ -85,6 +86,12 @@ struct DropoutParam : public dmlc::Parameter<DropoutParam> {
         .describe(
             "Whether to turn off cudnn in dropout operator. "
             "This option is ignored if axes is specified.");
+    DMLC_DECLARE_FIELD(packed_mask)
+        .set_default(false)
+        .describe(
+            "Whether to keep the mask as uint8 bits, 8 elements per byte, instead of an array "
+            "of the data type. cuDNN and MKL are then not used. "
+            "This option is ignored if axes is specified.");
   }
   std::string Mode2String(int mode) {
     switch (mode) {
@@ -99,26 +106,28 @@ struct DropoutParam : public dmlc::Parameter<DropoutParam> {
     return "";
   }
   void SetAttrDict(std::unordered_map<std::string, std::string>* dict) {
-    std::ostringstream p_s, mode_s, axes_s, cudnn_off_s;
+    std::ostringstream p_s, mode_s, axes_s, cudnn_off_s, packed_mask_s;
     p_s << p;
     mode_s << mode;
     axes_s << axes;
     cudnn_off_s << cudnn_off;
-    (*dict)["p"]         = p_s.str();
-    (*dict)["mode"]      = Mode2String(mode);
-    (*dict)["axes"]      = axes_s.str();
-    (*dict)["cudnn_off"] = cudnn_off_s.str();
+    packed_mask_s << packed_mask;
+    (*dict)["p"]           = p_s.str();
+    (*dict)["mode"]        = Mode2String(mode);
+    (*dict)["axes"]        = axes_s.str();
+    (*dict)["cudnn_off"]   = cudnn_off_s.str();
+    (*dict)["packed_mask"] = packed_mask_s.str();
   }
 };  // struct DropoutParam
 
 template <typename xpu, typename DType>
 class DropoutOp {
 #if MXNET_USE_MKL_DROPOUT
-  static void BernoulliGenerate(common::random::RandGenerator<cpu, DType> gen,
+  static void BernoulliGenerate(common::random::PhiloxGenerator<cpu, DType> gen,
                                 int n,
                                 double p,
                                 int* r) {
-    typename RandGenerator<xpu, DType>::Impl genImpl(&gen, 1);
+    typename PhiloxGenerator<xpu, DType>::Impl genImpl(&gen, 1);
     const int seed = 17 + abs(genImpl.rand() % 4096);
     CHECK_GE(seed, 0);
     const int nthr = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
@@ -148,8 +157,7 @@ class DropoutOp {
                          const std::vector<TBlob>& in_data,
                          const std::vector<TBlob>& out_data) {
     Stream<xpu>* s                  = ctx.get_stream<xpu>();
-    RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
-    CHECK_NOTNULL(pgen);
+    PhiloxGenerator<xpu, DType> gen = ctx.requested[0].get_counter_random<xpu, DType>();
     Tensor<xpu, 2, DType> mask = out_data[dropout::kMask].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, DType> data = in_data[dropout::kData].FlatTo2D<xpu, DType>(s);
     Tensor<xpu, 2, DType> out  = out_data[dropout::kOut].FlatTo2D<xpu, DType>(s);
@@ -162,7 +170,7 @@ class DropoutOp {
       Tensor<xpu, 1, int> temp = ctx.requested[1].get_space_typed<xpu, 1, int>(Shape1(count), s);
       maskptr                  = temp.dptr_;
     }
-    BernoulliGenerate(*pgen, count, this->pkeep_, maskptr);
+    BernoulliGenerate(gen, count, this->pkeep_, maskptr);
     const float pk_1 = 1.0f / this->pkeep_;
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
     for (int i = 0; i < count; ++i) {
@@ -210,7 +218,7 @@ class DropoutOp {
      * \param pkeep Dropout rate (keep when the generated random number is less than this value)
      */
     MSHADOW_XINLINE static void Map(index_t id,
-                                    RandGenerator<xpu, DType> gen,
+                                    PhiloxGenerator<xpu, DType> gen,
                                     const index_t N,
                                     const index_t step,
                                     DType* dropout_out,
@@ -224,10 +232,54 @@ class DropoutOp {
       });
     }
   };
+  /*!
+   * \brief Dropout kernel with a 1-bit mask, fusing the generation, the dropout and the packing
+   *  of the mask. A thread writes whole bytes of the mask, bit j of byte i is element 8 * i + j.
+   */
+  struct DropoutPackedKernel {
+    /*!
+     * \param N Total number of bytes of the mask
+     * \param size Total number of items in the output
+     */
+    MSHADOW_XINLINE static void Map(index_t id,
+                                    PhiloxGenerator<xpu, DType> gen,
+                                    const index_t N,
+                                    const index_t step,
+                                    const index_t size,
+                                    DType* dropout_out,
+                                    uint8_t* mask_out,
+                                    const DType* input_data,
+                                    const real_t pkeep) {
+      RNG_KERNEL_LOOP(xpu, DType, id, gen, N, step, {
+        const index_t begin = i * 8;
+        const int count     = size - begin < 8 ? static_cast<int>(size - begin) : 8;
+        uint8_t bits        = 0;
+        for (int j = 0; j < count; ++j) {
+          const real_t rand_num  = static_cast<real_t>(genImpl.uniform());
+          const real_t keep      = mshadow_op::threshold_eq::Map<real_t>(rand_num, pkeep);
+          dropout_out[begin + j] = input_data[begin + j] * DType(keep * (1.0f / pkeep));
+          bits |= static_cast<uint8_t>(keep) << j;
+        }
+        mask_out[i] = bits;
+      });
+    }
+  };
+  /*! \brief gradient of the dropout with a 1-bit mask, see DropoutPackedKernel */
+  template <int req>
+  struct DropoutPackedGradKernel {
+    MSHADOW_XINLINE static void Map(index_t i,
+                                    DType* in_grad,
+                                    const DType* out_grad,
+                                    const uint8_t* mask,
+                                    const real_t pkeep) {
+      const real_t keep = (mask[i >> 3] >> (i & 7)) & 1;
+      KERNEL_ASSIGN(in_grad[i], req, out_grad[i] * DType(keep * (1.0f / pkeep)));
+    }
+  };
   struct BernoulliKernel {
     /*! \brief Bernoulli kernel for generating mask */
     MSHADOW_XINLINE static void Map(index_t id,
-                                    RandGenerator<xpu, DType> gen,
+                                    PhiloxGenerator<xpu, DType> gen,
                                     const index_t N,
                                     const index_t step,
                                     DType* mask_out,
@@ -243,9 +295,11 @@ class DropoutOp {
     this->pkeep_               = 1.0f - param.p;
     this->mode_                = static_cast<dropout::DropoutOpMode>(param.mode);
     this->axes_                = param.axes;
+    this->packed_mask_         = param.packed_mask && param.axes.ndim() == 0;
     this->dropout_passthrough_ = true;
 #if MXNET_USE_CUDNN_DROPOUT
-    this->cudnn_off_ = param.cudnn_off && param.cudnn_off.value();
+    // the reserve space of cudnn is not the packed mask
+    this->cudnn_off_ = (param.cudnn_off && param.cudnn_off.value()) || this->packed_mask_;
     this->ctx_       = ctx;
     if (ctx.dev_type == kGPU && this->pkeep_ > 0 && !this->cudnn_off_) {
       dtype_ = mshadow::DataType<DType>::kCudnnFlag;
@@ -361,6 +415,20 @@ class DropoutOp {
       if (this->pkeep_ < 1 && (ctx.is_train || this->mode_ == dropout::kAlways)) {
         this->dropout_passthrough_ = false;
         if (this->axes_.ndim() == 0) {
+          if (this->packed_mask_) {
+            PhiloxGenerator<xpu, DType> gen = ctx.requested[0].get_counter_random<xpu, DType>();
+            CHECK(req[dropout::kOut] != kAddTo);
+            CHECK_EQ(mask.Size(), (out.Size() + 7) / 8);
+            LaunchRNG<DropoutPackedKernel, xpu>(s,
+                                                &gen,
+                                                mask.Size(),
+                                                out.Size(),
+                                                out.dptr<DType>(),
+                                                mask.dptr<uint8_t>(),
+                                                in.dptr<DType>(),
+                                                this->pkeep_);
+            return;
+          }
 #if MXNET_USE_MKL_DROPOUT
           if (MKLAvailable()) {
             MKLForward(ctx, in_data, out_data);
@@ -373,11 +441,10 @@ class DropoutOp {
             return;
           }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
-          RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
-          CHECK_NOTNULL(pgen);
+          PhiloxGenerator<xpu, DType> gen = ctx.requested[0].get_counter_random<xpu, DType>();
           CHECK(req[dropout::kOut] != kAddTo);
           LaunchRNG<DropoutKernel, xpu>(s,
-                                        pgen,
+                                        &gen,
                                         out.Size(),
                                         out.dptr<DType>(),
                                         mask.dptr<DType>(),
@@ -385,10 +452,9 @@ class DropoutOp {
                                         this->pkeep_);
           return;
         } else {
-          RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
-          CHECK_NOTNULL(pgen);
+          PhiloxGenerator<xpu, DType> gen = ctx.requested[0].get_counter_random<xpu, DType>();
           // initialize the mask
-          LaunchRNG<BernoulliKernel, xpu>(s, pgen, mask.Size(), mask.dptr<DType>(), this->pkeep_);
+          LaunchRNG<BernoulliKernel, xpu>(s, &gen, mask.Size(), mask.dptr<DType>(), this->pkeep_);
           // broadcast mul
           mxnet::TShape new_lshape, new_rshape, new_oshape;
           int ndim = BinaryBroadcastShapeCompact(
@@ -442,6 +508,18 @@ class DropoutOp {
       const TBlob& grad          = out_grad[dropout::kOut];
       const TBlob& mask          = out_data[dropout::kMask];
       if (this->axes_.ndim() == 0) {
+        if (this->packed_mask_) {
+          CHECK_EQ(mask.Size(), (grad.Size() + 7) / 8);
+          MXNET_ASSIGN_REQ_SWITCH(req[dropout::kData], Req, {
+            mxnet_op::Kernel<DropoutPackedGradKernel<Req>, xpu>::Launch(s,
+                                                                        gdata.Size(),
+                                                                        gdata.dptr<DType>(),
+                                                                        grad.dptr<DType>(),
+                                                                        mask.dptr<uint8_t>(),
+                                                                        this->pkeep_);
+          });
+          return;
+        }
 #if MXNET_USE_MKL_DROPOUT
         if (MKLAvailable()) {
           MKLBackward(ctx, in_grad, out_data, out_grad);
@@ -506,6 +584,8 @@ class DropoutOp {
   dropout::DropoutOpMode mode_;
   /*! \brief Axes on which dropout mask is shared in the form of broadcast multiply */
   mxnet::TShape axes_;
+  /*! \brief Whether the mask is kept as bits, see DropoutPackedKernel */
+  bool packed_mask_;
   /*! \brief Flag to record whether forward is executed in pass-through mode */
   bool dropout_passthrough_;
 #if MXNET_USE_CUDNN_DROPOUT
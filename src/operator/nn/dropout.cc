@@ -72,6 +72,9 @@ NNVM_REGISTER_OP(Dropout)
 - During testing, this operator does not change the input if mode is 'training'.
   If mode is 'always', the same computaion as during training will be applied.
 
+- With packed_mask, the mask kept for the backward is a uint8 array of one bit per
+  element instead of an array of the data type, e.g. 32 times smaller for float32.
+
 Example::
 
   random.seed(998)
@@ -119,6 +122,14 @@ Example::
                                       return false;
                                     out_shape->clear();
                                     out_shape->push_back(dshape);
+                                    if (param.packed_mask && param.axes.ndim() == 0) {
+                                      // 8 elements per byte of the mask
+                                      if (!mxnet::shape_is_known(dshape))
+                                        return false;
+                                      out_shape->push_back(
+                                          mxnet::TShape(1, (dshape.Size() + 7) / 8));
+                                      return true;
+                                    }
                                     for (int i = 0; i < param.axes.ndim(); ++i) {
                                       dshape[param.axes[i]] = 1;
                                     }
@@ -137,10 +148,12 @@ Example::
                                     return false;
                                   }
 
-                                  size_t nout = 2;
+                                  const DropoutParam& param =
+                                      nnvm::get<DropoutParam>(attrs.parsed);
+                                  const bool packed = param.packed_mask && param.axes.ndim() == 0;
                                   out_type->clear();
-                                  for (size_t i = 0; i < nout; ++i)
-                                    out_type->push_back(dtype);
+                                  out_type->push_back(dtype);
+                                  out_type->push_back(packed ? mshadow::kUint8 : dtype);
                                   return true;
                                 })
     .set_attr<FCreateOpState>("FCreateOpState", CreateDropoutState)
@@ -161,13 +174,13 @@ Example::
 #if MXNET_USE_CUDNN_DROPOUT
             // if cudnn is used, parallel random is not needed.
             if (1.0f - param.p > 0 && !(param.cudnn_off && param.cudnn_off.value()) &&
-                param.axes.ndim() == 0) {
+                !param.packed_mask && param.axes.ndim() == 0) {
               request.emplace_back(ResourceRequest::kCuDNNDropoutDesc);
               return request;
             }
 #endif
           }
-          request.emplace_back(ResourceRequest::kParallelRandom);
+          request.emplace_back(ResourceRequest::kCounterRandom);
 #if MXNET_USE_MKL_DROPOUT
           request.emplace_back(ResourceRequest::kTempSpace);
 #endif
@@ -163,6 +163,14 @@ static bool FullyConnectedType(const nnvm::NodeAttrs& attrs,
       attrs, in_type, out_type, -1);
 }
 
+// a multiply-add per output and input feature
+static uint64_t FullyConnectedFlops(const nnvm::NodeAttrs& attrs,
+                                    const mxnet::ShapeVector& in_shapes,
+                                    const mxnet::ShapeVector& out_shapes) {
+  const mxnet::TShape& wshape = in_shapes[fullc::kWeight];
+  return 2 * out_shapes[fullc::kOut].Size() * wshape[wshape.ndim() - 1];
+}
+
 struct FullyConnectedGrad {
   const char* op_name;
   std::vector<nnvm::NodeEntry> operator()(const nnvm::ObjectPtr& n,
@@ -313,6 +321,7 @@ If ``no_bias`` is set to be true, then the ``bias`` term is ignored.
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<mxnet::FInferShape>("FInferShape", FullyConnectedShape)
     .set_attr<nnvm::FInferType>("FInferType", FullyConnectedType)
+    .set_attr<FComputeCost>("FComputeCost", FullyConnectedFlops)
     .set_attr<FCompute>("FCompute<cpu>", FullyConnectedCompute<cpu>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", FullyConnectedComputeExCPU)
     .set_attr<nnvm::FGradient>("FGradient", FullyConnectedGrad{"_backward_FullyConnected"})
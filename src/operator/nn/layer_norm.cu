@@ -21,7 +21,9 @@
  * \file layer_norm.cu
  * \brief Implements Ba et. al, Layer Normalization (https://arxiv.org/abs/1607.06450).
  */
+#include <mxnet/random_generator.h>
 #include "./layer_norm-inl.h"
+#include "./add_dropout_layer_norm-inl.h"
 
 using namespace mshadow::cuda;
 
@@ -284,6 +286,60 @@ __device__ __forceinline__ void BlockWelfordOnlineSum<float, mshadow::half::half
   }
 }
 
+/* Merge the (mean, sigma2, count) of all the threads of a block with the Chan's parallel algorithm.
+ * Every thread gets the merged mean and sigma2, the sum of the squared deviations.
+ *  It's launched with (blockDim.x, blockDim.y) = (WARP_SIZE, blockDim.y), and needs the shared
+ *  memory of LayerNormFusedForwardKernelContig when blockDim.y > 1.
+ */
+template <typename AType, typename IType>
+__device__ __forceinline__ void BlockWelfordAllReduce(char* buf,
+                                                      AType& mean,     // NOLINT
+                                                      AType& sigma2,   // NOLINT
+                                                      IType& count) {  // NOLINT
+  // Merge the mean/sigma2 within a warp
+  // Use the Chan's Parallel Algorithm to merge all (mean, sigma2, counts)
+  // within a warp of threads.
+  // After the loop, every thread of the warp stores the result of
+  // the aggregated (mean, sigma2, counts).
+  for (int mask = blockDim.x / 2; mask > 0; mask >>= 1) {
+    AType meanB   = warp_shfl_xor(mean, mask);
+    AType sigma2B = warp_shfl_xor(sigma2, mask);
+    IType countB  = warp_shfl_xor(count, mask);
+    ChanMergePartition(meanB, sigma2B, countB, mean, sigma2, count);
+  }
+  if (blockDim.y > 1) {
+    // Inter-warp reduction. Copy the upper-half of the warps to shared memory
+    // and merge with the lower-half warp
+    AType* mean_buf   = reinterpret_cast<AType*>(buf);
+    AType* sigma2_buf = reinterpret_cast<AType*>(buf + sizeof(AType) * blockDim.y / 2 * blockDim.x);
+    IType* count_buf  = reinterpret_cast<IType*>(buf + sizeof(AType) * blockDim.y * blockDim.x);
+    for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
+      if (threadIdx.y >= offset && threadIdx.y < 2 * offset) {
+        const int idx   = (threadIdx.y - offset) * blockDim.x + threadIdx.x;
+        mean_buf[idx]   = mean;
+        sigma2_buf[idx] = sigma2;
+        count_buf[idx]  = count;
+      }
+      __syncthreads();
+      if (threadIdx.y < offset) {
+        const int idx = threadIdx.y * blockDim.x + threadIdx.x;
+        ChanMergePartition(mean_buf[idx], sigma2_buf[idx], count_buf[idx], mean, sigma2, count);
+      }
+      __syncthreads();
+    }
+    // Broadcast the result to all threads
+    if (threadIdx.y == 0) {
+      mean_buf[threadIdx.x]   = mean;
+      sigma2_buf[threadIdx.x] = sigma2;
+    }
+    __syncthreads();
+    mean   = mean_buf[threadIdx.x];
+    sigma2 = sigma2_buf[threadIdx.x];
+    // the buffer may be reused by the caller
+    __syncthreads();
+  }
+}
+
 /* Fused CUDA kernel for the forward pass of layer normalization.
  * It computes the LayerNorm when axis=-1, i.e., contiguous reduction scenario.
  * Shape of the input tensors:
@@ -318,50 +374,8 @@ __global__ void LayerNormFusedForwardKernelContig(const int nbatch,
     extern __shared__ char buf[];  // Shared memory
     const DType* col_vals = in_data + bid * nchannel;
     BlockWelfordOnlineSum(col_vals, nchannel, mean, sigma2, count);
-
-    // Merge the mean/sigma2 within a warp
-    // Use the Chan's Parallel Algorithm to merge all (mean, sigma2, counts)
-    // within a warp of threads.
-    // After calling the function, threadIdx.x == 0 will store the result of
-    // the aggregated (mean, sigma2, counts).
-    for (int mask = blockDim.x / 2; mask > 0; mask >>= 1) {
-      AType meanB   = warp_shfl_xor(mean, mask);
-      AType sigma2B = warp_shfl_xor(sigma2, mask);
-      IType countB  = warp_shfl_xor(count, mask);
-      ChanMergePartition(meanB, sigma2B, countB, mean, sigma2, count);
-    }
-    if (blockDim.y > 1) {
-      // Inter-warp reduction. Copy the upper-half of the warps to shared memory
-      // and merge with the lower-half warp
-      AType* mean_buf = reinterpret_cast<AType*>(buf);
-      AType* sigma2_buf =
-          reinterpret_cast<AType*>(buf + sizeof(AType) * blockDim.y / 2 * blockDim.x);
-      IType* count_buf = reinterpret_cast<IType*>(buf + sizeof(AType) * blockDim.y * blockDim.x);
-      for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
-        if (threadIdx.y >= offset && threadIdx.y < 2 * offset) {
-          const int idx   = (threadIdx.y - offset) * blockDim.x + threadIdx.x;
-          mean_buf[idx]   = mean;
-          sigma2_buf[idx] = sigma2;
-          count_buf[idx]  = count;
-        }
-        __syncthreads();
-        if (threadIdx.y < offset) {
-          const int idx = threadIdx.y * blockDim.x + threadIdx.x;
-          ChanMergePartition(mean_buf[idx], sigma2_buf[idx], count_buf[idx], mean, sigma2, count);
-        }
-        __syncthreads();
-      }
-      // Broadcast the result to all threads
-      if (threadIdx.y == 0) {
-        mean_buf[threadIdx.x]   = mean;
-        sigma2_buf[threadIdx.x] = sigma2;
-      }
-      __syncthreads();
-      mean   = mean_buf[threadIdx.x];
-      sigma2 = sigma2_buf[threadIdx.x] / nchannel;
-    } else {
-      sigma2 /= nchannel;
-    }
+    BlockWelfordAllReduce(buf, mean, sigma2, count);
+    sigma2 /= nchannel;
     // Calculate the out_data: gamma * (x - mean) / sqrt(var + eps) + beta
     AType std_eps      = sqrt(sigma2 + eps);
     AType invstd_eps   = DType(1.0) / std_eps;
@@ -741,45 +755,25 @@ void GetGammaBetaGradKernelParams(const int nbatch,
   CheckLaunchParam(*gb_grid_dim, *gb_block_dim);
 }
 
-template <bool safe_acc = false>
-void LayerNormGradGPUContig(const LayerNormParam param,
-                            const OpContext& ctx,
-                            const std::vector<TBlob>& inputs,
-                            const std::vector<OpReqType>& req,
-                            const std::vector<TBlob>& outputs) {
+/* Calculate the gradient of gamma and beta of the LayerNorm of in_data over its last axis,
+ *  with the kernels LayerNormFusedBackwardKernel_PartGammaBeta and
+ *  LayerNormFusedBackwardKernel_GammaBeta. It uses the temporary space of ctx.requested[0].
+ */
+template <bool safe_acc>
+void LayerNormGammaBetaGradGPU(const OpContext& ctx,
+                               const TBlob& in_data,
+                               const TBlob& out_grad,
+                               const TBlob& mean_data,
+                               const TBlob& std_data,
+                               const int gamma_grad_req,
+                               const int beta_grad_req,
+                               const TBlob& gamma_grad,
+                               const TBlob& beta_grad) {
   using namespace mshadow;
-#if MXNET_USE_ONEDNN == 1
-  CHECK_EQ(inputs.size(), 6U);  // additional beta tensor
-#else
-  CHECK_EQ(inputs.size(), 5U);
-#endif
-  const TBlob out_grad   = inputs[0];
-  const TBlob in_data    = inputs[1];
-  const TBlob gamma      = inputs[2];
-  const TBlob mean_data  = inputs[3];
-  const TBlob std_data   = inputs[4];
-  const TBlob data_grad  = outputs[0];
-  const TBlob gamma_grad = outputs[1];
-  const TBlob beta_grad  = outputs[2];
-
-  // Make sure the inputs are contiguous
-  CHECK_EQ(out_grad.CheckContiguous(), true);
-  CHECK_EQ(in_data.CheckContiguous(), true);
-  CHECK_EQ(gamma.CheckContiguous(), true);
-  CHECK_EQ(mean_data.CheckContiguous(), true);
-  CHECK_EQ(std_data.CheckContiguous(), true);
-  int nbatch         = in_data.shape_.ProdShape(0, in_data.ndim() - 1);
-  int nchannel       = in_data.shape_[in_data.ndim() - 1];
-  int data_grad_req  = req[0];
-  int gamma_grad_req = req[1];
-  int beta_grad_req  = req[2];
-  CHECK_NE(data_grad_req, kWriteInplace);
-  CHECK_NE(gamma_grad_req, kWriteInplace);
-  CHECK_NE(beta_grad_req, kWriteInplace);
+  const int nbatch    = in_data.shape_.ProdShape(0, in_data.ndim() - 1);
+  const int nchannel  = in_data.shape_[in_data.ndim() - 1];
   Stream<gpu>* s      = ctx.get_stream<gpu>();
   cudaStream_t stream = Stream<gpu>::GetStream(s);
-
-  // Calculate the gradient for gamma/beta
   CHECK_EQ(gamma_grad.CheckContiguous(), true);
   CHECK_EQ(beta_grad.CheckContiguous(), true);
   dim3 part_grad_block_dim, part_grad_grid_dim, gb_block_dim, gb_grid_dim;
@@ -856,6 +850,57 @@ void LayerNormGradGPUContig(const LayerNormParam param,
     MSHADOW_CUDA_POST_KERNEL_CHECK(LayerNormFusedBackwardKernel_GammaBeta);
   }
 
+}
+
+template <bool safe_acc = false>
+void LayerNormGradGPUContig(const LayerNormParam param,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+#if MXNET_USE_ONEDNN == 1
+  CHECK_EQ(inputs.size(), 6U);  // additional beta tensor
+#else
+  CHECK_EQ(inputs.size(), 5U);
+#endif
+  const TBlob out_grad   = inputs[0];
+  const TBlob in_data    = inputs[1];
+  const TBlob gamma      = inputs[2];
+  const TBlob mean_data  = inputs[3];
+  const TBlob std_data   = inputs[4];
+  const TBlob data_grad  = outputs[0];
+  const TBlob gamma_grad = outputs[1];
+  const TBlob beta_grad  = outputs[2];
+
+  // Make sure the inputs are contiguous
+  CHECK_EQ(out_grad.CheckContiguous(), true);
+  CHECK_EQ(in_data.CheckContiguous(), true);
+  CHECK_EQ(gamma.CheckContiguous(), true);
+  CHECK_EQ(mean_data.CheckContiguous(), true);
+  CHECK_EQ(std_data.CheckContiguous(), true);
+  int nbatch         = in_data.shape_.ProdShape(0, in_data.ndim() - 1);
+  int nchannel       = in_data.shape_[in_data.ndim() - 1];
+  int data_grad_req  = req[0];
+  int gamma_grad_req = req[1];
+  int beta_grad_req  = req[2];
+  CHECK_NE(data_grad_req, kWriteInplace);
+  CHECK_NE(gamma_grad_req, kWriteInplace);
+  CHECK_NE(beta_grad_req, kWriteInplace);
+  Stream<gpu>* s      = ctx.get_stream<gpu>();
+  cudaStream_t stream = Stream<gpu>::GetStream(s);
+
+  // Calculate the gradient for gamma/beta
+  LayerNormGammaBetaGradGPU<safe_acc>(ctx,
+                                      in_data,
+                                      out_grad,
+                                      mean_data,
+                                      std_data,
+                                      gamma_grad_req,
+                                      beta_grad_req,
+                                      gamma_grad,
+                                      beta_grad);
+
   // Calculate the gradient for data
   CHECK_EQ(data_grad.CheckContiguous(), true);
   int ngrid_x = (nbatch > kMaxGridDim) ? (nbatch + kBaseGridNum - 1) / kBaseGridNum : nbatch;
@@ -928,10 +973,373 @@ void LayerNormGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
   return LayerNormGradComputeGeneral<gpu>(attrs, ctx, inputs, req, outputs);
 }
 
+/* One row of AddDropoutLayerNormFusedForwardKernel. Each thread adds the residual to its values
+ * of data, dropped out when rand is given, and accumulates the sum into its Welford triplet as
+ * it writes it. The sum is then normalized from the values the thread has written itself.
+ */
+template <typename AType, typename DType, typename IType, typename RandImpl>
+__device__ __forceinline__ void AddDropoutLayerNormRow(char* buf,
+                                                       const int nchannel,
+                                                       const AType eps,
+                                                       const float pkeep,
+                                                       RandImpl* rand,
+                                                       const DType* __restrict__ data,
+                                                       const DType* __restrict__ residual,
+                                                       const DType* __restrict__ gamma,
+                                                       const DType* __restrict__ beta,
+                                                       DType* __restrict__ out,
+                                                       DType* __restrict__ sum,
+                                                       DType* __restrict__ mask,
+                                                       DType* __restrict__ mean_data,
+                                                       DType* __restrict__ std_data) {
+  const int tid     = threadIdx.y * blockDim.x + threadIdx.x;
+  const int nthread = blockDim.x * blockDim.y;
+  IType count       = 0;
+  AType mean        = 0;
+  AType sigma2      = 0;
+  for (int i = tid; i < nchannel; i += nthread) {
+    AType val = static_cast<AType>(data[i]);
+    if (rand != nullptr) {
+      const DType keep = rand->uniform() < pkeep ? DType(1.0f / pkeep) : DType(0);
+      mask[i]          = keep;
+      val *= static_cast<AType>(keep);
+    }
+    sum[i] = static_cast<DType>(val + static_cast<AType>(residual[i]));
+    StepWelfordOnlineSum(static_cast<AType>(sum[i]), mean, sigma2, count);
+  }
+  BlockWelfordAllReduce(buf, mean, sigma2, count);
+  sigma2 /= nchannel;
+  AType std_eps    = sqrt(sigma2 + eps);
+  AType invstd_eps = AType(1) / std_eps;
+  for (int i = tid; i < nchannel; i += nthread) {
+    out[i] = static_cast<DType>((static_cast<AType>(sum[i]) - mean) * invstd_eps *
+                                    static_cast<AType>(gamma[i]) +
+                                static_cast<AType>(beta[i]));
+  }
+  if (tid == 0) {
+    *mean_data = static_cast<DType>(mean);
+    *std_data  = static_cast<DType>(std_eps);
+  }
+}
+
+/* Fused CUDA kernel for the forward pass of _contrib_add_dropout_layer_norm, one block per row
+ * of nchannel values at a time. With dropout, each thread draws from its own random state, so
+ * the grid must not have more threads than RandGenerator<gpu>::kNumRandomStates.
+ * The launch and the shared memory are those of LayerNormFusedForwardKernelContig.
+ */
+template <bool dropping, typename AType, typename DType, typename IType>
+__global__ void AddDropoutLayerNormFusedForwardKernel(
+    const int nbatch,
+    const int nchannel,
+    const AType eps,
+    const float pkeep,
+    common::random::RandGenerator<gpu, float> gen,
+    const DType* __restrict__ data,
+    const DType* __restrict__ residual,
+    const DType* __restrict__ gamma,
+    const DType* __restrict__ beta,
+    DType* __restrict__ out,
+    DType* __restrict__ sum,
+    DType* __restrict__ mask,
+    DType* __restrict__ mean_data,
+    DType* __restrict__ std_data) {
+  extern __shared__ char buf[];  // Shared memory
+  typedef typename common::random::RandGenerator<gpu, float>::Impl RandImpl;
+  if (dropping) {
+    RandImpl rand(&gen, blockIdx.x * blockDim.x * blockDim.y + threadIdx.y * blockDim.x +
+                            threadIdx.x);
+    for (int bid = blockIdx.x; bid < nbatch; bid += gridDim.x) {
+      const index_t offset = static_cast<index_t>(bid) * nchannel;
+      AddDropoutLayerNormRow<AType, DType, IType>(buf,
+                                                  nchannel,
+                                                  eps,
+                                                  pkeep,
+                                                  &rand,
+                                                  data + offset,
+                                                  residual + offset,
+                                                  gamma,
+                                                  beta,
+                                                  out + offset,
+                                                  sum + offset,
+                                                  mask + offset,
+                                                  mean_data + bid,
+                                                  std_data + bid);
+    }
+  } else {
+    for (int bid = blockIdx.x; bid < nbatch; bid += gridDim.x) {
+      const index_t offset = static_cast<index_t>(bid) * nchannel;
+      AddDropoutLayerNormRow<AType, DType, IType>(buf,
+                                                  nchannel,
+                                                  eps,
+                                                  pkeep,
+                                                  static_cast<RandImpl*>(nullptr),
+                                                  data + offset,
+                                                  residual + offset,
+                                                  gamma,
+                                                  beta,
+                                                  out + offset,
+                                                  sum + offset,
+                                                  mask + offset,
+                                                  mean_data + bid,
+                                                  std_data + bid);
+    }
+  }
+}
+
+template <bool safe_acc>
+void AddDropoutLayerNormGPU(const AddDropoutLayerNormParam& param,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace add_dropout_layernorm;
+  using common::random::RandGenerator;
+  const TBlob& data   = inputs[kData];
+  const int nchannel  = data.shape_[data.ndim() - 1];
+  const int nbatch    = data.shape_.ProdShape(0, data.ndim() - 1);
+  const bool dropping = AddDropoutLayerNormIsDropping(param, ctx);
+  int nthread_y;
+  if (nchannel <= 128) {
+    nthread_y = 1;
+  } else if (nchannel <= 512) {
+    nthread_y = 2;
+  } else {
+    nthread_y = 4;
+  }
+  // with dropout, every thread of the grid owns a random state
+  const int max_block = dropping ? RandGenerator<gpu, float>::kNumRandomStates / (32 * nthread_y)
+                                 : kMaxGridDim;
+  const dim3 dimGrid(std::min(nbatch, max_block));
+  const dim3 dimBlock(32, nthread_y);
+  RandGenerator<gpu, float>* gen = ctx.requested[0].get_parallel_random<gpu, float>();
+  cudaStream_t stream            = Stream<gpu>::GetStream(ctx.get_stream<gpu>());
+  MXNET_REAL_ACC_TYPE_SWITCH(data.type_flag_, DType, AccType, {
+    typedef typename std::conditional<safe_acc, AccType, DType>::type AType;
+    int nshared =
+        nthread_y > 1 ? nthread_y * 32 * sizeof(AType) + (nthread_y / 2) * 32 * sizeof(int) : 0;
+    CheckLaunchParam(dimGrid, dimBlock);
+    auto kernel = dropping ? AddDropoutLayerNormFusedForwardKernel<true, AType, DType, int>
+                           : AddDropoutLayerNormFusedForwardKernel<false, AType, DType, int>;
+    kernel<<<dimGrid, dimBlock, nshared, stream>>>(nbatch,
+                                                   nchannel,
+                                                   static_cast<AType>(param.eps),
+                                                   1.0f - param.p,
+                                                   *gen,
+                                                   data.dptr<DType>(),
+                                                   inputs[kResidual].dptr<DType>(),
+                                                   inputs[kGamma].dptr<DType>(),
+                                                   inputs[kBeta].dptr<DType>(),
+                                                   outputs[kOut].dptr<DType>(),
+                                                   outputs[kSum].dptr<DType>(),
+                                                   outputs[kMask].dptr<DType>(),
+                                                   outputs[kMean].dptr<DType>(),
+                                                   outputs[kStd].dptr<DType>());
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(AddDropoutLayerNormFusedForwardKernel);
+}
+
+template <>
+void AddDropoutLayerNormCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                     const OpContext& ctx,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  const AddDropoutLayerNormParam& param = nnvm::get<AddDropoutLayerNormParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), 4U);
+  CHECK_EQ(outputs.size(), 5U);
+  if (req[add_dropout_layernorm::kOut] == kNullOp || inputs[0].Size() == 0)
+    return;
+  CHECK_NE(req[add_dropout_layernorm::kOut], kAddTo);
+  if (dmlc::GetEnv("MXNET_SAFE_ACCUMULATION", true)) {
+    AddDropoutLayerNormGPU<true>(param, ctx, inputs, req, outputs);
+  } else {
+    AddDropoutLayerNormGPU<false>(param, ctx, inputs, req, outputs);
+  }
+}
+
+/* Fused CUDA kernel for the gradients of data and residual of _contrib_add_dropout_layer_norm.
+ * The gradient of the sum is that of LayerNormFusedBackwardKernel_Data, plus sum_grad when given,
+ * and it is written to residual_grad and, multiplied by the mask when given, to data_grad.
+ * The launch and the shared memory are those of LayerNormFusedBackwardKernel_Data.
+ */
+template <typename AType, typename DType>
+__global__ void AddDropoutLayerNormFusedBackwardKernel_Data(const int nbatch,
+                                                            const int nchannel,
+                                                            const DType* __restrict__ sum,
+                                                            const DType* __restrict__ out_grad,
+                                                            const DType* __restrict__ sum_grad,
+                                                            const DType* __restrict__ mask,
+                                                            const DType* __restrict__ mean_data,
+                                                            const DType* __restrict__ std_data,
+                                                            const DType* __restrict__ gamma,
+                                                            const int residual_grad_req,
+                                                            const int data_grad_req,
+                                                            DType* residual_grad,
+                                                            DType* data_grad) {
+  int bid           = blockIdx.x + blockIdx.y * gridDim.x;
+  const int nthread = blockDim.x * blockDim.y;
+  if (bid < nbatch) {
+    // Shared memory with size blockDim.y * blockDim.x * sizeof(AType)
+    extern __shared__ char buf[];
+    const int tid     = threadIdx.x + threadIdx.y * blockDim.x;
+    const index_t row = static_cast<index_t>(bid) * nchannel;
+    AType sum_val0    = 0;  // Stores mean(out_grad * gamma, axis=-1)
+    AType sum_val1    = 0;  // Stores mean(out_grad * gamma * (x - mean) / std, axis=-1)
+    AType mean        = static_cast<AType>(mean_data[bid]);
+    AType invstd_eps  = AType(1) / static_cast<AType>(std_data[bid]);
+    for (int l = tid; l < nchannel; l += nthread) {
+      AType ele_og    = static_cast<AType>(out_grad[row + l]);
+      AType ele_xhat  = (static_cast<AType>(sum[row + l]) - mean) * invstd_eps;
+      AType ele_gamma = static_cast<AType>(gamma[l]);
+      sum_val0 += ele_og * ele_gamma;
+      sum_val1 += ele_og * ele_gamma * ele_xhat;
+    }
+    // Intra-warp reduction (all-reduce)
+    for (int mask = blockDim.x / 2; mask > 0; mask >>= 1) {
+      sum_val0 += warp_shfl_xor(sum_val0, mask);
+      sum_val1 += warp_shfl_xor(sum_val1, mask);
+    }
+    // Inter-warp reduction (all-reduce)
+    if (blockDim.y > 1) {
+      AType* sum_val0_buf = reinterpret_cast<AType*>(buf);
+      AType* sum_val1_buf =
+          reinterpret_cast<AType*>(buf + blockDim.y / 2 * blockDim.x * sizeof(AType));
+      for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
+        if (threadIdx.y >= offset && threadIdx.y < 2 * offset) {
+          const int idx     = (threadIdx.y - offset) * blockDim.x + threadIdx.x;
+          sum_val0_buf[idx] = sum_val0;
+          sum_val1_buf[idx] = sum_val1;
+        }
+        __syncthreads();
+        if (threadIdx.y < offset) {
+          const int idx = threadIdx.y * blockDim.x + threadIdx.x;
+          sum_val0 += sum_val0_buf[idx];
+          sum_val1 += sum_val1_buf[idx];
+        }
+        __syncthreads();
+      }
+      if (threadIdx.y == 0) {
+        sum_val0_buf[threadIdx.x] = sum_val0;
+        sum_val1_buf[threadIdx.x] = sum_val1;
+      }
+      __syncthreads();
+      sum_val0 = sum_val0_buf[threadIdx.x];
+      sum_val1 = sum_val1_buf[threadIdx.x];
+    }
+    sum_val0 /= nchannel;
+    sum_val1 /= nchannel;
+    for (int l = tid; l < nchannel; l += nthread) {
+      AType ele_og   = static_cast<AType>(out_grad[row + l]);
+      AType ele_xhat = (static_cast<AType>(sum[row + l]) - mean) * invstd_eps;
+      AType grad =
+          (ele_og * static_cast<AType>(gamma[l]) - sum_val0 - ele_xhat * sum_val1) * invstd_eps;
+      if (sum_grad != nullptr)
+        grad += static_cast<AType>(sum_grad[row + l]);
+      KERNEL_ASSIGN(residual_grad[row + l], residual_grad_req, static_cast<DType>(grad));
+      if (mask != nullptr)
+        grad *= static_cast<AType>(mask[row + l]);
+      KERNEL_ASSIGN(data_grad[row + l], data_grad_req, static_cast<DType>(grad));
+    }
+  }
+}
+
+template <bool safe_acc>
+void AddDropoutLayerNormGradGPU(const AddDropoutLayerNormParam& param,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace add_dropout_layernorm;
+  const int in_sum       = AddDropoutLayerNormBwdSum(param);
+  const TBlob& out_grad  = inputs[0];
+  const TBlob& sum       = inputs[in_sum];
+  const TBlob& mask      = inputs[in_sum + 1];
+  const TBlob& mean_data = inputs[in_sum + 2];
+  const TBlob& std_data  = inputs[in_sum + 3];
+  const TBlob& gamma     = inputs[in_sum + 4];
+  const int nbatch       = sum.shape_.ProdShape(0, sum.ndim() - 1);
+  const int nchannel     = sum.shape_[sum.ndim() - 1];
+  const bool dropping    = AddDropoutLayerNormIsDropping(param, ctx);
+  cudaStream_t stream    = Stream<gpu>::GetStream(ctx.get_stream<gpu>());
+
+  LayerNormGammaBetaGradGPU<safe_acc>(ctx,
+                                      sum,
+                                      out_grad,
+                                      mean_data,
+                                      std_data,
+                                      req[kBwdGammaGrad],
+                                      req[kBwdBetaGrad],
+                                      outputs[kBwdGammaGrad],
+                                      outputs[kBwdBetaGrad]);
+  if (req[kBwdDataGrad] == kNullOp && req[kBwdResidualGrad] == kNullOp)
+    return;
+  int ngrid_x = (nbatch > kMaxGridDim) ? (nbatch + kBaseGridNum - 1) / kBaseGridNum : nbatch;
+  int ngrid_y = (nbatch > kMaxGridDim) ? kBaseGridNum : 1;
+  const dim3 data_grid_dim(ngrid_x, ngrid_y);
+  int nthread_y;
+  if (nchannel <= 32) {
+    nthread_y = 1;
+  } else if (nchannel <= 128) {
+    nthread_y = 2;
+  } else if (nchannel <= 512) {
+    nthread_y = 4;
+  } else {
+    nthread_y = 8;
+  }
+  const dim3 data_block_dim(32, nthread_y);
+  MXNET_REAL_ACC_TYPE_SWITCH(sum.type_flag_, DType, AccType, {
+    typedef typename std::conditional<safe_acc, AccType, DType>::type AType;
+    int nshared = data_block_dim.y > 1 ? data_block_dim.y * data_block_dim.x * sizeof(AType) : 0;
+    CheckLaunchParam(data_grid_dim, data_block_dim);
+    AddDropoutLayerNormFusedBackwardKernel_Data<AType>
+        <<<data_grid_dim, data_block_dim, nshared, stream>>>(
+            nbatch,
+            nchannel,
+            sum.dptr<DType>(),
+            out_grad.dptr<DType>(),
+            param.output_sum ? inputs[1].dptr<DType>() : nullptr,
+            dropping ? mask.dptr<DType>() : nullptr,
+            mean_data.dptr<DType>(),
+            std_data.dptr<DType>(),
+            gamma.dptr<DType>(),
+            req[kBwdResidualGrad],
+            req[kBwdDataGrad],
+            outputs[kBwdResidualGrad].dptr<DType>(),
+            outputs[kBwdDataGrad].dptr<DType>());
+  });
+  MSHADOW_CUDA_POST_KERNEL_CHECK(AddDropoutLayerNormFusedBackwardKernel_Data);
+}
+
+template <>
+void AddDropoutLayerNormGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                         const OpContext& ctx,
+                                         const std::vector<TBlob>& inputs,
+                                         const std::vector<OpReqType>& req,
+                                         const std::vector<TBlob>& outputs) {
+  const AddDropoutLayerNormParam& param = nnvm::get<AddDropoutLayerNormParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), AddDropoutLayerNormBwdSum(param) + 5U);
+  CHECK_EQ(outputs.size(), 4U);
+  if (inputs[0].Size() == 0)
+    return;
+  if (dmlc::GetEnv("MXNET_SAFE_ACCUMULATION", true)) {
+    AddDropoutLayerNormGradGPU<true>(param, ctx, inputs, req, outputs);
+  } else {
+    AddDropoutLayerNormGradGPU<false>(param, ctx, inputs, req, outputs);
+  }
+}
+
 NNVM_REGISTER_OP(LayerNorm).set_attr<FCompute>("FCompute<gpu>", LayerNormCompute<gpu>);
 
 NNVM_REGISTER_OP(_backward_LayerNorm)
     .set_attr<FCompute>("FCompute<gpu>", LayerNormGradCompute<gpu>);
 
+NNVM_REGISTER_OP(_contrib_add_dropout_layer_norm)
+    .set_attr<FCompute>("FCompute<gpu>", AddDropoutLayerNormCompute<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_add_dropout_layer_norm)
+    .set_attr<FCompute>("FCompute<gpu>", AddDropoutLayerNormGradCompute<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
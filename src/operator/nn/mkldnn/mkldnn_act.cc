@@ -132,9 +132,9 @@ MKLDNNActForward& GetActForward(const MKLDNNActParam& param,
                                 const NDArray& in_data,
                                 const mkldnn::memory& in_mem) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
+  static thread_local MKLDNNCache<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNActSignature, MKLDNNActForward, OpHash> fwds;
 #endif
   MKLDNNActSignature key(param);
   key.AddSign(ctx.is_train);
@@ -219,9 +219,9 @@ static inline MKLDNNActBackward& GetActBackward(const MKLDNNActParam& param,
                                                 const NDArray& out_grad,
                                                 const mkldnn::memory& in_mem) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
+  static thread_local MKLDNNCache<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNActSignature, MKLDNNActBackward, OpHash> bwds;
 #endif
   MKLDNNActSignature key(param);
   key.AddSign(in_data);
@@ -42,6 +42,8 @@
 #include "mxnet/op_attr_types.h"
 #include "mxnet/resource.h"
 
+#include "mkldnn_cache-inl.h"
+
 #define MKLDNN_REAL_TYPE_SWITCH(type, DType, ...) \
   switch (type) {                                 \
     case mshadow::kFloat32: {                     \
@@ -151,24 +153,6 @@ static inline bool MKLDNNEnvSet() {
   return is_mkldnn_enabled;
 }
 
-static inline int GetMKLDNNCacheSize() {
-  static int mkldnn_cache_size = dmlc::GetEnv("MXNET_ONEDNN_CACHE_NUM", -1);
-  return mkldnn_cache_size;
-}
-
-// TODO(alex): (MXNET-1075) Will remove env variable and calculate cache size during runtime
-template <typename S, typename I, typename H>
-static typename std::unordered_map<S, I, H>::iterator AddToCache(std::unordered_map<S, I, H>* cache,
-                                                                 const S& key,
-                                                                 const I& item) {
-  int mkldnn_cache_size = GetMKLDNNCacheSize();
-  if (mkldnn_cache_size != -1 && static_cast<int>(cache->size()) > mkldnn_cache_size)
-    cache->erase(cache->begin());
-  auto ins_return = cache->insert(std::pair<S, I>(key, item));
-  CHECK(ins_return.second);
-  return ins_return.first;
-}
-
 /*
  * This is to align address to a certain alignment.
  */
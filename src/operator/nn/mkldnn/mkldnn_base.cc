@@ -38,6 +38,11 @@ MKLDNNStream* MKLDNNStream::Get() {
   return &stream;
 }
 
+MKLDNNCacheStats* MKLDNNCacheStats::Get() {
+  static MKLDNNCacheStats stats;
+  return &stats;
+}
+
 void* AlignMem(void* mem, size_t size, size_t alignment, size_t* space) {
   if (size > *space)
     return nullptr;
@@ -48,7 +48,7 @@ void MKLDNNBatchDotForward(const nnvm::NodeAttrs& attrs,
 MKLDNNBatchDotFwd& MKLDNNBatchDotFwd::GetCached(const DotParam& param,
                                                 const std::vector<NDArray>& inputs,
                                                 const std::vector<NDArray>& outputs) {
-  using batch_dot_fwd_map = std::unordered_map<BatchDotSignature, MKLDNNBatchDotFwd, OpHash>;
+  using batch_dot_fwd_map = MKLDNNCache<BatchDotSignature, MKLDNNBatchDotFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local batch_dot_fwd_map fwds;
 #else
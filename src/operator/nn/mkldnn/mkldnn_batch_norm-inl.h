@@ -128,9 +128,9 @@ static MKLDNNBNForward& GetBNForward(const BatchNormParam& param,
                                      const mkldnn::memory* data_mem,
                                      mkldnn::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
+  static thread_local MKLDNNCache<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNBNSignature, MKLDNNBNForward, OpHash> fwds;
 #endif
   MKLDNNBNSignature key(param);
   key.AddSign(ctx.is_train);
@@ -300,9 +300,9 @@ static MKLDNNBNBackward& GetBNBackward(const BatchNormParam& param,
                                        const mkldnn::memory& diff_mem,
                                        mkldnn::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
+  static thread_local MKLDNNCache<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNBNSignature, MKLDNNBNBackward, OpHash> bwds;
 #endif
   MKLDNNBNSignature key(param);
   key.AddSign(in_data);
@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mkldnn_cache-inl.h
+ * \brief Least recently used caches of the oneDNN primitives of the operators
+ */
+
+#ifndef MXNET_OPERATOR_NN_MKLDNN_MKLDNN_CACHE_INL_H_
+#define MXNET_OPERATOR_NN_MKLDNN_MKLDNN_CACHE_INL_H_
+
+#if MXNET_USE_ONEDNN == 1
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "mkldnn.hpp"
+
+namespace mxnet {
+
+static inline int GetMKLDNNCacheSize() {
+  static int mkldnn_cache_size = dmlc::GetEnv("MXNET_ONEDNN_CACHE_NUM", -1);
+  return mkldnn_cache_size;
+}
+
+/*! \return the bytes the primitive caches of all the threads may hold, or -1 if unbounded */
+static inline int64_t GetMKLDNNCacheBytes() {
+  static int64_t mkldnn_cache_mb = dmlc::GetEnv("MXNET_ONEDNN_CACHE_MB", int64_t(-1));
+  return mkldnn_cache_mb < 0 ? -1 : mkldnn_cache_mb << 20;
+}
+
+/*!
+ * \brief Lookups and evictions of the primitive caches of all the threads, with the number
+ *  and the estimated bytes of their entries
+ */
+struct MKLDNNCacheStats {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> evictions{0};
+  std::atomic<int64_t> entries{0};
+  std::atomic<int64_t> bytes{0};
+  /*! \brief get the global instance */
+  static MKLDNNCacheStats* Get();
+};
+
+namespace mkldnn_cache {
+template <typename T, typename = void>
+struct HasGetPd : std::false_type {};
+template <typename T>
+struct HasGetPd<T, std::void_t<decltype(std::declval<const T&>().GetPd())>> : std::true_type {};
+template <typename T, typename = void>
+struct HasFwdPd : std::false_type {};
+template <typename T>
+struct HasFwdPd<T, std::void_t<decltype(std::declval<T&>().fwd_pd)>> : std::true_type {};
+
+/*! \brief the memory held by a primitive and its scratchpad */
+template <typename PD>
+size_t PrimitiveBytes(const PD& pd) {
+  const int64_t held = pd.query_s64(mkldnn::query::memory_consumption_s64);
+  return (held > 0 ? held : 0) + pd.scratchpad_desc().get_size();
+}
+template <typename PD>
+size_t PrimitiveBytes(const std::shared_ptr<PD>& pd) {
+  return pd ? PrimitiveBytes(*pd) : 0;
+}
+
+/*! \brief estimated bytes of a cached item, from its primitive descriptor when it has one */
+template <typename I>
+size_t EntryBytes(I* item) {
+  if constexpr (HasGetPd<I>::value) {
+    return sizeof(I) + PrimitiveBytes(item->GetPd());
+  } else if constexpr (HasFwdPd<I>::value) {
+    return sizeof(I) + PrimitiveBytes(item->fwd_pd);
+  } else {
+    return sizeof(I);
+  }
+}
+}  // namespace mkldnn_cache
+
+/*!
+ * \brief Least recently used cache of the primitives of an operator, owned by one thread.
+ *  Holds at most MXNET_ONEDNN_CACHE_NUM entries, and evicts its entries while the caches of
+ *  all the threads hold more than MXNET_ONEDNN_CACHE_MB. The iterators of the entries stay
+ *  valid until the entries are evicted.
+ */
+template <typename S, typename I, typename H>
+class MKLDNNCache {
+ public:
+  using value_type = std::pair<const S, I>;
+  using iterator   = typename std::list<value_type>::iterator;
+
+  MKLDNNCache() = default;
+  MKLDNNCache(const MKLDNNCache&) = delete;
+  MKLDNNCache& operator=(const MKLDNNCache&) = delete;
+  ~MKLDNNCache() {
+    while (!entries_.empty())
+      Evict(false);
+  }
+
+  /*! \brief find the entry of key, which becomes the most recently used */
+  iterator find(const S& key) {
+    MKLDNNCacheStats* stats = MKLDNNCacheStats::Get();
+    auto it                 = index_.find(key);
+    if (it == index_.end()) {
+      stats->misses.fetch_add(1, std::memory_order_relaxed);
+      return entries_.end();
+    }
+    stats->hits.fetch_add(1, std::memory_order_relaxed);
+    entries_.splice(entries_.begin(), entries_, it->second.first);
+    return it->second.first;
+  }
+
+  iterator end() {
+    return entries_.end();
+  }
+
+  size_t size() const {
+    return index_.size();
+  }
+
+  /*! \brief add the entry of key, evicting the least recently used entries over the limits */
+  iterator insert(const S& key, const I& item) {
+    CHECK(index_.find(key) == index_.end());
+    MKLDNNCacheStats* stats = MKLDNNCacheStats::Get();
+    const int max_entries   = GetMKLDNNCacheSize();
+    const int64_t max_bytes = GetMKLDNNCacheBytes();
+    while (!entries_.empty() &&
+           ((max_entries != -1 && static_cast<int>(entries_.size()) >= max_entries) ||
+            (max_bytes != -1 && stats->bytes.load(std::memory_order_relaxed) > max_bytes))) {
+      Evict(true);
+    }
+    entries_.emplace_front(key, item);
+    const size_t bytes = mkldnn_cache::EntryBytes(&entries_.front().second);
+    index_.emplace(key, std::make_pair(entries_.begin(), bytes));
+    stats->entries.fetch_add(1, std::memory_order_relaxed);
+    stats->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    return entries_.begin();
+  }
+
+ private:
+  /*! \brief remove the least recently used entry */
+  void Evict(bool count) {
+    MKLDNNCacheStats* stats = MKLDNNCacheStats::Get();
+    auto it                 = index_.find(entries_.back().first);
+    stats->entries.fetch_sub(1, std::memory_order_relaxed);
+    stats->bytes.fetch_sub(it->second.second, std::memory_order_relaxed);
+    if (count)
+      stats->evictions.fetch_add(1, std::memory_order_relaxed);
+    index_.erase(it);
+    entries_.pop_back();
+  }
+
+  /*! \brief entries, the most recently used first */
+  std::list<value_type> entries_;
+  /*! \brief entry and estimated bytes of each key */
+  std::unordered_map<S, std::pair<iterator, size_t>, H> index_;
+};
+
+template <typename S, typename I, typename H>
+static typename MKLDNNCache<S, I, H>::iterator AddToCache(MKLDNNCache<S, I, H>* cache,
+                                                          const S& key,
+                                                          const I& item) {
+  return cache->insert(key, item);
+}
+
+}  // namespace mxnet
+#endif  // MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_NN_MKLDNN_MKLDNN_CACHE_INL_H_
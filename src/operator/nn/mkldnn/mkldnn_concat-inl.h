@@ -55,9 +55,9 @@ static MKLDNNConcatFwd& GetConcatForward(int concat_dim,
                                          const std::vector<NDArray>& in_data,
                                          const std::vector<mkldnn::memory::desc>& data_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
+  static thread_local MKLDNNCache<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<OpSignature, MKLDNNConcatFwd, OpHash> fwds;
 #endif
   OpSignature key;
   key.AddSign(concat_dim);
@@ -39,6 +39,10 @@ DMLC_REGISTER_PARAMETER(MKLDNNConvParam);
 bool SupportMKLDNNConv(const ConvolutionParam& params, const NDArray& input) {
   if (params.kernel.ndim() > 3 || params.kernel.ndim() == 0)
     return false;
+  // channels-last data runs the native kernels
+  if (params.layout.has_value() &&
+      (params.layout.value() == mshadow::kNHWC || params.layout.value() == mshadow::kNDHWC))
+    return false;
   return IsMKLDNNType(input.dtype()) &&
          input.shape().ndim() >= 3 && input.shape().ndim() <= 5;
 }
@@ -443,7 +447,7 @@ MKLDNNConvForward& GetConvFwd(const MKLDNNConvFullParam& param,
                               const NDArray& weight,
                               const NDArray* bias,
                               const NDArray& output) {
-  using conv_fwd_map = std::unordered_map<MKLDNNConvSignature, MKLDNNConvForward, OpHash>;
+  using conv_fwd_map = MKLDNNCache<MKLDNNConvSignature, MKLDNNConvForward, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local conv_fwd_map fwds;
 #else
@@ -558,7 +562,7 @@ static inline MKLDNNConvBackward& GetConvBwd(const MKLDNNConvFullParam& param,
                                              const NDArray& weight,
                                              const NDArray* bias,
                                              const NDArray& output) {
-  using mkldnn_conv_bwd_map = std::unordered_map<MKLDNNConvSignature, MKLDNNConvBackward, OpHash>;
+  using mkldnn_conv_bwd_map = MKLDNNCache<MKLDNNConvSignature, MKLDNNConvBackward, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local mkldnn_conv_bwd_map bwds;
 #else
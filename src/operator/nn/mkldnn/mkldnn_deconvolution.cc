@@ -51,7 +51,7 @@ void MKLDNNDeconvolutionForward(const nnvm::NodeAttrs& attrs,
 
 MKLDNNDeconvFwd& MKLDNNDeconvFwd::GetCached(const DeconvolutionParam& param,
                                             const Tensors& tensors) {
-  using deconv_fwd_map = std::unordered_map<DeconvSignature, MKLDNNDeconvFwd, OpHash>;
+  using deconv_fwd_map = MKLDNNCache<DeconvSignature, MKLDNNDeconvFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local deconv_fwd_map fwds;
 #else
@@ -178,7 +178,7 @@ void MKLDNNDeconvolutionBackward(const nnvm::NodeAttrs& attrs,
 
 MKLDNNDeconvBwd& MKLDNNDeconvBwd::GetCached(const DeconvolutionParam& param,
                                             const ReadTensors& read_tensors) {
-  using deconv_bwd_map = std::unordered_map<DeconvSignature, MKLDNNDeconvBwd, OpHash>;
+  using deconv_bwd_map = MKLDNNCache<DeconvSignature, MKLDNNDeconvBwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local deconv_bwd_map bwds;
 #else
@@ -126,13 +126,11 @@ MKLDNNFullyConnectedForward& GetFCFwd(const FullyConnectedParam& param,
                                       const NDArray* bias,
                                       const mkldnn::memory::desc& out_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::
-      unordered_map<MKLDNNFullyconSignature, MKLDNNFullyConnectedForward, OpHash>
-          fcFwds;
+  static thread_local MKLDNNCache<MKLDNNFullyconSignature, MKLDNNFullyConnectedForward, OpHash>
+      fcFwds;
 #else
-  static MX_THREAD_LOCAL
-      std::unordered_map<MKLDNNFullyconSignature, MKLDNNFullyConnectedForward, OpHash>
-          fcFwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNFullyconSignature, MKLDNNFullyConnectedForward, OpHash>
+      fcFwds;
 #endif
   MKLDNNFullyconSignature key(param);
   key.AddSign(is_train);
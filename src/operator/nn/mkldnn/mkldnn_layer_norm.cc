@@ -62,7 +62,7 @@ void MKLDNNLayerNormForward(const nnvm::NodeAttrs& attrs,
 MKLDNNLayerNormFwd& MKLDNNLayerNormFwd::GetCached(const LayerNormParam& param,
                                                   const OpContext& ctx,
                                                   const NDArray& data) {
-  using layernorm_fwd_map = std::unordered_map<LayerNormSignature, MKLDNNLayerNormFwd, OpHash>;
+  using layernorm_fwd_map = MKLDNNCache<LayerNormSignature, MKLDNNLayerNormFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local layernorm_fwd_map layer_norm_fwds;
 #else
@@ -221,7 +221,7 @@ void MKLDNNLayerNormBwd::Execute(const std::vector<NDArray>& inputs,
 
 MKLDNNLayerNormBwd& MKLDNNLayerNormBwd::GetCached(const LayerNormParam& param,
                                                   const std::vector<NDArray>& inputs) {
-  using layernorm_bwd_map = std::unordered_map<LayerNormSignature, MKLDNNLayerNormBwd, OpHash>;
+  using layernorm_bwd_map = MKLDNNCache<LayerNormSignature, MKLDNNLayerNormBwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local layernorm_bwd_map layer_norm_bwds;
 #else
@@ -261,11 +261,9 @@ MKLDNNPoolingFwd& GetPoolingFwd(const PoolingParam& param,
                                 const NDArray& data,
                                 const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNPoolingSignature, MKLDNNPoolingFwd, OpHash>
-      pooling_fwds;
+  static thread_local MKLDNNCache<MKLDNNPoolingSignature, MKLDNNPoolingFwd, OpHash> pooling_fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNPoolingSignature, MKLDNNPoolingFwd, OpHash>
-      pooling_fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNPoolingSignature, MKLDNNPoolingFwd, OpHash> pooling_fwds;
 #endif
 
   bool with_workspace = is_train && MKLDNNRequireWorkspace(param);
@@ -321,11 +319,9 @@ MKLDNNPoolingBwd& GetPoolingBwd(const PoolingParam& param,
                                 const NDArray& in_grad,
                                 const NDArray& out_grad) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNPoolingSignature, MKLDNNPoolingBwd, OpHash>
-      pooling_bwds;
+  static thread_local MKLDNNCache<MKLDNNPoolingSignature, MKLDNNPoolingBwd, OpHash> pooling_bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNPoolingSignature, MKLDNNPoolingBwd, OpHash>
-      pooling_bwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNPoolingSignature, MKLDNNPoolingBwd, OpHash> pooling_bwds;
 #endif
 
   bool with_workspace = MKLDNNRequireWorkspace(param);
@@ -107,9 +107,9 @@ MKLDNNReshapeFwd& GetReshapeForward(const OpReqType& req,
                                     const NDArray& input,
                                     const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNReshapeSignature, MKLDNNReshapeFwd, OpHash> fwds;
+  static thread_local MKLDNNCache<MKLDNNReshapeSignature, MKLDNNReshapeFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNReshapeSignature, MKLDNNReshapeFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNReshapeSignature, MKLDNNReshapeFwd, OpHash> fwds;
 #endif
   MKLDNNReshapeSignature key;
   key.AddSign(req);
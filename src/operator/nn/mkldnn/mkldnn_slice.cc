@@ -74,9 +74,9 @@ MKLDNNSliceFwd& GetSliceForward(const SliceParam& param,
                                 const NDArray& in_data,
                                 const NDArray& out_data) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
+  static thread_local MKLDNNCache<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNSliceSignature, MKLDNNSliceFwd, OpHash> fwds;
 #endif
   MKLDNNSliceSignature key(param);
   key.AddSign(is_train);
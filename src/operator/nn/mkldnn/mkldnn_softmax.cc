@@ -98,9 +98,9 @@ static MKLDNNSoftmaxFwd& GetSoftmaxFwd(const SoftmaxParam& param,
                                        const NDArray& data,
                                        const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNSoftmaxSignature, MKLDNNSoftmaxFwd, OpHash> fwds;
+  static thread_local MKLDNNCache<MKLDNNSoftmaxSignature, MKLDNNSoftmaxFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNSoftmaxSignature, MKLDNNSoftmaxFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNSoftmaxSignature, MKLDNNSoftmaxFwd, OpHash> fwds;
 #endif
 
   MKLDNNSoftmaxSignature key(param);
@@ -163,9 +163,9 @@ static MKLDNNSoftmaxBwd& GetSoftmaxBwd(const SoftmaxParam& param,
                                        const std::vector<NDArray>& data,
                                        const std::vector<NDArray>& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<MKLDNNSoftmaxSignature, MKLDNNSoftmaxBwd, OpHash> bwds;
+  static thread_local MKLDNNCache<MKLDNNSoftmaxSignature, MKLDNNSoftmaxBwd, OpHash> bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<MKLDNNSoftmaxSignature, MKLDNNSoftmaxBwd, OpHash> bwds;
+  static MX_THREAD_LOCAL MKLDNNCache<MKLDNNSoftmaxSignature, MKLDNNSoftmaxBwd, OpHash> bwds;
 #endif
 
   MKLDNNSoftmaxSignature key(param);
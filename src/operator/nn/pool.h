@@ -65,6 +65,7 @@
 #include "./pool_utils.h"
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
+#include "../../engine/openmp.h"
 
 namespace mxnet {
 namespace op {
@@ -116,49 +117,6 @@ inline void pool_max_1d_ncw_cpu(const DType* in_data,
   }
 }
 
-/*!
- * \brief max pooling cpu function for 1-D images in 'nwc' layout.
- * Do not call this kernel directly. Use the interface pool().
- */
-template <typename DType>
-inline void pool_max_1d_nwc_cpu(const DType* in_data,
-                                const mxnet::TShape& ishape,
-                                const mxnet::TShape& oshape,
-                                const mxnet::TShape& kernel,
-                                const mxnet::TShape& pad,
-                                const mxnet::TShape& stride,
-                                DType* out_data) {
-  using mshadow::red::limits::MinValue;
-  const int width               = ishape[1];
-  const int pooled_width        = oshape[1];
-  const int kernel_w            = kernel[0];
-  const int pad_w               = pad[0];
-  const int stride_w            = stride[0];
-  const int features            = oshape[2];
-  const index_t in_data_offset  = ishape[1] * features;
-  const index_t out_data_offset = oshape[1] * features;
-  std::vector<DType> max_vals(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int pw = 0; pw < pooled_width; ++pw) {
-      int wstart = pw * stride_w - pad_w;
-      int wend   = std::min(wstart + kernel_w, width);
-      wstart     = std::max(wstart, 0);
-      std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
-      for (int w = wstart; w < wend; ++w) {
-        for (index_t c = 0; c < features; ++c) {
-          if (in_data[w * features + c] > max_vals[c]) {
-            max_vals[c] = in_data[w * features + c];
-          }
-        }
-      }
-      for (index_t c = 0; c < features; ++c)
-        out_data[pw * features + c] = max_vals[c];
-    }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
-  }
-}
-
 /*!
  * \brief max pooling cpu function for 2-D images in 'nchw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -208,58 +166,6 @@ inline void pool_max_2d_nchw_cpu(const DType* in_data,
   }
 }
 
-/*!
- * \brief max pooling cpu function for 2-D images in 'nhwc' layout.
- * Do not call this kernel directly. Use the interface pool().
- */
-template <typename DType>
-inline void pool_max_2d_nhwc_cpu(const DType* in_data,
-                                 const mxnet::TShape& ishape,
-                                 const mxnet::TShape& oshape,
-                                 const mxnet::TShape& kernel,
-                                 const mxnet::TShape& pad,
-                                 const mxnet::TShape& stride,
-                                 DType* out_data) {
-  using mshadow::red::limits::MinValue;
-  const int height = ishape[1], width = ishape[2];
-  const int pooled_height = oshape[1], pooled_width = oshape[2];
-  const int kernel_h = kernel[0], kernel_w = kernel[1];
-  const int pad_h = pad[0], pad_w = pad[1];
-  const int stride_h = stride[0], stride_w = stride[1];
-  const int features            = oshape[3];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * features;
-  std::vector<DType> max_vals(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int ph = 0; ph < pooled_height; ++ph) {
-      for (int pw = 0; pw < pooled_width; ++pw) {
-        int hstart           = ph * stride_h - pad_h;
-        int wstart           = pw * stride_w - pad_w;
-        int hend             = std::min(hstart + kernel_h, height);
-        int wend             = std::min(wstart + kernel_w, width);
-        hstart               = std::max(hstart, 0);
-        wstart               = std::max(wstart, 0);
-        const int pool_index = ph * pooled_width + pw;
-        std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
-        for (int h = hstart; h < hend; ++h) {
-          for (int w = wstart; w < wend; ++w) {
-            const int in_index = h * width + w;
-            for (index_t c = 0; c < features; ++c) {
-              if (in_data[in_index * features + c] > max_vals[c]) {
-                max_vals[c] = in_data[in_index * features + c];
-              }
-            }
-          }
-        }
-        for (index_t c = 0; c < features; ++c)
-          out_data[pool_index * features + c] = max_vals[c];
-      }
-    }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
-  }
-}
-
 /*!
  * \brief max pooling cpu function for 3-D images in 'ncdhw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -316,65 +222,6 @@ inline void pool_max_3d_ncdhw_cpu(const DType* in_data,
   }
 }
 
-/*!
- * \brief max pooling cpu function for 3-D images in 'ndhwc' layout.
- * Do not call this kernel directly. Use the interface pool().
- */
-template <typename DType>
-inline void pool_max_3d_ndhwc_cpu(const DType* in_data,
-                                  const mxnet::TShape& ishape,
-                                  const mxnet::TShape& oshape,
-                                  const mxnet::TShape& kernel,
-                                  const mxnet::TShape& pad,
-                                  const mxnet::TShape& stride,
-                                  DType* out_data) {
-  using mshadow::red::limits::MinValue;
-  const int depth = ishape[1], height = ishape[2], width = ishape[3];
-  const int pooled_depth = oshape[1], pooled_height = oshape[2], pooled_width = oshape[3];
-  const int kernel_d = kernel[0], kernel_h = kernel[1], kernel_w = kernel[2];
-  const int pad_d = pad[0], pad_h = pad[1], pad_w = pad[2];
-  const int stride_d = stride[0], stride_h = stride[1], stride_w = stride[2];
-  const int features            = oshape[4];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * ishape[3] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * oshape[3] * features;
-  std::vector<DType> max_vals(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int pd = 0; pd < pooled_depth; ++pd) {
-      for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int dstart           = pd * stride_d - pad_d;
-          int hstart           = ph * stride_h - pad_h;
-          int wstart           = pw * stride_w - pad_w;
-          int dend             = std::min(dstart + kernel_d, depth);
-          int hend             = std::min(hstart + kernel_h, height);
-          int wend             = std::min(wstart + kernel_w, width);
-          dstart               = std::max(dstart, 0);
-          hstart               = std::max(hstart, 0);
-          wstart               = std::max(wstart, 0);
-          const int pool_index = (pd * pooled_height + ph) * pooled_width + pw;
-          std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
-          for (int d = dstart; d < dend; ++d) {
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                const int in_index = (d * height + h) * width + w;
-                for (index_t c = 0; c < features; ++c) {
-                  if (in_data[in_index * features + c] > max_vals[c]) {
-                    max_vals[c] = in_data[in_index * features + c];
-                  }
-                }
-              }
-            }
-          }
-          for (index_t c = 0; c < features; ++c)
-            out_data[pool_index * features + c] = max_vals[c];
-        }
-      }
-    }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
-  }
-}
-
 /*!
  * \brief avg/sum pooling cpu function for 1-D images in 'ncw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -420,54 +267,6 @@ inline void pool_sum_1d_ncw_cpu(const DType* in_data,
   }
 }
 
-/*!
- * \brief avg/sum pooling cpu function for 1-D images in 'nwc' layout.
- * Do not call this kernel directly. Use the interface pool().
- */
-template <typename DType, int p = 1>
-inline void pool_sum_1d_nwc_cpu(const DType* in_data,
-                                const mxnet::TShape& ishape,
-                                const mxnet::TShape& oshape,
-                                const mxnet::TShape& kernel,
-                                const mxnet::TShape& pad,
-                                const mxnet::TShape& stride,
-                                DType* out_data,
-                                const bool get_avg           = false,
-                                const bool count_include_pad = true) {
-  using AccType                 = typename PoolingTypes<DType>::AccType;
-  const int width               = ishape[1];
-  const int pooled_width        = oshape[1];
-  const int kernel_w            = kernel[0];
-  const int pad_w               = pad[0];
-  const int stride_w            = stride[0];
-  const int features            = oshape[2];
-  const index_t in_data_offset  = ishape[1] * features;
-  const index_t out_data_offset = oshape[1] * features;
-  std::vector<AccType> sums(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int pw = 0; pw < pooled_width; ++pw) {
-      int wstart    = pw * stride_w - pad_w;
-      int wend      = std::min(wstart + kernel_w, width + pad_w);
-      int pool_size = (get_avg ? (wend - wstart) : 1);
-      wstart        = std::max(wstart, 0);
-      wend          = std::min(wend, width);
-      if (get_avg && !count_include_pad) {
-        pool_size = (wend - wstart);
-      }
-      std::fill(sums.begin(), sums.end(), 0);
-      for (int w = wstart; w < wend; ++w) {
-        for (index_t c = 0; c < features; ++c) {
-          sums[c] += a_pow_p<AccType, p>::Map(in_data[w * features + c]) / pool_size;
-        }
-      }
-      for (index_t c = 0; c < features; ++c)
-        out_data[pw * features + c] = a_root_p<AccType, p>::Map(sums[c]);
-    }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
-  }
-}
-
 /*!
  * \brief avg/sum pooling cpu function for 2-D images in 'nchw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -521,64 +320,6 @@ inline void pool_sum_2d_nchw_cpu(const DType* in_data,
   }
 }
 
-/*!
- * \brief avg/sum pooling cpu function for 2-D images in 'nhwc' layout.
- * Do not call this kernel directly. Use the interface pool().
- */
-template <typename DType, int p = 1>
-inline void pool_sum_2d_nhwc_cpu(const DType* in_data,
-                                 const mxnet::TShape& ishape,
-                                 const mxnet::TShape& oshape,
-                                 const mxnet::TShape& kernel,
-                                 const mxnet::TShape& pad,
-                                 const mxnet::TShape& stride,
-                                 DType* out_data,
-                                 const bool get_avg           = false,
-                                 const bool count_include_pad = true) {
-  using AccType    = typename PoolingTypes<DType>::AccType;
-  const int height = ishape[1], width = ishape[2];
-  const int pooled_height = oshape[1], pooled_width = oshape[2];
-  const int kernel_h = kernel[0], kernel_w = kernel[1];
-  const int pad_h = pad[0], pad_w = pad[1];
-  const int stride_h = stride[0], stride_w = stride[1];
-  const int features            = oshape[3];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * features;
-  std::vector<AccType> sums(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int ph = 0; ph < pooled_height; ++ph) {
-      for (int pw = 0; pw < pooled_width; ++pw) {
-        int hstart    = ph * stride_h - pad_h;
-        int wstart    = pw * stride_w - pad_w;
-        int hend      = std::min(hstart + kernel_h, height + pad_h);
-        int wend      = std::min(wstart + kernel_w, width + pad_w);
-        int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
-        hstart        = std::max(hstart, 0);
-        wstart        = std::max(wstart, 0);
-        hend          = std::min(hend, height);
-        wend          = std::min(wend, width);
-        if (get_avg && !count_include_pad) {
-          pool_size = (hend - hstart) * (wend - wstart);
-        }
-        const int pool_index = ph * pooled_width + pw;
-        std::fill(sums.begin(), sums.end(), 0);
-        for (int h = hstart; h < hend; ++h) {
-          for (int w = wstart; w < wend; ++w) {
-            const int in_index = h * width + w;
-            for (index_t c = 0; c < features; ++c) {
-              sums[c] += a_pow_p<AccType, p>::Map(in_data[in_index * features + c]) / pool_size;
-            }
-          }
-        }
-        for (index_t c = 0; c < features; ++c)
-          out_data[pool_index * features + c] = a_root_p<AccType, p>::Map(sums[c]);
-      }
-    }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
-  }
-}
-
 /*!
  * \brief avg/sum pooling cpu function for 3-D images in 'ncdhw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -642,70 +383,161 @@ inline void pool_sum_3d_ncdhw_cpu(const DType* in_data,
   }
 }
 
+/*! \brief channels reduced at a time by the channels-last cpu pooling kernels */
+constexpr int kPoolChannelBlock = 64;
+
+/*!
+ * \brief spatial extents of a 1/2/3-D channels-last pooling as 3-D, with the missing
+ *  leading axes of extent 1.
+ */
+struct PoolNxCGeometry {
+  int in[3];
+  int out[3];
+  int kernel[3];
+  int pad[3];
+  int stride[3];
+  index_t features;
+
+  PoolNxCGeometry(const mxnet::TShape& ishape,
+                  const mxnet::TShape& oshape,
+                  const mxnet::TShape& kernel_shape,
+                  const mxnet::TShape& pad_shape,
+                  const mxnet::TShape& stride_shape) {
+    const int ndim = kernel_shape.ndim();
+    for (int i = 0; i < 3; ++i) {
+      const int d = i - (3 - ndim);
+      in[i]       = d < 0 ? 1 : ishape[d + 1];
+      out[i]      = d < 0 ? 1 : oshape[d + 1];
+      kernel[i]   = d < 0 ? 1 : kernel_shape[d];
+      pad[i]      = d < 0 ? 0 : pad_shape[d];
+      stride[i]   = d < 0 ? 1 : stride_shape[d];
+    }
+    features = oshape[ndim + 1];
+  }
+};
+
+/*!
+ * \brief max pooling cpu function for 1/2/3-D images in 'nwc', 'nhwc' or 'ndhwc' layout.
+ * The output pixels run in parallel, and the contiguous channels of a pixel are reduced
+ * kPoolChannelBlock at a time in a local buffer, which the compiler vectorizes.
+ * Do not call this kernel directly. Use the interface pool().
+ */
+template <typename DType>
+inline void pool_max_nxc_cpu(const DType* in_data,
+                             const mxnet::TShape& ishape,
+                             const mxnet::TShape& oshape,
+                             const mxnet::TShape& kernel,
+                             const mxnet::TShape& pad,
+                             const mxnet::TShape& stride,
+                             DType* out_data) {
+  using mshadow::red::limits::MinValue;
+  const PoolNxCGeometry g(ishape, oshape, kernel, pad, stride);
+  const index_t features = g.features;
+  const index_t in_image = static_cast<index_t>(g.in[0]) * g.in[1] * g.in[2] * features;
+  const index_t pixels   = static_cast<index_t>(oshape[0]) * g.out[0] * g.out[1] * g.out[2];
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < pixels; ++i) {
+    const int pw    = i % g.out[2];
+    const int ph    = (i / g.out[2]) % g.out[1];
+    const int pd    = (i / g.out[2] / g.out[1]) % g.out[0];
+    const index_t n = i / g.out[2] / g.out[1] / g.out[0];
+    int dstart      = pd * g.stride[0] - g.pad[0];
+    int hstart      = ph * g.stride[1] - g.pad[1];
+    int wstart      = pw * g.stride[2] - g.pad[2];
+    const int dend  = std::min(dstart + g.kernel[0], g.in[0]);
+    const int hend  = std::min(hstart + g.kernel[1], g.in[1]);
+    const int wend  = std::min(wstart + g.kernel[2], g.in[2]);
+    dstart          = std::max(dstart, 0);
+    hstart          = std::max(hstart, 0);
+    wstart          = std::max(wstart, 0);
+    DType max_vals[kPoolChannelBlock];
+    for (index_t c0 = 0; c0 < features; c0 += kPoolChannelBlock) {
+      const int block = static_cast<int>(std::min<index_t>(kPoolChannelBlock, features - c0));
+      for (int c = 0; c < block; ++c)
+        max_vals[c] = MinValue<DType>();
+      for (int d = dstart; d < dend; ++d) {
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            const DType* in_pixel =
+                in_data + n * in_image + ((d * g.in[1] + h) * g.in[2] + w) * features + c0;
+            for (int c = 0; c < block; ++c)
+              max_vals[c] = in_pixel[c] > max_vals[c] ? in_pixel[c] : max_vals[c];
+          }
+        }
+      }
+      for (int c = 0; c < block; ++c)
+        out_data[i * features + c0 + c] = max_vals[c];
+    }
+  }
+}
+
 /*!
- * \brief avg/sum pooling cpu function for 3-D images in 'ndhwc' layout.
+ * \brief avg/sum pooling cpu function for 1/2/3-D images in 'nwc', 'nhwc' or 'ndhwc'
+ * layout, parallel over the output pixels and blocked over the channels as
+ * pool_max_nxc_cpu.
+ * \param empty_is_nan whether a window without any element of the image gives nan
  * Do not call this kernel directly. Use the interface pool().
  */
 template <typename DType, int p = 1>
-inline void pool_sum_3d_ndhwc_cpu(const DType* in_data,
-                                  const mxnet::TShape& ishape,
-                                  const mxnet::TShape& oshape,
-                                  const mxnet::TShape& kernel,
-                                  const mxnet::TShape& pad,
-                                  const mxnet::TShape& stride,
-                                  DType* out_data,
-                                  const bool get_avg           = false,
-                                  const bool count_include_pad = true) {
-  using AccType   = typename PoolingTypes<DType>::AccType;
-  const int depth = ishape[1], height = ishape[2], width = ishape[3];
-  const int pooled_depth = oshape[1], pooled_height = oshape[2], pooled_width = oshape[3];
-  const int kernel_d = kernel[0], kernel_h = kernel[1], kernel_w = kernel[2];
-  const int pad_d = pad[0], pad_h = pad[1], pad_w = pad[2];
-  const int stride_d = stride[0], stride_h = stride[1], stride_w = stride[2];
-  const int features            = oshape[4];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * ishape[3] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * oshape[3] * features;
-  std::vector<AccType> sums(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int pd = 0; pd < pooled_depth; ++pd) {
-      for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int dstart    = pd * stride_d - pad_d;
-          int hstart    = ph * stride_h - pad_h;
-          int wstart    = pw * stride_w - pad_w;
-          int dend      = std::min(dstart + kernel_d, depth + pad_d);
-          int hend      = std::min(hstart + kernel_h, height + pad_h);
-          int wend      = std::min(wstart + kernel_w, width + pad_w);
-          int pool_size = (get_avg ? (dend - dstart) * (hend - hstart) * (wend - wstart) : 1);
-          dstart        = std::max(dstart, 0);
-          hstart        = std::max(hstart, 0);
-          wstart        = std::max(wstart, 0);
-          dend          = std::min(dend, depth);
-          hend          = std::min(hend, height);
-          wend          = std::min(wend, width);
-          if (get_avg && !count_include_pad) {
-            pool_size = (dend - dstart) * (hend - hstart) * (wend - wstart);
-          }
-          const int pool_index = (pd * pooled_height + ph) * pooled_width + pw;
-          std::fill(sums.begin(), sums.end(), 0);
-          for (int d = dstart; d < dend; ++d) {
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                const int in_index = (d * height + h) * width + w;
-                for (index_t c = 0; c < features; ++c) {
-                  sums[c] += a_pow_p<AccType, p>::Map(in_data[in_index * features + c]) / pool_size;
-                }
-              }
-            }
+inline void pool_sum_nxc_cpu(const DType* in_data,
+                             const mxnet::TShape& ishape,
+                             const mxnet::TShape& oshape,
+                             const mxnet::TShape& kernel,
+                             const mxnet::TShape& pad,
+                             const mxnet::TShape& stride,
+                             DType* out_data,
+                             const bool get_avg           = false,
+                             const bool count_include_pad = true,
+                             const bool empty_is_nan      = false) {
+  using AccType = typename PoolingTypes<DType>::AccType;
+  const PoolNxCGeometry g(ishape, oshape, kernel, pad, stride);
+  const index_t features = g.features;
+  const index_t in_image = static_cast<index_t>(g.in[0]) * g.in[1] * g.in[2] * features;
+  const index_t pixels   = static_cast<index_t>(oshape[0]) * g.out[0] * g.out[1] * g.out[2];
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < pixels; ++i) {
+    const int pw    = i % g.out[2];
+    const int ph    = (i / g.out[2]) % g.out[1];
+    const int pd    = (i / g.out[2] / g.out[1]) % g.out[0];
+    const index_t n = i / g.out[2] / g.out[1] / g.out[0];
+    int dstart      = pd * g.stride[0] - g.pad[0];
+    int hstart      = ph * g.stride[1] - g.pad[1];
+    int wstart      = pw * g.stride[2] - g.pad[2];
+    int dend        = std::min(dstart + g.kernel[0], g.in[0] + g.pad[0]);
+    int hend        = std::min(hstart + g.kernel[1], g.in[1] + g.pad[1]);
+    int wend        = std::min(wstart + g.kernel[2], g.in[2] + g.pad[2]);
+    int pool_size   = (get_avg ? (dend - dstart) * (hend - hstart) * (wend - wstart) : 1);
+    dstart          = std::max(dstart, 0);
+    hstart          = std::max(hstart, 0);
+    wstart          = std::max(wstart, 0);
+    dend            = std::min(dend, g.in[0]);
+    hend            = std::min(hend, g.in[1]);
+    wend            = std::min(wend, g.in[2]);
+    if (get_avg && !count_include_pad) {
+      pool_size = (dend - dstart) * (hend - hstart) * (wend - wstart);
+    }
+    AccType sums[kPoolChannelBlock];
+    for (index_t c0 = 0; c0 < features; c0 += kPoolChannelBlock) {
+      const int block = static_cast<int>(std::min<index_t>(kPoolChannelBlock, features - c0));
+      for (int c = 0; c < block; ++c)
+        sums[c] = 0;
+      for (int d = dstart; d < dend; ++d) {
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            const DType* in_pixel =
+                in_data + n * in_image + ((d * g.in[1] + h) * g.in[2] + w) * features + c0;
+            for (int c = 0; c < block; ++c)
+              sums[c] += a_pow_p<AccType, p>::Map(in_pixel[c]) / pool_size;
           }
-          for (index_t c = 0; c < features; ++c)
-            out_data[pool_index * features + c] =
-                (pool_size == 0) ? AccType(nanf("")) : a_root_p<AccType, p>::Map(sums[c]);
         }
       }
+      for (int c = 0; c < block; ++c)
+        out_data[i * features + c0 + c] = (empty_is_nan && pool_size == 0) ?
+                                              AccType(nanf("")) :
+                                              a_root_p<AccType, p>::Map(sums[c]);
     }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
   }
 }
 
@@ -1461,14 +1293,14 @@ inline void pool(mshadow::Stream<cpu>* s,
   if (kernel.ndim() == 1) {
     if (layout == mshadow::kNWC) {
       if (pool_enum::kMaxPooling == pool_type) {
-        pool_max_1d_nwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_max_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else if (pool_enum::kAvgPooling == pool_type) {
-        pool_sum_1d_nwc_cpu(
+        pool_sum_nxc_cpu(
             in_data, ishape, oshape, kernel, pad, stride, out_data, true, count_include_pad);
       } else if (pool_enum::kSumPooling == pool_type) {
-        pool_sum_1d_nwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else if (pool_enum::kLpPooling == pool_type) {
-        pool_sum_1d_nwc_cpu<DType, p>(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu<DType, p>(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else {
         LOG(FATAL) << "Unknown pooling type " << pool_type;
       }
@@ -1491,14 +1323,14 @@ inline void pool(mshadow::Stream<cpu>* s,
   } else if (kernel.ndim() == 2) {
     if (layout == mshadow::kNHWC) {
       if (pool_enum::kMaxPooling == pool_type) {
-        pool_max_2d_nhwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_max_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else if (pool_enum::kAvgPooling == pool_type) {
-        pool_sum_2d_nhwc_cpu(
+        pool_sum_nxc_cpu(
             in_data, ishape, oshape, kernel, pad, stride, out_data, true, count_include_pad);
       } else if (pool_enum::kSumPooling == pool_type) {
-        pool_sum_2d_nhwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else if (pool_enum::kLpPooling == pool_type) {
-        pool_sum_2d_nhwc_cpu<DType, p>(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu<DType, p>(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else {
         LOG(FATAL) << "Unknown pooling type " << pool_type;
       }
@@ -1520,15 +1352,17 @@ inline void pool(mshadow::Stream<cpu>* s,
     }
   } else if (kernel.ndim() == 3) {
     if (layout == mshadow::kNDHWC) {
+      // as in the 'ncdhw' kernel, a window outside of the image gives nan
       if (pool_enum::kMaxPooling == pool_type) {
-        pool_max_3d_ndhwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_max_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
       } else if (pool_enum::kAvgPooling == pool_type) {
-        pool_sum_3d_ndhwc_cpu(
-            in_data, ishape, oshape, kernel, pad, stride, out_data, true, count_include_pad);
+        pool_sum_nxc_cpu(
+            in_data, ishape, oshape, kernel, pad, stride, out_data, true, count_include_pad, true);
       } else if (pool_enum::kSumPooling == pool_type) {
-        pool_sum_3d_ndhwc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu(in_data, ishape, oshape, kernel, pad, stride, out_data, false, true, true);
       } else if (pool_enum::kLpPooling == pool_type) {
-        pool_sum_3d_ndhwc_cpu<DType, p>(in_data, ishape, oshape, kernel, pad, stride, out_data);
+        pool_sum_nxc_cpu<DType, p>(
+            in_data, ishape, oshape, kernel, pad, stride, out_data, false, true, true);
       } else {
         LOG(FATAL) << "Unknown pooling type " << pool_type;
       }
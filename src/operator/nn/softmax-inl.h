@@ -33,6 +33,7 @@
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../tensor/broadcast_reduce_op.h"
+#include "./softmax_isa.h"
 
 using mshadow::red::limits::MinValue;
 
@@ -87,6 +88,17 @@ inline void Softmax(Stream<cpu>* s,
   sshape[axis]       = 1;
   index_t sa         = stride[axis];
 
+  // contiguous rows of float and bfloat16 take the AVX2 and AVX-512 kernels of the CPU
+  constexpr bool is_log = std::is_same<OP, log_softmax_fwd>::value;
+  if constexpr (!negate && std::is_same<DType, OType>::value &&
+                (std::is_same<OP, softmax_fwd>::value || is_log) &&
+                (std::is_same<DType, float>::value ||
+                 std::is_same<DType, mshadow::bfloat::bf16_t>::value)) {
+    if (length == nullptr && sa == 1 &&
+        SoftmaxRowsISA(in, out, N, M, static_cast<float>(temperature), is_log))
+      return;
+  }
+
   if (length == nullptr) {
 #pragma omp parallel for
     for (index_t i = 0; i < N; ++i) {
@@ -1257,6 +1269,22 @@ void SoftmaxCompute(const nnvm::NodeAttrs& attrs,
   const double temperature  = param.temperature.has_value() ? param.temperature.value() : 1.0;
   mxnet::TShape shape       = AxisShapeCompact(inputs[0].shape_, &axis, true);
   bool safe_acc             = dmlc::GetEnv("MXNET_SAFE_ACCUMULATION", true);
+  if (std::is_same<xpu, cpu>::value && inputs[0].type_flag_ == mshadow::kBfloat16) {
+    // only the rows of the CPU kernels are computed in bfloat16
+    constexpr bool is_log = std::is_same<OP, log_softmax_fwd>::value;
+    CHECK((std::is_same<OP, softmax_fwd>::value || is_log) && !negate &&
+          !param.use_length.value() && outputs[0].type_flag_ == mshadow::kBfloat16 &&
+          axis == static_cast<int>(shape.ndim()) - 1)
+        << "bfloat16 softmax is only supported over the last axis, without length and dtype";
+    const index_t cols = shape[axis];
+    SoftmaxRowsISA(inputs[0].dptr<mshadow::bfloat::bf16_t>(),
+                   outputs[0].dptr<mshadow::bfloat::bf16_t>(),
+                   inputs[0].Size() / cols,
+                   cols,
+                   static_cast<float>(temperature),
+                   is_log);
+    return;
+  }
   if (!safe_acc && inputs[0].type_flag_ == mshadow::kFloat16) {
     common::LogOnce(
         "MXNET_SAFE_ACCUMULATION=1 is recommended for softmax with float16 inputs. "
@@ -0,0 +1,422 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file softmax_isa.cc
+ * \brief softmax kernels of the CPU instruction sets, selected at runtime
+ */
+#include "./softmax_isa.h"
+
+#include <cmath>
+#include <limits>
+
+#include "../../common/cpu_isa.h"
+
+#if MXNET_CPU_ISA_DISPATCH
+#include <immintrin.h>
+#endif
+#if MXNET_CPU_ISA_NEON
+#include <arm_neon.h>
+#endif
+
+namespace mxnet {
+namespace op {
+
+using mshadow::bfloat::bf16_t;
+
+namespace {
+
+/*! \brief softmax of a row with the scalar code, for bfloat16 rows on the baseline CPUs */
+template <typename DType>
+void SoftmaxRow(const DType* in, DType* out, index_t cols, float temperature, bool log) {
+  float row_max = -std::numeric_limits<float>::infinity();
+  for (index_t j = 0; j < cols; ++j)
+    row_max = std::max(row_max, static_cast<float>(in[j]));
+  double sum = 0;
+  for (index_t j = 0; j < cols; ++j)
+    sum += std::exp((static_cast<float>(in[j]) - row_max) / temperature);
+  for (index_t j = 0; j < cols; ++j) {
+    const float x = (static_cast<float>(in[j]) - row_max) / temperature;
+    out[j]        = DType(static_cast<float>(log ? x - std::log(sum) : std::exp(x) / sum));
+  }
+}
+
+#if MXNET_CPU_ISA_DISPATCH || MXNET_CPU_ISA_NEON
+// exp(x) = 2^n exp(r) with |r| <= ln(2) / 2 and a polynomial for exp(r), as in Cephes.
+// Below kExpMin the results would be denormals, which are flushed to zero.
+constexpr float kExpMin     = -87.3365447504f;
+constexpr float kExpMax     = 88.3762626647949f;
+constexpr float kExpLog2e   = 1.44269504088896341f;
+constexpr float kExpLn2Hi   = 0.693359375f;
+constexpr float kExpLn2Lo   = -2.12194440e-4f;
+constexpr float kExpPoly[6] = {1.9875691500e-4f,
+                               1.3981999507e-3f,
+                               8.3334519073e-3f,
+                               4.1665795894e-2f,
+                               1.6666665459e-1f,
+                               5.0000001201e-1f};
+#endif
+
+#if MXNET_CPU_ISA_DISPATCH
+namespace avx2 {
+
+constexpr int kWidth = 8;
+
+MXNET_TARGET_AVX2 inline __m256 Load(const float* p) {
+  return _mm256_loadu_ps(p);
+}
+
+MXNET_TARGET_AVX2 inline __m256 Load(const bf16_t* p) {
+  const __m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16));
+}
+
+MXNET_TARGET_AVX2 inline void Store(float* p, __m256 v) {
+  _mm256_storeu_ps(p, v);
+}
+
+// truncates like mshadow::bfloat::bf16_t
+MXNET_TARGET_AVX2 inline void Store(bf16_t* p, __m256 v) {
+  const __m256i bits   = _mm256_srli_epi32(_mm256_castps_si256(v), 16);
+  const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(bits, bits), 0x8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+}
+
+MXNET_TARGET_AVX2 inline __m256 Exp(__m256 x) {
+  const __m256 underflow = _mm256_cmp_ps(x, _mm256_set1_ps(kExpMin), _CMP_LT_OQ);
+  // the constants first, so that NaNs go through
+  x = _mm256_min_ps(_mm256_set1_ps(kExpMax), _mm256_max_ps(_mm256_set1_ps(kExpMin), x));
+  const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(kExpLog2e)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r       = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpLn2Hi), x);
+  r              = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpLn2Lo), r);
+  __m256 y       = _mm256_set1_ps(kExpPoly[0]);
+  for (int i = 1; i < 6; ++i)
+    y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(kExpPoly[i]));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.f)));
+  const __m256i pow2 =
+      _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+  return _mm256_andnot_ps(underflow, _mm256_mul_ps(y, _mm256_castsi256_ps(pow2)));
+}
+
+MXNET_TARGET_AVX2 inline float ReduceMax(__m256 v) {
+  __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  m        = _mm_max_ps(m, _mm_movehl_ps(m, m));
+  return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+}
+
+MXNET_TARGET_AVX2 inline __m256d AddWide(__m256d sum, __m256 v) {
+  sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+  return _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+}
+
+MXNET_TARGET_AVX2 inline double ReduceAdd(__m256d v) {
+  __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+MXNET_TARGET_AVX2 inline __m256 Logits(__m256 x, __m256 row_max, __m256 temp) {
+  return _mm256_div_ps(_mm256_sub_ps(x, row_max), temp);
+}
+
+/*! \brief softmax of a row, the last partial vector going through a padded buffer */
+template <typename DType>
+MXNET_TARGET_AVX2 void SoftmaxRow(const DType* in,
+                                  DType* out,
+                                  index_t cols,
+                                  float temperature,
+                                  bool log) {
+  const index_t body = cols - cols % kWidth;
+  alignas(32) float tail[kWidth];
+  for (int k = 0; k < kWidth; ++k) {
+    tail[k] = body + k < cols ? static_cast<float>(in[body + k]) :
+                                -std::numeric_limits<float>::infinity();
+  }
+  const __m256 last = _mm256_load_ps(tail);
+
+  __m256 vmax = last;
+  for (index_t j = 0; j < body; j += kWidth)
+    vmax = _mm256_max_ps(vmax, Load(in + j));
+  const __m256 row_max  = _mm256_set1_ps(ReduceMax(vmax));
+  const __m256 temp     = _mm256_set1_ps(temperature);
+  __m256d vsum          = AddWide(_mm256_setzero_pd(), Exp(Logits(last, row_max, temp)));
+  for (index_t j = 0; j < body; j += kWidth)
+    vsum = AddWide(vsum, Exp(Logits(Load(in + j), row_max, temp)));
+  const double sum = ReduceAdd(vsum);
+
+  // log_softmax subtracts the log of the sum, softmax divides by it
+  const __m256 shift = _mm256_set1_ps(static_cast<float>(std::log(sum)));
+  const __m256 norm  = _mm256_set1_ps(static_cast<float>(1.0 / sum));
+  for (index_t j = 0; j <= body; j += kWidth) {
+    const __m256 x = Logits(j < body ? Load(in + j) : last, row_max, temp);
+    const __m256 y = log ? _mm256_sub_ps(x, shift) : _mm256_mul_ps(Exp(x), norm);
+    if (j < body) {
+      Store(out + j, y);
+    } else {
+      _mm256_store_ps(tail, y);
+    }
+  }
+  for (index_t k = 0; body + k < cols; ++k)
+    out[body + k] = DType(tail[k]);
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+constexpr int kWidth = 16;
+
+MXNET_TARGET_AVX512 inline __m512 Load(const float* p) {
+  return _mm512_loadu_ps(p);
+}
+
+MXNET_TARGET_AVX512 inline __m512 Load(const bf16_t* p) {
+  const __m512i bits =
+      _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 16));
+}
+
+MXNET_TARGET_AVX512 inline void Store(float* p, __m512 v) {
+  _mm512_storeu_ps(p, v);
+}
+
+// truncates like mshadow::bfloat::bf16_t
+MXNET_TARGET_AVX512 inline void Store(bf16_t* p, __m512 v) {
+  const __m512i bits = _mm512_srli_epi32(_mm512_castps_si512(v), 16);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi32_epi16(bits));
+}
+
+MXNET_TARGET_AVX512 inline __m512 Exp(__m512 x) {
+  const __mmask16 underflow = _mm512_cmp_ps_mask(x, _mm512_set1_ps(kExpMin), _CMP_LT_OQ);
+  // the constants first, so that NaNs go through
+  x = _mm512_min_ps(_mm512_set1_ps(kExpMax), _mm512_max_ps(_mm512_set1_ps(kExpMin), x));
+  const __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(kExpLog2e)),
+                                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r       = _mm512_fnmadd_ps(n, _mm512_set1_ps(kExpLn2Hi), x);
+  r              = _mm512_fnmadd_ps(n, _mm512_set1_ps(kExpLn2Lo), r);
+  __m512 y       = _mm512_set1_ps(kExpPoly[0]);
+  for (int i = 1; i < 6; ++i)
+    y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(kExpPoly[i]));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.f)));
+  return _mm512_mask_mov_ps(_mm512_scalef_ps(y, n), underflow, _mm512_setzero_ps());
+}
+
+MXNET_TARGET_AVX512 inline __m512d AddWide(__m512d sum, __m512 v) {
+  const __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+  sum               = _mm512_add_pd(sum, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+  return _mm512_add_pd(sum, _mm512_cvtps_pd(high));
+}
+
+MXNET_TARGET_AVX512 inline __m512 Logits(__m512 x, __m512 row_max, __m512 temp) {
+  return _mm512_div_ps(_mm512_sub_ps(x, row_max), temp);
+}
+
+/*! \brief softmax of a row, the last partial vector going through a padded buffer */
+template <typename DType>
+MXNET_TARGET_AVX512 void SoftmaxRow(const DType* in,
+                                    DType* out,
+                                    index_t cols,
+                                    float temperature,
+                                    bool log) {
+  const index_t body = cols - cols % kWidth;
+  alignas(64) float tail[kWidth];
+  for (int k = 0; k < kWidth; ++k) {
+    tail[k] = body + k < cols ? static_cast<float>(in[body + k]) :
+                                -std::numeric_limits<float>::infinity();
+  }
+  const __m512 last = _mm512_load_ps(tail);
+
+  __m512 vmax = last;
+  for (index_t j = 0; j < body; j += kWidth)
+    vmax = _mm512_max_ps(vmax, Load(in + j));
+  const __m512 row_max  = _mm512_set1_ps(_mm512_reduce_max_ps(vmax));
+  const __m512 temp     = _mm512_set1_ps(temperature);
+  __m512d vsum          = AddWide(_mm512_setzero_pd(), Exp(Logits(last, row_max, temp)));
+  for (index_t j = 0; j < body; j += kWidth)
+    vsum = AddWide(vsum, Exp(Logits(Load(in + j), row_max, temp)));
+  const double sum = _mm512_reduce_add_pd(vsum);
+
+  // log_softmax subtracts the log of the sum, softmax divides by it
+  const __m512 shift = _mm512_set1_ps(static_cast<float>(std::log(sum)));
+  const __m512 norm  = _mm512_set1_ps(static_cast<float>(1.0 / sum));
+  for (index_t j = 0; j <= body; j += kWidth) {
+    const __m512 x = Logits(j < body ? Load(in + j) : last, row_max, temp);
+    const __m512 y = log ? _mm512_sub_ps(x, shift) : _mm512_mul_ps(Exp(x), norm);
+    if (j < body) {
+      Store(out + j, y);
+    } else {
+      _mm512_store_ps(tail, y);
+    }
+  }
+  for (index_t k = 0; body + k < cols; ++k)
+    out[body + k] = DType(tail[k]);
+}
+
+}  // namespace avx512
+#endif  // MXNET_CPU_ISA_DISPATCH
+
+#if MXNET_CPU_ISA_NEON
+namespace neon {
+
+constexpr int kWidth = 4;
+
+inline float32x4_t Load(const float* p) {
+  return vld1q_f32(p);
+}
+
+inline float32x4_t Load(const bf16_t* p) {
+  const uint32x4_t bits = vmovl_u16(vld1_u16(reinterpret_cast<const uint16_t*>(p)));
+  return vreinterpretq_f32_u32(vshlq_n_u32(bits, 16));
+}
+
+inline void Store(float* p, float32x4_t v) {
+  vst1q_f32(p, v);
+}
+
+// truncates like mshadow::bfloat::bf16_t
+inline void Store(bf16_t* p, float32x4_t v) {
+  vst1_u16(reinterpret_cast<uint16_t*>(p), vshrn_n_u32(vreinterpretq_u32_f32(v), 16));
+}
+
+inline float32x4_t Exp(float32x4_t x) {
+  const uint32x4_t underflow = vcltq_f32(x, vdupq_n_f32(kExpMin));
+  // vmaxq and vminq return the NaNs
+  x = vminq_f32(vdupq_n_f32(kExpMax), vmaxq_f32(vdupq_n_f32(kExpMin), x));
+  const float32x4_t n = vrndnq_f32(vmulq_f32(x, vdupq_n_f32(kExpLog2e)));
+  float32x4_t r       = vfmsq_f32(x, n, vdupq_n_f32(kExpLn2Hi));
+  r                   = vfmsq_f32(r, n, vdupq_n_f32(kExpLn2Lo));
+  float32x4_t y       = vdupq_n_f32(kExpPoly[0]);
+  for (int i = 1; i < 6; ++i)
+    y = vfmaq_f32(vdupq_n_f32(kExpPoly[i]), y, r);
+  y = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.f)), y, vmulq_f32(r, r));
+  const int32x4_t pow2 = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+  const float32x4_t e  = vmulq_f32(y, vreinterpretq_f32_s32(pow2));
+  return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(e), underflow));
+}
+
+inline float64x2_t AddWide(float64x2_t sum, float32x4_t v) {
+  sum = vaddq_f64(sum, vcvt_f64_f32(vget_low_f32(v)));
+  return vaddq_f64(sum, vcvt_high_f64_f32(v));
+}
+
+inline float32x4_t Logits(float32x4_t x, float32x4_t row_max, float32x4_t temp) {
+  return vdivq_f32(vsubq_f32(x, row_max), temp);
+}
+
+/*! \brief softmax of a row, the last partial vector going through a padded buffer */
+template <typename DType>
+void SoftmaxRow(const DType* in, DType* out, index_t cols, float temperature, bool log) {
+  const index_t body = cols - cols % kWidth;
+  alignas(16) float tail[kWidth];
+  for (int k = 0; k < kWidth; ++k) {
+    tail[k] = body + k < cols ? static_cast<float>(in[body + k]) :
+                                -std::numeric_limits<float>::infinity();
+  }
+  const float32x4_t last = vld1q_f32(tail);
+
+  float32x4_t vmax = last;
+  for (index_t j = 0; j < body; j += kWidth)
+    vmax = vmaxq_f32(vmax, Load(in + j));
+  const float32x4_t row_max = vdupq_n_f32(vmaxvq_f32(vmax));
+  const float32x4_t temp    = vdupq_n_f32(temperature);
+  float64x2_t vsum          = AddWide(vdupq_n_f64(0), Exp(Logits(last, row_max, temp)));
+  for (index_t j = 0; j < body; j += kWidth)
+    vsum = AddWide(vsum, Exp(Logits(Load(in + j), row_max, temp)));
+  const double sum = vaddvq_f64(vsum);
+
+  // log_softmax subtracts the log of the sum, softmax divides by it
+  const float32x4_t shift = vdupq_n_f32(static_cast<float>(std::log(sum)));
+  const float32x4_t norm  = vdupq_n_f32(static_cast<float>(1.0 / sum));
+  for (index_t j = 0; j <= body; j += kWidth) {
+    const float32x4_t x = Logits(j < body ? Load(in + j) : last, row_max, temp);
+    const float32x4_t y = log ? vsubq_f32(x, shift) : vmulq_f32(Exp(x), norm);
+    if (j < body) {
+      Store(out + j, y);
+    } else {
+      vst1q_f32(tail, y);
+    }
+  }
+  for (index_t k = 0; body + k < cols; ++k)
+    out[body + k] = DType(tail[k]);
+}
+
+}  // namespace neon
+#endif  // MXNET_CPU_ISA_NEON
+
+/*! \return whether the rows went through the kernels of the CPU instruction set */
+template <typename DType>
+bool SoftmaxRowsOfISA(const DType* in,
+                      DType* out,
+                      index_t rows,
+                      index_t cols,
+                      float temperature,
+                      bool log) {
+#if MXNET_CPU_ISA_DISPATCH
+  const common::CPUISA isa = common::GetCPUISA();
+  if (isa >= common::CPUISA::kAVX512 && cols >= avx512::kWidth) {
+#pragma omp parallel for
+    for (index_t i = 0; i < rows; ++i)
+      avx512::SoftmaxRow(in + i * cols, out + i * cols, cols, temperature, log);
+    return true;
+  }
+  if (isa >= common::CPUISA::kAVX2) {
+#pragma omp parallel for
+    for (index_t i = 0; i < rows; ++i)
+      avx2::SoftmaxRow(in + i * cols, out + i * cols, cols, temperature, log);
+    return true;
+  }
+#elif MXNET_CPU_ISA_NEON
+  if (common::GetCPUISA() >= common::CPUISA::kNEON) {
+#pragma omp parallel for
+    for (index_t i = 0; i < rows; ++i)
+      neon::SoftmaxRow(in + i * cols, out + i * cols, cols, temperature, log);
+    return true;
+  }
+#endif
+  return false;
+}
+
+}  // namespace
+
+bool SoftmaxRowsISA(const float* in,
+                    float* out,
+                    index_t rows,
+                    index_t cols,
+                    float temperature,
+                    bool log) {
+  return SoftmaxRowsOfISA(in, out, rows, cols, temperature, log);
+}
+
+bool SoftmaxRowsISA(const bf16_t* in,
+                    bf16_t* out,
+                    index_t rows,
+                    index_t cols,
+                    float temperature,
+                    bool log) {
+  if (SoftmaxRowsOfISA(in, out, rows, cols, temperature, log))
+    return true;
+  // the operators have no other bfloat16 kernel
+#pragma omp parallel for
+  for (index_t i = 0; i < rows; ++i)
+    SoftmaxRow(in + i * cols, out + i * cols, cols, temperature, log);
+  return true;
+}
+
+}  // namespace op
+}  // namespace mxnet
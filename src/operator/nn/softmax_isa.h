@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file softmax_isa.h
+ * \brief softmax kernels of the CPU instruction sets, selected at runtime
+ */
+#ifndef MXNET_OPERATOR_NN_SOFTMAX_ISA_H_
+#define MXNET_OPERATOR_NN_SOFTMAX_ISA_H_
+
+#include <mxnet/base.h>
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief softmax, or log_softmax, of rows rows of cols contiguous elements, with the AVX2,
+ *  AVX-512 or NEON kernels the CPU supports. Accumulates in float, bfloat16 rows included.
+ * \return false when the CPU has none of the instruction sets, leaving out unchanged. The
+ *  bfloat16 rows, which no other kernel computes, fall back to scalar code instead.
+ */
+bool SoftmaxRowsISA(const float* in,
+                    float* out,
+                    index_t rows,
+                    index_t cols,
+                    float temperature,
+                    bool log);
+bool SoftmaxRowsISA(const mshadow::bfloat::bf16_t* in,
+                    mshadow::bfloat::bf16_t* out,
+                    index_t rows,
+                    index_t cols,
+                    float temperature,
+                    bool log);
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_NN_SOFTMAX_ISA_H_
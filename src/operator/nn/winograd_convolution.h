@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file winograd_convolution.h
+ * \brief Winograd F(2x2, 3x3) and F(4x4, 3x3) forward pass of the native CPU convolution
+ *  for 3x3 kernels with stride 1, which needs 2.25 to 4 multiplications per output
+ *  instead of 9.
+ */
+#ifndef MXNET_OPERATOR_NN_WINOGRAD_CONVOLUTION_H_
+#define MXNET_OPERATOR_NN_WINOGRAD_CONVOLUTION_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <type_traits>
+#include "../linalg.h"
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief whether the native CPU convolution uses Winograd for the 3x3 stride 1 layers */
+inline bool ConvolutionWinograd() {
+  return dmlc::GetEnv("MXNET_CONV_WINOGRAD", true);
+}
+
+/*! \brief matrices B^T, G and A^T of the Winograd transform F(m x m, 3 x 3) */
+template <int m>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+  static constexpr int alpha = 4;
+  static const float* BT() {
+    static const float bt[4 * 4] = {1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 1, 0, 0, 1, 0, -1};
+    return bt;
+  }
+  static const float* G() {
+    static const float g[4 * 3] = {1, 0, 0, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0, 0, 1};
+    return g;
+  }
+  static const float* AT() {
+    static const float at[2 * 4] = {1, 1, 1, 0, 0, 1, -1, -1};
+    return at;
+  }
+};
+
+template <>
+struct WinogradMatrices<4> {
+  static constexpr int alpha = 6;
+  static const float* BT() {
+    static const float bt[6 * 6] = {4, 0, -5, 0,  1, 0, 0, -4, -4, 1,  1, 0,
+                                    0, 4, -4, -1, 1, 0, 0, -2, -1, 2,  1, 0,
+                                    0, 2, -1, -2, 1, 0, 0, 4,  0,  -5, 0, 1};
+    return bt;
+  }
+  static const float* G() {
+    static const float g[6 * 3] = {1.f / 4,  0,        0,       -1.f / 6, -1.f / 6, -1.f / 6,
+                                   -1.f / 6, 1.f / 6,  -1.f / 6, 1.f / 24, 1.f / 12, 1.f / 6,
+                                   1.f / 24, -1.f / 12, 1.f / 6, 0,        0,        1};
+    return g;
+  }
+  static const float* AT() {
+    static const float at[4 * 6] = {1, 1, 1, 1, 1,  0, 0, 1, -1, 2, -2, 0,
+                                    0, 1, 1, 4, 4,  0, 0, 1, -1, 8, -8, 1};
+    return at;
+  }
+};
+
+/*! \brief out (R x R) = A in A^T for A (R x N) and in (N x N) */
+template <int R, int N, typename DType>
+inline void WinogradSandwich(const float* A, const DType* in, DType* out) {
+  DType tmp[R * N];
+  for (int i = 0; i < R; ++i) {
+    for (int j = 0; j < N; ++j) {
+      DType sum = 0;
+      for (int k = 0; k < N; ++k)
+        sum += static_cast<DType>(A[i * N + k]) * in[k * N + j];
+      tmp[i * N + j] = sum;
+    }
+  }
+  for (int i = 0; i < R; ++i) {
+    for (int j = 0; j < R; ++j) {
+      DType sum = 0;
+      for (int k = 0; k < N; ++k)
+        sum += tmp[i * N + k] * static_cast<DType>(A[j * N + k]);
+      out[i * R + j] = sum;
+    }
+  }
+}
+
+/*! \brief geometry of a 3x3 stride 1 convolution in NCHW layout */
+struct WinogradConvGeometry {
+  index_t num;
+  index_t channels;
+  index_t height;
+  index_t width;
+  index_t out_h;
+  index_t out_w;
+  index_t pad_h;
+  index_t pad_w;
+  index_t num_filter;
+  index_t group;
+};
+
+template <typename Param>
+inline WinogradConvGeometry GetWinogradConvGeometry(const Param& param,
+                                                    const mxnet::TShape& dshape,
+                                                    const mxnet::TShape& oshape) {
+  WinogradConvGeometry g;
+  g.num        = dshape[0];
+  g.channels   = dshape[1];
+  g.height     = dshape[2];
+  g.width      = dshape[3];
+  g.out_h      = oshape[2];
+  g.out_w      = oshape[3];
+  g.pad_h      = param.pad[0];
+  g.pad_w      = param.pad[1];
+  g.num_filter = param.num_filter;
+  g.group      = param.num_group;
+  return g;
+}
+
+/*! \brief whether the forward pass of a convolution runs the Winograd transform */
+template <typename xpu, typename DType, typename Param>
+inline bool WinogradConvApplies(const Param& param) {
+  return std::is_same<xpu, cpu>::value &&
+         (std::is_same<DType, float>::value || std::is_same<DType, double>::value) &&
+         param.kernel.ndim() == 2 && param.kernel[0] == 3 && param.kernel[1] == 3 &&
+         param.stride[0] == 1 && param.stride[1] == 1 && param.dilate[0] == 1 &&
+         param.dilate[1] == 1 &&
+         (!param.layout.has_value() || param.layout.value() == mshadow::kNCHW) &&
+         ConvolutionWinograd();
+}
+
+/*! \brief output tile size m: F(4x4, 3x3) unless the output is too small to fill its tiles */
+inline int WinogradTileSize(const WinogradConvGeometry& g) {
+  return g.out_h >= 8 && g.out_w >= 8 ? 4 : 2;
+}
+
+/*! \brief number of tiles of a block, which keeps the transformed block within the L2 cache */
+inline index_t WinogradTileBlock(const WinogradConvGeometry& g, int alpha) {
+  const int m               = alpha - 2;
+  const index_t kBlockElems = 1 << 18;
+  const index_t tiles       = g.num * ((g.out_h + m - 1) / m) * ((g.out_w + m - 1) / m);
+  const index_t block       = kBlockElems / (alpha * alpha * (g.channels + g.num_filter));
+  return std::max<index_t>(1, std::min<index_t>(tiles, std::max<index_t>(16, block)));
+}
+
+/*! \brief temp space in elements needed by WinogradConvForward */
+inline index_t WinogradConvWorkspace(const WinogradConvGeometry& g) {
+  const int alpha = WinogradTileSize(g) + 2;
+  return alpha * alpha *
+         (g.num_filter * (g.channels / g.group) +
+          (g.channels + g.num_filter) * WinogradTileBlock(g, alpha));
+}
+
+template <int m, typename DType>
+inline void WinogradConvForwardImpl(mshadow::Stream<cpu>* s,
+                                    const WinogradConvGeometry& g,
+                                    const DType* data,
+                                    const DType* weight,
+                                    const DType* bias,
+                                    OpReqType req,
+                                    DType* out,
+                                    DType* workspace) {
+  using namespace mshadow;
+  typedef WinogradMatrices<m> Mat;
+  constexpr int alpha       = Mat::alpha;
+  constexpr int alpha2      = alpha * alpha;
+  const index_t C           = g.channels;
+  const index_t F           = g.num_filter;
+  const index_t Cg          = C / g.group;
+  const index_t Fg          = F / g.group;
+  const index_t tiles_h     = (g.out_h + m - 1) / m;
+  const index_t tiles_w     = (g.out_w + m - 1) / m;
+  const index_t image_tiles = tiles_h * tiles_w;
+  const index_t tiles       = g.num * image_tiles;
+  const index_t block       = WinogradTileBlock(g, alpha);
+  const int omp_threads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // V is (alpha^2, F, C / group), U is (alpha^2, C, block) and M is (alpha^2, F, block)
+  DType* V = workspace;
+  DType* U = V + alpha2 * F * Cg;
+  DType* M = U + alpha2 * C * block;
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t e = 0; e < F * Cg; ++e) {
+    DType v[alpha2];
+    WinogradSandwich<alpha, 3>(Mat::G(), weight + e * 9, v);
+    for (int x = 0; x < alpha2; ++x)
+      V[x * F * Cg + e] = v[x];
+  }
+  for (index_t t0 = 0; t0 < tiles; t0 += block) {
+    const index_t cols = std::min(block, tiles - t0);
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t e = 0; e < C * cols; ++e) {
+      const index_t c    = e / cols;
+      const index_t t    = t0 + e % cols;
+      const index_t tile = t % image_tiles;
+      const index_t h0   = (tile / tiles_w) * m - g.pad_h;
+      const index_t w0   = (tile % tiles_w) * m - g.pad_w;
+      const DType* im    = data + ((t / image_tiles) * C + c) * g.height * g.width;
+      DType d[alpha2];
+      DType u[alpha2];
+      for (int i = 0; i < alpha; ++i) {
+        for (int j = 0; j < alpha; ++j) {
+          const index_t h  = h0 + i;
+          const index_t w  = w0 + j;
+          d[i * alpha + j] = (h >= 0 && h < g.height && w >= 0 && w < g.width) ?
+                                 im[h * g.width + w] :
+                                 DType(0);
+        }
+      }
+      WinogradSandwich<alpha, alpha>(Mat::BT(), d, u);
+      for (int x = 0; x < alpha2; ++x)
+        U[(x * C + c) * cols + e % cols] = u[x];
+    }
+    // one GEMM per element of the transformed tiles and group
+    for (int x = 0; x < alpha2; ++x) {
+      for (index_t grp = 0; grp < g.group; ++grp) {
+        Tensor<cpu, 2, DType> v(V + (x * F + grp * Fg) * Cg, Shape2(Fg, Cg), s);
+        Tensor<cpu, 2, DType> u(U + (x * C + grp * Cg) * cols, Shape2(Cg, cols), s);
+        Tensor<cpu, 2, DType> y(M + (x * F + grp * Fg) * cols, Shape2(Fg, cols), s);
+        linalg_gemm(v, u, y, false, false, s, kWriteTo);
+      }
+    }
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t e = 0; e < F * cols; ++e) {
+      const index_t f    = e / cols;
+      const index_t t    = t0 + e % cols;
+      const index_t tile = t % image_tiles;
+      const index_t h0   = (tile / tiles_w) * m;
+      const index_t w0   = (tile % tiles_w) * m;
+      DType* o           = out + ((t / image_tiles) * F + f) * g.out_h * g.out_w;
+      const DType b      = bias == nullptr ? DType(0) : bias[f];
+      DType mt[alpha2];
+      DType y[m * m];
+      for (int x = 0; x < alpha2; ++x)
+        mt[x] = M[(x * F + f) * cols + e % cols];
+      WinogradSandwich<m, alpha>(Mat::AT(), mt, y);
+      // the last tiles of a row or column may be partial
+      for (int i = 0; i < m && h0 + i < g.out_h; ++i) {
+        for (int j = 0; j < m && w0 + j < g.out_w; ++j) {
+          DType& dst = o[(h0 + i) * g.out_w + w0 + j];
+          dst        = (req == kAddTo ? dst : DType(0)) + y[i * m + j] + b;
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * \brief out = conv3x3(data, weight) + bias with stride 1 and no dilation in NCHW layout.
+ * \param bias nullptr without bias
+ * \param workspace WinogradConvWorkspace(g) elements
+ */
+template <typename DType>
+inline void WinogradConvForward(mshadow::Stream<cpu>* s,
+                                const WinogradConvGeometry& g,
+                                const DType* data,
+                                const DType* weight,
+                                const DType* bias,
+                                OpReqType req,
+                                DType* out,
+                                DType* workspace) {
+  if (req == kNullOp)
+    return;
+  if (WinogradTileSize(g) == 4) {
+    WinogradConvForwardImpl<4>(s, g, data, weight, bias, req, out, workspace);
+  } else {
+    WinogradConvForwardImpl<2>(s, g, data, weight, bias, req, out, workspace);
+  }
+}
+
+template <typename DType>
+inline void WinogradConvForward(mshadow::Stream<gpu>* s,
+                                const WinogradConvGeometry& g,
+                                const DType* data,
+                                const DType* weight,
+                                const DType* bias,
+                                OpReqType req,
+                                DType* out,
+                                DType* workspace) {
+  LOG(FATAL) << "Winograd convolution is only implemented on CPU";
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_NN_WINOGRAD_CONVOLUTION_H_
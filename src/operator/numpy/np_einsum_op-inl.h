@@ -46,6 +46,10 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
 #include "./np_tensordot_op-inl.h"
 #include "./np_einsum_path_op-inl.h"
 #include "../../common/static_array.h"
@@ -53,6 +57,7 @@
 #include "../operator_common.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#include "../linalg.h"
 
 namespace mxnet {
 namespace op {
@@ -760,6 +765,273 @@ inline void NumpyEinsumProcess(const std::vector<TBlob>& inputs,
   }
 }
 
+/*!
+ * \brief a contraction of two operands as a batched GEMM. Every label of the operands is a
+ *  batch label (of both operands and the output), a contracted label (of both operands) or a
+ *  free label (of one operand and the output). The operands and the output are read and
+ *  written in place when their labels are ordered as the GEMM wants them, else transposed.
+ */
+struct EinsumGemmPlan {
+  index_t batch, m, n, k;
+  /*! \brief the operands are (batch, k, m) and (batch, n, k) */
+  bool trans_lhs, trans_rhs;
+  /*! \brief the output is (batch, n, m), computed as the transposed GEMM */
+  bool swap;
+  /*! \brief the operands are transposed to (batch, m, k) and (batch, k, n) by these axes */
+  bool copy_lhs, copy_rhs;
+  mxnet::TShape lhs_axes, rhs_axes;
+  /*! \brief the (batch, m, n) result of the shape is transposed to the output by the axes */
+  bool copy_out;
+  mxnet::TShape result_shape, out_axes;
+};
+
+/*!
+ * \brief plans the einsum of explicit subscripts, e.g. "bij,bjk->bik", as a batched GEMM.
+ * \return false if it is not a batched GEMM, e.g. with repeated or broadcast labels
+ */
+template <typename xpu>
+inline bool PlanEinsumGemm(const std::string& subscripts,
+                           const TBlob& lhs,
+                           const TBlob& rhs,
+                           const TBlob& out,
+                           EinsumGemmPlan* plan) {
+#if MSHADOW_USE_CBLAS == 0 && MSHADOW_USE_MKL == 0
+  if (std::is_same<xpu, cpu>::value)
+    return false;
+#endif
+  if (lhs.type_flag_ != out.type_flag_ || rhs.type_flag_ != out.type_flag_ ||
+      (out.type_flag_ != kFloat32 && out.type_flag_ != kFloat64)) {
+    return false;
+  }
+  std::string str;
+  for (const char c : subscripts) {
+    if (c != ' ')
+      str.push_back(c);
+  }
+  const size_t comma = str.find(',');
+  const size_t arrow = str.find("->");
+  if (comma == std::string::npos || arrow == std::string::npos || arrow < comma ||
+      str.find(',', comma + 1) != std::string::npos || str.find('.') != std::string::npos) {
+    return false;
+  }
+  const std::string labels[3] = {
+      str.substr(0, comma), str.substr(comma + 1, arrow - comma - 1), str.substr(arrow + 2)};
+  const mxnet::TShape* shapes[3] = {&lhs.shape_, &rhs.shape_, &out.shape_};
+  int pos[3][128];
+  index_t dims[128];
+  std::fill(&pos[0][0], &pos[0][0] + 3 * 128, -1);
+  std::fill(dims, dims + 128, -1);
+  for (int t = 0; t < 3; ++t) {
+    if (static_cast<int>(labels[t].size()) != shapes[t]->ndim())
+      return false;
+    for (size_t j = 0; j < labels[t].size(); ++j) {
+      const int c = labels[t][j];
+      if (c < 0 || c >= 128 || pos[t][c] >= 0)
+        return false;
+      pos[t][c] = j;
+      // no broadcasting of the labels
+      if (dims[c] >= 0 && dims[c] != (*shapes[t])[j])
+        return false;
+      dims[c] = (*shapes[t])[j];
+    }
+  }
+  std::vector<int> batch, free_lhs, free_rhs, contract;
+  for (const int c : labels[2]) {
+    if (pos[0][c] >= 0 && pos[1][c] >= 0) {
+      batch.push_back(c);
+    } else if (pos[0][c] >= 0) {
+      free_lhs.push_back(c);
+    } else if (pos[1][c] >= 0) {
+      free_rhs.push_back(c);
+    } else {
+      return false;
+    }
+  }
+  for (const int c : labels[0]) {
+    if (pos[2][c] < 0) {
+      if (pos[1][c] < 0)
+        return false;
+      contract.push_back(c);
+    }
+  }
+  for (const int c : labels[1]) {
+    if (pos[2][c] < 0 && pos[0][c] < 0)
+      return false;
+  }
+  auto size_of = [&](const std::vector<int>& group) {
+    index_t size = 1;
+    for (const int c : group)
+      size *= dims[c];
+    return size;
+  };
+  plan->batch = size_of(batch);
+  plan->m     = size_of(free_lhs);
+  plan->n     = size_of(free_rhs);
+  plan->k     = size_of(contract);
+  if (plan->batch == 0 || plan->m == 0 || plan->n == 0 || plan->k == 0)
+    return false;
+  // the axes of the term t ordered as the groups, and whether they are already in order
+  auto axes_of = [&](int t, std::initializer_list<const std::vector<int>*> groups,
+                     mxnet::TShape* axes) {
+    *axes          = mxnet::TShape(shapes[t]->ndim(), -1);
+    bool identity = true;
+    int i         = 0;
+    for (const std::vector<int>* group : groups) {
+      for (const int c : *group) {
+        (*axes)[i] = pos[t][c];
+        identity   = identity && pos[t][c] == i;
+        ++i;
+      }
+    }
+    return identity;
+  };
+  mxnet::TShape axes, swapped_axes;
+  plan->trans_lhs = false;
+  plan->copy_lhs  = false;
+  if (!axes_of(0, {&batch, &free_lhs, &contract}, &plan->lhs_axes)) {
+    plan->trans_lhs = axes_of(0, {&batch, &contract, &free_lhs}, &swapped_axes);
+    plan->copy_lhs  = !plan->trans_lhs;
+  }
+  plan->trans_rhs = false;
+  plan->copy_rhs  = false;
+  if (!axes_of(1, {&batch, &contract, &free_rhs}, &plan->rhs_axes)) {
+    plan->trans_rhs = axes_of(1, {&batch, &free_rhs, &contract}, &swapped_axes);
+    plan->copy_rhs  = !plan->trans_rhs;
+  }
+  plan->swap     = false;
+  plan->copy_out = false;
+  if (!axes_of(2, {&batch, &free_lhs, &free_rhs}, &axes)) {
+    plan->swap     = axes_of(2, {&batch, &free_rhs, &free_lhs}, &swapped_axes);
+    plan->copy_out = !plan->swap;
+  }
+  if (plan->copy_out) {
+    // the output axis i is the axes[i]-th axis of the (batch, m, n) result
+    plan->out_axes     = mxnet::TShape(out.ndim(), -1);
+    plan->result_shape = mxnet::TShape(out.ndim(), -1);
+    for (int i = 0; i < out.ndim(); ++i) {
+      plan->out_axes[axes[i]] = i;
+      plan->result_shape[i]   = dims[static_cast<int>(labels[2][axes[i]])];
+    }
+  }
+  // the transposes are of at most 6 dimensions
+  return !(plan->copy_lhs && lhs.ndim() > 6) && !(plan->copy_rhs && rhs.ndim() > 6) &&
+         !(plan->copy_out && out.ndim() > 6);
+}
+
+/*!
+ * \brief the subscripts of the gradients of the operands of "lhs,rhs->out", which are
+ *  "out,rhs->lhs" and "out,lhs->rhs" when no label is summed within an operand.
+ * \return false if the subscripts are not explicit with two operands
+ */
+inline bool EinsumGradSubscripts(const std::string& subscripts,
+                                 std::string* lhs_subscripts,
+                                 std::string* rhs_subscripts) {
+  std::string str;
+  for (const char c : subscripts) {
+    if (c != ' ')
+      str.push_back(c);
+  }
+  const size_t comma = str.find(',');
+  const size_t arrow = str.find("->");
+  if (comma == std::string::npos || arrow == std::string::npos || arrow < comma)
+    return false;
+  const std::string lhs = str.substr(0, comma);
+  const std::string rhs = str.substr(comma + 1, arrow - comma - 1);
+  const std::string out = str.substr(arrow + 2);
+  *lhs_subscripts       = out + "," + rhs + "->" + lhs;
+  *rhs_subscripts       = out + "," + lhs + "->" + rhs;
+  return true;
+}
+
+/*! \brief computes the einsum of the plan, the transposes are in the temp space */
+template <typename xpu>
+inline void EinsumGemm(const EinsumGemmPlan& plan,
+                       const TBlob& lhs,
+                       const TBlob& rhs,
+                       const OpReqType req,
+                       const TBlob& out,
+                       const OpContext& ctx) {
+  using namespace mshadow;
+  if (req == kNullOp)
+    return;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_SGL_DBL_TYPE_SWITCH(out.type_flag_, DType, {
+    const size_t lhs_size = plan.copy_lhs ? lhs.Size() : 0;
+    const size_t rhs_size = plan.copy_rhs ? rhs.Size() : 0;
+    const size_t out_size = plan.copy_out ? out.Size() : 0;
+    Tensor<xpu, 1, DType> workspace = ctx.requested[0].get_space_typed<xpu, 1, DType>(
+        Shape1(lhs_size + rhs_size + out_size), s);
+    DType* lhs_ptr = lhs.dptr<DType>();
+    DType* rhs_ptr = rhs.dptr<DType>();
+    DType* out_ptr = plan.copy_out ? workspace.dptr_ + lhs_size + rhs_size : out.dptr<DType>();
+    auto transpose = [&](const TBlob& src, const mxnet::TShape& axes, DType* dst) {
+      mxnet::TShape shape(src.ndim(), -1);
+      for (int i = 0; i < src.ndim(); ++i)
+        shape[i] = src.shape_[axes[i]];
+      TransposeImpl<xpu>(ctx.run_ctx, src, TBlob(dst, shape, xpu::kDevMask), axes);
+    };
+    if (plan.copy_lhs) {
+      lhs_ptr = workspace.dptr_;
+      transpose(lhs, plan.lhs_axes, lhs_ptr);
+    }
+    if (plan.copy_rhs) {
+      rhs_ptr = workspace.dptr_ + lhs_size;
+      transpose(rhs, plan.rhs_axes, rhs_ptr);
+    }
+    const index_t batch = plan.batch, m = plan.m, n = plan.n, k = plan.k;
+    Tensor<xpu, 3, DType> a(lhs_ptr, plan.trans_lhs ? Shape3(batch, k, m) : Shape3(batch, m, k), s);
+    Tensor<xpu, 3, DType> b(rhs_ptr, plan.trans_rhs ? Shape3(batch, n, k) : Shape3(batch, k, n), s);
+    const DType beta = req == kAddTo && !plan.copy_out ? DType(1) : DType(0);
+    if (plan.swap) {
+      // out^T = rhs^T lhs^T
+      Tensor<xpu, 3, DType> c(out_ptr, Shape3(batch, n, m), s);
+      linalg_batch_gemm(b, a, c, DType(1), beta, !plan.trans_rhs, !plan.trans_lhs, s);
+    } else {
+      Tensor<xpu, 3, DType> c(out_ptr, Shape3(batch, m, n), s);
+      linalg_batch_gemm(a, b, c, DType(1), beta, plan.trans_lhs, plan.trans_rhs, s);
+    }
+    if (plan.copy_out) {
+      TBlob result(out_ptr, plan.result_shape, xpu::kDevMask);
+      if (req == kAddTo) {
+        TransposeImpl<xpu, true>(ctx.run_ctx, result, out, plan.out_axes);
+      } else {
+        TransposeImpl<xpu>(ctx.run_ctx, result, out, plan.out_axes);
+      }
+    }
+  });
+}
+
+/*!
+ * \brief the optimized path of the subscripts on inputs of their shapes, dtype and device.
+ *  It is searched once per process, the imperative calls create a new state every call.
+ */
+inline std::vector<Step> EinsumPathCached(const std::string& subscripts,
+                                          const std::vector<TBlob>& inputs,
+                                          const RunContext& run_ctx) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::vector<Step>> cache;
+  std::ostringstream os;
+  os << subscripts << '|' << inputs[0].type_flag_ << '|' << run_ctx.ctx.dev_mask();
+  for (const TBlob& input : inputs)
+    os << '|' << input.shape_;
+  const std::string key = os.str();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it != cache.end())
+      return it->second;
+  }
+  std::vector<std::vector<int> > pos;
+  std::string string_repr;
+  std::vector<Step> paths = einsum_path(subscripts, inputs, true, run_ctx, &pos, &string_repr);
+  std::lock_guard<std::mutex> lock(mutex);
+  // bounded, e.g. with a new shape every batch of a variable length input
+  if (cache.size() >= 1024)
+    cache.clear();
+  cache.emplace(key, paths);
+  return paths;
+}
+
 template <typename xpu>
 inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
                                const OpContext& ctx,
@@ -776,14 +1048,18 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
   CHECK_EQ(inputs.size(), num_args);
   CHECK_EQ(outputs.size(), 1U);
   if (optimize == 0) {
+    EinsumGemmPlan plan;
+    if (num_args == 2 && PlanEinsumGemm<xpu>(state.subscripts, inputs[0], inputs[1], outputs[0],
+                                             &plan)) {
+      EinsumGemm<xpu>(plan, inputs[0], inputs[1], req[0], outputs[0], ctx);
+      return;
+    }
     NumpyEinsumProcess<xpu, 0>(inputs, req, outputs, subscripts, num_args, ctx);
     return;
   }
   std::vector<Step>& paths = state.paths;
-  std::vector<std::vector<int> > pos;
-  std::string string_repr;
-  paths         = einsum_path(state.subscripts, inputs, true, ctx.run_ctx, &pos, &string_repr);
-  int paths_len = paths.size();
+  paths                    = EinsumPathCached(state.subscripts, inputs, ctx.run_ctx);
+  int paths_len            = paths.size();
   size_t temp_space_size = 0, max_temp_space_size = 0;
   std::vector<TBlob> operands(inputs), tmp_operands, temp_space_vec(paths_len - 1);
   for (int i = 0; i + 1 < paths_len; ++i) {
@@ -794,8 +1070,13 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
   }
   temp_space_size += max_temp_space_size;
   MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    state.tempspace.reset<NDArray>(new NDArray(
-        TShape(Shape1(temp_space_size)), ctx.run_ctx.ctx, false, outputs[0].type_flag_));
+    // the intermediate results are kept for the backward, in the buffer of the last call
+    if (!state.tempspace || state.tempspace->shape().Size() < temp_space_size ||
+        state.tempspace->ctx() != ctx.run_ctx.ctx ||
+        state.tempspace->dtype() != outputs[0].type_flag_) {
+      state.tempspace.reset<NDArray>(new NDArray(
+          TShape(Shape1(temp_space_size)), ctx.run_ctx.ctx, false, outputs[0].type_flag_));
+    }
     Tensor<xpu, 1, DType> temp_space = state.tempspace->data().FlatTo1D<xpu, DType>();
     size_t begin                     = max_temp_space_size;
     for (int i = 0; i < paths_len - 1; ++i) {
@@ -862,12 +1143,25 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
                              tensordot_tempspace);
         }
       } else {
-        NumpyEinsumProcess<xpu, 0>(tmp_operands,
-                                   handle_out ? req : std::vector<OpReqType>{OpReqType::kWriteTo},
-                                   handle_out ? outputs : std::vector<TBlob>{temp_space_vec[i]},
-                                   paths[i].einsum_str.c_str(),
-                                   tmp_operands.size(),
-                                   ctx);
+        const TBlob& step_out = handle_out ? outputs[0] : temp_space_vec[i];
+        EinsumGemmPlan plan;
+        if (tmp_operands.size() == 2U &&
+            PlanEinsumGemm<xpu>(
+                paths[i].einsum_str, tmp_operands[0], tmp_operands[1], step_out, &plan)) {
+          EinsumGemm<xpu>(plan,
+                          tmp_operands[0],
+                          tmp_operands[1],
+                          handle_out ? req[0] : OpReqType::kWriteTo,
+                          step_out,
+                          ctx);
+        } else {
+          NumpyEinsumProcess<xpu, 0>(tmp_operands,
+                                     handle_out ? req : std::vector<OpReqType>{OpReqType::kWriteTo},
+                                     std::vector<TBlob>{step_out},
+                                     paths[i].einsum_str.c_str(),
+                                     tmp_operands.size(),
+                                     ctx);
+        }
       }
       if (!handle_out) {
         operands.push_back(temp_space_vec[i]);
@@ -892,6 +1186,19 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
   CHECK_EQ(inputs.size(), 1 + num_args);
   CHECK_EQ(outputs.size(), num_args);
   if (optimize == 0) {
+    // the gradients of a batched GEMM are batched GEMMs, of the output gradient and the other
+    // operand, e.g. "bik,bjk->bij" and "bik,bij->bjk" of "bij,bjk->bik"
+    EinsumGemmPlan plan, lhs_plan, rhs_plan;
+    std::string lhs_subscripts, rhs_subscripts;
+    if (num_args == 2 &&
+        PlanEinsumGemm<xpu>(state.subscripts, inputs[1], inputs[2], inputs[0], &plan) &&
+        EinsumGradSubscripts(state.subscripts, &lhs_subscripts, &rhs_subscripts) &&
+        PlanEinsumGemm<xpu>(lhs_subscripts, inputs[0], inputs[2], outputs[0], &lhs_plan) &&
+        PlanEinsumGemm<xpu>(rhs_subscripts, inputs[0], inputs[1], outputs[1], &rhs_plan)) {
+      EinsumGemm<xpu>(lhs_plan, inputs[0], inputs[2], req[0], outputs[0], ctx);
+      EinsumGemm<xpu>(rhs_plan, inputs[0], inputs[1], req[1], outputs[1], ctx);
+      return;
+    }
     NumpyEinsumProcess<xpu, 1>(inputs, req, outputs, subscripts, num_args, ctx);
     return;
   }
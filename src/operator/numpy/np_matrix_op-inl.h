@@ -1217,6 +1217,18 @@ void NumpyConcatenateForward(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*! \brief the inputs of concatenate are contiguous when flattened, see ConcatInputOffsets */
+inline std::vector<std::pair<int, size_t>> NumpyConcatenateViewInputs(
+    const nnvm::NodeAttrs& attrs,
+    const mxnet::ShapeVector& ishapes) {
+  const NumpyConcatenateParam& param = nnvm::get<NumpyConcatenateParam>(attrs.parsed);
+  if (!param.axis.has_value())
+    return ConcatInputOffsets(ishapes, 0);
+  if (ishapes.empty() || ishapes[0].ndim() <= 0)
+    return {};
+  return ConcatInputOffsets(ishapes, CheckAxis(param.axis.value(), ishapes[0].ndim()));
+}
+
 template <typename xpu>
 void NumpyConcatenateBackward(const nnvm::NodeAttrs& attrs,
                               const OpContext& ctx,
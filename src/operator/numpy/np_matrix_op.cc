@@ -706,6 +706,7 @@ NNVM_REGISTER_OP(_npi_concatenate)
     .set_attr<nnvm::FInferType>("FInferType", NumpyConcatenateType)
     .set_attr<mxnet::FInferShape>("FInferShape", NumpyConcatenateShape)
     .set_attr<FCompute>("FCompute<cpu>", NumpyConcatenateForward<cpu>)
+    .set_attr<FViewInputs>("FViewInputs", NumpyConcatenateViewInputs)
     .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_backward_np_concat"})
     .add_argument("data", "NDArray-or-Symbol[]", "List of arrays to concatenate")
     .add_arguments(ConcatParam::__FIELDS__());
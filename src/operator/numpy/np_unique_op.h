@@ -28,12 +28,12 @@
 #include <dmlc/optional.h>
 #include <vector>
 #include <numeric>
-#include <set>
 #include <string>
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../mshadow_op.h"
 #include "../contrib/boolean_mask-inl.h"
+#include "../tensor/sort_op.h"
 #ifdef __CUDACC__
 #include <thrust/device_ptr.h>
 #include <thrust/device_vector.h>
@@ -151,6 +151,15 @@ inline std::string type_string(const int& x) {
   return "unknown";
 }
 
+/*!
+ * \brief whether out is placed at offset elements in the memory of in, see FViewOutputs and
+ *  FViewInputs
+ */
+inline bool IsViewOutput(const TBlob& in, const TBlob& out, size_t offset) {
+  const size_t offset_bytes = offset * mshadow::mshadow_sizeof(in.type_flag_);
+  return out.dptr_ == static_cast<char*>(in.dptr_) + offset_bytes;
+}
+
 /*!
  * \brief Assign x to y. Checks for compatiblity when y is not empty.
  *  Allow missing dim in both x and y (as 0).
@@ -30,6 +30,7 @@
 #include <vector>
 #include <algorithm>
 #include <list>
+#include <mutex>
 #include <random>
 #include <unordered_set>
 #include "./mxnet_op.h"
@@ -117,10 +118,11 @@ class OperatorTune : public OperatorTuneByType<DType> {
   }
 
   /*!
-   * \brief Initialize the OperatorTune object
+   * \brief Initialize the OperatorTune object, at the first launch of a tuned kernel of DType
    * \return Whether the OperatorTune object was successfully initialized
    */
   static bool Initialize() {
+    std::lock_guard<std::mutex> lock(OperatorTuneBase::init_mutex_);
     if (!initialized_) {
       initialized_ = true;
       // Generate some random data for calling the operator kernels
@@ -163,16 +165,15 @@ class OperatorTune : public OperatorTuneByType<DType> {
       // This isn't actually supposed to be multithreaded init, but just to be sure the change is
       // seen everywhere, using atomic bool.
       if (!OperatorTuneBase::calculated_.load()) {
-        // Not especially concerned with a race condition, since this hsould
-        // run when only one thread is active (static init), just don't cache this variable
         OperatorTuneBase::calculated_.store(true);
         std::string config = dmlc::GetEnv("MXNET_USE_OPERATOR_TUNING", std::string());
         StringUtil::trim(&config);
         // disabled
         if (!config.empty() && ::isdigit(config[0]) && std::atoi(config.c_str()) == 0) {
           OperatorTuneBase::omp_overhead_ns_ = INT_MAX;
-        } else {
+        } else if (!OperatorTuneBase::LoadOMPOverhead(&OperatorTuneBase::omp_overhead_ns_)) {
           OperatorTuneBase::omp_overhead_ns_ = GetOMPLoopOverhead();
+          OperatorTuneBase::StoreOMPOverhead(OperatorTuneBase::omp_overhead_ns_);
         }
         ParseEnablerConfig(config);
       }
@@ -194,8 +195,9 @@ class OperatorTune : public OperatorTuneByType<DType> {
   static bool ScheduleTune(void (*tune_func)()) {
 #ifdef MXNET_USE_OPERATOR_TUNING
     if (tune_func) {
+      // static initialization only records the kernel, it is tuned at its first launch
       GetTuningList()->push_back(tune_func);
-      operator_names_.insert(demangle(typeid(OP).name()));
+      operator_names_.insert(typeid(OP).name());
       return true;
     }
     return false;
@@ -211,7 +213,30 @@ class OperatorTune : public OperatorTuneByType<DType> {
    */
   template <typename OP>
   static bool IsTuned() {
-    return operator_names_.find(demangle(typeid(OP).name())) != operator_names_.end();
+    return operator_names_.find(typeid(OP).name()) != operator_names_.end();
+  }
+
+  /*!
+   * \brief Tune a kernel operator at its first launch, or take the workload measured by an
+   *        earlier run from MXNET_OPERATOR_TUNING_FILE
+   * \tparam TUNED_OP tuned_op of the kernel operator and DType
+   * \param tune_func Function to call which tunes the operator
+   * \return true, to initialize a static variable of the UseOMP() of the kernel
+   */
+  template <typename TUNED_OP>
+  static bool TuneOnFirstUse(void (*tune_func)()) {
+    Initialize();
+#ifdef MXNET_USE_OPERATOR_TUNING
+    // the workload is only used by the automatic tuning mode
+    if (OperatorTuneByType<DType>::tuning_mode() == tune::kAuto) {
+      const char* name = typeid(TUNED_OP).name();
+      if (!OperatorTuneBase::LoadWorkload(name, &TUNED_OP::workload_[0])) {
+        tune_func();
+        OperatorTuneBase::StoreWorkload(name, TUNED_OP::workload_[0]);
+      }
+    }
+#endif
+    return true;
   }
 
   /*!\
@@ -250,8 +275,11 @@ class OperatorTune : public OperatorTuneByType<DType> {
    *        that the operator has been tuned.
    * \return Set of operator/kernel names that were registered for tuning
    */
-  static const std::unordered_set<std::string>& TunedOperatorNames() {
-    return operator_names_;
+  static std::unordered_set<std::string> TunedOperatorNames() {
+    std::unordered_set<std::string> names;
+    for (const std::string& name : operator_names_)
+      names.insert(demangle(name.c_str()));
+    return names;
   }
 
  protected:
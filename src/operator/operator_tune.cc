@@ -18,6 +18,10 @@
  */
 #include <cfloat>
 #include <atomic>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
 #include "./mxnet_op.h"
 #include "./mshadow_op.h"
 #include "./tensor/init_op.h"
@@ -33,6 +37,194 @@ namespace op {
 std::atomic<bool> OperatorTuneBase::calculated_(false);
 bool OperatorTuneBase::verbose_tuning_info_   = false;
 double OperatorTuneBase::tuning_weight_scale_ = 0.0;
+std::mutex OperatorTuneBase::init_mutex_;
+
+namespace {
+/*! \brief a choice of AdaptiveOMPTuning, a line of MXNET_OPERATOR_TUNING_FILE */
+struct AdaptiveOMPRecord {
+  int thread_count;
+  int log2;
+  int choice;
+  double serial_ns;
+  double omp_ns;
+};
+
+/*! \brief the tables of the kernels, which saves their choices at exit */
+struct AdaptiveOMPTables {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<AdaptiveOMPTuning::Table>> tables;
+  /*! \brief the records of the file, of the kernels not launched yet */
+  std::unordered_map<std::string, std::vector<AdaptiveOMPRecord>> loaded;
+  /*! \brief the startup workloads of the kernels, measured by this run or by an earlier one */
+  std::unordered_map<std::string, float> workloads;
+  OperatorTuneBase::duration_t omp_overhead_ns = -1;
+  const std::string path = dmlc::GetEnv("MXNET_OPERATOR_TUNING_FILE", std::string());
+
+  AdaptiveOMPTables() {
+    if (path.empty())
+      return;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream is(line);
+      std::string name;
+      AdaptiveOMPRecord record;
+      if (line.compare(0, 9, "workload ") == 0) {
+        float workload;
+        if (is >> name >> name >> workload && workload > 0)
+          workloads[name] = workload;
+        continue;
+      }
+      if (line.compare(0, 16, "omp_overhead_ns ") == 0) {
+        if (!(is >> name >> omp_overhead_ns) || omp_overhead_ns <= 0)
+          omp_overhead_ns = -1;
+        continue;
+      }
+      if (is >> name >> record.thread_count >> record.log2 >> record.choice >> record.serial_ns >>
+          record.omp_ns) {
+        if (record.thread_count > 1 && record.log2 >= 0 &&
+            record.log2 < AdaptiveOMPTuning::kBuckets &&
+            (record.choice == AdaptiveOMPTuning::kSerial ||
+             record.choice == AdaptiveOMPTuning::kOMP))
+          loaded[name].push_back(record);
+      }
+    }
+  }
+
+  ~AdaptiveOMPTables() {
+    Save();
+  }
+
+  void Save() {
+    if (path.empty())
+      return;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ofstream out(path);
+    if (omp_overhead_ns > 0)
+      out << "omp_overhead_ns " << omp_overhead_ns << '\n';
+    for (const auto& named : workloads)
+      out << "workload " << named.first << ' ' << named.second << '\n';
+    for (const auto& named : tables) {
+      for (const AdaptiveOMPTuning::ThreadSlot& slot : named.second->slots) {
+        const int thread_count = slot.thread_count.load();
+        for (int log2 = 0; thread_count > 0 && log2 < AdaptiveOMPTuning::kBuckets; ++log2) {
+          const AdaptiveOMPTuning::Bucket& bucket = slot.buckets[log2];
+          const int choice                        = bucket.choice.load();
+          if (choice != AdaptiveOMPTuning::kUndecided) {
+            out << named.first << ' ' << thread_count << ' ' << log2 << ' ' << choice << ' '
+                << bucket.serial_ns.load() << ' ' << bucket.omp_ns.load() << '\n';
+          }
+        }
+      }
+    }
+    // the kernels of the file not launched in this run are kept
+    for (const auto& named : loaded) {
+      for (const AdaptiveOMPRecord& record : named.second) {
+        out << named.first << ' ' << record.thread_count << ' ' << record.log2 << ' '
+            << record.choice << ' ' << record.serial_ns << ' ' << record.omp_ns << '\n';
+      }
+    }
+  }
+};
+
+AdaptiveOMPTables* GetAdaptiveOMPTables() {
+  static AdaptiveOMPTables tables;
+  return &tables;
+}
+}  // namespace
+
+bool AdaptiveOMPTuning::Enabled() {
+  static const bool enabled = dmlc::GetEnv("MXNET_ADAPTIVE_OPERATOR_TUNING", true);
+  return enabled;
+}
+
+AdaptiveOMPTuning::Table* AdaptiveOMPTuning::Get(const std::string& name) {
+  AdaptiveOMPTables* tables = GetAdaptiveOMPTables();
+  std::lock_guard<std::mutex> lock(tables->mutex);
+  std::unique_ptr<Table>& table = tables->tables[name];
+  if (!table) {
+    table.reset(new Table());
+    auto it = tables->loaded.find(name);
+    if (it != tables->loaded.end()) {
+      for (const AdaptiveOMPRecord& record : it->second) {
+        Bucket* bucket = FindBucket(table.get(), size_t(1) << record.log2, record.thread_count);
+        if (bucket == nullptr)
+          continue;
+        bucket->serial_ns.store(record.serial_ns);
+        bucket->omp_ns.store(record.omp_ns);
+        bucket->serial_samples.store(record.choice == kSerial ? kMinSamples : 0);
+        bucket->omp_samples.store(kMinSamples);
+        bucket->choice.store(record.choice);
+      }
+      tables->loaded.erase(it);
+    }
+  }
+  return table.get();
+}
+
+void AdaptiveOMPTuning::Record(Table* table,
+                               const Decision& decision,
+                               const size_t N,
+                               const int thread_count,
+                               const int64_t ns) {
+  Bucket* bucket = decision.bucket;
+  std::lock_guard<std::mutex> lock(table->mutex);
+  std::atomic<int>& samples = decision.omp ? bucket->omp_samples : bucket->serial_samples;
+  std::atomic<double>& mean = decision.omp ? bucket->omp_ns : bucket->serial_ns;
+  const int count           = samples.load();
+  // a running mean over about the last 2 * kMinSamples launches, which follows the contention
+  const double weight = 1.0 / std::min(count + 1, 2 * kMinSamples);
+  mean.store(count == 0 ? ns : mean.load() + weight * (ns - mean.load()));
+  samples.store(std::min(count + 1, 1 << 20));
+  const int serial = bucket->serial_samples.load();
+  const int omp    = bucket->omp_samples.load();
+  if (omp < kMinSamples || (serial < kMinSamples && SerialTrialAllowed(*bucket, thread_count)))
+    return;
+  const int choice =
+      serial >= kMinSamples && bucket->serial_ns.load() <= bucket->omp_ns.load() ? kSerial : kOMP;
+  if (bucket->choice.exchange(choice) != choice && verbose_tuning_info_) {
+    LOG(INFO) << "OMP " << (choice == kOMP ? "on" : "off") << " for " << thread_count
+              << " threads and about " << N << " iterations after " << serial << " serial and "
+              << omp << " OMP launches";
+  }
+}
+
+void AdaptiveOMPTuning::Save() {
+  GetAdaptiveOMPTables()->Save();
+}
+
+bool OperatorTuneBase::LoadWorkload(const std::string& name, float* workload) {
+  AdaptiveOMPTables* tables = GetAdaptiveOMPTables();
+  std::lock_guard<std::mutex> lock(tables->mutex);
+  auto it = tables->workloads.find(name);
+  if (it == tables->workloads.end())
+    return false;
+  *workload = it->second;
+  return true;
+}
+
+void OperatorTuneBase::StoreWorkload(const std::string& name, float workload) {
+  AdaptiveOMPTables* tables = GetAdaptiveOMPTables();
+  if (tables->path.empty())
+    return;
+  std::lock_guard<std::mutex> lock(tables->mutex);
+  tables->workloads[name] = workload;
+}
+
+bool OperatorTuneBase::LoadOMPOverhead(duration_t* omp_overhead_ns) {
+  AdaptiveOMPTables* tables = GetAdaptiveOMPTables();
+  std::lock_guard<std::mutex> lock(tables->mutex);
+  if (tables->omp_overhead_ns <= 0)
+    return false;
+  *omp_overhead_ns = tables->omp_overhead_ns;
+  return true;
+}
+
+void OperatorTuneBase::StoreOMPOverhead(duration_t omp_overhead_ns) {
+  AdaptiveOMPTables* tables = GetAdaptiveOMPTables();
+  std::lock_guard<std::mutex> lock(tables->mutex);
+  tables->omp_overhead_ns = tables->path.empty() ? -1 : omp_overhead_ns;
+}
 
 /*!
  * \brief Instantiate static variables for OperatorTune<DType>, where 'DType' is specified
@@ -131,6 +323,10 @@ struct static_init_var {
   namespace mxnet_op {                                                                        \
   template <>                                                                                 \
   bool ::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::UseOMP(size_t N, size_t omp_threads) { \
+    static const bool tuned =                                                                 \
+        ::mxnet::op::OperatorTune<__typ$>::TuneOnFirstUse<mxnet_op::tuned_op<__op$, __typ$>>( \
+            ::mxnet::op::UnaryOpTune<__typ$>::TuneBlankOperatorEx<__op$>);                    \
+    static_cast<void>(tuned);                                                                 \
     return ::mxnet::op::UnaryOpTune<__typ$>::UseOMP<mxnet_op::tuned_op<__op$, __typ$>>(       \
         N, omp_threads);                                                                      \
   }                                                                                           \
@@ -148,6 +344,10 @@ struct static_init_var {
   namespace mxnet_op {                                                                        \
   template <>                                                                                 \
   bool ::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::UseOMP(size_t N, size_t omp_threads) { \
+    static const bool tuned =                                                                 \
+        ::mxnet::op::OperatorTune<__typ$>::TuneOnFirstUse<mxnet_op::tuned_op<__op$, __typ$>>( \
+            ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryOperator<__op$>);                      \
+    static_cast<void>(tuned);                                                                 \
     return ::mxnet::op::UnaryOpTune<__typ$>::UseOMP<mxnet_op::tuned_op<__op$, __typ$>>(       \
         N, omp_threads);                                                                      \
   }                                                                                           \
@@ -166,6 +366,10 @@ struct static_init_var {
   template <>                                                                                   \
   bool ::mxnet::op::mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>,       \
                                        __typ$>::UseOMP(size_t N, size_t omp_threads) {          \
+    static const bool tuned = ::mxnet::op::OperatorTune<__typ$>::TuneOnFirstUse<                \
+        mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>>(         \
+        ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryBackwardOperator<__op$>);                    \
+    static_cast<void>(tuned);                                                                   \
     return ::mxnet::op::UnaryOpTune<__typ$>::UseOMP<                                            \
         mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>>(         \
         N, omp_threads);                                                                        \
@@ -184,6 +388,10 @@ struct static_init_var {
   namespace mxnet_op {                                                                        \
   template <>                                                                                 \
   bool ::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::UseOMP(size_t N, size_t omp_threads) { \
+    static const bool tuned =                                                                 \
+        ::mxnet::op::OperatorTune<__typ$>::TuneOnFirstUse<mxnet_op::tuned_op<__op$, __typ$>>( \
+            ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryOperator<__op$>);                    \
+    static_cast<void>(tuned);                                                                 \
     return ::mxnet::op::BinaryOpTune<__typ$>::UseOMP<mxnet_op::tuned_op<__op$, __typ$>>(      \
         N, omp_threads);                                                                      \
   }                                                                                           \
@@ -202,6 +410,10 @@ struct static_init_var {
   template <>                                                                                   \
   bool ::mxnet::op::mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>,       \
                                        __typ$>::UseOMP(size_t N, size_t omp_threads) {          \
+    static const bool tuned = ::mxnet::op::OperatorTune<__typ$>::TuneOnFirstUse<                \
+        mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>>(         \
+        ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryBackwardOperator<__op$>);                  \
+    static_cast<void>(tuned);                                                                   \
     return ::mxnet::op::BinaryOpTune<__typ$>::UseOMP<                                           \
         mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>>(         \
         N, omp_threads);                                                                        \
@@ -466,17 +678,25 @@ IMPLEMENT_BINARY_WORKLOAD_BWD(mxnet::op::mshadow_op::rldexp_grad);
 IMPLEMENT_BINARY_WORKLOAD_BWD(mxnet::op::mshadow_op::posone);                      // NOLINT()
 IMPLEMENT_BINARY_WORKLOAD_BWD(mxnet::op::mshadow_op::negone);                      // NOLINT()
 /*!
- * \brief Tuner objects, *not* automatically generated
+ * \brief The kernels are tuned at their first launch, unless MXNET_OUTPUT_TUNING_DATA asks
+ *        for the tuning data of all of them at startup
  */
 #ifdef MXNET_USE_OPERATOR_TUNING
-static BinaryOpTune<float> binaryOpTuneFloat;
-static BinaryOpTune<double> binaryOpTuneDouble;
-static BinaryOpTune<mshadow::half::half_t> binaryOpTuneHalf;
-static BinaryOpTune<mshadow::bfloat::bf16_t> binaryOpTuneBf16;
-static BinaryOpTune<int8_t> binaryOpTuneInt8;
-static BinaryOpTune<uint8_t> binaryOpTuneUInt8;
-static BinaryOpTune<int32_t> binaryOpTuneInt32;
-static BinaryOpTune<int64_t> binaryOpTuneInt64;
+struct EagerOperatorTuning {
+  EagerOperatorTuning() {
+    if (!dmlc::GetEnv("MXNET_OUTPUT_TUNING_DATA", false))
+      return;
+    BinaryOpTune<float>::TuneAll();
+    BinaryOpTune<double>::TuneAll();
+    BinaryOpTune<mshadow::half::half_t>::TuneAll();
+    BinaryOpTune<mshadow::bfloat::bf16_t>::TuneAll();
+    BinaryOpTune<int8_t>::TuneAll();
+    BinaryOpTune<uint8_t>::TuneAll();
+    BinaryOpTune<int32_t>::TuneAll();
+    BinaryOpTune<int64_t>::TuneAll();
+  }
+};
+static EagerOperatorTuning eager_operator_tuning;
 #endif  // MXNET_USE_OPERATOR_TUNING
 }  // namespace op
 }  // namespace mxnet
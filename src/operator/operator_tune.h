@@ -24,6 +24,7 @@
 #include <vector>
 #include <set>
 #include <atomic>
+#include <mutex>
 #include <string>
 
 // #define MXNET_DEBUG_TUNING_LAUNCH
@@ -76,6 +77,23 @@ class OperatorTuneBase {
   static bool verbose_tuning_info_;
   /*! \brief Tuning scale factor */
   static double tuning_weight_scale_;
+  /*! \brief Serializes the lazy initialization of the tuning of the data types */
+  static std::mutex init_mutex_;
+
+  /*!
+   * \brief The workload of a tuned kernel measured by an earlier run, from
+   *        MXNET_OPERATOR_TUNING_FILE
+   * \param name (mangled) name of the tuned kernel
+   * \param workload where to write the workload
+   * \return whether the file has the workload of the kernel
+   */
+  static bool LoadWorkload(const std::string& name, float* workload);
+  /*! \brief Keeps the workload of a tuned kernel, to write it to MXNET_OPERATOR_TUNING_FILE */
+  static void StoreWorkload(const std::string& name, float workload);
+  /*! \brief The OMP overhead measured by an earlier run, from MXNET_OPERATOR_TUNING_FILE */
+  static bool LoadOMPOverhead(duration_t* omp_overhead_ns);
+  /*! \brief Keeps the OMP overhead, to write it to MXNET_OPERATOR_TUNING_FILE */
+  static void StoreOMPOverhead(duration_t omp_overhead_ns);
 
  public:
   typedef std::chrono::high_resolution_clock::time_point Tick;
@@ -217,6 +235,125 @@ class OperatorTuneByType : public OperatorTuneBase {
 // template <typename DType>
 // volatile tune::TuningMode OperatorTuneByType<DType>::tuning_mode_;
 
+/*!
+ * \brief Online choice of OMP of the tuned kernels per size bucket (log2 of N) and thread
+ *  count, from the durations of their launches. The workloads timed at startup ignore the
+ *  shapes and the contention of the engine workers running ops concurrently.
+ *
+ * The launches of a bucket are timed until both the serial and the OMP loops have
+ * kMinSamples, then the faster one is used, and one launch in kResamplePeriod times one of
+ * them again. The serial loop is not tried when it would take more than kMaxSerialTrialNs
+ * by the OMP durations. Enabled by MXNET_ADAPTIVE_OPERATOR_TUNING, the choices are loaded
+ * from and saved to MXNET_OPERATOR_TUNING_FILE, along with the startup workloads.
+ */
+class AdaptiveOMPTuning : public OperatorTuneBase {
+ public:
+  static constexpr int kBuckets = 64;
+  /*! \brief distinct thread counts learned per kernel, the launches with others use UseOMP */
+  static constexpr int kThreadSlots         = 4;
+  static constexpr int kMinSamples          = 4;
+  static constexpr int kResamplePeriod      = 128;
+  static constexpr double kMaxSerialTrialNs = 2e6;
+
+  enum Choice { kUndecided, kSerial, kOMP };
+
+  struct Bucket {
+    std::atomic<int> choice{kUndecided};
+    std::atomic<int> serial_samples{0};
+    std::atomic<int> omp_samples{0};
+    std::atomic<uint32_t> launches{0};
+    /*! \brief running means of the durations, written under the mutex of the table */
+    std::atomic<double> serial_ns{0};
+    std::atomic<double> omp_ns{0};
+  };
+
+  struct ThreadSlot {
+    std::atomic<int> thread_count{0};
+    Bucket buckets[kBuckets];
+  };
+
+  /*! \brief the buckets of a kernel and data type */
+  struct Table {
+    ThreadSlot slots[kThreadSlots];
+    std::mutex mutex;
+  };
+
+  /*! \brief whether to use OMP for a launch, and whether to time it */
+  struct Decision {
+    bool omp;
+    bool timed;
+    Bucket* bucket;
+  };
+
+  static bool Enabled();
+
+  /*! \brief the table of a kernel by its (mangled) name, with the choices loaded from the file */
+  static Table* Get(const std::string& name);
+
+  /*!
+   * \brief the choice of a launch of N iterations with thread_count threads
+   * \param use_omp the choice of the startup workloads, used until the bucket is learned
+   */
+  static inline Decision Choose(Table* table, size_t N, int thread_count, bool use_omp) {
+    const Decision untimed = {use_omp, false, nullptr};
+    if (N == 0)
+      return untimed;
+    Bucket* bucket = FindBucket(table, N, thread_count);
+    if (bucket == nullptr)
+      return untimed;
+    const int choice = bucket->choice.load(std::memory_order_relaxed);
+    if (choice != kUndecided) {
+      const uint32_t launch = bucket->launches.fetch_add(1, std::memory_order_relaxed);
+      const bool omp        = choice == kOMP;
+      switch (launch % kResamplePeriod) {
+        case 0:
+          // the other loop, unless it is the serial one and too slow
+          return {!omp || !SerialTrialAllowed(*bucket, thread_count), true, bucket};
+        case 1:
+          return {omp, true, bucket};
+        default:
+          return {omp, false, bucket};
+      }
+    }
+    const int serial = bucket->serial_samples.load(std::memory_order_relaxed);
+    const int omp    = bucket->omp_samples.load(std::memory_order_relaxed);
+    if (serial == omp)
+      return {use_omp || !SerialTrialAllowed(*bucket, thread_count), true, bucket};
+    return {serial > omp || !SerialTrialAllowed(*bucket, thread_count), true, bucket};
+  }
+
+  /*! \brief records the duration of a timed launch, and updates the choice of its bucket */
+  static void Record(Table* table,
+                     const Decision& decision,
+                     size_t N,
+                     int thread_count,
+                     int64_t ns);
+
+  /*! \brief writes the learned choices to MXNET_OPERATOR_TUNING_FILE */
+  static void Save();
+
+ private:
+  static inline Bucket* FindBucket(Table* table, size_t N, int thread_count) {
+    int log2 = 0;
+    while ((N >> log2) > 1)
+      ++log2;
+    for (ThreadSlot& slot : table->slots) {
+      int count = slot.thread_count.load(std::memory_order_acquire);
+      if (count == 0 && slot.thread_count.compare_exchange_strong(count, thread_count))
+        return &slot.buckets[log2];
+      if (count == thread_count)
+        return &slot.buckets[log2];
+    }
+    return nullptr;
+  }
+
+  /*! \brief whether the serial loop may be timed, i.e. it is not far slower than the OMP one */
+  static inline bool SerialTrialAllowed(const Bucket& bucket, int thread_count) {
+    return bucket.omp_samples.load(std::memory_order_relaxed) == 0 ||
+           bucket.omp_ns.load(std::memory_order_relaxed) * thread_count < kMaxSerialTrialNs;
+  }
+};
+
 namespace mxnet_op {
 /*!
  * \brief Kernel operator wrapper used for tuning data
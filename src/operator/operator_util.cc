@@ -471,7 +471,8 @@ void SimpleOpRegEntryImpl::RegisterSourceImperative() {
     std::vector<Engine::VarHandle> write_vars = {ret.var()};
     for (ResourceRequest req : resource_requests_) {
       env.resource.push_back(ResourceManager::Get()->Request(ret.ctx(), req));
-      write_vars.push_back(env.resource.back().var);
+      if (env.resource.back().var != nullptr)
+        write_vars.push_back(env.resource.back().var);
     }
     // check if the function exist
     int dev_mask = ret.ctx().dev_mask();
@@ -647,7 +648,8 @@ void SimpleOpRegEntryImpl::RegisterUnaryImperative() {
     std::vector<Engine::VarHandle> write_vars = {ret.var()};
     for (ResourceRequest req : resource_requests_) {
       env.resource.push_back(ResourceManager::Get()->Request(src.ctx(), req));
-      write_vars.push_back(env.resource.back().var);
+      if (env.resource.back().var != nullptr)
+        write_vars.push_back(env.resource.back().var);
     }
 
     // check if the function exist
@@ -925,7 +927,8 @@ void SimpleOpRegEntryImpl::RegisterBinaryImperative() {
     std::vector<Engine::VarHandle> write_vars = {ret.var()};
     for (ResourceRequest req : resource_requests_) {
       env.resource.push_back(ResourceManager::Get()->Request(lhs.ctx(), req));
-      write_vars.push_back(env.resource.back().var);
+      if (env.resource.back().var != nullptr)
+        write_vars.push_back(env.resource.back().var);
     }
 
     // check if the function exist
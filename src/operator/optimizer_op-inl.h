@@ -36,6 +36,7 @@
 #include "./mshadow_op.h"
 #include "./elemwise_op_common.h"
 #include "mxnet_op.h"
+#include "./multi_tensor_apply-inl.h"
 #include "./tensor/init_op.h"
 #include "./tensor/util/tensor_util-inl.h"
 
@@ -223,27 +224,34 @@ struct MultiSGDKernel {
                                   const OpReqType req) {
     for (int index = 0; index < param.count; ++index) {
       if (i < static_cast<index_t>(param.sizes[index])) {
-        MPDType w =
-            has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
-        MPDType rescale_grad = param.rescale_grad * static_cast<MPDType>(param.grads[index][i]);
-        if (param.clip_gradient >= 0.0f) {
-          rescale_grad = mshadow_op::clip::Map(rescale_grad, param.clip_gradient);
-        }
-        rescale_grad += param.wds[index] * w;
-        if (has_momentum) {
-          param.mom[index][i] *= param.momentum;
-          param.mom[index][i] -= param.lrs[index] * rescale_grad;
-          w = w + param.mom[index][i];
-        } else {
-          w -= param.lrs[index] * rescale_grad;
-        }
-        if (has_mixed_precision) {
-          param.weights32[index][i] = w;
-        }
-        KERNEL_ASSIGN(param.out_data[index][i], req, w);
+        MapElement(index, i, param, req);
       }
     }
   }
+
+  template <typename DType>
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiSGDKernelParam<DType, MPDType>& param,
+                                         const OpReqType req) {
+    MPDType w = has_mixed_precision ? param.weights32[index][i] : MPDType(param.weights[index][i]);
+    MPDType rescale_grad = param.rescale_grad * static_cast<MPDType>(param.grads[index][i]);
+    if (param.clip_gradient >= 0.0f) {
+      rescale_grad = mshadow_op::clip::Map(rescale_grad, param.clip_gradient);
+    }
+    rescale_grad += param.wds[index] * w;
+    if (has_momentum) {
+      param.mom[index][i] *= param.momentum;
+      param.mom[index][i] -= param.lrs[index] * rescale_grad;
+      w = w + param.mom[index][i];
+    } else {
+      w -= param.lrs[index] * rescale_grad;
+    }
+    if (has_mixed_precision) {
+      param.weights32[index][i] = w;
+    }
+    KERNEL_ASSIGN(param.out_data[index][i], req, w);
+  }
 };
 
 template <typename xpu,
@@ -329,8 +337,8 @@ inline void MultiSGDUpdate(const nnvm::NodeAttrs& attrs,
     MultiSGDKernelParam<DType, MPDType> param =
         FillMultiSGDKernelParam<xpu, DType, MPDType, MultiSGDParam, input_stride>(
             attrs, ctx, inputs, outputs);
-    Kernel<MultiSGDKernel<MPDType, false, !std::is_same<DType, MPDType>::value>, xpu>::Launch(
-        s, param.max_size, param, req[0]);
+    Kernel<MultiSGDKernel<MPDType, false, !std::is_same<DType, MPDType>::value>, xpu>::
+        LaunchMultiTensor(s, param.count, param.sizes, param, req[0]);
   });
 }
 
@@ -346,8 +354,8 @@ inline void MultiSGDMomUpdate(const nnvm::NodeAttrs& attrs,
     using MPDType = typename MPTypeChooser<DType>::type;
     MultiSGDKernelParam<DType, MPDType> param =
         FillMultiSGDMomKernelParam<xpu, DType, MPDType, input_stride>(attrs, ctx, inputs, outputs);
-    Kernel<MultiSGDKernel<MPDType, true, !std::is_same<DType, MPDType>::value>, xpu>::Launch(
-        s, param.max_size, param, req[0]);
+    Kernel<MultiSGDKernel<MPDType, true, !std::is_same<DType, MPDType>::value>, xpu>::
+        LaunchMultiTensor(s, param.count, param.sizes, param, req[0]);
   });
 }
 
@@ -2933,6 +2941,446 @@ inline void AdagradUpdateEx(const nnvm::NodeAttrs& attrs,
   }
 }
 
+struct MultiLazyAdamParam : public dmlc::Parameter<MultiLazyAdamParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiLazyAdamParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe(
+        "Weight decays, only applied to the rows of the weights in the gradients.");
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
+        "The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe(
+        "The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+struct MultiAdagradParam : public dmlc::Parameter<MultiAdagradParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiAdagradParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe(
+        "Weight decays, only applied to the rows of the weights in the gradients.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1.0e-7).describe("epsilon");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+/*!
+ * \brief storage type inference of the multi-tensor row_sparse updates, every weight and its
+ *  states share a dense or row_sparse stype and every gradient is row_sparse
+ */
+template <typename ParamType, int input_stride>
+inline bool MultiLazyRspStorageType(const nnvm::NodeAttrs& attrs,
+                                    const int dev_mask,
+                                    DispatchMode* dispatch_mode,
+                                    std::vector<int>* in_attrs,
+                                    std::vector<int>* out_attrs) {
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), input_stride * param.num_weights);
+  CHECK_EQ(out_attrs->size(), param.num_weights);
+  for (int i = 0; i < param.num_weights; ++i) {
+    const int weight_stype = in_attrs->at(i * input_stride);
+    if (in_attrs->at(i * input_stride + 1) != kRowSparseStorage ||
+        (weight_stype != kDefaultStorage && weight_stype != kRowSparseStorage)) {
+      return false;
+    }
+    for (int j = 2; j < input_stride; ++j) {
+      if (in_attrs->at(i * input_stride + j) != weight_stype) {
+        return false;
+      }
+    }
+    if (!type_assign(&(*out_attrs)[i], weight_stype)) {
+      return false;
+    }
+  }
+  return dispatch_mode_assign(dispatch_mode, DispatchMode::kFComputeEx);
+}
+
+/*!
+ * \brief the weights, row_sparse gradients and states of up to N updates of a launch. state1
+ *  and state2 are the mean and var of adam, state1 is the history of adagrad.
+ */
+template <typename DType, typename IType>
+struct MultiLazyRspKernelParam {
+  // the kernel arguments of a gpu launch are at most 4KB
+  static const int N = 48;
+  int count;
+  index_t sizes[N];
+  index_t row_lengths[N];
+  DType* weights[N];
+  const IType* grad_idx[N];
+  const DType* grads[N];
+  DType* state1[N];
+  DType* state2[N];
+  DType* out_data[N];
+  DType lrs[N];
+  DType wds[N];
+  DType beta1;
+  DType beta2;
+  DType epsilon;
+  DType rescale_grad;
+  DType clip_gradient;
+};
+
+/*!
+ * \brief lazy update of the rows of all the weights in their gradients, the i-th element of
+ *  the values of a gradient updates the row of the weight and of all its states in one pass
+ */
+template <typename Update>
+struct MultiLazyRspKernel {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i, const MultiLazyRspKernelParam<DType, IType>& param) {
+    for (int index = 0; index < param.count; ++index) {
+      if (i < param.sizes[index]) {
+        MapElement(index, i, param);
+      }
+    }
+  }
+
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void MapElement(const int index,
+                                         index_t i,
+                                         const MultiLazyRspKernelParam<DType, IType>& param) {
+    const index_t row_length = param.row_lengths[index];
+    const index_t data_i =
+        static_cast<index_t>(param.grad_idx[index][i / row_length]) * row_length + i % row_length;
+    DType grad = param.grads[index][i] * param.rescale_grad;
+    if (param.clip_gradient >= 0.0f) {
+      grad = mshadow_op::clip::Map(grad, param.clip_gradient);
+    }
+    const DType weight = param.weights[index][data_i];
+    grad += param.wds[index] * weight;
+    const DType step              = Update::Map(index, data_i, grad, param);
+    param.out_data[index][data_i] = weight - param.lrs[index] * step;
+  }
+};
+
+struct MultiLazyAdamUpdate {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static DType Map(const int index,
+                                   const index_t data_i,
+                                   const DType grad,
+                                   const MultiLazyRspKernelParam<DType, IType>& param) {
+    DType& mean = param.state1[index][data_i];
+    DType& var  = param.state2[index][data_i];
+    mean        = param.beta1 * mean + (1.f - param.beta1) * grad;
+    var         = param.beta2 * var + (1.f - param.beta2) * grad * grad;
+    return mean / (mshadow_op::square_root::Map(var) + param.epsilon);
+  }
+};
+
+struct MultiAdagradUpdate {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static DType Map(const int index,
+                                   const index_t data_i,
+                                   const DType grad,
+                                   const MultiLazyRspKernelParam<DType, IType>& param) {
+    DType& history = param.state1[index][data_i];
+    history += grad * grad;
+    return grad / (mshadow_op::square_root::Map(history) + param.epsilon);
+  }
+};
+
+template <typename DType, typename IType>
+inline void SetMultiLazyRspHyperParams(const MultiLazyAdamParam& p,
+                                       MultiLazyRspKernelParam<DType, IType>* param) {
+  param->beta1   = p.beta1;
+  param->beta2   = p.beta2;
+  param->epsilon = p.epsilon;
+}
+
+template <typename DType, typename IType>
+inline void SetMultiLazyRspHyperParams(const MultiAdagradParam& p,
+                                       MultiLazyRspKernelParam<DType, IType>* param) {
+  param->beta1   = 0;
+  param->beta2   = 0;
+  param->epsilon = p.epsilon;
+}
+
+/*!
+ * \brief lazy updates of num_weights weights with row_sparse gradients, in one launch per N
+ *  weights instead of one per weight, e.g. for all the embedding tables of a model.
+ */
+template <typename xpu, typename Update, typename ParamType, int input_stride>
+inline void MultiLazyRspUpdateEx(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<NDArray>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  const ParamType& p = nnvm::get<ParamType>(attrs.parsed);
+  Stream<xpu>* s     = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].dtype(), DType, {
+    MSHADOW_IDX_TYPE_SWITCH(inputs[1].aux_type(kIdx), IType, {
+      MultiLazyRspKernelParam<DType, IType> param;
+      param.count         = 0;
+      param.rescale_grad  = p.rescale_grad;
+      param.clip_gradient = p.clip_gradient;
+      SetMultiLazyRspHyperParams(p, &param);
+      for (int i = 0; i < p.num_weights; ++i) {
+        const NDArray& weight = inputs[i * input_stride];
+        const NDArray& grad   = inputs[i * input_stride + 1];
+        CHECK_EQ(grad.aux_type(kIdx), inputs[1].aux_type(kIdx))
+            << "the gradients of " << attrs.op->name << " must share their index type";
+        if (req[i] == kNullOp || !grad.storage_initialized()) {
+          continue;
+        }
+        CHECK_EQ(req[i], kWriteInplace) << "kWriteInplace is expected for " << attrs.op->name;
+        if (weight.storage_type() == kRowSparseStorage) {
+          CheckAllRowsPresent(weight, attrs.op->name, "weights");
+          for (int j = 2; j < input_stride; ++j) {
+            if (!inputs[i * input_stride + j].storage_initialized()) {
+              NDArray state_zeros = inputs[i * input_stride + j];
+              FillDnsZerosRspImpl(s, &state_zeros);
+            }
+          }
+        }
+        const int k          = param.count++;
+        param.row_lengths[k] = weight.shape().ProdShape(1, weight.shape().ndim());
+        param.sizes[k]       = grad.aux_shape(kIdx)[0] * param.row_lengths[k];
+        param.weights[k]     = weight.data().dptr<DType>();
+        param.grad_idx[k]    = grad.aux_data(kIdx).dptr<IType>();
+        param.grads[k]       = grad.data().dptr<DType>();
+        param.state1[k]      = inputs[i * input_stride + 2].data().dptr<DType>();
+        param.state2[k] =
+            input_stride > 3 ? inputs[i * input_stride + 3].data().dptr<DType>() : nullptr;
+        param.out_data[k] = outputs[i].data().dptr<DType>();
+        param.lrs[k]      = p.lrs[i];
+        param.wds[k]      = p.wds[i];
+        if (param.count == param.N) {
+          Kernel<MultiLazyRspKernel<Update>, xpu>::LaunchMultiTensor(
+              s, param.count, param.sizes, param);
+          param.count = 0;
+        }
+      }
+      if (param.count > 0) {
+        Kernel<MultiLazyRspKernel<Update>, xpu>::LaunchMultiTensor(
+            s, param.count, param.sizes, param);
+      }
+    });
+  });
+}
+
+struct MultiAdamParam : public dmlc::Parameter<MultiAdamParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiAdamParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe(
+        "Weight decay augments the objective function with a "
+        "regularization term that penalizes large weights. "
+        "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
+        "The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe(
+        "The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+struct MultiRMSPropParam : public dmlc::Parameter<MultiRMSPropParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  float rho;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  float clip_weights;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiRMSPropParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe(
+        "Weight decay augments the objective function with a "
+        "regularization term that penalizes large weights. "
+        "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(rho).set_default(0.95f).describe("The decay rate of momentum estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(clip_weights)
+        .set_default(-1.0f)
+        .describe(
+            "Clip weights to the range of [-clip_weights, clip_weights] "
+            "If clip_weights <= 0, weight clipping is turned off. "
+            "weights = max(min(weights, clip_weights), -clip_weights).");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+struct MultiAdamOp {
+  static constexpr bool kHasGrad  = true;
+  static constexpr int kNumStates = 2;
+  template <typename MPDType>
+  struct Hyper {
+    MPDType beta1;
+    MPDType beta2;
+    MPDType epsilon;
+  };
+
+  template <typename MPDType>
+  static Hyper<MPDType> MakeHyper(const MultiAdamParam& p) {
+    return {p.beta1, p.beta2, p.epsilon};
+  }
+
+  template <typename MPDType, typename Param>
+  MSHADOW_XINLINE static MPDType Map(const int index,
+                                     const index_t i,
+                                     const MPDType w,
+                                     const Param& param) {
+    const MPDType grad  = MultiTensorGrad(param, index, i) + param.wds[index] * w;
+    const MPDType beta1 = param.hyper.beta1;
+    const MPDType beta2 = param.hyper.beta2;
+    MPDType* mean       = param.states[0][index];
+    MPDType* var        = param.states[1][index];
+    mean[i]             = beta1 * mean[i] + (MPDType(1) - beta1) * grad;
+    var[i]              = beta2 * var[i] + (MPDType(1) - beta2) * mshadow_op::square::Map(grad);
+    const MPDType denom = mshadow_op::square_root::Map(var[i]) + param.hyper.epsilon;
+    return w - param.lrs[index] * mean[i] / denom;
+  }
+};
+
+struct MultiRMSPropOp {
+  static constexpr bool kHasGrad  = true;
+  static constexpr int kNumStates = 1;
+  template <typename MPDType>
+  struct Hyper {
+    MPDType rho;
+    MPDType epsilon;
+    MPDType clip_weights;
+  };
+
+  template <typename MPDType>
+  static Hyper<MPDType> MakeHyper(const MultiRMSPropParam& p) {
+    return {p.rho, p.epsilon, p.clip_weights};
+  }
+
+  template <typename MPDType, typename Param>
+  MSHADOW_XINLINE static MPDType Map(const int index,
+                                     const index_t i,
+                                     const MPDType w,
+                                     const Param& param) {
+    const MPDType grad  = MultiTensorGrad(param, index, i) + param.wds[index] * w;
+    const MPDType rho   = param.hyper.rho;
+    MPDType* state_n    = param.states[0][index];
+    state_n[i]          = (MPDType(1) - rho) * mshadow_op::square::Map(grad) + rho * state_n[i];
+    const MPDType denom = mshadow_op::square_root::Map(state_n[i]) + param.hyper.epsilon;
+    MPDType weight      = w - param.lrs[index] * grad / denom;
+    if (param.hyper.clip_weights >= 0.0f)
+      weight = mshadow_op::clip::Map(weight, param.hyper.clip_weights);
+    return weight;
+  }
+};
+
+struct MultiNAGMomOp {
+  static constexpr bool kHasGrad  = true;
+  static constexpr int kNumStates = 1;
+  template <typename MPDType>
+  struct Hyper {
+    MPDType momentum;
+  };
+
+  template <typename MPDType>
+  static Hyper<MPDType> MakeHyper(const MultiSGDMomParam& p) {
+    return {p.momentum};
+  }
+
+  template <typename MPDType, typename Param>
+  MSHADOW_XINLINE static MPDType Map(const int index,
+                                     const index_t i,
+                                     const MPDType w,
+                                     const Param& param) {
+    const MPDType grad = MultiTensorGrad(param, index, i) + param.wds[index] * w;
+    MPDType* mom       = param.states[0][index];
+    mom[i]             = param.hyper.momentum * mom[i] - param.lrs[index] * grad;
+    return w + param.hyper.momentum * mom[i] - param.lrs[index] * grad;
+  }
+};
+
+/*!
+ * \brief updates the num_weights dense weights of the inputs with OP, N weights per launch.
+ *  The states and master copies of the weights are float32 if multi_precision.
+ */
+template <typename xpu, typename OP, typename ParamType, bool multi_precision>
+inline void MultiTensorUpdate(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  const ParamType& p = nnvm::get<ParamType>(attrs.parsed);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    using MPDType = typename std::conditional<multi_precision, float, DType>::type;
+    MultiTensorApply<xpu, OP, DType, MPDType, multi_precision>(ctx,
+                                                               inputs,
+                                                               req[0],
+                                                               outputs,
+                                                               p.lrs,
+                                                               p.wds,
+                                                               mxnet::Tuple<float>(),
+                                                               p.rescale_grad,
+                                                               p.clip_gradient,
+                                                               OP::template MakeHyper<MPDType>(p));
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
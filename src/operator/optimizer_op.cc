@@ -42,6 +42,10 @@ DMLC_REGISTER_PARAMETER(FtrlParam);
 DMLC_REGISTER_PARAMETER(SignSGDParam);
 DMLC_REGISTER_PARAMETER(SignumParam);
 DMLC_REGISTER_PARAMETER(AdagradParam);
+DMLC_REGISTER_PARAMETER(MultiLazyAdamParam);
+DMLC_REGISTER_PARAMETER(MultiAdagradParam);
+DMLC_REGISTER_PARAMETER(MultiAdamParam);
+DMLC_REGISTER_PARAMETER(MultiRMSPropParam);
 DMLC_REGISTER_PARAMETER(LambUpdatePhaseOneParam);
 DMLC_REGISTER_PARAMETER(LambUpdatePhaseTwoParam);
 
@@ -966,6 +970,426 @@ Note that non-zero values for the weight decay option are not supported.
     .add_argument("history", "NDArray-or-Symbol", "History")
     .add_arguments(AdagradParam::__FIELDS__());
 
+NNVM_REGISTER_OP(multi_lazy_adam_update)
+MXNET_ADD_SPARSE_OP_ALIAS(multi_lazy_adam_update)
+    .describe(R"code(Lazy Adam update of multiple weights with row_sparse gradients.
+
+The inputs are the weight, gradient, mean and variance of each of the ``num_weights`` weights.
+Only the row slices whose indices appear in the gradient of a weight are updated, as in
+``adam_update`` with ``lazy_update=True``::
+
+ for row in grad.indices:
+     g = clip(rescale_grad * grad[row], clip_gradient) + wd * w[row]
+     m[row] = beta1*m[row] + (1-beta1)*g
+     v[row] = beta2*v[row] + (1-beta2)*(g**2)
+     w[row] += - learning_rate * m[row] / (sqrt(v[row]) + epsilon)
+
+The weight and both states of a row are updated in one pass, and the rows of all the weights,
+e.g. the embedding tables of a model, are updated in one launch. The weights and states are all
+dense, or all row_sparse with all their rows present.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiLazyAdamParam& param = dmlc::get<MultiLazyAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 4);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiLazyAdamParam& param = dmlc::get<MultiLazyAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiLazyAdamParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiLazyAdamParam, 4>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<-1, -1>)
+    .set_attr<FInferStorageType>("FInferStorageType",
+                                 MultiLazyRspStorageType<MultiLazyAdamParam, 4>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiLazyAdamParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("mean_") + std::to_string(i));
+                                         ret.push_back(std::string("var_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiLazyAdamParam& param =
+                                         dmlc::get<MultiLazyAdamParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 2);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 4 + 2);
+                                       ret.push_back(i * 4 + 3);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FComputeEx>("FComputeEx<cpu>",
+                          MultiLazyRspUpdateEx<cpu, MultiLazyAdamUpdate, MultiLazyAdamParam, 4>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, means and variances")
+    .add_arguments(MultiLazyAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_sparse_multi_adagrad_update)
+    .describe(R"code(AdaGrad update of multiple weights with row_sparse gradients.
+
+The inputs are the weight, gradient and history of each of the ``num_weights`` weights.
+Only the row slices whose indices appear in the gradient of a weight are updated::
+
+ for row in grad.indices:
+     g = clip(rescale_grad * grad[row], clip_gradient) + wd * w[row]
+     history[row] += square(g)
+     w[row] -= learning_rate * g / (sqrt(history[row]) + epsilon)
+
+The rows of all the weights, e.g. the embedding tables of a model, are updated in one launch.
+Unlike ``adagrad_update``, the weight decays are supported, and only decay the rows updated.
+The weights and histories are all dense, or all row_sparse with all their rows present.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdagradParam& param = dmlc::get<MultiAdagradParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 3);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdagradParam& param = dmlc::get<MultiAdagradParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiAdagradParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiAdagradParam, 3>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<-1, -1>)
+    .set_attr<FInferStorageType>("FInferStorageType",
+                                 MultiLazyRspStorageType<MultiAdagradParam, 3>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiAdagradParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("history_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiAdagradParam& param =
+                                         dmlc::get<MultiAdagradParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 3 + 2);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FComputeEx>("FComputeEx<cpu>",
+                          MultiLazyRspUpdateEx<cpu, MultiAdagradUpdate, MultiAdagradParam, 3>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and histories")
+    .add_arguments(MultiAdagradParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_adam_update)
+    .describe(R"code(Adam update of any number of weights, in a few launches.
+
+The inputs are the weight, gradient, mean and variance of each of the ``num_weights`` weights,
+which are updated as in ``adam_update``::
+
+ g = clip(rescale_grad * grad, clip_gradient) + wd * w
+ m = beta1 * m + (1 - beta1) * g
+ v = beta2 * v + (1 - beta2) * (g**2)
+ w -= learning_rate * m / (sqrt(v) + epsilon)
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 4);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiAdamParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiAdamParam, 4>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<-1, -1>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiAdamParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("mean_") + std::to_string(i));
+                                         ret.push_back(std::string("var_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiAdamParam& param =
+                                         dmlc::get<MultiAdamParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 2);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 4 + 2);
+                                       ret.push_back(i * 4 + 3);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", MultiTensorUpdate<cpu, MultiAdamOp, MultiAdamParam, false>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, means and variances")
+    .add_arguments(MultiAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_mp_adam_update)
+    .describe(R"code(Multi-precision Adam update of any number of weights, in a few launches.
+
+The inputs are the weight, gradient, float32 mean and variance, and float32 master copy of each
+of the ``num_weights`` weights, see ``multi_adam_update``. The master copies are updated, and
+then cast to the weights.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 5);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiAdamParam& param = dmlc::get<MultiAdamParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiAdamParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiAdamParam, 5>)
+    .set_attr<nnvm::FInferType>("FInferType", MP_MultiSGD_InferType<MultiAdamParam, 5, 3>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiAdamParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("mean_") + std::to_string(i));
+                                         ret.push_back(std::string("var_") + std::to_string(i));
+                                         ret.push_back(std::string("weight32_") +
+                                                       std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiAdamParam& param =
+                                         dmlc::get<MultiAdamParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 3);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 5 + 2);
+                                       ret.push_back(i * 5 + 3);
+                                       ret.push_back(i * 5 + 4);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", MultiTensorUpdate<cpu, MultiAdamOp, MultiAdamParam, true>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, states and float32 weights")
+    .add_arguments(MultiAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_rmsprop_update)
+    .describe(R"code(RMSProp update of any number of weights, in a few launches.
+
+The inputs are the weight, gradient and state of each of the ``num_weights`` weights, which are
+updated as in ``rmsprop_update``::
+
+ g = clip(rescale_grad * grad, clip_gradient) + wd * w
+ n = (1 - rho) * (g**2) + rho * n
+ w = clip(w - learning_rate * g / (sqrt(n) + epsilon), clip_weights)
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 3);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiRMSPropParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiRMSPropParam, 3>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<-1, -1>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiRMSPropParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("n_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiRMSPropParam& param =
+                                         dmlc::get<MultiRMSPropParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 1);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 3 + 2);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>",
+                        MultiTensorUpdate<cpu, MultiRMSPropOp, MultiRMSPropParam, false>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and states")
+    .add_arguments(MultiRMSPropParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_mp_rmsprop_update)
+    .describe(R"code(Multi-precision RMSProp update of any number of weights, in a few launches.
+
+The inputs are the weight, gradient, float32 state and float32 master copy of each of the
+``num_weights`` weights, see ``multi_rmsprop_update``.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 4);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiRMSPropParam& param = dmlc::get<MultiRMSPropParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiRMSPropParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiRMSPropParam, 4>)
+    .set_attr<nnvm::FInferType>("FInferType", MP_MultiSGD_InferType<MultiRMSPropParam, 4, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiRMSPropParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("n_") + std::to_string(i));
+                                         ret.push_back(std::string("weight32_") +
+                                                       std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiRMSPropParam& param =
+                                         dmlc::get<MultiRMSPropParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 2);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 4 + 2);
+                                       ret.push_back(i * 4 + 3);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>",
+                        MultiTensorUpdate<cpu, MultiRMSPropOp, MultiRMSPropParam, true>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, states and float32 weights")
+    .add_arguments(MultiRMSPropParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_nag_mom_update)
+    .describe(R"code(Nesterov momentum update of any number of weights, in a few launches.
+
+The inputs are the weight, gradient and momentum of each of the ``num_weights`` weights, which
+are updated as in ``nag_mom_update``::
+
+ g = clip(rescale_grad * grad, clip_gradient) + wd * w
+ mom = momentum * mom - learning_rate * g
+ w += momentum * mom - learning_rate * g
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiSGDMomParam& param = dmlc::get<MultiSGDMomParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 3);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiSGDMomParam& param = dmlc::get<MultiSGDMomParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiSGDMomParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiSGDMomParam, 3>)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<-1, -1>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiSGDMomParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("mom_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiSGDMomParam& param =
+                                         dmlc::get<MultiSGDMomParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 1);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 3 + 2);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>",
+                        MultiTensorUpdate<cpu, MultiNAGMomOp, MultiSGDMomParam, false>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and momentums")
+    .add_arguments(MultiSGDMomParam::__FIELDS__());
+
+NNVM_REGISTER_OP(multi_mp_nag_mom_update)
+    .describe(R"code(Multi-precision NAG momentum update of any number of weights in a few launches.
+
+The inputs are the weight, gradient, float32 momentum and float32 master copy of each of the
+``num_weights`` weights, see ``multi_nag_mom_update``.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiSGDMomParam& param = dmlc::get<MultiSGDMomParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * 4);
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiSGDMomParam& param = dmlc::get<MultiSGDMomParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiSGDMomParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiSGDShape<MultiSGDMomParam, 4>)
+    .set_attr<nnvm::FInferType>("FInferType", MP_MultiSGD_InferType<MultiSGDMomParam, 4, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       uint32_t num_args =
+                                           dmlc::get<MultiSGDMomParam>(attrs.parsed).num_weights;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("weight_") + std::to_string(i));
+                                         ret.push_back(std::string("grad_") + std::to_string(i));
+                                         ret.push_back(std::string("mom_") + std::to_string(i));
+                                         ret.push_back(std::string("weight32_") +
+                                                       std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     std::vector<uint32_t> ret;
+                                     const MultiSGDMomParam& param =
+                                         dmlc::get<MultiSGDMomParam>(attrs.parsed);
+                                     ret.reserve(param.num_weights * 2);
+                                     for (int i = 0; i < param.num_weights; ++i) {
+                                       ret.push_back(i * 4 + 2);
+                                       ret.push_back(i * 4 + 3);
+                                     }
+                                     return ret;
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>",
+                        MultiTensorUpdate<cpu, MultiNAGMomOp, MultiSGDMomParam, true>)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, states and float32 weights")
+    .add_arguments(MultiSGDMomParam::__FIELDS__());
+
 NNVM_REGISTER_OP(lamb_update_phase1)
     .describe(R"code(Phase I of lamb update it performs the following operations and returns g:.
 
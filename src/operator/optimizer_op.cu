@@ -303,6 +303,37 @@ NNVM_REGISTER_OP(ftrl_update)
 NNVM_REGISTER_OP(_sparse_adagrad_update)
     .set_attr<FComputeEx>("FComputeEx<gpu>", AdagradUpdateEx<gpu>);
 
+NNVM_REGISTER_OP(multi_lazy_adam_update)
+    .set_attr<FComputeEx>("FComputeEx<gpu>",
+                          MultiLazyRspUpdateEx<gpu, MultiLazyAdamUpdate, MultiLazyAdamParam, 4>);
+
+NNVM_REGISTER_OP(_sparse_multi_adagrad_update)
+    .set_attr<FComputeEx>("FComputeEx<gpu>",
+                          MultiLazyRspUpdateEx<gpu, MultiAdagradUpdate, MultiAdagradParam, 3>);
+
+NNVM_REGISTER_OP(multi_adam_update)
+    .set_attr<FCompute>("FCompute<gpu>",
+                        MultiTensorUpdate<gpu, MultiAdamOp, MultiAdamParam, false>);
+
+NNVM_REGISTER_OP(multi_mp_adam_update)
+    .set_attr<FCompute>("FCompute<gpu>", MultiTensorUpdate<gpu, MultiAdamOp, MultiAdamParam, true>);
+
+NNVM_REGISTER_OP(multi_rmsprop_update)
+    .set_attr<FCompute>("FCompute<gpu>",
+                        MultiTensorUpdate<gpu, MultiRMSPropOp, MultiRMSPropParam, false>);
+
+NNVM_REGISTER_OP(multi_mp_rmsprop_update)
+    .set_attr<FCompute>("FCompute<gpu>",
+                        MultiTensorUpdate<gpu, MultiRMSPropOp, MultiRMSPropParam, true>);
+
+NNVM_REGISTER_OP(multi_nag_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>",
+                        MultiTensorUpdate<gpu, MultiNAGMomOp, MultiSGDMomParam, false>);
+
+NNVM_REGISTER_OP(multi_mp_nag_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>",
+                        MultiTensorUpdate<gpu, MultiNAGMomOp, MultiSGDMomParam, true>);
+
 NNVM_REGISTER_OP(lamb_update_phase1).set_attr<FCompute>("FCompute<gpu>", LambUpdatePhaseOne<gpu>);
 
 NNVM_REGISTER_OP(lamb_update_phase2).set_attr<FCompute>("FCompute<gpu>", LambUpdatePhaseTwo<gpu>);
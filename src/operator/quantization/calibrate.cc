@@ -106,6 +106,10 @@ void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
   const int num_half_quantized_bins = num_quantized_bins / 2;
   std::vector<float> thresholds(num_bins / 2 + 1 - num_quantized_bins / 2, 0.f);
   std::vector<float> divergence(thresholds.size(), 0.f);
+  // the outliers of each threshold are the sums of the bins before and after it
+  std::vector<double> hist_cumsum(num_bins + 1, 0.0);
+  for (size_t j = 0; j < num_bins; j++)
+    hist_cumsum[j + 1] = hist_cumsum[j] + hist_ptr[j];
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
   for (index_t i = num_quantized_bins / 2; i <= zero_bin_idx; i++) {
     const size_t p_bin_idx_start            = zero_bin_idx - i;
@@ -114,18 +118,12 @@ void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
 
     std::vector<size_t> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
     std::vector<float> p(p_bin_idx_stop - p_bin_idx_start);
-    p[0]     = 0;
-    p.back() = 0;
-    for (size_t j = 0; j < num_bins; j++) {
-      if (j <= p_bin_idx_start) {
-        p[0] += hist_ptr[j];
-      } else if (j >= p_bin_idx_stop) {
-        p.back() += hist_ptr[j];
-      } else {
-        sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
-        p[j - p_bin_idx_start]              = hist_ptr[j];
-      }
+    for (size_t j = p_bin_idx_start + 1; j < p_bin_idx_stop; j++) {
+      sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
+      p[j - p_bin_idx_start]              = hist_ptr[j];
     }
+    p[0] = hist_cumsum[p_bin_idx_start + 1];
+    p.back() += hist_cumsum[num_bins] - hist_cumsum[p_bin_idx_stop];
     // calculate how many bins should be merged to generate quantized distribution q
     const auto num_merged_bins = sliced_nd_hist.size() / num_quantized_bins;
     // merge hist into num_quantized_bins bins
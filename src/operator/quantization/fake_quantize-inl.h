@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fake_quantize-inl.h
+ * \brief Fake quantization with a learnable scale and straight-through gradients, for
+ *  quantization-aware training
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_FAKE_QUANTIZE_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_FAKE_QUANTIZE_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mxnet_op.h"
+#include "../tensor/broadcast_reduce_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+struct FakeQuantizeParam : public dmlc::Parameter<FakeQuantizeParam> {
+  int num_bits;
+  bool is_signed;
+  dmlc::optional<int> axis;
+  DMLC_DECLARE_PARAMETER(FakeQuantizeParam) {
+    DMLC_DECLARE_FIELD(num_bits).set_default(8).set_range(2, 16).describe(
+        "The number of bits of the quantized values.");
+    DMLC_DECLARE_FIELD(is_signed)
+        .set_default(true)
+        .describe(
+            "Whether the quantized values are signed, in [-(2^(num_bits-1)-1), "
+            "2^(num_bits-1)-1] as the symmetric int8 quantization, or in [0, 2^num_bits-1].");
+    DMLC_DECLARE_FIELD(axis)
+        .set_default(dmlc::optional<int>())
+        .describe(
+            "The axis of the channels of data when the scale is per channel, with one element "
+            "per channel. The scale has a single element when it is not set.");
+  }
+
+  float QuantizedMin() const {
+    return is_signed ? 1.f - (1 << (num_bits - 1)) : 0.f;
+  }
+
+  float QuantizedMax() const {
+    return is_signed ? (1 << (num_bits - 1)) - 1.f : (1 << num_bits) - 1.f;
+  }
+};
+
+/*! \brief the elements of data after the channel axis and the channels of the scale */
+inline void FakeQuantizeChannels(const FakeQuantizeParam& param,
+                                 const mxnet::TShape& dshape,
+                                 index_t* inner,
+                                 index_t* channels) {
+  if (!param.axis.has_value()) {
+    *inner    = dshape.Size();
+    *channels = 1;
+    return;
+  }
+  const int axis = CheckAxis(param.axis.value(), dshape.ndim());
+  *inner         = dshape.ProdShape(axis + 1, dshape.ndim());
+  *channels      = dshape[axis];
+}
+
+inline bool FakeQuantizeShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& dshape = in_attrs->at(0);
+  if (!shape_is_known(dshape))
+    return false;
+  if (param.axis.has_value()) {
+    const int axis = CheckAxis(param.axis.value(), dshape.ndim());
+    SHAPE_ASSIGN_CHECK(*in_attrs, 1, mxnet::TShape(1, dshape[axis]));
+  } else {
+    SHAPE_ASSIGN_CHECK(*in_attrs, 1, mxnet::TShape(1, 1));
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, dshape);
+  return true;
+}
+
+// out = clip(round(in / scale), qmin, qmax) * scale
+struct fake_quantize_forward {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* in,
+                                  const DType* scale,
+                                  index_t inner,
+                                  index_t channels,
+                                  float qmin,
+                                  float qmax) {
+    const float s = static_cast<float>(scale[(i / inner) % channels]);
+    const float q = Min(Max(::roundf(static_cast<float>(in[i]) / s), qmin), qmax);
+    out[i]        = static_cast<DType>(q * s);
+  }
+};
+
+// The gradient of data passes through within the range of the quantized values, the one of the
+// scale is that of the learned step size quantization, round(v) - v within the range and the
+// bound of the range outside, with v = in / scale.
+template <int req>
+struct fake_quantize_backward {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* in_grad,
+                                  float* scale_grad,
+                                  const DType* out_grad,
+                                  const DType* in,
+                                  const DType* scale,
+                                  index_t inner,
+                                  index_t channels,
+                                  float qmin,
+                                  float qmax) {
+    const float v = static_cast<float>(in[i]) / static_cast<float>(scale[(i / inner) % channels]);
+    const float g = static_cast<float>(out_grad[i]);
+    if (v < qmin) {
+      KERNEL_ASSIGN(in_grad[i], req, 0);
+      scale_grad[i] = g * qmin;
+    } else if (v > qmax) {
+      KERNEL_ASSIGN(in_grad[i], req, 0);
+      scale_grad[i] = g * qmax;
+    } else {
+      KERNEL_ASSIGN(in_grad[i], req, out_grad[i]);
+      scale_grad[i] = g * (::roundf(v) - v);
+    }
+  }
+};
+
+template <typename xpu>
+void FakeQuantizeForward(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_NE(req[0], kAddTo) << "_contrib_fake_quantize does not support kAddTo";
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s        = ctx.get_stream<xpu>();
+  index_t inner, channels;
+  FakeQuantizeChannels(param, inputs[0].shape_, &inner, &channels);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<fake_quantize_forward, xpu>::Launch(s,
+                                               inputs[0].Size(),
+                                               outputs[0].dptr<DType>(),
+                                               inputs[0].dptr<DType>(),
+                                               inputs[1].dptr<DType>(),
+                                               inner,
+                                               channels,
+                                               param.QuantizedMin(),
+                                               param.QuantizedMax());
+  });
+}
+
+template <typename xpu>
+void FakeQuantizeBackward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  // out_grad, data, scale
+  CHECK_EQ(inputs.size(), 3U);
+  // data_grad, scale_grad
+  CHECK_EQ(outputs.size(), 2U);
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s        = ctx.get_stream<xpu>();
+  const TBlob& data              = inputs[1];
+  index_t inner, channels;
+  FakeQuantizeChannels(param, data.shape_, &inner, &channels);
+  // the scale gradient is reduced from the ones of the elements to the shape of the channels
+  mxnet::TShape small(data.ndim(), 1);
+  if (param.axis.has_value())
+    small[CheckAxis(param.axis.value(), data.ndim())] = channels;
+  const TBlob scale_grad = outputs[1].reshape(small);
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    mxnet::TShape src_shape, dst_shape;
+    BroadcastReduceShapeCompact(data.shape_, small, &src_shape, &dst_shape);
+    const size_t reduce_size = broadcast::ReduceWorkspaceSize(s, dst_shape, req[1], src_shape);
+    // the workspace of the reduction is aligned after the gradients of the elements
+    const size_t elem_size = (data.Size() * sizeof(float) + 127) / 128 * 128;
+    mshadow::Tensor<xpu, 1, char> workspace =
+        ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(elem_size + reduce_size), s);
+    const TBlob elem_grad(reinterpret_cast<float*>(workspace.dptr_), data.shape_, xpu::kDevMask);
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      Kernel<fake_quantize_backward<Req>, xpu>::Launch(s,
+                                                       data.Size(),
+                                                       outputs[0].dptr<DType>(),
+                                                       elem_grad.dptr<float>(),
+                                                       inputs[0].dptr<DType>(),
+                                                       data.dptr<DType>(),
+                                                       inputs[2].dptr<DType>(),
+                                                       inner,
+                                                       channels,
+                                                       param.QuantizedMin(),
+                                                       param.QuantizedMax());
+    });
+    if (req[1] != kNullOp) {
+      mshadow::Tensor<xpu, 1, char> reduce_workspace(
+          workspace.dptr_ + elem_size, mshadow::Shape1(reduce_size), s);
+      ReduceAxesComputeImpl<xpu, mshadow::red::sum, false>(
+          ctx, {elem_grad}, {req[1]}, {scale_grad}, small, &reduce_workspace);
+    }
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_QUANTIZATION_FAKE_QUANTIZE_INL_H_
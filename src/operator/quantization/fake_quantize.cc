@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fake_quantize.cc
+ * \brief Fake quantization with a learnable scale and straight-through gradients
+ */
+#include "./fake_quantize-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(FakeQuantizeParam);
+
+NNVM_REGISTER_OP(_contrib_fake_quantize)
+    .add_alias("_npx_fake_quantize")
+    .describe(R"code(Quantizes data with scale and dequantizes it back, for quantization-aware
+training.
+
+The output is ``clip(round(data / scale), qmin, qmax) * scale``, where [qmin, qmax] is the range
+of the quantized values of `num_bits` bits, [-127, 127] or [0, 255] for the default 8 bits. The
+scale has one element, or one element per channel along `axis`.
+
+In the backward pass the gradient of data passes straight through within the range, and the
+scale is learned as in the learned step size quantization: the gradient of the scale of an element
+is ``round(data / scale) - data / scale`` within the range, and qmin or qmax outside of it.
+
+Reference: Esser et al., Learned Step Size Quantization, ICLR 2020.
+
+Example::
+
+  x = [-1.3, 0.26, 2.0]
+  fake_quantize(x, scale=[0.01]) = [-1.27, 0.26, 1.27]
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<FakeQuantizeParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "scale"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", FakeQuantizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FCompute>("FCompute<cpu>", FakeQuantizeForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_contrib_fake_quantize"})
+    .add_argument("data", "NDArray-or-Symbol", "The data to fake quantize.")
+    .add_argument("scale", "NDArray-or-Symbol", "The step size of the quantized values.")
+    .add_arguments(FakeQuantizeParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_fake_quantize)
+    .set_attr_parser(ParamParser<FakeQuantizeParam>)
+    .set_num_inputs(3)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", FakeQuantizeBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -31,8 +31,6 @@
 namespace mxnet {
 namespace op {
 
-DMLC_REGISTER_PARAMETER(QuantizeElemwiseAddParam);
-
 static inline float GetScale(const NDArray& data, float min, float max) {
   auto data_range = (data.dtype() == mshadow::kInt8) ? kInt8Range : kUint8Range;
   return data_range / MaxAbs(min, max);
@@ -67,10 +65,9 @@ static MKLDNNQuantizedElemwiseAddFwd& GetQuantizedElemwiseAddForward(
     const std::vector<NDArray>& out_data,
     const std::vector<mkldnn::memory::desc>& data_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, MKLDNNQuantizedElemwiseAddFwd, OpHash> fwds;
+  static thread_local MKLDNNCache<OpSignature, MKLDNNQuantizedElemwiseAddFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, MKLDNNQuantizedElemwiseAddFwd, OpHash>
-      fwds;
+  static MX_THREAD_LOCAL MKLDNNCache<OpSignature, MKLDNNQuantizedElemwiseAddFwd, OpHash> fwds;
 #endif
   OpSignature key;
   key.AddSign(in_data);
@@ -241,9 +238,7 @@ inline static bool ElemwiseAddStorageType(const nnvm::NodeAttrs& attrs,
 NNVM_REGISTER_OP(_contrib_quantized_elemwise_add)
     .set_attr<FInferStorageType>("FInferStorageType", ElemwiseAddStorageType)
     .set_attr<FComputeEx>("FComputeEx<cpu>", MKLDNNQuantizedElemwiseAddForward)
-    .set_attr<bool>("TIsMKLDNN", true)
-    .set_attr_parser(ParamParser<QuantizeElemwiseAddParam>)
-    .add_arguments(QuantizeElemwiseAddParam::__FIELDS__());
+    .set_attr<bool>("TIsMKLDNN", true);
 }  // namespace op
 }  // namespace mxnet
 
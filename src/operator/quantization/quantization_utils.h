@@ -80,6 +80,25 @@ MSHADOW_XINLINE float MinAbs(T a, T b) {
   return Min(Abs(static_cast<float>(a)), Abs(static_cast<float>(b)));
 }
 
+/*! \brief the quantized range of type T, kInt8Range, kUint8Range or kInt32Range, on devices */
+template <typename T>
+MSHADOW_XINLINE float QuantizedRange() {
+  return MinValue<T>() < 0 ? 127.5f : 255.5f;
+}
+
+template <>
+MSHADOW_XINLINE float QuantizedRange<int32_t>() {
+  return 2147483647.f;
+}
+
+/*! \brief rounds value to the nearest value of type T */
+template <typename T>
+MSHADOW_XINLINE T SaturateCast(float value) {
+  const int64_t rounded = static_cast<int64_t>(::roundf(value));
+  return static_cast<T>(Min(Max(rounded, static_cast<int64_t>(MinValue<T>())),
+                            static_cast<int64_t>(MaxValue<T>())));
+}
+
 template <typename T>
 MSHADOW_XINLINE T FloatToQuantized(float input, float min_range, float max_range) {
   float real_range      = MaxAbs(min_range, max_range);
@@ -31,6 +31,7 @@
 #include <unordered_set>
 #include <vector>
 #include "quantize_v2-inl.h"
+#include "../tensor/indexing_op.h"
 #include "../../common/utils.h"
 
 namespace mxnet {
@@ -107,8 +108,9 @@ std::vector<NodeEntry> OfflineParams(std::vector<NodeEntry>&& outputs,
   std::unordered_map<Node*, ObjectPtr> mirror_map;
   nnvm::NodeEntryMap<ObjectPtr> entry_var;
   auto need_offline = [&](ObjectPtr n) {
-    return (n->op() == Op::Get("_contrib_quantize_v2")) && n->inputs[0].node->is_variable() &&
-           offline_params.count(n->inputs[0].node->attrs.name);
+    return (n->op() == Op::Get("_contrib_quantize_v2") ||
+            n->op() == Op::Get("_contrib_rowwise_quantize")) &&
+           n->inputs[0].node->is_variable() && offline_params.count(n->inputs[0].node->attrs.name);
   };
   DFSVisit(outputs, [&](const ObjectPtr& node) {
     for (NodeEntry& e : node->inputs) {
@@ -140,6 +142,23 @@ bool isRegistered(ObjectPtr node, const int& dev_type) {
           fcomputestateful_ex != nullptr);
 }
 
+// Channel-wise quantization on CPU quantizes the tables of the float32 embeddings row by row
+// instead, their outputs stay float32.
+inline bool NeedRowwiseQuantize(ObjectPtr node,
+                                const std::unordered_set<std::string>& excluded_nodes,
+                                const std::unordered_set<std::string>& excluded_ops,
+                                const std::string& quantize_granularity,
+                                const int& dev_type) {
+  if (node->op() != Op::Get("Embedding") || quantize_granularity != "channel-wise" ||
+      dev_type != Context::kCPU || excluded_nodes.count(node->attrs.name) ||
+      excluded_ops.count(node->op()->name)) {
+    return false;
+  }
+  op::EmbeddingParam param;
+  param.Init(node->attrs.dict);
+  return param.dtype == mshadow::kFloat32;
+}
+
 inline QuantizeType NeedQuantize(ObjectPtr node,
                                  const std::unordered_set<std::string>& excluded_nodes,
                                  const std::unordered_set<std::string>& excluded_ops,
@@ -152,6 +171,8 @@ inline QuantizeType NeedQuantize(ObjectPtr node,
   static auto& fexec_type       = nnvm::Op::GetAttr<FExecType>("FExecType");
   const auto& op                = node->op();
   bool need                     = false;
+  if (NeedRowwiseQuantize(node, excluded_nodes, excluded_ops, quantize_granularity, dev_type))
+    return QuantizeType::kNone;
   if (op && quantized_op_map.count(op)) {
     need = true;
     // If the quantized node is not registered with a computation function, the node
@@ -292,6 +313,11 @@ Graph QuantizeGraph(Graph&& src) {
   const auto quantized_dtype      = src.GetAttr<std::string>("quantized_dtype");
   const auto quantize_granularity = src.GetAttr<std::string>("quantize_granularity");
   const auto dev_type             = src.GetAttr<int>("target_ctx");
+  const auto excluded_nodes       = src.GetAttr<std::unordered_set<std::string>>("excluded_nodes");
+  const auto excluded_ops         = src.GetAttr<std::unordered_set<std::string>>("excluded_ops");
+  static const int embedding_bits = dmlc::GetEnv("MXNET_QUANTIZE_EMBEDDING_BITS", 8);
+  CHECK(embedding_bits == 8 || embedding_bits == 4)
+      << "MXNET_QUANTIZE_EMBEDDING_BITS must be 8 or 4, got " << embedding_bits;
 
   if (dev_type == Context::kGPU && quantize_granularity == "channel-wise") {
     LOG(FATAL) << "`channel-wise` quantization option is not supported yet by GPU,"
@@ -466,6 +492,27 @@ Graph QuantizeGraph(Graph&& src) {
           new_node->inputs.emplace_back(mirror_node, e.index, e.version);
         }
       }
+      if (NeedRowwiseQuantize(
+              node, excluded_nodes, excluded_ops, quantize_granularity, dev_type)) {
+        if (verbose)
+          LOG(INFO) << node->attrs.name << " is quantized row by row.";
+        const std::string bits = std::to_string(embedding_bits);
+        op::EmbeddingParam param;
+        param.Init(node->attrs.dict);
+        new_node->attrs.dict.clear();
+        new_node->attrs.op                 = Op::Get("_contrib_rowwise_quantized_embedding");
+        new_node->attrs.dict["input_dim"]  = std::to_string(param.input_dim);
+        new_node->attrs.dict["output_dim"] = std::to_string(param.output_dim);
+        new_node->attrs.dict["bits"]       = bits;
+        new_node->op()->attr_parser(&(new_node->attrs));
+        const NodeEntry weight = new_node->inputs[1];
+        ObjectPtr quantize_node =
+            CreateNode("_contrib_rowwise_quantize", weight.node->attrs.name + "_rowwise_quantize");
+        quantize_node->attrs.dict["bits"] = bits;
+        quantize_node->op()->attr_parser(&(quantize_node->attrs));
+        quantize_node->inputs.emplace_back(weight);
+        new_node->inputs[1] = NodeEntry{quantize_node, 0, 0};
+      }
     }
     mirror_map[node.get()]       = new_node;
     reverse_mirror_map[new_node] = node;
@@ -647,12 +694,82 @@ Graph SetCalibTableToQuantizedGraph(Graph&& g) {
   return std::move(g);
 }
 
+/*!
+ * \brief Inserts a _contrib_fake_quantize before each input QuantizeGraph would quantize, for
+ *  quantization-aware training. The graph stays float32. The scale of the fake quantization of
+ *  an entry is the variable <name>_fq_scale, where name is the name of the variable of the entry,
+ *  or the name of its node and output, and the names are the graph attr "fake_quantize_entries".
+ *  Weights are fake quantized per output channel with channel-wise granularity, biases are not.
+ */
+Graph FakeQuantizeGraph(Graph&& src) {
+  static const auto& avoid_quantize_input_map =
+      Op::GetAttr<mxnet::FAvoidQuantizeInput>("FAvoidQuantizeInput");
+  static const auto& flist_inputs = nnvm::Op::GetAttr<nnvm::FListOutputNames>("FListInputNames");
+  const auto quantized_dtype      = src.GetAttr<std::string>("quantized_dtype");
+  const auto quantize_granularity = src.GetAttr<std::string>("quantize_granularity");
+
+  std::unordered_map<ObjectPtr, ObjectPtr> quantized_node_map;
+  MarkQuantizedNodes(src, &quantized_node_map);
+
+  std::unordered_map<Node*, ObjectPtr> mirror_map;
+  nnvm::NodeEntryMap<NodeEntry> fake_quantize_map;
+  std::vector<std::string> entry_names;
+  DFSVisit(src.outputs, [&](const ObjectPtr& node) {
+    ObjectPtr new_node = Node::Create();
+    *new_node          = *node;
+    new_node->inputs.clear();
+    for (ObjectPtr& dep : new_node->control_deps)
+      dep = mirror_map.at(dep.get());
+    for (size_t i = 0; i < node->inputs.size(); ++i) {
+      const auto& e          = node->inputs[i];
+      NodeEntry mirror_entry = NodeEntry{mirror_map.at(e.node.get()), e.index, e.version};
+      const std::string input_name =
+          flist_inputs.count(node->op()) ? flist_inputs[node->op()](node->attrs)[i] : "";
+      if (!quantized_node_map.count(node) || input_name == "bias" ||
+          (avoid_quantize_input_map.count(node->op()) &&
+           avoid_quantize_input_map[node->op()](node->attrs, i, quantize_granularity))) {
+        new_node->inputs.emplace_back(mirror_entry);
+        continue;
+      }
+      if (!fake_quantize_map.count(e)) {
+        std::string name = e.node->attrs.name;
+        if (!e.node->is_variable())
+          name += "_" + GetOutputName(e.node.get(), e.index);
+        ObjectPtr scale         = CreateNode("nullptr", name + "_fq_scale");
+        ObjectPtr fake_quantize = CreateNode("_contrib_fake_quantize", name + "_fake_quantize");
+        fake_quantize->inputs   = {mirror_entry, NodeEntry{scale, 0, 0}};
+        if (e.node->is_variable() && input_name == "weight" &&
+            quantize_granularity == "channel-wise")
+          fake_quantize->attrs.dict["axis"] = "0";
+        fake_quantize->attrs.dict["is_signed"] = quantized_dtype == "uint8" ? "False" : "True";
+        fake_quantize->op()->attr_parser(&(fake_quantize->attrs));
+        fake_quantize_map[e] = NodeEntry{fake_quantize, 0, 0};
+        entry_names.push_back(name);
+      }
+      new_node->inputs.emplace_back(fake_quantize_map[e]);
+    }
+    mirror_map[node.get()] = new_node;
+  });
+
+  Graph ret;
+  for (const auto& e : src.outputs)
+    ret.outputs.emplace_back(mirror_map.at(e.node.get()), e.index, e.version);
+  ret.attrs["fake_quantize_entries"] = std::make_shared<dmlc::any>(std::move(entry_names));
+  return ret;
+}
+
 NNVM_REGISTER_PASS(QuantizeGraph)
     .describe("")
     .set_body(QuantizeGraph)
     .provide_graph_attr("calib_nodes")
     .set_change_graph(true);
 
+NNVM_REGISTER_PASS(FakeQuantizeGraph)
+    .describe("")
+    .set_body(FakeQuantizeGraph)
+    .provide_graph_attr("fake_quantize_entries")
+    .set_change_graph(true);
+
 NNVM_REGISTER_PASS(SetCalibTableToQuantizedGraph)
     .describe("")
     .set_body(SetCalibTableToQuantizedGraph)
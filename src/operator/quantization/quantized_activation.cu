@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_activation.cu
+ */
+#include <mxnet/op_attr_types.h>
+#include "../nn/activation-inl.h"
+#include "../mxnet_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+// relu keeps the range of its input, the int8 output saturates the uint8 values above 127
+struct QuantizedReluKernel {
+  template <typename SrcDType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  int8_t* out,
+                                  float* omin_range,
+                                  float* omax_range,
+                                  const SrcDType* in,
+                                  const float* imin_range,
+                                  const float* imax_range) {
+    out[i]        = static_cast<int8_t>(Min(Max(static_cast<int>(in[i]), 0), 127));
+    omin_range[0] = imin_range[0];
+    omax_range[0] = imax_range[0];
+  }
+};
+
+void QuantizedActivationForwardGPU(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 3U);
+  const ActivationParam& param = nnvm::get<ActivationParam>(attrs.parsed);
+  CHECK_EQ(param.act_type, activation::kReLU)
+      << "_contrib_quantized_act only supports act_type=relu for now";
+  using namespace mxnet_op;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  if (inputs[0].type_flag_ == mshadow::kInt8) {
+    Kernel<QuantizedReluKernel, gpu>::Launch(s,
+                                             outputs[0].Size(),
+                                             outputs[0].dptr<int8_t>(),
+                                             outputs[1].dptr<float>(),
+                                             outputs[2].dptr<float>(),
+                                             inputs[0].dptr<int8_t>(),
+                                             inputs[1].dptr<float>(),
+                                             inputs[2].dptr<float>());
+  } else if (inputs[0].type_flag_ == mshadow::kUint8) {
+    Kernel<QuantizedReluKernel, gpu>::Launch(s,
+                                             outputs[0].Size(),
+                                             outputs[0].dptr<int8_t>(),
+                                             outputs[1].dptr<float>(),
+                                             outputs[2].dptr<float>(),
+                                             inputs[0].dptr<uint8_t>(),
+                                             inputs[1].dptr<float>(),
+                                             inputs[2].dptr<float>());
+  } else {
+    LOG(FATAL) << "_contrib_quantized_act only supports int8 and uint8 inputs";
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_act)
+    .set_attr<FCompute>("FCompute<gpu>", QuantizedActivationForwardGPU);
+
+}  // namespace op
+}  // namespace mxnet
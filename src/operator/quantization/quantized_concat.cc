@@ -100,6 +100,7 @@ static bool QuantizedConcatType(const nnvm::NodeAttrs& attrs,
 }
 
 NNVM_REGISTER_OP(_contrib_quantized_concat)
+    .add_alias("_npx_quantized_concat")
     .describe(R"code(Joins input arrays along a given axis.
 
 The dimensions of the input arrays should be the same except the axis along
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_concat.cu
+ */
+#include "../nn/concat-inl.h"
+#include "../mxnet_op.h"
+#include "./quantization_utils.h"
+
+namespace mxnet {
+namespace op {
+
+// the range of the output is the union of the ranges of the inputs and of 0, as the oneDNN operator
+struct QuantizedConcatRangeKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* omin_range,
+                                  float* omax_range,
+                                  const float* imin_range,
+                                  const float* imax_range,
+                                  bool first) {
+    omin_range[0] = Min(first ? 0.f : omin_range[0], imin_range[0]);
+    omax_range[0] = Max(first ? 0.f : omax_range[0], imax_range[0]);
+  }
+};
+
+// rescales an input of in_cols columns to the range of the output and writes it at col_offset
+struct QuantizedConcatKernel {
+  template <typename OType, typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  OType* out,
+                                  const float* omin_range,
+                                  const float* omax_range,
+                                  const DType* in,
+                                  const float* imin_range,
+                                  const float* imax_range,
+                                  index_t in_cols,
+                                  index_t out_cols,
+                                  index_t col_offset) {
+    const float scale = MaxAbs(imin_range[0], imax_range[0]) / QuantizedRange<DType>() *
+                        QuantizedRange<OType>() / MaxAbs(omin_range[0], omax_range[0]);
+    out[(i / in_cols) * out_cols + col_offset + i % in_cols] = SaturateCast<OType>(in[i] * scale);
+  }
+};
+
+void QuantizedConcatForwardGPU(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const ConcatParam& param = nnvm::get<ConcatParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), static_cast<size_t>(param.num_args * 3));
+  CHECK_EQ(outputs.size(), 3U);
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const TBlob& out        = outputs[0];
+  float* omin_range       = outputs[1].dptr<float>();
+  float* omax_range       = outputs[2].dptr<float>();
+  for (int i = 0; i < param.num_args; ++i) {
+    const float* imin_range = inputs[param.num_args + 2 * i].dptr<float>();
+    const float* imax_range = inputs[param.num_args + 2 * i + 1].dptr<float>();
+    Kernel<QuantizedConcatRangeKernel, gpu>::Launch(
+        s, 1, omin_range, omax_range, imin_range, imax_range, i == 0);
+  }
+  const int axis         = CheckAxis(param.dim, out.ndim());
+  const index_t leading  = out.shape_.ProdShape(0, axis);
+  const index_t out_cols = out.Size() / leading;
+  index_t col_offset     = 0;
+  for (int i = 0; i < param.num_args; ++i) {
+    const TBlob& in         = inputs[i];
+    const float* imin_range = inputs[param.num_args + 2 * i].dptr<float>();
+    const float* imax_range = inputs[param.num_args + 2 * i + 1].dptr<float>();
+    const index_t in_cols   = in.Size() / leading;
+    MXNET_INT_TYPE_SWITCH(out.type_flag_, OType, {
+      MXNET_INT_TYPE_SWITCH(in.type_flag_, DType, {
+        Kernel<QuantizedConcatKernel, gpu>::Launch(s,
+                                                   in.Size(),
+                                                   out.dptr<OType>(),
+                                                   omin_range,
+                                                   omax_range,
+                                                   in.dptr<DType>(),
+                                                   imin_range,
+                                                   imax_range,
+                                                   in_cols,
+                                                   out_cols,
+                                                   col_offset);
+      });
+    });
+    col_offset += in_cols;
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_concat)
+    .set_attr<FCompute>("FCompute<gpu>", QuantizedConcatForwardGPU);
+
+}  // namespace op
+}  // namespace mxnet
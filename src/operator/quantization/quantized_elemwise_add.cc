@@ -27,6 +27,8 @@
 namespace mxnet {
 namespace op {
 
+DMLC_REGISTER_PARAMETER(QuantizeElemwiseAddParam);
+
 static bool ElemwiseAddShape(const nnvm::NodeAttrs& attrs,
                              mxnet::ShapeVector* in_shape,
                              mxnet::ShapeVector* out_shape) {
@@ -106,6 +108,7 @@ and max thresholds representing the threholds for quantizing the float32 output
     })
     // C, C_min, C_max
     .set_num_outputs(3)
+    .set_attr_parser(ParamParser<QuantizeElemwiseAddParam>)
     .set_attr<nnvm::FListInputNames>(
         "FListInputNames",
         [](const NodeAttrs& attrs) {
@@ -125,7 +128,8 @@ and max thresholds representing the threholds for quantizing the float32 output
     .add_argument("lhs_min", "NDArray-or-Symbol", "3rd input")
     .add_argument("lhs_max", "NDArray-or-Symbol", "4th input")
     .add_argument("rhs_min", "NDArray-or-Symbol", "5th input")
-    .add_argument("rhs_max", "NDArray-or-Symbol", "6th input");
+    .add_argument("rhs_max", "NDArray-or-Symbol", "6th input")
+    .add_arguments(QuantizeElemwiseAddParam::__FIELDS__());
 
 NNVM_REGISTER_OP(elemwise_add).set_attr<FQuantizedOp>("FQuantizedOp", [](const NodeAttrs& attrs) {
   nnvm::ObjectPtr node = nnvm::Node::Create();
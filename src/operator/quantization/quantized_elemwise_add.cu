@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file quantized_elemwise_add.cu
+ */
+#include "../mxnet_op.h"
+#include "./quantization_utils.h"
+#include "./quantized_elemwise_add-inl.h"
+
+namespace mxnet {
+namespace op {
+
+// c = a + b in the range of the calibration when there is one, or in the range of
+// [-(|a| + |b|), |a| + |b|] otherwise, as the oneDNN operator
+struct QuantizedElemwiseAddKernel {
+  template <typename DTypeA, typename DTypeB, typename OType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  OType* out,
+                                  float* omin_range,
+                                  float* omax_range,
+                                  const DTypeA* a,
+                                  const DTypeB* b,
+                                  const float* amin_range,
+                                  const float* amax_range,
+                                  const float* bmin_range,
+                                  const float* bmax_range,
+                                  bool calibrated,
+                                  float calib_min,
+                                  float calib_max) {
+    const float a_absmax  = MaxAbs(amin_range[0], amax_range[0]);
+    const float b_absmax  = MaxAbs(bmin_range[0], bmax_range[0]);
+    const float out_max   = calibrated ? calib_max : a_absmax + b_absmax;
+    const float out_min   = calibrated ? calib_min : -out_max;
+    const float out_scale = QuantizedRange<OType>() / MaxAbs(out_min, out_max);
+    const float a_scale   = a_absmax / QuantizedRange<DTypeA>() * out_scale;
+    const float b_scale   = b_absmax / QuantizedRange<DTypeB>() * out_scale;
+    out[i]                = SaturateCast<OType>(a[i] * a_scale + b[i] * b_scale);
+    omin_range[0]         = out_min;
+    omax_range[0]         = out_max;
+  }
+};
+
+template <typename DTypeA, typename DTypeB>
+void QuantizedElemwiseAddLaunch(mshadow::Stream<gpu>* s,
+                                const QuantizeElemwiseAddParam& param,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<TBlob>& outputs) {
+  using namespace quantized_elemwise_add_enum;
+  const bool calibrated = param.min_calib_range.has_value() && param.max_calib_range.has_value();
+  MXNET_INT_TYPE_SWITCH(outputs[kOut].type_flag_, OType, {
+    mxnet_op::Kernel<QuantizedElemwiseAddKernel, gpu>::Launch(
+        s,
+        outputs[kOut].Size(),
+        outputs[kOut].dptr<OType>(),
+        outputs[kMin].dptr<float>(),
+        outputs[kMax].dptr<float>(),
+        inputs[kDataA].dptr<DTypeA>(),
+        inputs[kDataB].dptr<DTypeB>(),
+        inputs[kAMin].dptr<float>(),
+        inputs[kAMax].dptr<float>(),
+        inputs[kBMin].dptr<float>(),
+        inputs[kBMax].dptr<float>(),
+        calibrated,
+        calibrated ? param.min_calib_range.value() : 0.f,
+        calibrated ? param.max_calib_range.value() : 0.f);
+  });
+}
+
+void QuantizedElemwiseAddForwardGPU(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace quantized_elemwise_add_enum;
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(outputs.size(), 3U);
+  const QuantizeElemwiseAddParam& param = nnvm::get<QuantizeElemwiseAddParam>(attrs.parsed);
+  mshadow::Stream<gpu>* s               = ctx.get_stream<gpu>();
+  const bool a_int8                     = inputs[kDataA].type_flag_ == mshadow::kInt8;
+  const bool b_int8                     = inputs[kDataB].type_flag_ == mshadow::kInt8;
+  if (a_int8 && b_int8) {
+    QuantizedElemwiseAddLaunch<int8_t, int8_t>(s, param, inputs, outputs);
+  } else if (a_int8) {
+    QuantizedElemwiseAddLaunch<int8_t, uint8_t>(s, param, inputs, outputs);
+  } else if (b_int8) {
+    QuantizedElemwiseAddLaunch<uint8_t, int8_t>(s, param, inputs, outputs);
+  } else {
+    QuantizedElemwiseAddLaunch<uint8_t, uint8_t>(s, param, inputs, outputs);
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_quantized_elemwise_add)
+    .set_attr<FCompute>("FCompute<gpu>", QuantizedElemwiseAddForwardGPU);
+
+}  // namespace op
+}  // namespace mxnet
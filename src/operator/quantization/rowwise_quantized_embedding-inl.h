@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rowwise_quantized_embedding-inl.h
+ * \brief Embedding tables quantized row by row to int8 or int4
+ */
+#ifndef MXNET_OPERATOR_QUANTIZATION_ROWWISE_QUANTIZED_EMBEDDING_INL_H_
+#define MXNET_OPERATOR_QUANTIZATION_ROWWISE_QUANTIZED_EMBEDDING_INL_H_
+
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * A row-wise quantized table stores each row as its quantized values, two to a byte for 4 bits,
+ * followed by the float32 scale and bias of the row, value = scale * quantized + bias.
+ */
+namespace rowwise_quantize {
+enum RowwiseEmbeddingPooling { kNone, kSum, kMean };
+enum RowwiseEmbeddingInputs { kData, kWeight, kLength };
+
+/*! \brief the bytes of the quantized values of a row */
+inline index_t ValueBytes(const index_t dim, const int bits) {
+  return (dim * bits + 7) / 8;
+}
+
+/*! \brief the bytes of a row, the quantized values followed by the scale and the bias */
+inline index_t RowBytes(const index_t dim, const int bits) {
+  return ValueBytes(dim, bits) + 2 * static_cast<index_t>(sizeof(float));
+}
+}  // namespace rowwise_quantize
+
+struct RowwiseQuantizeParam : public dmlc::Parameter<RowwiseQuantizeParam> {
+  int bits;
+  DMLC_DECLARE_PARAMETER(RowwiseQuantizeParam) {
+    DMLC_DECLARE_FIELD(bits).set_default(8).describe(
+        "The bits of each quantized value, 8 or 4.");
+  }
+};
+
+struct RowwiseQuantizedEmbeddingParam
+    : public dmlc::Parameter<RowwiseQuantizedEmbeddingParam> {
+  index_t input_dim;
+  index_t output_dim;
+  int bits;
+  int pooling;
+  bool use_length;
+  DMLC_DECLARE_PARAMETER(RowwiseQuantizedEmbeddingParam) {
+    DMLC_DECLARE_FIELD(input_dim).set_lower_bound(1).describe(
+        "Vocabulary size of the input indices.");
+    DMLC_DECLARE_FIELD(output_dim)
+        .set_lower_bound(1)
+        .describe("Dimension of the embedding vectors.");
+    DMLC_DECLARE_FIELD(bits).set_default(8).describe(
+        "The bits of each quantized value of the weight, 8 or 4.");
+    DMLC_DECLARE_FIELD(pooling)
+        .add_enum("none", rowwise_quantize::kNone)
+        .add_enum("sum", rowwise_quantize::kSum)
+        .add_enum("mean", rowwise_quantize::kMean)
+        .set_default(rowwise_quantize::kNone)
+        .describe(
+            "How the embeddings of each bag, the last axis of data, are pooled. `none` returns "
+            "the embedding of every index.");
+    DMLC_DECLARE_FIELD(use_length)
+        .set_default(false)
+        .describe("Whether to use the length input, the number of indices of each bag.");
+  }
+};
+
+inline bool RowwiseQuantizeShape(const nnvm::NodeAttrs& attrs,
+                                 mxnet::ShapeVector* in_attrs,
+                                 mxnet::ShapeVector* out_attrs) {
+  const RowwiseQuantizeParam& param = nnvm::get<RowwiseQuantizeParam>(attrs.parsed);
+  CHECK(param.bits == 8 || param.bits == 4) << "Only 8 and 4 bits are supported";
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& dshape = (*in_attrs)[0];
+  if (!shape_is_known(dshape))
+    return false;
+  CHECK_EQ(dshape.ndim(), 2) << "The table to quantize must be two-dimensional";
+  SHAPE_ASSIGN_CHECK(
+      *out_attrs, 0, mshadow::Shape2(dshape[0], rowwise_quantize::RowBytes(dshape[1], param.bits)));
+  return true;
+}
+
+inline bool RowwiseQuantizeType(const nnvm::NodeAttrs& attrs,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kUint8);
+  return true;
+}
+
+inline bool RowwiseQuantizedEmbeddingShape(const nnvm::NodeAttrs& attrs,
+                                           mxnet::ShapeVector* in_attrs,
+                                           mxnet::ShapeVector* out_attrs) {
+  using namespace rowwise_quantize;
+  const auto& param = nnvm::get<RowwiseQuantizedEmbeddingParam>(attrs.parsed);
+  CHECK(param.bits == 8 || param.bits == 4) << "Only 8 and 4 bits are supported";
+  CHECK(!param.use_length || param.pooling != kNone) << "use_length needs a pooling";
+  SHAPE_ASSIGN_CHECK(*in_attrs,
+                     kWeight,
+                     mshadow::Shape2(param.input_dim, RowBytes(param.output_dim, param.bits)));
+  const mxnet::TShape& dshape = (*in_attrs)[kData];
+  if (!ndim_is_known(dshape))
+    return false;
+  mxnet::TShape oshape;
+  if (param.pooling == kNone) {
+    oshape = mxnet::TShape(dshape.ndim() + 1, -1);
+    for (int i = 0; i < dshape.ndim(); ++i)
+      oshape[i] = dshape[i];
+  } else {
+    CHECK_GE(dshape.ndim(), param.use_length ? 2 : 1)
+        << "The last axis of data is the bags of indices to pool";
+    oshape = mxnet::TShape(dshape.ndim(), -1);
+    for (int i = 0; i < dshape.ndim() - 1; ++i)
+      oshape[i] = dshape[i];
+    if (param.use_length) {
+      mxnet::TShape lshape(dshape.ndim() - 1, -1);
+      for (int i = 0; i < lshape.ndim(); ++i)
+        lshape[i] = dshape[i];
+      SHAPE_ASSIGN_CHECK(*in_attrs, kLength, lshape);
+    }
+  }
+  oshape[oshape.ndim() - 1] = param.output_dim;
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, oshape);
+  return shape_is_known(oshape);
+}
+
+inline bool RowwiseQuantizedEmbeddingType(const nnvm::NodeAttrs& attrs,
+                                          std::vector<int>* in_attrs,
+                                          std::vector<int>* out_attrs) {
+  CHECK_EQ(out_attrs->size(), 1U);
+  CHECK_NE((*in_attrs)[rowwise_quantize::kData], -1) << "First input must have specified type";
+  TYPE_ASSIGN_CHECK(*in_attrs, rowwise_quantize::kWeight, mshadow::kUint8);
+  // the length of the bags has the type of the indices unless given
+  if (in_attrs->size() > rowwise_quantize::kLength && (*in_attrs)[rowwise_quantize::kLength] == -1)
+    (*in_attrs)[rowwise_quantize::kLength] = (*in_attrs)[rowwise_quantize::kData];
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  return true;
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_QUANTIZATION_ROWWISE_QUANTIZED_EMBEDDING_INL_H_
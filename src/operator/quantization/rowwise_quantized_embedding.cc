@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rowwise_quantized_embedding.cc
+ * \brief Embedding tables quantized row by row to int8 or int4
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "./rowwise_quantized_embedding-inl.h"
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(RowwiseQuantizeParam);
+DMLC_REGISTER_PARAMETER(RowwiseQuantizedEmbeddingParam);
+
+void RowwiseQuantizeForward(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  const RowwiseQuantizeParam& param = nnvm::get<RowwiseQuantizeParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo) << "rowwise_quantize only supports req = kWriteTo";
+  const index_t rows        = inputs[0].shape_[0];
+  const index_t dim         = inputs[0].shape_[1];
+  const index_t value_bytes = rowwise_quantize::ValueBytes(dim, param.bits);
+  const index_t row_bytes   = rowwise_quantize::RowBytes(dim, param.bits);
+  const float levels        = static_cast<float>((1 << param.bits) - 1);
+  const float* in           = inputs[0].dptr<float>();
+  uint8_t* out              = outputs[0].dptr<uint8_t>();
+  const int omp_threads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t r = 0; r < rows; ++r) {
+    const float* x = in + r * dim;
+    uint8_t* q     = out + r * row_bytes;
+    float min      = dim > 0 ? x[0] : 0.f;
+    float max      = min;
+    for (index_t d = 1; d < dim; ++d) {
+      min = std::min(min, x[d]);
+      max = std::max(max, x[d]);
+    }
+    const float scale   = (max - min) / levels;
+    const float inverse = scale > 0.f ? 1.f / scale : 0.f;
+    std::memset(q, 0, value_bytes);
+    for (index_t d = 0; d < dim; ++d) {
+      const float v = std::min(std::max(std::round((x[d] - min) * inverse), 0.f), levels);
+      if (param.bits == 8)
+        q[d] = static_cast<uint8_t>(v);
+      else
+        q[d / 2] |= static_cast<uint8_t>(v) << (4 * (d % 2));
+    }
+    std::memcpy(q + value_bytes, &scale, sizeof(float));
+    std::memcpy(q + value_bytes + sizeof(float), &min, sizeof(float));
+  }
+}
+
+/*!
+ * \brief accumulate the dequantized row of a row-wise quantized table into out
+ */
+template <int bits>
+inline void AccumulateQuantizedRow(const uint8_t* row, const index_t dim, float* out) {
+  const index_t value_bytes = rowwise_quantize::ValueBytes(dim, bits);
+  float scale, bias;
+  std::memcpy(&scale, row + value_bytes, sizeof(float));
+  std::memcpy(&bias, row + value_bytes + sizeof(float), sizeof(float));
+  if (bits == 8) {
+#pragma omp simd
+    for (index_t d = 0; d < dim; ++d)
+      out[d] += scale * row[d] + bias;
+  } else {
+    for (index_t d = 0; d < dim; ++d)
+      out[d] += scale * ((row[d / 2] >> (4 * (d % 2))) & 0xF) + bias;
+  }
+}
+
+template <int bits, typename IType, typename LType>
+void RowwiseQuantizedEmbeddingImpl(const RowwiseQuantizedEmbeddingParam& param,
+                                   const IType* data,
+                                   const uint8_t* weight,
+                                   const LType* length,
+                                   const index_t num_bags,
+                                   const index_t bag_size,
+                                   float* out) {
+  const index_t dim       = param.output_dim;
+  const index_t row_bytes = rowwise_quantize::RowBytes(dim, bits);
+  const index_t max_index = param.input_dim - 1;
+  const int omp_threads   = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // Without pooling every index is a bag of its own.
+  const bool pooled = param.pooling != rowwise_quantize::kNone;
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t b = 0; b < num_bags; ++b) {
+    index_t count = bag_size;
+    if (length != nullptr)
+      count = std::min(std::max(static_cast<index_t>(length[b]), index_t(0)), bag_size);
+    float* o = out + (pooled ? b : b * bag_size) * dim;
+    std::fill(o, o + (pooled ? 1 : bag_size) * dim, 0.f);
+    for (index_t j = 0; j < count; ++j) {
+      const index_t idx =
+          std::min(std::max(static_cast<index_t>(data[b * bag_size + j]), index_t(0)), max_index);
+      AccumulateQuantizedRow<bits>(weight + idx * row_bytes, dim, pooled ? o : o + j * dim);
+    }
+    if (param.pooling == rowwise_quantize::kMean && count > 0) {
+      const float inverse = 1.f / count;
+      for (index_t d = 0; d < dim; ++d)
+        o[d] *= inverse;
+    }
+  }
+}
+
+void RowwiseQuantizedEmbeddingForward(const nnvm::NodeAttrs& attrs,
+                                      const OpContext& ctx,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<OpReqType>& req,
+                                      const std::vector<TBlob>& outputs) {
+  using namespace rowwise_quantize;
+  const auto& param = nnvm::get<RowwiseQuantizedEmbeddingParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo) << "rowwise_quantized_embedding only supports req = kWriteTo";
+  const TBlob& data      = inputs[kData];
+  const bool pooled      = param.pooling != kNone;
+  const index_t bag_size = pooled ? data.shape_[data.ndim() - 1] : 1;
+  const index_t num_bags =
+      pooled ? outputs[0].shape_.Size() / param.output_dim : data.shape_.Size();
+  const uint8_t* weight  = inputs[kWeight].dptr<uint8_t>();
+  float* out             = outputs[0].dptr<float>();
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    const IType* indices = data.dptr<IType>();
+    if (param.use_length) {
+      MSHADOW_TYPE_SWITCH(inputs[kLength].type_flag_, LType, {
+        const LType* length = inputs[kLength].dptr<LType>();
+        if (param.bits == 8)
+          RowwiseQuantizedEmbeddingImpl<8>(param, indices, weight, length, num_bags, bag_size, out);
+        else
+          RowwiseQuantizedEmbeddingImpl<4>(param, indices, weight, length, num_bags, bag_size, out);
+      });
+    } else {
+      const IType* length = nullptr;
+      if (param.bits == 8)
+        RowwiseQuantizedEmbeddingImpl<8>(param, indices, weight, length, num_bags, bag_size, out);
+      else
+        RowwiseQuantizedEmbeddingImpl<4>(param, indices, weight, length, num_bags, bag_size, out);
+    }
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_rowwise_quantize)
+    .add_alias("_npx_rowwise_quantize")
+    .describe(R"code(Quantize a float32 embedding table row by row to 8 or 4 bits.
+
+Each row of the output holds the quantized values of the row, two to a byte for 4 bits with the
+lower half first, followed by the float32 scale and bias of the row, so that a value is
+``scale * quantized + bias``. The bias is the minimum of the row and the scale the range of the
+row divided by ``2^bits - 1``. The output is the weight of ``rowwise_quantized_embedding``.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<RowwiseQuantizeParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", RowwiseQuantizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", RowwiseQuantizeType)
+    .set_attr<FCompute>("FCompute<cpu>", RowwiseQuantizeForward)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("data", "NDArray-or-Symbol", "The float32 table to quantize.")
+    .add_arguments(RowwiseQuantizeParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_rowwise_quantized_embedding)
+    .add_alias("_npx_rowwise_quantized_embedding")
+    .describe(R"code(Maps integer indices to the float32 embeddings of a row-wise quantized table,
+and optionally pools the embeddings of each bag.
+
+The weight is the output of ``rowwise_quantize``. The rows are dequantized as they are looked up,
+so the table stays quantized. With ``pooling`` set to ``sum`` or ``mean`` the last axis of data is
+the bags, the embeddings of each bag are summed or averaged, and with ``use_length`` only the
+first ``length`` indices of each bag are used.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const auto& param = nnvm::get<RowwiseQuantizedEmbeddingParam>(attrs.parsed);
+      return param.use_length ? 3U : 2U;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<RowwiseQuantizedEmbeddingParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          const auto& param = nnvm::get<RowwiseQuantizedEmbeddingParam>(attrs.parsed);
+          if (param.use_length)
+            return std::vector<std::string>{"data", "weight", "length"};
+          return std::vector<std::string>{"data", "weight"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", RowwiseQuantizedEmbeddingShape)
+    .set_attr<nnvm::FInferType>("FInferType", RowwiseQuantizedEmbeddingType)
+    .set_attr<FCompute>("FCompute<cpu>", RowwiseQuantizedEmbeddingForward)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("data", "NDArray-or-Symbol", "The input array to the embedding operator.")
+    .add_argument("weight", "NDArray-or-Symbol", "The row-wise quantized embedding table.")
+    .add_argument("length", "NDArray-or-Symbol", "The number of indices of each bag.")
+    .add_arguments(RowwiseQuantizedEmbeddingParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -55,7 +55,7 @@ DMLC_REGISTER_PARAMETER(MultiSampleParam);
       .set_attr<FResourceRequest>("FResourceRequest",                                      \
                                   [](const NodeAttrs& attrs) {                             \
                                     return std::vector<ResourceRequest>{                   \
-                                        ResourceRequest::kParallelRandom,                  \
+                                        ResourceRequest::kCounterRandom,                   \
                                         ResourceRequest::kTempSpace};                      \
                                   })                                                       \
       .set_attr<FCompute>("FCompute<cpu>", MultiSampleOpForward<cpu, sampler, num_inputs>) \
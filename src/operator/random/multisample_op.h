@@ -147,7 +147,7 @@ template <typename xpu, typename IType, typename OType, typename Sampler>
 struct SamplerCaller<xpu, IType, OType, Sampler, 1> {
   static void op(const std::vector<TBlob>& inputs,
                  const std::vector<TBlob>& outputs,
-                 RandGenerator<xpu, OType>* pgen,
+                 PhiloxGenerator<xpu, OType>* pgen,
                  mshadow::Stream<xpu>* s) {
     Sampler sampler;
     sampler.Sample(inputs[0].FlatTo1D<xpu, IType>(s), outputs[0].FlatTo1D<xpu, OType>(s), pgen, s);
@@ -158,7 +158,7 @@ template <typename xpu, typename IType, typename OType, typename Sampler>
 struct SamplerCaller<xpu, IType, OType, Sampler, 2> {
   static void op(const std::vector<TBlob>& inputs,
                  const std::vector<TBlob>& outputs,
-                 RandGenerator<xpu, OType>* pgen,
+                 PhiloxGenerator<xpu, OType>* pgen,
                  mshadow::Stream<xpu>* s) {
     Sampler sampler;
     sampler.Sample(inputs[0].FlatTo1D<xpu, IType>(s),
@@ -185,8 +185,8 @@ void MultiSampleOpForward(const nnvm::NodeAttrs& attrs,
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, IType, {
     MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-      RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
-      SamplerCaller<xpu, IType, OType, Sampler, inum>::op(inputs, outputs, pgen, s);
+      PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
+      SamplerCaller<xpu, IType, OType, Sampler, inum>::op(inputs, outputs, &gen, s);
     });
   });
 }
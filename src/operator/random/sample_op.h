@@ -363,9 +363,9 @@ static inline void uniform_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.low, param.high, ctx, &low, &high);
   UniformSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(low, high, out, pgen, s);
+    sampler.Sample(low, high, out, &gen, s);
   });
 }
 
@@ -381,9 +381,9 @@ static inline void normal_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.loc, param.scale, ctx, &loc, &scale);
   NormalSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(loc, scale, out, pgen, s);
+    sampler.Sample(loc, scale, out, &gen, s);
   });
 }
 
@@ -400,9 +400,9 @@ static inline void gamma_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.alpha, param.beta, ctx, &alpha, &beta);
   GammaSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(alpha, beta, out, pgen, s);
+    sampler.Sample(alpha, beta, out, &gen, s);
   });
 }
 
@@ -418,9 +418,9 @@ static inline void exponential_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.lam, 0, ctx, &lam, &dummy);
   ExponentialSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(lam, out, pgen, s);
+    sampler.Sample(lam, out, &gen, s);
   });
 }
 
@@ -436,9 +436,9 @@ static inline void poisson_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.lam, 0, ctx, &lam, &dummy);
   PoissonSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(lam, out, pgen, s);
+    sampler.Sample(lam, out, &gen, s);
   });
 }
 
@@ -455,9 +455,9 @@ static inline void neg_binomial_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.k, param.p, ctx, &k, &p);
   NegativeBinomialSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(k, p, out, pgen, s);
+    sampler.Sample(k, p, out, &gen, s);
   });
 }
 
@@ -476,9 +476,9 @@ static inline void gen_neg_binomial_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, float>(param.mu, param.alpha, ctx, &mu, &alpha);
   GeneralizedNegativeBinomialSampler<xpu> sampler;
   MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(mu, alpha, out, pgen, s);
+    sampler.Sample(mu, alpha, out, &gen, s);
   });
 }
 
@@ -494,9 +494,9 @@ static inline void rand_int_op(const nnvm::NodeAttrs& attrs,
   GetSamplingTempData<xpu, int64_t>(param.low, param.high, ctx, &low, &high);
   RandIntSampler<xpu> sampler;
   MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, OType, {
-    RandGenerator<xpu, OType>* pgen = ctx.requested[0].get_parallel_random<xpu, OType>();
+    PhiloxGenerator<xpu, OType> gen = ctx.requested[0].get_counter_random<xpu, OType>();
     Tensor<xpu, 1, OType> out       = outputs->FlatTo1D<xpu, OType>(s);
-    sampler.Sample(low, high, out, pgen, s);
+    sampler.Sample(low, high, out, &gen, s);
   });
 }
 
@@ -770,7 +770,7 @@ inline bool SampleOpType<SampleRandIntParam>(const nnvm::NodeAttrs& attrs,
 }
 
 inline std::vector<ResourceRequest> SampleResource(const NodeAttrs& attrs) {
-  return {ResourceRequest::kParallelRandom, ResourceRequest::kTempSpace};
+  return {ResourceRequest::kCounterRandom, ResourceRequest::kTempSpace};
 }
 
 }  // namespace op
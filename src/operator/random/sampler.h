@@ -26,6 +26,8 @@
 #define MXNET_OPERATOR_RANDOM_SAMPLER_H_
 
 #include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 using namespace mshadow;
 using namespace mxnet::op::mxnet_op;
@@ -34,6 +36,28 @@ using namespace mxnet::common::random;
 namespace mxnet {
 namespace op {
 
+/*!
+ * \brief Launch a generic kernel over the threads of a random generator, at least
+ *  min_per_thread iterations per thread and at most max_threads threads.
+ */
+template <typename OP, typename xpu, typename Generator, typename... Args>
+inline static void LaunchRNGThreads(mshadow::Stream<xpu>* s,
+                                    const Generator& gen,
+                                    const index_t N,
+                                    const index_t min_per_thread,
+                                    const index_t max_threads,
+                                    Args... args) {
+  // minimal check to avoid division by zero, below.
+  // if `N` is zero the map operation is a no-op in any case.
+  if (N <= 0) {
+    return;
+  }
+  const index_t nloop   = (N + min_per_thread - 1) / min_per_thread;
+  const index_t nthread = std::min(nloop, max_threads);
+  const index_t step    = (N + nthread - 1) / nthread;
+  Kernel<OP, xpu>::Launch(s, nthread, gen, N, step, args...);
+}
+
 /*!
  * \brief Launch a generic kernel with parallel random generator.
  * \tparam gen random generator
@@ -45,32 +69,183 @@ inline static void LaunchRNG(mshadow::Stream<xpu>* s,
                              common::random::RandGenerator<xpu, GType>* gen,
                              const index_t N,
                              Args... args) {
-  // minimal check to avoid division by zero, below.
-  // if `N` is zero the map operation is a no-op in any case.
-  if (N <= 0) {
-    return;
+  LaunchRNGThreads<OP>(s,
+                       *gen,
+                       N,
+                       RandGenerator<xpu>::kMinNumRandomPerThread,
+                       RandGenerator<xpu>::kNumRandomStates,
+                       args...);
+}
+
+/*!
+ * \brief Launch a generic kernel with a counter based random generator, the threads are
+ *  those of LaunchRNG with a parallel random generator.
+ */
+template <typename OP, typename xpu, typename GType, typename... Args>
+inline static void LaunchRNG(mshadow::Stream<xpu>* s,
+                             common::random::PhiloxGenerator<xpu, GType>* gen,
+                             const index_t N,
+                             Args... args) {
+  using Generator = common::random::PhiloxGenerator<xpu, GType>;
+  LaunchRNGThreads<OP>(
+      s, *gen, N, Generator::kMinNumRandomPerThread, Generator::kNumRandomStates, args...);
+}
+
+/*! \brief the random generator of the kind of Generator drawing DType numbers */
+template <typename Generator, typename DType>
+struct GeneratorOf;
+
+template <typename xpu, typename GType, typename DType>
+struct GeneratorOf<common::random::RandGenerator<xpu, GType>, DType> {
+  using type = common::random::RandGenerator<xpu, DType>;
+};
+
+template <typename xpu, typename GType, typename DType>
+struct GeneratorOf<common::random::PhiloxGenerator<xpu, GType>, DType> {
+  using type = common::random::PhiloxGenerator<xpu, DType>;
+};
+
+/*!
+ * \brief loop of a thread of LaunchRNG over its iterations i, with genImpl the state of the
+ *  thread of gen, a RandGenerator or a PhiloxGenerator.
+ */
+#define RNG_KERNEL_LOOP(xpu, GType, thread_id, gen, N, step, ...)          \
+  const index_t start = thread_id * step;                                  \
+  const index_t end   = start + step;                                      \
+  typename std::decay<decltype(gen)>::type::Impl genImpl(&gen, thread_id); \
+  for (index_t i = start; i < end && i < N; ++i) {                         \
+    { __VA_ARGS__ }                                                        \
+  }
+
+/*!
+ * \brief loop of a thread of LaunchRNG over its iterations on CPU, drawing the numbers of the
+ *  iterations of a parameter in chunks: draw(&genImpl, u, n) draws the numbers of n iterations
+ *  and body(p, i, u, n) computes the iterations [i, i + n) of the parameter p from them.
+ */
+template <typename FType, typename Generator, typename Draw, typename Body>
+inline void RNGBulkLoop(index_t thread_id,
+                        Generator* gen,
+                        const index_t N,
+                        const index_t step,
+                        const index_t nBatch,
+                        Draw draw,
+                        Body body) {
+  using GenImpl       = typename Generator::Impl;
+  const index_t start = thread_id * step;
+  const index_t end   = std::min(start + step, N);
+  GenImpl genImpl(gen, thread_id);
+  FType u[GenImpl::kBulk];
+  for (index_t i = start; i < end;) {
+    const index_t p = i / nBatch;
+    const index_t n = std::min(std::min(end, (p + 1) * nBatch) - i, index_t(GenImpl::kBulk));
+    draw(&genImpl, u, static_cast<int>(n));
+    body(p, i, u, n);
+    i += n;
   }
-  const index_t nloop = (N + RandGenerator<xpu>::kMinNumRandomPerThread - 1) /
-                        RandGenerator<xpu>::kMinNumRandomPerThread;
-  const index_t nthread =
-      std::min(nloop, static_cast<index_t>(RandGenerator<xpu>::kNumRandomStates));
-  const index_t step = (N + nthread - 1) / nthread;
-  Kernel<OP, xpu>::Launch(s, nthread, *gen, N, step, args...);
 }
 
-#define RNG_KERNEL_LOOP(xpu, GType, thread_id, gen, N, step, ...)    \
-  const index_t start = thread_id * step;                            \
-  const index_t end   = start + step;                                \
-  typename RandGenerator<xpu, GType>::Impl genImpl(&gen, thread_id); \
-  for (index_t i = start; i < end && i < N; ++i) {                   \
-    { __VA_ARGS__ }                                                  \
+/*!
+ * \brief the ziggurat of 128 layers of the standard normal distribution (Marsaglia and Tsang,
+ *  2000), drawing the float normals of the CPU kernels in bulk. All but about 1% of the numbers
+ *  take a table lookup and a product, instead of the logarithm and sine of Box-Muller.
+ */
+class NormalZiggurat {
+ public:
+  static const NormalZiggurat& Get() {
+    static const NormalZiggurat inst;
+    return inst;
+  }
+
+  /*! \brief n <= GenImpl::kBulk standard normals of gen */
+  template <typename GenImpl>
+  void Draw(GenImpl* gen, float* out, int n) const {
+    uint32_t words[GenImpl::kBulk];
+    (*gen)(words, n);
+    bool rejected = false;
+    for (int i = 0; i < n; ++i) {
+      const int32_t hz = static_cast<int32_t>(words[i]);
+      out[i]           = hz * w_[hz & 127];
+      rejected |= Abs(hz) >= k_[hz & 127];
+    }
+    if (!rejected)
+      return;
+    for (int i = 0; i < n; ++i) {
+      const int32_t hz = static_cast<int32_t>(words[i]);
+      if (Abs(hz) >= k_[hz & 127])
+        out[i] = Reject(gen, hz);
+    }
+  }
+
+ private:
+  NormalZiggurat() {
+    const double m = 2147483648.0;
+    double dn = 3.442619855899, tn = dn;
+    const double vn = 9.91256303526217e-3;
+    const double q  = vn / std::exp(-0.5 * dn * dn);
+    k_[0]   = static_cast<uint32_t>((dn / q) * m);
+    k_[1]   = 0;
+    w_[0]   = static_cast<float>(q / m);
+    w_[127] = static_cast<float>(dn / m);
+    f_[0]   = 1.0f;
+    f_[127] = static_cast<float>(std::exp(-0.5 * dn * dn));
+    for (int i = 126; i >= 1; --i) {
+      dn        = std::sqrt(-2.0 * std::log(vn / dn + std::exp(-0.5 * dn * dn)));
+      k_[i + 1] = static_cast<uint32_t>((dn / tn) * m);
+      tn        = dn;
+      f_[i]     = static_cast<float>(std::exp(-0.5 * dn * dn));
+      w_[i]     = static_cast<float>(dn / m);
+    }
+  }
+
+  static uint32_t Abs(int32_t hz) {
+    return hz < 0 ? 0u - static_cast<uint32_t>(hz) : static_cast<uint32_t>(hz);
+  }
+
+  // the number of a word out of the rectangle of its layer: the tail beyond the base layer, the
+  // wedge of the layer, or the numbers of the next words
+  template <typename GenImpl>
+  float Reject(GenImpl* gen, int32_t hz) const {
+    const float r = 3.442620f;
+    while (true) {
+      const int iz = hz & 127;
+      float x      = hz * w_[iz];
+      if (iz == 0) {
+        float y;
+        do {
+          x = -std::log(1.0f - gen->uniform()) / r;
+          y = -std::log(1.0f - gen->uniform());
+        } while (y + y < x * x);
+        return hz > 0 ? r + x : -r - x;
+      }
+      if (f_[iz] + gen->uniform() * (f_[iz - 1] - f_[iz]) < std::exp(-0.5f * x * x))
+        return x;
+      hz = static_cast<int32_t>((*gen)());
+      if (Abs(hz) < k_[hz & 127])
+        return hz * w_[hz & 127];
+    }
   }
 
+  uint32_t k_[128];
+  float w_[128];
+  float f_[128];
+};
+
+/*! \brief n standard normals of gen on CPU, float ones by the ziggurat */
+template <typename GenImpl>
+inline void DrawNormals(GenImpl* gen, float* out, int n) {
+  NormalZiggurat::Get().Draw(gen, out, n);
+}
+
+template <typename GenImpl>
+inline void DrawNormals(GenImpl* gen, double* out, int n) {
+  gen->normal(out, n);
+}
+
 template <typename xpu>
 struct SampleUniformKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, OType> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -84,15 +259,40 @@ struct SampleUniformKernel {
           OType(lower[i / nBatch] + (upper[i / nBatch] - lower[i / nBatch]) * genImpl.uniform());
     });
   }
+
+  template <typename IType, typename OType, typename GType>
+  static void Map(index_t id,
+                  PhiloxGenerator<cpu, GType> gen,
+                  const index_t N,
+                  const index_t step,
+                  index_t nParm,
+                  index_t nSample,
+                  const IType* lower,
+                  const IType* upper,
+                  OType* out) {
+    using FType = typename PhiloxGenerator<cpu, GType>::Impl::FType;
+    RNGBulkLoop<FType>(
+        id,
+        &gen,
+        N,
+        step,
+        1 + (nSample - 1) / nParm,
+        [](auto* genImpl, FType* u, int n) { genImpl->uniform(u, n); },
+        [&](index_t p, index_t i, const FType* u, index_t n) {
+          const IType lo = lower[p], hi = upper[p];
+          for (index_t j = 0; j < n; ++j)
+            out[i + j] = OType(lo + (hi - lo) * u[j]);
+        });
+  }
 };
 
 template <typename xpu>
 struct UniformSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& lower,
                                    const Tensor<xpu, 1, IType>& upper,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
     LaunchRNG<SampleUniformKernel<xpu>, xpu>(
         s, pgen, out.size(0), lower.size(0), out.size(0), lower.dptr_, upper.dptr_, out.dptr_);
@@ -101,9 +301,9 @@ struct UniformSampler {
 
 template <typename xpu>
 struct SampleRandIntKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, OType> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -125,11 +325,11 @@ struct SampleRandIntKernel {
 
 template <typename xpu>
 struct RandIntSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& lower,
                                    const Tensor<xpu, 1, IType>& upper,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
     LaunchRNG<SampleRandIntKernel<xpu>, xpu>(
         s, pgen, out.size(0), lower.size(0), out.size(0), lower.dptr_, upper.dptr_, out.dptr_);
@@ -138,9 +338,9 @@ struct RandIntSampler {
 
 template <typename xpu>
 struct SampleNormalKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, OType> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -153,15 +353,40 @@ struct SampleNormalKernel {
       out[i] = OType(genImpl.normal() * std[i / nBatch] + mean[i / nBatch]);
     });
   }
+
+  template <typename IType, typename OType, typename GType>
+  static void Map(index_t id,
+                  PhiloxGenerator<cpu, GType> gen,
+                  const index_t N,
+                  const index_t step,
+                  index_t nParm,
+                  index_t nSample,
+                  const IType* mean,
+                  const IType* std,
+                  OType* out) {
+    using FType = typename PhiloxGenerator<cpu, GType>::Impl::FType;
+    RNGBulkLoop<FType>(
+        id,
+        &gen,
+        N,
+        step,
+        1 + (nSample - 1) / nParm,
+        [](auto* genImpl, FType* u, int n) { DrawNormals(genImpl, u, n); },
+        [&](index_t p, index_t i, const FType* u, index_t n) {
+          const IType mu = mean[p], sigma = std[p];
+          for (index_t j = 0; j < n; ++j)
+            out[i + j] = OType(u[j] * sigma + mu);
+        });
+  }
 };
 
 template <typename xpu>
 struct NormalSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& mean,
                                    const Tensor<xpu, 1, IType>& std,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
     LaunchRNG<SampleNormalKernel<xpu>, xpu>(
         s, pgen, out.size(0), mean.size(0), out.size(0), mean.dptr_, std.dptr_, out.dptr_);
@@ -170,9 +395,9 @@ struct NormalSampler {
 
 template <typename xpu>
 struct SampleExponentialKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, OType> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -184,22 +409,46 @@ struct SampleExponentialKernel {
       out[i] = OType(-log(1.0 - genImpl.uniform()) / lambda[i / nBatch]);
     });
   }
+
+  template <typename IType, typename OType, typename GType>
+  static void Map(index_t id,
+                  PhiloxGenerator<cpu, GType> gen,
+                  const index_t N,
+                  const index_t step,
+                  index_t nParm,
+                  index_t nSample,
+                  const IType* lambda,
+                  OType* out) {
+    using FType = typename PhiloxGenerator<cpu, GType>::Impl::FType;
+    RNGBulkLoop<FType>(
+        id,
+        &gen,
+        N,
+        step,
+        1 + (nSample - 1) / nParm,
+        [](auto* genImpl, FType* u, int n) { genImpl->uniform(u, n); },
+        [&](index_t p, index_t i, const FType* u, index_t n) {
+          const IType lam = lambda[p];
+          for (index_t j = 0; j < n; ++j)
+            out[i + j] = OType(-log(1.0 - u[j]) / lam);
+        });
+  }
 };
 
 template <typename xpu>
 struct ExponentialSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& lambda,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
     LaunchRNG<SampleExponentialKernel<xpu>, xpu>(
         s, pgen, out.size(0), lambda.size(0), out.size(0), lambda.dptr_, out.dptr_);
   }
 };
 
-template <typename xpu, typename IType, typename OType>
-MSHADOW_XINLINE OType SampleGamma(IType a, IType b, typename RandGenerator<xpu, OType>::Impl* gen) {
+template <typename xpu, typename IType, typename OType, typename GenImpl>
+MSHADOW_XINLINE OType SampleGamma(IType a, IType b, GenImpl* gen) {
   // Generate one sample of the gamma distribution
   OType sample;
   OType d = a < 1 ? a + 2.0 / 3.0 : a - 1.0 / 3.0;
@@ -221,9 +470,9 @@ MSHADOW_XINLINE OType SampleGamma(IType a, IType b, typename RandGenerator<xpu,
 
 template <typename xpu>
 struct SampleGammaKernel {
-  template <typename IType, typename OType, typename FType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, FType> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -231,6 +480,8 @@ struct SampleGammaKernel {
                                   const IType* alpha,
                                   const IType* beta,
                                   OType* out) {
+    typedef
+        typename std::conditional<std::is_floating_point<OType>::value, OType, float>::type FType;
     RNG_KERNEL_LOOP(xpu, FType, id, gen, N, step, {
       index_t nBatch(1 + (nSample - 1) / nParm);
       out[i] = OType(SampleGamma<xpu, IType, FType>(alpha[i / nBatch], beta[i / nBatch], &genImpl));
@@ -240,22 +491,22 @@ struct SampleGammaKernel {
 
 template <typename xpu>
 struct GammaSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& alpha,
                                    const Tensor<xpu, 1, IType>& beta,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
     typedef
         typename std::conditional<std::is_floating_point<OType>::value, OType, float>::type FType;
-    RandGenerator<xpu, FType>* gen = reinterpret_cast<RandGenerator<xpu, FType>*>(pgen);
+    auto gen = reinterpret_cast<typename GeneratorOf<Generator, FType>::type*>(pgen);
     LaunchRNG<SampleGammaKernel<xpu>, xpu>(
         s, gen, out.size(0), alpha.size(0), out.size(0), alpha.dptr_, beta.dptr_, out.dptr_);
   }
 };
 
-template <typename xpu>
-MSHADOW_XINLINE int SamplePoisson(float lambda, typename RandGenerator<xpu, float>::Impl* gen) {
+template <typename xpu, typename GenImpl>
+MSHADOW_XINLINE int SamplePoisson(float lambda, GenImpl* gen) {
   // Generate one sample of the poisson distribution. Intentionally written
   // towards a specific type (float) for internal computation which is sufficient
   // for accurate enough computation.
@@ -289,9 +540,9 @@ MSHADOW_XINLINE int SamplePoisson(float lambda, typename RandGenerator<xpu, floa
 
 template <typename xpu>
 struct SamplePoissonKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, float> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -307,12 +558,12 @@ struct SamplePoissonKernel {
 
 template <typename xpu>
 struct PoissonSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& lambda,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
-    RandGenerator<xpu, float>* gen = reinterpret_cast<RandGenerator<xpu, float>*>(pgen);
+    auto gen = reinterpret_cast<typename GeneratorOf<Generator, float>::type*>(pgen);
     LaunchRNG<SamplePoissonKernel<xpu>, xpu>(
         s, gen, out.size(0), lambda.size(0), out.size(0), lambda.dptr_, out.dptr_);
   }
@@ -320,9 +571,9 @@ struct PoissonSampler {
 
 template <typename xpu>
 struct SampleNegativeBinomialKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, float> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -343,13 +594,13 @@ struct SampleNegativeBinomialKernel {
 
 template <typename xpu>
 struct NegativeBinomialSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& k,
                                    const Tensor<xpu, 1, IType>& p,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
-    RandGenerator<xpu, float>* gen = reinterpret_cast<RandGenerator<xpu, float>*>(pgen);
+    auto gen = reinterpret_cast<typename GeneratorOf<Generator, float>::type*>(pgen);
     LaunchRNG<SampleNegativeBinomialKernel<xpu>, xpu>(
         s, gen, out.size(0), k.size(0), out.size(0), k.dptr_, p.dptr_, out.dptr_);
   }
@@ -357,9 +608,9 @@ struct NegativeBinomialSampler {
 
 template <typename xpu>
 struct SampleGeneralizedNegativeBinomialKernel {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_XINLINE static void Map(index_t id,
-                                  RandGenerator<xpu, float> gen,
+                                  Generator gen,
                                   const index_t N,
                                   const index_t step,
                                   index_t nParm,
@@ -381,13 +632,13 @@ struct SampleGeneralizedNegativeBinomialKernel {
 
 template <typename xpu>
 struct GeneralizedNegativeBinomialSampler {
-  template <typename IType, typename OType>
+  template <typename IType, typename OType, typename Generator>
   MSHADOW_FORCE_INLINE void Sample(const Tensor<xpu, 1, IType>& mu,
                                    const Tensor<xpu, 1, IType>& alpha,
                                    const Tensor<xpu, 1, OType>& out,
-                                   RandGenerator<xpu, OType>* pgen,
+                                   Generator* pgen,
                                    Stream<xpu>* s) {
-    RandGenerator<xpu, float>* gen = reinterpret_cast<RandGenerator<xpu, float>*>(pgen);
+    auto gen = reinterpret_cast<typename GeneratorOf<Generator, float>::type*>(pgen);
     LaunchRNG<SampleGeneralizedNegativeBinomialKernel<xpu>, xpu>(
         s, gen, out.size(0), mu.size(0), out.size(0), mu.dptr_, alpha.dptr_, out.dptr_);
   }
@@ -36,6 +36,7 @@
 #include <parallel/algorithm>
 #endif
 #include "../elemwise_op_common.h"
+#include "./sampler.h"
 
 namespace mxnet {
 namespace op {
@@ -111,7 +112,8 @@ void ShuffleForwardCPU(const nnvm::NodeAttrs& attrs,
   MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
     Tensor<cpu, 1, DType> in  = inputs[0].get_with_shape<cpu, 1, DType>(Shape1(size), s);
     Tensor<cpu, 1, DType> out = outputs[0].get_with_shape<cpu, 1, DType>(Shape1(size), s);
-    auto& prnd = ctx.requested[0].get_random<cpu, index_t>(ctx.get_stream<cpu>())->GetRndEngine();
+    PhiloxGenerator<cpu> gen  = ctx.requested[0].get_counter_random<cpu, float>();
+    PhiloxGenerator<cpu>::Impl prnd(&gen, 0);
     if (req[0] != kWriteInplace) {
       std::copy(in.dptr_, in.dptr_ + size, out.dptr_);
     }
@@ -142,8 +144,8 @@ but the order of the elements in each row does not change.
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const nnvm::NodeAttrs& attrs) {
-                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom,
-                                                                      ResourceRequest::kTempSpace};
+                                  return std::vector<ResourceRequest>{
+                                      ResourceRequest::kCounterRandom, ResourceRequest::kTempSpace};
                                 })
     .set_attr<nnvm::FInplaceOption>("FInplaceOption",
                                     [](const NodeAttrs& attrs) {
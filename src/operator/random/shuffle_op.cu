@@ -27,12 +27,24 @@
 #include <vector>
 #include "../elemwise_op_common.h"
 #include "../tensor/init_op.h"
+#include "./sampler.h"
 
 namespace mxnet {
 namespace op {
 
 namespace {
 
+struct ShuffleKeys {
+  template <typename Generator>
+  MSHADOW_XINLINE static void Map(index_t id,
+                                  Generator gen,
+                                  const index_t N,
+                                  const index_t step,
+                                  uint32_t* keys) {
+    RNG_KERNEL_LOOP(gpu, float, id, gen, N, step, { keys[i] = genImpl(); });
+  }
+};
+
 struct CopyForShuffle {
   template <typename DType>
   MSHADOW_XINLINE static void Map(int i,
@@ -62,17 +74,17 @@ void ShuffleForwardGPU(const nnvm::NodeAttrs& attrs,
   const index_t stride             = size / first_axis_len;
   Stream<gpu>* s                   = ctx.get_stream<gpu>();
   MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
-    using KeyType              = uint32_t;
-    Tensor<gpu, 1, DType> in   = inputs[0].get_with_shape<gpu, 1, DType>(Shape1(size), s);
-    Tensor<gpu, 1, DType> out  = outputs[0].get_with_shape<gpu, 1, DType>(Shape1(size), s);
-    Random<gpu, KeyType>* prnd = ctx.requested[0].get_random<gpu, KeyType>(s);
+    using KeyType             = uint32_t;
+    Tensor<gpu, 1, DType> in  = inputs[0].get_with_shape<gpu, 1, DType>(Shape1(size), s);
+    Tensor<gpu, 1, DType> out = outputs[0].get_with_shape<gpu, 1, DType>(Shape1(size), s);
+    PhiloxGenerator<gpu> gen  = ctx.requested[0].get_counter_random<gpu, float>();
     if (input_shape.ndim() == 1) {
       if (req[0] != kWriteInplace) {
         Copy(out, in, s);
       }
       Tensor<gpu, 1, KeyType> keys =
           ctx.requested[1].get_space_typed<gpu, 1, KeyType>(Shape1(size), s);
-      prnd->GetRandInt(keys);
+      LaunchRNG<ShuffleKeys, gpu>(s, &gen, keys.size(0), keys.dptr_);
       SortByKey(keys, out, true);
     } else {
       const size_t tmp_space_size =
@@ -89,7 +101,7 @@ void ShuffleForwardGPU(const nnvm::NodeAttrs& attrs,
       Tensor<gpu, 1, KeyType> keys(
           reinterpret_cast<KeyType*>(tmp_space_ptr), Shape1(first_axis_len), s);
       tmp_space_ptr += sizeof(KeyType) * first_axis_len;
-      prnd->GetRandInt(keys);
+      LaunchRNG<ShuffleKeys, gpu>(s, &gen, keys.size(0), keys.dptr_);
       SortByKey(keys, indices, true);
       if (req[0] == kWriteInplace) {
         Tensor<gpu, 1, DType> buf(reinterpret_cast<DType*>(tmp_space_ptr), Shape1(size), s);
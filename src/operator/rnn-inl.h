@@ -75,6 +75,7 @@ struct RNNParam : public dmlc::Parameter<RNNParam> {
   dmlc::optional<int> projection_size;
   dmlc::optional<double> lstm_state_clip_min, lstm_state_clip_max;
   bool lstm_state_clip_nan;
+  bool use_persistent;
 
   DMLC_DECLARE_PARAMETER(RNNParam) {
     DMLC_DECLARE_FIELD(state_size).describe("size of the state for each layer");
@@ -127,6 +128,14 @@ struct RNNParam : public dmlc::Parameter<RNNParam> {
             "If set to true, this layer takes in an extra input parameter "
             "`sequence_length` "
             "to specify variable length sequence");
+
+    DMLC_DECLARE_FIELD(use_persistent)
+        .set_default(false)
+        .describe(
+            "Whether to use the persistent cuDNN kernels, which keep the recurrent weights on chip "
+            "across the time steps, on GPU. They reduce the latency of small batches. The layer "
+            "falls back to the standard kernels when the weights do not fit or the configuration "
+            "is not supported.");
   }
   std::string ComputeMode2String(int mode) {
     switch (mode) {
@@ -147,7 +156,7 @@ struct RNNParam : public dmlc::Parameter<RNNParam> {
   void SetAttrDict(std::unordered_map<std::string, std::string>* dict) {
     std::ostringstream state_size_s, num_layers_s, bidirectional_s, state_outputs_s, mode_s, p_s,
         use_sequence_length_s, projection_size_s, lstm_state_clip_min_s, lstm_state_clip_max_s,
-        lstm_state_clip_nan_s;
+        lstm_state_clip_nan_s, use_persistent_s;
     state_size_s << state_size;
     num_layers_s << num_layers;
     bidirectional_s << bidirectional;
@@ -159,6 +168,7 @@ struct RNNParam : public dmlc::Parameter<RNNParam> {
     lstm_state_clip_min_s << lstm_state_clip_min;
     lstm_state_clip_max_s << lstm_state_clip_max;
     lstm_state_clip_nan_s << lstm_state_clip_nan;
+    use_persistent_s << use_persistent;
     (*dict)["state_size"]          = state_size_s.str();
     (*dict)["num_layers"]          = num_layers_s.str();
     (*dict)["bidirectional"]       = bidirectional_s.str();
@@ -170,6 +180,7 @@ struct RNNParam : public dmlc::Parameter<RNNParam> {
     (*dict)["lstm_state_clip_min"] = lstm_state_clip_min_s.str();
     (*dict)["lstm_state_clip_max"] = lstm_state_clip_max_s.str();
     (*dict)["lstm_state_clip_nan"] = lstm_state_clip_nan_s.str();
+    (*dict)["use_persistent"]      = use_persistent_s.str();
   }
 };
 
@@ -429,7 +440,8 @@ void RNNForwardInference(DType* ws,
                          DType* y_ptr,
                          DType* hy_ptr,
                          DType* cy_ptr,
-                         int mode) {
+                         int mode,
+                         RNNWeightPack* packs) {
   switch (mode) {
     case rnn_enum::kLstm:
       LstmForwardInference<DType>(ws,
@@ -448,7 +460,8 @@ void RNNForwardInference(DType* ws,
                                   b_ptr,
                                   y_ptr,
                                   hy_ptr,
-                                  cy_ptr);
+                                  cy_ptr,
+                                  packs);
       break;
     case rnn_enum::kGru:
       GruForwardInference<DType>(ws,
@@ -463,7 +476,8 @@ void RNNForwardInference(DType* ws,
                                  hx_ptr,
                                  w_ptr,
                                  y_ptr,
-                                 hy_ptr);
+                                 hy_ptr,
+                                 packs);
       break;
     case rnn_enum::kRnnTanh:
     case rnn_enum::kRnnRelu:
@@ -480,7 +494,8 @@ void RNNForwardInference(DType* ws,
                                         w_ptr,
                                         y_ptr,
                                         hy_ptr,
-                                        mode);
+                                        mode,
+                                        packs);
       break;
     default:
       LOG(FATAL) << "unknown RNN mode" << mode;
@@ -1091,6 +1106,13 @@ class RNNOp {
                                   param_.mode,
                                   rnd_engine);
       } else {
+        // the recurrent weights are packed again by each call unless they are cached, as their
+        // values are then invariant
+        RNNWeightPack* packs = nullptr;
+        if (dmlc::GetEnv("MXNET_RNN_USE_WEIGHT_CACHE", 0)) {
+          weight_packs_.resize(param_.num_layers * direction);
+          packs = weight_packs_.data();
+        }
         RNNForwardInference<DType>(work_cpu_space,
                                    param_.state_outputs,
                                    param_.num_layers,
@@ -1108,7 +1130,8 @@ class RNNOp {
                                    y.dptr_,
                                    hy_ptr,
                                    cy_ptr,
-                                   param_.mode);
+                                   param_.mode,
+                                   packs);
       }
     }
 #endif
@@ -1481,7 +1504,36 @@ class RNNOp {
       cudnnDataType_t dtype_with_fallback_ =
           (cudnnGetVersion() >= 7500 && dtype_ == CUDNN_DATA_HALF) ? CUDNN_DATA_FLOAT : dtype_;
       cudnnRNNAlgo_t rnn_algo = CUDNN_RNN_ALGO_STANDARD;
-      dgrad_sync_needed_      = (rnn_algo == CUDNN_RNN_ALGO_STANDARD) && param_.bidirectional;
+      // The persistent kernels support neither projections nor padded sequences.
+      if (param_.use_persistent && !param_.projection_size.has_value() &&
+          !param_.use_sequence_length) {
+        CUDNN_CALL(cudnnSetRNNDescriptor_v6(s->dnn_handle_,
+                                            rnn_desc_,
+                                            param_.state_size,
+                                            param_.num_layers,
+                                            dropout_desc_,
+                                            input_mode_,
+                                            direction_,
+                                            mode_,
+                                            CUDNN_RNN_ALGO_PERSIST_STATIC,
+                                            dtype_with_fallback_));
+        // cuDNN rejects the configurations whose weights do not fit on chip.
+        size_t persistent_workspace_byte = 0;
+        if (cudnnGetRNNWorkspaceSize(s->dnn_handle_,
+                                     rnn_desc_,
+                                     param_.seq_length_,
+                                     x_desc_vec_.data(),
+                                     &persistent_workspace_byte) == CUDNN_STATUS_SUCCESS) {
+          rnn_algo = CUDNN_RNN_ALGO_PERSIST_STATIC;
+        } else {
+          LOG(INFO) << "The persistent cuDNN RNN kernels do not support this configuration, "
+                    << "falling back to the standard kernels.";
+        }
+      } else if (param_.use_persistent) {
+        LOG(INFO) << "The persistent cuDNN RNN kernels support neither projection_size nor "
+                  << "use_sequence_length, falling back to the standard kernels.";
+      }
+      dgrad_sync_needed_ = (rnn_algo == CUDNN_RNN_ALGO_STANDARD) && param_.bidirectional;
       CUDNN_CALL(cudnnSetRNNDescriptor_v6(s->dnn_handle_,
                                           rnn_desc_,
                                           param_.state_size,
@@ -1577,6 +1629,7 @@ class RNNOp {
   bool init_space_, temp_init_space_;
   size_t reserve_cpu_space_size_, temp_cpu_space_size_;
   NDArray reserve_cpu_space_, temp_cpu_space_;
+  std::vector<RNNWeightPack> weight_packs_;
 
 #if MXNET_USE_CUDNN == 1 && defined(__CUDACC__)
   // cuDNN versions up to and including v7.6.4 did not sync a last dgrad kernel back to the main
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <random>
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <utility>
@@ -53,6 +54,84 @@ inline DType relu(DType x) {
   return x > 0.0f ? static_cast<float>(x) : 0.0f;
 }
 
+/*!
+ * \brief the recurrent weight of one direction of a layer packed by MKL for the GEMMs of all the
+ *  steps, kept by the RNN operator when MXNET_RNN_USE_WEIGHT_CACHE is set
+ */
+struct RNNWeightPack {
+  const void* weight = nullptr;
+  index_t rows       = 0;
+  std::shared_ptr<void> data;
+};
+
+/*!
+ * \brief out = h * w.T + beta * out for the hidden state h of a step, with the float weight w
+ *  packed into pack when MKL is used, which it is again only when w or the rows of h change
+ */
+template <typename DType>
+inline void RNNRecurrentGemm(const Tensor<cpu, 2, DType>& h,
+                             const Tensor<cpu, 2, DType>& w,
+                             const Tensor<cpu, 2, DType>& out,
+                             DType beta,
+                             RNNWeightPack* pack) {
+  linalg_gemm(h, w, out, DType(1), beta, false, true);
+}
+
+#if MSHADOW_USE_MKL == 1 && INTEL_MKL_VERSION >= 20170000
+template <>
+inline void RNNRecurrentGemm<float>(const Tensor<cpu, 2, float>& h,
+                                    const Tensor<cpu, 2, float>& w,
+                                    const Tensor<cpu, 2, float>& out,
+                                    float beta,
+                                    RNNWeightPack* pack) {
+  const MKL_INT m = h.size(0), n = w.size(0), k = w.size(1);
+  if (pack->data == nullptr || pack->weight != w.dptr_ || pack->rows != h.size(0)) {
+    float* packed = cblas_sgemm_alloc(CblasBMatrix, m, n, k);
+    cblas_sgemm_pack(
+        CblasRowMajor, CblasBMatrix, CblasTrans, m, n, k, 1.0f, w.dptr_, w.stride_, packed);
+    pack->data.reset(packed, cblas_sgemm_free);
+    pack->weight = w.dptr_;
+    pack->rows   = h.size(0);
+  }
+  cblas_sgemm_compute(CblasRowMajor,
+                      CblasNoTrans,
+                      CblasPacked,
+                      m,
+                      n,
+                      k,
+                      h.dptr_,
+                      h.stride_,
+                      static_cast<float*>(pack->data.get()),
+                      k,
+                      beta,
+                      out.dptr_,
+                      out.stride_);
+}
+#endif
+
+/*!
+ * \brief writes to each of the rows rows of out, of cols elements, the biases bx + bh that do not
+ *  depend on the hidden state, or bx alone for the columns from bx_only on, so that the input
+ *  projection adds into them
+ */
+template <typename DType>
+inline void RNNFillBias(DType* out,
+                        index_t rows,
+                        index_t cols,
+                        index_t bx_only,
+                        const DType* bx,
+                        const DType* bh) {
+  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < rows; ++i) {
+    DType* row = out + i * cols;
+    for (index_t j = 0; j < bx_only; ++j)
+      row[j] = bx[j] + bh[j];
+    for (index_t j = bx_only; j < cols; ++j)
+      row[j] = bx[j];
+  }
+}
+
 template <typename DType>
 void LstmForwardTrainingSingleLayer(DType* ws,
                                     DType* rs,
@@ -73,38 +152,39 @@ void LstmForwardTrainingSingleLayer(DType* ws,
   using namespace mshadow;
   const Tensor<cpu, 2, DType> wx(w_ptr, Shape2(H * 4, I));
   const Tensor<cpu, 2, DType> wh(w_ptr + I * H * 4, Shape2(H * 4, H));
-  const Tensor<cpu, 2, DType> bx(b_ptr, Shape2(4, H));
-  const Tensor<cpu, 2, DType> bh(b_ptr + H * 4, Shape2(4, H));
   const Tensor<cpu, 2, DType> yx_flat(ws, Shape2(T * N, 4 * H));
-  const Tensor<cpu, 2, DType> yh_flat(ws + T * N * H * 4, Shape2(N, 4 * H));
-  const Tensor<cpu, 4, DType> yx(yx_flat.dptr_, Shape4(T, N, 4, H));
-  const Tensor<cpu, 3, DType> yh(yh_flat.dptr_, Shape3(N, 4, H));
-  Tensor<cpu, 2, DType> h(yh_flat.dptr_ + N * H * 4, Shape2(N, H));
+  Tensor<cpu, 2, DType> h(ws + (T + 1) * N * H * 4, Shape2(N, H));
   DType* c_ptr = bid ? rs + T * N * H * 7 : rs;
   Tensor<cpu, 3, DType> c(c_ptr, Shape3(T, N, H));
   Tensor<cpu, 4, DType> ifgo(c_ptr + T * N * H, Shape4(T, N, H, 4));
 
   const int offset        = bid ? H : 0;
   const DType alpha       = 1.0;
-  const DType beta        = 0.0;
+  const DType beta        = 1.0;
   const index_t cell_size = N * H;
+  // the gates of all the steps start from the biases and the input projection, to which each
+  // step adds the projection of its hidden state
+  RNNFillBias(yx_flat.dptr_, T * N, H * 4, H * 4, b_ptr, b_ptr + H * 4);
   linalg_gemm(x, wx, yx_flat, alpha, beta, false, true);
 
+  RNNWeightPack pack;
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   for (index_t i = 0; i < T; ++i) {
     index_t t = bid ? T - 1 - i : i;
-    linalg_gemm(i ? h : hx, wh, yh_flat, alpha, beta, false, true);
+    const Tensor<cpu, 2, DType> yx_t(yx_flat.dptr_ + t * N * H * 4, Shape2(N, H * 4));
+    RNNRecurrentGemm(i ? h : hx, wh, yx_t, beta, &pack);
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t jk = 0; jk < cell_size; ++jk) {
-      index_t j = jk / H;
-      index_t k = jk % H;
-      DType it  = sigmoid<DType>(yx[t][j][0][k] + yh[j][0][k] + bx[0][k] + bh[0][k]);
-      DType ft  = sigmoid<DType>(yx[t][j][1][k] + yh[j][1][k] + bx[1][k] + bh[1][k]);
-      DType gt  = tanh(yx[t][j][2][k] + yh[j][2][k] + bx[2][k] + bh[2][k]);
-      DType ot  = sigmoid<DType>(yx[t][j][3][k] + yh[j][3][k] + bx[3][k] + bh[3][k]);
-      DType ct  = (i ? c[i - 1][j][k] : cx[j][k]) * ft + it * gt;
-      DType ht  = ot * tanh(ct);
-      h[j][k]   = ht;
+      index_t j      = jk / H;
+      index_t k      = jk % H;
+      const DType* g = yx_t.dptr_ + j * H * 4;
+      DType it       = sigmoid<DType>(g[k]);
+      DType ft       = sigmoid<DType>(g[H + k]);
+      DType gt       = tanh(g[H * 2 + k]);
+      DType ot       = sigmoid<DType>(g[H * 3 + k]);
+      DType ct       = (i ? c[i - 1][j][k] : cx[j][k]) * ft + it * gt;
+      DType ht       = ot * tanh(ct);
+      h[j][k]        = ht;
       // reserve
       y[t][j][k + offset] = ht;
       c[i][j][k]          = ct;
@@ -243,20 +323,16 @@ void LstmForwardInferenceSingleLayer(DType* ws,
                                      DType* w_ptr,
                                      DType* b_ptr,
                                      DType* hy_ptr,
-                                     DType* cy_ptr) {
+                                     DType* cy_ptr,
+                                     RNNWeightPack* pack) {
   using namespace mshadow;
   const Tensor<cpu, 2, DType> wx(w_ptr, Shape2(H * 4, I));
   const Tensor<cpu, 2, DType> wh(w_ptr + I * H * 4, Shape2(H * 4, (P ? P : H)));
   Tensor<cpu, 2, DType> whr(w_ptr, Shape2(1, 1));
   if (P > 0)
     whr = Tensor<cpu, 2, DType>(wh.dptr_ + P * 4 * H, Shape2(P, H));
-  const Tensor<cpu, 2, DType> bx(b_ptr, Shape2(4, H));
-  const Tensor<cpu, 2, DType> bh(b_ptr + H * 4, Shape2(4, H));
   Tensor<cpu, 2, DType> yx_flat(ws, Shape2(T * N, H * 4));
-  Tensor<cpu, 2, DType> yh_flat(ws + T * N * H * 4, Shape2(N, H * 4));
-  const Tensor<cpu, 4, DType> yx(yx_flat.dptr_, Shape4(T, N, 4, H));
-  const Tensor<cpu, 3, DType> yh(yh_flat.dptr_, Shape3(N, 4, H));
-  Tensor<cpu, 2, DType> h(yh_flat.dptr_ + N * H * 4, Shape2(N, H));
+  Tensor<cpu, 2, DType> h(ws + (T + 1) * N * H * 4, Shape2(N, H));
   Tensor<cpu, 2, DType> c(h.dptr_ + N * H, Shape2(N, H));
   Tensor<cpu, 2, DType> r(hy_ptr, Shape2(1, 1));
   if (P > 0)
@@ -265,27 +341,34 @@ void LstmForwardInferenceSingleLayer(DType* ws,
   const int proj_offset   = bid ? P : 0;
   const DType alpha       = 1.0;
   const DType beta        = 0.0;
+  const DType beta1       = 1.0;
   const index_t cell_size = N * H;
-  linalg_gemm(x, wx, yx_flat, alpha, beta, false, true);
+  RNNFillBias(yx_flat.dptr_, T * N, H * 4, H * 4, b_ptr, b_ptr + H * 4);
+  linalg_gemm(x, wx, yx_flat, alpha, beta1, false, true);
 
+  RNNWeightPack local_pack;
+  if (pack == nullptr)
+    pack = &local_pack;
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   for (index_t i = 0; i < T; ++i) {
     index_t t = bid ? T - 1 - i : i;
+    const Tensor<cpu, 2, DType> yx_t(yx_flat.dptr_ + t * N * H * 4, Shape2(N, H * 4));
     if (P > 0) {
-      linalg_gemm(i ? r : hx, wh, yh_flat, alpha, beta, false, true);
+      RNNRecurrentGemm(i ? r : hx, wh, yx_t, beta1, pack);
     } else {
-      linalg_gemm(i ? h : hx, wh, yh_flat, alpha, beta, false, true);
+      RNNRecurrentGemm(i ? h : hx, wh, yx_t, beta1, pack);
     }
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t jk = 0; jk < cell_size; ++jk) {
-      int j    = jk / H;
-      int k    = jk % H;
-      DType it = sigmoid<DType>(yx[t][j][0][k] + yh[j][0][k] + bx[0][k] + bh[0][k]);
-      DType ft = sigmoid<DType>(yx[t][j][1][k] + yh[j][1][k] + bx[1][k] + bh[1][k]);
-      DType gt = tanh(yx[t][j][2][k] + yh[j][2][k] + bx[2][k] + bh[2][k]);
-      DType ot = sigmoid<DType>(yx[t][j][3][k] + yh[j][3][k] + bx[3][k] + bh[3][k]);
-      DType ct = (i ? c[j][k] : cx[j][k]) * ft + it * gt;
-      DType ht = ot * tanh(ct);
+      int j          = jk / H;
+      int k          = jk % H;
+      const DType* g = yx_t.dptr_ + j * H * 4;
+      DType it       = sigmoid<DType>(g[k]);
+      DType ft       = sigmoid<DType>(g[H + k]);
+      DType gt       = tanh(g[H * 2 + k]);
+      DType ot       = sigmoid<DType>(g[H * 3 + k]);
+      DType ct       = (i ? c[j][k] : cx[j][k]) * ft + it * gt;
+      DType ht       = ot * tanh(ct);
       if (P == 0)
         y[t][j][k + offset] = ht;
       if (i == T - 1 && state_outputs) {
@@ -329,7 +412,8 @@ void LstmForwardInference(DType* ws,
                           DType* b_ptr,
                           DType* y_ptr,
                           DType* hy_ptr,
-                          DType* cy_ptr) {
+                          DType* cy_ptr,
+                          RNNWeightPack* packs) {
   const int total_layers = D * L;
   Tensor<cpu, 3, DType> hx(hx_ptr, Shape3(total_layers, N, P ? P : H));
   Tensor<cpu, 3, DType> cx(cx_ptr, Shape3(total_layers, N, H));
@@ -368,7 +452,8 @@ void LstmForwardInference(DType* ws,
                                            w_ptr,
                                            b_ptr,
                                            hy_ptr,
-                                           cy_ptr);
+                                           cy_ptr,
+                                           packs ? packs + i * D : nullptr);
     // If bidirectional, then calculate the reverse direction's forward result.
     if (D == 2) {
       w_ptr += w_size;
@@ -393,7 +478,8 @@ void LstmForwardInference(DType* ws,
                                              w_ptr,
                                              b_ptr,
                                              hy_ptr,
-                                             cy_ptr);
+                                             cy_ptr,
+                                             packs ? packs + i * D + 1 : nullptr);
     }
     // Don't need to move pointer in the last layer.
     if (i != L - 1) {
@@ -718,7 +804,6 @@ void LstmBackward(DType* ws,
 
 template <typename DType>
 void GruForwardInferenceSingleLayer(DType* ws,
-                                    DType* tmp_buf,
                                     bool state_outputs,
                                     const int D,
                                     const index_t T,
@@ -732,16 +817,14 @@ void GruForwardInferenceSingleLayer(DType* ws,
                                     DType* bx_ptr,
                                     DType* bh_ptr,
                                     DType* y_ptr,
-                                    DType* hy_ptr) {
+                                    DType* hy_ptr,
+                                    RNNWeightPack* packs) {
   DType* ht          = y_ptr;
   DType* ht_1        = y_ptr;
   DType* back_ht_1   = y_ptr + (T - 1) * N * H * D + H;
   DType* back_ht     = back_ht_1;
   DType* gemmC1      = ws;                          // [D, T, N, 3 * H]
   DType* gemmC2      = gemmC1 + D * T * N * 3 * H;  // N * 3 * H
-  DType* rt          = gemmC2 + N * 3 * H;
-  DType* zt          = rt + N * H;
-  DType* nt          = zt + N * H;
   DType* back_wx_ptr = wx_ptr + I * 3 * H + H * 3 * H;
   DType* back_wh_ptr = wh_ptr + I * 3 * H + H * 3 * H;
   DType* back_bx_ptr = (bx_ptr != nullptr) ? bx_ptr + 3 * H * 2 : nullptr;
@@ -751,11 +834,9 @@ void GruForwardInferenceSingleLayer(DType* ws,
 
   const Tensor<cpu, 2, DType> wx(wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> wh(wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> bx(bx_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> bh(bh_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> back_wx(back_wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> back_wh(back_wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> back_bx(back_bx_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> back_bh(back_bh_ptr, Shape2(3, H));
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (D == 1) {
@@ -776,39 +857,37 @@ void GruForwardInferenceSingleLayer(DType* ws,
   Tensor<cpu, 2, DType> dgemmC2(gemmC2, Shape2(N, 3 * H));
   Tensor<cpu, 2, DType> dback_gemmC1(back_gemmC1, Shape2(T * N, 3 * H));
 
-  // x * wx.T : [T * N, I] * [I, 3 * H]
+  // bx + bh + x * wx.T : [T * N, I] * [I, 3 * H], but for bh of the new gate, which the reset
+  // gate scales
   DType alpha = 1.0;
   DType beta  = 0.0;
-  linalg_gemm(x, wx, dgemmC1, alpha, beta, false, true);
+  DType beta1 = 1.0;
+  RNNFillBias(gemmC1, T * N, 3 * H, 2 * H, bx_ptr, bh_ptr);
+  linalg_gemm(x, wx, dgemmC1, alpha, beta1, false, true);
   if (D == 2) {
-    linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta, false, true);
+    RNNFillBias(back_gemmC1, T * N, 3 * H, 2 * H, back_bx_ptr, back_bh_ptr);
+    linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta1, false, true);
   }
 
+  RNNWeightPack local_packs[2];
+  if (packs == nullptr)
+    packs = local_packs;
   for (index_t t = 0; t < T; t++) {
     //  perform the first direction, X * wx and H * wh for each step
     //  ht-1 * wh, ht-1:[N, H] wh:[3 * H, H]
-    Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, D * H));
-    if (D == 1) {
-      linalg_gemm(dht_1, wh, dgemmC2, alpha, beta, false, true);
-    } else {
-      Tensor<cpu, 3, DType> dht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dht_1_tmp = reshape(dht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dht_1_tmp[0], wh, dgemmC2, alpha, beta, true, true);
-    }
+    const Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, H), D * H, nullptr);
+    RNNRecurrentGemm(dht_1, wh, dgemmC2, beta, packs);
     gemmC1_t = gemmC1 + t * N * 3 * H;
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t i = 0; i < N; ++i) {
       for (int j = 0; j < H; ++j) {
-        index_t rtb   = i * 3 * H;
-        index_t ztb   = i * 3 * H + H;
-        index_t ntb   = i * 3 * H + 2 * H;
-        rt[i * H + j] = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + bx[0][j] + bh[0][j]);
-        zt[i * H + j] = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + bx[1][j] + bh[1][j]);
-        nt[i * H + j] =
-            tanh(gemmC1_t[ntb + j] + bx[2][j] + rt[i * H + j] * (gemmC2[ntb + j] + bh[2][j]));
-        ht[i * D * H + j] =
-            (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * ht_1[i * D * H + j];
+        index_t rtb       = i * 3 * H;
+        index_t ztb       = i * 3 * H + H;
+        index_t ntb       = i * 3 * H + 2 * H;
+        DType rt          = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j]);
+        DType zt          = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j]);
+        DType nt          = tanh(gemmC1_t[ntb + j] + rt * (gemmC2[ntb + j] + bh[2][j]));
+        ht[i * D * H + j] = (1 - zt) * nt + zt * ht_1[i * D * H + j];
       }
     }
     ht_1 = ht;
@@ -816,26 +895,19 @@ void GruForwardInferenceSingleLayer(DType* ws,
     //  perform the second direction
     if (D == 2) {
       gemmC1_t = back_gemmC1 + (T - 1 - t) * N * 3 * H;
-      Tensor<cpu, 2, DType> dback_ht_1(back_ht_1 - H, Shape2(N, D * H));
-      Tensor<cpu, 3, DType> dback_ht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dback_ht_1_tmp = reshape(dback_ht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dback_ht_1_tmp[1], back_wh, dgemmC2, alpha, beta, true, true);
+      const Tensor<cpu, 2, DType> dback_ht_1(back_ht_1, Shape2(N, H), D * H, nullptr);
+      RNNRecurrentGemm(dback_ht_1, back_wh, dgemmC2, beta, packs + 1);
 
 #pragma omp parallel for num_threads(omp_threads)
       for (index_t i = 0; i < N; ++i) {
         for (int j = 0; j < H; ++j) {
-          index_t rtb = i * 3 * H;
-          index_t ztb = i * 3 * H + H;
-          index_t ntb = i * 3 * H + 2 * H;
-          rt[i * H + j] =
-              sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + back_bx[0][j] + back_bh[0][j]);
-          zt[i * H + j] =
-              sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + back_bx[1][j] + back_bh[1][j]);
-          nt[i * H + j] = tanh(gemmC1_t[ntb + j] + back_bx[2][j] +
-                               rt[i * H + j] * (gemmC2[ntb + j] + back_bh[2][j]));
-          back_ht[i * D * H + j] =
-              (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * back_ht_1[i * D * H + j];
+          index_t rtb            = i * 3 * H;
+          index_t ztb            = i * 3 * H + H;
+          index_t ntb            = i * 3 * H + 2 * H;
+          DType rt               = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j]);
+          DType zt               = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j]);
+          DType nt               = tanh(gemmC1_t[ntb + j] + rt * (gemmC2[ntb + j] + back_bh[2][j]));
+          back_ht[i * D * H + j] = (1 - zt) * nt + zt * back_ht_1[i * D * H + j];
         }
       }
       back_ht_1 = back_ht;
@@ -877,17 +949,17 @@ void GruForwardInference(DType* ws,
                          DType* hx_ptr,
                          DType* w_ptr,
                          DType* y_ptr,
-                         DType* hy_ptr) {
+                         DType* hy_ptr,
+                         RNNWeightPack* packs) {
   DType* wx = w_ptr;
   DType* wh = wx + I * H * 3;
   DType* bx =
       wh + H * H * 3 + (D - 1) * (H * H * 3 + I * H * 3) + (L - 1) * ((D + 1) * H) * H * 3 * D;
   DType* bh = bx + H * 3;
 
-  DType* y_tmp   = ws;
-  DType* y_l     = x_ptr;
-  DType* tmp_buf = y_tmp + D * T * N * H;
-  DType* ws2     = y_tmp + D * T * N * H + D * H * N;
+  DType* y_tmp = ws;
+  DType* y_l   = x_ptr;
+  DType* ws2   = y_tmp + D * T * N * H + D * H * N;
 
   DType* wx_l = wx;
   DType* wh_l = wh;
@@ -903,8 +975,22 @@ void GruForwardInference(DType* ws,
       y_l = y_tmp;
     }
     Tensor<cpu, 2, DType> hx_l = hx[D * l];
-    GruForwardInferenceSingleLayer<DType>(
-        ws2, tmp_buf, state_outputs, D, T, N, I, H, x_l, hx_l, wx_l, wh_l, bx_l, bh_l, y_l, hy_l);
+    GruForwardInferenceSingleLayer<DType>(ws2,
+                                          state_outputs,
+                                          D,
+                                          T,
+                                          N,
+                                          I,
+                                          H,
+                                          x_l,
+                                          hx_l,
+                                          wx_l,
+                                          wh_l,
+                                          bx_l,
+                                          bh_l,
+                                          y_l,
+                                          hy_l,
+                                          packs ? packs + l * D : nullptr);
     hy_l = hy_l + D * N * H;
     bx_l = bx_l + 3 * H * D * 2;
     bh_l = bh_l + 3 * H * D * 2;
@@ -918,7 +1004,6 @@ void GruForwardInference(DType* ws,
 
 template <typename DType>
 void GruForwardTrainingSingleLayer(DType* ws,
-                                   DType* tmp_buf,
                                    bool state_outputs,
                                    const int D,
                                    const index_t T,
@@ -960,11 +1045,9 @@ void GruForwardTrainingSingleLayer(DType* ws,
 
   const Tensor<cpu, 2, DType> wx(wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> wh(wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> bx(bx_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> bh(bh_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> back_wx(back_wx_ptr, Shape2(H * 3, I));
   const Tensor<cpu, 2, DType> back_wh(back_wh_ptr, Shape2(H * 3, H));
-  const Tensor<cpu, 2, DType> back_bx(back_bx_ptr, Shape2(3, H));
   const Tensor<cpu, 2, DType> back_bh(back_bh_ptr, Shape2(3, H));
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (D == 1) {
@@ -986,26 +1069,24 @@ void GruForwardTrainingSingleLayer(DType* ws,
   Tensor<cpu, 2, DType> dgemmC2(gemmC2, Shape2(N, 3 * H));
   Tensor<cpu, 2, DType> dback_gemmC1(back_gemmC1, Shape2(T * N, 3 * H));
 
-  // x * wx.T : [T * N, I] * [I, 3 * H]
+  // bx + bh + x * wx.T : [T * N, I] * [I, 3 * H], but for bh of the new gate, which the reset
+  // gate scales
   DType alpha = 1.0;
   DType beta  = 0.0;
-  linalg_gemm(x, wx, dgemmC1, alpha, beta, false, true);
+  DType beta1 = 1.0;
+  RNNFillBias(gemmC1, T * N, 3 * H, 2 * H, bx_ptr, bh_ptr);
+  linalg_gemm(x, wx, dgemmC1, alpha, beta1, false, true);
   if (D == 2) {
-    linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta, false, true);
+    RNNFillBias(back_gemmC1, T * N, 3 * H, 2 * H, back_bx_ptr, back_bh_ptr);
+    linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta1, false, true);
   }
 
+  RNNWeightPack packs[2];
   for (index_t t = 0; t < T; t++) {
     //  perform the first direction, X * wx and H * wh for each step
     //  ht-1 * wh, ht-1:[N, H] wh:[3 * H, H]
-    Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, D * H));
-    if (D == 1) {
-      linalg_gemm(dht_1, wh, dgemmC2, alpha, beta, false, true);
-    } else {
-      Tensor<cpu, 3, DType> dht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dht_1_tmp = reshape(dht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dht_1_tmp[0], wh, dgemmC2, alpha, beta, true, true);
-    }
+    const Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, H), D * H, nullptr);
+    RNNRecurrentGemm(dht_1, wh, dgemmC2, beta, packs);
     rt          = gateR + t * N * H;
     zt          = gateZ + t * N * H;
     nt          = gateN + t * N * H;
@@ -1018,10 +1099,9 @@ void GruForwardTrainingSingleLayer(DType* ws,
         index_t ztb     = i * 3 * H + H;
         index_t ntb     = i * 3 * H + 2 * H;
         Mnht[i * H + j] = gemmC2[ntb + j] + bh[2][j];
-        rt[i * H + j]   = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + bx[0][j] + bh[0][j]);
-        zt[i * H + j]   = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + bx[1][j] + bh[1][j]);
-        nt[i * H + j] =
-            tanh(gemmC1_t[ntb + j] + bx[2][j] + rt[i * H + j] * (gemmC2[ntb + j] + bh[2][j]));
+        rt[i * H + j]   = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j]);
+        zt[i * H + j]   = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j]);
+        nt[i * H + j]   = tanh(gemmC1_t[ntb + j] + rt[i * H + j] * Mnht[i * H + j]);
         ht[i * D * H + j] =
             (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * ht_1[i * D * H + j];
       }
@@ -1034,11 +1114,8 @@ void GruForwardTrainingSingleLayer(DType* ws,
       zt       = back_gateZ + (T - 1 - t) * N * H;
       nt       = back_gateN + (T - 1 - t) * N * H;
       gemmC1_t = back_gemmC1 + (T - 1 - t) * N * 3 * H;
-      Tensor<cpu, 2, DType> dback_ht_1(back_ht_1 - H, Shape2(N, D * H));
-      Tensor<cpu, 3, DType> dback_ht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dback_ht_1_tmp = reshape(dback_ht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dback_ht_1_tmp[1], back_wh, dgemmC2, alpha, beta, true, true);
+      const Tensor<cpu, 2, DType> dback_ht_1(back_ht_1, Shape2(N, H), D * H, nullptr);
+      RNNRecurrentGemm(dback_ht_1, back_wh, dgemmC2, beta, packs + 1);
 
       DType* back_Mnht = back_Mnh + (T - 1 - t) * N * H;
 #pragma omp parallel for num_threads(omp_threads)
@@ -1048,12 +1125,9 @@ void GruForwardTrainingSingleLayer(DType* ws,
           index_t ztb          = i * 3 * H + H;
           index_t ntb          = i * 3 * H + 2 * H;
           back_Mnht[i * H + j] = gemmC2[ntb + j] + back_bh[2][j];
-          rt[i * H + j] =
-              sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j] + back_bx[0][j] + back_bh[0][j]);
-          zt[i * H + j] =
-              sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j] + back_bx[1][j] + back_bh[1][j]);
-          nt[i * H + j] = tanh(gemmC1_t[ntb + j] + back_bx[2][j] +
-                               rt[i * H + j] * (gemmC2[ntb + j] + back_bh[2][j]));
+          rt[i * H + j]        = sigmoid(gemmC1_t[rtb + j] + gemmC2[rtb + j]);
+          zt[i * H + j]        = sigmoid(gemmC1_t[ztb + j] + gemmC2[ztb + j]);
+          nt[i * H + j]        = tanh(gemmC1_t[ntb + j] + rt[i * H + j] * back_Mnht[i * H + j]);
           back_ht[i * D * H + j] =
               (1 - zt[i * H + j]) * nt[i * H + j] + zt[i * H + j] * back_ht_1[i * D * H + j];
         }
@@ -1142,7 +1216,6 @@ void GruForwardTraining(DType* ws,
     Tensor<cpu, 2, DType> x_l(y_tmp, Shape2(T * N, I));
     Tensor<cpu, 2, DType> hx_l = hx[D * l];
     GruForwardTrainingSingleLayer<DType>(ws2,
-                                         tmp_buf,
                                          state_outputs,
                                          D,
                                          T,
@@ -1665,7 +1738,6 @@ void GruBackward(DType* ws,
 
 template <typename DType>
 void VanillaRNNForwardInferenceSingleLayer(DType* ws,
-                                           DType* tmp_buf,
                                            bool state_outputs,
                                            const int D,
                                            const index_t T,
@@ -1680,13 +1752,13 @@ void VanillaRNNForwardInferenceSingleLayer(DType* ws,
                                            DType* bh_ptr,
                                            DType* y_ptr,
                                            DType* hy_ptr,
-                                           int mode) {
+                                           int mode,
+                                           RNNWeightPack* packs) {
   DType* ht          = y_ptr;
   DType* ht_1        = y_ptr;
   DType* back_ht_1   = y_ptr + (T - 1) * N * H * D + H;
   DType* back_ht     = back_ht_1;
-  DType* gemmC1      = ws;                      // [D, T, N, H]
-  DType* gemmC2      = gemmC1 + D * T * N * H;  // N * H
+  DType* gemmC1      = ws;  // [D, T, N, H]
   DType* back_wx_ptr = wx_ptr + I * H + H * H;
   DType* back_wh_ptr = wh_ptr + I * H + H * H;
   DType* back_bx_ptr = (bx_ptr != nullptr) ? bx_ptr + H * 2 : nullptr;
@@ -1696,12 +1768,8 @@ void VanillaRNNForwardInferenceSingleLayer(DType* ws,
 
   const Tensor<cpu, 2, DType> wx(wx_ptr, Shape2(H, I));
   const Tensor<cpu, 2, DType> wh(wh_ptr, Shape2(H, H));
-  const Tensor<cpu, 2, DType> bx(bx_ptr, Shape2(1, H));
-  const Tensor<cpu, 2, DType> bh(bh_ptr, Shape2(1, H));
   const Tensor<cpu, 2, DType> back_wx(back_wx_ptr, Shape2(H, I));
   const Tensor<cpu, 2, DType> back_wh(back_wh_ptr, Shape2(H, H));
-  const Tensor<cpu, 2, DType> back_bx(back_bx_ptr, Shape2(1, H));
-  const Tensor<cpu, 2, DType> back_bh(back_bh_ptr, Shape2(1, H));
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (D == 1) {
 #pragma omp parallel for num_threads(omp_threads)
@@ -1718,38 +1786,35 @@ void VanillaRNNForwardInferenceSingleLayer(DType* ws,
       }
   }
   Tensor<cpu, 2, DType> dgemmC1(ws, Shape2(T * N, H));
-  Tensor<cpu, 2, DType> dgemmC2(gemmC2, Shape2(N, H));
   Tensor<cpu, 2, DType> dback_gemmC1(back_gemmC1, Shape2(T * N, H));
 
-  // x * wx.T : [T * N, I] * [I, H]
+  // bx + bh + x * wx.T : [T * N, I] * [I, H], to which each step adds ht-1 * wh.T
   DType alpha = 1.0;
-  DType beta  = 0.0;
+  DType beta  = 1.0;
+  RNNFillBias(gemmC1, T * N, H, H, bx_ptr, bh_ptr);
   linalg_gemm(x, wx, dgemmC1, alpha, beta, false, true);
   if (D == 2) {
+    RNNFillBias(back_gemmC1, T * N, H, H, back_bx_ptr, back_bh_ptr);
     linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta, false, true);
   }
 
+  RNNWeightPack local_packs[2];
+  if (packs == nullptr)
+    packs = local_packs;
   for (index_t t = 0; t < T; t++) {
     //  perform the first direction, X * wx and H * wh for each step
     //  ht-1 * wh, ht-1:[N, H] wh:[H, H]
-    Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, D * H));
-    if (D == 1) {
-      linalg_gemm(dht_1, wh, dgemmC2, alpha, beta, false, true);
-    } else {
-      Tensor<cpu, 3, DType> dht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dht_1_tmp = reshape(dht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dht_1_tmp[0], wh, dgemmC2, alpha, beta, true, true);
-    }
     gemmC1_t = gemmC1 + t * N * H;
+    const Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, H), D * H, nullptr);
+    RNNRecurrentGemm(dht_1, wh, Tensor<cpu, 2, DType>(gemmC1_t, Shape2(N, H)), beta, packs);
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t i = 0; i < N; ++i) {
       for (int j = 0; j < H; ++j) {
         index_t tb = i * H;
         if (mode == 1) {
-          ht[i * D * H + j] = tanh(gemmC1_t[tb + j] + bx[0][j] + gemmC2[tb + j] + bh[0][j]);
+          ht[i * D * H + j] = tanh(gemmC1_t[tb + j]);
         } else {
-          ht[i * D * H + j] = relu(gemmC1_t[tb + j] + bx[0][j] + gemmC2[tb + j] + bh[0][j]);
+          ht[i * D * H + j] = relu(gemmC1_t[tb + j]);
         }
       }
     }
@@ -1758,22 +1823,18 @@ void VanillaRNNForwardInferenceSingleLayer(DType* ws,
     //  perform the second direction
     if (D == 2) {
       gemmC1_t = back_gemmC1 + (T - 1 - t) * N * H;
-      Tensor<cpu, 2, DType> dback_ht_1(back_ht_1 - H, Shape2(N, D * H));
-      Tensor<cpu, 3, DType> dback_ht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dback_ht_1_tmp = reshape(dback_ht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dback_ht_1_tmp[1], back_wh, dgemmC2, alpha, beta, true, true);
+      const Tensor<cpu, 2, DType> dback_ht_1(back_ht_1, Shape2(N, H), D * H, nullptr);
+      RNNRecurrentGemm(
+          dback_ht_1, back_wh, Tensor<cpu, 2, DType>(gemmC1_t, Shape2(N, H)), beta, packs + 1);
 
 #pragma omp parallel for num_threads(omp_threads)
       for (index_t i = 0; i < N; ++i) {
         for (int j = 0; j < H; ++j) {
           index_t tb = i * H;
           if (mode == 1) {
-            back_ht[i * D * H + j] =
-                tanh(gemmC1_t[tb + j] + back_bx[0][j] + gemmC2[tb + j] + back_bh[0][j]);
+            back_ht[i * D * H + j] = tanh(gemmC1_t[tb + j]);
           } else {
-            back_ht[i * D * H + j] =
-                relu(gemmC1_t[tb + j] + back_bx[0][j] + gemmC2[tb + j] + back_bh[0][j]);
+            back_ht[i * D * H + j] = relu(gemmC1_t[tb + j]);
           }
         }
       }
@@ -1817,16 +1878,16 @@ void VanillaRNNForwardInference(DType* ws,
                                 DType* w_ptr,
                                 DType* y_ptr,
                                 DType* hy_ptr,
-                                int mode) {
+                                int mode,
+                                RNNWeightPack* packs) {
   DType* wx = w_ptr;
   DType* wh = wx + I * H;
   DType* bx = wh + H * H + (D - 1) * (H * H + I * H) + (L - 1) * ((D + 1) * H) * H * D;
   DType* bh = bx + H;
 
-  DType* y_tmp   = ws;
-  DType* y_l     = x_ptr;
-  DType* tmp_buf = y_tmp + D * T * N * H;
-  DType* ws2     = y_tmp + D * T * N * H + D * H * N;
+  DType* y_tmp = ws;
+  DType* y_l   = x_ptr;
+  DType* ws2   = y_tmp + D * T * N * H + D * H * N;
 
   DType* wx_l = wx;
   DType* wh_l = wh;
@@ -1843,7 +1904,6 @@ void VanillaRNNForwardInference(DType* ws,
     }
     Tensor<cpu, 2, DType> hx_l = hx[D * l];
     VanillaRNNForwardInferenceSingleLayer<DType>(ws2,
-                                                 tmp_buf,
                                                  state_outputs,
                                                  D,
                                                  T,
@@ -1858,7 +1918,8 @@ void VanillaRNNForwardInference(DType* ws,
                                                  bh_l,
                                                  y_l,
                                                  hy_l,
-                                                 mode);
+                                                 mode,
+                                                 packs ? packs + l * D : nullptr);
     hy_l = hy_l + D * N * H;
     bx_l = bx_l + H * D * 2;
     bh_l = bh_l + H * D * 2;
@@ -1872,7 +1933,6 @@ void VanillaRNNForwardInference(DType* ws,
 
 template <typename DType>
 void VanillaRNNForwardTrainingSingleLayer(DType* ws,
-                                          DType* tmp_buf,
                                           bool state_outputs,
                                           const int D,
                                           const index_t T,
@@ -1894,8 +1954,7 @@ void VanillaRNNForwardTrainingSingleLayer(DType* ws,
   DType* back_ht_1 = y_ptr + (T - 1) * N * H * D + H;
   DType* back_ht   = back_ht_1;
 
-  DType* gemmC1      = ws;                      // [D, T, N, H]
-  DType* gemmC2      = gemmC1 + D * T * N * H;  // N * H
+  DType* gemmC1      = ws;  // [D, T, N, H]
   DType* nt          = gateN;
   DType* back_wx_ptr = wx_ptr + I * H + H * H;
   DType* back_wh_ptr = wh_ptr + I * H + H * H;
@@ -1907,12 +1966,8 @@ void VanillaRNNForwardTrainingSingleLayer(DType* ws,
 
   const Tensor<cpu, 2, DType> wx(wx_ptr, Shape2(H, I));
   const Tensor<cpu, 2, DType> wh(wh_ptr, Shape2(H, H));
-  const Tensor<cpu, 2, DType> bx(bx_ptr, Shape2(1, H));
-  const Tensor<cpu, 2, DType> bh(bh_ptr, Shape2(1, H));
   const Tensor<cpu, 2, DType> back_wx(back_wx_ptr, Shape2(H * 1, I));
   const Tensor<cpu, 2, DType> back_wh(back_wh_ptr, Shape2(H * 1, H));
-  const Tensor<cpu, 2, DType> back_bx(back_bx_ptr, Shape2(1, H));
-  const Tensor<cpu, 2, DType> back_bh(back_bh_ptr, Shape2(1, H));
   const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (D == 1) {
 #pragma omp parallel for num_threads(omp_threads)
@@ -1930,40 +1985,34 @@ void VanillaRNNForwardTrainingSingleLayer(DType* ws,
   }
 
   Tensor<cpu, 2, DType> dgemmC1(ws, Shape2(T * N, H));
-  Tensor<cpu, 2, DType> dgemmC2(gemmC2, Shape2(N, H));
   Tensor<cpu, 2, DType> dback_gemmC1(back_gemmC1, Shape2(T * N, H));
 
-  // x * wx.T : [T * N, I] * [I, H]
+  // bx + bh + x * wx.T : [T * N, I] * [I, H], to which each step adds ht-1 * wh.T
   DType alpha = 1.0;
-  DType beta  = 0.0;
+  DType beta  = 1.0;
+  RNNFillBias(gemmC1, T * N, H, H, bx_ptr, bh_ptr);
   linalg_gemm(x, wx, dgemmC1, alpha, beta, false, true);
   if (D == 2) {
+    RNNFillBias(back_gemmC1, T * N, H, H, back_bx_ptr, back_bh_ptr);
     linalg_gemm(x, back_wx, dback_gemmC1, alpha, beta, false, true);
   }
 
+  RNNWeightPack packs[2];
   for (index_t t = 0; t < T; t++) {
     //  perform the first direction, X * wx and H * wh for each step
     //  ht-1 * wh, ht-1:[N, H] wh:[H, H]
-    Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, D * H));
-    if (D == 1) {
-      linalg_gemm(dht_1, wh, dgemmC2, alpha, beta, false, true);
-    } else {
-      Tensor<cpu, 3, DType> dht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dht_1_tmp = reshape(dht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dht_1_tmp[0], wh, dgemmC2, alpha, beta, true, true);
-    }
-    nt       = gateN + t * N * H;
     gemmC1_t = gemmC1 + t * N * H;
+    const Tensor<cpu, 2, DType> dht_1(ht_1, Shape2(N, H), D * H, nullptr);
+    RNNRecurrentGemm(dht_1, wh, Tensor<cpu, 2, DType>(gemmC1_t, Shape2(N, H)), beta, packs);
+    nt = gateN + t * N * H;
 #pragma omp parallel for num_threads(omp_threads)
     for (index_t i = 0; i < N; ++i) {
       for (int j = 0; j < H; ++j) {
         index_t tb = i * H;
         if (mode == 1) {
-          nt[tb + j] = ht[i * D * H + j] =
-              tanh(gemmC1_t[tb + j] + bx[0][j] + gemmC2[tb + j] + bh[0][j]);
+          nt[tb + j] = ht[i * D * H + j] = tanh(gemmC1_t[tb + j]);
         } else {
-          nt[tb + j]        = gemmC1_t[tb + j] + bx[0][j] + gemmC2[tb + j] + bh[0][j];
+          nt[tb + j]        = gemmC1_t[tb + j];
           ht[i * D * H + j] = relu(nt[tb + j]);
         }
       }
@@ -1974,20 +2023,17 @@ void VanillaRNNForwardTrainingSingleLayer(DType* ws,
     if (D == 2) {
       nt       = back_gateN + (T - 1 - t) * N * H;
       gemmC1_t = back_gemmC1 + (T - 1 - t) * N * H;
-      Tensor<cpu, 2, DType> dback_ht_1(back_ht_1 - H, Shape2(N, D * H));
-      Tensor<cpu, 3, DType> dback_ht_1_tmp =
-          Tensor<cpu, 3, DType>(reinterpret_cast<DType*>(tmp_buf), Shape3(D, H, N));
-      dback_ht_1_tmp = reshape(dback_ht_1.T(), Shape3(D, H, N));
-      linalg_gemm(dback_ht_1_tmp[1], back_wh, dgemmC2, alpha, beta, true, true);
+      const Tensor<cpu, 2, DType> dback_ht_1(back_ht_1, Shape2(N, H), D * H, nullptr);
+      RNNRecurrentGemm(
+          dback_ht_1, back_wh, Tensor<cpu, 2, DType>(gemmC1_t, Shape2(N, H)), beta, packs + 1);
 #pragma omp parallel for num_threads(omp_threads)
       for (index_t i = 0; i < N; ++i) {
         for (int j = 0; j < H; ++j) {
           index_t tb = i * H;
           if (mode == 1) {
-            nt[tb + j] = back_ht[i * D * H + j] =
-                tanh(gemmC1_t[tb + j] + back_bx[0][j] + gemmC2[tb + j] + back_bh[0][j]);
+            nt[tb + j] = back_ht[i * D * H + j] = tanh(gemmC1_t[tb + j]);
           } else {
-            nt[tb + j] = gemmC1_t[tb + j] + back_bx[0][j] + gemmC2[tb + j] + back_bh[0][j];
+            nt[tb + j]             = gemmC1_t[tb + j];
             back_ht[i * D * H + j] = relu(nt[tb + j]);
           }
         }
@@ -2074,7 +2120,6 @@ void VanillaRNNForwardTraining(DType* ws,
     Tensor<cpu, 2, DType> x_l(y_tmp, Shape2(T * N, I));
     Tensor<cpu, 2, DType> hx_l = hx[D * l];
     VanillaRNNForwardTrainingSingleLayer<DType>(ws2,
-                                                tmp_buf,
                                                 state_outputs,
                                                 D,
                                                 T,
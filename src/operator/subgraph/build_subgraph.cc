@@ -28,6 +28,7 @@
 #include <queue>
 
 #include "./subgraph_property.h"
+#include "../../imperative/exec_pass.h"
 #include "mxnet/imperative.h"
 #include "mxnet/base.h"
 
@@ -336,6 +337,7 @@ bool LabelSubgraph(const nnvm::Graph& g,
  * \snid node id of the seed simple node
  * \simple_nodes all simple nodes in the top sorted order
  * \subgraph_nodes all the nodes belonging to the same subgraph of seed node
+ * \locked_nodes nodes that cannot be in any subgraph
  * \return Subgraph node candidates sorted in the topological order
  */
 void PreSelectSubgraphNodes(const nnvm::Graph& g,
@@ -343,9 +345,10 @@ void PreSelectSubgraphNodes(const nnvm::Graph& g,
                             const int label,
                             const size_t snid,
                             const std::vector<BiDirectedNodePtr>& simple_nodes,
-                            std::vector<BiDirectedNode*>* subgraph_nodes) {
-  std::unordered_set<const BiDirectedNode*> excluded_nodes;
-  size_t n_excluded_nodes    = 0;
+                            std::vector<BiDirectedNode*>* subgraph_nodes,
+                            const std::unordered_set<const BiDirectedNode*>& locked_nodes) {
+  std::unordered_set<const BiDirectedNode*> excluded_nodes(locked_nodes);
+  size_t n_excluded_nodes    = excluded_nodes.size();
   const size_t max_num_retry = simple_nodes.size() * simple_nodes.size();
   size_t count               = 0;
   bool success               = false;
@@ -407,18 +410,24 @@ void SelectSubgraphNodes(nnvm::Graph* g,
                          std::vector<SubgraphSelectorV2Ptr>* subgraph_selectors,
                          const BiDirectedNode* node,
                          const size_t snid,
-                         size_t* subgraph_id) {
+                         size_t* subgraph_id,
+                         const std::unordered_set<const BiDirectedNode*>& locked_nodes) {
   const auto& indexed_graph = g->indexed_graph();
 
   auto node_cmp = [&](const BiDirectedNode* node1, const BiDirectedNode* node2) {
     return indexed_graph.node_id(node1->node) < indexed_graph.node_id(node2->node);
   };
-  if ((simple_nodes[snid]->label == -1) &&
+  if ((simple_nodes[snid]->label == -1) && !locked_nodes.count(node) &&
       subgraph_selector->Select(*node, PrepareNodeAttr(*g, *node))) {
     // pre-select nodes that can be grouped in a subgraph
     std::vector<BiDirectedNode*> preselected_nodes;
-    PreSelectSubgraphNodes(
-        *g, subgraph_selector, *subgraph_id, snid, simple_nodes, &preselected_nodes);
+    PreSelectSubgraphNodes(*g,
+                           subgraph_selector,
+                           *subgraph_id,
+                           snid,
+                           simple_nodes,
+                           &preselected_nodes,
+                           locked_nodes);
 
     // filter out unqualified pre-selected nodes
     std::vector<BiDirectedNode*> filtered_nodes = subgraph_selector->Filter(preselected_nodes);
@@ -453,7 +462,8 @@ void SelectSubgraphNodes(nnvm::Graph* g,
 
 /*!
  * \brief Finds subgraphs with all nodes that meet certain criteria.
- * All nodes in a subgraph are marked with the same label.
+ * All nodes in a subgraph are marked with the same label. The nodes named in the
+ * subgraph_locked_nodes graph attribute, if any, are left out of all subgraphs.
  */
 void FindSubgraphs(nnvm::Graph* g,
                    const SubgraphProperty& subg_prop,
@@ -463,6 +473,14 @@ void FindSubgraphs(nnvm::Graph* g,
   const auto& indexed_graph = g->indexed_graph();
   CHECK_EQ(indexed_graph.num_nodes(), simple_nodes.size());
 
+  std::unordered_set<const BiDirectedNode*> locked_nodes;
+  if (g->HasAttr("subgraph_locked_nodes")) {
+    const auto& names = g->GetAttr<std::unordered_set<std::string>>("subgraph_locked_nodes");
+    for (const auto& snode : simple_nodes) {
+      if (names.count(snode->node->attrs.name))
+        locked_nodes.insert(snode.get());
+    }
+  }
   size_t subgraph_id = 0;
   for (size_t i = 0; i < simple_nodes.size(); ++i) {
     const auto snode                        = simple_nodes[i];
@@ -474,7 +492,8 @@ void FindSubgraphs(nnvm::Graph* g,
                         subgraph_selectors,
                         snode.get(),
                         i,
-                        &subgraph_id);
+                        &subgraph_id,
+                        locked_nodes);
   }
 }
 
@@ -850,6 +869,7 @@ nnvm::Graph BuildSubgraph(nnvm::Graph&& g) {
     return std::move(g);
   }
   using namespace sg;
+  exec::PassTimer timer("BuildSubgraph");
 
   const SubgraphPropertyPtr& subg_prop = g.GetAttr<SubgraphPropertyPtr>("subgraph_property");
   if (verbose > 1) {
@@ -894,5 +914,38 @@ NNVM_REGISTER_PASS(BuildSubgraph)
     .set_body(BuildSubgraph)
     .set_change_graph(true);
 
+/*!
+ * \brief Finds the subgraphs of the subgraph property without creating their nodes, and
+ *  provides the names of the operator nodes of each in the subgraph_candidates graph attribute.
+ */
+nnvm::Graph FindSubgraphCandidates(nnvm::Graph&& g) {
+  using namespace sg;
+  CHECK(g.HasAttr("subgraph_property")) << "FindSubgraphCandidates needs a subgraph_property";
+  const SubgraphPropertyPtr& subg_prop = g.GetAttr<SubgraphPropertyPtr>("subgraph_property");
+  std::vector<BiDirectedNodePtr> simple_nodes;
+  CreateSimpleGraph(g, &simple_nodes);
+  std::vector<std::vector<BiDirectedNode*>> subgraph_nodes;
+  std::vector<SubgraphSelectorV2Ptr> subgraph_selectors;
+  FindSubgraphs(&g, *subg_prop, simple_nodes, &subgraph_nodes, &subgraph_selectors);
+  std::vector<std::vector<std::string>> candidates;
+  for (const auto& nodes : subgraph_nodes) {
+    std::vector<std::string> names;
+    for (const BiDirectedNode* n : nodes) {
+      if (!n->node->is_variable())
+        names.push_back(n->node->attrs.name);
+    }
+    if (!names.empty())
+      candidates.push_back(std::move(names));
+  }
+  g.attrs["subgraph_candidates"] = std::make_shared<nnvm::any>(std::move(candidates));
+  return std::move(g);
+}
+
+NNVM_REGISTER_PASS(FindSubgraphCandidates)
+    .describe("Find the subgraphs of a SubgraphProperty without partitioning the graph")
+    .set_body(FindSubgraphCandidates)
+    .set_change_graph(false)
+    .provide_graph_attr("subgraph_candidates");
+
 }  // namespace op
 }  // namespace mxnet
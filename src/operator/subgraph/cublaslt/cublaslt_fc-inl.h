@@ -0,0 +1,222 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cublaslt_fc-inl.h
+ * \brief FullyConnected followed by a ReLU or a GELU, computed on GPU with the epilogues of the
+ *  cuBLASLt GEMMs
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_INL_H_
+
+#include <mxnet/operator.h>
+#include <vector>
+
+#include "../../mshadow_op.h"
+#include "../../mxnet_op.h"
+#include "../../operator_common.h"
+#include "../../nn/fully_connected-inl.h"
+#include "../../tensor/broadcast_reduce_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace sgfc {
+enum SgFCActType { kReLU, kGELU };
+enum SgFCOutputs { kOut, kPreAct };
+// the last input of the backward pass is the output for ReLU and the pre-activation for GELU
+enum SgFCInputsBwd { kBwdOutGrad, kBwdData, kBwdWeight, kBwdAct };
+}  // namespace sgfc
+
+struct SgCublasLtFCParam : public dmlc::Parameter<SgCublasLtFCParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  int act_type;
+
+  DMLC_DECLARE_PARAMETER(SgCublasLtFCParam) {
+    DMLC_DECLARE_FIELD(num_hidden)
+        .set_lower_bound(1)
+        .describe("Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+    DMLC_DECLARE_FIELD(act_type)
+        .add_enum("relu", sgfc::kReLU)
+        .add_enum("gelu", sgfc::kGELU)
+        .describe("Activation function applied to the output of the fully connected layer.");
+  }
+
+  FullyConnectedParam fc_param() const {
+    FullyConnectedParam param;
+    param.num_hidden = num_hidden;
+    param.no_bias    = no_bias;
+    param.flatten    = flatten;
+    return param;
+  }
+
+  /*! \brief GELU keeps its input, the pre-activation, as a hidden output for the backward pass */
+  int num_outputs() const {
+    return act_type == sgfc::kGELU ? 2 : 1;
+  }
+};
+
+/*! \brief the 2D views of data and of an output of the layer */
+template <typename xpu, typename DType>
+mshadow::Tensor<xpu, 2, DType> SgFCFlatten(const FullyConnectedParam& param,
+                                           const TBlob& blob,
+                                           const OpContext& ctx) {
+  return param.flatten ? FlattenAs2DTail<xpu, DType>(blob, ctx) :
+                         FlattenAs2DHead<xpu, DType>(blob, ctx);
+}
+
+/*! \brief bytes of temporary space of SgCublasLtFCBackward */
+template <typename xpu, typename DType>
+size_t SgFCBackwardWorkspaceSize(mshadow::Stream<xpu>* s,
+                                 const SgCublasLtFCParam& param,
+                                 const TBlob& out_grad) {
+  const index_t hidden = param.num_hidden;
+  const index_t rows   = out_grad.Size() / hidden;
+  size_t bytes         = out_grad.Size() * sizeof(DType);
+  if (!param.no_bias) {
+    bytes += broadcast::ReduceWorkspaceSize(
+        s, mxnet::TShape(Shape2(1, hidden)), kWriteTo, mxnet::TShape(Shape2(rows, hidden)));
+  }
+  return bytes;
+}
+
+/*! \brief out = act(data * weight^T + bias), with the FullyConnected GEMM */
+template <typename xpu, typename DType>
+void SgCublasLtFCForward(const OpContext& ctx,
+                         const SgCublasLtFCParam& param,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  if (req[sgfc::kOut] == kNullOp)
+    return;
+  CHECK_EQ(req[sgfc::kOut], kWriteTo);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& out        = outputs[sgfc::kOut];
+  if (param.act_type == sgfc::kReLU) {
+    FCForward<xpu, DType>(ctx, param.fc_param(), inputs, req, {out});
+    Kernel<op_with_req<mshadow_op::relu, kWriteTo>, xpu>::Launch(
+        s, out.Size(), out.dptr<DType>(), out.dptr<DType>());
+  } else {
+    const TBlob& pre_act = outputs[sgfc::kPreAct];
+    FCForward<xpu, DType>(ctx, param.fc_param(), inputs, {kWriteTo}, {pre_act});
+    Kernel<op_with_req<mshadow_op::gelu, kWriteTo>, xpu>::Launch(
+        s, out.Size(), out.dptr<DType>(), pre_act.dptr<DType>());
+  }
+}
+
+/*! \brief grad = out_grad * act'(pre-activation), from the last input of the backward pass */
+template <typename xpu, typename DType>
+void SgFCActivationGrad(mshadow::Stream<xpu>* s,
+                        const SgCublasLtFCParam& param,
+                        const std::vector<TBlob>& inputs,
+                        DType* grad) {
+  using namespace mxnet_op;
+  const TBlob& out_grad = inputs[sgfc::kBwdOutGrad];
+  const TBlob& act      = inputs[sgfc::kBwdAct];
+  if (param.act_type == sgfc::kReLU) {
+    Kernel<op_with_req<backward_grad_tuned<mshadow_op::relu_grad>, kWriteTo>, xpu>::Launch(
+        s, out_grad.Size(), grad, out_grad.dptr<DType>(), act.dptr<DType>());
+  } else {
+    Kernel<op_with_req<backward_grad_tuned<mshadow_op::gelu_grad>, kWriteTo>, xpu>::Launch(
+        s, out_grad.Size(), grad, out_grad.dptr<DType>(), act.dptr<DType>(), act.dptr<DType>());
+  }
+}
+
+/*! \brief the gradients of data, weight and bias, with the GEMMs of FullyConnected */
+template <typename xpu, typename DType>
+void SgCublasLtFCBackward(const OpContext& ctx,
+                          const SgCublasLtFCParam& param,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& out_grad   = inputs[sgfc::kBwdOutGrad];
+  const index_t hidden    = param.num_hidden;
+  const index_t rows      = out_grad.Size() / hidden;
+  const size_t grad_bytes = out_grad.Size() * sizeof(DType);
+  const size_t bytes      = SgFCBackwardWorkspaceSize<xpu, DType>(s, param, out_grad);
+  mshadow::Tensor<xpu, 1, char> space =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(mshadow::Shape1(bytes), s);
+  DType* grad_ptr = reinterpret_cast<DType*>(space.dptr_);
+  SgFCActivationGrad<xpu, DType>(s, param, inputs, grad_ptr);
+
+  const FullyConnectedParam fc_param = param.fc_param();
+  mshadow::Tensor<xpu, 2, DType> grad(grad_ptr, mshadow::Shape2(rows, hidden), s);
+  mshadow::Tensor<xpu, 2, DType> x =
+      SgFCFlatten<xpu, DType>(fc_param, inputs[sgfc::kBwdData], ctx);
+  mshadow::Tensor<xpu, 2, DType> wmat = inputs[sgfc::kBwdWeight].get<xpu, 2, DType>(s);
+  CHECK_NE(req[fullc::kWeight], kWriteInplace) << "cannot write weight inplace";
+  if (req[fullc::kWeight] != kNullOp) {
+    mshadow::Tensor<xpu, 2, DType> w_grad = outputs[fullc::kWeight].get<xpu, 2, DType>(s);
+    linalg_gemm(grad, x, w_grad, true, false, s, req[fullc::kWeight]);
+  }
+  if (!param.no_bias && req[fullc::kBias] != kNullOp) {
+    // the bias gradient reduces with the rest of the temporary space, which AddBiasGrad would
+    // request again and overwrite the gradient with
+    const TBlob grad_blob(grad);
+    const TBlob gbias = outputs[fullc::kBias].reshape(mxnet::TShape(Shape2(1, hidden)));
+    const mshadow::Tensor<xpu, 1, char> workspace(
+        space.dptr_ + grad_bytes, mshadow::Shape1(bytes - grad_bytes), s);
+#if !defined(__CUDACC__)
+    ReduceAxesComputeImpl<xpu, mshadow::red::sum, false, false, mshadow_op::identity>(
+        ctx, {grad_blob}, {req[fullc::kBias]}, {gbias}, gbias.shape_, &workspace);
+#else
+    ReduceAxesRTCComputeImpl(ctx,
+                             {grad_blob},
+                             {req[fullc::kBias]},
+                             {gbias},
+                             gbias.shape_,
+                             "red::sum{}",
+                             &workspace,
+                             false,
+                             "identity");
+#endif
+  }
+  if (req[fullc::kData] != kNullOp) {
+    mshadow::Tensor<xpu, 2, DType> x_grad =
+        SgFCFlatten<xpu, DType>(fc_param, outputs[fullc::kData], ctx);
+    linalg_gemm(grad, wmat, x_grad, false, false, s, req[fullc::kData]);
+  }
+}
+
+template <typename xpu>
+void SgCublasLtFCCompute(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs);
+
+template <typename xpu>
+void SgCublasLtFCGradCompute(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_INL_H_
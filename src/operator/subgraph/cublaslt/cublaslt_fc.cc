@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cublaslt_fc.cc
+ * \brief FullyConnected followed by a ReLU or a GELU, created by the CUBLASLT subgraph backend
+ */
+
+#include "./cublaslt_fc-inl.h"
+
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(SgCublasLtFCParam);
+
+static nnvm::NodeAttrs SgFCAttrs(const nnvm::NodeAttrs& attrs) {
+  nnvm::NodeAttrs fc_attrs;
+  fc_attrs.op     = Op::Get("FullyConnected");
+  fc_attrs.parsed = nnvm::get<SgCublasLtFCParam>(attrs.parsed).fc_param();
+  return fc_attrs;
+}
+
+static bool SgCublasLtFCShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_shape,
+                              mxnet::ShapeVector* out_shape) {
+  static const auto& fc_shape = Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  mxnet::ShapeVector fc_out(1, (*out_shape)[sgfc::kOut]);
+  if (out_shape->size() > sgfc::kPreAct && !shape_assign(&fc_out[0], (*out_shape)[sgfc::kPreAct]))
+    return false;
+  const bool done = fc_shape[Op::Get("FullyConnected")](SgFCAttrs(attrs), in_shape, &fc_out);
+  for (size_t i = 0; i < out_shape->size(); ++i)
+    SHAPE_ASSIGN_CHECK(*out_shape, i, fc_out[0]);
+  return done;
+}
+
+static bool SgCublasLtFCType(const nnvm::NodeAttrs& attrs,
+                             std::vector<int>* in_type,
+                             std::vector<int>* out_type) {
+  CHECK_GE(in_type->size(), 1U);
+  return ElemwiseAttr<int, type_is_none, type_assign, true, type_string>(
+      attrs, in_type, out_type, -1);
+}
+
+static std::vector<nnvm::NodeEntry> SgCublasLtFCGrad(const nnvm::ObjectPtr& n,
+                                                     const std::vector<nnvm::NodeEntry>& ograds) {
+  const auto& param = nnvm::get<SgCublasLtFCParam>(n->attrs.parsed);
+  std::vector<nnvm::NodeEntry> heads{ograds[sgfc::kOut]};
+  heads.push_back(n->inputs[fullc::kData]);
+  heads.push_back(n->inputs[fullc::kWeight]);
+  heads.emplace_back(n, param.act_type == sgfc::kReLU ? sgfc::kOut : sgfc::kPreAct, 0);
+  return MakeGradNode("_backward_sg_cublaslt_fully_connected", n, heads, n->attrs.dict);
+}
+
+template <>
+void SgCublasLtFCCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<SgCublasLtFCParam>(attrs.parsed);
+  MSHADOW_SGL_DBL_TYPE_SWITCH(inputs[fullc::kData].type_flag_, DType, {
+    SgCublasLtFCForward<cpu, DType>(ctx, param, inputs, req, outputs);
+  });
+}
+
+template <>
+void SgCublasLtFCGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<SgCublasLtFCParam>(attrs.parsed);
+  MSHADOW_SGL_DBL_TYPE_SWITCH(inputs[sgfc::kBwdOutGrad].type_flag_, DType, {
+    SgCublasLtFCBackward<cpu, DType>(ctx, param, inputs, req, outputs);
+  });
+}
+
+NNVM_REGISTER_OP(_sg_cublaslt_fully_connected)
+    .describe(R"code(FullyConnected followed by a ReLU or a GELU.
+
+The CUBLASLT subgraph backend creates this operator from a ``FullyConnected`` whose output only
+feeds an ``Activation`` or ``relu``, or a ``LeakyReLU`` with ``act_type='gelu'``. On GPU the bias
+and the ReLU are applied by the epilogue of the cuBLASLt GEMM, the bias as well for a GELU, and
+the bias gradient is reduced by the epilogue of the weight gradient GEMM.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SgCublasLtFCParam>(attrs.parsed).no_bias ? 2 : 3;
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SgCublasLtFCParam>(attrs.parsed).num_outputs();
+    })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<SgCublasLtFCParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          if (nnvm::get<SgCublasLtFCParam>(attrs.parsed).no_bias)
+            return std::vector<std::string>{"data", "weight"};
+          return std::vector<std::string>{"data", "weight", "bias"};
+        })
+    .set_attr<nnvm::FListOutputNames>(
+        "FListOutputNames",
+        [](const NodeAttrs& attrs) {
+          if (nnvm::get<SgCublasLtFCParam>(attrs.parsed).num_outputs() == 1)
+            return std::vector<std::string>{"output"};
+          return std::vector<std::string>{"output", "pre_activation"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", SgCublasLtFCShape)
+    .set_attr<nnvm::FInferType>("FInferType", SgCublasLtFCType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", SgCublasLtFCCompute<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", SgCublasLtFCGrad)
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("weight", "NDArray-or-Symbol", "Weight matrix.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+    .add_arguments(SgCublasLtFCParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_sg_cublaslt_fully_connected)
+    .set_num_inputs(4)
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SgCublasLtFCParam>(attrs.parsed).no_bias ? 2 : 3;
+    })
+    .set_attr_parser(ParamParser<SgCublasLtFCParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", SgCublasLtFCGradCompute<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,305 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cublaslt_fc.cu
+ * \brief FullyConnected followed by a ReLU or a GELU, with the bias, the ReLU and the bias
+ *  gradient computed by the epilogues of the cuBLASLt GEMMs
+ */
+
+#include "./cublaslt_fc-inl.h"
+
+#include <type_traits>
+#include <vector>
+
+// the BGRADB epilogue came with cuBLAS 11.6 of CUDA 11.4
+#if MXNET_USE_CUBLASLT == 1 && CUDA_VERSION >= 11040
+#include <cublasLt.h>
+#define MXNET_USE_CUBLASLT_EPILOGUE 1
+#else
+#define MXNET_USE_CUBLASLT_EPILOGUE 0
+#endif
+
+namespace mxnet {
+namespace op {
+
+#if MXNET_USE_CUBLASLT_EPILOGUE
+
+namespace {
+
+// bytes of the workspace of a cuBLASLt GEMM
+constexpr size_t kCublasLtWorkspace = 4 << 20;
+
+/*! \brief the cuBLASLt descriptors of a column major GEMM D = op(A) * op(B) with an epilogue */
+class CublasLtEpilogueGemm {
+ public:
+  CublasLtEpilogueGemm(cudaDataType_t dtype,
+                       cublasOperation_t transa,
+                       cublasOperation_t transb,
+                       index_t m,
+                       index_t n,
+                       index_t k,
+                       cublasLtEpilogue_t epilogue,
+                       const void* bias) {
+    const index_t a_rows = transa == CUBLAS_OP_N ? m : k;
+    const index_t b_rows = transb == CUBLAS_OP_N ? k : n;
+    CUBLAS_CALL(cublasLtMatmulDescCreate(&desc_, CUBLAS_COMPUTE_32F, CUDA_R_32F));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_TRANSA, &transa, sizeof(transa)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_TRANSB, &transb, sizeof(transb)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_EPILOGUE, &epilogue, sizeof(epilogue)));
+    CUBLAS_CALL(cublasLtMatmulDescSetAttribute(
+        desc_, CUBLASLT_MATMUL_DESC_BIAS_POINTER, &bias, sizeof(bias)));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(
+        &a_, dtype, a_rows, transa == CUBLAS_OP_N ? k : m, a_rows));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(
+        &b_, dtype, b_rows, transb == CUBLAS_OP_N ? n : k, b_rows));
+    CUBLAS_CALL(cublasLtMatrixLayoutCreate(&d_, dtype, m, n, m));
+  }
+
+  ~CublasLtEpilogueGemm() {
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(d_));
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(b_));
+    CUBLAS_CALL(cublasLtMatrixLayoutDestroy(a_));
+    CUBLAS_CALL(cublasLtMatmulDescDestroy(desc_));
+  }
+
+  /*! \brief chooses the algorithm, false when cuBLASLt has none for the epilogue */
+  bool Prepare(cublasLtHandle_t handle) {
+    cublasLtMatmulPreference_t pref;
+    const uint64_t workspace = kCublasLtWorkspace;
+    int found                = 0;
+    CUBLAS_CALL(cublasLtMatmulPreferenceCreate(&pref));
+    CUBLAS_CALL(cublasLtMatmulPreferenceSetAttribute(
+        pref, CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, &workspace, sizeof(workspace)));
+    const cublasStatus_t status =
+        cublasLtMatmulAlgoGetHeuristic(handle, desc_, a_, b_, d_, d_, pref, 1, &algo_, &found);
+    CUBLAS_CALL(cublasLtMatmulPreferenceDestroy(pref));
+    return status == CUBLAS_STATUS_SUCCESS && found > 0;
+  }
+
+  /*! \brief d = a * b + beta * d, with the epilogue */
+  void Run(cublasLtHandle_t handle,
+           cudaStream_t stream,
+           const void* a,
+           const void* b,
+           void* d,
+           float beta,
+           void* workspace) {
+    const float alpha = 1.0f;
+    CUBLAS_CALL(cublasLtMatmul(handle,
+                               desc_,
+                               &alpha,
+                               a,
+                               a_,
+                               b,
+                               b_,
+                               &beta,
+                               d,
+                               d_,
+                               d,
+                               d_,
+                               &algo_.algo,
+                               workspace,
+                               kCublasLtWorkspace,
+                               stream));
+  }
+
+ private:
+  cublasLtMatmulDesc_t desc_;
+  cublasLtMatrixLayout_t a_;
+  cublasLtMatrixLayout_t b_;
+  cublasLtMatrixLayout_t d_;
+  cublasLtMatmulHeuristicResult_t algo_;
+};
+
+template <typename DType>
+bool CublasLtSupports() {
+  return std::is_same<DType, float>::value || std::is_same<DType, mshadow::half::half_t>::value;
+}
+
+template <typename DType>
+cudaDataType_t CublasLtType() {
+  return std::is_same<DType, float>::value ? CUDA_R_32F : CUDA_R_16F;
+}
+
+cublasLtHandle_t CublasLtHandle(mshadow::Stream<gpu>* s) {
+  CHECK_EQ(s->blas_handle_ownership_, mshadow::Stream<gpu>::OwnHandle)
+      << "Must init CuBLAS handle in stream";
+  return reinterpret_cast<cublasLtHandle_t>(s->blas_handle_);
+}
+
+/*!
+ * \brief the forward pass as one GEMM with the bias, and the ReLU, in its epilogue; false when
+ *  cuBLASLt cannot compute it
+ */
+template <typename DType>
+bool SgCublasLtFCForwardGemm(const OpContext& ctx,
+                             const SgCublasLtFCParam& param,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  if (!CublasLtSupports<DType>())
+    return false;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const TBlob& data       = inputs[fullc::kData];
+  const TBlob& weight     = inputs[fullc::kWeight];
+  const bool relu         = param.act_type == sgfc::kReLU;
+  const TBlob& gemm_out   = relu ? outputs[sgfc::kOut] : outputs[sgfc::kPreAct];
+  const index_t hidden    = param.num_hidden;
+  const index_t cols      = weight.shape_[1];
+  const index_t rows      = data.Size() / cols;
+  cublasLtEpilogue_t epilogue;
+  if (param.no_bias) {
+    epilogue = relu ? CUBLASLT_EPILOGUE_RELU : CUBLASLT_EPILOGUE_DEFAULT;
+  } else {
+    epilogue = relu ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_BIAS;
+  }
+  const void* bias = param.no_bias ? nullptr : inputs[fullc::kBias].dptr_;
+  // the row major rows x hidden out = data * weight^T is the column major
+  // hidden x rows out = weight^T * data, whose bias is added to each column
+  CublasLtEpilogueGemm gemm(
+      CublasLtType<DType>(), CUBLAS_OP_T, CUBLAS_OP_N, hidden, rows, cols, epilogue, bias);
+  cublasLtHandle_t handle = CublasLtHandle(s);
+  if (!gemm.Prepare(handle))
+    return false;
+  mshadow::Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(
+      mshadow::Shape1(kCublasLtWorkspace), s);
+  gemm.Run(handle,
+           mshadow::Stream<gpu>::GetStream(s),
+           weight.dptr_,
+           data.dptr_,
+           gemm_out.dptr_,
+           0.0f,
+           workspace.dptr_);
+  if (!relu) {
+    const TBlob& out = outputs[sgfc::kOut];
+    Kernel<op_with_req<mshadow_op::gelu, kWriteTo>, gpu>::Launch(
+        s, out.Size(), out.dptr<DType>(), gemm_out.dptr<DType>());
+  }
+  return true;
+}
+
+/*!
+ * \brief the backward pass with the bias gradient reduced by the epilogue of the weight gradient
+ *  GEMM; false when cuBLASLt cannot compute it
+ */
+template <typename DType>
+bool SgCublasLtFCBackwardGemm(const OpContext& ctx,
+                              const SgCublasLtFCParam& param,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  // the epilogue writes the bias gradient, and computes it with the weight gradient
+  if (!CublasLtSupports<DType>() || param.no_bias || req[fullc::kBias] != kWriteTo ||
+      req[fullc::kWeight] == kNullOp)
+    return false;
+  CHECK_NE(req[fullc::kWeight], kWriteInplace) << "cannot write weight inplace";
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const TBlob& out_grad   = inputs[sgfc::kBwdOutGrad];
+  const TBlob& weight     = inputs[sgfc::kBwdWeight];
+  const index_t hidden    = param.num_hidden;
+  const index_t cols      = weight.shape_[1];
+  const index_t rows      = out_grad.Size() / hidden;
+  // the column major cols x hidden w_grad = data * grad^T, the bias gradient reduces grad over
+  // the rows
+  CublasLtEpilogueGemm gemm(CublasLtType<DType>(),
+                            CUBLAS_OP_N,
+                            CUBLAS_OP_T,
+                            cols,
+                            hidden,
+                            rows,
+                            CUBLASLT_EPILOGUE_BGRADB,
+                            outputs[fullc::kBias].dptr_);
+  cublasLtHandle_t handle = CublasLtHandle(s);
+  if (!gemm.Prepare(handle))
+    return false;
+
+  const size_t grad_bytes = out_grad.Size() * sizeof(DType);
+  mshadow::Tensor<gpu, 1, char> space = ctx.requested[0].get_space_typed<gpu, 1, char>(
+      mshadow::Shape1(grad_bytes + kCublasLtWorkspace), s);
+  DType* grad_ptr = reinterpret_cast<DType*>(space.dptr_);
+  SgFCActivationGrad<gpu, DType>(s, param, inputs, grad_ptr);
+  gemm.Run(handle,
+           mshadow::Stream<gpu>::GetStream(s),
+           inputs[sgfc::kBwdData].dptr_,
+           grad_ptr,
+           outputs[fullc::kWeight].dptr_,
+           req[fullc::kWeight] == kAddTo ? 1.0f : 0.0f,
+           space.dptr_ + grad_bytes);
+  if (req[fullc::kData] != kNullOp) {
+    mshadow::Tensor<gpu, 2, DType> grad(grad_ptr, mshadow::Shape2(rows, hidden), s);
+    mshadow::Tensor<gpu, 2, DType> wmat = weight.get<gpu, 2, DType>(s);
+    mshadow::Tensor<gpu, 2, DType> x_grad =
+        SgFCFlatten<gpu, DType>(param.fc_param(), outputs[fullc::kData], ctx);
+    linalg_gemm(grad, wmat, x_grad, false, false, s, req[fullc::kData]);
+  }
+  return true;
+}
+
+}  // namespace
+
+#endif  // MXNET_USE_CUBLASLT_EPILOGUE
+
+template <>
+void SgCublasLtFCCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<SgCublasLtFCParam>(attrs.parsed);
+  if (req[sgfc::kOut] == kNullOp)
+    return;
+  CHECK_EQ(req[sgfc::kOut], kWriteTo);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[fullc::kData].type_flag_, DType, {
+#if MXNET_USE_CUBLASLT_EPILOGUE
+    if (SgCublasLtFCForwardGemm<DType>(ctx, param, inputs, req, outputs))
+      return;
+#endif
+    SgCublasLtFCForward<gpu, DType>(ctx, param, inputs, req, outputs);
+  });
+}
+
+template <>
+void SgCublasLtFCGradCompute<gpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  const auto& param = nnvm::get<SgCublasLtFCParam>(attrs.parsed);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[sgfc::kBwdOutGrad].type_flag_, DType, {
+#if MXNET_USE_CUBLASLT_EPILOGUE
+    if (SgCublasLtFCBackwardGemm<DType>(ctx, param, inputs, req, outputs))
+      return;
+#endif
+    SgCublasLtFCBackward<gpu, DType>(ctx, param, inputs, req, outputs);
+  });
+}
+
+NNVM_REGISTER_OP(_sg_cublaslt_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", SgCublasLtFCCompute<gpu>);
+
+NNVM_REGISTER_OP(_backward_sg_cublaslt_fully_connected)
+    .set_attr<FCompute>("FCompute<gpu>", SgCublasLtFCGradCompute<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cublaslt_fc_property.h
+ * \brief Partition graph property fusing FullyConnected with the ReLU or the GELU after it
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_PROPERTY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../leaky_relu-inl.h"
+#include "../../nn/activation-inl.h"
+#include "../common.h"
+#include "../subgraph_property.h"
+
+#include "cublaslt_fc-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the act_type of _sg_cublaslt_fully_connected computing n, empty if there is none */
+inline std::string SgCublasLtFCActType(const nnvm::Node& n) {
+  if (n.op() == Op::Get("Activation")) {
+    const auto& param = nnvm::get<ActivationParam>(n.attrs.parsed);
+    return param.act_type == activation::kReLU ? "relu" : "";
+  }
+  if (n.op() == Op::Get("relu") || n.op() == Op::Get("_npx_relu"))
+    return "relu";
+  if (n.op() == Op::Get("LeakyReLU")) {
+    const auto& param = nnvm::get<LeakyReLUParam>(n.attrs.parsed);
+    return param.act_type == leakyrelu::kGELU ? "gelu" : "";
+  }
+  return "";
+}
+
+class SgCublasLtFCSelector : public SubgraphSelector {
+ public:
+  bool Select(const nnvm::Node& n) override {
+    if (n.op() != Op::Get("FullyConnected"))
+      return false;
+    fc_      = &n;
+    matched_ = false;
+    return true;
+  }
+
+  bool SelectInput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    if (&n != fc_ || matched_ || new_node.is_variable() || SgCublasLtFCActType(new_node).empty())
+      return false;
+    matched_ = true;
+    return true;
+  }
+
+  std::vector<nnvm::Node*> Filter(const std::vector<nnvm::Node*>& candidates) override {
+    return candidates.size() == 2 ? candidates : std::vector<nnvm::Node*>();
+  }
+
+  void Reset() override {
+    matched_ = false;
+  }
+
+ private:
+  const nnvm::Node* fc_ = nullptr;
+  bool matched_         = false;
+};
+
+class SgCublasLtFCProperty : public SubgraphProperty {
+ public:
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "cuBLASLt FullyConnected epilogue fusion pass";
+    auto property                  = std::make_shared<SgCublasLtFCProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    if (dmlc::GetEnv("MXNET_DISABLE_CUBLASLT_FC_FUSION", false))
+      property->SetAttr<bool>("disable", true);
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    // the output of FullyConnected must only feed the activation
+    const nnvm::ObjectPtr& act = sym.outputs[0].node;
+    for (const auto& e : sym.outputs) {
+      if (e.node != act || e.index != 0)
+        return nullptr;
+    }
+    const nnvm::ObjectPtr& fc = act->inputs[0].node;
+    nnvm::ObjectPtr n         = nnvm::Node::Create();
+    n->attrs.op               = Op::Get("_sg_cublaslt_fully_connected");
+    n->attrs.name             = fc->attrs.name + "_" + act->attrs.name;
+    n->attrs.dict             = fc->attrs.dict;
+    n->attrs.dict["act_type"] = SgCublasLtFCActType(*act);
+    n->op()->attr_parser(&(n->attrs));
+    // the placeholders of the inputs of FullyConnected in their order, for ConnectSubgraphInputs
+    n->inputs = fc->inputs;
+    return n;
+  }
+
+  SubgraphSelectorPtr CreateSubgraphSelector() const override {
+    return std::make_shared<SgCublasLtFCSelector>();
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr n,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    for (nnvm::NodeEntry* e : *output_entries)
+      *e = nnvm::NodeEntry{n, 0, 0};
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr n,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // The input entries are in topological order, which may not be the order of the inputs of
+    // FullyConnected, e.g. when the weight is shared with an earlier node. Sort both to it.
+    std::vector<nnvm::NodeEntry*> entries;
+    std::vector<nnvm::NodeEntry> orig_entries;
+    for (const auto& placeholder : n->inputs) {
+      for (size_t i = 0; i < input_entries->size(); ++i) {
+        if (input_entries->at(i)->node == placeholder.node) {
+          entries.push_back(input_entries->at(i));
+          orig_entries.push_back(orig_input_entries->at(i));
+          break;
+        }
+      }
+    }
+    CHECK_EQ(orig_entries.size(), n->inputs.size());
+    if (entries.size() == input_entries->size()) {
+      *input_entries      = entries;
+      *orig_input_entries = orig_entries;
+    }
+    n->inputs = orig_entries;
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUBLASLT_CUBLASLT_FC_PROPERTY_H_
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cusparselt_sparse-inl.h
+ * \brief FullyConnected and 1x1 Convolution with 2:4 structured sparse weights, computed on GPU
+ *  by the sparse GEMMs of cuSPARSELt
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_INL_H_
+
+#include <mxnet/ndarray.h>
+#include <mxnet/operator.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../mxnet_op.h"
+#include "../../operator_common.h"
+#include "../../nn/convolution-inl.h"
+#include "../../nn/fully_connected-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief whether the Convolution is a GEMM of its weight and of each image: 1x1, NC* layout */
+inline bool SgSparseConvIsGemm(const ConvolutionParam& param) {
+  if (param.num_group != 1)
+    return false;
+  if (param.layout.has_value() && param.layout.value() != mshadow::kNCW &&
+      param.layout.value() != mshadow::kNCHW && param.layout.value() != mshadow::kNCDHW)
+    return false;
+  for (int i = 0; i < param.kernel.ndim(); ++i) {
+    if (param.kernel[i] != 1 || param.stride[i] != 1 || param.pad[i] != 0 || param.dilate[i] != 1)
+      return false;
+  }
+  return true;
+}
+
+/*!
+ * \brief whether each 4 consecutive elements of the rows of the weight have at most 2 nonzeros,
+ *  the 2:4 pattern of the sparse GEMMs, with the rows of FullyConnected and Convolution weights
+ *  along their first axis
+ */
+bool SgSparseIs2To4(const NDArray& weight);
+
+/*! \brief the state of _sg_cusparselt_fully_connected and _sg_cusparselt_convolution */
+struct SgSparseState {
+  /*! \brief the attributes of the FullyConnected or the Convolution the operator computes */
+  nnvm::NodeAttrs attrs;
+  /*! \brief the cuSPARSELt GEMMs of the GPU forward pass and their compressed weights */
+  std::shared_ptr<void> gemms;
+};
+
+/*! \brief the layer computed by the FCompute of the dense FullyConnected or Convolution */
+template <typename xpu>
+void SgSparseDenseForward(const SgSparseState& state,
+                          const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<NDArray>& outputs) {
+  static const auto& fcompute = Op::GetAttr<FCompute>(
+      std::is_same<xpu, cpu>::value ? "FCompute<cpu>" : "FCompute<gpu>");
+  std::vector<TBlob> in_blobs;
+  std::vector<TBlob> out_blobs;
+  for (const NDArray& input : inputs)
+    in_blobs.push_back(input.data());
+  for (const NDArray& output : outputs)
+    out_blobs.push_back(output.data());
+  fcompute[state.attrs.op](state.attrs, ctx, in_blobs, req, out_blobs);
+}
+
+/*! \brief out[i] += bias[i / inner % channels], the bias of the channels of the output */
+struct SgSparseAddBias {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* bias,
+                                  index_t inner,
+                                  index_t channels) {
+    out[i] += bias[(i / inner) % channels];
+  }
+};
+
+template <typename xpu>
+void SgSparseForward(const OpStatePtr& state_ptr,
+                     const OpContext& ctx,
+                     const std::vector<NDArray>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<NDArray>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_INL_H_
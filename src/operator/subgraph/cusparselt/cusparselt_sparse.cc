@@ -0,0 +1,153 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cusparselt_sparse.cc
+ * \brief FullyConnected and 1x1 Convolution with 2:4 sparse weights, created by the CUSPARSELT
+ *  subgraph backend
+ */
+
+#include "./cusparselt_sparse-inl.h"
+
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+bool SgSparseIs2To4(const NDArray& weight) {
+  const mxnet::TShape& shape = weight.shape();
+  if (shape.ndim() < 2 || shape.ProdShape(1, shape.ndim()) % 4 != 0)
+    return false;
+  NDArray host = weight.ctx().dev_mask() == cpu::kDevMask ? weight : weight.Copy(Context::CPU());
+  host.WaitToRead();
+  bool sparse = true;
+  MSHADOW_REAL_TYPE_SWITCH(host.dtype(), DType, {
+    const DType* w = host.data().dptr<DType>();
+    for (size_t i = 0; sparse && i < shape.Size(); i += 4) {
+      int nonzeros = 0;
+      for (size_t j = i; j < i + 4; ++j)
+        nonzeros += static_cast<float>(w[j]) != 0.0f;
+      sparse = nonzeros <= 2;
+    }
+  });
+  return sparse;
+}
+
+/*! \brief the attributes of the dense layer the operator computes */
+static nnvm::NodeAttrs SgSparseDenseAttrs(const nnvm::NodeAttrs& attrs) {
+  static const Op* sparse_conv = Op::Get("_sg_cusparselt_convolution");
+  nnvm::NodeAttrs dense        = attrs;
+  dense.op = attrs.op == sparse_conv ? Op::Get("Convolution") : Op::Get("FullyConnected");
+  return dense;
+}
+
+static bool SgSparseShape(const nnvm::NodeAttrs& attrs,
+                          mxnet::ShapeVector* in_shape,
+                          mxnet::ShapeVector* out_shape) {
+  static const auto& finfer_shape = Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  const nnvm::NodeAttrs dense     = SgSparseDenseAttrs(attrs);
+  return finfer_shape[dense.op](dense, in_shape, out_shape);
+}
+
+static bool SgSparseType(const nnvm::NodeAttrs& attrs,
+                         std::vector<int>* in_type,
+                         std::vector<int>* out_type) {
+  static const auto& finfer_type = Op::GetAttr<nnvm::FInferType>("FInferType");
+  const nnvm::NodeAttrs dense    = SgSparseDenseAttrs(attrs);
+  return finfer_type[dense.op](dense, in_type, out_type);
+}
+
+static bool SgSparseStorageType(const nnvm::NodeAttrs& attrs,
+                                const int dev_mask,
+                                DispatchMode* dispatch_mode,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  for (int& stype : *in_attrs) {
+    if (!type_assign(&stype, kDefaultStorage))
+      return false;
+  }
+  return storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+}
+
+static std::vector<std::string> SgSparseListInputNames(const nnvm::NodeAttrs& attrs) {
+  static const auto& flist_inputs = Op::GetAttr<nnvm::FListInputNames>("FListInputNames");
+  const nnvm::NodeAttrs dense     = SgSparseDenseAttrs(attrs);
+  return flist_inputs[dense.op](dense);
+}
+
+static uint32_t SgSparseNumInputs(const nnvm::NodeAttrs& attrs) {
+  static const Op* sparse_conv = Op::Get("_sg_cusparselt_convolution");
+  if (attrs.op == sparse_conv)
+    return nnvm::get<ConvolutionParam>(attrs.parsed).no_bias ? 2 : 3;
+  return nnvm::get<FullyConnectedParam>(attrs.parsed).no_bias ? 2 : 3;
+}
+
+static OpStatePtr CreateSgSparseState(const nnvm::NodeAttrs& attrs,
+                                      Context ctx,
+                                      const mxnet::ShapeVector& in_shapes,
+                                      const std::vector<int>& in_types) {
+  return OpStatePtr::Create<SgSparseState>(SgSparseState{SgSparseDenseAttrs(attrs), nullptr});
+}
+
+template <>
+void SgSparseForward<cpu>(const OpStatePtr& state_ptr,
+                          const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<NDArray>& outputs) {
+  SgSparseDenseForward<cpu>(state_ptr.get_state<SgSparseState>(), ctx, inputs, req, outputs);
+}
+
+#define MXNET_REGISTER_SG_SPARSE_OP(name, dense_name, param_parser)                          \
+  NNVM_REGISTER_OP(name)                                                                     \
+      .describe("The " #dense_name " of a 2:4 sparse weight, computed on GPU by cuSPARSELt.\n" \
+                "\n"                                                                          \
+                "Created by the CUSPARSELT subgraph backend, for inference.\n" ADD_FILELINE)  \
+      .set_num_inputs(SgSparseNumInputs)                                                     \
+      .set_num_outputs(1)                                                                    \
+      .set_attr_parser(param_parser)                                                         \
+      .set_attr<nnvm::FListInputNames>("FListInputNames", SgSparseListInputNames)            \
+      .set_attr<nnvm::FListOutputNames>(                                                     \
+          "FListOutputNames",                                                                \
+          [](const NodeAttrs& attrs) { return std::vector<std::string>{"output"}; })         \
+      .set_attr<mxnet::FInferShape>("FInferShape", SgSparseShape)                            \
+      .set_attr<nnvm::FInferType>("FInferType", SgSparseType)                                \
+      .set_attr<FInferStorageType>("FInferStorageType", SgSparseStorageType)                 \
+      .set_attr<FCreateOpState>("FCreateOpState", CreateSgSparseState)                       \
+      .set_attr<FStatefulComputeEx>("FStatefulComputeEx<cpu>", SgSparseForward<cpu>)         \
+      .set_attr<FResourceRequest>(                                                           \
+          "FResourceRequest",                                                                \
+          [](const NodeAttrs& n) {                                                           \
+            return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};                \
+          })                                                                                 \
+      .add_argument("data", "NDArray-or-Symbol", "Input data.")                              \
+      .add_argument("weight", "NDArray-or-Symbol", "Weight with the 2:4 pattern.")           \
+      .add_argument("bias", "NDArray-or-Symbol", "Bias parameter.")
+
+MXNET_REGISTER_SG_SPARSE_OP(_sg_cusparselt_fully_connected,
+                            FullyConnected,
+                            ParamParser<FullyConnectedParam>)
+    .add_arguments(FullyConnectedParam::__FIELDS__());
+
+MXNET_REGISTER_SG_SPARSE_OP(_sg_cusparselt_convolution, Convolution, ConvolutionParamParser)
+    .add_arguments(ConvolutionParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,310 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cusparselt_sparse.cu
+ * \brief FullyConnected and 1x1 Convolution with 2:4 sparse weights, computed by the sparse
+ *  GEMMs of cuSPARSELt when the weights have the pattern, by the dense layers otherwise
+ */
+
+#include "./cusparselt_sparse-inl.h"
+
+#include <mxnet/storage.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../../../common/cuda/utils.h"
+
+#if MXNET_USE_CUSPARSELT == 1
+#include <cusparseLt.h>
+#endif
+
+namespace mxnet {
+namespace op {
+
+#if MXNET_USE_CUSPARSELT == 1
+
+namespace {
+
+#define CUSPARSELT_CALL(func)                                          \
+  {                                                                    \
+    cusparseStatus_t e = (func);                                       \
+    CHECK_EQ(e, CUSPARSE_STATUS_SUCCESS) << "cuSPARSELt: error " << e; \
+  }
+
+// the compressed weights of the GEMMs of a layer are kept for this many numbers of columns
+constexpr size_t kMaxSparseLtGemms = 8;
+
+/*!
+ * \brief the cuSPARSELt GEMM D = op(A) * B of a 2:4 sparse weight A and a batch of dense B, with
+ *  the weight compressed for its plan.
+ *
+ *  FullyConnected is column major: A is the k x m weight, transposed, B the k x n data and D the
+ *  m x n output, m being the hidden units and n the rows of the data. Convolution is row major:
+ *  A is the m x k weight, B the k x n image and D the m x n output of each of the batch images,
+ *  m being the filters and n the pixels.
+ */
+class SparseLtGemm {
+ public:
+  SparseLtGemm(const cusparseLtHandle_t* handle,
+               Context ctx,
+               int dtype,
+               bool fc,
+               index_t m,
+               index_t n,
+               index_t k,
+               index_t batch)
+      : handle_(handle), ctx_(ctx) {
+    const bool half                = dtype == mshadow::kFloat16;
+    const cudaDataType_t type      = half ? CUDA_R_16F : CUDA_R_32F;
+    const cusparseComputeType comp = half ? CUSPARSE_COMPUTE_16F : CUSPARSE_COMPUTE_TF32;
+    const cusparseOrder_t order    = fc ? CUSPARSE_ORDER_COL : CUSPARSE_ORDER_ROW;
+    const cusparseOperation_t op_a =
+        fc ? CUSPARSE_OPERATION_TRANSPOSE : CUSPARSE_OPERATION_NON_TRANSPOSE;
+    const cusparseOperation_t op_b = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    const uint32_t alignment       = 16;
+    CUSPARSELT_CALL(cusparseLtStructuredDescriptorInit(handle_,
+                                                       &a_,
+                                                       fc ? k : m,
+                                                       fc ? m : k,
+                                                       k,
+                                                       alignment,
+                                                       type,
+                                                       order,
+                                                       CUSPARSELT_SPARSITY_50_PERCENT));
+    CUSPARSELT_CALL(cusparseLtDenseDescriptorInit(
+        handle_, &b_, k, n, fc ? k : n, alignment, type, order));
+    CUSPARSELT_CALL(cusparseLtDenseDescriptorInit(
+        handle_, &d_, m, n, fc ? m : n, alignment, type, order));
+    if (batch > 1) {
+      // the weight is broadcast to the images
+      const int batches      = batch;
+      const int64_t a_stride = 0;
+      const int64_t b_stride = k * n;
+      const int64_t d_stride = m * n;
+      for (cusparseLtMatDescriptor_t* desc : {&a_, &b_, &d_}) {
+        CUSPARSELT_CALL(cusparseLtMatDescSetAttribute(
+            handle_, desc, CUSPARSELT_MAT_NUM_BATCHES, &batches, sizeof(batches)));
+      }
+      CUSPARSELT_CALL(cusparseLtMatDescSetAttribute(
+          handle_, &a_, CUSPARSELT_MAT_BATCH_STRIDE, &a_stride, sizeof(a_stride)));
+      CUSPARSELT_CALL(cusparseLtMatDescSetAttribute(
+          handle_, &b_, CUSPARSELT_MAT_BATCH_STRIDE, &b_stride, sizeof(b_stride)));
+      CUSPARSELT_CALL(cusparseLtMatDescSetAttribute(
+          handle_, &d_, CUSPARSELT_MAT_BATCH_STRIDE, &d_stride, sizeof(d_stride)));
+    }
+    CUSPARSELT_CALL(
+        cusparseLtMatmulDescriptorInit(handle_, &matmul_, op_a, op_b, &a_, &b_, &d_, &d_, comp));
+    CUSPARSELT_CALL(cusparseLtMatmulAlgSelectionInit(
+        handle_, &alg_, &matmul_, CUSPARSELT_MATMUL_ALG_DEFAULT));
+    CUSPARSELT_CALL(cusparseLtMatmulPlanInit(handle_, &plan_, &matmul_, &alg_));
+    CUSPARSELT_CALL(cusparseLtMatmulGetWorkspace(handle_, &plan_, &workspace_));
+    CUSPARSELT_CALL(cusparseLtSpMMACompressedSize(
+        handle_, &plan_, &compressed_size_, &compress_buffer_size_));
+  }
+
+  ~SparseLtGemm() {
+    if (compressed_.dptr != nullptr)
+      Storage::Get()->Free(compressed_);
+    CUSPARSELT_CALL(cusparseLtMatmulPlanDestroy(&plan_));
+    CUSPARSELT_CALL(cusparseLtMatDescriptorDestroy(&d_));
+    CUSPARSELT_CALL(cusparseLtMatDescriptorDestroy(&b_));
+    CUSPARSELT_CALL(cusparseLtMatDescriptorDestroy(&a_));
+  }
+
+  /*! \brief bytes of temporary space of Compress and Run */
+  size_t scratch_size() const {
+    return std::max(workspace_, compress_buffer_size_);
+  }
+
+  /*! \brief whether the weight has the 2:4 pattern, synchronizing the stream */
+  bool IsPruned(const void* weight, int* valid, cudaStream_t stream) const {
+    int host_valid = 1;
+    CUSPARSELT_CALL(cusparseLtSpMMAPruneCheck(handle_, &matmul_, weight, valid, stream));
+    CUDA_CALL(cudaMemcpyAsync(&host_valid, valid, sizeof(int), cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+    return host_valid == 0;
+  }
+
+  bool compressed() const {
+    return compressed_.dptr != nullptr;
+  }
+
+  void Compress(const void* weight, void* scratch, cudaStream_t stream) {
+    compressed_ = Storage::Get()->Alloc(compressed_size_, ctx_);
+    CUSPARSELT_CALL(
+        cusparseLtSpMMACompress(handle_, &plan_, weight, compressed_.dptr, scratch, stream));
+  }
+
+  /*! \brief d = a * b + beta * d */
+  void Run(const void* b, void* d, float beta, void* scratch, cudaStream_t stream) const {
+    const float alpha = 1.0f;
+    CUSPARSELT_CALL(cusparseLtMatmul(
+        handle_, &plan_, &alpha, compressed_.dptr, b, &beta, d, d, scratch, &stream, 1));
+  }
+
+ private:
+  const cusparseLtHandle_t* handle_;
+  Context ctx_;
+  cusparseLtMatDescriptor_t a_;
+  cusparseLtMatDescriptor_t b_;
+  cusparseLtMatDescriptor_t d_;
+  cusparseLtMatmulDescriptor_t matmul_;
+  cusparseLtMatmulAlgSelection_t alg_;
+  cusparseLtMatmulPlan_t plan_;
+  size_t workspace_            = 0;
+  size_t compressed_size_      = 0;
+  size_t compress_buffer_size_ = 0;
+  Storage::Handle compressed_;
+};
+
+/*! \brief the GEMMs of a layer by their number of columns, for one version of its weight */
+struct SparseLtGemms {
+  cusparseLtHandle_t handle;
+  const void* weight    = nullptr;
+  size_t weight_version = 0;
+  // whether the weight was checked for the 2:4 pattern, and has it
+  bool checked = false;
+  bool pruned  = false;
+  std::map<index_t, std::unique_ptr<SparseLtGemm>> by_columns;
+
+  SparseLtGemms() {
+    CUSPARSELT_CALL(cusparseLtInit(&handle));
+  }
+
+  ~SparseLtGemms() {
+    by_columns.clear();
+    CUSPARSELT_CALL(cusparseLtDestroy(&handle));
+  }
+};
+
+/*! \brief the forward pass with the sparse GEMM, false when cuSPARSELt cannot compute it */
+bool SgSparseLtForward(SgSparseState* state,
+                       const OpContext& ctx,
+                       const std::vector<NDArray>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  const int dtype = inputs[fullc::kData].dtype();
+  if ((dtype != mshadow::kFloat16 && dtype != mshadow::kFloat32) || req[0] == kWriteInplace ||
+      common::cuda::SMArch(ctx.run_ctx.ctx.dev_id) < 80)
+    return false;
+  const bool fc             = state->attrs.op == Op::Get("FullyConnected");
+  const NDArray& data       = inputs[fullc::kData];
+  const NDArray& weight     = inputs[fullc::kWeight];
+  const mxnet::TShape& dims = data.shape();
+  index_t m, n, k;
+  index_t batch = 1;
+  bool no_bias;
+  if (fc) {
+    no_bias = nnvm::get<FullyConnectedParam>(state->attrs.parsed).no_bias;
+    m       = weight.shape()[0];
+    k       = weight.shape()[1];
+    n       = dims.Size() / k;
+  } else {
+    no_bias = nnvm::get<ConvolutionParam>(state->attrs.parsed).no_bias;
+    m       = weight.shape()[0];
+    k       = weight.shape()[1];
+    batch   = dims[0];
+    n       = dims.ProdShape(2, dims.ndim());
+  }
+  // the sizes the sparse GEMMs of each dtype support
+  const index_t align = dtype == mshadow::kFloat16 ? 16 : 8;
+  if (m % align != 0 || k % align != 0 || n % (align / 2) != 0)
+    return false;
+
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  cudaStream_t stream     = mshadow::Stream<gpu>::GetStream(s);
+  if (state->gemms == nullptr)
+    state->gemms = std::make_shared<SparseLtGemms>();
+  SparseLtGemms* gemms   = static_cast<SparseLtGemms*>(state->gemms.get());
+  const void* weight_ptr = weight.data().dptr_;
+  if (gemms->weight != weight_ptr || gemms->weight_version != weight.version()) {
+    gemms->by_columns.clear();
+    gemms->weight         = weight_ptr;
+    gemms->weight_version = weight.version();
+    gemms->checked        = false;
+  }
+  if (!gemms->by_columns.count(n) && gemms->by_columns.size() >= kMaxSparseLtGemms)
+    gemms->by_columns.clear();
+  std::unique_ptr<SparseLtGemm>& gemm = gemms->by_columns[n];
+  if (gemm == nullptr)
+    gemm.reset(new SparseLtGemm(&gemms->handle, ctx.run_ctx.ctx, dtype, fc, m, n, k, batch));
+
+  // the scratch space of cuSPARSELt, then the result of the pattern check
+  const size_t valid_offset = (gemm->scratch_size() + 255) / 256 * 256;
+  mshadow::Tensor<gpu, 1, char> space = ctx.requested[0].get_space_typed<gpu, 1, char>(
+      mshadow::Shape1(valid_offset + sizeof(int)), s);
+  if (!gemms->checked) {
+    int* valid     = reinterpret_cast<int*>(space.dptr_ + valid_offset);
+    gemms->pruned  = gemm->IsPruned(weight_ptr, valid, stream);
+    gemms->checked = true;
+    if (!gemms->pruned)
+      LOG(WARNING) << "A weight of the CUSPARSELT backend does not have the 2:4 pattern, its "
+                   << "layer runs the dense GEMM until the weight changes";
+  }
+  if (!gemms->pruned)
+    return false;
+  if (!gemm->compressed())
+    gemm->Compress(weight_ptr, space.dptr_, stream);
+  const TBlob& out = outputs[0].data();
+  gemm->Run(data.data().dptr_, out.dptr_, req[0] == kAddTo ? 1.0f : 0.0f, space.dptr_, stream);
+  if (!no_bias) {
+    MSHADOW_REAL_TYPE_SWITCH(dtype, DType, {
+      Kernel<SgSparseAddBias, gpu>::Launch(s,
+                                           out.Size(),
+                                           out.dptr<DType>(),
+                                           inputs[fullc::kBias].data().dptr<DType>(),
+                                           fc ? 1 : n,
+                                           m);
+    });
+  }
+  return true;
+}
+
+}  // namespace
+
+#endif  // MXNET_USE_CUSPARSELT == 1
+
+template <>
+void SgSparseForward<gpu>(const OpStatePtr& state_ptr,
+                          const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<NDArray>& outputs) {
+  SgSparseState& state = state_ptr.get_state<SgSparseState>();
+  if (req[0] == kNullOp)
+    return;
+#if MXNET_USE_CUSPARSELT == 1
+  if (SgSparseLtForward(&state, ctx, inputs, req, outputs))
+    return;
+#endif
+  SgSparseDenseForward<gpu>(state, ctx, inputs, req, outputs);
+}
+
+NNVM_REGISTER_OP(_sg_cusparselt_fully_connected)
+    .set_attr<FStatefulComputeEx>("FStatefulComputeEx<gpu>", SgSparseForward<gpu>);
+
+NNVM_REGISTER_OP(_sg_cusparselt_convolution)
+    .set_attr<FStatefulComputeEx>("FStatefulComputeEx<gpu>", SgSparseForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
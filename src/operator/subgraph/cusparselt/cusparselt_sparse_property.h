@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cusparselt_sparse_property.h
+ * \brief Partition graph property running the FullyConnected and 1x1 Convolution layers with 2:4
+ *  sparse weights on the sparse GEMMs of cuSPARSELt
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_PROPERTY_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../common.h"
+#include "../subgraph_property.h"
+
+#include "cusparselt_sparse-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the sparse operator of a layer, nullptr if it has none */
+inline const Op* SgSparseOp(const nnvm::Node& n) {
+  if (n.op() == Op::Get("FullyConnected"))
+    return Op::Get("_sg_cusparselt_fully_connected");
+  if (n.op() == Op::Get("Convolution") &&
+      SgSparseConvIsGemm(nnvm::get<ConvolutionParam>(n.attrs.parsed)))
+    return Op::Get("_sg_cusparselt_convolution");
+  return nullptr;
+}
+
+class SgSparseSelector : public SubgraphSelector {
+ public:
+  explicit SgSparseSelector(const std::unordered_set<std::string>& dense_weights)
+      : dense_weights_(dense_weights) {}
+
+  // the layers of a weight variable, when its value given to the partitioning has the pattern
+  bool Select(const nnvm::Node& n) override {
+    if (n.is_variable() || SgSparseOp(n) == nullptr || n.inputs.size() <= fullc::kWeight)
+      return false;
+    const nnvm::Node* weight = n.inputs[fullc::kWeight].node.get();
+    return weight->is_variable() && !dense_weights_.count(weight->attrs.name);
+  }
+
+  bool SelectInput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    return false;
+  }
+
+ private:
+  const std::unordered_set<std::string>& dense_weights_;
+};
+
+class SgSparseProperty : public SubgraphProperty {
+ public:
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "cuSPARSELt 2:4 sparse weight pass";
+    auto property                  = std::make_shared<SgSparseProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    return property;
+  }
+
+  // the weights given to the partitioning without the 2:4 pattern keep their dense layers
+  void PrePartition(const nnvm::Graph& g,
+                    const std::unordered_map<std::string, std::string>& options_map) override {
+    dense_weights_.clear();
+    if (!g.HasAttr("in_args") || g.GetAttr<NDArray**>("in_args") == nullptr)
+      return;
+    const auto& in_arg_names = g.GetAttr<std::vector<std::string>>("in_arg_names");
+    NDArray** in_args_ptr    = g.GetAttr<NDArray**>("in_args");
+    std::unordered_map<std::string, const NDArray*> in_args;
+    for (size_t i = 0; i < in_arg_names.size(); ++i)
+      in_args[in_arg_names[i]] = in_args_ptr[i];
+    nnvm::DFSVisit(g.outputs, [&](const nnvm::ObjectPtr& n) {
+      if (n->is_variable() || SgSparseOp(*n) == nullptr || n->inputs.size() <= fullc::kWeight)
+        return;
+      const std::string& weight = n->inputs[fullc::kWeight].node->attrs.name;
+      auto it                   = in_args.find(weight);
+      if (it != in_args.end() && it->second != nullptr && !SgSparseIs2To4(*it->second))
+        dense_weights_.insert(weight);
+    });
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    const nnvm::ObjectPtr& layer = sym.outputs[0].node;
+    nnvm::ObjectPtr n            = nnvm::Node::Create();
+    n->attrs.op                  = SgSparseOp(*layer);
+    n->attrs.name                = layer->attrs.name;
+    n->attrs.dict                = layer->attrs.dict;
+    n->op()->attr_parser(&(n->attrs));
+    // the placeholders of the inputs of the layer in their order, for ConnectSubgraphInputs
+    n->inputs = layer->inputs;
+    return n;
+  }
+
+  SubgraphSelectorPtr CreateSubgraphSelector() const override {
+    return std::make_shared<SgSparseSelector>(dense_weights_);
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr n,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    for (nnvm::NodeEntry* e : *output_entries)
+      *e = nnvm::NodeEntry{n, 0, 0};
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr n,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // the input entries are in topological order, sort them to the order of the layer inputs
+    std::vector<nnvm::NodeEntry*> entries;
+    std::vector<nnvm::NodeEntry> orig_entries;
+    for (const auto& placeholder : n->inputs) {
+      for (size_t i = 0; i < input_entries->size(); ++i) {
+        if (input_entries->at(i)->node == placeholder.node) {
+          entries.push_back(input_entries->at(i));
+          orig_entries.push_back(orig_input_entries->at(i));
+          break;
+        }
+      }
+    }
+    CHECK_EQ(orig_entries.size(), n->inputs.size());
+    if (entries.size() == input_entries->size()) {
+      *input_entries      = entries;
+      *orig_input_entries = orig_entries;
+    }
+    n->inputs = orig_entries;
+  }
+
+ private:
+  std::unordered_set<std::string> dense_weights_;
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUSPARSELT_CUSPARSELT_SPARSE_PROPERTY_H_
@@ -106,6 +106,8 @@ class SgMKLDNNConvOperator {
   bool initialized_{false};
   bool inplace_{false};
   bool post_requantize_{false};
+  // whether the convolution reorders the weight array in place instead of into cached_weight_
+  bool share_weight_{false};
   nnvm::Symbol subgraph_sym_;
   MKLDNNConvFusionParam param_;
   std::shared_ptr<MKLDNNConvForward> fwd_;
@@ -232,8 +234,11 @@ void SgMKLDNNConvOperator::Forward(const OpContext& ctx,
     cached_data_max_ = data_max;
     cached_sum_min_  = sum_min;
     cached_sum_max_  = sum_max;
-    cached_weight_   = inputs[in_weight].Reorder2Default();
-    weight_ver_      = inputs[in_weight].version();
+    // Without the batch norm fusion and the quantization the weight keeps its values, so only the
+    // blocked layout of the weight array is kept, as the convolution does for inference.
+    share_weight_  = !mkldnn_param.with_bn && !mkldnn_param.quantized;
+    cached_weight_ = share_weight_ ? inputs[in_weight] : inputs[in_weight].Reorder2Default();
+    weight_ver_    = inputs[in_weight].version();
     if (!conv_param.no_bias) {
       cached_bias_ = inputs[in_bias];
       bias_ver_    = inputs[in_bias].version();
@@ -343,20 +348,22 @@ void SgMKLDNNConvOperator::Forward(const OpContext& ctx,
     mkldnn::memory::desc bias_md;
     if (has_bias)
       bias_md = fwd_->GetPd().bias_desc();
-    ConvertWeightBias2MKLDNN(&cached_weight_,
-                             &cached_bias_,
-                             has_bias,
-                             fwd_->GetPd().weights_desc(),
-                             has_bias ? &bias_md : nullptr,
-                             full_conv_param.conv_param.num_group,
-                             data_scale_,
-                             weight_scales_);
-    args_[MKLDNN_ARG_SRC]     = *data.GetMKLDNNData();
-    args_[MKLDNN_ARG_WEIGHTS] = *cached_weight_.GetMKLDNNData();
-    if (has_bias)
-      args_[MKLDNN_ARG_BIAS] = *cached_bias_.GetMKLDNNData();
-    args_[MKLDNN_ARG_DST] = *output.GetMKLDNNData();
-    initialized_          = true;
+    if (!share_weight_) {
+      ConvertWeightBias2MKLDNN(&cached_weight_,
+                               &cached_bias_,
+                               has_bias,
+                               fwd_->GetPd().weights_desc(),
+                               has_bias ? &bias_md : nullptr,
+                               full_conv_param.conv_param.num_group,
+                               data_scale_,
+                               weight_scales_);
+      args_[MKLDNN_ARG_SRC]     = *data.GetMKLDNNData();
+      args_[MKLDNN_ARG_WEIGHTS] = *cached_weight_.GetMKLDNNData();
+      if (has_bias)
+        args_[MKLDNN_ARG_BIAS] = *cached_bias_.GetMKLDNNData();
+      args_[MKLDNN_ARG_DST] = *output.GetMKLDNNData();
+    }
+    initialized_ = true;
   }
 
   if (mkldnn_param.with_sum) {
@@ -384,10 +391,11 @@ void SgMKLDNNConvOperator::Forward(const OpContext& ctx,
     MKLDNNStream::Get()->Submit();
   } else {
     std::vector<NDArray> new_inputs;
+    const NDArray& weight = share_weight_ ? inputs[in_weight] : cached_weight_;
     if (has_bias) {
-      new_inputs = {data, cached_weight_, cached_bias_};
+      new_inputs = {data, weight, share_weight_ ? inputs[in_bias] : cached_bias_};
     } else {
-      new_inputs = {data, cached_weight_};
+      new_inputs = {data, weight};
     }
     MKLDNNConvolutionForwardFullFeature(
         full_conv_param, ctx, fwd_.get(), new_inputs, req, {output});
@@ -66,6 +66,8 @@ class SgMKLDNNFCOp {
   bool initialized_{false};
   bool channel_wise_runtime_{false};
   bool reorder_data_{false};
+  // whether the weight array is reordered in place instead of into cached_weight_
+  bool share_weight_{false};
   nnvm::Symbol subgraph_sym_;
   MKLDNNFCFullParam full_param_;
   mkldnn_args_map_t args_;
@@ -345,8 +347,11 @@ void SgMKLDNNFCOp::Forward(const OpContext& ctx,
                                                (has_bias ? &cached_bias_ : nullptr),
                                                out_md));
 
-    // convert weight and bias to the format that MKL-DNN requires
-    if (!mkldnn_param.quantized || support_channelwise_scale) {
+    // convert weight and bias to the format that MKL-DNN requires. Unquantized weights keep
+    // their values, so only the blocked layout of the weight array is kept, as the fully
+    // connected layer does for inference.
+    share_weight_ = !mkldnn_param.quantized;
+    if (support_channelwise_scale) {
       mkldnn::memory::desc bias_md;
       if (has_bias)
         bias_md = fwd_->fwd_pd.bias_desc();
@@ -359,7 +364,7 @@ void SgMKLDNNFCOp::Forward(const OpContext& ctx,
                                data_scale_,
                                weight_scales_,
                                false);
-    } else {
+    } else if (!share_weight_) {
       const auto def_weight_mem = weight.GetMKLDNNData();
       if (def_weight_mem->get_desc() != fwd_->fwd_pd.weights_desc()) {
         cached_weight_         = NDArray(fwd_->fwd_pd.weights_desc());
@@ -391,6 +396,14 @@ void SgMKLDNNFCOp::Forward(const OpContext& ctx,
   MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
     cached_out_mem_->set_data_handle(reinterpret_cast<void*>(output.data().dptr<DType>()));
   });
+  if (share_weight_) {
+    const mkldnn::memory* weight_mem = weight.GetMKLDNNData();
+    if (weight_mem->get_desc() != fwd_->fwd_pd.weights_desc()) {
+      weight.MKLDNNDataReorderAsync(fwd_->fwd_pd.weights_desc());
+      weight_mem = GetWeights(weight, fwd_->fwd_pd.weights_desc(), 1);
+    }
+    args_[MKLDNN_ARG_WEIGHTS] = *weight_mem;
+  }
   MKLDNNStream::Get()->RegisterPrimArgs(fwd_->GetFwd(), args_);
   MKLDNNStream::Get()->Submit();
 
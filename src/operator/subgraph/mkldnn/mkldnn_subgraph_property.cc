@@ -26,6 +26,7 @@
 #include "mkldnn_fc_property.h"
 #include "mkldnn_post_quantize_align_scale_property.h"
 #include "mkldnn_post_quantize_property.h"
+#include "mkldnn_transformer_attention_property.h"
 #include "mkldnn_transformer_post_quantize_property.h"
 #include "mkldnn_transformer_qk_property.h"
 #include "mkldnn_transformer_valatt_property.h"
@@ -42,6 +43,7 @@ MXNET_REGISTER_SUBGRAPH_PROPERTY(MKLDNN, SgMKLDNNFCProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(MKLDNN, SgMKLDNNBNReLUProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(MKLDNN, SgMKLDNNTransformerQKProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(MKLDNN, SgMKLDNNTransformerValAttProperty);
+MXNET_REGISTER_SUBGRAPH_PROPERTY(MKLDNN, SgMKLDNNTransformerAttentionProperty);
 
 MXNET_REGISTER_SUBGRAPH_BACKEND(MKLDNN_QUANTIZE).set_attr("context", Context::CPU());
 
@@ -54,6 +54,30 @@ struct MKLDNNSelfAttParam : public dmlc::Parameter<MKLDNNSelfAttParam> {
   }
 };
 
+struct MKLDNNSelfAttFusedParam : public dmlc::Parameter<MKLDNNSelfAttFusedParam> {
+  int heads;
+  bool interleaved;
+  bool masked;
+  float temperature;
+  DMLC_DECLARE_PARAMETER(MKLDNNSelfAttFusedParam) {
+    DMLC_DECLARE_FIELD(heads).describe("Set number of heads.");
+    DMLC_DECLARE_FIELD(interleaved)
+        .set_default(false)
+        .describe(
+            "Whether the queries, keys and values are interleaved per head in "
+            "seq_length-batch-proj_dim, like the inputs of _contrib_interleaved_matmul_selfatt_qk, "
+            "instead of split in batch-seq_length-proj_dim.");
+    DMLC_DECLARE_FIELD(masked).set_default(false).describe(
+        "Whether a boolean mask selects the keys each query attends to.");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(1.0f)
+        .describe(
+            "Temperature of the softmax, which divides the scores. The scores of interleaved "
+            "inputs are also divided by sqrt(head_dim), like by "
+            "_contrib_interleaved_matmul_selfatt_qk.");
+  }
+};
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_SUBGRAPH_MKLDNN_MKLDNN_TRANSFORMER_INL_H_
@@ -0,0 +1,356 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mkldnn_transformer_attention.cc
+ * \brief Self attention with the scores, the mask, the softmax and the weighted values fused.
+ *  The scores are computed block by block of keys and folded into the output with a running
+ *  softmax, so the seq_length x seq_length attention maps are never materialized.
+ */
+
+#if MXNET_USE_ONEDNN == 1
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "./mkldnn_transformer-inl.h"
+
+#include "../../../engine/openmp.h"
+#include "../common.h"
+
+// 3 tensors within one (queries key values) =
+#define QKV_NUM 3
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(MKLDNNSelfAttFusedParam);
+
+// queries of a task, and keys scored at once
+static constexpr index_t kAttQueryBlock = 32;
+static constexpr index_t kAttKeyBlock   = 128;
+
+/*! \brief strides of the queries, keys, values, outputs and mask of a (batch, head) pair */
+struct SelfAttLayout {
+  index_t qkv_token;
+  index_t qkv_batch;
+  index_t qkv_head;
+  index_t key_offset;
+  index_t value_offset;
+  index_t out_token;
+  index_t out_batch;
+  index_t out_head;
+  index_t mask_batch;
+  index_t mask_head;
+  index_t mask_query;
+  index_t mask_key;
+};
+
+static bool SgMKLDNNSelfAttFusedShape(const NodeAttrs& attrs,
+                                      mxnet::ShapeVector* in_shape,
+                                      mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<MKLDNNSelfAttFusedParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), params.masked ? 2U : 1U);
+  const auto& qkv_shape = in_shape->at(0);
+  if (!mxnet::ndim_is_known(qkv_shape))
+    return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+      << "Input queries_keys_values should be 3D in "
+      << (params.interleaved ? "seq_length-batch-proj_dim" : "batch-seq_length-proj_dim")
+      << ", but the given tensor is " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (QKV_NUM * params.heads), 0)
+      << "The projection dimension " << qkv_shape[2] << " is not divisible by 3 * heads";
+
+  if (params.masked && mxnet::ndim_is_known(in_shape->at(1))) {
+    // the scores are batch-heads-seq_length-seq_length, or batch*heads-seq_length-seq_length
+    // when interleaved, and each dimension of the mask is broadcast or matches them
+    const index_t seq_len  = params.interleaved ? qkv_shape[0] : qkv_shape[1];
+    const index_t batch    = params.interleaved ? qkv_shape[1] : qkv_shape[0];
+    const auto scores      = params.interleaved ?
+                                 mxnet::TShape({batch * params.heads, seq_len, seq_len}) :
+                                 mxnet::TShape({batch, params.heads, seq_len, seq_len});
+    const auto& mask_shape = in_shape->at(1);
+    CHECK_EQ(mask_shape.ndim(), scores.ndim())
+        << "The mask should be " << scores.ndim() << "D, but the given tensor is "
+        << mask_shape.ndim() << "D";
+    for (int i = 0; i < scores.ndim(); ++i) {
+      CHECK(mask_shape[i] == 1 || mask_shape[i] == scores[i])
+          << "The mask " << mask_shape << " does not broadcast to the scores " << scores;
+    }
+  }
+
+  mxnet::TShape out(qkv_shape);
+  out[2] = qkv_shape[2] / QKV_NUM;
+  out_shape->resize(1);
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, out);
+  return shape_is_known(out);
+}
+
+static bool SgMKLDNNSelfAttFusedType(const nnvm::NodeAttrs& attrs,
+                                     std::vector<int>* in_types,
+                                     std::vector<int>* out_types) {
+  const auto& params = nnvm::get<MKLDNNSelfAttFusedParam>(attrs.parsed);
+  CHECK_EQ(in_types->size(), params.masked ? 2U : 1U);
+  CHECK_EQ(out_types->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_types, 0, mshadow::kFloat32);
+  if (params.masked)
+    TYPE_ASSIGN_CHECK(*in_types, 1, mshadow::kBool);
+  TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kFloat32);
+  return true;
+}
+
+static SelfAttLayout GetSelfAttLayout(const MKLDNNSelfAttFusedParam& params,
+                                      const mxnet::TShape& qkv_shape,
+                                      const mxnet::TShape* mask_shape) {
+  SelfAttLayout layout;
+  const index_t proj_dim  = qkv_shape[2];
+  const index_t embed_dim = proj_dim / QKV_NUM;
+  const index_t head_dim  = embed_dim / params.heads;
+  if (params.interleaved) {
+    // seq_length-batch-proj_dim, the queries, keys and values of each head side by side
+    const index_t batch = qkv_shape[1];
+    layout.qkv_token    = batch * proj_dim;
+    layout.qkv_batch    = proj_dim;
+    layout.qkv_head     = QKV_NUM * head_dim;
+    layout.key_offset   = head_dim;
+    layout.value_offset = 2 * head_dim;
+    layout.out_token    = batch * embed_dim;
+    layout.out_batch    = embed_dim;
+    layout.out_head     = head_dim;
+  } else {
+    // batch-seq_length-proj_dim, all the queries then all the keys then all the values
+    const index_t seq_len = qkv_shape[1];
+    layout.qkv_token      = proj_dim;
+    layout.qkv_batch      = seq_len * proj_dim;
+    layout.qkv_head       = head_dim;
+    layout.key_offset     = embed_dim;
+    layout.value_offset   = 2 * embed_dim;
+    layout.out_token      = embed_dim;
+    layout.out_batch      = seq_len * embed_dim;
+    layout.out_head       = head_dim;
+  }
+
+  layout.mask_batch = layout.mask_head = layout.mask_query = layout.mask_key = 0;
+  if (mask_shape) {
+    const int ndim = mask_shape->ndim();
+    std::vector<index_t> strides(ndim);
+    index_t stride = 1;
+    for (int i = ndim - 1; i >= 0; --i) {
+      strides[i] = (*mask_shape)[i] == 1 ? 0 : stride;
+      stride *= (*mask_shape)[i];
+    }
+    if (params.interleaved) {
+      // batch*heads-seq_length-seq_length, with the heads of a batch next to each other
+      layout.mask_batch = strides[0] * params.heads;
+      layout.mask_head  = strides[0];
+    } else {
+      layout.mask_batch = strides[0];
+      layout.mask_head  = strides[1];
+    }
+    layout.mask_query = strides[ndim - 2];
+    layout.mask_key   = strides[ndim - 1];
+  }
+  return layout;
+}
+
+/*!
+ * \brief Attend the queries [q_begin, q_end) of a head to all the keys.
+ * \param scores kAttQueryBlock * kAttKeyBlock scratch
+ * \param acc kAttQueryBlock * head_dim scratch
+ * \param row_max kAttQueryBlock scratch
+ * \param row_sum kAttQueryBlock scratch
+ */
+static void SelfAttBlock(const float* query,
+                         const float* key,
+                         const float* value,
+                         const bool* mask,
+                         float* out,
+                         const SelfAttLayout& layout,
+                         const index_t q_begin,
+                         const index_t q_end,
+                         const index_t seq_len,
+                         const index_t head_dim,
+                         const float scale,
+                         float* scores,
+                         float* acc,
+                         float* row_max,
+                         float* row_sum) {
+  const float neg_inf = -std::numeric_limits<float>::infinity();
+  const index_t num_q = q_end - q_begin;
+  std::fill(acc, acc + num_q * head_dim, 0.0f);
+  std::fill(row_max, row_max + num_q, neg_inf);
+  std::fill(row_sum, row_sum + num_q, 0.0f);
+
+  for (index_t k_begin = 0; k_begin < seq_len; k_begin += kAttKeyBlock) {
+    const index_t num_k = std::min(kAttKeyBlock, seq_len - k_begin);
+    for (index_t r = 0; r < num_q; ++r) {
+      const float* q_row = query + (q_begin + r) * layout.qkv_token;
+      float* s_row       = scores + r * kAttKeyBlock;
+      float block_max    = neg_inf;
+      for (index_t c = 0; c < num_k; ++c) {
+        if (mask &&
+            !mask[(q_begin + r) * layout.mask_query + (k_begin + c) * layout.mask_key]) {
+          s_row[c] = neg_inf;
+          continue;
+        }
+        const float* k_row = key + (k_begin + c) * layout.qkv_token;
+        float dot          = 0.0f;
+#pragma omp simd reduction(+ : dot)
+        for (index_t i = 0; i < head_dim; ++i)
+          dot += q_row[i] * k_row[i];
+        s_row[c]  = dot * scale;
+        block_max = std::max(block_max, s_row[c]);
+      }
+      if (block_max == neg_inf)
+        continue;
+
+      // rescale what the previous blocks accumulated to the new maximum
+      const float new_max = std::max(row_max[r], block_max);
+      const float rescale = std::exp(row_max[r] - new_max);
+      float* acc_row      = acc + r * head_dim;
+      row_sum[r] *= rescale;
+#pragma omp simd
+      for (index_t i = 0; i < head_dim; ++i)
+        acc_row[i] *= rescale;
+      for (index_t c = 0; c < num_k; ++c) {
+        if (s_row[c] == neg_inf)
+          continue;
+        const float p      = std::exp(s_row[c] - new_max);
+        const float* v_row = value + (k_begin + c) * layout.qkv_token;
+        row_sum[r] += p;
+#pragma omp simd
+        for (index_t i = 0; i < head_dim; ++i)
+          acc_row[i] += p * v_row[i];
+      }
+      row_max[r] = new_max;
+    }
+  }
+
+  for (index_t r = 0; r < num_q; ++r) {
+    // like masked_softmax, a query which attends to no key gets zeros
+    const float norm     = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+    const float* acc_row = acc + r * head_dim;
+    float* out_row       = out + (q_begin + r) * layout.out_token;
+#pragma omp simd
+    for (index_t i = 0; i < head_dim; ++i)
+      out_row[i] = acc_row[i] * norm;
+  }
+}
+
+static void SgMKLDNNSelfAttFusedForward(const nnvm::NodeAttrs& attrs,
+                                        const OpContext& ctx,
+                                        const std::vector<TBlob>& inputs,
+                                        const std::vector<OpReqType>& req,
+                                        const std::vector<TBlob>& outputs) {
+  const auto& params = nnvm::get<MKLDNNSelfAttFusedParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo) << "_sg_mkldnn_selfatt only supports kWriteTo";
+
+  const mxnet::TShape& qkv_shape = inputs[0].shape_;
+  const SelfAttLayout layout =
+      GetSelfAttLayout(params, qkv_shape, params.masked ? &inputs[1].shape_ : nullptr);
+  const index_t heads     = params.heads;
+  const index_t batch     = params.interleaved ? qkv_shape[1] : qkv_shape[0];
+  const index_t seq_len   = params.interleaved ? qkv_shape[0] : qkv_shape[1];
+  const index_t head_dim  = qkv_shape[2] / QKV_NUM / heads;
+  const index_t q_blocks  = (seq_len + kAttQueryBlock - 1) / kAttQueryBlock;
+  const index_t num_tasks = batch * heads * q_blocks;
+  const float scale =
+      params.interleaved ? 1.0f / (params.temperature * std::sqrt(static_cast<float>(head_dim))) :
+                           1.0f / params.temperature;
+
+  const float* qkv = inputs[0].dptr<float>();
+  const bool* mask = params.masked ? inputs[1].dptr<bool>() : nullptr;
+  float* out       = outputs[0].dptr<float>();
+
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(nthreads)
+  {
+    std::vector<float> scratch(kAttQueryBlock * (kAttKeyBlock + head_dim + 2));
+    float* scores  = scratch.data();
+    float* acc     = scores + kAttQueryBlock * kAttKeyBlock;
+    float* row_max = acc + kAttQueryBlock * head_dim;
+    float* row_sum = row_max + kAttQueryBlock;
+#pragma omp for
+    for (index_t task = 0; task < num_tasks; ++task) {
+      const index_t b       = task / (heads * q_blocks);
+      const index_t h       = task / q_blocks % heads;
+      const index_t q_begin = task % q_blocks * kAttQueryBlock;
+      const index_t q_end   = std::min(q_begin + kAttQueryBlock, seq_len);
+      const float* query    = qkv + b * layout.qkv_batch + h * layout.qkv_head;
+      const bool* head_mask =
+          mask ? mask + b * layout.mask_batch + h * layout.mask_head : nullptr;
+      SelfAttBlock(query,
+                   query + layout.key_offset,
+                   query + layout.value_offset,
+                   head_mask,
+                   out + b * layout.out_batch + h * layout.out_head,
+                   layout,
+                   q_begin,
+                   q_end,
+                   seq_len,
+                   head_dim,
+                   scale,
+                   scores,
+                   acc,
+                   row_max,
+                   row_sum);
+    }
+  }
+}
+
+NNVM_REGISTER_OP(_sg_mkldnn_selfatt)
+    .describe(R"code(_sg_mkldnn_selfatt)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      auto const& param = nnvm::get<MKLDNNSelfAttFusedParam>(attrs.parsed);
+      return param.masked ? 2 : 1;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<MKLDNNSelfAttFusedParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       auto const& param =
+                                           nnvm::get<MKLDNNSelfAttFusedParam>(attrs.parsed);
+                                       std::vector<std::string> input_names{"queries_keys_values"};
+                                       if (param.masked)
+                                         input_names.emplace_back("mask");
+                                       return input_names;
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", SgMKLDNNSelfAttFusedShape)
+    .set_attr<nnvm::FInferType>("FInferType", SgMKLDNNSelfAttFusedType)
+    .set_attr<FCompute>("FCompute<cpu>", SgMKLDNNSelfAttFusedForward)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("queries_keys_values",
+                  "NDArray-or-Symbol",
+                  "Queries, keys and values interleaved")
+    .add_argument("mask", "NDArray-or-Symbol", "Keys each query attends to")
+    .add_arguments(MKLDNNSelfAttFusedParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
@@ -0,0 +1,277 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_MKLDNN_MKLDNN_TRANSFORMER_ATTENTION_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_MKLDNN_MKLDNN_TRANSFORMER_ATTENTION_PROPERTY_H_
+#if MXNET_USE_ONEDNN == 1
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../contrib/transformer-inl.h"
+#include "../../nn/dropout-inl.h"
+#include "../../nn/softmax-inl.h"
+#include "../common.h"
+
+#include "mkldnn_common.h"
+#include "mkldnn_subgraph_base-inl.h"
+#include "mkldnn_transformer-inl.h"
+
+/*
+                 custom_op
+                     |
+     ________________|______________
+    |                |      ...    |    _sg_mkldnn_selfatt_qk with _sg_mkldnn_selfatt_valatt,
+    |         selfatt_qk     |     |    or _contrib_interleaved_matmul_selfatt_qk with
+    |                |       |     |    _contrib_interleaved_matmul_selfatt_valatt
+    |  (masked_)softmax      |     |
+    |                |       |     |
+    |        (Dropout)       |     |
+    |                 \      |     |
+    |              selfatt_valatt  |
+    |______________________________|
+*/
+namespace mxnet {
+namespace op {
+
+class SgMKLDNNTransformerAttentionSelector : public SubgraphSelectorV2 {
+  enum SelectStatus { kFail = 0, kStart, kSoftmax, kDropout, kSuccess };
+  /*
+    kStart ---> kSoftmax ---> (kDropout) ---> kSuccess
+    Each status except kStart is connected with kFail
+  */
+
+ private:
+  SelectStatus status_;
+  bool interleaved_;
+  std::vector<const BiDirectedNode*> matched_list_;
+
+  static bool IsSoftmax(const nnvm::Node& node) {
+    if (node.op() == Op::Get("softmax")) {
+      auto const& param = nnvm::get<SoftmaxParam>(node.attrs.parsed);
+      return param.axis == -1 && !param.dtype.has_value() &&
+             !(param.use_length.has_value() && param.use_length.value());
+    }
+    if (node.op() == Op::Get("masked_softmax")) {
+      auto const& param = nnvm::get<MaskedSoftmaxParam>(node.attrs.parsed);
+      return param.axis == -1;
+    }
+    return false;
+  }
+
+  static bool IsInferenceDropout(const nnvm::Node& node) {
+    if (node.op() != Op::Get("Dropout"))
+      return false;
+    auto const& param = nnvm::get<DropoutParam>(node.attrs.parsed);
+    return param.mode == dropout::kTraining;
+  }
+
+  // the values of valatt must be the queries, keys and values the scores were computed from
+  bool IsValAtt(const nnvm::Node& node, const nnvm::Node& attention) const {
+    const nnvm::Node* qk = matched_list_[0]->node;
+    if (interleaved_) {
+      return node.op() == Op::Get("_contrib_interleaved_matmul_selfatt_valatt") &&
+             node.inputs[1].node.get() == &attention && node.inputs[0] == qk->inputs[0] &&
+             nnvm::get<InterleavedMatMulParam>(node.attrs.parsed).heads ==
+                 nnvm::get<InterleavedMatMulParam>(qk->attrs.parsed).heads;
+    }
+    if (node.op() != Op::Get("_sg_mkldnn_selfatt_valatt"))
+      return false;
+    auto const& param = nnvm::get<MKLDNNSelfAttParam>(node.attrs.parsed);
+    return !param.quantized && node.inputs[0].node.get() == &attention &&
+           node.inputs[1] == qk->inputs[0] &&
+           param.heads == nnvm::get<MKLDNNSelfAttParam>(qk->attrs.parsed).heads;
+  }
+
+ public:
+  bool Select(const BiDirectedNode& seed_node,
+              const std::shared_ptr<NodeAttr>& node_attr) override {
+    const nnvm::Node* n = seed_node.node;
+    if (n->op() == Op::Get("_contrib_interleaved_matmul_selfatt_qk") ||
+        (n->op() == Op::Get("_sg_mkldnn_selfatt_qk") &&
+         !nnvm::get<MKLDNNSelfAttParam>(n->attrs.parsed).quantized)) {
+      status_      = kStart;
+      interleaved_ = n->op() == Op::Get("_contrib_interleaved_matmul_selfatt_qk");
+      matched_list_.clear();
+      matched_list_.push_back(&seed_node);
+      return true;
+    }
+    return false;
+  }
+
+  bool SelectInput(const BiDirectedNode& n, const BiDirectedNode& input_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& n, const BiDirectedNode& output_node) override {
+    if (status_ == kFail || status_ == kSuccess || output_node.node->is_variable() ||
+        &n != matched_list_.back())
+      return false;
+    // the scores and the attention maps are not used outside of the attention
+    if (n.outputs.size() != 1) {
+      status_ = kFail;
+      return false;
+    }
+
+    const nnvm::Node& new_node = *output_node.node;
+    switch (status_) {
+      case kStart:
+        if (IsSoftmax(new_node) && new_node.inputs[0].node.get() == n.node) {
+          status_ = kSoftmax;
+          matched_list_.push_back(&output_node);
+          return true;
+        }
+        break;
+      case kSoftmax:
+        if (IsInferenceDropout(new_node)) {
+          status_ = kDropout;
+          matched_list_.push_back(&output_node);
+          return true;
+        }
+      case kDropout:
+        if (IsValAtt(new_node, *n.node)) {
+          status_ = kSuccess;
+          matched_list_.push_back(&output_node);
+          return true;
+        }
+        break;
+      default:
+        break;
+    }
+    status_ = kFail;
+    return false;
+  }
+
+  std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
+    if (status_ != kSuccess)
+      return std::vector<BiDirectedNode*>(0);
+    std::vector<BiDirectedNode*> ret;
+    for (auto i : matched_list_) {
+      auto non_const_i = const_cast<BiDirectedNode*>(i);
+      if (std::find(candidates.begin(), candidates.end(), non_const_i) == candidates.end())
+        return std::vector<BiDirectedNode*>(0);
+      ret.push_back(non_const_i);
+    }
+    return ret;
+  }
+
+  void Reset() override {
+    CHECK_GE(matched_list_.size(), 1);
+    auto new_selector = SgMKLDNNTransformerAttentionSelector();
+    new_selector.Select(*matched_list_[0], nullptr);
+    *this = new_selector;
+  }
+};
+
+class SgMKLDNNTransformerAttentionProperty : public SubgraphProperty {
+ public:
+  SgMKLDNNTransformerAttentionProperty() {}
+
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "MKLDNN Transformer attention optimization pass";
+    auto property                  = std::make_shared<SgMKLDNNTransformerAttentionProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_MKLDNN_TRANSFORMER_OPT", 0) ||
+        dmlc::GetEnv("MXNET_DISABLE_ONEDNN_FUSED_ATTENTION", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    // This op has single output, remove duplicated.
+    auto last_node = sym.outputs[0].node;
+    nnvm::Symbol new_sym;
+    new_sym.outputs.emplace_back(last_node);
+    std::ostringstream node_name;
+
+    DFSVisit(new_sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->op() == Op::Get("_sg_mkldnn_selfatt_qk")) {
+        n->attrs.dict["heads"] = node->attrs.dict.at("heads");
+      } else if (node->op() == Op::Get("_contrib_interleaved_matmul_selfatt_qk")) {
+        n->attrs.dict["heads"]       = node->attrs.dict.at("heads");
+        n->attrs.dict["interleaved"] = "True";
+      } else if (node->op() == Op::Get("softmax") || node->op() == Op::Get("masked_softmax")) {
+        if (node->op() == Op::Get("masked_softmax"))
+          n->attrs.dict["masked"] = "True";
+        auto temperature = node->attrs.dict.find("temperature");
+        if (temperature != node->attrs.dict.end() && temperature->second != "None")
+          n->attrs.dict["temperature"] = temperature->second;
+      }
+    });
+
+    node_name << "_sg_mkldnn_selfatt_" << subgraph_id;
+    n->attrs.name = node_name.str();
+    n->attrs.op   = Op::Get("_sg_mkldnn_selfatt");
+    CHECK(n->attrs.op);
+    n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(new_sym));
+    n->op()->attr_parser(&(n->attrs));
+    return n;
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    auto selector = std::make_shared<SgMKLDNNTransformerAttentionSelector>();
+    return selector;
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr n,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    // Connect all extern output entries to output[0]
+    for (size_t i = 0; i < output_entries->size(); ++i) {
+      auto entry_ptr = output_entries->at(i);
+      *entry_ptr     = nnvm::NodeEntry{n, 0, 0};
+    }
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr subgraph_node,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // matmuls share the queries, keys and values, connect them once and the mask after them
+    const nnvm::NodeEntry* qkv_entry  = nullptr;
+    const nnvm::NodeEntry* mask_entry = nullptr;
+    DFSVisit(subgraph_node->attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->op() == Op::Get("_sg_mkldnn_selfatt_qk") ||
+          node->op() == Op::Get("_contrib_interleaved_matmul_selfatt_qk")) {
+        qkv_entry = &node->inputs[0];
+      } else if (node->op() == Op::Get("masked_softmax")) {
+        mask_entry = &node->inputs[1];
+      }
+    });
+    subgraph_node->inputs.clear();
+    for (const nnvm::NodeEntry* entry : {qkv_entry, mask_entry}) {
+      for (size_t i = 0; entry && i < input_entries->size(); ++i) {
+        // deduplicated subgraphs keep a single entry per variable
+        if (input_entries->at(i)->node == entry->node) {
+          subgraph_node->inputs.push_back(orig_input_entries->at(i));
+          break;
+        }
+      }
+    }
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_SUBGRAPH_MKLDNN_MKLDNN_TRANSFORMER_ATTENTION_PROPERTY_H_
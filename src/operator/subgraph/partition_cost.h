@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file partition_cost.h
+ * \brief Estimated cost of the subgraph candidates of several backends, to assign the operator
+ *  nodes of a graph to the backends with the least estimated latency
+ */
+#ifndef MXNET_OPERATOR_SUBGRAPH_PARTITION_COST_H_
+#define MXNET_OPERATOR_SUBGRAPH_PARTITION_COST_H_
+
+#include <nnvm/graph.h>
+#include <mxnet/base.h>
+#include <mxnet/tuple.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the cost model of a backend */
+struct PartitionBackendCost {
+  /*! \brief how many times faster the backend runs a subgraph than the default operators */
+  double speedup;
+  /*! \brief whether the inputs and outputs of its subgraphs are copied across devices */
+  bool transfer;
+};
+
+/*! \brief the elements of an entry, 1 when its shape is not known */
+inline double PartitionEntryElements(const nnvm::Graph& g, uint32_t eid) {
+  if (!g.HasAttr("shape"))
+    return 1;
+  const auto& shape = g.GetAttr<mxnet::ShapeVector>("shape")[eid];
+  return shape_is_known(shape) ? static_cast<double>(shape.Size()) : 1;
+}
+
+/*! \brief the bytes of an entry, for 4-byte elements when its dtype is not known */
+inline double PartitionEntryBytes(const nnvm::Graph& g, uint32_t eid) {
+  int dtype = -1;
+  if (g.HasAttr("dtype"))
+    dtype = g.GetAttr<nnvm::DTypeVector>("dtype")[eid];
+  return PartitionEntryElements(g, eid) * (dtype == -1 ? 4 : mshadow::mshadow_sizeof(dtype));
+}
+
+/*!
+ * \brief the estimated work of an operator node: the multiply-accumulates of FullyConnected and
+ *  the convolutions, the elements of its outputs otherwise
+ */
+inline double PartitionNodeWork(const nnvm::Graph& g, uint32_t nid) {
+  static const std::unordered_set<const nnvm::Op*> weighted_ops = {
+      Op::Get("FullyConnected"), Op::Get("Convolution"), Op::Get("Deconvolution")};
+  const auto& idx  = g.indexed_graph();
+  const auto& node = idx[nid];
+  double work      = 0;
+  for (uint32_t i = 0; i < node.source->num_outputs(); ++i)
+    work += PartitionEntryElements(g, idx.entry_id(nid, i));
+  if (weighted_ops.count(node.source->op()) && node.inputs.size() > 1 && g.HasAttr("shape")) {
+    // every output element reduces over the weights of its output channel
+    const auto& weight = g.GetAttr<mxnet::ShapeVector>("shape")[idx.entry_id(node.inputs[1])];
+    if (shape_is_known(weight) && weight[0] > 0)
+      work *= static_cast<double>(weight.Size()) / weight[0];
+  }
+  return work;
+}
+
+/*!
+ * \brief the estimated latency the backend saves on a region: the work of its nodes less that
+ *  of the backend, less the copies of the outputs of operators coming in and going out of it.
+ *  The parameters are copied once, so they do not count.
+ */
+inline double PartitionRegionBenefit(const nnvm::Graph& g,
+                                     const std::unordered_set<uint32_t>& nodes,
+                                     const PartitionBackendCost& cost,
+                                     double transfer_cost) {
+  const auto& idx = g.indexed_graph();
+  double work     = 0;
+  for (const uint32_t nid : nodes)
+    work += PartitionNodeWork(g, nid);
+  double benefit = work - work / cost.speedup;
+  if (!cost.transfer)
+    return benefit;
+  std::unordered_set<uint32_t> boundary;
+  for (const uint32_t nid : nodes) {
+    for (const auto& e : idx[nid].inputs) {
+      if (!nodes.count(e.node_id) && !idx[e.node_id].source->is_variable())
+        boundary.insert(idx.entry_id(e));
+    }
+  }
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    if (nodes.count(nid))
+      continue;
+    for (const auto& e : idx[nid].inputs) {
+      if (nodes.count(e.node_id))
+        boundary.insert(idx.entry_id(e));
+    }
+  }
+  for (const auto& e : idx.outputs()) {
+    if (nodes.count(e.node_id))
+      boundary.insert(idx.entry_id(e));
+  }
+  for (const uint32_t eid : boundary)
+    benefit -= PartitionEntryBytes(g, eid) * transfer_cost;
+  return benefit;
+}
+
+/*!
+ * \brief assigns the operator nodes of the graph to backends so that the estimated latency is the
+ *  least. The overlapping candidates of a backend, found by its properties, make a region, and the
+ *  regions of all the backends are taken greedily by their benefit while they do not overlap.
+ * \param g the graph, with its shapes and dtypes if they were inferred
+ * \param candidates the node names of the subgraph candidates of each backend
+ * \param costs the cost model of each backend
+ * \param transfer_cost the cost of a byte copied across devices, in multiply-accumulates
+ * \return the backend index of the assigned nodes, by name
+ */
+inline std::unordered_map<std::string, size_t> AssignPartitionByCost(
+    const nnvm::Graph& g,
+    const std::vector<std::vector<std::vector<std::string>>>& candidates,
+    const std::vector<PartitionBackendCost>& costs,
+    double transfer_cost) {
+  CHECK_EQ(candidates.size(), costs.size());
+  const auto& idx = g.indexed_graph();
+  std::unordered_map<std::string, uint32_t> node_ids;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid)
+    node_ids[idx[nid].source->attrs.name] = nid;
+
+  struct Region {
+    size_t backend;
+    std::unordered_set<uint32_t> nodes;
+    double benefit;
+  };
+  std::vector<Region> regions;
+  for (size_t b = 0; b < candidates.size(); ++b) {
+    // union-find over the candidates of the backend sharing nodes
+    std::vector<size_t> parent(candidates[b].size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](size_t i) {
+      while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+      return i;
+    };
+    std::unordered_map<uint32_t, size_t> candidate_of;
+    for (size_t c = 0; c < candidates[b].size(); ++c) {
+      for (const auto& name : candidates[b][c]) {
+        auto it = node_ids.find(name);
+        if (it == node_ids.end())
+          continue;
+        auto inserted = candidate_of.emplace(it->second, c);
+        if (!inserted.second)
+          parent[find(c)] = find(inserted.first->second);
+      }
+    }
+    std::unordered_map<size_t, size_t> region_of;
+    for (const auto& kv : candidate_of) {
+      const size_t root = find(kv.second);
+      if (!region_of.count(root)) {
+        region_of[root] = regions.size();
+        regions.push_back(Region{b, {}, 0});
+      }
+      regions[region_of[root]].nodes.insert(kv.first);
+    }
+  }
+  for (auto& region : regions)
+    region.benefit = PartitionRegionBenefit(g, region.nodes, costs[region.backend], transfer_cost);
+  std::stable_sort(regions.begin(), regions.end(), [](const Region& a, const Region& b) {
+    return a.benefit > b.benefit;
+  });
+
+  std::unordered_map<std::string, size_t> assignment;
+  std::unordered_set<uint32_t> assigned;
+  for (const auto& region : regions) {
+    if (region.benefit <= 0)
+      break;
+    bool overlaps = false;
+    for (const uint32_t nid : region.nodes)
+      overlaps = overlaps || assigned.count(nid);
+    if (overlaps)
+      continue;
+    for (const uint32_t nid : region.nodes) {
+      assigned.insert(nid);
+      assignment[idx[nid].source->attrs.name] = region.backend;
+    }
+  }
+  return assignment;
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_PARTITION_COST_H_
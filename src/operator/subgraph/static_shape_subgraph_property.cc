@@ -61,6 +61,13 @@ class StaticShapeOpSelector : public SubgraphSelector {
 /*
  * This subgraph property finds a subgraph whose nodes have only static shape operators.
  * The operators in the subgraph will be executed by _CachedOp.
+ *
+ * With the static_shape_aot option, on by default, the subgraphs are specialized ahead of time
+ * even though the graph around them is dynamic: their _CachedOp is static_alloc and static_shape,
+ * so that their memory is planned and their operators are resolved on the first call of an input
+ * shape, and it bulks the whole subgraph into one engine operation, which is captured into a CUDA
+ * graph with the static_shape_cuda_graphs option. The later calls with the shapes of one of the
+ * last shape_cache_size calls only compare the shapes and push that operation.
  */
 class StaticShapeSubgraphProperty : public SubgraphProperty {
  public:
@@ -81,6 +88,8 @@ class StaticShapeSubgraphProperty : public SubgraphProperty {
                     const std::unordered_map<std::string, std::string>& options_map) override {
     options_map_.clear();
     param_name_set_.clear();
+    aot_         = dmlc::GetEnv("MXNET_STATIC_SHAPE_SUBGRAPH_AOT", true);
+    cuda_graphs_ = dmlc::GetEnv("MXNET_STATIC_SHAPE_SUBGRAPH_CUDA_GRAPHS", false);
     const auto& indexed_graph = g.indexed_graph();
     for (auto& kv : options_map) {
       // update static_alloc and static_shape flags
@@ -90,6 +99,12 @@ class StaticShapeSubgraphProperty : public SubgraphProperty {
         } else {
           options_map_.emplace_back(kv.first, "false");
         }
+      } else if (kv.first == "static_shape_aot") {
+        aot_ = kv.second == "True" || kv.second == "true" || kv.second == "1";
+      } else if (kv.first == "static_shape_cuda_graphs") {
+        cuda_graphs_ = kv.second == "True" || kv.second == "true" || kv.second == "1";
+      } else if (kv.first == "shape_cache_size") {
+        shape_cache_size_ = kv.second;
         // update param_name_set_ for data_indices and param_indices
       } else if (kv.first == "param_indices") {
         std::string param_str = kv.second;
@@ -170,15 +185,34 @@ class StaticShapeSubgraphProperty : public SubgraphProperty {
     }
     data_indices  = data_indices + "]";
     param_indices = param_indices + "]";
-    for (auto kv : options_map_) {
-      flags->emplace_back(kv);
+    if (aot_) {
+      size_t num_ops = 0;
+      nnvm::DFSVisit(symbol.outputs, [&num_ops](const nnvm::ObjectPtr& node) {
+        num_ops += !node->is_variable();
+      });
+      flags->emplace_back("static_alloc", "true");
+      flags->emplace_back("static_shape", "true");
+      flags->emplace_back("forward_bulk_size", std::to_string(num_ops));
+      if (cuda_graphs_)
+        flags->emplace_back("cuda_graphs", "true");
+    } else {
+      for (auto kv : options_map_) {
+        flags->emplace_back(kv);
+      }
     }
+    if (!shape_cache_size_.empty())
+      flags->emplace_back("shape_cache_size", shape_cache_size_);
     flags->emplace_back("data_indices", data_indices);
     flags->emplace_back("param_indices", param_indices);
   }
 
   std::vector<std::pair<std::string, std::string>> options_map_;
   std::set<std::string> param_name_set_;
+  // whether the subgraphs are specialized ahead of time, see StaticShapeSubgraphProperty
+  bool aot_ = true;
+  // whether the subgraphs specialized ahead of time are captured into CUDA graphs
+  bool cuda_graphs_ = false;
+  std::string shape_cache_size_;
 };
 
 MXNET_REGISTER_SUBGRAPH_BACKEND(static_shape);
@@ -706,8 +706,8 @@ std::unordered_map<std::string, TShape> GetPlaceholderShapes(const ShapeVector&
   for (uint32_t i = 0; i < shape_inputs.size(); ++i) {
     std::string name  = ig[ig.input_nodes()[i]].source->attrs.name;
     mxnet::TShape shp = shape_inputs[i];
-    if (!mxnet::op::shape_is_none(shp)) {
-      // TODO(@reminisce): confirm
+    // the dimensions of -1 are those of the optimization profile of the engine
+    if (mxnet::ndim_is_known(shp)) {
       placeholder_shapes.emplace(name, shp);
     }
   }
@@ -750,9 +750,13 @@ void ConvertPlaceholder(const std::string& node_name,
   auto entry_shape = placeholder_shapes.find(node_name)->second;
   auto entry_dtype = placeholder_dtypes.find(node_name)->second;
   type_proto->set_elem_type(ConvertDType(entry_dtype));
-  for (const auto& elem : entry_shape) {
+  for (int i = 0; i < entry_shape.ndim(); ++i) {
     TensorShapeProto_Dimension* const tsp_dim = shape_proto->add_dim();
-    tsp_dim->set_dim_value(static_cast<int64>(elem));
+    if (entry_shape[i] == -1) {
+      tsp_dim->set_dim_param(node_name + "_" + std::to_string(i));
+    } else {
+      tsp_dim->set_dim_value(static_cast<int64>(entry_shape[i]));
+    }
   }
 }
 
@@ -822,9 +826,14 @@ void ConvertOutput(GraphProto* const graph_proto,
   // Also support fp16.
   tensor_type->set_elem_type(ConvertDType(dtype));
 
-  for (int64_t dim_shp : shapes[out_idx]) {
+  const mxnet::TShape& out_shape = shapes[out_idx];
+  for (int i = 0; i < out_shape.ndim(); ++i) {
     TensorShapeProto_Dimension* const tsp_dim = tensor_shape_proto->add_dim();
-    tsp_dim->set_dim_value(static_cast<int64>(dim_shp));
+    if (out_shape[i] == -1) {
+      tsp_dim->set_dim_param(node_name + "_" + std::to_string(i));
+    } else {
+      tsp_dim->set_dim_value(static_cast<int64>(out_shape[i]));
+    }
   }
 }
 
@@ -37,6 +37,8 @@
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
 
+#include <algorithm>
+
 using std::cerr;
 using std::cout;
 using std::endl;
@@ -65,7 +67,8 @@ onnxToTrtCtx(const std::string& onnx_model,
              int32_t max_batch_size,
              size_t max_workspace_size,
              nvinfer1::ILogger::Severity verbosity,
-             bool debug_builder) {
+             bool debug_builder,
+             const std::vector<TRTInputProfile>& profile) {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   auto trt_logger  = std::unique_ptr<TRT_Logger>(new TRT_Logger(verbosity));
@@ -103,20 +106,54 @@ onnxToTrtCtx(const std::string& onnx_model,
     }
     throw dmlc::Error("Cannot parse ONNX into TensorRT Engine");
   }
-  if (dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true)) {
+  auto trt_config = InferObject(trt_builder->createBuilderConfig());
+  if (UseFp16()) {
     if (trt_builder->platformHasFastFp16()) {
-      trt_builder->setFp16Mode(true);
+      trt_config->setFlag(nvinfer1::BuilderFlag::kFP16);
     } else {
       LOG(WARNING) << "TensorRT can't use fp16 on this platform";
     }
   }
+  if (debug_builder) {
+    trt_config->setFlag(nvinfer1::BuilderFlag::kDEBUG);
+  }
+  trt_config->setMaxWorkspaceSize(max_workspace_size);
   trt_builder->setMaxBatchSize(max_batch_size);
-  trt_builder->setMaxWorkspaceSize(max_workspace_size);
-  trt_builder->setDebugSync(debug_builder);
-  auto trt_engine = InferObject(trt_builder->buildCudaEngine(*trt_network));
+  // the inputs with dimensions of -1 take any shape from the min to the max of their profile
+  if (!profile.empty()) {
+    nvinfer1::IOptimizationProfile* trt_profile = trt_builder->createOptimizationProfile();
+    auto dims = [](const std::vector<int64_t>& shape) {
+      nvinfer1::Dims ret;
+      ret.nbDims = shape.size();
+      std::copy(shape.begin(), shape.end(), ret.d);
+      return ret;
+    };
+    for (const auto& p : profile) {
+      trt_profile->setDimensions(p.name.c_str(), nvinfer1::OptProfileSelector::kMIN, dims(p.min));
+      trt_profile->setDimensions(p.name.c_str(), nvinfer1::OptProfileSelector::kOPT, dims(p.opt));
+      trt_profile->setDimensions(p.name.c_str(), nvinfer1::OptProfileSelector::kMAX, dims(p.max));
+    }
+    trt_config->addOptimizationProfile(trt_profile);
+  }
+  auto trt_engine = InferObject(trt_builder->buildEngineWithConfig(*trt_network, *trt_config));
   return std::make_tuple(std::move(trt_engine), std::move(trt_parser), std::move(trt_logger));
 }
 
+std::string OnnxModelKey(const std::string& onnx_model) {
+  ::ONNX_NAMESPACE::ModelProto model;
+  if (!model.ParseFromString(onnx_model)) {
+    throw dmlc::Error("Could not parse ONNX from string");
+  }
+  model.mutable_graph()->clear_name();
+  std::string ret;
+  model.SerializeToString(&ret);
+  return ret;
+}
+
+bool UseFp16() {
+  return dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true);
+}
+
 }  // namespace onnx_to_tensorrt
 
 #endif  // MXNET_USE_TENSORRT
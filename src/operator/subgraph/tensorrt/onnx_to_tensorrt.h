@@ -38,6 +38,7 @@
 #include <string>
 #include <ctime>
 #include <tuple>
+#include <vector>
 
 namespace onnx_to_tensorrt {
 
@@ -83,14 +84,32 @@ class TRT_Logger : public nvinfer1::ILogger {
   }
 };
 
+/*!
+ * \brief the optimization profile of an input of the network, the dimensions of which may vary
+ *  from min to max where they differ, and are -1 in the ONNX model
+ */
+struct TRTInputProfile {
+  std::string name;
+  std::vector<int64_t> min;
+  std::vector<int64_t> opt;
+  std::vector<int64_t> max;
+};
+
 std::tuple<unique_ptr<nvinfer1::ICudaEngine>,
            unique_ptr<nvonnxparser::IParser>,
            std::unique_ptr<TRT_Logger> >
 onnxToTrtCtx(const std::string& onnx_model,
-             int32_t max_batch_size                = 32,
-             size_t max_workspace_size             = 1L << 30,
-             nvinfer1::ILogger::Severity verbosity = nvinfer1::ILogger::Severity::kWARNING,
-             bool debug_builder                    = false);
+             int32_t max_batch_size                      = 32,
+             size_t max_workspace_size                   = 1L << 30,
+             nvinfer1::ILogger::Severity verbosity       = nvinfer1::ILogger::Severity::kWARNING,
+             bool debug_builder                          = false,
+             const std::vector<TRTInputProfile>& profile = {});
+
+/*! \brief the ONNX model without the name of its graph, which differs between processes */
+std::string OnnxModelKey(const std::string& onnx_model);
+
+/*! \brief whether the engines are built with fp16 kernels */
+bool UseFp16();
 }  // namespace onnx_to_tensorrt
 
 #endif  // MXNET_USE_TENSORRT
@@ -30,6 +30,8 @@
 
 #include <onnx-tensorrt/NvOnnxParser.h>
 
+#include <algorithm>
+#include <memory>
 #include <utility>
 #include <string>
 #include <vector>
@@ -58,23 +60,34 @@ struct TRTParam {
   std::unordered_map<std::string, NDArray> params_map;
 };
 
+/*!
+ * \brief a TensorRT engine, shared by the states of the subgraphs with the same ONNX model and
+ *  optimization profile on a GPU
+ */
+struct TRTEngine {
+  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> trt_logger;
+  onnx_to_tensorrt::unique_ptr<nvinfer1::IRuntime> trt_runtime;
+  onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> trt_parser;
+  onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> trt_engine;
+};
+
 struct TRTEngineParam {
-  TRTEngineParam(onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> _trt_engine,
-                 onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> _trt_parser,
-                 std::unique_ptr<onnx_to_tensorrt::TRT_Logger> _trt_logger,
+  TRTEngineParam(std::shared_ptr<TRTEngine> _engine,
                  const std::unordered_map<std::string, uint32_t>& input_map,
                  const std::unordered_map<std::string, uint32_t>& output_map) {
-    trt_engine    = std::move(_trt_engine);
-    trt_logger    = std::move(_trt_logger);
-    trt_parser    = std::move(_trt_parser);
+    engine        = std::move(_engine);
+    trt_engine    = engine->trt_engine.get();
     binding_order = std::make_shared<std::vector<std::pair<uint32_t, bool>>>();
     bindings      = std::make_shared<std::vector<void*>>();
     binding_order->reserve(trt_engine->getNbBindings());
     bindings->resize(trt_engine->getNbBindings());
+    dynamic_bindings.resize(trt_engine->getNbBindings(), false);
     for (int b = 0; b < trt_engine->getNbBindings(); ++b) {
       const std::string& binding_name = trt_engine->getBindingName(b);
       if (trt_engine->bindingIsInput(b)) {
         binding_order->emplace_back(input_map.at(binding_name), true);
+        const nvinfer1::Dims dims = trt_engine->getBindingDimensions(b);
+        dynamic_bindings[b]       = std::count(dims.d, dims.d + dims.nbDims, -1) > 0;
       } else {
         binding_order->emplace_back(output_map.at(binding_name), false);
       }
@@ -82,12 +95,13 @@ struct TRTEngineParam {
     trt_executor = onnx_to_tensorrt::InferObject(trt_engine->createExecutionContext());
   }
 
-  onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> trt_engine;
+  std::shared_ptr<TRTEngine> engine;
+  nvinfer1::ICudaEngine* trt_engine;
   onnx_to_tensorrt::unique_ptr<nvinfer1::IExecutionContext> trt_executor;
-  onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> trt_parser;
-  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> trt_logger;
   std::shared_ptr<std::vector<std::pair<uint32_t, bool>>> binding_order;
   std::shared_ptr<std::vector<void*>> bindings;
+  /*! \brief whether the shape of an input binding is set by each call, from its profile */
+  std::vector<bool> dynamic_bindings;
 };
 
 class TensorrtSelector : public SubgraphSelector {
@@ -279,6 +293,14 @@ class TensorrtProperty : public SubgraphProperty {
     for (unsigned i = 0; i < in_aux_names.size(); ++i) {
       in_aux_dict[in_aux_names[i]] = in_aux_ptr[i];
     }
+    // the optimization profiles of the inputs, as min_shape_<input>=(1,3,224,224)
+    profile_options.clear();
+    for (const auto& kv : options_map) {
+      for (const char* prefix : {"min_shape_", "opt_shape_", "max_shape_"}) {
+        if (kv.first.rfind(prefix, 0) == 0)
+          profile_options.insert(kv);
+      }
+    }
   }
 
   nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
@@ -314,6 +336,12 @@ class TensorrtProperty : public SubgraphProperty {
         param.params_map.emplace(param_name, cache->Copy(Context()));
         param.params_map[param_name].WaitToRead();
         params_oss << param_name << ";";
+      } else {
+        for (const char* prefix : {"min_shape_", "opt_shape_", "max_shape_"}) {
+          auto it = profile_options.find(prefix + param_name);
+          if (it != profile_options.end())
+            n->attrs.dict.insert(*it);
+        }
       }
     }
     auto tensorrt_params_names = params_oss.str();
@@ -362,6 +390,7 @@ class TensorrtProperty : public SubgraphProperty {
   }
 
   std::unordered_map<std::string, NDArray*> in_args_dict, in_aux_dict;
+  std::unordered_map<std::string, std::string> profile_options;
 };
 
 }  // namespace op
@@ -27,6 +27,18 @@
 
 #include "./tensorrt-inl.h"
 
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "../../../common/cuda/utils.h"
+
 namespace mxnet {
 namespace op {
 
@@ -257,6 +269,151 @@ void TRTParamParser(nnvm::NodeAttrs* attrs) {
   attrs->parsed = std::move(_param);
 }
 
+/*! \brief the shape of an input set by attrs.dict[key], or default_shape when it is not set */
+inline mxnet::TShape TRTProfileShape(const nnvm::NodeAttrs& attrs,
+                                     const std::string& key,
+                                     const mxnet::TShape& default_shape) {
+  auto it = attrs.dict.find(key);
+  if (it == attrs.dict.end())
+    return default_shape;
+  mxnet::TShape shape;
+  std::istringstream is(it->second);
+  is >> shape;
+  CHECK_EQ(shape.ndim(), default_shape.ndim())
+      << key << " of " << attrs.name << " is " << it->second << ", but the input has "
+      << default_shape.ndim() << " dimensions";
+  return shape;
+}
+
+/*!
+ * \brief the optimization profile of the inputs of a TensorRT subgraph, empty when their shapes
+ *  are static. The first dimension of an input varies from 1 to MXNET_TENSORRT_MAX_BATCH_SIZE,
+ *  and the min_shape_<input>, opt_shape_<input> and max_shape_<input> options of the backend
+ *  set the ranges of the others.
+ */
+std::vector<onnx_to_tensorrt::TRTInputProfile> TRTProfile(const nnvm::NodeAttrs& attrs,
+                                                          const std::vector<TShape>& in_shape) {
+  const auto& inputs_to_idx = nnvm::get<TRTParam>(attrs.parsed).inputs_to_idx;
+  const int max_batch_size  = dmlc::GetEnv("MXNET_TENSORRT_MAX_BATCH_SIZE", 0);
+  std::vector<onnx_to_tensorrt::TRTInputProfile> profile;
+  bool dynamic = false;
+  for (const auto& kv : inputs_to_idx) {
+    // the labels are not inputs of the ONNX model
+    if (kv.first.find("label") != std::string::npos)
+      continue;
+    const mxnet::TShape& shape = in_shape[kv.second];
+    mxnet::TShape min_shape    = shape;
+    mxnet::TShape max_shape    = shape;
+    if (max_batch_size > 0 && shape.ndim() > 0) {
+      min_shape[0] = 1;
+      max_shape[0] = std::max<dim_t>(max_batch_size, shape[0]);
+    }
+    min_shape                     = TRTProfileShape(attrs, "min_shape_" + kv.first, min_shape);
+    max_shape                     = TRTProfileShape(attrs, "max_shape_" + kv.first, max_shape);
+    const mxnet::TShape opt_shape = TRTProfileShape(attrs, "opt_shape_" + kv.first, max_shape);
+    for (int i = 0; i < shape.ndim(); ++i) {
+      CHECK(min_shape[i] <= shape[i] && shape[i] <= max_shape[i] && min_shape[i] <= opt_shape[i] &&
+            opt_shape[i] <= max_shape[i])
+          << "The shape " << shape << " of input " << kv.first << " of " << attrs.name
+          << " is not in its optimization profile, from " << min_shape << " to " << max_shape
+          << " with opt " << opt_shape;
+      dynamic |= min_shape[i] != max_shape[i];
+    }
+    profile.push_back({kv.first,
+                       std::vector<int64_t>(min_shape.begin(), min_shape.end()),
+                       std::vector<int64_t>(opt_shape.begin(), opt_shape.end()),
+                       std::vector<int64_t>(max_shape.begin(), max_shape.end())});
+  }
+  if (!dynamic)
+    return {};
+  std::sort(profile.begin(), profile.end(), [](const auto& a, const auto& b) {
+    return a.name < b.name;
+  });
+  return profile;
+}
+
+/*!
+ * \brief the engine of an ONNX model and optimization profile on the current GPU. The engines are
+ *  shared by the subgraphs in the process, and loaded from MXNET_TENSORRT_ENGINE_CACHE_DIR, to
+ *  which the ones built are saved, when it is set.
+ */
+std::shared_ptr<TRTEngine> GetTRTEngine(
+    const std::string& onnx_graph,
+    const std::vector<onnx_to_tensorrt::TRTInputProfile>& profile,
+    uint32_t max_batch_size,
+    int dev_id) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<TRTEngine>> engines;
+  static const std::string cache_dir =
+      dmlc::GetEnv("MXNET_TENSORRT_ENGINE_CACHE_DIR", std::string());
+
+  // the key of an engine is the ONNX model, its profile, the GPU and the version of TensorRT
+  cudaDeviceProp props;
+  CUDA_CALL(cudaGetDeviceProperties(&props, dev_id));
+  std::ostringstream desc;
+  desc << props.name << " sm_" << props.major << props.minor << " TensorRT "
+       << getInferLibVersion() << " fp16 " << onnx_to_tensorrt::UseFp16() << " batch "
+       << max_batch_size;
+  for (const auto& p : profile) {
+    desc << " " << p.name << " " << mxnet::TShape(p.min.begin(), p.min.end())
+         << mxnet::TShape(p.opt.begin(), p.opt.end()) << mxnet::TShape(p.max.begin(), p.max.end());
+  }
+  size_t hash = std::hash<std::string>()(onnx_to_tensorrt::OnnxModelKey(onnx_graph));
+  hash        = dmlc::HashCombine(hash, desc.str());
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<TRTEngine> engine = engines[key.str()].lock();
+  if (engine)
+    return engine;
+  engine                 = std::make_shared<TRTEngine>();
+  const std::string path = cache_dir + "/trt_" + key.str() + ".engine";
+  std::ifstream cached;
+  if (!cache_dir.empty())
+    cached.open(path, std::ios::binary);
+  if (cached.is_open()) {
+    const std::string blob((std::istreambuf_iterator<char>(cached)),
+                           std::istreambuf_iterator<char>());
+    engine->trt_logger  = std::make_unique<onnx_to_tensorrt::TRT_Logger>();
+    engine->trt_runtime = onnx_to_tensorrt::InferObject(
+        nvinfer1::createInferRuntime(*engine->trt_logger));
+    nvinfer1::ICudaEngine* trt_engine =
+        engine->trt_runtime->deserializeCudaEngine(blob.data(), blob.size());
+    if (trt_engine != nullptr) {
+      engine->trt_engine.reset(trt_engine);
+    } else {
+      LOG(WARNING) << "Cannot load the TensorRT engine " << path << ", rebuilding it";
+    }
+  }
+  if (!engine->trt_engine) {
+    engine->trt_runtime.reset();
+    auto trt_tuple = onnx_to_tensorrt::onnxToTrtCtx(onnx_graph,
+                                                    max_batch_size,
+                                                    1 << 30,
+                                                    nvinfer1::ILogger::Severity::kWARNING,
+                                                    false,
+                                                    profile);
+    engine->trt_engine = std::move(std::get<0>(trt_tuple));
+    engine->trt_parser = std::move(std::get<1>(trt_tuple));
+    engine->trt_logger = std::move(std::get<2>(trt_tuple));
+    if (!cache_dir.empty()) {
+      // written to a temporary file first, as other processes may load the engine concurrently
+      const std::string tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+      auto serialized            = onnx_to_tensorrt::InferObject(engine->trt_engine->serialize());
+      std::ofstream out(tmp_path, std::ios::binary);
+      out.write(static_cast<const char*>(serialized->data()), serialized->size());
+      out.close();
+      if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LOG(WARNING) << "Cannot save the TensorRT engine to " << path;
+        std::remove(tmp_path.c_str());
+      }
+    }
+  }
+  engines[key.str()] = engine;
+  return engine;
+}
+
 OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
                           Context ctx,
                           const std::vector<TShape>& in_shape,
@@ -264,17 +421,29 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
   const auto& node_param = nnvm::get<TRTParam>(attrs.parsed);
   nnvm::Graph graph;
   graph.outputs           = attrs.subgraphs[0]->outputs;
-  uint32_t max_batch_size = dmlc::GetEnv("MXNET_TENSORRT_MAX_BATCH_SIZE", in_shape[0][0]);
-  if (max_batch_size < in_shape[0][0]) {
-    LOG(INFO) << "Warning: max batch size changed to be is: " << in_shape[0][0]
-              << " instead of: " << max_batch_size;
-    max_batch_size = in_shape[0][0];
-  }
+  const auto profile      = TRTProfile(attrs, in_shape);
+  uint32_t max_batch_size = in_shape[0][0];
+  for (const auto& p : profile)
+    max_batch_size = std::max<uint32_t>(max_batch_size, p.max[0]);
   std::unordered_map<std::string, NDArray> params_map = node_param.params_map;
   const auto& inputs_to_idx                           = node_param.inputs_to_idx;
   const auto& outputs_to_idx                          = node_param.outputs_to_idx;
   const auto& idx_g                                   = graph.indexed_graph();
   const auto& input_nids                              = idx_g.input_nodes();
+  // the shapes of the inputs at the bounds of the profile, the dimensions which vary between them
+  // are -1 in the ONNX model
+  mxnet::ShapeVector min_in_shape(in_shape.begin(), in_shape.end());
+  mxnet::ShapeVector max_in_shape(in_shape.begin(), in_shape.end());
+  mxnet::ShapeVector dynamic_in_shape(in_shape.begin(), in_shape.end());
+  for (const auto& p : profile) {
+    const uint32_t i = inputs_to_idx.at(p.name);
+    min_in_shape[i]  = mxnet::TShape(p.min.begin(), p.min.end());
+    max_in_shape[i]  = mxnet::TShape(p.max.begin(), p.max.end());
+    for (int d = 0; d < dynamic_in_shape[i].ndim(); ++d) {
+      if (p.min[d] != p.max[d])
+        dynamic_in_shape[i][d] = -1;
+    }
+  }
   mxnet::ShapeVector shape_inputs(input_nids.size());
   nnvm::DTypeVector dtype_inputs(input_nids.size());
   for (int i = 0; i < input_nids.size(); ++i) {
@@ -285,7 +454,7 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
       shape_inputs[i] = it_params->second.shape();
       dtype_inputs[i] = it_params->second.dtype();
     } else if (it_inputs != inputs_to_idx.end()) {
-      shape_inputs[i] = in_shape[it_inputs->second];
+      shape_inputs[i] = dynamic_in_shape[it_inputs->second];
       dtype_inputs[i] = in_type[it_inputs->second];
     } else {
       LOG(FATAL) << node->attrs.name << " attribute is missing for attributes inference";
@@ -297,6 +466,18 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
   nnvm::DTypeVector _in_type(in_type.begin(), in_type.end());
   TRTInferShape(attrs, &_in_shape, &out_shape);
   TRTInferType(attrs, &_in_type, &out_type);
+  if (!profile.empty()) {
+    mxnet::ShapeVector min_out_shape(graph.outputs.size());
+    mxnet::ShapeVector max_out_shape(graph.outputs.size());
+    TRTInferShape(attrs, &min_in_shape, &min_out_shape);
+    TRTInferShape(attrs, &max_in_shape, &max_out_shape);
+    for (size_t i = 0; i < out_shape.size(); ++i) {
+      for (int d = 0; d < out_shape[i].ndim(); ++d) {
+        if (min_out_shape[i][d] != max_out_shape[i][d])
+          out_shape[i][d] = -1;
+      }
+    }
+  }
   nnvm::DTypeVector dtypes(idx_g.num_node_entries());
   mxnet::ShapeVector shapes(idx_g.num_node_entries());
   for (int i = 0; i < graph.outputs.size(); ++i) {
@@ -309,12 +490,9 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
   graph.attrs["dtype"]        = std::make_shared<nnvm::any>(std::move(dtypes));
   graph.attrs["shape"]        = std::make_shared<nnvm::any>(std::move(shapes));
   auto onnx_graph             = op::nnvm_to_onnx::ConvertNnvmGraphToOnnx(graph, &params_map);
-  auto trt_tuple = ::onnx_to_tensorrt::onnxToTrtCtx(onnx_graph, max_batch_size, 1 << 30);
-  return OpStatePtr::Create<TRTEngineParam>(std::move(std::get<0>(trt_tuple)),
-                                            std::move(std::get<1>(trt_tuple)),
-                                            std::move(std::get<2>(trt_tuple)),
-                                            inputs_to_idx,
-                                            outputs_to_idx);
+  common::cuda::DeviceStore device_store(ctx.dev_id);
+  return OpStatePtr::Create<TRTEngineParam>(
+      GetTRTEngine(onnx_graph, profile, max_batch_size, ctx.dev_id), inputs_to_idx, outputs_to_idx);
 }
 
 NNVM_REGISTER_OP(_TensorRT)
@@ -58,6 +58,13 @@ void TRTCompute(const OpStatePtr& state,
     auto& p = param.binding_order->at(i);
     if (p.second == true) {
       param.bindings->at(i) = inputs[p.first].dptr_;
+      if (param.dynamic_bindings[i]) {
+        const TShape& shape = inputs[p.first].shape_;
+        nvinfer1::Dims dims;
+        dims.nbDims = shape.ndim();
+        std::copy(shape.begin(), shape.end(), dims.d);
+        param.trt_executor->setBindingDimensions(i, dims);
+      }
     } else {
       param.bindings->at(i) = outputs[p.first].dptr_;
     }
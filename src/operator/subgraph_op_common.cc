@@ -191,6 +191,18 @@ LoopState::LoopState(const nnvm::Symbol& g, bool is_dynamic) {
   this->subgraph_sym     = g;
   this->subgraph.outputs = g.outputs;
   this->iter_op          = LoopState::MakeSharedOp(g, is_dynamic);
+  this->static_op        = LoopState::MakeStaticOp(g);
+}
+
+CachedOpPtr LoopState::MakeStaticOp(const nnvm::Symbol& sym) {
+  if (!dmlc::GetEnv("MXNET_STATIC_LOOP_BODY", false))
+    return nullptr;
+  // A body with dynamic shape operators is found when it runs, and runs dynamically.
+  std::vector<std::pair<std::string, std::string> > kwargs = {
+      {"inline_limit", "0"}, {"static_alloc", "1"}, {"static_shape", "1"}, {"is_dynamic", "0"}};
+  if (dmlc::GetEnv("MXNET_STATIC_LOOP_BODY_CUDA_GRAPHS", false))
+    kwargs.push_back({"cuda_graphs", "1"});
+  return std::make_shared<CachedOp>(sym, kwargs);
 }
 
 void LoopState::Forward(int iter_no,
@@ -217,7 +229,9 @@ void LoopState::Forward(int iter_no,
     outputs[i] = &out_bufs[i];
   CHECK(inputs.size() > 0) << "loop forward requires at least 1 input";
   Context default_ctx = cinputs[0].ctx();
-  OpStatePtr state    = iter_op->Forward(nullptr, inputs, outputs, default_ctx);
+  const CachedOpPtr& op =
+      static_op != nullptr && !Imperative::Get()->is_recording() ? static_op : iter_op;
+  OpStatePtr state = op->Forward(nullptr, inputs, outputs, default_ctx);
   // If an input and an output share the array, the output array will be changed
   // by CachedOp. We need to copy data to the real output.
   for (size_t i = 0; i < out_bufs.size(); i++)
@@ -136,6 +136,8 @@ class LoopState {
   // which will be used in the backward.
   std::vector<OpStatePtr> all_states;
   CachedOpPtr iter_op;
+  // The iterations which are not recorded run the static op instead, when there is one.
+  CachedOpPtr static_op;
   nnvm::Symbol subgraph_sym;
   nnvm::Graph subgraph;
 
@@ -169,6 +171,14 @@ class LoopState {
     }
     return std::make_shared<CachedOp>(sym, kwargs);
   }
+  /*!
+   * \brief the op running the body of the iterations not recorded with MXNET_STATIC_LOOP_BODY,
+   *  null otherwise. It is static_shape: its memory is planned and its operators are bulked
+   *  into engine operations on the first iteration of an input shape, which the next
+   *  iterations push again. Its bulks are captured into CUDA graphs with
+   *  MXNET_STATIC_LOOP_BODY_CUDA_GRAPHS.
+   */
+  static CachedOpPtr MakeStaticOp(const nnvm::Symbol& sym);
 };
 
 }  // namespace op
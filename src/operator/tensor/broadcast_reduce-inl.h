@@ -39,8 +39,8 @@ namespace mxnet_op {
 template <int ndim, typename OP>
 struct binary_broadcast_kernel {
   /*! \brief Map function for binary_broadcast_kernel */
-  template <typename IType, typename DType>
-  MSHADOW_XINLINE static void Map(index_t base,
+  template <typename IType, typename DType, typename IndexType>
+  MSHADOW_XINLINE static void Map(IndexType base,
                                   index_t length,
                                   OpReqType req,
                                   const Shape<ndim>& lstride,
@@ -49,10 +49,15 @@ struct binary_broadcast_kernel {
                                   IType* lhs,
                                   IType* rhs,
                                   DType* out) {
+    IndexType lidx0, ridx0;
+    unravel_dot(base, oshape, lstride, rstride, &lidx0, &ridx0);
+    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx0], rhs[ridx0]));
+    // the GPU kernels map single elements, with the index of the size of out
+    if (length == 1)
+      return;
     Shape<ndim> coord = unravel(base, oshape);
-    auto lidx         = static_cast<index_t>(dot(coord, lstride));
-    auto ridx         = static_cast<index_t>(dot(coord, rstride));
-    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx], rhs[ridx]));
+    index_t lidx      = lidx0;
+    index_t ridx      = ridx0;
     // starts from 1 to avoid extra inc at end of loop
     for (index_t i = 1; i < length; ++i) {
       inc(&coord, oshape, &lidx, lstride, &ridx, rstride);
@@ -63,8 +68,8 @@ struct binary_broadcast_kernel {
   }
 
   /*! \brief Map function for binary_broadcast_kernel */
-  template <typename LType, typename RType, typename OType>
-  MSHADOW_XINLINE static void Map(index_t base,
+  template <typename LType, typename RType, typename OType, typename IndexType>
+  MSHADOW_XINLINE static void Map(IndexType base,
                                   index_t length,
                                   OpReqType req,
                                   const Shape<ndim>& lstride,
@@ -73,10 +78,15 @@ struct binary_broadcast_kernel {
                                   LType* lhs,
                                   RType* rhs,
                                   OType* out) {
+    IndexType lidx0, ridx0;
+    unravel_dot(base, oshape, lstride, rstride, &lidx0, &ridx0);
+    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx0], rhs[ridx0]));
+    // the GPU kernels map single elements, with the index of the size of out
+    if (length == 1)
+      return;
     Shape<ndim> coord = unravel(base, oshape);
-    auto lidx         = static_cast<index_t>(dot(coord, lstride));
-    auto ridx         = static_cast<index_t>(dot(coord, rstride));
-    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx], rhs[ridx]));
+    index_t lidx      = lidx0;
+    index_t ridx      = ridx0;
     // starts from 1 to avoid extra inc at end of loop
     for (index_t i = 1; i < length; ++i) {
       inc(&coord, oshape, &lidx, lstride, &ridx, rstride);
@@ -87,8 +97,8 @@ struct binary_broadcast_kernel {
   }
 
   /*! \brief Map function for binary_broadcast_kernel */
-  template <typename IType, typename DType>
-  MSHADOW_XINLINE static void Map(index_t base,
+  template <typename IType, typename DType, typename IndexType>
+  MSHADOW_XINLINE static void Map(IndexType base,
                                   index_t length,
                                   OpReqType req,
                                   const Shape<ndim>& lstride,
@@ -97,10 +107,15 @@ struct binary_broadcast_kernel {
                                   IType lhs,
                                   IType* rhs,
                                   DType* out) {
+    IndexType lidx0, ridx0;
+    unravel_dot(base, oshape, lstride, rstride, &lidx0, &ridx0);
+    KERNEL_ASSIGN(out[base], req, OP::Map(lhs, rhs[ridx0]));
+    // the GPU kernels map single elements, with the index of the size of out
+    if (length == 1)
+      return;
     Shape<ndim> coord = unravel(base, oshape);
-    auto lidx         = static_cast<index_t>(dot(coord, lstride));
-    auto ridx         = static_cast<index_t>(dot(coord, rstride));
-    KERNEL_ASSIGN(out[base], req, OP::Map(lhs, rhs[ridx]));
+    index_t lidx      = lidx0;
+    index_t ridx      = ridx0;
     // starts from 1 to avoid extra inc at end of loop
     for (index_t i = 1; i < length; ++i) {
       inc(&coord, oshape, &lidx, lstride, &ridx, rstride);
@@ -114,8 +129,9 @@ struct binary_broadcast_kernel {
   /* used for mixed type binary ops */
   template <typename IType,
             typename DType,
+            typename IndexType,
             typename std::enable_if<!std::is_same<IType, DType>::value, int>::type = 0>
-  MSHADOW_XINLINE static void Map(index_t base,
+  MSHADOW_XINLINE static void Map(IndexType base,
                                   index_t length,
                                   OpReqType req,
                                   const Shape<ndim>& lstride,
@@ -124,10 +140,15 @@ struct binary_broadcast_kernel {
                                   IType* lhs,
                                   DType* rhs,
                                   DType* out) {
+    IndexType lidx0, ridx0;
+    unravel_dot(base, oshape, lstride, rstride, &lidx0, &ridx0);
+    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx0], rhs[ridx0]));
+    // the GPU kernels map single elements, with the index of the size of out
+    if (length == 1)
+      return;
     Shape<ndim> coord = unravel(base, oshape);
-    auto lidx         = static_cast<index_t>(dot(coord, lstride));
-    auto ridx         = static_cast<index_t>(dot(coord, rstride));
-    KERNEL_ASSIGN(out[base], req, OP::Map(lhs[lidx], rhs[ridx]));
+    index_t lidx      = lidx0;
+    index_t ridx      = ridx0;
     // starts from 1 to avoid extra inc at end of loop
     for (index_t i = 1; i < length; ++i) {
       inc(&coord, oshape, &lidx, lstride, &ridx, rstride);
@@ -142,9 +163,10 @@ struct binary_broadcast_kernel {
   template <
       typename IType,
       typename DType,
+      typename IndexType,
       typename std::enable_if<!std::is_same<IType, DType>::value && !std::is_pointer<IType>::value,
                               int>::type = 0>
-  MSHADOW_XINLINE static void Map(index_t base,
+  MSHADOW_XINLINE static void Map(IndexType base,
                                   index_t length,
                                   OpReqType req,
                                   const Shape<ndim>& lstride,
@@ -153,10 +175,15 @@ struct binary_broadcast_kernel {
                                   IType lhs,
                                   DType* rhs,
                                   DType* out) {
+    IndexType lidx0, ridx0;
+    unravel_dot(base, oshape, lstride, rstride, &lidx0, &ridx0);
+    KERNEL_ASSIGN(out[base], req, OP::Map(lhs, rhs[ridx0]));
+    // the GPU kernels map single elements, with the index of the size of out
+    if (length == 1)
+      return;
     Shape<ndim> coord = unravel(base, oshape);
-    auto lidx         = static_cast<index_t>(dot(coord, lstride));
-    auto ridx         = static_cast<index_t>(dot(coord, rstride));
-    KERNEL_ASSIGN(out[base], req, OP::Map(lhs, rhs[ridx]));
+    index_t lidx      = lidx0;
+    index_t ridx      = ridx0;
     // starts from 1 to avoid extra inc at end of loop
     for (index_t i = 1; i < length; ++i) {
       inc(&coord, oshape, &lidx, lstride, &ridx, rstride);
@@ -214,6 +241,35 @@ struct csr_dns_csr_broadcast_kernel {
   }
 };
 
+template <int req, typename OP>
+struct rsp_dns_rsp_broadcast_kernel {
+  /*!
+   * \brief Map function for broadcast between the rows of a 2D rsp matrix and a dense matrix
+   * \param i           global thread id
+   * \param rsp_data    ptr to data buffer of rsp matrix
+   * \param rsp_idx     ptr to indices buffer of rsp matrix
+   * \param dns         ptr to data buffer of the dense matrix
+   * \param out         ptr to the data buffer of output rsp matrix
+   * \param num_cols    number of columns of the rsp matrix
+   * \param row_stride  stride of the rows of the dense matrix, 0 when they are broadcast
+   * \param col_stride  stride of the columns of the dense matrix, 0 when they are broadcast
+   */
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const DType* rsp_data,
+                                  const IType* rsp_idx,
+                                  const DType* dns,
+                                  DType* out,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t row_stride,
+                                  const nnvm::dim_t col_stride) {
+    const nnvm::dim_t row = i / num_cols;
+    const nnvm::dim_t col = i % num_cols;
+    KERNEL_ASSIGN(
+        out[i], req, OP::Map(rsp_data[i], dns[rsp_idx[row] * row_stride + col * col_stride]));
+  }
+};
+
 template <int req, typename OP, bool reverse = false>
 struct csr_dns_map_kernel {
   template <typename DType, typename CType, typename RType>
@@ -988,6 +1044,23 @@ void RTCReduce(const OpContext& ctx,
                const std::string& OP1,
                const std::string& OP2);
 
+/*!
+ * \brief Reduce an expression of lhs and rhs, which broadcast to big, over the elements
+ *  of big. The data of big is not read. func_code defines the AType accumulation type and
+ *  the FUNC macro, evaluated with the IType1::from(lhs[idx_lhs[u]]) and
+ *  IType2::from(rhs[idx_rhs[u]]) values of an element.
+ */
+void RTCReduceFunc(const OpContext& ctx,
+                   const TBlob& small,
+                   const OpReqType req,
+                   const Tensor<gpu, 1, char>& workspace,
+                   const TBlob& big,
+                   const TBlob& lhs,
+                   const TBlob& rhs,
+                   const std::string& reducer,
+                   int ndim,
+                   const std::string& func_code);
+
 #endif
 
 }  // namespace broadcast
@@ -2012,6 +2012,7 @@ Defined in )code";
       .set_attr_parser(ParamParser<ReduceAxisParam>)                \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceAxisShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>) \
+      .set_attr<FComputeCost>("FComputeCost", ReduceFlops)          \
       .add_argument("data", "NDArray-or-Symbol", "The input")       \
       .add_arguments(ReduceAxisParam::__FIELDS__())
 
@@ -2022,6 +2023,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)            \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>) \
+      .set_attr<FComputeCost>("FComputeCost", ReduceFlops)          \
       .add_argument("data", "NDArray-or-Symbol", "The input")       \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -2032,6 +2034,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)                  \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceMinMaxAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)       \
+      .set_attr<FComputeCost>("FComputeCost", ReduceFlops)                \
       .add_argument("data", "NDArray-or-Symbol", "The input")             \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -86,6 +86,31 @@ struct where_csr {
   }
 };
 
+/*! \brief Choose elements from x or y depending on condition.
+ * The condition is a rsp array of the shape of x and y, or a rsp vector
+ * whose size is the same as the x's first dim size, while x and y are both dense.
+ * i is for the i-th element of the rows of the output the condition stores
+ */
+template <int req>
+struct where_rsp {
+  // DType is the output data type
+  // CType is condition data type
+  template <typename DType, typename CType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const IType* cond_idx,
+                                  const CType* cond_data,
+                                  const nnvm::dim_t num_cols,
+                                  const bool batch,
+                                  const DType* x) {
+    const nnvm::dim_t row = i / num_cols;
+    if (cond_data[batch ? row : i] != 0) {
+      const nnvm::dim_t out_idx = cond_idx[row] * num_cols + i % num_cols;
+      KERNEL_ASSIGN(out[out_idx], req, x[out_idx]);
+    }
+  }
+};
+
 /*! \brief Choose elements from x or y depending on condition
  * The condition is a vector whose size is the same as the
  * x's first dim size.
@@ -251,9 +276,10 @@ inline bool WhereOpForwardStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFCompute);
   }
-  if (!dispatched && cond_stype == kCSRStorage && x_stype == kDefaultStorage &&
-      y_stype == kDefaultStorage) {
+  if (!dispatched && (cond_stype == kCSRStorage || cond_stype == kRowSparseStorage) &&
+      x_stype == kDefaultStorage && y_stype == kDefaultStorage) {
     // csr, dns, dns -> dns
+    // rsp, dns, dns -> dns
     dispatched =
         storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
@@ -370,6 +396,46 @@ void WhereOpForwardCsrImpl(mshadow::Stream<xpu>* s,
   });
 }
 
+template <typename xpu>
+void WhereOpForwardRspImpl(mshadow::Stream<xpu>* s,
+                           const NDArray& cond,
+                           const TBlob& x,
+                           const TBlob& y,
+                           const OpReqType req,
+                           const TBlob& out) {
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  if (out.Size() == 0 || req == kNullOp)
+    return;
+  const bool batch = cond.shape().ndim() == 1 && x.ndim() > 1;
+  CHECK(batch || cond.shape() == x.shape_)
+      << "WhereOpForwardRspImpl only supports conditions of the shape of the inputs or of their "
+         "first dim";
+  CHECK(req == kWriteInplace || req == kWriteTo)
+      << "WhereOpForwardRspImpl doesn't support req = " << req;
+  MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(cond.dtype(), CType, {
+      MSHADOW_IDX_TYPE_SWITCH(cond.aux_type(kIdx), IType, {
+        MXNET_ASSIGN_REQ_SWITCH(req, req_type, {
+          mshadow::Copy(out.FlatTo1D<xpu, DType>(s), y.FlatTo1D<xpu, DType>(s), s);
+          // no condition is satisfied
+          if (!cond.storage_initialized())
+            return;
+          const nnvm::dim_t num_cols = x.shape_.ProdShape(1, x.ndim());
+          Kernel<where_rsp<req_type>, xpu>::Launch(s,
+                                                   cond.aux_shape(kIdx).Size() * num_cols,
+                                                   out.dptr<DType>(),
+                                                   cond.aux_data(kIdx).dptr<IType>(),
+                                                   cond.data().dptr<CType>(),
+                                                   num_cols,
+                                                   batch,
+                                                   x.dptr<DType>());
+        });
+      });
+    });
+  });
+}
+
 template <typename xpu>
 void WhereOpForwardEx(const nnvm::NodeAttrs& attrs,
                       const OpContext& ctx,
@@ -384,11 +450,15 @@ void WhereOpForwardEx(const nnvm::NodeAttrs& attrs,
   const int y_stype       = inputs[2].storage_type();
   const auto& out_stype   = outputs[0].storage_type();
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-  CHECK_NE(inputs[0].shape().ndim(), 1) << "WhereOpForwardEx with 1-D cond is not implemented";
   if (cond_stype == kCSRStorage && x_stype == kDefaultStorage && y_stype == kDefaultStorage &&
       out_stype == kDefaultStorage) {
+    CHECK_NE(inputs[0].shape().ndim(), 1) << "WhereOpForwardEx with 1-D cond is not implemented";
     WhereOpForwardCsrImpl(
         s, inputs[0], inputs[1].data(), inputs[2].data(), req[0], outputs[0].data());
+  } else if (cond_stype == kRowSparseStorage && x_stype == kDefaultStorage &&
+             y_stype == kDefaultStorage && out_stype == kDefaultStorage) {
+    WhereOpForwardRspImpl(
+        s, inputs[0], inputs[1].data(), inputs[2].data(), req[0], outputs[0].data());
   } else {
     LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
   }
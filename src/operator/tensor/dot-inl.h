@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <utility>
 #include <type_traits>
+#include <limits>
 
 #include "./util/tensor_util-inl.h"
 #include "../mshadow_op.h"
@@ -40,6 +41,10 @@
 #ifdef __CUDACC__
 #include "./dot-inl.cuh"
 #endif  // __CUDACC__
+#if MSHADOW_USE_MKL == 1 && INTEL_MKL_VERSION >= 20170000 && !defined(__CUDACC__)
+#include <mkl_spblas.h>
+#define MXNET_USE_MKL_SPARSE_DOT 1
+#endif
 
 namespace mxnet {
 namespace op {
@@ -366,14 +371,21 @@ inline bool DotBackwardInferStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
+/*! \brief the number of output columns a block of dot(csr, dns1) = dns2 computes at once */
+constexpr nnvm::dim_t kDotCsrDnsColBlock = 512;
+
 /*!
  * \brief CPU Kernel of dot(csr, dns1) = dns2
- * Parallelization by row blocks
+ * Parallelization by blocks of rows with about the same number of non-zeros, times blocks
+ * of kDotCsrDnsColBlock columns, so that a skew of the row lengths does not leave threads
+ * idle and the columns of dns1 a block reads stay in cache.
  */
-struct DotCsrDnsDnsByRowBlocks {
+struct DotCsrDnsDnsByNnzBlocks {
   /*!
    * \brief
-   * \param i the i-th thread
+   * \param i the i-th block
+   * \param row_starts the first row of each row block, then the number of rows
+   * \param num_col_blocks the number of column blocks
    */
   template <typename DType, typename IType, typename CType>
   MSHADOW_CINLINE static void Map(int i,
@@ -382,23 +394,39 @@ struct DotCsrDnsDnsByRowBlocks {
                                   const IType* indptr_l,
                                   const CType* col_idx_l,
                                   const DType* data_r,
-                                  const nnvm::dim_t seg_len,
-                                  const nnvm::dim_t num_rows,
+                                  const nnvm::dim_t* row_starts,
+                                  const nnvm::dim_t num_col_blocks,
                                   const nnvm::dim_t num_cols) {
     using nnvm::dim_t;
-    const dim_t seg_start = i * seg_len;
-    if (seg_start >= num_rows)
-      return;
-    const dim_t seg_end = std::min(seg_start + seg_len, num_rows);
-    for (dim_t j = seg_start; j < seg_end; ++j) {
-      if (indptr_l[j] == indptr_l[j + 1])
-        continue;
-      const dim_t offset_out = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j + 1]; ++k) {
-        const DType val      = data_l[k];
-        const dim_t offset_r = col_idx_l[k] * num_cols;
-        for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out + l] += data_r[offset_r + l] * val;
+    const dim_t row_block = i / num_col_blocks;
+    const dim_t col_start = (i % num_col_blocks) * kDotCsrDnsColBlock;
+    const dim_t col_len   = std::min(kDotCsrDnsColBlock, num_cols - col_start);
+    const DType* r        = data_r + col_start;
+    for (dim_t j = row_starts[row_block]; j < row_starts[row_block + 1]; ++j) {
+      DType* o        = out + j * num_cols + col_start;
+      const IType end = indptr_l[j + 1];
+      IType k         = indptr_l[j];
+      // four non-zeros at a time, which loads and stores the outputs a quarter as often
+      for (; k + 4 <= end; k += 4) {
+        const DType v0  = data_l[k];
+        const DType v1  = data_l[k + 1];
+        const DType v2  = data_l[k + 2];
+        const DType v3  = data_l[k + 3];
+        const DType* r0 = r + col_idx_l[k] * num_cols;
+        const DType* r1 = r + col_idx_l[k + 1] * num_cols;
+        const DType* r2 = r + col_idx_l[k + 2] * num_cols;
+        const DType* r3 = r + col_idx_l[k + 3] * num_cols;
+#pragma omp simd
+        for (dim_t l = 0; l < col_len; ++l) {
+          o[l] += v0 * r0[l] + v1 * r1[l] + v2 * r2[l] + v3 * r3[l];
+        }
+      }
+      for (; k < end; ++k) {
+        const DType val = data_l[k];
+        const DType* r0 = r + col_idx_l[k] * num_cols;
+#pragma omp simd
+        for (dim_t l = 0; l < col_len; ++l) {
+          o[l] += val * r0[l];
         }
       }
     }
@@ -407,7 +435,9 @@ struct DotCsrDnsDnsByRowBlocks {
 
 /*!
  * \brief CPU Kernel of dot(csr.T(), dns1) = dns2
- * Parallelization by row blocks
+ * Parallelization by blocks of output rows, which are columns of the csr. The column
+ * indices of a csr row are sorted, so each block finds its columns in a row by binary
+ * search instead of reading all the non-zeros, and no two blocks write the same output.
  */
 struct DotCsrTransDnsDnsByRowBlocks {
   /*!
@@ -429,19 +459,17 @@ struct DotCsrTransDnsDnsByRowBlocks {
     const dim_t seg_start = i * seg_len;
     if (seg_start >= num_rows)
       return;
-    const dim_t seg_end = (i + 1) * seg_len;
+    const dim_t seg_end = std::min(seg_start + seg_len, num_rows);
     for (dim_t j = 0; j < num_rows_l; ++j) {
-      if (indptr_l[j] == indptr_l[j + 1])
-        continue;
-      const dim_t offset_r = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j + 1]; ++k) {
-        const CType col_idx = col_idx_l[k];
-        if (col_idx < seg_start || col_idx >= seg_end)
-          continue;
-        const dim_t offset_out = col_idx * num_cols;
-        const DType val        = data_l[k];
+      const CType* row_end = col_idx_l + indptr_l[j + 1];
+      const CType* col     = std::lower_bound(col_idx_l + indptr_l[j], row_end, seg_start);
+      const DType* r       = data_r + j * num_cols;
+      for (; col != row_end && *col < seg_end; ++col) {
+        DType* o        = out + *col * num_cols;
+        const DType val = data_l[col - col_idx_l];
+#pragma omp simd
         for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out + l] += data_r[offset_r + l] * val;
+          o[l] += val * r[l];
         }
       }
     }
@@ -804,6 +832,86 @@ struct DotDnsCsrTransDnsByRowBlocks {
   }
 };
 
+#if MXNET_USE_MKL_SPARSE_DOT
+inline sparse_status_t MKLSparseCreateCsr(sparse_matrix_t* a,
+                                          const MKL_INT rows,
+                                          const MKL_INT cols,
+                                          MKL_INT* indptr,
+                                          MKL_INT* col_idx,
+                                          float* data) {
+  return mkl_sparse_s_create_csr(
+      a, SPARSE_INDEX_BASE_ZERO, rows, cols, indptr, indptr + 1, col_idx, data);
+}
+
+inline sparse_status_t MKLSparseCreateCsr(sparse_matrix_t* a,
+                                          const MKL_INT rows,
+                                          const MKL_INT cols,
+                                          MKL_INT* indptr,
+                                          MKL_INT* col_idx,
+                                          double* data) {
+  return mkl_sparse_d_create_csr(
+      a, SPARSE_INDEX_BASE_ZERO, rows, cols, indptr, indptr + 1, col_idx, data);
+}
+
+inline sparse_status_t MKLSparseMM(const sparse_operation_t op,
+                                   const sparse_matrix_t a,
+                                   const float* b,
+                                   const MKL_INT cols,
+                                   const float beta,
+                                   float* c) {
+  matrix_descr descr;
+  descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+  return mkl_sparse_s_mm(op, 1.0f, a, descr, SPARSE_LAYOUT_ROW_MAJOR, b, cols, cols, beta, c, cols);
+}
+
+inline sparse_status_t MKLSparseMM(const sparse_operation_t op,
+                                   const sparse_matrix_t a,
+                                   const double* b,
+                                   const MKL_INT cols,
+                                   const double beta,
+                                   double* c) {
+  matrix_descr descr;
+  descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+  return mkl_sparse_d_mm(op, 1.0, a, descr, SPARSE_LAYOUT_ROW_MAJOR, b, cols, cols, beta, c, cols);
+}
+
+/*!
+ * \brief dot(csr, dns1) = dns2 or dot(csr.T, dns1) = dns2 with the sparse BLAS of MKL
+ * \return false if MKL cannot compute it, whose indices must have the size of MKL_INT
+ */
+template <typename DType, typename IType, typename CType>
+inline bool DotCsrDnsDnsMKL(const TBlob& data_l,
+                            const TBlob& indptr_l,
+                            const TBlob& col_idx_l,
+                            const mxnet::TShape& shape_l,
+                            const TBlob& data_r,
+                            const OpReqType req,
+                            const bool trans_lhs,
+                            const TBlob& data_out) {
+  const auto max_size = static_cast<nnvm::dim_t>(std::numeric_limits<MKL_INT>::max());
+  if (sizeof(IType) != sizeof(MKL_INT) || sizeof(CType) != sizeof(MKL_INT) ||
+      shape_l[0] > max_size || shape_l[1] > max_size || data_r.shape_[1] > max_size)
+    return false;
+  sparse_matrix_t a;
+  if (MKLSparseCreateCsr(&a,
+                         static_cast<MKL_INT>(shape_l[0]),
+                         static_cast<MKL_INT>(shape_l[1]),
+                         reinterpret_cast<MKL_INT*>(indptr_l.dptr<IType>()),
+                         reinterpret_cast<MKL_INT*>(col_idx_l.dptr<CType>()),
+                         data_l.dptr<DType>()) != SPARSE_STATUS_SUCCESS)
+    return false;
+  const sparse_status_t status =
+      MKLSparseMM(trans_lhs ? SPARSE_OPERATION_TRANSPOSE : SPARSE_OPERATION_NON_TRANSPOSE,
+                  a,
+                  data_r.dptr<DType>(),
+                  static_cast<MKL_INT>(data_r.shape_[1]),
+                  DType(req == kAddTo ? 1 : 0),
+                  data_out.dptr<DType>());
+  mkl_sparse_destroy(a);
+  return status == SPARSE_STATUS_SUCCESS;
+}
+#endif  // MXNET_USE_MKL_SPARSE_DOT
+
 /*!
  * \brief CPU Impl of dot(csr, dns1) = dns2 and dot(csr.T, dns1) = dns2
  */
@@ -834,22 +942,18 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
   MSHADOW_SGL_DBL_TYPE_SWITCH(data_l.type_flag_, DType, {     // data type
     MSHADOW_IDX_TYPE_SWITCH(indptr_l.type_flag_, IType, {     // indptr type
       MSHADOW_IDX_TYPE_SWITCH(col_idx_l.type_flag_, CType, {  // col idx type
-        dim_t num_threads;
+#if MXNET_USE_MKL_SPARSE_DOT
+        if (DotCsrDnsDnsMKL<DType, IType, CType>(
+                data_l, indptr_l, col_idx_l, lhs.shape(), data_r, req, trans_lhs, data_out))
+          return;
+#endif  // MXNET_USE_MKL_SPARSE_DOT
         if (kWriteTo == req) {
-          num_threads = data_out.Size();
-          mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(s, num_threads, data_out.dptr<DType>());
-        }
-        num_threads                        = mxnet_op::get_num_threads<cpu>(data_out.shape_[0]);
-        bool dynamic                       = false;
-        const dim_t large_matrix_threshold = 1024 * 10;
-        if (data_out.shape_[0] > large_matrix_threshold) {
-          dynamic = true;
-          // each unit of work processes at least 1024 elements in the output
-          const dim_t unit_work_per_thread = 1024;
-          num_threads                      = data_out.Size() / unit_work_per_thread;
+          mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(
+              s, data_out.Size(), data_out.dptr<DType>());
         }
-        dim_t seg_len = (data_out.shape_[0] + num_threads - 1) / num_threads;
+        const dim_t num_threads = mxnet_op::get_num_threads<cpu>(data_out.shape_[0]);
         if (trans_lhs) {
+          const dim_t seg_len = (data_out.shape_[0] + num_threads - 1) / num_threads;
           mxnet_op::Kernel<DotCsrTransDnsDnsByRowBlocks, cpu>::Launch(s,
                                                                       num_threads,
                                                                       data_out.dptr<DType>(),
@@ -862,29 +966,30 @@ inline void DotCsrDnsDnsImpl(const OpContext& ctx,
                                                                       data_out.shape_[0],
                                                                       data_out.shape_[1]);
         } else {
-          if (dynamic) {
-            mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::LaunchDynamic(s,
-                                                                          num_threads,
-                                                                          data_out.dptr<DType>(),
-                                                                          data_l.dptr<DType>(),
-                                                                          indptr_l.dptr<IType>(),
-                                                                          col_idx_l.dptr<CType>(),
-                                                                          data_r.dptr<DType>(),
-                                                                          seg_len,
-                                                                          data_out.shape_[0],
-                                                                          data_out.shape_[1]);
-          } else {
-            mxnet_op::Kernel<DotCsrDnsDnsByRowBlocks, cpu>::Launch(s,
-                                                                   num_threads,
-                                                                   data_out.dptr<DType>(),
-                                                                   data_l.dptr<DType>(),
-                                                                   indptr_l.dptr<IType>(),
-                                                                   col_idx_l.dptr<CType>(),
-                                                                   data_r.dptr<DType>(),
-                                                                   seg_len,
-                                                                   data_out.shape_[0],
-                                                                   data_out.shape_[1]);
+          // a few blocks per thread, which the dynamic schedule balances further
+          const dim_t num_rows       = data_out.shape_[0];
+          const dim_t num_col_blocks = (data_out.shape_[1] + kDotCsrDnsColBlock - 1) /
+                                       kDotCsrDnsColBlock;
+          const dim_t num_row_blocks = std::max<dim_t>(
+              1, std::min(num_rows, (4 * num_threads + num_col_blocks - 1) / num_col_blocks));
+          const IType* indptr = indptr_l.dptr<IType>();
+          const dim_t nnz     = indptr[num_rows];
+          std::vector<dim_t> row_starts(num_row_blocks + 1, num_rows);
+          for (dim_t b = 0; b < num_row_blocks; ++b) {
+            const IType first = static_cast<IType>(nnz * b / num_row_blocks);
+            row_starts[b]     = std::lower_bound(indptr, indptr + num_rows, first) - indptr;
           }
+          mxnet_op::Kernel<DotCsrDnsDnsByNnzBlocks, cpu>::LaunchDynamic(s,
+                                                                        num_row_blocks *
+                                                                            num_col_blocks,
+                                                                        data_out.dptr<DType>(),
+                                                                        data_l.dptr<DType>(),
+                                                                        indptr,
+                                                                        col_idx_l.dptr<CType>(),
+                                                                        data_r.dptr<DType>(),
+                                                                        row_starts.data(),
+                                                                        num_col_blocks,
+                                                                        data_out.shape_[1]);
         }
       });
     });
@@ -1562,6 +1667,27 @@ inline bool BatchDotShape(const nnvm::NodeAttrs& attrs,
   return shape_is_known((*out_attrs)[0]);
 }
 
+/*! \brief FComputeCost of dot, a multiply-add per output and element of the inner dimension */
+inline uint64_t DotFlops(const nnvm::NodeAttrs& attrs,
+                         const mxnet::ShapeVector& in_shapes,
+                         const mxnet::ShapeVector& out_shapes) {
+  const DotParam& param    = nnvm::get<DotParam>(attrs.parsed);
+  const mxnet::TShape& lhs = in_shapes[0];
+  const uint64_t k         = param.transpose_a ? lhs[0] : lhs[lhs.ndim() - 1];
+  return 2 * out_shapes[0].Size() * k;
+}
+
+/*! \brief FComputeCost of batch_dot */
+inline uint64_t BatchDotFlops(const nnvm::NodeAttrs& attrs,
+                              const mxnet::ShapeVector& in_shapes,
+                              const mxnet::ShapeVector& out_shapes) {
+  const DotParam& param    = nnvm::get<DotParam>(attrs.parsed);
+  const mxnet::TShape& lhs = in_shapes[0];
+  const int ndim           = lhs.ndim();
+  const uint64_t k         = param.transpose_a ? lhs[ndim - 2] : lhs[ndim - 1];
+  return 2 * out_shapes[0].Size() * k;
+}
+
 }  // namespace op
 }  // namespace mxnet
 namespace std {
@@ -88,6 +88,7 @@ above patterns, ``dot`` will fallback and generate output with default storage.
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", DotShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FComputeCost>("FComputeCost", DotFlops)
     .set_attr<FInferStorageType>("FInferStorageType", DotForwardInferStorageType)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
@@ -165,6 +166,7 @@ which is computed by::
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", BatchDotShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
+    .set_attr<FComputeCost>("FComputeCost", BatchDotFlops)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
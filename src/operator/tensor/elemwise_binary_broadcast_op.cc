@@ -61,7 +61,9 @@ __global__ void binary_broadcast_kernel(
     const index_t N,
     const index_t num_aligned_elements) {
   using namespace vector;
-  const index_t M = num_aligned_elements * other_dim;
+  const index_type M = static_cast<index_type>(num_aligned_elements * other_dim);
+  const index_type num_aligned = static_cast<index_type>(num_aligned_elements);
+  const index_type lead = static_cast<index_type>(lead_dim);
 
   VectorizedLoader<InputType0, nvec, aligned> lloader(
     reinterpret_cast<const InputType0*>(param.inputs[0]), param.size[0]);
@@ -73,16 +75,16 @@ __global__ void binary_broadcast_kernel(
   using OType = AccType<OutputType0>;
 
 
-  for (index_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  for (index_type idx = blockIdx.x * blockDim.x + threadIdx.x;
        idx < M;
        idx += gridDim.x * blockDim.x) {
     OutputType0 * current_output_pointer;
     index_t output_size;
-    index_t output_idx;
+    index_type output_idx;
     if (aligned) {
       // Simplified case
-      index_t lindex, rindex;
-      util::unravel_dot<ndim>(idx * nvec, param.oshape,
+      index_type lindex, rindex;
+      util::unravel_dot<index_type, ndim>(idx * nvec, param.oshape,
                               param.stride[0], param.stride[1],
                               &lindex, &rindex);
       lloader.load(lindex / nvec, param.size[0]);
@@ -91,19 +93,19 @@ __global__ void binary_broadcast_kernel(
       output_size = N;
       output_idx = idx;
     } else {
-      const index_t row = idx / num_aligned_elements;
-      const index_t lead_dim_idx = idx - row * num_aligned_elements;
-
-      index_t lindex, rindex;
-      const index_t original_idx = max(lead_dim_idx * nvec - lloader.alignment(),
-                                       static_cast<index_t>(0)) +
-                                   row * lead_dim;
-      util::unravel_dot<ndim>(original_idx, param.oshape,
+      const index_type row = idx / num_aligned;
+      const index_type lead_dim_idx = idx - row * num_aligned;
+
+      index_type lindex, rindex;
+      const index_type original_idx = max(lead_dim_idx * nvec - lloader.alignment(),
+                                          static_cast<index_type>(0)) +
+                                      row * lead;
+      util::unravel_dot<index_type, ndim>(original_idx, param.oshape,
                               param.stride[0], param.stride[1],
                               &lindex, &rindex);
       lloader.load((lindex + lloader.alignment()) / nvec, param.size[0]);
       rloader.load((rindex + lloader.alignment()) / nvec, param.size[1]);
-      current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead_dim;
+      current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead;
       output_size = lead_dim;
       output_idx = lead_dim_idx;
     }
@@ -146,7 +148,9 @@ __global__ void single_side_binary_broadcast_kernel(
     const index_t N,
     const index_t num_aligned_elements) {
   using namespace vector;
-  const index_t M = num_aligned_elements * other_dim;
+  const index_type M = static_cast<index_type>(num_aligned_elements * other_dim);
+  const index_type num_aligned = static_cast<index_type>(num_aligned_elements);
+  const index_type lead = static_cast<index_type>(lead_dim);
   constexpr int other_side = 1 - side;
 
   VectorizedLoader<DType, nvec, aligned> lloader(
@@ -157,34 +161,35 @@ __global__ void single_side_binary_broadcast_kernel(
   using OType = AccType<OutputType0>;
 
 
-  for (index_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  for (index_type idx = blockIdx.x * blockDim.x + threadIdx.x;
        idx < M;
        idx += gridDim.x * blockDim.x) {
-    index_t original_idx;
+    index_type original_idx;
     OutputType0 * current_output_pointer;
     index_t output_size;
-    index_t output_idx;
+    index_type output_idx;
     if (aligned) {
       // Simplified case
       original_idx = idx * nvec;
-      const index_t lindex = util::unravel_dot<ndim>(original_idx, param.oshape,
-                                                     param.stride[side]);
+      const index_type lindex = util::unravel_dot<index_type, ndim>(original_idx, param.oshape,
+                                                                    param.stride[side]);
       lloader.load(lindex / nvec, param.size[side]);
       current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]);
       output_size = N;
       output_idx = idx;
     } else {
-      const index_t row = idx / num_aligned_elements;
-      const index_t lead_dim_idx = idx - row * num_aligned_elements;
+      const index_type row = idx / num_aligned;
+      const index_type lead_dim_idx = idx - row * num_aligned;
       original_idx = lead_dim_idx * nvec -
-                     lloader.alignment() + row * lead_dim;
-      const index_t original_idx_clamped = max(lead_dim_idx * nvec - lloader.alignment(),
-                                               static_cast<index_t>(0)) +
-                                           row * lead_dim;
-      const index_t lindex = util::unravel_dot<ndim>(original_idx_clamped, param.oshape,
-                                                     param.stride[side]);
+                     lloader.alignment() + row * lead;
+      const index_type original_idx_clamped = max(lead_dim_idx * nvec - lloader.alignment(),
+                                                  static_cast<index_type>(0)) +
+                                              row * lead;
+      const index_type lindex = util::unravel_dot<index_type, ndim>(original_idx_clamped,
+                                                                    param.oshape,
+                                                                    param.stride[side]);
       lloader.load((lindex + lloader.alignment()) / nvec, param.size[side]);
-      current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead_dim;
+      current_output_pointer = reinterpret_cast<OutputType0*>(param.outputs[0]) + row * lead;
       output_size = lead_dim;
       output_idx = lead_dim_idx;
     }
@@ -195,11 +200,12 @@ __global__ void single_side_binary_broadcast_kernel(
     }
 #pragma unroll
     for (int i = 0; i < nvec; ++i) {
-      const index_t rindex = min(max(util::unravel_dot<ndim>(original_idx + i,
-                                                             param.oshape,
-                                                             param.stride[other_side]),
-                                     static_cast<index_t>(0)),
-                                 param.size[other_side] - 1);
+      const index_type rindex =
+        min(max(util::unravel_dot<index_type, ndim>(original_idx + i,
+                                                    param.oshape,
+                                                    param.stride[other_side]),
+                static_cast<index_type>(0)),
+            static_cast<index_type>(param.size[other_side] - 1));
       const auto rinput = IType2::from(
                             reinterpret_cast<const DType2*>(param.inputs[other_side])
                             [rindex]);
@@ -319,7 +325,11 @@ void BinaryBroadcastRTCCompute::operator()(const nnvm::NodeAttrs& attrs,
                        OP +
                        "\n"
                        "const int ndim = " +
-                       std::to_string(ndim) + ";\n";
+                       std::to_string(ndim) +
+                       ";\n"
+                       "using index_type = " +
+                       (mxnet_op::UseInt32Index(output.shape_.Size()) ? "int32" : "index_t") +
+                       ";\n";
     if (common_shape != 1) {
       VectorizedKernelRTCLauncher(code,
                                   "binary_broadcast_kernel",
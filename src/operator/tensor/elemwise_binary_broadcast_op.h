@@ -98,6 +98,10 @@ inline bool BinaryBroadcastMulStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(&out_stype, kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
+  if (!dispatched && lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage) {
+    dispatched = storage_type_assign(
+        &out_stype, kRowSparseStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
   if (!dispatched) {
     dispatched = dispatch_fallback(out_attrs, dispatch_mode);
   }
@@ -460,6 +464,54 @@ void BinaryBroadcastCsrDnsCsrImpl(const OpContext& ctx,
   }
 }
 
+/*! \brief broadcast between the rows of a 2D rsp matrix and a dense matrix, vector or scalar */
+template <typename xpu, typename OP>
+void BinaryBroadcastRspDnsRspImpl(const OpContext& ctx,
+                                  const NDArray& rsp,
+                                  const NDArray& dns,
+                                  const OpReqType req,
+                                  const NDArray& output) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  CHECK(req == kWriteTo || req == kWriteInplace);
+  CHECK_EQ(rsp.shape().ndim(), 2U) << "broadcast between row_sparse and dense arrays only "
+                                      "supports 2D row_sparse arrays";
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (!rsp.storage_initialized()) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  const nnvm::dim_t num_rows = rsp.shape()[0];
+  const nnvm::dim_t num_cols = rsp.shape()[1];
+  const nnvm::dim_t dns_rows = dns.shape().ndim() == 2 ? dns.shape()[0] : 1;
+  const nnvm::dim_t dns_cols = dns.shape().ndim() > 0 ? dns.shape()[dns.shape().ndim() - 1] : 1;
+  CHECK((dns_rows == 1 || dns_rows == num_rows) && (dns_cols == 1 || dns_cols == num_cols))
+      << "cannot broadcast " << dns.shape() << " to " << rsp.shape();
+  const nnvm::dim_t nz_rows = rsp.aux_shape(kIdx).Size();
+  const bool in_place       = output.IsSame(rsp);
+  if (!in_place)
+    output.CheckAndAlloc({Shape1(nz_rows)});
+  MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
+    MSHADOW_IDX_TYPE_SWITCH(rsp.aux_type(kIdx), IType, {
+      if (!in_place) {
+        Kernel<op_with_req<mshadow_op::identity, kWriteTo>, xpu>::Launch(
+            s, nz_rows, output.aux_data(kIdx).dptr<IType>(), rsp.aux_data(kIdx).dptr<IType>());
+      }
+      Kernel<rsp_dns_rsp_broadcast_kernel<kWriteTo, OP>, xpu>::Launch(
+          s,
+          nz_rows * num_cols,
+          rsp.data().dptr<DType>(),
+          rsp.aux_data(kIdx).dptr<IType>(),
+          dns.data().dptr<DType>(),
+          output.data().dptr<DType>(),
+          num_cols,
+          dns_rows == 1 ? 0 : dns_cols,
+          dns_cols == 1 ? 0 : 1);
+    });
+  });
+}
+
 template <typename xpu, typename OP>
 void BinaryBroadcastCsrDnsDnsImpl(const OpContext& ctx,
                                   const NDArray& csr,
@@ -570,6 +622,12 @@ void BinaryBroadcastComputeSparseEx(const nnvm::NodeAttrs& attrs,
   const auto lhs_stype = lhs.storage_type();
   const auto rhs_stype = rhs.storage_type();
   const auto out_stype = out.storage_type();
+  if (lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage &&
+      out_stype == kRowSparseStorage) {
+    // broadcast(RSP, Dense) = RSP
+    BinaryBroadcastRspDnsRspImpl<xpu, OP>(ctx, lhs, rhs, req[0], out);
+    return;
+  }
   // If the input is a matrix with the same shape, should be elemwise
   if ((rhs.shape().ndim() != 1U) && (rhs.shape()[0] != 1) && (rhs.shape()[1] != 1)) {
     if (lhs_stype == kCSRStorage && rhs_stype == kDefaultStorage && out_stype == kCSRStorage) {
@@ -761,6 +819,7 @@ void BinaryBroadcastBackwardUseIn(const nnvm::NodeAttrs& attrs,
                                        })                                                         \
       .set_attr<mxnet::FInferShape>("FInferShape", BinaryBroadcastShape)                          \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)                               \
+      .set_attr<FComputeCost>("FComputeCost", ElemwiseFlops)                                      \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                           \
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
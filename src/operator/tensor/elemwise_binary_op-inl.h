@@ -747,6 +747,95 @@ void ElemwiseBinaryOp::DnsRspDnsOp(mshadow::Stream<xpu>* s,
   });
 }
 
+/*!
+ * \brief Kernel for performing elemwise op between the rows of a rsp tensor and the same rows
+ *        of a dense tensor
+ * \param i            global thread id
+ * \param out          data array of rsp output
+ * \param dns_data     data array of dense input
+ * \param rsp_data     data array of rsp input
+ * \param rsp_indices  indices array of rsp input
+ * \param num_cols     number of columns of both inputs
+ */
+template <int req, typename OP, bool reverse>
+struct ElemwiseRspDnsRspKernel {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* dns_data,
+                                  const DType* rsp_data,
+                                  const IType* rsp_indices,
+                                  const nnvm::dim_t num_cols) {
+    const nnvm::dim_t rsp_idx = i / num_cols;
+    const nnvm::dim_t col     = i % num_cols;
+    const DType dns_value     = dns_data[rsp_indices[rsp_idx] * num_cols + col];
+    KERNEL_ASSIGN(out[i],
+                  req,
+                  reverse ? OP::Map(rsp_data[i], dns_value) : OP::Map(dns_value, rsp_data[i]));
+  }
+};
+
+/*! \brief RSP -op- DNS binary operator with a rsp result, for the ops whose zeros stay zeros */
+template <typename xpu, typename OP>
+void ElemwiseBinaryOp::RspDnsRspOp(mshadow::Stream<xpu>* s,
+                                   const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const NDArray& dns,
+                                   const NDArray& rsp,
+                                   const OpReqType req,
+                                   const NDArray& output,
+                                   const bool reverse) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  CHECK_EQ(dns.storage_type(), kDefaultStorage);
+  CHECK_EQ(rsp.storage_type(), kRowSparseStorage);
+  CHECK_EQ(output.storage_type(), kRowSparseStorage);
+  CHECK_EQ(output.shape(), dns.shape());
+  CHECK(req == kWriteTo || req == kWriteInplace) << "RspDnsRspOp only supports kWriteTo and "
+                                                    "kWriteInplace";
+  if (!rsp.storage_initialized()) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  const nnvm::dim_t nz_rows  = rsp.aux_shape(rowsparse::kIdx).Size();
+  const nnvm::dim_t num_cols = dns.shape()[0] > 0 ? dns.data().Size() / dns.shape()[0] : 0;
+  const bool in_place        = output.IsSame(rsp);
+  if (!in_place)
+    output.CheckAndAlloc({Shape1(nz_rows)});
+  const TBlob rsp_data    = rsp.data();
+  const TBlob rsp_indices = rsp.aux_data(rowsparse::kIdx);
+  MSHADOW_TYPE_SWITCH(rsp_data.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(rsp_indices.type_flag_, IType, {
+      if (!in_place) {
+        Kernel<op_with_req<mshadow_op::identity, kWriteTo>, xpu>::Launch(
+            s,
+            nz_rows,
+            output.aux_data(rowsparse::kIdx).dptr<IType>(),
+            rsp_indices.dptr<IType>());
+      }
+      if (reverse) {
+        Kernel<ElemwiseRspDnsRspKernel<kWriteTo, OP, true>, xpu>::Launch(
+            s,
+            nz_rows * num_cols,
+            output.data().dptr<DType>(),
+            dns.data().dptr<DType>(),
+            rsp_data.dptr<DType>(),
+            rsp_indices.dptr<IType>(),
+            num_cols);
+      } else {
+        Kernel<ElemwiseRspDnsRspKernel<kWriteTo, OP, false>, xpu>::Launch(
+            s,
+            nz_rows * num_cols,
+            output.data().dptr<DType>(),
+            dns.data().dptr<DType>(),
+            rsp_data.dptr<DType>(),
+            rsp_indices.dptr<IType>(),
+            num_cols);
+      }
+    });
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -290,6 +290,17 @@ class ElemwiseBinaryOp : public OpBase {
                           const NDArray& output,
                           const bool reverse);
 
+  /*! \brief RSP -op- DNS binary operator producing the rows of the rsp input */
+  template <typename xpu, typename OP>
+  static void RspDnsRspOp(mshadow::Stream<xpu>* s,
+                          const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const NDArray& lhs,
+                          const NDArray& rhs,
+                          OpReqType req,
+                          const NDArray& output,
+                          const bool reverse);
+
  public:
   /*!
    * \brief Rsp-op-Rsp operation which produces a dense result
@@ -349,7 +360,8 @@ class ElemwiseBinaryOp : public OpBase {
                         (lhs_stype == kDefaultStorage && rhs_stype == kRowSparseStorage))) {
       // rsp, dns -> rsp
       // dns, rsp -> rsp
-      dispatched = storage_type_assign(&out_stype, kRowSparseStorage, dispatch_mode, dispatch_ex);
+      dispatched = storage_type_assign(
+          &out_stype, kRowSparseStorage, dispatch_mode, DispatchMode::kFComputeEx);
     }
     if (!dispatched && ((lhs_stype == kCSRStorage && rhs_stype == kDefaultStorage) ||
                         (lhs_stype == kDefaultStorage && rhs_stype == kCSRStorage))) {
@@ -660,7 +672,18 @@ class ElemwiseBinaryOp : public OpBase {
     const auto lhs_stype = inputs[0].storage_type();
     const auto rhs_stype = inputs[1].storage_type();
     const auto out_stype = outputs[0].storage_type();
-    if ((out_stype == kRowSparseStorage || out_stype == kDefaultStorage) &&
+    if (out_stype == kRowSparseStorage && req[0] != kAddTo &&
+        ((lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage && rhs_may_be_dense) ||
+         (lhs_stype == kDefaultStorage && rhs_stype == kRowSparseStorage && lhs_may_be_dense))) {
+      // rsp, dns -> rsp
+      // dns, rsp -> rsp
+      // computed on the rows of the rsp input only
+      const bool reverse      = lhs_stype == kRowSparseStorage;
+      const NDArray& dns      = reverse ? inputs[1] : inputs[0];
+      const NDArray& rsp      = reverse ? inputs[0] : inputs[1];
+      mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+      RspDnsRspOp<xpu, OP>(s, attrs, ctx, dns, rsp, req[0], outputs[0], reverse);
+    } else if ((out_stype == kRowSparseStorage || out_stype == kDefaultStorage) &&
         ((lhs_stype == kRowSparseStorage && rhs_stype == kRowSparseStorage) ||
          (lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage) ||
          (lhs_stype == kDefaultStorage && rhs_stype == kRowSparseStorage)) &&
@@ -699,6 +722,28 @@ class ElemwiseBinaryOp : public OpBase {
     }
   }
 
+  /*! \brief ComputeEx with a rsp result for rsp -op- dns, for the ops whose zero lhs is zero */
+  template <typename xpu, typename OP>
+  static void ComputeRspDnsEx(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<NDArray>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<NDArray>& outputs) {
+    CHECK_EQ(inputs.size(), 2);
+    CHECK_EQ(outputs.size(), 1);
+    if (req[0] == kNullOp)
+      return;
+    if (inputs[0].storage_type() == kRowSparseStorage &&
+        inputs[1].storage_type() == kDefaultStorage &&
+        outputs[0].storage_type() == kRowSparseStorage && req[0] != kAddTo) {
+      // rsp, dns -> rsp
+      mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+      RspDnsRspOp<xpu, OP>(s, attrs, ctx, inputs[1], inputs[0], req[0], outputs[0], true);
+    } else {
+      ComputeEx<xpu, OP>(attrs, ctx, inputs, req, outputs);
+    }
+  }
+
   template <typename xpu, typename LOP, typename ROP>
   static inline void BackwardUseNone(const nnvm::NodeAttrs& attrs,
                                      const OpContext& ctx,
@@ -788,6 +833,7 @@ class ElemwiseBinaryOp : public OpBase {
                                        })                                                         \
       .set_attr<mxnet::FInferShape>("FInferShape", ElemwiseShape<2, 1>)                           \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)                               \
+      .set_attr<FComputeCost>("FComputeCost", ElemwiseFlops)                                      \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                           \
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
@@ -265,13 +265,40 @@ NNVM_REGISTER_OP(_backward_mul)
         "FComputeEx<cpu>",
         ElemwiseBinaryOp::BackwardUseInEx<cpu, mshadow_op::right, mshadow_op::left>);
 
-MXNET_OPERATOR_REGISTER_BINARY_WITH_SPARSE_CPU_DR(elemwise_div, op::mshadow_op::div)
+static inline bool ElemwiseDivStorageType(const nnvm::NodeAttrs& attrs,
+                                          const int dev_mask,
+                                          DispatchMode* dispatch_mode,
+                                          std::vector<int>* in_attrs,
+                                          std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  // rsp, dns -> rsp, on the rows of the rsp input
+  if (in_attrs->at(0) == kRowSparseStorage && in_attrs->at(1) == kDefaultStorage &&
+      storage_type_assign(
+          &out_attrs->at(0), kRowSparseStorage, dispatch_mode, DispatchMode::kFComputeEx)) {
+    return true;
+  }
+  return ElemwiseBinaryOp::SparseSparseWithDenseResult(
+      attrs, dev_mask, dispatch_mode, in_attrs, out_attrs);
+}
+
+MXNET_OPERATOR_REGISTER_BINARY(elemwise_div)
 MXNET_ADD_SPARSE_OP_ALIAS(elemwise_div)
     .describe(R"code(Divides arguments element-wise.
 
-The storage type of ``elemwise_div`` output is always dense
+The storage type of ``elemwise_div`` output depends on storage types of inputs
+
+   - elemwise_div(row_sparse, default) = row_sparse
+   - otherwise, ``elemwise_div`` generates output with default storage
+
+The rows missing from the row_sparse output of ``elemwise_div(row_sparse, default)`` are zeros,
+including those divided by zero.
 
 )code")
+    .set_attr<FInferStorageType>("FInferStorageType", ElemwiseDivStorageType)
+    .set_attr<FCompute>("FCompute<cpu>", ElemwiseBinaryOp::Compute<cpu, op::mshadow_op::div>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>",
+                          ElemwiseBinaryOp::ComputeRspDnsEx<cpu, op::mshadow_op::div>)
     .add_alias("_div")
     .add_alias("_Div")
     .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_div"});
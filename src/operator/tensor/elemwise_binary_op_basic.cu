@@ -278,7 +278,10 @@ NNVM_REGISTER_OP(elemwise_mul)
 NNVM_REGISTER_OP(_backward_mul)
     .set_attr<FCompute>("FCompute<gpu>", ElemwiseBinaryRTCBwdUseIn{"right", "left"});
 
-NNVM_REGISTER_OP(elemwise_div).set_attr<FCompute>("FCompute<gpu>", ElemwiseBinaryRTCCompute{"div"});
+NNVM_REGISTER_OP(elemwise_div)
+    .set_attr<FCompute>("FCompute<gpu>", ElemwiseBinaryRTCCompute{"div"})
+    .set_attr<FComputeEx>("FComputeEx<gpu>",
+                          ElemwiseBinaryOp::ComputeRspDnsEx<gpu, op::mshadow_op::div>);
 
 NNVM_REGISTER_OP(_backward_div)
     .set_attr<FCompute>("FCompute<gpu>", ElemwiseBinaryRTCBwdUseIn{"div_grad", "div_rgrad"});
@@ -414,6 +414,79 @@ void TakeOpForward<cpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*!
+ * \brief the row_sparse gradient of the weight of Embedding from the sorted indices, with a
+ *  workspace proportional to the size of the data instead of the number of rows of the weight
+ */
+inline void SparseEmbeddingOpBackwardSortedRspImpl(const OpContext& ctx,
+                                                   const TBlob& ograd,
+                                                   const TBlob& data,
+                                                   const NDArray& output) {
+  using namespace mshadow;
+  using namespace rowsparse;
+  using nnvm::dim_t;
+  Stream<cpu>* s         = ctx.get_stream<cpu>();
+  const dim_t num_rows   = output.shape()[0];
+  const dim_t row_length = output.shape()[1];
+  const dim_t data_size  = static_cast<dim_t>(data.shape_.Size());
+  if (data_size == 0) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  // sorted indices, followed by the positions of the sorted indices in the data
+  Tensor<cpu, 1, dim_t> workspace =
+      ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, dim_t>(Shape1(data_size * 2), s);
+  dim_t* sorted_idx = workspace.dptr_;
+  dim_t* order      = workspace.dptr_ + data_size;
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    const IType* data_ptr = data.dptr<IType>();
+    CHECK(CheckIndexOutOfBound(data_ptr, data_size, IType(0), static_cast<IType>(num_rows - 1)))
+        << "Embedding input contains data out of bound";
+    for (dim_t i = 0; i < data_size; ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order, order + data_size, [data_ptr](dim_t a, dim_t b) {
+      return data_ptr[a] < data_ptr[b];
+    });
+    for (dim_t i = 0; i < data_size; ++i) {
+      sorted_idx[i] = static_cast<dim_t>(data_ptr[order[i]]);
+    }
+  });
+  const dim_t nnr = std::unique(sorted_idx, sorted_idx + data_size) - sorted_idx;
+  output.CheckAndAlloc({Shape1(nnr)});
+  MSHADOW_SGL_DBL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(output.aux_type(kIdx), RType, {
+      MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+        RType* grad_row_idx    = output.aux_data(kIdx).dptr<RType>();
+        DType* grad_data       = output.data().dptr<DType>();
+        const DType* ograd_ptr = ograd.dptr<DType>();
+        const IType* data_ptr  = data.dptr<IType>();
+        const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+        for (dim_t i = 0; i < nnr; ++i) {
+          grad_row_idx[i] = static_cast<RType>(sorted_idx[i]);
+          // the positions of the index in the data are the run of order starting at lower_bound
+          dim_t j = std::lower_bound(order,
+                                     order + data_size,
+                                     sorted_idx[i],
+                                     [data_ptr](dim_t pos, dim_t idx) {
+                                       return static_cast<dim_t>(data_ptr[pos]) < idx;
+                                     }) -
+                    order;
+          DType* grad_row = grad_data + i * row_length;
+          std::fill_n(grad_row, row_length, DType(0));
+          for (; j < data_size && static_cast<dim_t>(data_ptr[order[j]]) == sorted_idx[i]; ++j) {
+            const DType* ograd_row = ograd_ptr + order[j] * row_length;
+            for (dim_t k = 0; k < row_length; ++k) {
+              grad_row[k] += ograd_row[k];
+            }
+          }
+        }
+      });
+    });
+  });
+}
+
 template <>
 inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
                                                   const OpContext& ctx,
@@ -431,10 +504,15 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
   CHECK_EQ(req, kWriteTo) << "SparseEmbedding layer doesn't support "
                           << "weight gradient calculation with req != write";
 
+  Stream<cpu>* s   = ctx.get_stream<cpu>();
+  dim_t num_rows   = output.shape()[0];
+  dim_t row_length = output.shape()[1];
+  if (static_cast<dim_t>(data.shape_.Size()) < num_rows / 8) {
+    // the row flags of the huge id spaces, e.g. hashed ids, would not fit in memory
+    SparseEmbeddingOpBackwardSortedRspImpl(ctx, ograd, data, output);
+    return;
+  }
   // Request temporary storage for marking non-zero rows and prefix sum
-  Stream<cpu>* s        = ctx.get_stream<cpu>();
-  dim_t num_rows        = output.shape()[0];
-  dim_t row_length      = output.shape()[1];
   size_t workspace_size = num_rows * sizeof(dim_t);
   Tensor<cpu, 1, char> workspace =
       ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(Shape1(workspace_size), s);
@@ -661,7 +739,10 @@ Examples::
                             [ 10.,  11.,  12.,  13.,  14.]]]
 
 
-The storage type of weight can be either row_sparse or default.
+The storage type of weight can be either row_sparse or default. A row_sparse weight only needs
+the rows looked up, the others are zeros, so input_dim can be far larger than the rows in memory,
+e.g. the 64-bit hashed ids of the rows pulled from a kvstore with ``row_sparse_pull``. The data
+must then be of an integer type which holds the ids exactly, such as int64.
 
 .. Note::
 
@@ -686,7 +767,9 @@ The storage type of weight can be either row_sparse or default.
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
                                 })
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .set_attr<FInferStorageType>("FInferStorageType", EmbeddingOpForwardStorageType)
     .set_attr<FCompute>("FCompute<cpu>", EmbeddingOpForward<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", EmbeddingOpForwardEx<cpu>)
     .set_attr<nnvm::FGradient>(
         "FGradient",
         [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
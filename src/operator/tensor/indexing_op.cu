@@ -63,59 +63,36 @@ struct AddTakeGradRspGPUKernel {
 };
 
 /*
- * \brief kernel for backward computation for take, executed with deterministic order
- * \param thread_id the thread id
- * \param out the output gradient data
- * \param lookup_table the table to lookup the position of an id in gradient array
- * \param sorted_data the sorted data input
+ * \brief kernel for backward computation for take, executed with deterministic order. Each warp
+ *  sums the head gradients of a run of the same index in the sorted data, the lanes covering
+ *  the features, and writes the row of the run in the row_sparse gradient.
+ * \param out the output gradient data, one row per run
+ * \param run_ends the end of each run in the sorted data
+ * \param num_runs the number of runs, the number of rows of out
  * \param original_idx the original indices of the sorted data input
  * \param ograd head gradient
  * \param row_length the output dimension
- * \param num_threads_per_row the number of threads to process a row together
- * \param SZ the number of features a thread is responsible for
  */
-template <int SZ>
-struct AddTakeGradRspDeterministicKernel {
-  template <typename DType>
-  __device__ __forceinline__ static void Map(int thread_id,
-                                             DType* out,
-                                             const nnvm::dim_t* lookup_table,
-                                             const nnvm::dim_t* sorted_data,
-                                             const nnvm::dim_t data_size,
-                                             const nnvm::dim_t* original_idx,
-                                             const DType* ograd,
-                                             const nnvm::dim_t row_length,
-                                             const nnvm::dim_t num_threads_per_row) {
-    using nnvm::dim_t;
-    int tid                 = thread_id / num_threads_per_row;
-    const int feature_start = thread_id % num_threads_per_row * SZ;
-    int num_features        = SZ;
-    if (feature_start + num_features > row_length) {
-      num_features = row_length - feature_start;
-    }
-    if (tid == 0 || sorted_data[tid - 1] != sorted_data[tid]) {
-      DType acc[SZ];
-#pragma unroll
-      for (int i = 0; i < SZ; i++) {
-        acc[i] = 0;
-      }
-      const dim_t data       = sorted_data[tid];
-      const dim_t row_id     = lookup_table[data];
-      const dim_t out_offset = row_id * row_length + feature_start;
-      do {
-        const dim_t idx          = original_idx[tid];
-        const dim_t ograd_offset = idx * row_length + feature_start;
-        for (int i = 0; i < num_features; i++) {
-          acc[i] += ograd[ograd_offset + i];
-        }
-        tid++;
-      } while (tid < data_size && sorted_data[tid - 1] == sorted_data[tid]);
-      for (int i = 0; i < num_features; i++) {
-        out[out_offset + i] += acc[i];
-      }
-    }
+template <typename AType, typename DType>
+__global__ void AddTakeGradRspDeterministicKernel(DType* out,
+                                                  const nnvm::dim_t* run_ends,
+                                                  const nnvm::dim_t num_runs,
+                                                  const nnvm::dim_t* original_idx,
+                                                  const DType* ograd,
+                                                  const nnvm::dim_t row_length) {
+  using nnvm::dim_t;
+  const dim_t run = static_cast<dim_t>(blockIdx.x) * blockDim.y + threadIdx.y;
+  if (run >= num_runs)
+    return;
+  const dim_t begin = run == 0 ? 0 : run_ends[run - 1];
+  const dim_t end   = run_ends[run];
+  for (dim_t f = threadIdx.x; f < row_length; f += blockDim.x) {
+    AType acc = 0;
+    for (dim_t j = begin; j < end; ++j)
+      acc += static_cast<AType>(ograd[original_idx[j] * row_length + f]);
+    out[run * row_length + f] = static_cast<DType>(acc);
   }
-};
+}
 
 template <bool clip = true>
 struct TakeZeroAxisGPU {
@@ -252,41 +229,46 @@ void SparseEmbeddingDeterministicKernelLaunch(const OpContext& ctx,
   const dim_t num_rows    = output.shape()[0];
   const dim_t row_length  = output.shape()[1];
   const dim_t data_size   = static_cast<dim_t>(data.shape_.Size());
+  cudaStream_t stream     = Stream<gpu>::GetStream(s);
   // temp resource declarations
-  dim_t* lookup_table = nullptr;
   void* temp_storage  = nullptr;
   dim_t* sorted_data  = nullptr;
   dim_t* original_idx = nullptr;
-  // calculate number of bytes for temp resources
-  size_t lookup_table_bytes         = num_rows * sizeof(dim_t);
+  dim_t* run_ends     = nullptr;
+  dim_t* num_runs     = nullptr;
+  // calculate number of bytes for temp resources, none depends on the number of rows so that
+  // the rows not referenced by data are never touched
   size_t sorted_data_storage_bytes  = data_size * sizeof(dim_t);
   size_t original_idx_storage_bytes = data_size * sizeof(dim_t);
+  size_t run_ends_storage_bytes     = (data_size + 1) * sizeof(dim_t);
   size_t sort_workspace_size        = SortByKeyWorkspaceSize<dim_t, dim_t, gpu>(data_size);
-  size_t unique_workspace_bytes     = 0;
-  // estimate unique temp space
-  IType* data_ptr  = data.dptr<IType>();
-  size_t* null_ptr = nullptr;
-  // unique operations will be applied on sorted data
-  cub::DeviceSelect::Unique(nullptr,
-                            unique_workspace_bytes,
-                            sorted_data,
-                            sorted_data,
-                            null_ptr,
-                            data_size,
-                            Stream<gpu>::GetStream(s));
-  // One more space reserved for unique count
-  size_t temp_workspace_bytes = std::max(unique_workspace_bytes, sort_workspace_size);
-  size_t total_storage_bytes  = lookup_table_bytes + sorted_data_storage_bytes +
-                               original_idx_storage_bytes + temp_workspace_bytes;
+  size_t encode_workspace_bytes     = 0;
+  size_t scan_workspace_bytes       = 0;
+  RType* null_row_idx               = nullptr;
+  // the runs of the same index are encoded, then their lengths summed to their ends
+  cub::DeviceRunLengthEncode::Encode(nullptr,
+                                     encode_workspace_bytes,
+                                     sorted_data,
+                                     null_row_idx,
+                                     run_ends,
+                                     num_runs,
+                                     data_size,
+                                     stream);
+  cub::DeviceScan::InclusiveSum(
+      nullptr, scan_workspace_bytes, run_ends, run_ends, data_size, stream);
+  size_t temp_workspace_bytes =
+      std::max(sort_workspace_size, std::max(encode_workspace_bytes, scan_workspace_bytes));
+  size_t total_storage_bytes = sorted_data_storage_bytes + original_idx_storage_bytes +
+                               run_ends_storage_bytes + temp_workspace_bytes;
 
   // request resource and split it. layout is:
-  // lookup_table, sorted_data, original_idx, temp_storage
+  // sorted_data, original_idx, run_ends and num_runs, temp_storage
   Tensor<gpu, 1, char> workspace =
       ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(total_storage_bytes), s);
-  lookup_table = reinterpret_cast<dim_t*>(workspace.dptr_);
-  sorted_data  = reinterpret_cast<dim_t*>(workspace.dptr_ + lookup_table_bytes);
-  original_idx =
-      reinterpret_cast<dim_t*>(workspace.dptr_ + lookup_table_bytes + sorted_data_storage_bytes);
+  sorted_data  = reinterpret_cast<dim_t*>(workspace.dptr_);
+  original_idx = sorted_data + data_size;
+  run_ends     = original_idx + data_size;
+  num_runs     = run_ends + data_size;
   temp_storage = workspace.dptr_ + total_storage_bytes - temp_workspace_bytes;
 
   // check out-of-bound indices
@@ -316,47 +298,37 @@ void SparseEmbeddingDeterministicKernelLaunch(const OpContext& ctx,
   SortByKey(sorted_data_tensor, original_idx_tensor, true, &temp_storage_tensor, 0, num_bits);
 
   // compute unique row ids based on sorted values.
-  output.CheckAndAllocAuxData(kIdx, Shape1(data_size + 1));
+  output.CheckAndAllocAuxData(kIdx, Shape1(data_size));
 
-  // fill row_idx array of output matrix, using the row_flg values
+  // fill row_idx array of output matrix with the indices of the runs, and their lengths
   RType* grad_row_idx = output.aux_data(kIdx).dptr<RType>();
-  cub::DeviceSelect::Unique(temp_storage_ptr,
-                            unique_workspace_bytes,
-                            sorted_data,
-                            grad_row_idx,
-                            grad_row_idx + data_size,
-                            data_size,
-                            Stream<gpu>::GetStream(s));
+  cub::DeviceRunLengthEncode::Encode(temp_storage_ptr,
+                                     encode_workspace_bytes,
+                                     sorted_data,
+                                     grad_row_idx,
+                                     run_ends,
+                                     num_runs,
+                                     data_size,
+                                     stream);
 
   dim_t nnr = 0;
-  CUDA_CALL(cudaMemcpyAsync(&nnr,
-                            grad_row_idx + data_size,
-                            sizeof(RType),
-                            cudaMemcpyDeviceToHost,
-                            mshadow::Stream<gpu>::GetStream(s)));
-  CUDA_CALL(cudaStreamSynchronize(mshadow::Stream<gpu>::GetStream(s)));
+  CUDA_CALL(cudaMemcpyAsync(&nnr, num_runs, sizeof(dim_t), cudaMemcpyDeviceToHost, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
   CHECK_EQ(output.shape().ndim(), 2) << "Unexcepted ndim";
   output.CheckAndAllocData(Shape2(nnr, output.shape()[1]));
   output.set_aux_shape(kIdx, Shape1(nnr));
-
-  // generate lookup table
-  Kernel<MarkLookupTable, gpu>::Launch(s, nnr, lookup_table, grad_row_idx);
-
-  // accumulate gradients
-  DType* grad_data = output.data().dptr<DType>();
-  Fill<false>(s, TBlob(grad_data, Shape1(nnr * row_length), gpu::kDevMask), kWriteTo, 0);
-  const int SZ                          = 4;
-  const nnvm::dim_t num_threads_per_row = (row_length + SZ - 1) / SZ;
-  Kernel<AddTakeGradRspDeterministicKernel<SZ>, gpu>::Launch(s,
-                                                             data_size * num_threads_per_row,
-                                                             grad_data,
-                                                             lookup_table,
-                                                             sorted_data,
-                                                             data_size,
-                                                             original_idx,
-                                                             ograd.dptr<DType>(),
-                                                             row_length,
-                                                             num_threads_per_row);
+  cub::DeviceScan::InclusiveSum(
+      temp_storage_ptr, scan_workspace_bytes, run_ends, run_ends, nnr, stream);
+
+  // sum the gradients of each run, which writes every element of the gradient data once
+  using AType              = typename mxnet_op::AccType<DType>::type;
+  DType* grad_data         = output.data().dptr<DType>();
+  const int runs_per_block = 4;
+  const dim3 block(32, runs_per_block);
+  const dim3 grid((nnr + runs_per_block - 1) / runs_per_block);
+  AddTakeGradRspDeterministicKernel<AType><<<grid, block, 0, stream>>>(
+      grad_data, run_ends, nnr, original_idx, ograd.dptr<DType>(), row_length);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(AddTakeGradRspDeterministicKernel);
 }
 
 inline void SparseEmbeddingOpBackwardDeterministicRspImpl(const OpContext& ctx,
@@ -394,7 +366,9 @@ inline void SparseEmbeddingOpBackwardRspImpl<gpu>(const bool deterministic,
                                                   const TBlob& data,
                                                   const OpReqType req,
                                                   const NDArray& output) {
-  if (deterministic) {
+  // the sorting implementation does not mark the rows of the weight, which would not fit in
+  // memory for the huge id spaces, e.g. hashed ids
+  if (deterministic || static_cast<nnvm::dim_t>(data.shape_.Size()) < output.shape()[0] / 8) {
     SparseEmbeddingOpBackwardDeterministicRspImpl(ctx, ograd, data, req, output);
     return;
   }
@@ -940,7 +914,9 @@ void EmbeddingOpBackward<gpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
-NNVM_REGISTER_OP(Embedding).set_attr<FCompute>("FCompute<gpu>", EmbeddingOpForward<gpu>);
+NNVM_REGISTER_OP(Embedding)
+    .set_attr<FCompute>("FCompute<gpu>", EmbeddingOpForward<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", EmbeddingOpForwardEx<gpu>);
 
 NNVM_REGISTER_OP(_backward_Embedding)
     .set_attr<FCompute>("FCompute<gpu>", EmbeddingOpBackward<gpu>)
@@ -182,6 +182,34 @@ inline bool EmbeddingOpType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+// storage type inference function for Embedding
+inline bool EmbeddingOpForwardStorageType(const nnvm::NodeAttrs& attrs,
+                                          const int dev_mask,
+                                          DispatchMode* dispatch_mode,
+                                          std::vector<int>* in_attrs,
+                                          std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const int& data_stype   = in_attrs->at(embedding::kData);
+  const int& weight_stype = in_attrs->at(embedding::kWeight);
+  int& out_stype          = out_attrs->at(embedding::kOut);
+  bool dispatched         = false;
+  if (!dispatched && data_stype == kDefaultStorage && weight_stype == kDefaultStorage) {
+    // dns, dns -> dns
+    dispatched =
+        storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFCompute);
+  }
+  if (!dispatched && data_stype == kDefaultStorage && weight_stype == kRowSparseStorage) {
+    // dns, rsp -> dns, the rows of the weight are looked up without densifying it
+    dispatched =
+        storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
+  if (!dispatched) {
+    dispatched = dispatch_fallback(out_attrs, dispatch_mode);
+  }
+  return dispatched;
+}
+
 // storage type inference function for _backward_Embedding
 inline bool EmbeddingOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
                                            const int dev_mask,
@@ -231,9 +259,11 @@ struct TakeNonzeroAxis {
    * \param idx_ndims   # of dims of indices tensor
    * \param axis_dim    dim size of the axis dimension
    * \param axis        axis id
+   * The output indices are computed in the type of i, int32_t on GPU for the outputs fitting it,
+   * and the input index in index_t, as the input can be larger than the output.
    */
-  template <typename DType, typename IType>
-  MSHADOW_XINLINE static void Map(index_t i,
+  template <typename DType, typename IType, typename IndexType>
+  MSHADOW_XINLINE static void Map(IndexType i,
                                   DType* out_data,
                                   const DType* in_data,
                                   const IType* idx,
@@ -246,10 +276,12 @@ struct TakeNonzeroAxis {
                                   const int axis_dim,
                                   const int axis) {
     // i is the global flattened index in the output
-    const index_t out_head_index = i / out_prev_stride;
-    const index_t out_rest_index = i % out_prev_stride;
-    const index_t out_mid_index  = out_rest_index / in_stride;
-    const index_t out_tail_index = (axis == in_ndims - 1) ? 0 : (out_rest_index % in_stride);
+    const IndexType out_stride     = static_cast<IndexType>(out_prev_stride);
+    const IndexType stride         = static_cast<IndexType>(in_stride);
+    const IndexType out_head_index = i / out_stride;
+    const IndexType out_rest_index = i % out_stride;
+    const IndexType out_mid_index  = out_rest_index / stride;
+    const IndexType out_tail_index = (axis == in_ndims - 1) ? 0 : (out_rest_index % stride);
     index_t idx_index            = static_cast<index_t>(idx[out_mid_index]);
     if (clip) {
       idx_index = (idx_index < 0) ? 0 : idx_index;
@@ -258,8 +290,8 @@ struct TakeNonzeroAxis {
       idx_index %= axis_dim;
       idx_index += (idx_index < 0) ? axis_dim : 0;
     }
-    const index_t in_tail_index = out_tail_index;
-    const index_t in_head_index = out_head_index;
+    const index_t in_tail_index = static_cast<index_t>(out_tail_index);
+    const index_t in_head_index = static_cast<index_t>(out_head_index);
     index_t in_src_index        = in_tail_index + idx_index * in_stride;
     in_src_index += in_head_index * in_prev_stride;
     out_data[i] = in_data[in_src_index];
@@ -391,6 +423,28 @@ void EmbeddingOpForward(const nnvm::NodeAttrs& attrs,
                                  outputs[embedding::kOut]);
 }
 
+template <typename xpu>
+void EmbeddingOpForwardEx(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<NDArray>& outputs) {
+  CHECK_EQ(req[embedding::kOut], kWriteTo);
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  const NDArray& data   = inputs[embedding::kData];
+  const NDArray& weight = inputs[embedding::kWeight];
+  const NDArray& out    = outputs[embedding::kOut];
+  if (data.storage_type() == kDefaultStorage && weight.storage_type() == kRowSparseStorage &&
+      out.storage_type() == kDefaultStorage) {
+    // dns, rsp -> dns
+    SparseEmbeddingOpForwardRspImpl<xpu>(
+        ctx, data.data(), weight, req[embedding::kOut], out.data());
+  } else {
+    LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
+  }
+}
+
 /*! \brief cast to type and clip to range [0, K - 1]
  */
 struct tcast_clip {
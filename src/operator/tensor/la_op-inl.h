@@ -452,16 +452,19 @@ struct gelqf {
     // From here on, we work on Q only
     // Reserve workspace
     // The size is determined by workspace queries, done on the first items
-    // of the batch
+    // of the batch. Batches of small matrices are processed in parallel on
+    // CPU, each thread with its own workspace.
     int ws_size(linalg_gelqf_workspace_query(Q[0], s));
-    Tensor<xpu, 1, DType> work =
-        ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(ws_size), s);
+    const int nthreads(linalg_batch_omp_threads<xpu>(A.size(0), Q.size(2)));
+    Tensor<xpu, 2, DType> works =
+        ctx.requested[0].get_space_typed<xpu, 2, DType>(Shape2(nthreads, ws_size), s);
     // Loop over items in batch
     linalg_check_batch_size(A.size(0), Q.size(0), L.size(0));
     int m = Q.size(1);  // Q[i] has shape (m, n)
-    for (index_t i = 0; i < A.size(0); ++i) {
-      const Tensor<xpu, 2, DType>& Qi = Q[i];
-      const Tensor<xpu, 2, DType>& Li = L[i];
+    linalg_batch_for(A.size(0), nthreads, [&](index_t i, int thread) {
+      const Tensor<xpu, 1, DType>& work = works[thread];
+      const Tensor<xpu, 2, DType>& Qi   = Q[i];
+      const Tensor<xpu, 2, DType>& Li   = L[i];
       // Call gelqf: Overwrites Qi and part of work. Afterwards, L matrix is
       // in lower triangle of Qi
       linalg_gelqf(Qi, work, s);
@@ -476,7 +479,7 @@ struct gelqf {
       // Call orglq: Input is Qi and part of work. Overwrites Qi by final Q
       // matrix (conversion from internal representation)
       linalg_orglq(Qi, work, s);
-    }
+    });
   }
 };
 
@@ -525,12 +528,9 @@ struct syevd {
       Copy(U, A, s);
     // From here on, we work on U only
     // Reserve workspace (size determined by query)
-    IndexT lwork(linalg_syevd_workspace_query(U[0], L[0], s));
+    IndexT lwork(linalg_batch_syevd_workspace_query(U, L, s));
     Tensor<xpu, 1, DType> work = ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(lwork), s);
-    // Loop over items in batch
-    for (index_t i = 0; i < U.size(0); ++i) {
-      linalg_syevd(U[i], L[i], work, s);
-    }
+    linalg_batch_syevd(U, L, work, s);
     // Set signs of eigenvectors in a deterministic way
     using namespace mxnet_op;
     Kernel<SyevdEigenVecSigns, xpu>::Launch(
@@ -38,6 +38,7 @@
 #include "./init_op.h"
 #include "../../common/static_array.h"
 #include "./slice-inl.h"
+#include "./transpose_cpu.h"
 
 #if MXNET_USE_CUDA
 #include <thrust/device_vector.h>
@@ -374,6 +375,11 @@ bool TransposeCommonImpl(RunContext ctx,
     });
     return true;
   }
+  // The CPU transposes collapse their dimensions and go through tiles, but for the sums
+  if (ctx.get_ctx().dev_mask() == cpu::kDevMask && !is_addto) {
+    TransposeCPU(src.dptr_, ret.dptr_, src.shape_, axes, mshadow::mshadow_sizeof(ret.type_flag_));
+    return true;
+  }
   // Handle the general transpose case
   MSHADOW_TYPE_SWITCH(ret.type_flag_, DType, {
     switch (axes.ndim()) {
@@ -699,14 +705,13 @@ inline bool SliceForwardInferStorageType(const nnvm::NodeAttrs& attrs,
   auto& out_stype         = out_attrs->at(0);
   bool dispatched         = false;
   const auto dispatch_ex  = DispatchMode::kFComputeEx;
-  // If step = 1, no need to fallback; otherwise fallback to dense
-  bool trivial_step = false;
-  if (param.step.ndim() == 0U) {
-    trivial_step = true;
-  } else if (param.step.ndim() == 1U &&
-             (!param.step[0].has_value() || param.step[0].value() == 1)) {
-    trivial_step = true;
-  }
+  // If step = 1, no need to fallback. The csr arrays are sliced with a step on their rows on cpu,
+  // and fallback to dense otherwise.
+  auto unit_step = [&param](int axis) {
+    return axis >= param.step.ndim() || !param.step[axis].has_value() ||
+           param.step[axis].value() == 1;
+  };
+  const bool csr_step = unit_step(1) && (unit_step(0) || dev_mask == Context::kCPU);
 
   if (in_stype == kDefaultStorage) {
 #if MXNET_USE_ONEDNN == 1
@@ -720,7 +725,7 @@ inline bool SliceForwardInferStorageType(const nnvm::NodeAttrs& attrs,
     }
   }
 
-  if (!dispatched && in_stype == kCSRStorage && trivial_step) {
+  if (!dispatched && in_stype == kCSRStorage && csr_step) {
     dispatched = storage_type_assign(&out_stype, kCSRStorage, dispatch_mode, dispatch_ex);
   }
 
@@ -1486,6 +1491,18 @@ inline void GetSliceAxisParams(const SliceAxisParam& param,
   CHECK(*begin >= 0) << "Invalid begin for begin=" << param.begin;
 }
 
+/*! \brief the output of slice_axis is contiguous when the axes before axis have one element */
+inline std::vector<std::pair<int, size_t>> SliceAxisViewOutputs(const nnvm::NodeAttrs& attrs,
+                                                                const mxnet::TShape& ishape) {
+  const SliceAxisParam& param = nnvm::get<SliceAxisParam>(attrs.parsed);
+  int axis;
+  index_t begin, end;
+  GetSliceAxisParams(param, ishape, &axis, &begin, &end);
+  if (ishape.ProdShape(0, axis) != 1)
+    return {};
+  return {{0, begin * ishape.ProdShape(axis + 1, ishape.ndim())}};
+}
+
 inline bool SliceAxisShape(const nnvm::NodeAttrs& attrs,
                            mxnet::ShapeVector* in_attrs,
                            mxnet::ShapeVector* out_attrs) {
@@ -1527,6 +1544,11 @@ void SliceAxis(const nnvm::NodeAttrs& attrs,
   index_t begin, end;
   GetSliceAxisParams(param, inputs[0].shape_, &axis, &begin, &end);
   int ndim = outputs[0].ndim();
+  if (inputs[0].shape_.ProdShape(0, axis) == 1 &&
+      IsViewOutput(inputs[0],
+                   outputs[0],
+                   begin * inputs[0].shape_.ProdShape(axis + 1, inputs[0].ndim())))
+    return;
 
   if (axis + 1 == ndim) {
     MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
@@ -3246,6 +3268,23 @@ struct ConcatenateKernel {
   }
 };
 
+/*! \brief the outputs of split are contiguous when the axes before axis have one element */
+inline std::vector<std::pair<int, size_t>> SplitViewOutputs(const nnvm::NodeAttrs& attrs,
+                                                            const mxnet::TShape& ishape) {
+  const SplitParam& param = nnvm::get<SplitParam>(attrs.parsed);
+  const int axis          = param.axis < 0 ? param.axis + ishape.ndim() : param.axis;
+  if (ishape.ProdShape(0, axis) != 1)
+    return {};
+  const mxnet::TShape split_pts =
+      (param.sections > 0) ? GetSplitIndices(ishape, axis, param.sections) : param.indices;
+  const int num_outputs = (param.sections > 0) ? param.sections : param.indices.ndim();
+  const size_t trailing = ishape.ProdShape(axis + 1, ishape.ndim());
+  std::vector<std::pair<int, size_t>> views;
+  for (int i = 0; i < num_outputs; ++i)
+    views.emplace_back(i, split_pts[i] * trailing);
+  return views;
+}
+
 template <typename xpu>
 inline void SplitOpForwardImpl(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
@@ -3281,6 +3320,13 @@ inline void SplitOpForwardImpl(const nnvm::NodeAttrs& attrs,
     indices.push_back(ishape[real_axis]);
   }
   workspace_size += indices.size() * sizeof(size_t);
+  if (leading == 1) {
+    bool views = true;
+    for (size_t i = 0; i < outputs.size(); ++i)
+      views = views && IsViewOutput(input_data, outputs[i], indices[i] * trailing);
+    if (views)
+      return;
+  }
   MSHADOW_TYPE_SWITCH(input_data.type_flag_, DType, {
     std::vector<DType*> output_data;
     for (const TBlob& data : outputs) {
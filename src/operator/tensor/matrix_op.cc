@@ -97,6 +97,98 @@ void SliceDimTwoCsrImpl<cpu>(const mxnet::TShape& begin,
   });
 }
 
+/*!
+ * \brief slice the rows of a CSRNDArray with a step between begin_col and end_col
+ */
+struct SliceRowStepCsrAssign {
+  template <typename IType, typename RType, typename DType>
+  MSHADOW_XINLINE static void Map(int i,
+                                  IType* out_idx,
+                                  DType* out_data,
+                                  const RType* out_indptr,
+                                  const IType* in_idx,
+                                  const DType* in_data,
+                                  const RType* in_indptr,
+                                  const nnvm::dim_t begin_row,
+                                  const nnvm::dim_t row_step,
+                                  const nnvm::dim_t begin_col,
+                                  const nnvm::dim_t end_col) {
+    const nnvm::dim_t row = begin_row + i * row_step;
+    RType ind             = out_indptr[i];
+    for (RType j = in_indptr[row]; j < in_indptr[row + 1]; j++) {
+      // indices of CSRNDArray are in ascending order per row
+      if (in_idx[j] >= end_col) {
+        break;
+      } else if (in_idx[j] >= begin_col) {
+        out_idx[ind]  = in_idx[j] - begin_col;
+        out_data[ind] = in_data[j];
+        ind++;
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Slice a CSR NDArray with a step on its rows
+ */
+void SliceRowStepCsrImpl(const SliceParam& param,
+                         const OpContext& ctx,
+                         const NDArray& in,
+                         OpReqType req,
+                         const NDArray& out) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace csr;
+  if (req == kNullOp)
+    return;
+  CHECK_NE(req, kAddTo) << "kAddTo for Slice on CSR input is not supported";
+  CHECK_NE(req, kWriteInplace) << "kWriteInplace for Slice on CSR input is not supported";
+  common::StaticArray<index_t, 2> begin, end, step;
+  GetIndexRange(in.shape(), param.begin, param.end, param.step, &begin, &end, &step);
+  const nnvm::dim_t num_rows  = out.shape()[0];
+  const nnvm::dim_t begin_col = begin[1];
+  const nnvm::dim_t end_col   = begin[1] + out.shape()[1];
+  out.CheckAndAllocAuxData(kIndPtr, Shape1(num_rows + 1));
+  MSHADOW_IDX_TYPE_SWITCH(in.aux_type(kIndPtr), RType, {
+    MSHADOW_IDX_TYPE_SWITCH(in.aux_type(kIdx), IType, {
+      MSHADOW_TYPE_SWITCH(in.dtype(), DType, {
+        const RType* in_indptr = in.aux_data(kIndPtr).dptr<RType>();
+        const IType* in_idx    = in.aux_data(kIdx).dptr<IType>();
+        RType* out_indptr      = out.aux_data(kIndPtr).dptr<RType>();
+        out_indptr[0]          = 0;
+        for (nnvm::dim_t i = 0; i < num_rows; i++) {
+          const nnvm::dim_t row = begin[0] + i * step[0];
+          out_indptr[i + 1]     = out_indptr[i];
+          for (RType j = in_indptr[row]; j < in_indptr[row + 1] && in_idx[j] < end_col; j++) {
+            if (in_idx[j] >= begin_col)
+              out_indptr[i + 1]++;
+          }
+        }
+        const RType nnz = out_indptr[num_rows];
+        // returns zeros in csr format if nnz = 0
+        if (nnz == 0) {
+          out.set_aux_shape(kIdx, Shape1(0));
+          return;
+        }
+        out.CheckAndAllocAuxData(kIdx, Shape1(nnz));
+        out.CheckAndAllocData(Shape1(nnz));
+        Kernel<SliceRowStepCsrAssign, cpu>::Launch(ctx.get_stream<cpu>(),
+                                                   num_rows,
+                                                   out.aux_data(kIdx).dptr<IType>(),
+                                                   out.data().dptr<DType>(),
+                                                   out_indptr,
+                                                   in_idx,
+                                                   in.data().dptr<DType>(),
+                                                   in_indptr,
+                                                   begin[0],
+                                                   step[0],
+                                                   begin_col,
+                                                   end_col);
+      });
+    });
+  });
+}
+
 DMLC_REGISTER_PARAMETER(ReshapeParam);
 DMLC_REGISTER_PARAMETER(TransposeParam);
 DMLC_REGISTER_PARAMETER(ExpandDimParam);
@@ -464,7 +556,11 @@ void SliceExCPU(const nnvm::NodeAttrs& attrs,
   const SliceParam& param = nnvm::get<SliceParam>(attrs.parsed);
   auto in_stype           = inputs[0].storage_type();
   if (in_stype == kCSRStorage) {
-    SliceCsrImpl<cpu>(param, ctx, inputs[0], req[0], outputs[0]);
+    if (param.step.ndim() > 0 && param.step[0].has_value() && param.step[0].value() != 1) {
+      SliceRowStepCsrImpl(param, ctx, inputs[0], req[0], outputs[0]);
+    } else {
+      SliceCsrImpl<cpu>(param, ctx, inputs[0], req[0], outputs[0]);
+    }
 #if MXNET_USE_ONEDNN == 1
   } else if (in_stype == kDefaultStorage) {
     if (SupportMKLDNN(inputs[0])) {
@@ -507,9 +603,9 @@ The storage type of ``slice`` output depends on storage types of inputs
 .. note::
 
    When input data storage type is csr, it only supports
-   step=(), or step=(None,), or step=(1,) to generate a csr output.
-   For other step parameter values, it falls back to slicing
-   a dense tensor.
+   a step of 1 on the columns to generate a csr output, and on GPU
+   a step of 1 on the rows too. For other step parameter values,
+   it falls back to slicing a dense tensor.
 
 Example::
 
@@ -620,6 +716,7 @@ Examples::
     .set_attr<mxnet::FInferShape>("FInferShape", SliceAxisShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)
     .set_attr<FCompute>("FCompute<cpu>", SliceAxis<cpu>)
+    .set_attr<FViewOutputs>("FViewOutputs", SliceAxisViewOutputs)
     .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseNone{"_backward_slice_axis"})
     .add_argument("data", "NDArray-or-Symbol", "Source input")
     .add_arguments(SliceAxisParam::__FIELDS__());
@@ -1183,6 +1280,7 @@ Example::
     .set_attr<mxnet::FInferShape>("FInferShape", SplitOpShape)
     .set_attr<nnvm::FInferType>("FInferType", SplitOpType)
     .set_attr<FCompute>("FCompute<cpu>", SplitOpForward<cpu>)
+    .set_attr<FViewOutputs>("FViewOutputs", SplitViewOutputs)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& n) {
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
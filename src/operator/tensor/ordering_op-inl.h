@@ -36,6 +36,9 @@
 #include "./sort_op.h"
 #include "./indexing_op.h"
 #include "../../api/operator/op_utils.h"
+#ifdef __CUDACC__
+#include <cub/block/block_scan.cuh>
+#endif
 
 namespace mshadow {
 template <typename xpu, int src_dim, typename DType, int dst_dim>
@@ -275,34 +278,26 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
   // Batch size.
   const size_t M(work.size(0) / (sizeof(DType) * N));
   const int omp_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
-#pragma omp parallel for num_threads(omp_threads)
+  // the threads sort a segment each, or all of them sort every segment when there are fewer
+  const bool by_segment     = M >= static_cast<size_t>(omp_threads);
+  const int segment_threads = by_segment ? 1 : omp_threads;
+#pragma omp parallel for num_threads(omp_threads) if (by_segment)
   for (index_t i = 0; i < static_cast<index_t>(M); ++i) {
     // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
     DType* vals        = reinterpret_cast<DType*>(work.dptr_);
     DType* sorted_vals = dat.dptr_ + i * N;
     IDXType* indices   = ind.dptr_ + i * N;
-    if (is_ascend) {
-      if (full_sort) {
-        std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-          return vals[i1] < vals[i2];
-        });
-      } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] < vals[i2];
-            });
-      }
+    if (full_sort) {
+      ArgsortCPU(vals, indices, N, is_ascend, segment_threads);
     } else {
-      if (full_sort) {
-        std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-          return vals[i1] > vals[i2];
-        });
-      } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] > vals[i2];
-            });
-      }
+      // Select the top K in linear time and only sort them. The ties are broken by the indices
+      // so that the selection does not depend on the order the elements are visited in.
+      auto better = [&](const IDXType& i1, const IDXType& i2) {
+        return (is_ascend ? vals[i1] < vals[i2] : vals[i1] > vals[i2]) ||
+               (vals[i1] == vals[i2] && i1 < i2);
+      };
+      std::nth_element(indices, indices + K - 1, indices + N, better);
+      std::sort(indices, indices + K, better);
     }
     for (IDXType j = 0; j < K; ++j) {
       sorted_vals[j] = vals[indices[j]];
@@ -405,6 +400,132 @@ __global__ void PartialSortSmallK(IDXType K, IDXType N, DType* val, IDXType* ind
   }
 }
 
+/*!
+ * \brief The key of a value as an unsigned integer which orders like the value.
+ */
+template <typename DType>
+struct TopKRadixKey {
+  using KeyT = typename std::make_unsigned<DType>::type;
+  static MSHADOW_XINLINE KeyT Get(DType v) {
+    return std::is_signed<DType>::value ?
+               static_cast<KeyT>(v) ^ (KeyT(1) << (8 * sizeof(KeyT) - 1)) :
+               static_cast<KeyT>(v);
+  }
+};
+
+template <>
+struct TopKRadixKey<float> {
+  using KeyT = uint32_t;
+  static MSHADOW_XINLINE KeyT Get(float v) {
+    const KeyT bits = __float_as_uint(v);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+  }
+};
+
+template <>
+struct TopKRadixKey<double> {
+  using KeyT = uint64_t;
+  static MSHADOW_XINLINE KeyT Get(double v) {
+    const KeyT bits = static_cast<KeyT>(__double_as_longlong(v));
+    return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+  }
+};
+
+template <>
+struct TopKRadixKey<mshadow::half::half_t> : public TopKRadixKey<float> {
+  static MSHADOW_XINLINE KeyT Get(mshadow::half::half_t v) {
+    return TopKRadixKey<float>::Get(static_cast<float>(v));
+  }
+};
+
+template <>
+struct TopKRadixKey<mshadow::bfloat::bf16_t> : public TopKRadixKey<float> {
+  static MSHADOW_XINLINE KeyT Get(mshadow::bfloat::bf16_t v) {
+    return TopKRadixKey<float>::Get(static_cast<float>(v));
+  }
+};
+
+/*!
+ * \brief Select the top K elements of each segment of N elements of val, one thread block per
+ *  segment, and write them in the order of the segment to out_val and out_ind.
+ *
+ * The key of the K-th element is found by a radix select, one pass over the segment per byte of
+ * the key, then the elements of smaller keys (better for the order) and as many of those of the
+ * same key as needed, the first ones of the segment, are gathered with block-wide scans.
+ */
+template <int kThreads, typename DType, typename IDXType>
+__global__ void RadixSelectTopK(IDXType K,
+                                IDXType N,
+                                const DType* val,
+                                const IDXType* ind,
+                                bool is_ascend,
+                                DType* out_val,
+                                IDXType* out_ind) {
+  using KeyT      = typename TopKRadixKey<DType>::KeyT;
+  using BlockScan = cub::BlockScan<unsigned int, kThreads>;
+  __shared__ unsigned int hist[256];
+  __shared__ KeyT prefix, mask;
+  __shared__ unsigned int remaining, taken_ties, written;
+  __shared__ typename BlockScan::TempStorage scan_storage;
+  const DType* seg_val   = val + blockIdx.x * N;
+  const IDXType* seg_ind = ind + blockIdx.x * N;
+  // smaller keys are better in both orders
+  auto key = [&](IDXType i) {
+    const KeyT k = TopKRadixKey<DType>::Get(seg_val[i]);
+    return is_ascend ? k : static_cast<KeyT>(~k);
+  };
+  if (threadIdx.x == 0) {
+    prefix     = 0;
+    mask       = 0;
+    remaining  = K;
+    taken_ties = 0;
+    written    = 0;
+  }
+  for (int shift = 8 * (sizeof(KeyT) - 1); shift >= 0; shift -= 8) {
+    for (int b = threadIdx.x; b < 256; b += kThreads)
+      hist[b] = 0;
+    __syncthreads();
+    for (IDXType i = threadIdx.x; i < N; i += kThreads) {
+      const KeyT k = key(i);
+      if ((k & mask) == prefix)
+        atomicAdd(&hist[(k >> shift) & 0xFF], 1u);
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      unsigned int b = 0;
+      while (hist[b] < remaining) {
+        remaining -= hist[b];
+        ++b;
+      }
+      prefix |= static_cast<KeyT>(b) << shift;
+      mask |= static_cast<KeyT>(0xFF) << shift;
+    }
+    __syncthreads();
+  }
+  // prefix is the key of the K-th element, and remaining the number of elements of that key to
+  // take.
+  for (IDXType base = 0; base < N; base += kThreads) {
+    const IDXType i = base + threadIdx.x;
+    const KeyT k    = i < N ? key(i) : KeyT(0);
+    const bool tie  = i < N && k == prefix;
+    unsigned int tie_rank, ties, rank, count;
+    BlockScan(scan_storage).ExclusiveSum(tie ? 1u : 0u, tie_rank, ties);
+    __syncthreads();
+    const bool take = i < N && (k < prefix || (tie && taken_ties + tie_rank < remaining));
+    BlockScan(scan_storage).ExclusiveSum(take ? 1u : 0u, rank, count);
+    if (take) {
+      out_val[blockIdx.x * K + written + rank] = seg_val[i];
+      out_ind[blockIdx.x * K + written + rank] = seg_ind[i];
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      taken_ties += ties;
+      written += count;
+    }
+    __syncthreads();
+  }
+}
+
 template <typename DType, typename IDXType>
 MSHADOW_FORCE_INLINE void TopKSort(const Tensor<gpu, 1, DType>& dat,
                                    const Tensor<gpu, 1, IDXType>& ind,
@@ -414,17 +535,48 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<gpu, 1, DType>& dat,
                                    bool is_ascend,
                                    Stream<gpu>* s) {
   // Use full sort for all but very small K for which we
-  // can do a partial sort entirely within shared memory.
+  // can do a partial sort entirely within shared memory, or K much smaller than N for which the
+  // top K of each segment are selected first and only they are sorted.
   const bool full_sort(K > 5);
+  const bool select(full_sort && K * 16 <= N && N <= (1 << 24));
   // Batch size.
   const size_t M(dat.size(0) / N);
-  if (full_sort) {
-    // Divide workspace into two parts. The first one is needed to store batch ids.
-    size_t alignment = std::max(sizeof(DType), sizeof(IDXType));
-    size_t id_size   = PadBytes(sizeof(IDXType) * ind.size(0), alignment);
+  // Divide workspace into two parts. The first one is needed to store batch ids, or the selected
+  // elements and their batch ids.
+  size_t alignment = std::max(sizeof(DType), sizeof(IDXType));
+  size_t id_size   = PadBytes(sizeof(IDXType) * ind.size(0), alignment);
+  Tensor<gpu, 1, char> sort_work(work.dptr_ + id_size, Shape1(work.size(0) - id_size), s);
+  if (select) {
+    const size_t MK      = M * K;
+    const size_t val_off = 0;
+    const size_t ind_off = val_off + PadBytes(sizeof(DType) * MK, alignment);
+    const size_t id_off  = ind_off + PadBytes(sizeof(IDXType) * MK, alignment);
+    CHECK_LE(id_off + PadBytes(sizeof(IDXType) * MK, alignment), id_size);
+    Tensor<gpu, 1, DType> sel_dat(reinterpret_cast<DType*>(work.dptr_ + val_off), Shape1(MK), s);
+    Tensor<gpu, 1, IDXType> sel_ind(
+        reinterpret_cast<IDXType*>(work.dptr_ + ind_off), Shape1(MK), s);
+    Tensor<gpu, 1, IDXType> batch_id(
+        reinterpret_cast<IDXType*>(work.dptr_ + id_off), Shape1(MK), s);
+    constexpr int nthreads = mshadow::cuda::kBaseThreadNum;
+    RadixSelectTopK<nthreads><<<M, nthreads, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+        K, N, dat.dptr_, ind.dptr_, is_ascend, sel_dat.dptr_, sel_ind.dptr_);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(RadixSelectTopK);
+    // The selected elements are in the order of their segments, so the stable sorts order the ties
+    // like the full sort.
+    mxnet::op::SortByKey(sel_dat, sel_ind, is_ascend, &sort_work);
+    if (M > 1) {
+      batch_id = sel_ind / N;
+      mxnet::op::SortByKey(batch_id, sel_dat, true, &sort_work);
+      batch_id = sel_ind / N;
+      mxnet::op::SortByKey(batch_id, sel_ind, true, &sort_work);
+    }
+    Tensor<gpu, 2, DType> batch_dat   = inplace_reshape(dat, Shape2(M, N));
+    Tensor<gpu, 2, IDXType> batch_ind = inplace_reshape(ind, Shape2(M, N));
+    slice<1>(batch_dat, 0, K)         = inplace_reshape(sel_dat, Shape2(M, K));
+    slice<1>(batch_ind, 0, K)         = inplace_reshape(sel_ind, Shape2(M, K));
+  } else if (full_sort) {
     Tensor<gpu, 1, IDXType> batch_id(
         reinterpret_cast<IDXType*>(work.dptr_), Shape1(ind.size(0)), s);
-    Tensor<gpu, 1, char> sort_work(work.dptr_ + id_size, Shape1(work.size(0) - id_size), s);
     mxnet::op::SortByKey(dat, ind, is_ascend, &sort_work);
     if (M > 1) {
       // Back to back sorting. Note that mxnet::op::SortByKey is a stable sort.
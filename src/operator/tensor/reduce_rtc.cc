@@ -290,9 +290,10 @@ void RTCReduceImpl(Stream<gpu>* s,
                    const int ndim,
                    const std::string& common_code,
                    int dev_id,
-                   const TBlob* lhs     = nullptr,
-                   const TBlob* rhs     = nullptr,
-                   const bool use_index = false) {
+                   const TBlob* lhs      = nullptr,
+                   const TBlob* rhs      = nullptr,
+                   const bool use_index  = false,
+                   const char* func_code = nullptr) {
   using namespace common::cuda::rtc;
   void* small_dptr = small.dptr_;
   if (config.Mnext > 1) {
@@ -362,10 +363,12 @@ void RTCReduceImpl(Stream<gpu>* s,
   args.emplace_back(&param);
   args.emplace_back(&config.Mnext);
 
-  const auto& function_code = (lhs == nullptr)
-                                  ? (use_index ? reduce_function_index_code : reduce_function_code)
-                                  : reduce_function_use_input_code;
-  const auto& kernel_name   = (config.Mnext > 1) ? "reduce_kernel_multi" : "reduce_kernel_single";
+  const char* function_code =
+      (func_code != nullptr)
+          ? func_code
+          : ((lhs == nullptr) ? (use_index ? reduce_function_index_code : reduce_function_code)
+                              : reduce_function_use_input_code);
+  const auto& kernel_name = (config.Mnext > 1) ? "reduce_kernel_multi" : "reduce_kernel_single";
   auto reduce_kernel_func =
       get_function(code + function_code, kernel_name, reduce_kernel_code, dev_id);
   launch(reduce_kernel_func,
@@ -453,7 +456,8 @@ void RTCReduceM1Impl(Stream<gpu>* s,
                      const int ndim,
                      const std::string& common_code,
                      int dev_id,
-                     const bool use_index = false) {
+                     const bool use_index  = false,
+                     const char* func_code = nullptr) {
   using namespace common::cuda::rtc;
 
   std::string code =
@@ -497,14 +501,244 @@ void RTCReduceM1Impl(Stream<gpu>* s,
   args.emplace_back(&small.dptr_);
   args.emplace_back(&param);
 
-  const auto& function_code = (lhs == nullptr)
-                                  ? (use_index ? reduce_function_index_code : reduce_function_code)
-                                  : reduce_function_use_input_code;
+  const char* function_code =
+      (func_code != nullptr)
+          ? func_code
+          : ((lhs == nullptr) ? (use_index ? reduce_function_index_code : reduce_function_code)
+                              : reduce_function_use_input_code);
   auto reduce_kernel_M1_func =
       get_function(code + function_code, "reduce_kernel_M1", reduce_kernel_M1_code, dev_id);
   launch(reduce_kernel_M1_func, config.kernel_1.gridDim, config.kernel_1.blockDim, 0, s, &args);
 }
 
+const char reduce_contiguous_kernel_code[] = R"code(
+__device__ inline void reduce_contiguous_assign(OutputType0* small, AType* partial,
+                                                const index_t idx, const index_t N,
+                                                const int m0, const int Mnext, AType val) {
+  using OType = AccType<OutputType0>;
+  if (Mnext > 1) {
+    partial[idx + m0 * N] = val;
+  } else if (req == OpReqType::kAddTo) {
+    small[idx] = OType::to(op::add(OType::from(small[idx]),
+                                   static_cast<typename OType::type>(val)));
+  } else {
+    small[idx] = OType::to(val);
+  }
+}
+
+// big is a [N, M] matrix reduced along its rows. Each warp reduces a row, or one of the
+// Mnext parts of a row, with vectorized loads and shuffles.
+__launch_bounds__(kRTCMaxThreadsPerBlock)
+__global__ void reduce_rows_kernel(const index_t N, const index_t M,
+                                   const InputType0* __restrict big,
+                                   OutputType0* small,
+                                   AType* partial,
+                                   const int Mnext) {
+  using IType0 = AccType<InputType0>;
+  const index_t nwarps = static_cast<index_t>(blockDim.y) * gridDim.x;
+  for (index_t w = threadIdx.y + static_cast<index_t>(blockIdx.x) * blockDim.y;
+       w < N * Mnext; w += nwarps) {
+    const index_t idx    = w % N;
+    const int m0         = w / N;
+    const index_t Mstart = (index_t)((int64)M*(int64)m0/(int64)Mnext);
+    const index_t Mend   = (index_t)((int64)M*(int64)(m0 + 1)/(int64)Mnext);
+    const index_t length = Mend - Mstart;
+    vector::VectorizedLoader<InputType0, nvec, false> loader(big + idx * M + Mstart, length);
+    AType val, residual;
+    REDUCER.SetInitValue(val, residual);
+    for (index_t i = threadIdx.x; i < loader.num_aligned_elements(); i += util::warp_size) {
+      loader.load(i, length);
+      #pragma unroll
+      for (int j = 0; j < nvec; ++j) {
+        const index_t k = i * nvec + j - loader.alignment();
+        if (k >= 0 && k < length) {
+          REDUCER.Reduce(val, OP(IType0::from(loader.separate()[j])), residual);
+        }
+      }
+    }
+    #pragma unroll
+    for (int i = util::warp_size / 2; i >= 1; i /= 2) {
+      AType other          = __shfl_down_sync(0xffffffff, val, i);
+      AType other_residual = __shfl_down_sync(0xffffffff, residual, i);
+      REDUCER.Merge(val, residual, other, other_residual);
+    }
+    if (threadIdx.x == 0) {
+      REDUCER.Finalize(val, residual);
+      reduce_contiguous_assign(small, partial, idx, N, m0, Mnext, val);
+    }
+  }
+}
+
+// big is a [M, N] matrix reduced along its columns. Each thread reduces nvec adjacent columns
+// of a part of the rows with vectorized loads, the threads of a column of the block are
+// combined in shared memory, and the blocks along y reduce the Mnext parts of the rows.
+__launch_bounds__(kRTCMaxThreadsPerBlock)
+__global__ void reduce_cols_kernel(const index_t N, const index_t M,
+                                   const InputType0* __restrict big,
+                                   OutputType0* small,
+                                   AType* partial,
+                                   const int Mnext) {
+  extern __shared__ char shTileChar[];
+  using IType0          = AccType<InputType0>;
+  using LoadType        = vector::VectorizedStorage<InputType0, nvec>;
+  AType* shTile         = (AType*)(shTileChar);
+  const int tid         = threadIdx.x + threadIdx.y * blockDim.x;
+  const index_t ngroups = N / nvec;
+  for (int m0 = blockIdx.y; m0 < Mnext; m0 += gridDim.y) {
+    const index_t Mstart = (index_t)((int64)M*(int64)m0/(int64)Mnext);
+    const index_t Mend   = (index_t)((int64)M*(int64)(m0 + 1)/(int64)Mnext);
+    for (index_t g0 = static_cast<index_t>(blockIdx.x) * blockDim.x; g0 < ngroups;
+         g0 += static_cast<index_t>(blockDim.x) * gridDim.x) {
+      const index_t g = g0 + threadIdx.x;
+      AType val[nvec], residual[nvec];
+      #pragma unroll
+      for (int j = 0; j < nvec; ++j) {
+        REDUCER.SetInitValue(val[j], residual[j]);
+      }
+      if (g < ngroups) {
+        for (index_t m = Mstart + threadIdx.y; m < Mend; m += blockDim.y) {
+          const LoadType v(reinterpret_cast<const typename LoadType::LType*>(big + m * N)[g]);
+          #pragma unroll
+          for (int j = 0; j < nvec; ++j) {
+            REDUCER.Reduce(val[j], OP(IType0::from(v.scratch_.separate[j])), residual[j]);
+          }
+        }
+      }
+      #pragma unroll
+      for (int j = 0; j < nvec; ++j) {
+        shTile[(tid * nvec + j) * 2]     = val[j];
+        shTile[(tid * nvec + j) * 2 + 1] = residual[j];
+      }
+      __syncthreads();
+      for (int t = blockDim.y / 2; t >= 1; t /= 2) {
+        if (threadIdx.y < t) {
+          const int other = tid + t * blockDim.x;
+          #pragma unroll
+          for (int j = 0; j < nvec; ++j) {
+            REDUCER.Merge(shTile[(tid * nvec + j) * 2], shTile[(tid * nvec + j) * 2 + 1],
+                          shTile[(other * nvec + j) * 2], shTile[(other * nvec + j) * 2 + 1]);
+          }
+        }
+        __syncthreads();
+      }
+      if (threadIdx.y == 0 && g < ngroups) {
+        #pragma unroll
+        for (int j = 0; j < nvec; ++j) {
+          AType v          = shTile[(tid * nvec + j) * 2];
+          AType v_residual = shTile[(tid * nvec + j) * 2 + 1];
+          REDUCER.Finalize(v, v_residual);
+          reduce_contiguous_assign(small, partial, g * nvec + j, N, m0, Mnext, v);
+        }
+      }
+      __syncthreads();
+    }
+  }
+}
+)code";
+
+/*!
+ * \brief Reduce big when, without its axes of size 1, it is a row-major matrix reduced along its
+ *  rows or its columns, with the kernels of reduce_contiguous_kernel_code. They load several
+ *  elements at once and avoid the index arithmetic of the general kernel for each element.
+ *  Mnext of config splits the reduced axis, so that the partial results fit in the workspace
+ *  sized for the general kernel.
+ *
+ * \return whether big was reduced, else the general kernel has to run
+ */
+bool RTCReduceContiguousImpl(Stream<gpu>* s,
+                             const TBlob& small,
+                             const TBlob& big,
+                             const Tensor<gpu, 1, char>& workspace,
+                             const ReduceImplConfig& config,
+                             const int ndim,
+                             const std::string& common_code,
+                             int dev_id) {
+  using namespace common::cuda::rtc;
+  // the accumulation type of bool cannot be shuffled across a warp
+  if (big.type_flag_ == mshadow::kBool)
+    return false;
+  const common::MShadowTypeInfo info = common::mshadow_type_info(big.type_flag_);
+  // the reduced axes come after the kept ones for rows, before them for columns
+  bool rows = true, cols = true, reduced = false, kept = false;
+  for (int i = 0; i < ndim; ++i) {
+    if (big.shape_[i] == 1)
+      continue;
+    if (small.shape_[i] == 1) {
+      cols    = cols && !kept;
+      reduced = true;
+    } else {
+      rows = rows && !reduced;
+      kept = true;
+    }
+  }
+  const index_t N = config.N;
+  const index_t M = config.M;
+  const int Mnext = config.Mnext;
+  int nvec        = std::max(16 / info.size, 1);
+  if (rows && M >= 64) {
+    cols = false;
+  } else if (cols && !rows && N >= 32) {
+    // the rows of big must be aligned to the vectors, and the shared memory is kept to 16 KB
+    const size_t address = reinterpret_cast<size_t>(big.dptr_);
+    while (nvec > 1 && (N % nvec != 0 || address % (nvec * info.size) != 0 ||
+                        warpSize * 8 * nvec * 2 * info.acc_size > 16384))
+      nvec /= 2;
+  } else {
+    return false;
+  }
+
+  void* partial = nullptr;
+  if (config.Mnext > 1) {
+    CHECK_EQ(workspace.CheckContiguous(), true);
+    CHECK_GE(workspace.size(0), config.workspace_size);
+    partial = workspace.dptr_;
+  }
+  const std::string code = common_code + "const int nvec = " + std::to_string(nvec) +
+                           ";\n"
+                           "using InputType0 = " +
+                           info.name +
+                           ";\n"
+                           "using OutputType0 = " +
+                           common::mshadow_type_info(small.type_flag_).name + ";\n";
+  std::vector<const void*> args;
+  args.emplace_back(&N);
+  args.emplace_back(&M);
+  args.emplace_back(&big.dptr_);
+  args.emplace_back(&small.dptr_);
+  args.emplace_back(&partial);
+  args.emplace_back(&Mnext);
+  if (cols) {
+    const dim3 block(warpSize, 8);
+    const index_t ngroups = N / nvec;
+    const dim3 grid(std::min<index_t>(kBaseGridNum, (ngroups + block.x - 1) / block.x),
+                    std::min<index_t>(kBaseGridNum, Mnext));
+    const int shmem = block.x * block.y * nvec * 2 * info.acc_size;
+    auto func       = get_function(
+        code + reduce_function_code, "reduce_cols_kernel", reduce_contiguous_kernel_code, dev_id);
+    launch(func, grid, block, shmem, s, &args);
+  } else {
+    const dim3 block(warpSize, 4);
+    const dim3 grid(std::min<index_t>(kBaseGridNum, (N * Mnext + block.y - 1) / block.y));
+    auto func = get_function(
+        code + reduce_function_code, "reduce_rows_kernel", reduce_contiguous_kernel_code, dev_id);
+    launch(func, grid, block, 0, s, &args);
+  }
+
+  if (Mnext > 1) {
+    args.resize(0);
+    args.emplace_back(&N);
+    args.emplace_back(&config.Mnext);
+    args.emplace_back(&N);
+    args.emplace_back(&partial);
+    args.emplace_back(&small.dptr_);
+    auto reduce_lines_kernel_func = get_function(
+        code + reduce_function_code, "reduce_lines_kernel", reduce_lines_kernel_code, dev_id);
+    launch(
+        reduce_lines_kernel_func, config.kernel_2.gridSize, config.kernel_2.blockSize, 0, s, &args);
+  }
+  return true;
+}
+
 }  // namespace
 
 void RTCReduce(const OpContext& ctx,
@@ -542,7 +776,9 @@ void RTCReduce(const OpContext& ctx,
                     common_code,
                     ctx.run_ctx.ctx.dev_id,
                     use_index);
-  } else {
+  } else if (use_index || !RTCReduceContiguousImpl(
+                              s, small, big, workspace, config, ndim, common_code,
+                              ctx.run_ctx.ctx.dev_id)) {
     RTCReduceImpl(s,
                   small,
                   req == kAddTo,
@@ -604,6 +840,77 @@ void RTCReduce(const OpContext& ctx,
   }
 }
 
+void RTCReduceFunc(const OpContext& ctx,
+                   const TBlob& small,
+                   const OpReqType req,
+                   const Tensor<gpu, 1, char>& workspace,
+                   const TBlob& big,
+                   const TBlob& lhs,
+                   const TBlob& rhs,
+                   const std::string& reducer,
+                   int ndim,
+                   const std::string& func_code) {
+  using namespace mxnet::common::cuda::rtc;
+  if (req == kNullOp)
+    return;
+  Stream<gpu>* s = ctx.get_stream<gpu>();
+  ReduceImplConfig config(small.shape_, big.shape_, &lhs.shape_, &rhs.shape_);
+  // lhs and rhs may be broadcast along any reduced axis, so they are walked with the
+  // reduced shape of big and a zero stride where they are broadcast
+  int mdim = 0;
+  for (int i = 0; i < ndim; ++i)
+    mdim += small.shape_[i] != big.shape_[i];
+  auto reduced_strides = [&](const TShape& shape, TShape* dims, TShape* stride) {
+    index_t s = 1;
+    for (int i = 0; i < ndim; ++i)
+      (*dims)[i] = (*stride)[i] = 1;
+    for (int i = ndim - 1, j = mdim; i >= 0; --i) {
+      if (small.shape_[i] != big.shape_[i]) {
+        --j;
+        (*dims)[j]   = big.shape_[i];
+        (*stride)[j] = shape[i] == 1 ? 0 : s;
+      }
+      s *= shape[i];
+    }
+  };
+  reduced_strides(lhs.shape_, &config.lhs_shape, &config.lhs_stride);
+  reduced_strides(rhs.shape_, &config.rhs_shape, &config.rhs_stride);
+  std::string common_code = std::string("const OpReqType req = ") + util::to_string(req) +
+                            ";\n"
+                            "#define REDUCER " +
+                            reducer +
+                            "\n"
+                            "const int ndim = " +
+                            std::to_string(ndim) + ";\n";
+  if (config.M == 1) {
+    RTCReduceM1Impl(s,
+                    small,
+                    big,
+                    &lhs,
+                    &rhs,
+                    config,
+                    ndim,
+                    common_code,
+                    ctx.run_ctx.ctx.dev_id,
+                    false,
+                    func_code.c_str());
+  } else {
+    RTCReduceImpl(s,
+                  small,
+                  req == kAddTo,
+                  big,
+                  workspace,
+                  config,
+                  ndim,
+                  common_code,
+                  ctx.run_ctx.ctx.dev_id,
+                  &lhs,
+                  &rhs,
+                  false,
+                  func_code.c_str());
+  }
+}
+
 #endif  // MXNET_USE_CUDA
 
 }  // namespace broadcast
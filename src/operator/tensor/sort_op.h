@@ -26,6 +26,9 @@
 
 #include <dmlc/logging.h>
 #include <mshadow/tensor.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <type_traits>
 
@@ -43,6 +46,223 @@ MSHADOW_XINLINE size_t PadBytes(size_t num_bytes, size_t alignment) {
 }
 
 namespace op {
+/*! \brief CPU: segments shorter than this are sorted with comparisons */
+constexpr size_t kRadixSortMinSize = 1 << 10;
+/*! \brief CPU: minimum number of elements per thread of a parallel sort */
+constexpr size_t kParallelSortGrain = 1 << 16;
+
+/*!
+ * \brief CPU: the unsigned integer ordered as the arithmetic key by its bits, for the radix
+ *  sort. The descending keys are the complemented ascending ones.
+ */
+template <typename KDType, bool is_float = std::is_floating_point<KDType>::value>
+struct RadixKey {
+  using UType = typename std::conditional<sizeof(KDType) <= 4, uint32_t, uint64_t>::type;
+  static UType Get(const KDType key, const bool is_ascend) {
+    // the signed keys are ordered as unsigned with the sign bit flipped
+    UType bits = static_cast<UType>(key);
+    if (std::is_signed<KDType>::value)
+      bits ^= UType(1) << (8 * sizeof(UType) - 1);
+    return is_ascend ? bits : ~bits;
+  }
+};
+
+template <typename KDType>
+struct RadixKey<KDType, true> {
+  using UType = typename std::conditional<sizeof(KDType) == 4, uint32_t, uint64_t>::type;
+  static_assert(sizeof(KDType) == sizeof(UType), "radix sort of float32 and float64 keys");
+  static UType Get(const KDType key, const bool is_ascend) {
+    // -0 and 0 are equal, their order is kept as by the comparisons
+    const KDType value = key == KDType(0) ? KDType(0) : key;
+    UType bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // the negative keys are complemented, the positive ones get the sign bit
+    const UType sign = UType(1) << (8 * sizeof(UType) - 1);
+    bits             = (bits & sign) ? ~bits : (bits | sign);
+    return is_ascend ? bits : ~bits;
+  }
+};
+
+/*!
+ * \brief CPU: stable sort of n elements with num_threads threads. The chunks of the threads
+ *  are sorted, then merged pairwise, every merge split between the threads left.
+ */
+template <typename T, typename Compare>
+inline void ParallelStableSort(T* data, const size_t n, Compare comp, const int num_threads) {
+  const int num_chunks =
+      static_cast<int>(std::max<size_t>(1, std::min<size_t>(num_threads, n / kParallelSortGrain)));
+  if (num_chunks == 1) {
+    std::stable_sort(data, data + n, comp);
+    return;
+  }
+  const size_t chunk = (n + num_chunks - 1) / num_chunks;
+#pragma omp parallel for num_threads(num_chunks)
+  for (int c = 0; c < num_chunks; ++c) {
+    std::stable_sort(data + std::min(n, c * chunk), data + std::min(n, (c + 1) * chunk), comp);
+  }
+  std::vector<T> buffer(n);
+  T* in  = data;
+  T* out = buffer.data();
+  for (size_t width = chunk; width < n; width *= 2) {
+    const int num_merges = static_cast<int>((n + 2 * width - 1) / (2 * width));
+    const int parts      = std::max(1, num_chunks / num_merges);
+#pragma omp parallel for num_threads(num_chunks)
+    for (int task = 0; task < num_merges * parts; ++task) {
+      const size_t lo = (task / parts) * 2 * width;
+      const size_t na = std::min(width, n - lo);
+      const size_t nb = std::min(width, n - lo - na);
+      const T* a      = in + lo;
+      const T* b      = a + na;
+      // the first i of a and k - i of b are the first k merged, the ties taken from a first
+      auto split = [&](const size_t k) {
+        size_t i  = k > nb ? k - nb : 0;
+        size_t hi = std::min(k, na);
+        while (i < hi) {
+          const size_t mid = (i + hi) / 2;
+          if (!comp(b[k - mid - 1], a[mid])) {
+            i = mid + 1;
+          } else {
+            hi = mid;
+          }
+        }
+        return i;
+      };
+      const int part  = task % parts;
+      const size_t k0 = (na + nb) * part / parts;
+      const size_t k1 = (na + nb) * (part + 1) / parts;
+      const size_t i0 = split(k0);
+      const size_t i1 = split(k1);
+      std::merge(a + i0, a + i1, b + k0 - i0, b + k1 - i1, out + lo + k0, comp);
+    }
+    std::swap(in, out);
+  }
+  if (in != data)
+    std::copy(in, in + n, data);
+}
+
+/*!
+ * \brief CPU: LSD radix sort of the n indices by their arithmetic keys[idx[i]] a byte per
+ *  pass, stable. The histograms and the scatters of a pass are split between the threads,
+ *  the passes of a byte equal for all the keys are skipped.
+ */
+template <typename KDType, typename IDXType>
+inline void RadixArgsort(const KDType* keys,
+                         IDXType* idx,
+                         const size_t n,
+                         const bool is_ascend,
+                         const int num_threads) {
+  using UType          = typename RadixKey<KDType>::UType;
+  constexpr int kRadix = 256;
+  const int num_chunks =
+      static_cast<int>(std::max<size_t>(1, std::min<size_t>(num_threads, n / kParallelSortGrain)));
+  const size_t chunk = (n + num_chunks - 1) / num_chunks;
+  std::vector<UType> ukeys(n), ukeys_out(n);
+  std::vector<IDXType> idx_out(n);
+#pragma omp parallel for num_threads(num_chunks)
+  for (int c = 0; c < num_chunks; ++c) {
+    for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+      ukeys[i] = RadixKey<KDType>::Get(keys[idx[i]], is_ascend);
+    }
+  }
+  UType* kin    = ukeys.data();
+  UType* kout   = ukeys_out.data();
+  IDXType* vin  = idx;
+  IDXType* vout = idx_out.data();
+  std::vector<size_t> hist(num_chunks * kRadix);
+  for (size_t shift = 0; shift < 8 * sizeof(UType); shift += 8) {
+    std::fill(hist.begin(), hist.end(), 0);
+#pragma omp parallel for num_threads(num_chunks)
+    for (int c = 0; c < num_chunks; ++c) {
+      size_t* h = hist.data() + c * kRadix;
+      for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+        ++h[(kin[i] >> shift) & (kRadix - 1)];
+      }
+    }
+    // the offsets of the digits of every chunk, in the order of the digits then the chunks
+    size_t offset = 0;
+    bool skip     = false;
+    for (int d = 0; d < kRadix; ++d) {
+      const size_t begin = offset;
+      for (int c = 0; c < num_chunks; ++c) {
+        const size_t count   = hist[c * kRadix + d];
+        hist[c * kRadix + d] = offset;
+        offset += count;
+      }
+      skip = skip || offset - begin == n;
+    }
+    if (skip)
+      continue;
+#pragma omp parallel for num_threads(num_chunks)
+    for (int c = 0; c < num_chunks; ++c) {
+      size_t* h = hist.data() + c * kRadix;
+      for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+        const size_t pos = h[(kin[i] >> shift) & (kRadix - 1)]++;
+        kout[pos]        = kin[i];
+        vout[pos]        = vin[i];
+      }
+    }
+    std::swap(kin, kout);
+    std::swap(vin, vout);
+  }
+  if (vin != idx)
+    std::copy(vin, vin + n, idx);
+}
+
+template <typename KDType, typename IDXType>
+inline void ArgsortCPU(const KDType* keys,
+                       IDXType* idx,
+                       const size_t n,
+                       const bool is_ascend,
+                       const int num_threads,
+                       std::true_type) {
+  if (n >= kRadixSortMinSize) {
+    RadixArgsort(keys, idx, n, is_ascend, num_threads);
+  } else if (is_ascend) {
+    std::stable_sort(
+        idx, idx + n, [&](const IDXType i1, const IDXType i2) { return keys[i1] < keys[i2]; });
+  } else {
+    std::stable_sort(
+        idx, idx + n, [&](const IDXType i1, const IDXType i2) { return keys[i1] > keys[i2]; });
+  }
+}
+
+template <typename KDType, typename IDXType>
+inline void ArgsortCPU(const KDType* keys,
+                       IDXType* idx,
+                       const size_t n,
+                       const bool is_ascend,
+                       const int num_threads,
+                       std::false_type) {
+  if (is_ascend) {
+    ParallelStableSort(
+        idx, n, [&](const IDXType i1, const IDXType i2) { return keys[i1] < keys[i2]; },
+        num_threads);
+  } else {
+    ParallelStableSort(
+        idx, n, [&](const IDXType i1, const IDXType i2) { return keys[i1] > keys[i2]; },
+        num_threads);
+  }
+}
+
+/*!
+ * \brief CPU: stable sort of the n indices idx by their keys keys[idx[i]] with num_threads
+ *  threads, a radix sort of the arithmetic keys and a merge sort of the others, e.g. half_t
+ */
+template <typename KDType, typename IDXType>
+inline void ArgsortCPU(const KDType* keys,
+                       IDXType* idx,
+                       const size_t n,
+                       const bool is_ascend,
+                       const int num_threads) {
+  ArgsortCPU(keys,
+             idx,
+             n,
+             is_ascend,
+             num_threads,
+             std::integral_constant<bool,
+                                    std::is_arithmetic<KDType>::value && sizeof(KDType) <= 8>());
+}
+
 /*!
  * \brief CPU/GPU: Sort key-value pairs stored in separate places. (Stable sort is performed!)
  * \param keys the keys to sort
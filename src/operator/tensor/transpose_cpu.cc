@@ -0,0 +1,386 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file transpose_cpu.cc
+ * \brief transpose of the CPU arrays of any number of dimensions, by tiles transposed in the
+ *  registers of the CPU instruction sets
+ */
+#include "./transpose_cpu.h"
+
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "../../common/cpu_isa.h"
+#include "../../engine/openmp.h"
+
+#if MXNET_CPU_ISA_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace mxnet {
+namespace op {
+
+namespace {
+
+/*! \brief side of the tiles of the threads, 4 KB of 4 byte elements, which stay in L1 */
+constexpr index_t kBlock = 32;
+
+/*! \brief the arrays smaller than this, in bytes, are transposed by the calling thread */
+constexpr size_t kMinParallelBytes = 1 << 16;
+
+/*! \brief the transpose of the collapsed dimensions */
+struct TransposePlan {
+  /*! \brief the collapsed dimensions, in the order of the input */
+  std::vector<index_t> shape;
+  /*! \brief the strides of the dimensions in the input */
+  std::vector<index_t> in_stride;
+  /*! \brief the strides of the dimensions in the output */
+  std::vector<index_t> out_stride;
+  /*! \brief the dimension the last one of the output reads */
+  int last_out;
+};
+
+/*!
+ * \brief drops the dimensions of size 1 and collapses the dimensions which stay next to each
+ *  other, in the same order, in the output
+ */
+TransposePlan MakePlan(const mxnet::TShape& shape, const mxnet::TShape& axes) {
+  const int ndim = shape.ndim();
+  // the rank of the dimensions of more than one element among themselves
+  std::vector<int> rank(ndim, -1);
+  int num_kept = 0;
+  for (int i = 0; i < ndim; ++i) {
+    if (shape[i] != 1)
+      rank[i] = num_kept++;
+  }
+  // the groups of consecutive dimensions, by the rank of their first dimension
+  std::vector<int> group_of_rank(num_kept, -1);
+  std::vector<index_t> group_size;
+  std::vector<int> group_first;
+  int last_rank = -2;
+  for (int i = 0; i < ndim; ++i) {
+    const int r = rank[axes[i]];
+    if (r < 0)
+      continue;
+    if (r == last_rank + 1) {
+      group_size.back() *= shape[axes[i]];
+    } else {
+      group_of_rank[r] = group_size.size();
+      group_size.push_back(shape[axes[i]]);
+      group_first.push_back(r);
+    }
+    last_rank = r;
+  }
+  // the groups in the order of the input, and the one each output dimension reads
+  const int num_groups = group_size.size();
+  std::vector<int> in_pos(num_groups);
+  TransposePlan plan;
+  for (int r = 0; r < num_kept; ++r) {
+    if (group_of_rank[r] >= 0) {
+      in_pos[group_of_rank[r]] = plan.shape.size();
+      plan.shape.push_back(group_size[group_of_rank[r]]);
+    }
+  }
+  plan.in_stride.resize(num_groups);
+  plan.out_stride.resize(num_groups);
+  index_t stride = 1;
+  for (int j = num_groups - 1; j >= 0; --j) {
+    plan.in_stride[j] = stride;
+    stride *= plan.shape[j];
+  }
+  stride = 1;
+  for (int i = num_groups - 1; i >= 0; --i) {
+    plan.out_stride[in_pos[i]] = stride;
+    stride *= group_size[i];
+  }
+  plan.last_out = num_groups > 0 ? in_pos[num_groups - 1] : -1;
+  return plan;
+}
+
+/*! \brief transposes the rows x cols block of in, of leading dimension ldi, to out */
+template <typename DType>
+inline void TransposeBlock(const DType* in,
+                           index_t ldi,
+                           DType* out,
+                           index_t ldo,
+                           index_t rows,
+                           index_t cols) {
+  for (index_t r = 0; r < rows; ++r) {
+    for (index_t c = 0; c < cols; ++c)
+      out[c * ldo + r] = in[r * ldi + c];
+  }
+}
+
+#if MXNET_CPU_ISA_DISPATCH
+namespace avx2 {
+
+constexpr int kWidth = 8;
+
+/*! \brief transposes the 8 x 8 block of floats of in to out */
+MXNET_TARGET_AVX2 inline void Transpose8x8(const float* in, index_t ldi, float* out, index_t ldo) {
+  __m256 r[8], t[8];
+  for (int i = 0; i < 8; ++i)
+    r[i] = _mm256_loadu_ps(in + i * ldi);
+  for (int i = 0; i < 8; i += 2) {
+    t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+  }
+  // the lane l of r[4 k + m] holds the column 4 l + m of the rows 4 k to 4 k + 3
+  for (int i = 0; i < 8; i += 4) {
+    r[i]     = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  for (int m = 0; m < 4; ++m) {
+    _mm256_storeu_ps(out + m * ldo, _mm256_permute2f128_ps(r[m], r[m + 4], 0x20));
+    _mm256_storeu_ps(out + (m + 4) * ldo, _mm256_permute2f128_ps(r[m], r[m + 4], 0x31));
+  }
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+constexpr int kWidth = 16;
+
+/*! \brief transposes the 16 x 16 block of floats of in to out */
+MXNET_TARGET_AVX512 inline void Transpose16x16(const float* in,
+                                               index_t ldi,
+                                               float* out,
+                                               index_t ldo) {
+  __m512 r[16], t[16];
+  for (int i = 0; i < 16; ++i)
+    r[i] = _mm512_loadu_ps(in + i * ldi);
+  for (int i = 0; i < 16; i += 2) {
+    t[i]     = _mm512_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm512_unpackhi_ps(r[i], r[i + 1]);
+  }
+  // the lane l of r[4 k + m] holds the column 4 l + m of the rows 4 k to 4 k + 3
+  for (int i = 0; i < 16; i += 4) {
+    r[i]     = _mm512_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 1] = _mm512_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    r[i + 2] = _mm512_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 3] = _mm512_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  // then the lanes are transposed across r[m], r[m + 4], r[m + 8] and r[m + 12]
+  for (int m = 0; m < 4; ++m) {
+    const __m512 u0 = _mm512_shuffle_f32x4(r[m], r[m + 4], _MM_SHUFFLE(2, 0, 2, 0));
+    const __m512 u1 = _mm512_shuffle_f32x4(r[m], r[m + 4], _MM_SHUFFLE(3, 1, 3, 1));
+    const __m512 u2 = _mm512_shuffle_f32x4(r[m + 8], r[m + 12], _MM_SHUFFLE(2, 0, 2, 0));
+    const __m512 u3 = _mm512_shuffle_f32x4(r[m + 8], r[m + 12], _MM_SHUFFLE(3, 1, 3, 1));
+    _mm512_storeu_ps(out + m * ldo, _mm512_shuffle_f32x4(u0, u2, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm512_storeu_ps(out + (m + 4) * ldo, _mm512_shuffle_f32x4(u1, u3, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm512_storeu_ps(out + (m + 8) * ldo, _mm512_shuffle_f32x4(u0, u2, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm512_storeu_ps(out + (m + 12) * ldo,
+                     _mm512_shuffle_f32x4(u1, u3, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+}
+
+}  // namespace avx512
+
+/*!
+ * \brief transposes the rows x cols block of in by the width x width blocks of kernel, and the
+ *  edges left with the scalar code
+ */
+template <int width, typename Kernel>
+inline void TransposeBlockOf(Kernel kernel,
+                             const float* in,
+                             index_t ldi,
+                             float* out,
+                             index_t ldo,
+                             index_t rows,
+                             index_t cols) {
+  const index_t body_rows = rows - rows % width;
+  const index_t body_cols = cols - cols % width;
+  for (index_t r = 0; r < body_rows; r += width) {
+    for (index_t c = 0; c < body_cols; c += width)
+      kernel(in + r * ldi + c, ldi, out + c * ldo + r, ldo);
+  }
+  TransposeBlock(in + body_cols, ldi, out + body_cols * ldo, ldo, rows, cols - body_cols);
+  TransposeBlock(in + body_rows * ldi, ldi, out + body_rows, ldo, rows - body_rows, body_cols);
+}
+#endif  // MXNET_CPU_ISA_DISPATCH
+
+/*! \brief the transpose of the blocks of the last dimensions of in and of out */
+template <typename DType>
+struct BlockTranspose {
+  void operator()(const DType* in,
+                  index_t ldi,
+                  DType* out,
+                  index_t ldo,
+                  index_t rows,
+                  index_t cols) const {
+    TransposeBlock(in, ldi, out, ldo, rows, cols);
+  }
+};
+
+template <>
+struct BlockTranspose<uint32_t> {
+  BlockTranspose() : isa(common::GetCPUISA()) {}
+
+  void operator()(const uint32_t* in,
+                  index_t ldi,
+                  uint32_t* out,
+                  index_t ldo,
+                  index_t rows,
+                  index_t cols) const {
+    // the shuffles move the bits of the elements, whatever their type
+#if MXNET_CPU_ISA_DISPATCH
+    const float* fin = reinterpret_cast<const float*>(in);
+    float* fout      = reinterpret_cast<float*>(out);
+    if (isa >= common::CPUISA::kAVX512) {
+      TransposeBlockOf<avx512::kWidth>(avx512::Transpose16x16, fin, ldi, fout, ldo, rows, cols);
+      return;
+    }
+    if (isa >= common::CPUISA::kAVX2) {
+      TransposeBlockOf<avx2::kWidth>(avx2::Transpose8x8, fin, ldi, fout, ldo, rows, cols);
+      return;
+    }
+#endif
+    TransposeBlock(in, ldi, out, ldo, rows, cols);
+  }
+
+  common::CPUISA isa;
+};
+
+/*!
+ * \brief transposes in to out by plan. The last dimension of the input, contiguous, and the
+ *  dimension of the last one of the output are transposed by tiles, one tile of each of the
+ *  indices of the other dimensions at a time.
+ */
+template <typename DType>
+void TransposeByPlan(const DType* in, DType* out, const TransposePlan& plan, int num_threads) {
+  const int ndim = plan.shape.size();
+  const int row  = plan.last_out;
+  const int col  = ndim - 1;
+  const index_t rows       = plan.shape[row];
+  const index_t cols       = plan.shape[col];
+  const index_t row_blocks = (rows + kBlock - 1) / kBlock;
+  const index_t col_blocks = (cols + kBlock - 1) / kBlock;
+  index_t outer            = 1;
+  for (int j = 0; j < ndim; ++j) {
+    if (j != row && j != col)
+      outer *= plan.shape[j];
+  }
+  const index_t num_tiles = outer * row_blocks * col_blocks;
+  const BlockTranspose<DType> transpose{};
+#pragma omp parallel for num_threads(num_threads)
+  for (index_t tile = 0; tile < num_tiles; ++tile) {
+    index_t k             = tile;
+    const index_t col_blk = k % col_blocks;
+    k /= col_blocks;
+    const index_t row_blk = k % row_blocks;
+    k /= row_blocks;
+    index_t in_offset  = 0;
+    index_t out_offset = 0;
+    for (int j = ndim - 1; j >= 0; --j) {
+      if (j == row || j == col)
+        continue;
+      const index_t coord = k % plan.shape[j];
+      k /= plan.shape[j];
+      in_offset += coord * plan.in_stride[j];
+      out_offset += coord * plan.out_stride[j];
+    }
+    const index_t r0 = row_blk * kBlock;
+    const index_t c0 = col_blk * kBlock;
+    // the rows of the tiles of in are the columns of the tiles of out
+    transpose(in + in_offset + r0 * plan.in_stride[row] + c0,
+              plan.in_stride[row],
+              out + out_offset + c0 * plan.out_stride[col] + r0,
+              plan.out_stride[col],
+              std::min(kBlock, rows - r0),
+              std::min(kBlock, cols - c0));
+  }
+}
+
+/*! \brief copies the rows of the last dimension, which stays the last one, of in to out */
+void CopyRows(const char* in,
+              char* out,
+              const TransposePlan& plan,
+              size_t type_size,
+              int num_threads) {
+  const int ndim             = plan.shape.size();
+  const size_t row_bytes     = plan.shape[ndim - 1] * type_size;
+  index_t num_rows           = 1;
+  for (int j = 0; j < ndim - 1; ++j)
+    num_rows *= plan.shape[j];
+#pragma omp parallel for num_threads(num_threads)
+  for (index_t i = 0; i < num_rows; ++i) {
+    index_t k          = i;
+    index_t out_offset = 0;
+    for (int j = ndim - 2; j >= 0; --j) {
+      out_offset += (k % plan.shape[j]) * plan.out_stride[j];
+      k /= plan.shape[j];
+    }
+    std::memcpy(out + out_offset * type_size, in + i * row_bytes, row_bytes);
+  }
+}
+
+}  // namespace
+
+void TransposeCPU(const void* in,
+                  void* out,
+                  const mxnet::TShape& shape,
+                  const mxnet::TShape& axes,
+                  size_t type_size) {
+  CHECK_EQ(shape.ndim(), axes.ndim());
+  const size_t size = shape.Size();
+  if (size == 0)
+    return;
+  const TransposePlan plan = MakePlan(shape, axes);
+  const int ndim           = plan.shape.size();
+  if (ndim <= 1) {
+    std::memcpy(out, in, size * type_size);
+    return;
+  }
+  const int num_threads = size * type_size < kMinParallelBytes ?
+                              1 :
+                              engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (plan.last_out == ndim - 1) {
+    CopyRows(static_cast<const char*>(in), static_cast<char*>(out), plan, type_size, num_threads);
+    return;
+  }
+  switch (type_size) {
+    case 1:
+      TransposeByPlan(
+          static_cast<const uint8_t*>(in), static_cast<uint8_t*>(out), plan, num_threads);
+      break;
+    case 2:
+      TransposeByPlan(
+          static_cast<const uint16_t*>(in), static_cast<uint16_t*>(out), plan, num_threads);
+      break;
+    case 4:
+      TransposeByPlan(
+          static_cast<const uint32_t*>(in), static_cast<uint32_t*>(out), plan, num_threads);
+      break;
+    case 8:
+      TransposeByPlan(
+          static_cast<const uint64_t*>(in), static_cast<uint64_t*>(out), plan, num_threads);
+      break;
+    default:
+      LOG(FATAL) << "TransposeCPU does not support elements of " << type_size << " bytes";
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
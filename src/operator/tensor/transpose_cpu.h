@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file transpose_cpu.h
+ * \brief transpose of the CPU arrays of any number of dimensions, by tiles transposed in the
+ *  registers of the CPU instruction sets
+ */
+#ifndef MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_H_
+#define MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_H_
+
+#include <mxnet/base.h>
+#include <mxnet/tuple.h>
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief writes to out the transpose by axes of in, of shape and elements of type_size bytes.
+ *  The dimensions of size 1 are dropped and the ones staying next to each other are collapsed,
+ *  so that (0, 2, 1, 3) moves rows of the last dimension. When the last dimension moves, the
+ *  two dimensions contiguous in the input and in the output are transposed by tiles of 32 x 32
+ *  elements, spread over the OpenMP threads, with 8 x 8 or 16 x 16 in-register transposes of the
+ *  4 byte elements on the CPUs with AVX2 or AVX-512.
+ */
+void TransposeCPU(const void* in,
+                  void* out,
+                  const mxnet::TShape& shape,
+                  const mxnet::TShape& axes,
+                  size_t type_size);
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_TENSOR_TRANSPOSE_CPU_H_
@@ -126,7 +126,10 @@ void TVMOpModule::Call(const std::string& func_name,
     TVMSetStream(dev_type, dev_id, stream);
   }
 #endif
-  GetFunction(module_ptr_, func_name, args).CallPacked(tvm_args, &rv);
+  PackedFunc func = GetFunction(module_ptr_, func_name, args);
+  CHECK(func != nullptr) << "TVM operator kernel " << func_name << " of the arguments is not in "
+                         << "the TVM operator library";
+  func.CallPacked(tvm_args, &rv);
 #if MXNET_USE_CUDA
   if (dev_type == kDLGPU) {
     TVMSetStream(dev_type, dev_id, nullptr);
@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file vectorized_math-inl.h
+ * \brief float32 exp, log, tanh and erf of the cpu the compiler vectorizes in the loops of the
+ *  elementwise kernels, unlike the calls to libm. Branch free: the selects are of the integer
+ *  bits, gcc does not if-convert the float comparisons with -ftrapping-math.
+ */
+#ifndef MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
+#define MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
+
+#include <mshadow/base.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#ifndef MXNET_USE_VECTORIZED_MATH
+#define MXNET_USE_VECTORIZED_MATH 1
+#endif
+
+namespace mxnet {
+namespace op {
+namespace math {
+namespace vec {
+
+MSHADOW_FORCE_INLINE float as_float(const int32_t bits) {
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+MSHADOW_FORCE_INLINE int32_t as_int(const float f) {
+  int32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+/*!
+ * \brief the bits t if c else f. A mask rather than a ternary, gcc branches around the
+ *  computation of the unused operand
+ */
+MSHADOW_FORCE_INLINE int32_t select(const bool c, const int32_t t, const int32_t f) {
+  const int32_t mask = -static_cast<int32_t>(c);
+  return (mask & t) | (~mask & f);
+}
+
+/*!
+ * \brief e^a, cephes expf, at most 1 ulp from expf. Overflows to inf and underflows to 0 by
+ *  the clamp, so that there are no branches.
+ */
+MSHADOW_FORCE_INLINE float exp(const float a) {
+  // clamped as integers, the bits of key are ordered as the floats
+  const int32_t bits = as_int(a);
+  int32_t key        = bits ^ ((bits >> 31) & 0x7fffffff);
+  key                = std::min(std::max(key, -0x42d00000 - 1), 0x42b20000);
+  const float x      = as_float(key ^ ((key >> 31) & 0x7fffffff));
+  // x = n ln2 + r, |r| <= ln2 / 2, ln2 split in two for the precision of r. n is rounded by
+  // the 1.5 * 2^23 trick, floor does not vectorize without -fno-trapping-math
+  const float n = (x * 1.44269504088896341f + 12582912.0f) - 12582912.0f;
+  const float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+  float p       = 1.9875691500e-4f;
+  p             = p * r + 1.3981999507e-3f;
+  p             = p * r + 8.3334519073e-3f;
+  p             = p * r + 4.1665795894e-2f;
+  p             = p * r + 1.6666665459e-1f;
+  p             = p * r + 5.0000001201e-1f;
+  p             = p * r * r + r + 1.0f;
+
+  // 2^n as the product of two normal floats, n is in [-150, 128]
+  const int32_t n1 = static_cast<int32_t>(n) >> 1;
+  const int32_t n2 = static_cast<int32_t>(n) - n1;
+  const float y    = p * as_float((n1 + 127) << 23) * as_float((n2 + 127) << 23);
+  return as_float(select((bits & 0x7fffffff) > 0x7f800000, bits, as_int(y)));
+}
+
+/*! \brief natural logarithm of a, cephes logf, at most 1 ulp from logf */
+MSHADOW_FORCE_INLINE float log(const float a) {
+  const int32_t bits  = as_int(a);
+  const bool denormal = bits < 0x00800000;
+  const int32_t ix    = select(denormal, as_int(a * 8388608.0f), bits);
+  // a = (1 + m) 2^e, 1 + m in [sqrt(1/2), sqrt(2))
+  const int32_t shifted = ix - 0x3f3504f3;
+  const float e         = static_cast<float>((shifted >> 23) - select(denormal, 23, 0));
+  const float m         = as_float((shifted & 0x007fffff) + 0x3f3504f3) - 1.0f;
+  const float z         = m * m;
+  float p               = 7.0376836292e-2f;
+  p             = p * m - 1.1514610310e-1f;
+  p             = p * m + 1.1676998740e-1f;
+  p             = p * m - 1.2420140846e-1f;
+  p             = p * m + 1.4249322787e-1f;
+  p             = p * m - 1.6668057665e-1f;
+  p             = p * m + 2.0000714765e-1f;
+  p             = p * m - 2.4999993993e-1f;
+  p             = p * m + 3.3333331174e-1f;
+  const float y = m + (p * m * z - 2.12194440e-4f * e - 0.5f * z) + 0.693359375f * e;
+  // log(inf) = inf, log(nan) = nan, log(+-0) = -inf, log(negative) = nan
+  int32_t out = as_int(y);
+  out         = select(bits >= 0x7f800000, bits, out);
+  out         = select((bits & 0x7fffffff) == 0, static_cast<int32_t>(0xff800000), out);
+  out         = select((bits < 0) & (bits != INT32_MIN), 0x7fc00000, out);
+  return as_float(out);
+}
+
+/*! \brief hyperbolic tangent of a, cephes tanhf, at most 2 ulp from tanhf */
+MSHADOW_FORCE_INLINE float tanh(const float a) {
+  const float x = std::fabs(a);
+  // a polynomial below 0.625, else 1 - 2 / (e^2x + 1)
+  const float z = x * x;
+  float p       = -5.70498872745e-3f;
+  p             = p * z + 2.06390887954e-2f;
+  p             = p * z - 5.37397155531e-2f;
+  p             = p * z + 1.33314422036e-1f;
+  p             = p * z - 3.33332819422e-1f;
+
+  const int32_t small = as_int(p * z * x + x);
+  const int32_t large = as_int(1.0f - 2.0f / (exp(x + x) + 1.0f));
+  return std::copysign(as_float(select(as_int(x) < 0x3f200000, small, large)), a);
+}
+
+/*!
+ * \brief error function of a, at most 3 ulp from erff. cephes erff below 1, else
+ *  Abramowitz and Stegun 7.1.26
+ */
+MSHADOW_FORCE_INLINE float erf(const float a) {
+  const float x = std::fabs(a);
+  const float z = x * x;
+  float p       = 7.853861353153693e-5f;
+  p             = p * z - 8.010193625184903e-4f;
+  p             = p * z + 5.188327685732524e-3f;
+  p             = p * z - 2.685381193529856e-2f;
+  p             = p * z + 1.128358514861418e-1f;
+  p             = p * z - 3.761262582423300e-1f;
+  p             = p * z + 1.128379165726710f;
+
+  const float t = 1.0f / (1.0f + 0.3275911f * x);
+  float q       = 1.061405429f;
+  q             = q * t - 1.453152027f;
+  q             = q * t + 1.421413741f;
+  q             = q * t - 0.284496736f;
+  q             = q * t + 0.254829592f;
+
+  const int32_t small = as_int(x * p);
+  const int32_t large = as_int(1.0f - q * t * exp(-z));
+  return std::copysign(as_float(select(as_int(x) < 0x3f800000, small, large)), a);
+}
+
+}  // namespace vec
+}  // namespace math
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_VECTORIZED_MATH_INL_H_
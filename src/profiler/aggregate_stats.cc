@@ -23,7 +23,9 @@
  */
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <mxnet/base.h>
+#include <algorithm>
 #include <fstream>
 #include <thread>
 #include <iomanip>
@@ -46,6 +48,45 @@ inline float ByteToKilobyte(const DType byte) {
   return static_cast<float>(static_cast<double>(byte) / 1000);
 }
 
+/*! \brief achieved throughput of the operators with a FComputeCost */
+struct Roofline {
+  double gflops, gbps, intensity, efficiency;
+  explicit Roofline(const AggregateStats::StatData& data) {
+    // the peaks of the device the operators ran on, efficiency is negative if unknown
+    static const double peak_gflops = dmlc::GetEnv("MXNET_PROFILER_PEAK_GFLOPS", 0.0);
+    static const double peak_gbps   = dmlc::GetEnv("MXNET_PROFILER_PEAK_GBPS", 0.0);
+    const double ns = std::max<double>(data.total_aggregate_, 1) * 1e3;
+    gflops          = data.total_flops_ / ns;
+    gbps            = data.total_bytes_ / ns;
+    intensity       = 0;
+    if (data.total_bytes_)
+      intensity = static_cast<double>(data.total_flops_) / data.total_bytes_;
+    efficiency = -1;
+    if (peak_gflops > 0) {
+      const double attainable =
+          peak_gbps > 0 ? std::min(peak_gflops, intensity * peak_gbps) : peak_gflops;
+      efficiency = attainable > 0 ? 100 * gflops / attainable : 0;
+    }
+  }
+};
+
+/*! \brief efficiency of the CPU operators from their hardware counters */
+struct HardwareCounters {
+  double ipc, miss_rate, mpki, dram_gbps;
+  explicit HardwareCounters(const AggregateStats::StatData& data) {
+    // every last level cache miss loads a cache line from memory
+    constexpr double kCacheLine = 64;
+    const double ns           = std::max<double>(data.counters_time_, 1) * 1e3;
+    const double cycles       = std::max<double>(data.total_cycles_, 1);
+    const double instructions = std::max<double>(data.total_instructions_, 1);
+    const double references   = std::max<double>(data.total_llc_references_, 1);
+    ipc                       = data.total_instructions_ / cycles;
+    miss_rate                 = 100 * data.total_llc_misses_ / references;
+    mpki                      = 1e3 * data.total_llc_misses_ / instructions;
+    dram_gbps                 = kCacheLine * data.total_llc_misses_ / ns;
+  }
+};
+
 inline std::priority_queue<pi> BuildHeap(
     const std::unordered_map<std::string, AggregateStats::StatData>& map,
     int sort_by,
@@ -92,6 +133,29 @@ void AggregateStats::OnProfileStat(const ProfileStat& stat) {
   }
 }
 
+void AggregateStats::OnDuration(const std::string& category,
+                                const std::string& name,
+                                uint64_t duration) {
+  std::unique_lock<std::mutex> lk(m_);
+  StatData& data = stats_[category][name];
+  data.type_     = StatData::kDuration;
+  ++data.total_count_;
+  data.total_aggregate_ += duration;
+  data.max_aggregate_ = std::max(data.max_aggregate_, duration);
+  data.min_aggregate_ = std::min(data.min_aggregate_, duration);
+}
+
+void AggregateStats::ForEach(
+    const std::string& category,
+    const std::function<void(const std::string&, const StatData&)>& fvisit) {
+  std::unique_lock<std::mutex> lk(m_);
+  auto iter = stats_.find(category);
+  if (iter == stats_.end())
+    return;
+  for (const auto& kv : iter->second)
+    fvisit(kv.first, kv.second);
+}
+
 void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
   std::ios state(nullptr);
   state.copyfmt(os);
@@ -139,11 +203,86 @@ void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
       heap.pop();
     }
     os << std::endl;
+    DumpRooflineTable(os, type, mm, sort_by, ascending);
+    DumpCountersTable(os, type, mm, sort_by, ascending);
   }
   os << std::flush;
   os.copyfmt(state);
 }
 
+void AggregateStats::DumpRooflineTable(std::ostream& os,
+                                       const std::string& type,
+                                       const std::unordered_map<std::string, StatData>& mm,
+                                       int sort_by,
+                                       int ascending) {
+  bool has_cost = false;
+  for (const auto& iter : mm)
+    has_cost = has_cost || iter.second.total_flops_ > 0;
+  if (!has_cost)
+    return;
+  os << type << " Roofline" << std::endl << "=================" << std::endl;
+  os << std::setw(25) << std::left << "Name" << std::setw(16) << std::right << "GFLOP/s" << " "
+     << std::setw(16) << std::right << "GB/s" << " " << std::setw(16) << std::right
+     << "FLOP/Byte" << " " << std::setw(16) << std::right << "Efficiency (%)" << std::endl;
+  os << std::setw(25) << std::left << "----" << std::setw(16) << std::right << "-------" << " "
+     << std::setw(16) << std::right << "----" << " " << std::setw(16) << std::right
+     << "---------" << " " << std::setw(16) << std::right << "--------------" << std::endl;
+  auto heap = BuildHeap(mm, sort_by, ascending);
+  while (!heap.empty()) {
+    const std::string& name = heap.top().second;
+    const StatData& data    = mm.at(name);
+    if (data.total_flops_ > 0) {
+      const Roofline roofline(data);
+      os << std::setw(25) << std::left << name << std::fixed << std::setprecision(4)
+         << std::setw(16) << std::right << roofline.gflops << " " << std::setw(16) << std::right
+         << roofline.gbps << " " << std::setw(16) << std::right << roofline.intensity << " "
+         << std::setw(16) << std::right;
+      if (roofline.efficiency >= 0)
+        os << roofline.efficiency << std::endl;
+      else
+        os << "-" << std::endl;
+    }
+    heap.pop();
+  }
+  os << std::endl;
+}
+
+void AggregateStats::DumpCountersTable(std::ostream& os,
+                                       const std::string& type,
+                                       const std::unordered_map<std::string, StatData>& mm,
+                                       int sort_by,
+                                       int ascending) {
+  bool has_counters = false;
+  for (const auto& iter : mm)
+    has_counters = has_counters || iter.second.counters_count_ > 0;
+  if (!has_counters)
+    return;
+  os << type << " Hardware Counters" << std::endl << "=================" << std::endl;
+  os << std::setw(25) << std::left << "Name" << std::setw(16) << std::right << "Count" << " "
+     << std::setw(16) << std::right << "IPC" << " " << std::setw(16) << std::right
+     << "LLC Miss (%)" << " " << std::setw(16) << std::right << "LLC MPKI" << " "
+     << std::setw(16) << std::right << "DRAM GB/s" << std::endl;
+  os << std::setw(25) << std::left << "----" << std::setw(16) << std::right << "-----" << " "
+     << std::setw(16) << std::right << "---" << " " << std::setw(16) << std::right
+     << "------------" << " " << std::setw(16) << std::right << "--------" << " "
+     << std::setw(16) << std::right << "---------" << std::endl;
+  auto heap = BuildHeap(mm, sort_by, ascending);
+  while (!heap.empty()) {
+    const std::string& name = heap.top().second;
+    const StatData& data    = mm.at(name);
+    if (data.counters_count_ > 0) {
+      const HardwareCounters counters(data);
+      os << std::setw(25) << std::left << name << std::setw(16) << std::right
+         << data.counters_count_ << " " << std::fixed << std::setprecision(4) << std::setw(16)
+         << std::right << counters.ipc << " " << std::setw(16) << std::right
+         << counters.miss_rate << " " << std::setw(16) << std::right << counters.mpki << " "
+         << std::setw(16) << std::right << counters.dram_gbps << std::endl;
+    }
+    heap.pop();
+  }
+  os << std::endl;
+}
+
 void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
   std::ios state(nullptr);
   state.copyfmt(os);
@@ -174,6 +313,29 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
         if (!is_memory)
           *ss << "                \"Total\": " << std::setprecision(4)
               << MicroToMilli(data.total_aggregate_) << "," << std::endl;
+        if (data.total_flops_ > 0) {
+          const Roofline roofline(data);
+          *ss << "                \"GFLOP/s\": " << std::setprecision(4) << roofline.gflops
+              << "," << std::endl
+              << "                \"GB/s\": " << std::setprecision(4) << roofline.gbps << ","
+              << std::endl
+              << "                \"FLOP/Byte\": " << std::setprecision(4) << roofline.intensity
+              << "," << std::endl;
+          if (roofline.efficiency >= 0)
+            *ss << "                \"Efficiency\": " << std::setprecision(4)
+                << roofline.efficiency << "," << std::endl;
+        }
+        if (data.counters_count_ > 0) {
+          const HardwareCounters counters(data);
+          *ss << "                \"IPC\": " << std::setprecision(4) << counters.ipc << ","
+              << std::endl
+              << "                \"LLC Miss Rate\": " << std::setprecision(4)
+              << counters.miss_rate << "," << std::endl
+              << "                \"LLC MPKI\": " << std::setprecision(4) << counters.mpki << ","
+              << std::endl
+              << "                \"DRAM GB/s\": " << std::setprecision(4) << counters.dram_gbps
+              << "," << std::endl;
+        }
         *ss << "                \"Min\": " << std::setprecision(4)
             << (is_memory ? ByteToKilobyte(data.min_aggregate_) : MicroToMilli(data.min_aggregate_))
             << "," << std::endl
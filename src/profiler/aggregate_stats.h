@@ -23,6 +23,7 @@
 #include <string>
 #include <map>
 #include <cstdint>
+#include <functional>
 #include <ostream>
 #include <mutex>
 #include "./profiler.h"
@@ -45,6 +46,16 @@ class AggregateStats {
     uint64_t total_aggregate_ = 0;
     uint64_t max_aggregate_   = 0;
     uint64_t min_aggregate_   = INT_MAX;
+    /*! \brief floating point operations and bytes of the operators with a FComputeCost */
+    uint64_t total_flops_ = 0;
+    uint64_t total_bytes_ = 0;
+    /*! \brief hardware counters of the executions which have some, and their duration */
+    size_t counters_count_         = 0;
+    uint64_t counters_time_        = 0;
+    uint64_t total_cycles_         = 0;
+    uint64_t total_instructions_   = 0;
+    uint64_t total_llc_references_ = 0;
+    uint64_t total_llc_misses_     = 0;
   };
 
   /*!
@@ -52,6 +63,13 @@ class AggregateStats {
    * \param stat SIngle profile statistics to add to the accumulates statistics
    */
   void OnProfileStat(const ProfileStat& stat);
+  /*!
+   * \brief Record a duration measured outside of a profile statistic
+   * \param category Category of the duration
+   * \param name Name of the duration
+   * \param duration Duration in microseconds
+   */
+  void OnDuration(const std::string& category, const std::string& name, uint64_t duration);
   /*!
    * \brief Print profliing statistics to console in a tabular format
    * \param sort_by by which stat to sort the entries, can be "avg", "min", "max", or "count"
@@ -64,6 +82,13 @@ class AggregateStats {
    * \param ascending whether to sort ascendingly
    */
   void DumpJson(std::ostream& os, int sort_by, int ascending);
+  /*!
+   * \brief Visit the statistics of a category under the lock
+   * \param category Category of the statistics
+   * \param fvisit Function called with the name and the data of each statistic
+   */
+  void ForEach(const std::string& category,
+               const std::function<void(const std::string&, const StatData&)>& fvisit);
   /*!
    * \brief Delete all of the current statistics
    */
@@ -72,6 +97,26 @@ class AggregateStats {
   enum class SortBy { Total, Avg, Min, Max, Count };
 
  private:
+  /*!
+   * \brief Print the achieved GFLOP/s, GB/s and arithmetic intensity of the statistics of a
+   *  category which have a cost, and their efficiency against the roofline of the peaks set
+   *  by MXNET_PROFILER_PEAK_GFLOPS and MXNET_PROFILER_PEAK_GBPS. The lock must be held.
+   */
+  void DumpRooflineTable(std::ostream& os,
+                         const std::string& type,
+                         const std::unordered_map<std::string, StatData>& mm,
+                         int sort_by,
+                         int ascending);
+  /*!
+   * \brief Print the instructions per cycle, the last level cache miss rate and misses per
+   *  thousand instructions, and the DRAM bandwidth they imply, of the statistics of a category
+   *  which have hardware counters. The lock must be held.
+   */
+  void DumpCountersTable(std::ostream& os,
+                         const std::string& type,
+                         const std::unordered_map<std::string, StatData>& mm,
+                         int sort_by,
+                         int ascending);
   /*! \brief Should rarely collide, so most locks should occur only in user-space (futex) */
   std::mutex m_;
   /* !\brief Stat type -> State name -> Stats */
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "./io_profiler.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+const char* const kStageNames[IOProfiler::kNumStages] = {
+    "Read", "Decode", "Augmentation", "Batchify", "Consumer Wait"};
+const char* const kQueueNames[IOProfiler::kNumQueues] = {"Prefetch", "Loader"};
+}  // namespace
+
+IOProfiler* IOProfiler::Get() {
+  static IOProfiler inst;
+  return &inst;
+}
+
+IOProfiler::IOProfiler() : domain_("MXNET_IO") {
+  for (int i = 0; i < kNumStages; ++i) {
+    const std::string name = std::string("IO ") + kStageNames[i] + " Time (us)";
+    stage_counters_[i].reset(new ProfileCounter(name.c_str(), &domain_));
+    stage_us_[i]    = 0;
+    stage_count_[i] = 0;
+  }
+  bytes_counter_.reset(new ProfileCounter("IO Bytes Read", &domain_));
+  for (int i = 0; i < kNumQueues; ++i) {
+    const std::string name = std::string("IO ") + kQueueNames[i] + " Queue Depth";
+    queue_counters_[i].reset(new ProfileCounter(name.c_str(), &domain_));
+  }
+}
+
+std::string IOProfiler::Summary(bool reset) {
+  uint64_t us[kNumStages], count[kNumStages];
+  bool recorded = false;
+  for (int i = 0; i < kNumStages; ++i) {
+    us[i]    = reset ? stage_us_[i].exchange(0) : stage_us_[i].load();
+    count[i] = reset ? stage_count_[i].exchange(0) : stage_count_[i].load();
+    recorded = recorded || count[i] > 0;
+  }
+  const uint64_t bytes = reset ? bytes_read_.exchange(0) : bytes_read_.load();
+  if (!recorded)
+    return std::string();
+  // the consumer waits for the stages producing the batches
+  int slowest = kRead;
+  for (int i = kRead; i < kConsumerWait; ++i) {
+    if (us[i] > us[slowest])
+      slowest = i;
+  }
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(4) << "\nInput Pipeline Statistics:\n"
+     << "=========================\n\n"
+     << std::setw(24) << std::left << "Stage" << std::setw(16) << std::right << "Count"
+     << std::setw(24) << "Total Time (ms)" << std::setw(24) << "Avg Time (ms)\n"
+     << std::setw(24) << std::left << "-----" << std::setw(16) << std::right << "-----"
+     << std::setw(24) << "---------------" << std::setw(24) << "-------------\n";
+  for (int i = 0; i < kNumStages; ++i) {
+    os << std::setw(24) << std::left << kStageNames[i] << std::setw(16) << std::right << count[i]
+       << std::setw(24) << us[i] / 1000.0 << std::setw(23)
+       << (count[i] > 0 ? us[i] / 1000.0 / count[i] : 0.0) << "\n";
+  }
+  os << "\nBytes Read: " << bytes << "\n"
+     << "Slowest Stage: " << kStageNames[slowest]
+     << " (times are summed over the threads of each stage)\n";
+  return os.str();
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_PROFILER_IO_PROFILER_H_
+#define MXNET_PROFILER_IO_PROFILER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Timing of the stages of the input pipelines via ProfileCounters, recorded while
+ *  the profiler is running
+ */
+class IOProfiler {
+ public:
+  /*! \brief stages of the input pipelines */
+  enum Stage { kRead = 0, kDecode, kAugment, kBatchify, kConsumerWait, kNumStages };
+  /*! \brief queues of the input pipelines */
+  enum Queue { kPrefetchQueue = 0, kLoaderQueue, kNumQueues };
+
+  /*! \brief get the global instance */
+  static IOProfiler* Get();
+
+  /*! \return whether the stages are recorded */
+  static bool IsProfiling() {
+    return Profiler::Get()->GetState() == Profiler::kRunning;
+  }
+
+  /*! \brief record the time spent in a stage, summed over the threads of the stage */
+  void AddTime(Stage stage, uint64_t us) {
+    if (!IsProfiling())
+      return;
+    stage_us_[stage] += us;
+    ++stage_count_[stage];
+    *stage_counters_[stage] += us;
+  }
+
+  /*! \brief record the bytes read from the input files */
+  void AddBytesRead(uint64_t bytes) {
+    if (!IsProfiling())
+      return;
+    bytes_read_ += bytes;
+    *bytes_counter_ += bytes;
+  }
+
+  /*! \brief record the number of batches waiting in a queue */
+  void SetQueueDepth(Queue queue, uint64_t depth) {
+    if (!IsProfiling())
+      return;
+    *queue_counters_[queue] = depth;
+  }
+
+  /*!
+   * \brief Summary of the stages recorded since the last reset, which names the slowest stage
+   * \param reset whether to reset the stages
+   * \return the summary as a table, empty if no stage was recorded
+   */
+  std::string Summary(bool reset);
+
+ private:
+  IOProfiler();
+
+  /*! \brief Domain of the input pipeline counters */
+  ProfileDomain domain_;
+  /*! \brief time of each stage in microseconds */
+  std::unique_ptr<ProfileCounter> stage_counters_[kNumStages];
+  /*! \brief bytes read from the input files */
+  std::unique_ptr<ProfileCounter> bytes_counter_;
+  /*! \brief depth of each queue */
+  std::unique_ptr<ProfileCounter> queue_counters_[kNumQueues];
+  /*! \brief totals since the last summary reset */
+  std::atomic<uint64_t> stage_us_[kNumStages];
+  std::atomic<uint64_t> stage_count_[kNumStages];
+  std::atomic<uint64_t> bytes_read_{0};
+};
+
+/*!
+ * \brief Record the time spent in a stage of the input pipelines until destruction
+ */
+class IOStageTimer {
+ public:
+  explicit IOStageTimer(IOProfiler::Stage stage)
+      : stage_(stage), start_(IOProfiler::IsProfiling() ? ProfileStat::NowInMicrosec() : 0) {}
+  ~IOStageTimer() {
+    if (start_ != 0)
+      IOProfiler::Get()->AddTime(stage_, ProfileStat::NowInMicrosec() - start_);
+  }
+
+ private:
+  IOProfiler::Stage stage_;
+  uint64_t start_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_IO_PROFILER_H_
@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "./openmetrics.h"
+#include <mxnet/engine.h>
+#include <mxnet/storage.h>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if MXNET_USE_ONEDNN == 1
+#include "../operator/nn/mkldnn/mkldnn_cache-inl.h"
+#endif  // MXNET_USE_ONEDNN == 1
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+const char* const kCallNames[KVStoreMetrics::kNumCalls] = {"push", "pull", "pushpull"};
+
+std::string EscapeLabel(const std::string& value) {
+  std::string escaped;
+  for (const char c : value) {
+    if (c == '\\' || c == '"')
+      escaped += '\\';
+    if (c == '\n')
+      escaped += "\\n";
+    else
+      escaped += c;
+  }
+  return escaped;
+}
+
+void Family(std::ostream* os, const char* name, const char* type, const char* help) {
+  *os << "# TYPE " << name << " " << type << "\n# HELP " << name << " " << help << "\n";
+}
+
+void Seconds(std::ostream* os, uint64_t us) {
+  *os << std::fixed << std::setprecision(6) << static_cast<double>(us) / 1e6
+      << std::defaultfloat << "\n";
+}
+}  // namespace
+
+KVStoreMetrics* KVStoreMetrics::Get() {
+  static KVStoreMetrics inst;
+  return &inst;
+}
+
+KVStoreMetrics::KVStoreMetrics() {
+  for (int i = 0; i < kNumCalls; ++i) {
+    calls_[i] = 0;
+    bytes_[i] = 0;
+    us_[i]    = 0;
+  }
+}
+
+void KVStoreMetrics::Append(std::string* text) const {
+  std::ostringstream os;
+  Family(&os, "mxnet_kvstore_bytes", "counter", "Bytes of the arrays passed to the kvstore calls.");
+  for (int i = 0; i < kNumCalls; ++i)
+    os << "mxnet_kvstore_bytes_total{call=\"" << kCallNames[i] << "\"} " << bytes_[i] << "\n";
+  Family(&os, "mxnet_kvstore_call_seconds", "summary", "Time to issue the kvstore calls.");
+  for (int i = 0; i < kNumCalls; ++i) {
+    os << "mxnet_kvstore_call_seconds_sum{call=\"" << kCallNames[i] << "\"} ";
+    Seconds(&os, us_[i]);
+    os << "mxnet_kvstore_call_seconds_count{call=\"" << kCallNames[i] << "\"} " << calls_[i]
+       << "\n";
+  }
+  *text += os.str();
+}
+
+std::string OpenMetricsText() {
+  std::ostringstream os;
+  uint64_t num_executed = 0, num_pending = 0;
+  std::vector<std::pair<std::string, uint64_t>> queue_depths;
+  Engine::Get()->load_stats(&num_executed, &num_pending, &queue_depths);
+  Family(&os, "mxnet_engine_operations_executed", "counter", "Operations pushed to the engine.");
+  os << "mxnet_engine_operations_executed_total " << num_executed << "\n";
+  Family(&os, "mxnet_engine_pending_operations", "gauge", "Operations not completed yet.");
+  os << "mxnet_engine_pending_operations " << num_pending << "\n";
+  Family(&os, "mxnet_engine_queue_depth", "gauge", "Operations waiting in the worker queues.");
+  for (const auto& depth : queue_depths)
+    os << "mxnet_engine_queue_depth{pool=\"" << EscapeLabel(depth.first) << "\"} "
+       << depth.second << "\n";
+
+  const auto usage = Storage::Get()->PoolUsage();
+  Family(&os, "mxnet_storage_pool_held_bytes", "gauge", "Bytes held by the memory pools.");
+  for (const auto& pool : usage)
+    os << "mxnet_storage_pool_held_bytes{context=\"" << std::get<0>(pool) << "\"} "
+       << std::get<1>(pool) << "\n";
+  Family(&os, "mxnet_storage_pool_used_bytes", "gauge", "Bytes of the pools handed out.");
+  for (const auto& pool : usage)
+    os << "mxnet_storage_pool_used_bytes{context=\"" << std::get<0>(pool) << "\"} "
+       << std::get<2>(pool) << "\n";
+
+#if MXNET_USE_ONEDNN == 1
+  const MKLDNNCacheStats* cache = MKLDNNCacheStats::Get();
+  Family(&os, "mxnet_onednn_cache_hits", "counter", "Primitives found in the oneDNN caches.");
+  os << "mxnet_onednn_cache_hits_total " << cache->hits << "\n";
+  Family(&os, "mxnet_onednn_cache_misses", "counter", "Primitives created by the operators.");
+  os << "mxnet_onednn_cache_misses_total " << cache->misses << "\n";
+  Family(&os, "mxnet_onednn_cache_evictions", "counter", "Primitives evicted from the caches.");
+  os << "mxnet_onednn_cache_evictions_total " << cache->evictions << "\n";
+  Family(&os, "mxnet_onednn_cache_entries", "gauge", "Primitives held by the oneDNN caches.");
+  os << "mxnet_onednn_cache_entries " << cache->entries << "\n";
+  Family(&os, "mxnet_onednn_cache_bytes", "gauge", "Estimated bytes of the cached primitives.");
+  os << "mxnet_onednn_cache_bytes " << cache->bytes << "\n";
+#endif  // MXNET_USE_ONEDNN == 1
+
+  std::string text = os.str();
+  KVStoreMetrics::Get()->Append(&text);
+
+  // the operators are only aggregated while the profiler runs with aggregate_stats set
+  std::ostringstream ops;
+  Family(&ops, "mxnet_operator_time_seconds", "counter", "Time spent in the operators.");
+  std::ostringstream counts;
+  Family(&counts, "mxnet_operator_executions", "counter", "Executions of the operators.");
+  std::shared_ptr<AggregateStats> stats = Profiler::Get()->GetAggregateStats();
+  if (stats) {
+    stats->ForEach("operator", [&](const std::string& name, const AggregateStats::StatData& d) {
+      ops << "mxnet_operator_time_seconds_total{op=\"" << EscapeLabel(name) << "\"} ";
+      Seconds(&ops, d.total_aggregate_);
+      counts << "mxnet_operator_executions_total{op=\"" << EscapeLabel(name) << "\"} "
+             << d.total_count_ << "\n";
+    });
+  }
+  text += ops.str() + counts.str() + "# EOF\n";
+  return text;
+}
+
+}  // namespace profiler
+}  // namespace mxnet
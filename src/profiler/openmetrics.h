@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_PROFILER_OPENMETRICS_H_
+#define MXNET_PROFILER_OPENMETRICS_H_
+
+#include <atomic>
+#include <string>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Calls, bytes and latencies of the kvstore calls, always recorded for the exporter
+ */
+class KVStoreMetrics {
+ public:
+  /*! \brief kvstore calls */
+  enum Call { kPush = 0, kPull, kPushPull, kNumCalls };
+
+  /*! \brief get the global instance */
+  static KVStoreMetrics* Get();
+
+  /*! \brief record a call of the kvstore */
+  void Record(Call call, uint64_t bytes, uint64_t us) {
+    calls_[call].fetch_add(1, std::memory_order_relaxed);
+    bytes_[call].fetch_add(bytes, std::memory_order_relaxed);
+    us_[call].fetch_add(us, std::memory_order_relaxed);
+  }
+
+  /*! \brief append the metric families of the kvstore calls */
+  void Append(std::string* text) const;
+
+ private:
+  KVStoreMetrics();
+
+  std::atomic<uint64_t> calls_[kNumCalls];
+  std::atomic<uint64_t> bytes_[kNumCalls];
+  std::atomic<uint64_t> us_[kNumCalls];
+};
+
+/*!
+ * \brief Record a kvstore call until destruction. The calls only push the operations to the
+ *  engine, so the latency is the time to issue the call, not to complete the transfer.
+ */
+class KVStoreCallTimer {
+ public:
+  KVStoreCallTimer(KVStoreMetrics::Call call, uint64_t bytes)
+      : call_(call), bytes_(bytes), start_(ProfileStat::NowInMicrosec()) {}
+  ~KVStoreCallTimer() {
+    KVStoreMetrics::Get()->Record(call_, bytes_, ProfileStat::NowInMicrosec() - start_);
+  }
+
+ private:
+  KVStoreMetrics::Call call_;
+  uint64_t bytes_;
+  uint64_t start_;
+};
+
+/*!
+ * \brief Metrics of the engine, the memory pools, the kvstore and the operators
+ * \return the metrics in the OpenMetrics text exposition format, terminated by "# EOF"
+ */
+std::string OpenMetricsText();
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_OPENMETRICS_H_
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file perf_counters.cc
+ * \brief hardware performance counters of the CPU threads, read through perf_event_open
+ */
+#include "./perf_counters.h"
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace mxnet {
+namespace profiler {
+
+#if defined(__linux__)
+namespace {
+
+/*! \brief whether the counters are enabled and the kernel did not deny them yet */
+std::atomic<bool> perf_counters_available(dmlc::GetEnv("MXNET_PROFILER_PERF_COUNTERS", false));
+
+int OpenCounter(uint32_t type, uint64_t config, int group_fd) {
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size           = sizeof(attr);
+  attr.type           = type;
+  attr.config         = config;
+  attr.disabled       = group_fd == -1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format    = PERF_FORMAT_GROUP;
+  // the calling thread on any CPU
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  group_fd_ = OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (group_fd_ == -1) {
+    if (perf_counters_available.exchange(false)) {
+      LOG(WARNING) << "MXNET_PROFILER_PERF_COUNTERS is set but the hardware counters are not "
+                   << "available: " << strerror(errno) << ". Check kernel.perf_event_paranoid.";
+    }
+    return;
+  }
+  const uint64_t configs[] = {
+      PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+  for (int i = 0; i < 3; ++i)
+    fds_[i] = OpenCounter(PERF_TYPE_HARDWARE, configs[i], group_fd_);
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters() {
+  for (int fd : fds_) {
+    if (fd != -1)
+      close(fd);
+  }
+  if (group_fd_ != -1)
+    close(group_fd_);
+}
+
+PerfCounters* PerfCounters::ThreadLocal() {
+  if (!perf_counters_available.load(std::memory_order_relaxed))
+    return nullptr;
+  static thread_local PerfCounters counters;
+  return counters.group_fd_ != -1 ? &counters : nullptr;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) const {
+  // number of counters of the group, then their values in the order they were opened
+  uint64_t data[5] = {0};
+  if (read(group_fd_, data, sizeof(data)) < static_cast<ssize_t>(2 * sizeof(uint64_t)))
+    return false;
+  uint64_t* counters[] = {&values->cycles,
+                          &values->instructions,
+                          &values->llc_references,
+                          &values->llc_misses};
+  // the counters which the CPU lacks were not opened and are left to 0
+  const int opened[] = {group_fd_, fds_[0], fds_[1], fds_[2]};
+  for (uint64_t i = 0, j = 1; i < 4 && j <= data[0]; ++i) {
+    if (opened[i] != -1)
+      *counters[i] = data[j++];
+  }
+  return true;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+  if (dmlc::GetEnv("MXNET_PROFILER_PERF_COUNTERS", false))
+    LOG(WARNING) << "MXNET_PROFILER_PERF_COUNTERS is only supported on Linux";
+}
+
+PerfCounters::~PerfCounters() {}
+
+PerfCounters* PerfCounters::ThreadLocal() {
+  static PerfCounters warning;
+  return nullptr;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) const {
+  return false;
+}
+
+#endif  // __linux__
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file perf_counters.h
+ * \brief hardware performance counters of the CPU threads, read through perf_event_open
+ */
+#ifndef MXNET_PROFILER_PERF_COUNTERS_H_
+#define MXNET_PROFILER_PERF_COUNTERS_H_
+
+#include <cstdint>
+
+namespace mxnet {
+namespace profiler {
+
+/*! \brief values of the hardware counters of a thread */
+struct PerfCounterValues {
+  uint64_t cycles         = 0;
+  uint64_t instructions   = 0;
+  uint64_t llc_references = 0;
+  uint64_t llc_misses     = 0;
+
+  PerfCounterValues operator-(const PerfCounterValues& other) const {
+    PerfCounterValues diff;
+    diff.cycles         = cycles - other.cycles;
+    diff.instructions   = instructions - other.instructions;
+    diff.llc_references = llc_references - other.llc_references;
+    diff.llc_misses     = llc_misses - other.llc_misses;
+    return diff;
+  }
+};
+
+/*!
+ * \brief Group of the cycles, instructions, last level cache references and misses counters
+ *  of the calling thread, counting in user space. Enabled by MXNET_PROFILER_PERF_COUNTERS on
+ *  Linux, and disabled with a warning when the kernel denies the counters.
+ */
+class PerfCounters {
+ public:
+  /*!
+   * \brief get the counters of the calling thread, opened on first use
+   * \return the counters, or nullptr if they are disabled or unavailable
+   */
+  static PerfCounters* ThreadLocal();
+  /*!
+   * \brief read the counters
+   * \return false if the counters could not be read
+   */
+  bool Read(PerfCounterValues* values) const;
+
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+ private:
+  /*! \brief file descriptor of the group leader, the cycles counter, -1 if unavailable */
+  int group_fd_ = -1;
+  /*! \brief file descriptors of the instructions and cache counters */
+  int fds_[3]   = {-1, -1, -1};
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_PERF_COUNTERS_H_
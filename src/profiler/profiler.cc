@@ -200,19 +200,33 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   // If aggregate stats aren't enabled, this won't cause a locked instruction
   std::shared_ptr<AggregateStats> ptr_aggregate_stats =
       aggregate_stats_.get() ? aggregate_stats_ : nullptr;
+  // the statistics recorded in the arenas of the threads
+  {
+    std::lock_guard<std::mutex> arenas_lock(arenas_mutex_);
+    for (auto it = arenas_.begin(); it != arenas_.end();) {
+      (*it)->Consume([&](ProfileStat* stat, size_t device) {
+        if (device == ProfileStatArena::kNoDevice) {
+          EmitGeneralStat(&file, stat, ptr_aggregate_stats.get());
+        } else {
+          EmitDeviceStat(&file, stat, device, ptr_aggregate_stats.get());
+        }
+      });
+      // the arena of an exited thread is only referenced here
+      if (it->use_count() == 1) {
+        it = arenas_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // the statistics queued while the arenas were full
   for (uint32_t i = 0; i < dev_num; ++i) {
     DeviceStats& d = profile_stat[i];
     ProfileStat* _opr_stat;
     while (d.opr_exec_stats_->try_dequeue(_opr_stat)) {
       CHECK_NOTNULL(_opr_stat);
       std::unique_ptr<ProfileStat> opr_stat(_opr_stat);  // manage lifecycle
-      opr_stat->process_id_ = i;  // lie and set process id to be the device number
-      file << ",\n" << std::endl;
-      opr_stat->EmitEvents(&file);
-      ++num_records_emitted_;
-      if (ptr_aggregate_stats) {
-        ptr_aggregate_stats->OnProfileStat(*_opr_stat);
-      }
+      EmitDeviceStat(&file, opr_stat.get(), i, ptr_aggregate_stats.get());
     }
   }
 
@@ -220,27 +234,10 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   ProfileStat* _profile_stat;
   while (general_stats_.opr_exec_stats_->try_dequeue(_profile_stat)) {
     CHECK_NOTNULL(_profile_stat);
-    file << ",";
     std::unique_ptr<ProfileStat> profile_stat(_profile_stat);  // manage lifecycle
-    CHECK_NE(profile_stat->categories_.c_str()[0], '\0') << "Category must be set";
-    // Currently, category_to_pid_ is only accessed here, so it is protected by this->m_ above
-    auto iter = category_to_pid_.find(profile_stat->categories_.c_str());
-    if (iter == category_to_pid_.end()) {
-      static std::hash<std::string> hash_fn;
-      const size_t this_pid = hash_fn(profile_stat->categories_.c_str());
-      iter = category_to_pid_.emplace(std::make_pair(profile_stat->categories_.c_str(), this_pid))
-                 .first;
-      EmitPid(&file, profile_stat->categories_.c_str(), iter->second);
-      file << ",\n";
-    }
-    profile_stat->process_id_ = iter->second;
-    file << std::endl;
-    profile_stat->EmitEvents(&file);
-    ++num_records_emitted_;
-    if (ptr_aggregate_stats) {
-      ptr_aggregate_stats->OnProfileStat(*profile_stat);
-    }
+    EmitGeneralStat(&file, profile_stat.get(), ptr_aggregate_stats.get());
   }
+  EmitFlows(&file);
 
   if (last_pass) {
     file << "\n" << std::endl;
@@ -252,6 +249,94 @@ void Profiler::DumpProfile(bool perform_cleanup) {
                                                     // Otherwise, profiling stops.
 }
 
+ProfileStatArena* Profiler::ThreadArena() {
+  static thread_local std::shared_ptr<ProfileStatArena> arena;
+  if (!arena) {
+    arena = std::make_shared<ProfileStatArena>();
+    std::lock_guard<std::mutex> lock(arenas_mutex_);
+    arenas_.push_back(arena);
+  }
+  return arena.get();
+}
+
+void Profiler::EmitDeviceStat(std::ostream* os,
+                              ProfileStat* stat,
+                              size_t device,
+                              AggregateStats* aggregate_stats) {
+  stat->process_id_ = device;  // lie and set process id to be the device number
+  *os << ",\n" << std::endl;
+  stat->EmitEvents(os);
+  ++num_records_emitted_;
+  if (aggregate_stats) {
+    aggregate_stats->OnProfileStat(*stat);
+  }
+  auto* opr_stat = dynamic_cast<ProfileOperator::OprExecStat*>(stat);
+  if (opr_stat && opr_stat->opr_id_ != 0) {
+    const size_t tid = std::hash<std::thread::id>{}(stat->thread_id_);
+    flow_sources_[opr_stat->opr_id_] = {
+        stat->items_[ProfileOperator::OprExecStat::kStop].timestamp_, device, tid};
+    if (!opr_stat->deps_.empty()) {
+      flow_targets_.emplace_back(
+          FlowEndpoint{stat->items_[ProfileOperator::OprExecStat::kStart].timestamp_, device, tid},
+          std::move(opr_stat->deps_));
+    }
+  }
+}
+
+void Profiler::EmitFlows(std::ostream* os) {
+  for (const auto& target : flow_targets_) {
+    for (const uint64_t dep : target.second) {
+      auto iter = flow_sources_.find(dep);
+      if (iter == flow_sources_.end()) {
+        iter = prev_flow_sources_.find(dep);
+        if (iter == prev_flow_sources_.end())
+          continue;
+      }
+      const uint64_t id = num_flows_++;
+      const FlowEndpoint* ends[2] = {&iter->second, &target.first};
+      for (int i = 0; i < 2; ++i) {
+        *os << ",\n"
+            << "    {\n"
+            << "        \"name\": \"dependency\",\n"
+            << "        \"cat\": \"dependency\",\n"
+            << "        \"ph\": \"" << (i ? "f" : "s") << "\",\n"
+            << (i ? "        \"bp\": \"e\",\n" : "") << "        \"id\": " << id << ",\n"
+            << "        \"ts\": " << ends[i]->ts << ",\n"
+            << "        \"pid\": " << ends[i]->pid << ",\n"
+            << "        \"tid\": " << ends[i]->tid << "\n"
+            << "    }";
+      }
+    }
+  }
+  flow_targets_.clear();
+  // the operators waited for by the next dump were mostly emitted by this one
+  prev_flow_sources_.swap(flow_sources_);
+  flow_sources_.clear();
+}
+
+void Profiler::EmitGeneralStat(std::ostream* os,
+                               ProfileStat* stat,
+                               AggregateStats* aggregate_stats) {
+  *os << ",";
+  CHECK_NE(stat->categories_.c_str()[0], '\0') << "Category must be set";
+  // Currently, category_to_pid_ is only accessed here, so it is protected by this->m_ above
+  auto iter = category_to_pid_.find(stat->categories_.c_str());
+  if (iter == category_to_pid_.end()) {
+    static std::hash<std::string> hash_fn;
+    const size_t this_pid = hash_fn(stat->categories_.c_str());
+    iter = category_to_pid_.emplace(std::make_pair(stat->categories_.c_str(), this_pid)).first;
+    EmitPid(os, stat->categories_.c_str(), iter->second);
+    *os << ",\n";
+  }
+  stat->process_id_ = iter->second;
+  *os << std::endl;
+  stat->EmitEvents(os);
+  ++num_records_emitted_;
+  if (aggregate_stats) {
+    aggregate_stats->OnProfileStat(*stat);
+  }
+}
+
 static constexpr char TIMER_THREAD_NAME[] = "DumpProfileTimer";
 
 void Profiler::SetContinuousProfileDump(bool continuous_dump, float delay_in_seconds) {
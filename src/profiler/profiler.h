@@ -32,8 +32,13 @@
 #include <mutex>
 #include <memory>
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
 #include "./vtune.h"
 #include "./aggregate_stats.h"
+#include "./perf_counters.h"
 #include "../common/cuda/nvtx.h"
 #include "../common/utils.h"
 
@@ -248,6 +253,66 @@ struct DeviceStats {
   std::shared_ptr<TQueue> opr_exec_stats_ = std::make_shared<TQueue>();
 };
 
+/*!
+ * \brief Ring of preallocated slots, owned by a thread, that the profile statistics of the
+ *  thread are constructed in. The thread is the only producer and DumpProfile the only
+ *  consumer, so recording a statistic takes neither an allocation nor a lock.
+ */
+struct ProfileStatArena {
+  /*! \brief size of the largest statistic held in a slot */
+  static constexpr size_t kSlotSize = 512;
+  /*! \brief number of slots, the statistics recorded while the ring is full are queued */
+  static constexpr size_t kNumSlots = 1024;
+  /*! \brief device index of the statistics not associated with a device */
+  static constexpr size_t kNoDevice = SIZE_MAX;
+
+  struct Slot {
+    alignas(alignof(std::max_align_t)) char data[kSlotSize];
+    /*! \brief device index of the statistic in the slot */
+    size_t device;
+    ProfileStat* stat() {
+      return reinterpret_cast<ProfileStat*>(data);
+    }
+  };
+
+  /*! \brief Destructor, destroy the statistics that were not consumed */
+  ~ProfileStatArena() {
+    for (size_t i = tail_; i != head_; ++i) {
+      slots_[i % kNumSlots].stat()->~ProfileStat();
+    }
+  }
+
+  /*! \return the next free slot of the producer, nullptr if the ring is full */
+  Slot* Acquire() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kNumSlots)
+      return nullptr;
+    return &slots_[head % kNumSlots];
+  }
+  /*! \brief publish the statistic constructed in the slot returned by Acquire() */
+  void Publish() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /*! \brief consume the published statistics, which are destroyed after fn returns */
+  template <typename Fn>
+  void Consume(Fn fn) {
+    const size_t head = head_.load(std::memory_order_acquire);
+    size_t tail       = tail_.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      Slot& slot = slots_[tail % kNumSlots];
+      fn(slot.stat(), slot.device);
+      slot.stat()->~ProfileStat();
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+ private:
+  std::unique_ptr<Slot[]> slots_{new Slot[kNumSlots]};
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
 /*!
  *  _____              __  _  _
  * |  __ \            / _|(_)| |
@@ -322,9 +387,20 @@ class Profiler {
   template <typename StatType, typename SetExtraInfoFunction, typename... Args>
   void AddNewProfileStat(SetExtraInfoFunction set_extra_info_function, Args... args) {
     if (!paused_) {
-      std::unique_ptr<StatType> stat = CreateProfileStat<StatType>(args...);
-      set_extra_info_function(stat.get());
-      AddProfileStat(&stat);
+      static_assert(std::is_base_of<ProfileStat, StatType>::value, "Not a profile statistic");
+      ProfileStatArena* arena =
+          sizeof(StatType) <= ProfileStatArena::kSlotSize ? ThreadArena() : nullptr;
+      ProfileStatArena::Slot* slot = arena ? arena->Acquire() : nullptr;
+      if (slot) {
+        StatType* stat = new (slot->data) StatType(args...);
+        set_extra_info_function(stat);
+        slot->device = StatDeviceIndex(stat);
+        arena->Publish();
+      } else {
+        std::unique_ptr<StatType> stat = CreateProfileStat<StatType>(args...);
+        set_extra_info_function(stat.get());
+        AddProfileStat(&stat);
+      }
     }
   }
 
@@ -438,9 +514,38 @@ class Profiler {
     general_stats_.opr_exec_stats_->enqueue(stat->release());
   }
 
+  /*!
+   * \brief Device index of a profile statistic
+   * \tparam StatType Type of the statistic object
+   * \param stat The statistic object
+   * \return The index of its device, ProfileStatArena::kNoDevice if it has none
+   */
+  template <typename StatType>
+  inline size_t StatDeviceIndex(const StatType* stat) {
+    return ProfileStatArena::kNoDevice;
+  }
+
+  /*! \return the arena of the calling thread, registered on first use */
+  ProfileStatArena* ThreadArena();
+
   /*! \brief generate device information following chrome profile file format */
   void EmitPid(std::ostream* os, const std::string& name, size_t pid);
 
+  /*! \brief emit a statistic of a device and add it to the aggregate stats */
+  void EmitDeviceStat(std::ostream* os,
+                      ProfileStat* stat,
+                      size_t device,
+                      AggregateStats* aggregate_stats);
+
+  /*! \brief emit a statistic not associated with a device and add it to the aggregate stats */
+  void EmitGeneralStat(std::ostream* os, ProfileStat* stat, AggregateStats* aggregate_stats);
+
+  /*!
+   * \brief emit a flow event from the end of each operator emitted by this or the previous
+   *  dump to the start of each of its dependents emitted by this dump
+   */
+  void EmitFlows(std::ostream* os);
+
   /*!
    * \brief Set continuous asynchronous profile dump
    * \param continuous_dump Whether to continuously dump profile information
@@ -462,6 +567,10 @@ class Profiler {
   std::unique_ptr<DeviceStats[]> profile_stat;
   /*! \brief Stats not associated directly with a device */
   DeviceStats general_stats_;
+  /*! \brief guards the registration of the arenas */
+  std::mutex arenas_mutex_;
+  /*! \brief arenas of the threads, kept until consumed after their thread exits */
+  std::vector<std::shared_ptr<ProfileStatArena>> arenas_;
   /*! \brief Map category -> pid */
   std::unordered_map<std::string, size_t> category_to_pid_;
   /*! \brief cpu number on the machine */
@@ -485,6 +594,18 @@ class Profiler {
   std::shared_ptr<dmlc::ThreadGroup> thread_group_ = std::make_shared<dmlc::ThreadGroup>();
   /* !\brief pids */
   std::unordered_set<uint32_t> process_ids_;
+  /*! \brief an end of a slice of an operator, that a flow event is bound to */
+  struct FlowEndpoint {
+    uint64_t ts;
+    size_t pid;
+    size_t tid;
+  };
+  /*! \brief ends of the operators emitted by this and the previous dump, by operator id */
+  std::unordered_map<uint64_t, FlowEndpoint> flow_sources_, prev_flow_sources_;
+  /*! \brief starts and dependencies of the operators emitted by this dump */
+  std::vector<std::pair<FlowEndpoint, std::vector<uint64_t>>> flow_targets_;
+  /*! \brief number of flow events emitted, the id of the next flow */
+  uint64_t num_flows_ = 0;
 };
 
 #ifdef MXNET_USE_VTUNE
@@ -1127,6 +1248,48 @@ struct ProfileMarker {
 
 static ProfileDomain custom_op_domain("Custom Operator");
 
+/*!
+ * \brief Floating point operations and bytes of the next operator pushed to the engine by
+ *  a thread, set by the imperative runtime while the aggregate stats are recorded
+ */
+struct OperatorCost {
+  uint64_t flops = 0;
+  uint64_t bytes = 0;
+  /*! \brief get the cost of the thread */
+  static OperatorCost* ThreadNext() {
+    static thread_local OperatorCost cost;
+    return &cost;
+  }
+  /*! \brief take the cost, which is cleared */
+  OperatorCost Take() {
+    OperatorCost cost = *this;
+    flops = bytes = 0;
+    return cost;
+  }
+};
+
+/*!
+ * \brief Marks the operator executed by the calling thread, to which the memory timeline
+ *  attributes the allocations of the unnamed arrays
+ */
+class RunningOperatorScope {
+ public:
+  explicit RunningOperatorScope(const char* name) : prev_(Current()) {
+    Current() = name;
+  }
+  ~RunningOperatorScope() {
+    Current() = prev_;
+  }
+  /*! \return the name of the operator executed by the thread, or nullptr */
+  static const char*& Current() {
+    static thread_local const char* name = nullptr;
+    return name;
+  }
+
+ private:
+  const char* prev_;
+};
+
 /*!
  * \brief Operator profiler object. Logs as both an independent event and a task in
  * the operator domain
@@ -1189,6 +1352,22 @@ struct ProfileOperator : public ProfileEvent {
     // make as_task_ not to add stat to AggregateStats; otherwise we will add twice
     as_task_.enableAggregateStats(false);
   }
+  /*!
+   * \brief Set the engine dependencies of the operator, emitted as flow events
+   * \param opr_id Id of the operator in the engine
+   * \param deps Ids of the operators that the operator waited for
+   */
+  void SetDependencies(uint64_t opr_id, std::vector<uint64_t>&& deps) {
+    opr_id_ = opr_id;
+    deps_   = std::move(deps);
+  }
+  /*!
+   * \brief Set the cost of the operator, aggregated to report its throughput
+   * \param cost Floating point operations and bytes of the operator
+   */
+  void SetCost(const OperatorCost& cost) {
+    cost_ = cost;
+  }
   /*!
    * \brief Start the profiling scope
    * \param dev_type Device type that the profiling will occur on
@@ -1200,6 +1379,10 @@ struct ProfileOperator : public ProfileEvent {
     if (profiling_) {
       ProfileEvent::start();
       as_task_.start();
+      // last, so that the counters exclude the profiler
+      counters_ = dev_type == Context::kGPU ? nullptr : PerfCounters::ThreadLocal();
+      if (counters_ != nullptr && !counters_->Read(&counters_start_))
+        counters_ = nullptr;
     }
   }
   /*!
@@ -1207,6 +1390,13 @@ struct ProfileOperator : public ProfileEvent {
    */
   void stop() override {
     if (profiling_) {
+      // only counted when stopped by the thread which started, and so ran, the operator
+      PerfCounterValues values;
+      if (counters_ != nullptr && counters_ == PerfCounters::ThreadLocal() &&
+          counters_->Read(&values)) {
+        counter_values_ = values - counters_start_;
+        has_counters_   = true;
+      }
       as_task_.stop();
       ProfileEvent::stop();
     }
@@ -1249,6 +1439,57 @@ struct ProfileOperator : public ProfileEvent {
     mxnet::Context::DeviceType dev_type_;
     /*! \brief device id */
     uint32_t dev_id_;
+    /*! \brief id of the operator in the engine, 0 if unknown */
+    uint64_t opr_id_ = 0;
+    /*! \brief ids of the operators that the operator waited for */
+    std::vector<uint64_t> deps_;
+    /*! \brief floating point operations and bytes of the operator */
+    OperatorCost cost_;
+    /*! \brief whether the hardware counters of the operator were read */
+    bool has_counters_ = false;
+    /*! \brief hardware counters of the thread during the operator */
+    PerfCounterValues counters_;
+
+    void SaveAggregate(AggregateStats::StatData* data) const override {
+      DurationStat::SaveAggregate(data);
+      if (data) {
+        data->total_flops_ += cost_.flops;
+        data->total_bytes_ += cost_.bytes;
+        if (has_counters_) {
+          ++data->counters_count_;
+          data->counters_time_ += items_[kStop].timestamp_ - items_[kStart].timestamp_;
+          data->total_cycles_ += counters_.cycles;
+          data->total_instructions_ += counters_.instructions;
+          data->total_llc_references_ += counters_.llc_references;
+          data->total_llc_misses_ += counters_.llc_misses;
+        }
+      }
+    }
+
+   protected:
+    void EmitExtra(std::ostream* os, size_t idx) override {
+      DurationStat::EmitExtra(os, idx);
+      const bool counters = has_counters_ && idx == kStop;
+      if (opr_id_ == 0 && !counters)
+        return;
+      *os << "        \"args\": { ";
+      if (opr_id_ != 0) {
+        *os << "\"opr_id\": " << opr_id_;
+        if (idx == kStart) {
+          *os << ", \"deps\": [";
+          for (size_t i = 0; i < deps_.size(); ++i)
+            *os << (i ? ", " : "") << deps_[i];
+          *os << "]";
+        }
+      }
+      if (counters) {
+        *os << (opr_id_ != 0 ? ", " : "") << "\"cycles\": " << counters_.cycles
+            << ", \"instructions\": " << counters_.instructions
+            << ", \"llc_references\": " << counters_.llc_references
+            << ", \"llc_misses\": " << counters_.llc_misses;
+      }
+      *os << " },\n";
+    }
   };
 
  private:
@@ -1256,13 +1497,22 @@ struct ProfileOperator : public ProfileEvent {
    * \brief Send this object's statistical datapoint to the profiler
    */
   void SendStat() override {
-    Profiler::Get()->AddNewProfileStat<OprExecStat>([](OprExecStat* stat) {},
-                                                    name_.c_str(),
-                                                    dev_type_,
-                                                    dev_id_,
-                                                    start_time_,
-                                                    ProfileStat::NowInMicrosec(),
-                                                    attributes_.get());
+    Profiler::Get()->AddNewProfileStat<OprExecStat>(
+        [this](OprExecStat* stat) {
+          stat->opr_id_ = opr_id_;
+          stat->deps_   = std::move(deps_);
+          stat->cost_   = cost_;
+          if (has_counters_) {
+            stat->has_counters_ = true;
+            stat->counters_     = counter_values_;
+          }
+        },
+        name_.c_str(),
+        dev_type_,
+        dev_id_,
+        start_time_,
+        ProfileStat::NowInMicrosec(),
+        attributes_.get());
   }
   /*!
    * \brief Check if this operator is no longer profiled
@@ -1292,6 +1542,20 @@ struct ProfileOperator : public ProfileEvent {
   std::unique_ptr<Attributes> attributes_;
   /*! \brief Whether to profile or not */
   const bool profiling_;
+  /*! \brief id of the operator in the engine, 0 if unknown */
+  uint64_t opr_id_ = 0;
+  /*! \brief ids of the operators that the operator waited for */
+  std::vector<uint64_t> deps_;
+  /*! \brief floating point operations and bytes of the operator */
+  OperatorCost cost_;
+  /*! \brief hardware counters of the thread which started the operator, nullptr if none */
+  PerfCounters* counters_ = nullptr;
+  /*! \brief values of the hardware counters when the operator started */
+  PerfCounterValues counters_start_;
+  /*! \brief hardware counters of the thread during the operator */
+  PerfCounterValues counter_values_;
+  /*! \brief whether the operator was stopped by the thread which started it */
+  bool has_counters_ = false;
 };
 
 /*
@@ -1334,6 +1598,18 @@ inline void Profiler::AddProfileStat<ProfileOperator::OprExecStat>(
   dev_stat.opr_exec_stats_->enqueue((*opr_stat).release());
 }
 
+/*!
+ * \brief Explicit 'Profiler::StatDeviceIndex' override for 'OprExecStat'
+ * \param opr_stat The operator statistic
+ */
+template <>
+inline size_t Profiler::StatDeviceIndex<ProfileOperator::OprExecStat>(
+    const ProfileOperator::OprExecStat* opr_stat) {
+  const size_t idx = DeviceIndex(opr_stat->dev_type_, opr_stat->dev_id_);
+  CHECK_LT(idx, DeviceCount());
+  return idx;
+}
+
 #undef VTUNE_ONLY_CODE  // This macro not meant to be used outside of this file
 
 class ProfilerScope {
@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "./request_tracer.h"
+
+#include <dmlc/parameter.h>
+#include <mxnet/engine.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+/*! \return the time of the profiler in microseconds as nanoseconds since the Unix epoch */
+std::string UnixNano(uint64_t time) {
+  static const int64_t offset =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count() -
+      static_cast<int64_t>(ProfileStat::NowInMicrosec());
+  return std::to_string((static_cast<int64_t>(time) + offset) * 1000);
+}
+
+std::string EscapeJSON(const std::string& s) {
+  std::ostringstream os;
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << ' ';
+    } else {
+      os << c;
+    }
+  }
+  return os.str();
+}
+
+std::string StringAttribute(const std::string& key, const std::string& value) {
+  return "{\"key\":\"" + key + "\",\"value\":{\"stringValue\":\"" + EscapeJSON(value) + "\"}}";
+}
+
+std::string IntAttribute(const std::string& key, uint64_t value) {
+  return "{\"key\":\"" + key + "\",\"value\":{\"intValue\":\"" + std::to_string(value) + "\"}}";
+}
+
+/*! \brief write a span of OTLP/JSON, its attributes are a comma separated list */
+void WriteSpan(std::ostream* os,
+               const std::string& trace_id,
+               const std::string& span_id,
+               const std::string& parent_span_id,
+               const std::string& name,
+               uint64_t start,
+               uint64_t end,
+               const std::string& attributes) {
+  *os << "{\"traceId\":\"" << trace_id << "\",\"spanId\":\"" << span_id << "\"";
+  if (!parent_span_id.empty())
+    *os << ",\"parentSpanId\":\"" << parent_span_id << "\"";
+  *os << ",\"name\":\"" << EscapeJSON(name) << "\",\"kind\":1"
+      << ",\"startTimeUnixNano\":\"" << UnixNano(start) << "\""
+      << ",\"endTimeUnixNano\":\"" << UnixNano(end) << "\""
+      << ",\"attributes\":[" << attributes << "]}";
+}
+
+bool IsHex(const std::string& s) {
+  return std::all_of(s.begin(), s.end(), [](char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+  });
+}
+
+}  // namespace
+
+RequestTrace::RequestTrace(std::string trace_id, std::string parent_span_id)
+    : trace_id_(std::move(trace_id)),
+      parent_span_id_(std::move(parent_span_id)),
+      start_(ProfileStat::NowInMicrosec()) {}
+
+RequestTrace::~RequestTrace() {
+  uint64_t end = scope_end_ ? scope_end_ : ProfileStat::NowInMicrosec();
+  for (const OperatorSpan& op : operators_)
+    end = std::max(end, op.end);
+  RequestTracer* tracer = RequestTracer::Get();
+  if (end - start_ >= tracer->threshold())
+    tracer->Export(ToOTLP(end));
+}
+
+void RequestTrace::AddOperator(const std::string& name,
+                               const Context& ctx,
+                               uint64_t push,
+                               uint64_t ready,
+                               uint64_t start,
+                               uint64_t end) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  operators_.push_back({name, ctx, push, ready, start, end});
+}
+
+void RequestTrace::EndScope() {
+  scope_end_ = ProfileStat::NowInMicrosec();
+}
+
+std::string RequestTrace::ToOTLP(uint64_t end) const {
+  std::ostringstream spans;
+  const std::string root_id = RequestTracer::RandomId(8);
+  uint64_t wait = 0, queue = 0, run = 0;
+  for (const OperatorSpan& op : operators_) {
+    const uint64_t ready = std::max(op.ready, op.push);
+    const uint64_t start = std::max(op.start, ready);
+    const uint64_t stop  = std::max(op.end, start);
+    std::ostringstream device;
+    device << op.ctx;
+    const std::string op_id = RequestTracer::RandomId(8);
+    spans << ",";
+    WriteSpan(&spans,
+              trace_id_,
+              op_id,
+              root_id,
+              op.name,
+              op.push,
+              stop,
+              StringAttribute("mxnet.device", device.str()) + "," +
+                  IntAttribute("mxnet.wait_us", ready - op.push) + "," +
+                  IntAttribute("mxnet.queue_us", start - ready) + "," +
+                  IntAttribute("mxnet.run_us", stop - start));
+    spans << ",";
+    WriteSpan(&spans, trace_id_, RequestTracer::RandomId(8), op_id, "queue", ready, start, "");
+    spans << ",";
+    WriteSpan(&spans, trace_id_, RequestTracer::RandomId(8), op_id, "run", start, stop, "");
+    wait += ready - op.push;
+    queue += start - ready;
+    run += stop - start;
+  }
+  std::ostringstream os;
+  os << "{\"resourceSpans\":[{\"resource\":{\"attributes\":["
+     << StringAttribute("service.name", "mxnet") << "]},\"scopeSpans\":[{\"scope\":"
+     << "{\"name\":\"mxnet.engine\"},\"spans\":[";
+  WriteSpan(&os,
+            trace_id_,
+            root_id,
+            parent_span_id_,
+            "request",
+            start_,
+            end,
+            IntAttribute("mxnet.latency_us", end - start_) + "," +
+                IntAttribute("mxnet.operators", operators_.size()) + "," +
+                IntAttribute("mxnet.wait_us", wait) + "," + IntAttribute("mxnet.queue_us", queue) +
+                "," + IntAttribute("mxnet.run_us", run));
+  os << spans.str() << "]}]}]}";
+  return os.str();
+}
+
+RequestTracer* RequestTracer::Get() {
+  static RequestTracer inst;
+  return &inst;
+}
+
+RequestTracer::RequestTracer()
+    : threshold_(static_cast<uint64_t>(
+          dmlc::GetEnv("MXNET_REQUEST_TRACE_THRESHOLD_MS", 100.0) * 1000)),
+      filename_(dmlc::GetEnv("MXNET_REQUEST_TRACE_FILE", std::string("mxnet_traces.json"))) {}
+
+std::shared_ptr<RequestTrace> RequestTracer::Begin(const std::string& traceparent) {
+  std::shared_ptr<RequestTrace>& current = Current();
+  CHECK(current == nullptr) << "A traced request is already in progress on this thread";
+  if (traceparent.empty()) {
+    current = std::make_shared<RequestTrace>(RandomId(16), "");
+  } else {
+    // version-trace_id-parent_id-flags
+    const bool valid = traceparent.size() == 55 && traceparent[2] == '-' &&
+                       traceparent[35] == '-' && traceparent[52] == '-' &&
+                       IsHex(traceparent.substr(0, 2)) && IsHex(traceparent.substr(3, 32)) &&
+                       IsHex(traceparent.substr(36, 16)) && IsHex(traceparent.substr(53, 2)) &&
+                       traceparent.substr(3, 32) != std::string(32, '0');
+    CHECK(valid) << "Invalid W3C traceparent '" << traceparent
+                 << "', expected 00-<32 hex digits>-<16 hex digits>-<2 hex digits>";
+    current = std::make_shared<RequestTrace>(traceparent.substr(3, 32), traceparent.substr(36, 16));
+  }
+  return current;
+}
+
+void RequestTracer::End() {
+  std::shared_ptr<RequestTrace>& current = Current();
+  CHECK(current != nullptr) << "No traced request is in progress on this thread";
+  // the bulked operators are pushed for the request
+  Engine::Get()->set_bulk_size(Engine::Get()->set_bulk_size(0));
+  current->EndScope();
+  current.reset();
+}
+
+void RequestTracer::SetConfig(uint64_t threshold, const std::string& filename) {
+  threshold_ = threshold;
+  std::lock_guard<std::mutex> lock(mutex_);
+  filename_ = filename;
+}
+
+void RequestTracer::Export(const std::string& otlp) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream file(filename_, std::ios::app);
+  if (!file) {
+    LOG(WARNING) << "Cannot write the request traces to " << filename_;
+    return;
+  }
+  file << otlp << "\n";
+}
+
+std::string RequestTracer::RandomId(size_t num_bytes) {
+  static thread_local std::mt19937_64 engine(std::random_device{}());
+  static const char digits[] = "0123456789abcdef";
+  std::string id;
+  while (id.empty() || id == std::string(num_bytes * 2, '0')) {
+    id.clear();
+    for (size_t i = 0; i < num_bytes; ++i) {
+      const uint64_t byte = engine() & 0xff;
+      id += digits[byte >> 4];
+      id += digits[byte & 0xf];
+    }
+  }
+  return id;
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_PROFILER_REQUEST_TRACER_H_
+#define MXNET_PROFILER_REQUEST_TRACER_H_
+
+#include <mxnet/base.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief The engine operators of a request traced by its caller. It ends when both the scope
+ *  of the caller and the operators pushed in it are done, which is when the last reference to
+ *  it is released, and its spans are then exported if it took longer than the threshold.
+ */
+class RequestTrace {
+ public:
+  /*!
+   * \param trace_id the 32 hex digits of the trace
+   * \param parent_span_id the 16 hex digits of the span of the caller, or empty
+   */
+  RequestTrace(std::string trace_id, std::string parent_span_id);
+  ~RequestTrace();
+
+  /*! \return the 32 hex digits of the trace */
+  const std::string& trace_id() const {
+    return trace_id_;
+  }
+
+  /*!
+   * \brief record an operator of the request, the times are in microseconds
+   * \param name name of the operator
+   * \param ctx context the operator ran on
+   * \param push time it was pushed to the engine
+   * \param ready time its dependencies were done and it was queued to a worker
+   * \param start time a worker started it
+   * \param end time it completed
+   */
+  void AddOperator(const std::string& name,
+                   const Context& ctx,
+                   uint64_t push,
+                   uint64_t ready,
+                   uint64_t start,
+                   uint64_t end);
+
+  /*! \brief the scope of the caller ended, which no longer pushes operators for the request */
+  void EndScope();
+
+ private:
+  /*! \brief an operator of the request */
+  struct OperatorSpan {
+    std::string name;
+    Context ctx;
+    uint64_t push, ready, start, end;
+  };
+
+  /*! \brief the spans of the request and its operators as OTLP/JSON */
+  std::string ToOTLP(uint64_t end) const;
+
+  std::string trace_id_;
+  std::string parent_span_id_;
+  /*! \brief time the scope of the caller began and ended, in microseconds */
+  uint64_t start_{0}, scope_end_{0};
+  std::mutex mutex_;
+  std::vector<OperatorSpan> operators_;
+};
+
+/*!
+ * \brief Tags the engine operators pushed for a request with its trace, so that the latency of
+ *  a slow request can be attributed to the waits on dependencies, the queues of the workers of
+ *  the engine and the operators themselves.
+ */
+class RequestTracer {
+ public:
+  /*! \brief get the global instance */
+  static RequestTracer* Get();
+
+  /*! \return the trace of the request of the calling thread, null outside of a request */
+  static std::shared_ptr<RequestTrace>& Current() {
+    static thread_local std::shared_ptr<RequestTrace> current;
+    return current;
+  }
+
+  /*!
+   * \brief begin the traced request of the calling thread
+   * \param traceparent the W3C traceparent of the caller, or empty to start a new trace
+   * \return the trace of the request
+   */
+  std::shared_ptr<RequestTrace> Begin(const std::string& traceparent);
+
+  /*! \brief end the scope of the traced request of the calling thread */
+  void End();
+
+  /*! \return latency in microseconds from which the traced requests are exported */
+  uint64_t threshold() const {
+    return threshold_.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief set where and from which latency the traced requests are exported
+   * \param threshold latency in microseconds
+   * \param filename file the spans are appended to, one OTLP/JSON request per line
+   */
+  void SetConfig(uint64_t threshold, const std::string& filename);
+
+  /*! \brief append the spans of a request, as one line of OTLP/JSON */
+  void Export(const std::string& otlp);
+
+  /*! \return a random id of num_bytes bytes as hex digits */
+  static std::string RandomId(size_t num_bytes);
+
+ private:
+  RequestTracer();
+
+  std::atomic<uint64_t> threshold_;
+  /*! \brief guards filename_ and the writes to it */
+  std::mutex mutex_;
+  std::string filename_;
+};
+
+/*! \brief sets the trace of the calling thread until the end of the scope */
+class RequestTraceScope {
+ public:
+  explicit RequestTraceScope(std::shared_ptr<RequestTrace> trace)
+      : prev_(std::move(RequestTracer::Current())) {
+    RequestTracer::Current() = std::move(trace);
+  }
+  ~RequestTraceScope() {
+    RequestTracer::Current() = std::move(prev_);
+  }
+
+ private:
+  std::shared_ptr<RequestTrace> prev_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_REQUEST_TRACER_H_
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "./sampling_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include "./aggregate_stats.h"
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+SamplingProfiler* SamplingProfiler::Get() {
+  static SamplingProfiler inst;
+  return &inst;
+}
+
+SamplingProfiler::SamplingProfiler()
+    : sample_rate_(dmlc::GetEnv("MXNET_PROFILER_SAMPLE_RATE", 0)) {}
+
+void SamplingProfiler::set_sample_rate(int sample_rate) {
+  CHECK_GE(sample_rate, 0) << "The sample rate of the profiler should be non-negative";
+  sample_rate_ = sample_rate;
+}
+
+SamplingProfiler::RingBuffer* SamplingProfiler::ThreadBuffer() {
+  static thread_local std::shared_ptr<RingBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<RingBuffer>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(buffer);
+  }
+  return buffer.get();
+}
+
+void SamplingProfiler::Record(const std::string& name, uint64_t duration) {
+  RingBuffer* buffer = ThreadBuffer();
+  const size_t head  = buffer->head.load(std::memory_order_relaxed);
+  if (head - buffer->tail.load(std::memory_order_acquire) >= RingBuffer::kCapacity) {
+    ++dropped_;
+    return;
+  }
+  SampleEntry& entry = buffer->entries[head % RingBuffer::kCapacity];
+  const size_t size  = std::min(name.size(), sizeof(entry.name) - 1);
+  std::memcpy(entry.name, name.data(), size);
+  entry.name[size] = '\0';
+  entry.duration   = duration;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void SamplingProfiler::Drain() {
+  std::shared_ptr<AggregateStats> stats = Profiler::Get()->GetAggregateStats();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    RingBuffer* buffer = it->get();
+    const size_t head  = buffer->head.load(std::memory_order_acquire);
+    size_t tail        = buffer->tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      const SampleEntry& entry = buffer->entries[tail % RingBuffer::kCapacity];
+      Window& window           = windows_[entry.name];
+      if (window.durations.size() < Window::kWindowSize) {
+        window.durations.push_back(entry.duration);
+      } else {
+        window.durations[window.next] = entry.duration;
+      }
+      window.next = (window.next + 1) % Window::kWindowSize;
+      ++window.count;
+      if (stats) {
+        stats->OnDuration("operator (sampled)", entry.name, entry.duration);
+      }
+    }
+    buffer->tail.store(tail, std::memory_order_release);
+    // the buffer of an exited thread is only referenced here
+    if (it->use_count() == 1) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::string SamplingProfiler::Scrape(bool reset) {
+  Drain();
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::map<std::string, Window> windows(windows_.begin(), windows_.end());
+  std::ostringstream os;
+  os << "{\n  \"Unit\": \"us\",\n  \"SampleRate\": " << sample_rate_
+     << ",\n  \"Dropped\": " << (reset ? dropped_.exchange(0) : dropped_.load())
+     << ",\n  \"Operators\": {";
+  bool first = true;
+  for (const auto& kv : windows) {
+    std::vector<uint64_t> durations = kv.second.durations;
+    std::sort(durations.begin(), durations.end());
+    auto percentile = [&durations](double p) {
+      return durations[static_cast<size_t>(p * (durations.size() - 1) + 0.5)];
+    };
+    os << (first ? "\n" : ",\n") << "    \"";
+    for (const char c : kv.first) {
+      if (c == '"' || c == '\\')
+        os << '\\';
+      os << c;
+    }
+    os << "\": {\"Count\": " << kv.second.count << ", \"P50\": " << percentile(0.5)
+       << ", \"P90\": " << percentile(0.9) << ", \"P99\": " << percentile(0.99)
+       << ", \"Max\": " << durations.back() << "}";
+    first = false;
+  }
+  os << (first ? "}\n}" : "\n  }\n}");
+  if (reset) {
+    windows_.clear();
+  }
+  return os.str();
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_PROFILER_SAMPLING_PROFILER_H_
+#define MXNET_PROFILER_SAMPLING_PROFILER_H_
+
+#include <dmlc/parameter.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Always-on profiling of the latency of 1 in N operator executions, independent of the
+ *  state of the profiler. The samples are recorded into per-thread ring buffers without locks,
+ *  and drained into rolling per-operator windows and the aggregate stats when scraped.
+ */
+class SamplingProfiler {
+ public:
+  /*! \brief get the global instance */
+  static SamplingProfiler* Get();
+
+  /*! \return every how many operator executions one is sampled, 0 if disabled */
+  int sample_rate() const {
+    return sample_rate_;
+  }
+  /*! \brief set every how many operator executions one is sampled, 0 to disable */
+  void set_sample_rate(int sample_rate);
+
+  /*! \return whether to sample the next operator execution of the calling thread */
+  bool Sample() {
+    const int rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate <= 0)
+      return false;
+    static thread_local int count = 0;
+    if (++count < rate)
+      return false;
+    count = 0;
+    return true;
+  }
+
+  /*!
+   * \brief Record the latency of a sampled operator execution, dropped if the ring buffer
+   *  of the calling thread is full
+   * \param name name of the operator
+   * \param duration latency in microseconds
+   */
+  void Record(const std::string& name, uint64_t duration);
+
+  /*!
+   * \brief Drain the ring buffers and return the rolling latency percentiles of the operators
+   * \param reset whether to clear the windows after scraping
+   * \return a JSON object of the percentiles in microseconds, by operator
+   */
+  std::string Scrape(bool reset);
+
+  /*! \brief drain the ring buffers into the windows and the aggregate stats */
+  void Drain();
+
+ private:
+  /*! \brief a sampled execution, with the name truncated to avoid allocations */
+  struct SampleEntry {
+    char name[56];
+    uint64_t duration;
+  };
+
+  /*! \brief ring buffer with a single producer, its thread, and a single consumer, Drain */
+  struct RingBuffer {
+    static constexpr size_t kCapacity = 4096;
+    SampleEntry entries[kCapacity];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+  };
+
+  /*! \brief latencies of the last kWindowSize executions of an operator */
+  struct Window {
+    static constexpr size_t kWindowSize = 1024;
+    std::vector<uint64_t> durations;
+    size_t next{0};
+    uint64_t count{0};
+  };
+
+  SamplingProfiler();
+  RingBuffer* ThreadBuffer();
+
+  /*! \brief every how many operator executions one is sampled */
+  std::atomic<int> sample_rate_;
+  /*! \brief number of samples dropped because of a full ring buffer */
+  std::atomic<uint64_t> dropped_{0};
+  /*! \brief guards the registration of the buffers and the windows */
+  std::mutex mutex_;
+  /*! \brief ring buffers of the threads, kept until drained after their thread exits */
+  std::vector<std::shared_ptr<RingBuffer>> buffers_;
+  /*! \brief rolling windows by operator */
+  std::unordered_map<std::string, Window> windows_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_SAMPLING_PROFILER_H_
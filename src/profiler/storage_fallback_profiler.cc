@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "./storage_fallback_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace profiler {
+
+StorageFallbackProfiler* StorageFallbackProfiler::Get() {
+  static StorageFallbackProfiler inst;
+  return &inst;
+}
+
+StorageFallbackProfiler::StorageFallbackProfiler() : domain_("MXNET_STORAGE_FALLBACK") {
+  bytes_counter_.reset(new ProfileCounter("Storage Fallback Bytes", &domain_));
+  time_counter_.reset(new ProfileCounter("Storage Fallback Time (us)", &domain_));
+}
+
+void StorageFallbackProfiler::AddFallback(const std::string& op, uint64_t bytes, uint64_t us) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    OpStat& stat = stats_[op];
+    ++stat.count;
+    stat.bytes += bytes;
+    stat.us += us;
+  }
+  *bytes_counter_ += bytes;
+  *time_counter_ += us;
+}
+
+std::string StorageFallbackProfiler::Summary(bool reset) {
+  std::vector<std::pair<std::string, OpStat>> stats;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.assign(stats_.begin(), stats_.end());
+    if (reset)
+      stats_.clear();
+  }
+  if (stats.empty())
+    return std::string();
+  // the largest copies first
+  std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) {
+    return a.second.bytes != b.second.bytes ? a.second.bytes > b.second.bytes : a.first < b.first;
+  });
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(4) << "\nStorage Fallback Statistics:\n"
+     << "============================\n\n"
+     << std::setw(32) << std::left << "Operator" << std::setw(16) << std::right << "Count"
+     << std::setw(24) << "Dense Bytes (MB)" << std::setw(24) << "Total Time (ms)\n"
+     << std::setw(32) << std::left << "--------" << std::setw(16) << std::right << "-----"
+     << std::setw(24) << "----------------" << std::setw(24) << "---------------\n";
+  for (const auto& kv : stats) {
+    os << std::setw(32) << std::left << kv.first << std::setw(16) << std::right << kv.second.count
+       << std::setw(24) << kv.second.bytes / 1048576.0 << std::setw(23) << kv.second.us / 1000.0
+       << "\n";
+  }
+  os << "\nThe operators above have no kernel for the storage types of their arrays, which are "
+        "cast to and from dense arrays.\n";
+  return os.str();
+}
+
+}  // namespace profiler
+}  // namespace mxnet
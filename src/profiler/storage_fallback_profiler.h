@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_PROFILER_STORAGE_FALLBACK_PROFILER_H_
+#define MXNET_PROFILER_STORAGE_FALLBACK_PROFILER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief The storage type fallbacks of the operators, the casts of their sparse inputs and
+ *  outputs to and from dense arrays, via ProfileCounters, recorded while the profiler is running
+ */
+class StorageFallbackProfiler {
+ public:
+  /*! \brief get the global instance */
+  static StorageFallbackProfiler* Get();
+
+  /*! \return whether the fallbacks are recorded */
+  static bool IsProfiling() {
+    return Profiler::Get()->GetState() == Profiler::kRunning;
+  }
+
+  /*! \brief record the casts of a call of op, of bytes of dense arrays in us microseconds */
+  void AddFallback(const std::string& op, uint64_t bytes, uint64_t us);
+
+  /*!
+   * \brief Summary of the fallbacks recorded since the last reset, by operator
+   * \param reset whether to reset the fallbacks
+   * \return the summary as a table, empty if no fallback was recorded
+   */
+  std::string Summary(bool reset);
+
+ private:
+  StorageFallbackProfiler();
+
+  struct OpStat {
+    uint64_t count{0};
+    uint64_t bytes{0};
+    uint64_t us{0};
+  };
+
+  /*! \brief Domain of the fallback counters */
+  ProfileDomain domain_;
+  /*! \brief bytes of the dense arrays cast */
+  std::unique_ptr<ProfileCounter> bytes_counter_;
+  /*! \brief time of the casts in microseconds */
+  std::unique_ptr<ProfileCounter> time_counter_;
+  /*! \brief totals of each operator since the last summary reset */
+  std::mutex mutex_;
+  std::unordered_map<std::string, OpStat> stats_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_STORAGE_FALLBACK_PROFILER_H_
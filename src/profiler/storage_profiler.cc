@@ -21,10 +21,13 @@
 #if MXNET_USE_NVML
 #include <nvml.h>
 #endif  // MXNET_USE_NVML
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <regex>
+#include <sstream>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "./profiler.h"
 #include "../common/utils.h"
@@ -33,6 +36,240 @@
 namespace mxnet {
 namespace profiler {
 
+namespace {
+std::string EscapeJSON(const std::string& s) {
+  std::ostringstream os;
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << ' ';
+    } else {
+      os << c;
+    }
+  }
+  return os.str();
+}
+
+/*! \brief instant event of the trace marking an allocation or a free of a tensor */
+struct MemoryEventStat : public ProfileStat {
+  MemoryEventStat(const std::string& tensor,
+                  const char* event,
+                  const Context& ctx,
+                  size_t bytes,
+                  int64_t live_bytes)
+      : ctx_(ctx), bytes_(bytes), live_bytes_(live_bytes) {
+    items_[0].enabled_    = true;
+    items_[0].event_type_ = kInstant;
+    items_->timestamp_    = NowInMicrosec();
+    enable_aggregate_     = false;
+    name_.set(EscapeJSON(tensor).c_str());
+    categories_.set(event);
+  }
+  void EmitExtra(std::ostream* os, size_t idx) override {
+    ProfileStat::EmitExtra(os, idx);
+    *os << "        \"s\": \"t\",\n"
+        << "        \"args\": { \"bytes\": " << bytes_ << ", \"context\": \"" << ctx_
+        << "\", \"live_bytes\": " << live_bytes_ << " },\n";
+  }
+  const Context ctx_;
+  const size_t bytes_;
+  const int64_t live_bytes_;
+};
+
+/*! \brief instant event of the trace with the largest tensors live at a peak of the memory */
+struct MemoryPeakStat : public ProfileStat {
+  MemoryPeakStat(const Context& ctx, uint64_t timestamp, std::string args)
+      : args_(std::move(args)) {
+    items_[0].enabled_    = true;
+    items_[0].event_type_ = kInstant;
+    items_->timestamp_    = timestamp;
+    enable_aggregate_     = false;
+    std::ostringstream os;
+    os << "Peak Memory: " << ctx;
+    name_.set(os.str().c_str());
+    categories_.set("memory");
+  }
+  void EmitExtra(std::ostream* os, size_t idx) override {
+    ProfileStat::EmitExtra(os, idx);
+    *os << "        \"s\": \"p\",\n"
+        << "        \"args\": { " << args_ << " },\n";
+  }
+  const std::string args_;
+};
+
+/*! \brief number of the largest live tensors in the arguments of a peak event */
+constexpr size_t kPeakEventTensors = 16;
+}  // namespace
+
+void DeviceStorageProfiler::CallsiteOnAlloc(const Storage::Handle& handle) {
+  std::string callsite = handle.profiler_scope + handle.name;
+  std::lock_guard<std::mutex> lock(callsite_mutex_);
+  auto& entry = callsites_[handle.ctx][callsite];
+  ++entry.num_allocs;
+  ++entry.live_blocks;
+  entry.total_bytes += handle.size;
+  entry.live_bytes += handle.size;
+  entry.peak_live_bytes     = std::max(entry.peak_live_bytes, entry.live_bytes);
+  live_allocs_[handle.dptr] = std::make_pair(std::move(callsite), handle.size);
+}
+
+void DeviceStorageProfiler::CallsiteOnFree(const Storage::Handle& handle) {
+  std::lock_guard<std::mutex> lock(callsite_mutex_);
+  auto it = live_allocs_.find(handle.dptr);
+  // allocated before the recording started
+  if (it == live_allocs_.end())
+    return;
+  auto& entry = callsites_[handle.ctx][it->second.first];
+  --entry.live_blocks;
+  entry.live_bytes -= it->second.second;
+  live_allocs_.erase(it);
+}
+
+void DeviceStorageProfiler::CallsiteOnUpdate(const Storage::Handle& handle) {
+  std::string callsite = handle.profiler_scope + handle.name;
+  std::lock_guard<std::mutex> lock(callsite_mutex_);
+  auto it = live_allocs_.find(handle.dptr);
+  if (it == live_allocs_.end() || it->second.first == callsite)
+    return;
+  auto& site    = callsites_[handle.ctx];
+  auto& old_e   = site[it->second.first];
+  auto& new_e   = site[callsite];
+  const auto sz = it->second.second;
+  --old_e.num_allocs;
+  --old_e.live_blocks;
+  old_e.total_bytes -= sz;
+  old_e.live_bytes -= sz;
+  ++new_e.num_allocs;
+  ++new_e.live_blocks;
+  new_e.total_bytes += sz;
+  new_e.live_bytes += sz;
+  new_e.peak_live_bytes = std::max(new_e.peak_live_bytes, new_e.live_bytes);
+  it->second.first      = std::move(callsite);
+}
+
+std::string DeviceStorageProfiler::CallsiteStats(const Context& ctx) {
+  std::vector<std::pair<std::string, CallsiteEntry>> entries;
+  {
+    std::lock_guard<std::mutex> lock(callsite_mutex_);
+    auto it = callsites_.find(ctx);
+    if (it != callsites_.end())
+      entries.assign(it->second.begin(), it->second.end());
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return a.second.live_bytes > b.second.live_bytes;
+  });
+  std::ostringstream os;
+  os << "[";
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& e = entries[i].second;
+    os << (i ? ", " : "") << "{\"callsite\": \"" << EscapeJSON(entries[i].first)
+       << "\", \"num_allocs\": " << e.num_allocs << ", \"total_bytes\": " << e.total_bytes
+       << ", \"live_blocks\": " << e.live_blocks << ", \"live_bytes\": " << e.live_bytes
+       << ", \"peak_live_bytes\": " << e.peak_live_bytes << "}";
+  }
+  os << "]";
+  return os.str();
+}
+
+void DeviceStorageProfiler::TimelineOnAlloc(const Storage::Handle& handle) {
+  // the allocations of the unnamed arrays are attributed to the operator that made them
+  const char* opr = RunningOperatorScope::Current();
+  std::string tensor =
+      handle.profiler_scope +
+      (handle.name == MXNET_STORAGE_DEFAULT_NAME_CSTR && opr && *opr ? opr : handle.name);
+  int64_t live_bytes;
+  {
+    std::lock_guard<std::mutex> lock(timeline_mutex_);
+    auto& timeline = timelines_[handle.ctx];
+    timeline.live[handle.dptr] = std::make_pair(tensor, handle.size);
+    live_bytes = timeline.live_bytes += handle.size;
+    if (live_bytes > timeline.peak_bytes) {
+      timeline.peak_bytes = live_bytes;
+      timeline.peak_time  = ProfileStat::NowInMicrosec();
+      timeline.at_peak    = true;
+    }
+  }
+  Profiler::Get()->AddNewProfileStat<MemoryEventStat>(
+      [](MemoryEventStat*) {}, tensor, "alloc", handle.ctx, handle.size, live_bytes);
+}
+
+void DeviceStorageProfiler::TimelineOnFree(const Storage::Handle& handle) {
+  std::string tensor = handle.profiler_scope + handle.name;
+  int64_t live_bytes;
+  {
+    std::lock_guard<std::mutex> lock(timeline_mutex_);
+    auto& timeline = timelines_[handle.ctx];
+    // the live tensors are only recorded at the local maxima of the timeline above its peak
+    if (timeline.at_peak)
+      RecordPeak(handle.ctx, &timeline);
+    auto it = timeline.live.find(handle.dptr);
+    // allocated before the recording started
+    if (it != timeline.live.end()) {
+      tensor = std::move(it->second.first);
+      timeline.live_bytes -= it->second.second;
+      timeline.live.erase(it);
+    }
+    live_bytes = timeline.live_bytes;
+  }
+  Profiler::Get()->AddNewProfileStat<MemoryEventStat>(
+      [](MemoryEventStat*) {}, tensor, "free", handle.ctx, handle.size, live_bytes);
+}
+
+void DeviceStorageProfiler::TimelineOnUpdate(const Storage::Handle& handle) {
+  std::lock_guard<std::mutex> lock(timeline_mutex_);
+  auto& timeline = timelines_[handle.ctx];
+  auto it        = timeline.live.find(handle.dptr);
+  if (it != timeline.live.end())
+    it->second.first = handle.profiler_scope + handle.name;
+}
+
+void DeviceStorageProfiler::RecordPeak(const Context& ctx, Timeline* timeline) {
+  std::unordered_map<std::string, std::pair<int64_t, int64_t>> tensors;
+  for (const auto& alloc : timeline->live) {
+    auto& entry = tensors[alloc.second.first];
+    entry.first += alloc.second.second;
+    ++entry.second;
+  }
+  timeline->peak_tensors.clear();
+  for (auto& tensor : tensors) {
+    timeline->peak_tensors.emplace_back(tensor.first, tensor.second.first, tensor.second.second);
+  }
+  std::sort(timeline->peak_tensors.begin(),
+            timeline->peak_tensors.end(),
+            [](const auto& a, const auto& b) { return std::get<1>(a) > std::get<1>(b); });
+  timeline->at_peak = false;
+  std::ostringstream args;
+  args << "\"live_bytes\": " << timeline->peak_bytes;
+  for (size_t i = 0; i < std::min(timeline->peak_tensors.size(), kPeakEventTensors); ++i) {
+    const auto& tensor = timeline->peak_tensors[i];
+    args << ", \"" << EscapeJSON(std::get<0>(tensor)) << "\": " << std::get<1>(tensor);
+  }
+  Profiler::Get()->AddNewProfileStat<MemoryPeakStat>(
+      [](MemoryPeakStat*) {}, ctx, timeline->peak_time, args.str());
+}
+
+std::string DeviceStorageProfiler::PeakStats(const Context& ctx) {
+  std::lock_guard<std::mutex> lock(timeline_mutex_);
+  auto it = timelines_.find(ctx);
+  if (it == timelines_.end())
+    return "";
+  Timeline& timeline = it->second;
+  if (timeline.at_peak)
+    RecordPeak(ctx, &timeline);
+  std::ostringstream os;
+  os << "{\"bytes\": " << timeline.peak_bytes << ", \"time_us\": " << timeline.peak_time
+     << ", \"live_bytes\": " << timeline.live_bytes << ", \"tensors\": [";
+  for (size_t i = 0; i < timeline.peak_tensors.size(); ++i) {
+    const auto& tensor = timeline.peak_tensors[i];
+    os << (i ? ", " : "") << "{\"name\": \"" << EscapeJSON(std::get<0>(tensor))
+       << "\", \"bytes\": " << std::get<1>(tensor) << ", \"blocks\": " << std::get<2>(tensor)
+       << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
 #if MXNET_USE_CUDA
 
 GpuDeviceStorageProfiler* GpuDeviceStorageProfiler::Get() {
@@ -19,10 +19,13 @@
 #ifndef MXNET_PROFILER_STORAGE_PROFILER_H_
 #define MXNET_PROFILER_STORAGE_PROFILER_H_
 
+#include <dmlc/parameter.h>
 #include <mxnet/libinfo.h>
 #include <mxnet/storage.h>
+#include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <thread>
 #include <unordered_map>
@@ -48,6 +51,8 @@ class DeviceStorageProfiler {
    * \param handle Handle to the allocated storage
    */
   void OnAlloc(const Storage::Handle& handle) {
+    if (handle.size > 0 && callsite_stats_)
+      CallsiteOnAlloc(handle);
     if (handle.size > 0) {
       profiler::Profiler* prof = profiler::Profiler::Get();
       if (prof->IsProfiling(profiler::Profiler::kMemory)) {
@@ -61,6 +66,7 @@ class DeviceStorageProfiler {
         }
         CHECK_LT(idx, mem_counters_.size()) << "Invalid device index: " << idx;
         *mem_counters_[idx] += handle.size;
+        TimelineOnAlloc(handle);
       }
     }
   }
@@ -70,6 +76,8 @@ class DeviceStorageProfiler {
    * \param handle Handle to the allocated storage
    */
   void OnFree(const Storage::Handle& handle) {
+    if (handle.size > 0 && callsite_stats_)
+      CallsiteOnFree(handle);
     if (handle.size > 0) {
       profiler::Profiler* prof = profiler::Profiler::Get();
       if (prof->IsProfiling(profiler::Profiler::kMemory)) {
@@ -87,11 +95,85 @@ class DeviceStorageProfiler {
         } else {
           *mem_counters_[idx] = 0;
         }
+        TimelineOnFree(handle);
       }
     }
   }
 
+  /*!
+   * \brief Histogram of the allocations of ctx by callsite, the profiler scope and
+   *  name of the storage handle. Recorded when MXNET_STORAGE_CALLSITE_STATS is set.
+   * \return a JSON array, ordered by live bytes
+   */
+  std::string CallsiteStats(const Context& ctx);
+
+  /*! \brief move a live allocation to the callsite of its new profiler scope and name */
+  void UpdateStorageInfo(const Storage::Handle& handle) {
+    if (handle.size > 0 && callsite_stats_)
+      CallsiteOnUpdate(handle);
+    if (handle.size > 0 && profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kMemory))
+      TimelineOnUpdate(handle);
+  }
+
+  /*!
+   * \brief The tensors live on ctx at the peak of its memory timeline, recorded while the
+   *  profiler records the memory
+   * \return a JSON object, the tensors ordered by live bytes, or an empty string when no
+   *  timeline was recorded for ctx
+   */
+  std::string PeakStats(const Context& ctx);
+
+  /*! \return whether the allocations are recorded by callsite */
+  bool callsite_stats() const {
+    return callsite_stats_;
+  }
+
  private:
+  /*! \brief allocation counters of one callsite */
+  struct CallsiteEntry {
+    uint64_t num_allocs     = 0;
+    uint64_t total_bytes    = 0;
+    int64_t live_blocks     = 0;
+    int64_t live_bytes      = 0;
+    int64_t peak_live_bytes = 0;
+  };
+
+  void CallsiteOnAlloc(const Storage::Handle& handle);
+  void CallsiteOnFree(const Storage::Handle& handle);
+  void CallsiteOnUpdate(const Storage::Handle& handle);
+
+  /*! \brief live tensors and peak of the memory of one context */
+  struct Timeline {
+    /*! \brief name and size of the live allocations */
+    std::unordered_map<void*, std::pair<std::string, size_t>> live;
+    int64_t live_bytes = 0;
+    int64_t peak_bytes = 0;
+    uint64_t peak_time = 0;
+    /*! \brief whether the live allocations are the peak, which is not recorded yet */
+    bool at_peak = false;
+    /*! \brief live bytes and blocks by tensor name at the recorded peak */
+    std::vector<std::tuple<std::string, int64_t, int64_t>> peak_tensors;
+  };
+
+  void TimelineOnAlloc(const Storage::Handle& handle);
+  void TimelineOnFree(const Storage::Handle& handle);
+  void TimelineOnUpdate(const Storage::Handle& handle);
+  /*! \brief record the live tensors at the peak, emitted as an instant event of the trace */
+  void RecordPeak(const Context& ctx, Timeline* timeline);
+
+  /*! \brief whether to record the allocations by callsite */
+  const bool callsite_stats_ = dmlc::GetEnv("MXNET_STORAGE_CALLSITE_STATS", false);
+  /*! \brief mutex for the callsite counters */
+  std::mutex callsite_mutex_;
+  /*! \brief counters per context and callsite */
+  std::unordered_map<Context, std::unordered_map<std::string, CallsiteEntry>> callsites_;
+  /*! \brief callsite and size of the live allocations */
+  std::unordered_map<void*, std::pair<std::string, size_t>> live_allocs_;
+  /*! \brief mutex for the memory timelines */
+  std::mutex timeline_mutex_;
+  /*! \brief memory timeline per context */
+  std::unordered_map<Context, Timeline> timelines_;
+
   /*!
    * \brief Lazy initialization.  No locks occur except for on the first pass
    * (or colliding parallel first passes)
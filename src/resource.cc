@@ -31,6 +31,9 @@
 #include <limits>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "./common/lazy_alloc_array.h"
 #include "./common/utils.h"
 #include "./common/cuda/utils.h"
@@ -47,6 +50,10 @@ struct SpaceAllocator {
   Storage::Handle handle;
   // internal CPU handle
   Storage::Handle host_handle;
+  // whether the space is of a single request, returned to the pool of the storage
+  bool dynamic = false;
+  // the spaces a dynamic allocator outgrew, which the launched kernels may still use
+  std::vector<Storage::Handle> outgrown;
 
   SpaceAllocator() {
     handle.dptr      = nullptr;
@@ -69,10 +76,11 @@ struct SpaceAllocator {
     if (handle.size >= size)
       return handle.dptr;
 
-    Storage::Get()->DirectFree(handle);
+    Retire(handle);
     handle                = Storage::Get()->Alloc(size, ctx);
     handle.profiler_scope = "resource:";
     handle.name           = name;
+    Storage::Get()->UpdateStorageInfo(handle);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->UpdateStorageInfo(handle);
 #endif  // MXNET_USE_CUDA
@@ -83,11 +91,59 @@ struct SpaceAllocator {
     if (host_handle.size >= size)
       return host_handle.dptr;
 
-    Storage::Get()->DirectFree(host_handle);
+    Retire(host_handle);
     host_handle = Storage::Get()->Alloc(size, Context());
     return host_handle.dptr;
   }
+
+  // frees a space which is outgrown, the free synchronizes with the device, except for a
+  // dynamic allocator which keeps it until the kernels of the request are complete
+  inline void Retire(const Storage::Handle& space) {
+    if (!dynamic) {
+      Storage::Get()->DirectFree(space);
+    } else if (space.dptr != nullptr) {
+      outgrown.push_back(space);
+    }
+  }
+
+  // returns the spaces of a dynamic allocator to the pool of the storage
+  inline void FreeAll() {
+    for (const auto& space : outgrown) {
+      Storage::Get()->Free(space);
+    }
+    outgrown.clear();
+    Storage::Get()->Free(handle);
+    handle.dptr = nullptr;
+    handle.size = 0;
+
+    Storage::Get()->Free(host_handle);
+    host_handle.dptr = nullptr;
+    host_handle.size = 0;
+  }
+};
+
+// internal seed of the counter based random number generators of a device, written by the
+// engine in the order of the ops reading it
+struct CounterRandomSeed {
+  // internal context
+  Context ctx;
+  // number of seeds in the 32 high bits, and the last seed
+  uint64_t seed;
+  // number of the first request after the last seed
+  uint64_t seed_stream;
+};
+
+#if MXNET_USE_NCCL == 1
+// the NCCL communicators of the GPUs, shared by the resource managers of the threads
+struct NCCLComms {
+  std::mutex mutex;
+  std::unordered_map<int, ncclComm_t> comms;
+  static NCCLComms* Get() {
+    static NCCLComms inst;
+    return &inst;
+  }
 };
+#endif  // MXNET_USE_NCCL == 1
 
 // Implements resource manager
 class ResourceManagerImpl : public ResourceManager {
@@ -96,6 +152,7 @@ class ResourceManagerImpl : public ResourceManager {
     cpu_temp_space_copy_  = dmlc::GetEnv("MXNET_CPU_TEMP_COPY", 4);
     gpu_temp_space_copy_  = dmlc::GetEnv("MXNET_GPU_TEMP_COPY", 1);
     cpu_native_rand_copy_ = dmlc::GetEnv("MXNET_CPU_PARALLEL_RAND_COPY", 1);
+    dynamic_temp_space_   = dmlc::GetEnv("MXNET_DYNAMIC_TEMP_SPACE", false);
     gpu_native_rand_copy_ = dmlc::GetEnv("MXNET_GPU_PARALLEL_RAND_COPY", 1);
 #if MXNET_USE_CUDNN == 1
     gpu_cudnn_dropout_state_copy_ = dmlc::GetEnv("MXNET_GPU_CUDNN_DROPOUT_STATE_COPY", 1);
@@ -107,16 +164,22 @@ class ResourceManagerImpl : public ResourceManager {
         Context::CPU(), cpu_temp_space_copy_);
     cpu_parallel_rand_ = std::make_unique<ResourceParallelRandom<cpu>>(
         Context::CPU(), cpu_native_rand_copy_, global_seed_);
+    cpu_counter_rand_  = std::make_unique<ResourceCounterRandom>(Context::CPU(), global_seed_);
   }
   ~ResourceManagerImpl() override {
     // need explicit delete, before engine get killed
     cpu_rand_.reset(nullptr);
     cpu_space_.reset(nullptr);
     cpu_parallel_rand_.reset(nullptr);
+    cpu_counter_rand_.reset(nullptr);
 #if MXNET_USE_CUDA
     gpu_rand_.Clear();
     gpu_space_.Clear();
     gpu_parallel_rand_.Clear();
+    gpu_counter_rand_.Clear();
+#if MXNET_USE_NCCL == 1
+    gpu_nccl_comm_.Clear();
+#endif  // MXNET_USE_NCCL == 1
 #if MXNET_USE_CUDNN == 1
     gpu_cudnn_dropout_state_.Clear();
 #endif  // MXNET_USE_CUDNN == 1
@@ -136,9 +199,15 @@ class ResourceManagerImpl : public ResourceManager {
         case ResourceRequest::kRandom:
           return cpu_rand_->resource;
         case ResourceRequest::kTempSpace:
-          return cpu_space_->GetNext();
+          return dynamic_temp_space_ ? DynamicTempSpace(ctx) : cpu_space_->GetNext();
         case ResourceRequest::kParallelRandom:
           return cpu_parallel_rand_->GetNext();
+        case ResourceRequest::kCounterRandom:
+          return cpu_counter_rand_->GetNext();
+#if MXNET_USE_NCCL == 1
+        case ResourceRequest::kNCCLComm:
+          LOG(FATAL) << "The NCCL communicators are of the gpu contexts";
+#endif  // MXNET_USE_NCCL == 1
         default:
           LOG(FATAL) << "Unknown supported type " << req.type;
       }
@@ -152,6 +221,8 @@ class ResourceManagerImpl : public ResourceManager {
               ->resource;
         }
         case ResourceRequest::kTempSpace: {
+          if (dynamic_temp_space_)
+            return DynamicTempSpace(ctx);
           return gpu_space_
               .Get(ctx.dev_id,
                    [ctx, this]() {
@@ -169,6 +240,12 @@ class ResourceManagerImpl : public ResourceManager {
                    })
               ->GetNext();
         }
+        case ResourceRequest::kCounterRandom: {
+          return gpu_counter_rand_
+              .Get(ctx.dev_id,
+                   [ctx, this]() { return new ResourceCounterRandom(ctx, global_seed_); })
+              ->GetNext();
+        }
 #if MXNET_USE_CUDNN == 1
         case ResourceRequest::kCuDNNDropoutDesc: {
           return gpu_cudnn_dropout_state_
@@ -180,6 +257,12 @@ class ResourceManagerImpl : public ResourceManager {
               ->GetNext();
         }
 #endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+        case ResourceRequest::kNCCLComm: {
+          return gpu_nccl_comm_.Get(ctx.dev_id, [ctx]() { return new ResourceNCCLComm(ctx); })
+              ->resource;
+        }
+#endif  // MXNET_USE_NCCL == 1
         default:
           LOG(FATAL) << "Unknown supported type " << req.type;
       }
@@ -195,10 +278,13 @@ class ResourceManagerImpl : public ResourceManager {
     global_seed_ = seed;
     cpu_rand_->SeedWithDeviceID(global_seed_);
     cpu_parallel_rand_->SeedWithDeviceID(global_seed_);
+    cpu_counter_rand_->SeedWithDeviceID(global_seed_);
 #if MXNET_USE_CUDA
     gpu_rand_.ForEach([seed](size_t i, ResourceRandom<gpu>* p) { p->SeedWithDeviceID(seed); });
     gpu_parallel_rand_.ForEach(
         [seed](size_t i, ResourceParallelRandom<gpu>* p) { p->SeedWithDeviceID(seed); });
+    gpu_counter_rand_.ForEach(
+        [seed](size_t i, ResourceCounterRandom* p) { p->SeedWithDeviceID(seed); });
 #if MXNET_USE_CUDNN == 1
     gpu_cudnn_dropout_state_.ForEach([seed](size_t i, ResourceCUDNNDropout* p) {
       ResourceManagerImpl::SeedCUDNNDropout(p, seed);
@@ -210,8 +296,12 @@ class ResourceManagerImpl : public ResourceManager {
   void SeedRandom(Context ctx, uint32_t seed) override {
     cpu_rand_->Seed(seed);
     cpu_parallel_rand_->Seed(seed);
+    cpu_counter_rand_->Seed(seed);
 #if MXNET_USE_CUDA
     if (ctx.dev_type == Context::kGPU) {
+      gpu_counter_rand_
+          .Get(ctx.dev_id, [ctx, seed, this]() { return new ResourceCounterRandom(ctx, seed); })
+          ->Seed(seed);
       gpu_rand_.Get(ctx.dev_id, [ctx, seed, this]() { return new ResourceRandom<gpu>(ctx, seed); })
           ->Seed(seed);
       gpu_parallel_rand_
@@ -472,10 +562,105 @@ class ResourceManagerImpl : public ResourceManager {
     }
   };
 
+  // the counter based random number resources, one per device. The ops read the variable, so
+  // they run concurrently, and the seeds write it, so they are ordered with the ops.
+  struct ResourceCounterRandom {
+    /*! \brief the context of the generators */
+    Context ctx;
+    /*! \brief the seed read by the ops */
+    CounterRandomSeed* state;
+    /*! \brief number of the next request */
+    std::atomic<uint64_t> next_stream{0};
+    /*! \brief resource representation */
+    Resource resource;
+    /*! \brief constructor */
+    explicit ResourceCounterRandom(Context ctx, uint32_t global_seed) : ctx(ctx) {
+      state         = new CounterRandomSeed{ctx, ctx.dev_id + global_seed * kRandMagic, 0};
+      resource.var  = Engine::Get()->NewVariable();
+      resource.ptr_ = state;
+      resource.req  = ResourceRequest(ResourceRequest::kCounterRandom);
+    }
+    ~ResourceCounterRandom() {
+      CounterRandomSeed* r = state;
+      Engine::Get()->DeleteVariable(
+          [r](RunContext rctx) { MSHADOW_CATCH_ERROR(delete r); }, ctx, resource.var);
+    }
+    // set seed to the generators using global_seed and device id
+    inline void SeedWithDeviceID(uint32_t global_seed) {
+      Seed(ctx.dev_id + global_seed * kRandMagic);
+    }
+    // set seed to the generators, the requests after it are numbered from 0
+    inline void Seed(uint32_t seed) {
+      CounterRandomSeed* r = state;
+      const uint64_t first = next_stream.load();
+      Engine::Get()->PushSync(
+          [r, seed, first](RunContext rctx) {
+            r->seed        = (((r->seed >> 32) + 1) << 32) | seed;
+            r->seed_stream = first;
+          },
+          ctx,
+          {},
+          {resource.var},
+          FnProperty::kNormal,
+          0,
+          "ResourceCounterRandomSetSeed");
+    }
+    // every request is a stream of numbers of its own
+    inline Resource GetNext() {
+      Resource ret        = resource;
+      ret.counter_stream_ = next_stream++;
+      return ret;
+    }
+  };
+
+  // a space of its own for every request, without a variable, so the ops requesting it do not
+  // wait for each other. The space is allocated by the op and returned to the pool of the
+  // storage with the last copy of the resource, i.e. when the op is complete.
+  static Resource DynamicTempSpace(Context ctx) {
+    std::shared_ptr<SpaceAllocator> space(new SpaceAllocator(), [](SpaceAllocator* p) {
+      MSHADOW_CATCH_ERROR(p->FreeAll());
+      delete p;
+    });
+    space->ctx     = ctx;
+    space->dynamic = true;
+    Resource ret;
+    ret.ptr_           = space.get();
+    ret.req            = ResourceRequest(ResourceRequest::kTempSpace);
+    ret.dynamic_space_ = space;
+    return ret;
+  }
+
+#if MXNET_USE_NCCL == 1
+  // the NCCL communicator of a GPU, the variable orders the collectives of the ops
+  struct ResourceNCCLComm {
+    /*! \brief the context of the communicator */
+    Context ctx;
+    /*! \brief resource representation */
+    Resource resource;
+    /*! \brief constructor */
+    explicit ResourceNCCLComm(Context ctx) : ctx(ctx) {
+      NCCLComms* registry = NCCLComms::Get();
+      std::lock_guard<std::mutex> lock(registry->mutex);
+      auto it = registry->comms.find(ctx.dev_id);
+      CHECK(it != registry->comms.end())
+          << "No NCCL communicator of gpu(" << ctx.dev_id << "), "
+          << "create the communicators with mx.contrib.nccl.init first";
+      resource.var  = Engine::Get()->NewVariable();
+      resource.ptr_ = it->second;
+      resource.req  = ResourceRequest(ResourceRequest::kNCCLComm);
+    }
+    ~ResourceNCCLComm() {
+      Engine::Get()->DeleteVariable([](RunContext rctx) {}, ctx, resource.var);
+    }
+  };
+#endif  // MXNET_USE_NCCL == 1
+
   /*! \brief number of copies in CPU temp space */
   int cpu_temp_space_copy_;
   /*! \brief number of copies in GPU temp space */
   int gpu_temp_space_copy_;
+  /*! \brief whether every temp space request has a space of its own */
+  bool dynamic_temp_space_;
   /*! \brief number of copies in CPU native random sampler */
   int cpu_native_rand_copy_;
   /*! \brief number of copies in GPU native random sampler */
@@ -492,6 +677,8 @@ class ResourceManagerImpl : public ResourceManager {
   std::unique_ptr<ResourceTempSpace<ResourceRequest::kTempSpace>> cpu_space_;
   /*! \brief CPU parallel random number resources */
   std::unique_ptr<ResourceParallelRandom<cpu>> cpu_parallel_rand_;
+  /*! \brief CPU counter based random number resources */
+  std::unique_ptr<ResourceCounterRandom> cpu_counter_rand_;
 #if MXNET_USE_CUDA
   /*! \brief random number generator for GPU */
   common::LazyAllocArray<ResourceRandom<gpu>> gpu_rand_;
@@ -499,12 +686,18 @@ class ResourceManagerImpl : public ResourceManager {
   common::LazyAllocArray<ResourceTempSpace<ResourceRequest::kTempSpace>> gpu_space_;
   /*! \brief GPU parallel (on device) random number resources */
   common::LazyAllocArray<ResourceParallelRandom<gpu>> gpu_parallel_rand_;
+  /*! \brief GPU counter based random number resources */
+  common::LazyAllocArray<ResourceCounterRandom> gpu_counter_rand_;
 #if MXNET_USE_CUDNN == 1
   /*! \brief number of copies in GPU cudnn dropout descriptor resources */
   int gpu_cudnn_dropout_state_copy_;
   /*! \brief GPU parallel (on device) random number resources */
   common::LazyAllocArray<ResourceCUDNNDropout> gpu_cudnn_dropout_state_;
 #endif  // MXNET_USE_CUDNN == 1
+#if MXNET_USE_NCCL == 1
+  /*! \brief GPU NCCL communicator resources */
+  common::LazyAllocArray<ResourceNCCLComm> gpu_nccl_comm_;
+#endif  // MXNET_USE_NCCL == 1
 #endif
 };
 }  // namespace resource
@@ -517,6 +710,36 @@ void* Resource::get_host_space_internal(size_t size) const {
   return static_cast<resource::SpaceAllocator*>(ptr_)->GetHostSpace(size);
 }
 
+uint64_t Resource::get_counter_random_internal(uint64_t* key) const {
+  CHECK_EQ(req.type, ResourceRequest::kCounterRandom);
+  auto state                = static_cast<const resource::CounterRandomSeed*>(ptr_);
+  const uint32_t generation = static_cast<uint32_t>(state->seed >> 32);
+  if (counter_generation_ != generation) {
+    counter_generation_ = generation;
+    counter_invocation_ = 0;
+  }
+  // the requests after the last seed are numbered from it, so that they reproduce with the
+  // seed, the older ones, e.g. of a bound graph, keep their number with the high bit set
+  const uint64_t stream = counter_stream_ >= state->seed_stream
+                              ? (counter_stream_ - state->seed_stream) & 0x7fffffffULL
+                              : (counter_stream_ & 0x7fffffffULL) | 0x80000000ULL;
+  *key = (static_cast<uint64_t>(state->ctx.dev_type) << 32) | static_cast<uint32_t>(state->seed);
+  return (stream << 32) | counter_invocation_++;
+}
+
+void* Resource::current_space_internal() const {
+  CHECK_EQ(req.type, ResourceRequest::kTempSpace);
+  return static_cast<resource::SpaceAllocator*>(ptr_)->handle.dptr;
+}
+
+void Resource::release_space() const {
+  if (req.type != ResourceRequest::kTempSpace)
+    return;
+  auto space = static_cast<resource::SpaceAllocator*>(ptr_);
+  if (space->dynamic)
+    space->FreeAll();
+}
+
 #if MXNET_USE_CUDNN == 1
 void Resource::get_cudnn_dropout_desc(cudnnDropoutDescriptor_t* dropout_desc,
                                       mshadow::Stream<gpu>* stream,
@@ -543,6 +766,35 @@ void Resource::get_cudnn_dropout_desc(cudnnDropoutDescriptor_t* dropout_desc,
 }
 #endif  // MXNET_USE_CUDNN == 1
 
+#if MXNET_USE_NCCL == 1
+void ResourceManager::InitNCCLComms(const ncclUniqueId& id,
+                                    int num_ranks,
+                                    int first_rank,
+                                    const std::vector<int>& dev_ids) {
+  resource::NCCLComms* registry = resource::NCCLComms::Get();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  for (int dev_id : dev_ids) {
+    CHECK_EQ(registry->comms.count(dev_id), 0U)
+        << "The NCCL communicator of gpu(" << dev_id << ") is already created";
+  }
+  CHECK_LE(first_rank + static_cast<int>(dev_ids.size()), num_ranks);
+  std::vector<ncclComm_t> comms(dev_ids.size());
+  mxnet::common::cuda::DeviceStore device_store;
+  // the ranks of this process join the communicators together
+  ncclGroupStart();
+  for (size_t i = 0; i < dev_ids.size(); ++i) {
+    device_store.SetDevice(dev_ids[i]);
+    ncclCommInitRank(&comms[i], num_ranks, id, first_rank + static_cast<int>(i));
+  }
+  const ncclResult_t ret = ncclGroupEnd();
+  CHECK_EQ(ret, ncclSuccess) << "Failed to create the NCCL communicators: "
+                             << ncclGetErrorString(ret);
+  for (size_t i = 0; i < dev_ids.size(); ++i) {
+    registry->comms[dev_ids[i]] = comms[i];
+  }
+}
+#endif  // MXNET_USE_NCCL == 1
+
 ResourceManager* ResourceManager::Get() {
   typedef dmlc::ThreadLocalStore<resource::ResourceManagerImpl> inst;
   return inst::Get();
@@ -21,16 +21,21 @@
 // Copyright (C) 2011  Carl Rogers, 2018 Leonard Lausen
 
 #include "cnpy.h"
+#include "./device_staging.h"
+#include <dmlc/parameter.h>
 #include <mxnet/op_attr_types.h>
 #include <mxnet/imperative.h>
 #include <string_view>
+#include <cerrno>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <complex>
+#include <memory>
 #include <numeric>
 #include <limits>
 #include <regex>
@@ -39,8 +44,92 @@
 #include <stdexcept>
 #include <typeinfo>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 namespace mxnet {
 
+// the data of the arrays saved by MXNet starts at a multiple of this many bytes of the file, so
+// that mapped arrays are aligned
+constexpr size_t kNpyDataAlignment = 64;
+
+/*! \brief a file mapped in memory, unmapped when the last array viewing it is released */
+struct MappedFile {
+  char* data{nullptr};
+  size_t size{0};
+  ~MappedFile() {
+#ifndef _WIN32
+    if (data != nullptr)
+      munmap(data, size);
+#endif  // _WIN32
+  }
+};
+
+/*!
+ * \brief maps fname privately: the pages are shared with the other processes mapping the file
+ *  through the page cache until an array writes to them. Null on Windows.
+ */
+std::shared_ptr<MappedFile> map_file(const std::string& fname) {
+#ifndef _WIN32
+  const int fd = open(fname.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Failed to open " << fname << " for mapping: " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << fname;
+  auto file  = std::make_shared<MappedFile>();
+  file->size = st.st_size;
+  if (file->size > 0) {
+    void* ptr = mmap(nullptr, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << fname << ": " << strerror(errno);
+    file->data = static_cast<char*>(ptr);
+  }
+  close(fd);
+  return file;
+#else
+  LOG(WARNING) << "Mapping " << fname << " is not supported on Windows, reading it instead";
+  return nullptr;
+#endif  // _WIN32
+}
+
+/*!
+ * \brief views the array at offset of the mapped file in *out, false if it lies outside of the
+ *  file or is not aligned for its type
+ */
+bool map_array(const std::shared_ptr<MappedFile>& file,
+               size_t offset,
+               const TShape& shape,
+               int type_flag,
+               NDArray* out) {
+  const size_t type_size = mshadow::mshadow_sizeof(type_flag);
+  if (offset % type_size != 0 || offset + shape.Size() * type_size > file->size)
+    return false;
+  TBlob view(file->data + offset, shape, cpu::kDevMask, type_flag);
+  // the view keeps the mapping alive
+  *out = NDArray(view, 0, [file]() {});
+  return true;
+}
+
+/*! \brief array on the CPU in the default layout, once its pending writes completed */
+NDArray readable_cpu_array(const NDArray& array_) {
+  NDArray array;  // a copy on cpu
+  if (array_.ctx().dev_mask() != cpu::kDevMask) {
+    array = array_.Copy(Context::CPU());
+    array.WaitToRead();
+  } else {
+    array = array_;
+    array.WaitToRead();
+#if MXNET_USE_ONEDNN == 1
+    if (array.IsMKLDNNData()) {
+      array = array.Reorder2Default();
+    }
+#endif
+  }
+  return array;
+}
+
 void fortran_order_transpose_prepare(std::vector<dim_t>& shape) {  // NOLINT(runtime/references)
   std::reverse(std::begin(shape), std::end(shape));
 }
@@ -118,7 +207,10 @@ std::string dtype_descr(const TBlob& blob) {
 }
 
 int dtype_descr(const std::string& dtype_descr) {
-  if (dtype_descr.find("f2'") != std::string::npos)
+  // before u2', the type of the field of the bfloat16 structure
+  if (dtype_descr.find("bfloat16'") != std::string::npos)
+    return mshadow::kBfloat16;
+  else if (dtype_descr.find("f2'") != std::string::npos)
     return mshadow::kFloat16;
   else if (dtype_descr.find("f4'") != std::string::npos)
     return mshadow::kFloat32;
@@ -142,14 +234,16 @@ int dtype_descr(const std::string& dtype_descr) {
     return mshadow::kUint32;
   else if (dtype_descr.find("u8'") != std::string::npos)
     return mshadow::kUint64;
-  else if (dtype_descr.find("bfloat16'") != std::string::npos)
-    return mshadow::kBfloat16;
   else
     LOG(FATAL) << "Unknown dtype descriptor " << dtype_descr << "encountered.";
   return -1;
 }
 
-std::string create_npy_header(const TBlob& blob) {
+/*!
+ * \brief the npy header of blob, padded so that the data after it starts at a multiple of
+ *  kNpyDataAlignment bytes of the file when the header starts at offset
+ */
+std::string create_npy_header(const TBlob& blob, size_t offset = 0) {
   std::string dict;
   dict += "{'descr': ";
   dict += dtype_descr(blob);
@@ -166,12 +260,12 @@ std::string create_npy_header(const TBlob& blob) {
   }
   dict += "), }";
 
-  // pad with spaces so that preamble+dict is modulo 64 bytes. preamble is
+  // pad with spaces so that offset+preamble+dict is modulo 64 bytes. preamble is
   // 10 bytes. dict needs to end with \n
-  int remainder = 64 - (10 + dict.size() + 1) % 64;
+  int remainder = kNpyDataAlignment - (offset + 10 + dict.size() + 1) % kNpyDataAlignment;
   dict.insert(dict.end(), remainder, ' ');
   dict.push_back('\n');
-  assert((dict.size() + 10) % 64 == 0);
+  assert((offset + dict.size() + 10) % kNpyDataAlignment == 0);
 
   std::string header;
   header += static_cast<char>(0x93);
@@ -218,10 +312,10 @@ uint32_t parse_npy_header_len(std::ifstream& strm) {
 
   uint32_t header_len = 0;
   header_len += strm.get();
-  header_len += strm.get() >> 8;
+  header_len += strm.get() << 8;
   if (major_version == 0x02) {
-    header_len += strm.get() >> 16;
-    header_len += strm.get() >> 24;
+    header_len += strm.get() << 16;
+    header_len += strm.get() << 24;
   }
   return header_len;
 }
@@ -261,21 +355,11 @@ std::tuple<int, int, std::vector<dim_t>> parse_npy_header_descr(const std::strin
   return std::tuple(type_flag, fortran_order, shape);
 }
 
-void save_array(const std::string& fname, const NDArray& array_) {
-  NDArray array;  // a copy on cpu
-  if (array_.ctx().dev_mask() != cpu::kDevMask) {
-    array = array_.Copy(Context::CPU());
-    array.WaitToRead();
-  } else {
-    array = array_;
-    array.WaitToRead();
-#if MXNET_USE_ONEDNN == 1
-    if (array.IsMKLDNNData()) {
-      array = array.Reorder2Default();
-    }
-#endif
-  }
+void save_array(const std::string& fname, const NDArray& array) {
+  save_cpu_array(fname, readable_cpu_array(array));
+}
 
+void save_cpu_array(const std::string& fname, const NDArray& array) {
   CHECK_EQ(array.storage_type(), kDefaultStorage);
 
   const TBlob& blob      = array.data();
@@ -287,7 +371,7 @@ void save_array(const std::string& fname, const NDArray& array_) {
                blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_));
 }
 
-NDArray load_array(const std::string& fname) {
+NDArray load_array(const std::string& fname, bool use_mmap) {
   std::ifstream strm(fname, std::ios::binary);
   strm.exceptions(std::istream::eofbit);
   strm.exceptions(std::istream::failbit);
@@ -303,6 +387,16 @@ NDArray load_array(const std::string& fname) {
   }
 
   TShape tshape(shape);
+  if (use_mmap && !fortran_order) {
+    const size_t offset = strm.tellg();
+    strm.close();
+    auto file = map_file(fname);
+    NDArray array;
+    if (file && map_array(file, offset, tshape, type_flag, &array))
+      return array;
+    strm.open(fname, std::ios::binary);
+    strm.seekg(offset);
+  }
   NDArray array(tshape, Context::CPU(), false, type_flag);
   const TBlob& blob = array.data();
   strm.read(reinterpret_cast<char*>(blob.dptr_),
@@ -319,43 +413,75 @@ NDArray load_array(const std::string& fname) {
 
 namespace npz {
 
+/*! \brief the npy member written by save_blob: its header, then the data read by read_data */
+struct NpyMemberSource {
+  const std::string* npy_header;
+  std::function<void(size_t offset, void* dst, size_t n)> read_data;
+};
+
 size_t npy_header_blob_read_callback(void* pOpaque, mz_uint64 file_ofs, void* pBuf, size_t n) {
-  auto [npy_header, blob] =                                                  // NOLINT
-      *static_cast<std::tuple<const std::string*, const TBlob*>*>(pOpaque);  // NOLINT
-
-  if (file_ofs < npy_header->size() && file_ofs + n < npy_header->size()) {
-    // Read n bytes from npy_header
-    const void* pSrc = static_cast<const void*>(npy_header->data() + file_ofs);
-    std::memcpy(pBuf, pSrc, n);
-  } else if (file_ofs < npy_header->size()) {
-    // Read npy_header->size() - file_ofs bytes from npy_header
-    const void* pSrc          = static_cast<const void*>(npy_header->data() + file_ofs);
-    const size_t npy_header_n = npy_header->size() - file_ofs;
-    std::memcpy(pBuf, pSrc, npy_header_n);
-
-    // Read n - (npy_header->size() - file_ofs) bytes from blob
-    void* pBuf_blob = static_cast<void*>(static_cast<char*>(pBuf) + npy_header_n);
-    std::memcpy(pBuf_blob, blob->dptr_, n - npy_header_n);
-  } else {
-    // Read n bytes from blob
-    const void* pSrc =
-        static_cast<const void*>(static_cast<char*>(blob->dptr_) + file_ofs - npy_header->size());
-    std::memcpy(pBuf, pSrc, n);
+  const NpyMemberSource& source = *static_cast<const NpyMemberSource*>(pOpaque);
+  const std::string& header     = *source.npy_header;
+  char* dst                     = static_cast<char*>(pBuf);
+  size_t remaining              = n;
+  if (file_ofs < header.size()) {
+    const size_t header_n = std::min<size_t>(remaining, header.size() - file_ofs);
+    std::memcpy(dst, header.data() + file_ofs, header_n);
+    dst += header_n;
+    remaining -= header_n;
+    file_ofs += header_n;
   }
+  if (remaining > 0)
+    source.read_data(file_ofs - header.size(), dst, remaining);
   return n;
 }
 
-void save_blob(mz_zip_archive* archive, const std::string& blob_name, const TBlob& blob) {
-  const std::string npy_header = npy::create_npy_header(blob);
+/*!
+ * \brief offset in the archive of the data of the next member, after its local header, its name
+ *  and the zip64 extra field miniz writes for large members or offsets
+ */
+size_t next_member_data_offset(const mz_zip_archive* archive,
+                               const std::string& name,
+                               mz_uint64 size) {
+  const mz_uint64 offset = archive->m_archive_size;
+  size_t extra           = 0;
+  if (size >= MZ_UINT32_MAX || offset >= MZ_UINT32_MAX) {
+    extra = 2 * sizeof(mz_uint16);
+    extra += size >= MZ_UINT32_MAX ? 2 * sizeof(mz_uint64) : 0;
+    extra += offset >= MZ_UINT32_MAX ? sizeof(mz_uint64) : 0;
+  }
+  // the local header is 30 bytes
+  return offset + 30 + name.size() + extra;
+}
 
+/*!
+ * \brief adds the npy member blob_name.npy with the header of blob and its data, read by read_data,
+ *  by default from the memory of blob
+ */
+void save_blob(mz_zip_archive* archive,
+               const std::string& blob_name,
+               const TBlob& blob,
+               std::function<void(size_t, void*, size_t)> read_data = nullptr) {
   const std::string blob_name_npy = blob_name + ".npy";
-  mz_uint64 size_to_add           = npy_header.size();
-  size_to_add += blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
-  auto callback_data = std::tuple(&npy_header, &blob);
+  const size_t nbytes             = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+  // align the data, for load_arrays to map it
+  const size_t offset = next_member_data_offset(
+      archive, blob_name_npy, npy::create_npy_header(blob).size() + nbytes);
+  const std::string npy_header = npy::create_npy_header(blob, offset);
+  if (read_data == nullptr) {
+    const char* data = static_cast<const char*>(blob.dptr_);
+    read_data        = [data](size_t offset, void* dst, size_t n) {
+      std::memcpy(dst, data + offset, n);
+    };
+  }
+
+  mz_uint64 size_to_add = npy_header.size();
+  size_to_add += nbytes;
+  NpyMemberSource source{&npy_header, std::move(read_data)};
   CHECK(mz_zip_writer_add_read_buf_callback(archive,
                                             blob_name_npy.data(),
                                             npy_header_blob_read_callback,
-                                            static_cast<void*>(&callback_data),
+                                            static_cast<void*>(&source),
                                             size_to_add,
                                             nullptr,
                                             nullptr,
@@ -467,21 +593,7 @@ void save_format_array(mz_zip_archive* archive,
       << mz_zip_get_error_string(mz_zip_get_last_error(archive));
 }
 
-void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array_) {
-  NDArray array;  // a copy on cpu
-  if (array_.ctx().dev_mask() != cpu::kDevMask) {
-    array = array_.Copy(Context::CPU());
-    array.WaitToRead();
-  } else {
-    array = array_;
-    array.WaitToRead();
-#if MXNET_USE_ONEDNN == 1
-    if (array.IsMKLDNNData()) {
-      array = array.Reorder2Default();
-    }
-#endif
-  }
-
+void save_cpu_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array) {
   switch (array.storage_type()) {
     case kDefaultStorage: {
       save_blob(archive, array_name, array.data());
@@ -507,6 +619,51 @@ void save_array(mz_zip_archive* archive, const std::string& array_name, const ND
   }
 }
 
+/*! \brief save_array, streaming the dense arrays of a GPU through staging */
+void save_array(mz_zip_archive* archive,
+                const std::string& array_name,
+                const NDArray& array,
+                DeviceStaging* staging) {
+  if (array.ctx().dev_mask() == cpu::kDevMask || array.storage_type() != kDefaultStorage) {
+    save_cpu_array(archive, array_name, readable_cpu_array(array));
+    return;
+  }
+  staging->Start(array);
+  save_blob(archive, array_name, array.data(), [staging](size_t offset, void* dst, size_t n) {
+    staging->Read(offset, dst, n);
+  });
+}
+
+void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array) {
+  DeviceStaging staging;
+  save_array(archive, array_name, array, &staging);
+}
+
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names,
+                 bool cpu_arrays) {
+  CHECK(names.empty() || names.size() == arrays.size());
+  mz_zip_archive archive{};
+  CHECK(mz_zip_writer_init_file(&archive, fname.data(), 0))
+      << "Failed to open archive " << fname << ": "
+      << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  DeviceStaging staging;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const std::string array_key = names.empty() ? "arr_" + std::to_string(i) : names[i];
+    if (cpu_arrays) {
+      save_cpu_array(&archive, array_key, arrays[i]);
+    } else {
+      save_array(&archive, array_key, arrays[i], &staging);
+    }
+  }
+  CHECK(mz_zip_writer_finalize_archive(&archive))
+      << "Failed to finalize archive " << fname
+      << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  CHECK(mz_zip_writer_end(&archive)) << "Failed to end archive " << fname
+                                     << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+}
+
 uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
                               const std::string_view& fname,
                               const std::string& zip_fname) {
@@ -522,24 +679,50 @@ uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
   uint8_t major_version = buffer[6];
   CHECK(major_version == 0x01 || major_version == 0x02) << "Unsupported npy major version";
   CHECK(buffer[7] == 0x00) << "Unsupported npy minor version";
-  uint32_t header_len = 0;
-  header_len += buffer[8];
-  header_len += buffer[9] >> 8;
+  const auto byte = [&](int i) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(buffer[i]));
+  };
+  uint32_t header_len = byte(8) + (byte(9) << 8);
   if (major_version == 0x02) {
     CHECK_EQ(mz_zip_reader_extract_iter_read(state, &buffer[10], 2), 2)
         << "Failed to read from " << fname << " member of " << zip_fname;
-    header_len += buffer[10] >> 16;
-    header_len += buffer[11] >> 24;
+    header_len += (byte(10) << 16) + (byte(11) << 24);
   }
   return header_len;
 }
 
-std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
-    const std::string& zip_fname) {
+/*!
+ * \brief offset in the mapped archive of the data of the uncompressed dense array in the member
+ *  path, with a header of header_len bytes; 0 if the member is compressed
+ */
+size_t member_array_offset(mz_zip_archive* archive,
+                           const MappedFile& file,
+                           const std::string& path,
+                           uint32_t header_len) {
+  const int index = mz_zip_reader_locate_file(archive, path.data(), nullptr, 0);
+  mz_zip_archive_file_stat stat;
+  if (index < 0 || !mz_zip_reader_file_stat(archive, index, &stat) || stat.m_method != 0)
+    return 0;
+  // the name and the extra field of the 30 bytes local header
+  const size_t header_ofs = stat.m_local_header_ofs;
+  CHECK_LE(header_ofs + 30, file.size) << "Invalid local header of " << path;
+  uint16_t name_len, extra_len;
+  std::memcpy(&name_len, file.data + header_ofs + 26, sizeof(name_len));
+  std::memcpy(&extra_len, file.data + header_ofs + 28, sizeof(extra_len));
+  const size_t npy_ofs = header_ofs + 30 + name_len + extra_len;
+  CHECK_LE(npy_ofs + 8, file.size) << "Invalid local header of " << path;
+  // the preamble of the npy format is 10 bytes in version 1 and 12 bytes in version 2
+  return npy_ofs + (file.data[npy_ofs + 6] == 0x01 ? 10 : 12) + header_len;
+}
+
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& zip_fname,
+                                                                      bool use_mmap) {
   mz_zip_archive archive{};
   CHECK(mz_zip_reader_init_file(&archive, zip_fname.data(), 0))
       << "Failed to open archive " << zip_fname << ": "
       << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  // the dense arrays stored uncompressed are views of the mapped archive
+  const std::shared_ptr<MappedFile> mapped = use_mmap ? map_file(zip_fname) : nullptr;
 
   // Collect the set of file-names per folder in the zip file. If the set of
   // file names in a folder matches the scipy.sparse.save_npz pattern, the
@@ -912,12 +1095,18 @@ std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
         }
 
         TShape tshape(shape);
-        NDArray array(tshape, Context::CPU(), false, type_flag);
-        const TBlob& blob = array.data();
-        size_t nbytes     = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
-        CHECK_EQ(mz_zip_reader_extract_iter_read(file, blob.dptr_, nbytes), nbytes)
-            << "Failed to read from " << fname << " member of " << zip_fname << ": "
-            << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+        NDArray array;
+        const size_t offset = mapped && !fortran_order ?
+                                  member_array_offset(&archive, *mapped, path, header_len) :
+                                  0;
+        if (offset == 0 || !map_array(mapped, offset, tshape, type_flag, &array)) {
+          array             = NDArray(tshape, Context::CPU(), false, type_flag);
+          const TBlob& blob = array.data();
+          size_t nbytes     = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+          CHECK_EQ(mz_zip_reader_extract_iter_read(file, blob.dptr_, nbytes), nbytes)
+              << "Failed to read from " << fname << " member of " << zip_fname << ": "
+              << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+        }
         CHECK(mz_zip_reader_extract_iter_free(file));
 
         if (fortran_order) {
@@ -25,6 +25,7 @@
 #define MXNET_SERIALIZATION_CNPY_H_
 
 #include <mxnet/ndarray.h>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,15 +37,42 @@ namespace mxnet {
 namespace npy {
 
 void save_array(const std::string& fname, const NDArray& array);
-NDArray load_array(const std::string& fname);
+/*!
+ * \brief save_array of a dense array of the CPU in the default layout, whose pending writes have
+ *  completed: it reads the array without waiting for the engine
+ */
+void save_cpu_array(const std::string& fname, const NDArray& array);
+/*!
+ * \brief loads the array of the npy file fname; with use_mmap, the array is a copy-on-write view
+ *  of the mapped file unless it is in Fortran order
+ */
+NDArray load_array(const std::string& fname, bool use_mmap = false);
 
 }  // namespace npy
 
 namespace npz {
 
 void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array);
+/*! \brief save_array of an array like those of npy::save_cpu_array, of any storage type */
+void save_cpu_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array);
 
-std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname);
+/*!
+ * \brief saves arrays to the npz file fname, named arr_0, arr_1, ... without names. The dense
+ *  arrays of a GPU are copied to the file in chunks through pinned staging buffers, see
+ *  MXNET_LOAD_STAGING_BYTES, without a copy of the whole array on the host.
+ * \param cpu_arrays whether the arrays are like those of save_cpu_array, saved without waiting
+ */
+void save_arrays(const std::string& fname,
+                 const std::vector<NDArray>& arrays,
+                 const std::vector<std::string>& names,
+                 bool cpu_arrays = false);
+
+/*!
+ * \brief loads the arrays of the npz file fname; with use_mmap, the dense arrays stored
+ *  uncompressed in C order are copy-on-write views of the mapped file
+ */
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname,
+                                                                      bool use_mmap = false);
 
 }  // namespace npz
 }  // namespace mxnet
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file device_staging.h
+ * \brief copies of the arrays of GPUs to the host in chunks, for saving them
+ */
+#ifndef MXNET_SERIALIZATION_DEVICE_STAGING_H_
+#define MXNET_SERIALIZATION_DEVICE_STAGING_H_
+
+#include <dmlc/io.h>
+#include <dmlc/parameter.h>
+#include <mxnet/ndarray.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace mxnet {
+
+/*!
+ * \brief The dense arrays of a GPU go to the file in chunks through a ring of pinned staging
+ *  buffers, so that the copies of the next chunks from the GPU overlap writing the current one,
+ *  without a copy of the whole array on the host.
+ */
+class DeviceStaging {
+ public:
+  DeviceStaging()
+      : staging_bytes_(
+            std::max(dmlc::GetEnv("MXNET_LOAD_STAGING_BYTES", size_t(16) << 20), sizeof(double))),
+        num_staging_(std::max(dmlc::GetEnv("MXNET_LOAD_STAGING_BUFFERS", 4), 1)) {}
+
+  /*! \brief starts copying the chunks of the dense array of a GPU, which Read returns */
+  void Start(const NDArray& array) {
+    size_       = array.shape().Size();
+    elem_bytes_ = mshadow::mshadow_sizeof(array.dtype());
+    chunk_      = staging_bytes_ / elem_bytes_;
+    num_chunks_ = (size_ + chunk_ - 1) / chunk_;
+    next_chunk_ = 0;
+    if (size_ == 0)
+      return;
+    array_ = array;
+    flat_  = array.Reshape(mxnet::TShape(1, size_));
+    for (size_t c = 0; c < std::min(num_chunks_, num_staging_); ++c)
+      Issue();
+  }
+
+  /*! \brief copies n bytes of the data of the array at offset to dst; the offsets increase */
+  void Read(size_t offset, void* dst, size_t n) {
+    const size_t chunk_bytes = chunk_ * elem_bytes_;
+    char* out                = static_cast<char*>(dst);
+    while (n > 0) {
+      const size_t c = offset / chunk_bytes;
+      // the chunks before c are read, so their buffers take the next chunks
+      while (next_chunk_ < num_chunks_ && next_chunk_ < c + num_staging_)
+        Issue();
+      const NDArray& buffer = staging_[c % num_staging_];
+      buffer.WaitToRead();
+      const size_t begin = offset - c * chunk_bytes;
+      const size_t end   = std::min(chunk_bytes, size_ * elem_bytes_ - c * chunk_bytes);
+      const size_t len   = std::min(n, end - begin);
+      std::memcpy(out, static_cast<const char*>(buffer.data().dptr_) + begin, len);
+      out += len;
+      offset += len;
+      n -= len;
+    }
+  }
+
+  /*! \brief writes the data of the array started to strm, from the staging buffers */
+  void Write(dmlc::Stream* strm) {
+    const size_t chunk_bytes = chunk_ * elem_bytes_;
+    for (size_t c = 0; c < num_chunks_; ++c) {
+      while (next_chunk_ < num_chunks_ && next_chunk_ < c + num_staging_)
+        Issue();
+      const NDArray& buffer = staging_[c % num_staging_];
+      buffer.WaitToRead();
+      strm->Write(buffer.data().dptr_,
+                  std::min(chunk_bytes, size_ * elem_bytes_ - c * chunk_bytes));
+    }
+  }
+
+ private:
+  /*! \brief copies the next chunk into its staging buffer */
+  void Issue() {
+    const size_t c     = next_chunk_++;
+    const index_t from = c * chunk_;
+    const index_t to   = std::min(from + chunk_, size_);
+    if (staging_.size() < num_staging_) {
+      staging_.emplace_back(mxnet::TShape(1, staging_bytes_),
+                            Context::CPUPinned(array_.ctx().dev_id),
+                            false,
+                            mshadow::kUint8);
+    }
+    const NDArray buffer =
+        staging_[c % num_staging_].AsArray(mxnet::TShape(1, to - from), array_.dtype());
+    CopyFromTo(flat_.Slice(from, to), buffer);
+  }
+
+  const size_t staging_bytes_;
+  const size_t num_staging_;
+  std::vector<NDArray> staging_;
+  NDArray array_;
+  NDArray flat_;
+  index_t size_{0};
+  size_t elem_bytes_{1};
+  index_t chunk_{1};
+  size_t num_chunks_{0};
+  size_t next_chunk_{0};
+};
+
+}  // namespace mxnet
+
+#endif  // MXNET_SERIALIZATION_DEVICE_STAGING_H_
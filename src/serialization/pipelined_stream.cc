@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pipelined_stream.cc
+ * \brief stream writing to another one from a thread, for the streams of remote files
+ */
+#include "./pipelined_stream.h"
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <utility>
+
+namespace mxnet {
+
+PipelinedWriteStream::PipelinedWriteStream(std::unique_ptr<dmlc::Stream> stream,
+                                           size_t part_bytes,
+                                           size_t num_parts)
+    : stream_(std::move(stream)),
+      part_bytes_(std::max<size_t>(part_bytes, 1)),
+      num_parts_(num_parts) {
+  if (num_parts_ == 0)
+    return;
+  current_.reserve(part_bytes_);
+  writer_ = std::thread([this]() { WriteParts(); });
+}
+
+PipelinedWriteStream::~PipelinedWriteStream() {
+  if (!stream_)
+    return;
+  try {
+    Close();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to write the stream: " << e.what();
+  }
+}
+
+size_t PipelinedWriteStream::Read(void*, size_t) {
+  LOG(FATAL) << "PipelinedWriteStream is not readable";
+  return 0;
+}
+
+void PipelinedWriteStream::Write(const void* ptr, size_t size) {
+  if (num_parts_ == 0) {
+    stream_->Write(ptr, size);
+    return;
+  }
+  const char* data = static_cast<const char*>(ptr);
+  while (size > 0) {
+    const size_t n = std::min(size, part_bytes_ - current_.size());
+    current_.append(data, n);
+    data += n;
+    size -= n;
+    if (current_.size() == part_bytes_)
+      Flush();
+  }
+}
+
+void PipelinedWriteStream::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this]() { return parts_.size() < num_parts_ || error_; });
+  if (error_)
+    std::rethrow_exception(error_);
+  parts_.emplace_back(std::move(current_));
+  if (free_parts_.empty()) {
+    current_ = std::string();
+    current_.reserve(part_bytes_);
+  } else {
+    current_ = std::move(free_parts_.back());
+    free_parts_.pop_back();
+  }
+  cond_.notify_all();
+}
+
+void PipelinedWriteStream::Close() {
+  CHECK(stream_) << "PipelinedWriteStream is closed";
+  std::exception_ptr error;
+  if (writer_.joinable()) {
+    try {
+      if (!current_.empty())
+        Flush();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cond_.notify_all();
+    writer_.join();
+    if (!error)
+      error = error_;
+  }
+  // closing a remote stream completes the upload
+  try {
+    stream_.reset();
+  } catch (...) {
+    if (!error)
+      error = std::current_exception();
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void PipelinedWriteStream::WriteParts() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() { return !parts_.empty() || closed_; });
+    if (parts_.empty())
+      return;
+    std::string part = std::move(parts_.front());
+    parts_.pop_front();
+    lock.unlock();
+    try {
+      stream_->Write(part.data(), part.size());
+    } catch (...) {
+      lock.lock();
+      error_ = std::current_exception();
+      parts_.clear();
+      cond_.notify_all();
+      return;
+    }
+    part.clear();
+    lock.lock();
+    free_parts_.emplace_back(std::move(part));
+    cond_.notify_all();
+  }
+}
+
+bool PipelinedWriteStream::IsRemote(const std::string& uri) {
+  const size_t pos = uri.find("://");
+  return pos != std::string::npos && uri.compare(0, pos, "file") != 0;
+}
+
+std::unique_ptr<PipelinedWriteStream> PipelinedWriteStream::Create(const std::string& uri) {
+  std::unique_ptr<dmlc::Stream> stream(dmlc::Stream::Create(uri.c_str(), "w"));
+  const int num_parts =
+      IsRemote(uri) ? std::max(dmlc::GetEnv("MXNET_REMOTE_SAVE_PARTS", 4), 0) : 0;
+  const size_t part_bytes = dmlc::GetEnv("MXNET_REMOTE_SAVE_PART_BYTES", size_t(64) << 20);
+  return std::unique_ptr<PipelinedWriteStream>(
+      new PipelinedWriteStream(std::move(stream), part_bytes, num_parts));
+}
+
+}  // namespace mxnet
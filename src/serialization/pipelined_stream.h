@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pipelined_stream.h
+ * \brief stream writing to another one from a thread, for the streams of remote files
+ */
+#ifndef MXNET_SERIALIZATION_PIPELINED_STREAM_H_
+#define MXNET_SERIALIZATION_PIPELINED_STREAM_H_
+
+#include <dmlc/io.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mxnet {
+
+/*!
+ * \brief Writes to a stream in parts of part_bytes from its own thread, so that the writer
+ *  prepares the next parts, such as copying them from GPUs, while the current one is uploaded.
+ *  Write blocks while num_parts parts wait for the stream. With no parts, Write writes to the
+ *  stream directly.
+ */
+class PipelinedWriteStream : public dmlc::Stream {
+ public:
+  PipelinedWriteStream(std::unique_ptr<dmlc::Stream> stream, size_t part_bytes, size_t num_parts);
+  /*! \brief closes the stream if Close was not called, logging the error of the writes */
+  ~PipelinedWriteStream() override;
+
+  size_t Read(void* ptr, size_t size) override;
+  void Write(const void* ptr, size_t size) override;
+  /*! \brief writes the pending parts and closes the stream, throwing the error of the writes */
+  void Close();
+
+  /*! \brief whether uri names a file of a remote file system, such as s3:// or hdfs:// */
+  static bool IsRemote(const std::string& uri);
+  /*!
+   * \brief the stream to write uri with, pipelined for the files of remote file systems as
+   *  configured by MXNET_REMOTE_SAVE_PART_BYTES and MXNET_REMOTE_SAVE_PARTS
+   */
+  static std::unique_ptr<PipelinedWriteStream> Create(const std::string& uri);
+
+ private:
+  /*! \brief the body of the thread writing the parts to the stream */
+  void WriteParts();
+  /*! \brief queues the current part for the thread */
+  void Flush();
+
+  std::unique_ptr<dmlc::Stream> stream_;
+  const size_t part_bytes_;
+  const size_t num_parts_;
+  std::string current_;
+  std::deque<std::string> parts_;
+  std::vector<std::string> free_parts_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool closed_{false};
+  std::exception_ptr error_;
+  std::thread writer_;
+};
+
+}  // namespace mxnet
+
+#endif  // MXNET_SERIALIZATION_PIPELINED_STREAM_H_
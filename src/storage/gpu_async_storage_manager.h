@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file gpu_async_storage_manager.h
+ * \brief GPU storage manager based on the stream ordered allocator of CUDA.
+ */
+#ifndef MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
+
+#if MXNET_USE_CUDA
+#include <cuda_runtime.h>
+#include <dmlc/parameter.h>
+#include <mxnet/storage.h>
+#include <sstream>
+#include <string>
+#include "./storage_manager.h"
+#include "./pooled_storage_manager.h"
+#include "../common/cuda/utils.h"
+#include "../profiler/storage_profiler.h"
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Whether GPU dev_id supports the stream ordered allocator.
+ */
+inline bool GPUAsyncStorageSupported(int dev_id) {
+#if CUDART_VERSION >= 11020
+  int supported = 0;
+  if (cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, dev_id) != cudaSuccess) {
+    cudaGetLastError();
+    return false;
+  }
+  return supported != 0;
+#else
+  return false;
+#endif
+}
+
+#if CUDART_VERSION >= 11020
+/*!
+ * \brief GPU storage manager using cudaMallocFromPoolAsync and cudaFreeAsync.
+ *
+ * Unlike cudaMalloc and cudaFree, the stream ordered calls do not synchronize the device,
+ * so a pool miss does not stall the other streams. On an engine worker, memory is
+ * allocated and freed on the stream of the worker, so it is ready for the running
+ * operator without any synchronization. Other threads use a stream of the manager
+ * and wait for the allocation to be ready. The engine guarantees that no pending work
+ * uses a buffer when it is freed.
+ *
+ * The device memory is kept by a cudaMemPool_t. The pool gives memory back to the
+ * system at synchronization points once it holds more than the release threshold:
+ * MXNET_GPU_MEM_POOL_RELEASE_THRESHOLD bytes, by default all the memory except the
+ * MXNET_GPU_MEM_POOL_RESERVE percentage. ReleaseAll trims the pool.
+ */
+class GPUAsyncStorageManager final : public StorageManager {
+ public:
+  explicit GPUAsyncStorageManager(const Context& ctx) : dev_id_(ctx.real_dev_id()) {
+    mxnet::common::cuda::DeviceStore device_store(dev_id_, true);
+    cudaMemPoolProps props = {};
+    props.allocType        = cudaMemAllocationTypePinned;
+    props.handleTypes      = cudaMemHandleTypeNone;
+    props.location.type    = cudaMemLocationTypeDevice;
+    props.location.id      = dev_id_;
+    CUDA_CALL(cudaMemPoolCreate(&pool_, &props));
+
+    size_t free_mem = 0, total_mem = 0;
+    CUDA_CALL(cudaMemGetInfo(&free_mem, &total_mem));
+    const size_t reserve = dmlc::GetEnv(env_var_name("GPU", pool_reserve).c_str(), 5);
+    CHECK_LE(reserve, 100) << env_var_name("GPU", pool_reserve) << " must be a percentage";
+    uint64_t threshold = dmlc::GetEnv("MXNET_GPU_MEM_POOL_RELEASE_THRESHOLD",
+                                      static_cast<uint64_t>(total_mem / 100 * (100 - reserve)));
+    CUDA_CALL(cudaMemPoolSetAttribute(pool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+    CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+  }
+
+  ~GPUAsyncStorageManager() override {
+    // The CUDA runtime may already be unloading at exit, ignore the errors.
+    mxnet::common::cuda::DeviceStore device_store(dev_id_, true);
+    cudaStreamSynchronize(stream_);
+    cudaStreamDestroy(stream_);
+    cudaMemPoolDestroy(pool_);
+    cudaGetLastError();
+  }
+
+  void Alloc(Storage::Handle* handle) override {
+    mxnet::common::cuda::DeviceStore device_store(dev_id_, true);
+    cudaStream_t stream = mxnet::common::cuda::GetThreadStream(dev_id_);
+    const bool own      = stream == nullptr;
+    if (own)
+      stream = stream_;
+    cudaError_t e = cudaMallocFromPoolAsync(&handle->dptr, handle->size, pool_, stream);
+    if (e == cudaErrorMemoryAllocation) {
+      // retry after giving back the memory parked in the pool
+      cudaGetLastError();
+      ReleaseAll();
+      e = cudaMallocFromPoolAsync(&handle->dptr, handle->size, pool_, stream);
+    }
+    if (e != cudaSuccess) {
+      cudaGetLastError();
+      LOG(FATAL) << "Memory allocation failed " << cudaGetErrorString(e);
+    }
+    if (own)
+      CUDA_CALL(cudaStreamSynchronize(stream_));
+    profiler::GpuDeviceStorageProfiler::Get()->OnAlloc(*handle, handle->size, false);
+  }
+
+  void Free(Storage::Handle handle) override {
+    mxnet::common::cuda::DeviceStore device_store(dev_id_, true);
+    cudaStream_t stream = mxnet::common::cuda::GetThreadStream(dev_id_);
+    CUDA_CALL(cudaFreeAsync(handle.dptr, stream != nullptr ? stream : stream_));
+    profiler::GpuDeviceStorageProfiler::Get()->OnFree(handle);
+  }
+
+  void DirectFree(Storage::Handle handle) override {
+    Free(handle);
+  }
+
+  void ReleaseAll() override {
+    mxnet::common::cuda::DeviceStore device_store(dev_id_, true);
+    CUDA_CALL(cudaStreamSynchronize(stream_));
+    CUDA_CALL(cudaMemPoolTrimTo(pool_, 0));
+  }
+
+  std::string Stats() override {
+    uint64_t reserved = 0, reserved_high = 0, used = 0, used_high = 0;
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrReservedMemCurrent, &reserved));
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrReservedMemHigh, &reserved_high));
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrUsedMemCurrent, &used));
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrUsedMemHigh, &used_high));
+    std::ostringstream os;
+    os << "{\"used_bytes\": " << reserved << ", \"peak_used_bytes\": " << reserved_high
+       << ", \"in_use_bytes\": " << used << ", \"peak_in_use_bytes\": " << used_high << "}";
+    return os.str();
+  }
+
+  void Usage(size_t* held_bytes, size_t* in_use_bytes) override {
+    uint64_t reserved = 0, used = 0;
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrReservedMemCurrent, &reserved));
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrUsedMemCurrent, &used));
+    *held_bytes   = reserved;
+    *in_use_bytes = used;
+  }
+
+ private:
+  int dev_id_;
+  cudaMemPool_t pool_;
+  // stream for the allocations of threads that are not engine workers
+  cudaStream_t stream_;
+
+  DISALLOW_COPY_AND_ASSIGN(GPUAsyncStorageManager);
+};  // class GPUAsyncStorageManager
+#endif  // CUDART_VERSION >= 11020
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
+#endif  // MXNET_STORAGE_GPU_ASYNC_STORAGE_MANAGER_H_
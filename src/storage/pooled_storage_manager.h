@@ -27,7 +27,9 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <map>
 #include <mutex>
+#include <sstream>
 #include <tuple>
 #include "./storage_manager.h"
 #include "../profiler/storage_profiler.h"
@@ -129,11 +131,14 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
   void Free(Storage::Handle handle) override {
     // Insert returned memory in cache
     std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
-    StoringMethod::InsertInCache(BucketingStrategy::get_bucket(handle.size), handle.dptr);
+    const auto bucket_id = BucketingStrategy::get_bucket(handle.size);
+    StoringMethod::InsertInCache(bucket_id, handle.dptr);
+    --bucket_stats_[bucket_id].in_use;
   }
 
   void DirectFree(Storage::Handle handle) override {
     std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    --bucket_stats_[BucketingStrategy::get_bucket(handle.size)].in_use;
     SET_DEVICE(device_store, contextHelper_, handle.ctx, true);
     contextHelper_->Free(handle.dptr);
     SET_GPU_PROFILER(profilerGPU, contextHelper_);
@@ -147,8 +152,48 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     ReleaseAllNoLock();
   }
 
+  std::string Stats() override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    std::ostringstream os;
+    os << "{\"used_bytes\": " << used_memory_ << ", \"peak_used_bytes\": " << peak_used_memory_
+       << ", \"reserve_bytes\": " << memory_allocation_limit_ << ", \"num_release_all\": "
+       << num_release_all_ << ", \"buckets\": [";
+    bool first = true;
+    for (const auto& kv : bucket_stats_) {
+      const size_t size        = BucketingStrategy::RoundAllocSizeForBucket(kv.first);
+      const size_t free_blocks = StoringMethod::NumFreeBlocks(kv.first);
+      const auto& s            = kv.second;
+      os << (first ? "" : ", ") << "{\"size\": " << size << ", \"free_blocks\": " << free_blocks
+         << ", \"free_bytes\": " << free_blocks * size << ", \"in_use_blocks\": " << s.in_use
+         << ", \"peak_in_use_blocks\": " << s.peak_in_use << ", \"hits\": " << s.hits
+         << ", \"misses\": " << s.misses << "}";
+      first = false;
+    }
+    os << "]}";
+    return os.str();
+  }
+
+  void Usage(size_t* held_bytes, size_t* in_use_bytes) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    size_t free_bytes = 0;
+    for (const auto& kv : bucket_stats_)
+      free_bytes += StoringMethod::NumFreeBlocks(kv.first) *
+                    BucketingStrategy::RoundAllocSizeForBucket(kv.first);
+    *held_bytes   = used_memory_;
+    *in_use_bytes = used_memory_ - std::min(free_bytes, used_memory_);
+  }
+
  private:
+  /*! \brief usage counters of one bucket */
+  struct BucketStats {
+    int64_t in_use      = 0;
+    int64_t peak_in_use = 0;
+    uint64_t hits       = 0;
+    uint64_t misses     = 0;
+  };
+
   void ReleaseAllNoLock(bool set_device = true) {
+    ++num_release_all_;
     SET_DEVICE(device_store, contextHelper_, contextHelper_->initilal_context(), set_device);
     used_memory_ -= StoringMethod::ReleaseAllNoLock(contextHelper_.get(), this);
     UNSET_DEVICE(device_store);
@@ -163,8 +208,14 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
   Context::DeviceType dev_type_;
   // used memory
   size_t used_memory_ = 0;
+  // high-water mark of used_memory_
+  size_t peak_used_memory_ = 0;
   // minimum amount of memory, which will never be allocated
   size_t memory_allocation_limit_ = 0;
+  // number of times the cached memory was released
+  size_t num_release_all_ = 0;
+  // usage counters per bucket, ordered by size
+  std::map<size_t, BucketStats> bucket_stats_;
   // Pointer to the Helper, supporting some context-specific operations in GPU/CPU/CPUPinned context
   std::unique_ptr<ContextHelper> contextHelper_;
 };
@@ -201,12 +252,19 @@ void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Hand
     UNSET_DEVICE(device_store);
 
     used_memory_ += roundSize;
-    handle->dptr = ret;
+    peak_used_memory_ = std::max(peak_used_memory_, used_memory_);
+    handle->dptr      = ret;
   } else {
     // Reusing memory
     handle->dptr = reuse_pool->back();
     reuse_pool->pop_back();
   }
+  auto& stats = bucket_stats_[bucket_id];
+  if (reuse_pool)
+    ++stats.hits;
+  else
+    ++stats.misses;
+  stats.peak_in_use = std::max(stats.peak_in_use, ++stats.in_use);
 #if MXNET_USE_CUDA
   SET_GPU_PROFILER(profilerGPU, contextHelper_);
   if (profilerGPU) {
@@ -387,6 +445,11 @@ class UnorderedMapContainer {
     return reuse_it != memory_pool_.end() && reuse_it->second.size() ? &reuse_it->second : nullptr;
   }
 
+  inline size_t NumFreeBlocks(size_t key) const {
+    auto&& it = memory_pool_.find(key);
+    return it != memory_pool_.end() ? it->second.size() : 0;
+  }
+
   size_t ReleaseAllNoLock(const ContextHelper* contextHelper, const RoundHelper* /*rndHelper*/) {
     SET_GPU_PROFILER(profilerGPU, contextHelper);
     size_t released_memory = 0;
@@ -431,6 +494,10 @@ class VectorContainer {
     return reuse_pool.size() ? &reuse_pool : nullptr;
   }
 
+  inline size_t NumFreeBlocks(size_t idx) const {
+    return memory_pool_[idx].size();
+  }
+
   size_t ReleaseAllNoLock(const ContextHelper* contextHelper, const RoundHelper* rndHelper) {
     SET_GPU_PROFILER(profilerGPU, contextHelper);
     size_t released_memory = 0;
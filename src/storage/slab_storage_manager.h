@@ -0,0 +1,420 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file slab_storage_manager.h
+ * \brief CPU storage manager with size classes, slabs and per-thread caches.
+ */
+#ifndef MXNET_STORAGE_SLAB_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_SLAB_STORAGE_MANAGER_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "./storage_manager.h"
+#include "../common/numa.h"
+#include "../common/utils.h"
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Storage manager for CPU memory in the style of tcmalloc/jemalloc.
+ *
+ * Requests are rounded up to one of four size classes per power of two. Every thread
+ * keeps a small cache of free chunks per size class, so that allocation and freeing
+ * usually take no lock. Threads exchange chunks with a central free list per size
+ * class in batches, under a per-class mutex.
+ *
+ * Small classes are carved out of slabs aligned to their size, which cuts the number
+ * of system allocations. A slab is returned to the system once all of its chunks are
+ * back in the central free list. Larger classes own individual allocations. Requests
+ * above MXNET_CPU_SLAB_MAX_SIZE bytes are not pooled.
+ *
+ * Memory that stays unused in the central lists for MXNET_CPU_SLAB_RELEASE_INTERVAL
+ * seconds is returned to the system. ReleaseAll returns all free memory that is not
+ * cached by other threads.
+ */
+class SlabStorageManager final : public StorageManager {
+ public:
+  explicit SlabStorageManager(const Context& ctx)
+      : central_(std::make_shared<Central>(ctx.real_dev_id())) {}
+  ~SlabStorageManager() override = default;
+
+  void Alloc(Storage::Handle* handle) override {
+    const int cls = central_->ClassOf(handle->size);
+    if (cls < 0) {
+      handle->dptr = central_->SystemAlloc(handle->size, kAlignment);
+      return;
+    }
+    ThreadCache* tc = GetThreadCache();
+    auto& bin       = tc->bins[cls];
+    if (bin.empty())
+      central_->Refill(cls, &bin);
+    handle->dptr = bin.back();
+    bin.pop_back();
+  }
+
+  void Free(Storage::Handle handle) override {
+    const int cls = central_->ClassOf(handle.size);
+    if (cls < 0) {
+      central_->SystemFree(handle.dptr, handle.size);
+      return;
+    }
+    ThreadCache* tc = GetThreadCache();
+    auto& bin       = tc->bins[cls];
+    bin.push_back(handle.dptr);
+    if (bin.size() > central_->classes[cls].max_cached)
+      central_->Flush(cls, &bin, central_->classes[cls].batch);
+  }
+
+  void DirectFree(Storage::Handle handle) override {
+    const int cls = central_->ClassOf(handle.size);
+    if (cls < 0 || central_->classes[cls].slab) {
+      // Slab chunks can only go back to the system with their whole slab.
+      Free(handle);
+    } else {
+      central_->SystemFree(handle.dptr, central_->classes[cls].size);
+    }
+  }
+
+  void ReleaseAll() override {
+    ThreadCache* tc = GetThreadCache();
+    for (size_t cls = 0; cls < tc->bins.size(); ++cls)
+      central_->Flush(cls, &tc->bins[cls], tc->bins[cls].size());
+    central_->Release(false);
+  }
+
+  std::string Stats() override {
+    std::ostringstream os;
+    os << "{\"used_bytes\": " << central_->system_bytes << ", \"buckets\": [";
+    bool first = true;
+    for (size_t cls = 0; cls < central_->classes.size(); ++cls) {
+      const SizeClass& c = central_->classes[cls];
+      CentralBin& bin    = central_->bins[cls];
+      std::lock_guard<std::mutex> lock(bin.mutex);
+      if (bin.free.empty() && bin.slabs.empty())
+        continue;
+      os << (first ? "" : ", ") << "{\"size\": " << c.size
+         << ", \"free_blocks\": " << bin.free.size()
+         << ", \"free_bytes\": " << bin.free.size() * c.size << ", \"slabs\": " << bin.slabs.size()
+         << "}";
+      first = false;
+    }
+    os << "]}";
+    return os.str();
+  }
+
+  // the blocks cached by the threads count as in use
+  void Usage(size_t* held_bytes, size_t* in_use_bytes) override {
+    size_t free_bytes = 0;
+    for (size_t cls = 0; cls < central_->classes.size(); ++cls) {
+      CentralBin& bin = central_->bins[cls];
+      std::lock_guard<std::mutex> lock(bin.mutex);
+      free_bytes += bin.free.size() * central_->classes[cls].size;
+    }
+    *held_bytes   = central_->system_bytes;
+    *in_use_bytes = *held_bytes - std::min(free_bytes, *held_bytes);
+  }
+
+  /*! \return bytes currently obtained from the system */
+  size_t system_bytes() const {
+    return central_->system_bytes;
+  }
+
+ private:
+#if MXNET_USE_ONEDNN == 1 || MXNET_USE_INTGEMM == 1
+  static constexpr size_t kAlignment = kMKLDNNAlign;
+#else
+  static constexpr size_t kAlignment = 16;
+#endif
+  /*! \brief size of a slab, slabs are aligned to it */
+  static constexpr size_t kSlabSize = 256 * 1024;
+  /*! \brief classes up to this size are carved out of slabs */
+  static constexpr size_t kMaxSlabChunk = kSlabSize / 8;
+  /*! \brief maximum number of chunks per class in a thread cache */
+  static constexpr size_t kMaxCachedChunks = 64;
+
+  struct SizeClass {
+    size_t size;
+    bool slab;
+    size_t max_cached;
+    size_t batch;
+  };
+
+  struct CentralBin {
+    std::mutex mutex;
+    std::vector<void*> free;
+    /*! \brief smallest size of free since the last release */
+    size_t low_water = 0;
+    /*! \brief base addresses of the slabs of this class */
+    std::unordered_set<void*> slabs;
+  };
+
+  struct Central {
+    explicit Central(int dev_id) : id(NextId()), dev_id(dev_id) {
+      max_size = dmlc::GetEnv("MXNET_CPU_SLAB_MAX_SIZE", static_cast<size_t>(16) << 20);
+      thread_cache_bytes =
+          dmlc::GetEnv("MXNET_CPU_SLAB_THREAD_CACHE_SIZE", static_cast<size_t>(4) << 20);
+      release_interval_ns =
+          static_cast<int64_t>(dmlc::GetEnv("MXNET_CPU_SLAB_RELEASE_INTERVAL", 10.0) * 1e9);
+      CHECK_LE(max_size, static_cast<size_t>(1) << 40) << "MXNET_CPU_SLAB_MAX_SIZE is too large";
+      for (size_t rounded = kAlignment;; rounded = RoundClassSize(rounded + 1)) {
+        SizeClass c;
+        c.size       = rounded;
+        c.slab       = rounded <= kMaxSlabChunk;
+        c.max_cached = std::min(kMaxCachedChunks, thread_cache_bytes / rounded);
+        c.batch      = std::max<size_t>(1, c.max_cached / 2);
+        classes.push_back(c);
+        if (rounded >= max_size)
+          break;
+      }
+      // lookup table from the rounded size to the class
+      for (size_t i = 0; i < classes.size(); ++i)
+        class_index[classes[i].size] = static_cast<int>(i);
+      bins.reset(new CentralBin[classes.size()]);
+      next_release_ns = NowNs() + release_interval_ns;
+    }
+
+    ~Central() {
+      for (size_t i = 0; i < classes.size(); ++i) {
+        if (classes[i].slab) {
+          for (void* slab : bins[i].slabs)
+            common::AlignedMemFree(slab);
+        } else {
+          for (void* p : bins[i].free)
+            common::AlignedMemFree(p);
+        }
+      }
+    }
+
+    static uint64_t NextId() {
+      static std::atomic<uint64_t> next_id{1};
+      return next_id++;
+    }
+
+    static int64_t NowNs() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    /*!
+     * \brief round size up to its class: four classes per power of two,
+     *  multiples of kAlignment
+     */
+    static size_t RoundClassSize(size_t size) {
+      if (size <= kAlignment)
+        return kAlignment;
+      // size is in (2^log2, 2^(log2 + 1)]
+      const int log2    = common::ilog2ul(size - 1) - 1;
+      const size_t step = std::max(kAlignment, static_cast<size_t>(1) << std::max(0, log2 - 2));
+      return (size + step - 1) / step * step;
+    }
+
+    int ClassOf(size_t size) const {
+      if (size > max_size || size == 0)
+        return -1;
+      auto it = class_index.find(RoundClassSize(size));
+      return it == class_index.end() ? -1 : it->second;
+    }
+
+    void* SystemAlloc(size_t size, size_t alignment) {
+      void* ptr = nullptr;
+      if (!common::numa::AlignedMemAllocForDevice(&ptr, size, alignment, dev_id)) {
+        // retry after returning the free memory of the pool
+        Release(false);
+        if (!common::numa::AlignedMemAllocForDevice(&ptr, size, alignment, dev_id))
+          LOG(FATAL) << "Failed to allocate CPU Memory";
+      }
+      system_bytes += size;
+      return ptr;
+    }
+
+    void SystemFree(void* ptr, size_t size) {
+      common::AlignedMemFree(ptr);
+      system_bytes -= size;
+    }
+
+    /*! \brief move a batch of chunks of class cls from the central list to out */
+    void Refill(int cls, std::vector<void*>* out) {
+      const SizeClass& c = classes[cls];
+      CentralBin& bin    = bins[cls];
+      {
+        std::lock_guard<std::mutex> lock(bin.mutex);
+        const size_t n = std::min(c.batch, bin.free.size());
+        out->insert(out->end(), bin.free.end() - n, bin.free.end());
+        bin.free.resize(bin.free.size() - n);
+        bin.low_water = std::min(bin.low_water, bin.free.size());
+      }
+      if (out->empty()) {
+        if (c.slab) {
+          char* slab        = static_cast<char*>(SystemAlloc(kSlabSize, kSlabSize));
+          const size_t n    = kSlabSize / c.size;
+          const size_t keep = std::min(n, c.batch);
+          for (size_t i = 0; i < keep; ++i)
+            out->push_back(slab + i * c.size);
+          std::lock_guard<std::mutex> lock(bin.mutex);
+          bin.slabs.insert(slab);
+          for (size_t i = keep; i < n; ++i)
+            bin.free.push_back(slab + i * c.size);
+        } else {
+          out->push_back(SystemAlloc(c.size, kAlignment));
+        }
+      }
+      MaybeRelease();
+    }
+
+    /*! \brief move the last n chunks of class cls from in to the central list */
+    void Flush(int cls, std::vector<void*>* in, size_t n) {
+      n = std::min(n, in->size());
+      if (n == 0)
+        return;
+      CentralBin& bin = bins[cls];
+      {
+        std::lock_guard<std::mutex> lock(bin.mutex);
+        bin.free.insert(bin.free.end(), in->end() - n, in->end());
+      }
+      in->resize(in->size() - n);
+      MaybeRelease();
+    }
+
+    /*! \brief release the memory that stayed unused for a whole release interval */
+    void MaybeRelease() {
+      if (release_interval_ns <= 0)
+        return;
+      const int64_t now = NowNs();
+      int64_t next      = next_release_ns.load(std::memory_order_relaxed);
+      if (now < next ||
+          !next_release_ns.compare_exchange_strong(next, now + release_interval_ns))
+        return;
+      Release(true);
+    }
+
+    /*!
+     * \brief return free chunks to the system.
+     * \param idle_only only release the chunks that were not used since the last release
+     */
+    void Release(bool idle_only) {
+      for (size_t cls = 0; cls < classes.size(); ++cls) {
+        const SizeClass& c = classes[cls];
+        CentralBin& bin    = bins[cls];
+        std::lock_guard<std::mutex> lock(bin.mutex);
+        // chunks are taken from the back, so the front holds the least recently used ones
+        size_t budget = idle_only ? bin.low_water : bin.free.size();
+        if (budget > 0 && c.slab) {
+          ReleaseSlabs(c, &bin, budget);
+        } else if (budget > 0) {
+          for (size_t i = 0; i < budget; ++i)
+            SystemFree(bin.free[i], c.size);
+          bin.free.erase(bin.free.begin(), bin.free.begin() + budget);
+        }
+        bin.low_water = bin.free.size();
+      }
+    }
+
+    /*! \brief release the slabs whose chunks are all free, at most budget chunks */
+    void ReleaseSlabs(const SizeClass& c, CentralBin* bin, size_t budget) {
+      const size_t per_slab = kSlabSize / c.size;
+      std::unordered_map<void*, size_t> free_count;
+      for (void* p : bin->free)
+        ++free_count[SlabOf(p)];
+      std::unordered_set<void*> released;
+      for (const auto& kv : free_count) {
+        if (kv.second == per_slab && budget >= per_slab) {
+          released.insert(kv.first);
+          budget -= per_slab;
+        }
+      }
+      if (released.empty())
+        return;
+      bin->free.erase(std::remove_if(bin->free.begin(),
+                                     bin->free.end(),
+                                     [&released](void* p) { return released.count(SlabOf(p)); }),
+                      bin->free.end());
+      for (void* slab : released) {
+        bin->slabs.erase(slab);
+        SystemFree(slab, kSlabSize);
+      }
+    }
+
+    static void* SlabOf(void* p) {
+      return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(p) & ~(kSlabSize - 1));
+    }
+
+    const uint64_t id;
+    const int dev_id;
+    size_t max_size;
+    size_t thread_cache_bytes;
+    int64_t release_interval_ns;
+    std::vector<SizeClass> classes;
+    std::unordered_map<size_t, int> class_index;
+    std::unique_ptr<CentralBin[]> bins;
+    std::atomic<int64_t> next_release_ns{0};
+    std::atomic<size_t> system_bytes{0};
+  };
+
+  /*! \brief per-thread free chunks of one manager, returned to it on thread exit */
+  struct ThreadCache {
+    explicit ThreadCache(const std::shared_ptr<Central>& central)
+        : central(central), bins(central->classes.size()) {}
+    ~ThreadCache() {
+      // the manager may be gone already, its memory is freed then
+      if (auto c = central.lock()) {
+        for (size_t cls = 0; cls < bins.size(); ++cls)
+          c->Flush(cls, &bins[cls], bins[cls].size());
+      }
+    }
+    std::weak_ptr<Central> central;
+    std::vector<std::vector<void*>> bins;
+  };
+
+  ThreadCache* GetThreadCache() {
+    thread_local std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>> caches;
+    thread_local uint64_t last_id  = 0;
+    thread_local ThreadCache* last = nullptr;
+    if (last_id == central_->id)
+      return last;
+    auto& tc = caches[central_->id];
+    if (!tc)
+      tc = std::make_unique<ThreadCache>(central_);
+    last_id = central_->id;
+    last    = tc.get();
+    return last;
+  }
+
+  std::shared_ptr<Central> central_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabStorageManager);
+};  // class SlabStorageManager
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_STORAGE_SLAB_STORAGE_MANAGER_H_
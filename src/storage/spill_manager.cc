@@ -0,0 +1,374 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file spill_manager.cc
+ * \brief Spilling of cold GPU arrays to pinned host memory or to a file.
+ */
+#include "./spill_manager.h"
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif  // _WIN32
+#if MXNET_USE_CUDA
+#include "../common/cuda/utils.h"
+#endif  // MXNET_USE_CUDA
+
+namespace mxnet {
+namespace storage {
+
+std::atomic<int> SpillManager::num_entries_{0};
+
+/*! \brief set while the copies are pushed, as they are reported to OnPush as well */
+static thread_local bool in_copy_push = false;
+
+/*! \brief host copy of a spilled array */
+struct SpillManager::HostBuffer {
+  void* dptr = nullptr;
+  size_t size;
+  /*! \brief pinned memory, unused when the buffer is a mapped file */
+  Storage::Handle pinned;
+
+  HostBuffer(size_t size, int dev_id) : size(size) {
+    static const std::string dir = dmlc::GetEnv("MXNET_GPU_SPILL_DIR", std::string());
+    if (dir.empty()) {
+      pinned = Storage::Get()->Alloc(size, Context::CPUPinned(dev_id));
+      dptr   = pinned.dptr;
+      return;
+    }
+#ifndef _WIN32
+    std::string path = dir + "/mxnet_spill_XXXXXX";
+    int fd           = mkstemp(&path[0]);
+    CHECK_NE(fd, -1) << "Failed to create a spill file in " << dir << ": " << strerror(errno);
+    // the file is removed once it is unmapped
+    unlink(path.c_str());
+    CHECK_EQ(ftruncate(fd, size), 0) << "Failed to resize a spill file: " << strerror(errno);
+    dptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    CHECK_NE(dptr, MAP_FAILED) << "Failed to map a spill file: " << strerror(errno);
+#else
+    LOG(FATAL) << "MXNET_GPU_SPILL_DIR is not supported on Windows";
+#endif  // _WIN32
+  }
+
+  ~HostBuffer() {
+    if (pinned.dptr != nullptr) {
+      Storage::Get()->Free(pinned);
+    } else if (dptr != nullptr) {
+#ifndef _WIN32
+      munmap(dptr, size);
+#endif  // _WIN32
+    }
+  }
+};
+
+struct SpillManager::Entry {
+  Engine::VarHandle var;
+  Storage::Handle* handle;
+  std::weak_ptr<void> owner;
+  int dev_id;
+  size_t size;
+  /*! \brief fills the memory of a lazily loaded array */
+  std::function<void(void*, size_t)> loader;
+  /*! \brief whether a lazily loaded array has been loaded */
+  bool loaded = true;
+  /*! \brief whether an operator wrote the array, which can no longer be loaded again */
+  bool dirty = false;
+  /*! \brief whether the last pushed copy moves the array to the host */
+  bool spilled = false;
+  /*! \brief whether the last spill freed the memory without copying it */
+  bool dropped = false;
+  uint64_t last_use = 0;
+  std::list<Entry*>::iterator lru_pos;
+  /*! \brief only accessed by the copies, which the engine serializes */
+  std::unique_ptr<HostBuffer> host;
+
+  void SpillData(const RunContext& rctx, bool drop) {
+#if MXNET_USE_CUDA
+    if (!drop) {
+      cudaStream_t stream = mshadow::Stream<gpu>::GetStream(rctx.get_stream<gpu>());
+      host.reset(new HostBuffer(size, dev_id));
+      CUDA_CALL(cudaMemcpyAsync(host->dptr, handle->dptr, size, cudaMemcpyDeviceToHost, stream));
+      CUDA_CALL(cudaStreamSynchronize(stream));
+    }
+    Storage::Get()->Free(*handle);
+    handle->dptr = nullptr;
+#endif  // MXNET_USE_CUDA
+  }
+
+  void RestoreData(const RunContext& rctx, bool drop) {
+#if MXNET_USE_CUDA
+    Storage::Get()->Alloc(handle);
+    if (drop) {
+      loader(handle->dptr, size);
+      return;
+    }
+    cudaStream_t stream = mshadow::Stream<gpu>::GetStream(rctx.get_stream<gpu>());
+    CUDA_CALL(cudaMemcpyAsync(handle->dptr, host->dptr, size, cudaMemcpyHostToDevice, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+    host.reset();
+#endif  // MXNET_USE_CUDA
+  }
+};
+
+SpillManager* SpillManager::Get() {
+  static SpillManager inst;
+  return &inst;
+}
+
+SpillManager::DeviceState& SpillManager::Device(int dev_id) {
+  auto it = devices_.find(dev_id);
+  if (it != devices_.end())
+    return it->second;
+  size_t total_mem = 0;
+#if MXNET_USE_CUDA
+  {
+    mxnet::common::cuda::DeviceStore device_store(dev_id, true);
+    size_t free_mem = 0;
+    CUDA_CALL(cudaMemGetInfo(&free_mem, &total_mem));
+  }
+#endif  // MXNET_USE_CUDA
+  DeviceState& dev = devices_[dev_id];
+  dev.budget       = dmlc::GetEnv("MXNET_GPU_SPILL_BUDGET", total_mem / 2);
+  return dev;
+}
+
+void SpillManager::Register(Engine::VarHandle var,
+                            Storage::Handle* handle,
+                            std::weak_ptr<void> owner) {
+#if MXNET_USE_CUDA
+  CHECK_EQ(handle->ctx.dev_mask(), gpu::kDevMask) << "Only GPU arrays can be spilled";
+  CHECK(handle->dptr != nullptr) << "The array must be allocated before it can be spilled";
+  const int dev_id = handle->ctx.real_dev_id();
+  std::vector<Action> actions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.count(var))
+      return;
+    auto entry    = std::make_shared<Entry>();
+    entry->var    = var;
+    entry->handle = handle;
+    entry->owner  = std::move(owner);
+    entry->dev_id = dev_id;
+    entry->size   = handle->size;
+    DeviceState& dev = Device(dev_id);
+    dev.resident += entry->size;
+    dev.lru.push_front(entry.get());
+    entry->lru_pos   = dev.lru.begin();
+    entry->last_use  = ++clock_;
+    entries_[var]    = entry;
+    num_entries_.fetch_add(1, std::memory_order_relaxed);
+    Evict(dev_id, entry->last_use, &actions);
+  }
+  PushCopies(&actions);
+#else
+  LOG(FATAL) << "Spilling GPU arrays requires MXNet built with CUDA";
+#endif  // MXNET_USE_CUDA
+}
+
+void SpillManager::RegisterLazy(Engine::VarHandle var,
+                                Storage::Handle* handle,
+                                std::weak_ptr<void> owner,
+                                std::function<void(void*, size_t)> loader) {
+#if MXNET_USE_CUDA
+  CHECK_EQ(handle->ctx.dev_mask(), gpu::kDevMask) << "Only GPU arrays can be spilled";
+  CHECK(handle->dptr == nullptr) << "A lazily loaded array must not be allocated yet";
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.count(var))
+    return;
+  auto entry    = std::make_shared<Entry>();
+  entry->var    = var;
+  entry->handle = handle;
+  entry->owner  = std::move(owner);
+  entry->dev_id = handle->ctx.real_dev_id();
+  entry->size   = handle->size;
+  entry->loader = std::move(loader);
+  entry->loaded = false;
+  entries_[var] = entry;
+  Device(entry->dev_id);
+  num_entries_.fetch_add(1, std::memory_order_relaxed);
+#else
+  LOG(FATAL) << "Spilling GPU arrays requires MXNet built with CUDA";
+#endif  // MXNET_USE_CUDA
+}
+
+void SpillManager::OnLoad(Engine::VarHandle var) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(var);
+  if (it == entries_.end() || it->second->loaded)
+    return;
+  Entry* entry     = it->second.get();
+  DeviceState& dev = devices_[entry->dev_id];
+  entry->loaded    = true;
+  dev.resident += entry->size;
+  ++dev.num_loads;
+  dev.lru.push_front(entry);
+  entry->lru_pos  = dev.lru.begin();
+  entry->last_use = ++clock_;
+  // the load may run in an operator, the next push evicts the arrays over the budget
+}
+
+void SpillManager::Unregister(Engine::VarHandle var) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(var);
+  if (it == entries_.end())
+    return;
+  Entry* entry     = it->second.get();
+  DeviceState& dev = devices_[entry->dev_id];
+  if (!entry->loaded) {
+    // counted neither as resident nor as spilled
+  } else if (entry->spilled) {
+    dev.spilled -= entry->size;
+  } else {
+    dev.resident -= entry->size;
+    dev.lru.erase(entry->lru_pos);
+  }
+  entries_.erase(it);
+  num_entries_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void SpillManager::OnPush(const std::vector<Engine::VarHandle>& const_vars,
+                          const std::vector<Engine::VarHandle>& mutable_vars) {
+  if (in_copy_push)
+    return;
+  std::vector<Action> actions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t stamp = ++clock_;
+    for (auto var : const_vars)
+      Touch(var, stamp, false, &actions);
+    for (auto var : mutable_vars)
+      Touch(var, stamp, true, &actions);
+    // restoring an array and loading a lazily loaded one grow the resident memory
+    for (auto& kv : devices_)
+      Evict(kv.first, stamp, &actions);
+    if (actions.empty())
+      return;
+  }
+  PushCopies(&actions);
+}
+
+void SpillManager::Touch(Engine::VarHandle var,
+                         uint64_t stamp,
+                         bool write,
+                         std::vector<Action>* actions) {
+  auto it = entries_.find(var);
+  if (it == entries_.end())
+    return;
+  Entry* entry = it->second.get();
+  // the restore pushed below comes before the write
+  const bool restore_drop = entry->dropped;
+  entry->dirty |= write;
+  if (!entry->loaded || entry->last_use == stamp)
+    return;
+  entry->last_use  = stamp;
+  DeviceState& dev = devices_[entry->dev_id];
+  if (!entry->spilled) {
+    dev.lru.splice(dev.lru.begin(), dev.lru, entry->lru_pos);
+    return;
+  }
+  std::shared_ptr<void> owner = entry->owner.lock();
+  if (owner == nullptr)
+    return;
+  entry->spilled = false;
+  dev.spilled -= entry->size;
+  dev.resident += entry->size;
+  ++dev.num_restores;
+  dev.lru.push_front(entry);
+  entry->lru_pos = dev.lru.begin();
+  actions->push_back(Action{it->second, std::move(owner), false, restore_drop});
+}
+
+void SpillManager::Evict(int dev_id, uint64_t stamp, std::vector<Action>* actions) {
+  DeviceState& dev = devices_[dev_id];
+  auto it          = dev.lru.end();
+  while (dev.resident > dev.budget && it != dev.lru.begin()) {
+    Entry* entry = *(--it);
+    // arrays used by the operator being pushed stay on the device
+    if (entry->last_use == stamp)
+      break;
+    std::shared_ptr<void> owner = entry->owner.lock();
+    if (owner == nullptr)
+      continue;
+    it             = dev.lru.erase(it);
+    entry->spilled = true;
+    entry->dropped = entry->loader != nullptr && !entry->dirty;
+    dev.resident -= entry->size;
+    dev.spilled += entry->size;
+    ++dev.num_spills;
+    actions->push_back(Action{entries_.at(entry->var), std::move(owner), true, entry->dropped});
+  }
+}
+
+void SpillManager::PushCopies(std::vector<Action>* actions) {
+  // spills go first, so that their memory can be reused by the restores
+  std::stable_partition(
+      actions->begin(), actions->end(), [](const Action& a) { return a.spill; });
+  in_copy_push = true;
+  for (const auto& action : *actions)
+    PushCopy(action);
+  in_copy_push = false;
+}
+
+void SpillManager::PushCopy(const Action& action) {
+  std::shared_ptr<Entry> entry = action.entry;
+  std::shared_ptr<void> owner  = action.owner;
+  const bool spill             = action.spill;
+  const bool drop              = action.drop;
+  Engine::Get()->PushAsync(
+      [entry, owner, spill, drop](RunContext rctx, Engine::CallbackOnComplete on_complete) {
+        if (spill) {
+          entry->SpillData(rctx, drop);
+        } else {
+          entry->RestoreData(rctx, drop);
+        }
+        on_complete();
+      },
+      entry->handle->ctx,
+      {},
+      {entry->var},
+      spill ? FnProperty::kCopyFromGPU : FnProperty::kCopyToGPU,
+      0,
+      spill ? "SpillToHost" : "RestoreFromHost");
+}
+
+std::string SpillManager::Stats(Context ctx) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = devices_.find(ctx.real_dev_id());
+  if (ctx.dev_mask() != gpu::kDevMask || it == devices_.end())
+    return "{}";
+  const DeviceState& dev = it->second;
+  std::ostringstream os;
+  os << "{\"budget_bytes\": " << dev.budget << ", \"resident_bytes\": " << dev.resident
+     << ", \"spilled_bytes\": " << dev.spilled << ", \"num_spills\": " << dev.num_spills
+     << ", \"num_restores\": " << dev.num_restores << ", \"num_loads\": " << dev.num_loads
+     << "}";
+  return os.str();
+}
+
+}  // namespace storage
+}  // namespace mxnet
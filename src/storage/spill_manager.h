@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file spill_manager.h
+ * \brief Spilling of cold GPU arrays to pinned host memory or to a file.
+ */
+#ifndef MXNET_STORAGE_SPILL_MANAGER_H_
+#define MXNET_STORAGE_SPILL_MANAGER_H_
+
+#include <mxnet/base.h>
+#include <mxnet/engine.h>
+#include <mxnet/storage.h>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Moves the memory of cold GPU arrays to the host and back.
+ *
+ * An array is registered with the engine variable that guards its data. The engine
+ * reports the variables of every pushed operator, which orders the registered arrays
+ * by their last use. When the registered arrays of a device hold more than
+ * MXNET_GPU_SPILL_BUDGET bytes, the least recently used ones are copied to pinned
+ * host memory, or to a file in MXNET_GPU_SPILL_DIR, and their device memory is freed.
+ * Pushing an operator that uses a spilled array first pushes a copy back to the
+ * device. Both copies are engine operators that write the variable of the array and
+ * run on the copy streams, so operators already pushed see the old location and the
+ * following ones the new one, and the copies overlap with the computation.
+ *
+ * An array materialized on its first access by a loader, see NDArray::SetLoader, is
+ * registered before it is allocated and counted from its load. Until it is written,
+ * spilling it frees its memory without copying it, and restoring it loads it again.
+ *
+ * The spilled location replaces the data pointer of the storage handle, so only
+ * arrays whose pointer is read when their operators run may be registered, not e.g.
+ * the parameters of a static CachedOp.
+ */
+class SpillManager {
+ public:
+  /*! \return the spill manager singleton */
+  static SpillManager* Get();
+  /*! \brief whether any array is registered, checked before every push */
+  static bool Active() {
+    return num_entries_.load(std::memory_order_relaxed) > 0;
+  }
+  /*!
+   * \brief register the GPU memory of an array.
+   * \param var engine variable guarding the memory.
+   * \param handle storage handle of the array, updated when the memory moves.
+   * \param owner keeps the handle alive while a copy is pending.
+   */
+  void Register(Engine::VarHandle var, Storage::Handle* handle, std::weak_ptr<void> owner);
+  /*!
+   * \brief register the GPU memory of an array that is not allocated yet, and that
+   *  loader fills once it is. OnLoad is called after the first load.
+   */
+  void RegisterLazy(Engine::VarHandle var,
+                    Storage::Handle* handle,
+                    std::weak_ptr<void> owner,
+                    std::function<void(void*, size_t)> loader);
+  /*! \brief called once the array of var registered with RegisterLazy is loaded */
+  void OnLoad(Engine::VarHandle var);
+  /*!
+   * \brief unregister the array of var. The memory of a spilled array is not
+   *  restored, handle->dptr stays nullptr.
+   */
+  void Unregister(Engine::VarHandle var);
+  /*!
+   * \brief called by the engine before an operator is pushed, restores the spilled
+   *  arrays it uses and spills cold arrays if the budget is exceeded.
+   */
+  void OnPush(const std::vector<Engine::VarHandle>& const_vars,
+              const std::vector<Engine::VarHandle>& mutable_vars);
+  /*! \return the spill statistics of ctx as a JSON object */
+  std::string Stats(Context ctx);
+
+ private:
+  struct HostBuffer;
+  struct Entry;
+  struct DeviceState {
+    size_t budget   = 0;
+    size_t resident = 0;
+    size_t spilled  = 0;
+    uint64_t num_spills   = 0;
+    uint64_t num_restores = 0;
+    uint64_t num_loads    = 0;
+    /*! \brief resident entries, the most recently used first */
+    std::list<Entry*> lru;
+  };
+  /*! \brief a copy to push once the lock is released */
+  struct Action {
+    std::shared_ptr<Entry> entry;
+    std::shared_ptr<void> owner;
+    bool spill;
+    /*! \brief whether the memory is freed without a copy, or loaded again */
+    bool drop;
+  };
+
+  /*! \return the state of dev_id, with its budget */
+  DeviceState& Device(int dev_id);
+  void Touch(Engine::VarHandle var,
+             uint64_t stamp,
+             bool write,
+             std::vector<Action>* actions);
+  void Evict(int dev_id, uint64_t stamp, std::vector<Action>* actions);
+  void PushCopies(std::vector<Action>* actions);
+  void PushCopy(const Action& action);
+
+  static std::atomic<int> num_entries_;
+  std::mutex mutex_;
+  std::unordered_map<Engine::VarHandle, std::shared_ptr<Entry>> entries_;
+  std::unordered_map<int, DeviceState> devices_;
+  uint64_t clock_ = 0;
+};
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_STORAGE_SPILL_MANAGER_H_
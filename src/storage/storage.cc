@@ -18,13 +18,17 @@
  */
 
 #include <mxnet/storage.h>
+#include <sstream>
 #include "./storage_manager.h"
 #include "./naive_storage_manager.h"
 #include "./pooled_storage_manager.h"
+#include "./slab_storage_manager.h"
 #include "./cpu_shared_storage_manager.h"
 #include "./cpu_device_storage.h"
 #include "./gpu_device_storage.h"
+#include "./gpu_async_storage_manager.h"
 #include "./pinned_memory_storage.h"
+#include "./spill_manager.h"
 #include "../common/lazy_alloc_array.h"
 #include "../profiler/storage_profiler.h"
 
@@ -40,6 +44,11 @@ class StorageImpl : public Storage {
   void ReleaseAll(Context ctx) override {
     storage_manager(ctx)->ReleaseAll();
   }
+  std::string PoolStats(Context ctx) override;
+  std::vector<std::tuple<Context, size_t, size_t>> PoolUsage() override;
+  void UpdateStorageInfo(const Handle& handle) override {
+    profiler_.UpdateStorageInfo(handle);
+  }
 
   void SharedIncrementRefCount(Handle handle) override;
   StorageImpl()           = default;
@@ -77,6 +86,24 @@ StorageManager* CreateStorageManager(const Context& ctx,
     ptr = new PooledStorageManager<RoundPower2, VectorContainer>(ctx, num_gpu_device);
   } else if (*pStrategy == "Naive") {
     ptr = new PooledStorageManager<RoundMultiple, UnorderedMapContainer>(ctx, num_gpu_device);
+  } else if (*pStrategy == "Async") {
+    CHECK_EQ(ctx.dev_type, Context::kGPU)
+        << "The Async memory pool is only available for GPU memory, set " << env_var;
+#if MXNET_USE_CUDA && CUDART_VERSION >= 11020
+    if (GPUAsyncStorageSupported(ctx.real_dev_id())) {
+      ptr = new GPUAsyncStorageManager(ctx);
+    }
+#endif
+    if (ptr == nullptr) {
+      LOG(WARNING) << "The stream ordered allocator is not supported on " << ctx
+                   << ", falling back to the Round memory pool";
+      *pStrategy = "Round";
+      ptr        = new PooledStorageManager<RoundPower2, VectorContainer>(ctx, num_gpu_device);
+    }
+  } else if (*pStrategy == "Slab") {
+    CHECK_EQ(ctx.dev_type, Context::kCPU)
+        << "The Slab memory pool is only available for CPU memory, set " << env_var;
+    ptr = new SlabStorageManager(ctx);
   } else if (*pStrategy == "Unpooled") {
     if (ctx.dev_type == Context::kCPU || num_gpu_device == 0)
       ptr = new NaiveStorageManager<CPUDeviceStorage>();
@@ -228,6 +255,37 @@ void StorageImpl::DirectFree(Storage::Handle handle) {
   profiler_.OnFree(handle);
 }
 
+std::string StorageImpl::PoolStats(Context ctx) {
+  std::ostringstream os;
+  os << "{\"context\": \"" << ctx << "\", \"pool\": ";
+  auto&& device = storage_managers_.at(ctx.dev_type);
+  std::shared_ptr<StorageManager> manager =
+      device.Get(ctx.real_dev_id(), []() -> StorageManager* { return nullptr; });
+  os << (manager ? manager->Stats() : "{}");
+  if (profiler_.callsite_stats())
+    os << ", \"callsites\": " << profiler_.CallsiteStats(ctx);
+  const std::string peak = profiler_.PeakStats(ctx);
+  if (!peak.empty())
+    os << ", \"peak\": " << peak;
+  if (SpillManager::Active())
+    os << ", \"spill\": " << SpillManager::Get()->Stats(ctx);
+  os << "}";
+  return os.str();
+}
+
+std::vector<std::tuple<Context, size_t, size_t>> StorageImpl::PoolUsage() {
+  std::vector<std::tuple<Context, size_t, size_t>> usage;
+  for (size_t dev_type = 0; dev_type < kMaxNumberOfDevices; ++dev_type) {
+    storage_managers_[dev_type].ForEach([&](size_t dev_id, StorageManager* manager) {
+      size_t held = 0, in_use = 0;
+      manager->Usage(&held, &in_use);
+      usage.emplace_back(
+          Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id), held, in_use);
+    });
+  }
+  return usage;
+}
+
 void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
   CHECK_EQ(handle.ctx.dev_type, Context::kCPUShared);
   auto&& device = storage_managers_.at(Context::kCPUShared);
@@ -27,6 +27,7 @@
 
 #include "./storage_manager_helpers.h"
 #include <mxnet/storage.h>
+#include <string>
 
 namespace mxnet {
 namespace storage {
@@ -59,6 +60,23 @@ class StorageManager {
    * For non-pool memory managers this has no effect.
    */
   virtual void ReleaseAll() {}
+  /*!
+   * \brief Usage statistics of the memory pool.
+   * \return a JSON object, empty for non-pool memory managers.
+   */
+  virtual std::string Stats() {
+    return "{}";
+  }
+  /*!
+   * \brief Bytes of the memory pool.
+   * \param held_bytes Bytes allocated from the device and held by the pool.
+   * \param in_use_bytes Bytes of the held blocks which are handed out, both zero for
+   *  non-pool memory managers.
+   */
+  virtual void Usage(size_t* held_bytes, size_t* in_use_bytes) {
+    *held_bytes   = 0;
+    *in_use_bytes = 0;
+  }
   /*!
    * \brief Destructor.
    */
@@ -43,6 +43,7 @@ typedef mxnet::common::cuda::DeviceStore CudaDeviceStore;
 
 #include <tuple>
 #include "../common/utils.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace storage {
@@ -121,7 +122,8 @@ class ContextHelperCPU : public ContextHelper {
   }
 
   int Malloc(void** ppNtr, size_t size) const override {
-    bool success = mxnet::common::AlignedMemAlloc(ppNtr, size, alignment_);
+    bool success = mxnet::common::numa::AlignedMemAllocForDevice(
+        ppNtr, size, alignment_, initilal_context().dev_id);
     return success ? 0 : -1;
   }
 
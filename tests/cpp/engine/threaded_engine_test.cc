@@ -30,10 +30,12 @@
 #include <mxnet/engine.h>
 #include <mxnet/ndarray.h>
 #include <dmlc/timer.h>
+#include <atomic>
 #include <ctime>
 #include <cstdio>
 #include <thread>
 #include <chrono>
+#include <memory>
 #include <vector>
 #include <random>
 
@@ -180,6 +182,69 @@ TEST(Engine, RandSumExpr) {
   LOG(INFO) << "ThreadedEnginePerDevice\t" << t[3] << " sec";
 }
 
+TEST(Engine, RandSumExprWorkStealing) {
+  std::vector<Workload> workloads;
+  int num_repeat = 3;
+  setenv("MXNET_CPU_WORK_STEALING", "1", 1);
+  mxnet::Engine* engine = mxnet::engine::CreateThreadedEnginePerDevice();
+  unsetenv("MXNET_CPU_WORK_STEALING");
+
+  for (int repeat = 0; repeat < num_repeat; ++repeat) {
+    srand(time(nullptr) + repeat);
+    int num_var = 100;
+    GenerateWorkload(10000, num_var, 2, 20, 1, 10, &workloads);
+    std::vector<double> expected(num_var, 1.0), data(num_var, 1.0);
+    EvaluateWorkloads(workloads, nullptr, &expected);
+    double t = EvaluateWorkloads(workloads, engine, &data);
+    for (int j = 0; j < num_var; ++j) EXPECT_EQ(expected[j], data[j]);
+    LOG(INFO) << "ThreadedEnginePerDevice(work stealing)\t" << t << " sec";
+  }
+}
+
+#if MXNET_USE_CUDA == 1
+TEST(Engine, InlineGPU) {
+  int num_gpus = 0;
+  if (cudaGetDeviceCount(&num_gpus) != cudaSuccess || num_gpus == 0) {
+    LOG(INFO) << "Skipping the inline GPU test without GPU";
+    return;
+  }
+  setenv("MXNET_ENGINE_INLINE_GPU", "1", 1);
+  std::unique_ptr<mxnet::Engine> engine(mxnet::engine::CreateThreadedEnginePerDevice());
+  unsetenv("MXNET_ENGINE_INLINE_GPU");
+
+  const int n = 1 << 20;
+  char* data = nullptr;
+  ASSERT_EQ(cudaMalloc(&data, n), cudaSuccess);
+  auto var = engine->NewVariable();
+  const std::thread::id pusher = std::this_thread::get_id();
+  std::vector<std::thread::id> gpu_threads;
+  std::vector<char> host(n, 0);
+  for (int i = 1; i <= 10; ++i) {
+    // launched by this thread on the inline stream, without waiting for it
+    engine->PushSync([&, i](mxnet::RunContext rctx) {
+        gpu_threads.push_back(std::this_thread::get_id());
+        EXPECT_TRUE(rctx.is_bulk);
+        cudaStream_t stream = mshadow::Stream<mxnet::gpu>::GetStream(rctx.get_stream<mxnet::gpu>());
+        EXPECT_EQ(cudaMemsetAsync(data, i, n, stream), cudaSuccess);
+      }, mxnet::Context::GPU(0), {}, {var}, mxnet::FnProperty::kNormal, 0, "InlineMemset");
+  }
+  // a CPU worker sees the result of the inline operations
+  engine->PushSync([&](mxnet::RunContext) {
+      EXPECT_EQ(cudaMemcpy(host.data(), data, n, cudaMemcpyDeviceToHost), cudaSuccess);
+    }, mxnet::Context::CPU(), {var}, {}, mxnet::FnProperty::kNormal, 0, "CopyBack");
+  engine->WaitForVar(var);
+  engine->WaitForAll();
+  for (const auto& id : gpu_threads)
+    EXPECT_EQ(id, pusher);
+  EXPECT_EQ(gpu_threads.size(), 10);
+  EXPECT_EQ(host[0], 10);
+  EXPECT_EQ(host[n - 1], 10);
+  engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context::CPU(), var);
+  engine->WaitForAll();
+  cudaFree(data);
+}
+#endif  // MXNET_USE_CUDA == 1
+
 void Foo(mxnet::RunContext, int i) { printf("The fox says %d\n", i); }
 
 void FooAsyncFunc(void*, void* cb_ptr, void* param) {
@@ -494,6 +559,40 @@ TEST(Engine, VarVersion) {
   }
 }
 
+TEST(Engine, DeleteVariableBatch) {
+  // more deletions than a batch, so that some are pushed when a batch is full and the others
+  // when waiting for all
+  const int num_vars = 37;
+  std::unique_ptr<mxnet::Engine> engine(mxnet::engine::CreateThreadedEnginePerDevice());
+  std::atomic<int> written{0};
+  std::atomic<int> deleted{0};
+  std::vector<mxnet::Engine::VarHandle> vars;
+  for (int i = 0; i < num_vars; ++i) {
+    vars.push_back(engine->NewVariable());
+    engine->PushSync(
+        [&written](mxnet::RunContext) {
+          std::this_thread::sleep_for(std::chrono::milliseconds{1});
+          ++written;
+        },
+        mxnet::Context{},
+        {},
+        {vars.back()});
+  }
+  for (auto var : vars) {
+    engine->DeleteVariable(
+        [&deleted, var](mxnet::RunContext) {
+          // the data of a variable is freed after the operations writing it
+          EXPECT_EQ(var->version(), 1U);
+          ++deleted;
+        },
+        mxnet::Context{},
+        var);
+  }
+  engine->WaitForAll();
+  EXPECT_EQ(written.load(), num_vars);
+  EXPECT_EQ(deleted.load(), num_vars);
+}
+
 #ifdef _OPENMP
 
 struct TestSaveAndRestoreOMPState {
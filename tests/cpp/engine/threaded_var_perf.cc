@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file threaded_var_perf.cc
+ * \brief Dependency tracking overhead of ThreadedVar,
+ *  mutex based vs lock free scheduling of reads.
+ */
+#include <gtest/gtest.h>
+#include <dmlc/logging.h>
+#include <dmlc/timer.h>
+#include <mxnet/engine.h>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../src/engine/engine_impl.h"
+#include "../include/test_util.h"
+
+namespace {
+
+/*!
+ * \brief Push num_readers reads followed by num_writers writes on every variable,
+ *  repeated num_steps times, and wait for all of them.
+ * \return elapsed seconds
+ */
+double PushReadersWriters(mxnet::Engine* engine,
+                          int num_vars,
+                          int num_readers,
+                          int num_writers,
+                          int num_steps,
+                          std::atomic<int64_t>* executed) {
+  using mxnet::Engine;
+  std::vector<Engine::VarHandle> vars(num_vars);
+  for (auto& v : vars) {
+    v = engine->NewVariable();
+  }
+  auto fn = [executed](mxnet::RunContext, Engine::CallbackOnComplete cb) {
+    ++(*executed);
+    cb();
+  };
+  const double start = dmlc::GetTime();
+  for (int step = 0; step < num_steps; ++step) {
+    for (auto v : vars) {
+      for (int r = 0; r < num_readers; ++r) {
+        engine->PushAsync(fn, mxnet::Context::CPU(), {v}, {});
+      }
+      for (int w = 0; w < num_writers; ++w) {
+        engine->PushAsync(fn, mxnet::Context::CPU(), {}, {v});
+      }
+    }
+  }
+  engine->WaitForAll();
+  const double elapsed = dmlc::GetTime() - start;
+  for (auto v : vars) {
+    engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context::CPU(), v);
+  }
+  engine->WaitForAll();
+  return elapsed;
+}
+
+}  // namespace
+
+TEST(ENGINE_PERF, ThreadedVarReadersWriters) {
+  const int num_vars    = mxnet::test::performance_run ? 2000 : 100;
+  const int num_steps   = mxnet::test::performance_run ? 20 : 2;
+  const int readers[]   = {1, 8, 32};
+  const int writers[]   = {0, 1};
+  const char* modes[]   = {"0", "1"};
+  const char* names[]   = {"mutex", "lock-free"};
+  std::vector<mxnet::Engine*> engines;
+  for (const char* mode : modes) {
+    setenv("MXNET_ENGINE_LOCK_FREE_VAR", mode, 1);
+    engines.push_back(mxnet::engine::CreateThreadedEnginePerDevice());
+  }
+  unsetenv("MXNET_ENGINE_LOCK_FREE_VAR");
+
+  for (int num_readers : readers) {
+    for (int num_writers : writers) {
+      for (size_t i = 0; i < engines.size(); ++i) {
+        std::atomic<int64_t> executed{0};
+        const double t = PushReadersWriters(
+            engines[i], num_vars, num_readers, num_writers, num_steps, &executed);
+        EXPECT_EQ(executed.load(),
+                  static_cast<int64_t>(num_vars) * num_steps * (num_readers + num_writers));
+        LOG(INFO) << names[i] << "\treaders=" << num_readers << "\twriters=" << num_writers
+                  << "\tvars=" << num_vars << "\t" << t << " sec";
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_queue_test.cc
+ * \brief Tests for the work stealing deque and task queue
+ */
+#include <gtest/gtest.h>
+#include <dmlc/logging.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../src/engine/work_stealing_queue.h"
+
+using mxnet::engine::WorkStealingDeque;
+using mxnet::engine::WorkStealingTaskQueue;
+
+TEST(WorkStealingDeque, OwnerLIFOThiefFIFO) {
+  WorkStealingDeque<intptr_t> deque(1);
+  // exceed the initial capacity to exercise growth
+  for (intptr_t i = 0; i < 100; ++i) {
+    deque.Push(i);
+  }
+  EXPECT_EQ(deque.Size(), 100);
+  intptr_t item;
+  EXPECT_TRUE(deque.Steal(&item));
+  EXPECT_EQ(item, 0);
+  EXPECT_TRUE(deque.Pop(&item));
+  EXPECT_EQ(item, 99);
+  EXPECT_EQ(deque.Size(), 98);
+  while (deque.Pop(&item)) {}
+  EXPECT_EQ(deque.Size(), 0);
+  EXPECT_FALSE(deque.Steal(&item));
+}
+
+TEST(WorkStealingDeque, ConcurrentSteal) {
+  const intptr_t num_items = 100000;
+  const int num_thieves    = 4;
+  WorkStealingDeque<intptr_t> deque;
+  std::vector<std::atomic<int>> seen(num_items);
+  for (auto& s : seen) s = 0;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < num_thieves; ++i) {
+    thieves.emplace_back([&]() {
+      intptr_t item;
+      while (!done.load()) {
+        if (deque.Steal(&item)) ++seen[item];
+      }
+      while (deque.Steal(&item)) ++seen[item];
+    });
+  }
+  intptr_t item;
+  for (intptr_t i = 0; i < num_items; ++i) {
+    deque.Push(i);
+    if (i % 3 == 0 && deque.Pop(&item)) ++seen[item];
+  }
+  while (deque.Pop(&item)) ++seen[item];
+  done = true;
+  for (auto& t : thieves) t.join();
+  for (intptr_t i = 0; i < num_items; ++i) {
+    EXPECT_EQ(seen[i].load(), 1) << "item " << i;
+  }
+}
+
+TEST(WorkStealingTaskQueue, PushPopKill) {
+  const int num_workers    = 4;
+  const intptr_t num_items = 20000;
+  WorkStealingTaskQueue<intptr_t> queue(num_workers);
+  std::atomic<intptr_t> sum{0};
+  std::atomic<intptr_t> count{0};
+  std::vector<std::thread> workers;
+  for (int w = 0; w < num_workers; ++w) {
+    workers.emplace_back([&, w]() {
+      intptr_t item;
+      while (queue.Pop(w, &item)) {
+        // re-dispatch from the worker itself to exercise the owner deque
+        if (item < 0) {
+          queue.Push(-item, w);
+          continue;
+        }
+        sum += item;
+        ++count;
+      }
+    });
+  }
+  intptr_t expected = 0;
+  for (intptr_t i = 1; i <= num_items; ++i) {
+    queue.Push(i % 2 ? i : -i, -1, static_cast<int>(i % num_workers), i % 7 == 0);
+    expected += i;
+  }
+  while (count.load() != num_items) {
+    std::this_thread::yield();
+  }
+  queue.SignalForKill();
+  for (auto& t : workers) t.join();
+  EXPECT_EQ(sum.load(), expected);
+  EXPECT_EQ(queue.Size(), 0);
+}
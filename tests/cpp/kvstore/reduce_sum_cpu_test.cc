@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file reduce_sum_cpu_test.cc
+ * \brief sums of the CPU arrays reduced by CommCPU
+ */
+#include <gtest/gtest.h>
+#include <mxnet/base.h>
+#include <random>
+#include <vector>
+
+#include "../src/kvstore/reduce_sum_cpu.h"
+
+namespace {
+
+/*!
+ * \brief checks the sum of num_in arrays of size elements, starting offset elements into their
+ *  buffers, written to a separate output or to the first input, with the inputs on two NUMA
+ *  nodes summed apart or not
+ */
+template <typename DType>
+void CheckReduceSum(int dtype, size_t size, int num_in, size_t offset, bool inplace, bool numa) {
+  std::mt19937 gen(size + num_in);
+  std::uniform_int_distribution<int> dist(-50, 50);
+  std::vector<std::vector<DType>> in(num_in, std::vector<DType>(size + offset + 1));
+  for (auto& v : in) {
+    for (auto& x : v)
+      x = static_cast<DType>(dist(gen));
+  }
+  std::vector<DType> expected(size, 0);
+  for (size_t j = 0; j < size; ++j) {
+    for (int i = 0; i < num_in; ++i)
+      expected[j] += in[i][offset + j];
+  }
+  std::vector<DType> out(size + offset + 1, -1);
+  std::vector<std::vector<DType>> partials(2, std::vector<DType>(size));
+  DType* out_data = inplace ? in[0].data() + offset : out.data() + offset;
+
+  mxnet::kvstore::ReduceSumArgs args;
+  for (int i = 0; i < num_in; ++i) {
+    args.in.push_back(in[i].data() + offset);
+    if (numa)
+      args.in_nodes.push_back(i % 3 - 1);
+  }
+  if (numa)
+    args.partials = {partials[0].data(), partials[1].data()};
+  args.out               = out_data;
+  args.out_node          = -1;
+  args.size              = size;
+  args.dtype             = dtype;
+  args.min_parallel_size = 1000;
+  args.max_threads       = 4;
+  mxnet::kvstore::ReduceSumCPU(args);
+
+  for (size_t j = 0; j < size; ++j)
+    ASSERT_EQ(out_data[j], expected[j]) << "element " << j << " of " << size << ", " << num_in;
+  if (!inplace) {
+    for (size_t j = 0; j < offset; ++j)
+      EXPECT_EQ(out[j], -1);
+    EXPECT_EQ(out[offset + size], -1);
+  }
+}
+
+}  // namespace
+
+TEST(ReduceSumCPU, Sums) {
+  for (size_t size : {1, 15, 17, 4097, 300001}) {
+    for (int num_in : {2, 3, 8, 9, 17}) {
+      for (size_t offset : {0, 3}) {
+        for (bool inplace : {false, true}) {
+          for (bool numa : {false, true}) {
+            CheckReduceSum<float>(mshadow::kFloat32, size, num_in, offset, inplace, numa);
+            CheckReduceSum<double>(mshadow::kFloat64, size, num_in, offset, inplace, numa);
+            CheckReduceSum<int>(mshadow::kInt32, size, num_in, offset, inplace, numa);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file philox_generator_test.cc
+ * \brief tests of the bulk draws of the counter based random generator
+ */
+#include <gtest/gtest.h>
+#include <mxnet/random_generator.h>
+#include <cmath>
+
+using mxnet::common::random::PhiloxGenerator;
+
+namespace {
+
+/*! \brief the bulk draws of a thread are its scalar draws, from any point of its blocks */
+template <typename DType>
+void CheckBulkDraws() {
+  using Generator = PhiloxGenerator<mshadow::cpu, DType>;
+  using FType     = typename Generator::Impl::FType;
+  Generator gen(0x1234567890ull, 77);
+  for (int n : {0, 1, 3, 4, 5, 17, 64, 127, 128}) {
+    typename Generator::Impl bulk(&gen, 5), scalar(&gen, 5);
+    FType x[Generator::Impl::kBulk];
+    uint32_t words[Generator::Impl::kBulk];
+    for (int rep = 0; rep < 3; ++rep) {
+      // the scalar draws in between leave partial blocks and cached normals
+      EXPECT_EQ(bulk.uniform(), scalar.uniform());
+      bulk.uniform(x, n);
+      for (int i = 0; i < n; ++i)
+        EXPECT_EQ(x[i], scalar.uniform()) << n << " uniforms";
+      EXPECT_EQ(bulk.normal(), scalar.normal());
+      bulk.normal(x, n);
+      for (int i = 0; i < n; ++i)
+        EXPECT_NEAR(x[i], scalar.normal(), 1e-6) << n << " normals";
+      bulk(words, n);
+      for (int i = 0; i < n; ++i)
+        EXPECT_EQ(words[i], scalar()) << n << " words";
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PhiloxGenerator, BulkDrawsFloat) {
+  CheckBulkDraws<float>();
+}
+
+TEST(PhiloxGenerator, BulkDrawsDouble) {
+  CheckBulkDraws<double>();
+}
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pipelined_stream_test.cc
+ * \brief tests of the stream writing the files of remote file systems
+ */
+#include <gtest/gtest.h>
+#include <dmlc/logging.h>
+#include <dmlc/memory_io.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "../../src/serialization/pipelined_stream.h"
+
+using mxnet::PipelinedWriteStream;
+
+namespace {
+
+/*! \brief a stream failing after limit bytes, as a lost connection */
+class FailingStream : public dmlc::Stream {
+ public:
+  explicit FailingStream(size_t limit) : limit_(limit) {}
+  size_t Read(void*, size_t) override {
+    return 0;
+  }
+  void Write(const void*, size_t size) override {
+    written_ += size;
+    CHECK_LE(written_, limit_) << "connection lost";
+  }
+
+ private:
+  size_t limit_;
+  size_t written_{0};
+};
+
+}  // namespace
+
+TEST(PipelinedWriteStream, WritesInOrder) {
+  std::string data;
+  for (int i = 0; i < 10000; ++i)
+    data += std::to_string(i);
+  for (size_t num_parts : {0, 1, 3}) {
+    std::string out;
+    PipelinedWriteStream stream(
+        std::unique_ptr<dmlc::Stream>(new dmlc::MemoryStringStream(&out)), 1000, num_parts);
+    // writes smaller and larger than the parts
+    size_t offset = 0;
+    for (size_t n = 1; offset < data.size(); n = n * 3 + 1) {
+      n = std::min(n, data.size() - offset);
+      stream.Write(data.data() + offset, n);
+      offset += n;
+    }
+    stream.Close();
+    EXPECT_EQ(out, data) << num_parts << " parts";
+  }
+}
+
+TEST(PipelinedWriteStream, ThrowsWriteErrors) {
+  const std::string data(10000, 'x');
+  PipelinedWriteStream stream(std::unique_ptr<dmlc::Stream>(new FailingStream(2500)), 1000, 2);
+  EXPECT_THROW(
+      {
+        for (int i = 0; i < 100; ++i)
+          stream.Write(data.data(), data.size());
+        stream.Close();
+      },
+      dmlc::Error);
+}
+
+TEST(PipelinedWriteStream, IsRemote) {
+  EXPECT_TRUE(PipelinedWriteStream::IsRemote("s3://bucket/model-0001.params"));
+  EXPECT_TRUE(PipelinedWriteStream::IsRemote("hdfs://namenode/model-0001.params"));
+  EXPECT_FALSE(PipelinedWriteStream::IsRemote("file:///tmp/model-0001.params"));
+  EXPECT_FALSE(PipelinedWriteStream::IsRemote("/tmp/model-0001.params"));
+}
@@ -39,6 +39,48 @@ TEST(OMP_TUNING, ShowAllTunedOps) {
   }
 }
 
+/*!
+ * \brief A kernel is tuned at its first launch rather than when the library is loaded
+ */
+TEST(OMP_TUNING, TuneOnFirstUse) {
+  using tuned_negation = mxnet::op::mxnet_op::tuned_op<mxnet::op::mshadow_op::negation, double>;
+  tuned_negation::UseOMP(1024, 4);
+  if (mxnet::op::OperatorTuneByType<double>::tuning_mode() == mxnet::op::tune::kAuto) {
+    EXPECT_NE(tuned_negation::workload_[0], static_cast<float>(INT_MAX >> 3));
+  }
+}
+
+/*!
+ * \brief The adaptive tuning learns the size above which OMP is faster from the durations
+ */
+TEST(OMP_TUNING, AdaptiveCutoff) {
+  using mxnet::op::AdaptiveOMPTuning;
+  AdaptiveOMPTuning::Table* table = AdaptiveOMPTuning::Get("AdaptiveCutoffTestKernel");
+  const int threads               = 16;
+  // 1 ns per iteration, OMP takes 5 us more, so the cutoff is about 5333 iterations
+  auto duration = [](const size_t N, const bool omp) {
+    return static_cast<int64_t>(omp ? 5000 + N / threads : N);
+  };
+  for (int launch = 0; launch < 4 * AdaptiveOMPTuning::kResamplePeriod; ++launch) {
+    for (int log2 = 0; log2 < 20; ++log2) {
+      const size_t N = size_t(1) << log2;
+      // the startup workloads always choose OMP
+      const AdaptiveOMPTuning::Decision decision =
+          AdaptiveOMPTuning::Choose(table, N, threads, true);
+      if (decision.timed)
+        AdaptiveOMPTuning::Record(table, decision, N, threads, duration(N, decision.omp));
+    }
+  }
+  for (int log2 = 0; log2 < 20; ++log2) {
+    const size_t N        = size_t(1) << log2;
+    const bool omp_faster = duration(N, true) < duration(N, false);
+    const int choice      = table->slots[0].buckets[log2].choice.load();
+    EXPECT_EQ(choice, omp_faster ? AdaptiveOMPTuning::kOMP : AdaptiveOMPTuning::kSerial) << N;
+  }
+  // another thread count is learned separately
+  EXPECT_EQ(AdaptiveOMPTuning::Choose(table, 16, 8, true).omp, true);
+}
+
 using kwargs_t = test::op::kwargs_t;
 
 static std::vector<mxnet::ShapeVector> tuning_shapes() {
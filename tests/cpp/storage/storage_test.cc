@@ -26,7 +26,12 @@
 #include <mxnet/storage.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include "test_util.h"
+#include "../src/storage/slab_storage_manager.h"
+#include "../src/storage/gpu_async_storage_manager.h"
 
 TEST(Storage, Basic_CPU) {
   constexpr size_t kSize = 1024;
@@ -69,6 +74,62 @@ TEST(Storage, CPU_MemAlign) {
   }
 }
 
+TEST(Storage, CPU_Slab) {
+  mxnet::storage::SlabStorageManager manager(mxnet::Context::CPU(0));
+  mxnet::Storage::Handle handle;
+  handle.ctx = mxnet::Context::CPU(0);
+  handle.size = 1000;
+  manager.Alloc(&handle);
+  void* ptr = handle.dptr;
+  std::memset(ptr, 1, handle.size);
+  manager.Free(handle);
+  // Same size class, served from the thread cache.
+  handle.size = 1020;
+  manager.Alloc(&handle);
+  EXPECT_EQ(handle.dptr, ptr);
+  manager.Free(handle);
+  // Large allocations are not pooled.
+  handle.size = size_t(64) << 20;
+  manager.Alloc(&handle);
+  EXPECT_NE(handle.dptr, nullptr);
+  manager.Free(handle);
+  EXPECT_GT(manager.system_bytes(), 0);
+  manager.ReleaseAll();
+  EXPECT_EQ(manager.system_bytes(), 0);
+}
+
+TEST(Storage, CPU_Slab_MultiThread) {
+  mxnet::storage::SlabStorageManager manager(mxnet::Context::CPU(0));
+  auto worker = [&manager](int id) {
+    std::vector<mxnet::Storage::Handle> handles;
+    for (int i = 0; i < 2000; ++i) {
+      mxnet::Storage::Handle handle;
+      handle.ctx = mxnet::Context::CPU(0);
+      handle.size = ((i * 7919 + id * 104729) % 100000) + 1;
+      manager.Alloc(&handle);
+      std::memset(handle.dptr, id, handle.size);
+      handles.push_back(handle);
+      if (i % 3 == 0) {
+        auto& h = handles[handles.size() / 2];
+        const char* p = static_cast<const char*>(h.dptr);
+        EXPECT_EQ(p[0], static_cast<char>(id));
+        EXPECT_EQ(p[h.size - 1], static_cast<char>(id));
+        manager.Free(h);
+        handles.erase(handles.begin() + handles.size() / 2);
+      }
+    }
+    for (auto& h : handles)
+      manager.Free(h);
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i <= 4; ++i)
+    threads.emplace_back(worker, i);
+  for (auto& t : threads)
+    t.join();
+  // The caches of the exited threads went back to the central lists.
+  manager.ReleaseAll();
+  EXPECT_EQ(manager.system_bytes(), 0);
+}
 
 #if MXNET_USE_CUDA
 TEST(Storage_GPU, Basic_GPU) {
@@ -128,5 +189,23 @@ TEST(Storage_GPU, Basic_GPU) {
     storage->Free(handle);
   }
 }
+
+#if CUDART_VERSION >= 11020
+TEST(Storage_GPU, Async_GPU) {
+  if (mxnet::test::unitTestsWithCuda && mxnet::storage::GPUAsyncStorageSupported(0)) {
+    mxnet::Context context_gpu = mxnet::Context::GPU(0);
+    mxnet::storage::GPUAsyncStorageManager manager(context_gpu);
+    mxnet::Storage::Handle handle;
+    handle.ctx = context_gpu;
+    handle.size = 1 << 20;
+    manager.Alloc(&handle);
+    EXPECT_NE(handle.dptr, nullptr);
+    EXPECT_EQ(cudaMemset(handle.dptr, 0, handle.size), cudaSuccess);
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    manager.Free(handle);
+    manager.ReleaseAll();
+  }
+}
+#endif  // CUDART_VERSION >= 11020
 #endif  // MXNET_USE_CUDA
 
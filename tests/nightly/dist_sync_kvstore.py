@@ -448,6 +448,55 @@ def test_sync_init(gpu_tests=False):
         check_init(kv, init_test_keys_device_big, big_shape, device=True)
     print('worker ' + str(kv.rank) + ' is initialized')
 
+def test_server_snapshot():
+    import os
+    import time
+    num_servers = int(os.environ['DMLC_NUM_SERVER'])
+
+    def load_snapshot(prefix):
+        fnames = ['%s-server%d.params' % (prefix, i) for i in range(num_servers)]
+        # the servers write the values in the background
+        for _ in range(600):
+            if all(os.path.exists(f) for f in fnames):
+                break
+            time.sleep(0.1)
+        time.sleep(1)
+        return [mx.nd.load(f) for f in fnames]
+
+    kv.save_server_snapshot('test_snapshot_full')
+    kv._barrier()
+    full = load_snapshot('test_snapshot_full')
+    assert sum(len(s) for s in full) > 0
+    # push one row of the big row_sparse key, only this row is saved incrementally
+    v = mx.nd.zeros(big_shape)
+    v[0] = 1
+    kv.push(rsp_keys_big_shape[0], v.tostype('row_sparse'))
+    out = mx.nd.sparse.zeros('row_sparse', big_shape)
+    kv.row_sparse_pull(rsp_keys_big_shape[0], out=out, row_ids=mx.nd.array([0]))
+    out.wait_to_read()
+    kv._barrier()
+    kv.save_server_snapshot('test_snapshot_inc', incremental=True)
+    kv._barrier()
+    inc = load_snapshot('test_snapshot_inc')
+    rows = sum(a.indices.size for s in inc for a in s.values() if a.stype == 'row_sparse')
+    assert rows == 1, rows
+    print('worker ' + str(my_rank) + ' passed test_server_snapshot')
+
+def test_hash_embedding():
+    kv = mx.kv.create('dist_sync')
+    num_ids, dim = 2**40, 4
+    # ids on every server shard, all workers push them once
+    ids = np.array([1, 2**38 + 5, 2**39 + 7, 2**40 - 1], dtype=np.int64)
+    kv.init_hash_embedding('hashed', (num_ids, dim), learning_rate=1, init_scale=0)
+    grad = mx.nd.sparse.row_sparse_array((np.ones((len(ids), dim)), ids), shape=(num_ids, dim))
+    kv.push('hashed', grad)
+    kv._barrier()
+    out = mx.nd.sparse.zeros('row_sparse', (num_ids, dim))
+    kv.row_sparse_pull('hashed', out=out, row_ids=mx.nd.array(ids, dtype=np.int64))
+    assert_almost_equal(out.indices.asnumpy(), ids)
+    check_diff(out.data, -kv.num_workers, kv.rank)
+    print('worker ' + str(kv.rank) + ' passed test_hash_embedding')
+
 def test_invalid_operations():
     def check_invalid_gluon_trainer_reset():
         x = mx.gluon.Parameter('x', shape=(4, 2), lr_mult=1.0, stype='row_sparse')
@@ -544,6 +593,12 @@ if __name__ == "__main__":
         test_gluon_trainer_step()
     elif opt.type == 'gluon_sparse_step_cpu':
         test_gluon_trainer_sparse_step()
+    elif opt.type == 'snapshot_cpu':
+        kv = init_kv()
+        kv = set_optimizer(use_multiprecision=False)
+        test_server_snapshot()
+    elif opt.type == 'hash_embedding_cpu':
+        test_hash_embedding()
     elif opt.type == 'invalid_cpu':
         test_invalid_operations()
     elif opt.type == 'init_gpu':
@@ -293,6 +293,26 @@ def test_compress_kvstore(kv_type, compression='2bit', threshold=0.5):
         check_neg(kv, -1*threshold, rate, curval)
     check_compr_random(kv, threshold)
 
+def test_lossy_compress_kvstore(kv_type, compression, atol, **kwargs):
+    print(kv_type + ' with ' + compression + ' compression')
+    kv = mx.kv.create(kv_type)
+    kv.set_gradient_compression(dict(type=compression, **kwargs))
+    kv.set_optimizer(mx.optimizer.create('test', learning_rate=-1))
+    for k, s in zip(keys, shapes):
+        kv.init(k, mx.nd.zeros(s))
+    for j in range(len(keys)):
+        kv.push(keys[j], [mx.nd.array(data[0][j][g], mx.gpu(g)) for g in range(nworker)])
+        out = [mx.nd.zeros(shapes[j], mx.gpu(g)) for g in range(nworker)]
+        kv.pull(keys[j], out=out)
+        for o in out:
+            if compression == 'topk':
+                # at most one value of each block is sent by every device
+                block_size = kwargs['block_size']
+                nnz = (o.asnumpy().reshape(-1, block_size) != 0).sum(axis=1)
+                assert np.all(nnz <= nworker), nnz.max()
+            else:
+                assert_almost_equal(o.asnumpy(), sum(data[0][j]), rtol=0, atol=atol)
+
 ## group keys interface
 def test_group_kvstore(kv_type, stype):
     print(kv_type)
@@ -338,6 +358,10 @@ if __name__ == "__main__":
     test_compress_kvstore('local_allreduce_device', '1bit', 0)
     test_compress_kvstore('local_allreduce_device', '1bit', .5)
     test_compress_kvstore('local_allreduce_device', '2bit', .5)
+    test_lossy_compress_kvstore('local_allreduce_device', 'fp16', 1e-2)
+    test_lossy_compress_kvstore('local_allreduce_device', 'bf16', 5e-2)
+    test_lossy_compress_kvstore('local_allreduce_device', 'int8', nworker / 127., threshold=1.)
+    test_lossy_compress_kvstore('local_allreduce_device', 'topk', 0, block_size=16)
     for stype in stypes:
         test_group_kvstore('local_update_cpu', stype)
         test_group_kvstore('local_allreduce_cpu', stype)
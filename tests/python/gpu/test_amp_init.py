@@ -51,3 +51,32 @@ def test_npi_concatenate_multicast(np_shape_array, amp_init):
     data = mx.np.ones((32, 8), ctx=mx.gpu())
     out = foo(data)
     assert out.dtype == np.float32
+
+
+def test_device_loss_scale(np_shape_array, amp_init):
+    net = nn.Dense(4, in_units=8)
+    net.initialize(ctx=mx.gpu())
+    trainer = mx.gluon.Trainer(net.collect_params(), 'sgd', {'learning_rate': 0.1, 'momentum': 0.9},
+                               update_on_kvstore=False)
+    amp.init_trainer(trainer, device_loss_scale=True)
+    data = mx.np.ones((2, 8), ctx=mx.gpu())
+
+    def step(overflow):
+        with mx.autograd.record():
+            loss = net(data).sum()
+            with amp.scale_loss(loss, trainer) as scaled_loss:
+                mx.autograd.backward(scaled_loss)
+        if overflow:
+            net.weight.grad()[0, 0] = np.inf
+        weight = net.weight.data().asnumpy()
+        trainer.step(1)
+        return weight
+
+    loss_scale = trainer.amp_loss_scale
+    weight = step(False)
+    assert not np.array_equal(weight, net.weight.data().asnumpy())
+    assert trainer.amp_loss_scale == loss_scale
+    # the step with an overflow is skipped on the device, and the loss scale is decreased
+    weight = step(True)
+    assert np.array_equal(weight, net.weight.data().asnumpy())
+    assert trainer.amp_loss_scale == loss_scale / 2
@@ -60,5 +60,53 @@ def test_device_pushpull():
                 check_dense_pushpull('device')
 
 
+@pytest.mark.skipif(mx.context.num_gpus() < 1, reason="test_spill_to_host needs at least 1 GPU")
+def test_spill_to_host():
+    shape = (256, 1024)
+    nbytes = 256 * 1024 * 4
+    with environment('MXNET_GPU_SPILL_BUDGET', str(2 * nbytes)):
+        states = [mx.nd.full(shape, i, ctx=mx.gpu(0)) for i in range(4)]
+        for s in states:
+            s.set_spillable()
+        for _ in range(3):
+            for s in states:
+                s += 1
+        for i, s in enumerate(states):
+            assert np.all(s.asnumpy() == i + 3)
+        stats = mx.gpu(0).memory_pool_stats()['spill']
+        assert stats['num_spills'] > 0
+        assert stats['num_restores'] > 0
+        assert stats['resident_bytes'] <= max(stats['budget_bytes'], nbytes)
+        del states
+        mx.nd.waitall()
+
+
+@pytest.mark.skipif(mx.context.num_gpus() < 1, reason="test_lazy_load needs at least 1 GPU")
+def test_lazy_load(tmp_path):
+    fname = str(tmp_path / 'lazy.params')
+    shape = (256, 1024)
+    nbytes = 256 * 1024 * 4
+    experts = {'expert%d' % i: mx.nd.full(shape, i) for i in range(4)}
+    mx.nd.save(fname, experts)
+    with environment('MXNET_GPU_SPILL_BUDGET', str(2 * nbytes)):
+        lazy = mx.nd.load(fname, ctx=mx.gpu(0), lazy=True)
+        assert lazy['expert0'].context == mx.gpu(0)
+        before = mx.gpu(0).memory_pool_stats()['spill']
+        for _ in range(3):
+            for k, x in experts.items():
+                assert np.all((lazy[k] * 2).asnumpy() == x.asnumpy() * 2)
+        # a written array is spilled to the host instead of being loaded again
+        lazy['expert1'] += 1
+        for k in ['expert0', 'expert2', 'expert3']:
+            (lazy[k] + 0).wait_to_read()
+        assert np.all(lazy['expert1'].asnumpy() == 2)
+        stats = mx.gpu(0).memory_pool_stats()['spill']
+        assert stats['num_loads'] - before['num_loads'] == len(experts)
+        assert stats['num_spills'] > before['num_spills']
+        assert stats['num_restores'] > before['num_restores']
+        del lazy
+        mx.nd.waitall()
+
+
 if __name__ == '__main__':
     test_device_pushpull()
@@ -74,6 +74,13 @@ def test_custom_op_gpu():
     exe_base.backward([out_grad])
     assert_almost_equal(in_grad_base[0].asnumpy(), in_grad[0].asnumpy(), rtol=1e-3, atol=1e-3)
 
+    # test custom relu computed in place of an intermediate output when not training
+    e = mx.sym.my_relu(c - 1)
+    base = mx.sym.relu(d - 1)
+    out = e._bind(ctx=mx.gpu(), args={'c':b}).forward()
+    out_base = base._bind(ctx=mx.gpu(), args={'d':b}).forward()
+    assert_almost_equal(out_base[0].asnumpy(), out[0].asnumpy(), rtol=1e-3, atol=1e-3)
+
     # test custom noisy relu producing deterministic result given same seed managed by mxnet
     d1 = mx.nd.ones(shape=(10,10,10), ctx=mx.cpu())
     d2 = mx.nd.ones(shape=(10,10,10), ctx=mx.gpu())
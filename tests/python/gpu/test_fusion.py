@@ -369,3 +369,130 @@ def test_fusion_cycle():
     t.hybridize(static_alloc=True, static_shape=True)
     out = t(a, b)
     mx.npx.waitall()
+
+def test_fusion_reduce():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_3d()
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=(1, shape[1], 1))
+
+    shifted = mx.sym.broadcast_sub(a, mx.sym.max(a, axis=1, keepdims=True))
+    check_fused_symbol(mx.sym.sum(mx.sym.exp(shifted), axis=1), a=arr1)
+    diff = mx.sym.broadcast_sub(a, b)
+    check_fused_symbol(mx.sym.mean(mx.sym.square(diff), axis=(0, 2), keepdims=True), a=arr1, b=arr2)
+    check_fused_symbol(mx.sym.sum(a * 2 + 1, axis=1, exclude=True), a=arr1)
+
+@use_np
+def test_fusion_reduce_inference():
+    class Block(gluon.HybridBlock):
+        def forward(self, x, y):
+            d = x - y
+            var = mx.np.mean(d * d, axis=(0, 2))
+            norm = mx.np.sum(mx.np.exp(x * 0.5), axis=-1, keepdims=True)
+            return var, norm
+
+    x = mx.np.random.uniform(size=(4, 5, 6), ctx=mx.gpu())
+    y = mx.np.random.uniform(size=(5, 1), ctx=mx.gpu())
+    results = {}
+    for use_fusion in ('0', '1'):
+        with environment('MXNET_USE_FUSION', use_fusion):
+            n = Block()
+            n.hybridize(static_alloc=True)
+            results[use_fusion] = [out.asnumpy() for out in n(x, y)]
+    for orig, fused in zip(results['0'], results['1']):
+        assert_allclose(orig, fused, rtol=1e-5, atol=1e-6)
+
+def test_fusion_kernel_cache(tmpdir):
+    import subprocess
+    # the cache directory is read once per process
+    script = '''
+import mxnet as mx
+a = mx.sym.Variable('a')
+sym = mx.sym.exp(a * 3 + 1) - mx.sym.tanh(a)
+exe = sym._simple_bind(ctx=mx.gpu(0), a=(10, 10))
+print(exe.forward(a=mx.nd.ones((10, 10)))[0].sum().asscalar())
+'''
+    env = dict(os.environ, MXNET_RTC_CACHE_DIR=str(tmpdir), MXNET_USE_FUSION='1')
+    first = subprocess.check_output([sys.executable, '-c', script], env=env)
+    entries = os.listdir(str(tmpdir))
+    assert len(entries) > 0
+    second = subprocess.check_output([sys.executable, '-c', script], env=env)
+    assert sorted(os.listdir(str(tmpdir))) == sorted(entries)
+    assert first == second
+
+@use_np
+def test_fused_self_attention():
+    seq_len, batch, heads, head_dim = 37, 2, 3, 16
+    qkv = mx.np.random.uniform(-1, 1, size=(seq_len, batch, heads * 3 * head_dim), ctx=mx.gpu())
+    mask = mx.np.random.uniform(size=(1, seq_len, seq_len), ctx=mx.gpu()) > 0.3
+    mask[:, 0, :] = False
+    mask = mx.np.broadcast_to(mask, (batch * heads, seq_len, seq_len))
+
+    class Attention(gluon.HybridBlock):
+        def forward(self, qkv, mask=None):
+            scores = mx.npx.interleaved_matmul_selfatt_qk(qkv, heads=heads)
+            if mask is None:
+                att = mx.npx.softmax(scores, axis=-1, temperature=0.5)
+            else:
+                att = mx.npx.masked_softmax(scores, mask, axis=-1, temperature=0.5)
+            return mx.npx.interleaved_matmul_selfatt_valatt(qkv, att, heads=heads)
+
+    def run(fn, *args):
+        x = qkv.copy()
+        x.attach_grad()
+        with autograd.record():
+            out = fn(x, *args)
+        out.backward(mx.np.ones_like(out))
+        return out.asnumpy(), x.grad.asnumpy()
+
+    for args in ((), (mask,)):
+        fused = lambda x, *m: mx.npx.interleaved_selfatt(x, *m, heads=heads, masked=len(m) > 0,
+                                                         temperature=0.5)
+        ref = run(Attention(), *args)
+        for r, f in zip(ref, run(fused, *args)):
+            assert_allclose(r, f, rtol=1e-4, atol=1e-5)
+        net = Attention()
+        net.hybridize(static_alloc=True)
+        with environment('MXNET_USE_FUSED_ATTENTION', '1'):
+            res = run(net, *args)
+        for r, f in zip(ref, res):
+            assert_allclose(r, f, rtol=1e-4, atol=1e-5)
+
+
+@use_np
+def test_fused_batch_norm_add_relu():
+    shape = (2, 5, 6, 8)
+
+    class Block(gluon.HybridBlock):
+        def __init__(self):
+            super(Block, self).__init__()
+            self.bn = gluon.nn.BatchNorm(axis=-1)
+
+        def forward(self, x, residual):
+            return mx.npx.relu(self.bn(x) + residual)
+
+    def run(net, args, head_grad):
+        xs = [a.copy() for a in args]
+        for x in xs:
+            x.attach_grad()
+        with autograd.record():
+            out = net(*xs)
+        out.backward(head_grad)
+        params = net.collect_params().values()
+        return [out.asnumpy()] + [x.grad.asnumpy() for x in xs] + \
+               [p.grad().asnumpy() for p in params if p.grad_req != 'null']
+
+    # cuDNN fuses the addition and the ReLU for float16, the bitmask is computed apart for float32
+    for dtype, tol in (('float16', 1e-2), ('float32', 1e-4)):
+        net = Block()
+        net.initialize(ctx=mx.gpu())
+        net.cast(dtype)
+        args = [mx.np.random.uniform(-1, 1, size=shape, ctx=mx.gpu()).astype(dtype) for _ in range(2)]
+        head_grad = mx.np.random.uniform(-1, 1, size=shape, ctx=mx.gpu()).astype(dtype)
+        ref = run(net, args, head_grad)
+        net.hybridize(static_alloc=True)
+        with environment('MXNET_USE_FUSED_BN_ADD_RELU', '1'):
+            res = run(net, args, head_grad)
+        for r, f in zip(ref, res):
+            assert_allclose(r, f, rtol=tol, atol=tol)
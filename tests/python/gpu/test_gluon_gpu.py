@@ -151,6 +151,24 @@ def test_lstm_clip():
     assert not _np.isnan(cell_states).any()
 
 
+@assert_raises_cudnn_not_satisfied(min_version='7.2.1')
+@pytest.mark.parametrize('layer_cls', [gluon.rnn.LSTM, gluon.rnn.GRU])
+def test_rnn_layer_persistent(layer_cls):
+    # the persistent kernels compute the same recurrence as the standard ones
+    hidden_size, num_layers, input_size, seq_len = 128, 2, 64, 20
+    for batch_size in [1, 8]:
+        data = mx.np.random.uniform(size=(seq_len, batch_size, input_size), ctx=mx.gpu(0))
+        standard = layer_cls(hidden_size, num_layers, input_size=input_size)
+        standard.initialize(ctx=mx.gpu(0))
+        persistent = layer_cls(hidden_size, num_layers, input_size=input_size,
+                               use_persistent=True)
+        persistent.initialize(ctx=mx.gpu(0))
+        persistent.load_dict({k: v.data() for k, v in standard.collect_params().items()})
+        standard.hybridize()
+        persistent.hybridize()
+        assert_almost_equal(persistent(data), standard(data), rtol=1e-3, atol=1e-4)
+
+
 @assert_raises_cudnn_not_satisfied(min_version='5.1.10')
 def test_rnn_layer():
     check_rnn_layer(gluon.rnn.RNN(100, num_layers=3))
@@ -339,7 +357,7 @@ def test_global_norm_clip_multi_device():
         assert_almost_equal(x4, _np.ones((7, 4)) / 9)
 
 
-def _check_batchnorm_result(input, num_devices=1, cuda=False):
+def _check_batchnorm_result(input, num_devices=1, cuda=False, use_nccl=False):
     from mxnet.gluon.utils import split_and_load
     def _find_bn(module):
         if isinstance(module, (mx.gluon.nn.BatchNorm, mx.gluon.nn.SyncBatchNorm)):
@@ -367,7 +385,7 @@ def _check_batchnorm_result(input, num_devices=1, cuda=False):
 
     nch = input.shape[1]
     bn1 = mx.gluon.nn.BatchNorm(in_channels=nch)
-    bn2 = mx.gluon.nn.SyncBatchNorm(in_channels=nch, num_devices=num_devices)
+    bn2 = mx.gluon.nn.SyncBatchNorm(in_channels=nch, num_devices=num_devices, use_nccl=use_nccl)
 
     bn1.initialize(ctx=ctx_list[0])
     bn2.initialize(ctx=ctx_list)
@@ -418,6 +436,49 @@ def test_sync_batchnorm():
         _check_batchnorm_result(mx.np.random.uniform(size=(4, 1, 4, 4)),
                                 num_devices=ndev, cuda=True)
 
+_nccl_devices = []
+
+def _init_nccl(ndev):
+    # the communicators of a process are created once
+    if not _nccl_devices:
+        if mx.context.num_gpus() < ndev or not mx.runtime.Features().is_enabled('NCCL'):
+            return False
+        _nccl_devices.extend(mx.gpu(i) for i in range(ndev))
+        mx.contrib.nccl.init(mx.contrib.nccl.get_unique_id(), ndev, 0, _nccl_devices)
+    return len(_nccl_devices) == ndev
+
+@mx.util.use_np
+def test_sync_batchnorm_nccl():
+    # the GPUs of this process are all the ranks of the communicators
+    ndev = 2
+    if not _init_nccl(ndev):
+        return
+    for _ in range(10):
+        _check_batchnorm_result(mx.np.random.uniform(size=(4, 3, 4, 4)),
+                                num_devices=ndev, cuda=True, use_nccl=True)
+
+def test_collectives_nccl():
+    ndev = 2
+    if not _init_nccl(ndev):
+        return
+    xs = [mx.nd.random.uniform(shape=(4, 3), ctx=mx.gpu(i)) for i in range(ndev)]
+    for x in xs:
+        x.attach_grad()
+    with mx.autograd.record():
+        sums = [mx.nd.contrib.allreduce(x, num_ranks=ndev) for x in xs]
+        gathers = [mx.nd.contrib.allgather(x, num_ranks=ndev) for x in xs]
+        scatters = [mx.nd.contrib.reduce_scatter(x, num_ranks=ndev) for x in xs]
+    expected_sum = sum(x.asnumpy() for x in xs)
+    expected_gather = _np.concatenate([x.asnumpy() for x in xs], axis=0)
+    for r in range(ndev):
+        assert_almost_equal(sums[r], expected_sum)
+        assert_almost_equal(gathers[r], expected_gather)
+        assert_almost_equal(scatters[r], expected_sum[r * 2:(r + 1) * 2])
+    # the gradient of all gather reduce scatters the gradients of the ranks
+    mx.autograd.backward([g * (r + 1) for r, g in enumerate(gathers)])
+    for r in range(ndev):
+        assert_almost_equal(xs[r].grad, _np.full((4, 3), 3.0))
+
 def test_symbol_block_fp16(tmpdir):
     # Test case to verify if initializing the SymbolBlock from a model with params
     # other than fp32 param dtype.
@@ -646,3 +707,201 @@ def test_cudnn_dropout_reproducibility():
 
     assert_almost_equal(a.grad, b.grad)
 
+
+@mx.util.use_np
+def test_cuda_graphs():
+    class Net(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.fc1 = nn.Dense(32)
+            self.bn = nn.BatchNorm()
+            self.fc2 = nn.Dense(8)
+
+        def forward(self, x):
+            return self.fc2(mx.npx.relu(self.bn(self.fc1(x))))
+
+    def run(use_graphs):
+        mx.np.random.seed(1234)
+        net = Net()
+        net.initialize(ctx=mx.gpu(0))
+        net.hybridize(static_alloc=True, static_shape=True)
+        x = mx.np.random.uniform(size=(4, 16), ctx=mx.gpu(0))
+        outs, grads = [], []
+        with environment('MXNET_ENABLE_CUDA_GRAPHS', use_graphs):
+            for _ in range(4):
+                outs.append(net(x).asnumpy())
+                with autograd.record():
+                    y = net(x)
+                y.backward()
+                grads.append(net.fc1.weight.grad().asnumpy())
+        return outs, grads
+
+    ref_outs, ref_grads = run('0')
+    outs, grads = run('1')
+    for ref, out in zip(ref_outs + ref_grads, outs + grads):
+        assert_almost_equal(ref, out)
+
+
+@mx.util.use_np
+def test_nhwc_layout():
+    class Net(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.conv1 = nn.Conv2D(16, 3, padding=1)
+            self.bn = nn.BatchNorm()
+            self.conv2 = nn.Conv2D(16, 3, padding=1)
+            self.pool = nn.MaxPool2D()
+            self.dense = nn.Dense(4)
+
+        def forward(self, x):
+            y = mx.npx.relu(self.bn(self.conv1(x)))
+            y = self.pool(self.conv2(y) + y)
+            return self.dense(y), y
+
+    def run(use_nhwc):
+        mx.np.random.seed(1234)
+        net = Net()
+        net.initialize(ctx=mx.gpu(0))
+        net.hybridize(static_alloc=True)
+        x = mx.np.random.uniform(size=(2, 8, 12, 12), ctx=mx.gpu(0))
+        x.attach_grad()
+        with environment('MXNET_USE_NHWC_LAYOUT', use_nhwc):
+            with autograd.record():
+                out, feat = net(x)
+            out.backward()
+        return [out.asnumpy(), feat.asnumpy(), x.grad.asnumpy(),
+                net.conv1.weight.grad().asnumpy()]
+
+    for ref, res in zip(run('0'), run('1')):
+        assert_almost_equal(ref, res, rtol=1e-3, atol=1e-3)
+
+
+@mx.util.use_np
+def test_multi_stream_branches():
+    class Net(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.conv1 = nn.Conv2D(8, 1)
+            self.conv3 = nn.Conv2D(8, 3, padding=1)
+            self.conv5 = nn.Conv2D(8, 5, padding=2)
+            self.pool = nn.MaxPool2D(3, 1, 1)
+            self.dense = nn.Dense(4)
+
+        def forward(self, x):
+            ys = [mx.npx.relu(conv(x)) for conv in (self.conv1, self.conv3, self.conv5)] + [self.pool(x)]
+            return self.dense(mx.np.concatenate(ys, axis=1))
+
+    def run(multi_stream):
+        mx.np.random.seed(1234)
+        net = Net()
+        net.initialize(ctx=mx.gpu(0))
+        net.hybridize(static_alloc=True, static_shape=True)
+        x = mx.np.random.uniform(size=(2, 4, 10, 10), ctx=mx.gpu(0))
+        outs, grads = [], []
+        with environment('MXNET_EXEC_MULTI_STREAM', multi_stream):
+            for _ in range(2):
+                outs.append(net(x).asnumpy())
+                with autograd.record():
+                    y = net(x)
+                y.backward()
+                grads.append(net.conv3.weight.grad().asnumpy())
+        return outs + grads
+
+    for ref, res in zip(run('0'), run('1')):
+        assert_almost_equal(ref, res)
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('dtype', ['float32', 'float16'])
+def test_cublaslt_fc_fusion(dtype):
+    class Net(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.fc1 = nn.Dense(32, activation='relu')
+            self.fc2 = nn.Dense(16, flatten=False)
+            self.gelu = nn.GELU()
+            self.fc3 = nn.Dense(8, use_bias=False)
+
+        def forward(self, x):
+            y = self.gelu(self.fc2(self.fc1(x)))
+            # the output of fc3 also feeds the sum, so its ReLU is not fused
+            z = self.fc3(y)
+            return mx.npx.relu(z) + z
+
+    def run(backend):
+        mx.np.random.seed(1234)
+        net = Net()
+        net.initialize(ctx=mx.gpu(0))
+        net.cast(dtype)
+        x = mx.np.random.uniform(-1, 1, size=(16, 24), ctx=mx.gpu(0), dtype=dtype)
+        if backend:
+            net.optimize_for(x, backend=backend)
+            assert net._cached_graph[1].tojson().count('_sg_cublaslt_fully_connected') == 2
+        else:
+            net.hybridize()
+        x.attach_grad()
+        with autograd.record():
+            out = net(x)
+        out.backward()
+        return [out, x.grad] + [p.grad() for p in net.collect_params().values()]
+
+    tol = 1e-2 if dtype == 'float16' else 1e-5
+    for ref, res in zip(run(None), run('CUBLASLT')):
+        assert_almost_equal(ref, res, rtol=tol, atol=tol)
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('dtype', ['float32', 'float16'])
+def test_cusparselt_2_4_sparse_layers(dtype):
+    class Net(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            # the weight rows of conv1 have 3 elements, it is not pruned and stays dense
+            self.conv1 = nn.Conv2D(32, 1, in_channels=3, activation='relu')
+            self.conv2 = nn.Conv2D(16, 1, in_channels=32)
+            self.fc = nn.Dense(32, in_units=16 * 8 * 8)
+
+        def forward(self, x):
+            return self.fc(self.conv2(self.conv1(x)))
+
+    def run(backend):
+        mx.np.random.seed(1234)
+        net = Net()
+        net.initialize(ctx=mx.gpu(0))
+        net.cast(dtype)
+        pruned = mx.contrib.sparsity.prune_block_2_4(net)
+        assert len(pruned) == 2
+        assert all(mx.contrib.sparsity.is_2_4_sparse(net.collect_params()[name].data()) for name in pruned)
+        x = mx.np.random.uniform(-1, 1, size=(16, 3, 8, 8), ctx=mx.gpu(0), dtype=dtype)
+        if backend:
+            net.optimize_for(x, backend=backend)
+            graph = net._cached_graph[1].tojson()
+            assert graph.count('_sg_cusparselt_convolution') == 1
+            assert graph.count('_sg_cusparselt_fully_connected') == 1
+        else:
+            net.hybridize()
+        return net(x)
+
+    tol = 1e-2 if dtype == 'float16' else 1e-5
+    assert_almost_equal(run(None), run('CUSPARSELT'), rtol=tol, atol=tol)
+
+
+@mx.util.use_np
+def _test_shared_gpu_parameters_in_process(seed, handles, x, out):
+    net = nn.Dense(8, in_units=16)
+    net.setattr('grad_req', 'null')
+    gluon.utils.load_shared_gpu_parameters(net.collect_params(), handles)
+    assert not net.weight.data().writable
+    out.extend(net(mx.np.array(x, ctx=mx.gpu(0))).asnumpy().ravel().tolist())
+
+@mx.util.use_np
+def test_shared_gpu_parameters():
+    net = nn.Dense(8, in_units=16)
+    net.initialize(ctx=mx.gpu(0))
+    x = _np.random.uniform(-1, 1, size=(4, 16)).astype('float32')
+    expected = net(mx.np.array(x, ctx=mx.gpu(0))).asnumpy()
+    handles = gluon.utils.export_shared_gpu_parameters(net.collect_params())
+    out = mp.Manager().list()
+    if not run_in_spawned_process(_test_shared_gpu_parameters_in_process, {}, handles, x, out):
+        return
+    assert_almost_equal(_np.array(out).reshape(expected.shape), expected)
@@ -0,0 +1,95 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import os
+import mxnet as mx
+import numpy as np
+import pytest
+from mxnet.test_utils import get_cifar10
+
+
+@pytest.fixture(scope="session")
+def cifar10(tmpdir_factory):
+    path = str(tmpdir_factory.mktemp('cifar'))
+    get_cifar10(path)
+    return path
+
+
+@pytest.mark.skip(reason="Test requires nvJPEG enabled during build")
+@pytest.mark.parametrize('dtype', ['uint8', 'float32'])
+def test_ImageRecordIter_gpu_decode(dtype, cifar10):
+    def create_iter(gpu_decode, **kwargs):
+        return mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'test.rec'),
+            data_shape=(3, 28, 28),
+            batch_size=100,
+            dtype=dtype,
+            mean_r=125.3, mean_g=123.0, mean_b=113.9,
+            std_r=63.0, std_g=62.1, std_b=66.7,
+            gpu_decode=gpu_decode,
+            device_id=0,
+            **kwargs)
+
+    # the center crops of both decoders only differ by the IDCT of the JPEG decoders
+    cpu_iter = create_iter(False)
+    gpu_iter = create_iter(True)
+    for cpu_batch, gpu_batch in zip(cpu_iter, gpu_iter):
+        assert gpu_batch.data[0].context == mx.gpu(0)
+        assert gpu_batch.pad == cpu_batch.pad
+        np.testing.assert_equal(gpu_batch.label[0].asnumpy(), cpu_batch.label[0].asnumpy())
+        diff = np.abs(gpu_batch.data[0].asnumpy().astype('float32') -
+                      cpu_batch.data[0].asnumpy().astype('float32'))
+        assert diff.mean() < (0.5 if dtype == 'uint8' else 0.01)
+
+    # the random augmentations keep the shape and range of the batches
+    aug_iter = create_iter(True, random_resized_crop=True, min_random_area=0.5,
+                           max_aspect_ratio=1.33, min_aspect_ratio=0.75, rand_mirror=True,
+                           brightness=0.4, contrast=0.4, saturation=0.4, resize=36)
+    for batch in aug_iter:
+        data = batch.data[0].asnumpy()
+        assert data.shape == (100, 3, 28, 28)
+        assert np.isfinite(data).all()
+
+
+def test_LibSVMIter_prefetch_device(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    rng = np.random.RandomState(0)
+    with open(data_path, 'w') as fout:
+        for _ in range(100):
+            indices = np.sort(rng.choice(20, rng.randint(0, 5), replace=False))
+            fout.write(' '.join(['%d' % rng.randint(0, 5)] +
+                                ['%d:%.3f' % (i, rng.uniform()) for i in indices]) + '\n')
+
+    def create_iter(**kwargs):
+        return mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(20,), batch_size=8, **kwargs)
+
+    host_iter = create_iter()
+    device_iter = create_iter(prefetch_device_id=0)
+    for _ in range(2):
+        num_batches = 0
+        for host_batch, device_batch in zip(host_iter, device_iter):
+            assert device_batch.data[0].context == mx.gpu(0)
+            assert device_batch.data[0].stype == 'csr'
+            assert device_batch.label[0].context == mx.gpu(0)
+            assert device_batch.pad == host_batch.pad
+            np.testing.assert_allclose(device_batch.data[0].asnumpy(), host_batch.data[0].asnumpy())
+            np.testing.assert_allclose(device_batch.label[0].asnumpy(),
+                                       host_batch.label[0].asnumpy())
+            num_batches += 1
+        assert num_batches == 13
+        host_iter.reset()
+        device_iter.reset()
@@ -134,3 +134,26 @@ def test_rsp_push_pull_large_rowid():
     kv.row_sparse_pull('a', out=out, row_ids=mx.nd.arange(0, num_rows, dtype='int64'))
     assert(out.indices.shape[0] == num_rows)
 
+
+
+@pytest.mark.skipif(mx.context.num_gpus() < 2, reason="test_gpu_peer_copy needs more than 1 GPU")
+@pytest.mark.serial
+def test_gpu_peer_copy():
+    ctxs = [mx.gpu(i) for i in range(mx.context.num_gpus())]
+    # the small arrays are broadcast by one kernel, the large one in chunks over the links
+    shapes = [(1,), (3, 5), (17, 33), (256, 256), (3, 1 << 21)]
+    for dtype in ['float32', 'float16']:
+        kv = mx.kv.create('device')
+        vals = [mx.nd.random.uniform(shape=s, ctx=ctxs[1]).astype(dtype) for s in shapes]
+        kv.init(list(range(len(shapes))), vals)
+        outs = [[mx.nd.zeros(s, ctx=c, dtype=dtype) for c in ctxs] for s in shapes]
+        kv.pull(list(range(len(shapes))), out=outs)
+        for val, out in zip(vals, outs):
+            for o in out:
+                assert_almost_equal(o.asnumpy(), val.asnumpy())
+
+    # copies between GPUs of views at unaligned offsets and of large arrays
+    x = mx.nd.random.uniform(0, 100, shape=((1 << 25) + 7,), ctx=ctxs[0]).astype('int8')
+    for view in [x[3:20], x[1:], x]:
+        y = view.copyto(ctxs[1])
+        assert_almost_equal(y.asnumpy(), view.asnumpy())
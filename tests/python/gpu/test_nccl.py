@@ -49,5 +49,30 @@ def test_nccl_pushpull():
 
     print ("Passed")
 
+@pytest.mark.skip(reason="Test requires NCCL library installed and enabled during build")
+def test_nccl_row_sparse_pushpull():
+    shape = (100, 8)
+    for n_gpus in gpus:
+        kv_nccl = mx.kv.create('nccl')
+        cur_key = str(1000 + n_gpus)
+        kv_nccl.init(cur_key, mx.nd.zeros(shape).tostype('row_sparse'))
+        expected = np.zeros(shape)
+        arr_list = []
+        for x in range(n_gpus):
+            # the rows of the GPUs overlap, the last GPU has none
+            rows = [] if x == n_gpus - 1 and n_gpus > 1 else [x, x + 1, 50 + x]
+            dense = np.zeros(shape)
+            dense[rows] = x + 1
+            expected += dense
+            arr_list.append(mx.nd.array(dense, mx.gpu(x)).tostype('row_sparse'))
+        kv_nccl.push(cur_key, arr_list)
+        row_ids = mx.nd.arange(0, shape[0], ctx=mx.gpu(0))
+        res = mx.nd.sparse.zeros('row_sparse', shape, ctx=mx.gpu(0))
+        kv_nccl.row_sparse_pull(cur_key, out=res, row_ids=row_ids)
+        assert np.sum(np.abs(res.asnumpy() - expected)) == 0
+
+    print ("Passed")
+
 if __name__ == '__main__':
     test_nccl_pushpull()
+    test_nccl_row_sparse_pushpull()
@@ -50,6 +50,7 @@ from test_ndarray import *
 from test_subgraph_op import *
 from test_gluon_gpu import _test_bulking
 from test_contrib_operator import test_multibox_target_op
+from test_contrib_operator import test_box_nms_large, test_box_detection_op
 from test_optimizer import test_adamW
 del test_custom_op_fork  #noqa
 
@@ -2284,3 +2285,99 @@ def test_split_v2_fwd(dtype):
     data = mx.sym.Variable("data")
     sym = mx.sym.split_v2(data, indices_or_sections=indices, axis=axis)
     check_symbolic_forward(sym, {"data": mx_data}, np_out, rtol=1e-3, atol=1e-5)
+
+
+@pytest.mark.parametrize('dtype', ['float16', 'float32', 'float64', 'int32'])
+@pytest.mark.parametrize('shape,axis', [((37, 1000), 1), ((3, 5, 2049), (1, 2)), ((100003,), 0),
+                                        ((1000, 37), 0), ((2, 2000, 64), (0, 1)), ((3001, 130), 0)])
+@pytest.mark.parametrize('offset', [0, 1])
+def test_reduce_contiguous_axes(dtype, shape, axis, offset):
+    # the reductions of the leading or the trailing axes take the vectorized kernels, from
+    # aligned and unaligned data
+    data = mx.nd.random.uniform(-1, 1, shape=(shape[0] + offset,) + shape[1:], ctx=mx.cpu())
+    data = (data * 10 if dtype == 'int32' else data).astype(dtype)[offset:]
+    gpu_data = data.copyto(mx.gpu())
+    for op, tol in ((mx.nd.sum, 1e-2), (mx.nd.max, 0), (mx.nd.min, 0), (mx.nd.norm, 1e-2)):
+        if op is mx.nd.norm and dtype == 'int32':
+            continue
+        expected = op(data.astype('float64'), axis=axis).asnumpy()
+        out = op(gpu_data, axis=axis).asnumpy().astype('float64')
+        assert_almost_equal(out, expected, rtol=tol, atol=tol * shape[-1])
+
+
+@pytest.mark.parametrize('staging_bytes', ['1000', '16777216'])
+def test_ndarray_load_to_gpu(staging_bytes, tmp_path):
+    fname = str(tmp_path / 'gpu.params')
+    dmap = {'w%d' % i: mx.nd.random.uniform(-1, 1, shape=(i * 100 + 1, 33)).astype(dtype)
+            for i, dtype in enumerate(['float32', 'float16', 'float64', 'int8', 'float32'])}
+    dmap['sparse'] = dmap['w0'].clip(0, 1).tostype('csr')
+    mx.nd.save(fname, dmap)
+    # small staging buffers copy the arrays in many chunks, reusing the buffers
+    with environment({'MXNET_LOAD_STAGING_BYTES': staging_bytes, 'MXNET_LOAD_STAGING_BUFFERS': '2'}):
+        loaded = mx.nd.load(fname, ctx=mx.gpu(0))
+    assert sorted(loaded.keys()) == sorted(dmap.keys())
+    for k, x in dmap.items():
+        assert loaded[k].context == mx.gpu(0)
+        assert loaded[k].stype == x.stype
+        assert loaded[k].dtype == x.dtype
+        assert same(loaded[k].asnumpy(), x.asnumpy())
+
+
+@pytest.mark.parametrize('staging_bytes', ['1000', '16777216'])
+@pytest.mark.parametrize('save_fn', ['savez', 'savez_async'])
+def test_npz_save_from_gpu(staging_bytes, save_fn, tmp_path):
+    fname = str(tmp_path / 'gpu.npz')
+    dmap = {'w%d' % i: mx.nd.random.uniform(-1, 1, shape=(i * 100 + 1, 33), ctx=mx.gpu(0))
+            .astype(dtype) for i, dtype in enumerate(['float32', 'float16', 'float64', 'int8'])}
+    dmap['empty'] = mx.nd.zeros((0, 3), ctx=mx.gpu(0))
+    dmap['sparse'] = dmap['w0'].clip(0, 1).tostype('csr')
+    # small staging buffers copy the arrays to the file in many chunks, reusing the buffers
+    with environment({'MXNET_LOAD_STAGING_BYTES': staging_bytes, 'MXNET_LOAD_STAGING_BUFFERS': '2'}):
+        if save_fn == 'savez':
+            mx.npx.savez(fname, **dmap)
+        else:
+            mx.npx.savez_async(fname, **dmap).result()
+    loaded = mx.nd.load(fname)
+    assert sorted(loaded.keys()) == sorted(dmap.keys())
+    for k, x in dmap.items():
+        assert loaded[k].stype == x.stype
+        assert loaded[k].dtype == x.dtype
+        assert same(loaded[k].asnumpy(), x.asnumpy())
+
+
+@pytest.mark.parametrize('stream', [None, 1, 2])
+def test_dlpack_stream_handoff(stream):
+    x = mx.nd.random.uniform(shape=(1024, 1024), ctx=mx.gpu(0))
+    # the handoff does not wait for the pending dot, the stream of the consumer does
+    y = mx.nd.dot(x, x)
+    assert y.__dlpack_device__() == (2, 0)
+    z = mx.nd.from_dlpack(y.__dlpack__(stream=stream))
+    assert z.context == mx.gpu(0)
+    assert_almost_equal(z.asnumpy(), mx.nd.dot(x, x).asnumpy(), rtol=1e-4, atol=1e-4)
+
+
+def test_dgl_graph_gpu():
+    shape = (5, 5)
+    data_np = np.arange(1, 21, dtype=np.int64)
+    indices_np = np.array([1,2,3,4,0,2,3,4,0,1,3,4,0,1,2,4,0,1,2,3], dtype=np.int64)
+    indptr_np = np.array([0,4,8,12,16,20], dtype=np.int64)
+    a = mx.nd.sparse.csr_matrix((data_np, indices_np, indptr_np), shape=shape)
+    u = mx.nd.array([0, 0, 1, 1, 2, 4], dtype=np.int64)
+    v = mx.nd.array([0, 1, 1, 2, 0, 3], dtype=np.int64)
+    expected = mx.nd.contrib.edge_id(a, u, v)
+    out = mx.nd.contrib.edge_id(a.as_in_context(mx.gpu(0)), u.as_in_context(mx.gpu(0)),
+                                v.as_in_context(mx.gpu(0)))
+    assert out.context == mx.gpu(0)
+    assert_almost_equal(out.asnumpy(), expected.asnumpy())
+
+    seed = mx.nd.array([0, 4], dtype=np.int64)
+    subg_v, subg = mx.nd.contrib.dgl_csr_neighbor_uniform_sample(
+        a, seed, num_args=2, num_hops=1, num_neighbor=2, max_num_vertices=5)[:2]
+    graph_size = int(subg_v[-1].asscalar())
+    expected = mx.nd.contrib.dgl_graph_compact(subg, subg_v, graph_sizes=(graph_size,),
+                                               return_mapping=False)
+    out = mx.nd.contrib.dgl_graph_compact(subg.as_in_context(mx.gpu(0)),
+                                          subg_v.as_in_context(mx.gpu(0)),
+                                          graph_sizes=(graph_size,), return_mapping=False)
+    assert out.context == mx.gpu(0)
+    assert_almost_equal(out.asnumpy(), expected.asnumpy())
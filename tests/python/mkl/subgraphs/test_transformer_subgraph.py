@@ -92,3 +92,39 @@ def test_self_attention(batch_size, seq_length, units, num_heads):
       max_range = np.max(ref_out[i].asnumpy())
       atol = 0.1 * max(abs(min_range), abs(max_range))
       assert_almost_equal_with_err(qout[i].asnumpy(), ref_out[i].asnumpy(), rtol=0.1, atol=atol, etol=0.2)
+
+
+@use_np
+@pytest.mark.parametrize('batch_size', [1, 8])
+@pytest.mark.parametrize('seq_length', [31, 200])
+@pytest.mark.parametrize('masked', [False, True])
+def test_fused_interleaved_self_attention(batch_size, seq_length, masked):
+  units, num_heads = 64, 4
+  class InterleavedAttention(nn.HybridBlock):
+    def __init__(self, **kwargs):
+        super(InterleavedAttention, self).__init__(**kwargs)
+        self._fc = nn.Dense(in_units=units, units=3*units, flatten=False)
+
+    def forward(self, x, mask):
+        qkv = self._fc(x)
+        scores = mx.npx.interleaved_matmul_selfatt_qk(qkv, heads=num_heads)
+        if masked:
+            attn_weights = mx.npx.masked_softmax(scores, mask=mask.astype(np.bool), axis=-1,
+                                                 temperature=2.0)
+        else:
+            attn_weights = mx.npx.softmax(scores, axis=-1, temperature=2.0)
+        return mx.npx.interleaved_matmul_selfatt_valatt(qkv, attn_weights, heads=num_heads)
+
+  net = InterleavedAttention()
+  in_data = mx.np.random.uniform(size=[seq_length, batch_size, units], dtype='float32')
+  mask = mx.np.random.uniform(low=0, high=2, size=[batch_size * num_heads, 1, seq_length],
+                              dtype='int32')
+  net.initialize()
+  net.hybridize()
+  ref_out = net(in_data, mask)
+
+  net.optimize_for(in_data, mask, backend="MKLDNN")
+  out = net(in_data, mask)
+  sym, _ = net.export(None)
+  assert '_sg_mkldnn_selfatt' in sym.tojson()
+  assert_almost_equal(out.asnumpy(), ref_out.asnumpy(), rtol=1e-4, atol=1e-5)
@@ -427,6 +427,55 @@ def test_convolution():
         check_convolution_training(stype)
 
 
+def test_primitive_cache_metrics():
+    def cache_metrics():
+        text = mx.profiler.metrics()
+        samples = dict(line.rsplit(' ', 1) for line in text.splitlines()
+                       if line.startswith('mxnet_onednn_cache_'))
+        return {k: int(v) for k, v in samples.items()}
+
+    data = mx.nd.ones((2, 3, 16, 16))
+    weight = mx.nd.ones((4, 3, 3, 3))
+    mx.nd.Convolution(data, weight, kernel=(3, 3), num_filter=4, no_bias=True).wait_to_read()
+    before = cache_metrics()
+    for _ in range(4):
+        mx.nd.Convolution(data, weight, kernel=(3, 3), num_filter=4, no_bias=True).wait_to_read()
+    after = cache_metrics()
+    assert after['mxnet_onednn_cache_hits_total'] > before['mxnet_onednn_cache_hits_total']
+    assert after['mxnet_onednn_cache_entries'] > 0
+    assert after['mxnet_onednn_cache_bytes'] > 0
+
+
+@use_np
+@pytest.mark.parametrize('backend', [None, 'MKLDNN'])
+def test_prepack_weights(tmpdir, backend):
+    def build():
+        net = nn.HybridSequential()
+        net.add(nn.Conv2D(8, kernel_size=3, activation='relu'),
+                nn.Conv2D(8, kernel_size=3),
+                nn.Dense(16, activation='relu'),
+                nn.Dense(4))
+        return net
+
+    x = mx.np.random.uniform(size=(2, 3, 12, 12))
+    net = build()
+    net.initialize()
+    expected = net(x)
+    if backend:
+        net.optimize_for(x, backend=backend)
+    else:
+        net.hybridize()
+    assert_almost_equal(net.prepack(x), expected, rtol=1e-4, atol=1e-5)
+    assert_almost_equal(net(x), expected, rtol=1e-4, atol=1e-5)
+
+    # the packed weights are saved in the default layout
+    path = str(tmpdir.join('prepacked.params'))
+    net.save_parameters(path)
+    loaded = build()
+    loaded.load_parameters(path)
+    assert_almost_equal(loaded(x), expected, rtol=1e-4, atol=1e-5)
+
+
 def test_Deconvolution():
     def check_Deconvolution_training(stype):
         for shape in [(3, 3, 10), (3, 3, 10, 10), (3, 3, 3, 10, 10)]:
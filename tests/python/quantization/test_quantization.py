@@ -355,9 +355,6 @@ def test_quantized_elemwise_add():
         elif qtype != 'uint8' and qtype != 'int8':
             print('skipped testing quantized_elemwise_add for not supported data type')
             return
-        elif is_test_for_gpu():
-            print('skipped testing quantized_elemwise_add for gpu since it is not supported yet')
-            return
 
         class ElemwiseSumBlock(mx.gluon.nn.HybridBlock):
             def __init__(self, **kwargs):
@@ -789,6 +786,57 @@ def test_quantized_embedding():
     check_quantized_embedding((32,), 1024, 512)
 
 
+@use_np
+def test_rowwise_quantized_embedding():
+    def check_rowwise_quantized_embedding(data_shape, input_dim, output_dim, bits, pooling,
+                                          use_length):
+        if is_test_for_gpu():
+            print('skipped testing test_rowwise_quantized_embedding for gpu since it is not supported yet')
+            return
+        weight = onp.random.uniform(-2, 2, size=(input_dim, output_dim)).astype('float32')
+        data = onp.random.randint(0, input_dim, size=data_shape).astype('float32')
+        qweight = npx.rowwise_quantize(mx.np.array(weight), bits=bits)
+        assert qweight.dtype == onp.uint8
+        assert qweight.shape == (input_dim, (output_dim * bits + 7) // 8 + 8)
+
+        # a row dequantizes to within half a step of the float32 row
+        step = (weight.max(axis=1) - weight.min(axis=1)) / (2 ** bits - 1)
+        rows = weight[data.astype('int64')]
+        errors = step[data.astype('int64')][..., None] / 2 + 1e-5
+        kwargs = {'input_dim': input_dim, 'output_dim': output_dim, 'bits': bits,
+                  'pooling': pooling}
+        if pooling == 'none':
+            qoutput = npx.rowwise_quantized_embedding(mx.np.array(data), qweight, **kwargs)
+            assert qoutput.shape == rows.shape
+            assert (onp.abs(qoutput.asnumpy() - rows) <= errors).all()
+            return
+        length = onp.full(data_shape[:-1], data_shape[-1])
+        if use_length:
+            length = onp.random.randint(0, data_shape[-1] + 1, size=data_shape[:-1])
+            kwargs['use_length'] = True
+            qoutput = npx.rowwise_quantized_embedding(mx.np.array(data), qweight,
+                                                      mx.np.array(length), **kwargs)
+        else:
+            qoutput = npx.rowwise_quantized_embedding(mx.np.array(data), qweight, **kwargs)
+        mask = (onp.arange(data_shape[-1]) < length[..., None])[..., None]
+        output = (rows * mask).sum(axis=-2)
+        error = (errors * mask).sum(axis=-2)
+        if pooling == 'mean':
+            count = onp.maximum(length, 1)[..., None]
+            output = output / count
+            error = error / count
+        assert qoutput.shape == output.shape
+        assert (onp.abs(qoutput.asnumpy() - output) <= error + 1e-5).all()
+
+    for bits in [8, 4]:
+        check_rowwise_quantized_embedding((32,), 1000, 64, bits, 'none', False)
+        check_rowwise_quantized_embedding((4, 5), 100, 33, bits, 'none', False)
+        for pooling in ['sum', 'mean']:
+            check_rowwise_quantized_embedding((16, 8), 1000, 64, bits, pooling, False)
+            check_rowwise_quantized_embedding((16, 8), 1000, 33, bits, pooling, True)
+            check_rowwise_quantized_embedding((2, 3, 4), 100, 16, bits, pooling, True)
+
+
 @use_np
 def test_quantized_flatten():
     def check_quantized_flatten(shape, qdtype):
@@ -825,9 +873,6 @@ def test_quantized_act():
         elif qdtype == 'int8' and is_test_for_mkldnn():
             print('skipped testing quantized_act for mkldnn cpu int8 since it is not supported yet')
             return
-        elif is_test_for_gpu():
-            print('skipped testing quantized_act for gpu since it is not supported yet')
-            return
 
         act_fp32 = mx.gluon.nn.Activation(activation='relu')
 
@@ -871,6 +916,37 @@ def test_quantized_act():
         check_quantized_act((3, 4, 23, 23), qdtype)
 
 
+@use_np
+def test_quantized_concat():
+    def check_quantized_concat(data_shapes, dim, qdtype):
+        if is_test_for_native_cpu():
+            print('skipped testing quantized_concat for native cpu since it is not supported yet')
+            return
+
+        data_low, data_high = (0, 255) if qdtype == 'uint8' else (-127, 127)
+        # the inputs have different ranges, which are rescaled to their union in the output
+        scales = [1.0 + 0.5 * i for i in range(len(data_shapes))]
+        qdata = [mx.np.random.uniform(low=data_low, high=data_high, size=shape).astype(qdtype)
+                 for shape in data_shapes]
+        min_data = [mx.np.array([data_low * scale]) for scale in scales]
+        max_data = [mx.np.array([data_high * scale]) for scale in scales]
+        qoutput, min_range, max_range = npx.quantized_concat(*qdata, *(min_data + max_data),
+                                                             dim=dim, num_args=len(qdata))
+        quantized_range = 255.5 if qdtype == 'uint8' else 127.5
+        data = [d.astype('float32') * max(abs(l.item()), abs(h.item())) / quantized_range
+                for d, l, h in zip(qdata, min_data, max_data)]
+        output = mx.np.concatenate(data, axis=dim)
+        absmax = max(abs(min_range.item()), abs(max_range.item()))
+        assert_almost_equal(min_range.item(), min(data_low * scale for scale in scales))
+        assert_almost_equal(max_range.item(), max(data_high * scale for scale in scales))
+        assert_almost_equal(qoutput.astype('float32') * absmax / quantized_range, output,
+                            rtol=0, atol=absmax / quantized_range)
+
+    for qdtype in ['int8', 'uint8']:
+        check_quantized_concat([(2, 3, 4, 4), (2, 5, 4, 4)], 1, qdtype)
+        check_quantized_concat([(3, 4, 6), (3, 4, 2), (3, 4, 5)], 2, qdtype)
+
+
 @use_np
 def test_quantized_bn():
     def get_mean_var(data):
@@ -1347,3 +1423,101 @@ def test_get_optimal_thresholds():
         assert 'layer1' in min_max_dict
         assert_almost_equal(onp.array([min_max_dict['layer1'][1]]), expected_threshold, rtol=1e-2, atol=1e-4)
 
+
+
+def test_histogram_collector():
+    # the histograms collected on the device of the layer outputs are those of numpy
+    collector = mx.contrib.quant._LayerHistogramCollector('int8', include_layers=['layer1'])
+    arrays = [onp.random.uniform(low=-1, high=1, size=(4, 100)), onp.random.uniform(low=-3, high=2, size=(4, 100))]
+    for arr in arrays:
+        collector.collect('layer1', 'op', mx.nd.array(arr))
+    expected = None
+    for arr in arrays:
+        min_range, max_range = onp.min(arr), onp.max(arr)
+        th = max(abs(min_range), abs(max_range))
+        if expected is None:
+            hist, hist_edges = onp.histogram(arr, bins=8001, range=(-th, th))
+            expected = (hist, hist_edges, min_range, max_range, th)
+        else:
+            expected = collector.combine_histogram(expected, arr, min_range, max_range, th)
+    hist, hist_edges, min_range, max_range, th = collector.hist_dict['layer1']
+    assert hist.sum() == 800
+    assert_almost_equal(hist_edges, expected[1], rtol=1e-5, atol=1e-5)
+    assert_almost_equal(th, expected[4], rtol=1e-5, atol=1e-6)
+    # the bins agree up to the values on their edges
+    assert onp.abs(hist - expected[0]).sum() <= 4
+
+
+@pytest.mark.parametrize('calib_mode', ['percentile', 'mse'])
+def test_histogram_threshold_collector(calib_mode):
+    # most of the values are in [-1, 1], with a few outliers up to 20
+    arr = onp.concatenate([onp.random.uniform(low=-1, high=1, size=(1000000,)), onp.array([-20, 15, 20])])
+    th = 20
+    hist, hist_edges = onp.histogram(arr, bins=8001, range=(-th, th))
+    collector = mx.contrib.quant._LayerHistogramThresholdCollector('int8', calib_mode,
+                                                                   include_layers=['layer1'])
+    collector.hist_dict = {'layer1': (hist, hist_edges, onp.min(arr), onp.max(arr), th)}
+    min_max_dict = collector.post_collect()
+    min_th, max_th = min_max_dict['layer1']
+    assert min_th == -max_th
+    if calib_mode == 'percentile':
+        assert 0.9 < max_th < 1.1
+    else:
+        # the error of clipping the outliers is traded for the resolution of the other values
+        assert 1 < max_th < 10
+
+
+@pytest.mark.parametrize('axis', [None, 1])
+@pytest.mark.parametrize('is_signed', [True, False])
+def test_fake_quantize(axis, is_signed):
+    shape = (2, 3, 4, 5)
+    data = onp.random.uniform(low=-2, high=2, size=shape).astype('float32')
+    if axis is None:
+        scale = onp.array([0.01], dtype='float32')
+        s = scale.reshape(1, 1, 1, 1)
+    else:
+        scale = onp.array([0.005, 0.01, 0.02], dtype='float32')
+        s = scale.reshape(1, 3, 1, 1)
+    qmin, qmax = (-127, 127) if is_signed else (0, 255)
+    v = data / s
+    expected = onp.clip(onp.round(v), qmin, qmax) * s
+    in_range = (v >= qmin) & (v <= qmax)
+    ograd = onp.random.uniform(size=shape).astype('float32')
+    expected_data_grad = ograd * in_range
+    expected_scale_grad = ograd * onp.where(in_range, onp.round(v) - v, onp.clip(v, qmin, qmax))
+    expected_scale_grad = expected_scale_grad.sum(axis=(0, 2, 3)) if axis is not None else expected_scale_grad.sum()
+
+    x, sc = mx.nd.array(data), mx.nd.array(scale)
+    x.attach_grad()
+    sc.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.contrib.fake_quantize(x, sc, axis=axis, is_signed=is_signed)
+    out.backward(mx.nd.array(ograd))
+    assert_almost_equal(out.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+    assert_almost_equal(x.grad.asnumpy(), expected_data_grad, rtol=1e-5, atol=1e-5)
+    assert_almost_equal(sc.grad.asnumpy().reshape(-1), onp.array(expected_scale_grad).reshape(-1),
+                        rtol=1e-3, atol=1e-3)
+
+
+def test_fake_quantize_net():
+    net = mx.gluon.nn.HybridSequential()
+    net.add(mx.gluon.nn.Dense(16, activation='relu'))
+    net.add(mx.gluon.nn.Dense(4))
+    net.initialize()
+    data = mx.nd.random.uniform(low=-1, high=1, shape=(32, 8))
+    calib_data = mx.gluon.data.DataLoader(mx.gluon.data.ArrayDataset(data), batch_size=8)
+    ref_out = net(data)
+
+    fq_net = mx.contrib.quant.fake_quantize_net(net, calib_data, quantize_granularity='channel-wise')
+    scales = {k: v for k, v in fq_net.collect_params().items() if k.endswith('_fq_scale')}
+    # the weights are fake quantized per output channel, the biases are not fake quantized
+    assert sum(v.shape == (16,) for v in scales.values()) == 1
+    assert sum(v.shape == (4,) for v in scales.values()) == 1
+    assert not any('bias' in k for k in scales)
+    assert_almost_equal(fq_net(data).asnumpy(), ref_out.asnumpy(), rtol=0.05, atol=0.05)
+
+    with mx.autograd.record():
+        loss = fq_net(data).sum()
+    loss.backward()
+    for v in scales.values():
+        assert onp.abs(v.grad().asnumpy()).sum() > 0
@@ -584,3 +584,31 @@ def test_retain_grad_drop_grad_gluon():
 
     assert u.grad is None and z.grad is None and y.grad is None
     assert (x.grad == 2 * x * y).all()
+
+
+@use_np
+@pytest.mark.parametrize('head_grad', [False, True])
+def test_backward_repeated_tapes(head_grad):
+    import numpy as onp
+    # the iterations with the tape of an earlier one reuse its gradient graph with their arrays
+    w = mx.np.random.uniform(size=(3, 4))
+    w.attach_grad()
+    dense = mx.gluon.nn.Dense(2, in_units=4)
+    dense.initialize()
+    dense.hybridize()
+    for batch in [5, 5, 7, 5]:
+        x = mx.np.random.uniform(size=(batch, 3))
+        ograd = mx.np.random.uniform(size=(batch, 2)) if head_grad else mx.np.ones((batch, 2))
+        with mx.autograd.record():
+            h = mx.np.tanh(mx.np.dot(x, w))
+            y = dense(h)
+        h.attach_grad()
+        y.backward(ograd if head_grad else None)
+
+        h_np = onp.tanh(onp.dot(x.asnumpy(), w.asnumpy()))
+        h_grad = onp.dot(ograd.asnumpy(), dense.weight.data().asnumpy())
+        assert_almost_equal(h.grad, h_grad, rtol=1e-4, atol=1e-5)
+        assert_almost_equal(w.grad, onp.dot(x.asnumpy().T, h_grad * (1 - h_np ** 2)),
+                            rtol=1e-4, atol=1e-5)
+        assert_almost_equal(dense.weight.grad(), onp.dot(ograd.asnumpy().T, h_np),
+                            rtol=1e-4, atol=1e-5)
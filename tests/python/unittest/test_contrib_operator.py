@@ -200,6 +200,47 @@ def test_box_nms_op():
     test_box_nms_forward(np.array(boxes9), np.array(expected9), force=force, thresh=thresh, bid=background_id)
     test_box_nms_backward(np.array(boxes9), grad9, expected_in_grad9, force=force, thresh=thresh, bid=background_id)
 
+def test_box_nms_large():
+    # several tiles of 64 boxes per batch, against a greedy reference
+    def numpy_box_nms(data, thresh, topk, force):
+        out = np.full(data.shape, -1, dtype=data.dtype)
+        for b, boxes in enumerate(data):
+            order = np.argsort(-boxes[:, 1], kind='stable')[:topk]
+            kept = []
+            for i in order:
+                box = boxes[i]
+                suppressed = False
+                for k in kept:
+                    if not force and boxes[k, 0] != box[0]:
+                        continue
+                    w = min(box[4], boxes[k, 4]) - max(box[2], boxes[k, 2])
+                    h = min(box[5], boxes[k, 5]) - max(box[3], boxes[k, 3])
+                    inter = max(w, 0) * max(h, 0)
+                    area = (box[4] - box[2]) * (box[5] - box[3]) + \
+                           (boxes[k, 4] - boxes[k, 2]) * (boxes[k, 5] - boxes[k, 3])
+                    if inter / (area - inter) > thresh:
+                        suppressed = True
+                        break
+                if not suppressed:
+                    kept.append(i)
+            out[b, :len(kept)] = boxes[kept]
+        return out
+
+    num_batch, num_elem = 3, 300
+    data = np.zeros((num_batch, num_elem, 6), dtype='float32')
+    data[:, :, 0] = np.random.randint(0, 4, size=(num_batch, num_elem))
+    data[:, :, 1] = np.random.permutation(num_batch * num_elem).reshape(num_batch, num_elem) + 1
+    corner = np.random.uniform(0, 10, size=(num_batch, num_elem, 2))
+    size = np.random.uniform(1, 3, size=(num_batch, num_elem, 2))
+    data[:, :, 2:4] = corner
+    data[:, :, 4:6] = corner + size
+    for force, topk in itertools.product([False, True], [-1, 200]):
+        out = mx.contrib.nd.box_nms(mx.nd.array(data), overlap_thresh=0.3, valid_thresh=0,
+                                    topk=topk, coord_start=2, score_index=1, id_index=0,
+                                    force_suppress=force)
+        expected = numpy_box_nms(data, 0.3, num_elem if topk < 0 else topk, force)
+        assert_almost_equal(out.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+
 def test_box_iou_op():
     def numpy_box_iou(a, b, fmt='corner'):
         def area(left, top, right, bottom):
@@ -353,6 +394,61 @@ def test_box_decode_op():
     assert_allclose(Y.asnumpy(), np.array([[[-0.0562755, -0.00865743, 0.26227552, 0.42465743], \
         [0.13240421, 0.17859563, 0.93759584, 1.1174043 ]]]), atol=1e-5, rtol=1e-5)
 
+def test_box_detection_op():
+    def numpy_box_detection(cls_prob, loc_pred, anchors, threshold, nms_threshold, force,
+                            nms_topk, keep_topk, variances=(0.1, 0.1, 0.2, 0.2)):
+        def decode(anchor, loc):
+            aw, ah = anchor[2] - anchor[0], anchor[3] - anchor[1]
+            ax, ay = (anchor[0] + anchor[2]) / 2, (anchor[1] + anchor[3]) / 2
+            ox, oy = loc[0] * variances[0] * aw + ax, loc[1] * variances[1] * ah + ay
+            ow = np.exp(loc[2] * variances[2]) * aw / 2
+            oh = np.exp(loc[3] * variances[3]) * ah / 2
+            return np.clip([ox - ow, oy - oh, ox + ow, oy + oh], 0, 1)
+
+        def iou(a, b):
+            w = max(min(a[2], b[2]) - max(a[0], b[0]), 0)
+            h = max(min(a[3], b[3]) - max(a[1], b[1]), 0)
+            union = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - w * h
+            return w * h / union
+
+        num_batch, num_classes, num_anchors = cls_prob.shape
+        out = np.full((num_batch, keep_topk, 6), -1, dtype=cls_prob.dtype)
+        for b in range(num_batch):
+            cands = []
+            for c in range(1, num_classes):
+                prob = cls_prob[b, c]
+                order = [n for n in np.argsort(-prob, kind='stable') if prob[n] > threshold]
+                for n in order[:nms_topk]:
+                    cands.append([c - 1, prob[n]] + list(decode(anchors[n], loc_pred[b, n])))
+            # candidates by descending score, ties in candidate order
+            order = sorted(range(len(cands)), key=lambda i: -cands[i][1])
+            kept = []
+            for i in order:
+                if all(not (force or cands[k][0] == cands[i][0]) or
+                       iou(cands[k][2:], cands[i][2:]) <= nms_threshold for k in kept):
+                    kept.append(i)
+            kept = sorted(kept, key=lambda i: (-cands[i][1], i))[:keep_topk]
+            if kept:
+                out[b, :len(kept)] = np.array([cands[i] for i in kept])
+        return out
+
+    num_batch, num_classes, num_anchors = 2, 4, 300
+    logits = np.random.uniform(-3, 3, size=(num_batch, num_classes, num_anchors))
+    cls_prob = (np.exp(logits) / np.exp(logits).sum(axis=1, keepdims=True)).astype('float32')
+    corner = np.random.uniform(0, 0.8, size=(num_anchors, 2))
+    anchors = np.concatenate([corner, corner + np.random.uniform(0.05, 0.2, size=(num_anchors, 2))],
+                             axis=1).astype('float32')
+    loc_pred = np.random.normal(0, 0.5, size=(num_batch, num_anchors, 4)).astype('float32')
+    for force, nms_topk, keep_topk in [(False, 400, 100), (True, 50, 20), (False, -1, 500)]:
+        out = mx.nd.contrib.box_detection(
+            mx.nd.array(cls_prob), mx.nd.array(loc_pred.reshape((num_batch, -1))),
+            mx.nd.array(anchors.reshape((1, -1, 4))), threshold=0.3, nms_threshold=0.45,
+            force_suppress=force, nms_topk=nms_topk, keep_topk=keep_topk)
+        assert out.shape == (num_batch, keep_topk, 6)
+        expected = numpy_box_detection(cls_prob, loc_pred, anchors, 0.3, 0.45, force,
+                                       num_anchors if nms_topk < 0 else nms_topk, keep_topk)
+        assert_almost_equal(out.asnumpy(), expected, rtol=1e-5, atol=1e-5)
+
 def test_op_mrcnn_mask_target():
     if default_context().device_type != 'gpu':
         return
@@ -454,6 +550,19 @@ def test_dynamic_reshape():
     for test_case in test_cases:
         dynamic_reshape_testcases(*test_case)
 
+def test_collectives_shapes():
+    # a single rank is the identity, the shapes of more split the first axis
+    x = mx.nd.random.uniform(shape=(4, 3))
+    for op in [mx.nd.contrib.allreduce, mx.nd.contrib.allgather, mx.nd.contrib.reduce_scatter]:
+        assert_almost_equal(op(x, num_ranks=1), x)
+    data = mx.sym.var('data')
+    _, out, _ = mx.sym.contrib.allgather(data, num_ranks=4).infer_shape(data=(2, 3))
+    assert out == [(8, 3)]
+    _, out, _ = mx.sym.contrib.reduce_scatter(data, num_ranks=4).infer_shape(data=(8, 3))
+    assert out == [(2, 3)]
+    args, _, _ = mx.sym.contrib.allgather(data, num_ranks=4).infer_shape_partial()
+    assert args == [()]
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
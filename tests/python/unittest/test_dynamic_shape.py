@@ -152,3 +152,67 @@ def test_dynamic_shape_backward():
         assert_almost_equal(result.asnumpy(), result_nd)
         assert_almost_equal(data.grad.asnumpy(), data_grad_nd)
 
+
+@mx.util.use_np
+def test_dynamic_shape_pipeline():
+    # test the dispatch of the independent ops before the dynamic shapes are known
+    class _TestBlock(gluon.HybridBlock):
+        def __init__(self):
+            super(_TestBlock, self).__init__()
+
+        def forward(self, data, index):
+            masked = _npi.boolean_mask(data, index)
+            again = _npi.boolean_mask(data * 2, index)
+            return mx.np.sum(masked, axis=0) + mx.np.sum(again), data * 3
+
+    data = mx.np.array([[1, 2, 3],[4, 5, 6],[7, 8, 9]])
+    index = mx.np.array([0, 1, 1])
+    results = []
+    for pipeline in ['0', '1']:
+        with environment('MXNET_DYNAMIC_SHAPE_PIPELINE', pipeline):
+            block = _TestBlock()
+            block.hybridize()
+            x = data.copy()
+            x.attach_grad()
+            with mx.autograd.record():
+                out, other = block(x, index)
+            out.backward()
+            results.append([out.asnumpy(), other.asnumpy(), x.grad.asnumpy()])
+    for ref, res in zip(*results):
+        assert_almost_equal(ref, res)
+    assert_almost_equal(results[1][0], np.array([11., 13., 15.]) + 78)
+
+
+@mx.util.use_np
+def test_dynamic_shape_static_subgraph_aot():
+    # the static shape subgraphs around the dynamic shape op are specialized ahead of time
+    class _TestBlock(gluon.HybridBlock):
+        def __init__(self):
+            super(_TestBlock, self).__init__()
+
+        def forward(self, data, index):
+            scaled = mx.np.exp(data * 0.5) + 1
+            masked = _npi.boolean_mask(scaled, index)
+            return mx.np.sum(mx.np.tanh(masked) * 2 - 1, axis=1)
+
+    data = mx.np.random.uniform(size=(4, 3))
+    results = []
+    for aot in ['0', '1']:
+        with environment('MXNET_STATIC_SHAPE_SUBGRAPH_AOT', aot):
+            block = _TestBlock()
+            block.hybridize()
+            outs = []
+            # the shape of the last subgraph changes with the mask and comes back
+            for mask in [[0, 1, 1, 0], [1, 1, 1, 1], [0, 1, 1, 0]]:
+                x = data.copy()
+                x.attach_grad()
+                with mx.autograd.record():
+                    out = block(x, mx.np.array(mask))
+                out.backward()
+                outs.append([out.asnumpy(), x.grad.asnumpy()])
+            results.append(outs)
+    for ref, res in zip(*results):
+        assert_almost_equal(ref[0], res[0])
+        assert_almost_equal(ref[1], res[1])
+    expected = (np.tanh(np.exp(data.asnumpy() * 0.5) + 1) * 2 - 1).sum(axis=1)
+    assert_almost_equal(results[1][1][0], expected)
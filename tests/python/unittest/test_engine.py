@@ -32,6 +32,29 @@ def test_bulk():
             x += 1
     assert (x.asnumpy() == 104).all()
 
+def test_adaptive_bulk_stats():
+    before = mx.engine.adaptive_bulk_stats()
+    x = mx.nd.ones((10,))
+    for _ in range(20):
+        x += 1
+    assert (x.asnumpy() == 21).all()
+    after = mx.engine.adaptive_bulk_stats()
+    for key in ('merged', 'bulks', 'timed'):
+        assert after[key] >= before[key]
+    assert after['merged'] - before['merged'] <= 20
+
+def test_priority():
+    prev = mx.engine.set_priority(0)
+    with mx.engine.priority(10):
+        assert mx.engine.set_priority(10) == 10
+        x = mx.nd.ones((10,))
+        x += 1
+        with mx.engine.priority(-5):
+            x *= 2
+        assert mx.engine.set_priority(10) == 10
+    assert mx.engine.set_priority(prev) == 0
+    assert (x.asnumpy() == 4).all()
+
 @pytest.mark.skip(reason="OMP platform dependent")
 def test_engine_openmp_after_fork():
     """
@@ -69,3 +92,52 @@ def test_engine_openmp_after_fork():
             print("Child omp max threads: {}".format(omp_max_threads))
             assert omp_max_threads == 1
 
+
+@pytest.mark.skipif(not hasattr(os, 'fork'), reason="no fork")
+def test_engine_inline_after_fork():
+    # the forked child runs its operators inline, see MXNET_MP_WORKER_INLINE_ENGINE
+    x = mx.nd.ones((10,))
+    x.wait_to_read()
+    pid = os.fork()
+    if pid == 0:
+        status = 1
+        try:
+            y = x.copy()
+            for _ in range(10):
+                y += 1
+            z = mx.nd.dot(y.reshape((1, 10)), y.reshape((10, 1)))
+            if (y.asnumpy() == 11).all() and z.asscalar() == 1210:
+                status = 0
+        finally:
+            os._exit(status)
+    x += 1
+    assert (x.asnumpy() == 2).all()
+    _, status = os.waitpid(pid, 0)
+    assert os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+
+def test_tape():
+    def step(x, w):
+        y = mx.nd.dot(x, w)
+        y = mx.nd.relu(y) + 1
+        return y.sum()
+
+    x = mx.nd.ones((4, 3))
+    w = mx.nd.ones((3, 2))
+    expected = step(x, w).asscalar()
+    before = mx.engine.tape_stats()
+    for _ in range(5):
+        with mx.engine.tape():
+            out = step(x, w)
+        assert out.asscalar() == expected
+    after = mx.engine.tape_stats()
+    assert after['recorded'] > before['recorded']
+    assert after['reused'] > before['reused']
+    # a different sequence is recorded again
+    with mx.engine.tape():
+        out = (x * 2).sum()
+    assert out.asscalar() == 24
+    with mx.engine.tape():
+        with pytest.raises(RuntimeError):
+            with mx.engine.tape():
+                pass
+    mx.engine.clear_tape()
@@ -1051,6 +1051,68 @@ def test_import():
     assert lines[2] == ')'
 
 
+@use_np
+@pytest.mark.parametrize('param_dtype', ['float16', 'bfloat16'])
+def test_export_param_dtype(tmpdir, param_dtype):
+    net1 = nn.HybridSequential()
+    net1.add(nn.Dense(8, activation='relu'), nn.Dense(4))
+    net1.initialize()
+    net1.hybridize()
+    data = mx.np.random.normal(size=(2, 5))
+    out1 = net1(data)
+
+    path = os.path.join(str(tmpdir), 'typed')
+    sym_file, params_file = net1.export(path, param_dtype=param_dtype)
+    saved = mx.npx.load(params_file)
+    info = json.loads(saved.pop('__param_dtype__').asnumpy().tobytes().decode('utf-8'))
+    assert info['dtype'] == param_dtype
+    dtype = onp.dtype(onp.float16) if param_dtype == 'float16' else \
+        onp.dtype([('bfloat16', onp.uint16)])
+    weights = [k for k in saved if k.endswith('weight')]
+    assert len(weights) == 2
+    assert all(onp.dtype(saved[k].dtype) == dtype for k in weights)
+
+    # the graph is converted for the parameters, which are loaded as saved
+    net2 = gluon.SymbolBlock.imports(sym_file, ['data'], params_file)
+    assert 'amp_cast' in net2._cached_graph[1].tojson(remove_amp_cast=False)
+    for name, param in net2.collect_params().items():
+        if name.endswith('weight'):
+            assert onp.dtype(param.dtype) == dtype
+    if param_dtype == 'float16' and mx.context.current_context().device_type == 'gpu':
+        assert_almost_equal(net2(data), out1, rtol=1e-2, atol=1e-2)
+
+    with pytest.raises(ValueError):
+        net1.export(path, param_dtype='int4')
+
+
+@use_np
+def test_export_compiled(tmpdir):
+    net1 = nn.HybridSequential()
+    net1.add(nn.Conv2D(4, kernel_size=3, activation='relu'), nn.BatchNorm(), nn.Dense(6))
+    net1.initialize()
+    net1.hybridize(static_alloc=True, shape_cache_size=2)
+    data = mx.np.random.normal(size=(2, 3, 8, 8))
+    out1 = net1(data)
+
+    path = os.path.join(str(tmpdir), 'compiled.npz')
+    assert net1.export_compiled(path, data) == path
+    net2 = gluon.SymbolBlock.imports_compiled(path)
+    assert ('static_alloc', True) in net2._flags
+    assert ('shape_cache_size', 2) in net2._flags
+    assert_almost_equal(net2(data), out1, rtol=1e-5, atol=1e-6)
+
+    # an archive of another version is built again, with the same results
+    arrays = mx.npx.load(path)
+    manifest = json.loads(arrays['__manifest__'].asnumpy().tobytes().decode('utf-8'))
+    manifest['version'] = '0.0.0'
+    arrays['__manifest__'] = mx.np.array(
+        onp.frombuffer(json.dumps(manifest).encode('utf-8'), dtype=onp.uint8), dtype=onp.uint8)
+    mx.npx.savez(path, **arrays)
+    with pytest.warns(UserWarning, match='0.0.0'):
+        net3 = gluon.SymbolBlock.imports_compiled(path, warmup=False)
+    assert_almost_equal(net3(data), out1, rtol=1e-5, atol=1e-6)
+
+
 def test_hybrid_stale_cache():
     net = mx.gluon.nn.HybridSequential()
     net.add(mx.gluon.nn.Dense(10, weight_initializer='zeros', bias_initializer='ones', flatten=False))
@@ -1521,6 +1583,68 @@ def test_hybrid_static_memory_switching(static_alloc, static_shape):
         y.backward()
     mx.npx.waitall()
 
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_hybrid_shape_cache(static_alloc):
+    net = nn.Dense(4, flatten=False)
+    net.initialize()
+    inputs = [mx.np.random.uniform(size=(2, length, 3)) for length in (3, 5, 3, 7, 5)]
+    expected = [net(x) for x in inputs]
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc, shape_cache_size=2)
+    for _ in range(2):
+        for x, y in zip(inputs, expected):
+            with mx.autograd.record():
+                out = net(x)
+            out.backward()
+            assert_almost_equal(out.asnumpy(), y.asnumpy(), rtol=1e-5, atol=1e-6)
+
+
+def test_hybrid_pad_to_bucket():
+    net = nn.Dense(4, flatten=False)
+    net.initialize()
+    x = mx.np.random.uniform(size=(2, 5, 3))
+    y = net(x)
+    net.hybridize(pad_to_bucket='pow2')
+    out = net(x)
+    assert out.shape == (2, 8, 4)
+    assert_almost_equal(out[:, :5].asnumpy(), y.asnumpy(), rtol=1e-5, atol=1e-6)
+    net.hybridize(pad_to_bucket=[4, 6])
+    assert net(x).shape == (2, 6, 4)
+    assert net(mx.np.ones((2, 7, 3))).shape == (2, 7, 4)
+
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+@pytest.mark.parametrize('recompute,budget', [('sqrt', None), ('budget', 0.0001)])
+def test_hybrid_recompute(static_alloc, recompute, budget):
+    class Net(gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.dense0 = nn.Dense(8)
+            self.dense1 = nn.Dense(8)
+
+        def forward(self, x):
+            h = mx.np.tanh(self.dense0(x))
+            h = mx.np.exp(h) * mx.np.sin(h) + mx.npx.sigmoid(h)
+            return self.dense1(mx.npx.relu(h * h))
+
+    def run(net):
+        x = mx.np.linspace(-1, 1, 24).reshape((3, 8))
+        x.attach_grad()
+        with mx.autograd.record():
+            y = net(x)
+        y.backward()
+        return y.asnumpy(), x.grad.asnumpy(), net.dense0.weight.grad().asnumpy()
+
+    net = Net()
+    net.initialize(mx.init.Uniform())
+    expected = run(net)
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc,
+                  recompute=recompute, recompute_budget_mb=budget)
+    for _ in range(2):
+        for a, e in zip(run(net), expected):
+            assert_almost_equal(a, e, rtol=1e-5, atol=1e-6)
+
+
 def test_hook():
     global hook_call_count
     hook_call_count = 0
@@ -1623,6 +1747,47 @@ def test_op_hook_output_names():
                 'node_5_bias', 'node_5_output',
                 'node_6_input0', 'node_6_output'], monitor_all=True)
 
+@use_np
+@pytest.mark.parametrize('bins', [0, 4])
+def test_tensor_stats_monitor(bins):
+    from mxnet.gluon.contrib.monitor import TensorStatsMonitor
+    model = mx.gluon.nn.HybridSequential()
+    model.add(mx.gluon.nn.Dense(3))
+    model.initialize()
+    model.hybridize()
+    monitor = TensorStatsMonitor(interval=2, pattern='.*output', bins=bins, hist_range=(-2, 2))
+    monitor.install(model)
+
+    inputs = [mx.np.random.uniform(-1, 1, (2, 5)), mx.np.random.uniform(-1, 1, (4, 5))]
+    inputs[1][0, 0] = onp.nan
+    outputs = []
+    for i, x in enumerate(inputs):
+        outputs.append(model(x).asnumpy().reshape(-1))
+        stats = monitor.step()
+        assert (stats is None) == (i == 0)
+    assert len(stats) == 1
+    stats = list(stats.values())[0]
+    expected = onp.concatenate(outputs)
+    finite = expected[~onp.isnan(expected)]
+    assert stats['count'] == expected.size
+    assert stats['nan_count'] == onp.isnan(expected).sum() == 3
+    assert onp.isnan(stats['min']) and onp.isnan(stats['max']) and onp.isnan(stats['mean'])
+    if bins:
+        assert_almost_equal(stats['histogram'], onp.histogram(finite, bins=bins, range=(-2, 2))[0])
+    else:
+        assert 'histogram' not in stats
+    assert monitor.stats() == {}
+
+    # without NaN
+    model(inputs[0])
+    assert monitor.step() is None
+    model(inputs[0])
+    stats = list(monitor.step().values())[0]
+    assert stats['nan_count'] == 0
+    assert_almost_equal(stats['min'], outputs[0].min())
+    assert_almost_equal(stats['max'], outputs[0].max())
+    assert_almost_equal(stats['mean'], outputs[0].mean())
+
 def test_apply():
     global called_blocks
     called_blocks = []
@@ -1730,6 +1895,64 @@ def test_hybrid_static_memory_recording():
     net(x)
 
 
+@use_np
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_hybrid_slice_views(static_alloc):
+    class SplitBlock(gluon.HybridBlock):
+        def forward(self, x):
+            # the splits along the first axis are placed in the memory of the output of exp
+            a, b, c = mx.np.split(mx.np.exp(x), 3, axis=0)
+            d, e = mx.np.array_split(a * 2, 2, axis=0)
+            return b * c + mx.np.concatenate([e, d], axis=0), mx.np.split(x, 2, axis=1)[1] + 1
+
+    net = SplitBlock()
+    x = mx.np.random.uniform(size=(6, 4, 5))
+    x.attach_grad()
+    with mx.autograd.record():
+        expected = net(x)
+        mx.autograd.backward(expected)
+    expected_grad = x.grad.copy()
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc)
+    for _ in range(2):
+        assert_almost_equal(net(x)[0], expected[0], rtol=1e-5, atol=1e-6)
+        with mx.autograd.record():
+            out = net(x)
+            mx.autograd.backward(out)
+        for o, e in zip(out, expected):
+            assert_almost_equal(o, e, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(x.grad, expected_grad, rtol=1e-5, atol=1e-6)
+
+
+@use_np
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_hybrid_concat_views(static_alloc):
+    class ConcatBlock(gluon.HybridBlock):
+        def forward(self, x):
+            # exp, tanh and the inner concatenate write their outputs in the memory of the outer one
+            a = mx.np.concatenate([mx.np.exp(x), mx.np.tanh(x)], axis=0)
+            b = mx.np.concatenate([a, x * 2, mx.np.sin(x)], axis=None)
+            # concatenating along the second axis of x copies the inputs
+            return b + 1, mx.np.concatenate([mx.np.cos(x), x], axis=1)
+
+    net = ConcatBlock()
+    x = mx.np.random.uniform(size=(3, 4, 5))
+    x.attach_grad()
+    with mx.autograd.record():
+        expected = net(x)
+        mx.autograd.backward(expected)
+    expected_grad = x.grad.copy()
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc)
+    for _ in range(2):
+        for o, e in zip(net(x), expected):
+            assert_almost_equal(o, e, rtol=1e-5, atol=1e-6)
+        with mx.autograd.record():
+            out = net(x)
+            mx.autograd.backward(out)
+        for o, e in zip(out, expected):
+            assert_almost_equal(o, e, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(x.grad, expected_grad, rtol=1e-5, atol=1e-6)
+
+
 @use_np
 def test_share_inputs_outputs():
     class TestIOBackward(gluon.HybridBlock):
@@ -3157,3 +3380,292 @@ def test_pixelshuffle3d():
             [64, 88, 65, 89, 66, 90, 67, 91],
             [68, 92, 69, 93, 70, 94, 71, 95]]]]]
     )
+
+@pytest.mark.parametrize('dtype', ['float16', 'float32', 'float64'])
+@pytest.mark.parametrize('y_shape', [(5, 1000), (1, 1000)])
+def test_cpu_pointwise_fusion(dtype, y_shape):
+    class Pointwise(gluon.HybridBlock):
+        def forward(self, x, y):
+            z = mx.npx.relu(x * y + 1) - mx.np.tanh(x) * 2
+            return mx.npx.sigmoid(z), mx.np.exp(-z) / 4
+
+    x = mx.np.random.uniform(-1, 1, size=(5, 1000)).astype(dtype)
+    y = mx.np.random.uniform(-1, 1, size=y_shape).astype(dtype)
+    outputs = {}
+    for fusion in ['0', '1']:
+        with environment('MXNET_USE_FUSION_CPU', fusion):
+            net = Pointwise()
+            net.hybridize(static_alloc=True)
+            xg, yg = x.copy(), y.copy()
+            xg.attach_grad()
+            yg.attach_grad()
+            with mx.autograd.record():
+                out = net(xg, yg)
+                loss = out[0].sum() + out[1].sum()
+            loss.backward()
+            outputs[fusion] = [out[0], out[1], xg.grad, yg.grad]
+    rtol = 1e-2 if dtype == 'float16' else 1e-5
+    atol = 1e-3 if dtype == 'float16' else 1e-6
+    for orig, fused in zip(outputs['0'], outputs['1']):
+        assert_allclose(orig.asnumpy(), fused.asnumpy(), rtol=rtol, atol=atol)
+
+def test_parallel_infer_graph_attr():
+    class Wide(gluon.HybridBlock):
+        def __init__(self, num_branches):
+            super().__init__()
+            self.branches = gluon.nn.HybridSequential()
+            for i in range(num_branches):
+                self.branches.add(gluon.nn.Dense(i % 4 + 1, activation='relu'))
+
+        def forward(self, x):
+            return mx.np.concatenate([branch(x) * 2 for branch in self.branches], axis=1)
+
+    x = mx.np.random.uniform(-1, 1, size=(3, 7))
+    outputs, shapes = {}, {}
+    for parallel in ['0', '1']:
+        with environment('MXNET_INFER_GRAPH_ATTR_PARALLEL', parallel):
+            net = Wide(64)
+            net.initialize(mx.init.One())
+            net.hybridize()
+            outputs[parallel] = net(x)
+            shapes[parallel] = [p.shape for p in net.collect_params().values()]
+    assert shapes['0'] == shapes['1']
+    assert_allclose(outputs['0'].asnumpy(), outputs['1'].asnumpy())
+
+@use_np
+@pytest.mark.parametrize('k', [1, 3])
+def test_adaptive_softmax(k):
+    in_units, num_classes, cutoffs = 16, 50, [5, 20]
+    net = nn.AdaptiveSoftmax(in_units, num_classes, cutoffs, div_value=2.0)
+    net.initialize(init.Uniform(1))
+    x = mx.np.random.uniform(-1, 1, size=(32, in_units))
+    # labels in the shortlist and in the clusters
+    label = mx.np.array(onp.concatenate([onp.random.randint(0, 5, size=8),
+                                         onp.random.randint(0, num_classes, size=24)]))
+    log_prob = net.log_prob(x)
+    assert log_prob.shape == (32, num_classes)
+    assert_almost_equal(mx.np.exp(log_prob).sum(axis=-1), mx.np.ones(32), rtol=1e-5, atol=1e-5)
+
+    params = list(net.collect_params().values())
+    grads = {}
+    for name, loss_fn in [('forward', lambda: net(x, label)),
+                          ('log_prob', lambda: -mx.npx.pick(net.log_prob(x), label, axis=-1))]:
+        with mx.autograd.record():
+            loss = loss_fn()
+        loss.backward()
+        grads[name] = (loss, [p.grad().copy() for p in params])
+    assert_almost_equal(grads['forward'][0], grads['log_prob'][0], rtol=1e-5, atol=1e-5)
+    for grad, expected in zip(grads['forward'][1], grads['log_prob'][1]):
+        assert_almost_equal(grad, expected, rtol=1e-5, atol=1e-5)
+
+    values, classes = net.topk(x, k=k)
+    expected_values, expected_classes = mx.npx.topk(log_prob, k=k, ret_typ='both', dtype='int64')
+    assert_almost_equal(values, expected_values, rtol=1e-5, atol=1e-5)
+    assert_array_equal(classes.asnumpy(), expected_classes.asnumpy())
+
+@pytest.mark.parametrize('no_bias', [False, True])
+def test_grouped_fully_connected(no_bias):
+    class Branches(gluon.HybridBlock):
+        def __init__(self, sizes):
+            super().__init__()
+            self.branches = gluon.nn.HybridSequential()
+            for size in sizes:
+                self.branches.add(gluon.nn.Dense(size, use_bias=not no_bias, flatten=False))
+            self.head = gluon.nn.Dense(2, use_bias=not no_bias, flatten=False)
+
+        def forward(self, x):
+            y = mx.np.concatenate([mx.npx.relu(branch(x)) for branch in self.branches], axis=-1)
+            return self.head(y)
+
+    x = mx.np.random.uniform(-1, 1, size=(2, 3, 5))
+    outputs = {}
+    for grouped in ['0', '1']:
+        with environment('MXNET_USE_GROUPED_FC', grouped):
+            mx.random.seed(1234)
+            net = Branches([3, 3, 4, 1])
+            net.initialize()
+            net.hybridize()
+            xg = x.copy()
+            xg.attach_grad()
+            with mx.autograd.record():
+                out = net(xg)
+            out.backward()
+            outputs[grouped] = [out, xg.grad] + [p.grad() for p in net.collect_params().values()]
+    for orig, grouped in zip(outputs['0'], outputs['1']):
+        assert_allclose(orig.asnumpy(), grouped.asnumpy(), rtol=1e-5, atol=1e-6)
+
+def test_fused_add_dropout_layer_norm():
+    class Block(gluon.HybridBlock):
+        def __init__(self):
+            super().__init__()
+            self.post_norm = gluon.nn.LayerNorm(epsilon=1e-3)
+            self.pre_norm = gluon.nn.LayerNorm()
+
+        def forward(self, x, y):
+            h = self.post_norm(mx.npx.dropout(x, p=0.3) + y)
+            # the sum is also used after the normalization
+            s = h + x
+            return self.pre_norm(s) * s
+
+    x = mx.np.random.uniform(-1, 1, size=(2, 3, 8))
+    y = mx.np.random.uniform(-1, 1, size=(2, 3, 8))
+    outputs = {}
+    for fused in ['0', '1']:
+        with environment('MXNET_USE_FUSED_LAYER_NORM', fused):
+            net = Block()
+            net.initialize()
+            net.hybridize()
+            xs = [x.copy(), y.copy()]
+            for a in xs:
+                a.attach_grad()
+            # the dropout is only applied in training, and the fused one draws other masks
+            with mx.autograd.record(train_mode=False):
+                out = net(*xs)
+            out.backward()
+            outputs[fused] = [out] + [a.grad for a in xs] + [p.grad() for p in net.collect_params().values()]
+    for orig, fused in zip(outputs['0'], outputs['1']):
+        assert_allclose(orig.asnumpy(), fused.asnumpy(), rtol=1e-4, atol=1e-5)
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_fold_constants(static_alloc):
+    class Folded(gluon.HybridBlock):
+        def __init__(self):
+            super().__init__()
+            self.weight = gluon.Parameter('weight', shape=(4, 6))
+            self.scale = gluon.Parameter('scale', shape=(4, 1))
+
+        def forward(self, x):
+            w = (self.weight.data() * self.scale.data()).T
+            return mx.np.dot(x, w) + mx.np.ones((1, 4)) * 2
+
+    x = mx.np.random.uniform(size=(3, 6))
+    net = Folded()
+    net.initialize()
+    expected = net(x)
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc, fold_constants=True)
+    assert_allclose(net(x).asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-6)
+    assert_allclose(net(x).asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-6)
+    # the folded constants follow the updates of the parameters, training runs the whole graph
+    net.scale.data()[:] = 3
+    with mx.autograd.record():
+        recorded = net(x)
+    assert not onp.allclose(recorded.asnumpy(), expected.asnumpy())
+    assert_allclose(net(x).asnumpy(), recorded.asnumpy(), rtol=1e-5, atol=1e-6)
+
+class _TwoHeads(gluon.HybridBlock):
+    def __init__(self):
+        super().__init__()
+        self.hidden = nn.Dense(8, activation='relu')
+        self.dropout = nn.Dropout(0.5)
+        self.out = nn.Dense(3)
+        self.aux = nn.Dense(2)
+
+    def forward(self, x):
+        h = self.dropout(self.hidden(x))
+        return self.out(mx.npx.stop_gradient(h)), self.aux(h)
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_prune_for_inference(static_alloc):
+    x = mx.np.random.uniform(size=(4, 5))
+    net = _TwoHeads()
+    net.initialize()
+    expected = net(x)
+    net.hybridize(static_alloc=static_alloc, static_shape=static_alloc, prune_for_inference=True)
+    for _ in range(2):
+        for out, ref in zip(net(x), expected):
+            assert_allclose(out.asnumpy(), ref.asnumpy(), rtol=1e-5, atol=1e-6)
+    # training runs the dropouts
+    with mx.autograd.record():
+        trained = net(mx.np.ones((64, 5)))
+    with mx.autograd.predict_mode():
+        inferred = net(mx.np.ones((64, 5)))
+    assert not onp.allclose(trained[1].asnumpy(), inferred[1].asnumpy())
+
+def test_export_prune_for_inference(tmpdir):
+    x = mx.np.random.uniform(size=(4, 5))
+    net1 = _TwoHeads()
+    net1.initialize()
+    net1.hybridize()
+    expected = net1(x)
+
+    path = os.path.join(str(tmpdir), 'pruned')
+    sym_file, params_file = net1.export(path, prune_for_inference=True, outputs=0)
+    with open(sym_file) as f:
+        ops = {node['op'] for node in json.load(f)['nodes']}
+    assert 'Dropout' not in ops and 'BlockGrad' not in ops
+    assert not any('aux.' in k for k in mx.npx.load(params_file))
+    net2 = gluon.SymbolBlock.imports(sym_file, ['data'], params_file)
+    assert_allclose(net2(x).asnumpy(), expected[0].asnumpy(), rtol=1e-5, atol=1e-6)
+
+    # the dropouts of the exported graph are kept for training
+    sym_file, _ = net1.export(path)
+    with open(sym_file) as f:
+        assert 'Dropout' in {node['op'] for node in json.load(f)['nodes']}
+    with pytest.raises(ValueError):
+        net1.export(path, outputs=0)
+
+@pytest.mark.parametrize('static_shape', [False, True])
+def test_share_static_alloc(static_shape):
+    def make_net(hidden):
+        net = nn.HybridSequential()
+        net.add(nn.Dense(hidden, activation='relu'), nn.Dense(hidden * 2, activation='tanh'), nn.Dense(3))
+        net.initialize()
+        return net
+
+    # the models of different sizes borrow the same memory, the later larger ones grow it
+    nets = [make_net(hidden) for hidden in [4, 16, 8, 32]]
+    x = mx.np.random.uniform(size=(5, 7))
+    expected = [net(x).asnumpy() for net in nets]
+    for net in nets:
+        net.hybridize(static_alloc=True, static_shape=static_shape, share_static_alloc=True)
+    for _ in range(3):
+        outputs = [net(x) for net in nets]
+        for out, ref in zip(outputs, expected):
+            assert_allclose(out.asnumpy(), ref, rtol=1e-5, atol=1e-6)
+    # training keeps its own memory for the backward pass
+    with mx.autograd.record():
+        out = nets[0](x)
+    out.backward()
+    assert_allclose(out.asnumpy(), expected[0], rtol=1e-5, atol=1e-6)
+
+
+def test_pipeline_schedule():
+    from mxnet.gluon.contrib.pipeline import pipeline_schedule
+    order = pipeline_schedule(3, 4)
+    assert len(set(order)) == len(order) == 24
+    # the first stage runs two forward passes ahead, then alternates
+    assert [(f, m) for s, f, m in order if s == 0] == \
+        [(True, 0), (True, 1), (True, 2), (False, 0), (True, 3), (False, 1), (False, 2), (False, 3)]
+    for i, (s, f, m) in enumerate(order):
+        dep = (s - 1, True, m) if f else ((s, True, m) if s == 2 else (s + 1, False, m))
+        assert s == 0 and f or dep in order[:i]
+
+
+@use_np
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_pipeline_parallel(hybridize):
+    from mxnet.gluon.contrib.pipeline import PipelineParallel
+    ctxs = [mx.cpu(0), mx.cpu(1)]
+    stages = [nn.Dense(8, activation='relu', in_units=5), nn.Dense(3, in_units=8)]
+    pipe = PipelineParallel(stages, ctxs, num_micro_batches=3)
+    pipe.initialize()
+    if hybridize:
+        for stage in stages:
+            stage.hybridize()
+    loss_fn = gluon.loss.L2Loss()
+    x = mx.np.random.uniform(size=(7, 5))
+    y = mx.np.random.uniform(size=(7, 3))
+    losses = pipe.train_step(x, y, loss_fn)
+    assert len(losses) == 3
+    grads = [p.grad(p.list_ctx()[0]).asnumpy() for p in pipe.collect_params().values()]
+
+    # the whole batch without micro-batches gives the same gradients
+    pipe.zero_grad()
+    with mx.autograd.record():
+        out = stages[1](stages[0](x).as_in_ctx(ctxs[1]))
+        loss = loss_fn(out, y.as_in_ctx(ctxs[1]))
+    loss.backward()
+    assert_allclose(mx.np.concatenate(losses).asnumpy(), loss.asnumpy(), rtol=1e-5, atol=1e-6)
+    for g, p in zip(grads, pipe.collect_params().values()):
+        assert_allclose(g, p.grad(p.list_ctx()[0]).asnumpy(), rtol=1e-5, atol=1e-6)
+    assert_allclose(pipe(x).asnumpy(), out.asnumpy(), rtol=1e-5, atol=1e-6)
@@ -17,6 +17,7 @@
 
 import copy
 import numpy as np
+import pytest
 import mxnet as mx
 from mxnet import gluon
 from mxnet.test_utils import *
@@ -692,3 +693,40 @@ def test_rnn():
     for cell_type, num_states in cell_types:
         check_rnn(cell_type, num_states)
 
+
+class WhileLayer(gluon.HybridBlock):
+    def __init__(self, hidden_size):
+        super(WhileLayer, self).__init__()
+        self.dense = gluon.nn.Dense(hidden_size, in_units=hidden_size, activation='tanh')
+
+    def forward(self, state):
+        return mx.npx.while_loop(
+            cond=lambda i, s: i < 7,
+            func=lambda i, s: ([self.dense(s)], [i + 1, self.dense(s)]),
+            loop_vars=[mx.np.zeros((1,)), state],
+            max_iterations=10)
+
+@mx.util.use_np
+@pytest.mark.parametrize('cell_type', [gluon.rnn.RNNCell, gluon.rnn.LSTMCell, gluon.rnn.GRUCell])
+def test_static_loop_body(cell_type):
+    rnn_data = mx.np.random.normal(loc=0, scale=1, size=(6, 4, 8))
+    states = [mx.np.random.normal(loc=0, scale=1, size=(4, 16))
+              for _ in range(2 if cell_type is gluon.rnn.LSTMCell else 1)]
+    layer = RNNLayer(cell_type, 16)
+    layer.infer_shape(rnn_data)
+    layer.initialize(ctx=default_context())
+    while_layer = WhileLayer(16)
+    while_layer.initialize(ctx=default_context())
+    expected = [layer(rnn_data, states), while_layer(states[0])[1][1]]
+    # the body runs static for inference, as recorded for training
+    with environment('MXNET_STATIC_LOOP_BODY', '1'):
+        for net in [layer, while_layer]:
+            net.hybridize(static_alloc=True)
+        for _ in range(2):
+            outputs = [layer(rnn_data, states), while_layer(states[0])[1][1]]
+            for out, ref in zip(outputs, expected):
+                assert_almost_equal(out.asnumpy(), ref.asnumpy(), rtol=1e-4, atol=1e-4)
+        with mx.autograd.record():
+            out = layer(rnn_data, states)
+        out.backward()
+        assert_almost_equal(out.asnumpy(), expected[0].asnumpy(), rtol=1e-4, atol=1e-4)
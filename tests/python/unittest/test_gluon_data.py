@@ -87,6 +87,45 @@ def test_recordimage_dataset_handle(prepare_record):
         assert x.shape[0] == 1 and x.shape[3] == 3
         assert y.item() == i
 
+def test_recordimage_dataset_mmap(prepare_record):
+    recfile = prepare_record
+    dataset = gluon.data.vision.ImageRecordDataset(recfile).__mx_handle__()
+    mapped = gluon.data.vision.ImageRecordDataset(recfile, use_mmap=True).__mx_handle__()
+    assert len(mapped) == len(dataset)
+    for i in random.sample(range(len(dataset)), len(dataset)):
+        x, y = mapped[i]
+        np.testing.assert_equal(x.asnumpy(), dataset[i][0].asnumpy())
+        assert y.item() == dataset[i][1].item()
+
+    raw = gluon.data.RecordFileDataset(recfile).__mx_handle__()
+    raw_mapped = gluon.data.RecordFileDataset(recfile, use_mmap=True).__mx_handle__()
+    for i in range(len(raw)):
+        np.testing.assert_equal(raw_mapped[i].asnumpy(), raw[i].asnumpy())
+
+    loader = gluon.data.DataLoader(mapped, 1, num_workers=2, try_nopython=True, num_inflight=4)
+    for i, (x, y) in enumerate(loader):
+        assert x.shape[0] == 1 and x.shape[3] == 3
+        assert y.item() == i
+
+@pytest.mark.parametrize('cache_size', [1, 1024])
+def test_recordimage_dataset_cache(prepare_record, cache_size):
+    recfile = prepare_record
+    dataset = gluon.data.vision.ImageRecordDataset(recfile)
+    cached = dataset.cache(cache_size)
+    assert len(cached) == len(dataset)
+    # the second epoch reads the cache, or the base dataset for the evicted images
+    for _ in range(2):
+        for i in range(len(dataset)):
+            x, y = cached[i]
+            np.testing.assert_equal(x.asnumpy(), dataset[i][0].asnumpy())
+            assert y.item() == dataset[i][1]
+
+    loader = gluon.data.DataLoader(cached, 1, num_workers=2)
+    for _ in range(2):
+        for i, (x, y) in enumerate(loader):
+            assert x.shape[0] == 1 and x.shape[3] == 3
+            assert y.item() == i
+
 def _dataset_transform_fn(x, y):
     """Named transform function since lambda function cannot be pickled."""
     return x, y
@@ -553,6 +592,25 @@ def test_mx_data_loader_nopython():
     for _ in dl1:
         pass
 
+@mx.util.use_np
+@pytest.mark.parametrize('out_of_order', [False, True])
+def test_mx_data_loader_nopython_inflight(out_of_order):
+    from mxnet.gluon.data.dataloader import DataLoader
+    from mxnet.gluon.data.vision.transforms import ToTensor
+    dataset = mx.gluon.data.vision.MNIST(train=False).transform_first(ToTensor())
+    dl1 = DataLoader(dataset=dataset, batch_size=32, num_workers=4, try_nopython=True,
+                     num_inflight=4, out_of_order=out_of_order)
+    dl2 = DataLoader(dataset=dataset, batch_size=32, num_workers=4, try_nopython=True)
+    for _ in range(2):
+        labels1 = [y.asnumpy() for _, y in dl1]
+        labels2 = [y.asnumpy() for _, y in dl2]
+        assert len(labels1) == len(labels2)
+        if out_of_order:
+            labels1 = sorted(labels1, key=lambda y: y.tobytes())
+            labels2 = sorted(labels2, key=lambda y: y.tobytes())
+        for y1, y2 in zip(labels1, labels2):
+            assert np.all(y1 == y2)
+
 def test_batchify_stack():
     a = np.array([[1, 2, 3, 4], [5, 6, 7, 8]])
     b = np.array([[5, 6, 7, 8], [1, 2, 3, 4]])
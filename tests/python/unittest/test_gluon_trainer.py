@@ -351,3 +351,105 @@ def test_trainer_share_parameters():
 
     assert((shared_params[0] == shared_params[1]).all())
 
+
+
+@pytest.mark.parametrize('kvstore', ['local', 'device'])
+def test_trainer_shard_optimizer_states(kvstore):
+    ctxs = [mx.cpu(0), mx.cpu(1)]
+    shapes = [(10, 4), (3,), (6, 2), (5,)]
+    def make_params():
+        params = [gluon.Parameter('p%d' % i, shape=shape) for i, shape in enumerate(shapes)]
+        for i, p in enumerate(params):
+            p.initialize(ctx=ctxs, init=mx.init.Constant(i + 1))
+        return params
+    def train(trainer, params, steps=3):
+        for step in range(steps):
+            with mx.autograd.record():
+                for p in params:
+                    for j, w in enumerate(p.list_data()):
+                        ((w * (step + j + 1)) ** 2).sum().backward()
+            trainer.step(1)
+
+    ref_params = make_params()
+    ref = gluon.Trainer(ref_params, 'adam', {'learning_rate': 0.1}, kvstore=kvstore,
+                        update_on_kvstore=False)
+    train(ref, ref_params)
+    params = make_params()
+    trainer = gluon.Trainer(params, 'adam', {'learning_rate': 0.1}, kvstore=kvstore,
+                            shard_optimizer_states=True)
+    train(trainer, params)
+    for p, ref_p in zip(params, ref_params):
+        for w, ref_w in zip(p.list_data(), ref_p.list_data()):
+            assert_almost_equal(w, ref_w, rtol=1e-5, atol=1e-6)
+    # every context keeps the states of its own Parameters only, balancing the sizes
+    assert trainer._owners == {0: 0, 2: 1, 3: 1, 1: 1}
+    for j, updater in enumerate(trainer._updaters):
+        assert sorted(updater.states) == sorted(i for i, o in trainer._owners.items() if o == j)
+
+    trainer.save_states('test_trainer_shard_optimizer_states.states')
+    trainer.load_states('test_trainer_shard_optimizer_states.states')
+    os.remove('test_trainer_shard_optimizer_states.states')
+    train(trainer, params, 1)
+    ref.save_states('test_trainer_shard_optimizer_states.states')
+    ref.load_states('test_trainer_shard_optimizer_states.states')
+    os.remove('test_trainer_shard_optimizer_states.states')
+    train(ref, ref_params, 1)
+    for p, ref_p in zip(params, ref_params):
+        for w, ref_w in zip(p.list_data(), ref_p.list_data()):
+            assert_almost_equal(w, ref_w, rtol=1e-5, atol=1e-6)
+    with pytest.raises(ValueError):
+        gluon.Trainer(make_params(), 'adam', update_on_kvstore=True, shard_optimizer_states=True)
+
+@pytest.mark.parametrize('lazy_update', [True, False])
+def test_trainer_delta_checkpoint(tmpdir, lazy_update):
+    class Table(gluon.Block):
+        def __init__(self):
+            super(Table, self).__init__()
+            self.weight = gluon.Parameter('weight', shape=(20, 3), grad_stype='row_sparse')
+            self.bias = gluon.Parameter('bias', shape=(3,))
+
+        def forward(self, rows):
+            emb = mx.nd.Embedding(rows, self.weight.data(), input_dim=20, output_dim=3,
+                                  sparse_grad=True)
+            return emb + self.bias.data()
+
+    net = Table()
+    net.initialize(init=mx.init.Uniform())
+    trainer = gluon.Trainer(net.collect_params(), 'sgd',
+                            {'learning_rate': 0.1, 'momentum': 0.9, 'wd': 0.01,
+                             'lazy_update': lazy_update}, kvstore=None)
+    def train(rows):
+        with mx.autograd.record():
+            loss = (net(mx.nd.array(rows)) ** 2).sum()
+        loss.backward()
+        trainer.step(1)
+
+    base = str(tmpdir.join('base.params'))
+    train([1, 2])
+    net.save_parameters(base)
+    train([3, 4])
+    train([4, 7])
+    delta = str(tmpdir.join('delta.params'))
+    net.save_parameters(delta, base=base)
+    saved = mx.nd.load(delta)
+    assert saved['bias'].stype == 'default'
+    if lazy_update:
+        # only the rows updated since the base are saved
+        assert saved['weight'].stype == 'row_sparse'
+        assert sorted(saved['weight'].indices.asnumpy().tolist()) == [3, 4, 7]
+    else:
+        assert saved['weight'].stype == 'default'
+
+    train([5])
+    delta2 = str(tmpdir.join('delta2.params'))
+    net.save_parameters(delta2, base=delta)
+    loaded = Table()
+    loaded.load_parameters(delta2)
+    for name in ['weight', 'bias']:
+        assert_almost_equal(getattr(loaded, name).data(), getattr(net, name).data())
+
+    full = str(tmpdir.join('full.params'))
+    gluon.utils.compact_parameters(delta2, full)
+    compacted = mx.nd.load(full)
+    assert sorted(compacted) == ['bias', 'weight']
+    assert_almost_equal(compacted['weight'].tostype('default'), net.weight.data())
@@ -107,6 +107,21 @@ def test_inter_methods_in_augmenter(inter_method, cifar10):
     for _ in dataiter:
         pass
 
+@pytest.mark.parametrize('jpeg_scale_min_size', [-1, 16])
+def test_ImageRecordIter_jpeg_scaled_decode(jpeg_scale_min_size, cifar10):
+    dataiter = mx.io.ImageRecordIter(
+        path_imgrec=os.path.join(cifar10, 'cifar', 'test.rec'),
+        data_shape=(3, 16, 16),
+        batch_size=100,
+        random_resized_crop=True,
+        min_random_area=0.5,
+        jpeg_scale_min_size=jpeg_scale_min_size)
+    batchcount = 0
+    for batch in dataiter:
+        assert batch.data[0].shape == (100, 3, 16, 16)
+        batchcount += 1
+    assert batchcount == 100
+
 def test_image_iter_exception(cifar10):
     with pytest.raises(MXNetError):
         dataiter = mx.io.ImageRecordIter(
@@ -409,6 +424,79 @@ def test_LibSVMIter(tmpdir):
     assertRaises(MXNetError, check_libSVMIter_exception)
 
 
+def test_LibSVMIter_parse_threads(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    rng = np.random.RandomState(0)
+    with open(data_path, 'w') as fout:
+        for _ in range(1000):
+            indices = np.sort(rng.choice(100, rng.randint(0, 10), replace=False))
+            values = rng.uniform(-10, 10, size=len(indices))
+            fout.write(' '.join(['%d' % rng.randint(0, 5)] +
+                                ['%d:%.6g' % (i, v) for i, v in zip(indices, values)]) + '\n')
+
+    def read(**kwargs):
+        data_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(100,), batch_size=10,
+                                     **kwargs)
+        return [(batch.data[0].asnumpy(), batch.label[0].asnumpy()) for batch in data_iter]
+
+    expected = read()
+    for _ in range(2):
+        batches = read(num_parse_threads=4, parse_prefetch=3)
+        assert len(batches) == len(expected)
+        for (data, label), (expected_data, expected_label) in zip(batches, expected):
+            assert_almost_equal(data, expected_data)
+            assert_almost_equal(label, expected_label)
+
+
+def test_CSRBinIter(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    bin_path = os.path.join(str(tmpdir), 'data.bin')
+    rng = np.random.RandomState(0)
+    rows = []
+    for _ in range(100):
+        indices = np.sort(rng.choice(20, rng.randint(0, 5), replace=False))
+        rows.append((rng.randint(0, 5), indices, rng.uniform(-1, 1, size=len(indices))))
+    with open(data_path, 'w') as fout:
+        for label, indices, values in rows:
+            fout.write(' '.join(['%d' % label] +
+                                ['%d:%.6g' % (i, v) for i, v in zip(indices, values)]) + '\n')
+
+    # the layout of src/io/csr_binary.h, as written by tools/libsvm2bin in blocks of 30 rows
+    def align(offset, alignment):
+        return (offset + alignment - 1) // alignment * alignment
+
+    with open(bin_path, 'wb') as fout:
+        fout.write(b'XCSRBIN1' + np.uint64(1).tobytes())
+        for start in range(0, len(rows), 30):
+            block = rows[start:start + 30]
+            labels = np.array([r[0] for r in block], dtype=np.float32)
+            indptr = np.cumsum([0] + [len(r[1]) for r in block]).astype(np.int64)
+            indices = np.concatenate([r[1] for r in block]).astype(np.int64)
+            values = np.concatenate([r[2] for r in block]).astype(np.float32)
+            columns = [np.array([len(block), indptr[-1]], dtype=np.uint64),
+                       labels, indptr, indices, values]
+            fout.seek(align(max(fout.tell(), 64), 64))
+            for column in columns:
+                fout.seek(align(fout.tell(), 8))
+                fout.write(column.tobytes())
+        fout.write(b'\0' * (align(fout.tell(), 64) - fout.tell()))
+
+    libsvm_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(20,), batch_size=8)
+    bin_iter = mx.io.CSRBinIter(data_csrbin=bin_path, data_shape=(20,), batch_size=8)
+    for _ in range(2):
+        num_batches = 0
+        for batch, expected in zip_longest(bin_iter, libsvm_iter):
+            assert batch is not None and expected is not None
+            batch.data[0].check_format(True)
+            assert batch.pad == expected.pad
+            assert_almost_equal(batch.data[0].asnumpy(), expected.data[0].asnumpy())
+            assert_almost_equal(batch.label[0].asnumpy(), expected.label[0].asnumpy())
+            num_batches += 1
+        assert num_batches == 13
+        bin_iter.reset()
+        libsvm_iter.reset()
+
+
 def test_DataBatch():
     from mxnet.io import DataBatch
     import re
@@ -19,7 +19,7 @@
 import mxnet as mx
 import numpy as np
 import unittest
-from mxnet.test_utils import rand_ndarray, assert_almost_equal
+from mxnet.test_utils import rand_ndarray, assert_almost_equal, environment
 from common import assertRaises
 from mxnet.base import py_str, MXNetError
 import pytest
@@ -93,6 +93,43 @@ def test_row_sparse_pull():
     check_row_sparse_pull(kv, 1)
     check_row_sparse_pull(kv, 4)
 
+def test_hash_embedding():
+    num_ids, dim = 2**40, 4
+    ids = np.array([3, 2**39], dtype=np.int64)
+
+    def push(kv, key, row_ids, grad):
+        kv.push(key, mx.nd.sparse.row_sparse_array((grad, row_ids), shape=(num_ids, dim)))
+
+    def pull(kv, key, row_ids):
+        out = mx.nd.sparse.zeros('row_sparse', (num_ids, dim))
+        kv.row_sparse_pull(key, out=out, row_ids=mx.nd.array(row_ids, dtype=np.int64))
+        assert_almost_equal(out.indices.asnumpy(), np.unique(row_ids))
+        return out.data.asnumpy()
+
+    grad = np.ones((len(ids), dim), dtype=np.float32)
+    for key in [9, 'h']:
+        kv = mx.kv.create()
+        kv.init_hash_embedding(key, (num_ids, dim), learning_rate=0.5, init_scale=0)
+        assert_almost_equal(pull(kv, key, ids), np.zeros((2, dim)))
+        push(kv, key, ids, grad)
+        push(kv, key, ids[:1], grad[:1])
+        assert_almost_equal(pull(kv, key, ids), np.array([[-1] * dim, [-0.5] * dim]))
+        # the ids never pushed have no row
+        assert_almost_equal(pull(kv, key, np.array([5], dtype=np.int64)), np.zeros((1, dim)))
+        assertRaises(MXNetError, kv.pull, key, out=mx.nd.zeros((num_ids, dim)))
+
+    # an id gets a row on its second push, and loses it after 2 pushes without it
+    kv = mx.kv.create()
+    kv.init_hash_embedding(0, (num_ids, dim), learning_rate=1, init_scale=0, admit_count=2,
+                           max_idle_updates=2)
+    push(kv, 0, ids[:1], grad[:1])
+    assert_almost_equal(pull(kv, 0, ids[:1]), np.zeros((1, dim)))
+    push(kv, 0, ids[:1], grad[:1])
+    assert_almost_equal(pull(kv, 0, ids[:1]), -np.ones((1, dim)))
+    push(kv, 0, ids[1:], grad[1:])
+    push(kv, 0, ids[1:], grad[1:])
+    assert_almost_equal(pull(kv, 0, ids), np.array([[0] * dim, [-1] * dim]))
+
 def test_init():
     """test init"""
     def check_init(kv, key):
@@ -170,6 +207,25 @@ def test_aggregator():
         check_aggregator(init_kv_with_str(), 'a', str_keys, stype)
 
 
+@pytest.mark.parametrize('kv_type', ['local', 'device'])
+def test_fused_pushpull(kv_type):
+    """pushpull of small keys through the fusion buffers"""
+    num_devs = 4
+    devs = [mx.Context('cpu', i) for i in range(num_devs)]
+    # the last key is too large to be fused
+    shapes = [(2, 3), (5,), (4, 4), (3, 1), (16, 16)]
+    fused_keys = list(range(len(shapes)))
+    with environment('MXNET_KVSTORE_FUSION_BYTES', '1024'):
+        kv = mx.kv.create(kv_type)
+    kv.init(fused_keys, [mx.nd.zeros(s) for s in shapes])
+    for step in range(1, 3):
+        vals = [[mx.nd.ones(s, d) * (k + step) for d in devs] for k, s in enumerate(shapes)]
+        kv.pushpull(fused_keys, vals)
+        for k, val in enumerate(vals):
+            for v in val:
+                check_diff_to_scalar(v, num_devs * (k + step))
+
+
 @pytest.mark.skip(reason='Skipped due to segfault. Tracked in #18098')
 def test_sparse_aggregator():
     """aggregate sparse ndarray on muliple devices"""
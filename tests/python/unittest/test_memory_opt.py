@@ -76,3 +76,34 @@ def test_fc():
     z = mx.sym.Activation(y, act_type='tanh', name='z')
     z = mx.sym.FullyConnected(z, num_hidden=num_hidden)
     exec = z._simple_bind(mx.cpu(), 'write', x=(num_hidden,))
+
+
+def test_liverange_memory_planner():
+    net = mx.gluon.nn.HybridSequential()
+    for _ in range(4):
+        net.add(mx.gluon.nn.Dense(64, activation='tanh'))
+    net.initialize()
+    x = mx.np.random.uniform(size=(8, 32))
+    with mx.autograd.record():
+        expected = net(x)
+    expected.backward()
+    grad = net[0].weight.grad().copy()
+    with environment('MXNET_MEMORY_PLANNER', 'liverange'):
+        net.hybridize(static_alloc=True)
+        with mx.autograd.record():
+            out = net(x)
+        out.backward()
+    mx.test_utils.assert_almost_equal(out.asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-6)
+    mx.test_utils.assert_almost_equal(net[0].weight.grad().asnumpy(), grad.asnumpy(),
+                                      rtol=1e-5, atol=1e-6)
+
+
+def test_memory_pool_stats():
+    a = mx.nd.ones((128, 128), ctx=mx.cpu())
+    a.wait_to_read()
+    stats = mx.cpu().memory_pool_stats()
+    assert stats['context'] == 'cpu(0)'
+    assert isinstance(stats['pool'], dict)
+    if 'used_bytes' in stats['pool']:
+        assert stats['pool']['used_bytes'] >= 0
+
@@ -435,6 +435,59 @@ def test_ndarray_load_fortran_order(tmp_path):
     assert np.sum(np_mx_arr != arr) == 0
 
 
+@pytest.mark.parametrize('dtype', ['float32', 'float16', 'int8', 'float64'])
+def test_ndarray_load_mmap(dtype, tmp_path):
+    fname = str(tmp_path / 'mmap.params')
+    dmap = {'arg:w%d' % i: mx.nd.array(np.random.uniform(-10, 10, (i + 1, 7)), dtype=dtype)
+            for i in range(5)}
+    mx.nd.save(fname, dmap)
+    dmap2 = mx.nd.load(fname, mmap=True)
+    assert sorted(dmap2.keys()) == sorted(dmap.keys())
+    for k, x in dmap.items():
+        assert dmap2[k].dtype == x.dtype
+        assert_array_equal(dmap2[k].asnumpy(), x.asnumpy())
+    # the arrays are copy-on-write views of the file
+    dmap2['arg:w0'][:] = 0
+    for k, x in mx.nd.load(fname, mmap=True).items():
+        assert_array_equal(x.asnumpy(), dmap[k].asnumpy())
+
+    # files saved by numpy are not aligned, thus read when their arrays are not
+    np.savez(fname + '.npz', **{k: x.asnumpy() for k, x in dmap.items()})
+    for k, x in mx.nd.load(fname + '.npz', mmap=True).items():
+        assert_array_equal(x.asnumpy(), dmap[k].asnumpy())
+    mx.nd.save(fname + '.npy', dmap['arg:w3'])
+    assert_array_equal(mx.nd.load(fname + '.npy', mmap=True)[0].asnumpy(), dmap['arg:w3'].asnumpy())
+
+
+def test_ndarray_asnumpy_async():
+    x = mx.nd.random.uniform(shape=(64, 32), ctx=default_context())
+    y = mx.nd.dot(x, x.T)
+    future = y.asnumpy_async()
+    z = y + 1
+    assert_almost_equal(future.result(), y.asnumpy())
+    assert future.done()
+    assert_almost_equal(z.asnumpy(), future.result() + 1)
+
+    out = np.zeros(x.shape, dtype=x.dtype)
+    assert x.asnumpy_async(out=out).result() is out
+    assert_array_equal(out, x.asnumpy())
+    assertRaises(ValueError, x.asnumpy_async, np.zeros((32, 64), dtype=x.dtype))
+    assertRaises(ValueError, x.asnumpy_async, np.zeros(x.shape, dtype='float64'))
+
+    async def fetch():
+        return await (x * 2).asnumpy_async()
+    import asyncio
+    loop = asyncio.new_event_loop()
+    try:
+        assert_almost_equal(loop.run_until_complete(fetch()), x.asnumpy() * 2)
+    finally:
+        loop.close()
+
+    # the errors of the operations computing the array are raised by the result
+    with pytest.raises(mx.MXNetError):
+        mx.nd.random.normal(0, -1, (2, 2)).asnumpy_async().result()
+
+
 def test_ndarray_legacy_load():
     data = []
     for _ in range(6):
@@ -1258,6 +1311,53 @@ def test_cached():
         o.backward()
 
 
+
+@pytest.mark.serial
+@pytest.mark.parametrize('static', [False, True])
+def test_cached_op_given_outputs(static):
+    sym = mx.sym.FullyConnected(mx.sym.var('data'), num_hidden=4, name='fc') * 2
+    op = mx.nd.CachedOp(sym, flags=[('static_alloc', static), ('static_shape', static)])
+    x = mx.nd.random.uniform(shape=(3, 5))
+    weight = mx.nd.random.uniform(shape=(4, 5))
+    bias = mx.nd.random.uniform(shape=(4,))
+    expected = op(x, weight, bias).asnumpy()
+    # the same array given on every call
+    out = mx.nd.zeros((3, 4))
+    for _ in range(3):
+        out[:] = 0
+        assert op(x, weight, bias, out=out) is out
+        assert_almost_equal(out, expected)
+    if default_context() == mx.cpu():
+        # a host buffer wrapped without a copy
+        buf = np.zeros((3, 4), dtype=np.float32)
+        op(x, weight, bias, out=mx.nd.from_numpy(buf, zero_copy=True))
+        mx.nd.waitall()
+        assert_almost_equal(buf, expected)
+    assert_almost_equal(op(x, weight, bias), expected)
+    assert_almost_equal(op(x, weight, bias, out=out), expected)
+    if static:
+        assertRaises(mx.MXNetError, op, x, weight, bias, out=mx.nd.zeros((4, 3)))
+
+
+@pytest.mark.serial
+def test_cached_op_batcher():
+    from concurrent.futures import ThreadPoolExecutor
+    from mxnet._ctypes.cached_op import CachedOpBatcher
+    sym = mx.sym.FullyConnected(mx.sym.var('data'), num_hidden=8, name='fc')
+    op = mx.nd.CachedOp(sym, flags=[('data_indices', [0]), ('param_indices', [1, 2])], thread_safe=True)
+    weight = mx.nd.random.uniform(shape=(8, 5))
+    bias = mx.nd.random.uniform(shape=(8,))
+    batcher = CachedOpBatcher(op, max_batch=16, timeout_us=20000)
+    # the requests are coalesced into padded batches, the last one is larger than a batch
+    requests = [mx.nd.random.uniform(shape=(n, 5)) for n in [1, 3, 2, 7, 1, 20]]
+    with ThreadPoolExecutor(len(requests)) as pool:
+        outputs = list(pool.map(lambda x: batcher(x, weight, bias), requests))
+    for x, out in zip(requests, outputs):
+        assert out.shape == (x.shape[0], 8)
+        expected = mx.nd.FullyConnected(x, weight, bias, num_hidden=8)
+        assert_almost_equal(out, expected, rtol=1e-5, atol=1e-5)
+
+
 def test_output():
     shape = (2,2)
     ones = mx.nd.ones(shape)
@@ -1817,6 +1917,15 @@ def test_dlpack():
             assert_almost_equal(a_np, d)
             assert_almost_equal(a_np, e)
 
+def test_dlpack_protocol():
+    a = mx.nd.random.uniform(shape=(3, 4)) * 2
+    assert a.__dlpack_device__() == (1, 0)
+    b = mx.nd.from_dlpack(a.__dlpack__())
+    assert_almost_equal(a, b)
+    # consumers take the objects with __dlpack__ as well
+    c = mx.npx.from_dlpack(a.as_np_ndarray())
+    assert_almost_equal(a, c)
+
 def test_ndarray_is_inf():
     random_dimensions = np.random.randint(2, 5)
     random_shape = [np.random.randint(2, 5) for i in range(random_dimensions)]
@@ -2063,3 +2172,41 @@ def test_readable_bfloat16_print():
     arr_float = arr_bfloat16.astype(float)
     assert (arr_bfloat16.__str__() == arr_float.__str__())
     assert (arr_bfloat16.__repr__().find(arr_uint16.__str__()) != -1)
+
+
+def test_imperative_dispatch_cache():
+    # the repeated calls reuse the plans of the first ones, which must not leak to other signatures
+    for _ in range(3):
+        for shape in [(2, 3), (4, 5)]:
+            for dtype in ['float32', 'float16', 'int32']:
+                a = mx.nd.ones(shape, dtype=dtype)
+                b = mx.nd.full(shape, 2, dtype=dtype)
+                c = a + b
+                assert c.shape == shape and c.dtype == np.dtype(dtype)
+                assert same(c.asnumpy(), np.full(shape, 3, dtype=dtype))
+                for axis in [0, 1]:
+                    s = mx.nd.sum(b, axis=axis)
+                    assert same(s.asnumpy(), b.asnumpy().sum(axis=axis, dtype=dtype))
+                out = mx.nd.zeros(shape, dtype=dtype)
+                mx.nd.elemwise_add(a, b, out=out)
+                assert same(out.asnumpy(), c.asnumpy())
+        dense = mx.nd.ones((3, 4))
+        csr = dense.tostype('csr')
+        assert (csr * 2).stype == 'csr' and (dense * 2).stype == 'default'
+        assert same((csr * 2).asnumpy(), (dense * 2).asnumpy())
+
+
+def test_imperative_attrs_cache():
+    # the repeated calls with the same parameters reuse their parsed attributes
+    for _ in range(3):
+        for n in [2, 3]:
+            arrays = [mx.nd.ones((2, 3)) * i for i in range(n)]
+            c = mx.nd.concat(*arrays, dim=1)
+            assert c.shape == (2, 3 * n)
+            assert same(c.asnumpy(), np.concatenate([a.asnumpy() for a in arrays], axis=1))
+        for axes in [(1, 0, 2), (2, 1, 0)]:
+            t = mx.nd.transpose(mx.nd.ones((2, 3, 4)), axes=axes)
+            assert t.shape == tuple((2, 3, 4)[i] for i in axes)
+        with mx.util.np_shape(True):
+            assert mx.nd.ones(shape=()).shape == ()
+        assert mx.nd.ones(shape=(2,)).shape == (2,)
@@ -1065,6 +1065,28 @@ def test_np_save_load_ndarrays(load_fn):
                 assert _np.array_equal(v.asnumpy() if load_fn is npx.load else v, arr_dict[k].asnumpy())
 
 
+@use_np
+def test_np_savez_async(tmp_path):
+    fname = str(tmp_path / 'async.npz')
+    arrays = {'a': np.arange(1000).reshape(10, 100), 'b': np.ones((3, 0)),
+              'c': np.random.uniform(size=(7, 5))}
+    expected = {k: v.asnumpy() for k, v in arrays.items()}
+    future = npx.savez_async(fname, **arrays)
+    # the writes to the saved arrays wait for the save
+    arrays['a'] += 1
+    assert future.result() is None
+    assert future.done()
+    loaded = npx.load(fname)
+    assert sorted(loaded.keys()) == sorted(expected.keys())
+    for k, v in expected.items():
+        assert _np.array_equal(loaded[k].asnumpy(), v)
+    assert _np.array_equal(arrays['a'].asnumpy(), expected['a'] + 1)
+    # the errors of the save are raised by the result
+    future = npx.savez_async(str(tmp_path / 'missing' / 'async.npz'), a=arrays['a'])
+    with pytest.raises(mx.MXNetError):
+        future.result()
+
+
 @retry(5)
 @use_np
 @pytest.mark.serial
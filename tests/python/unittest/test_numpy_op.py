@@ -8418,6 +8418,39 @@ def test_np_einsum():
                     assert_almost_equal(grad[0][iop], grad[1][iop], rtol=rtol, atol=atol)
 
 
+@use_np
+@pytest.mark.parametrize('subscripts,shapes', [
+    ('ij,jk->ik', [(3, 4), (4, 5)]),
+    ('bij,bjk->bik', [(2, 3, 4), (2, 4, 5)]),
+    ('bji,bjk->bik', [(2, 4, 3), (2, 4, 5)]),
+    ('bij,bkj->bki', [(2, 3, 4), (2, 5, 4)]),
+    ('ijb,jkb->kib', [(3, 4, 2), (4, 5, 2)]),
+    ('abiz,abjz->abij', [(2, 3, 4, 6), (2, 3, 5, 6)]),
+    ('i,i->', [(5,), (5,)]),
+    ('ij,kl->likj', [(2, 3), (4, 5)]),
+])
+@pytest.mark.parametrize('dtype', ['float32', 'float64'])
+@pytest.mark.parametrize('optimize', [False, True])
+def test_np_einsum_batched_gemm(subscripts, shapes, dtype, optimize):
+    # the contractions computed with transposes and batched GEMMs, and their gradients
+    lhs, rhs = subscripts.split('->')[0].split(',')
+    out = subscripts.split('->')[1]
+    x_np = [onp.random.uniform(-1.0, 1.0, shape).astype(dtype) for shape in shapes]
+    x = [np.array(a, dtype=dtype) for a in x_np]
+    for a in x:
+        a.attach_grad()
+    with mx.autograd.record():
+        out_mx = np.einsum(subscripts, *x, optimize=optimize)
+    expected = onp.einsum(subscripts, *x_np)
+    assert_almost_equal(out_mx.asnumpy(), expected, rtol=1e-3, atol=1e-5)
+    ograd_np = onp.random.uniform(-1.0, 1.0, expected.shape).astype(dtype)
+    out_mx.backward(np.array(ograd_np, dtype=dtype))
+    expected_grads = [onp.einsum(out + ',' + rhs + '->' + lhs, ograd_np, x_np[1]),
+                      onp.einsum(out + ',' + lhs + '->' + rhs, ograd_np, x_np[0])]
+    for a, expected_grad in zip(x, expected_grads):
+        assert_almost_equal(a.grad.asnumpy(), expected_grad, rtol=1e-3, atol=1e-5)
+
+
 @use_np
 @pytest.mark.skip(reason='Skipped as the test is flaky and the feature causes curand error. Tracked in #18100')
 def test_np_diagflat():
@@ -10775,6 +10808,44 @@ def check_multihead_attention_encdec(dtype):
         assert_allclose(grads1[k].data().asnumpy(), grads2[k].data().asnumpy(), rtol=1e-2, atol=1e-3)
 
 
+@use_np
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_interleaved_kv_cache(hybridize):
+    seq_len, prefix, batch, heads, head_dim = 9, 4, 2, 3, 8
+    qkv = np.random.uniform(-1, 1, size=(seq_len, batch, heads * 3 * head_dim))
+    # every token attends to the tokens up to it
+    scores = npx.interleaved_matmul_selfatt_qk(qkv, heads=heads)
+    causal = np.tril(np.ones((seq_len, seq_len))).astype('bool')
+    att = npx.masked_softmax(scores, np.broadcast_to(causal, scores.shape), temperature=0.5)
+    expected = npx.interleaved_matmul_selfatt_valatt(qkv, att, heads=heads)
+
+    class Decoder(HybridBlock):
+        def __init__(self):
+            super().__init__()
+            self.cache = Parameter('cache', shape=(seq_len, batch, heads * 2 * head_dim),
+                                   init='zeros', grad_req='null')
+            self.length = Parameter('length', shape=(1,), dtype='int32', init='zeros',
+                                    grad_req='null')
+
+        def forward(self, qkv):
+            queries = npx.interleaved_kv_cache_append(qkv, self.cache.data(), self.length.data(),
+                                                      heads=heads)
+            return npx.interleaved_kv_cache_attend(queries, self.cache.data(),
+                                                   self.length.data(), heads=heads,
+                                                   temperature=0.5)
+
+    net = Decoder()
+    net.initialize()
+    if hybridize:
+        net.hybridize(static_alloc=True)
+    # the prompt, then one token at a time
+    outs = [net(qkv[:prefix])]
+    for i in range(prefix, seq_len):
+        outs.append(net(qkv[i:i + 1]))
+    assert net.length.data().item() == seq_len
+    assert_almost_equal(np.concatenate(outs, axis=0), expected, rtol=1e-4, atol=1e-5)
+
+
 @use_np
 @assert_raises_cuda_not_satisfied(min_version='9.1')
 @pytest.mark.serial
@@ -470,6 +470,110 @@ def test_fully_connected():
     #check_symbolic_forward(fc, {'data': data_np, 'weight': fc_weight.asnumpy(), 'bias': fc_bias2.asnumpy()}, {'fc_output': res})
 
 
+@pytest.mark.parametrize('no_bias', [False, True])
+def test_grouped_fully_connected(no_bias):
+    shapes = [((4, 6), 3), ((4, 6), 3), ((2, 3, 5), 7)]
+    args, grads = [], []
+    for data_shape, num_hidden in shapes:
+        layer = [mx.nd.random.uniform(-1, 1, shape=data_shape),
+                 mx.nd.random.uniform(-1, 1, shape=(num_hidden, np.prod(data_shape[1:])))]
+        if not no_bias:
+            layer.append(mx.nd.random.uniform(-1, 1, shape=(num_hidden,)))
+        for arr in layer:
+            arr.attach_grad()
+        args += layer
+    per = 2 if no_bias else 3
+    with mx.autograd.record():
+        outs = mx.nd.contrib.grouped_fully_connected(
+            *args, num_groups=len(shapes), num_hidden=[s[1] for s in shapes], no_bias=no_bias)
+        sum(out.sum() for out in outs).backward()
+    grads = [arr.grad.copy() for arr in args]
+    for g, (_, num_hidden) in enumerate(shapes):
+        layer = args[g * per:(g + 1) * per]
+        with mx.autograd.record():
+            expected = mx.nd.FullyConnected(*layer, num_hidden=num_hidden, no_bias=no_bias)
+            expected.sum().backward()
+        assert_almost_equal(outs[g], expected, rtol=1e-5, atol=1e-6)
+        for arr, grad in zip(layer, grads[g * per:(g + 1) * per]):
+            assert_almost_equal(grad, arr.grad, rtol=1e-5, atol=1e-6)
+
+@pytest.mark.parametrize('remove_accidental_hits', [False, True])
+@pytest.mark.parametrize('subtract_log_q', [False, True])
+def test_sampled_logits(remove_accidental_hits, subtract_log_q):
+    batch_size, dim, num_classes, num_sampled = 6, 5, 20, 8
+    data = mx.nd.random.uniform(-1, 1, shape=(batch_size, dim))
+    weight = mx.nd.random.uniform(-1, 1, shape=(num_classes, dim))
+    bias = mx.nd.random.uniform(-1, 1, shape=(num_classes,))
+    sampled, num_tries = mx.nd._internal._sample_unique_zipfian(num_classes, shape=(1, num_sampled))
+    sampled = sampled.reshape(-1)
+    label = np.random.randint(0, num_classes, size=batch_size)
+    # accidental hits, of a label repeated in the batch
+    label[:2] = sampled[0].asscalar()
+    label = mx.nd.array(label)
+    hits = label.asnumpy().reshape(-1, 1) == sampled.asnumpy().reshape(1, -1)
+    hits = np.concatenate([np.zeros((batch_size, 1), dtype=bool), hits & remove_accidental_hits], axis=1)
+    classes = np.concatenate([label.asnumpy().reshape(-1, 1),
+                              np.broadcast_to(sampled.asnumpy(), (batch_size, num_sampled))], axis=1)
+    prob = np.log((classes + 2) / (classes + 1)) / np.log(num_classes + 1)
+    log_q = np.log(1 - (1 - prob) ** num_tries.asscalar()) if subtract_log_q else np.zeros_like(prob)
+    ograd = mx.nd.random.uniform(-1, 1, shape=(batch_size, num_sampled + 1))
+
+    args = [data, weight, bias]
+    for arr in args:
+        arr.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.contrib.sampled_logits(data, weight, bias, label, sampled, num_tries,
+                                           remove_accidental_hits=remove_accidental_hits,
+                                           subtract_log_q=subtract_log_q)
+    out.backward(ograd)
+    grads = [arr.grad.copy() for arr in args]
+    with mx.autograd.record():
+        full = mx.nd.FullyConnected(data, weight, bias, num_hidden=num_classes)
+        expected = mx.nd.concat(mx.nd.pick(full, label, axis=1).reshape(-1, 1),
+                                mx.nd.take(full, sampled, axis=1), dim=1) - mx.nd.array(log_q)
+        lowest = mx.nd.full(expected.shape, -np.finfo(np.float32).max)
+        expected = mx.nd.where(mx.nd.array(hits.astype(np.float32)), lowest, expected)
+    expected.backward(ograd)
+    assert_almost_equal(out, expected, rtol=1e-5, atol=1e-5)
+    for arr, grad in zip(args, grads):
+        assert_almost_equal(grad, arr.grad, rtol=1e-5, atol=1e-5)
+
+def test_fp8_fully_connected():
+    # values in {0, +-0.25, +-0.5, +-1} with a maximum of 1 are exact in E4M3 once scaled by 448
+    def exact_data(shape):
+        arr = np.random.choice([0, 0.25, -0.25, 0.5, -0.5, 1, -1], size=shape).astype(np.float32)
+        arr.flat[0] = 1
+        return mx.nd.array(arr)
+    data, weight, bias = exact_data((4, 2, 3)), exact_data((5, 6)), exact_data((5,))
+    history = mx.nd.zeros((2, 3))
+    for arr in [data, weight, bias]:
+        arr.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.contrib.fp8_fully_connected(data, weight, bias, history, num_hidden=5, amax_history_len=3)
+    out.backward(mx.nd.ones_like(out))
+    grads = [arr.grad.copy() for arr in [data, weight, bias]]
+    with mx.autograd.record():
+        expected = mx.nd.FullyConnected(data, weight, bias, num_hidden=5)
+    expected.backward(mx.nd.ones_like(expected))
+    assert_almost_equal(out, expected, rtol=0, atol=0)
+    for arr, grad in zip([data, weight, bias], grads):
+        assert_almost_equal(grad, arr.grad, rtol=0, atol=0)
+    assert_almost_equal(history, np.array([[1, 0, 0], [1, 0, 0]]))
+
+    # the history keeps the newest maxima first, and rounding to E4M3 keeps 3 mantissa bits
+    data = mx.nd.random.uniform(-2, 2, shape=(8, 16))
+    weight = mx.nd.random.uniform(-0.5, 0.5, shape=(4, 16))
+    with mx.autograd.record():
+        out = mx.nd.contrib.fp8_fully_connected(data, weight, history, num_hidden=4, no_bias=True,
+                                                amax_history_len=3)
+    expected = mx.nd.FullyConnected(data, weight, num_hidden=4, no_bias=True)
+    assert_almost_equal(out, expected, rtol=0.1, atol=0.1)
+    assert_almost_equal(history[:, 0], np.array([np.abs(data.asnumpy()).max(), np.abs(weight.asnumpy()).max()]))
+    assert_almost_equal(history[:, 1:], np.array([[1, 0], [1, 0]]))
+    # outside of training the history stays as it is
+    mx.nd.contrib.fp8_fully_connected(data * 2, weight, history, num_hidden=4, no_bias=True, amax_history_len=3)
+    assert_almost_equal(history[:, 1:], np.array([[1, 0], [1, 0]]))
+
 def test_pow_fn():
     shape = (3, 4)
     exp = mx.symbol.Variable("exp")
@@ -1634,6 +1738,37 @@ def test_batchnorm(op_name, shape, fix_gamma, cudnn_off, output_mean_var):
                         data_grad_req, gamma_grad_req, beta_grad_req)
 
 
+@pytest.mark.parametrize('shape', [(4, 3, 4), (2, 8, 5, 6)])
+@pytest.mark.parametrize('axis', [1, -1])
+@pytest.mark.parametrize('fix_gamma', [False, True])
+@pytest.mark.parametrize('addend_grad_req', ['write', 'add'])
+@pytest.mark.parametrize('train_mode', [True, False])
+def test_batch_norm_add_relu(shape, axis, fix_gamma, addend_grad_req, train_mode):
+    channels = shape[axis]
+    data, addend = mx.nd.random.uniform(-1, 1, shape=shape), mx.nd.random.uniform(-1, 1, shape=shape)
+    gamma, beta = mx.nd.random.uniform(0.5, 1.5, shape=(channels,)), mx.nd.random.uniform(-1, 1, shape=(channels,))
+    moving_mean, moving_var = mx.nd.random.uniform(-1, 1, shape=(channels,)), mx.nd.ones((channels,))
+    head_grad = mx.nd.random.uniform(-1, 1, shape=shape)
+
+    def run(fn):
+        xs = [a.copy() for a in (data, gamma, beta, addend)]
+        aux = [moving_mean.copy(), moving_var.copy()]
+        for x in xs:
+            x.attach_grad()
+        xs[-1].attach_grad(grad_req=addend_grad_req)
+        xs[-1].grad[:] = 1
+        with mx.autograd.record(train_mode=train_mode):
+            out = fn(*(xs[:3] + aux + xs[3:]))
+        out.backward(head_grad)
+        return [out.asnumpy()] + [x.grad.asnumpy() for x in xs] + [a.asnumpy() for a in aux]
+
+    kwargs = {'axis': axis, 'fix_gamma': fix_gamma, 'eps': 1e-3}
+    fused = run(lambda *args: mx.nd.contrib.BatchNormAddReLU(*args, **kwargs))
+    reference = run(lambda x, g, b, m, v, r: mx.nd.relu(mx.nd.BatchNorm(x, g, b, m, v, **kwargs) + r))
+    for f, r in zip(fused, reference):
+        assert_almost_equal(f, r, rtol=1e-4, atol=1e-4)
+
+
 def test_groupnorm():
     acc_types = {'float16': 'float32', 'float32': 'float64', 'float64': 'float64'}
     def x_hat_helper(x, num_groups, eps):
@@ -1756,6 +1891,62 @@ def test_convolution_grouping():
                 np.testing.assert_allclose(arr1.asnumpy(), arr2.asnumpy(), rtol=1e-3, atol=1e-3)
 
 
+@pytest.mark.parametrize('dim', [2, 3])
+@pytest.mark.parametrize('num_group', [1, 2])
+@pytest.mark.parametrize('stride,pad,dilate', [(1, 0, 1), (2, 1, 1), (1, 2, 2)])
+@pytest.mark.parametrize('no_bias', [False, True])
+def test_convolution_channels_last(dim, num_group, stride, pad, dilate, no_bias):
+    ctx = default_context()
+    num_filter, channels = 6, 4
+    kernel = (3,) * dim
+    data = mx.nd.random.uniform(-1, 1, (2, channels) + (7,) * dim, ctx=ctx)
+    weight = mx.nd.random.uniform(-1, 1, (num_filter, channels // num_group) + kernel, ctx=ctx)
+    bias = mx.nd.random.uniform(-1, 1, (num_filter,), ctx=ctx)
+    to_last = (0,) + tuple(range(2, dim + 2)) + (1,)
+    to_first = (0, dim + 1) + tuple(range(1, dim + 1))
+    kwargs = dict(kernel=kernel, stride=(stride,) * dim, pad=(pad,) * dim,
+                  dilate=(dilate,) * dim, num_filter=num_filter, num_group=num_group,
+                  no_bias=no_bias, cudnn_off=True)
+    first, last = ('NCDHW', 'NDHWC') if dim == 3 else ('NCHW', 'NHWC')
+    outs, grads = [], []
+    for layout, perm in [(first, None), (last, to_last)]:
+        args = [data, weight] if perm is None else [data.transpose(perm), weight.transpose(perm)]
+        args = [a.copy() for a in args] + ([] if no_bias else [bias.copy()])
+        for a in args:
+            a.attach_grad()
+        with mx.autograd.record():
+            out = mx.nd.Convolution(*args, layout=layout, **kwargs)
+            if perm is not None:
+                out = out.transpose(to_first)
+        out.backward(mx.nd.arange(out.size, ctx=ctx).reshape(out.shape) / out.size)
+        outs.append(out)
+        grads.append([a.grad if perm is None or a.ndim == 1 else a.grad.transpose(to_first)
+                      for a in args])
+    assert_almost_equal(outs[1], outs[0], rtol=1e-4, atol=1e-4)
+    for g_last, g_first in zip(grads[1], grads[0]):
+        assert_almost_equal(g_last, g_first, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize('shape', [(2, 6, 5, 7), (2, 6, 13, 10)])
+@pytest.mark.parametrize('num_group', [1, 2])
+@pytest.mark.parametrize('pad', [(0, 0), (1, 1), (2, 1)])
+@pytest.mark.parametrize('dtype', ['float32', 'float64'])
+def test_convolution_winograd(shape, num_group, pad, dtype):
+    # the small images use F(2x2, 3x3) and the large ones F(4x4, 3x3) with partial tiles
+    ctx = default_context()
+    num_filter = 10
+    data = mx.nd.random.uniform(-1, 1, shape, ctx=ctx, dtype=dtype)
+    weight = mx.nd.random.uniform(-1, 1, (num_filter, shape[1] // num_group, 3, 3), ctx=ctx,
+                                  dtype=dtype)
+    bias = mx.nd.random.uniform(-1, 1, (num_filter,), ctx=ctx, dtype=dtype)
+    outs = []
+    for winograd in ['0', '1']:
+        with environment('MXNET_CONV_WINOGRAD', winograd):
+            outs.append(mx.nd.Convolution(data, weight, bias, kernel=(3, 3), pad=pad,
+                                          num_filter=num_filter, num_group=num_group))
+    assert_almost_equal(outs[1], outs[0], rtol=1e-4, atol=1e-4)
+
+
 @pytest.mark.skip(reason="Flaky test https://github.com/apache/incubator-mxnet/issues/14052")
 def test_depthwise_convolution():
     for dim in [1,2]:
@@ -2641,6 +2832,22 @@ def test_larger_transpose():
     assert_allclose(np.transpose(x.asnumpy()), y.asnumpy())
 
 
+@pytest.mark.parametrize('shape,axes', [
+    ((4, 37, 12, 45), (0, 2, 1, 3)),
+    ((4, 37, 12, 45), (0, 2, 3, 1)),
+    ((3, 1, 33, 1, 17), (4, 2, 3, 0, 1)),
+    ((2, 3, 4, 5, 6, 7), (1, 0, 3, 2, 5, 4)),
+    ((64, 65), (1, 0)),
+    ((5, 1, 7), (2, 1, 0)),
+])
+@pytest.mark.parametrize('dtype', ['uint8', 'float16', 'float32', 'int32', 'float64'])
+def test_transpose_collapsed_dims(shape, axes, dtype):
+    x_np = np.random.uniform(-100, 100, size=shape).astype(dtype)
+    y = mx.nd.transpose(mx.nd.array(x_np, dtype=dtype), axes=axes)
+    assert y.dtype == np.dtype(dtype)
+    assert_array_equal(y.asnumpy(), np.transpose(x_np, axes=axes))
+
+
 def test_expand_dims():
     for ndim in range(1, 6):
         for axis in range(-ndim + 1, ndim):
@@ -3560,6 +3767,44 @@ def test_layer_norm(enforce_safe_acc, dtype, forward_check_eps, backward_check_e
                                               finite_grad_check=finite_grad_check)
 
 
+@pytest.mark.parametrize('shape', [(3, 5, 7), (4, 1000)])
+@pytest.mark.parametrize('output_sum', [False, True])
+@pytest.mark.parametrize('train_mode', [True, False])
+def test_add_dropout_layer_norm(shape, output_sum, train_mode):
+    p, eps = 0.5, 1e-3
+    args = [mx.nd.random.uniform(-1, 1, shape=shape), mx.nd.random.uniform(-1, 1, shape=shape),
+            mx.nd.random.uniform(0.5, 1.5, shape=shape[-1:]), mx.nd.random.uniform(-1, 1, shape=shape[-1:])]
+    head_grads = [mx.nd.random.uniform(-1, 1, shape=shape) for _ in range(2)]
+
+    def run(fn):
+        xs = [a.copy() for a in args]
+        for x in xs:
+            x.attach_grad()
+        with mx.autograd.record(train_mode=train_mode):
+            outs = fn(*xs)
+            outs = outs if isinstance(outs, list) else [outs]
+        mx.autograd.backward(outs, head_grads[:len(outs)])
+        return [o.asnumpy() for o in outs] + [x.grad.asnumpy() for x in xs]
+
+    fused = run(lambda x, r, g, b: mx.nd.contrib.add_dropout_layer_norm(x, r, g, b, p=p, eps=eps,
+                                                                        output_sum=output_sum))
+    # the dropped values of data, and only those, get no gradient
+    keep = fused[-4] != 0
+    if train_mode:
+        assert 0.4 < keep.mean() < 0.6
+    else:
+        assert keep.all()
+    mask = mx.nd.array(keep / (1 - p) if train_mode else keep)
+
+    def reference(x, r, g, b):
+        s = x * mask + r
+        out = mx.nd.LayerNorm(s, g, b, eps=eps)
+        return [out, s] if output_sum else out
+
+    for f, r in zip(fused, run(reference)):
+        assert_almost_equal(f, r, rtol=1e-4, atol=1e-4)
+
+
 # Numpy Implementation of Sequence Ops
 def sequence_last_numpy(array, lengths, axis):
     # create new array of dims [batch, seqlen, ...]
@@ -3914,6 +4159,21 @@ def test_mathematical():
     rounding("fix", lambda x: mx.sym.fix(x), lambda x: np.fix(x))
 
 
+def test_float32_exp_log_tanh_erf():
+    # the vectorized float32 functions of the cpu over their whole range, with the special values
+    x = np.concatenate([np.linspace(-110, 100, 100001), np.logspace(-44, 38, 10001), -np.logspace(-44, 38, 10001),
+                        [0., -0., np.inf, -np.inf, np.nan, 88.8, -104.5]]).astype(np.float32)
+    erf = np.vectorize(math.erf, otypes=[np.float64])
+    with np.errstate(all='ignore'):
+        for op, ref in [(mx.nd.exp, np.exp), (mx.nd.log, np.log), (mx.nd.tanh, np.tanh), (mx.nd.erf, erf),
+                        (mx.nd.sigmoid, lambda a: 1 / (1 + np.exp(-a)))]:
+            out = op(mx.nd.array(x, dtype=np.float32)).asnumpy()
+            expected = ref(x.astype(np.float64)).astype(np.float32)
+            assert_almost_equal(out, expected, rtol=1e-6, atol=1e-37, equal_nan=True)
+            number = ~np.isnan(expected)
+            assert np.array_equal(np.signbit(out[number]), np.signbit(expected[number]))
+
+
 def test_special_functions_using_scipy():
     try:
         from scipy import special as scipy_special
@@ -4131,6 +4391,47 @@ def test_order():
                     is_ascend=True)])
 
 
+@pytest.mark.parametrize('dtype', ['float32', 'float16', 'int32'])
+@pytest.mark.parametrize('is_ascend', [True, False])
+def test_topk_small_k_long_axis(dtype, is_ascend):
+    # k much smaller than the axis selects the top k before sorting them, the ties must still be
+    # ordered by index like the full sort
+    for shape, k, axis in [((3, 50000), 20, 1), ((400, 7), 10, 0), ((2, 3000, 2), 64, 1)]:
+        if dtype == 'int32':
+            a_npy = np.random.randint(-100, 100, size=shape).astype(dtype)
+        else:
+            a_npy = np.random.uniform(-1000, 1000, size=shape).astype(dtype)
+        key = a_npy.astype('float64')
+        order = np.argsort(key if is_ascend else -key, axis=axis, kind='stable')
+        expected_indices = np.take(order, np.arange(k), axis=axis)
+        expected_values = np.take_along_axis(a_npy, expected_indices, axis=axis)
+        a = mx.nd.array(a_npy, dtype=dtype)
+        values, indices = mx.nd.topk(a, axis=axis, k=k, ret_typ='both', is_ascend=is_ascend,
+                                     dtype='int64')
+        assert_almost_equal(values.asnumpy(), expected_values)
+        assert_almost_equal(indices.asnumpy(), expected_indices)
+
+
+@pytest.mark.parametrize('dtype', ['float32', 'float64', 'float16', 'int32', 'int64'])
+@pytest.mark.parametrize('is_ascend', [True, False])
+def test_sort_long_segment(dtype, is_ascend):
+    # segments longer than the radix sort threshold, with ties, -0 and 0, in one or few
+    # segments so that the threads share a segment
+    for shape, axis in [((200000,), 0), ((3, 5000), 1), ((4000, 2), 0)]:
+        if dtype in ('int32', 'int64'):
+            a_npy = np.random.randint(-100, 100, size=shape).astype(dtype)
+        else:
+            a_npy = np.random.randint(-50, 50, size=shape).astype(dtype) / 4
+            a_npy.flat[::7] = -0.0
+        key = a_npy.astype('float64')
+        expected = np.argsort(key if is_ascend else -key, axis=axis, kind='stable')
+        a = mx.nd.array(a_npy, dtype=dtype)
+        indices = mx.nd.argsort(a, axis=axis, is_ascend=is_ascend, dtype='int64')
+        assert_almost_equal(indices.asnumpy(), expected)
+        values = mx.nd.sort(a, axis=axis, is_ascend=is_ascend)
+        assert_almost_equal(values.asnumpy(), np.take_along_axis(a_npy, expected, axis=axis))
+
+
 def test_blockgrad():
     a = mx.sym.Variable('a')
     b = mx.sym.BlockGrad(a)
@@ -4456,6 +4757,100 @@ def test_all_finite():
     assert sym_output[0] == 1
 
 
+
+@pytest.mark.parametrize('compute_norms', [False, True])
+@pytest.mark.parametrize('bad_value', [None, np.inf, np.nan])
+def test_multi_all_finite_many_arrays(compute_norms, bad_value):
+    # more arrays than fit in a launch, of several types and sizes over several chunks
+    ctx = default_context()
+    shapes = [(3,), (1,), (100003,), (7, 5)] * 60
+    dtypes = ['float32', 'float16', 'float64']
+    arrays = [mx.nd.random.uniform(-1, 1, shape, ctx=ctx).astype(dtypes[i % len(dtypes)])
+              for i, shape in enumerate(shapes)]
+    if bad_value is not None:
+        arrays[-2][50000] = bad_value
+    outputs = mx.nd.multi_all_finite(*arrays, num_arrays=len(arrays), compute_norms=compute_norms)
+    if compute_norms:
+        finite, norms = outputs
+        expected = [np.linalg.norm(a.asnumpy().astype(np.float32).reshape(-1)) for a in arrays]
+        norms = norms.asnumpy()
+        assert norms.shape == (len(arrays),)
+        assert np.isfinite(norms[-2]) == (bad_value is None)
+        assert_almost_equal(norms[:-2], np.array(expected[:-2]), rtol=1e-3, atol=1e-3)
+    else:
+        finite = outputs
+    assert finite.asscalar() == (bad_value is None)
+
+
+def test_amp_update_loss_scale():
+    state = mx.nd.array([1024, 1, 0])
+    for step in range(1, 3):
+        mx.nd.amp_update_loss_scale(state, scale_window=3, out=state)
+        assert_almost_equal(state, np.array([1024, 1, step]))
+    # increased after scale_window finite steps
+    mx.nd.amp_update_loss_scale(state, scale_window=3, out=state)
+    assert_almost_equal(state, np.array([2048, 1, 0]))
+    mx.nd.amp_update_loss_scale(state, scale_window=1, max_loss_scale=3000, out=state)
+    assert_almost_equal(state, np.array([3000, 1, 0]))
+    # decreased after a step with gradients that are not finite, as written by multi_all_finite
+    mx.nd.multi_all_finite(mx.nd.array([1, np.inf]), num_arrays=1, out=state[1:2])
+    mx.nd.amp_update_loss_scale(state, out=state)
+    assert_almost_equal(state, np.array([1500, 0, 0]))
+
+
+@pytest.mark.parametrize('momentum', [0, 0.9])
+@pytest.mark.parametrize('multi_precision', [False, True])
+@pytest.mark.parametrize('finite', [True, False])
+def test_preloaded_multi_sgd_with_amp_state(momentum, multi_precision, finite):
+    dtype = np.float16 if multi_precision else np.float32
+    shapes = [(3, 4), (7,), (2, 5, 3)]
+    loss_scale = 128.
+    weights = [mx.nd.random.uniform(shape=shape).astype(dtype) for shape in shapes]
+    grads = [(mx.nd.random.uniform(-1, 1, shape=shape) * loss_scale).astype(dtype) for shape in shapes]
+    if not finite:
+        grads[1][3] = np.inf
+    lrs = mx.nd.array([0.1, 0.2, 0.3])
+    wds = mx.nd.array([0.01, 0.02, 0.0])
+    state = mx.nd.array([loss_scale, 1, 0])
+    mx.nd.multi_all_finite(*grads, num_arrays=len(grads), out=state[1:2])
+
+    def update(grads, rescale_grad, amp_state):
+        ws = [w.copy() for w in weights]
+        moms = [mx.nd.zeros(shape) + 0.5 for shape in shapes]
+        ws32 = [w.astype(np.float32) for w in weights]
+        kwargs = {'num_weights': len(shapes), 'rescale_grad': rescale_grad, 'out': ws}
+        if amp_state is not None:
+            kwargs['with_amp_state'] = True
+        extra = [lrs, wds] + ([amp_state] if amp_state is not None else [])
+        if momentum > 0:
+            kwargs['momentum'] = momentum
+            if multi_precision:
+                args = [a for arrs in zip(ws, grads, moms, ws32) for a in arrs]
+                mx.nd.preloaded_multi_mp_sgd_mom_update(*args, *extra, **kwargs)
+            else:
+                args = [a for arrs in zip(ws, grads, moms) for a in arrs]
+                mx.nd.preloaded_multi_sgd_mom_update(*args, *extra, **kwargs)
+        elif multi_precision:
+            args = [a for arrs in zip(ws, grads, ws32) for a in arrs]
+            mx.nd.preloaded_multi_mp_sgd_update(*args, *extra, **kwargs)
+        else:
+            args = [a for arrs in zip(ws, grads) for a in arrs]
+            mx.nd.preloaded_multi_sgd_update(*args, *extra, **kwargs)
+        return ws, moms, ws32
+
+    ws, moms, ws32 = update(grads, 0.5, state)
+    if finite:
+        # the gradients are divided by the loss scale of the state
+        ref_ws, ref_moms, ref_ws32 = update(grads, 0.5 / loss_scale, None)
+    else:
+        # the step is skipped
+        ref_ws, ref_moms, ref_ws32 = weights, [mx.nd.zeros(shape) + 0.5 for shape in shapes], \
+            [w.astype(np.float32) for w in weights]
+    for arrs, refs in [(ws, ref_ws), (moms, ref_moms), (ws32, ref_ws32)]:
+        for arr, ref in zip(arrs, refs):
+            assert_almost_equal(arr, ref)
+
+
 def test_repeat():
     def test_repeat_forward():
         ndim_max = 6 # max number of dims of the ndarray
@@ -4962,6 +5357,44 @@ def test_softmax_dtype():
                               'float32', 'float64', 'float64')
 
 
+def test_softmax_cpu_isa(tmpdir):
+    import platform
+    import subprocess
+    import sys
+    # the instruction set of the kernels is selected once per process
+    script = '''
+import sys
+import mxnet as mx
+x = mx.nd.load(sys.argv[1])['x']
+x_bf16 = mx.nd.amp_cast(x, dtype='bfloat16')
+out = {'softmax': mx.nd.softmax(x, temperature=0.7),
+       'log_softmax': mx.nd.log_softmax(x),
+       'softmax_bf16': mx.nd.amp_cast(mx.nd.softmax(x_bf16), dtype='float32'),
+       'log_softmax_bf16': mx.nd.amp_cast(mx.nd.log_softmax(x_bf16), dtype='float32')}
+mx.nd.save(sys.argv[2], out)
+'''
+    x = mx.nd.random.normal(scale=3, shape=(5, 37))
+    x_path = str(tmpdir.join('x.params'))
+    mx.nd.save(x_path, {'x': x})
+    data = x.asnumpy()
+    data_bf16 = mx.nd.amp_cast(mx.nd.amp_cast(x, dtype='bfloat16'), dtype='float32').asnumpy()
+    if platform.machine() == 'aarch64':
+        isas = ['baseline', 'neon']
+    else:
+        isas = ['baseline', 'avx2', 'avx512']
+    for isa in isas:
+        out_path = str(tmpdir.join(isa + '.params'))
+        env = dict(os.environ, MXNET_CPU_MAX_ISA=isa)
+        subprocess.check_call([sys.executable, '-c', script, x_path, out_path], env=env)
+        out = mx.nd.load(out_path)
+        assert_almost_equal(out['softmax'], np_softmax(data, temperature=0.7),
+                            rtol=1e-5, atol=1e-6)
+        assert_almost_equal(out['log_softmax'], np.log(np_softmax(data)), rtol=1e-5, atol=1e-5)
+        assert_almost_equal(out['softmax_bf16'], np_softmax(data_bf16), rtol=1e-2, atol=1e-3)
+        assert_almost_equal(out['log_softmax_bf16'], np.log(np_softmax(data_bf16)),
+                            rtol=1e-2, atol=1e-2)
+
+
 def test_softmax_with_length():
     def np_softmax_with_length(data, length):
         res = np.zeros(data.shape)
@@ -5300,6 +5733,70 @@ def test_ctc_loss_grad():
         for label in ['first', 'last']:
             check_ctc_loss_grad(label, contrib=contrib)
 
+def test_ctc_beam_search():
+    def ctc_beam_search_ref(acts, length, beam_size, top_k, blank, lm, lm_weight, bonus):
+        logaddexp = np.logaddexp
+        lp = acts - acts.max(axis=1, keepdims=True)
+        lp = lp - np.log(np.exp(lp).sum(axis=1, keepdims=True))
+        tokens = [a for a in range(acts.shape[1]) if a != blank]
+        beams = [((), 0., -np.inf, 0.)]
+        for t in range(length):
+            order = sorted(tokens, key=lambda a: -acts[t, a])
+            frame = set(order[:top_k] if top_k > 0 else order)
+            existing = set(b[0] for b in beams)
+            nxt = {}
+            for prefix, pb, pnb, score in beams:
+                entry = nxt.setdefault(prefix, [-np.inf, -np.inf, score])
+                entry[0] = logaddexp(entry[0], logaddexp(pb, pnb) + lp[t, blank])
+                if prefix:
+                    entry[1] = logaddexp(entry[1], pnb + lp[t, prefix[-1]])
+            for prefix, pb, pnb, score in beams:
+                for c in tokens:
+                    new = prefix + (c,)
+                    if new not in existing and c not in frame:
+                        continue
+                    prev = pb if prefix and prefix[-1] == c else logaddexp(pb, pnb)
+                    if new not in nxt:
+                        extra = bonus
+                        if lm is not None:
+                            extra += lm_weight * lm[prefix[-1] if prefix else blank, c]
+                        nxt[new] = [-np.inf, -np.inf, score + extra]
+                    nxt[new][1] = logaddexp(nxt[new][1], prev + lp[t, c])
+            ranked = sorted(nxt.items(), key=lambda kv: -(logaddexp(kv[1][0], kv[1][1]) + kv[1][2]))
+            beams = [(k, v[0], v[1], v[2]) for k, v in ranked[:beam_size]
+                     if logaddexp(v[0], v[1]) > -np.inf]
+        return beams
+
+    seq_len, batch, alphabet = 12, 3, 6
+    acts = np.random.normal(scale=3, size=(seq_len, batch, alphabet)).astype(np.float32)
+    lengths = np.array([seq_len, 7, 0], dtype=np.float32)
+    lm = np.log(np.random.dirichlet(np.ones(alphabet), size=alphabet)).astype(np.float32)
+    for blank_label, beam_size, top_k, use_lm in [('first', 4, 0, False), ('last', 4, 3, False),
+                                                  ('first', 5, 2, True), ('last', 1, 0, True)]:
+        blank = 0 if blank_label == 'first' else alphabet - 1
+        args = [mx.nd.array(acts), mx.nd.array(lengths)]
+        if use_lm:
+            args.append(mx.nd.array(lm))
+        tokens, scores = mx.nd.contrib.ctc_beam_search(
+            *args, beam_size=beam_size, top_k=top_k, blank_label=blank_label,
+            use_data_lengths=True, use_lm=use_lm, lm_weight=0.5, insertion_bonus=0.3)
+        assert tokens.shape == (batch, beam_size, seq_len)
+        assert tokens.dtype == np.int32
+        tokens, scores = tokens.asnumpy(), scores.asnumpy()
+        for b in range(batch):
+            beams = ctc_beam_search_ref(acts[:, b], int(lengths[b]), beam_size, top_k, blank,
+                                        lm if use_lm else None, 0.5, 0.3)
+            for r in range(beam_size):
+                if r >= len(beams):
+                    assert scores[b, r] == -np.inf
+                    assert_array_equal(tokens[b, r], -1)
+                    continue
+                prefix, pb, pnb, score = beams[r]
+                expected = -np.ones(seq_len, dtype=np.int32)
+                expected[:len(prefix)] = prefix
+                assert_array_equal(tokens[b, r], expected)
+                assert_allclose(scores[b, r], np.logaddexp(pb, pnb) + score, rtol=1e-4, atol=1e-4)
+
 def test_quantization_op():
     min0 = mx.nd.array([0.0])
     max0 = mx.nd.array([1.0])
@@ -5777,6 +6274,61 @@ def test_custom_op_exc():
         pytest.raises(MXNetError, custom_exc4)
 
 
+def test_custom_op_async():
+    import threading
+
+    class AsyncSqr(mx.operator.CustomOp):
+        def __init__(self, error):
+            super(AsyncSqr, self).__init__()
+            self.error = error
+
+        def forward_async(self, is_train, req, in_data, out_data, aux, on_complete):
+            def run():
+                self.assign(out_data[0], req[0], in_data[0] * in_data[0])
+                out_data[0].wait_to_read()
+                on_complete(self.error)
+            threading.Thread(target=run).start()
+
+        def backward_async(self, req, out_grad, in_data, out_data, in_grad, aux, on_complete):
+            def run():
+                self.assign(in_grad[0], req[0], 2 * in_data[0] * out_grad[0])
+                in_grad[0].wait_to_read()
+                on_complete()
+            threading.Thread(target=run).start()
+
+    @mx.operator.register("async_sqr")
+    class AsyncSqrProp(mx.operator.CustomOpProp):
+        def __init__(self, error=''):
+            super(AsyncSqrProp, self).__init__(need_top_grad=True)
+            self.error = error or None
+
+        def list_arguments(self):
+            return ['data']
+
+        def list_outputs(self):
+            return ['output']
+
+        def infer_shape(self, in_shape):
+            return in_shape, [in_shape[0]], []
+
+        def create_operator(self, ctx, shapes, dtypes):
+            return AsyncSqr(self.error)
+
+    x = mx.nd.array(np.random.uniform(-1, 1, size=(4, 10)))
+    x.attach_grad()
+    with mx.autograd.record():
+        ys = [mx.nd.Custom(x, op_type='async_sqr') for _ in range(8)]
+        y = mx.nd.add_n(*ys)
+    y.backward()
+    assert_almost_equal(y, 8 * x.asnumpy() ** 2)
+    assert_almost_equal(x.grad, 16 * x.asnumpy())
+
+    def custom_async_exc():
+        z = mx.nd.Custom(x, op_type='async_sqr', error='failed asynchronously')
+        z.wait_to_read()
+    pytest.raises(MXNetError, custom_async_exc)
+
+
 def test_psroipooling():
     for num_rois in [1, 2]:
         for num_classes, num_group in itertools.product([2, 3], [2, 3]):
@@ -5864,6 +6416,42 @@ def test_deformable_convolution(num_batch, num_channel_data_deformable_group, in
                                grad_nodes=grad_nodes, ctx=mx.gpu(0), numeric_eps=1.0/64)
 
 
+@mx.util.use_np
+@pytest.mark.parametrize('modulated', [False, True])
+@pytest.mark.parametrize('num_group,num_deformable_group', [(1, 1), (2, 1), (1, 2), (2, 4)])
+@pytest.mark.parametrize('stride,pad,dilate', [((1, 1), (1, 1), (1, 1)), ((2, 2), (2, 1), (2, 1))])
+def test_deformable_convolution_implicit_gemm(modulated, num_group, num_deformable_group,
+                                              stride, pad, dilate):
+    num_batch, channels, height, width, num_filter = 3, 8, 9, 11, 70
+    kernel = (3, 3)
+    out_h = (height + 2 * pad[0] - dilate[0] * (kernel[0] - 1) - 1) // stride[0] + 1
+    out_w = (width + 2 * pad[1] - dilate[1] * (kernel[1] - 1) - 1) // stride[1] + 1
+    ksize = kernel[0] * kernel[1]
+    data = mx.np.random.uniform(size=(num_batch, channels, height, width))
+    # offsets past the borders exercise the clamped and zero padded samples
+    offset = mx.np.random.uniform(-3, 3, size=(num_batch, num_deformable_group * 2 * ksize,
+                                               out_h, out_w))
+    weight = mx.np.random.normal(size=(num_filter, channels // num_group) + kernel)
+    bias = mx.np.random.normal(size=(num_filter,))
+    kwargs = dict(kernel=kernel, stride=stride, pad=pad, dilate=dilate, num_filter=num_filter,
+                  num_group=num_group, num_deformable_group=num_deformable_group)
+    if modulated:
+        mask = mx.np.random.uniform(size=(num_batch, num_deformable_group * ksize, out_h, out_w))
+        args = [data, offset, mask, weight, bias]
+        op = mx.npx.modulated_deformable_convolution
+        kwargs['im2col_step'] = 1
+    else:
+        args = [data, offset, weight, bias]
+        op = mx.npx.deformable_convolution
+
+    outs = []
+    for implicit_gemm in ['0', '1']:
+        with environment('MXNET_DEFORMABLE_CONV_IMPLICIT_GEMM', implicit_gemm):
+            outs.append(op(*args, **kwargs).asnumpy())
+    assert outs[0].shape == (num_batch, num_filter, out_h, out_w)
+    assert_almost_equal(outs[1], outs[0], rtol=1e-4, atol=1e-4)
+
+
 def _validate_sample_location(input_rois, input_offset, spatial_scale, pooled_w, pooled_h, sample_per_part, part_size, output_dim, num_classes, trans_std, feat_h, feat_w):
     num_rois = input_rois.shape[0]
     output_offset = input_offset.copy()
@@ -6508,6 +7096,43 @@ def test_laop_4():
     #print('float32')
     check_fw(test_syevd, [a_np], [u_np, l_np], np.float32)
 
+@pytest.mark.parametrize('n', [1, 3, 8, 32, 70])
+@pytest.mark.parametrize('lower', [True, False])
+def test_laop_batched_small_matrices(n, lower):
+    # batches of small matrices are processed as a whole, larger ones matrix by matrix
+    batch = 17
+    dtype = np.float64
+    x = np.random.uniform(-1, 1, (batch, n, n))
+    a = np.matmul(x, x.transpose(0, 2, 1)) + n * np.eye(n)
+    chol = np.linalg.cholesky(a)
+    factor = chol if lower else chol.transpose(0, 2, 1)
+    a_nd = mx.nd.array(a, dtype=dtype)
+    factor_nd = mx.nd.array(factor, dtype=dtype)
+    assert_almost_equal(mx.nd.linalg.potrf(a_nd, lower=lower), factor, rtol=1e-8, atol=1e-8)
+    assert_almost_equal(mx.nd.linalg.potri(factor_nd, lower=lower), np.linalg.inv(a),
+                        rtol=1e-8, atol=1e-8)
+    for rightside, transpose in itertools.product([False, True], [False, True]):
+        b = np.random.uniform(-1, 1, (batch, 5, n) if rightside else (batch, n, 5))
+        inv = np.linalg.inv(factor.transpose(0, 2, 1) if transpose else factor)
+        expected = 2 * (np.matmul(b, inv) if rightside else np.matmul(inv, b))
+        res = mx.nd.linalg.trsm(factor_nd, mx.nd.array(b, dtype=dtype), transpose=transpose,
+                                rightside=rightside, lower=lower, alpha=2.)
+        assert_almost_equal(res, expected, rtol=1e-8, atol=1e-8)
+    u, lam = mx.nd.linalg.syevd(a_nd)
+    u, lam = u.asnumpy(), lam.asnumpy()
+    assert_almost_equal(lam, np.linalg.eigvalsh(a), rtol=1e-8, atol=1e-8)
+    assert_almost_equal(np.matmul(u.transpose(0, 2, 1) * lam[:, None, :], u), a, rtol=1e-8, atol=1e-8)
+    c = np.random.uniform(-1, 1, (batch, n, n + 2))
+    q, l = mx.nd.linalg.gelqf(mx.nd.array(c, dtype=dtype))
+    q, l = q.asnumpy(), l.asnumpy()
+    assert_almost_equal(np.matmul(q, q.transpose(0, 2, 1)), np.broadcast_to(np.eye(n), (batch, n, n)),
+                        rtol=1e-8, atol=1e-8)
+    assert_almost_equal(l, np.tril(l))
+    assert_almost_equal(np.matmul(l, q), c, rtol=1e-8, atol=1e-8)
+    if default_context() == mx.cpu():
+        a[batch // 2] = -np.eye(n)
+        assertRaises(MXNetError, lambda: mx.nd.linalg.potrf(mx.nd.array(a, dtype=dtype)).wait_to_read())
+
 def test_laop_5():
     # tests for diagonal and triangular matrix extraction and generation
     data = mx.symbol.Variable('data')
@@ -6789,6 +7414,36 @@ def test_dropout():
         check_dropout_axes(0.25, nshape, axes = (1, 2, 3), cudnn_off=False)
 
 
+@pytest.mark.parametrize('dtype', [np.float16, np.float32, np.float64])
+@pytest.mark.parametrize('ratio', [0.0, 0.25, 0.5, 1.0])
+def test_dropout_packed_mask(dtype, ratio):
+    # 91 elements, the last byte of the mask is partial
+    shape = (7, 13)
+    x = mx.nd.ones(shape, dtype=dtype)
+    x.attach_grad()
+    ograd = mx.nd.random.uniform(shape=shape, dtype=dtype)
+    with mx.autograd.record():
+        y = mx.nd.Dropout(x, p=ratio, packed_mask=True)
+    y.backward(ograd)
+    out = y.asnumpy()
+    if ratio == 1.0:
+        assert np.isnan(out).all()
+        return
+    kept = out != 0
+    assert_almost_equal(out[kept], np.full(kept.sum(), 1 / (1 - ratio), dtype=dtype))
+    if ratio == 0.0:
+        assert kept.all()
+    elif ratio == 0.5:
+        assert 0 < kept.sum() < out.size
+    assert_almost_equal(x.grad.asnumpy(), ograd.asnumpy() * out, rtol=1e-3, atol=1e-3)
+
+    y = mx.sym.Dropout(mx.sym.var('data'), p=ratio, packed_mask=True)
+    _, out_shapes, _ = y.get_internals().infer_shape(data=shape)
+    _, out_types, _ = y.get_internals().infer_type(data=dtype)
+    assert out_shapes[-1] == ((shape[0] * shape[1] + 7) // 8,)
+    assert out_types[-1] == np.uint8
+
+
 @pytest.mark.skip(reason="test fails intermittently. temporarily disabled till it gets fixed. tracked at https://github.com/apache/incubator-mxnet/issues/11290")
 def test_scatter_gather_nd():
     def check(data, idx):
@@ -7513,6 +8168,24 @@ def test_bilinear_resize_op():
     check_bilinear_resize_modes_op(shape_1, shape_1=shape_0, mode='like')
     check_bilinear_resize_align_corners_op()
 
+@pytest.mark.parametrize('shape,height,width', [
+    ((1, 1, 37, 23), 75, 41),
+    ((1, 3, 64, 48), 17, 29),
+    ((2, 5, 9, 40), 30, 12)])
+@pytest.mark.parametrize('align_corners', [True, False])
+def test_bilinear_resize_adjoint(shape, height, width, align_corners):
+    # few planes of many rows go through blocks of rows, whose gradients must add up to
+    # the adjoint of the forward pass: <resize(x), g> == <x, resize_backward(g)>
+    x = mx.nd.random.uniform(shape=shape, dtype='float64')
+    g = mx.nd.random.uniform(shape=shape[:2] + (height, width), dtype='float64')
+    x.attach_grad()
+    with mx.autograd.record():
+        y = mx.nd.contrib.BilinearResize2D(x, height=height, width=width,
+                                           align_corners=align_corners)
+    y.backward(g)
+    assert_almost_equal((y * g).sum(), (x * x.grad).sum(), rtol=1e-10, atol=1e-10)
+
+
 def test_multi_proposal_op():
     # paramters
     feature_stride = 16
@@ -8031,10 +8704,42 @@ def test_op_roi_align():
                                grad_nodes={'data': 'add', 'rois': 'null'},
                                numeric_eps=1e-4, rtol=1e-1, atol=1e-4, ctx=ctx)
 
+    def test_roi_align_nhwc(sampling_ratio=0, position_sensitive=False, aligned=False):
+        ctx = default_context()
+        N, C, H, W = 3, 40, 20, 24
+        pooled_size = (3, 2)
+        C = C * pooled_size[0] * pooled_size[1] if position_sensitive else C
+        data = mx.nd.random.uniform(-1, 1, (N, C, H, W), ctx=ctx)
+        R = 9
+        center_xy = mx.nd.random.uniform(0, 96, (R, 2), ctx=ctx)
+        wh = mx.nd.random.uniform(8, 96, (R, 2), ctx=ctx)
+        batch_ind = mx.nd.array(np.random.randint(0, N, size=(R, 1)), ctx=ctx)
+        batch_ind[0] = -1
+        rois = mx.nd.concat(batch_ind, center_xy - wh / 2, center_xy + wh / 2, dim=1)
+        kwargs = dict(pooled_size=pooled_size, spatial_scale=0.25, sample_ratio=sampling_ratio,
+                      position_sensitive=position_sensitive, aligned=aligned)
+        outs, grads = [], []
+        for layout, x in [('NCHW', data), ('NHWC', data.transpose((0, 2, 3, 1)))]:
+            x = x.copy()
+            x.attach_grad()
+            with mx.autograd.record():
+                out = mx.nd.contrib.ROIAlign(x, rois, layout=layout, **kwargs)
+            if layout == 'NHWC':
+                out = out.transpose((0, 3, 1, 2))
+            out.backward(mx.nd.arange(out.size, ctx=ctx).reshape(out.shape) / out.size)
+            outs.append(out)
+            grads.append(x.grad if layout == 'NCHW' else x.grad.transpose((0, 3, 1, 2)))
+        assert_almost_equal(outs[1], outs[0], rtol=1e-5, atol=1e-5)
+        assert_almost_equal(grads[1], grads[0], rtol=1e-5, atol=1e-5)
+        assert (outs[0][0].asnumpy() == 0).all()
+
     test_roi_align_value()
     test_roi_align_value(sampling_ratio=2)
     test_roi_align_value(position_sensitive=True)
     test_roi_align_autograd()
+    test_roi_align_nhwc()
+    test_roi_align_nhwc(sampling_ratio=2, aligned=True)
+    test_roi_align_nhwc(position_sensitive=True)
 
 def test_op_rroi_align():
     T = np.float32
@@ -8484,6 +9189,34 @@ def test_invalid_max_pooling_pad_type_same():
         pooling_convention="same")
 
 
+@pytest.mark.parametrize('dim', [1, 2, 3])
+@pytest.mark.parametrize('pool_type,extra', [('max', {}), ('avg', {}),
+                                             ('avg', {'count_include_pad': False}),
+                                             ('sum', {}), ('lp', {'p_value': 2})])
+def test_pooling_channels_last(dim, pool_type, extra):
+    ctx = default_context()
+    # more channels than a block of the cpu kernels
+    data = mx.nd.random.uniform(0.1, 1, (2, 70) + (6,) * dim, ctx=ctx)
+    to_last = (0,) + tuple(range(2, dim + 2)) + (1,)
+    to_first = (0, dim + 1) + tuple(range(1, dim + 1))
+    first, last = [('NCW', 'NWC'), ('NCHW', 'NHWC'), ('NCDHW', 'NDHWC')][dim - 1]
+    kwargs = dict(kernel=(3,) * dim, stride=(2,) * dim, pad=(1,) * dim, pool_type=pool_type,
+                  cudnn_off=True, **extra)
+    outs, grads = [], []
+    for layout, perm in [(first, None), (last, to_last)]:
+        x = (data if perm is None else data.transpose(perm)).copy()
+        x.attach_grad()
+        with mx.autograd.record():
+            out = mx.nd.Pooling(x, layout=layout, **kwargs)
+            if perm is not None:
+                out = out.transpose(to_first)
+        out.backward(mx.nd.arange(out.size, ctx=ctx).reshape(out.shape) / out.size)
+        outs.append(out)
+        grads.append(x.grad if perm is None else x.grad.transpose(to_first))
+    assert_almost_equal(outs[1], outs[0], rtol=1e-5, atol=1e-5)
+    assert_almost_equal(grads[1], grads[0], rtol=1e-5, atol=1e-5)
+
+
 @pytest.mark.serial
 def test_image_normalize():
     # Part 1 - Test 3D input with 3D mean/std
@@ -8598,6 +9331,57 @@ def test_image_normalize():
     # check backward using finite difference
     check_numeric_gradient(img_norm_sym, [data_in_4d], atol=0.001)
 
+
+def test_image_batch_preprocess():
+    def taps(dst, resized, src):
+        s = np.maximum((dst.astype(np.float32) + np.float32(0.5)) * np.float32(src) /
+                       np.float32(resized) - np.float32(0.5), 0).astype(np.float32)
+        i0 = np.minimum(s.astype(np.int64), src - 1)
+        frac = np.where(s.astype(np.int64) >= src - 1, 0, s - i0).astype(np.float32)
+        return i0, np.minimum(i0 + 1, src - 1), frac
+
+    def numpy_preprocess(image, out_w, out_h, mode, mean, std, pad_value):
+        h, w, c = image.shape
+        scale_h, scale_w = np.float32(out_h) / np.float32(h), np.float32(out_w) / np.float32(w)
+        scale = min(scale_h, scale_w) if mode == 'letterbox' else max(scale_h, scale_w)
+        rh = int(np.floor(np.float32(h) * scale + 0.5))
+        rw = int(np.floor(np.float32(w) * scale + 0.5))
+        if mode == 'letterbox':
+            rh, rw = min(out_h, max(1, rh)), min(out_w, max(1, rw))
+        else:
+            rh, rw = max(out_h, rh), max(out_w, rw)
+        ry = np.arange(out_h) - int((out_h - rh) / 2)
+        rx = np.arange(out_w) - int((out_w - rw) / 2)
+        y0, y1, fy = taps(ry, rh, h)
+        x0, x1, fx = taps(rx, rw, w)
+        img = image.astype(np.float32)
+        fx, fy = fx[None, :, None], fy[:, None, None]
+        top = (1 - fx) * img[y0][:, x0] + fx * img[y0][:, x1]
+        bot = (1 - fx) * img[y1][:, x0] + fx * img[y1][:, x1]
+        out = (1 - fy) * top + fy * bot
+        inside = ((ry >= 0) & (ry < rh))[:, None] & ((rx >= 0) & (rx < rw))[None, :]
+        out[~inside] = pad_value
+        return ((out / 255 - np.array(mean)) / np.array(std)).transpose(2, 0, 1)
+
+    mean, std = (0.485, 0.456, 0.406), (0.229, 0.224, 0.225)
+    # more images than one kernel launch takes
+    sizes = [(np.random.randint(5, 40), np.random.randint(5, 40)) for _ in range(70)]
+    sizes[:3] = [(48, 64), (64, 48), (20, 20)]
+    for channels in [1, 3]:
+        images = [np.random.randint(0, 256, size=(h, w, channels)).astype(np.uint8)
+                  for h, w in sizes]
+        for mode in ['letterbox', 'center_crop']:
+            for out_w, out_h in [(32, 32), (24, 16)]:
+                out = mx.nd.image.batch_preprocess(
+                    *[mx.nd.array(img, dtype=np.uint8) for img in images],
+                    num_images=len(images), size=(out_w, out_h), mode=mode,
+                    mean=mean[:channels], std=std[:channels], pad_value=114)
+                assert out.shape == (len(images), channels, out_h, out_w)
+                assert out.dtype == np.float32
+                expected = np.stack([numpy_preprocess(img, out_w, out_h, mode, mean[:channels],
+                                                      std[:channels], 114) for img in images])
+                assert_almost_equal(out.asnumpy(), expected, rtol=1e-4, atol=1e-4)
+
 @pytest.mark.serial
 def test_index_array():
     def test_index_array_default():
@@ -87,6 +87,17 @@ def test_sgd():
                                   dtype, w_stype='csr', g_stype='csr')
 
 
+
+@pytest.mark.parametrize('dtype', [np.float16, np.float32])
+def test_sgd_aggregate_large_and_small(dtype):
+    # the aggregated update of a CPU cuts the weights into chunks of 16384 elements
+    shapes = [(40000,), (3, 4), (128, 128), (1,)]
+    kwarg = {'momentum': 0.9, 'wd': 0.03, 'clip_gradient': 0.4, 'rescale_grad': 0.8,
+             'multi_precision': dtype == np.float16}
+    compare_optimizer(mx.optimizer.SGD(use_fused_step=False, **kwarg),
+                      mx.optimizer.SGD(use_fused_step=True, aggregate_num=np.inf, **kwarg),
+                      shapes, dtype, rtol=1e-3, atol=1e-4)
+
 class PySparseSGD(mx.optimizer.Optimizer):
     """python reference implemenation of sgd"""
     def __init__(self, learning_rate=0.1, momentum=0.0, **kwargs):
@@ -858,6 +869,128 @@ def test_sparse_adagrad():
                                   g_stype='row_sparse')
 
 
+def test_multi_sparse_updates_many_weights():
+    # more weights than a kernel launch takes, with dense and row_sparse weights and some
+    # gradients without rows
+    num_weights = 50
+    shapes = [(np.random.randint(1, 20), np.random.randint(1, 5)) for _ in range(num_weights)]
+    w_stypes = ['default' if i % 2 else 'row_sparse' for i in range(num_weights)]
+    weights = [rand_ndarray(shape, stype, density=1) for shape, stype in zip(shapes, w_stypes)]
+    grads = [rand_ndarray(shape, 'row_sparse', density=0 if i % 7 == 0 else 0.3)
+             for i, shape in enumerate(shapes)]
+    lrs = [0.1 + 0.01 * i for i in range(num_weights)]
+    wds = [0.001 * i for i in range(num_weights)]
+    kwargs = {'rescale_grad': 0.5, 'clip_gradient': 0.8}
+
+    def states(num_states):
+        return [[mx.nd.zeros(w.shape, stype=w.stype) for _ in range(num_states)] for w in weights]
+
+    expected = [w.copy() for w in weights]
+    expected_states = states(2)
+    for w, g, (m, v), lr, wd in zip(expected, grads, expected_states, lrs, wds):
+        mx.nd.adam_update(w, g, m, v, out=w, lr=lr, wd=wd, lazy_update=True, **kwargs)
+    out = [w.copy() for w in weights]
+    out_states = states(2)
+    mx.nd.multi_lazy_adam_update(*[a for w, g, (m, v) in zip(out, grads, out_states) for a in (w, g, m, v)],
+                                 out=out, num_weights=num_weights, lrs=lrs, wds=wds, **kwargs)
+    for w1, w2, s1, s2 in zip(expected, out, expected_states, out_states):
+        assert_almost_equal(w1, w2, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(s1[0], s2[0], rtol=1e-5, atol=1e-6)
+        assert_almost_equal(s1[1], s2[1], rtol=1e-5, atol=1e-6)
+
+    expected = [w.copy() for w in weights]
+    expected_states = states(1)
+    for w, g, (h,), lr in zip(expected, grads, expected_states, lrs):
+        mx.nd.sparse.adagrad_update(w, g, h, out=w, lr=lr, **kwargs)
+    out = [w.copy() for w in weights]
+    out_states = states(1)
+    mx.nd.sparse.multi_adagrad_update(*[a for w, g, (h,) in zip(out, grads, out_states) for a in (w, g, h)],
+                                      out=out, num_weights=num_weights, lrs=lrs, wds=[0] * num_weights,
+                                      **kwargs)
+    for w1, w2, s1, s2 in zip(expected, out, expected_states, out_states):
+        assert_almost_equal(w1, w2, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(s1[0], s2[0], rtol=1e-5, atol=1e-6)
+
+
+def test_multi_tensor_updates_many_weights():
+    # more weights than a kernel launch takes, with an empty weight
+    num_weights = 130
+    shapes = [(np.random.randint(1, 20), np.random.randint(1, 5)) for _ in range(num_weights)]
+    shapes[3] = (0, 4)
+    lrs = [0.1 + 0.01 * i for i in range(num_weights)]
+    wds = [0.001 * i for i in range(num_weights)]
+    kwargs = {'rescale_grad': 0.5, 'clip_gradient': 0.8}
+
+    def check(single_update, multi_update, num_states, dtype='float32', mp=False, **op_kwargs):
+        weights = [mx.nd.random.uniform(-1, 1, shape=shape).astype(dtype) for shape in shapes]
+        grads = [mx.nd.random.uniform(-2, 2, shape=shape).astype(dtype) for shape in shapes]
+        state_dtype = 'float32' if mp else dtype
+        def states():
+            return [[mx.nd.random.uniform(0, 1, shape=w.shape).astype(state_dtype)
+                     for _ in range(num_states)] + ([w.astype('float32')] if mp else [])
+                    for w in weights]
+        initial_states = states()
+        expected = [w.copy() for w in weights]
+        expected_states = [[a.copy() for a in s] for s in initial_states]
+        for w, g, s, lr, wd in zip(expected, grads, expected_states, lrs, wds):
+            single_update(w, g, *s, out=w, lr=lr, wd=wd, **kwargs, **op_kwargs)
+        out = [w.copy() for w in weights]
+        out_states = [[a.copy() for a in s] for s in initial_states]
+        multi_update(*[a for w, g, s in zip(out, grads, out_states) for a in [w, g] + s],
+                     out=out, num_weights=num_weights, lrs=lrs, wds=wds, **kwargs, **op_kwargs)
+        tol = {'rtol': 1e-2, 'atol': 1e-2} if dtype == 'float16' else {'rtol': 1e-5, 'atol': 1e-6}
+        for w1, w2, s1, s2 in zip(expected, out, expected_states, out_states):
+            assert_almost_equal(w1, w2, **tol)
+            for a1, a2 in zip(s1, s2):
+                assert_almost_equal(a1, a2, rtol=1e-5, atol=1e-6)
+
+    check(mx.nd.adam_update, mx.nd.multi_adam_update, 2, beta1=0.8, beta2=0.9, epsilon=1e-6)
+    check(mx.nd.rmsprop_update, mx.nd.multi_rmsprop_update, 1, rho=0.8, clip_weights=0.9)
+    for dtype in ['float32', 'float64']:
+        check(mx.nd.nag_mom_update, mx.nd.multi_nag_mom_update, 1, dtype=dtype, momentum=0.9)
+    check(mx.nd.mp_nag_mom_update, mx.nd.multi_mp_nag_mom_update, 1, dtype='float16', mp=True,
+          momentum=0.9)
+
+    arrays = [mx.nd.random.uniform(-1, 1, shape=shape) for shape in shapes]
+    expected_norm = math.sqrt(sum((a.asnumpy() ** 2).sum() for a in arrays))
+    expected = [a.asnumpy() * min(1, 2.0 / (expected_norm + 1e-8)) for a in arrays]
+    norm = mx.nd.multi_clip_global_norm(*arrays, num_arrays=num_weights, max_norm=2.0)
+    assert_almost_equal(norm.asnumpy(), np.array([expected_norm]), rtol=1e-4, atol=1e-5)
+    for a, e in zip(arrays, expected):
+        assert_almost_equal(a, e, rtol=1e-5, atol=1e-6)
+
+
+def test_clip_global_norm_scale():
+    shapes = [(3, 4), (10,), (2, 3, 5)]
+    num_weights = len(shapes)
+    grads = [mx.nd.random.uniform(-1, 1, shape=shape) for shape in shapes]
+    rescale_grad, max_norm = 0.5, 1.0
+    expected_norm = math.sqrt(sum(((rescale_grad * g.asnumpy()) ** 2).sum() for g in grads))
+    expected_scale = rescale_grad * min(1, max_norm / (expected_norm + 1e-8))
+    scale = mx.nd.clip_global_norm(*grads, num_arrays=num_weights, max_norm=max_norm,
+                                   rescale_grad=rescale_grad)
+    assert_almost_equal(scale.asnumpy(), np.array([expected_scale]), rtol=1e-4, atol=1e-6)
+
+    # the update reading the scale on the device matches the update with the scale of the host
+    weights = [mx.nd.random.uniform(shape=shape) for shape in shapes]
+    kwargs = {'lrs': [0.1] * num_weights, 'wds': [0.01] * num_weights, 'etas': [1.0] * num_weights}
+    def update(rescale):
+        out = [w.copy() for w in weights]
+        mean = [mx.nd.zeros(shape) for shape in shapes]
+        var = [mx.nd.zeros(shape) for shape in shapes]
+        mx.nd.contrib.multi_adamw_update(out, grads, mean, var, rescale, out=out, **kwargs)
+        return out
+    for w1, w2 in zip(update(scale), update(mx.nd.array([scale.asscalar()]))):
+        assert_almost_equal(w1, w2, rtol=1e-5, atol=1e-6)
+
+    # a gradient which is not finite gives a scale of 0, the update is skipped
+    grads[1][0] = np.inf
+    scale = mx.nd.clip_global_norm(*grads, num_arrays=num_weights, max_norm=max_norm)
+    assert scale.asscalar() == 0
+    for w1, w2 in zip(update(scale), weights):
+        assert_almost_equal(w1, w2)
+
+
 def test_adadelta():
     opt1 = mx.optimizer.AdaDelta
     opt2 = mx.optimizer.AdaDelta
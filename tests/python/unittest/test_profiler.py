@@ -281,6 +281,225 @@ def test_aggregate_stats_sorting():
     profiler.set_state('stop')
 
 
+def test_aggregate_stats_input_pipeline(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.csv')
+    np.savetxt(data_path, np.random.uniform(size=(64, 4)), delimiter=',')
+    file_name = 'test_aggregate_stats_input_pipeline.json'
+    enable_profiler(file_name, True, False, True)
+    # clear aggregate stats
+    profiler.dumps(reset=True)
+    data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(4,), batch_size=8)
+    for _ in data_iter:
+        pass
+    mx.gluon.data.batchify.Stack()([np.zeros((2, 3)), np.ones((2, 3))])
+    debug_str = profiler.dumps(reset=True)
+    profiler.set_state('stop')
+    assert 'Input Pipeline Statistics' in debug_str
+    stages = {line.split()[0]: line.split() for line in debug_str.splitlines()
+              if line.startswith(('Batchify', 'Consumer'))}
+    assert int(stages['Batchify'][1]) == 1
+    assert int(stages['Consumer'][2]) > 0
+    assert 'Slowest Stage: ' in debug_str
+    # the statistics are reset with the aggregate stats
+    assert 'Input Pipeline Statistics' not in profiler.dumps()
+
+
+def test_aggregate_stats_storage_fallback():
+    file_name = 'test_aggregate_stats_storage_fallback.json'
+    enable_profiler(file_name, True, False, True)
+    # clear aggregate stats
+    profiler.dumps(reset=True)
+    # softmax has no kernel for csr arrays, which are cast to 1MB dense arrays
+    data = mx.nd.ones((256, 1024)).tostype('csr')
+    mx.nd.softmax(data).wait_to_read()
+    debug_str = profiler.dumps(reset=True)
+    profiler.set_state('stop')
+    assert 'Storage Fallback Statistics' in debug_str
+    fallback_str = debug_str[debug_str.index('Storage Fallback Statistics'):]
+    stats = {line.split()[0]: line.split() for line in fallback_str.splitlines()
+             if line.startswith('softmax')}
+    assert int(stats['softmax'][1]) == 1
+    assert float(stats['softmax'][2]) == pytest.approx(1.0)
+    # the statistics are reset with the aggregate stats
+    assert 'Storage Fallback Statistics' not in profiler.dumps()
+
+
+def test_sampled_operator_latencies():
+    profiler.set_sample_rate(2)
+    try:
+        profiler.scrape_sampled(reset=True)
+        a = mx.nd.ones((16, 16))
+        for _ in range(100):
+            a = mx.nd.dot(a, a) / 16
+        mx.nd.waitall()
+        stats = profiler.scrape_sampled(reset=True)
+    finally:
+        profiler.set_sample_rate(0)
+    assert stats['Unit'] == 'us' and stats['SampleRate'] == 2
+    dot = stats['Operators']['dot']
+    assert dot['Count'] > 0
+    assert dot['P50'] <= dot['P90'] <= dot['P99'] <= dot['Max']
+    # the sampled latencies are cleared by the reset
+    assert profiler.scrape_sampled()['Operators'] == {}
+
+
+@pytest.mark.parametrize('traceparent', [None, '00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01'])
+def test_trace_request(tmpdir, traceparent):
+    filename = str(tmpdir.join('traces.json'))
+    net = nn.Dense(8)
+    net.initialize()
+    net.hybridize()
+    x = mx.nd.ones((4, 16))
+    net(x).wait_to_read()
+    profiler.set_request_trace_config(threshold_ms=0, filename=filename)
+    try:
+        with profiler.trace_request(traceparent) as trace_id:
+            out = net(x)
+        out.wait_to_read()
+        # the request is exported by the release of its last operator
+        for _ in range(100):
+            if os.path.exists(filename):
+                break
+            time.sleep(0.05)
+        # not exported when faster than the threshold
+        profiler.set_request_trace_config(threshold_ms=1e6, filename=filename)
+        with profiler.trace_request():
+            net(x).wait_to_read()
+        mx.nd.waitall()
+        time.sleep(0.1)
+    finally:
+        profiler.set_request_trace_config()
+    with open(filename) as f:
+        lines = f.read().splitlines()
+    assert len(lines) == 1
+    spans = json.loads(lines[0])['resourceSpans'][0]['scopeSpans'][0]['spans']
+    assert all(span['traceId'] == trace_id for span in spans)
+    root = spans[0]
+    assert root['name'] == 'request'
+    if traceparent:
+        assert trace_id == traceparent.split('-')[1]
+        assert root['parentSpanId'] == traceparent.split('-')[2]
+    else:
+        assert len(trace_id) == 32 and 'parentSpanId' not in root
+    ops = [span for span in spans if span.get('parentSpanId') == root['spanId']]
+    assert ops
+    for op in ops:
+        attrs = {a['key']: a['value'] for a in op['attributes']}
+        assert attrs['mxnet.device']['stringValue'] == 'cpu(0)'
+        children = [span['name'] for span in spans if span.get('parentSpanId') == op['spanId']]
+        assert sorted(children) == ['queue', 'run']
+        assert int(op['startTimeUnixNano']) <= int(op['endTimeUnixNano'])
+    assert int(root['startTimeUnixNano']) <= min(int(op['startTimeUnixNano']) for op in ops)
+    with pytest.raises(mx.MXNetError):
+        with profiler.trace_request('not-a-traceparent'):
+            pass
+
+
+def test_openmetrics():
+    kv = mx.kv.create('local')
+    kv.init(3, mx.nd.ones((2, 3)))
+    kv.push(3, mx.nd.ones((2, 3)))
+    out = mx.nd.zeros((2, 3))
+    kv.pull(3, out=out)
+    mx.nd.waitall()
+    text = profiler.metrics()
+    assert text.endswith('# EOF\n')
+    for family in ['mxnet_engine_operations_executed', 'mxnet_engine_pending_operations',
+                   'mxnet_storage_pool_held_bytes', 'mxnet_kvstore_bytes',
+                   'mxnet_kvstore_call_seconds', 'mxnet_operator_time_seconds']:
+        assert '# TYPE ' + family + ' ' in text
+    assert 'mxnet_storage_pool_held_bytes{context="cpu(0)"}' in text
+    samples = dict(line.rsplit(' ', 1) for line in text.splitlines() if not line.startswith('#'))
+    assert int(samples['mxnet_kvstore_bytes_total{call="push"}']) >= 24
+    assert int(samples['mxnet_kvstore_call_seconds_count{call="pull"}']) >= 1
+    assert int(samples['mxnet_engine_operations_executed_total']) > 0
+
+    import urllib.request
+    server = profiler.start_metrics_server(0, addr='127.0.0.1')
+    try:
+        url = 'http://127.0.0.1:%d/metrics' % server.server_address[1]
+        with urllib.request.urlopen(url) as response:
+            assert response.headers['Content-Type'].startswith('application/openmetrics-text')
+            assert response.read().decode('utf-8').endswith('# EOF\n')
+    finally:
+        server.shutdown()
+
+
+def test_aggregate_stats_roofline():
+    file_name = 'test_aggregate_stats_roofline.json'
+    enable_profiler(file_name, run=True, continuous_dump=False, aggregate_stats=True)
+    profiler.dumps(reset=True)
+    a = mx.nd.ones((128, 128))
+    b = mx.nd.dot(a, a)
+    c = mx.nd.exp(b)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    stats = json.loads(profiler.dumps(format='json'))['Time']['operator']
+    assert stats['dot']['GFLOP/s'] > 0
+    # 2 * 128 ** 3 floating point operations over 3 * 128 ** 2 float32 elements
+    assert abs(stats['dot']['FLOP/Byte'] - 2 * 128 / 12.0) < 0.01
+    assert stats['exp']['FLOP/Byte'] == 0.125
+    assert 'operator Roofline' in profiler.dumps(reset=True)
+    profiler.set_config(aggregate_stats=False)
+
+
+def test_memory_timeline():
+    file_name = 'test_memory_timeline.json'
+    enable_profiler(file_name, run=True)
+    a = mx.nd.ones((256, 256))
+    b = mx.nd.exp(a)
+    mx.nd.waitall()
+    peak = mx.cpu().memory_pool_stats()['peak']
+    profiler.set_state('stop')
+    profiler.dump(True)
+    assert peak['bytes'] >= 2 * a.size * 4
+    assert sum(tensor['bytes'] for tensor in peak['tensors']) == peak['bytes']
+    assert all(tensor['blocks'] > 0 for tensor in peak['tensors'])
+    with open(file_name, 'r') as f:
+        events = json.load(f)['traceEvents']
+    allocs = [e for e in events if e.get('cat') == 'alloc']
+    assert any(e['args']['bytes'] >= a.size * 4 and e['args']['context'] == 'cpu(0)'
+               for e in allocs)
+    assert any(e['name'] == 'Peak Memory: cpu(0)' for e in events)
+
+
+def test_profile_dependencies():
+    file_name = 'test_profile_dependencies.json'
+    enable_profiler(profile_filename=file_name, run=True)
+    a = mx.nd.ones((64, 64))
+    b = mx.nd.sqrt(a)
+    c = mx.nd.exp(a)
+    d = b + c
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    profiler.dump()
+    with open(file_name) as fin:
+        events = json.load(fin)['traceEvents']
+    begins = {e['args']['opr_id']: e for e in events
+              if e['ph'] == 'B' and 'opr_id' in e.get('args', {})}
+    names = {opr_id: e['name'] for opr_id, e in begins.items()}
+    # the addition waits for the writes of both of its inputs
+    add = [e for e in begins.values() if sorted(names.get(dep) for dep in e['args']['deps'])
+           == ['exp', 'sqrt']]
+    assert len(add) == 1
+    # each dependency is drawn as a flow from the end of an operator to the start of another
+    flows = [e for e in events if e.get('cat') == 'dependency']
+    assert len([e for e in flows if e['ph'] == 's']) == len([e for e in flows if e['ph'] == 'f'])
+    assert len(flows) >= 4
+
+    import importlib.util
+    path = os.path.join(os.path.dirname(__file__), '..', '..', '..', 'tools', 'profile',
+                        'critical_path.py')
+    spec = importlib.util.spec_from_file_location('critical_path', path)
+    critical_path = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(critical_path)
+    oprs = critical_path.load_operators(critical_path.load_trace(file_name))
+    path, length, slack = critical_path.critical_path(oprs)
+    assert path[-1] == add[0]['args']['opr_id']
+    assert oprs[path[-2]]['name'] in ('exp', 'sqrt')
+    assert length > 0 and all(slack[opr_id] == 0 for opr_id in path)
+
+
 @pytest.mark.skip(reason='https://github.com/apache/incubator-mxnet/issues/18564')
 def test_aggregate_duplication():
     file_name = 'test_aggregate_duplication.json'
@@ -479,6 +479,39 @@ def test_parallel_random_seed_setting():
             assert same(un1.asnumpy(), un2.asnumpy()), \
                 "symbolic seed-setting test: `uniform` should give the same result with the same seed"
 
+def test_counter_random_seed_setting():
+    # the ops of the counter based generators draw different numbers, reproduced by the seed
+    ctx = mx.context.current_context()
+    shape = (100, 100)
+    data = mx.nd.ones(shape, ctx=ctx)
+    def draw():
+        return [mx.nd.random.uniform(shape=shape, ctx=ctx).asnumpy(),
+                mx.nd.random.normal(shape=shape, ctx=ctx).asnumpy(),
+                mx.nd.Dropout(data, p=0.5, mode='always', cudnn_off=True).asnumpy(),
+                mx.nd.random.shuffle(mx.nd.arange(1000, ctx=ctx)).asnumpy()]
+    mx.random.seed(4321)
+    ret1 = draw()
+    ret2 = draw()
+    mx.random.seed(4321)
+    ret3 = draw()
+    for a, b, c in zip(ret1, ret2, ret3):
+        assert same(a, c)
+        assert not same(a, b)
+    assert not same(ret1[0], ret1[1])
+
+    # the forwards of a bound graph draw different numbers, reproduced by the seed
+    X = mx.sym.Variable("X")
+    Y = mx.sym.random.uniform(shape=shape) + X
+    x = mx.nd.zeros(shape, ctx=ctx)
+    yexec = Y._bind(ctx, {'X' : x})
+    mx.random.seed(4321)
+    un1 = yexec.forward()[0].asnumpy()
+    un2 = yexec.forward()[0].asnumpy()
+    mx.random.seed(4321)
+    un3 = yexec.forward()[0].asnumpy()
+    assert same(un1, un3)
+    assert not same(un1, un2)
+
 # Set seed for the context variously based on `start_seed` and `num_init_seeds`, then set seed finally to `final_seed`
 def set_seed_variously_for_context(ctx, init_seed, num_init_seeds, final_seed):
     end_seed = init_seed + num_init_seeds
@@ -1375,6 +1375,29 @@ def test_sparse_dot():
     test_sparse_dot_zero_output(rand_shape_2d(50, 200), False, 40)
     test_sparse_dot_zero_output(rand_shape_2d(50, 200), True, 40)
 
+@pytest.mark.parametrize('trans_lhs', [False, True])
+def test_sparse_dot_skewed_rows(trans_lhs):
+    # a few long rows among many empty ones, and enough columns for several column blocks
+    lhs_np = np.zeros((97, 300), dtype=np.float32)
+    lhs_np[3, :] = np.random.uniform(-1, 1, size=300)
+    lhs_np[50, ::3] = np.random.uniform(-1, 1, size=100)
+    lhs_np[np.arange(0, 97, 7), np.arange(0, 97, 7)] = 1
+    lhs = mx.nd.array(lhs_np).tostype('csr')
+    rhs_np = np.random.uniform(-1, 1, size=(97 if trans_lhs else 300, 1100)).astype(np.float32)
+    rhs = mx.nd.array(rhs_np)
+    expected = np.dot(lhs_np.T if trans_lhs else lhs_np, rhs_np)
+    assert_almost_equal(mx.nd.dot(lhs, rhs, transpose_a=trans_lhs), expected, rtol=1e-4, atol=1e-4)
+
+    # the gradient of rhs is the other dot, added to the previous one
+    rhs.attach_grad(grad_req='add')
+    for _ in range(2):
+        with mx.autograd.record():
+            out = mx.nd.dot(lhs, rhs, transpose_a=trans_lhs)
+        out.backward(mx.nd.ones(out.shape))
+    ograd = np.ones(expected.shape, dtype=np.float32)
+    grad = 2 * np.dot(lhs_np if trans_lhs else lhs_np.T, ograd)
+    assert_almost_equal(rhs.grad, grad, rtol=1e-4, atol=1e-4)
+
 @pytest.mark.serial
 def test_sparse_dot_determinism():
     def check_dot_determinism(lhs_stype, rhs_stype, lhs_density, rhs_density, transpose_a, transpose_b, forward_stype):
@@ -1419,6 +1442,21 @@ def test_sparse_slice():
     check_csr_slice(shape, False)
 
 
+@pytest.mark.parametrize('begin,end,step', [
+    ((None,), (None,), (2,)),
+    ((None,), (None,), (-1,)),
+    ((1, 1), (None, -1), (3, None)),
+    ((-2, 0), (0, None), (-2, 1)),
+])
+def test_sparse_slice_row_step(begin, end, step):
+    data, _ = rand_sparse_ndarray((13, 7), 'csr', density=0.3)
+    out = mx.nd.slice(data, begin=begin, end=end, step=step)
+    expected = mx.nd.slice(data.tostype('default'), begin=begin, end=end, step=step)
+    if data.context.device_type == 'cpu':
+        assert out.stype == 'csr'
+    assert same(out.asnumpy(), expected.asnumpy())
+
+
 @pytest.mark.serial
 def test_sparse_retain():
     def check_sparse_retain(shape, density, index_type=np.int64):
@@ -1790,6 +1828,54 @@ def test_sparse_embedding():
     for sparse_grad in sparse_grads:
         check_sparse_embedding(in_dim, out_dim, batch, densities, sparse_grad)
 
+
+def test_sparse_embedding_skewed_indices():
+    # a large vocabulary with a few hot rows, the gradient only holds the rows referenced
+    in_dim, out_dim, batch = 100000, 70, 4096
+    np_data = np.random.randint(0, in_dim, size=batch)
+    np_data[:batch // 2] = np.random.randint(0, 3, size=batch // 2)
+    data = mx.nd.array(np_data)
+    weight = mx.nd.random.uniform(shape=(in_dim, out_dim))
+    weight.attach_grad(stype='row_sparse')
+    np_ograd = np.random.uniform(-1, 1, size=(batch, out_dim)).astype(np.float32)
+    grads = []
+    for _ in range(2):
+        with mx.autograd.record():
+            out = mx.nd.Embedding(data, weight, input_dim=in_dim, output_dim=out_dim,
+                                  sparse_grad=True)
+        out.backward(mx.nd.array(np_ograd))
+        assert weight.grad.stype == 'row_sparse'
+        grads.append(weight.grad.copy())
+    rows = np.unique(np_data)
+    expected = np.zeros((len(rows), out_dim), dtype=np.float32)
+    np.add.at(expected, np.searchsorted(rows, np_data), np_ograd)
+    assert_almost_equal(grads[0].indices.asnumpy(), rows)
+    assert_almost_equal(grads[0].data.asnumpy(), expected, rtol=1e-4, atol=1e-4)
+    # the gradient does not depend on the order of the accumulation
+    assert same(grads[0].data.asnumpy(), grads[1].data.asnumpy())
+
+def test_sparse_embedding_hashed_ids():
+    # a row_sparse weight of 64-bit ids, neither the forward nor the backward densify it
+    in_dim, out_dim = 2**40, 3
+    np_data = np.array([[7, 2**39], [2**39, 5]], dtype=np.int64)
+    rows = np.array([7, 2**39], dtype=np.int64)
+    np_rows = np.random.uniform(size=(len(rows), out_dim)).astype(np.float32)
+    weight = mx.nd.sparse.row_sparse_array((np_rows, rows), shape=(in_dim, out_dim))
+    weight.attach_grad(stype='row_sparse')
+    data = mx.nd.array(np_data, dtype=np.int64)
+    np_ograd = np.random.uniform(-1, 1, size=(2, 2, out_dim)).astype(np.float32)
+    with mx.autograd.record():
+        out = mx.nd.sparse.Embedding(data, weight, input_dim=in_dim, output_dim=out_dim,
+                                     sparse_grad=True)
+    out.backward(mx.nd.array(np_ograd))
+    assert out.stype == 'default'
+    expected = np.stack([np_rows[0], np_rows[1], np_rows[1], np.zeros(out_dim)]).reshape((2, 2, out_dim))
+    assert_almost_equal(out.asnumpy(), expected)
+    assert weight.grad.stype == 'row_sparse'
+    assert_almost_equal(weight.grad.indices.asnumpy(), np.array([5, 7, 2**39]))
+    expected_grad = np.stack([np_ograd[1, 1], np_ograd[0, 0], np_ograd[0, 1] + np_ograd[1, 0]])
+    assert_almost_equal(weight.grad.data.asnumpy(), expected_grad, rtol=1e-5, atol=1e-5)
+
 def test_sparse_broadcast_add_sub():
     def check_broadcast_add(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
         assert_almost_equal(mx.nd.sparse.add(mx_lhs, mx_rhs).asnumpy(), np.add(np_lhs, np_rhs), atol=1e-4)
@@ -1836,6 +1922,30 @@ def test_sparse_broadcast_mul_div():
             check_broadcast_mul(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
             check_broadcast_div(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
 
+@pytest.mark.parametrize('density', [0.0, 0.3, 1.0])
+def test_sparse_elemwise_rsp_dns_rsp(density):
+    shape = rand_shape_2d()
+    mx_rsp = rand_ndarray(shape, 'row_sparse', density)
+    mx_dns = mx.nd.random.uniform(1, 2, shape=shape)
+    np_rsp, np_dns = mx_rsp.asnumpy(), mx_dns.asnumpy()
+    for out, expected in [(mx.nd.elemwise_mul(mx_rsp, mx_dns), np_rsp * np_dns),
+                          (mx.nd.elemwise_mul(mx_dns, mx_rsp), np_dns * np_rsp),
+                          (mx.nd.elemwise_div(mx_rsp, mx_dns), np_rsp / np_dns)]:
+        assert out.stype == 'row_sparse'
+        assert_almost_equal(out.asnumpy(), expected, atol=1e-4)
+
+
+@pytest.mark.parametrize('rhs_shape', [(1, 5), (5,), (4, 1), (1, 1), (1,), (4, 5)])
+def test_sparse_broadcast_mul_div_rsp(rhs_shape):
+    mx_lhs = rand_ndarray((4, 5), 'row_sparse', 0.5)
+    mx_rhs = mx.nd.random.uniform(1, 2, shape=rhs_shape)
+    np_lhs, np_rhs = mx_lhs.asnumpy(), mx_rhs.asnumpy()
+    for out, expected in [(mx.nd.sparse.multiply(mx_lhs, mx_rhs), np.multiply(np_lhs, np_rhs)),
+                          (mx.nd.sparse.divide(mx_lhs, mx_rhs), np.divide(np_lhs, np_rhs))]:
+        assert out.stype == 'row_sparse'
+        assert_almost_equal(out.asnumpy(), expected, atol=1e-4)
+
+
 def test_batchnorm_fallback():
     # same test as test_operator.test_batchnorm_training, but tests fallback logic of batchnorm
     stype = 'row_sparse'
@@ -2019,6 +2129,19 @@ def test_sparse_nd_where():
     test_where_helper((5, 9))
     test_where_numeric_gradient((5, 9))
 
+@pytest.mark.parametrize('cond_shape', [(6, 4), (6,)])
+def test_sparse_nd_where_rsp(cond_shape):
+    cond_np = np.random.randint(0, 2, size=cond_shape)
+    # the rows the row_sparse condition does not store
+    cond_np[::2] = 0
+    cond = mx.nd.array(cond_np).tostype('row_sparse')
+    x = mx.nd.random.uniform(shape=(6, 4))
+    y = mx.nd.random.uniform(shape=(6, 4))
+    out = mx.nd.where(cond, x, y)
+    assert out.stype == 'default'
+    assert_almost_equal(out, mx.nd.where(mx.nd.array(cond_np), x, y))
+
+
 @pytest.mark.serial
 def test_sparse_quadratic_function():
     def f(x, a, b, c):
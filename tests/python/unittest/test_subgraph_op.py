@@ -18,6 +18,7 @@
 import os
 import sys
 import ctypes
+import json
 import mxnet as mx
 from mxnet.base import SymbolHandle, check_call, _LIB, mx_uint, c_str_array, c_str, mx_real_t
 from mxnet.symbol import Symbol
@@ -532,6 +533,32 @@ def test_subgraph_backend_gluon_ext2(tmpdir):
         assert_almost_equal(mx.np.abs(outputs1[i] - outputs2[i]).sum().asnumpy(), onp.zeros(shape=(1,)))
 
 
+@pytest.mark.parametrize('options,top_ops', [
+    ({}, ['_CachedOp']),
+    ({'cost_speedup_default': 1.1}, ['_CachedOp', 'elemwise_add', 'sin'])])
+@pytest.mark.skipif(sys.platform == "win32", reason='https://github.com/apache/incubator-mxnet/issues/19915')
+def test_subgraph_cost_partition(options, top_ops):
+    """Partition across two backends, which the estimated cost of their subgraphs decides"""
+    sym, _, _ = network_structure_2()
+    all_ops = ['exp', 'sin', 'cos', '_Plus', 'elemwise_add', '_plus']
+    for backend, op_names in [('default', all_ops), ('default_v2', ['exp', 'cos'])]:
+        check_call(_LIB.MXSetSubgraphPropertyOpNamesV2(c_str(backend), mx_uint(len(op_names)),
+                                                       c_str_array(op_names)))
+    partitioned_sym = sym.optimize_for(['default', 'default_v2'], **options)
+    for backend in ['default', 'default_v2']:
+        check_call(_LIB.MXRemoveSubgraphPropertyOpNamesV2(c_str(backend)))
+    nodes = json.loads(partitioned_sym.tojson())['nodes']
+    assert sorted(set(n['op'] for n in nodes if n['op'] != 'null')) == top_ops
+
+    exe = sym._simple_bind(ctx=mx.current_context(), grad_req='null')
+    partitioned_exe = partitioned_sym._simple_bind(ctx=mx.current_context(), grad_req='null')
+    exe.arg_dict['data'][:] = mx.nd.random.uniform(shape=exe.arg_dict['data'].shape)
+    partitioned_exe.arg_dict['data'][:] = exe.arg_dict['data']
+    exe.forward()
+    partitioned_exe.forward()
+    assert_almost_equal(exe.outputs[0], partitioned_exe.outputs[0])
+
+
 if __name__ == "__main__":
     import datetime
     tmpdir = datetime.datetime.now().strftime('mylogfile_%H_%M_%S_%f_%d_%m_%Y.log')
@@ -28,6 +28,7 @@ from mxnet.base import NotImplementedForSymbol
 from mxnet.test_utils import discard_stderr, rand_shape_nd, use_np, environment
 from mxnet.util import np_shape
 import pickle as pkl
+import pytest
 
 def test_symbol_basic():
     mlist = []
@@ -449,6 +450,35 @@ def test_load_save_symbol():
                     assert out_shapes[0] == (batch_size, num_hdidden)  # output
                     assert len(aux_shapes) == 0
 
+@pytest.mark.parametrize('fast_loader', ['0', '1'])
+def test_symbol_fromjson(fast_loader):
+    data = mx.sym.var('data', attr={'note': 'quote " backslash \\ tab \t \u00e9 \U0001f600'})
+    net = data
+    for i in range(3):
+        net = mx.sym.FullyConnected(net, num_hidden=8, name='fc%d' % i)
+        net = mx.sym.Activation(net, act_type='relu', name='relu%d' % i)
+    net = mx.sym.Group([net, mx.sym.BlockGrad(data)])
+    with environment({'MXNET_FAST_JSON_LOADER': fast_loader}):
+        loaded = mx.sym.fromjson(net.tojson())
+        assert loaded.tojson() == net.tojson()
+        assert loaded.attr_dict()['data']['note'] == data.attr('note')
+        arg_shapes, out_shapes, _ = loaded.infer_shape(data=(2, 5))
+        assert arg_shapes[1] == (8, 5)
+        assert out_shapes == [(2, 8), (2, 5)]
+
+        # legacy JSON, with param dictionaries and inputs without version
+        legacy = {'nodes': [{'op': 'null', 'param': {}, 'name': 'data', 'inputs': [], 'backward_source_id': -1},
+                            {'op': 'FullyConnected', 'param': {'num_hidden': '4', 'no_bias': 'False'},
+                             'name': 'fc', 'inputs': [[0, 0]], 'backward_source_id': -1}],
+                  'arg_nodes': [0], 'heads': [[1, 0]]}
+        loaded = mx.sym.fromjson(json.dumps(legacy))
+        assert loaded.list_arguments() == ['data', 'fc_weight', 'fc_bias']
+        _, out_shapes, _ = loaded.infer_shape(data=(3, 6))
+        assert out_shapes == [(3, 4)]
+
+        with pytest.raises(mx.MXNetError):
+            mx.sym.fromjson(net.tojson().replace('"FullyConnected"', '"NoSuchOperator"'))
+
 def test_infershape_happens_for_all_ops_in_graph():
     v = mx.sym.Variable('V')
     s = mx.sym.transpose(v)
@@ -21,7 +21,7 @@ import mxnet as mx
 from mxnet import context, attribute
 from mxnet.context import Context
 from mxnet.attribute import AttrScope
-from mxnet.test_utils import assert_almost_equal, set_default_context
+from mxnet.test_utils import assert_almost_equal, set_default_context, environment
 from mxnet.util import _NumpyArrayScope, set_np_shape
 
 
@@ -230,3 +230,28 @@ def test_np_global_shape():
         assert_almost_equal(data[1].asnumpy(), np.ones(shape=(0, 1, 2)))
     finally:
         set_np_shape(prev_np_shape)
+
+
+def test_dynamic_temp_space():
+    # the resource manager of a thread reads MXNET_DYNAMIC_TEMP_SPACE when it is created
+    x = mx.nd.random.uniform(shape=(50, 300))
+    net = mx.gluon.nn.HybridSequential()
+    net.add(mx.gluon.nn.Dense(16), mx.gluon.nn.Dense(4))
+    net.initialize()
+    net.hybridize(static_alloc=True)
+    expected = [mx.nd.sort(x, axis=1).asnumpy(), mx.nd.topk(x, k=5, ret_typ='value').asnumpy(),
+                net(x).asnumpy()]
+    data = []
+
+    def f():
+        for _ in range(3):
+            data.append([mx.nd.sort(x, axis=1), mx.nd.topk(x, k=5, ret_typ='value'), net(x)])
+        mx.nd.waitall()
+    with environment('MXNET_DYNAMIC_TEMP_SPACE', '1'):
+        thread = threading.Thread(target=f)
+        thread.start()
+        thread.join()
+    assert len(data) == 3
+    for outs in data:
+        for out, ref in zip(outs, expected):
+            assert_almost_equal(out.asnumpy(), ref)
@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Compact a delta checkpoint, saved by Block.save_parameters with a base, and the chain of
+base checkpoints it refers to into one full checkpoint, e.g. before the bases are deleted.
+
+Example:
+    python compact_checkpoint.py --input model-day7.params --output model-full.params
+"""
+import argparse
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Apply a delta checkpoint to its chain of base checkpoints.')
+    parser.add_argument('--input', required=True, help='checkpoint to compact, full or delta')
+    parser.add_argument('--output', required=True,
+                        help='full checkpoint to write, may be the input')
+    parser.add_argument('--nd', action='store_true',
+                        help='the checkpoint was saved without the numpy semantics')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    import mxnet as mx
+    if not args.nd:
+        mx.npx.set_np()
+    mx.gluon.utils.compact_parameters(args.input, args.output)
+
+
+if __name__ == '__main__':
+    main()
@@ -24,11 +24,24 @@
  *  The 64bit zero pad was reserved for future purposes
  *
  *  Image List Format: unique-image-index label[s] path-to-image
+ *
+ *  The images are read, decoded, resized and encoded by worker threads and their records are
+ *  written in the order of the list, with an index file of their offsets.
  * \sa dmlc/recordio.h
  */
+#include <algorithm>
 #include <cctype>
+#include <cstdio>
 #include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <iomanip>
 #include <sstream>
@@ -61,6 +74,262 @@ int GetInterMethod(int inter_method, int old_width, int old_height, int new_widt
         return inter_method;
     }
 }
+/*! \brief the parameters of the packing of the images */
+struct PackParam {
+  int label_width = 1;
+  int pack_label = 0;
+  int new_size = -1;
+  int center_crop = 0;
+  int color_mode = CV_LOAD_IMAGE_COLOR;
+  int unchanged = 0;
+  int inter_method = CV_INTER_LINEAR;
+  std::string encoding;
+  std::vector<int> encode_params;
+  std::string root;
+};
+
+/*! \brief an image of the list, packed into its record by a worker */
+struct ImageTask {
+  uint64_t image_id;
+  std::string path;
+  /*! \brief the header and the labels of the record, followed by the image once packed */
+  std::string blob;
+};
+
+/*! \brief parses a line of the list into task, false for the lines to skip */
+bool ParseLine(const PackParam& param, const std::string& sline, ImageTask* task) {
+  std::istringstream is(sline);
+  mxnet::io::ImageRecordIO rec;
+  if (!(is >> rec.header.image_id[0] >> rec.header.label)) return false;
+  std::vector<float> label_buf(param.label_width, 0.f);
+  label_buf[0] = rec.header.label;
+  for (int k = 1; k < param.label_width; ++k) {
+    CHECK(is >> label_buf[k])
+        << "Invalid ImageList, did you provide the correct label_width?";
+  }
+  if (param.pack_label) rec.header.flag = param.label_width;
+  rec.SaveHeader(&task->blob);
+  if (param.pack_label) {
+    size_t bsize = task->blob.size();
+    task->blob.resize(bsize + label_buf.size()*sizeof(float));
+    memcpy(dmlc::BeginPtr(task->blob) + bsize,
+           dmlc::BeginPtr(label_buf), label_buf.size()*sizeof(float));
+  }
+  std::string fname;
+  CHECK(std::getline(is, fname));
+  // eliminate invalid chars in the end
+  while (fname.length() != 0 &&
+         (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
+    fname.resize(fname.length() - 1);
+  }
+  // eliminate invalid chars in beginning.
+  const char *p = fname.c_str();
+  while (isspace(*p)) ++p;
+  task->image_id = rec.header.image_id[0];
+  task->path = param.root + p;
+  return true;
+}
+
+/*! \brief reads the image of task and appends it to its record, decoded, resized and encoded */
+void PackImage(const PackParam& param, ImageTask* task, std::mt19937* prnd,
+               std::vector<unsigned char>* decode_buf, std::vector<unsigned char>* encode_buf) {
+  const static size_t kBufferSize = 1 << 20UL;
+  // use "r" is equal to rb in dmlc::Stream
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(task->path.c_str(), "r"));
+  decode_buf->clear();
+  size_t imsize = 0;
+  while (true) {
+    decode_buf->resize(imsize + kBufferSize);
+    size_t nread = fi->Read(dmlc::BeginPtr(*decode_buf) + imsize, kBufferSize);
+    imsize += nread;
+    decode_buf->resize(imsize);
+    if (nread != kBufferSize) break;
+  }
+  fi.reset();
+
+  std::string& blob = task->blob;
+  if (param.unchanged != 1) {
+    cv::Mat img = cv::imdecode(*decode_buf, param.color_mode);
+    CHECK(img.data != nullptr) << "OpenCV decode fail:" << task->path;
+    cv::Mat res = img;
+    const int new_size = param.new_size;
+    if (new_size > 0) {
+      if (param.center_crop) {
+        if (img.rows > img.cols) {
+          int margin = (img.rows - img.cols)/2;
+          img = img(cv::Range(margin, margin+img.cols), cv::Range(0, img.cols));
+        } else {
+          int margin = (img.cols - img.rows)/2;
+          img = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
+        }
+      }
+      int interpolation_method = 1;
+      if (img.rows > img.cols) {
+          if (img.cols != new_size) {
+              interpolation_method = GetInterMethod(param.inter_method, img.cols, img.rows, new_size, img.rows * new_size / img.cols, *prnd);
+              cv::resize(img, res, cv::Size(new_size, img.rows * new_size / img.cols), 0, 0, interpolation_method);
+          } else {
+              res = img.clone();
+          }
+      } else {
+          if (img.rows != new_size) {
+              interpolation_method = GetInterMethod(param.inter_method, img.cols, img.rows, new_size * img.cols / img.rows, new_size, *prnd);
+              cv::resize(img, res, cv::Size(new_size * img.cols / img.rows, new_size), 0, 0, interpolation_method);
+          } else {
+              res = img.clone();
+          }
+      }
+    }
+    encode_buf->clear();
+    CHECK(cv::imencode(param.encoding, res, *encode_buf, param.encode_params));
+
+    // write buffer
+    size_t bsize = blob.size();
+    blob.resize(bsize + encode_buf->size());
+    memcpy(dmlc::BeginPtr(blob) + bsize,
+           dmlc::BeginPtr(*encode_buf), encode_buf->size());
+  } else {
+    size_t bsize = blob.size();
+    blob.resize(bsize + decode_buf->size());
+    memcpy(dmlc::BeginPtr(blob) + bsize,
+           dmlc::BeginPtr(*decode_buf), decode_buf->size());
+  }
+}
+
+/*!
+ * \brief packs the images of flist into the records of fo, and their offsets into fidx, with
+ *  num_thread workers. The list is read on the calling thread, the records are written in its
+ *  order by a writer thread. Returns the number of images packed.
+ */
+size_t PackShard(const PackParam& param, int num_thread, dmlc::InputSplit* flist,
+                 dmlc::Stream* fo, dmlc::Stream* fidx, size_t imcnt, double tstart) {
+  // the images read and not written yet, which bounds the memory of the reordering
+  const size_t max_pending = 64 * num_thread;
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<std::pair<size_t, ImageTask>> tasks;
+  std::map<size_t, ImageTask> packed;
+  size_t num_read = 0;
+  size_t num_written = 0;
+  bool closed = false;
+  std::exception_ptr error;
+  auto fail = [&](std::unique_lock<std::mutex>* lock) {
+    lock->lock();
+    if (!error) error = std::current_exception();
+    cond.notify_all();
+  };
+
+  auto work = [&]() {
+    std::random_device rd;
+    std::mt19937 prnd(rd());
+    std::vector<unsigned char> decode_buf;
+    std::vector<unsigned char> encode_buf;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [&]() { return !tasks.empty() || closed || error; });
+      if (tasks.empty() || error) return;
+      std::pair<size_t, ImageTask> task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      try {
+        PackImage(param, &task.second, &prnd, &decode_buf, &encode_buf);
+      } catch (...) {
+        fail(&lock);
+        return;
+      }
+      lock.lock();
+      packed.emplace(task.first, std::move(task.second));
+      cond.notify_all();
+    }
+  };
+
+  auto write = [&]() {
+    dmlc::RecordIOWriter writer(fo);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cond.wait(lock, [&]() {
+        return packed.count(num_written) || (closed && num_written == num_read) || error;
+      });
+      auto it = packed.find(num_written);
+      if (error || it == packed.end()) return;
+      ImageTask task = std::move(it->second);
+      packed.erase(it);
+      lock.unlock();
+      try {
+        std::ostringstream os;
+        os << task.image_id << '\t' << writer.Tell() << '\n';
+        writer.WriteRecord(dmlc::BeginPtr(task.blob), task.blob.size());
+        const std::string line = os.str();
+        fidx->Write(line.data(), line.size());
+      } catch (...) {
+        fail(&lock);
+        return;
+      }
+      lock.lock();
+      ++num_written;
+      if ((imcnt + num_written) % 1000 == 0) {
+        LOG(INFO) << imcnt + num_written << " images processed, "
+                  << dmlc::GetTime() - tstart << " sec elapsed";
+      }
+      cond.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_thread; ++i) workers.emplace_back(work);
+  std::thread writer(write);
+  std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+  try {
+    dmlc::InputSplit::Blob line;
+    while (flist->NextRecord(&line)) {
+      ImageTask task;
+      if (!ParseLine(param, std::string(static_cast<char*>(line.dptr), line.size), &task)) {
+        continue;
+      }
+      lock.lock();
+      cond.wait(lock, [&]() { return num_read - num_written < max_pending || error; });
+      if (error) break;
+      tasks.emplace_back(num_read++, std::move(task));
+      cond.notify_all();
+      lock.unlock();
+    }
+  } catch (...) {
+    fail(&lock);
+  }
+  if (!lock.owns_lock()) lock.lock();
+  closed = true;
+  cond.notify_all();
+  lock.unlock();
+  for (auto& worker : workers) worker.join();
+  writer.join();
+  if (error) std::rethrow_exception(error);
+  return num_written;
+}
+
+/*!
+ * \brief the name of a file of the shard of output, output itself for the records of a single
+ *  shard, e.g. data.rec, data.idx, or data_00001.rec, data_00001.idx of several shards
+ */
+std::string ShardName(const std::string& output, int shard, int num_shard,
+                      const std::string& ext) {
+  if (num_shard == 1 && ext == ".rec") return output;
+  std::string prefix = output;
+  if (prefix.size() > 4 && prefix.compare(prefix.size() - 4, 4, ".rec") == 0) {
+    prefix.resize(prefix.size() - 4);
+  }
+  std::ostringstream os;
+  os << prefix;
+  if (num_shard > 1) os << '_' << std::setw(5) << std::setfill('0') << shard;
+  os << ext;
+  return os.str();
+}
+
+/*! \brief whether the file uri exists */
+bool FileExists(const std::string& uri) {
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(uri.c_str(), "r", true));
+  return fi != nullptr;
+}
+
 int main(int argc, char *argv[]) {
   if (argc < 4) {
     printf("Usage: <image.lst> <image_root_dir> <output.rec> [additional parameters in form key=value]\n"\
@@ -75,7 +344,10 @@ int main(int argc, char *argv[]) {
            "\tquality=QUALITY[default=95] JPEG quality for encoding (1-100, default: 95) or PNG compression for encoding (1-9, default: 3).\n"\
            "\tencoding=ENCODING[default='.jpg'] Encoding type. Can be '.jpg' or '.png'\n"\
            "\tinter_method=INTER_METHOD[default=1] NN(0) BILINEAR(1) CUBIC(2) AREA(3) LANCZOS4(4) AUTO(9) RAND(10).\n"\
-           "\tunchanged=UNCHANGED[default=0] Keep the original image encoding, size and color. If set to 1, it will ignore the others parameters.\n");
+           "\tunchanged=UNCHANGED[default=0] Keep the original image encoding, size and color. If set to 1, it will ignore the others parameters.\n"\
+           "\tnum_thread=NUM_THREAD[default=number of cores] number of threads reading, decoding, resizing and encoding the images.\n"\
+           "\tnum_shard=NUM_SHARD[default=1] write the images to NUM_SHARD pairs of .rec and .idx files, split from the list by position.\n"\
+           "\tresume=RESUME[default=0] skip the shards written by an earlier run, and write the others to temporary files renamed once complete.\n");
     return 0;
   }
   int label_width = 1;
@@ -88,6 +360,9 @@ int main(int argc, char *argv[]) {
   int color_mode = CV_LOAD_IMAGE_COLOR;
   int unchanged = 0;
   int inter_method = CV_INTER_LINEAR;
+  int num_thread = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  int num_shard = 1;
+  int resume = 0;
   std::string encoding(".jpg");
   for (int i = 4; i < argc; ++i) {
     char key[128], val[128];
@@ -111,6 +386,9 @@ int main(int argc, char *argv[]) {
       if (!strcmp(key, "encoding")) encoding = std::string(val);
       if (!strcmp(key, "unchanged")) unchanged = atoi(val);
       if (!strcmp(key, "inter_method")) inter_method = atoi(val);
+      if (!strcmp(key, "num_thread")) num_thread = atoi(val);
+      if (!strcmp(key, "num_shard")) num_shard = atoi(val);
+      if (!strcmp(key, "resume")) resume = atoi(val);
     }
   }
   // Check parameters ranges
@@ -123,6 +401,9 @@ int main(int argc, char *argv[]) {
   if (label_width <= 1 && pack_label) {
     LOG(FATAL) << "pack_label can only be used when label_width > 1";
   }
+  if (num_thread < 1 || num_shard < 1) {
+    LOG(FATAL) << "num_thread and num_shard must be positive";
+  }
   if (new_size > 0) {
     LOG(INFO) << "New Image Size: Short Edge " << new_size;
   } else {
@@ -167,137 +448,61 @@ int main(int argc, char *argv[]) {
             return 0;
       }
   }
-  std::random_device rd;
-  std::mt19937 prnd(rd());
-  using namespace dmlc;
-  const static size_t kBufferSize = 1 << 20UL;
-  std::string root = argv[2];
-  mxnet::io::ImageRecordIO rec;
+  PackParam param;
+  param.label_width = label_width;
+  param.pack_label = pack_label;
+  param.new_size = new_size;
+  param.center_crop = center_crop;
+  param.color_mode = color_mode;
+  param.unchanged = unchanged;
+  param.inter_method = inter_method;
+  param.encoding = encoding;
+  param.root = argv[2];
+  if (encoding == std::string(".png")) {
+      param.encode_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
+      param.encode_params.push_back(quality);
+      LOG(INFO) << "PNG encoding compression: " << quality;
+  } else {
+      param.encode_params.push_back(CV_IMWRITE_JPEG_QUALITY);
+      param.encode_params.push_back(quality);
+      LOG(INFO) << "JPEG encoding quality: " << quality;
+  }
+  LOG(INFO) << "Use " << num_thread << " threads";
+
   size_t imcnt = 0;
   double tstart = dmlc::GetTime();
-  dmlc::InputSplit *flist = dmlc::InputSplit::
-      Create(argv[1], partid, nsplit, "text");
   std::ostringstream os;
   if (nsplit == 1) {
     os << argv[3];
   } else {
     os << argv[3] << ".part" << std::setw(3) << std::setfill('0') << partid;
   }
-  LOG(INFO) << "Write to output: " << os.str();
-  dmlc::Stream *fo = dmlc::Stream::Create(os.str().c_str(), "w");
-  LOG(INFO) << "Output: " << os.str();
-  dmlc::RecordIOWriter writer(fo);
-  std::string fname, path, blob;
-  std::vector<unsigned char> decode_buf;
-  std::vector<unsigned char> encode_buf;
-  std::vector<int> encode_params;
-  if (encoding == std::string(".png")) {
-      encode_params.push_back(CV_IMWRITE_PNG_COMPRESSION);
-      encode_params.push_back(quality);
-      LOG(INFO) << "PNG encoding compression: " << quality;
-  } else {
-      encode_params.push_back(CV_IMWRITE_JPEG_QUALITY);
-      encode_params.push_back(quality);
-      LOG(INFO) << "JPEG encoding quality: " << quality;
-  }
-  dmlc::InputSplit::Blob line;
-  std::vector<float> label_buf(label_width, 0.f);
-
-  while (flist->NextRecord(&line)) {
-    std::string sline(static_cast<char*>(line.dptr), line.size);
-    std::istringstream is(sline);
-    if (!(is >> rec.header.image_id[0] >> rec.header.label)) continue;
-    label_buf[0] = rec.header.label;
-    for (int k = 1; k < label_width; ++k) {
-      CHECK(is >> label_buf[k])
-          << "Invalid ImageList, did you provide the correct label_width?";
-    }
-    if (pack_label) rec.header.flag = label_width;
-    rec.SaveHeader(&blob);
-    if (pack_label) {
-      size_t bsize = blob.size();
-      blob.resize(bsize + label_buf.size()*sizeof(float));
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(label_buf), label_buf.size()*sizeof(float));
-    }
-    CHECK(std::getline(is, fname));
-    // eliminate invalid chars in the end
-    while (fname.length() != 0 &&
-           (isspace(*fname.rbegin()) || !isprint(*fname.rbegin()))) {
-      fname.resize(fname.length() - 1);
-    }
-    // eliminate invalid chars in beginning.
-    const char *p = fname.c_str();
-    while (isspace(*p)) ++p;
-    path = root + p;
-    // use "r" is equal to rb in dmlc::Stream
-    dmlc::Stream *fi = dmlc::Stream::Create(path.c_str(), "r");
-    decode_buf.clear();
-    size_t imsize = 0;
-    while (true) {
-      decode_buf.resize(imsize + kBufferSize);
-      size_t nread = fi->Read(BeginPtr(decode_buf) + imsize, kBufferSize);
-      imsize += nread;
-      decode_buf.resize(imsize);
-      if (nread != kBufferSize) break;
+  // the shards split the part of the list further
+  for (int shard = 0; shard < num_shard; ++shard) {
+    const std::string rec_name = ShardName(os.str(), shard, num_shard, ".rec");
+    const std::string idx_name = ShardName(os.str(), shard, num_shard, ".idx");
+    if (resume && FileExists(rec_name) && FileExists(idx_name)) {
+      LOG(INFO) << "Skip the written output: " << rec_name;
+      continue;
     }
-    delete fi;
-
-
-    if (unchanged != 1) {
-      cv::Mat img = cv::imdecode(decode_buf, color_mode);
-      CHECK(img.data != nullptr) << "OpenCV decode fail:" << path;
-      cv::Mat res = img;
-      if (new_size > 0) {
-        if (center_crop) {
-          if (img.rows > img.cols) {
-            int margin = (img.rows - img.cols)/2;
-            img = img(cv::Range(margin, margin+img.cols), cv::Range(0, img.cols));
-          } else {
-            int margin = (img.cols - img.rows)/2;
-            img = img(cv::Range(0, img.rows), cv::Range(margin, margin + img.rows));
-          }
-        }
-        int interpolation_method = 1;
-        if (img.rows > img.cols) {
-            if (img.cols != new_size) {
-                interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size, img.rows * new_size / img.cols, prnd);
-                cv::resize(img, res, cv::Size(new_size, img.rows * new_size / img.cols), 0, 0, interpolation_method);
-            } else {
-                res = img.clone();
-            }
-        } else {
-            if (img.rows != new_size) {
-                interpolation_method = GetInterMethod(inter_method, img.cols, img.rows, new_size * img.cols / img.rows, new_size, prnd);
-                cv::resize(img, res, cv::Size(new_size * img.cols / img.rows, new_size), 0, 0, interpolation_method);
-            } else {
-                res = img.clone();
-            }
-        }
-      }
-      encode_buf.clear();
-      CHECK(cv::imencode(encoding, res, encode_buf, encode_params));
-
-      // write buffer
-      size_t bsize = blob.size();
-      blob.resize(bsize + encode_buf.size());
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(encode_buf), encode_buf.size());
-    } else {
-      size_t bsize = blob.size();
-      blob.resize(bsize + decode_buf.size());
-      memcpy(BeginPtr(blob) + bsize,
-             BeginPtr(decode_buf), decode_buf.size());
+    // a shard interrupted leaves its temporary files only
+    const std::string suffix = resume ? ".tmp" : "";
+    LOG(INFO) << "Write to output: " << rec_name;
+    std::unique_ptr<dmlc::InputSplit> flist(dmlc::InputSplit::Create(
+        argv[1], partid * num_shard + shard, nsplit * num_shard, "text"));
+    {
+      std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create((rec_name + suffix).c_str(), "w"));
+      std::unique_ptr<dmlc::Stream> fidx(
+          dmlc::Stream::Create((idx_name + suffix).c_str(), "w"));
+      imcnt += PackShard(param, num_thread, flist.get(), fo.get(), fidx.get(), imcnt, tstart);
     }
-    writer.WriteRecord(BeginPtr(blob), blob.size());
-    // write header
-    ++imcnt;
-    if (imcnt % 1000 == 0) {
-      LOG(INFO) << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
+    if (resume) {
+      CHECK_EQ(std::rename((rec_name + suffix).c_str(), rec_name.c_str()), 0)
+          << "Failed to rename the output " << rec_name + suffix;
+      CHECK_EQ(std::rename((idx_name + suffix).c_str(), idx_name.c_str()), 0)
+          << "Failed to rename the output " << idx_name + suffix;
     }
   }
-  LOG(INFO) << "Total: " << imcnt << " images processed, " << GetTime() - tstart << " sec elapsed";
-  delete fo;
-  delete flist;
+  LOG(INFO) << "Total: " << imcnt << " images processed, " << dmlc::GetTime() - tstart << " sec elapsed";
   return 0;
 }
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file libsvm2bin.cc
+ * \brief convert a zero-based LibSVM file into the binary CSR format read by CSRBinIter
+ * \sa src/io/csr_binary.h
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <dmlc/base.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/timer.h>
+#include "../src/io/csr_binary.h"
+#include "../src/io/text_parser.h"
+
+using mxnet::io::CSRBinBlockHeader;
+using mxnet::io::CSRBinBlockLayout;
+using mxnet::io::CSRBinFileHeader;
+
+/*! \brief write size bytes of data at offset pos of the block */
+void WriteAt(dmlc::Stream* fo, uint64_t* written, uint64_t pos, const void* data, size_t size) {
+  static const char zeros[CSRBinBlockLayout::kBlockAlign] = {0};
+  CHECK_LE(*written, pos);
+  while (*written < pos) {
+    const size_t pad = std::min<uint64_t>(pos - *written, sizeof(zeros));
+    fo->Write(zeros, pad);
+    *written += pad;
+  }
+  fo->Write(data, size);
+  *written += size;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    printf("Usage: <input.libsvm> <output.bin> [additional parameters in form key=value]\n"\
+           "Possible additional parameters:\n"\
+           "\tnthread=NTHREAD[default=4] number of threads parsing the input.\n");
+    return 0;
+  }
+  int nthread = 4;
+  for (int i = 3; i < argc; ++i) {
+    char key[128], val[128];
+    if (sscanf(argv[i], "%127[^=]=%127s", key, val) == 2) {
+      if (!strcmp(key, "nthread")) nthread = atoi(val);
+    }
+  }
+  mxnet::io::LibSVMChunkParser<uint64_t> parser(argv[1], 0, 1, nthread, 2);
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(argv[2], "w"));
+  CSRBinFileHeader file_header;
+  uint64_t written = 0;
+  WriteAt(fo.get(), &written, 0, &file_header, sizeof(file_header));
+
+  double tstart = dmlc::GetTime();
+  uint64_t num_rows = 0, nnz = 0;
+  std::vector<int64_t> indptr, indices;
+  while (parser.Next()) {
+    const dmlc::RowBlock<uint64_t>& batch = parser.Value();
+    CSRBinBlockHeader header;
+    header.num_rows = batch.size;
+    header.nnz = batch.offset[batch.size] - batch.offset[0];
+    const CSRBinBlockLayout layout(header);
+    indptr.resize(batch.size + 1);
+    for (size_t i = 0; i <= batch.size; ++i) {
+      indptr[i] = batch.offset[i] - batch.offset[0];
+    }
+    indices.assign(batch.index + batch.offset[0], batch.index + batch.offset[batch.size]);
+    const uint64_t block = mxnet::io::CSRBinBlockLayout::Align(
+        std::max(written, mxnet::io::kCSRBinFirstBlock), CSRBinBlockLayout::kBlockAlign);
+    WriteAt(fo.get(), &written, block, &header, sizeof(header));
+    WriteAt(fo.get(), &written, block + layout.label, batch.label, batch.size * sizeof(float));
+    WriteAt(fo.get(), &written, block + layout.indptr, indptr.data(),
+            indptr.size() * sizeof(int64_t));
+    WriteAt(fo.get(), &written, block + layout.indices, indices.data(),
+            indices.size() * sizeof(int64_t));
+    WriteAt(fo.get(), &written, block + layout.values, batch.value + batch.offset[0],
+            header.nnz * sizeof(float));
+    num_rows += header.num_rows;
+    nnz += header.nnz;
+    LOG(INFO) << num_rows << " rows converted, " << nnz << " non-zeros, "
+              << (dmlc::GetTime() - tstart) << " sec elapsed";
+  }
+  // pad the last block
+  WriteAt(fo.get(), &written,
+          CSRBinBlockLayout::Align(std::max(written, mxnet::io::kCSRBinFirstBlock),
+                                   CSRBinBlockLayout::kBlockAlign),
+          nullptr, 0);
+  LOG(INFO) << "Total: " << num_rows << " rows processed, "
+            << (dmlc::GetTime() - tstart) << " sec elapsed";
+  return 0;
+}
@@ -0,0 +1,165 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Critical path of the operators of a profiler trace.
+
+The threaded engines record the id of each profiled operator and the operators it waited for
+on its variables in the `args` of the trace, which are also drawn as flow events. This script
+rebuilds the dependency graph of the operators of a step, and reports the chain of operators
+that bounds the step time and the slack of every operator, i.e. how much its execution can
+grow without delaying the step if the engine ran every operator as soon as its inputs were
+ready.
+
+Example::
+
+    mx.profiler.set_config(profile_all=True, filename='profile.json')
+    mx.profiler.set_state('run')
+    train_step()
+    mx.nd.waitall()
+    mx.profiler.set_state('stop')
+    mx.profiler.dump()
+
+    $ python tools/profile/critical_path.py profile.json
+"""
+import argparse
+import json
+from collections import defaultdict
+
+
+def load_trace(path):
+    """Load a trace, including the trace of a continuous dump which is not terminated yet."""
+    with open(path) as fin:
+        text = fin.read()
+    try:
+        trace = json.loads(text)
+    except ValueError:
+        trace = json.loads(text.rstrip().rstrip(',') + ']}')
+    return trace['traceEvents'] if isinstance(trace, dict) else trace
+
+
+def load_operators(events, begin=None, end=None):
+    """Return the operators of the events which ran within [begin, end], by id.
+
+    Each operator is a dict with the `name`, `start` and `end` in microseconds, the `pid` and
+    `tid` of the trace, and the ids of the operators it depends on within the window in `deps`.
+    """
+    oprs = {}
+    for event in events:
+        args = event.get('args')
+        if not isinstance(args, dict) or 'opr_id' not in args:
+            continue
+        opr = oprs.setdefault(args['opr_id'], {'name': event['name'], 'pid': event['pid'],
+                                               'tid': event['tid'], 'deps': []})
+        if event['ph'] == 'B':
+            opr['start'] = event['ts']
+            opr['deps'] = list(args.get('deps', []))
+        elif event['ph'] == 'E':
+            opr['end'] = event['ts']
+    oprs = {k: v for k, v in oprs.items() if 'start' in v and 'end' in v and
+            (begin is None or v['start'] >= begin) and (end is None or v['end'] <= end)}
+    for opr in oprs.values():
+        opr['deps'] = [dep for dep in opr['deps'] if dep in oprs]
+    return oprs
+
+
+def critical_path(oprs):
+    """Schedule every operator as soon as its dependencies complete.
+
+    Returns
+    -------
+    path : list of int
+        the ids of the operators of the critical path, in execution order
+    length : int
+        the length of the critical path in microseconds, the step time if the engine had
+        enough workers and no overhead
+    slack : dict of int to int
+        the slack of each operator in microseconds, 0 on the critical path
+    """
+    # the ids increase in push order, which is a topological order
+    order = sorted(oprs)
+    finish, blocker = {}, {}
+    for opr_id in order:
+        opr = oprs[opr_id]
+        ready, blocker[opr_id] = 0, None
+        for dep in opr['deps']:
+            if finish[dep] > ready:
+                ready, blocker[opr_id] = finish[dep], dep
+        finish[opr_id] = ready + opr['end'] - opr['start']
+    if not order:
+        return [], 0, {}
+    length = max(finish.values())
+    succs = defaultdict(list)
+    for opr_id in order:
+        for dep in oprs[opr_id]['deps']:
+            succs[dep].append(opr_id)
+    latest = {}
+    for opr_id in reversed(order):
+        latest[opr_id] = min([latest[s] - (oprs[s]['end'] - oprs[s]['start'])
+                              for s in succs[opr_id]] + [length])
+    slack = {opr_id: latest[opr_id] - finish[opr_id] for opr_id in order}
+    path, opr_id = [], max(order, key=lambda k: finish[k])
+    while opr_id is not None:
+        path.append(opr_id)
+        opr_id = blocker[opr_id]
+    return path[::-1], length, slack
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Critical path of the operators of a trace')
+    parser.add_argument('trace', help='trace dumped by the profiler')
+    parser.add_argument('--begin', type=float, default=None,
+                        help='timestamp in microseconds where the step begins')
+    parser.add_argument('--end', type=float, default=None,
+                        help='timestamp in microseconds where the step ends')
+    parser.add_argument('--top', type=int, default=20,
+                        help='number of operators with the least slack to print')
+    parser.add_argument('--json', action='store_true', help='print the results in json')
+    args = parser.parse_args()
+
+    oprs = load_operators(load_trace(args.trace), args.begin, args.end)
+    if not oprs:
+        parser.error('no operator with dependencies in the trace, was it recorded by a '
+                     'threaded engine with profile_imperative or profile_symbolic set?')
+    path, length, slack = critical_path(oprs)
+    observed = max(o['end'] for o in oprs.values()) - min(o['start'] for o in oprs.values())
+    if args.json:
+        print(json.dumps({
+            'step_us': observed, 'critical_path_us': length,
+            'critical_path': [{'id': k, 'name': oprs[k]['name'],
+                               'duration_us': oprs[k]['end'] - oprs[k]['start']}
+                              for k in path],
+            'slack_us': {str(k): v for k, v in slack.items()}}, indent=2))
+        return
+    print('Step time: %.3f ms, critical path: %.3f ms over %d of %d operators'
+          % (observed / 1000.0, length / 1000.0, len(path), len(oprs)))
+    print('\nCritical path:')
+    print('%12s %12s  %s' % ('Time (ms)', 'Total (ms)', 'Operator'))
+    total = 0
+    for opr_id in path:
+        duration = oprs[opr_id]['end'] - oprs[opr_id]['start']
+        total += duration
+        print('%12.3f %12.3f  %s' % (duration / 1000.0, total / 1000.0, oprs[opr_id]['name']))
+    print('\nOperators with the least slack:')
+    print('%12s %12s  %s' % ('Slack (ms)', 'Time (ms)', 'Operator'))
+    for opr_id in sorted(slack, key=lambda k: (slack[k], k))[:args.top]:
+        opr = oprs[opr_id]
+        print('%12.3f %12.3f  %s' % (slack[opr_id] / 1000.0, (opr['end'] - opr['start']) / 1000.0,
+                                     opr['name']))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Populate the on-disk cache of runtime compiled kernels (MXNET_RTC_CACHE_DIR)
+by running an exported model once, so that the processes started later, e.g. from a
+container image, do not compile the fused kernels again.
+
+Example:
+    python rtc_cache_warmup.py --cache-dir /opt/rtc_cache --symbol model-symbol.json \\
+        --params model-0000.params --input data:1,3,224,224 --input data:8,3,224,224
+"""
+import argparse
+import os
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Compile the runtime kernels of a model into MXNET_RTC_CACHE_DIR.')
+    parser.add_argument('--cache-dir', required=True,
+                        help='directory of the kernel cache, created if needed')
+    parser.add_argument('--symbol', required=True, help='symbol file of the exported model')
+    parser.add_argument('--params', default=None, help='parameter file of the exported model')
+    parser.add_argument('--input', action='append', required=True,
+                        help='name:shape of an input, e.g. data:1,3,224,224. Repeating an '
+                             'input compiles the kernels of every given shape.')
+    parser.add_argument('--dtype', default='float32', help='data type of the inputs')
+    parser.add_argument('--gpus', default='0',
+                        help='comma separated GPUs to compile for, one per architecture '
+                             'is enough')
+    parser.add_argument('--train', action='store_true',
+                        help='also compile the kernels of the backward pass')
+    parser.add_argument('--nd', action='store_true',
+                        help='the model was exported without the numpy semantics')
+    return parser.parse_args()
+
+
+def parse_inputs(specs):
+    """Group the name:shape specifications into lists of shapes by input name."""
+    inputs = {}
+    for spec in specs:
+        name, shape = spec.rsplit(':', 1)
+        inputs.setdefault(name, []).append(tuple(int(d) for d in shape.split(',')))
+    num_shapes = {len(shapes) for shapes in inputs.values()}
+    if len(num_shapes) != 1:
+        raise ValueError('every input needs the same number of shapes')
+    return inputs, num_shapes.pop()
+
+
+def main():
+    args = parse_args()
+    os.makedirs(args.cache_dir, exist_ok=True)
+    # read by MXNet when the first kernel is compiled
+    os.environ['MXNET_RTC_CACHE_DIR'] = os.path.abspath(args.cache_dir)
+    import mxnet as mx
+    if not args.nd:
+        mx.npx.set_np()
+    inputs, num_shapes = parse_inputs(args.input)
+    names = list(inputs)
+    for gpu in args.gpus.split(','):
+        ctx = mx.gpu(int(gpu))
+        net = mx.gluon.SymbolBlock.imports(args.symbol, names, args.params, ctx=ctx)
+        net.hybridize(static_alloc=True, static_shape=True)
+        for i in range(num_shapes):
+            if args.nd:
+                data = [mx.nd.ones(inputs[n][i], ctx=ctx, dtype=args.dtype) for n in names]
+            else:
+                data = [mx.np.ones(inputs[n][i], ctx=ctx, dtype=args.dtype) for n in names]
+            if args.train:
+                for d in data:
+                    d.attach_grad()
+                with mx.autograd.record():
+                    out = net(*data)
+                outputs = out if isinstance(out, (list, tuple)) else [out]
+                mx.autograd.backward(outputs)
+            else:
+                out = net(*data)
+                outputs = out if isinstance(out, (list, tuple)) else [out]
+            for o in outputs:
+                o.wait_to_read()
+        mx.nd.waitall()
+    print('Kernel cache %s holds %d kernels' % (args.cache_dir, len(os.listdir(args.cache_dir))))
+
+
+if __name__ == '__main__':
+    main()
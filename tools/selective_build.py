@@ -0,0 +1,202 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Selective build of the operators of libmxnet for inference deployments.
+
+The ops command lists the operators of models, exported as -symbol.json files or by
+HybridBlock.export_compiled, and the sources command lists the sources of src/operator
+which register none of the operators of such a list, along with the frontend API of the
+operators in src/api/operator. CMake drops those sources when
+MXNET_SELECTED_OPS is set to the list.
+
+Example:
+    python selective_build.py ops --output ops.txt resnet50-symbol.json bert.npz
+    cmake -DMXNET_SELECTED_OPS=$PWD/ops.txt ..
+"""
+import argparse
+import io
+import json
+import os
+import re
+import sys
+import zipfile
+
+# operators the runtime itself creates, e.g. to copy, initialize and cast arrays
+ESSENTIAL_OPS = ['_copy', '_zeros', '_ones', '_full', '_zeros_without_dtype', 'Cast', 'amp_cast',
+                 'amp_multicast', 'BlockGrad', 'zeros_like', 'ones_like', '_npi_zeros',
+                 '_npi_ones', '_npi_full']
+
+# sources which are used from outside of the operators they register, always built
+ALWAYS_BUILT = ['custom/', 'subgraph/']
+
+# the macros registering operators, the first argument of which is the name of the operator or,
+# for the macros defining families of operators, a part of the name
+_REGISTER = re.compile(r'^\s*(NNVM_REGISTER_OP|MXNET_REGISTER_OP_PROPERTY|'
+                       r'MXNET_(?:MKL_)?OPERATOR_REGISTER_\w+|MXNET_REGISTER_\w*_OP)'
+                       r'\(\s*(\w+)', re.MULTILINE)
+_ALIAS = re.compile(r'\.add_alias\(\s*"(\w+)"\s*\)')
+_PARAMETER = re.compile(r'DMLC_REGISTER_PARAMETER\(\s*(\w+)\s*\)')
+# the functions a source defines for other sources, which are not static nor inline
+_FUNCTION = re.compile(r'^(?!static\b|inline\b|template\b|return\b|else\b|typedef\b|using\b)'
+                       r'(?:[A-Za-z_][\w:]*(?:<[^;()]*>)?[\s\*&]+)+([A-Za-z_]\w*)\([^;]*$', re.MULTILINE)
+_WORD = re.compile(r'\w+')
+
+
+def _graph_ops(graph, ops):
+    for node in graph['nodes']:
+        if node['op'] != 'null':
+            ops.add(node['op'])
+        for subgraph in node.get('subgraphs', []):
+            _graph_ops(subgraph, ops)
+
+
+def _read_symbol(path):
+    if path.endswith('.npz'):
+        import numpy as np
+        with zipfile.ZipFile(path) as archive:
+            data = np.load(io.BytesIO(archive.read('__symbol__.npy')))
+        return json.loads(data.tobytes().decode('utf-8'))
+    with open(path) as f:
+        return json.load(f)
+
+
+def model_ops(paths):
+    """The operators of the graphs of the models, and those the runtime needs."""
+    ops = set(ESSENTIAL_OPS)
+    for path in paths:
+        _graph_ops(_read_symbol(path), ops)
+    return ops
+
+
+def _registers(source, ops):
+    """Whether the source registers one of ops, or no operator at all."""
+    names = []
+    for macro, name in _REGISTER.findall(source):
+        if macro in ('NNVM_REGISTER_OP', 'MXNET_REGISTER_OP_PROPERTY'):
+            names.append(name)
+        elif any(name in op for op in ops):
+            # a family of operators, named after the argument
+            return True
+    names += _ALIAS.findall(source)
+    if not names:
+        return True
+    for name in names:
+        if name in ops:
+            return True
+        if name.startswith('_backward_') and name[len('_backward_'):] in ops:
+            return True
+    return False
+
+
+def _read(path):
+    with open(path, encoding='utf-8', errors='replace') as f:
+        return f.read()
+
+
+def _sources(src_dir):
+    """The sources of src_dir, with the .cc file and the .cu file of the same name together."""
+    stems = {}
+    for root, _, files in os.walk(src_dir):
+        for fname in files:
+            stem, ext = os.path.splitext(fname)
+            if ext in ('.cc', '.cu'):
+                stems.setdefault(os.path.join(root, stem), []).append(os.path.join(root, fname))
+    return stems
+
+
+def excluded_sources(src_dir, ops):
+    """The sources of the operators which register none of ops, and the frontend API of the
+    operators. A .cc file and the .cu file of the same name are either both built or both
+    excluded, and a source is built when the sources built use the parameters or functions
+    it defines."""
+    op_dir = os.path.join(src_dir, 'operator')
+    api_dir = os.path.join(src_dir, 'api', 'operator')
+    stems = _sources(op_dir)
+    texts = {stem: '\n'.join(_read(path) for path in paths) for stem, paths in stems.items()}
+    kept = set()
+    for stem in stems:
+        rel = os.path.relpath(stem, op_dir).replace(os.sep, '/')
+        if any(rel.startswith(prefix) for prefix in ALWAYS_BUILT) or _registers(texts[stem], ops):
+            kept.add(stem)
+    used = [texts[stem] for stem in kept]
+    for stem, paths in _sources(src_dir).items():
+        if not stem.startswith((op_dir + os.sep, api_dir + os.sep)):
+            used += [_read(path) for path in paths]
+    used = set(_WORD.findall('\n'.join(used)))
+    # the parameters and functions the sources excluded so far define
+    defined = {stem: _PARAMETER.findall(texts[stem]) +
+                     [name for name in _FUNCTION.findall(texts[stem]) if not name.isupper()]
+               for stem in stems if stem not in kept}
+    changed = True
+    while changed:
+        changed = False
+        for stem in sorted(defined):
+            if stem in kept:
+                continue
+            if any(name in used for name in defined[stem]):
+                kept.add(stem)
+                used.update(_WORD.findall(texts[stem]))
+                changed = True
+    excluded = [path for stem, paths in stems.items() if stem not in kept for path in paths]
+    # the frontend API of the operators is for the Python package, not for serving
+    excluded += [path for paths in _sources(api_dir).values() for path in paths]
+    return sorted(excluded)
+
+
+def read_op_list(path):
+    """Reads a list of operators, one per line, with # comments."""
+    with open(path) as f:
+        ops = [line.split('#')[0].strip() for line in f]
+    return set(op for op in ops if op) | set(ESSENTIAL_OPS)
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='List the operators of models, or the sources which do not register them.')
+    commands = parser.add_subparsers(dest='command')
+    commands.required = True
+    ops = commands.add_parser('ops', help='list the operators of models')
+    ops.add_argument('models', nargs='+', help='-symbol.json files or files of export_compiled')
+    ops.add_argument('--output', help='file to write the list to, standard output by default')
+    sources = commands.add_parser('sources', help='list the sources to exclude from the build')
+    sources.add_argument('--ops', required=True, help='file listing the operators to build')
+    sources.add_argument('--src', default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                       '..', 'src'),
+                         help='directory of the sources of libmxnet')
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    if args.command == 'ops':
+        text = ''.join(op + '\n' for op in sorted(model_ops(args.models)))
+        if args.output:
+            with open(args.output, 'w') as f:
+                f.write(text)
+        else:
+            sys.stdout.write(text)
+    else:
+        src_dir = os.path.abspath(args.src)
+        excluded = excluded_sources(src_dir, read_op_list(args.ops))
+        # a CMake list
+        sys.stdout.write(';'.join(path.replace(os.sep, '/') for path in excluded))
+
+
+if __name__ == '__main__':
+    main()